@@ -1,4 +1,5 @@
 #include "adaptive_decision_engine.hpp"
+#include "../core/metrics.hpp"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -594,11 +595,224 @@ void Version1210Adapter::handle_deep_dark_adaptations(EnhancedEntityBehaviorData
     std::cout << "Applied Deep Dark adaptations" << std::endl;
 }
 
+// ===========================================
+// 世界视图查询
+// ===========================================
+void WorldView::build_entity_index() {
+    auto index = std::make_shared<EntityIndex>();
+    for (size_t i = 0; i < nearby_entities.size(); ++i) {
+        index->insert(static_cast<int>(i), nearby_entities[i].x, nearby_entities[i].z);
+    }
+    entity_index = std::move(index);
+}
+
+std::vector<WorldView::EntityInfo> WorldView::getEntitiesInRange(float x, float z, float range) const {
+    std::vector<EntityInfo> result;
+    if (entity_index && entity_index->size() == nearby_entities.size()) {
+        thread_local std::vector<int> candidates;
+        candidates.clear();
+        entity_index->queryRange(x, z, range, candidates);
+        std::sort(candidates.begin(), candidates.end());    // 保持nearby_entities中的顺序
+        result.reserve(candidates.size());
+        for (int i : candidates) {
+            result.push_back(nearby_entities[i]);
+        }
+        return result;
+    }
+    
+    const float range_sq = range * range;
+    for (const auto& entity : nearby_entities) {
+        const float dx = entity.x - x;
+        const float dz = entity.z - z;
+        if (dx * dx + dz * dz <= range_sq) {
+            result.push_back(entity);
+        }
+    }
+    return result;
+}
+
+bool WorldView::heard_vibration(float range) const {
+    if (!game_events || listener_id == 0) {
+        return false;
+    }
+    const GameEventGrid::Delivery* nearest = game_events->nearest_for(listener_id);
+    return nearest && nearest->distance <= range;
+}
+
+// ===========================================
+// 游戏事件网格
+// ===========================================
+
+int GameEventGrid::cell_coord(float value) {
+    return static_cast<int>(std::floor(value / CELL_SIZE));
+}
+
+uint64_t GameEventGrid::cell_key(int cx, int cy, int cz) {
+    // x、z各26位，y 12位（±2048个格子，远超世界高度）
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cx) & 0x3FFFFFF) << 38) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(cz) & 0x3FFFFFF) << 12) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(cy) & 0xFFF));
+}
+
+void GameEventGrid::begin_tick(uint64_t tick) {
+    tick_ = tick;
+    dispatched_ = false;
+    listeners_.clear();
+    listener_index_.clear();
+    events_.clear();
+    // 上一tick没有用到的格子释放，其余保留容量
+    for (auto it = cells_.begin(); it != cells_.end();) {
+        if (it->second.empty()) {
+            it = cells_.erase(it);
+        } else {
+            it->second.clear();
+            ++it;
+        }
+    }
+    deliveries_.clear();
+    listener_offsets_.clear();
+}
+
+void GameEventGrid::register_listener(uint64_t listener_id, float x, float y, float z, float radius) {
+    if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(z) || !(radius >= 0.0f)) {
+        return;
+    }
+    auto [it, inserted] = listener_index_.try_emplace(listener_id, static_cast<uint32_t>(listeners_.size()));
+    if (!inserted) {
+        // 重新登记：旧格子里的下标在dispatch时按位置重新校验，这里只更新位置
+        listeners_[it->second] = Listener{listener_id, x, y, z, radius};
+    } else {
+        listeners_.push_back(Listener{listener_id, x, y, z, radius});
+    }
+    const uint32_t index = it->second;
+    for (int cx = cell_coord(x - radius); cx <= cell_coord(x + radius); ++cx) {
+        for (int cy = cell_coord(y - radius); cy <= cell_coord(y + radius); ++cy) {
+            for (int cz = cell_coord(z - radius); cz <= cell_coord(z + radius); ++cz) {
+                std::vector<uint32_t>& members = cells_[cell_key(cx, cy, cz)];
+                if (members.empty() || members.back() != index) {
+                    members.push_back(index);
+                }
+            }
+        }
+    }
+    ++stats_.listeners;
+}
+
+void GameEventGrid::post_event(const GameEvent& event) {
+    if (!std::isfinite(event.x) || !std::isfinite(event.y) || !std::isfinite(event.z)) {
+        return;
+    }
+    events_.push_back(event);
+    ++stats_.events;
+}
+
+void GameEventGrid::dispatch() {
+    struct Pending {
+        uint32_t listener;
+        Delivery delivery;
+    };
+    thread_local std::vector<Pending> pending;
+    pending.clear();
+    
+    for (uint32_t e = 0; e < events_.size(); ++e) {
+        const GameEvent& event = events_[e];
+        auto cell = cells_.find(cell_key(cell_coord(event.x), cell_coord(event.y), cell_coord(event.z)));
+        if (cell == cells_.end()) {
+            continue;
+        }
+        for (uint32_t index : cell->second) {
+            const Listener& listener = listeners_[index];
+            ++stats_.distance_checks;
+            if (listener.id == event.source_id) {
+                continue;   // 自己造成的振动
+            }
+            const float dx = event.x - listener.x;
+            const float dy = event.y - listener.y;
+            const float dz = event.z - listener.z;
+            const float distance_sq = dx * dx + dy * dy + dz * dz;
+            if (distance_sq <= listener.radius * listener.radius) {
+                pending.push_back(Pending{index, Delivery{e, std::sqrt(distance_sq)}});
+            }
+        }
+    }
+    
+    // 重复登记的监听者在多个格子里可能出现两次，按(监听者, 事件)去重
+    std::sort(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        if (a.listener != b.listener) {
+            return a.listener < b.listener;
+        }
+        return a.delivery.event_index < b.delivery.event_index;
+    });
+    pending.erase(std::unique(pending.begin(), pending.end(), [](const Pending& a, const Pending& b) {
+        return a.listener == b.listener && a.delivery.event_index == b.delivery.event_index;
+    }), pending.end());
+    
+    listener_offsets_.assign(listeners_.size() + 1, 0);
+    deliveries_.clear();
+    deliveries_.reserve(pending.size());
+    size_t next = 0;
+    for (uint32_t listener = 0; listener < listeners_.size(); ++listener) {
+        listener_offsets_[listener] = static_cast<uint32_t>(deliveries_.size());
+        const size_t first = deliveries_.size();
+        for (; next < pending.size() && pending[next].listener == listener; ++next) {
+            deliveries_.push_back(pending[next].delivery);
+        }
+        std::sort(deliveries_.begin() + static_cast<std::ptrdiff_t>(first), deliveries_.end(),
+                  [](const Delivery& a, const Delivery& b) {
+                      return a.distance < b.distance ||
+                             (a.distance == b.distance && a.event_index < b.event_index);
+                  });
+    }
+    listener_offsets_[listeners_.size()] = static_cast<uint32_t>(deliveries_.size());
+    stats_.deliveries += deliveries_.size();
+    dispatched_ = true;
+}
+
+std::pair<const GameEventGrid::Delivery*, const GameEventGrid::Delivery*> GameEventGrid::deliveries_for(
+    uint64_t listener_id) const {
+    auto it = listener_index_.find(listener_id);
+    if (!dispatched_ || it == listener_index_.end()) {
+        return {nullptr, nullptr};
+    }
+    const Delivery* base = deliveries_.data();
+    return {base + listener_offsets_[it->second], base + listener_offsets_[it->second + 1]};
+}
+
+const GameEventGrid::Delivery* GameEventGrid::nearest_for(uint64_t listener_id) const {
+    auto [first, last] = deliveries_for(listener_id);
+    return first != last ? first : nullptr;
+}
+
 // ===========================================
 // 3. 智能决策树实现
 // ===========================================
+namespace {
+    std::atomic<uint32_t> next_decision_cache_owner{1};
+
+    core::Counter& decisionCounter(const char* cache) {
+        return core::MetricsRegistry::instance().counter(
+            "lattice_ai_decisions_total", "Decision tree evaluations by decision cache result", {{"cache", cache}});
+    }
+
+    uint32_t hash_entity_id(const std::string& id) {
+        uint32_t hash = 2166136261u;    // FNV-1a
+        for (unsigned char c : id) {
+            hash = (hash ^ c) * 16777619u;
+        }
+        return hash;
+    }
+
+    uint64_t mix_decision_key(uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xFF51AFD7ED558CCDULL;
+        key ^= key >> 33;
+        return key;
+    }
+}
+
 SmartDecisionTree::SmartDecisionTree(const std::shared_ptr<cache::HierarchicalCacheSystem>& cache_system)
-    : cache_system_(cache_system) {
+    : cache_system_(cache_system),
+      cache_owner_(next_decision_cache_owner.fetch_add(1, std::memory_order_relaxed)) {
     std::cout << "Smart Decision Tree initialized" << std::endl;
 }
 
@@ -610,38 +824,35 @@ EntityState::BehaviorState SmartDecisionTree::make_decision(
     auto start_time = std::chrono::steady_clock::now();
     
     // 检查决策缓存
-    if (caching_enabled_) {
-        std::shared_lock lock(cache_mutex_);
-        std::string cache_key = generate_decision_key(world, config, current_state);
-        
-        auto cache_it = decision_cache_.find(cache_key);
-        if (cache_it != decision_cache_.end()) {
-            // 检查缓存是否过期（5分钟）
-            auto cache_time = cache_timestamps_[cache_key];
-            auto now = std::chrono::steady_clock::now();
-            if (std::chrono::duration_cast<std::chrono::minutes>(now - cache_time).count() < 5) {
-                {
-                    std::lock_guard stats_lock(stats_mutex_);
-                    stats_.cache_hits++;
-                    stats_.total_decisions++;
-                }
-                return cache_it->second;
+    const uint64_t cache_key = caching_enabled_.load(std::memory_order_relaxed)
+                                   ? generate_decision_key(world, config, current_state)
+                                   : 0;
+    if (cache_key != 0) {
+        EntityState::BehaviorState cached;
+        if (lookup_decision_cache(cache_key, start_time, cached)) {
+            {
+                std::lock_guard stats_lock(stats_mutex_);
+                stats_.cache_hits++;
+                stats_.total_decisions++;
             }
+            static core::Counter& hits = decisionCounter("hit");
+            hits.inc();
+            return cached;
         }
     }
     
     // 优先级1: 生存威胁检测
-    if (has_nearby_threats(world, config)) {
+    if (sensed_nearby_threats(world, config)) {
         auto behavior = handle_threat_response(world, config);
-        update_decision_cache(world, config, current_state, behavior);
+        update_decision_cache(cache_key, behavior);
         update_stats(start_time, false);
         return behavior;
     }
     
     // 优先级2: 环境适应性
-    auto env_result = check_environment_adaptation(world, config);
+    auto env_result = sensed_environment_adaptation(world, config);
     if (env_result.needs_adaptation) {
-        update_decision_cache(world, config, current_state, env_result.suggested_behavior);
+        update_decision_cache(cache_key, env_result.suggested_behavior);
         update_stats(start_time, false);
         return env_result.suggested_behavior;
     }
@@ -649,7 +860,7 @@ EntityState::BehaviorState SmartDecisionTree::make_decision(
     // 优先级3: 攻击目标检查
     if (has_attack_targets(world, config)) {
         if (config.combat.can_attack) {
-            update_decision_cache(world, config, current_state, EntityState::BehaviorState::ATTACKING);
+            update_decision_cache(cache_key, EntityState::BehaviorState::ATTACKING);
             update_stats(start_time, false);
             return EntityState::BehaviorState::ATTACKING;
         }
@@ -658,7 +869,7 @@ EntityState::BehaviorState SmartDecisionTree::make_decision(
     // 优先级4: 食物或休息需求
     if (needs_food_or_rest(world, config)) {
         auto behavior = handle_goal_driven_behavior(world, config);
-        update_decision_cache(world, config, current_state, behavior);
+        update_decision_cache(cache_key, behavior);
         update_stats(start_time, false);
         return behavior;
     }
@@ -666,14 +877,14 @@ EntityState::BehaviorState SmartDecisionTree::make_decision(
     // 优先级5: 特殊行为处理（1.21.0）
     auto special_behavior = handle_special_behaviors(world, config);
     if (special_behavior != EntityState::BehaviorState::UNKNOWN) {
-        update_decision_cache(world, config, current_state, special_behavior);
+        update_decision_cache(cache_key, special_behavior);
         update_stats(start_time, false);
         return special_behavior;
     }
     
     // 优先级6: 默认行为
     auto default_behavior = handle_goal_driven_behavior(world, config);
-    update_decision_cache(world, config, current_state, default_behavior);
+    update_decision_cache(cache_key, default_behavior);
     update_stats(start_time, false);
     return default_behavior;
 }
@@ -749,6 +960,84 @@ bool SmartDecisionTree::has_nearby_threats(const WorldView& world, const Enhance
     return false;
 }
 
+uint64_t SmartDecisionTree::sensor_key(const WorldView& world, SensorKind kind, uint32_t param) const {
+    if (!world.has_observer_position || world.tick == 0 ||
+        !sensor_sharing_enabled_.load(std::memory_order_relaxed)) {
+        return 0;
+    }
+    // 位布局：63 非零标记 | 62..43 格子x | 42..23 格子z | 22..11 格子y | 10..9 种类 | 7..0 参数
+    // 格子坐标取低位，相距约四百万格以上的两个格子才会重合
+    const auto cell = [](float v) {
+        return static_cast<uint64_t>(static_cast<int64_t>(std::floor(v / SENSOR_CELL_SIZE)));
+    };
+    return (1ULL << 63) |
+           ((cell(world.observer_x) & 0xFFFFF) << 43) |
+           ((cell(world.observer_z) & 0xFFFFF) << 23) |
+           ((cell(world.observer_y) & 0xFFF) << 11) |
+           (static_cast<uint64_t>(kind) << 9) |
+           (param & 0xFF);
+}
+
+template <typename Compute>
+SmartDecisionTree::SensorValue SmartDecisionTree::sense(const WorldView& world, SensorKind kind,
+                                                        uint32_t param, Compute&& compute) {
+    const uint64_t key = sensor_key(world, kind, param);
+    if (key == 0) {
+        return compute();
+    }
+    SensorShard& shard = sensor_shards_[mix_decision_key(key) & (SENSOR_SHARDS - 1)];
+    {
+        std::lock_guard lock(shard.mutex);
+        if (shard.tick == world.tick) {
+            auto it = shard.values.find(key);
+            if (it != shard.values.end()) {
+                sensor_shared_hits_.fetch_add(1, std::memory_order_relaxed);
+                return it->second;
+            }
+        }
+    }
+    // 在锁外计算；两个线程同时算同一个键时结果相同，保留先写入的
+    SensorValue value = compute();
+    sensor_evaluations_.fetch_add(1, std::memory_order_relaxed);
+    std::lock_guard lock(shard.mutex);
+    if (shard.tick != world.tick) {
+        if (world.tick < shard.tick) {
+            return value;   // 落后的tick不覆盖新tick的结果
+        }
+        shard.values.clear();
+        shard.tick = world.tick;
+    }
+    shard.values.try_emplace(key, value);
+    return value;
+}
+
+bool SmartDecisionTree::sensed_nearby_threats(const WorldView& world, const EnhancedEntityBehaviorData& config) {
+    // 参数：探测范围向上取整到整格（最多127）和是否为敌对类别，决定了查询结果
+    const auto range = static_cast<uint32_t>(std::clamp(std::ceil(config.combat.detection_range), 0.0f, 127.0f));
+    const uint32_t param = (range << 1) | (config.category == "hostile" ? 1u : 0u);
+    return sense(world, SensorKind::THREATS, param, [&] {
+        SensorValue value;
+        value.flag = has_nearby_threats(world, config);
+        return value;
+    }).flag;
+}
+
+EnvironmentAdaptationResult SmartDecisionTree::sensed_environment_adaptation(
+    const WorldView& world,
+    const EnhancedEntityBehaviorData& config) {
+    // 参数：check_environment_adaptation读取的全部生存属性
+    const uint32_t param = (config.survival.is_nocturnal ? 1u : 0u) |
+                           (config.survival.avoids_water ? 2u : 0u) |
+                           (config.survival.freeze_damage ? 4u : 0u) |
+                           (config.survival.fire_damage ? 8u : 0u) |
+                           (config.survival.fire_immune ? 16u : 0u);
+    return sense(world, SensorKind::ENVIRONMENT, param, [&] {
+        SensorValue value;
+        value.environment = check_environment_adaptation(world, config);
+        return value;
+    }).environment;
+}
+
 bool SmartDecisionTree::has_attack_targets(const WorldView& world, const EnhancedEntityBehaviorData& config) const {
     if (!config.combat.can_attack) {
         return false;
@@ -825,6 +1114,11 @@ EntityState::BehaviorState SmartDecisionTree::handle_warden_behaviors(
     const WorldView& world,
     const EnhancedEntityBehaviorData& config) const {
     
+    // 本tick投递给这只监守者的振动
+    if (world.heard_vibration(config.v1210.vibration_detection_range)) {
+        return EntityState::BehaviorState::VIBRATION_DETECTION;
+    }
+    
     // 检查振动检测
     for (const auto& entity : world.nearby_entities) {
         if (entity.is_player && entity.distance <= config.v1210.vibration_detection_range) {
@@ -876,73 +1170,165 @@ EntityState::BehaviorState SmartDecisionTree::handle_bogged_behaviors(
     return EntityState::BehaviorState::PATROLLING;
 }
 
-std::string SmartDecisionTree::generate_decision_key(
+/**
+ * 决策缓存键：把决策依赖的输入量化后打包进64位
+ *
+ *  63..32  实体ID哈希
+ *  31..24  当前行为状态
+ *  23..20  群系类型
+ *  19..17  光照档位（8档）
+ *  16      强光（> 0.7，夜行生物躲避的阈值）
+ *  15..14  生命值档位（4档，边界包含50%的觅食/休息阈值）
+ *  13..12  温度带（寒冷 / 正常 / 炎热）
+ *  11      附近有液体
+ *  10..7   威胁、近战目标、远程目标、振动范围内的玩家
+ *  0       恒为1，保证有效键非0
+ *
+ * 决策分支只比较这些阈值，所以量化后同一个键的决策相同；
+ * 附近实体一次遍历求出各个标志位，不再拼接字符串。
+ */
+uint64_t SmartDecisionTree::generate_decision_key(
     const WorldView& world,
     const EnhancedEntityBehaviorData& config,
     EntityState::BehaviorState current_state) const {
     
-    std::stringstream key;
-    key << config.id << "_";
-    key << static_cast<int>(current_state) << "_";
-    key << world.environment.light_level << "_";
-    key << world.nearby_entities.size() << "_";
-    key << world.environment.temperature << "_";
-    key << world.environment.humidity;
-    
-    return key.str();
+    bool threat = false;
+    bool target = false;
+    bool ranged_target = false;
+    // 投递给观察者的振动与范围内的玩家走同一个决策分支
+    bool vibration = world.heard_vibration(config.v1210.vibration_detection_range);
+    const bool hostile_category = config.category == "hostile";
+    for (const auto& entity : world.nearby_entities) {
+        threat = threat || ((entity.is_hostile || (entity.is_player && hostile_category)) &&
+                            entity.distance <= config.combat.detection_range);
+        target = target || ((entity.is_player || (!entity.is_ally && !entity.is_hostile)) &&
+                            entity.distance <= config.combat.attack_range);
+        ranged_target = ranged_target || ((entity.is_player || !entity.is_ally) &&
+                                          entity.distance <= config.combat.ranged_attack_range);
+        vibration = vibration || (entity.is_player &&
+                                  entity.distance <= config.v1210.vibration_detection_range);
+    }
+    bool liquid = false;
+    for (const auto& block : world.nearby_blocks) {
+        if (block.is_liquid) {
+            liquid = true;
+            break;
+        }
+    }
+
+    const float light = std::clamp(world.environment.light_level, 0.0f, 1.0f);
+    const uint64_t light_bucket = std::min<uint64_t>(static_cast<uint64_t>(light * 8.0f), 7);
+    const float max_health = config.physics.max_health > 0 ? config.physics.max_health : 1.0f;
+    const float health = std::clamp(config.physics.current_health / max_health, 0.0f, 1.0f);
+    const uint64_t health_bucket = std::min<uint64_t>(static_cast<uint64_t>(health * 4.0f), 3);
+    const float temperature = world.environment.temperature;
+    const uint64_t temperature_band = temperature < 0.2f ? 0 : (temperature > 0.8f ? 2 : 1);
+
+    uint64_t key = static_cast<uint64_t>(hash_entity_id(config.id)) << 32;
+    key |= static_cast<uint64_t>(current_state) << 24;
+    key |= (static_cast<uint64_t>(world.environment.biome_type) & 0xF) << 20;
+    key |= light_bucket << 17;
+    key |= static_cast<uint64_t>(world.environment.light_level > 0.7f) << 16;
+    key |= health_bucket << 14;
+    key |= temperature_band << 12;
+    key |= static_cast<uint64_t>(liquid) << 11;
+    key |= static_cast<uint64_t>(threat) << 10;
+    key |= static_cast<uint64_t>(target) << 9;
+    key |= static_cast<uint64_t>(ranged_target) << 8;
+    key |= static_cast<uint64_t>(vibration) << 7;
+    return key | 1;
+}
+
+SmartDecisionTree::DecisionCacheTable& SmartDecisionTree::decision_cache_table() {
+    // 每个线程独占一张表；多个决策树共用，按owner区分
+    thread_local DecisionCacheTable table;
+    return table;
+}
+
+bool SmartDecisionTree::lookup_decision_cache(uint64_t key, std::chrono::steady_clock::time_point now,
+                                              EntityState::BehaviorState& decision) const {
+    const auto& entries = decision_cache_table().entries;
+    const uint32_t generation = cache_generation_.load(std::memory_order_acquire);
+    const auto expired_before = (now - DECISION_CACHE_TTL).time_since_epoch().count();
+    size_t slot = mix_decision_key(key) & (DECISION_CACHE_SIZE - 1);
+    for (size_t probe = 0; probe < DECISION_CACHE_PROBES; ++probe) {
+        const DecisionCacheEntry& entry = entries[slot];
+        if (entry.key == 0) {
+            return false;
+        }
+        if (entry.key == key && entry.owner == cache_owner_) {
+            if (entry.generation != generation || entry.stamp <= expired_before) {
+                return false;
+            }
+            decision = entry.decision;
+            return true;
+        }
+        slot = (slot + 1) & (DECISION_CACHE_SIZE - 1);
+    }
+    return false;
 }
 
-void SmartDecisionTree::update_decision_cache(
-    const WorldView& world,
-    const EnhancedEntityBehaviorData& config,
-    EntityState::BehaviorState current_state,
-    EntityState::BehaviorState decision) {
-    
-    if (!caching_enabled_) return;
-    
-    std::unique_lock lock(cache_mutex_);
-    std::string key = generate_decision_key(world, config, current_state);
+void SmartDecisionTree::update_decision_cache(uint64_t key, EntityState::BehaviorState decision) {
+    if (key == 0) return;
     
-    decision_cache_[key] = decision;
-    cache_timestamps_[key] = std::chrono::steady_clock::now();
+    auto& entries = decision_cache_table().entries;
+    const uint32_t generation = cache_generation_.load(std::memory_order_acquire);
+    const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+    const size_t home = mix_decision_key(key) & (DECISION_CACHE_SIZE - 1);
     
-    // 清理过期缓存（保留最新的1000个）
-    if (decision_cache_.size() > 1000) {
-        auto oldest = std::min_element(cache_timestamps_.begin(), cache_timestamps_.end(),
-            [](const auto& a, const auto& b) {
-                return a.second < b.second;
-            });
-        
-        if (oldest != cache_timestamps_.end()) {
-            decision_cache_.erase(oldest->first);
-            cache_timestamps_.erase(oldest);
+    // 探测窗口内：同键或空槽直接写入，否则替换最旧的一项
+    size_t victim = home;
+    for (size_t probe = 0; probe < DECISION_CACHE_PROBES; ++probe) {
+        const size_t slot = (home + probe) & (DECISION_CACHE_SIZE - 1);
+        const DecisionCacheEntry& entry = entries[slot];
+        if (entry.key == 0 || (entry.key == key && entry.owner == cache_owner_)) {
+            victim = slot;
+            break;
+        }
+        if (entry.stamp < entries[victim].stamp) {
+            victim = slot;
         }
     }
+    entries[victim] = DecisionCacheEntry{key, cache_owner_, generation, now, decision};
 }
 
 SmartDecisionTree::DecisionStats SmartDecisionTree::get_stats() const {
     std::lock_guard lock(stats_mutex_);
-    return stats_;
+    DecisionStats stats = stats_;
+    stats.sensor_shared_hits = sensor_shared_hits_.load(std::memory_order_relaxed);
+    stats.sensor_evaluations = sensor_evaluations_.load(std::memory_order_relaxed);
+    return stats;
 }
 
 void SmartDecisionTree::reset_stats() {
     std::lock_guard lock(stats_mutex_);
     stats_ = DecisionStats{};
+    sensor_shared_hits_.store(0, std::memory_order_relaxed);
+    sensor_evaluations_.store(0, std::memory_order_relaxed);
 }
 
 void SmartDecisionTree::enable_decision_caching(bool enable) {
     caching_enabled_ = enable;
 }
 
+void SmartDecisionTree::enable_sensor_sharing(bool enable) {
+    sensor_sharing_enabled_ = enable;
+}
+
 void SmartDecisionTree::clear_decision_cache() {
-    std::unique_lock lock(cache_mutex_);
-    decision_cache_.clear();
-    cache_timestamps_.clear();
+    // 各线程表中旧代数的项在下次查询时视为未命中
+    cache_generation_.fetch_add(1, std::memory_order_acq_rel);
 }
 
 void SmartDecisionTree::update_stats(std::chrono::steady_clock::time_point start_time, bool cache_hit) {
+    static core::Counter& hits = decisionCounter("hit");
+    static core::Counter& misses = decisionCounter("miss");
+    static core::Histogram& decisionSeconds = core::MetricsRegistry::instance().histogram(
+        "lattice_ai_decision_duration_seconds", "Decision tree evaluation time", core::Histogram::latencyBuckets());
     auto end_time = std::chrono::steady_clock::now();
     auto decision_time = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    (cache_hit ? hits : misses).inc();
+    decisionSeconds.observe(std::chrono::duration<double>(end_time - start_time).count());
     
     std::lock_guard lock(stats_mutex_);
     stats_.total_decisions++;
@@ -1693,10 +2079,19 @@ std::vector<EntityState::BehaviorState> decide_multiple_entities(
     
     world_views.reserve(entity_ids.size());
     
+    // 一次批量调用视为一个tick，同一感知格子内的实体共享本批的感知结果
+    static std::atomic<uint64_t> batch_tick{0};
+    const uint64_t tick = batch_tick.fetch_add(1, std::memory_order_relaxed) + 1;
+    
     for (size_t i = 0; i < entity_ids.size(); ++i) {
         WorldView world_view;
         world_view.environment.is_daytime = is_daytime_list[i];
         world_view.environment.light_level = light_level_list[i];
+        world_view.has_observer_position = true;
+        world_view.observer_x = positions[i][0];
+        world_view.observer_y = positions[i][1];
+        world_view.observer_z = positions[i][2];
+        world_view.tick = tick;
         
         // 填充附近实体信息
         for (const auto& entity_str : nearby_entities_list[i]) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -13,6 +14,7 @@
 #include <algorithm>
 #include <nlohmann/json.hpp>
 #include "cache/hierarchical_cache_system.hpp"
+#include "../core/net/loose_grid.hpp"
 
 namespace lattice {
 namespace ai {
@@ -79,6 +81,8 @@ namespace EntityState {
     };
 }
 
+using EntityState::EnvironmentType;
+
 // ===========================================
 // 2. 增强的实体行为数据结构
 // ===========================================
@@ -257,6 +261,78 @@ struct EnhancedEntityBehaviorData {
 // ===========================================
 // 3. 世界视图和环境感知
 // ===========================================
+/**
+ * 每tick的游戏事件（振动）空间索引
+ *
+ * 监听者（监守者、幽匿感测体等）按监听半径登记进覆盖其球体包围盒的所有格子，
+ * 事件只查看自己所在格子里的监听者并做精确距离判断，所以每个振动只投递给附近的监听者，
+ * 不再逐对比较所有事件与所有监听者（远古城市里玩家成群时两者都很多）。
+ *
+ * 用法：每tick begin_tick()，登记监听者、发布事件后dispatch()一次；
+ * 之后只读，可以用shared_ptr<const GameEventGrid>挂到各个WorldView上被多个线程同时查询。
+ * 投递不考虑羊毛遮挡，由Java侧在收到振动后判断。
+ */
+class GameEventGrid {
+public:
+    static constexpr int CELL_SIZE = 16;    // 原版监守者的监听半径
+    
+    struct GameEvent {
+        uint32_t type{0};           // 游戏事件注册表中的id
+        uint8_t frequency{1};       // 振动频率（1..15）
+        float x{0.0f}, y{0.0f}, z{0.0f};
+        uint64_t source_id{0};      // 0表示没有来源实体（方块事件等）
+    };
+    
+    struct Delivery {
+        uint32_t event_index;       // events()中的下标
+        float distance;
+    };
+    
+    struct Stats {
+        uint64_t events{0};
+        uint64_t listeners{0};
+        uint64_t deliveries{0};
+        uint64_t distance_checks{0};    // 事件所在格子里实际比较过的监听者
+    };
+    
+    // 清空上一tick的监听者、事件和投递结果（保留容量）
+    void begin_tick(uint64_t tick);
+    // 同一tick内重复登记同一个id时以最后一次为准
+    void register_listener(uint64_t listener_id, float x, float y, float z, float radius);
+    void post_event(const GameEvent& event);
+    // 把本tick的事件投递给范围内的监听者；每个监听者收到的事件按距离从近到远排列
+    void dispatch();
+    
+    uint64_t tick() const { return tick_; }
+    const std::vector<GameEvent>& events() const { return events_; }
+    // 监听者本tick收到的事件（dispatch之前、未登记的监听者为空），source_id为监听者自己的事件不投递
+    std::pair<const Delivery*, const Delivery*> deliveries_for(uint64_t listener_id) const;
+    // 最近的一个事件；没有时返回nullptr
+    const Delivery* nearest_for(uint64_t listener_id) const;
+    Stats get_stats() const { return stats_; }
+    
+private:
+    struct Listener {
+        uint64_t id;
+        float x, y, z, radius;
+    };
+    
+    static uint64_t cell_key(int cx, int cy, int cz);
+    static int cell_coord(float value);
+    
+    uint64_t tick_{0};
+    bool dispatched_{false};
+    std::vector<Listener> listeners_;
+    std::unordered_map<uint64_t, uint32_t> listener_index_;
+    std::vector<GameEvent> events_;
+    // 格子 -> 登记在其中的监听者下标
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+    // 按监听者分段存放的投递结果：listener_offsets_[i]..listener_offsets_[i + 1]
+    std::vector<Delivery> deliveries_;
+    std::vector<uint32_t> listener_offsets_;
+    Stats stats_;
+};
+
 struct WorldView {
     struct BlockInfo {
         std::string id;
@@ -292,8 +368,26 @@ struct WorldView {
     std::vector<EntityInfo> nearby_entities;
     EnvironmentInfo environment;
     
+    // nearby_entities下标的松散网格（与HierarchicalTracker同一种格子结构）
+    // 填好nearby_entities后调用build_entity_index()建立一次，视图的副本共享同一份索引
+    using EntityIndex = entity::LooseGrid<32>;
+    std::shared_ptr<const EntityIndex> entity_index;
+    void build_entity_index();
+    
+    // 观察者位置和所在tick；都填写时，同一感知格子内的实体在本tick共用感知结果（见SmartDecisionTree）
+    bool has_observer_position{false};
+    float observer_x{0.0f}, observer_y{0.0f}, observer_z{0.0f};
+    uint64_t tick{0};   // 0表示未知，不共享
+    
+    // 本tick的游戏事件索引与观察者作为监听者登记的id（0表示不是监听者），见GameEventGrid
+    std::shared_ptr<const GameEventGrid> game_events;
+    uint64_t listener_id{0};
+    // 观察者本tick在range内收到过振动
+    bool heard_vibration(float range) const;
+    
     // 查询功能
     std::optional<BlockInfo> getBlockAt(int x, int y, int z) const;
+    // 建立了entity_index时只扫描覆盖范围的格子，否则遍历nearby_entities
     std::vector<EntityInfo> getEntitiesInRange(float x, float z, float range) const;
     float getLightLevel(int x, int y, int z) const;
     bool isInWater(int x, int y, int z) const;
@@ -389,11 +483,16 @@ public:
     void enable_decision_caching(bool enable);
     void clear_decision_cache();
     
+    // 同一感知格子内的实体共享本tick的感知结果（威胁、环境适应）
+    void enable_sensor_sharing(bool enable);
+    
     // 性能统计
     struct DecisionStats {
         uint64_t total_decisions{0};
         uint64_t cache_hits{0};
         uint64_t cache_misses{0};
+        uint64_t sensor_shared_hits{0};     // 直接取用同格子其他实体已算出的感知结果
+        uint64_t sensor_evaluations{0};     // 实际执行的感知查询
         std::chrono::microseconds avg_decision_time{0};
         double cache_hit_ratio() const {
             return (total_decisions > 0) ? static_cast<double>(cache_hits) / total_decisions : 0.0;
@@ -408,11 +507,52 @@ private:
     mutable std::mutex stats_mutex_;
     DecisionStats stats_;
     
-    // 决策缓存
-    std::unordered_map<std::string, EntityState::BehaviorState> decision_cache_;
-    std::unordered_map<std::string, std::chrono::steady_clock::time_point> cache_timestamps_;
-    mutable std::shared_mutex cache_mutex_;
-    bool caching_enabled_{true};
+    // 决策缓存：每个线程一张开放寻址表（见DecisionCacheTable），查询和写入都不加锁
+    struct DecisionCacheEntry {
+        uint64_t key{0};            // 0表示空槽
+        uint32_t owner{0};          // 写入该项的决策树
+        uint32_t generation{0};     // 写入时决策树的缓存代数，clear_decision_cache后失效
+        std::chrono::steady_clock::rep stamp{0};
+        EntityState::BehaviorState decision{EntityState::BehaviorState::IDLE};
+    };
+    static constexpr size_t DECISION_CACHE_SIZE = 1024;     // 2的幂
+    static constexpr size_t DECISION_CACHE_PROBES = 4;
+    static constexpr std::chrono::minutes DECISION_CACHE_TTL{5};
+    struct DecisionCacheTable {
+        std::array<DecisionCacheEntry, DECISION_CACHE_SIZE> entries{};
+    };
+    static DecisionCacheTable& decision_cache_table();
+
+    const uint32_t cache_owner_;
+    std::atomic<uint32_t> cache_generation_{1};
+    std::atomic<bool> caching_enabled_{true};
+    
+    // 感知结果共享：按(感知格子, 查询种类, 参数)记录本tick的结果，同格子的实体直接取用。
+    // 分片加锁；分片记录的tick与查询的tick不同时先清空，所以只保留当前tick的结果
+    enum class SensorKind : uint8_t { THREATS, ENVIRONMENT };
+    struct SensorValue {
+        bool flag{false};
+        EnvironmentAdaptationResult environment;
+    };
+    struct SensorShard {
+        std::mutex mutex;
+        uint64_t tick{0};
+        std::unordered_map<uint64_t, SensorValue> values;
+    };
+    static constexpr int SENSOR_CELL_SIZE = 4;
+    static constexpr size_t SENSOR_SHARDS = 16;
+    std::array<SensorShard, SENSOR_SHARDS> sensor_shards_;
+    std::atomic<bool> sensor_sharing_enabled_{true};
+    std::atomic<uint64_t> sensor_shared_hits_{0};
+    std::atomic<uint64_t> sensor_evaluations_{0};
+    
+    // 不能共享（没有观察者位置或tick）时返回0
+    uint64_t sensor_key(const WorldView& world, SensorKind kind, uint32_t param) const;
+    template <typename Compute>
+    SensorValue sense(const WorldView& world, SensorKind kind, uint32_t param, Compute&& compute);
+    bool sensed_nearby_threats(const WorldView& world, const EnhancedEntityBehaviorData& config);
+    EnvironmentAdaptationResult sensed_environment_adaptation(const WorldView& world,
+                                                             const EnhancedEntityBehaviorData& config);
     
     // 决策逻辑
     EnvironmentAdaptationResult check_environment_adaptation(const WorldView& world,
@@ -435,9 +575,13 @@ private:
                                                        const EnhancedEntityBehaviorData& config) const;
     
     // 缓存键生成
-    std::string generate_decision_key(const WorldView& world,
-                                     const EnhancedEntityBehaviorData& config,
-                                     EntityState::BehaviorState current_state) const;
+    uint64_t generate_decision_key(const WorldView& world,
+                                  const EnhancedEntityBehaviorData& config,
+                                  EntityState::BehaviorState current_state) const;
+    bool lookup_decision_cache(uint64_t key, std::chrono::steady_clock::time_point now,
+                               EntityState::BehaviorState& decision) const;
+    void update_decision_cache(uint64_t key, EntityState::BehaviorState decision);
+    void update_stats(std::chrono::steady_clock::time_point start_time, bool cache_hit);
     
     // 1.21.10特殊行为处理
     EntityState::BehaviorState handle_warden_behaviors(const WorldView& world,
@@ -0,0 +1,418 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/io/anvil_format.hpp"
+#include "core/io/nbt_reader.hpp"
+#include "core/io/palette_codec.hpp"
+#include "core/io/region_file.hpp"
+#include "core/world/advanced_light_engine.hpp"
+
+// ===== 基准工具共用的世界读取 =====
+// lattice_light_bench与lattice_world_bench共用：按region文件头列出区块，通过AnvilChunkIO读取，
+// 把区块段的调色板解析为方块状态id，并按方块名估算光照属性上传给LightOpacityTable。
+
+namespace lattice {
+namespace bench {
+
+using io::anvil::AnvilChunkIO;
+using io::anvil::NBTReader;
+using io::anvil::NBTType;
+using io::anvil::RegionFile;
+using io::anvil::paletteBitsFor;
+using io::anvil::unpackPaletteIndices;
+using world::AdvancedLightEngine;
+using world::BlockLightProperties;
+using world::LightOpacityTable;
+
+// ===== 方块状态登记 =====
+// 调色板条目按"名称[属性]"字符串编号，编号即上传给LightOpacityTable的方块状态id
+
+inline bool contains(std::string_view text, std::string_view part) {
+    return text.find(part) != std::string_view::npos;
+}
+
+inline bool endsWith(std::string_view text, std::string_view suffix) {
+    return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// 按方块名近似原版BlockBehaviour.Properties的lightLevel与getLightBlock
+inline BlockLightProperties estimateProperties(std::string_view name, std::string_view properties) {
+    BlockLightProperties result;
+
+    static constexpr std::string_view TRANSPARENT[] = {
+        "air", "glass", "pane", "torch", "flower", "sapling", "short_grass", "tall_grass", "fern",
+        "bush", "button", "lever", "pressure_plate", "rail", "sign", "banner", "carpet", "snow",
+        "vine", "ladder", "door", "trapdoor", "fence", "wall", "bars", "chain", "lantern",
+        "redstone_wire", "repeater", "comparator", "tripwire", "string", "sugar_cane", "kelp",
+        "seagrass", "mushroom", "roots", "sprouts", "dripleaf", "lichen", "moss_carpet", "candle",
+        "head", "skull", "pot", "cobweb", "bell", "campfire", "end_rod", "dead_bush", "crop",
+        "wheat", "carrots", "potatoes", "beetroots", "stem", "berry", "cactus", "bamboo", "coral",
+        "pickle", "scaffolding", "hopper", "lightning_rod", "amethyst_bud", "amethyst_cluster",
+        "slab", "stairs", "fire", "portal", "frame", "pointed_dripstone", "barrier", "light",
+    };
+    bool transparent = false;
+    for (std::string_view token : TRANSPARENT) {
+        if (contains(name, token)) {
+            transparent = true;
+            break;
+        }
+    }
+    if (contains(name, "leaves") || name == "minecraft:water" || name == "minecraft:ice" ||
+        contains(name, "cobweb") || contains(name, "bubble_column")) {
+        result.opacity = 1;
+    } else if (transparent) {
+        result.opacity = 0;
+    }
+
+    // 台阶与楼梯：透光值为0，靠形状挡住上/下表面
+    if (endsWith(name, "_slab")) {
+        if (contains(properties, "type=double")) {
+            result.opacity = 15;
+        } else {
+            result.occludedFaces = contains(properties, "type=top") ? LightOpacityTable::FACE_UP
+                                                                    : LightOpacityTable::FACE_DOWN;
+        }
+    } else if (endsWith(name, "_stairs")) {
+        result.occludedFaces = contains(properties, "half=top") ? LightOpacityTable::FACE_UP
+                                                                : LightOpacityTable::FACE_DOWN;
+    }
+
+    static const std::unordered_map<std::string_view, uint8_t> EMISSION = {
+        {"minecraft:torch", 14}, {"minecraft:wall_torch", 14}, {"minecraft:lantern", 15},
+        {"minecraft:soul_torch", 10}, {"minecraft:soul_wall_torch", 10}, {"minecraft:soul_lantern", 10},
+        {"minecraft:glowstone", 15}, {"minecraft:sea_lantern", 15}, {"minecraft:shroomlight", 15},
+        {"minecraft:lava", 15}, {"minecraft:fire", 15}, {"minecraft:jack_o_lantern", 15},
+        {"minecraft:beacon", 15}, {"minecraft:end_rod", 14}, {"minecraft:magma_block", 3},
+        {"minecraft:ochre_froglight", 15}, {"minecraft:verdant_froglight", 15},
+        {"minecraft:pearlescent_froglight", 15}, {"minecraft:end_gateway", 15},
+        {"minecraft:nether_portal", 11}, {"minecraft:crying_obsidian", 10},
+        {"minecraft:glow_lichen", 7}, {"minecraft:amethyst_cluster", 5}, {"minecraft:brewing_stand", 1},
+    };
+    if (auto it = EMISSION.find(name); it != EMISSION.end()) {
+        result.emission = it->second;
+    } else if ((name == "minecraft:redstone_lamp" || name == "minecraft:furnace" ||
+                name == "minecraft:smoker" || name == "minecraft:blast_furnace" ||
+                endsWith(name, "campfire")) && contains(properties, "lit=true")) {
+        result.emission = endsWith(name, "lamp") || name == "minecraft:campfire" ? 15 : 13;
+    }
+    result.opacity &= 0x0F;
+    return result;
+}
+
+class StateRegistry {
+public:
+    explicit StateRegistry(std::unordered_map<std::string, BlockLightProperties> overrides)
+        : overrides_(std::move(overrides)) {}
+
+    uint16_t idFor(const std::string& key, std::string_view name, std::string_view properties) {
+        auto [it, inserted] = ids_.try_emplace(key, static_cast<uint16_t>(states_.size()));
+        if (inserted) {
+            keys_.push_back(key);
+            auto override = overrides_.find(key);
+            if (override == overrides_.end()) {
+                override = overrides_.find(std::string(name));
+            }
+            states_.push_back(override != overrides_.end() ? override->second
+                                                           : estimateProperties(name, properties));
+            if (states_.size() > UINT16_MAX) {
+                throw std::runtime_error("too many distinct block states");
+            }
+        }
+        return it->second;
+    }
+
+    // 新状态出现后重新上传（只在区块之间调用）
+    void upload() {
+        if (uploaded_ == states_.size()) {
+            return;
+        }
+        std::vector<uint8_t> packed(states_.size() * sizeof(BlockLightProperties));
+        for (size_t i = 0; i < states_.size(); ++i) {
+            packed[i * 4] = states_[i].opacity;
+            packed[i * 4 + 1] = states_[i].emission;
+            packed[i * 4 + 2] = states_[i].occludedFaces;
+            packed[i * 4 + 3] = states_[i].reserved;
+        }
+        LightOpacityTable::setBlockStateTable(packed.data(), states_.size());
+        uploaded_ = states_.size();
+    }
+
+    size_t size() const { return states_.size(); }
+
+    // 状态id对应的"名称[属性]"字符串
+    const std::string& key(uint16_t id) const { return keys_[id]; }
+
+private:
+    std::unordered_map<std::string, BlockLightProperties> overrides_;
+    std::unordered_map<std::string, uint16_t> ids_;
+    std::vector<std::string> keys_;                 // 下标为状态id
+    std::vector<BlockLightProperties> states_;
+    size_t uploaded_ = static_cast<size_t>(-1);
+};
+
+inline std::unordered_map<std::string, BlockLightProperties> loadStateFile(const std::string& path) {
+    std::unordered_map<std::string, BlockLightProperties> states;
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open state table " + path);
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string key;
+        int opacity = 15, emission = 0, faces = 0;
+        if (!(fields >> key >> opacity >> emission)) {
+            continue;
+        }
+        fields >> faces;
+        BlockLightProperties properties;
+        properties.opacity = static_cast<uint8_t>(opacity & 0x0F);
+        properties.emission = static_cast<uint8_t>(emission & 0x0F);
+        properties.occludedFaces = static_cast<uint8_t>(faces & 0x3F);
+        states[key] = properties;
+    }
+    return states;
+}
+
+// ===== 区块解析 =====
+
+struct LoadedSection {
+    int32_t sectionY = 0;
+    std::vector<uint16_t> states;            // 4096格，下标(y << 8) | (z << 4) | x
+    std::vector<uint8_t> skyLight;           // 原版保存的光照（可能为空）
+    std::vector<uint8_t> blockLight;
+};
+
+struct LoadedChunk {
+    int32_t chunkX = 0;
+    int32_t chunkZ = 0;
+    bool lightOn = false;
+    std::vector<LoadedSection> sections;     // 按sectionY升序
+};
+
+// 调色板条目 {Name, Properties{...}} -> 状态id
+inline uint16_t readPaletteEntry(NBTReader& reader, StateRegistry& registry) {
+    std::string name = "minecraft:air";
+    std::string properties;
+    NBTType type;
+    std::string_view tag;
+    while (reader.readTagHeader(type, tag) && type != NBTType::END) {
+        if (tag == "Name" && type == NBTType::STRING) {
+            name = std::string(reader.readString());
+        } else if (tag == "Properties" && type == NBTType::COMPOUND) {
+            // 属性按序列化顺序拼接（原版按属性名排序写入）
+            std::string_view key;
+            NBTType valueType;
+            while (reader.readTagHeader(valueType, key) && valueType != NBTType::END) {
+                if (valueType == NBTType::STRING) {
+                    properties += properties.empty() ? "" : ",";
+                    properties += key;
+                    properties += '=';
+                    properties += reader.readString();
+                } else {
+                    reader.skipPayload(valueType);
+                }
+            }
+        } else {
+            reader.skipPayload(type);
+        }
+    }
+    const std::string key = properties.empty() ? name : name + "[" + properties + "]";
+    return registry.idFor(key, name, properties);
+}
+
+inline void readBlockStates(NBTReader& reader, StateRegistry& registry, std::vector<uint16_t>& states) {
+    std::vector<uint16_t> palette;
+    std::vector<int64_t> data;
+    NBTType type;
+    std::string_view tag;
+    while (reader.readTagHeader(type, tag) && type != NBTType::END) {
+        if (tag == "palette" && type == NBTType::LIST) {
+            NBTType elementType;
+            int32_t length = 0;
+            if (reader.readListHeader(elementType, length) && elementType == NBTType::COMPOUND) {
+                for (int32_t i = 0; i < length && reader.ok(); ++i) {
+                    palette.push_back(readPaletteEntry(reader, registry));
+                }
+            } else {
+                for (int32_t i = 0; i < length && reader.ok(); ++i) {
+                    reader.skipPayload(elementType);
+                }
+            }
+        } else if (tag == "data" && type == NBTType::LONG_ARRAY) {
+            reader.readLongArray().copyTo(data);
+        } else {
+            reader.skipPayload(type);
+        }
+    }
+
+    states.assign(4096, palette.empty() ? registry.idFor("minecraft:air", "minecraft:air", "") : palette[0]);
+    if (palette.size() <= 1 || data.empty()) {
+        return;
+    }
+    // 1.16+的打包方式：每个值不跨long，位宽至少4
+    std::vector<uint16_t> indices(states.size());
+    if (!unpackPaletteIndices(data, paletteBitsFor(palette.size(), 4), indices)) {
+        return;
+    }
+    for (size_t i = 0; i < states.size(); ++i) {
+        states[i] = indices[i] < palette.size() ? palette[indices[i]] : palette[0];
+    }
+}
+
+inline bool parseChunk(const std::vector<uint8_t>& nbt, StateRegistry& registry, LoadedChunk& chunk) {
+    NBTReader reader(nbt);
+    if (!reader.enterRootCompound()) {
+        return false;
+    }
+    std::string status;
+    NBTType type;
+    std::string_view tag;
+    while (reader.readTagHeader(type, tag) && type != NBTType::END) {
+        if (tag == "isLightOn" && type == NBTType::BYTE) {
+            chunk.lightOn = reader.readByte() != 0;
+        } else if (tag == "Status" && type == NBTType::STRING) {
+            status = std::string(reader.readString());
+        } else if (tag == "sections" && type == NBTType::LIST) {
+            NBTType elementType;
+            int32_t length = 0;
+            if (!reader.readListHeader(elementType, length) || elementType != NBTType::COMPOUND) {
+                return false;
+            }
+            for (int32_t i = 0; i < length && reader.ok(); ++i) {
+                LoadedSection section;
+                NBTType fieldType;
+                std::string_view field;
+                while (reader.readTagHeader(fieldType, field) && fieldType != NBTType::END) {
+                    if (field == "Y" && fieldType == NBTType::BYTE) {
+                        section.sectionY = reader.readByte();
+                    } else if (field == "block_states" && fieldType == NBTType::COMPOUND) {
+                        readBlockStates(reader, registry, section.states);
+                    } else if (field == "SkyLight" && fieldType == NBTType::BYTE_ARRAY) {
+                        auto bytes = reader.readByteArray();
+                        section.skyLight.assign(bytes.begin(), bytes.end());
+                    } else if (field == "BlockLight" && fieldType == NBTType::BYTE_ARRAY) {
+                        auto bytes = reader.readByteArray();
+                        section.blockLight.assign(bytes.begin(), bytes.end());
+                    } else {
+                        reader.skipPayload(fieldType);
+                    }
+                }
+                chunk.sections.push_back(std::move(section));
+            }
+        } else {
+            reader.skipPayload(type);
+        }
+    }
+    std::sort(chunk.sections.begin(), chunk.sections.end(),
+              [](const LoadedSection& a, const LoadedSection& b) { return a.sectionY < b.sectionY; });
+    const bool full = status.empty() || status == "full" || status == "minecraft:full";
+    return reader.ok() && full && !chunk.sections.empty();
+}
+
+// 区块内存在的区块（region文件头）
+inline std::vector<std::pair<int32_t, int32_t>> listChunks(const std::string& worldPath, int worldId, size_t limit) {
+    namespace fs = std::filesystem;
+    std::vector<std::pair<int32_t, int32_t>> chunks;
+    fs::path regionDir = fs::path(worldPath) / (worldId != 0 ? "DIM" + std::to_string(worldId) : "") / "region";
+    std::error_code ec;
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(regionDir, ec)) {
+        if (entry.is_regular_file(ec) && entry.path().extension() == ".mca") {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto& path : files) {
+        // r.<x>.<z>.mca
+        int regionX = 0, regionZ = 0;
+        const std::string stem = path.stem().string();
+        const size_t first = stem.find('.');
+        const size_t second = stem.find('.', first + 1);
+        if (first == std::string::npos || second == std::string::npos ||
+            std::from_chars(stem.data() + first + 1, stem.data() + second, regionX).ec != std::errc() ||
+            std::from_chars(stem.data() + second + 1, stem.data() + stem.size(), regionZ).ec != std::errc()) {
+            continue;
+        }
+        RegionFile region(path.string(), false);
+        if (!region.isOpen()) {
+            continue;
+        }
+        for (int localZ = 0; localZ < 32; ++localZ) {
+            for (int localX = 0; localX < 32; ++localX) {
+                if (region.hasChunk(localX, localZ)) {
+                    chunks.emplace_back(regionX * 32 + localX, regionZ * 32 + localZ);
+                    if (chunks.size() >= limit) {
+                        return chunks;
+                    }
+                }
+            }
+        }
+    }
+    return chunks;
+}
+
+// 通过AnvilChunkIO读取并解析一个区块；nbt不为空时保留原始NBT（保存时原样写回）
+// 区块不存在或不是完整区块时返回false
+inline bool loadChunk(AnvilChunkIO& io, int worldId, int32_t chunkX, int32_t chunkZ, StateRegistry& registry,
+                      LoadedChunk& chunk, std::vector<uint8_t>* nbt = nullptr) {
+    auto payload = io.getChunkDataForJava(worldId, chunkX, chunkZ);
+    if (payload.size() < 2) {
+        return false;
+    }
+    // 第一个字节为压缩类型（NONE），其余为NBT
+    std::vector<uint8_t> data(payload.begin() + 1, payload.end());
+    chunk.chunkX = chunkX;
+    chunk.chunkZ = chunkZ;
+    if (!parseChunk(data, registry, chunk)) {
+        return false;
+    }
+    if (nbt) {
+        *nbt = std::move(data);
+    }
+    return true;
+}
+
+// 区块列的方块状态（minY起的连续层），供initializeChunkSkylight使用
+inline std::vector<uint16_t> columnStates(const LoadedChunk& chunk, uint16_t air, int32_t& minY, int32_t& height) {
+    const int32_t minSection = chunk.sections.front().sectionY;
+    const int32_t maxSection = chunk.sections.back().sectionY;
+    minY = minSection << 4;
+    height = (maxSection - minSection + 1) << 4;
+    std::vector<uint16_t> column(static_cast<size_t>(height) << 8, air);
+    for (const auto& section : chunk.sections) {
+        if (section.states.size() == 4096) {
+            std::copy(section.states.begin(), section.states.end(),
+                      column.begin() + (static_cast<size_t>(section.sectionY - minSection) << 12));
+        }
+    }
+    return column;
+}
+
+// 处理到队列为空（或达到上限），返回tick数
+inline int settle(AdvancedLightEngine& engine, int maxTicks) {
+    int ticks = 0;
+    while (ticks < maxTicks && engine.hasUpdates()) {
+        engine.tick();
+        ++ticks;
+    }
+    return ticks;
+}
+
+} // namespace bench
+} // namespace lattice
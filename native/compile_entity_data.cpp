@@ -0,0 +1,34 @@
+#include <iostream>
+#include <string>
+
+#include "entity/biological_ai.hpp"
+
+using namespace lattice::entity;
+
+// ===== 实体行为数据预编译工具 =====
+// 用法: lattice_compile_entity_data <minecraft-data目录> <游戏版本>...
+// 解析data/pc/<版本>/entities.json，在其旁边写出entities.lebd（DataModule加载时优先读取）
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " <minecraft-data-path> <version>..." << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    DataModule dataModule(argv[1]);
+    for (int i = 2; i < argc; ++i) {
+        if (!dataModule.compileEntityBlob(argv[i])) {
+            std::cerr << "Failed to compile entity data for " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
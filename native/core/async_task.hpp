@@ -0,0 +1,333 @@
+#pragma once
+
+#include "native_runtime.hpp"
+#include "threadpool.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdio>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lattice {
+namespace core {
+
+// ====== 协程任务 ======
+
+template <class T = void>
+class AsyncTask;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+    bool detached = false;
+
+    // 结束时直接转到等待者（对称转移，不增加栈深度）；分离的任务在这里销毁自己
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <class Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            TaskPromiseBase& promise = handle.promise();
+            if (promise.detached) {
+                if (promise.error) {
+                    try {
+                        std::rethrow_exception(promise.error);
+                    } catch (const std::exception& e) {
+                        fprintf(stderr, "Detached task failed: %s\n", e.what());
+                    } catch (...) {
+                        fprintf(stderr, "Detached task failed with unknown exception\n");
+                    }
+                }
+                handle.destroy();
+                return std::noop_coroutine();
+            }
+            return promise.continuation;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <class T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    AsyncTask<T> get_return_object() noexcept;
+
+    template <class U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    AsyncTask<void> get_return_object() noexcept;
+
+    void return_void() const noexcept {}
+
+    void take() const {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief 惰性协程任务
+ *
+ * 创建后不执行，被co_await时才开始，结束后直接恢复等待它的协程。
+ * 异常在co_await处重新抛出。不需要结果时用spawn()分离执行，需要阻塞等待时用syncWait()。
+ * 协程在哪个线程上继续由它等待的对象决定：schedule()转到线程池，SerialExecutor::schedule()
+ * 转到拥有者线程（如tick线程），awaitCallback()在回调到来后把后续部分投递到指定线程池。
+ */
+template <class T>
+class [[nodiscard]] AsyncTask {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    AsyncTask() = default;
+    explicit AsyncTask(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    AsyncTask(AsyncTask&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    AsyncTask& operator=(AsyncTask&& other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    ~AsyncTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return false; }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                handle.promise().continuation = caller;
+                return handle;
+            }
+
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{handle_};
+    }
+
+    // 交出协程句柄（spawn使用）
+    std::coroutine_handle<promise_type> release() noexcept {
+        return std::exchange(handle_, nullptr);
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace detail {
+
+template <class T>
+AsyncTask<T> TaskPromise<T>::get_return_object() noexcept {
+    return AsyncTask<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline AsyncTask<void> TaskPromise<void>::get_return_object() noexcept {
+    return AsyncTask<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+} // namespace detail
+
+// 在当前线程开始执行任务，不等待结果；任务结束时自行释放，未捕获的异常输出到stderr
+inline void spawn(AsyncTask<void> task) {
+    auto handle = task.release();
+    if (!handle) {
+        return;
+    }
+    handle.promise().detached = true;
+    handle.resume();
+}
+
+namespace detail {
+
+template <class T>
+struct SyncWaitState {
+    std::atomic<bool> done{false};
+    std::optional<std::conditional_t<std::is_void_v<T>, bool, T>> value;
+    std::exception_ptr error;
+};
+
+template <class T>
+AsyncTask<void> syncWaitBody(AsyncTask<T> task, SyncWaitState<T>* state) {
+    try {
+        if constexpr (std::is_void_v<T>) {
+            co_await std::move(task);
+            state->value.emplace(true);
+        } else {
+            state->value.emplace(co_await std::move(task));
+        }
+    } catch (...) {
+        state->error = std::current_exception();
+    }
+    // 之后不再访问state：等待方被唤醒后即可销毁它
+    state->done.store(true, std::memory_order_release);
+    state->done.notify_all();
+}
+
+} // namespace detail
+
+/**
+ * 阻塞当前线程直到任务结束并返回结果
+ * 不能在任务最终要恢复到的线程上调用（例如在tick线程上等待一个需要回到tick线程的任务）
+ */
+template <class T>
+T syncWait(AsyncTask<T> task) {
+    detail::SyncWaitState<T> state;
+    spawn(detail::syncWaitBody(std::move(task), &state));
+    state.done.wait(false, std::memory_order_acquire);
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*state.value);
+    }
+}
+
+// ====== 执行位置 ======
+
+// co_await schedule(pool)：把协程的后续部分交给线程池执行
+inline auto schedule(ThreadPool& pool, TaskPriority priority = TaskPriority::NORMAL) {
+    struct Awaiter {
+        ThreadPool& pool;
+        TaskPriority priority;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool.submit([handle] { handle.resume(); }, priority);
+        }
+        void await_resume() const noexcept {}
+    };
+    return Awaiter{pool, priority};
+}
+
+// 在NativeRuntime的共享线程池上继续
+inline auto schedule(TaskPriority priority = TaskPriority::NORMAL) {
+    return schedule(NativeRuntime::instance().pool(), priority);
+}
+
+/**
+ * @brief 由拥有者线程排空的恢复队列
+ *
+ * co_await executor.schedule()挂起协程，直到拥有者线程（如tick线程）调用drain()时在该线程上恢复，
+ * 用于只能在特定线程执行的步骤（光照载入、世界修改等）。schedule可以在任意线程调用。
+ */
+class SerialExecutor {
+public:
+    auto schedule() {
+        struct Awaiter {
+            SerialExecutor& executor;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard<std::mutex> lock(executor.mutex_);
+                executor.pending_.push_back(handle);
+            }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    // 恢复目前排队的协程，返回恢复的数量；恢复过程中新排队的留到下一次
+    size_t drain() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_.swap(pending_);
+        }
+        const size_t count = running_.size();
+        for (std::coroutine_handle<> handle : running_) {
+            handle.resume();
+        }
+        running_.clear();
+        return count;
+    }
+
+    size_t pendingCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_.size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::coroutine_handle<>> pending_;
+    std::vector<std::coroutine_handle<>> running_;      // 只在drain()中使用
+};
+
+// ====== 回调接口适配 ======
+
+/**
+ * co_await awaitCallback<Result>(pool, start)：调用start(resume)发起回调式操作，
+ * 回调以resume(result)交回结果，协程随后在pool上继续，而不是在回调所在的线程（I/O完成线程、压缩线程）上。
+ *
+ * resume只保存一个指针，装进std::function时落在其内联存储中，不额外分配；
+ * 回调可以在start内同步调用。resume必须恰好调用一次。
+ */
+template <class Result, class Start>
+auto awaitCallback(ThreadPool& pool, Start&& start, TaskPriority priority = TaskPriority::HIGH) {
+    struct Awaiter {
+        ThreadPool& pool;
+        Start start;
+        TaskPriority priority;
+        std::optional<Result> result;
+        std::coroutine_handle<> handle;
+
+        struct Resume {
+            Awaiter* awaiter;
+            void operator()(Result value) const {
+                awaiter->result.emplace(std::move(value));
+                awaiter->pool.submit([handle = awaiter->handle] { handle.resume(); }, awaiter->priority);
+            }
+        };
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            // 回调可能在start返回之前就已恢复协程，这里之后不能再访问成员
+            start(Resume{this});
+        }
+        Result await_resume() { return std::move(*result); }
+    };
+    return Awaiter{pool, std::forward<Start>(start), priority, std::nullopt, {}};
+}
+
+} // namespace core
+} // namespace lattice
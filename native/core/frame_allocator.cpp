@@ -0,0 +1,246 @@
+#include "frame_allocator.hpp"
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <new>
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+constexpr uint64_t NO_FRAME = ~uint64_t{0};
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+/**
+ * 一个线程的两块arena；除pins外的字段只由拥有者线程访问
+ */
+struct FrameAllocator::ThreadArena {
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    struct Large {
+        void* ptr;
+        size_t size;
+        size_t alignment;
+    };
+
+    struct Buffer {
+        uint64_t frame = NO_FRAME;       // 这块arena当前属于的帧
+        std::vector<Block> blocks;
+        size_t current = 0;              // 正在切分的块
+        size_t offset = 0;
+        std::vector<Large> large;
+    };
+
+    Buffer buffers[2];
+    uint32_t pins = 0;                   // 嵌套的FrameScope数
+    uint64_t pinnedFrame = 0;
+};
+
+namespace {
+
+thread_local FrameAllocator::ThreadArena* tlsArena = nullptr;
+thread_local bool tlsExiting = false;
+
+} // namespace
+
+struct FrameAllocator::ArenaHandle {
+    ThreadArena* arena = nullptr;
+
+    ~ArenaHandle() {
+        if (arena) {
+            tlsArena = nullptr;
+            tlsExiting = true;
+            FrameAllocator::instance().abandonArena(arena);
+        }
+    }
+};
+
+FrameAllocator& FrameAllocator::instance() {
+    // 不析构：静态对象析构期间仍可能有帧容器在使用
+    static FrameAllocator* allocator = new FrameAllocator();
+    return *allocator;
+}
+
+FrameAllocator::FrameAllocator() {
+    auto& registry = MetricsRegistry::instance();
+    registry.addCallback(MetricType::GAUGE, "lattice_frame_allocator_reserved_bytes",
+                         "Bytes held by per-thread frame arenas", {},
+                         [this] { return static_cast<double>(reservedBytes_.load(std::memory_order_relaxed)); });
+    registry.addCallback(MetricType::COUNTER, "lattice_frame_allocator_block_allocations_total",
+                         "Frame arena blocks requested from the system allocator", {},
+                         [this] { return static_cast<double>(blockAllocations_.load(std::memory_order_relaxed)); });
+    registry.addCallback(MetricType::COUNTER, "lattice_frame_allocator_fallbacks_total",
+                         "Frame containers created on the heap because ticks were not reported", {},
+                         [this] { return static_cast<double>(fallbacks_.load(std::memory_order_relaxed)); });
+}
+
+int64_t FrameAllocator::nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FrameAllocator::advanceFrame() {
+    frame_.fetch_add(1, std::memory_order_relaxed);
+    lastAdvance_.store(nowNanos(), std::memory_order_relaxed);
+}
+
+bool FrameAllocator::active() const {
+    const int64_t last = lastAdvance_.load(std::memory_order_relaxed);
+    return last != 0 && nowNanos() - last <= REPORT_TIMEOUT_NANOS;
+}
+
+std::pmr::memory_resource* FrameAllocator::resource() {
+    if (active()) {
+        return &resource_;
+    }
+    fallbacks_.fetch_add(1, std::memory_order_relaxed);
+    return std::pmr::new_delete_resource();
+}
+
+void* FrameAllocator::FrameResource::do_allocate(size_t bytes, size_t alignment) {
+    return FrameAllocator::instance().allocate(bytes, alignment);
+}
+
+void* FrameAllocator::allocate(size_t bytes, size_t alignment) {
+    if (ThreadArena* arena = currentArena()) {
+        return allocateFrom(*arena, bytes, alignment);
+    }
+    return allocateExiting(bytes, alignment);
+}
+
+FrameAllocator::ThreadArena* FrameAllocator::currentArena() {
+    if (tlsArena) {
+        return tlsArena;
+    }
+    return tlsExiting ? nullptr : acquireArena();
+}
+
+FrameAllocator::ThreadArena* FrameAllocator::acquireArena() {
+    ThreadArena* arena = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!abandoned_.empty()) {
+            arena = abandoned_.back();
+            abandoned_.pop_back();
+        }
+    }
+    if (!arena) {
+        arena = new ThreadArena();
+        arenas_.fetch_add(1, std::memory_order_relaxed);
+    }
+    thread_local ArenaHandle handle;
+    handle.arena = arena;
+    tlsArena = arena;
+    return arena;
+}
+
+// 在退出的线程上调用：arena连同其中的帧原样交出，接手的线程按帧号照常退回
+void FrameAllocator::abandonArena(ThreadArena* arena) {
+    arena->pins = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    abandoned_.push_back(arena);
+}
+
+void* FrameAllocator::allocateExiting(size_t bytes, size_t alignment) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!exitingArena_) {
+        exitingArena_ = new ThreadArena();
+        arenas_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return allocateFrom(*exitingArena_, bytes, alignment);
+}
+
+void* FrameAllocator::allocateFrom(ThreadArena& arena, size_t bytes, size_t alignment) {
+    const uint64_t frame = arena.pins != 0 ? arena.pinnedFrame : frame_.load(std::memory_order_relaxed);
+    ThreadArena::Buffer& buffer = arena.buffers[frame & 1];
+    if (buffer.frame != frame) {
+        // 两个tick前的分配到期：整体退回，保留不超过MAX_RETAINED_BYTES的块
+        for (const ThreadArena::Large& large : buffer.large) {
+            systemRelease(large.ptr, large.size, large.alignment);
+        }
+        buffer.large.clear();
+        const size_t retained = std::min(buffer.blocks.size(), MAX_RETAINED_BYTES / BLOCK_SIZE);
+        for (size_t i = retained; i < buffer.blocks.size(); ++i) {
+            systemRelease(buffer.blocks[i].data, buffer.blocks[i].size, MAX_ALIGNMENT);
+        }
+        buffer.blocks.resize(retained);
+        buffer.current = 0;
+        buffer.offset = 0;
+        buffer.frame = frame;
+    }
+
+    bytes = std::max<size_t>(bytes, 1);
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    if (bytes > BLOCK_SIZE / 2 || alignment > MAX_ALIGNMENT) {
+        buffer.large.reserve(buffer.large.size() + 1);
+        void* ptr = systemAllocate(bytes, alignment, true);
+        buffer.large.push_back({ptr, bytes, alignment});
+        return ptr;
+    }
+
+    while (buffer.current < buffer.blocks.size()) {
+        const ThreadArena::Block& block = buffer.blocks[buffer.current];
+        const size_t start = alignUp(buffer.offset, alignment);
+        if (start + bytes <= block.size) {
+            buffer.offset = start + bytes;
+            return block.data + start;
+        }
+        ++buffer.current;
+        buffer.offset = 0;
+    }
+
+    buffer.blocks.reserve(buffer.blocks.size() + 1);
+    char* data = static_cast<char*>(systemAllocate(BLOCK_SIZE, MAX_ALIGNMENT, false));
+    buffer.blocks.push_back({data, BLOCK_SIZE});
+    buffer.current = buffer.blocks.size() - 1;
+    buffer.offset = bytes;
+    return data;
+}
+
+void* FrameAllocator::systemAllocate(size_t bytes, size_t alignment, bool large) {
+    void* ptr = ::operator new(bytes, std::align_val_t{alignment});
+    (large ? largeAllocations_ : blockAllocations_).fetch_add(1, std::memory_order_relaxed);
+    reservedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    return ptr;
+}
+
+void FrameAllocator::systemRelease(void* ptr, size_t bytes, size_t alignment) noexcept {
+    ::operator delete(ptr, bytes, std::align_val_t{alignment});
+    reservedBytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+FrameAllocator::Stats FrameAllocator::getStats() const {
+    Stats stats;
+    stats.frames = frame_.load(std::memory_order_relaxed);
+    stats.fallbacks = fallbacks_.load(std::memory_order_relaxed);
+    stats.blockAllocations = blockAllocations_.load(std::memory_order_relaxed);
+    stats.largeAllocations = largeAllocations_.load(std::memory_order_relaxed);
+    stats.reservedBytes = reservedBytes_.load(std::memory_order_relaxed);
+    stats.arenas = arenas_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+FrameScope::FrameScope() : arena_(FrameAllocator::instance().currentArena()) {
+    if (arena_ && arena_->pins++ == 0) {
+        arena_->pinnedFrame = FrameAllocator::instance().frame();
+    }
+}
+
+FrameScope::~FrameScope() {
+    if (arena_ && arena_->pins != 0) {
+        --arena_->pins;
+    }
+}
+
+} // namespace core
+} // namespace lattice
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace lattice {
+namespace core {
+
+// ====== 每tick的帧分配器 ======
+//
+// 可见实体查询、红石受影响组件、同步更新编码这类路径每个tick都要分配一批只活到本tick的临时vector，
+// 高峰时malloc/free的抖动直接反映在tick耗时上。这里给每个线程两块轮换的arena：
+// 第N个tick的分配来自arena[N & 1]，tick开始时不释放任何东西，某个线程在新tick第一次分配时
+// 才把两个tick前用过的那块整体退回（保留块，不归还系统）。
+//
+// 帧由Java在tick开始时推进（与NativeTickBudget.tickStarted一起上报），
+// 与TickBudget相同，每个桥接库各有一份FrameAllocator。
+
+/**
+ * @brief 本库的帧分配器（进程内每个桥接库一份）
+ *
+ * 生命周期：第N个tick中分配的内存一直有效到第N+1个tick结束（第N+2个tick开始后不再有效），
+ * 因此帧内存只用于局部临时数据，不要放进跨tick保存的结构。
+ *
+ * - 分配只访问本线程的arena，不加锁、没有原子操作；释放什么都不做，内存随帧整体退回
+ * - 线程退出时arena交给之后新建的线程继续使用（与SlabAllocator的线程堆相同），帧的时效照旧
+ * - Java未上报或超过一秒没有推进帧时，resource()返回new_delete_resource：
+ *   没有tick边界就无法退回，帧内存只会增长，此时退化为普通分配
+ * - 大于BLOCK_SIZE / 2的请求单独申请，随所在的帧一起释放
+ *
+ * 线程被抢占或tick追赶时，一次查询可能跨过两个tick边界；查询入口用FrameScope固定帧，
+ * 作用域内的分配都落在进入时的那块arena上，不会在中途被退回。
+ */
+class FrameAllocator {
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_ALIGNMENT = 64;                     // 更大的对齐单独申请
+    static constexpr size_t MAX_RETAINED_BYTES = 4 * 1024 * 1024;   // 每块arena退回后保留的块总大小
+    static constexpr int64_t REPORT_TIMEOUT_NANOS = 1'000'000'000;
+
+    static FrameAllocator& instance();
+
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    // 主线程在每个tick开始时调用
+    void advanceFrame();
+    uint64_t frame() const { return frame_.load(std::memory_order_relaxed); }
+
+    // 帧在按tick推进（最近一秒内推进过）
+    bool active() const;
+
+    /**
+     * 本tick临时容器使用的内存资源：帧在推进时为帧资源，否则为new_delete_resource
+     * 容器在构造时取定资源，之后的扩容与释放都走同一个资源
+     */
+    std::pmr::memory_resource* resource();
+
+    // 从当前线程的帧arena分配（不检查active）；失败时抛出std::bad_alloc
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t fallbacks = 0;             // resource()因为帧未推进返回new_delete_resource的次数
+        uint64_t blockAllocations = 0;      // 向系统申请块的次数（稳定后应不再增长）
+        uint64_t largeAllocations = 0;      // 单独申请的大块
+        size_t reservedBytes = 0;           // 所有arena持有的块
+        size_t arenas = 0;                  // 创建过的线程arena（含线程已退出、等待接手的）
+    };
+    Stats getStats() const;
+
+    struct ThreadArena;
+
+private:
+    FrameAllocator();
+
+    class FrameResource : public std::pmr::memory_resource {
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    };
+
+    struct ArenaHandle;
+    friend struct ArenaHandle;
+    friend class FrameScope;
+
+    static int64_t nowNanos();
+
+    // 当前线程的arena（必要时接手或创建）；线程局部对象析构期间返回nullptr
+    ThreadArena* currentArena();
+    ThreadArena* acquireArena();
+    void abandonArena(ThreadArena* arena);
+    void* allocateFrom(ThreadArena& arena, size_t bytes, size_t alignment);
+    void* allocateExiting(size_t bytes, size_t alignment);
+    void* systemAllocate(size_t bytes, size_t alignment, bool large);
+    void systemRelease(void* ptr, size_t bytes, size_t alignment) noexcept;
+
+    FrameResource resource_;
+    std::atomic<uint64_t> frame_{0};
+    std::atomic<int64_t> lastAdvance_{0};      // 0表示从未推进
+
+    mutable std::mutex mutex_;                 // 只保护arena的登记，不在分配路径上
+    std::vector<ThreadArena*> abandoned_;
+    ThreadArena* exitingArena_ = nullptr;      // 线程局部对象析构期间的分配，在mutex_下使用
+
+    std::atomic<uint64_t> fallbacks_{0};
+    std::atomic<uint64_t> blockAllocations_{0};
+    std::atomic<uint64_t> largeAllocations_{0};
+    std::atomic<size_t> reservedBytes_{0};
+    std::atomic<size_t> arenas_{0};
+};
+
+/**
+ * @brief RAII：作用域内当前线程的帧分配固定在进入时的帧上
+ *
+ * 可以嵌套，必须在创建它的线程上析构。作用域内创建的帧容器应在作用域结束前销毁或拷出。
+ */
+class FrameScope {
+public:
+    FrameScope();
+    ~FrameScope();
+
+    FrameScope(const FrameScope&) = delete;
+    FrameScope& operator=(const FrameScope&) = delete;
+
+private:
+    FrameAllocator::ThreadArena* arena_;
+};
+
+// 本tick的临时vector：FrameVector<int> ids = makeFrameVector<int>();
+template <typename T>
+using FrameVector = std::pmr::vector<T>;
+
+template <typename T>
+FrameVector<T> makeFrameVector(size_t reserve = 0) {
+    FrameVector<T> vector(FrameAllocator::instance().resource());
+    if (reserve != 0) {
+        vector.reserve(reserve);
+    }
+    return vector;
+}
+
+} // namespace core
+} // namespace lattice
@@ -1,84 +1,99 @@
 #include "anvil_format.hpp"
-#include <libdeflate.h>
+#include "chunk_codecs.hpp"
+#include "zstd_dictionary.hpp"
+#include "io_metrics.hpp"
+#include "../metrics.hpp"
+#include "nbt_reader.hpp"
+#include "nbt_writer.hpp"
+#include <unistd.h>
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <stdexcept>
 
 namespace lattice {
 namespace io {
 namespace anvil {
 
+namespace {
+
+uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count();
+}
+
+} // namespace
+
 // ===== Minecraft压缩算法实现 =====
 
 std::vector<uint8_t> MinecraftCompressor::compressData(const std::vector<uint8_t>& data, 
-                                                       CompressionType type) {
-    if (data.size() < MIN_COMPRESSION_SIZE) {
+                                                       CompressionType type,
+                                                       const ZstdDictionary* dictionary) {
+    return compressData(data.data(), data.size(), type, dictionary);
+}
+
+std::vector<uint8_t> MinecraftCompressor::compressData(const uint8_t* data, size_t size,
+                                                       CompressionType type,
+                                                       const ZstdDictionary* dictionary) {
+    std::vector<uint8_t> result;
+    
+    auto storeUncompressed = [&]() {
+        result.resize(size + 1);
+        result[0] = static_cast<uint8_t>(CompressionType::NONE);
+        if (size > 0) {
+            std::memcpy(result.data() + 1, data, size);
+        }
+    };
+    
+    if (size < MIN_COMPRESSION_SIZE) {
         // 小数据不压缩，直接返回
-        std::vector<uint8_t> result;
-        result.reserve(data.size() + 1);
-        result.push_back(static_cast<uint8_t>(CompressionType::NONE));
-        result.insert(result.end(), data.begin(), data.end());
+        storeUncompressed();
         return result;
     }
     
-    std::vector<uint8_t> result;
-    result.reserve(data.size() + 1024); // 预分配空间
+    // 类型字节之后直接追加压缩结果，不经过临时缓冲区
+    result.push_back(static_cast<uint8_t>(type));
+    bool compressed = false;
     
     switch (type) {
-        case CompressionType::NONE: {
-            result.push_back(static_cast<uint8_t>(CompressionType::NONE));
-            result.insert(result.end(), data.begin(), data.end());
+        case CompressionType::ZLIB:
+            compressed = codec::deflateCompress(codec::DeflateFormat::ZLIB, data, size, DEFLATE_LEVEL, result);
             break;
-        }
         case CompressionType::GZIP:
-        case CompressionType::ZLIB: {
-            // 使用libdeflate压缩（比zlib更快）
-            // libdeflate使用DEFLATE算法，与Minecraft原生格式兼容
-            struct libdeflate_compressor* compressor = libdeflate_alloc_compressor(6); // 压缩级别6
-            
-            if (compressor) {
-                size_t compressed_size;
-                std::vector<uint8_t> compressed(data.size() + 1024); // 预分配空间
-                
-                compressed_size = libdeflate_deflate_compress(compressor, 
-                                                             data.data(), data.size(),
-                                                             compressed.data(), compressed.size());
-                
-                if (compressed_size > 0) {
-                    // 成功压缩
-                    result.push_back(static_cast<uint8_t>(CompressionType::ZLIB));
-                    result.insert(result.end(), compressed.data(), compressed.data() + compressed_size);
-                } else {
-                    // 压缩失败，返回未压缩数据
-                    result.push_back(static_cast<uint8_t>(CompressionType::NONE));
-                    result.insert(result.end(), data.begin(), data.end());
-                }
-                
-                libdeflate_free_compressor(compressor);
-            } else {
-                // 无法创建压缩器，返回未压缩数据
-                result.push_back(static_cast<uint8_t>(CompressionType::NONE));
-                result.insert(result.end(), data.begin(), data.end());
-            }
+            compressed = codec::deflateCompress(codec::DeflateFormat::GZIP, data, size, DEFLATE_LEVEL, result);
             break;
-        }
-        default: {
-            // 不支持的压缩类型，返回未压缩数据
-            result.push_back(static_cast<uint8_t>(CompressionType::NONE));
-            result.insert(result.end(), data.begin(), data.end());
+        case CompressionType::LZ4:
+            compressed = codec::lz4Compress(data, size, result);
+            break;
+        case CompressionType::ZSTD: {
+            // 与region自定义压缩格式一致：负载以算法名开头
+            result.push_back(static_cast<uint8_t>(ZSTD_CUSTOM_NAME.size() >> 8));
+            result.push_back(static_cast<uint8_t>(ZSTD_CUSTOM_NAME.size() & 0xFF));
+            result.insert(result.end(), ZSTD_CUSTOM_NAME.begin(), ZSTD_CUSTOM_NAME.end());
+            compressed = codec::zstdCompress(data, size, ZSTD_LEVEL, result, dictionary);
             break;
         }
+        default:
+            break;
+    }
+    
+    if (!compressed) {
+        // 压缩失败或不支持的压缩类型，返回未压缩数据
+        storeUncompressed();
     }
     
     return result;
 }
 
 std::vector<uint8_t> MinecraftCompressor::decompressData(const std::vector<uint8_t>& compressedData,
-                                                         CompressionType type) {
+                                                         CompressionType type,
+                                                         const ZstdDictionary* dictionary) {
     if (compressedData.empty()) {
         return {};
     }
@@ -88,66 +103,47 @@ std::vector<uint8_t> MinecraftCompressor::decompressData(const std::vector<uint8
         type = detectedType; // 使用检测到的类型
     }
     
+    // 跳过类型字节
+    return decompressPayload(type, compressedData.data() + 1, compressedData.size() - 1, dictionary);
+}
+
+std::vector<uint8_t> MinecraftCompressor::decompressPayload(CompressionType type, const uint8_t* data, size_t dataSize,
+                                                            const ZstdDictionary* dictionary) {
+    std::vector<uint8_t> result;
+    
     switch (type) {
-        case CompressionType::NONE: {
-            // 无压缩，直接返回（跳过类型字节）
-            return std::vector<uint8_t>(compressedData.begin() + 1, compressedData.end());
-        }
+        case CompressionType::NONE:
+            return std::vector<uint8_t>(data, data + dataSize);
+        case CompressionType::ZLIB:
+            // 旧版本写入的是裸DEFLATE流，zlib解码失败时回退
+            if (codec::deflateDecompress(codec::DeflateFormat::ZLIB, data, dataSize, result) ||
+                codec::deflateDecompress(codec::DeflateFormat::RAW, data, dataSize, result)) {
+                return result;
+            }
+            return {};
         case CompressionType::GZIP:
-        case CompressionType::ZLIB: {
-            // 跳过类型字节进行解压缩
-            const uint8_t* data = compressedData.data() + 1;
-            size_t dataSize = compressedData.size() - 1;
-            
-            // 使用libdeflate进行解压缩
-            struct libdeflate_decompressor* decompressor = libdeflate_alloc_decompressor();
-            
-            if (decompressor) {
-                size_t decompressed_size;
-                std::vector<uint8_t> result(dataSize * 2); // 初始猜测大小
-                
-                // libdeflate_deflate_decompress会返回实际需要的缓冲区大小
-                libdeflate_result res = libdeflate_deflate_decompress(decompressor,
-                                                                     data, dataSize,
-                                                                     result.data(), result.size(),
-                                                                     &decompressed_size);
-                
-                if (res == LIBDEFLATE_SUCCESS) {
-                    result.resize(decompressed_size);
-                    libdeflate_free_decompressor(decompressor);
-                    return result;
-                } else if (res == LIBDEFLATE_INSUFFICIENT_SPACE) {
-                    // 缓冲区太小，重新分配
-                    libdeflate_free_decompressor(decompressor);
-                    decompressor = libdeflate_alloc_decompressor();
-                    
-                    if (decompressor) {
-                        result.resize(decompressed_size);
-                        res = libdeflate_deflate_decompress(decompressor,
-                                                            data, dataSize,
-                                                            result.data(), result.size(),
-                                                            &decompressed_size);
-                        
-                        if (res == LIBDEFLATE_SUCCESS) {
-                            result.resize(decompressed_size);
-                            libdeflate_free_decompressor(decompressor);
-                            return result;
-                        }
-                    }
-                }
-                
-                if (decompressor) {
-                    libdeflate_free_decompressor(decompressor);
-                }
+            if (codec::deflateDecompress(codec::DeflateFormat::GZIP, data, dataSize, result)) {
+                return result;
+            }
+            return {};
+        case CompressionType::LZ4:
+            if (codec::lz4Decompress(data, dataSize, result)) {
+                return result;
+            }
+            return {};
+        case CompressionType::ZSTD: {
+            const size_t nameSize = 2 + ZSTD_CUSTOM_NAME.size();
+            if (fromRegionRecord(REGION_COMPRESSION_CUSTOM, data, dataSize) != CompressionType::ZSTD) {
+                return {};
+            }
+            if (codec::zstdDecompress(data + nameSize, dataSize - nameSize, result, dictionary)) {
+                return result;
             }
-            
-            // 所有解压尝试都失败，返回空数据
             return {};
         }
-        default: {
+        default:
             // 不支持的压缩类型
             return {};
-        }
     }
 }
 
@@ -161,12 +157,30 @@ MinecraftCompressor::CompressionType MinecraftCompressor::detectCompressionType(
         case CompressionType::NONE:
         case CompressionType::ZLIB:
         case CompressionType::GZIP:
+        case CompressionType::CUSTOM:
+        case CompressionType::LZ4:
+        case CompressionType::ZSTD:
             return static_cast<CompressionType>(typeByte);
         default:
             return CompressionType::ZLIB; // 默认假设是ZLIB
     }
 }
 
+bool MinecraftCompressor::isSupported(CompressionType type) {
+    switch (type) {
+        case CompressionType::NONE:
+        case CompressionType::ZLIB:
+        case CompressionType::GZIP:
+            return true;
+        case CompressionType::LZ4:
+            return codec::lz4Available();
+        case CompressionType::ZSTD:
+            return codec::zstdAvailable();
+        default:
+            return false;
+    }
+}
+
 void MinecraftCompressor::compressBatch(std::vector<std::shared_ptr<AnvilChunkData>>& chunks,
                                        CompressionType type) {
     for (auto& chunk : chunks) {
@@ -212,6 +226,110 @@ void MinecraftCompressor::decompressBatch(std::vector<std::shared_ptr<AnvilChunk
     }
 }
 
+uint8_t MinecraftCompressor::toRegionCompressionId(CompressionType type) {
+    switch (type) {
+        case CompressionType::GZIP: return REGION_COMPRESSION_GZIP;
+        case CompressionType::ZLIB: return REGION_COMPRESSION_ZLIB;
+        case CompressionType::NONE: return REGION_COMPRESSION_NONE;
+        case CompressionType::LZ4:  return REGION_COMPRESSION_LZ4;
+        case CompressionType::ZSTD: return REGION_COMPRESSION_CUSTOM;
+        default:                    return REGION_COMPRESSION_ZLIB;
+    }
+}
+
+MinecraftCompressor::CompressionType MinecraftCompressor::fromRegionCompressionId(uint8_t regionId) {
+    // 最高位表示数据存放在外部.mcc文件中，这里只关心压缩方案
+    switch (regionId & 0x7F) {
+        case REGION_COMPRESSION_GZIP: return CompressionType::GZIP;
+        case REGION_COMPRESSION_ZLIB: return CompressionType::ZLIB;
+        case REGION_COMPRESSION_NONE: return CompressionType::NONE;
+        case REGION_COMPRESSION_LZ4:  return CompressionType::LZ4;
+        default:                      return CompressionType::CUSTOM;
+    }
+}
+
+MinecraftCompressor::CompressionType MinecraftCompressor::fromRegionRecord(uint8_t regionId,
+                                                                           const uint8_t* payload, size_t size) {
+    if ((regionId & 0x7F) != REGION_COMPRESSION_CUSTOM) {
+        return fromRegionCompressionId(regionId);
+    }
+    
+    // 自定义压缩：负载以2字节大端长度 + 算法名开头
+    if (size < 2) {
+        return CompressionType::CUSTOM;
+    }
+    size_t nameLength = (static_cast<size_t>(payload[0]) << 8) | payload[1];
+    if (size < 2 + nameLength) {
+        return CompressionType::CUSTOM;
+    }
+    
+    std::string_view name(reinterpret_cast<const char*>(payload + 2), nameLength);
+    return name == ZSTD_CUSTOM_NAME ? CompressionType::ZSTD : CompressionType::CUSTOM;
+}
+
+MinecraftCompressor::RecordIntegrity MinecraftCompressor::verifyRecord(uint8_t regionId, const uint8_t* payload,
+                                                                      size_t size, const ZstdDictionary* dictionary) {
+    if ((regionId & 0x80) != 0) {
+        return RecordIntegrity::UNSUPPORTED;
+    }
+    if (size == 0) {
+        return RecordIntegrity::CORRUPT;
+    }
+    
+    // 解压输出只用于结构检查，缓冲区按线程复用
+    thread_local std::vector<uint8_t> scratch;
+    scratch.clear();
+    bool decoded = false;
+    switch (regionId) {
+        case REGION_COMPRESSION_NONE:
+            return payload[0] == static_cast<uint8_t>(NBTType::COMPOUND) && payload[size - 1] == 0
+                ? RecordIntegrity::OK : RecordIntegrity::CORRUPT;
+        case REGION_COMPRESSION_ZLIB:
+            // zlib头：CM=8且(CMF << 8 | FLG)能被31整除；旧版本Lattice写入的裸DEFLATE流没有校验和
+            if (size >= 2 && (payload[0] & 0x0F) == 8 && ((payload[0] << 8) | payload[1]) % 31 == 0) {
+                decoded = codec::deflateDecompress(codec::DeflateFormat::ZLIB, payload, size, scratch);
+            } else {
+                decoded = codec::deflateDecompress(codec::DeflateFormat::RAW, payload, size, scratch);
+            }
+            break;
+        case REGION_COMPRESSION_GZIP:
+            if (size < 18 || payload[0] != 0x1F || payload[1] != 0x8B || payload[2] != 8) {
+                return RecordIntegrity::CORRUPT;
+            }
+            decoded = codec::deflateDecompress(codec::DeflateFormat::GZIP, payload, size, scratch);
+            break;
+        case REGION_COMPRESSION_LZ4:
+            if (!codec::lz4Available()) {
+                return RecordIntegrity::UNSUPPORTED;
+            }
+            decoded = codec::lz4Decompress(payload, size, scratch);
+            break;
+        case REGION_COMPRESSION_CUSTOM: {
+            if (fromRegionRecord(regionId, payload, size) != CompressionType::ZSTD || !codec::zstdAvailable()) {
+                return RecordIntegrity::UNSUPPORTED;
+            }
+            const size_t nameSize = 2 + ZSTD_CUSTOM_NAME.size();
+            // 用没有加载的字典写入的帧无法判断好坏，不能当作损坏处理
+            const uint32_t frameDictId = codec::zstdFrameDictionaryId(payload + nameSize, size - nameSize);
+            if (frameDictId != 0 && (!dictionary || !dictionary->forId(frameDictId))) {
+                return RecordIntegrity::UNSUPPORTED;
+            }
+            decoded = codec::zstdDecompress(payload + nameSize, size - nameSize, scratch, dictionary);
+            break;
+        }
+        default:
+            return RecordIntegrity::CORRUPT;
+    }
+    
+    const bool valid = decoded && scratch.size() >= 3 &&
+                       scratch.front() == static_cast<uint8_t>(NBTType::COMPOUND) && scratch.back() == 0;
+    // 偶发的超大区块不让缓冲区一直占着
+    if (scratch.capacity() > 16 * 1024 * 1024) {
+        std::vector<uint8_t>().swap(scratch);
+    }
+    return valid ? RecordIntegrity::OK : RecordIntegrity::CORRUPT;
+}
+
 // ===== Minecraft 1.21.10兼容方法实现 =====
 
 bool NBTSerializer::isNBTFormatCompatible(const std::vector<uint8_t>& nbtData) {
@@ -229,14 +347,13 @@ bool NBTSerializer::isNBTFormatCompatible(const std::vector<uint8_t>& nbtData) {
     
     // 检查是否为压缩数据
     auto detectedType = MinecraftCompressor::detectCompressionType(nbtData);
-    if (detectedType == MinecraftCompressor::CompressionType::ZLIB ||
-        detectedType == MinecraftCompressor::CompressionType::GZIP) {
+    if (detectedType != MinecraftCompressor::CompressionType::NONE &&
+        MinecraftCompressor::isSupported(detectedType)) {
         
-        // 解压缩后检查NBT格式
-        auto decompressed = MinecraftCompressor::decompressData(nbtData, detectedType);
-        if (!decompressed.empty() && decompressed[0] == static_cast<uint8_t>(NBTType::COMPOUND)) {
-            return true;
-        }
+        // 只校验并检查结构，不保留解压结果
+        return MinecraftCompressor::verifyRecord(MinecraftCompressor::toRegionCompressionId(detectedType),
+                                                 nbtData.data() + 1, nbtData.size() - 1) ==
+               MinecraftCompressor::RecordIntegrity::OK;
     }
     
     return false;
@@ -290,77 +407,178 @@ const std::vector<int>& NBTSerializer::getSupportedMinecraftVersions() {
 // ===== NBT序列化器实现 =====
 
 std::vector<uint8_t> NBTSerializer::serializeChunkToNBT(const AnvilChunkData& chunk) {
-    std::vector<uint8_t> buffer;
-    buffer.reserve(4096); // 预分配
-    
+    NBTWriter writer(estimateSerializedSize(chunk));
+    serializeChunkToNBT(chunk, writer);
+    auto view = writer.finish();
+    return std::vector<uint8_t>(view.begin(), view.end());
+}
+
+void NBTSerializer::serializeChunkToNBT(const AnvilChunkData& chunk, NBTWriter& writer) {
     // 写入根复合标签
-    writeNBTHeader(buffer, NBTType::COMPOUND, ""); // 根标签无名称
+    writer.writeTagHeader(NBTType::COMPOUND, ""); // 根标签无名称
     
     // Level数据复合标签
-    writeNBTHeader(buffer, NBTType::COMPOUND, "Level");
+    writer.writeTagHeader(NBTType::COMPOUND, "Level");
     
     // xPos: int (区块的X坐标起始位置)
-    writeNBTHeader(buffer, NBTType::INT, "xPos");
-    writeNBTInt(buffer, chunk.x * 16);
+    writer.writeTagHeader(NBTType::INT, "xPos");
+    writer.writeInt(chunk.x * 16);
     
     // zPos: int (区块的Z坐标起始位置)  
-    writeNBTHeader(buffer, NBTType::INT, "zPos");
-    writeNBTInt(buffer, chunk.z * 16);
+    writer.writeTagHeader(NBTType::INT, "zPos");
+    writer.writeInt(chunk.z * 16);
     
     // LastModified: long (最后修改时间)
-    writeNBTHeader(buffer, NBTType::LONG, "LastModified");
-    writeNBTLong(buffer, chunk.lastModified);
+    writer.writeTagHeader(NBTType::LONG, "LastModified");
+    writer.writeLong(chunk.lastModified);
     
     // Status: string (区块状态)
-    writeNBTHeader(buffer, NBTType::STRING, "Status");
-    writeNBTString(buffer, "full");
+    writer.writeTagHeader(NBTType::STRING, "Status");
+    writer.writeString("full");
+    
+    // Light: byte_array (光照数据，16x16x1 = 256字节)
+    writer.writeTagHeader(NBTType::BYTE_ARRAY, "Light");
+    writer.writeByteArrayFilled(256, 0);
     
-    // Light: byte_array (光照数据)
-    writeNBTHeader(buffer, NBTType::BYTE_ARRAY, "Light");
-    std::vector<uint8_t> lightData(256, 0); // 16x16x1 = 256字节
-    writeNBTByteArray(buffer, lightData);
+    // SkyLight: byte_array (天空光照默认15)
+    writer.writeTagHeader(NBTType::BYTE_ARRAY, "SkyLight");
+    writer.writeByteArrayFilled(256, 15);
     
-    // SkyLight: byte_array (天空光照)
-    writeNBTHeader(buffer, NBTType::BYTE_ARRAY, "SkyLight");
-    std::vector<uint8_t> skyLightData(256, 15); // 天空光照默认15
-    writeNBTByteArray(buffer, skyLightData);
+    // BlockLight: byte_array (方块光照默认0)
+    writer.writeTagHeader(NBTType::BYTE_ARRAY, "BlockLight");
+    writer.writeByteArrayFilled(256, 0);
     
-    // BlockLight: byte_array (方块光照)
-    writeNBTHeader(buffer, NBTType::BYTE_ARRAY, "BlockLight");
-    std::vector<uint8_t> blockLightData(256, 0); // 方块光照默认0
-    writeNBTByteArray(buffer, blockLightData);
+    // isLightOn: byte (光照可信，加载时无需重新计算)
+    writer.writeTagHeader(NBTType::BYTE, "isLightOn");
+    writer.writeByte(chunk.lightTrusted ? 1 : 0);
+    
+    // sections: list<compound> (段光照：Y + SkyLight/BlockLight nibble数组，缺失的数组不写)
+    if (!chunk.lightSections.empty()) {
+        writer.writeTagHeader(NBTType::LIST, "sections");
+        writer.writeByte(static_cast<int8_t>(NBTType::COMPOUND));
+        writer.writeInt(static_cast<int32_t>(chunk.lightSections.size()));
+        for (const auto& section : chunk.lightSections) {
+            writer.writeTagHeader(NBTType::BYTE, "Y");
+            writer.writeByte(static_cast<int8_t>(section.sectionY));
+            if (!section.skyLight.empty()) {
+                writer.writeTagHeader(NBTType::BYTE_ARRAY, "SkyLight");
+                writer.writeByteArray(section.skyLight);
+            }
+            if (!section.blockLight.empty()) {
+                writer.writeTagHeader(NBTType::BYTE_ARRAY, "BlockLight");
+                writer.writeByteArray(section.blockLight);
+            }
+            writer.writeEnd();
+        }
+    }
     
     // InhabitedTime: long (居住时间)
-    writeNBTHeader(buffer, NBTType::LONG, "InhabitedTime");
-    writeNBTLong(buffer, 0);
+    writer.writeTagHeader(NBTType::LONG, "InhabitedTime");
+    writer.writeLong(0);
     
-    // 生物群系数据 (简化版本)
-    writeNBTHeader(buffer, NBTType::BYTE_ARRAY, "Biomes");
-    std::vector<uint8_t> biomesData(256, 1); // 简单的草地群系
-    writeNBTByteArray(buffer, biomesData);
+    // 生物群系数据 (简化版本，草地群系)
+    writer.writeTagHeader(NBTType::BYTE_ARRAY, "Biomes");
+    writer.writeByteArrayFilled(256, 1);
     
     // 写入区块数据（压缩）
-    writeNBTHeader(buffer, NBTType::BYTE_ARRAY, "Data");
-    writeNBTByteArray(buffer, chunk.data);
+    writer.writeTagHeader(NBTType::BYTE_ARRAY, "Data");
+    writer.writeByteArray(chunk.data);
     
-    // 结束根复合标签
-    buffer.push_back(static_cast<uint8_t>(NBTType::END));
+    // 结束Level复合标签和根复合标签
+    writer.writeEnd();
+    writer.writeEnd();
     
-    return buffer;
+    SerializedSizeHistory::global().record(chunk.worldId, chunk.x, chunk.z, writer.size());
+}
+
+size_t NBTSerializer::estimateSerializedSize(const AnvilChunkData& chunk) {
+    // 固定字段约1.2KB（光照/生物群系数组 + 标签头），其余为Data负载与段光照
+    constexpr size_t FIXED_FIELDS_SIZE = 1280;
+    constexpr size_t SECTION_TAGS_SIZE = 48;
+    size_t lightSize = 0;
+    for (const auto& section : chunk.lightSections) {
+        lightSize += section.skyLight.size() + section.blockLight.size() + SECTION_TAGS_SIZE;
+    }
+    return SerializedSizeHistory::global().estimate(chunk.worldId, chunk.x, chunk.z,
+                                                    chunk.data.size() + lightSize + FIXED_FIELDS_SIZE);
 }
 
 AnvilChunkData NBTSerializer::deserializeChunkFromNBT(const std::vector<uint8_t>& nbtData,
                                                       int worldId, int x, int z) {
     AnvilChunkData chunk(x, z, worldId);
+    const auto parseStart = std::chrono::steady_clock::now();
+    
+    // 流式解析serializeChunkToNBT写入的Level结构，只物化Data负载，其余标签跳过
+    NBTReader reader(nbtData);
+    NBTType type;
+    bool parsed = false;
+    if (reader.enterRootCompound() && reader.findInCompound("Level", type) && type == NBTType::COMPOUND) {
+        std::string_view name;
+        while (reader.readTagHeader(type, name) && type != NBTType::END) {
+            if (name == "LastModified" && type == NBTType::LONG) {
+                chunk.lastModified = static_cast<uint32_t>(reader.readLong());
+            } else if (name == "Data" && type == NBTType::BYTE_ARRAY) {
+                auto payload = reader.readByteArray();
+                chunk.data.assign(payload.begin(), payload.end());
+                parsed = true;
+            } else if (name == "isLightOn" && type == NBTType::BYTE) {
+                chunk.lightTrusted = reader.readByte() != 0;
+            } else if (name == "sections" && type == NBTType::LIST) {
+                readLightSections(reader, chunk.lightSections);
+            } else {
+                reader.skipPayload(type);
+            }
+        }
+        parsed = parsed && reader.ok();
+    }
     
-    // 简化版本：直接使用原始数据
-    // 实际实现需要完整的NBT解析器
-    chunk.data = nbtData;
-    chunk.lastModified = static_cast<uint32_t>(std::time(nullptr));
+    if (!parsed) {
+        // 非Level结构的数据按原样保留（其中的光照不可信）
+        chunk.lightSections.clear();
+        chunk.lightTrusted = false;
+        chunk.data = nbtData;
+        chunk.lastModified = static_cast<uint32_t>(std::time(nullptr));
+    }
     
+    IOMetrics::recordStage(IOStage::NBT_PARSE, microsSince(parseStart));
     return chunk;
 }
 
+void NBTSerializer::readLightSections(NBTReader& reader, std::vector<ChunkLightSection>& sections) {
+    NBTType elementType = NBTType::END;
+    int32_t length = 0;
+    if (!reader.readListHeader(elementType, length) || elementType != NBTType::COMPOUND) {
+        for (int32_t i = 0; reader.ok() && i < length; i++) {
+            reader.skipPayload(elementType);
+        }
+        return;
+    }
+    
+    sections.reserve(static_cast<size_t>(std::max(length, 0)));
+    for (int32_t i = 0; reader.ok() && i < length; i++) {
+        ChunkLightSection section;
+        NBTType type;
+        std::string_view name;
+        while (reader.readTagHeader(type, name) && type != NBTType::END) {
+            if (name == "Y" && type == NBTType::BYTE) {
+                section.sectionY = reader.readByte();
+            } else if ((name == "SkyLight" || name == "BlockLight") && type == NBTType::BYTE_ARRAY) {
+                auto payload = reader.readByteArray();
+                auto& target = name == "SkyLight" ? section.skyLight : section.blockLight;
+                target.assign(payload.begin(), payload.end());
+            } else {
+                reader.skipPayload(type);
+            }
+        }
+        if (!section.skyLight.empty() || !section.blockLight.empty()) {
+            sections.push_back(std::move(section));
+        }
+    }
+    if (!reader.ok()) {
+        sections.clear();
+    }
+}
+
 std::vector<std::vector<uint8_t>> NBTSerializer::batchSerializeToNBT(
     const std::vector<std::shared_ptr<AnvilChunkData>>& chunks) {
     std::vector<std::vector<uint8_t>> results;
@@ -375,6 +593,28 @@ std::vector<std::vector<uint8_t>> NBTSerializer::batchSerializeToNBT(
     return results;
 }
 
+NBTSerializer::SerializedBatch NBTSerializer::batchSerializeToNBT(
+    const std::vector<std::shared_ptr<AnvilChunkData>>& chunks,
+    lattice::net::MemoryArena& arena) {
+    SerializedBatch batch;
+    batch.views.reserve(chunks.size());
+    
+    for (const auto& chunk : chunks) {
+        if (!chunk) continue;
+        
+        NBTWriter writer(arena, estimateSerializedSize(*chunk));
+        serializeChunkToNBT(*chunk, writer);
+        batch.views.push_back(writer.finish());
+        
+        // arena耗尽时writer已退回堆内存，接管其所有权保证视图有效
+        if (auto heap = writer.releaseHeapStorage()) {
+            batch.spilled.push_back(std::move(heap));
+        }
+    }
+    
+    return batch;
+}
+
 AnvilChunkData NBTSerializer::deserializeChunkFromJavaBytes(const std::vector<uint8_t>& javaBytes,
                                                            int worldId, int x, int z) {
     AnvilChunkData chunk(x, z, worldId);
@@ -390,7 +630,8 @@ std::vector<uint8_t> NBTSerializer::serializeChunkToJavaBytes(const AnvilChunkDa
 
 void NBTSerializer::writeNBTHeader(std::vector<uint8_t>& buffer, NBTType type, const std::string& name) {
     buffer.push_back(static_cast<uint8_t>(type));
-    if (!name.empty()) {
+    // 除END外的标签都带名称长度（根标签的空名称也要写入0长度）
+    if (type != NBTType::END) {
         uint16_t nameLength = static_cast<uint16_t>(name.length());
         buffer.push_back(static_cast<uint8_t>((nameLength >> 8) & 0xFF));
         buffer.push_back(static_cast<uint8_t>(nameLength & 0xFF));
@@ -487,10 +728,43 @@ std::string createAnvilFilePath(const std::string& worldPath, int worldId, int r
 
 AnvilChunkIO::AnvilChunkIO(const std::string& worldPath) 
     : worldPath_(worldPath) {
+    reloadZstdDictionary();
+    recoverJournal();
+    registerMetrics();
 }
 
 AnvilChunkIO::~AnvilChunkIO() {
-    // 清理资源
+    for (const uint64_t id : metricCallbacks_) {
+        core::MetricsRegistry::instance().removeCallback(id);
+    }
+    // 正常关闭时做最后一次检查点，下次启动无需重放
+    try {
+        setJournalEnabled(false);
+    } catch (const std::exception&) {
+        // 日志保留在磁盘上，下次启动时重放
+    }
+}
+
+void AnvilChunkIO::registerMetrics() {
+    auto& registry = core::MetricsRegistry::instance();
+    const core::MetricLabels world{{"world", worldPath_}};
+    auto withResult = [&](const char* value) {
+        core::MetricLabels labels = world;
+        labels.emplace_back("result", value);
+        return labels;
+    };
+    metricCallbacks_.push_back(registry.addCallback(
+        core::MetricType::COUNTER, "lattice_chunk_cache_requests_total", "Hot chunk cache lookups by result",
+        withResult("hit"), [this] { return static_cast<double>(chunkCache_.getStats().hits); }));
+    metricCallbacks_.push_back(registry.addCallback(
+        core::MetricType::COUNTER, "lattice_chunk_cache_requests_total", "Hot chunk cache lookups by result",
+        withResult("miss"), [this] { return static_cast<double>(chunkCache_.getStats().misses); }));
+    metricCallbacks_.push_back(registry.addCallback(
+        core::MetricType::COUNTER, "lattice_chunk_cache_evictions_total", "Hot chunk cache evictions",
+        world, [this] { return static_cast<double>(chunkCache_.getStats().evictions); }));
+    metricCallbacks_.push_back(registry.addCallback(
+        core::MetricType::GAUGE, "lattice_chunk_cache_bytes", "Decompressed chunk payload bytes held by the hot cache",
+        world, [this] { return static_cast<double>(chunkCache_.getStats().bytes); }));
 }
 
 void AnvilChunkIO::loadChunkAsync(int worldId, int chunkX, int chunkZ,
@@ -506,31 +780,27 @@ void AnvilChunkIO::loadChunkAsync(int worldId, int chunkX, int chunkZ,
             return;
         }
         
-        // 计算region坐标
-        int regionX, regionZ, localX, localZ;
-        getRegionCoordinates(chunkX, chunkZ, regionX, regionZ, localX, localZ);
-        
-        // 构建region文件路径
-        std::string regionPath = createAnvilFilePath(worldPath_, worldId, regionX, regionZ);
-        
-        // 读取区块数据
-        auto chunk = readChunkFromRegion(regionPath, localX, localZ);
-        if (chunk) {
-            result.success = true;
-            // 转换为通用ChunkData格式
-            result.chunk.x = chunk->x;
-            result.chunk.z = chunk->z;
-            result.chunk.worldId = worldId;
-            result.chunk.lastModified = chunk->lastModified;
-            result.chunk.data = std::vector<char>(chunk->data.begin(), chunk->data.end());
-            
-            // 更新统计
-            stats_.totalAnvilLoads++;
-        } else {
+        HotChunkCache::Entry cached;
+        if (!acquireChunkPayload(worldId, chunkX, chunkZ, cached)) {
             result.success = false;
             result.errorMessage = "Chunk not found";
+            callback(result);
+            return;
         }
         
+        result.success = true;
+        // 转换为通用ChunkData格式（NONE类型记录）
+        result.chunk.x = chunkX;
+        result.chunk.z = chunkZ;
+        result.chunk.worldId = worldId;
+        result.chunk.lastModified = cached.lastModified;
+        result.chunk.data.reserve(cached.payload->size() + 1);
+        result.chunk.data.push_back(static_cast<char>(MinecraftCompressor::CompressionType::NONE));
+        result.chunk.data.insert(result.chunk.data.end(), cached.payload->begin(), cached.payload->end());
+        
+        // 更新统计
+        stats_.totalAnvilLoads++;
+        
     } catch (const std::exception& e) {
         result.success = false;
         result.errorMessage = e.what();
@@ -539,75 +809,362 @@ void AnvilChunkIO::loadChunkAsync(int worldId, int chunkX, int chunkZ,
     callback(result);
 }
 
+core::AsyncTask<std::optional<AnvilChunkData>> AnvilChunkIO::loadChunkData(int worldId, int chunkX, int chunkZ,
+                                                                           core::TaskPriority priority) {
+    co_await core::schedule(priority);
+    if (!isValidChunkCoordinates(chunkX, chunkZ)) {
+        co_return std::nullopt;
+    }
+    HotChunkCache::Entry cached;
+    if (!acquireChunkPayload(worldId, chunkX, chunkZ, cached)) {
+        co_return std::nullopt;
+    }
+    stats_.totalAnvilLoads++;
+    co_return NBTSerializer::deserializeChunkFromNBT(*cached.payload, worldId, chunkX, chunkZ);
+}
+
+bool AnvilChunkIO::acquireChunkPayload(int worldId, int chunkX, int chunkZ, HotChunkCache::Entry& entry) {
+    // 计算region坐标
+    int regionX, regionZ, localX, localZ;
+    getRegionCoordinates(chunkX, chunkZ, regionX, regionZ, localX, localZ);
+    
+    // 先查热缓存，命中时不读盘也不解压
+    const uint64_t cacheKey = HotChunkCache::packKey(worldId, chunkX, chunkZ);
+    if (chunkCache_.get(cacheKey, entry)) {
+        return true;
+    }
+    // 读盘期间区块被保存时，保存路径已放入新内容，读到的旧内容不能再覆盖它
+    const uint32_t cacheGeneration = chunkCache_.generation(cacheKey);
+    
+    // 构建region文件路径
+    std::string regionPath = createAnvilFilePath(worldPath_, worldId, regionX, regionZ);
+    
+    std::vector<uint8_t> nbt;
+    uint32_t lastModified = 0;
+    bool found = false;
+    
+    if (readOnlyMapped_.load()) {
+        // 直接从映射扇区解压，没有pread和中间拷贝
+        found = inflateMappedChunk(regionPath, localX, localZ, nbt, lastModified);
+    } else {
+        const auto readStart = std::chrono::steady_clock::now();
+        auto chunk = readChunkFromRegion(regionPath, localX, localZ);
+        IOMetrics::recordStage(IOStage::DISK_READ, microsSince(readStart));
+        if (chunk) {
+            const auto inflateStart = std::chrono::steady_clock::now();
+            nbt = decompressChunk(chunk->data);
+            IOMetrics::recordStage(IOStage::INFLATE, microsSince(inflateStart));
+            lastModified = chunk->lastModified;
+            found = true;
+        }
+    }
+    
+    if (!found) {
+        return false;
+    }
+    if (nbt.empty()) {
+        throw std::runtime_error("Failed to decompress chunk");
+    }
+    entry.payload = std::make_shared<const std::vector<uint8_t>>(std::move(nbt));
+    entry.lastModified = lastModified;
+    chunkCache_.putIfCurrent(cacheKey, entry.payload, entry.lastModified, cacheGeneration);
+    return true;
+}
+
 void AnvilChunkIO::saveChunkAsync(const AnvilChunkData& chunk,
                                  std::function<void(AsyncIOResult)> callback) {
     AsyncIOResult result;
     
+    // 只对未压缩NBT计算指纹；已压缩的记录总是写入
+    const bool rawNbt = !chunk.data.empty() && chunk.data[0] == static_cast<uint8_t>(NBTType::COMPOUND);
+    const bool trackContent = rawNbt && skipUnchangedSaves_.load();
+    
     try {
-        // 计算region坐标
-        int regionX, regionZ, localX, localZ;
-        getRegionCoordinates(chunk.x, chunk.z, regionX, regionZ, localX, localZ);
-        
-        // 构建region文件路径
-        std::string regionPath = createAnvilFilePath(worldPath_, chunk.worldId, regionX, regionZ);
-        
-        // 写入区块数据
-        writeChunkToRegion(regionPath, chunk, localX, localZ);
+        if (trackContent && sectionCache_.isUnchanged(chunk.worldId, chunk.x, chunk.z,
+                                                      chunk.data.data(), chunk.data.size())) {
+            result.success = true;
+            callback(result);
+            return;
+        }
         
+        persistChunk(chunk);
+        if (trackContent) {
+            sectionCache_.recordFullSave(chunk.worldId, chunk.x, chunk.z, chunk.data.data(), chunk.data.size());
+        }
         result.success = true;
         
-        // 更新统计
-        stats_.totalAnvilSaves++;
+    } catch (const std::exception& e) {
+        sectionCache_.forget(chunk.worldId, chunk.x, chunk.z);
+        result.success = false;
+        result.errorMessage = e.what();
+    }
+    
+    callback(result);
+}
+
+SectionSaveCache::DeltaResult AnvilChunkIO::saveChunkDelta(const ChunkDelta& delta,
+                                                          std::function<void(AsyncIOResult)> callback) {
+    AsyncIOResult result;
+    auto outcome = SectionSaveCache::DeltaResult::NEEDS_FULL;
+    
+    try {
+        std::vector<uint8_t> nbt;
+        outcome = sectionCache_.applyDelta(delta, nbt);
+        
+        if (outcome == SectionSaveCache::DeltaResult::ASSEMBLED) {
+            AnvilChunkData chunk(delta.chunkX, delta.chunkZ, delta.worldId);
+            if (delta.timestamp != 0) {
+                chunk.lastModified = delta.timestamp;
+            }
+            chunk.data = std::move(nbt);
+            persistChunk(chunk);
+            result.success = true;
+        } else if (outcome == SectionSaveCache::DeltaResult::UNCHANGED) {
+            result.success = true;
+        } else {
+            result.success = false;
+            result.errorMessage = "Full chunk save required";
+        }
         
     } catch (const std::exception& e) {
+        // 基线可能已包含未写入的段，丢弃后下次需要完整提交
+        sectionCache_.forget(delta.worldId, delta.chunkX, delta.chunkZ);
+        outcome = SectionSaveCache::DeltaResult::NEEDS_FULL;
         result.success = false;
         result.errorMessage = e.what();
     }
     
     callback(result);
+    return outcome;
+}
+
+void AnvilChunkIO::persistChunk(const AnvilChunkData& chunk) {
+    // 计算region坐标
+    int regionX, regionZ, localX, localZ;
+    getRegionCoordinates(chunk.x, chunk.z, regionX, regionZ, localX, localZ);
+    
+    // 构建region文件路径
+    std::string regionPath = createAnvilFilePath(worldPath_, chunk.worldId, regionX, regionZ);
+    
+    // 写入区块数据
+    writeChunkToRegion(regionPath, chunk, localX, localZ);
+    updateCacheAfterWrite(chunk);
+    checkpointJournalIfNeeded();
+    
+    // 更新统计
+    stats_.totalAnvilSaves++;
 }
 
 void AnvilChunkIO::saveChunksBatch(const std::vector<std::shared_ptr<AnvilChunkData>>& chunks,
                                   std::function<void(std::vector<AsyncIOResult>)> callback) {
-    std::vector<AsyncIOResult> results;
-    results.reserve(chunks.size());
+    if (readOnlyMapped_.load()) {
+        std::vector<AsyncIOResult> results;
+        for (const auto& chunk : chunks) {
+            if (!chunk) continue;
+            AsyncIOResult result;
+            result.success = false;
+            result.errorMessage = "World is opened read-only";
+            results.push_back(std::move(result));
+        }
+        callback(std::move(results));
+        return;
+    }
     
-    // 按region分组以优化I/O
-    std::unordered_map<std::string, std::vector<std::pair<int, std::shared_ptr<AnvilChunkData>>>> regionMap;
+    std::vector<SavePipeline::Job> jobs;
+    jobs.reserve(chunks.size());
+    size_t resultCount = 0;
+    const bool skipUnchanged = skipUnchangedSaves_.load();
+    
+    auto isRawNbt = [](const AnvilChunkData& chunk) {
+        return !chunk.data.empty() && chunk.data[0] == static_cast<uint8_t>(NBTType::COMPOUND);
+    };
     
     for (const auto& chunk : chunks) {
         if (!chunk) continue;
+        const size_t index = resultCount++;
         
-        int regionX, regionZ, localX, localZ;
-        getRegionCoordinates(chunk->x, chunk->z, regionX, regionZ, localX, localZ);
-        std::string regionPath = createAnvilFilePath(worldPath_, chunk->worldId, regionX, regionZ);
+        // 内容与上次保存相同的区块不进入流水线，直接报告成功
+        if (skipUnchanged && isRawNbt(*chunk) &&
+            sectionCache_.isUnchanged(chunk->worldId, chunk->x, chunk->z, chunk->data.data(), chunk->data.size())) {
+            continue;
+        }
         
-        regionMap[regionPath].push_back({localZ * REGION_SIZE + localX, chunk});
+        SavePipeline::Job job;
+        job.index = index;
+        job.chunk = chunk;
+        int regionX, regionZ;
+        getRegionCoordinates(chunk->x, chunk->z, regionX, regionZ, job.localX, job.localZ);
+        job.regionPath = createAnvilFilePath(worldPath_, chunk->worldId, regionX, regionZ);
+        jobs.push_back(std::move(job));
+    }
+    
+    SavePipeline::Stages stages;
+    
+    // 序列化阶段：Java侧传入的已是NBT（COMPOUND开头）或已压缩的记录，这里只做校验
+    stages.serialize = [](SavePipeline::Job& job) {
+        if (job.chunk->data.empty()) {
+            throw std::runtime_error("Empty chunk data");
+        }
+    };
+    
+    // 压缩阶段：未压缩NBT按原版格式压缩；已压缩记录原样通过
+    const auto compressionType = compressionType_.load();
+    auto dictionary = getZstdDictionary();
+    stages.compress = [compressionType, dictionary](SavePipeline::Job& job) {
+        const auto& source = job.nbt.empty() ? job.chunk->data : job.nbt;
+        if (source[0] == static_cast<uint8_t>(NBTType::COMPOUND)) {
+            job.framed = MinecraftCompressor::compressData(source.data(), source.size(), compressionType,
+                                                           dictionary.get());
+        }
+    };
+    
+    // 启用日志时写入阶段只追加日志记录，整批组提交一次后再写入region
+    std::shared_lock<std::shared_mutex> journalLock(journalMutex_);
+    ChunkJournal* journal = journal_.get();
+    
+    if (journal) {
+        stages.write = [journal](SavePipeline::Job& job) {
+            const auto& framed = job.framed.empty() ? job.chunk->data : job.framed;
+            journal->append(job.chunk->worldId, job.chunk->x, job.chunk->z, job.chunk->lastModified,
+                            framed.data(), framed.size());
+        };
+    } else {
+        // 写入阶段：按region分片，单线程写同一region文件
+        stages.write = [this](SavePipeline::Job& job) {
+            const auto& framed = job.framed.empty() ? job.chunk->data : job.framed;
+            writeFramedToRegion(job.regionPath, framed.data(), framed.size(),
+                                job.localX, job.localZ, job.chunk->lastModified);
+            updateCacheAfterWrite(*job.chunk);
+        };
     }
     
-    // 为每个region执行批量写入
-    for (auto& [regionPath, regionChunks] : regionMap) {
-        // 按localIndex排序以优化写入
-        std::sort(regionChunks.begin(), regionChunks.end(),
-                 [](const auto& a, const auto& b) { return a.first < b.first; });
+    SavePipeline::StageStats pipelineStats = savePipeline()->run(jobs, stages);
+    
+    if (journal) {
+        std::string syncError;
+        try {
+            journal->sync();
+        } catch (const std::exception& e) {
+            syncError = e.what();
+        }
         
-        // 这里简化处理，实际实现需要处理region文件的写入
-        for (auto& [localIndex, chunk] : regionChunks) {
-            AsyncIOResult result;
+        // 日志已落盘，region写入无需再sync；同一region的记录仍按批次顺序写入
+        for (auto& job : jobs) {
+            if (job.failed) continue;
+            if (!syncError.empty()) {
+                job.failed = true;
+                job.errorMessage = syncError;
+                pipelineStats.failed++;
+                continue;
+            }
             try {
-                int localX = localIndex % REGION_SIZE;
-                int localZ = localIndex / REGION_SIZE;
-                writeChunkToRegion(regionPath, *chunk, localX, localZ);
-                result.success = true;
+                const auto& framed = job.framed.empty() ? job.chunk->data : job.framed;
+                writeFramedToRegion(job.regionPath, framed.data(), framed.size(),
+                                    job.localX, job.localZ, job.chunk->lastModified);
+                updateCacheAfterWrite(*job.chunk);
+                std::lock_guard<std::mutex> lock(journalDirtyMutex_);
+                journalDirtyRegions_.insert(job.regionPath);
             } catch (const std::exception& e) {
-                result.success = false;
-                result.errorMessage = e.what();
+                job.failed = true;
+                job.errorMessage = e.what();
+                pipelineStats.failed++;
             }
-            results.push_back(result);
         }
     }
+    journalLock.unlock();
+    checkpointJournalIfNeeded();
     
-    callback(results);
+    std::vector<AsyncIOResult> results(resultCount);
+    for (auto& result : results) {
+        result.success = true;
+    }
+    for (auto& job : jobs) {
+        const AnvilChunkData& chunk = *job.chunk;
+        if (job.failed) {
+            sectionCache_.forget(chunk.worldId, chunk.x, chunk.z);
+        } else if (skipUnchanged && isRawNbt(chunk)) {
+            sectionCache_.recordFullSave(chunk.worldId, chunk.x, chunk.z, chunk.data.data(), chunk.data.size());
+        }
+        AsyncIOResult& result = results[job.index];
+        result.success = !job.failed;
+        result.errorMessage = std::move(job.errorMessage);
+    }
+    
+    stats_.totalAnvilSaves += pipelineStats.jobs - pipelineStats.failed;
+    stats_.totalSaveTime += pipelineStats.wallMicros;
+    stats_.maxSaveTime = std::max(stats_.maxSaveTime, pipelineStats.wallMicros);
+    {
+        std::lock_guard<std::mutex> lock(pipelineStatsMutex_);
+        lastPipelineStats_ = pipelineStats;
+    }
+    
+    callback(std::move(results));
+}
+
+void AnvilChunkIO::setCompressionType(MinecraftCompressor::CompressionType type) {
+    if (!MinecraftCompressor::isSupported(type)) {
+        throw std::runtime_error("Compression type not supported by this build");
+    }
+    compressionType_.store(type);
+}
+
+void AnvilChunkIO::setZstdDictionary(std::shared_ptr<const ZstdDictionary> dictionary) {
+    std::lock_guard<std::mutex> lock(dictionaryMutex_);
+    // 换字典后仍能解压用之前的字典写入的区块
+    zstdDictionary_ = ZstdDictionary::supersede(std::move(dictionary), zstdDictionary_);
+}
+
+std::shared_ptr<const ZstdDictionary> AnvilChunkIO::getZstdDictionary() const {
+    std::lock_guard<std::mutex> lock(dictionaryMutex_);
+    return zstdDictionary_;
+}
+
+bool AnvilChunkIO::reloadZstdDictionary() {
+    auto dictionary = ZstdDictionary::loadForWorld(worldPath_, MinecraftCompressor::ZSTD_LEVEL);
+    if (!dictionary) {
+        return false;
+    }
+    setZstdDictionary(std::move(dictionary));
+    return true;
+}
+
+std::vector<uint8_t> AnvilChunkIO::decompressChunk(const std::vector<uint8_t>& framed) const {
+    auto dictionary = getZstdDictionary();
+    return MinecraftCompressor::decompressData(framed, MinecraftCompressor::detectCompressionType(framed),
+                                               dictionary.get());
+}
+
+const AnvilChunkIO::AnvilPerformanceStats& AnvilChunkIO::getPerformanceStats() const {
+    HotChunkCache::Stats cacheStats = chunkCache_.getStats();
+    stats_.cacheHits = cacheStats.hits;
+    stats_.cacheMisses = cacheStats.misses;
+    stats_.cacheEvictions = cacheStats.evictions;
+    stats_.cachedBytes = cacheStats.bytes;
+    return stats_;
+}
+
+void AnvilChunkIO::setSavePipelineConfig(const SavePipeline::Config& config) {
+    std::lock_guard<std::mutex> lock(pipelineMutex_);
+    pipelineConfig_ = config;
+    pipeline_.reset();
+}
+
+SavePipeline::Config AnvilChunkIO::getSavePipelineConfig() const {
+    std::lock_guard<std::mutex> lock(pipelineMutex_);
+    return pipelineConfig_;
+}
+
+std::shared_ptr<SavePipeline> AnvilChunkIO::savePipeline() {
+    std::lock_guard<std::mutex> lock(pipelineMutex_);
+    if (!pipeline_) {
+        pipeline_ = std::make_shared<SavePipeline>(pipelineConfig_);
+    }
+    return pipeline_;
+}
+
+SavePipeline::StageStats AnvilChunkIO::getLastSavePipelineStats() const {
+    std::lock_guard<std::mutex> lock(pipelineStatsMutex_);
+    return lastPipelineStats_;
 }
 
 AnvilChunkIO* AnvilChunkIO::forThread(const std::string& worldPath) {
@@ -619,16 +1176,40 @@ AnvilChunkIO* AnvilChunkIO::forThread(const std::string& worldPath) {
 }
 
 std::vector<uint8_t> AnvilChunkIO::getChunkDataForJava(int worldId, int chunkX, int chunkZ) {
-    // 同步加载区块数据
-    AsyncIOResult result;
-    loadChunkAsync(worldId, chunkX, chunkZ, [&result](AsyncIOResult r) {
-        result = std::move(r);
-    });
+    std::vector<uint8_t> data;
+    try {
+        copyChunkDataForJava(worldId, chunkX, chunkZ, [&data](size_t size) {
+            data.resize(size);
+            return data.data();
+        });
+    } catch (const std::exception&) {
+        data.clear();
+    }
+    return data;
+}
+
+size_t AnvilChunkIO::copyChunkDataForJava(int worldId, int chunkX, int chunkZ,
+                                          const std::function<uint8_t*(size_t)>& acquireBuffer) {
+    if (!isValidChunkCoordinates(chunkX, chunkZ)) {
+        return 0;
+    }
     
-    if (result.success) {
-        return std::vector<uint8_t>(result.chunk.data.begin(), result.chunk.data.end());
+    // 缓存中的负载是共享只读的，直接从这里拷入目标缓冲区
+    HotChunkCache::Entry cached;
+    if (!acquireChunkPayload(worldId, chunkX, chunkZ, cached)) {
+        return 0;
     }
-    return {};
+    
+    const size_t size = cached.payload->size() + 1;
+    uint8_t* out = acquireBuffer(size);
+    if (!out) {
+        return 0;
+    }
+    out[0] = static_cast<uint8_t>(MinecraftCompressor::CompressionType::NONE);
+    std::memcpy(out + 1, cached.payload->data(), cached.payload->size());
+    
+    stats_.totalAnvilLoads++;
+    return size;
 }
 
 void AnvilChunkIO::setChunkDataFromJava(int worldId, int chunkX, int chunkZ, const std::vector<uint8_t>& data) {
@@ -650,33 +1231,467 @@ void AnvilChunkIO::getRegionCoordinates(int chunkX, int chunkZ, int& regionX, in
 
 std::shared_ptr<AnvilChunkData> AnvilChunkIO::readChunkFromRegion(const std::string& regionPath,
                                                                 int localX, int localZ) {
-    // 简化实现：检查文件是否存在
-    std::ifstream file(regionPath, std::ios::binary);
-    if (!file.is_open()) {
+    // 复用已打开的region句柄和已解析的位置表
+    auto region = regionCache_.acquire(regionPath);
+    if (!region) {
         return nullptr; // 文件不存在
     }
     
-    // 简化实现：返回空区块数据
-    auto chunk = std::make_shared<AnvilChunkData>(0, 0, 0); // 实际应该从文件读取
+    auto chunk = std::make_shared<AnvilChunkData>();
+    uint32_t timestamp = 0;
+    
+    // 单次pread读取该区块的完整扇区跨度
+    if (!region->readChunk(localX, localZ, chunk->data, &timestamp)) {
+        return nullptr;
+    }
+    
+    // 外部.mcc存储的超大区块暂不支持
+    if (chunk->data[0] & 0x80) {
+        throw std::runtime_error("External chunk storage (.mcc) is not supported");
+    }
+    
+    // 将region压缩方案ID转换为MinecraftCompressor的类型字节，后续可直接decompressData
+    chunk->data[0] = static_cast<uint8_t>(MinecraftCompressor::fromRegionRecord(
+        chunk->data[0], chunk->data.data() + 1, chunk->data.size() - 1));
+    chunk->lastModified = timestamp;
+    chunk->metrics.compressedSize = chunk->data.size() - 1;
     
-    file.close();
     return chunk;
 }
 
 void AnvilChunkIO::writeChunkToRegion(const std::string& regionPath, const AnvilChunkData& chunk,
                                      int localX, int localZ) {
-    // 简化实现：创建目录并写入文件
-    std::string directory = regionPath.substr(0, regionPath.find_last_of('/'));
+    ensureWritable();
+    if (chunk.data.empty()) {
+        throw std::runtime_error("Empty chunk data");
+    }
+    
+    // Java侧传入的是未压缩NBT（以COMPOUND标签开头），先按原版格式压缩
+    if (chunk.data[0] == static_cast<uint8_t>(NBTType::COMPOUND)) {
+        auto dictionary = getZstdDictionary();
+        std::vector<uint8_t> compressed = MinecraftCompressor::compressData(chunk.data, compressionType_.load(),
+                                                                            dictionary.get());
+        commitFramed(chunk, regionPath, compressed.data(), compressed.size(), localX, localZ);
+        return;
+    }
+    
+    commitFramed(chunk, regionPath, chunk.data.data(), chunk.data.size(), localX, localZ);
+}
+
+void AnvilChunkIO::commitFramed(const AnvilChunkData& chunk, const std::string& regionPath,
+                                const uint8_t* framed, size_t framedSize, int localX, int localZ) {
+    std::shared_lock<std::shared_mutex> journalLock(journalMutex_);
+    if (journal_) {
+        // 并发保存在sync中合并为一次fdatasync
+        journal_->append(chunk.worldId, chunk.x, chunk.z, chunk.lastModified, framed, framedSize);
+        journal_->sync();
+        writeFramedToRegion(regionPath, framed, framedSize, localX, localZ, chunk.lastModified);
+        std::lock_guard<std::mutex> lock(journalDirtyMutex_);
+        journalDirtyRegions_.insert(regionPath);
+        return;
+    }
+    writeFramedToRegion(regionPath, framed, framedSize, localX, localZ, chunk.lastModified);
+}
+
+bool AnvilChunkIO::inflateMappedChunk(const std::string& regionPath, int localX, int localZ,
+                                      std::vector<uint8_t>& nbt, uint32_t& timestamp) {
+    const auto locateStart = std::chrono::steady_clock::now();
+    auto region = mappedRegions_.acquire(regionPath);
+    uint8_t compressionId = 0;
+    const uint8_t* payload = nullptr;
+    size_t payloadSize = 0;
+    const bool found = region && region->locateChunk(localX, localZ, compressionId, payload, payloadSize, &timestamp);
+    IOMetrics::recordStage(IOStage::DISK_READ, microsSince(locateStart));
+    if (!found) {
+        return false;
+    }
+    
+    // 外部.mcc存储的超大区块暂不支持
+    if (compressionId & 0x80) {
+        throw std::runtime_error("External chunk storage (.mcc) is not supported");
+    }
+    
+    // 缺页在解压时发生，映射模式下INFLATE包含了实际的读盘时间
+    const auto inflateStart = std::chrono::steady_clock::now();
+    auto type = MinecraftCompressor::fromRegionRecord(compressionId, payload, payloadSize);
+    auto dictionary = getZstdDictionary();
+    nbt = MinecraftCompressor::decompressPayload(type, payload, payloadSize, dictionary.get());
+    IOMetrics::recordStage(IOStage::INFLATE, microsSince(inflateStart));
+    return true;
+}
+
+void AnvilChunkIO::setReadOnlyMapped(bool enabled) {
+    if (readOnlyMapped_.exchange(enabled) == enabled) {
+        return;
+    }
+    // 切换时丢弃另一种模式持有的句柄或映射
+    if (enabled) {
+        regionCache_.clear();
+    } else {
+        mappedRegions_.clear();
+    }
+}
+
+size_t AnvilChunkIO::prefetchChunks(int worldId, const std::vector<std::pair<int, int>>& chunks) {
+    if (!readOnlyMapped_.load()) {
+        return 0;
+    }
+    
+    size_t hinted = 0;
+    std::string lastPath;
+    std::shared_ptr<MappedRegionFile> region;
+    for (const auto& [chunkX, chunkZ] : chunks) {
+        if (!isValidChunkCoordinates(chunkX, chunkZ)) {
+            continue;
+        }
+        // 已在热缓存中的区块不需要再读
+        if (chunkCache_.contains(HotChunkCache::packKey(worldId, chunkX, chunkZ))) {
+            continue;
+        }
+        
+        int regionX, regionZ, localX, localZ;
+        getRegionCoordinates(chunkX, chunkZ, regionX, regionZ, localX, localZ);
+        std::string regionPath = createAnvilFilePath(worldPath_, worldId, regionX, regionZ);
+        // 预测的区块通常集中在少数region中
+        if (regionPath != lastPath) {
+            region = mappedRegions_.acquire(regionPath);
+            lastPath = std::move(regionPath);
+        }
+        if (region && region->hasChunk(localX, localZ)) {
+            region->prefetchChunk(localX, localZ);
+            hinted++;
+        }
+    }
+    return hinted;
+}
+
+// ===== 预写日志 =====
+
+void AnvilChunkIO::recoverJournal() {
+    const std::string path = ChunkJournal::pathForWorld(worldPath_);
+    if (::access(path.c_str(), F_OK) != 0) {
+        return;
+    }
     
-    // 创建目录（简化实现）
-    system(("mkdir -p " + directory).c_str());
+    ChunkJournal journal(path);
+    auto records = journal.recover();
+    for (const auto& record : records) {
+        int regionX, regionZ, localX, localZ;
+        getRegionCoordinates(record.chunkX, record.chunkZ, regionX, regionZ, localX, localZ);
+        std::string regionPath = createAnvilFilePath(worldPath_, record.worldId, regionX, regionZ);
+        writeFramedToRegion(regionPath, record.framed.data(), record.framed.size(),
+                            localX, localZ, record.timestamp);
+        journalDirtyRegions_.insert(std::move(regionPath));
+    }
     
-    std::ofstream file(regionPath, std::ios::binary | std::ios::app);
-    if (file.is_open()) {
-        // 简化实现：写入空数据
-        file.write(reinterpret_cast<const char*>(chunk.data.data()), chunk.data.size());
-        file.close();
+    // 重放结果落盘前保留日志，失败时下次启动再次重放（记录幂等）
+    if (!syncJournalDirtyRegions() || !journal.checkpoint()) {
+        throw std::runtime_error("Failed to apply chunk journal: " + path);
+    }
+    stats_.journalRecordsReplayed += records.size();
+    ::unlink(path.c_str());
+}
+
+void AnvilChunkIO::setJournalEnabled(bool enabled) {
+    std::unique_lock<std::shared_mutex> lock(journalMutex_);
+    if (enabled == (journal_ != nullptr)) {
+        return;
+    }
+    
+    const std::string path = ChunkJournal::pathForWorld(worldPath_);
+    if (enabled) {
+        journal_ = std::make_unique<ChunkJournal>(path);
+        return;
+    }
+    
+    if (!syncJournalDirtyRegions() || !journal_->checkpoint()) {
+        throw std::runtime_error("Failed to checkpoint chunk journal");
+    }
+    journal_.reset();
+    ::unlink(path.c_str());
+}
+
+bool AnvilChunkIO::isJournalEnabled() const {
+    std::shared_lock<std::shared_mutex> lock(journalMutex_);
+    return journal_ != nullptr;
+}
+
+bool AnvilChunkIO::checkpointJournal() {
+    std::unique_lock<std::shared_mutex> lock(journalMutex_);
+    if (!journal_) {
+        return true;
     }
+    // 独占锁下所有已追加的记录都已写入region
+    return syncJournalDirtyRegions() && journal_->checkpoint();
+}
+
+ChunkJournal::Stats AnvilChunkIO::getJournalStats() const {
+    std::shared_lock<std::shared_mutex> lock(journalMutex_);
+    return journal_ ? journal_->getStats() : ChunkJournal::Stats{};
+}
+
+bool AnvilChunkIO::syncJournalDirtyRegions() {
+    std::lock_guard<std::mutex> lock(journalDirtyMutex_);
+    for (auto it = journalDirtyRegions_.begin(); it != journalDirtyRegions_.end();) {
+        // 已被淘汰的句柄重新打开后sync，fdatasync作用于整个文件
+        auto region = regionCache_.acquire(*it);
+        if (region && !region->sync()) {
+            return false;
+        }
+        it = journalDirtyRegions_.erase(it);
+    }
+    return true;
+}
+
+void AnvilChunkIO::checkpointJournalIfNeeded() {
+    {
+        std::shared_lock<std::shared_mutex> lock(journalMutex_);
+        if (!journal_ || journal_->fileBytes() < journalCheckpointBytes_.load()) {
+            return;
+        }
+    }
+    checkpointJournal();
+}
+
+void AnvilChunkIO::ensureWritable() const {
+    if (readOnlyMapped_.load()) {
+        throw std::runtime_error("World is opened read-only");
+    }
+}
+
+void AnvilChunkIO::updateCacheAfterWrite(const AnvilChunkData& chunk) {
+    regionIndex_.recordChunk(chunk.worldId, chunk.x, chunk.z, chunk.lastModified);
+    if (packetStoreEnabled_.load()) {
+        int regionX, regionZ, localX, localZ;
+        getRegionCoordinates(chunk.x, chunk.z, regionX, regionZ, localX, localZ);
+        packetStore_.invalidate(createAnvilFilePath(worldPath_, chunk.worldId, regionX, regionZ), localX, localZ);
+    }
+    const uint64_t key = HotChunkCache::packKey(chunk.worldId, chunk.x, chunk.z);
+    if (!chunk.data.empty() && chunk.data[0] == static_cast<uint8_t>(NBTType::COMPOUND)) {
+        chunkCache_.put(key, std::make_shared<const std::vector<uint8_t>>(chunk.data), chunk.lastModified);
+    } else {
+        chunkCache_.erase(key);
+    }
+}
+
+void AnvilChunkIO::writeFramedToRegion(const std::string& regionPath, const uint8_t* framed, size_t framedSize,
+                                      int localX, int localZ, uint32_t timestamp) {
+    ensureWritable();
+    auto region = regionCache_.acquire(regionPath, true);
+    if (!region) {
+        throw std::runtime_error("Failed to open region file: " + regionPath);
+    }
+    
+    // framed[0]为CompressionType类型字节，其后为压缩负载
+    auto type = static_cast<MinecraftCompressor::CompressionType>(framed[0]);
+    region->writeChunk(localX, localZ,
+                       MinecraftCompressor::toRegionCompressionId(type),
+                       framed + 1, framedSize - 1,
+                       timestamp);
+}
+
+std::unique_ptr<BulkRegionImporter> AnvilChunkIO::beginBulkImport(const BulkRegionImporter::Config& config) {
+    ensureWritable();
+    if (isJournalEnabled() && !checkpointJournal()) {
+        throw std::runtime_error("Failed to checkpoint chunk journal before bulk import");
+    }
+    
+    const std::string worldPath = worldPath_;
+    const auto compressionType = compressionType_.load();
+    auto dictionary = getZstdDictionary();
+    
+    return std::make_unique<BulkRegionImporter>(config,
+        [worldPath](int worldId, int regionX, int regionZ) {
+            return createAnvilFilePath(worldPath, worldId, regionX, regionZ);
+        },
+        [compressionType, dictionary](const uint8_t* nbt, size_t size) {
+            return MinecraftCompressor::compressData(nbt, size, compressionType, dictionary.get());
+        },
+        [this](const std::string& path, int worldId, int regionX, int regionZ) {
+            invalidateRegion(path, worldId, regionX, regionZ);
+        });
+}
+
+std::unique_ptr<RegionDefragmenter> AnvilChunkIO::startDefragmenter(const RegionDefragmenter::Config& config) {
+    ensureWritable();
+    
+    // 区块搬移不改变内容：热缓存、增量基线和日志记录（按区块坐标重放）都不受影响
+    const std::string worldPath = worldPath_;
+    auto defragmenter = std::make_unique<RegionDefragmenter>(config,
+        [worldPath]() {
+            return RegionDefragmenter::listWorldRegions(worldPath);
+        },
+        [this](const std::string& path) -> std::shared_ptr<RegionFile> {
+            if (readOnlyMapped_.load()) {
+                return nullptr;
+            }
+            return regionCache_.acquire(path, false);
+        });
+    defragmenter->start();
+    return defragmenter;
+}
+
+std::unique_ptr<RegionScrubber> AnvilChunkIO::startScrubber(const RegionScrubber::Config& config,
+                                                            RegionScrubber::BadChunkFound onBadChunk) {
+    ensureWritable();
+    
+    const std::string worldPath = worldPath_;
+    auto scrubber = std::make_unique<RegionScrubber>(config,
+        [worldPath]() {
+            return RegionDefragmenter::listWorldRegions(worldPath);
+        },
+        [this](const std::string& path) -> std::shared_ptr<RegionFile> {
+            if (readOnlyMapped_.load()) {
+                return nullptr;
+            }
+            return regionCache_.acquire(path, false);
+        },
+        [this](uint8_t regionId, const uint8_t* payload, size_t size) {
+            // 每次校验取当前字典：扫描期间换字典后，用新字典写入的区块不会被误判
+            auto dictionary = getZstdDictionary();
+            switch (MinecraftCompressor::verifyRecord(regionId, payload, size, dictionary.get())) {
+                case MinecraftCompressor::RecordIntegrity::OK: return RegionScrubber::Verdict::OK;
+                case MinecraftCompressor::RecordIntegrity::UNSUPPORTED: return RegionScrubber::Verdict::UNSUPPORTED;
+                default: return RegionScrubber::Verdict::CORRUPT;
+            }
+        },
+        [this, onBadChunk = std::move(onBadChunk)](const RegionScrubber::BadChunk& chunk) {
+            if (chunk.quarantined) {
+                chunkCache_.erase(HotChunkCache::packKey(chunk.worldId, chunk.chunkX, chunk.chunkZ));
+                sectionCache_.forget(chunk.worldId, chunk.chunkX, chunk.chunkZ);
+                regionIndex_.removeChunk(chunk.worldId, chunk.chunkX, chunk.chunkZ);
+            }
+            if (onBadChunk) {
+                onBadChunk(chunk);
+            }
+        });
+    scrubber->start();
+    return scrubber;
+}
+
+void AnvilChunkIO::invalidateRegion(const std::string& regionPath, int worldId, int regionX, int regionZ) {
+    regionCache_.invalidate(regionPath);
+    mappedRegions_.invalidate(regionPath);
+    for (int localZ = 0; localZ < 32; ++localZ) {
+        for (int localX = 0; localX < 32; ++localX) {
+            const int chunkX = (regionX << 5) + localX;
+            const int chunkZ = (regionZ << 5) + localZ;
+            chunkCache_.erase(HotChunkCache::packKey(worldId, chunkX, chunkZ));
+            sectionCache_.forget(worldId, chunkX, chunkZ);
+        }
+    }
+    // 整个region被替换（或删除），重新读取它的头部；旁路文件中的记录随后按时间戳过期
+    regionIndex_.rescanRegion(worldId, regionX, regionZ, regionPath);
+    packetStore_.forget(regionPath);
+}
+
+void AnvilChunkIO::forgetRegion(int worldId, int regionX, int regionZ) {
+    invalidateRegion(createAnvilFilePath(worldPath_, worldId, regionX, regionZ), worldId, regionX, regionZ);
+}
+
+RegionIndex::Stats AnvilChunkIO::buildRegionIndex(const RegionIndex::Config& config) {
+    return regionIndex_.build(worldPath_, config);
+}
+
+bool AnvilChunkIO::chunkExists(int worldId, int chunkX, int chunkZ) {
+    const RegionIndex::Presence presence = regionIndex_.chunkPresence(worldId, chunkX, chunkZ);
+    if (presence != RegionIndex::Presence::UNKNOWN) {
+        return presence == RegionIndex::Presence::PRESENT;
+    }
+    
+    int regionX, regionZ, localX, localZ;
+    getRegionCoordinates(chunkX, chunkZ, regionX, regionZ, localX, localZ);
+    const std::string regionPath = createAnvilFilePath(worldPath_, worldId, regionX, regionZ);
+    if (readOnlyMapped_.load()) {
+        auto region = mappedRegions_.acquire(regionPath);
+        return region && region->hasChunk(localX, localZ);
+    }
+    auto region = regionCache_.acquire(regionPath, false);
+    return region && region->hasChunk(localX, localZ);
+}
+
+uint32_t AnvilChunkIO::chunkSaveTimestamp(const std::string& regionPath, int worldId, int chunkX, int chunkZ) {
+    if (const uint32_t indexed = regionIndex_.chunkTimestamp(worldId, chunkX, chunkZ)) {
+        return indexed;
+    }
+    const int localX = chunkX & 0x1F;
+    const int localZ = chunkZ & 0x1F;
+    if (readOnlyMapped_.load()) {
+        auto region = mappedRegions_.acquire(regionPath);
+        return region && region->hasChunk(localX, localZ) ? region->getTimestamp(localX, localZ) : 0;
+    }
+    auto region = regionCache_.acquire(regionPath, false);
+    return region && region->hasChunk(localX, localZ) ? region->getTimestamp(localX, localZ) : 0;
+}
+
+void AnvilChunkIO::setPacketStoreEnabled(bool enabled) {
+    packetStoreEnabled_.store(enabled);
+    if (!enabled) {
+        // 关闭期间的保存不会清除记录，再次开启时依赖时间戳判断过期
+        packetStore_.clear();
+    }
+}
+
+size_t AnvilChunkIO::copyChunkPacket(int worldId, int chunkX, int chunkZ, uint32_t formatTag,
+                                     const std::function<uint8_t*(size_t)>& acquireBuffer) {
+    if (!packetStoreEnabled_.load() || !isValidChunkCoordinates(chunkX, chunkZ)) {
+        return 0;
+    }
+    int regionX, regionZ, localX, localZ;
+    getRegionCoordinates(chunkX, chunkZ, regionX, regionZ, localX, localZ);
+    const std::string regionPath = createAnvilFilePath(worldPath_, worldId, regionX, regionZ);
+    const uint32_t timestamp = chunkSaveTimestamp(regionPath, worldId, chunkX, chunkZ);
+    if (timestamp == 0) {
+        return 0;
+    }
+    return packetStore_.read(regionPath, localX, localZ, timestamp, formatTag, acquireBuffer);
+}
+
+bool AnvilChunkIO::storeChunkPacket(int worldId, int chunkX, int chunkZ, uint32_t formatTag,
+                                    const uint8_t* packet, size_t length, int level) {
+    if (!packetStoreEnabled_.load() || !packet || length == 0 || length > 0x7FFFFFFF ||
+        !isValidChunkCoordinates(chunkX, chunkZ)) {
+        return false;
+    }
+    int regionX, regionZ, localX, localZ;
+    getRegionCoordinates(chunkX, chunkZ, regionX, regionZ, localX, localZ);
+    const std::string regionPath = createAnvilFilePath(worldPath_, worldId, regionX, regionZ);
+    // 先取保存代数再读时间戳：同一秒内的保存时间戳不变，只能靠代数发现帧已过期
+    const uint32_t generation = packetStore_.generation(regionPath, localX, localZ);
+    const uint32_t timestamp = chunkSaveTimestamp(regionPath, worldId, chunkX, chunkZ);
+    if (timestamp == 0) {
+        return false;
+    }
+    
+    // 帧格式同ChunkPacketCache：VarInt(未压缩长度) + zlib数据
+    std::vector<uint8_t> frame;
+    for (uint32_t value = static_cast<uint32_t>(length); ; value >>= 7) {
+        if (value < 0x80) {
+            frame.push_back(static_cast<uint8_t>(value));
+            break;
+        }
+        frame.push_back(static_cast<uint8_t>(value | 0x80));
+    }
+    if (!codec::deflateCompress(codec::DeflateFormat::ZLIB, packet, length, std::clamp(level, 1, 9), frame)) {
+        return false;
+    }
+    return packetStore_.write(regionPath, localX, localZ, timestamp, formatTag, generation, frame.data(), frame.size());
+}
+
+uint64_t AnvilChunkIO::compactRegion(int worldId, int regionX, int regionZ) {
+    std::string regionPath = createAnvilFilePath(worldPath_, worldId, regionX, regionZ);
+    
+    ensureWritable();
+    
+    // 日志中的记录引用旧扇区布局之前的状态，压缩前先落盘并截断
+    if (isJournalEnabled() && !checkpointJournal()) {
+        throw std::runtime_error("Failed to checkpoint chunk journal before compaction");
+    }
+    
+    // 关闭缓存的句柄，确保压缩期间没有读写者持有旧文件
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    regionCache_.invalidate(regionPath);
+    return RegionFile::compactFile(regionPath);
 }
 
 } // namespace anvil
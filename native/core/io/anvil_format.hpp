@@ -1,18 +1,45 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <cstdint>
 #include <chrono>
 #include <functional>
+#include <optional>
+#include <span>
+#include <shared_mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include "../async_task.hpp"
 #include "io_types.hpp"
+#include "bulk_region_importer.hpp"
+#include "region_defragmenter.hpp"
+#include "region_scrubber.hpp"
+#include "region_file.hpp"
+#include "region_index.hpp"
+#include "chunk_journal.hpp"
+#include "chunk_packet_store.hpp"
+#include "hot_chunk_cache.hpp"
+#include "mapped_region_file.hpp"
+#include "save_pipeline.hpp"
+#include "section_save_cache.hpp"
 
 namespace lattice {
+namespace net {
+class MemoryArena;
+} // namespace net
+
 namespace io {
 namespace anvil {
 
+class NBTReader;
+class NBTWriter;
+class ZstdDictionary;
+
 // ===== Anvil文件格式常量 =====
 constexpr size_t REGION_SIZE = 32;           // 32x32 区块每个region
 constexpr size_t REGION_FILE_SIZE = 32 * 1024 * 1024; // 32MB 每个region文件
@@ -44,6 +71,10 @@ struct AnvilChunkData {
     uint32_t lastModified;       // 最后修改时间戳
     std::vector<uint8_t> data;   // 压缩后的NBT数据
     
+    // 保存的段光照；lightTrusted对应原版isLightOn，为true时加载后可以直接使用、跳过重新计算
+    std::vector<ChunkLightSection> lightSections;
+    bool lightTrusted = false;
+    
     // 性能指标
     struct PerformanceMetrics {
         std::chrono::microseconds loadTime{0};
@@ -63,29 +94,78 @@ struct AnvilChunkData {
 // ===== Minecraft压缩算法 =====
 class MinecraftCompressor {
 public:
-    // 注意：Minecraft原版仅支持ZLIB/DEFLATE格式，其他格式作为可选选项并默认关闭
+    // 注意：Minecraft原版默认ZLIB/DEFLATE格式，其他格式作为可选选项并默认关闭
     // 使用libdeflate库（比标准zlib更快）实现DEFLATE压缩算法
     enum class CompressionType : uint8_t {
         NONE = 0,      // 无压缩（小数据）
-        ZLIB = 1,      // DEFLATE压缩（唯一支持的Minecraft原生格式，默认，使用libdeflate库）
+        ZLIB = 1,      // DEFLATE压缩（Minecraft原生格式，默认，使用libdeflate库）
         // 以下格式作为可选选项，默认关闭
         GZIP = 2,      // GZIP压缩 (可选，旧格式)
-        CUSTOM = 3     // 自定义压缩 (可选)
+        CUSTOM = 3,    // 自定义压缩 (可选，无法识别的外部算法)
+        LZ4 = 4,       // LZ4 (可选，原版1.20.5+支持，解压速度优先)
+        ZSTD = 5       // zstd (可选，region中以自定义压缩ID存储，仅Lattice可读)
     };
     
+    // dictionary仅对ZSTD生效（见ZstdDictionary），其他类型忽略
     static std::vector<uint8_t> compressData(const std::vector<uint8_t>& data, 
-                                           CompressionType type = CompressionType::ZLIB);
+                                           CompressionType type = CompressionType::ZLIB,
+                                           const ZstdDictionary* dictionary = nullptr);
+    // 直接压缩NBTWriter/arena中的数据，避免先拷贝成vector
+    static std::vector<uint8_t> compressData(const uint8_t* data, size_t size,
+                                           CompressionType type = CompressionType::ZLIB,
+                                           const ZstdDictionary* dictionary = nullptr);
     static std::vector<uint8_t> decompressData(const std::vector<uint8_t>& compressedData,
-                                              CompressionType type);
+                                              CompressionType type,
+                                              const ZstdDictionary* dictionary = nullptr);
+    // 解压不带类型字节的负载（例如映射内的region记录），type需由调用者确定
+    static std::vector<uint8_t> decompressPayload(CompressionType type, const uint8_t* payload, size_t size,
+                                                 const ZstdDictionary* dictionary = nullptr);
     static CompressionType detectCompressionType(const std::vector<uint8_t>& data);
     
+    // 当前构建是否支持该压缩类型（LZ4/zstd为可选依赖）
+    static bool isSupported(CompressionType type);
+    
     // 批量压缩优化
     static void compressBatch(std::vector<std::shared_ptr<AnvilChunkData>>& chunks,
                             CompressionType type = CompressionType::ZLIB);
     static void decompressBatch(std::vector<std::shared_ptr<AnvilChunkData>>& chunks);
     
+    // region文件中的压缩方案ID（原版定义：1=GZIP, 2=ZLIB, 3=无压缩, 4=LZ4, 127=自定义）
+    static constexpr uint8_t REGION_COMPRESSION_GZIP = 1;
+    static constexpr uint8_t REGION_COMPRESSION_ZLIB = 2;
+    static constexpr uint8_t REGION_COMPRESSION_NONE = 3;
+    static constexpr uint8_t REGION_COMPRESSION_LZ4 = 4;
+    static constexpr uint8_t REGION_COMPRESSION_CUSTOM = 127;
+    
+    // 自定义压缩的算法名（原版格式：负载以2字节长度 + 名称开头）
+    static constexpr std::string_view ZSTD_CUSTOM_NAME = "lattice:zstd";
+    
+    // CompressionType与region压缩方案ID互相转换
+    static uint8_t toRegionCompressionId(CompressionType type);
+    static CompressionType fromRegionCompressionId(uint8_t regionId);
+    // 自定义压缩ID需要检查负载开头的算法名
+    static CompressionType fromRegionRecord(uint8_t regionId, const uint8_t* payload, size_t size);
+    
+    /**
+     * 区块记录完整性校验（RegionScrubber与NBTSerializer::isNBTFormatCompatible使用）
+     * 不做NBT解析：解压到线程内复用的缓冲区，由libdeflate校验zlib的Adler-32 / gzip的CRC-32与长度，
+     * zstd校验帧（含内容校验和时一并校验），LZ4校验分块XXH32；然后检查负载是以TAG_End结束的复合标签
+     * 校验和覆盖的是解压后的数据，所以解压本身不可省略；省掉的是NBT解析和结果分配
+     */
+    enum class RecordIntegrity : uint8_t {
+        OK = 0,
+        CORRUPT = 1,
+        UNSUPPORTED = 2     // 外部.mcc记录、未知的自定义算法、当前构建没有对应的解码器，或zstd帧依赖的字典不在dictionary中
+    };
+    static RecordIntegrity verifyRecord(uint8_t regionId, const uint8_t* payload, size_t size,
+                                        const ZstdDictionary* dictionary = nullptr);
+    
+    // zstd压缩级别（字典的CDict也按此级别创建）
+    static constexpr int ZSTD_LEVEL = 3;
+    
 private:
     static constexpr size_t MIN_COMPRESSION_SIZE = 64; // 最小压缩大小
+    static constexpr int DEFLATE_LEVEL = 6;
 };
 
 // ===== NBT序列化器 =====
@@ -102,6 +182,23 @@ public:
     static std::vector<std::vector<uint8_t>> batchSerializeToNBT(
         const std::vector<std::shared_ptr<AnvilChunkData>>& chunks);
     
+    // 写入调用者提供的NBTWriter（arena/压缩缓冲区后备），不经过中间vector
+    static void serializeChunkToNBT(const AnvilChunkData& chunk, NBTWriter& writer);
+    
+    // 序列化大小预估：优先取同一区块上次保存的大小
+    static size_t estimateSerializedSize(const AnvilChunkData& chunk);
+    
+    // 批量序列化到arena：views在arena clear()之前有效；
+    // arena耗尽时溢出到堆，由spilled持有
+    struct SerializedBatch {
+        std::vector<std::span<const uint8_t>> views;
+        std::vector<std::unique_ptr<uint8_t[]>> spilled;
+    };
+    
+    static SerializedBatch batchSerializeToNBT(
+        const std::vector<std::shared_ptr<AnvilChunkData>>& chunks,
+        lattice::net::MemoryArena& arena);
+    
     // 从Java字节数组反序列化（Minecraft 1.21.10兼容）
     static AnvilChunkData deserializeChunkFromJavaBytes(const std::vector<uint8_t>& javaBytes,
                                                        int worldId, int x, int z);
@@ -148,6 +245,9 @@ private:
     static std::vector<uint8_t> readNBTByteArray(const std::vector<uint8_t>& buffer, size_t& offset);
     static std::vector<int32_t> readNBTIntArray(const std::vector<uint8_t>& buffer, size_t& offset);
     static std::vector<int64_t> readNBTLongArray(const std::vector<uint8_t>& buffer, size_t& offset);
+    
+    // 读取sections列表中的段光照（游标位于列表负载处），格式错误时清空
+    static void readLightSections(NBTReader& reader, std::vector<ChunkLightSection>& sections);
 };
 
 // ===== Anvil I/O 类 =====
@@ -160,19 +260,52 @@ public:
     void loadChunkAsync(int worldId, int chunkX, int chunkZ,
                        std::function<void(AsyncIOResult)> callback);
     
+    /**
+     * 协程版本的读取 → 解压 → 解析：先转到NativeRuntime的共享线程池，读盘（或命中热缓存）、
+     * 解压并反序列化为AnvilChunkData，包括保存的段光照。区块不存在时返回nullopt，读盘或解压失败时抛出
+     */
+    core::AsyncTask<std::optional<AnvilChunkData>> loadChunkData(int worldId, int chunkX, int chunkZ,
+                                                                 core::TaskPriority priority = core::TaskPriority::NORMAL);
+    
     // 异步保存区块 - 使用Minecraft原生压缩
     void saveChunkAsync(const AnvilChunkData& chunk,
                        std::function<void(AsyncIOResult)> callback);
     
-    // 批量操作优化（保持高性能）
+    /**
+     * 批量保存：序列化 → 压缩 → 写入三阶段流水线并行执行
+     * 每个region文件只有一个写线程；结果顺序与输入一致（跳过空指针）
+     */
     void saveChunksBatch(const std::vector<std::shared_ptr<AnvilChunkData>>& chunks,
                         std::function<void(std::vector<AsyncIOResult>)> callback);
     
+    /**
+     * 增量保存：只提交自上次保存以来重新编码的段（见ChunkDelta），
+     * 其余段取自SectionSaveCache中的基线拼接成完整NBT后写入。
+     * 返回UNCHANGED时不写盘；返回NEEDS_FULL时回调失败，调用者需提交完整增量
+     */
+    SectionSaveCache::DeltaResult saveChunkDelta(const ChunkDelta& delta,
+                                                 std::function<void(AsyncIOResult)> callback);
+    
+    // 整块保存时跳过内容与上次保存相同的区块（默认开启）
+    void setSkipUnchangedSaves(bool enabled) { skipUnchangedSaves_.store(enabled); }
+    SectionSaveCache::Stats getSectionSaveStats() const { return sectionCache_.getStats(); }
+    void setSectionSaveCacheBudget(size_t bytes) { sectionCache_.setByteBudget(bytes); }
+    // 区块卸载时释放其增量基线
+    void forgetChunkBaseline(int worldId, int chunkX, int chunkZ) { sectionCache_.forget(worldId, chunkX, chunkZ); }
+    
     // 每线程实例（与AsyncChunkIO保持一致）
     static AnvilChunkIO* forThread(const std::string& worldPath);
     
     // 与PaperMC API的桥接
     std::vector<uint8_t> getChunkDataForJava(int worldId, int chunkX, int chunkZ);
+    
+    /**
+     * 零中间拷贝版本：与getChunkDataForJava相同的字节（NONE类型字节 + NBT），
+     * 直接写入acquireBuffer(size)返回的缓冲区（如池化的DirectByteBuffer）
+     * 返回写入的字节数；区块不存在或acquireBuffer返回nullptr时返回0，读盘或解压失败时抛出
+     */
+    size_t copyChunkDataForJava(int worldId, int chunkX, int chunkZ,
+                                const std::function<uint8_t*(size_t)>& acquireBuffer);
     void setChunkDataFromJava(int worldId, int chunkX, int chunkZ, const std::vector<uint8_t>& data);
     
     // 性能监控
@@ -183,12 +316,156 @@ public:
         uint64_t totalSaveTime{0};
         uint64_t maxLoadTime{0};
         uint64_t maxSaveTime{0};
+        // 热区块缓存（HotChunkCache）
+        uint64_t cacheHits{0};
+        uint64_t cacheMisses{0};
+        uint64_t cacheEvictions{0};
+        size_t cachedBytes{0};
+        // 启动时从区块日志重放的记录数
+        uint64_t journalRecordsReplayed{0};
     };
     
-    const AnvilPerformanceStats& getPerformanceStats() const { return stats_; }
+    const AnvilPerformanceStats& getPerformanceStats() const;
+    
+    /**
+     * 热区块缓存：缓存解压后的NBT，命中时跳过读盘和解压
+     * loadChunkAsync返回的数据统一为NONE类型记录（类型字节0 + NBT）
+     */
+    HotChunkCache::Stats getChunkCacheStats() const { return chunkCache_.getStats(); }
+    void setChunkCacheBudget(size_t bytes) { chunkCache_.setByteBudget(bytes); }
+    void invalidateCachedChunk(int worldId, int chunkX, int chunkZ) {
+        chunkCache_.erase(HotChunkCache::packKey(worldId, chunkX, chunkZ));
+    }
+    
+    /**
+     * 离线压缩指定region文件，回收碎片扇区
+     * 必须在该region没有并发读写时调用（例如服务器关闭后或世界卸载时）
+     * @return 回收的字节数
+     */
+    uint64_t compactRegion(int worldId, int regionX, int regionZ);
+    
+    /**
+     * 批量导入 / 预生成（见BulkRegionImporter）：整region在内存中组装、并行压缩、一次顺序写出，
+     * 使用本世界的压缩类型与字典；region写出后使对应的句柄、映射和缓存失效
+     * 启用预写日志时先做一次检查点（导入不经过日志，不能被旧记录重放覆盖）
+     * 返回的导入器不得比本对象存活更久；只读映射模式或检查点失败时抛出std::runtime_error
+     */
+    std::unique_ptr<BulkRegionImporter> beginBulkImport(const BulkRegionImporter::Config& config);
+    
+    /**
+     * 后台碎片整理 / 重新压缩（见RegionDefragmenter），与在线保存共用region句柄缓存，
+     * 可以在服务器运行时启动；调用者每tick通过onTick()发放I/O预算
+     * 已启动的整理器不得比本对象存活更久；只读映射模式下抛出std::runtime_error，
+     * 运行期间切换到只读映射模式后跳过所有region
+     */
+    std::unique_ptr<RegionDefragmenter> startDefragmenter(const RegionDefragmenter::Config& config);
+    
+    /**
+     * 后台损坏区块扫描（见RegionScrubber），按本世界的zstd字典校验记录，与在线保存共用region句柄缓存
+     * 隔离的区块同时从热缓存、增量基线和存在索引中移除，之后按未生成区块加载
+     * 已启动的扫描器不得比本对象存活更久；只读映射模式下抛出std::runtime_error
+     */
+    std::unique_ptr<RegionScrubber> startScrubber(const RegionScrubber::Config& config,
+                                                  RegionScrubber::BadChunkFound onBadChunk = nullptr);
+    
+    // region文件在外部被替换或删除（格式转换等）后，丢弃其句柄、映射和所有区块的缓存
+    void forgetRegion(int worldId, int regionX, int regionZ);
+    
+    /**
+     * 区块存在与时间戳索引（见RegionIndex）：并行读取所有region头部，通常在世界加载时调用一次
+     * 之后在线保存和批量导入都会更新索引；升级扫描可通过getRegionIndex().chunksSavedBefore()取得待处理区块
+     */
+    RegionIndex::Stats buildRegionIndex(const RegionIndex::Config& config = RegionIndex::Config{});
+    // 区块是否已写入region：已建立索引的维度只查内存，否则读取（缓存的）region头部
+    bool chunkExists(int worldId, int chunkX, int chunkZ);
+    const RegionIndex& getRegionIndex() const { return regionIndex_; }
+    
+    // region句柄缓存统计与配置
+    RegionFileCache::CacheStats getRegionCacheStats() const { return regionCache_.getStats(); }
+    void setMaxOpenRegions(size_t maxOpenRegions) { regionCache_.setMaxOpenRegions(maxOpenRegions); }
+    
+    /**
+     * 本世界新写入区块使用的压缩类型（默认ZLIB）
+     * 读取时按每条记录的压缩ID解码，同一region中可以混合多种格式
+     * 当前构建不支持该类型时抛出std::runtime_error
+     */
+    void setCompressionType(MinecraftCompressor::CompressionType type);
+    MinecraftCompressor::CompressionType getCompressionType() const { return compressionType_.load(); }
+    
+    /**
+     * 本世界的zstd字典（见ZstdDictionary），ZSTD类型的保存用它压缩，解压按帧头的字典ID选用它或它保留的旧字典
+     * 构造时自动加载世界目录下的字典文件（含按ID存档的旧字典）；换字典时保留之前的字典用于解压，
+     * 传入nullptr取消字典。reloadZstdDictionary在没有字典文件时保持现有字典并返回false
+     */
+    void setZstdDictionary(std::shared_ptr<const ZstdDictionary> dictionary);
+    std::shared_ptr<const ZstdDictionary> getZstdDictionary() const;
+    bool reloadZstdDictionary();
+    
+    // 使用本世界的字典解压loadChunkAsync返回的记录
+    std::vector<uint8_t> decompressChunk(const std::vector<uint8_t>& framed) const;
+    
+    /**
+     * 只读映射模式：region文件整体mmap，加载时直接从映射扇区解压，不再pread到中间缓冲区
+     * 适用于不会被修改的世界（小游戏地图等）；开启后所有保存和compactRegion都会失败
+     */
+    void setReadOnlyMapped(bool enabled);
+    bool isReadOnlyMapped() const { return readOnlyMapped_.load(); }
+    MappedRegionCache::CacheStats getMappedRegionStats() const { return mappedRegions_.getStats(); }
+    void setMaxMappedRegions(size_t maxMappedRegions) { mappedRegions_.setMaxMappedRegions(maxMappedRegions); }
+    
+    // 对预测即将加载的区块发出madvise(WILLNEED)；仅只读映射模式下生效，返回已提示的区块数
+    size_t prefetchChunks(int worldId, const std::vector<std::pair<int, int>>& chunks);
+    
+    /**
+     * 预写日志模式（见ChunkJournal）：保存先组提交到世界目录下的日志再写region，
+     * region写入不再单独落盘；日志超过checkpointBytes时sync所有改动过的region并截断日志。
+     * 构造时总会重放上次遗留的日志。关闭时先做一次检查点再删除日志文件
+     */
+    static constexpr uint64_t DEFAULT_JOURNAL_CHECKPOINT_BYTES = 64ull * 1024 * 1024;
+    
+    void setJournalEnabled(bool enabled);
+    bool isJournalEnabled() const;
+    void setJournalCheckpointBytes(uint64_t bytes) { journalCheckpointBytes_.store(bytes); }
+    bool checkpointJournal();
+    ChunkJournal::Stats getJournalStats() const;
+    
+    /**
+     * 预压缩区块数据包（见ChunkPacketStore）：静态地图的区块数据包编码压缩一次后存进region旁的
+     * 旁路文件，之后的加入直接读出帧发送。记录按区块在region头部中的保存时间戳失效，
+     * 开启期间本对象的每次保存也会立即清除对应记录
+     * formatTag由Java提供（协议版本等），与生成时不同的记录不会返回
+     */
+    void setPacketStoreEnabled(bool enabled);
+    bool isPacketStoreEnabled() const { return packetStoreEnabled_.load(); }
+    
+    /**
+     * 把区块的预压缩帧（VarInt(未压缩长度) + zlib，与ChunkPacketCache相同）写入acquireBuffer(size)
+     * 返回的缓冲区，返回写入的字节数；未开启、区块不存在或没有有效记录时返回0
+     */
+    size_t copyChunkPacket(int worldId, int chunkX, int chunkZ, uint32_t formatTag,
+                           const std::function<uint8_t*(size_t)>& acquireBuffer);
+    
+    /**
+     * 压缩Java编码好的区块数据包（包ID + 包体）并存入旁路文件，首次发送时或离线预生成时调用
+     * 区块必须已保存在region中（记录绑定它当前的保存时间戳）；未开启或失败时返回false
+     */
+    bool storeChunkPacket(int worldId, int chunkX, int chunkZ, uint32_t formatTag,
+                          const uint8_t* packet, size_t length, int level);
+    ChunkPacketStore::Stats getPacketStoreStats() const { return packetStore_.getStats(); }
+    
+    // 保存流水线配置与最近一次批量保存的阶段耗时
+    void setSavePipelineConfig(const SavePipeline::Config& config);
+    SavePipeline::Config getSavePipelineConfig() const;
+    SavePipeline::StageStats getLastSavePipelineStats() const;
     
     // 世界路径管理
-    void setWorldPath(const std::string& worldPath) { worldPath_ = worldPath; }
+    void setWorldPath(const std::string& worldPath) {
+        worldPath_ = worldPath;
+        chunkCache_.clear();
+        mappedRegions_.clear();
+        sectionCache_.clear();
+        packetStore_.clear();
+    }
     const std::string& getWorldPath() const { return worldPath_; }
     
 private:
@@ -196,9 +473,49 @@ private:
     mutable std::mutex ioMutex_;
     mutable AnvilPerformanceStats stats_;
     
-    // 简单缓存（可选实现）
-    std::unordered_map<std::string, std::shared_ptr<AnvilChunkData>> cache_;
-    mutable std::mutex cacheMutex_;
+    // region句柄缓存（打开的fd + 已解析的位置表，LRU淘汰）
+    RegionFileCache regionCache_;
+    
+    std::atomic<MinecraftCompressor::CompressionType> compressionType_{MinecraftCompressor::CompressionType::ZLIB};
+    std::shared_ptr<const ZstdDictionary> zstdDictionary_;
+    mutable std::mutex dictionaryMutex_;
+    
+    // 保存流水线：工作线程在各批次间复用，修改配置时替换（进行中的批次继续使用旧实例）
+    std::shared_ptr<SavePipeline> savePipeline();
+    SavePipeline::Config pipelineConfig_;
+    std::shared_ptr<SavePipeline> pipeline_;
+    mutable std::mutex pipelineMutex_;
+    SavePipeline::StageStats lastPipelineStats_;
+    mutable std::mutex pipelineStatsMutex_;
+    
+    // 解压后区块负载的热缓存
+    HotChunkCache chunkCache_;
+    
+    // 增量保存基线与整块内容指纹
+    SectionSaveCache sectionCache_;
+    std::atomic<bool> skipUnchangedSaves_{true};
+    
+    // 只读映射模式
+    std::atomic<bool> readOnlyMapped_{false};
+    MappedRegionCache mappedRegions_;
+    
+    // 预压缩区块数据包的旁路文件
+    ChunkPacketStore packetStore_;
+    std::atomic<bool> packetStoreEnabled_{false};
+    
+    // 区块存在索引（buildRegionIndex之前为空，查询回退到读取region头部）
+    RegionIndex regionIndex_;
+    
+    // 预写日志：保存持有共享锁（追加到写入region），检查点持有独占锁
+    std::unique_ptr<ChunkJournal> journal_;
+    mutable std::shared_mutex journalMutex_;
+    std::atomic<uint64_t> journalCheckpointBytes_{DEFAULT_JOURNAL_CHECKPOINT_BYTES};
+    std::unordered_set<std::string> journalDirtyRegions_;     // 上次检查点后写过的region
+    std::mutex journalDirtyMutex_;
+    
+    // 热区块缓存在MetricsRegistry中的回调指标，析构时移除
+    std::vector<uint64_t> metricCallbacks_;
+    void registerMetrics();
     
     // 区块在region中的位置计算
     void getRegionCoordinates(int chunkX, int chunkZ, int& regionX, int& regionZ, 
@@ -207,8 +524,37 @@ private:
     // 区块数据读写
     std::shared_ptr<AnvilChunkData> readChunkFromRegion(const std::string& regionPath,
                                                        int localX, int localZ);
+    // 热缓存命中或读盘解压后放入缓存；区块不存在时返回false，解压失败时抛出
+    bool acquireChunkPayload(int worldId, int chunkX, int chunkZ, HotChunkCache::Entry& entry);
+    // 只读映射模式下定位并解压区块；区块不存在时返回false
+    bool inflateMappedChunk(const std::string& regionPath, int localX, int localZ,
+                            std::vector<uint8_t>& nbt, uint32_t& timestamp);
+    void ensureWritable() const;
     void writeChunkToRegion(const std::string& regionPath, const AnvilChunkData& chunk,
                           int localX, int localZ);
+    
+    // 写入region并更新缓存、日志检查点与统计（saveChunkAsync / saveChunkDelta共用）
+    void persistChunk(const AnvilChunkData& chunk);
+    
+    // 批量导入替换region文件后丢弃其句柄、映射和所有区块的缓存
+    void invalidateRegion(const std::string& regionPath, int worldId, int regionX, int regionZ);
+    
+    // 区块在region头部中的保存时间戳（已建立索引时只查内存）；区块不存在时返回0
+    uint32_t chunkSaveTimestamp(const std::string& regionPath, int worldId, int chunkX, int chunkZ);
+    
+    // 写入后同步缓存：未压缩NBT直接写入缓存，已压缩记录使缓存失效
+    void updateCacheAfterWrite(const AnvilChunkData& chunk);
+    
+    // 经过日志（启用时）写入已压缩的记录
+    void commitFramed(const AnvilChunkData& chunk, const std::string& regionPath,
+                      const uint8_t* framed, size_t framedSize, int localX, int localZ);
+    void recoverJournal();
+    bool syncJournalDirtyRegions();
+    void checkpointJournalIfNeeded();
+    
+    // 写入已压缩的记录（framed[0]为CompressionType类型字节）
+    void writeFramedToRegion(const std::string& regionPath, const uint8_t* framed, size_t framedSize,
+                           int localX, int localZ, uint32_t timestamp);
 };
 
 // ===== 工具函数 =====
@@ -1,18 +1,42 @@
 #include "async_chunk_io.hpp"
+#include "../tracing.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
 #include <new>
 #include <cmath>
+#include <stdexcept>
 
 namespace lattice {
 namespace io {
 
 // ===== AsyncChunkIO 构造函数实现 =====
 
-AsyncChunkIO::AsyncChunkIO() 
-    : memoryArena_(net::MemoryArena::forThread()) {
+AsyncChunkIO::AsyncChunkIO(const BatchConfig& config) 
+    : memoryArena_(net::MemoryArena::forThread()),
+      config_(config),
+      storageFormat_(defaultStorageFormat_.load()) {
+    
+    IORequestScheduler::Config schedulerConfig;
+    schedulerConfig.maxInFlight = static_cast<size_t>(maxConcurrentIO_.load());
+    scheduler_ = std::make_unique<IORequestScheduler>(schedulerConfig);
     
-    // 创建默认的PlatformBackend实例
     try {
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+        // 优先使用io_uring；内核不支持（如容器禁用io_uring）时回退到同步POSIX后端
+        try {
+            backend_ = std::make_unique<LinuxIOUringBackend>(memoryArena_, config_);
+        } catch (const std::exception&) {
+            backend_ = std::make_unique<PlatformBackend>(memoryArena_);
+        }
+#else
         backend_ = std::make_unique<PlatformBackend>(memoryArena_);
+#endif
     } catch (const std::exception& e) {
         throw std::runtime_error(std::string("Failed to create I/O backend: ") + e.what());
     }
@@ -20,42 +44,114 @@ AsyncChunkIO::AsyncChunkIO()
 
 AsyncChunkIO::~AsyncChunkIO() = default;
 
+namespace {
+
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+std::string buildLegacyChunkPath(int worldId, int chunkX, int chunkZ) {
+    return "world" + std::to_string(worldId) + "/chunks/" +
+           std::to_string(chunkX) + "_" + std::to_string(chunkZ) + ".nbt";
+}
+
+} // namespace
+
 // ===== 异步加载实现 =====
 
-void AsyncChunkIO::loadChunkAsync(int worldId, int chunkX, int chunkZ, 
-                                   std::function<void(AsyncIOResult)> callback) {
+core::AsyncTask<AsyncIOResult> AsyncChunkIO::loadChunk(int worldId, int chunkX, int chunkZ,
+                                                       IORequestOptions options) {
+    co_return co_await core::awaitCallback<AsyncIOResult>(
+        core::NativeRuntime::instance().pool(), [&](auto resume) {
+            loadChunkAsync(worldId, chunkX, chunkZ, resume, options);
+        });
+}
+
+IORequestId AsyncChunkIO::loadChunkAsync(int worldId, int chunkX, int chunkZ, 
+                                         std::function<void(AsyncIOResult)> callback,
+                                         const IORequestOptions& options) {
     if (!backend_) {
         AsyncIOResult result;
         result.success = false;
         result.errorMessage = "Backend not initialized";
         callback(result);
-        return;
+        return INVALID_IO_REQUEST;
     }
     
-    // 构建文件路径
-    std::string worldPath = "world" + std::to_string(worldId);
-    std::string chunkPath = worldPath + "/chunks/" + 
-                           std::to_string(chunkX) + "_" + std::to_string(chunkZ) + ".nbt";
+    // 回调返回后归还调度槽位
+    IORequestScheduler* scheduler = scheduler_.get();
+    const uint64_t submitTime = nowMicros();
+    auto dispatch = [this, scheduler, submitTime, worldId, chunkX, chunkZ, callback]() {
+        IOMetrics::recordStage(IOStage::QUEUE_WAIT, nowMicros() - submitTime);
+        startLoad(worldId, chunkX, chunkZ, [scheduler, callback](AsyncIOResult result) {
+            callback(std::move(result));
+            scheduler->complete();
+        });
+    };
+    auto cancel = [worldId, chunkX, chunkZ, callback]() {
+        AsyncIOResult result;
+        result.success = false;
+        result.errorMessage = "Request cancelled";
+        result.chunk.x = chunkX;
+        result.chunk.z = chunkZ;
+        result.chunk.worldId = worldId;
+        result.completionTime = nowMicros();
+        callback(result);
+    };
+    
+    const IORequestId id = scheduler_->submit(options, std::move(dispatch), std::move(cancel));
+    if (core::Tracer::enabled()) {
+        const auto stats = scheduler_->getStats();
+        core::Tracer::instance().counter("chunk_io", "AsyncChunkIO queued", static_cast<int64_t>(stats.queued));
+        core::Tracer::instance().counter("chunk_io", "AsyncChunkIO in flight", static_cast<int64_t>(stats.inFlight));
+    }
+    return id;
+}
+
+void AsyncChunkIO::startLoad(int worldId, int chunkX, int chunkZ,
+                             std::function<void(AsyncIOResult)> callback) {
+    LATTICE_TRACE_SPAN("chunk_io", "AsyncChunkIO::startLoad");
+    const uint64_t startTime = nowMicros();
+    std::string chunkPath = buildLegacyChunkPath(worldId, chunkX, chunkZ);
     
-    // 计算文件偏移和大小
-    off_t offset = 0;
-    size_t size = 64 * 1024; // 默认64KB
+    int fd = ::open(chunkPath.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        if (fd >= 0) ::close(fd);
+        AsyncIOResult result;
+        result.success = false;
+        result.errorMessage = "Chunk not found";
+        result.completionTime = nowMicros();
+        callback(result);
+        return;
+    }
     
-    // 调用平台特定实现
-    backend_->loadChunkZeroCopy(-1, offset, size, 
-        [callback](char* buffer, size_t bytesRead) {
+    // 提交到后端后立即返回；io_uring后端由完成线程回调
+    PlatformBackend* backend = backend_.get();
+    backend_->loadChunkAsync(fd, 0, static_cast<size_t>(st.st_size),
+        [backend, fd, worldId, chunkX, chunkZ, startTime, callback](std::shared_ptr<uint8_t> buffer, size_t bytesRead) {
+            // 读盘阶段到后端回调为止，不含关闭文件和拷贝
+            const uint64_t readTime = nowMicros();
+            IOMetrics::recordStage(IOStage::DISK_READ, readTime - startTime);
+            LATTICE_TRACE_SPAN("chunk_io", "AsyncChunkIO::loadComplete");
+            backend->closeFileDescriptor(fd);
+            
             AsyncIOResult result;
+            result.chunk.x = chunkX;
+            result.chunk.z = chunkZ;
+            result.chunk.worldId = worldId;
             if (buffer && bytesRead > 0) {
+                const char* begin = reinterpret_cast<const char*>(buffer.get());
                 result.success = true;
-                result.chunk.data.assign(buffer, buffer + bytesRead);
-                result.chunk.dataSize();
+                result.chunk.data.assign(begin, begin + bytesRead);
             } else {
                 result.success = false;
                 result.errorMessage = "Failed to load chunk data";
             }
-            result.completionTime = std::chrono::duration_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now().time_since_epoch()
-            ).count();
+            result.completionTime = nowMicros();
+            IOMetrics::recordLoadTime(result.completionTime - startTime);
             callback(result);
         });
 }
@@ -96,46 +192,120 @@ void AsyncChunkIO::saveChunksBatch(const std::vector<ChunkData*>& chunks,
         return;
     }
     
+    LATTICE_TRACE_SPAN("chunk_io", "AsyncChunkIO::saveChunksBatch");
+    const uint64_t startTime = nowMicros();
+    
     // 优化批次（空间局部性排序）
     std::vector<ChunkData*> optimizedChunks = chunks;
     BatchOptimizer::optimizeBatch(optimizedChunks);
+    IOMetrics::recordBatchSize(optimizedChunks.size());
     
-    // 转换为平台特定的请求结构
-    struct BatchChunkData {
-        int worldId;
-        int x, z;
-        const char* data;
-        size_t size;
-    };
-    
-    std::vector<BatchChunkData> requests;
+    // 结果骨架在提交前构建：调用者可以在本函数返回后释放ChunkData
+    auto results = std::make_shared<std::vector<AsyncIOResult>>(optimizedChunks.size());
+    std::vector<PlatformBackend::WriteRequest> requests;
+    std::vector<size_t> requestSlots;   // requests[i]对应的results下标
     requests.reserve(optimizedChunks.size());
+    requestSlots.reserve(optimizedChunks.size());
     
-    for (const auto* chunk : optimizedChunks) {
-        requests.push_back(BatchChunkData{
-            chunk->worldId,
-            chunk->x, chunk->z,
-            chunk->data.data(),
-            chunk->data.size()
-        });
+    for (size_t i = 0; i < optimizedChunks.size(); ++i) {
+        const ChunkData* chunk = optimizedChunks[i];
+        AsyncIOResult& result = (*results)[i];
+        result.chunk.x = chunk->x;
+        result.chunk.z = chunk->z;
+        result.chunk.worldId = chunk->worldId;
+        result.chunk.lastModified = chunk->lastModified;
+        
+        std::string chunkPath = buildLegacyChunkPath(chunk->worldId, chunk->x, chunk->z);
+        int fd = ::open(chunkPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            result.success = false;
+            result.errorMessage = "Failed to open chunk file: " + chunkPath;
+            continue;
+        }
+        
+        // 数据拷贝到共享缓冲区，保证在异步写完成前有效
+        std::shared_ptr<uint8_t> buffer = backend_->acquireIOBuffer(chunk->data.size());
+        std::memcpy(buffer.get(), chunk->data.data(), chunk->data.size());
+        
+        requests.push_back(PlatformBackend::WriteRequest{fd, 0, std::move(buffer), chunk->data.size()});
+        requestSlots.push_back(i);
     }
     
-    // 调用平台特定的批量保存
-    backend_->saveChunksBatch(requests);
+    if (requests.empty()) {
+        callback(std::move(*results));
+        return;
+    }
     
-    // 简化处理：同步等待完成并返回结果
-    std::vector<AsyncIOResult> results;
-    for (size_t i = 0; i < chunks.size(); ++i) {
-        AsyncIOResult result;
-        result.success = true;
-        result.chunk = *chunks[i];
-        result.completionTime = std::chrono::duration_cast<std::chrono::microseconds>(
-            std::chrono::steady_clock::now().time_since_epoch()
-        ).count();
-        results.push_back(result);
+    std::vector<int> fds;
+    fds.reserve(requests.size());
+    for (const auto& request : requests) {
+        fds.push_back(request.fd);
     }
     
-    callback(results);
+    // 整批请求交给后端一次提交
+    PlatformBackend* backend = backend_.get();
+    backend_->writeBatchAsync(requests,
+        [backend, results, requestSlots = std::move(requestSlots), fds = std::move(fds),
+         startTime, callback](std::vector<bool> written) {
+            LATTICE_TRACE_SPAN("chunk_io", "AsyncChunkIO::saveComplete");
+            const uint64_t completionTime = nowMicros();
+            for (size_t i = 0; i < requestSlots.size(); ++i) {
+                backend->closeFileDescriptor(fds[i]);
+                AsyncIOResult& result = (*results)[requestSlots[i]];
+                result.success = i < written.size() && written[i];
+                if (!result.success) {
+                    result.errorMessage = "Write failed";
+                }
+                result.completionTime = completionTime;
+            }
+            IOMetrics::recordSaveTime(completionTime - startTime);
+            callback(std::move(*results));
+        });
+}
+
+// ===== 默认后端实现（同步POSIX I/O） =====
+
+void AsyncChunkIO::PlatformBackend::loadChunkAsync(int fd, off_t offset, size_t size,
+                                                   std::function<void(std::shared_ptr<uint8_t>, size_t)> callback) {
+    std::shared_ptr<uint8_t> buffer(new uint8_t[size], std::default_delete<uint8_t[]>());
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pread(fd, buffer.get() + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    callback(done > 0 ? buffer : nullptr, done);
+}
+
+void AsyncChunkIO::PlatformBackend::saveChunkAsync(int fd, off_t offset, const std::shared_ptr<uint8_t>& data, size_t size,
+                                                   std::function<void(bool, std::string)> callback) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pwrite(fd, data.get() + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    bool success = done == size;
+    callback(success, success ? "" : std::string("Write failed: ") + std::strerror(errno));
+}
+
+void AsyncChunkIO::PlatformBackend::writeBatchAsync(const std::vector<WriteRequest>& requests,
+                                                    std::function<void(std::vector<bool>)> callback) {
+    std::vector<bool> written(requests.size(), false);
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const auto& request = requests[i];
+        saveChunkAsync(request.fd, request.offset, request.data, request.size,
+            [&written, i](bool success, std::string) { written[i] = success; });
+    }
+    callback(std::move(written));
+}
+
+void AsyncChunkIO::PlatformBackend::closeFileDescriptor(int fd) {
+    if (fd >= 0) {
+        ::close(fd);
+    }
 }
 
 // ===== 静态方法实现 =====
@@ -186,40 +356,51 @@ void AsyncChunkIO::warmupThreadPool() {
 
 std::atomic<int> AsyncChunkIO::maxConcurrentIO_{8};
 std::atomic<bool> AsyncChunkIO::directIOEnabled_{false};
+std::atomic<StorageFormat> AsyncChunkIO::defaultStorageFormat_{StorageFormat::LEGACY};
+std::atomic<AsyncChunkIO::CompressionFormat> AsyncChunkIO::compressionFormat_{AsyncChunkIO::CompressionFormat::ZLIB_ONLY};
 
-// ===== 平台特性检测实现 =====
-
-PlatformFeatures PlatformBackend::detectPlatformFeatures() {
-    PlatformFeatures features;
-    
-#if defined(__linux__)
-    // Linux 平台检测
-    features.io_uring = true;  // 假设支持io_uring
-    features.direct_io = true;
-#elif defined(__APPLE__)
-    // macOS 平台检测
-    features.apfs = true;
-    features.apple_silicon = true; // 简化处理
-#elif defined(_WIN32)
-    // Windows 平台检测
-    features.iocp = true;
-#endif
-    
-    return features;
+void AsyncChunkIO::setStorageFormat(StorageFormat format) {
+    defaultStorageFormat_ = format;
 }
 
-// ===== 全局方法实现 =====
+StorageFormat AsyncChunkIO::getDefaultStorageFormat() {
+    return defaultStorageFormat_.load();
+}
 
-MemoryMappedRegion::MemoryMappedRegion(const std::string& filePath, size_t size, bool readOnly) {
-    // 简化实现
-    impl_ = nullptr; // 实际需要根据平台实现
+StorageFormat AsyncChunkIO::detectStorageFormat(const std::string& worldPath) const {
+    // 只看主世界region目录里的文件名，不打开任何文件；遇到第一个可识别的文件即返回
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::directory_iterator it(fs::path(worldPath) / "region", ec);
+    if (ec) {
+        return StorageFormat::LEGACY;
+    }
+    for (; it != fs::directory_iterator(); it.increment(ec)) {
+        if (ec) {
+            break;
+        }
+        const std::string extension = it->path().extension().string();
+        if (extension == ".linear") {
+            return StorageFormat::LINEAR;
+        }
+        if (extension == ".mca") {
+            return StorageFormat::ANVIL;
+        }
+    }
+    return StorageFormat::LEGACY;
 }
 
-MemoryMappedRegion::~MemoryMappedRegion() = default;
+bool AsyncChunkIO::isAnvilFormatAvailable(const std::string& worldPath) const {
+    return detectStorageFormat(worldPath) == StorageFormat::ANVIL;
+}
 
-void* MemoryMappedRegion::data() const { return nullptr; }
+void AsyncChunkIO::setCompressionFormat(CompressionFormat format) {
+    compressionFormat_ = format;
+}
 
-size_t MemoryMappedRegion::size() const { return 0; }
+AsyncChunkIO::CompressionFormat AsyncChunkIO::getCompressionFormat() {
+    return compressionFormat_.load();
+}
 
 // ===== 批处理优化器实现 =====
 
@@ -239,30 +420,5 @@ float BatchOptimizer::spatialDistance(int x1, int z1, int x2, int z2) {
     return std::sqrt((x1 - x2) * (x1 - x2) + (z1 - z2) * (z1 - z2));
 }
 
-// ===== 性能监控实现 =====
-
-IOMetrics::Stats IOMetrics::stats_{};
-
-void IOMetrics::recordLoadTime(uint64_t microseconds) {
-    stats_.totalLoads++;
-    stats_.totalLoadTime += microseconds;
-}
-
-void IOMetrics::recordSaveTime(uint64_t microseconds) {
-    stats_.totalSaves++;
-    stats_.totalSaveTime += microseconds;
-}
-
-void IOMetrics::recordBatchSize(size_t chunkCount) {
-    uint64_t current = stats_.maxBatchSize.load();
-    while (chunkCount > current) {
-        stats_.maxBatchSize.compare_exchange_weak(current, chunkCount);
-    }
-}
-
-const IOMetrics::Stats& IOMetrics::getStats() {
-    return stats_;
-}
-
 } // namespace io
 } // namespace lattice
\ No newline at end of file
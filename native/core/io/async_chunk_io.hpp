@@ -6,9 +6,21 @@
 #include <cstdint>
 #include <functional>
 #include <atomic>
+#include <exception>
+#include "../async_task.hpp"
+#include "../slab_allocator.hpp"
 #include "../net/native_compressor.hpp"
 #include "../net/memory_arena.hpp"
 #include "io_types.hpp"
+#include "io_metrics.hpp"
+#include "io_scheduler.hpp"
+#include "memory_mapped_region.hpp"
+
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+#include <liburing.h>
+#include <mutex>
+#include <thread>
+#endif
 
 namespace lattice {
 namespace io {
@@ -17,12 +29,26 @@ namespace io {
 
 class AsyncChunkIO {
 public:
-    AsyncChunkIO();
+    explicit AsyncChunkIO(const BatchConfig& config = BatchConfig{});
     ~AsyncChunkIO();
     
-    // 异步加载区块（零拷贝）
-    void loadChunkAsync(int worldId, int chunkX, int chunkZ, 
-                       std::function<void(AsyncIOResult)> callback);
+    /**
+     * 异步加载区块（零拷贝）
+     * 请求按options.priority进入调度队列（见IORequestScheduler），返回的ID可用于
+     * promoteRequest/cancelRequest；被取消的请求以"Request cancelled"失败回调
+     */
+    IORequestId loadChunkAsync(int worldId, int chunkX, int chunkZ, 
+                              std::function<void(AsyncIOResult)> callback,
+                              const IORequestOptions& options = IORequestOptions{});
+    
+    // 协程版本：co_await io.loadChunk(...)；完成后在NativeRuntime的共享线程池上继续，不占用I/O完成线程
+    core::AsyncTask<AsyncIOResult> loadChunk(int worldId, int chunkX, int chunkZ,
+                                             IORequestOptions options = IORequestOptions{});
+    
+    // 调整/取消仍在排队的加载请求；已开始读取时返回false
+    bool promoteRequest(IORequestId id, IOPriority priority) { return scheduler_->promote(id, priority); }
+    bool cancelRequest(IORequestId id) { return scheduler_->cancel(id); }
+    IORequestScheduler::Stats getSchedulerStats() const { return scheduler_->getStats(); }
     
     // 异步保存区块（批处理）
     void saveChunkAsync(const ChunkData& chunk, 
@@ -78,6 +104,7 @@ public:
     AsyncChunkIO& operator=(AsyncChunkIO&&) = delete;
 
     // 平台特定后端完整定义
+    // 基类提供同步pread/pwrite实现，作为没有异步I/O能力平台的回退
     class PlatformBackend {
     public:
         PlatformBackend(lattice::net::MemoryArena& arena) : memoryArena_(arena) {}
@@ -85,14 +112,22 @@ public:
         
         // 基本异步I/O操作
         virtual void loadChunkAsync(int fd, off_t offset, size_t size,
-                                  std::function<void(std::shared_ptr<uint8_t>, size_t)> callback) {
-            callback(nullptr, 0); // 默认空实现
-        }
+                                  std::function<void(std::shared_ptr<uint8_t>, size_t)> callback);
         
         virtual void saveChunkAsync(int fd, off_t offset, const std::shared_ptr<uint8_t>& data, size_t size,
-                                  std::function<void(bool, std::string)> callback) {
-            callback(true, ""); // 默认成功
-        }
+                                  std::function<void(bool, std::string)> callback);
+        
+        // 批量写请求：后端可以把整批请求放进一次提交
+        struct WriteRequest {
+            int fd;
+            off_t offset;
+            std::shared_ptr<uint8_t> data;
+            size_t size;
+        };
+        
+        // 回调参数与requests一一对应（true = 写入成功）
+        virtual void writeBatchAsync(const std::vector<WriteRequest>& requests,
+                                   std::function<void(std::vector<bool>)> callback);
         
         virtual void saveChunksBatch(const std::vector<std::shared_ptr<ChunkData>>& chunks,
                                    std::function<void(std::vector<AsyncIOResult>)> callback) {
@@ -100,8 +135,13 @@ public:
             callback(results);
         }
         
+        // 返回MemoryMappedRegion；映射失败时返回nullptr
         virtual std::shared_ptr<void> memoryMapFile(const std::string& filepath, size_t size, bool read_only) {
-            return nullptr;
+            try {
+                return std::make_shared<MemoryMappedRegion>(filepath, size, read_only);
+            } catch (const std::exception&) {
+                return nullptr;
+            }
         }
         
         virtual PlatformFeatures getPlatformFeatures() const {
@@ -114,12 +154,20 @@ public:
             return features;
         }
         
-        virtual void closeFileDescriptor(int fd) {}
+        virtual void closeFileDescriptor(int fd);
         
-    private:
+        // I/O缓冲区：支持注册缓冲区的后端返回预先注册的内存，否则普通堆分配
+        virtual std::shared_ptr<uint8_t> acquireIOBuffer(size_t size) {
+            return std::shared_ptr<uint8_t>(new uint8_t[size], std::default_delete<uint8_t[]>());
+        }
+        
+    protected:
         lattice::net::MemoryArena& memoryArena_;
     };
     
+    // 加载请求调度器；声明在backend_之前，保证后端完成线程退出后才析构
+    std::unique_ptr<IORequestScheduler> scheduler_;
+    
     std::unique_ptr<PlatformBackend> backend_;
     
     // 内存池（使用 MemoryArena 实现）
@@ -132,29 +180,83 @@ public:
     static std::atomic<CompressionFormat> compressionFormat_;
     
     // 实例级配置
+    BatchConfig config_;
     StorageFormat storageFormat_;
+    
+private:
+    // 调度器派发后实际发起读取
+    void startLoad(int worldId, int chunkX, int chunkZ, std::function<void(AsyncIOResult)> callback);
 };
 
-// ===== 内存映射区域 =====
+// ===== Linux io_uring后端 =====
+// 生产环境Linux后端：提交队列深度取自BatchConfig，批量请求一次io_uring_submit，
+// 独立的完成线程处理CQE并调用回调，加载请求不再占用工作线程做同步读取
 
-class MemoryMappedRegion {
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+class LinuxIOUringBackend : public AsyncChunkIO::PlatformBackend {
 public:
-    class PlatformImpl;
+    LinuxIOUringBackend(lattice::net::MemoryArena& arena, const BatchConfig& config);
+    ~LinuxIOUringBackend() override;
+    
+    void loadChunkAsync(int fd, off_t offset, size_t size,
+                       std::function<void(std::shared_ptr<uint8_t>, size_t)> callback) override;
+    
+    void saveChunkAsync(int fd, off_t offset, const std::shared_ptr<uint8_t>& data, size_t size,
+                       std::function<void(bool, std::string)> callback) override;
+    
+    void writeBatchAsync(const std::vector<WriteRequest>& requests,
+                        std::function<void(std::vector<bool>)> callback) override;
+    
+    PlatformFeatures getPlatformFeatures() const override;
     
-    MemoryMappedRegion(const std::string& filePath, size_t size, bool readOnly);
-    ~MemoryMappedRegion();
+    void closeFileDescriptor(int fd) override;
     
-    void* data() const;
-    size_t size() const;
-    bool isValid() const { return impl_ != nullptr; }
+    std::shared_ptr<uint8_t> acquireIOBuffer(size_t size) override;
     
-    // 禁止拷贝
-    MemoryMappedRegion(const MemoryMappedRegion&) = delete;
-    MemoryMappedRegion& operator=(const MemoryMappedRegion&) = delete;
+    size_t getInFlightCount() const { return inFlight_.load(std::memory_order_relaxed); }
+    bool registeredBuffersActive() const { return fixedBuffers_ != nullptr; }
     
 private:
-    std::unique_ptr<PlatformImpl> impl_;
+    // 注册到ring的固定缓冲区池；由shared_ptr持有，保证借出的缓冲区比后端活得久
+    struct FixedBufferPool;
+    std::shared_ptr<FixedBufferPool> fixedBuffers_;
+    
+    void setupRegisteredBuffers();
+    
+    // 为SQE选择固定缓冲区。调用者持有submitMutex_
+    void prepRead(io_uring_sqe* sqe, int fd, uint8_t* buffer, size_t size, off_t offset);
+    void prepWrite(io_uring_sqe* sqe, int fd, const uint8_t* data, size_t size, off_t offset);
+    
+    // 每个SQE关联的上下文，完成时由完成线程释放
+    // 提交线程分配、完成线程释放，走SlabAllocator的无锁跨线程释放（成员函数形式以保持聚合初始化）
+    struct IOContext {
+        int fd;
+        off_t offset;
+        size_t size;
+        std::shared_ptr<uint8_t> buffer;
+        std::function<void(std::shared_ptr<uint8_t>, size_t)> readCallback;
+        std::function<void(bool, std::string)> writeCallback;
+
+        static void* operator new(size_t bytes) { return core::SlabAllocator::instance().allocate(bytes); }
+        static void operator delete(void* ptr, size_t bytes) noexcept {
+            core::SlabAllocator::instance().deallocate(ptr, bytes);
+        }
+    };
+    
+    io_uring ring_;
+    BatchConfig config_;
+    std::mutex submitMutex_;          // 保护提交队列（SQ仅允许单生产者）
+    std::thread completionThread_;
+    std::atomic<bool> running_{false};
+    std::atomic<size_t> inFlight_{0};
+    
+    // 获取SQE；提交队列已满时先提交已准备的请求再重试。调用者持有submitMutex_
+    io_uring_sqe* acquireSqeLocked();
+    
+    void completionLoop();
+    void handleCompletion(IOContext* ctx, int result);
 };
+#endif
 
 // ===== 批处理优化器 =====
 
@@ -164,28 +266,6 @@ public:
     static float spatialDistance(int x1, int z1, int x2, int z2);
 };
 
-// ===== 性能监控 =====
-
-class IOMetrics {
-public:
-    static void recordLoadTime(uint64_t microseconds);
-    static void recordSaveTime(uint64_t microseconds);
-    static void recordBatchSize(size_t chunkCount);
-    
-    struct Stats {
-        std::atomic<uint64_t> totalLoads{0};
-        std::atomic<uint64_t> totalSaves{0};
-        std::atomic<uint64_t> totalLoadTime{0};
-        std::atomic<uint64_t> totalSaveTime{0};
-        std::atomic<uint64_t> maxBatchSize{0};
-    };
-    
-    static const Stats& getStats();
-    
-private:
-    static Stats stats_;
-};
-
 // ===== 平台特定实现 =====
 // 平台特定实现在相应的 .cpp 文件中
 
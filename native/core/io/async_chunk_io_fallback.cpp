@@ -149,49 +149,6 @@ private:
     }
 };
 
-// ===== Memory Mapped Region (Fallback) =====
-
-class MemoryMappedRegion::PlatformImpl {
-public:
-    PlatformImpl(const std::string& filePath, size_t size, bool readOnly)
-        : fd_(-1), address_(nullptr), size_(size) {
-        
-        // 打开文件
-        int flags = readOnly ? O_RDONLY : O_RDWR;
-        fd_ = open(filePath.c_str(), flags | O_CREAT, 0644);
-        if (fd_ == -1) {
-            throw std::runtime_error("Failed to open file: " + std::string(strerror(errno)));
-        }
-        
-        // 确保文件大小
-        if (!readOnly && ftruncate(fd_, size) == -1) {
-            close(fd_);
-            throw std::runtime_error("Failed to truncate file: " + std::string(strerror(errno)));
-        }
-        
-        // 内存映射
-        int prot = readOnly ? PROT_READ : (PROT_READ | PROT_WRITE);
-        address_ = mmap(nullptr, size, prot, MAP_SHARED, fd_, 0);
-        if (address_ == MAP_FAILED) {
-            close(fd_);
-            throw std::runtime_error("mmap failed: " + std::string(strerror(errno)));
-        }
-    }
-    
-    ~PlatformImpl() {
-        if (address_) munmap(address_, size_);
-        if (fd_ != -1) close(fd_);
-    }
-    
-    void* data() const { return address_; }
-    size_t size() const { return size_; }
-
-private:
-    int fd_;
-    void* address_;
-    size_t size_;
-};
-
 // ===== 平台特性检测 (Fallback) =====
 
 PlatformFeatures AsyncChunkIO::detectPlatformFeatures() {
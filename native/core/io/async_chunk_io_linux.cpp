@@ -1,19 +1,345 @@
 #include "async_chunk_io.hpp"
-#include <iostream>
+#include "../native_runtime.hpp"
+
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <stdexcept>
 
 namespace lattice {
 namespace io {
 
-// Linux-specific async chunk I/O implementation
-void AsyncChunkIO::initializeLinuxSpecific() {
-    std::cout << "Initializing Linux-specific async chunk I/O with io_uring" << std::endl;
-    // Linux-specific initialization would go here
+// ===== Linux io_uring后端实现 =====
+
+namespace {
+
+// 完成线程等待CQE的超时，用于及时响应关闭请求
+constexpr long long COMPLETION_WAIT_TIMEOUT_NS = 50 * 1000 * 1000;
+// 等待CQE出错时的退避：从1ms起倍增，最长100ms，成功取到CQE后复位
+constexpr int COMPLETION_ERROR_BACKOFF_MAX_MS = 100;
+
+// 批量写入的共享状态：最后一个完成的请求负责回调
+struct BatchWriteState {
+    std::vector<bool> written;
+    std::atomic<size_t> remaining;
+    std::function<void(std::vector<bool>)> callback;
+
+    BatchWriteState(size_t count, std::function<void(std::vector<bool>)> cb)
+        : written(count, false), remaining(count), callback(std::move(cb)) {}
+};
+
+} // namespace
+
+// ===== 注册缓冲区池 =====
+// 一次分配fixedBufferCount个等长缓冲区，整体注册到ring；
+// 借出的缓冲区通过索引换回，READ_FIXED/WRITE_FIXED无需每次内核页表映射
+struct LinuxIOUringBackend::FixedBufferPool {
+    uint8_t* base = nullptr;
+    size_t bufferSize = 0;
+    size_t count = 0;
+    std::mutex mutex;
+    std::vector<size_t> freeList;
+
+    FixedBufferPool(size_t bufferCount, size_t size) : bufferSize(size), count(bufferCount) {
+        base = static_cast<uint8_t*>(::operator new(bufferSize * count, std::align_val_t{4096}));
+        freeList.reserve(count);
+        for (size_t i = count; i > 0; --i) {
+            freeList.push_back(i - 1);
+        }
+    }
+
+    ~FixedBufferPool() {
+        ::operator delete(base, std::align_val_t{4096});
+    }
+
+    uint8_t* acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeList.empty()) {
+            return nullptr;
+        }
+        size_t index = freeList.back();
+        freeList.pop_back();
+        return base + index * bufferSize;
+    }
+
+    void release(uint8_t* buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeList.push_back(static_cast<size_t>(buffer - base) / bufferSize);
+    }
+
+    // 缓冲区在池内时返回其注册索引，否则返回-1
+    int indexOf(const uint8_t* ptr) const {
+        if (ptr < base || ptr >= base + bufferSize * count) {
+            return -1;
+        }
+        return static_cast<int>(static_cast<size_t>(ptr - base) / bufferSize);
+    }
+};
+
+LinuxIOUringBackend::LinuxIOUringBackend(lattice::net::MemoryArena& arena, const BatchConfig& config)
+    : PlatformBackend(arena), config_(config) {
+
+    // 提交队列深度取自BatchConfig；完成队列加倍，避免批量提交时CQ溢出
+    io_uring_params params{};
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = static_cast<uint32_t>(std::max<size_t>(config_.ioQueueDepth, 1) * 2);
+
+    unsigned entries = static_cast<unsigned>(std::max<size_t>(config_.ioQueueDepth, 1));
+    int ret = io_uring_queue_init_params(entries, &ring_, &params);
+    if (ret < 0) {
+        throw std::runtime_error(std::string("Failed to initialize io_uring: ") + std::strerror(-ret));
+    }
+
+    if (config_.registeredBuffers) {
+        setupRegisteredBuffers();
+    }
+
+    running_ = true;
+    completionThread_ = core::NativeRuntime::instance().startThread(
+        core::NativeSubsystem::CHUNK_IO, [this] { completionLoop(); });
+}
+
+LinuxIOUringBackend::~LinuxIOUringBackend() {
+    // 完成线程在所有在途请求完成后退出
+    running_ = false;
+    if (completionThread_.joinable()) {
+        completionThread_.join();
+    }
+    if (fixedBuffers_) {
+        io_uring_unregister_buffers(&ring_);
+    }
+    io_uring_queue_exit(&ring_);
+}
+
+void LinuxIOUringBackend::setupRegisteredBuffers() {
+    if (config_.fixedBufferCount == 0 || config_.fixedBufferSize == 0) {
+        return;
+    }
+
+    auto pool = std::make_shared<FixedBufferPool>(config_.fixedBufferCount, config_.fixedBufferSize);
+    std::vector<iovec> iovecs(pool->count);
+    for (size_t i = 0; i < pool->count; ++i) {
+        iovecs[i].iov_base = pool->base + i * pool->bufferSize;
+        iovecs[i].iov_len = pool->bufferSize;
+    }
+
+    // RLIMIT_MEMLOCK不足时注册失败，退回普通缓冲区
+    int ret = io_uring_register_buffers(&ring_, iovecs.data(), static_cast<unsigned>(iovecs.size()));
+    if (ret == 0) {
+        fixedBuffers_ = std::move(pool);
+    }
 }
 
-void AsyncChunkIO::performLinuxAsyncOperation(int chunkX, int chunkZ) {
-    std::cout << "Performing Linux async operation for chunk (" << chunkX << ", " << chunkZ << ")" << std::endl;
-    // Linux-specific async I/O operation
+std::shared_ptr<uint8_t> LinuxIOUringBackend::acquireIOBuffer(size_t size) {
+    if (fixedBuffers_ && size <= fixedBuffers_->bufferSize) {
+        if (uint8_t* buffer = fixedBuffers_->acquire()) {
+            // 删除器持有池的引用，缓冲区归还前池不会被释放
+            std::shared_ptr<FixedBufferPool> pool = fixedBuffers_;
+            return std::shared_ptr<uint8_t>(buffer, [pool](uint8_t* p) { pool->release(p); });
+        }
+    }
+    return PlatformBackend::acquireIOBuffer(size);
+}
+
+void LinuxIOUringBackend::prepRead(io_uring_sqe* sqe, int fd, uint8_t* buffer, size_t size, off_t offset) {
+    int bufIndex = fixedBuffers_ ? fixedBuffers_->indexOf(buffer) : -1;
+    if (bufIndex >= 0) {
+        io_uring_prep_read_fixed(sqe, fd, buffer, static_cast<unsigned>(size),
+                                 static_cast<uint64_t>(offset), bufIndex);
+    } else {
+        io_uring_prep_read(sqe, fd, buffer, static_cast<unsigned>(size), static_cast<uint64_t>(offset));
+    }
+}
+
+void LinuxIOUringBackend::prepWrite(io_uring_sqe* sqe, int fd, const uint8_t* data, size_t size, off_t offset) {
+    int bufIndex = fixedBuffers_ ? fixedBuffers_->indexOf(data) : -1;
+    if (bufIndex >= 0) {
+        io_uring_prep_write_fixed(sqe, fd, data, static_cast<unsigned>(size),
+                                  static_cast<uint64_t>(offset), bufIndex);
+    } else {
+        io_uring_prep_write(sqe, fd, data, static_cast<unsigned>(size), static_cast<uint64_t>(offset));
+    }
+}
+
+io_uring_sqe* LinuxIOUringBackend::acquireSqeLocked() {
+    io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+    if (!sqe) {
+        // SQ已满：提交已准备的请求，腾出空间
+        io_uring_submit(&ring_);
+        sqe = io_uring_get_sqe(&ring_);
+    }
+    return sqe;
+}
+
+void LinuxIOUringBackend::loadChunkAsync(int fd, off_t offset, size_t size,
+                                         std::function<void(std::shared_ptr<uint8_t>, size_t)> callback) {
+    std::shared_ptr<uint8_t> buffer = acquireIOBuffer(size);
+    auto* ctx = new IOContext{fd, offset, size, buffer, std::move(callback), nullptr};
+
+    {
+        std::lock_guard<std::mutex> lock(submitMutex_);
+        io_uring_sqe* sqe = acquireSqeLocked();
+        if (!sqe) {
+            auto cb = std::move(ctx->readCallback);
+            delete ctx;
+            cb(nullptr, 0);
+            return;
+        }
+
+        prepRead(sqe, fd, buffer.get(), size, offset);
+        io_uring_sqe_set_data(sqe, ctx);
+        inFlight_.fetch_add(1, std::memory_order_relaxed);
+
+        // 加载是延迟敏感的，立即提交
+        io_uring_submit(&ring_);
+    }
+}
+
+void LinuxIOUringBackend::saveChunkAsync(int fd, off_t offset, const std::shared_ptr<uint8_t>& data, size_t size,
+                                         std::function<void(bool, std::string)> callback) {
+    auto* ctx = new IOContext{fd, offset, size, data, nullptr, std::move(callback)};
+
+    std::lock_guard<std::mutex> lock(submitMutex_);
+    io_uring_sqe* sqe = acquireSqeLocked();
+    if (!sqe) {
+        auto cb = std::move(ctx->writeCallback);
+        delete ctx;
+        cb(false, "Failed to get SQE");
+        return;
+    }
+
+    prepWrite(sqe, fd, data.get(), size, offset);
+    io_uring_sqe_set_data(sqe, ctx);
+    inFlight_.fetch_add(1, std::memory_order_relaxed);
+    io_uring_submit(&ring_);
+}
+
+void LinuxIOUringBackend::writeBatchAsync(const std::vector<WriteRequest>& requests,
+                                          std::function<void(std::vector<bool>)> callback) {
+    if (requests.empty()) {
+        callback({});
+        return;
+    }
+
+    auto state = std::make_shared<BatchWriteState>(requests.size(), std::move(callback));
+    const size_t submitBatch = std::max<size_t>(config_.maxBatchSize, 1);
+
+    std::lock_guard<std::mutex> lock(submitMutex_);
+    size_t prepared = 0;
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const auto& request = requests[i];
+        auto* ctx = new IOContext{request.fd, request.offset, request.size, request.data, nullptr,
+            [state, i](bool success, std::string) {
+                state->written[i] = success;
+                if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    state->callback(std::move(state->written));
+                }
+            }};
+
+        io_uring_sqe* sqe = acquireSqeLocked();
+        if (!sqe) {
+            handleCompletion(ctx, -EAGAIN);
+            continue;
+        }
+
+        prepWrite(sqe, request.fd, request.data.get(), request.size, request.offset);
+        io_uring_sqe_set_data(sqe, ctx);
+        inFlight_.fetch_add(1, std::memory_order_relaxed);
+
+        // 每maxBatchSize个请求提交一次，而不是每个请求一次系统调用
+        if (++prepared == submitBatch) {
+            io_uring_submit(&ring_);
+            prepared = 0;
+        }
+    }
+
+    if (prepared > 0) {
+        io_uring_submit(&ring_);
+    }
+}
+
+void LinuxIOUringBackend::completionLoop() {
+    int backoffMs = 0;
+    while (running_.load(std::memory_order_acquire) || inFlight_.load(std::memory_order_acquire) > 0) {
+        io_uring_cqe* cqe = nullptr;
+        __kernel_timespec timeout{0, COMPLETION_WAIT_TIMEOUT_NS};
+
+        int ret = io_uring_wait_cqe_timeout(&ring_, &cqe, &timeout);
+        if (ret == -ETIME || ret == -EINTR) {
+            continue;
+        }
+        if (ret < 0 || !cqe) {
+            // 其他错误（-EBUSY、-ENOMEM等）多半不会立刻消失，立即重试只会空转占满一个核
+            if (backoffMs == 0) {
+                fprintf(stderr, "[Lattice] io_uring completion wait failed: %s, backing off\n",
+                        std::strerror(ret < 0 ? -ret : EAGAIN));
+            }
+            backoffMs = std::min(backoffMs > 0 ? backoffMs * 2 : 1, COMPLETION_ERROR_BACKOFF_MAX_MS);
+            std::this_thread::sleep_for(std::chrono::milliseconds(backoffMs));
+            continue;
+        }
+        backoffMs = 0;
+
+        // 一次唤醒处理所有已就绪的CQE
+        do {
+            auto* ctx = static_cast<IOContext*>(io_uring_cqe_get_data(cqe));
+            int result = cqe->res;
+            io_uring_cqe_seen(&ring_, cqe);
+
+            if (ctx) {
+                inFlight_.fetch_sub(1, std::memory_order_acq_rel);
+                handleCompletion(ctx, result);
+            }
+        } while (io_uring_peek_cqe(&ring_, &cqe) == 0 && cqe);
+    }
+}
+
+void LinuxIOUringBackend::handleCompletion(IOContext* ctx, int result) {
+    std::unique_ptr<IOContext> owned(ctx);
+
+    if (owned->readCallback) {
+        if (result > 0) {
+            owned->readCallback(owned->buffer, static_cast<size_t>(result));
+        } else {
+            owned->readCallback(nullptr, 0);
+        }
+        return;
+    }
+
+    if (owned->writeCallback) {
+        bool success = result >= 0 && static_cast<size_t>(result) == owned->size;
+        if (success) {
+            owned->writeCallback(true, "");
+        } else if (result < 0) {
+            owned->writeCallback(false, std::string("Write failed: ") + std::strerror(-result));
+        } else {
+            owned->writeCallback(false, "Short write");
+        }
+    }
+}
+
+PlatformFeatures LinuxIOUringBackend::getPlatformFeatures() const {
+    PlatformFeatures features;
+    features.io_uring = true;
+    features.direct_io = true;
+    features.registered_buffers = fixedBuffers_ != nullptr;
+    return features;
+}
+
+void LinuxIOUringBackend::closeFileDescriptor(int fd) {
+    if (fd >= 0) {
+        ::close(fd);
+    }
 }
 
 } // namespace io
-} // namespace lattice
\ No newline at end of file
+} // namespace lattice
+
+#endif // __linux__ && LATTICE_HAS_IO_URING
@@ -0,0 +1,639 @@
+#include "bulk_region_importer.hpp"
+#include "anvil_format.hpp"
+#include "region_file.hpp"
+#include "../net/arena_page_allocator.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <stdexcept>
+
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+#include <liburing.h>
+#endif
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+inline void writeBigEndian32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+inline uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+bool writeFully(int fd, const uint8_t* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::write(fd, data + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void syncDirectory(const std::filesystem::path& directory) {
+    int dirFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+
+// ioprio_set参数（linux/ioprio.h）：IOPRIO_CLASS_IDLE，作用于调用线程
+constexpr int IOPRIO_CLASS_IDLE_VALUE = 3 << 13;
+constexpr int IOPRIO_WHO_PROCESS_VALUE = 1;
+
+void setIdleIOPriority() {
+#if defined(__linux__) && defined(SYS_ioprio_set)
+    if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS_VALUE, 0, IOPRIO_CLASS_IDLE_VALUE) != 0) {
+        fprintf(stderr, "[BulkRegionImporter] ioprio_set failed: %s\n", strerror(errno));
+    }
+#endif
+}
+
+bool pwriteFully(int fd, const uint8_t* data, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pwrite(fd, data + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            errno = EIO;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 镜像中的一条区块记录；payload指向压缩输出、输入数据或保留的旧记录
+struct ImageEntry {
+    const uint8_t* payload{nullptr};
+    size_t payloadSize{0};
+    uint8_t compressionId{0};
+    uint32_t timestamp{0};
+};
+
+} // namespace
+
+// ===== DirectWriter =====
+
+/**
+ * 写入线程独占：一块可复用的扇区对齐缓冲区，以及io_uring（编译支持且内核允许时）
+ * 镜像按SEGMENT_SIZE分段，最多QUEUE_DEPTH段同时在途
+ */
+class BulkRegionImporter::DirectWriter {
+public:
+    static constexpr size_t SEGMENT_SIZE = 1024 * 1024;
+    static constexpr unsigned QUEUE_DEPTH = 8;
+
+    explicit DirectWriter(bool idlePriority) : idlePriority_(idlePriority) {
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+        ringReady_ = io_uring_queue_init(QUEUE_DEPTH, &ring_, 0) == 0;
+#endif
+    }
+
+    ~DirectWriter() {
+        if (buffer_.ptr) {
+            net::ArenaPageAllocator::instance().release(buffer_);
+        }
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+        if (ringReady_) {
+            io_uring_queue_exit(&ring_);
+        }
+#endif
+    }
+
+    DirectWriter(const DirectWriter&) = delete;
+    DirectWriter& operator=(const DirectWriter&) = delete;
+
+    // 已清零的对齐缓冲区（O_DIRECT要求地址、长度与偏移都按扇区对齐）
+    uint8_t* acquire(size_t size) {
+        if (buffer_.size < size) {
+            if (buffer_.ptr) {
+                net::ArenaPageAllocator::instance().release(buffer_);
+            }
+            buffer_ = net::ArenaPageAllocator::instance().allocate(size, REGION_SECTOR_SIZE);
+            if (!buffer_.ptr) {
+                buffer_ = net::ArenaPageAllocator::Allocation{};
+                throw std::bad_alloc();
+            }
+        }
+        std::memset(buffer_.ptr, 0, size);
+        return static_cast<uint8_t*>(buffer_.ptr);
+    }
+
+    // 失败时返回false并保留errno
+    bool write(int fd, const uint8_t* data, size_t size) {
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+        if (ringReady_) {
+            return writeRing(fd, data, size);
+        }
+#endif
+        for (size_t offset = 0; offset < size; offset += SEGMENT_SIZE) {
+            if (!pwriteFully(fd, data + offset, std::min(SEGMENT_SIZE, size - offset), static_cast<off_t>(offset))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+#if defined(__linux__) && defined(LATTICE_HAS_IO_URING)
+    bool writeRing(int fd, const uint8_t* data, size_t size) {
+        size_t submitted = 0;
+        unsigned inFlight = 0;
+        int firstError = 0;
+        while (submitted < size || inFlight > 0) {
+            while (firstError == 0 && submitted < size && inFlight < QUEUE_DEPTH) {
+                io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+                if (!sqe) break;
+                const size_t length = std::min(SEGMENT_SIZE, size - submitted);
+                io_uring_prep_write(sqe, fd, data + submitted, static_cast<unsigned>(length), submitted);
+                if (idlePriority_) {
+                    sqe->ioprio = IOPRIO_CLASS_IDLE_VALUE;
+                }
+                // user_data存段的起始偏移，短写时补齐剩余部分
+                io_uring_sqe_set_data(sqe, reinterpret_cast<void*>(static_cast<uintptr_t>(submitted)));
+                submitted += length;
+                inFlight++;
+            }
+            if (inFlight == 0) {
+                break;
+            }
+            const int ret = io_uring_submit_and_wait(&ring_, 1);
+            if (ret < 0 && ret != -EINTR) {
+                // 提交失败时还在途的段无法追踪，放弃ring改用同步写入
+                io_uring_queue_exit(&ring_);
+                ringReady_ = false;
+                return write(fd, data, size);
+            }
+            io_uring_cqe* cqe = nullptr;
+            unsigned head;
+            unsigned seen = 0;
+            io_uring_for_each_cqe(&ring_, head, cqe) {
+                seen++;
+                const size_t offset = reinterpret_cast<uintptr_t>(io_uring_cqe_get_data(cqe));
+                const size_t length = std::min(SEGMENT_SIZE, size - offset);
+                if (cqe->res < 0) {
+                    if (firstError == 0) firstError = -cqe->res;
+                } else if (static_cast<size_t>(cqe->res) < length && firstError == 0) {
+                    const size_t written = static_cast<size_t>(cqe->res);
+                    if (!pwriteFully(fd, data + offset + written, length - written,
+                                     static_cast<off_t>(offset + written))) {
+                        firstError = errno;
+                    }
+                }
+            }
+            io_uring_cq_advance(&ring_, seen);
+            inFlight -= seen;
+        }
+        if (firstError != 0) {
+            errno = firstError;
+            return false;
+        }
+        return true;
+    }
+
+    io_uring ring_{};
+    bool ringReady_{false};
+#endif
+
+    bool idlePriority_;
+    net::ArenaPageAllocator::Allocation buffer_{};
+};
+
+// ===== BulkRegionImporter实现 =====
+
+BulkRegionImporter::BulkRegionImporter(const Config& config, RegionPath regionPath, Compress compress,
+                                       RegionWritten onRegionWritten)
+    : config_(config),
+      regionPath_(std::move(regionPath)),
+      compress_(std::move(compress)),
+      onRegionWritten_(std::move(onRegionWritten)),
+      started_(std::chrono::steady_clock::now()) {
+    config_.maxOpenRegions = std::max<size_t>(1, config_.maxOpenRegions);
+    config_.maxQueuedRegions = std::max<size_t>(1, config_.maxQueuedRegions);
+    if (config_.directIO) {
+        directWriter_ = std::make_unique<DirectWriter>(config_.idleIOPriority);
+    }
+
+    size_t workers = config_.compressWorkers;
+    if (workers == 0) {
+        workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    compressWorkers_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        compressWorkers_.emplace_back([this] { compressLoop(); });
+    }
+    writer_ = std::thread([this] { writeLoop(); });
+}
+
+BulkRegionImporter::~BulkRegionImporter() {
+    try {
+        finish();
+    } catch (const std::exception&) {
+        // 析构中不传播异常
+    }
+}
+
+uint64_t BulkRegionImporter::regionKey(int worldId, int regionX, int regionZ) {
+    // worldId取低16位即可区分维度，region坐标各24位
+    return (static_cast<uint64_t>(static_cast<uint16_t>(worldId)) << 48) |
+           ((static_cast<uint64_t>(regionX) & 0xFFFFFF) << 24) |
+           (static_cast<uint64_t>(regionZ) & 0xFFFFFF);
+}
+
+void BulkRegionImporter::add(std::shared_ptr<AnvilChunkData> chunk) {
+    if (!chunk) {
+        return;
+    }
+
+    const int regionX = chunk->x >> 5;
+    const int regionZ = chunk->z >> 5;
+    const uint64_t key = regionKey(chunk->worldId, regionX, regionZ);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (finishing_) {
+        throw std::logic_error("Bulk import already finished");
+    }
+
+    auto it = open_.find(key);
+    if (it == open_.end()) {
+        // 累积中的region过多时封存最早打开的一个
+        while (open_.size() >= config_.maxOpenRegions) {
+            auto oldest = std::min_element(open_.begin(), open_.end(), [](const auto& a, const auto& b) {
+                return a.second->openOrder < b.second->openOrder;
+            });
+            sealLocked(oldest->first, lock);
+        }
+
+        auto batch = std::make_shared<RegionBatch>();
+        batch->path = regionPath_(chunk->worldId, regionX, regionZ);
+        batch->worldId = chunk->worldId;
+        batch->regionX = regionX;
+        batch->regionZ = regionZ;
+        batch->openOrder = nextOpenOrder_++;
+        batch->chunks.reserve(REGION_CHUNK_COUNT);
+        it = open_.emplace(key, std::move(batch)).first;
+    }
+
+    it->second->chunks.push_back(std::move(chunk));
+    stats_.chunksAdded++;
+
+    // 区块数达到一个完整region时立即封存，按region顺序的输入不需要等到finish
+    if (it->second->chunks.size() >= REGION_CHUNK_COUNT) {
+        sealLocked(key, lock);
+    }
+}
+
+void BulkRegionImporter::sealLocked(uint64_t key, std::unique_lock<std::mutex>& lock) {
+    auto it = open_.find(key);
+    if (it == open_.end()) {
+        return;
+    }
+    BatchPtr batch = std::move(it->second);
+    open_.erase(it);
+
+    // 背压：写入线程跟不上时阻塞提交者
+    spaceAvailable_.wait(lock, [this] { return queuedRegions_ < config_.maxQueuedRegions; });
+
+    const size_t count = batch->chunks.size();
+    batch->framed.resize(count);
+    batch->failed.assign(count, 0);
+    batch->remaining.store(count);
+    queuedRegions_++;
+    sealed_.push_back(batch);
+    for (size_t i = 0; i < count; ++i) {
+        compressTasks_.emplace_back(batch, i);
+    }
+    compressAvailable_.notify_all();
+}
+
+BulkRegionImporter::Stats BulkRegionImporter::finish() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (finished_) {
+        return stats_;
+    }
+    finishing_ = true;
+
+    // 按打开顺序封存剩余region
+    std::vector<std::pair<uint64_t, uint64_t>> order;
+    for (const auto& [key, batch] : open_) {
+        order.emplace_back(batch->openOrder, key);
+    }
+    std::sort(order.begin(), order.end());
+    for (const auto& entry : order) {
+        sealLocked(entry.second, lock);
+    }
+
+    compressAvailable_.notify_all();
+    writeAvailable_.notify_all();
+    drained_.wait(lock, [this] { return sealed_.empty(); });
+    finished_ = true;
+    compressAvailable_.notify_all();
+    writeAvailable_.notify_all();
+    lock.unlock();
+
+    for (auto& worker : compressWorkers_) {
+        worker.join();
+    }
+    writer_.join();
+
+    lock.lock();
+    stats_.compressMicros = compressMicros_.load();
+    stats_.wallMicros = microsSince(started_);
+    return stats_;
+}
+
+void BulkRegionImporter::compressLoop() {
+    for (;;) {
+        std::pair<BatchPtr, size_t> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            compressAvailable_.wait(lock, [this] { return finished_ || !compressTasks_.empty(); });
+            if (compressTasks_.empty()) {
+                return;
+            }
+            task = std::move(compressTasks_.front());
+            compressTasks_.pop_front();
+        }
+
+        compressChunk(*task.first, task.second);
+        if (task.first->remaining.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            writeAvailable_.notify_all();
+        }
+    }
+}
+
+void BulkRegionImporter::compressChunk(RegionBatch& batch, size_t index) {
+    const auto start = std::chrono::steady_clock::now();
+    const AnvilChunkData& chunk = *batch.chunks[index];
+    try {
+        if (chunk.data.empty()) {
+            throw std::runtime_error("Empty chunk data");
+        }
+        // 已压缩的记录原样写入
+        if (chunk.data[0] == static_cast<uint8_t>(NBTType::COMPOUND)) {
+            batch.framed[index] = compress_(chunk.data.data(), chunk.data.size());
+        }
+    } catch (const std::exception& e) {
+        batch.failed[index] = 1;
+        recordError("Chunk " + std::to_string(chunk.x) + "," + std::to_string(chunk.z) + ": " + e.what());
+    }
+    compressMicros_.fetch_add(microsSince(start));
+}
+
+void BulkRegionImporter::writeLoop() {
+    if (config_.idleIOPriority) {
+        setIdleIOPriority();
+    }
+    for (;;) {
+        BatchPtr batch;
+        bool mergeExisting = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            writeAvailable_.wait(lock, [this] {
+                return (!sealed_.empty() && sealed_.front()->remaining.load() == 0) ||
+                       (finished_ && sealed_.empty());
+            });
+            if (sealed_.empty()) {
+                return;
+            }
+            batch = sealed_.front();
+            const uint64_t key = regionKey(batch->worldId, batch->regionX, batch->regionZ);
+            mergeExisting = config_.preserveExisting || written_.count(key) > 0;
+            written_.insert(key);
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        bool threw = false;
+        try {
+            writeRegion(*batch, mergeExisting);
+        } catch (const std::exception& e) {
+            // 读取旧文件、分配镜像或回调抛出：只有这个region失败，写入线程继续处理后面的region
+            threw = true;
+            fprintf(stderr, "[BulkRegionImporter] Failed to write %s: %s\n", batch->path.c_str(), e.what());
+            recordError(batch->path + ": " + e.what());
+        }
+        const uint64_t elapsed = microsSince(start);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threw) {
+            stats_.failedRegions++;
+            stats_.failedChunks += batch->chunks.size();
+        }
+        stats_.writeMicros += elapsed;
+        sealed_.pop_front();
+        queuedRegions_--;
+        spaceAvailable_.notify_all();
+        drained_.notify_all();
+    }
+}
+
+void BulkRegionImporter::writeRegion(RegionBatch& batch, bool mergeExisting) {
+    std::array<ImageEntry, REGION_CHUNK_COUNT> entries{};
+    std::array<bool, REGION_CHUNK_COUNT> imported{};
+
+    // 同一区块提交多次时后提交的覆盖先提交的
+    for (size_t i = 0; i < batch.chunks.size(); ++i) {
+        if (batch.failed[i]) continue;
+        const AnvilChunkData& chunk = *batch.chunks[i];
+        const std::vector<uint8_t>& framed = batch.framed[i].empty() ? chunk.data : batch.framed[i];
+        const size_t index = RegionFile::chunkIndex(chunk.x, chunk.z);
+        auto type = static_cast<MinecraftCompressor::CompressionType>(framed[0]);
+        entries[index] = ImageEntry{framed.data() + 1, framed.size() - 1,
+                                    MinecraftCompressor::toRegionCompressionId(type), chunk.lastModified};
+        imported[index] = true;
+    }
+
+    // 保留旧文件中本次没有导入的区块
+    std::vector<std::vector<uint8_t>> preserved;
+    uint64_t preservedCount = 0;
+    if (mergeExisting && ::access(batch.path.c_str(), F_OK) == 0) {
+        RegionFile existing(batch.path, false);
+        if (existing.isOpen()) {
+            preserved.reserve(REGION_CHUNK_COUNT);
+            for (int localZ = 0; localZ < 32; ++localZ) {
+                for (int localX = 0; localX < 32; ++localX) {
+                    const size_t index = RegionFile::chunkIndex(localX, localZ);
+                    if (imported[index]) continue;
+                    std::vector<uint8_t> record;
+                    uint32_t timestamp = 0;
+                    if (!existing.readChunk(localX, localZ, record, &timestamp)) continue;
+                    preserved.push_back(std::move(record));
+                    const auto& kept = preserved.back();
+                    entries[index] = ImageEntry{kept.data() + 1, kept.size() - 1, kept[0], timestamp};
+                    preservedCount++;
+                }
+            }
+        }
+    }
+
+    // 布局：头部之后按区块索引顺序连续排列，没有空洞
+    std::array<uint32_t, REGION_CHUNK_COUNT> locations{};
+    size_t nextSector = REGION_HEADER_SECTORS;
+    uint64_t written = 0;
+    uint64_t failed = 0;
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        const ImageEntry& entry = entries[index];
+        if (!entry.payload) continue;
+        const size_t sectors = (entry.payloadSize + REGION_CHUNK_HEADER_SIZE + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+        if (sectors > 0xFF) {
+            failed++;
+            recordError("Chunk payload too large for region sector table: " + batch.path);
+            continue;
+        }
+        locations[index] = (static_cast<uint32_t>(nextSector) << 8) | static_cast<uint32_t>(sectors);
+        nextSector += sectors;
+        written++;
+    }
+
+    // 布局本身按扇区对齐，directIO模式下只需要对齐的缓冲区
+    const size_t imageSize = nextSector * REGION_SECTOR_SIZE;
+    std::vector<uint8_t> bufferedImage;
+    uint8_t* image = nullptr;
+    if (directWriter_) {
+        image = directWriter_->acquire(imageSize);
+    } else {
+        bufferedImage.resize(imageSize);
+        image = bufferedImage.data();
+    }
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        const uint32_t location = locations[index];
+        writeBigEndian32(image + index * 4, location);
+        if (location == 0) continue;
+        const ImageEntry& entry = entries[index];
+        writeBigEndian32(image + REGION_SECTOR_SIZE + index * 4, entry.timestamp);
+        uint8_t* record = image + static_cast<size_t>(RegionFile::sectorOffset(location)) * REGION_SECTOR_SIZE;
+        writeBigEndian32(record, static_cast<uint32_t>(entry.payloadSize + 1));
+        record[4] = entry.compressionId;
+        std::memcpy(record + REGION_CHUNK_HEADER_SIZE, entry.payload, entry.payloadSize);
+    }
+
+    // 一次顺序写入临时文件，再原子替换
+    const std::filesystem::path target(batch.path);
+    const std::string tempPath = batch.path + ".import";
+    bool ok = false;
+    bool direct = false;
+    std::string error;
+    try {
+        std::filesystem::create_directories(target.parent_path());
+        writeImage(tempPath, image, imageSize, direct);
+        if (::rename(tempPath.c_str(), batch.path.c_str()) != 0) {
+            throw std::runtime_error("Failed to replace " + batch.path + ": " + strerror(errno));
+        }
+        if (config_.syncFiles) {
+            syncDirectory(target.parent_path());
+        }
+        ok = true;
+    } catch (const std::exception& e) {
+        ::unlink(tempPath.c_str());
+        error = e.what();
+    }
+
+    if (ok && onRegionWritten_) {
+        onRegionWritten_(batch.path, batch.worldId, batch.regionX, batch.regionZ);
+    }
+
+    uint64_t chunkFailures = failed;
+    for (uint8_t chunkFailed : batch.failed) {
+        chunkFailures += chunkFailed;
+    }
+
+    if (!ok) {
+        recordError(error);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.failedChunks += chunkFailures;
+    if (ok) {
+        stats_.regionsWritten++;
+        stats_.chunksWritten += written;
+        stats_.chunksPreserved += preservedCount;
+        stats_.bytesWritten += imageSize;
+        if (direct) {
+            stats_.directRegions++;
+        } else if (directWriter_) {
+            stats_.bufferedFallbacks++;
+        }
+    } else {
+        stats_.failedRegions++;
+    }
+}
+
+void BulkRegionImporter::writeImage(const std::string& tempPath, const uint8_t* image, size_t size, bool& direct) {
+    constexpr int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+    direct = false;
+    int fd = -1;
+#if defined(O_DIRECT)
+    if (directWriter_) {
+        fd = ::open(tempPath.c_str(), flags | O_DIRECT, 0644);
+        // tmpfs等不支持O_DIRECT时返回EINVAL，改为普通写入
+        direct = fd >= 0;
+        if (fd < 0 && errno != EINVAL) {
+            throw std::runtime_error("Failed to create " + tempPath + ": " + strerror(errno));
+        }
+    }
+#endif
+    if (fd < 0) {
+        fd = ::open(tempPath.c_str(), flags, 0644);
+    }
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create " + tempPath + ": " + strerror(errno));
+    }
+
+    bool writeOk = directWriter_ ? directWriter_->write(fd, image, size) : writeFully(fd, image, size);
+    if (writeOk && config_.syncFiles) {
+        writeOk = ::fsync(fd) == 0;
+    }
+#if defined(POSIX_FADV_DONTNEED)
+    if (writeOk && directWriter_ && !direct) {
+        // 只有已写回的干净页能被丢弃；不fsync时先等待写回
+        if (!config_.syncFiles) {
+            writeOk = ::fdatasync(fd) == 0;
+        }
+        if (writeOk) {
+            ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        }
+    }
+#endif
+    const int savedErrno = errno;
+    ::close(fd);
+    if (!writeOk) {
+        throw std::runtime_error("Failed to write " + tempPath + ": " + strerror(savedErrno));
+    }
+}
+
+void BulkRegionImporter::recordError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stats_.firstError.empty()) {
+        stats_.firstError = message;
+    }
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+struct AnvilChunkData;
+
+/**
+ * BulkRegionImporter - 世界预生成 / 批量导入的整region写入路径
+ *
+ * 区块按region累积在内存中，region封存后由压缩线程并行压缩其中的区块，
+ * 写入线程在内存中组装完整的.mca镜像（头部 + 连续紧凑的扇区），一次顺序写入临时文件后
+ * 原子替换目标文件。不经过在线保存路径的region句柄、扇区分配、热缓存和预写日志。
+ *
+ * - 输入最好按region顺序提交：同时累积的region超过maxOpenRegions时封存最早的一个，
+ *   同一region被再次封存时与上次写出的文件合并
+ * - 已封存但尚未写出的region超过maxQueuedRegions时add()阻塞，内存占用有上限
+ * - 导入期间不得通过在线路径读写同一region
+ *
+ * 单个区块失败（超过255个扇区等）只跳过该区块；region写入失败计入failedRegions。
+ *
+ * directIO模式（预生成 / 恢复与在线服务器同机时使用）：镜像组装在ArenaPageAllocator分配的4KB对齐缓冲区中，
+ * 临时文件以O_DIRECT打开，按段提交到写入线程私有的io_uring（未编译io_uring支持时用pwrite），
+ * 写出的region不进入页缓存，不会挤掉在线服务器的热region。文件系统不支持O_DIRECT时改为普通写入，
+ * 落盘后丢弃这些页（posix_fadvise DONTNEED）。idleIOPriority把写入设为idle I/O优先级，只在磁盘空闲时推进。
+ */
+class BulkRegionImporter {
+public:
+    struct Config {
+        size_t compressWorkers = 0;      // 0表示按CPU核数选择
+        size_t maxOpenRegions = 8;       // 同时累积中的region数
+        size_t maxQueuedRegions = 8;     // 已封存、等待压缩或写入的region数
+        bool preserveExisting = true;    // 保留目标文件中本次未导入的区块
+        bool syncFiles = true;           // 每个region替换前fsync
+        bool directIO = false;           // 绕过页缓存写入（见类注释）
+        bool idleIOPriority = false;     // 写入线程使用IOPRIO_CLASS_IDLE（Linux）
+    };
+
+    struct Stats {
+        uint64_t chunksAdded{0};
+        uint64_t chunksWritten{0};       // 含preserveExisting保留的旧区块
+        uint64_t chunksPreserved{0};
+        uint64_t failedChunks{0};
+        uint64_t regionsWritten{0};
+        uint64_t failedRegions{0};
+        uint64_t bytesWritten{0};
+        uint64_t directRegions{0};       // 以O_DIRECT写出的region
+        uint64_t bufferedFallbacks{0};   // directIO模式下文件系统不支持O_DIRECT、改为普通写入的region
+        uint64_t compressMicros{0};      // 所有压缩线程之和
+        uint64_t writeMicros{0};         // 组装 + 写入 + fsync
+        uint64_t wallMicros{0};
+        std::string firstError;
+    };
+
+    // 压缩未压缩的NBT，返回MinecraftCompressor类型字节 + 负载
+    using Compress = std::function<std::vector<uint8_t>(const uint8_t* nbt, size_t size)>;
+    using RegionPath = std::function<std::string(int worldId, int regionX, int regionZ)>;
+    // region文件被替换后调用（写入线程），用于使上层缓存失效
+    using RegionWritten = std::function<void(const std::string& path, int worldId, int regionX, int regionZ)>;
+
+    BulkRegionImporter(const Config& config, RegionPath regionPath, Compress compress,
+                       RegionWritten onRegionWritten = nullptr);
+    // 未调用finish()时在这里完成导入（丢弃统计与错误）
+    ~BulkRegionImporter();
+
+    BulkRegionImporter(const BulkRegionImporter&) = delete;
+    BulkRegionImporter& operator=(const BulkRegionImporter&) = delete;
+
+    /**
+     * 提交一个区块：data为未压缩NBT（COMPOUND开头）或已压缩记录（类型字节 + 负载）
+     * 同一区块提交多次时保留最后一次；finish()之后调用抛出std::logic_error
+     */
+    void add(std::shared_ptr<AnvilChunkData> chunk);
+
+    // 封存所有region并等待全部写出
+    Stats finish();
+
+private:
+    struct RegionBatch {
+        std::string path;
+        int worldId{0};
+        int regionX{0};
+        int regionZ{0};
+        uint64_t openOrder{0};
+        std::vector<std::shared_ptr<AnvilChunkData>> chunks;
+        std::vector<std::vector<uint8_t>> framed;    // 压缩输出；为空表示原样使用chunk->data
+        std::vector<uint8_t> failed;
+        std::atomic<size_t> remaining{0};
+    };
+
+    using BatchPtr = std::shared_ptr<RegionBatch>;
+
+    // directIO模式的对齐缓冲区与io_uring，只由写入线程使用
+    class DirectWriter;
+
+    static uint64_t regionKey(int worldId, int regionX, int regionZ);
+
+    // 调用者持有lock；等待队列有空位时会暂时释放
+    void sealLocked(uint64_t key, std::unique_lock<std::mutex>& lock);
+    void compressLoop();
+    void writeLoop();
+    void compressChunk(RegionBatch& batch, size_t index);
+    void writeRegion(RegionBatch& batch, bool mergeExisting);
+    // 写入并（按配置）fsync临时文件；失败时抛出std::runtime_error
+    void writeImage(const std::string& tempPath, const uint8_t* image, size_t size, bool& direct);
+    void recordError(const std::string& message);
+
+    Config config_;
+    RegionPath regionPath_;
+    Compress compress_;
+    RegionWritten onRegionWritten_;
+
+    std::mutex mutex_;
+    std::condition_variable compressAvailable_;
+    std::condition_variable writeAvailable_;
+    std::condition_variable spaceAvailable_;
+    std::condition_variable drained_;
+
+    std::unordered_map<uint64_t, BatchPtr> open_;
+    std::deque<std::pair<BatchPtr, size_t>> compressTasks_;
+    std::deque<BatchPtr> sealed_;                    // 按封存顺序写出，同一region的多次封存不会乱序
+    std::unordered_set<uint64_t> written_;           // 本次导入已写出过的region
+    uint64_t nextOpenOrder_{0};
+    size_t queuedRegions_{0};
+    bool finishing_{false};
+    bool finished_{false};
+
+    Stats stats_;
+    std::atomic<uint64_t> compressMicros_{0};
+    std::chrono::steady_clock::time_point started_;
+
+    std::unique_ptr<DirectWriter> directWriter_;
+
+    std::vector<std::thread> compressWorkers_;
+    std::thread writer_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,482 @@
+#include "chunk_codecs.hpp"
+#include "zstd_dictionary.hpp"
+#include <libdeflate.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+
+#if defined(LATTICE_HAS_LZ4)
+#include <lz4.h>
+#endif
+#if defined(LATTICE_HAS_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace lattice {
+namespace io {
+namespace anvil {
+namespace codec {
+
+namespace {
+
+// 解压结果上限，防止损坏/恶意数据导致无限扩容
+constexpr size_t MAX_DECOMPRESSED_SIZE = 64 * 1024 * 1024;
+
+inline uint32_t readLittleEndian32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline void writeLittleEndian32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+inline uint32_t rotateLeft(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+// ===== 线程局部libdeflate上下文 =====
+
+// 每个级别一个压缩器，首次使用时分配；保存（默认级别）与后台重新压缩交替时不再反复分配
+struct DeflateContexts {
+    static constexpr int MAX_LEVEL = 12;
+
+    std::array<libdeflate_compressor*, MAX_LEVEL + 1> compressors{};
+    libdeflate_decompressor* decompressor = nullptr;
+
+    ~DeflateContexts() {
+        for (auto* compressor : compressors) {
+            if (compressor) libdeflate_free_compressor(compressor);
+        }
+        if (decompressor) libdeflate_free_decompressor(decompressor);
+    }
+
+    libdeflate_compressor* getCompressor(int wantedLevel) {
+        if (wantedLevel < 0 || wantedLevel > MAX_LEVEL) {
+            return nullptr;
+        }
+        auto*& compressor = compressors[static_cast<size_t>(wantedLevel)];
+        if (!compressor) {
+            compressor = libdeflate_alloc_compressor(wantedLevel);
+        }
+        return compressor;
+    }
+
+    libdeflate_decompressor* getDecompressor() {
+        if (!decompressor) {
+            decompressor = libdeflate_alloc_decompressor();
+        }
+        return decompressor;
+    }
+};
+
+DeflateContexts& deflateContexts() {
+    thread_local DeflateContexts contexts;
+    return contexts;
+}
+
+// ===== lz4-java LZ4Block格式常量 =====
+constexpr uint8_t LZ4_BLOCK_MAGIC[8] = {'L', 'Z', '4', 'B', 'l', 'o', 'c', 'k'};
+constexpr size_t LZ4_BLOCK_HEADER_SIZE = 8 + 1 + 4 + 4 + 4;
+constexpr size_t LZ4_BLOCK_SIZE = 64 * 1024;                    // lz4-java默认块大小
+constexpr uint8_t LZ4_METHOD_RAW = 0x10;
+constexpr uint8_t LZ4_METHOD_LZ4 = 0x20;
+constexpr uint8_t LZ4_COMPRESSION_LEVEL = 6;                    // log2(64KB) - 10
+constexpr uint32_t LZ4_CHECKSUM_SEED = 0x9747b28c;
+constexpr uint32_t LZ4_CHECKSUM_MASK = 0x0FFFFFFF;
+
+} // namespace
+
+// ===== DEFLATE（libdeflate） =====
+
+bool deflateCompress(DeflateFormat format, const uint8_t* data, size_t size, int level,
+                     std::vector<uint8_t>& out) {
+    libdeflate_compressor* compressor = deflateContexts().getCompressor(level);
+    if (!compressor) {
+        return false;
+    }
+
+    const size_t base = out.size();
+    size_t bound = 0;
+    switch (format) {
+        case DeflateFormat::RAW:  bound = libdeflate_deflate_compress_bound(compressor, size); break;
+        case DeflateFormat::ZLIB: bound = libdeflate_zlib_compress_bound(compressor, size); break;
+        case DeflateFormat::GZIP: bound = libdeflate_gzip_compress_bound(compressor, size); break;
+    }
+    out.resize(base + bound);
+
+    size_t written = 0;
+    switch (format) {
+        case DeflateFormat::RAW:
+            written = libdeflate_deflate_compress(compressor, data, size, out.data() + base, bound);
+            break;
+        case DeflateFormat::ZLIB:
+            written = libdeflate_zlib_compress(compressor, data, size, out.data() + base, bound);
+            break;
+        case DeflateFormat::GZIP:
+            written = libdeflate_gzip_compress(compressor, data, size, out.data() + base, bound);
+            break;
+    }
+
+    out.resize(written > 0 ? base + written : base);
+    return written > 0;
+}
+
+bool deflateDecompress(DeflateFormat format, const uint8_t* data, size_t size,
+                       std::vector<uint8_t>& out) {
+    libdeflate_decompressor* decompressor = deflateContexts().getDecompressor();
+    if (!decompressor) {
+        return false;
+    }
+
+    // libdeflate不报告所需大小：从4倍输入开始，空间不足时翻倍重试
+    const size_t base = out.size();
+    size_t capacity = std::max<size_t>(size * 4, 16 * 1024);
+
+    while (capacity <= MAX_DECOMPRESSED_SIZE) {
+        out.resize(base + capacity);
+        size_t actual = 0;
+        libdeflate_result result = LIBDEFLATE_BAD_DATA;
+        switch (format) {
+            case DeflateFormat::RAW:
+                result = libdeflate_deflate_decompress(decompressor, data, size, out.data() + base, capacity, &actual);
+                break;
+            case DeflateFormat::ZLIB:
+                result = libdeflate_zlib_decompress(decompressor, data, size, out.data() + base, capacity, &actual);
+                break;
+            case DeflateFormat::GZIP:
+                result = libdeflate_gzip_decompress(decompressor, data, size, out.data() + base, capacity, &actual);
+                break;
+        }
+
+        if (result == LIBDEFLATE_SUCCESS) {
+            out.resize(base + actual);
+            return true;
+        }
+        if (result != LIBDEFLATE_INSUFFICIENT_SPACE) {
+            break;
+        }
+        capacity *= 2;
+    }
+
+    out.resize(base);
+    return false;
+}
+
+// ===== CRC-32 =====
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    return libdeflate_crc32(0, data, size);
+}
+
+uint32_t adler32(const uint8_t* data, size_t size) {
+    return libdeflate_adler32(1, data, size);
+}
+
+// ===== XXH32 =====
+
+uint32_t xxHash32(const uint8_t* data, size_t size, uint32_t seed) {
+    constexpr uint32_t PRIME1 = 2654435761U;
+    constexpr uint32_t PRIME2 = 2246822519U;
+    constexpr uint32_t PRIME3 = 3266489917U;
+    constexpr uint32_t PRIME4 = 668265263U;
+    constexpr uint32_t PRIME5 = 374761393U;
+
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint32_t hash;
+
+    if (size >= 16) {
+        uint32_t v1 = seed + PRIME1 + PRIME2;
+        uint32_t v2 = seed + PRIME2;
+        uint32_t v3 = seed;
+        uint32_t v4 = seed - PRIME1;
+        const uint8_t* limit = end - 16;
+        do {
+            v1 = rotateLeft(v1 + readLittleEndian32(p) * PRIME2, 13) * PRIME1; p += 4;
+            v2 = rotateLeft(v2 + readLittleEndian32(p) * PRIME2, 13) * PRIME1; p += 4;
+            v3 = rotateLeft(v3 + readLittleEndian32(p) * PRIME2, 13) * PRIME1; p += 4;
+            v4 = rotateLeft(v4 + readLittleEndian32(p) * PRIME2, 13) * PRIME1; p += 4;
+        } while (p <= limit);
+        hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+    } else {
+        hash = seed + PRIME5;
+    }
+
+    hash += static_cast<uint32_t>(size);
+
+    while (p + 4 <= end) {
+        hash = rotateLeft(hash + readLittleEndian32(p) * PRIME3, 17) * PRIME4;
+        p += 4;
+    }
+    while (p < end) {
+        hash = rotateLeft(hash + (*p) * PRIME5, 11) * PRIME1;
+        ++p;
+    }
+
+    hash ^= hash >> 15;
+    hash *= PRIME2;
+    hash ^= hash >> 13;
+    hash *= PRIME3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// ===== LZ4（lz4-java LZ4Block格式） =====
+
+bool lz4Available() {
+#if defined(LATTICE_HAS_LZ4)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool lz4Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+#if defined(LATTICE_HAS_LZ4)
+    const size_t base = out.size();
+    const size_t blockCount = (size + LZ4_BLOCK_SIZE - 1) / LZ4_BLOCK_SIZE;
+    const size_t maxBlock = static_cast<size_t>(LZ4_compressBound(static_cast<int>(LZ4_BLOCK_SIZE)));
+    out.resize(base + (blockCount + 1) * LZ4_BLOCK_HEADER_SIZE + blockCount * maxBlock);
+
+    uint8_t* cursor = out.data() + base;
+    auto writeHeader = [&](uint8_t method, uint32_t compressedLength, uint32_t originalLength, uint32_t checksum) {
+        std::memcpy(cursor, LZ4_BLOCK_MAGIC, sizeof(LZ4_BLOCK_MAGIC));
+        cursor[8] = static_cast<uint8_t>(method | LZ4_COMPRESSION_LEVEL);
+        writeLittleEndian32(cursor + 9, compressedLength);
+        writeLittleEndian32(cursor + 13, originalLength);
+        writeLittleEndian32(cursor + 17, checksum);
+        cursor += LZ4_BLOCK_HEADER_SIZE;
+    };
+
+    for (size_t offset = 0; offset < size; offset += LZ4_BLOCK_SIZE) {
+        const size_t blockSize = std::min(LZ4_BLOCK_SIZE, size - offset);
+        const uint8_t* block = data + offset;
+        const uint32_t checksum = xxHash32(block, blockSize, LZ4_CHECKSUM_SEED) & LZ4_CHECKSUM_MASK;
+
+        uint8_t* payload = cursor + LZ4_BLOCK_HEADER_SIZE;
+        int compressed = LZ4_compress_default(reinterpret_cast<const char*>(block), reinterpret_cast<char*>(payload),
+                                              static_cast<int>(blockSize), static_cast<int>(maxBlock));
+        if (compressed <= 0) {
+            out.resize(base);
+            return false;
+        }
+
+        if (static_cast<size_t>(compressed) >= blockSize) {
+            // 不可压缩的块按原样存储（与lz4-java行为一致）
+            std::memcpy(payload, block, blockSize);
+            writeHeader(LZ4_METHOD_RAW, static_cast<uint32_t>(blockSize), static_cast<uint32_t>(blockSize), checksum);
+            cursor += blockSize;
+        } else {
+            writeHeader(LZ4_METHOD_LZ4, static_cast<uint32_t>(compressed), static_cast<uint32_t>(blockSize), checksum);
+            cursor += compressed;
+        }
+    }
+
+    // 结束块
+    writeHeader(LZ4_METHOD_RAW, 0, 0, 0);
+    out.resize(static_cast<size_t>(cursor - out.data()));
+    return true;
+#else
+    (void)data; (void)size; (void)out;
+    return false;
+#endif
+}
+
+bool lz4Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+#if defined(LATTICE_HAS_LZ4)
+    // 第一遍只扫描块头，得到原始总大小后一次分配
+    size_t total = 0;
+    for (size_t offset = 0; offset + LZ4_BLOCK_HEADER_SIZE <= size;) {
+        if (std::memcmp(data + offset, LZ4_BLOCK_MAGIC, sizeof(LZ4_BLOCK_MAGIC)) != 0) {
+            return false;
+        }
+        uint32_t compressedLength = readLittleEndian32(data + offset + 9);
+        uint32_t originalLength = readLittleEndian32(data + offset + 13);
+        if (originalLength == 0) {
+            break;
+        }
+        total += originalLength;
+        offset += LZ4_BLOCK_HEADER_SIZE + compressedLength;
+        if (offset > size || total > MAX_DECOMPRESSED_SIZE) {
+            return false;
+        }
+    }
+
+    const size_t base = out.size();
+    out.resize(base + total);
+    uint8_t* target = out.data() + base;
+
+    for (size_t offset = 0; offset + LZ4_BLOCK_HEADER_SIZE <= size;) {
+        const uint8_t* header = data + offset;
+        const uint8_t method = header[8] & 0xF0;
+        uint32_t compressedLength = readLittleEndian32(header + 9);
+        uint32_t originalLength = readLittleEndian32(header + 13);
+        uint32_t checksum = readLittleEndian32(header + 17);
+        if (originalLength == 0) {
+            break;
+        }
+
+        const uint8_t* payload = header + LZ4_BLOCK_HEADER_SIZE;
+        if (method == LZ4_METHOD_RAW) {
+            if (compressedLength != originalLength) {
+                out.resize(base);
+                return false;
+            }
+            std::memcpy(target, payload, originalLength);
+        } else if (method == LZ4_METHOD_LZ4) {
+            int decoded = LZ4_decompress_safe(reinterpret_cast<const char*>(payload), reinterpret_cast<char*>(target),
+                                              static_cast<int>(compressedLength), static_cast<int>(originalLength));
+            if (decoded != static_cast<int>(originalLength)) {
+                out.resize(base);
+                return false;
+            }
+        } else {
+            out.resize(base);
+            return false;
+        }
+
+        if ((xxHash32(target, originalLength, LZ4_CHECKSUM_SEED) & LZ4_CHECKSUM_MASK) != checksum) {
+            out.resize(base);
+            return false;
+        }
+
+        target += originalLength;
+        offset += LZ4_BLOCK_HEADER_SIZE + compressedLength;
+    }
+
+    return true;
+#else
+    (void)data; (void)size; (void)out;
+    return false;
+#endif
+}
+
+// ===== zstd =====
+
+#if defined(LATTICE_HAS_ZSTD)
+namespace {
+
+struct ZstdContexts {
+    ZSTD_CCtx* cctx = nullptr;
+    ZSTD_DCtx* dctx = nullptr;
+
+    ~ZstdContexts() {
+        if (cctx) ZSTD_freeCCtx(cctx);
+        if (dctx) ZSTD_freeDCtx(dctx);
+    }
+
+    ZSTD_CCtx* compressor() {
+        if (!cctx) cctx = ZSTD_createCCtx();
+        return cctx;
+    }
+
+    ZSTD_DCtx* decompressor() {
+        if (!dctx) dctx = ZSTD_createDCtx();
+        return dctx;
+    }
+};
+
+ZstdContexts& zstdContexts() {
+    thread_local ZstdContexts contexts;
+    return contexts;
+}
+
+} // namespace
+#endif
+
+bool zstdAvailable() {
+#if defined(LATTICE_HAS_ZSTD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t zstdFrameDictionaryId(const uint8_t* data, size_t size) {
+#if defined(LATTICE_HAS_ZSTD)
+    return ZSTD_getDictID_fromFrame(data, size);
+#else
+    (void)data; (void)size;
+    return 0;
+#endif
+}
+
+bool zstdCompress(const uint8_t* data, size_t size, int level, std::vector<uint8_t>& out,
+                  const ZstdDictionary* dictionary) {
+#if defined(LATTICE_HAS_ZSTD)
+    ZSTD_CCtx* cctx = zstdContexts().compressor();
+    if (!cctx) {
+        return false;
+    }
+
+    const size_t base = out.size();
+    const size_t bound = ZSTD_compressBound(size);
+    out.resize(base + bound);
+
+    // 字典模式的压缩级别在创建CDict时已确定
+    size_t written = dictionary
+        ? ZSTD_compress_usingCDict(cctx, out.data() + base, bound, data, size,
+                                   static_cast<const ZSTD_CDict*>(dictionary->compressionDictionary()))
+        : ZSTD_compressCCtx(cctx, out.data() + base, bound, data, size, level);
+    if (ZSTD_isError(written)) {
+        out.resize(base);
+        return false;
+    }
+    out.resize(base + written);
+    return true;
+#else
+    (void)data; (void)size; (void)level; (void)out; (void)dictionary;
+    return false;
+#endif
+}
+
+bool zstdDecompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                    const ZstdDictionary* dictionary) {
+#if defined(LATTICE_HAS_ZSTD)
+    ZSTD_DCtx* dctx = zstdContexts().decompressor();
+    if (!dctx) {
+        return false;
+    }
+
+    // 帧依赖的字典须是当前字典或其保留的旧字典之一
+    const unsigned frameDictId = ZSTD_getDictID_fromFrame(data, size);
+    const ZstdDictionary* frameDictionary = frameDictId != 0 && dictionary ? dictionary->forId(frameDictId) : nullptr;
+    if (frameDictId != 0 && !frameDictionary) {
+        return false;
+    }
+
+    unsigned long long contentSize = ZSTD_getFrameContentSize(data, size);
+    if (contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+        contentSize > MAX_DECOMPRESSED_SIZE) {
+        // 本库写入的帧总是记录原始大小
+        return false;
+    }
+
+    const size_t base = out.size();
+    out.resize(base + static_cast<size_t>(contentSize));
+    size_t decoded = frameDictId != 0
+        ? ZSTD_decompress_usingDDict(dctx, out.data() + base, static_cast<size_t>(contentSize), data, size,
+                                     static_cast<const ZSTD_DDict*>(frameDictionary->decompressionDictionary()))
+        : ZSTD_decompressDCtx(dctx, out.data() + base, static_cast<size_t>(contentSize), data, size);
+    if (ZSTD_isError(decoded) || decoded != contentSize) {
+        out.resize(base);
+        return false;
+    }
+    return true;
+#else
+    (void)data; (void)size; (void)out; (void)dictionary;
+    return false;
+#endif
+}
+
+} // namespace codec
+} // namespace anvil
+} // namespace io
+} // namespace lattice
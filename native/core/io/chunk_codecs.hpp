@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+class ZstdDictionary;
+
+namespace codec {
+
+/**
+ * 区块压缩编解码器
+ *
+ * MinecraftCompressor的底层实现。所有函数把结果追加到out末尾（调用者可以先写入
+ * 类型字节），失败时返回false且out恢复原长度。编解码上下文按线程缓存复用。
+ *
+ * LZ4与zstd是可选依赖：编译时未定义LATTICE_HAS_LZ4 / LATTICE_HAS_ZSTD时
+ * 对应函数直接返回false，available函数返回false。
+ */
+
+enum class DeflateFormat : uint8_t {
+    RAW,     // 裸DEFLATE流（旧版本Lattice写入的数据）
+    ZLIB,    // zlib封装（原版region压缩ID 2）
+    GZIP     // gzip封装（原版region压缩ID 1）
+};
+
+bool deflateCompress(DeflateFormat format, const uint8_t* data, size_t size, int level,
+                     std::vector<uint8_t>& out);
+bool deflateDecompress(DeflateFormat format, const uint8_t* data, size_t size,
+                       std::vector<uint8_t>& out);
+
+/**
+ * LZ4 - 与原版相同的lz4-java LZ4BlockOutputStream格式
+ * （"LZ4Block"魔数 + 64KB分块，每块带XXH32校验，末尾空块结束）
+ */
+bool lz4Available();
+bool lz4Compress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+bool lz4Decompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+// zstd - 单帧，帧头记录原始大小；使用字典时帧头记录字典ID，解码时必须提供同一字典（或保留了它的新字典）
+bool zstdAvailable();
+// 帧头记录的字典ID，不依赖字典或无法识别时为0
+uint32_t zstdFrameDictionaryId(const uint8_t* data, size_t size);
+bool zstdCompress(const uint8_t* data, size_t size, int level, std::vector<uint8_t>& out,
+                  const ZstdDictionary* dictionary = nullptr);
+bool zstdDecompress(const uint8_t* data, size_t size, std::vector<uint8_t>& out,
+                    const ZstdDictionary* dictionary = nullptr);
+
+// CRC-32（libdeflate实现，区块日志记录校验使用）
+uint32_t crc32(const uint8_t* data, size_t size);
+// Adler-32（libdeflate实现，与zlib尾部校验相同）
+uint32_t adler32(const uint8_t* data, size_t size);
+
+// XXH32（lz4-java分块校验使用）
+uint32_t xxHash32(const uint8_t* data, size_t size, uint32_t seed);
+
+} // namespace codec
+} // namespace anvil
+} // namespace io
+} // namespace lattice
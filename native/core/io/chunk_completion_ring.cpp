@@ -0,0 +1,167 @@
+#include "chunk_completion_ring.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+// Java未及时消费时的轮询间隔；Java不会通知原生侧
+constexpr auto PRODUCER_BACKOFF = std::chrono::microseconds(200);
+
+inline std::atomic_ref<uint64_t> cursorAt(uint8_t* base, size_t offset) {
+    return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(base + offset));
+}
+
+} // namespace
+
+// ===== ChunkCompletionRing实现 =====
+
+ChunkCompletionRing::ChunkCompletionRing(void* memory, size_t totalBytes)
+    : base_(static_cast<uint8_t*>(memory)), data_(nullptr), dataCapacity_(0) {
+    if (!memory || reinterpret_cast<uintptr_t>(memory) % std::atomic_ref<uint64_t>::required_alignment != 0) {
+        throw std::invalid_argument("Completion ring memory must be 8-byte aligned");
+    }
+    if (totalBytes < requiredBytes(MIN_DATA_CAPACITY)) {
+        throw std::invalid_argument("Completion ring is too small");
+    }
+
+    size_t capacity = MIN_DATA_CAPACITY;
+    while (capacity * 2 <= totalBytes - HEADER_BYTES) {
+        capacity *= 2;
+    }
+    dataCapacity_ = capacity;
+    data_ = base_ + HEADER_BYTES;
+
+    std::memset(base_, 0, HEADER_BYTES);
+    const uint32_t magic = MAGIC;
+    const uint32_t capacity32 = static_cast<uint32_t>(dataCapacity_);
+    std::memcpy(base_ + MAGIC_OFFSET, &magic, sizeof(magic));
+    std::memcpy(base_ + CAPACITY_OFFSET, &capacity32, sizeof(capacity32));
+    cursorAt(base_, READ_CURSOR_OFFSET).store(0, std::memory_order_relaxed);
+    storeWriteCursor(0);
+}
+
+uint64_t ChunkCompletionRing::loadReadCursor() const {
+    return cursorAt(base_, READ_CURSOR_OFFSET).load(std::memory_order_acquire);
+}
+
+void ChunkCompletionRing::storeWriteCursor(uint64_t value) {
+    cursorAt(base_, WRITE_CURSOR_OFFSET).store(value, std::memory_order_release);
+}
+
+void ChunkCompletionRing::writeHeader(size_t offset, uint32_t recordBytes, Status status, int worldId,
+                                      int chunkX, int chunkZ, uint32_t payloadBytes, uint64_t tag) {
+    uint8_t* header = data_ + offset;
+    const int32_t statusValue = static_cast<int32_t>(status);
+    const int32_t fields[] = {worldId, chunkX, chunkZ};
+    std::memcpy(header, &recordBytes, 4);
+    std::memcpy(header + 4, &statusValue, 4);
+    std::memcpy(header + 8, fields, sizeof(fields));
+    std::memcpy(header + 20, &payloadBytes, 4);
+    std::memcpy(header + 24, &tag, 8);
+}
+
+uint8_t* ChunkCompletionRing::reserve(size_t payloadBytes) {
+    if (!fits(payloadBytes) || closed_.load()) {
+        return nullptr;
+    }
+
+    const size_t recordBytes = recordBytesFor(payloadBytes);
+    const uint64_t mask = dataCapacity_ - 1;
+    bool waited = false;
+
+    writeMutex_.lock();
+    for (;;) {
+        if (closed_.load()) {
+            writeMutex_.unlock();
+            return nullptr;
+        }
+
+        const size_t offset = static_cast<size_t>(writeCursor_ & mask);
+        const size_t toEnd = dataCapacity_ - offset;
+        const size_t needed = recordBytes <= toEnd ? recordBytes : toEnd + recordBytes;
+
+        // 忽略越过写游标的异常读游标
+        uint64_t readCursor = loadReadCursor();
+        if (readCursor > writeCursor_) {
+            readCursor = writeCursor_;
+        }
+
+        if (writeCursor_ + needed - readCursor <= dataCapacity_) {
+            if (recordBytes > toEnd) {
+                writeHeader(offset, static_cast<uint32_t>(toEnd), Status::PADDING, 0, 0, 0, 0, 0);
+                writeCursor_ += toEnd;
+                storeWriteCursor(writeCursor_);
+            }
+            reservedStart_ = writeCursor_;
+            reservedBytes_ = recordBytes;
+            break;
+        }
+
+        waited = true;
+        std::this_thread::sleep_for(PRODUCER_BACKOFF);
+    }
+
+    if (waited) {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        stats_.producerWaits++;
+    }
+    return data_ + static_cast<size_t>(reservedStart_ & mask) + RECORD_HEADER_BYTES;
+}
+
+void ChunkCompletionRing::commit(Status status, int worldId, int chunkX, int chunkZ,
+                                 uint64_t tag, size_t payloadBytes) {
+    const size_t recordBytes = recordBytesFor(payloadBytes);
+    if (recordBytes > reservedBytes_) {
+        writeMutex_.unlock();
+        throw std::logic_error("Completion record exceeds its reservation");
+    }
+
+    writeHeader(static_cast<size_t>(reservedStart_ & (dataCapacity_ - 1)), static_cast<uint32_t>(recordBytes),
+                status, worldId, chunkX, chunkZ, static_cast<uint32_t>(payloadBytes), tag);
+    writeCursor_ = reservedStart_ + recordBytes;
+    storeWriteCursor(writeCursor_);
+    reservedBytes_ = 0;
+    writeMutex_.unlock();
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats_.published++;
+    stats_.bytesPublished += payloadBytes;
+    if (status == Status::TOO_LARGE) {
+        stats_.tooLarge++;
+    }
+}
+
+bool ChunkCompletionRing::publish(Status status, int worldId, int chunkX, int chunkZ, uint64_t tag,
+                                  const uint8_t* payload, size_t payloadBytes) {
+    // 错误信息过长时截断，而不是丢掉整条完成记录
+    payloadBytes = std::min(payloadBytes, maxPayloadBytes());
+    uint8_t* out = reserve(payloadBytes);
+    if (!out) {
+        return false;
+    }
+    if (payloadBytes > 0) {
+        std::memcpy(out, payload, payloadBytes);
+    }
+    commit(status, worldId, chunkX, chunkZ, tag, payloadBytes);
+    return true;
+}
+
+void ChunkCompletionRing::close() {
+    closed_.store(true);
+}
+
+ChunkCompletionRing::Stats ChunkCompletionRing::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    return stats_;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * ChunkCompletionRing - 与Java共享的区块加载完成环形缓冲区
+ *
+ * 原生侧的多个加载线程写入完成记录（负载内联），Java每tick轮询一次，不需要
+ * AttachCurrentThread / CallVoidMethod。内存由调用者提供（通常是DirectByteBuffer），
+ * 布局如下（本机字节序，Java侧需ByteBuffer.order(ByteOrder.nativeOrder())）：
+ *
+ *   [0,   8)    u64 writeCursor  原生侧发布（release），Java以volatile读取
+ *   [64,  72)   u64 readCursor   Java消费后写入（volatile），原生侧据此回收空间
+ *   [128, 132)  u32 magic "LCR1"
+ *   [132, 136)  u32 dataCapacity 数据区字节数（2的幂）
+ *   [192, ...)  数据区
+ *
+ * 游标是单调递增的字节位置，位置 & (dataCapacity - 1) 为数据区偏移。
+ * 每条记录按32字节对齐，记录不跨越数据区末尾：剩余空间不足时写入一条PADDING记录，
+ * 读者跳过它回到开头。记录头（32字节）：
+ *   u32 recordBytes（含头部与对齐填充） | i32 status | i32 worldId | i32 chunkX | i32 chunkZ |
+ *   u32 payloadBytes | u64 tag
+ * OK记录的负载与getChunkDataForJava相同（NONE类型字节 + NBT），FAILED记录的负载为UTF-8错误信息。
+ *
+ * 空间不足时写入者等待Java消费（背压），close()后等待中的写入者立即返回失败。
+ */
+class ChunkCompletionRing {
+public:
+    static constexpr uint32_t MAGIC = 0x4C435231;            // "LCR1"
+    static constexpr size_t WRITE_CURSOR_OFFSET = 0;
+    static constexpr size_t READ_CURSOR_OFFSET = 64;
+    static constexpr size_t MAGIC_OFFSET = 128;
+    static constexpr size_t CAPACITY_OFFSET = 132;
+    static constexpr size_t HEADER_BYTES = 192;
+    static constexpr size_t RECORD_HEADER_BYTES = 32;
+    static constexpr size_t RECORD_ALIGNMENT = 32;
+    static constexpr size_t MIN_DATA_CAPACITY = 64 * 1024;
+
+    enum class Status : int32_t {
+        PADDING = -1,       // 跳到数据区开头
+        OK = 0,
+        NOT_FOUND = 1,
+        FAILED = 2,
+        TOO_LARGE = 3       // 超过单条记录上限，无负载；Java改用getChunkDataDirect单独加载
+    };
+
+    struct Stats {
+        uint64_t published{0};
+        uint64_t bytesPublished{0};
+        uint64_t producerWaits{0};      // 因空间不足等待Java消费的次数
+        uint64_t tooLarge{0};
+    };
+
+    // 容纳dataCapacity字节数据区所需的总内存
+    static size_t requiredBytes(size_t dataCapacity) { return HEADER_BYTES + dataCapacity; }
+
+    /**
+     * 在memory上初始化环形缓冲区（清零游标并写入头部）
+     * memory须8字节对齐；数据区容量为totalBytes - HEADER_BYTES向下取2的幂，
+     * 小于MIN_DATA_CAPACITY时抛出std::invalid_argument
+     */
+    ChunkCompletionRing(void* memory, size_t totalBytes);
+
+    ChunkCompletionRing(const ChunkCompletionRing&) = delete;
+    ChunkCompletionRing& operator=(const ChunkCompletionRing&) = delete;
+
+    // 单条记录负载上限（数据区的一半，保证等待总能结束）
+    size_t maxPayloadBytes() const { return dataCapacity_ / 2 - RECORD_HEADER_BYTES; }
+    bool fits(size_t payloadBytes) const { return payloadBytes <= maxPayloadBytes(); }
+
+    /**
+     * 预留一条负载为payloadBytes的记录，返回负载写入位置
+     * 成功时持有写入锁，调用者必须随后调用commit()；负载超限或已关闭时返回nullptr
+     */
+    uint8_t* reserve(size_t payloadBytes);
+
+    // 发布reserve()预留的记录；payloadBytes不得超过预留大小
+    void commit(Status status, int worldId, int chunkX, int chunkZ, uint64_t tag, size_t payloadBytes);
+
+    // reserve + 拷贝 + commit；返回false表示已关闭
+    bool publish(Status status, int worldId, int chunkX, int chunkZ, uint64_t tag,
+                 const uint8_t* payload, size_t payloadBytes);
+
+    // 唤醒并拒绝所有等待中的写入者
+    void close();
+
+    size_t dataCapacity() const { return dataCapacity_; }
+    Stats getStats() const;
+
+private:
+    static size_t recordBytesFor(size_t payloadBytes) {
+        return (RECORD_HEADER_BYTES + payloadBytes + RECORD_ALIGNMENT - 1) & ~(RECORD_ALIGNMENT - 1);
+    }
+
+    uint64_t loadReadCursor() const;
+    void storeWriteCursor(uint64_t value);
+    void writeHeader(size_t offset, uint32_t recordBytes, Status status, int worldId,
+                     int chunkX, int chunkZ, uint32_t payloadBytes, uint64_t tag);
+
+    uint8_t* base_;
+    uint8_t* data_;
+    size_t dataCapacity_;
+
+    // 写入者之间互斥；reserve到commit期间持有
+    std::mutex writeMutex_;
+    uint64_t writeCursor_{0};
+    uint64_t reservedStart_{0};
+    size_t reservedBytes_{0};
+    std::atomic<bool> closed_{false};
+
+    mutable std::mutex statsMutex_;
+    Stats stats_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,296 @@
+#include "chunk_journal.hpp"
+#include "chunk_codecs.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) |
+           static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t readBigEndian64(const uint8_t* p) {
+    return (static_cast<uint64_t>(readBigEndian32(p)) << 32) | readBigEndian32(p + 4);
+}
+
+inline void appendBigEndian32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline void appendBigEndian64(std::vector<uint8_t>& out, uint64_t value) {
+    appendBigEndian32(out, static_cast<uint32_t>(value >> 32));
+    appendBigEndian32(out, static_cast<uint32_t>(value));
+}
+
+inline void writeBigEndian32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+bool pwriteFully(int fd, const uint8_t* data, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pwrite(fd, data + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool preadFully(int fd, uint8_t* data, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pread(fd, data + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool dataSync(int fd) {
+    while (::fdatasync(fd) != 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 新建文件后sync所在目录，保证目录项本身在崩溃后存在
+void syncParentDirectory(const std::string& path) {
+    std::string parent = std::filesystem::path(path).parent_path().string();
+    int dirFd = ::open(parent.empty() ? "." : parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+
+} // namespace
+
+// ===== ChunkJournal实现 =====
+
+std::string ChunkJournal::pathForWorld(const std::string& worldPath) {
+    return worldPath + "/" + FILE_NAME;
+}
+
+ChunkJournal::ChunkJournal(const std::string& path)
+    : path_(path), fd_(-1) {
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open chunk journal: " + std::string(strerror(errno)));
+    }
+
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("Failed to stat chunk journal: " + std::string(strerror(errno)));
+    }
+
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    if (size < FILE_HEADER_SIZE) {
+        // 新文件，或创建后还没来得及写完头部就崩溃了
+        uint8_t header[FILE_HEADER_SIZE];
+        writeBigEndian32(header, MAGIC);
+        writeBigEndian32(header + 4, VERSION);
+        if (::ftruncate(fd_, 0) != 0 || !pwriteFully(fd_, header, FILE_HEADER_SIZE, 0) || !dataSync(fd_)) {
+            ::close(fd_);
+            throw std::runtime_error("Failed to initialize chunk journal: " + std::string(strerror(errno)));
+        }
+        syncParentDirectory(path);
+        fileEnd_ = FILE_HEADER_SIZE;
+    } else {
+        uint8_t header[FILE_HEADER_SIZE];
+        if (!preadFully(fd_, header, FILE_HEADER_SIZE, 0) ||
+            readBigEndian32(header) != MAGIC || readBigEndian32(header + 4) != VERSION) {
+            ::close(fd_);
+            throw std::runtime_error("Invalid chunk journal header: " + path);
+        }
+        fileEnd_ = size;
+    }
+    stats_.fileBytes = fileEnd_;
+}
+
+ChunkJournal::~ChunkJournal() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+std::vector<ChunkJournal::Record> ChunkJournal::recover() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<Record> records;
+
+    uint64_t offset = FILE_HEADER_SIZE;
+    std::vector<uint8_t> body;
+    while (offset + RECORD_HEADER_SIZE <= fileEnd_) {
+        uint8_t header[RECORD_HEADER_SIZE];
+        if (!preadFully(fd_, header, RECORD_HEADER_SIZE, static_cast<off_t>(offset))) {
+            break;
+        }
+        const uint32_t bodyLength = readBigEndian32(header);
+        const uint32_t checksum = readBigEndian32(header + 4);
+        if (bodyLength < RECORD_BODY_PREFIX + 1 || bodyLength > MAX_RECORD_BODY ||
+            offset + RECORD_HEADER_SIZE + bodyLength > fileEnd_) {
+            break;
+        }
+
+        body.resize(bodyLength);
+        if (!preadFully(fd_, body.data(), bodyLength, static_cast<off_t>(offset + RECORD_HEADER_SIZE)) ||
+            codec::crc32(body.data(), bodyLength) != checksum) {
+            break;
+        }
+
+        Record record;
+        record.sequence = readBigEndian64(body.data());
+        record.worldId = static_cast<int32_t>(readBigEndian32(body.data() + 8));
+        record.chunkX = static_cast<int32_t>(readBigEndian32(body.data() + 12));
+        record.chunkZ = static_cast<int32_t>(readBigEndian32(body.data() + 16));
+        record.timestamp = readBigEndian32(body.data() + 20);
+        record.framed.assign(body.begin() + RECORD_BODY_PREFIX, body.end());
+        nextSequence_ = std::max(nextSequence_, record.sequence + 1);
+        records.push_back(std::move(record));
+
+        offset += RECORD_HEADER_SIZE + bodyLength;
+    }
+
+    // 丢弃末尾写了一半的记录，后续追加从最后一条完整记录之后开始
+    if (offset != fileEnd_) {
+        if (::ftruncate(fd_, static_cast<off_t>(offset)) == 0) {
+            dataSync(fd_);
+        }
+        fileEnd_ = offset;
+    }
+    durableSequence_ = nextSequence_ - 1;
+    stats_.fileBytes = fileEnd_;
+    return records;
+}
+
+uint64_t ChunkJournal::append(int worldId, int chunkX, int chunkZ, uint32_t timestamp,
+                              const uint8_t* framed, size_t framedSize) {
+    if (framedSize == 0 || framedSize > MAX_RECORD_BODY - RECORD_BODY_PREFIX) {
+        throw std::runtime_error("Invalid chunk journal record size");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (failed_) {
+        throw std::runtime_error("Chunk journal is unusable after a write failure");
+    }
+
+    const uint64_t sequence = nextSequence_++;
+    const size_t bodyLength = RECORD_BODY_PREFIX + framedSize;
+    const size_t start = pending_.size();
+    pending_.reserve(start + RECORD_HEADER_SIZE + bodyLength);
+
+    appendBigEndian32(pending_, static_cast<uint32_t>(bodyLength));
+    appendBigEndian32(pending_, 0);                 // 校验和在body写完后回填
+    appendBigEndian64(pending_, sequence);
+    appendBigEndian32(pending_, static_cast<uint32_t>(worldId));
+    appendBigEndian32(pending_, static_cast<uint32_t>(chunkX));
+    appendBigEndian32(pending_, static_cast<uint32_t>(chunkZ));
+    appendBigEndian32(pending_, timestamp);
+    pending_.insert(pending_.end(), framed, framed + framedSize);
+
+    const uint8_t* body = pending_.data() + start + RECORD_HEADER_SIZE;
+    writeBigEndian32(pending_.data() + start + 4, codec::crc32(body, bodyLength));
+
+    stats_.appended++;
+    return sequence;
+}
+
+void ChunkJournal::sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t target = nextSequence_ - 1;
+
+    while (durableSequence_ < target) {
+        if (failed_) {
+            throw std::runtime_error("Chunk journal write failed");
+        }
+        if (flushing_) {
+            // 其他线程正在写出，等待本轮结束后再判断
+            flushed_.wait(lock);
+            continue;
+        }
+
+        // 成为leader：写出到目前为止缓冲的所有记录
+        flushing_ = true;
+        std::vector<uint8_t> batch;
+        batch.swap(pending_);
+        const uint64_t batchSequence = nextSequence_ - 1;
+        const uint64_t offset = fileEnd_;
+        lock.unlock();
+
+        const bool ok = pwriteFully(fd_, batch.data(), batch.size(), static_cast<off_t>(offset)) && dataSync(fd_);
+
+        lock.lock();
+        flushing_ = false;
+        if (ok) {
+            fileEnd_ = offset + batch.size();
+            durableSequence_ = batchSequence;
+            stats_.syncs++;
+            stats_.bytesWritten += batch.size();
+            stats_.fileBytes = fileEnd_;
+        } else {
+            failed_ = true;
+        }
+        flushed_.notify_all();
+    }
+}
+
+bool ChunkJournal::checkpoint() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    flushed_.wait(lock, [this] { return !flushing_; });
+    if (failed_) {
+        return false;
+    }
+    if (::ftruncate(fd_, static_cast<off_t>(FILE_HEADER_SIZE)) != 0 || !dataSync(fd_)) {
+        return false;
+    }
+    fileEnd_ = FILE_HEADER_SIZE;
+    stats_.fileBytes = fileEnd_;
+    stats_.checkpoints++;
+    return true;
+}
+
+uint64_t ChunkJournal::fileBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return fileEnd_;
+}
+
+ChunkJournal::Stats ChunkJournal::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.pendingBytes = pending_.size();
+    return stats;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
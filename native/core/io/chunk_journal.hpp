@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * ChunkJournal - 区块保存的预写日志（仅追加）
+ *
+ * 写入region文件之前，先把已压缩的区块记录追加到日志并fdatasync；region写入本身不再落盘，
+ * 由检查点统一sync region后截断日志。崩溃后重启时重放日志中的完整记录，
+ * 末尾写了一半的记录按校验失败丢弃（该次保存从未向调用者报告成功）。
+ *
+ * 组提交：append只写入内存缓冲区，sync由第一个到达的线程作为leader一次写出
+ * 所有缓冲记录并fdatasync，期间到达的线程等待下一轮，N个并发保存只需约一次fsync。
+ *
+ * 文件格式（大端）：头部 魔数"LCJ1" + 版本号；每条记录为
+ * u32 bodyLength | u32 crc32(body) | body，
+ * body = u64 sequence | i32 worldId | i32 chunkX | i32 chunkZ | u32 timestamp | framed
+ * 其中framed为MinecraftCompressor的类型字节 + 压缩负载。
+ */
+class ChunkJournal {
+public:
+    static constexpr const char* FILE_NAME = "lattice_chunks.journal";
+    static constexpr uint32_t MAGIC = 0x4C434A31;        // "LCJ1"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t FILE_HEADER_SIZE = 8;
+    static constexpr size_t RECORD_HEADER_SIZE = 8;
+    static constexpr size_t RECORD_BODY_PREFIX = 24;
+    static constexpr size_t MAX_RECORD_BODY = 64 * 1024 * 1024;
+
+    struct Record {
+        uint64_t sequence{0};
+        int worldId{0};
+        int chunkX{0};
+        int chunkZ{0};
+        uint32_t timestamp{0};
+        std::vector<uint8_t> framed;
+    };
+
+    struct Stats {
+        uint64_t appended{0};
+        uint64_t syncs{0};               // fdatasync次数（组提交轮数）
+        uint64_t bytesWritten{0};
+        uint64_t checkpoints{0};
+        uint64_t fileBytes{0};           // 当前日志文件长度
+        size_t pendingBytes{0};          // 尚未写出的缓冲记录
+    };
+
+    static std::string pathForWorld(const std::string& worldPath);
+
+    // 打开或创建日志文件；已有内容保留，需先recover()。打开失败或头部无效时抛出std::runtime_error
+    explicit ChunkJournal(const std::string& path);
+    ~ChunkJournal();
+
+    ChunkJournal(const ChunkJournal&) = delete;
+    ChunkJournal& operator=(const ChunkJournal&) = delete;
+
+    /**
+     * 读取日志中所有完整记录（按写入顺序），截掉末尾损坏或不完整的部分
+     * 调用者应用这些记录并sync对应region后调用checkpoint()
+     */
+    std::vector<Record> recover();
+
+    // 追加到缓冲区，不做I/O；返回记录序号
+    uint64_t append(int worldId, int chunkX, int chunkZ, uint32_t timestamp,
+                    const uint8_t* framed, size_t framedSize);
+
+    /**
+     * 组提交：调用前追加的所有记录落盘后返回
+     * 写入或fdatasync失败时抛出std::runtime_error，此后日志不可再用
+     */
+    void sync();
+
+    /**
+     * 截断日志（保留尚未写出的缓冲记录）
+     * 调用者必须保证已写出的记录都已应用到region且region已sync
+     */
+    bool checkpoint();
+
+    const std::string& path() const { return path_; }
+    uint64_t fileBytes() const;
+    Stats getStats() const;
+
+private:
+    std::string path_;
+    int fd_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable flushed_;
+    std::vector<uint8_t> pending_;
+    uint64_t nextSequence_{1};
+    uint64_t durableSequence_{0};
+    uint64_t fileEnd_{0};
+    bool flushing_{false};
+    bool failed_{false};
+    Stats stats_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,140 @@
+#include "chunk_load_batcher.hpp"
+#include "anvil_format.hpp"
+#include <algorithm>
+#include <exception>
+#include <string>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+// ===== ChunkLoadBatcher实现 =====
+
+ChunkLoadBatcher::ChunkLoadBatcher(AnvilChunkIO& io, ChunkCompletionRing& ring, size_t workerCount)
+    : io_(io), ring_(ring) {
+    if (workerCount == 0) {
+        workerCount = std::max<size_t>(1, std::thread::hardware_concurrency() / 2);
+    }
+    workers_.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ChunkLoadBatcher::~ChunkLoadBatcher() {
+    shutdown();
+}
+
+size_t ChunkLoadBatcher::submit(int worldId, const uint64_t* packedCoords, size_t count, uint64_t tag) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return 0;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            queue_.push_back(Request{worldId, unpackX(packedCoords[i]), unpackZ(packedCoords[i]), tag});
+        }
+        stats_.submitted += count;
+    }
+    available_.notify_all();
+    return count;
+}
+
+void ChunkLoadBatcher::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ && workers_.empty()) {
+            return;
+        }
+        stopping_ = true;
+        stats_.dropped += queue_.size();
+        queue_.clear();
+    }
+    ring_.close();
+    available_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+}
+
+ChunkLoadBatcher::Stats ChunkLoadBatcher::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.pending = queue_.size();
+    return stats;
+}
+
+void ChunkLoadBatcher::workerLoop() {
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            request = queue_.front();
+            queue_.pop_front();
+        }
+        process(request);
+    }
+}
+
+void ChunkLoadBatcher::process(const Request& request) {
+    using Status = ChunkCompletionRing::Status;
+
+    // 区块从热缓存负载直接拷入环形缓冲区的预留空间
+    bool reserved = false;
+    bool tooLarge = false;
+    Status status = Status::OK;
+    std::string error;
+    size_t written = 0;
+    try {
+        written = io_.copyChunkDataForJava(request.worldId, request.chunkX, request.chunkZ,
+            [&](size_t size) -> uint8_t* {
+                if (!ring_.fits(size)) {
+                    tooLarge = true;
+                    return nullptr;
+                }
+                uint8_t* out = ring_.reserve(size);
+                reserved = out != nullptr;
+                return out;
+            });
+    } catch (const std::exception& e) {
+        status = Status::FAILED;
+        error = e.what();
+    }
+
+    bool published = true;
+    if (reserved) {
+        // copyChunkDataForJava在缓冲区分配之后只做memcpy，不会在预留后失败
+        ring_.commit(Status::OK, request.worldId, request.chunkX, request.chunkZ, request.tag, written);
+    } else {
+        if (status != Status::FAILED) {
+            status = tooLarge ? Status::TOO_LARGE : Status::NOT_FOUND;
+        }
+        published = ring_.publish(status, request.worldId, request.chunkX, request.chunkZ, request.tag,
+                                  reinterpret_cast<const uint8_t*>(error.data()), error.size());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!published) {
+        stats_.dropped++;
+        return;
+    }
+    stats_.completed++;
+    if (status == Status::NOT_FOUND) {
+        stats_.notFound++;
+    } else if (status == Status::FAILED) {
+        stats_.failed++;
+    } else if (status == Status::TOO_LARGE) {
+        stats_.tooLarge++;
+    }
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
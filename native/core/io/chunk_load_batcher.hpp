@@ -0,0 +1,82 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "chunk_completion_ring.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+class AnvilChunkIO;
+
+/**
+ * ChunkLoadBatcher - 批量区块加载，结果写入ChunkCompletionRing
+ *
+ * Java一次JNI调用提交一批打包坐标（(x << 32) | (z & 0xFFFFFFFF)），工作线程通过
+ * AnvilChunkIO::copyChunkDataForJava把区块直接拷入环形缓冲区，Java每tick轮询完成记录。
+ * 每个请求恰好产生一条完成记录（OK / NOT_FOUND / FAILED / TOO_LARGE），tag为提交时的批次标签。
+ *
+ * 环形缓冲区满时工作线程等待Java消费；析构时丢弃尚未开始的请求并关闭环形缓冲区。
+ */
+class ChunkLoadBatcher {
+public:
+    struct Stats {
+        uint64_t submitted{0};
+        uint64_t completed{0};
+        uint64_t notFound{0};
+        uint64_t failed{0};
+        uint64_t tooLarge{0};
+        uint64_t dropped{0};         // 关闭时尚未完成的请求
+        size_t pending{0};
+    };
+
+    static int unpackX(uint64_t packed) { return static_cast<int32_t>(packed >> 32); }
+    static int unpackZ(uint64_t packed) { return static_cast<int32_t>(packed & 0xFFFFFFFFu); }
+
+    // workerCount为0时按CPU核数的一半选择（至少1个）
+    ChunkLoadBatcher(AnvilChunkIO& io, ChunkCompletionRing& ring, size_t workerCount = 0);
+    ~ChunkLoadBatcher();
+
+    ChunkLoadBatcher(const ChunkLoadBatcher&) = delete;
+    ChunkLoadBatcher& operator=(const ChunkLoadBatcher&) = delete;
+
+    // 入队一批请求，立即返回；关闭后返回0
+    size_t submit(int worldId, const uint64_t* packedCoords, size_t count, uint64_t tag);
+
+    // 停止接受请求，唤醒等待环形缓冲区空间的工作线程并等待其退出
+    void shutdown();
+
+    Stats getStats() const;
+
+private:
+    struct Request {
+        int worldId;
+        int chunkX;
+        int chunkZ;
+        uint64_t tag;
+    };
+
+    void workerLoop();
+    void process(const Request& request);
+
+    AnvilChunkIO& io_;
+    ChunkCompletionRing& ring_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::deque<Request> queue_;
+    bool stopping_{false};
+    Stats stats_;
+
+    std::vector<std::thread> workers_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,400 @@
+#include "chunk_packet_store.hpp"
+#include "chunk_codecs.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+constexpr uint32_t FILE_MAGIC = 0x4C43504B;     // "LCPK"
+constexpr uint32_t FILE_VERSION = 1;
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) |
+           static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t readBigEndian64(const uint8_t* p) {
+    return (static_cast<uint64_t>(readBigEndian32(p)) << 32) | readBigEndian32(p + 4);
+}
+
+inline void writeBigEndian32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+inline void writeBigEndian64(uint8_t* p, uint64_t value) {
+    writeBigEndian32(p, static_cast<uint32_t>(value >> 32));
+    writeBigEndian32(p + 4, static_cast<uint32_t>(value));
+}
+
+bool preadFully(int fd, uint8_t* data, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pread(fd, data + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool pwriteFully(int fd, const uint8_t* data, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pwrite(fd, data + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+size_t slotOf(int localX, int localZ) {
+    return static_cast<size_t>((localX & 0x1F) + (localZ & 0x1F) * 32);
+}
+
+} // namespace
+
+ChunkPacketStore::Sidecar::~Sidecar() {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+ChunkPacketStore::ChunkPacketStore(size_t maxOpenFiles)
+    : maxOpenFiles_(std::max<size_t>(1, maxOpenFiles)),
+      generations_(new std::atomic<uint32_t>[GENERATION_SLOTS]) {
+    for (size_t i = 0; i < GENERATION_SLOTS; ++i) {
+        generations_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+std::string ChunkPacketStore::sidecarPath(const std::string& regionPath) {
+    constexpr const char* REGION_SUFFIX = ".mca";
+    if (regionPath.size() >= 4 && regionPath.compare(regionPath.size() - 4, 4, REGION_SUFFIX) == 0) {
+        return regionPath.substr(0, regionPath.size() - 4) + ".lcp";
+    }
+    return regionPath + ".lcp";
+}
+
+std::shared_ptr<ChunkPacketStore::Sidecar> ChunkPacketStore::open(const std::string& path, bool create) {
+    const int fd = ::open(path.c_str(), create ? (O_RDWR | O_CREAT) : O_RDWR, 0644);
+    if (fd < 0) {
+        return nullptr;
+    }
+    auto sidecar = std::make_shared<Sidecar>();
+    sidecar->path = path;
+    sidecar->fd = fd;
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        return nullptr;
+    }
+    sidecar->fileSize = static_cast<uint64_t>(st.st_size);
+
+    std::vector<uint8_t> header(INDEX_BYTES);
+    bool valid = sidecar->fileSize >= INDEX_BYTES && preadFully(fd, header.data(), header.size(), 0) &&
+                 readBigEndian32(header.data()) == FILE_MAGIC &&
+                 readBigEndian32(header.data() + 4) == FILE_VERSION;
+    if (valid) {
+        for (size_t slot = 0; slot < CHUNKS; ++slot) {
+            const uint8_t* p = header.data() + FILE_HEADER_BYTES + slot * INDEX_ENTRY_BYTES;
+            IndexEntry entry;
+            entry.offset = readBigEndian64(p);
+            entry.length = readBigEndian32(p + 8);
+            entry.saveTimestamp = readBigEndian32(p + 12);
+            entry.formatTag = readBigEndian32(p + 16);
+            entry.crc = readBigEndian32(p + 20);
+            // 越界的索引项（例如截断的文件）当作空
+            if (entry.length == 0 || entry.offset < INDEX_BYTES ||
+                entry.offset + entry.length > sidecar->fileSize) {
+                entry = IndexEntry{};
+            }
+            sidecar->liveBytes += entry.length;
+            sidecar->index[slot] = entry;
+        }
+        return sidecar;
+    }
+    if (!create) {
+        return nullptr;
+    }
+
+    // 新文件或无法识别的旧文件：写一个空索引
+    std::fill(header.begin(), header.end(), 0);
+    writeBigEndian32(header.data(), FILE_MAGIC);
+    writeBigEndian32(header.data() + 4, FILE_VERSION);
+    if (::ftruncate(fd, 0) != 0 || !pwriteFully(fd, header.data(), header.size(), 0)) {
+        return nullptr;
+    }
+    sidecar->fileSize = INDEX_BYTES;
+    return sidecar;
+}
+
+std::shared_ptr<ChunkPacketStore::Sidecar> ChunkPacketStore::acquire(const std::string& path, bool create) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = handles_.find(path);
+    if (it != handles_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return it->second.sidecar;
+    }
+    if (!create && missing_.count(path) != 0) {
+        return nullptr;
+    }
+
+    errno = 0;
+    auto sidecar = open(path, create);
+    if (!sidecar) {
+        if (!create && errno == ENOENT) {
+            missing_.insert(path);
+        }
+        return nullptr;
+    }
+    missing_.erase(path);
+    lru_.push_front(path);
+    handles_.emplace(path, Handle{sidecar, lru_.begin()});
+    // 从最久未用的开始淘汰；仍被其他线程持有的句柄跳过，否则下次acquire会为同一文件再打开
+    // 一个Sidecar，两个写入者各自追加到同一偏移
+    auto victim = lru_.end();
+    while (handles_.size() > maxOpenFiles_ && victim != lru_.begin()) {
+        --victim;
+        auto handle = handles_.find(*victim);
+        if (handle->second.sidecar.use_count() > 1) {
+            continue;
+        }
+        handles_.erase(handle);
+        victim = lru_.erase(victim);
+    }
+    return sidecar;
+}
+
+std::atomic<uint32_t>& ChunkPacketStore::generationSlot(const std::string& regionPath, size_t slot) const {
+    const size_t hash = std::hash<std::string>{}(regionPath) ^ (slot * 0x9E3779B97F4A7C15ULL);
+    return generations_[hash % GENERATION_SLOTS];
+}
+
+uint32_t ChunkPacketStore::generation(const std::string& regionPath, int localX, int localZ) const {
+    return generationSlot(regionPath, slotOf(localX, localZ)).load(std::memory_order_acquire);
+}
+
+bool ChunkPacketStore::writeIndexEntry(Sidecar& sidecar, size_t slot) {
+    const IndexEntry& entry = sidecar.index[slot];
+    uint8_t bytes[INDEX_ENTRY_BYTES];
+    writeBigEndian64(bytes, entry.offset);
+    writeBigEndian32(bytes + 8, entry.length);
+    writeBigEndian32(bytes + 12, entry.saveTimestamp);
+    writeBigEndian32(bytes + 16, entry.formatTag);
+    writeBigEndian32(bytes + 20, entry.crc);
+    return pwriteFully(sidecar.fd, bytes, sizeof(bytes),
+                       static_cast<off_t>(FILE_HEADER_BYTES + slot * INDEX_ENTRY_BYTES));
+}
+
+size_t ChunkPacketStore::read(const std::string& regionPath, int localX, int localZ, uint32_t saveTimestamp,
+                              uint32_t formatTag, const std::function<uint8_t*(size_t)>& acquireBuffer) {
+    auto sidecar = acquire(sidecarPath(regionPath), false);
+    if (!sidecar) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.misses++;
+        return 0;
+    }
+
+    std::shared_lock<std::shared_mutex> fileLock(sidecar->mutex);
+    const IndexEntry entry = sidecar->index[slotOf(localX, localZ)];
+    if (entry.length == 0 || entry.saveTimestamp != saveTimestamp || entry.formatTag != formatTag) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        (entry.length == 0 ? stats_.misses : stats_.stale)++;
+        return 0;
+    }
+
+    uint8_t* out = acquireBuffer(entry.length);
+    if (!out) {
+        return 0;
+    }
+    if (!preadFully(sidecar->fd, out, entry.length, static_cast<off_t>(entry.offset)) ||
+        codec::crc32(out, entry.length) != entry.crc) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.corrupt++;
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.hits++;
+    stats_.bytesServed += entry.length;
+    return entry.length;
+}
+
+bool ChunkPacketStore::write(const std::string& regionPath, int localX, int localZ, uint32_t saveTimestamp,
+                             uint32_t formatTag, uint32_t generation, const uint8_t* frame, size_t length) {
+    if (!frame || length == 0 || length > MAX_FRAME_BYTES) {
+        return false;
+    }
+    const size_t slot = slotOf(localX, localZ);
+    const std::atomic<uint32_t>& currentGeneration = generationSlot(regionPath, slot);
+    if (currentGeneration.load(std::memory_order_acquire) != generation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.discardedWrites++;
+        return false;
+    }
+    auto sidecar = acquire(sidecarPath(regionPath), true);
+    if (!sidecar) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> fileLock(sidecar->mutex);
+    // invalidate先递增代数再取独占锁：这里核对通过的帧，随后的invalidate一定会清掉
+    if (currentGeneration.load(std::memory_order_acquire) != generation) {
+        fileLock.unlock();
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.discardedWrites++;
+        return false;
+    }
+    // 先写帧再更新索引：中途失败时索引仍指向旧帧
+    const uint64_t offset = sidecar->fileSize;
+    if (!pwriteFully(sidecar->fd, frame, length, static_cast<off_t>(offset))) {
+        return false;
+    }
+    sidecar->fileSize += length;
+
+    IndexEntry& entry = sidecar->index[slot];
+    sidecar->liveBytes -= entry.length;
+    entry.offset = offset;
+    entry.length = static_cast<uint32_t>(length);
+    entry.saveTimestamp = saveTimestamp;
+    entry.formatTag = formatTag;
+    entry.crc = codec::crc32(frame, length);
+    sidecar->liveBytes += length;
+    if (!writeIndexEntry(*sidecar, slot)) {
+        entry = IndexEntry{};
+        sidecar->liveBytes -= length;
+        return false;
+    }
+
+    bool compacted = false;
+    const uint64_t deadBytes = sidecar->fileSize - INDEX_BYTES - sidecar->liveBytes;
+    if (deadBytes >= COMPACT_MIN_BYTES && deadBytes > sidecar->liveBytes) {
+        compacted = compactLocked(*sidecar);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.writes++;
+    stats_.bytesWritten += length;
+    stats_.compactions += compacted ? 1 : 0;
+    return true;
+}
+
+bool ChunkPacketStore::compactLocked(Sidecar& sidecar) {
+    const std::string tempPath = sidecar.path + ".tmp";
+    const int fd = ::open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    std::array<IndexEntry, CHUNKS> index = sidecar.index;
+    std::vector<uint8_t> header(INDEX_BYTES, 0);
+    std::vector<uint8_t> frame;
+    uint64_t offset = INDEX_BYTES;
+    bool ok = true;
+    for (size_t slot = 0; slot < CHUNKS && ok; ++slot) {
+        IndexEntry& entry = index[slot];
+        if (entry.length == 0) {
+            continue;
+        }
+        frame.resize(entry.length);
+        ok = preadFully(sidecar.fd, frame.data(), frame.size(), static_cast<off_t>(entry.offset)) &&
+             pwriteFully(fd, frame.data(), frame.size(), static_cast<off_t>(offset));
+        entry.offset = offset;
+        offset += entry.length;
+
+        uint8_t* p = header.data() + FILE_HEADER_BYTES + slot * INDEX_ENTRY_BYTES;
+        writeBigEndian64(p, entry.offset);
+        writeBigEndian32(p + 8, entry.length);
+        writeBigEndian32(p + 12, entry.saveTimestamp);
+        writeBigEndian32(p + 16, entry.formatTag);
+        writeBigEndian32(p + 20, entry.crc);
+    }
+    writeBigEndian32(header.data(), FILE_MAGIC);
+    writeBigEndian32(header.data() + 4, FILE_VERSION);
+    ok = ok && pwriteFully(fd, header.data(), header.size(), 0) &&
+         std::rename(tempPath.c_str(), sidecar.path.c_str()) == 0;
+    if (!ok) {
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        return false;
+    }
+
+    ::close(sidecar.fd);
+    sidecar.fd = fd;
+    sidecar.fileSize = offset;
+    sidecar.index = index;
+    return true;
+}
+
+void ChunkPacketStore::invalidate(const std::string& regionPath, int localX, int localZ) {
+    const size_t slot = slotOf(localX, localZ);
+    // 即使旁路文件还不存在也要递增：正在压缩的帧可能随后才创建它
+    generationSlot(regionPath, slot).fetch_add(1, std::memory_order_acq_rel);
+    auto sidecar = acquire(sidecarPath(regionPath), false);
+    if (!sidecar) {
+        return;
+    }
+    std::unique_lock<std::shared_mutex> fileLock(sidecar->mutex);
+    IndexEntry& entry = sidecar->index[slot];
+    if (entry.length == 0) {
+        return;
+    }
+    sidecar->liveBytes -= entry.length;
+    entry = IndexEntry{};
+    writeIndexEntry(*sidecar, slot);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.invalidations++;
+}
+
+void ChunkPacketStore::forget(const std::string& regionPath) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const std::string path = sidecarPath(regionPath);
+    auto it = handles_.find(path);
+    if (it != handles_.end()) {
+        lru_.erase(it->second.lruPos);
+        handles_.erase(it);
+    }
+    missing_.erase(path);
+}
+
+void ChunkPacketStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handles_.clear();
+    lru_.clear();
+    missing_.clear();
+}
+
+ChunkPacketStore::Stats ChunkPacketStore::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats result = stats_;
+    result.openFiles = handles_.size();
+    return result;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
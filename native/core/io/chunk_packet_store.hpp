@@ -0,0 +1,154 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * ChunkPacketStore - 与region文件并列持久化的预压缩区块数据包（可选）
+ *
+ * 大厅、小游戏这类静态地图上每个区块的数据包从不变化，每次加入都重新序列化、压缩是浪费。
+ * 这里为每个region保存一个旁路文件（r.X.Z.mca旁的r.X.Z.lcp），记录每个区块编码并压缩好的
+ * 网络帧（与ChunkPacketCache相同：VarInt(未压缩长度) + zlib数据），命中时直接pread到
+ * 发送缓冲区，不经过序列化和压缩。
+ *
+ * - 每条记录带生成时该区块在region头部中的保存时间戳，与当前时间戳不同即视为过期；
+ *   formatTag由Java提供（协议版本、压缩级别等），不同同样视为过期
+ * - 记录带CRC-32，损坏的记录按未命中处理
+ * - 帧追加写入，头部逐项原地更新；被替换的旧帧超过存活数据且不少于COMPACT_MIN_BYTES时整体重写
+ * - 旁路文件只是缓存：格式不符或损坏时直接重建，删除它不影响世界数据
+ *
+ * 文件格式（大端序）：16字节文件头（魔数、版本）+ 1024项 × 24字节索引，之后为帧数据；
+ * 索引项为 offset(8) + length(4) + saveTimestamp(4) + formatTag(4) + crc32(4)，length为0表示空。
+ * 打开的旁路文件按LRU缓存，读取持有共享锁，写入与重写持有独占锁。
+ *
+ * 时间戳只有秒级分辨率：同一秒内的保存不会让旧帧按时间戳过期。每个区块因此另有一个保存代数，
+ * invalidate先递增代数再清除记录，write在独占锁下核对调用方压缩前取得的代数，不符就丢弃帧，
+ * 这样保存之后才写入的旧帧不会留在文件里。
+ */
+class ChunkPacketStore {
+public:
+    static constexpr size_t DEFAULT_MAX_OPEN_FILES = 64;
+    static constexpr uint64_t COMPACT_MIN_BYTES = 4 * 1024 * 1024;
+    static constexpr size_t MAX_FRAME_BYTES = 64 * 1024 * 1024;
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};              // 没有记录（含旁路文件不存在）
+        uint64_t stale{0};               // 保存时间戳或formatTag不符
+        uint64_t corrupt{0};             // 读取失败或CRC不符
+        uint64_t writes{0};
+        uint64_t discardedWrites{0};     // 压缩期间区块被保存，帧已过期
+        uint64_t invalidations{0};
+        uint64_t compactions{0};
+        uint64_t bytesServed{0};
+        uint64_t bytesWritten{0};
+        size_t openFiles{0};
+    };
+
+    explicit ChunkPacketStore(size_t maxOpenFiles = DEFAULT_MAX_OPEN_FILES);
+    ~ChunkPacketStore() = default;
+
+    ChunkPacketStore(const ChunkPacketStore&) = delete;
+    ChunkPacketStore& operator=(const ChunkPacketStore&) = delete;
+
+    // region文件对应的旁路文件路径（.mca换成.lcp）
+    static std::string sidecarPath(const std::string& regionPath);
+
+    /**
+     * 读出区块的帧，写入acquireBuffer(size)返回的缓冲区
+     * 返回写入的字节数；没有有效记录（不存在、过期、损坏）或acquireBuffer返回nullptr时返回0
+     * 损坏时缓冲区已经分配，由调用方归还
+     */
+    size_t read(const std::string& regionPath, int localX, int localZ, uint32_t saveTimestamp,
+                uint32_t formatTag, const std::function<uint8_t*(size_t)>& acquireBuffer);
+
+    // 区块当前的保存代数；调用方在读取保存时间戳、压缩帧之前取得，交给write核对
+    uint32_t generation(const std::string& regionPath, int localX, int localZ) const;
+
+    /**
+     * 写入（替换）区块的帧；旁路文件不存在时创建
+     * 期间区块被保存过（代数不等于generation）时丢弃帧，与I/O失败一样返回false
+     */
+    bool write(const std::string& regionPath, int localX, int localZ, uint32_t saveTimestamp,
+               uint32_t formatTag, uint32_t generation, const uint8_t* frame, size_t length);
+
+    // 清除一个区块的记录并递增保存代数（区块保存后调用，不依赖秒级的时间戳分辨率）
+    void invalidate(const std::string& regionPath, int localX, int localZ);
+
+    // 关闭旁路文件（region被替换时调用，旧记录随后按时间戳过期）
+    void forget(const std::string& regionPath);
+    void clear();
+
+    Stats getStats() const;
+
+private:
+    static constexpr size_t FILE_HEADER_BYTES = 16;
+    static constexpr size_t INDEX_ENTRY_BYTES = 24;
+    static constexpr size_t CHUNKS = 32 * 32;
+    static constexpr size_t INDEX_BYTES = FILE_HEADER_BYTES + CHUNKS * INDEX_ENTRY_BYTES;
+    // 保存代数按(region, 区块)散列到固定大小的表，冲突只会多丢弃一些帧
+    static constexpr size_t GENERATION_SLOTS = 16384;
+
+    struct IndexEntry {
+        uint64_t offset{0};
+        uint32_t length{0};
+        uint32_t saveTimestamp{0};
+        uint32_t formatTag{0};
+        uint32_t crc{0};
+    };
+
+    struct Sidecar {
+        std::string path;
+        int fd{-1};
+        uint64_t fileSize{0};
+        uint64_t liveBytes{0};                   // 索引引用的帧字节数
+        std::array<IndexEntry, CHUNKS> index{};
+        mutable std::shared_mutex mutex;
+
+        ~Sidecar();
+    };
+
+    using LruList = std::list<std::string>;
+
+    struct Handle {
+        std::shared_ptr<Sidecar> sidecar;
+        LruList::iterator lruPos;
+    };
+
+    /**
+     * 打开（create时必要时创建或重建）旁路文件；不存在且create为false时返回nullptr
+     * 确认不存在的路径会被记住，之后的只读访问（每次保存都有的invalidate）不再调用open()
+     */
+    std::shared_ptr<Sidecar> acquire(const std::string& path, bool create);
+    std::atomic<uint32_t>& generationSlot(const std::string& regionPath, size_t slot) const;
+    static std::shared_ptr<Sidecar> open(const std::string& path, bool create);
+    static bool writeIndexEntry(Sidecar& sidecar, size_t slot);
+    // 只保留索引引用的帧重写整个文件（持有sidecar的独占锁）
+    bool compactLocked(Sidecar& sidecar);
+
+    size_t maxOpenFiles_;
+    mutable std::mutex mutex_;
+    LruList lru_;                                // 头部 = 最近使用
+    std::unordered_map<std::string, Handle> handles_;
+    std::unordered_set<std::string> missing_;    // 已确认不存在的旁路文件
+    Stats stats_;
+    std::unique_ptr<std::atomic<uint32_t>[]> generations_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
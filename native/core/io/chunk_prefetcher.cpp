@@ -0,0 +1,343 @@
+#include "chunk_prefetcher.hpp"
+#include "async_chunk_io.hpp"
+#include "hot_chunk_cache.hpp"
+#include "../net/hierarchical_tracker.hpp"
+#include "../tick_budget.hpp"
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace lattice {
+namespace io {
+
+namespace {
+
+constexpr float CHUNK_SIZE = 16.0f;
+constexpr float SAMPLE_STEP = 8.0f;      // 沿前进方向的取样间隔（方块），半个区块保证不漏格
+
+struct ChunkTarget {
+    int x;
+    int z;
+    uint64_t key;
+};
+
+inline int toChunkCoord(float blockCoord) {
+    return static_cast<int>(std::floor(blockCoord / CHUNK_SIZE));
+}
+
+// 为当前速度规划视距前沿的区块，按距离由近到远，同一距离先中心后两侧
+std::vector<ChunkTarget> planTargets(const ChunkPrefetcher::Config& config, int worldId,
+                                     const entity::PlayerPredictor& predictor) {
+    std::vector<ChunkTarget> targets;
+    const float vx = predictor.velocityX;
+    const float vz = predictor.velocityZ;
+    const float speed = std::sqrt(vx * vx + vz * vz);
+    if (!(speed >= config.minSpeed)) {
+        return targets;
+    }
+
+    const float dirX = vx / speed;
+    const float dirZ = vz / speed;
+    const float originX = predictor.lastPos.x;
+    const float originZ = predictor.lastPos.z;
+    const int originChunkX = toChunkCoord(originX);
+    const int originChunkZ = toChunkCoord(originZ);
+
+    // 从视距边缘开始，到lookahead秒后的视距边缘结束
+    const float start = config.viewDistance * CHUNK_SIZE;
+    const float end = start + speed * config.lookaheadSeconds;
+
+    std::unordered_set<uint64_t> seen;
+    for (float s = start; s <= end && targets.size() < config.maxChunksPerPlayer; s += SAMPLE_STEP) {
+        const float px = originX + dirX * s;
+        const float pz = originZ + dirZ * s;
+        for (int i = 0; i <= 2 * config.corridorRadius && targets.size() < config.maxChunksPerPlayer; ++i) {
+            // 0, -1, +1, -2, +2 ...
+            const int lateral = (i % 2 == 0) ? i / 2 : -(i + 1) / 2;
+            const float offset = lateral * CHUNK_SIZE;
+            const int chunkX = toChunkCoord(px - dirZ * offset);
+            const int chunkZ = toChunkCoord(pz + dirX * offset);
+
+            // 已在视距内的区块由正常加载负责
+            if (std::abs(chunkX - originChunkX) <= config.viewDistance &&
+                std::abs(chunkZ - originChunkZ) <= config.viewDistance) {
+                continue;
+            }
+
+            const uint64_t key = anvil::HotChunkCache::packKey(worldId, chunkX, chunkZ);
+            if (seen.insert(key).second) {
+                targets.push_back({chunkX, chunkZ, key});
+            }
+        }
+    }
+    return targets;
+}
+
+} // namespace
+
+// ===== 共享状态 =====
+// I/O完成回调可能晚于ChunkPrefetcher析构，回调持有State的shared_ptr
+
+struct ChunkPrefetcher::State {
+    struct Player {
+        int worldId{0};
+        std::deque<ChunkTarget> pending;
+        std::unordered_set<uint64_t> done;      // 已完成且仍在规划中的区块
+    };
+
+    struct InFlight {
+        int playerId;
+        bool stale;
+        bool cancelling;                    // 正在向调度器撤回
+        IORequestId requestId;
+    };
+
+    AsyncChunkIO* io;
+    Config config;
+    bool stopped{false};
+
+    mutable std::mutex mutex;
+    std::unordered_map<int, Player> players;
+    std::unordered_map<uint64_t, InFlight> inFlight;
+    PrefetchSink sink;
+    Stats stats;
+
+    // 取出一批待发起的请求（调用者持有mutex），玩家之间轮流
+    std::vector<std::pair<int, ChunkTarget>> takeBatchLocked() {
+        std::vector<std::pair<int, ChunkTarget>> batch;
+        // 主线程超时时不再发起新预取（已排队的留到下次update），有余量时放宽并发上限
+        const size_t maxInFlight = core::TickBudget::instance().scale(core::DeferrableWork::PREFETCH,
+                                                                      config.maxInFlight);
+        bool progressed = true;
+        while (progressed && inFlight.size() < maxInFlight) {
+            progressed = false;
+            for (auto& [playerId, player] : players) {
+                if (inFlight.size() >= maxInFlight) {
+                    break;
+                }
+                while (!player.pending.empty()) {
+                    ChunkTarget target = player.pending.front();
+                    player.pending.pop_front();
+                    // 其他玩家已在预取同一区块
+                    if (inFlight.count(target.key)) {
+                        continue;
+                    }
+                    inFlight.emplace(target.key, InFlight{playerId, false, false, INVALID_IO_REQUEST});
+                    batch.emplace_back(player.worldId, target);
+                    stats.issued++;
+                    progressed = true;
+                    break;
+                }
+            }
+        }
+        return batch;
+    }
+
+    static void pump(const std::shared_ptr<State>& self) {
+        // 同步后端会在发起时直接回调，回调中的pump由最外层循环接管，避免递归
+        thread_local bool pumping = false;
+        if (pumping) {
+            return;
+        }
+        pumping = true;
+
+        while (true) {
+            std::vector<std::pair<int, ChunkTarget>> batch;
+            {
+                std::lock_guard<std::mutex> lock(self->mutex);
+                if (self->stopped) {
+                    break;
+                }
+                batch = self->takeBatchLocked();
+            }
+            if (batch.empty()) {
+                break;
+            }
+            for (const auto& [worldId, target] : batch) {
+                issue(self, worldId, target);
+            }
+        }
+
+        pumping = false;
+    }
+
+    static void issue(const std::shared_ptr<State>& self, int worldId, const ChunkTarget& target) {
+        const uint64_t key = target.key;
+        auto onComplete = [self, key](AsyncIOResult result) {
+            PrefetchSink sink;
+            int playerId = 0;
+            {
+                std::lock_guard<std::mutex> lock(self->mutex);
+                auto it = self->inFlight.find(key);
+                if (it == self->inFlight.end()) {
+                    return;
+                }
+                InFlight entry = it->second;
+                self->inFlight.erase(it);
+
+                auto playerIt = self->players.find(entry.playerId);
+                if (entry.stale || self->stopped || playerIt == self->players.end()) {
+                    // 在调度队列中被撤回的请求已计入cancelled
+                    if (!entry.cancelling) {
+                        self->stats.discarded++;
+                    }
+                } else {
+                    self->stats.completed++;
+                    playerIt->second.done.insert(key);
+                    sink = self->sink;
+                    playerId = entry.playerId;
+                }
+            }
+            if (sink && result.success) {
+                sink(playerId, result);
+            }
+            pump(self);
+        };
+
+        IORequestOptions options;
+        options.priority = IOPriority::PREFETCH;
+        IORequestId requestId = self->io->loadChunkAsync(worldId, target.x, target.z,
+                                                         std::move(onComplete), options);
+
+        // 同步完成时条目已被移除
+        std::lock_guard<std::mutex> lock(self->mutex);
+        auto it = self->inFlight.find(key);
+        if (it != self->inFlight.end()) {
+            it->second.requestId = requestId;
+        }
+    }
+
+    // 把过期请求从AsyncChunkIO调度队列中撤回；已开始读取的只能等完成后丢弃
+    static void withdraw(const std::shared_ptr<State>& self, const std::vector<std::pair<uint64_t, IORequestId>>& stale) {
+        for (const auto& [key, requestId] : stale) {
+            if (self->io->cancelRequest(requestId)) {
+                std::lock_guard<std::mutex> lock(self->mutex);
+                self->stats.cancelled++;
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(self->mutex);
+            auto it = self->inFlight.find(key);
+            if (it != self->inFlight.end() && it->second.requestId == requestId) {
+                it->second.cancelling = false;
+            }
+        }
+    }
+
+    // 标记玩家不再需要的在途请求（调用者持有mutex），返回需要撤回的请求
+    std::vector<std::pair<uint64_t, IORequestId>> markStaleLocked(int playerId,
+                                                                  const std::unordered_set<uint64_t>* keep) {
+        std::vector<std::pair<uint64_t, IORequestId>> stale;
+        for (auto& [key, entry] : inFlight) {
+            if (entry.playerId != playerId || entry.stale || (keep && keep->count(key))) {
+                continue;
+            }
+            entry.stale = true;
+            if (entry.requestId != INVALID_IO_REQUEST) {
+                entry.cancelling = true;
+                stale.emplace_back(key, entry.requestId);
+            }
+        }
+        return stale;
+    }
+};
+
+ChunkPrefetcher::ChunkPrefetcher(AsyncChunkIO& io)
+    : ChunkPrefetcher(io, Config{}) {
+}
+
+ChunkPrefetcher::ChunkPrefetcher(AsyncChunkIO& io, const Config& config)
+    : state_(std::make_shared<State>()) {
+    state_->io = &io;
+    state_->config = config;
+}
+
+ChunkPrefetcher::~ChunkPrefetcher() {
+    // 已发出的读取完成时只更新统计，不再回调sink或发起新请求
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->stopped = true;
+    state_->players.clear();
+    state_->sink = nullptr;
+}
+
+void ChunkPrefetcher::setSink(PrefetchSink sink) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->sink = std::move(sink);
+}
+
+void ChunkPrefetcher::update(int playerId, int worldId, const entity::PlayerPredictor& predictor) {
+    std::vector<ChunkTarget> plan = planTargets(state_->config, worldId, predictor);
+    std::unordered_set<uint64_t> planned;
+    planned.reserve(plan.size());
+    for (const auto& target : plan) {
+        planned.insert(target.key);
+    }
+
+    std::vector<std::pair<uint64_t, IORequestId>> stale;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        auto& player = state_->players[playerId];
+        player.worldId = worldId;
+
+        // 不在新规划中的排队请求直接取消
+        for (const auto& target : player.pending) {
+            if (!planned.count(target.key)) {
+                state_->stats.cancelled++;
+            }
+        }
+        player.pending.clear();
+
+        // 已发出的请求标记为过期，仍在调度队列中的随后撤回
+        stale = state_->markStaleLocked(playerId, &planned);
+
+        for (auto it = player.done.begin(); it != player.done.end();) {
+            it = planned.count(*it) ? std::next(it) : player.done.erase(it);
+        }
+
+        for (const auto& target : plan) {
+            auto flight = state_->inFlight.find(target.key);
+            if (flight != state_->inFlight.end()) {
+                // 预测回到原路线时恢复尚未撤回的过期请求
+                if (flight->second.playerId == playerId && !flight->second.cancelling) {
+                    flight->second.stale = false;
+                }
+                continue;
+            }
+            if (!player.done.count(target.key)) {
+                player.pending.push_back(target);
+            }
+        }
+    }
+
+    State::withdraw(state_, stale);
+    State::pump(state_);
+}
+
+void ChunkPrefetcher::removePlayer(int playerId) {
+    std::vector<std::pair<uint64_t, IORequestId>> stale;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        auto it = state_->players.find(playerId);
+        if (it == state_->players.end()) {
+            return;
+        }
+        state_->stats.cancelled += it->second.pending.size();
+        state_->players.erase(it);
+        stale = state_->markStaleLocked(playerId, nullptr);
+    }
+    State::withdraw(state_, stale);
+}
+
+ChunkPrefetcher::Stats ChunkPrefetcher::getStats() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    Stats stats = state_->stats;
+    stats.inFlight = state_->inFlight.size();
+    for (const auto& [playerId, player] : state_->players) {
+        stats.pending += player.pending.size();
+    }
+    return stats;
+}
+
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "io_types.hpp"
+
+namespace lattice {
+namespace entity {
+struct PlayerPredictor;
+}
+
+namespace io {
+
+class AsyncChunkIO;
+
+/**
+ * ChunkPrefetcher - 按玩家移动方向预取区块
+ *
+ * BatchOptimizer只能整理已经排队的请求；高速移动的玩家（鞘翅）在区块进入视距时
+ * 才发起加载，往往来不及。预取器用PlayerPredictor的速度外推玩家前进方向，
+ * 对视距前沿lookaheadSeconds秒内将进入视距的区块提前发起AsyncChunkIO读取。
+ *
+ * - 规划：沿前进方向在视距边缘之外取样，每个样本点覆盖垂直方向corridorRadius个区块
+ * - 低优先级：以IOPriority::PREFETCH提交，并发数受maxInFlight限制，多个玩家之间轮流发起
+ * - 取消：每次update重新规划，不再位于新规划中的请求从调度队列撤回；
+ *   已开始读取的请求无法中止，完成后结果被丢弃（不回调sink）
+ *
+ * 线程安全：update/removePlayer可以从tick线程调用，完成回调来自I/O线程。
+ */
+class ChunkPrefetcher {
+public:
+    struct Config {
+        int viewDistance = 10;              // 服务器视距（区块），视距内的区块由正常加载负责
+        float lookaheadSeconds = 3.0f;      // 预取视距前沿多少秒内会进入视距的区块
+        int corridorRadius = 1;             // 前进方向两侧额外覆盖的区块数
+        float minSpeed = 8.0f;              // 低于该速度（方块/秒）不预取
+        size_t maxChunksPerPlayer = 48;
+        size_t maxInFlight = 32;            // 所有玩家共享的并发预取上限
+    };
+
+    struct Stats {
+        uint64_t issued{0};
+        uint64_t completed{0};
+        uint64_t cancelled{0};      // 读取开始前因预测变化被丢弃
+        uint64_t discarded{0};      // 已发出但完成时已不在规划中
+        size_t pending{0};
+        size_t inFlight{0};
+    };
+
+    // 预取完成（且仍在规划中）时调用，用于预热上层缓存
+    using PrefetchSink = std::function<void(int playerId, const AsyncIOResult& result)>;
+
+    explicit ChunkPrefetcher(AsyncChunkIO& io);
+    ChunkPrefetcher(AsyncChunkIO& io, const Config& config);
+    ~ChunkPrefetcher();
+
+    ChunkPrefetcher(const ChunkPrefetcher&) = delete;
+    ChunkPrefetcher& operator=(const ChunkPrefetcher&) = delete;
+
+    void setSink(PrefetchSink sink);
+
+    // 用玩家最新的预测重新规划并发起预取
+    void update(int playerId, int worldId, const entity::PlayerPredictor& predictor);
+
+    // 玩家离线或换世界：丢弃其所有预取
+    void removePlayer(int playerId);
+
+    Stats getStats() const;
+
+private:
+    struct State;
+    std::shared_ptr<State> state_;
+};
+
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,270 @@
+#include "hot_chunk_cache.hpp"
+#include <algorithm>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+// splitmix64终混：相邻区块的键只差低位，直接取模会集中到少数分片
+inline uint64_t mixKey(uint64_t key) {
+    key ^= key >> 30;
+    key *= 0xbf58476d1ce4e5b9ULL;
+    key ^= key >> 27;
+    key *= 0x94d049bb133111ebULL;
+    key ^= key >> 31;
+    return key;
+}
+
+} // namespace
+
+HotChunkCache::HotChunkCache(size_t byteBudget, size_t shardCount)
+    : byteBudget_(byteBudget) {
+    shardCount = std::max<size_t>(1, shardCount);
+    shards_.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->budget = byteBudget / shardCount;
+        shards_.push_back(std::move(shard));
+    }
+    shedderId_ = core::MemoryBudget::instance().addShedder(
+        core::MemorySubsystem::CHUNK_CACHE, [this](size_t bytes) { return shed(bytes); });
+}
+
+HotChunkCache::~HotChunkCache() {
+    // 等待正在执行的回收结束；剩余的记账由memory_析构归还
+    core::MemoryBudget::instance().removeShedder(shedderId_);
+}
+
+HotChunkCache::Shard& HotChunkCache::shardFor(uint64_t key) {
+    return *shards_[mixKey(key) % shards_.size()];
+}
+
+bool HotChunkCache::get(uint64_t key, Entry& entry) {
+    Shard& shard = shardFor(key);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Slot& slot = shard.slots[it->second];
+            slot.referenced = true;
+            entry = slot.entry;
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool HotChunkCache::contains(uint64_t key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.index.count(key) != 0;
+}
+
+uint32_t& HotChunkCache::generationSlot(Shard& shard, uint64_t key) {
+    // 分片用mixKey的低位取模，代数槽取高位，两者互不相关
+    return shard.generations[(mixKey(key) >> 48) % GENERATION_SLOTS];
+}
+
+void HotChunkCache::put(uint64_t key, Payload payload, uint32_t lastModified) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    generationSlot(shard, key)++;
+    if (payload) {
+        insertLocked(shard, key, std::move(payload), lastModified);
+    }
+}
+
+uint32_t HotChunkCache::generation(uint64_t key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return generationSlot(shard, key);
+}
+
+bool HotChunkCache::putIfCurrent(uint64_t key, Payload payload, uint32_t lastModified, uint32_t generation) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (generationSlot(shard, key) != generation) {
+        staleFills_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    if (payload) {
+        insertLocked(shard, key, std::move(payload), lastModified);
+    }
+    return true;
+}
+
+void HotChunkCache::insertLocked(Shard& shard, uint64_t key, Payload payload, uint32_t lastModified) {
+    const size_t bytes = payload->size() + ENTRY_OVERHEAD;
+    const size_t bytesBefore = shard.bytes;
+
+    // 单个超大区块不能挤掉整片缓存
+    if (bytes > shard.budget / 8) {
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            releaseSlot(shard, it->second);
+            accountShard(shard, bytesBefore);
+        }
+        return;
+    }
+
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        Slot& slot = shard.slots[it->second];
+        shard.bytes = shard.bytes - slot.bytes + bytes;
+        slot.entry.payload = std::move(payload);
+        slot.entry.lastModified = lastModified;
+        slot.bytes = bytes;
+        slot.referenced = true;
+        evictUntil(shard, shard.budget);
+        accountShard(shard, bytesBefore);
+        return;
+    }
+
+    evictUntil(shard, shard.budget - bytes);
+
+    size_t slotIndex;
+    if (!shard.freeSlots.empty()) {
+        slotIndex = shard.freeSlots.back();
+        shard.freeSlots.pop_back();
+    } else {
+        slotIndex = shard.slots.size();
+        shard.slots.emplace_back();
+    }
+
+    Slot& slot = shard.slots[slotIndex];
+    slot.key = key;
+    slot.entry.payload = std::move(payload);
+    slot.entry.lastModified = lastModified;
+    slot.bytes = bytes;
+    slot.referenced = false;  // 新条目需要再次命中才能躲过一轮扫描
+    slot.occupied = true;
+
+    shard.index.emplace(key, slotIndex);
+    shard.bytes += bytes;
+    insertions_.fetch_add(1, std::memory_order_relaxed);
+    accountShard(shard, bytesBefore);
+}
+
+void HotChunkCache::erase(uint64_t key) {
+    Shard& shard = shardFor(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    generationSlot(shard, key)++;
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        const size_t bytesBefore = shard.bytes;
+        releaseSlot(shard, it->second);
+        accountShard(shard, bytesBefore);
+    }
+}
+
+void HotChunkCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        memory_.sub(shard->bytes);
+        shard->slots.clear();
+        shard->freeSlots.clear();
+        shard->index.clear();
+        shard->hand = 0;
+        shard->bytes = 0;
+        for (uint32_t& generation : shard->generations) {
+            generation++;
+        }
+    }
+}
+
+void HotChunkCache::setByteBudget(size_t byteBudget) {
+    byteBudget_.store(byteBudget, std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        const size_t bytesBefore = shard->bytes;
+        shard->budget = byteBudget / shards_.size();
+        evictUntil(*shard, shard->budget);
+        accountShard(*shard, bytesBefore);
+    }
+}
+
+size_t HotChunkCache::shed(size_t bytes) {
+    // 各片按当前占用比例分摊，热点片多淘汰
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->bytes;
+    }
+    if (total == 0) {
+        return 0;
+    }
+    const double fraction = std::min(1.0, static_cast<double>(bytes) / static_cast<double>(total));
+    size_t released = 0;
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        const size_t bytesBefore = shard->bytes;
+        const size_t target = bytesBefore - static_cast<size_t>(static_cast<double>(bytesBefore) * fraction);
+        evictUntil(*shard, target);
+        released += bytesBefore - shard->bytes;
+        accountShard(*shard, bytesBefore);
+    }
+    return released;
+}
+
+HotChunkCache::Stats HotChunkCache::getStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.insertions = insertions_.load(std::memory_order_relaxed);
+    stats.staleFills = staleFills_.load(std::memory_order_relaxed);
+    stats.byteBudget = byteBudget_.load(std::memory_order_relaxed);
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        stats.entries += shard->index.size();
+        stats.bytes += shard->bytes;
+    }
+    return stats;
+}
+
+void HotChunkCache::accountShard(Shard& shard, size_t bytesBefore) {
+    if (shard.bytes > bytesBefore) {
+        memory_.add(shard.bytes - bytesBefore);
+    } else if (shard.bytes < bytesBefore) {
+        memory_.sub(bytesBefore - shard.bytes);
+    }
+}
+
+void HotChunkCache::releaseSlot(Shard& shard, size_t slotIndex) {
+    Slot& slot = shard.slots[slotIndex];
+    shard.index.erase(slot.key);
+    shard.bytes -= slot.bytes;
+    slot.entry = Entry{};
+    slot.bytes = 0;
+    slot.referenced = false;
+    slot.occupied = false;
+    shard.freeSlots.push_back(slotIndex);
+}
+
+void HotChunkCache::evictUntil(Shard& shard, size_t targetBytes) {
+    // CLOCK：指针扫过的条目若有引用位则清除并跳过，否则淘汰
+    // 每个条目最多被跳过一次，因此最多扫描两圈
+    while (shard.bytes > targetBytes && !shard.index.empty()) {
+        if (shard.hand >= shard.slots.size()) {
+            shard.hand = 0;
+        }
+        Slot& slot = shard.slots[shard.hand];
+        if (slot.occupied) {
+            if (slot.referenced) {
+                slot.referenced = false;
+            } else {
+                releaseSlot(shard, shard.hand);
+                evictions_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        ++shard.hand;
+    }
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
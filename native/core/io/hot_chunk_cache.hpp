@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "../memory_budget.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * HotChunkCache - 已解压区块负载的热缓存
+ *
+ * 玩家附近的区块会被反复加载，缓存解压后的NBT可以同时省去pread和inflate。
+ * 按字节预算限制内存，按键哈希分片（每片独立互斥锁和预算），片内使用CLOCK淘汰：
+ * 命中只设置引用位，不移动节点，读路径上没有链表操作。
+ *
+ * 负载以shared_ptr<const vector>共享，被淘汰的条目在最后一个读者释放后才回收。
+ * 读盘填充与保存可能并发：put/erase推进键的代数，读盘前取generation()，
+ * 填充时用putIfCurrent，期间被保存过的区块不会被读到的旧内容覆盖。
+ * 缓存字节数记到MemoryBudget的CHUNK_CACHE，超出子系统预算时由回收线程调用shed()。
+ */
+class HotChunkCache {
+public:
+    static constexpr size_t DEFAULT_BYTE_BUDGET = 64 * 1024 * 1024;
+    static constexpr size_t DEFAULT_SHARD_COUNT = 16;
+    static constexpr size_t ENTRY_OVERHEAD = 64;   // 每条目的簿记开销估算
+    static constexpr size_t GENERATION_SLOTS = 256; // 每片的代数槽，按键哈希共用
+
+    using Payload = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Entry {
+        Payload payload;            // 解压后的区块NBT
+        uint32_t lastModified{0};
+    };
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        uint64_t insertions{0};
+        uint64_t staleFills{0};     // putIfCurrent因代数变化丢弃的填充
+        size_t entries{0};
+        size_t bytes{0};
+        size_t byteBudget{0};
+    };
+
+    explicit HotChunkCache(size_t byteBudget = DEFAULT_BYTE_BUDGET,
+                           size_t shardCount = DEFAULT_SHARD_COUNT);
+
+    ~HotChunkCache();
+
+    HotChunkCache(const HotChunkCache&) = delete;
+    HotChunkCache& operator=(const HotChunkCache&) = delete;
+
+    /**
+     * 打包区块键：worldId低12位 | chunkX低26位 | chunkZ低26位
+     * 26位覆盖原版世界边界（±1875000区块）
+     */
+    static uint64_t packKey(int worldId, int chunkX, int chunkZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(worldId) & 0xFFF) << 52) |
+               ((static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) & 0x3FFFFFF) << 26) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(chunkZ)) & 0x3FFFFFF);
+    }
+
+    // 未命中时返回false
+    bool get(uint64_t key, Entry& entry);
+
+    // 只检查是否存在：不计入命中统计，也不设置CLOCK引用位
+    bool contains(uint64_t key);
+
+    // 插入或替换（保存路径），推进键的代数；超过单片预算1/8的负载不缓存
+    void put(uint64_t key, Payload payload, uint32_t lastModified);
+
+    // 键当前的代数；读盘之前取得，交给putIfCurrent
+    uint32_t generation(uint64_t key);
+
+    // 读盘填充：取得generation之后键被put/erase过时不插入，返回false
+    bool putIfCurrent(uint64_t key, Payload payload, uint32_t lastModified, uint32_t generation);
+
+    // 移除并推进键的代数
+    void erase(uint64_t key);
+    void clear();
+
+    // 调整预算，超出部分立即淘汰
+    void setByteBudget(size_t byteBudget);
+    size_t getByteBudget() const { return byteBudget_.load(std::memory_order_relaxed); }
+
+    // 按CLOCK从各片淘汰，直到释放约bytes字节（不改变预算），返回释放的字节数
+    size_t shed(size_t bytes);
+
+    Stats getStats() const;
+
+private:
+    struct Slot {
+        uint64_t key{0};
+        Entry entry;
+        size_t bytes{0};
+        bool referenced{false};
+        bool occupied{false};
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::vector<Slot> slots;
+        std::vector<size_t> freeSlots;
+        std::unordered_map<uint64_t, size_t> index;
+        size_t hand{0};
+        size_t bytes{0};
+        size_t budget{0};
+        std::array<uint32_t, GENERATION_SLOTS> generations{};
+    };
+
+    Shard& shardFor(uint64_t key);
+
+    // 以下函数要求持有shard.mutex
+    static uint32_t& generationSlot(Shard& shard, uint64_t key);
+    void insertLocked(Shard& shard, uint64_t key, Payload payload, uint32_t lastModified);
+    void releaseSlot(Shard& shard, size_t slotIndex);
+    void evictUntil(Shard& shard, size_t targetBytes);
+    void accountShard(Shard& shard, size_t bytesBefore);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<size_t> byteBudget_;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> insertions_{0};
+    std::atomic<uint64_t> staleFills_{0};
+
+    core::MemoryCharge memory_{core::MemorySubsystem::CHUNK_CACHE};
+    uint64_t shedderId_{0};
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
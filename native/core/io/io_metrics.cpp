@@ -0,0 +1,172 @@
+#include "io_metrics.hpp"
+#include "../metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace lattice {
+namespace io {
+
+// ===== LatencyHistogram =====
+
+size_t LatencyHistogram::bucketIndex(uint64_t micros) {
+    // [0, SUB_BUCKETS)线性；之后每个2的幂区间SUB_BUCKETS个子桶
+    if (micros < SUB_BUCKETS) {
+        return static_cast<size_t>(micros);
+    }
+    const size_t exponent = 63 - static_cast<size_t>(std::countl_zero(micros));   // >= SUB_BUCKET_BITS
+    if (exponent > MAX_EXPONENT) {
+        return BUCKET_COUNT - 1;
+    }
+    const size_t shift = exponent - SUB_BUCKET_BITS;
+    const size_t sub = static_cast<size_t>(micros >> shift) - SUB_BUCKETS;
+    return (shift + 1) * SUB_BUCKETS + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    const size_t shift = index / SUB_BUCKETS - 1;
+    const uint64_t sub = index % SUB_BUCKETS;
+    return ((SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t micros) {
+    buckets_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+
+    uint64_t current = max_.load(std::memory_order_relaxed);
+    while (micros > current &&
+           !max_.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double quantile) const {
+    // 以桶计数之和为准，避免与count_之间的并发差异
+    std::array<uint64_t, BUCKET_COUNT> snapshot;
+    uint64_t total = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        snapshot[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    quantile = std::clamp(quantile, 0.0, 1.0);
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        seen += snapshot[i];
+        if (seen >= rank) {
+            // 桶上界不超过实际最大值
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+const char* ioStageName(IOStage stage) {
+    switch (stage) {
+        case IOStage::QUEUE_WAIT:  return "queue_wait";
+        case IOStage::DISK_READ:   return "disk_read";
+        case IOStage::INFLATE:     return "inflate";
+        case IOStage::NBT_PARSE:   return "nbt_parse";
+        case IOStage::JNI_HANDOFF: return "jni_handoff";
+        default:                   return "unknown";
+    }
+}
+
+// ===== IOMetrics =====
+
+IOMetrics::Stats IOMetrics::stats_{};
+std::array<LatencyHistogram, IO_STAGE_COUNT> IOMetrics::stageHistograms_{};
+
+namespace {
+
+// 同时导出到统一指标注册表（core/metrics.hpp）；HDR直方图保留给百分位摘要
+core::Histogram& operationHistogram(const char* operation) {
+    return core::MetricsRegistry::instance().histogram(
+        "lattice_chunk_io_duration_seconds", "Chunk load/save latency from submit to completion",
+        core::Histogram::latencyBuckets(), {{"operation", operation}});
+}
+
+core::Histogram& stageHistogram(IOStage stage) {
+    static const auto histograms = [] {
+        std::array<core::Histogram*, IO_STAGE_COUNT> result{};
+        for (size_t i = 0; i < IO_STAGE_COUNT; ++i) {
+            result[i] = &core::MetricsRegistry::instance().histogram(
+                "lattice_chunk_load_stage_duration_seconds", "Chunk load latency by pipeline stage",
+                core::Histogram::latencyBuckets(), {{"stage", ioStageName(static_cast<IOStage>(i))}});
+        }
+        return result;
+    }();
+    return *histograms[static_cast<size_t>(stage)];
+}
+
+} // namespace
+
+void IOMetrics::recordLoadTime(uint64_t microseconds) {
+    static core::Histogram& loads = operationHistogram("load");
+    stats_.totalLoads++;
+    stats_.totalLoadTime += microseconds;
+    loads.observe(static_cast<double>(microseconds) * 1e-6);
+}
+
+void IOMetrics::recordSaveTime(uint64_t microseconds) {
+    static core::Histogram& saves = operationHistogram("save");
+    stats_.totalSaves++;
+    stats_.totalSaveTime += microseconds;
+    saves.observe(static_cast<double>(microseconds) * 1e-6);
+}
+
+void IOMetrics::recordBatchSize(size_t chunkCount) {
+    uint64_t current = stats_.maxBatchSize.load();
+    while (chunkCount > current) {
+        stats_.maxBatchSize.compare_exchange_weak(current, chunkCount);
+    }
+}
+
+const IOMetrics::Stats& IOMetrics::getStats() {
+    return stats_;
+}
+
+void IOMetrics::recordStage(IOStage stage, uint64_t microseconds) {
+    stageHistograms_[static_cast<size_t>(stage)].record(microseconds);
+    stageHistogram(stage).observe(static_cast<double>(microseconds) * 1e-6);
+}
+
+const LatencyHistogram& IOMetrics::getStageHistogram(IOStage stage) {
+    return stageHistograms_[static_cast<size_t>(stage)];
+}
+
+void IOMetrics::resetStageHistograms() {
+    for (auto& histogram : stageHistograms_) {
+        histogram.reset();
+    }
+}
+
+IOMetrics::StageSummary IOMetrics::summarizeStage(IOStage stage) {
+    const LatencyHistogram& histogram = getStageHistogram(stage);
+    StageSummary summary;
+    summary.count = histogram.count();
+    summary.p50 = histogram.percentile(0.50);
+    summary.p99 = histogram.percentile(0.99);
+    summary.p999 = histogram.percentile(0.999);
+    summary.max = histogram.max();
+    return summary;
+}
+
+} // namespace io
+} // namespace lattice
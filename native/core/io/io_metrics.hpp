@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lattice {
+namespace io {
+
+// ===== 延迟直方图 =====
+
+/**
+ * LatencyHistogram - 无锁HDR风格延迟直方图（微秒）
+ *
+ * 对数-线性分桶：每个2的幂区间再均分为SUB_BUCKETS个子桶，相对误差不超过1/SUB_BUCKETS，
+ * 覆盖1us到约2^40us。记录只做一次relaxed fetch_add，可在I/O完成线程上直接调用；
+ * 读取百分位时不加锁扫描，并发记录下得到的是近似快照。
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 5;
+    static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+    static constexpr size_t MAX_EXPONENT = 40;
+    static constexpr size_t BUCKET_COUNT = (MAX_EXPONENT - SUB_BUCKET_BITS + 2) * SUB_BUCKETS;
+
+    void record(uint64_t micros);
+    void reset();
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+    // quantile取值[0, 1]，返回所在桶的上界；没有样本时返回0
+    uint64_t percentile(double quantile) const;
+
+    static size_t bucketIndex(uint64_t micros);
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// 区块加载各阶段
+enum class IOStage : uint8_t {
+    QUEUE_WAIT = 0,     // 调度队列等待
+    DISK_READ,          // 读取压缩记录
+    INFLATE,            // 解压
+    NBT_PARSE,          // NBT解析
+    JNI_HANDOFF,        // 拷贝到Java数组
+    COUNT
+};
+
+constexpr size_t IO_STAGE_COUNT = static_cast<size_t>(IOStage::COUNT);
+
+const char* ioStageName(IOStage stage);
+
+// ===== 性能监控 =====
+
+class IOMetrics {
+public:
+    static void recordLoadTime(uint64_t microseconds);
+    static void recordSaveTime(uint64_t microseconds);
+    static void recordBatchSize(size_t chunkCount);
+
+    struct Stats {
+        std::atomic<uint64_t> totalLoads{0};
+        std::atomic<uint64_t> totalSaves{0};
+        std::atomic<uint64_t> totalLoadTime{0};
+        std::atomic<uint64_t> totalSaveTime{0};
+        std::atomic<uint64_t> maxBatchSize{0};
+    };
+
+    static const Stats& getStats();
+
+    // 分阶段延迟
+    static void recordStage(IOStage stage, uint64_t microseconds);
+    static const LatencyHistogram& getStageHistogram(IOStage stage);
+    static void resetStageHistograms();
+
+    struct StageSummary {
+        uint64_t count{0};
+        uint64_t p50{0};
+        uint64_t p99{0};
+        uint64_t p999{0};
+        uint64_t max{0};
+    };
+
+    static StageSummary summarizeStage(IOStage stage);
+
+private:
+    static Stats stats_;
+    static std::array<LatencyHistogram, IO_STAGE_COUNT> stageHistograms_;
+};
+
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,210 @@
+#include "io_scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+
+namespace lattice {
+namespace io {
+
+namespace {
+
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+} // namespace
+
+IORequestScheduler::IORequestScheduler()
+    : IORequestScheduler(Config{}) {
+}
+
+IORequestScheduler::IORequestScheduler(const Config& config)
+    : config_(config) {
+    config_.maxInFlight = std::max<size_t>(1, config_.maxInFlight);
+    config_.agingIntervalMicros = std::max<uint64_t>(1, config_.agingIntervalMicros);
+}
+
+IORequestId IORequestScheduler::submit(const IORequestOptions& options, Dispatch dispatch, Cancel cancel) {
+    IORequestId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+        const auto cls = static_cast<size_t>(options.priority);
+
+        Request request;
+        request.priority = options.priority;
+        request.enqueueMicros = nowMicros();
+        request.deadlineMicros = options.deadlineMicros;
+        request.sequence = nextSequence_++;
+        request.dispatch = std::move(dispatch);
+        request.cancel = std::move(cancel);
+        requests_.emplace(id, std::move(request));
+
+        queues_[cls].push_back(id);
+        if (options.deadlineMicros != 0) {
+            deadlines_.emplace(options.deadlineMicros, id);
+        }
+        stats_.submitted[cls]++;
+    }
+
+    drain();
+    return id;
+}
+
+bool IORequestScheduler::promote(IORequestId id, IOPriority priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = requests_.find(id);
+    if (it == requests_.end()) {
+        return false;
+    }
+    if (it->second.priority != priority) {
+        // 旧队列中的条目在出队时因优先级不符被跳过
+        it->second.priority = priority;
+        queues_[static_cast<size_t>(priority)].push_back(id);
+        stats_.promoted++;
+    }
+    return true;
+}
+
+bool IORequestScheduler::cancel(IORequestId id) {
+    Cancel callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = requests_.find(id);
+        if (it == requests_.end()) {
+            return false;
+        }
+        eraseDeadlineLocked(id, it->second.deadlineMicros);
+        callback = std::move(it->second.cancel);
+        requests_.erase(it);
+        stats_.cancelled++;
+    }
+    if (callback) {
+        callback();
+    }
+    return true;
+}
+
+void IORequestScheduler::complete() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inFlight_ > 0) {
+            inFlight_--;
+        }
+    }
+    drain();
+}
+
+void IORequestScheduler::setMaxInFlight(size_t maxInFlight) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_.maxInFlight = std::max<size_t>(1, maxInFlight);
+    }
+    drain();
+}
+
+IORequestScheduler::Stats IORequestScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.queued = requests_.size();
+    stats.inFlight = inFlight_;
+    return stats;
+}
+
+bool IORequestScheduler::takeNextLocked(uint64_t now, Request& out) {
+    IORequestId chosen = INVALID_IO_REQUEST;
+
+    // 1. 即将到期的请求
+    if (!deadlines_.empty() && deadlines_.begin()->first <= now + config_.deadlineSlackMicros) {
+        chosen = deadlines_.begin()->second;
+        deadlines_.erase(deadlines_.begin());
+    }
+
+    // 2. 每个队列的队首是该级别等待最久的请求，比较它们的有效优先级
+    if (chosen == INVALID_IO_REQUEST) {
+        uint64_t bestLevel = UINT64_MAX;
+        uint64_t bestSequence = UINT64_MAX;
+        for (size_t cls = 0; cls < IO_PRIORITY_COUNT; ++cls) {
+            auto& queue = queues_[cls];
+            while (!queue.empty()) {
+                auto it = requests_.find(queue.front());
+                if (it != requests_.end() && static_cast<size_t>(it->second.priority) == cls) {
+                    break;
+                }
+                queue.pop_front();   // 已取消或已改变优先级
+            }
+            if (queue.empty()) {
+                continue;
+            }
+
+            const Request& request = requests_.at(queue.front());
+            const uint64_t boost = (now - std::min(now, request.enqueueMicros)) / config_.agingIntervalMicros;
+            const uint64_t level = cls > boost ? cls - boost : 0;
+            if (level < bestLevel || (level == bestLevel && request.sequence < bestSequence)) {
+                bestLevel = level;
+                bestSequence = request.sequence;
+                chosen = queue.front();
+            }
+        }
+        if (chosen == INVALID_IO_REQUEST) {
+            return false;
+        }
+        auto& request = requests_.at(chosen);
+        queues_[static_cast<size_t>(request.priority)].pop_front();
+        eraseDeadlineLocked(chosen, request.deadlineMicros);
+    }
+
+    auto it = requests_.find(chosen);
+    out = std::move(it->second);
+    requests_.erase(it);
+
+    const auto cls = static_cast<size_t>(out.priority);
+    const uint64_t waited = now - std::min(now, out.enqueueMicros);
+    stats_.maxQueueWaitMicros[cls] = std::max(stats_.maxQueueWaitMicros[cls], waited);
+    if (out.deadlineMicros != 0 && now > out.deadlineMicros) {
+        stats_.deadlineMisses++;
+    }
+    stats_.dispatched++;
+    return true;
+}
+
+void IORequestScheduler::eraseDeadlineLocked(IORequestId id, uint64_t deadlineMicros) {
+    if (deadlineMicros == 0) {
+        return;
+    }
+    auto range = deadlines_.equal_range(deadlineMicros);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == id) {
+            deadlines_.erase(it);
+            return;
+        }
+    }
+}
+
+void IORequestScheduler::drain() {
+    // 同步后端在Dispatch内直接complete()，嵌套调用交给最外层循环，避免递归过深
+    thread_local const IORequestScheduler* draining = nullptr;
+    if (draining == this) {
+        return;
+    }
+    const IORequestScheduler* outer = draining;
+    draining = this;
+
+    while (true) {
+        Request request;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (inFlight_ >= config_.maxInFlight || !takeNextLocked(nowMicros(), request)) {
+                break;
+            }
+            inFlight_++;
+        }
+        request.dispatch();
+    }
+
+    draining = outer;
+}
+
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include "io_types.hpp"
+
+namespace lattice {
+namespace io {
+
+/**
+ * IORequestScheduler - 区块I/O请求的优先级调度
+ *
+ * 所有请求先进入按IOPriority划分的队列，同时在途的请求数不超过maxInFlight，
+ * 空出槽位时按以下顺序选择下一个请求：
+ * 1. 截止时间在deadlineSlackMicros以内的请求（最早截止优先）
+ * 2. 有效优先级最高的请求：每等待agingIntervalMicros，有效优先级提升一级，
+ *    后台任务不会被持续的玩家请求饿死
+ * 3. 同一有效优先级按提交顺序
+ *
+ * 排队中的请求可以调整优先级或取消；已派发的请求不受影响。
+ * Dispatch必须在I/O完成后调用complete()归还槽位（可以在Dispatch内同步调用）。
+ */
+class IORequestScheduler {
+public:
+    struct Config {
+        size_t maxInFlight = 8;
+        uint64_t agingIntervalMicros = 50000;     // 每50ms提升一级
+        uint64_t deadlineSlackMicros = 5000;      // 距截止5ms内视为紧急
+    };
+
+    struct Stats {
+        std::array<uint64_t, IO_PRIORITY_COUNT> submitted{};
+        std::array<uint64_t, IO_PRIORITY_COUNT> maxQueueWaitMicros{};
+        uint64_t dispatched{0};
+        uint64_t cancelled{0};
+        uint64_t promoted{0};
+        uint64_t deadlineMisses{0};      // 派发时已超过截止时间
+        size_t queued{0};
+        size_t inFlight{0};
+    };
+
+    using Dispatch = std::function<void()>;
+    using Cancel = std::function<void()>;
+
+    IORequestScheduler();
+    explicit IORequestScheduler(const Config& config);
+
+    IORequestScheduler(const IORequestScheduler&) = delete;
+    IORequestScheduler& operator=(const IORequestScheduler&) = delete;
+
+    // 有空闲槽位时可能在调用线程上直接派发
+    IORequestId submit(const IORequestOptions& options, Dispatch dispatch, Cancel cancel = nullptr);
+
+    // 调整排队中请求的优先级；请求已派发或不存在时返回false
+    bool promote(IORequestId id, IOPriority priority);
+
+    // 取消排队中的请求并调用其Cancel；请求已派发或不存在时返回false
+    bool cancel(IORequestId id);
+
+    // 在途请求完成，派发后续请求
+    void complete();
+
+    void setMaxInFlight(size_t maxInFlight);
+    Stats getStats() const;
+
+private:
+    struct Request {
+        IOPriority priority;
+        uint64_t enqueueMicros;
+        uint64_t deadlineMicros;
+        uint64_t sequence;
+        Dispatch dispatch;
+        Cancel cancel;
+    };
+
+    // 选出下一个请求并移出队列（调用者持有mutex_）；没有可派发请求时返回false
+    bool takeNextLocked(uint64_t now, Request& out);
+    void eraseDeadlineLocked(IORequestId id, uint64_t deadlineMicros);
+
+    void drain();
+
+    Config config_;
+    mutable std::mutex mutex_;
+    std::unordered_map<IORequestId, Request> requests_;
+    std::array<std::deque<IORequestId>, IO_PRIORITY_COUNT> queues_;   // 惰性删除：出队时校验
+    std::multimap<uint64_t, IORequestId> deadlines_;
+    IORequestId nextId_{1};
+    uint64_t nextSequence_{0};
+    size_t inFlight_{0};
+    Stats stats_;
+};
+
+} // namespace io
+} // namespace lattice
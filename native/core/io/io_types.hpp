@@ -21,6 +21,14 @@ struct ChunkData {
     size_t dataSize() const { return data.size(); }
 };
 
+// 区块一个段的光照（原版区块NBT sections[]中的SkyLight/BlockLight）
+// 各为2048字节的nibble数组，下标(y << 8) | (z << 4) | x，偶数格为低4位；段缺少该光照时为空
+struct ChunkLightSection {
+    int32_t sectionY = 0;
+    std::vector<uint8_t> skyLight;
+    std::vector<uint8_t> blockLight;
+};
+
 // I/O 操作类型
 enum class IOOperation {
     LOAD,
@@ -32,7 +40,28 @@ enum class IOOperation {
 // 存储格式类型
 enum class StorageFormat {
     LEGACY = 0,    // 传统格式（一区块一文件）
-    ANVIL = 1      // Anvil格式（32x32区块一文件）
+    ANVIL = 1,     // Anvil格式（32x32区块一文件）
+    LINEAR = 2     // 单文件整region格式（r.X.Z.linear，整region一个zstd帧，见LinearRegionFile）
+};
+
+// I/O请求优先级（数值越小越优先）
+enum class IOPriority : uint8_t {
+    PLAYER_BLOCKING = 0,   // 玩家正在等待（出生点、传送目标）
+    TICKING = 1,           // 正在tick的区块
+    PREFETCH = 2,          // 移动预测预取
+    BACKGROUND = 3         // 预生成、备份等后台任务
+};
+
+constexpr size_t IO_PRIORITY_COUNT = 4;
+
+// 调度器分配的请求ID，0表示无效
+using IORequestId = uint64_t;
+constexpr IORequestId INVALID_IO_REQUEST = 0;
+
+// 单个请求的调度选项
+struct IORequestOptions {
+    IOPriority priority = IOPriority::TICKING;
+    uint64_t deadlineMicros = 0;     // steady_clock微秒时间戳，0表示无截止时间
 };
 
 // 异步操作结果
@@ -45,10 +74,26 @@ struct AsyncIOResult {
     AsyncIOResult() : success(false), completionTime(0) {}
 };
 
+// 批处理与I/O队列配置（与world::BatchConfig字段对应）
+struct BatchConfig {
+    size_t maxBatchSize = 64;        // 单次io_uring_submit最多提交的请求数
+    size_t minBatchSize = 4;
+    uint32_t batchTimeoutMs = 100;
+    size_t ioQueueDepth = 256;       // 提交队列深度
+    int compressionLevel = 6;
+    size_t threadPoolSize = 0;       // 0表示自动检测
+    
+    // io_uring注册缓冲区模式（需要足够的RLIMIT_MEMLOCK，注册失败时自动关闭）
+    bool registeredBuffers = false;
+    size_t fixedBufferCount = 256;   // 注册缓冲区数量
+    size_t fixedBufferSize = 64 * 1024;
+};
+
 // 平台特性检测
 struct PlatformFeatures {
     bool io_uring = false;      // Linux io_uring
     bool direct_io = false;     // Direct I/O
+    bool registered_buffers = false; // io_uring注册缓冲区
     bool apfs = false;          // macOS APFS
     bool apple_silicon = false; // Apple Silicon
     bool iocp = false;          // Windows IOCP
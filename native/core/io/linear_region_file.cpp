@@ -0,0 +1,894 @@
+#include "linear_region_file.hpp"
+#include "anvil_format.hpp"
+#include "bulk_region_importer.hpp"
+#include "io_metrics.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#if defined(LATTICE_HAS_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+// 解压后大小上限：每个区块最多8MB，整个region受头部32位长度字段限制；载入时按头部的区块数计算
+constexpr uint64_t MAX_CHUNK_SIZE = 8 * 1024 * 1024;
+constexpr uint64_t MAX_UNCOMPRESSED_SIZE = std::min<uint64_t>(REGION_CHUNK_COUNT * MAX_CHUNK_SIZE, UINT32_MAX);
+constexpr size_t TABLE_SIZE = REGION_CHUNK_COUNT * LinearRegionFile::TABLE_ENTRY_SIZE;
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline void writeBigEndian32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+inline void writeBigEndian64(uint8_t* p, uint64_t value) {
+    writeBigEndian32(p, static_cast<uint32_t>(value >> 32));
+    writeBigEndian32(p + 4, static_cast<uint32_t>(value));
+}
+
+inline uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+bool writeFully(int fd, const uint8_t* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::write(fd, data + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool readFully(int fd, uint8_t* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::read(fd, data + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void syncDirectory(const std::filesystem::path& directory) {
+    int dirFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dirFd >= 0) {
+        ::fsync(dirFd);
+        ::close(dirFd);
+    }
+}
+
+uint64_t fileSize(const std::string& path) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    return ec ? 0 : static_cast<uint64_t>(size);
+}
+
+// 解析"r.X.Z<extension>"
+bool parseRegionFileName(const std::string& name, const char* extension, int& regionX, int& regionZ) {
+    const size_t extensionLength = std::strlen(extension);
+    if (name.size() <= 2 + extensionLength || name.compare(0, 2, "r.") != 0 ||
+        name.compare(name.size() - extensionLength, extensionLength, extension) != 0) {
+        return false;
+    }
+    const std::string coords = name.substr(2, name.size() - 2 - extensionLength);
+    const size_t dot = coords.find('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    try {
+        size_t usedX = 0, usedZ = 0;
+        regionX = std::stoi(coords.substr(0, dot), &usedX);
+        regionZ = std::stoi(coords.substr(dot + 1), &usedZ);
+        return usedX == dot && usedZ == coords.size() - dot - 1;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+} // namespace
+
+// ===== LinearRegionFile实现 =====
+
+bool LinearRegionFile::available() {
+#if defined(LATTICE_HAS_ZSTD)
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<LinearRegionFile> LinearRegionFile::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return nullptr;
+        }
+        throw std::runtime_error("Failed to open " + path + ": " + strerror(errno));
+    }
+
+    struct stat st;
+    std::vector<uint8_t> file;
+    bool readOk = ::fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(HEADER_SIZE + TRAILER_SIZE);
+    if (readOk) {
+        file.resize(static_cast<size_t>(st.st_size));
+        readOk = readFully(fd, file.data(), file.size());
+    }
+    const int savedErrno = errno;
+    ::close(fd);
+    if (!readOk) {
+        throw std::runtime_error("Failed to read linear region " + path + ": " +
+                                 (file.empty() ? "file too short" : strerror(savedErrno)));
+    }
+
+    const uint8_t* header = file.data();
+    if (std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 ||
+        std::memcmp(file.data() + file.size() - TRAILER_SIZE, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a linear region file: " + path);
+    }
+    if (header[8] != VERSION) {
+        throw std::runtime_error("Unsupported linear region version " + std::to_string(header[8]) + ": " + path);
+    }
+    const uint32_t chunkCount = readBigEndian32(header + 12);
+    const uint32_t uncompressedSize = readBigEndian32(header + 24);
+    const uint32_t compressedSize = readBigEndian32(header + 28);
+    // 分配解压缓冲区之前先校验声明的大小：不超过头部区块数能占用的上限，且与zstd帧记录的内容大小一致
+    if (HEADER_SIZE + static_cast<uint64_t>(compressedSize) + TRAILER_SIZE != file.size() ||
+        chunkCount > REGION_CHUNK_COUNT || uncompressedSize < TABLE_SIZE ||
+        uncompressedSize > TABLE_SIZE + static_cast<uint64_t>(chunkCount) * MAX_CHUNK_SIZE) {
+        throw std::runtime_error("Truncated or corrupt linear region: " + path);
+    }
+
+#if defined(LATTICE_HAS_ZSTD)
+    if (ZSTD_getFrameContentSize(file.data() + HEADER_SIZE, compressedSize) != uncompressedSize) {
+        throw std::runtime_error("Truncated or corrupt linear region: " + path);
+    }
+    std::vector<uint8_t> body(uncompressedSize);
+    ZSTD_DCtx* dctx = ZSTD_createDCtx();
+    if (!dctx) {
+        throw std::runtime_error("Failed to create zstd decompression context");
+    }
+    const size_t decoded = ZSTD_decompressDCtx(dctx, body.data(), body.size(), file.data() + HEADER_SIZE, compressedSize);
+    ZSTD_freeDCtx(dctx);
+    if (ZSTD_isError(decoded) || decoded != uncompressedSize) {
+        throw std::runtime_error("Failed to decompress linear region " + path + ": " +
+                                 (ZSTD_isError(decoded) ? ZSTD_getErrorName(decoded) : "size mismatch"));
+    }
+    file.clear();
+    file.shrink_to_fit();
+
+    auto region = std::make_unique<LinearRegionFile>();
+    const uint8_t* table = body.data();
+    const uint8_t* data = body.data() + TABLE_SIZE;
+    const size_t dataSize = body.size() - TABLE_SIZE;
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        const uint8_t* entry = table + index * TABLE_ENTRY_SIZE;
+        const uint32_t offset = readBigEndian32(entry);
+        const uint32_t size = readBigEndian32(entry + 4);
+        if (size == 0) continue;
+        if (static_cast<uint64_t>(offset) + size > dataSize) {
+            throw std::runtime_error("Linear region offset table out of range: " + path);
+        }
+        region->entries_[index].nbt = std::make_shared<const std::vector<uint8_t>>(data + offset, data + offset + size);
+        region->entries_[index].timestamp = readBigEndian32(entry + 8);
+        region->chunkCount_++;
+        region->payloadBytes_ += size;
+    }
+    if (region->chunkCount_ != chunkCount) {
+        throw std::runtime_error("Linear region chunk count mismatch: " + path);
+    }
+    return region;
+#else
+    throw std::runtime_error("zstd support is not compiled in");
+#endif
+}
+
+bool LinearRegionFile::hasChunk(int localX, int localZ) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return entries_[RegionFile::chunkIndex(localX, localZ)].nbt != nullptr;
+}
+
+std::shared_ptr<const std::vector<uint8_t>> LinearRegionFile::getChunk(int localX, int localZ,
+                                                                      uint32_t* timestamp) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Entry& entry = entries_[RegionFile::chunkIndex(localX, localZ)];
+    if (timestamp && entry.nbt) {
+        *timestamp = entry.timestamp;
+    }
+    return entry.nbt;
+}
+
+void LinearRegionFile::putChunk(int localX, int localZ, std::shared_ptr<const std::vector<uint8_t>> nbt,
+                                uint32_t timestamp) {
+    if (!nbt || nbt->empty()) {
+        removeChunk(localX, localZ);
+        return;
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Entry& entry = entries_[RegionFile::chunkIndex(localX, localZ)];
+    if (entry.nbt) {
+        payloadBytes_ -= entry.nbt->size();
+    } else {
+        chunkCount_++;
+    }
+    payloadBytes_ += nbt->size();
+    entry.nbt = std::move(nbt);
+    entry.timestamp = timestamp;
+    generation_++;
+}
+
+bool LinearRegionFile::removeChunk(int localX, int localZ) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Entry& entry = entries_[RegionFile::chunkIndex(localX, localZ)];
+    if (!entry.nbt) {
+        return false;
+    }
+    payloadBytes_ -= entry.nbt->size();
+    chunkCount_--;
+    entry = Entry{};
+    generation_++;
+    return true;
+}
+
+size_t LinearRegionFile::chunkCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return chunkCount_;
+}
+
+size_t LinearRegionFile::payloadBytes() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return payloadBytes_;
+}
+
+bool LinearRegionFile::isDirty() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return generation_ != savedGeneration_;
+}
+
+uint64_t LinearRegionFile::save(const std::string& path, int compressionLevel, bool syncFile) {
+    std::lock_guard<std::mutex> saveLock(saveMutex_);
+
+    // 只在拷贝快照期间持有锁，NBT由shared_ptr共享，压缩与写盘在锁外
+    std::array<Entry, REGION_CHUNK_COUNT> snapshot;
+    uint64_t generation = 0;
+    size_t payloadBytes = 0;
+    size_t chunkCount = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        snapshot = entries_;
+        generation = generation_;
+        payloadBytes = payloadBytes_;
+        chunkCount = chunkCount_;
+    }
+
+    auto markSaved = [&] {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        savedGeneration_ = generation;
+    };
+
+    if (chunkCount == 0) {
+        if (::unlink(path.c_str()) != 0 && errno != ENOENT) {
+            throw std::runtime_error("Failed to remove empty linear region " + path + ": " + strerror(errno));
+        }
+        markSaved();
+        return 0;
+    }
+    if (TABLE_SIZE + static_cast<uint64_t>(payloadBytes) > MAX_UNCOMPRESSED_SIZE) {
+        throw std::runtime_error("Linear region too large: " + path);
+    }
+
+#if defined(LATTICE_HAS_ZSTD)
+    // 偏移表 + 按区块索引顺序排列的NBT
+    std::vector<uint8_t> body(TABLE_SIZE + payloadBytes);
+    uint32_t offset = 0;
+    uint64_t newestTimestamp = 0;
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        const Entry& entry = snapshot[index];
+        if (!entry.nbt) continue;
+        uint8_t* tableEntry = body.data() + index * TABLE_ENTRY_SIZE;
+        writeBigEndian32(tableEntry, offset);
+        writeBigEndian32(tableEntry + 4, static_cast<uint32_t>(entry.nbt->size()));
+        writeBigEndian32(tableEntry + 8, entry.timestamp);
+        std::memcpy(body.data() + TABLE_SIZE + offset, entry.nbt->data(), entry.nbt->size());
+        offset += static_cast<uint32_t>(entry.nbt->size());
+        newestTimestamp = std::max<uint64_t>(newestTimestamp, entry.timestamp);
+    }
+
+    std::vector<uint8_t> image(HEADER_SIZE + ZSTD_compressBound(body.size()) + TRAILER_SIZE);
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    if (!cctx) {
+        throw std::runtime_error("Failed to create zstd compression context");
+    }
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, compressionLevel);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+    const size_t compressed = ZSTD_compress2(cctx, image.data() + HEADER_SIZE, image.size() - HEADER_SIZE - TRAILER_SIZE,
+                                             body.data(), body.size());
+    ZSTD_freeCCtx(cctx);
+    if (ZSTD_isError(compressed)) {
+        throw std::runtime_error(std::string("Failed to compress linear region: ") + ZSTD_getErrorName(compressed));
+    }
+    body.clear();
+    body.shrink_to_fit();
+
+    image.resize(HEADER_SIZE + compressed + TRAILER_SIZE);
+    std::memcpy(image.data(), MAGIC, sizeof(MAGIC));
+    image[8] = VERSION;
+    writeBigEndian32(image.data() + 12, static_cast<uint32_t>(chunkCount));
+    writeBigEndian64(image.data() + 16, newestTimestamp);
+    writeBigEndian32(image.data() + 24, static_cast<uint32_t>(TABLE_SIZE + payloadBytes));
+    writeBigEndian32(image.data() + 28, static_cast<uint32_t>(compressed));
+    std::memcpy(image.data() + image.size() - TRAILER_SIZE, MAGIC, sizeof(MAGIC));
+
+    // 一次顺序写入临时文件，再原子替换
+    const std::filesystem::path target(path);
+    const std::string tempPath = path + ".tmp";
+    try {
+        std::filesystem::create_directories(target.parent_path());
+        int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to create " + tempPath + ": " + strerror(errno));
+        }
+        const bool writeOk = writeFully(fd, image.data(), image.size()) && (!syncFile || ::fsync(fd) == 0);
+        const int savedErrno = errno;
+        ::close(fd);
+        if (!writeOk) {
+            throw std::runtime_error("Failed to write " + tempPath + ": " + strerror(savedErrno));
+        }
+        if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+            throw std::runtime_error("Failed to replace " + path + ": " + strerror(errno));
+        }
+        if (syncFile) {
+            syncDirectory(target.parent_path());
+        }
+    } catch (...) {
+        ::unlink(tempPath.c_str());
+        throw;
+    }
+
+    markSaved();
+    return image.size();
+#else
+    (void)compressionLevel; (void)syncFile;
+    throw std::runtime_error("zstd support is not compiled in");
+#endif
+}
+
+std::string LinearRegionFile::pathFor(const std::string& worldPath, int worldId, int regionX, int regionZ) {
+    std::string path = createAnvilFilePath(worldPath, worldId, regionX, regionZ);
+    return path.substr(0, path.size() - 4) + FILE_EXTENSION;
+}
+
+// ===== LinearChunkIO实现 =====
+
+LinearChunkIO::LinearChunkIO(const std::string& worldPath, size_t maxResidentRegions)
+    : worldPath_(worldPath), maxResidentRegions_(std::max<size_t>(1, maxResidentRegions)) {
+}
+
+LinearChunkIO::~LinearChunkIO() {
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        fprintf(stderr, "[Lattice] Failed to flush linear regions of %s: %s\n", worldPath_.c_str(), e.what());
+    }
+}
+
+uint64_t LinearChunkIO::regionKey(int worldId, int regionX, int regionZ) {
+    // 与BulkRegionImporter相同：worldId取低16位，region坐标各24位
+    return (static_cast<uint64_t>(static_cast<uint16_t>(worldId)) << 48) |
+           ((static_cast<uint64_t>(regionX) & 0xFFFFFF) << 24) |
+           (static_cast<uint64_t>(regionZ) & 0xFFFFFF);
+}
+
+std::shared_ptr<LinearRegionFile> LinearChunkIO::acquire(int worldId, int regionX, int regionZ, bool create) {
+    const uint64_t key = regionKey(worldId, regionX, regionZ);
+    const std::string path = LinearRegionFile::pathFor(worldPath_, worldId, regionX, regionZ);
+    for (;;) {
+        uint64_t epoch = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto region = findResidentLocked(key)) {
+                return region;
+            }
+            epoch = evictionEpoch_;
+        }
+
+        // 锁外读盘解压；并发载入同一region时保留先放入的那份（内容相同）
+        const auto readStart = std::chrono::steady_clock::now();
+        std::shared_ptr<LinearRegionFile> loaded = LinearRegionFile::load(path);
+        IOMetrics::recordStage(IOStage::DISK_READ, microsSince(readStart));
+
+        std::vector<Evicted> toSave;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (auto region = findResidentLocked(key)) {
+                return region;
+            }
+            if (evictionEpoch_ != epoch) {
+                // 读盘期间有脏region被摘下并可能已写完：读到的文件可能比它旧，重新载入
+                continue;
+            }
+            if (loaded) {
+                regionsLoaded_.fetch_add(1, std::memory_order_relaxed);
+            } else if (!create) {
+                return nullptr;
+            } else {
+                loaded = std::make_shared<LinearRegionFile>();
+            }
+            lru_.push_front(key);
+            residents_.emplace(key, Resident{loaded, path, lru_.begin()});
+            evictLocked(toSave);
+            updateResidentBytesLocked();
+        }
+        saveEvicted(toSave);
+        return loaded;
+    }
+}
+
+std::shared_ptr<LinearRegionFile> LinearChunkIO::findResidentLocked(uint64_t key) {
+    auto it = residents_.find(key);
+    if (it != residents_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return it->second.region;
+    }
+    // 正在写出的region：取回常驻，写出照常进行（save写的是快照，之后的修改保持脏状态）
+    auto evicted = evicting_.find(key);
+    if (evicted == evicting_.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<LinearRegionFile> region = evicted->second.region;
+    lru_.push_front(key);
+    residents_.emplace(key, Resident{region, std::move(evicted->second.path), lru_.begin()});
+    evicting_.erase(evicted);
+    updateResidentBytesLocked();
+    return region;
+}
+
+void LinearChunkIO::evictLocked(std::vector<Evicted>& toSave) {
+    // 从最久未用的开始；仍被其他线程持有的region跳过，保证淘汰后不会再有写入
+    auto it = lru_.end();
+    while (residents_.size() > maxResidentRegions_ && it != lru_.begin()) {
+        --it;
+        auto resident = residents_.find(*it);
+        if (resident->second.region.use_count() > 1) {
+            continue;
+        }
+        if (resident->second.region->isDirty()) {
+            // 写盘在锁外进行（saveEvicted），期间的访问从evicting_取回
+            Evicted evicted{*it, ++evictionEpoch_, resident->second.region, resident->second.path};
+            evicting_.insert_or_assign(evicted.key, evicted);
+            toSave.push_back(std::move(evicted));
+        }
+        residents_.erase(resident);
+        it = lru_.erase(it);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void LinearChunkIO::saveEvicted(std::vector<Evicted>& toSave) {
+    for (Evicted& evicted : toSave) {
+        bool saved = false;
+        try {
+            const uint64_t written = evicted.region->save(evicted.path, compressionLevel_.load(), syncOnSave_.load());
+            regionsWritten_.fetch_add(1, std::memory_order_relaxed);
+            bytesWritten_.fetch_add(written, std::memory_order_relaxed);
+            saved = true;
+        } catch (const std::exception& e) {
+            fprintf(stderr, "[Lattice] Failed to write evicted linear region %s: %s\n",
+                    evicted.path.c_str(), e.what());
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = evicting_.find(evicted.key);
+        if (it == evicting_.end() || it->second.epoch != evicted.epoch) {
+            // 写出期间已被取回常驻（可能又被再次摘下，由那次淘汰负责收尾）
+            continue;
+        }
+        if (!saved) {
+            // 写出失败时放回常驻（最久未用端），下次flush重试
+            lru_.push_back(evicted.key);
+            residents_.emplace(evicted.key, Resident{evicted.region, std::move(evicted.path), std::prev(lru_.end())});
+            updateResidentBytesLocked();
+        }
+        evicting_.erase(it);
+    }
+    toSave.clear();
+}
+
+void LinearChunkIO::updateResidentBytesLocked() {
+    size_t bytes = 0;
+    for (const auto& [key, resident] : residents_) {
+        bytes += resident.region->payloadBytes();
+    }
+    memory_.set(bytes);
+}
+
+void LinearChunkIO::loadChunkAsync(int worldId, int chunkX, int chunkZ, std::function<void(AsyncIOResult)> callback) {
+    AsyncIOResult result;
+    result.chunk.x = chunkX;
+    result.chunk.z = chunkZ;
+    result.chunk.worldId = worldId;
+
+    try {
+        uint32_t timestamp = 0;
+        auto nbt = loadChunk(worldId, chunkX, chunkZ, &timestamp);
+        if (!nbt) {
+            result.success = false;
+            result.errorMessage = "Chunk not found";
+        } else {
+            // 与AnvilChunkIO相同的NONE类型记录
+            result.success = true;
+            result.chunk.lastModified = timestamp;
+            result.chunk.data.reserve(nbt->size() + 1);
+            result.chunk.data.push_back(static_cast<char>(MinecraftCompressor::CompressionType::NONE));
+            result.chunk.data.insert(result.chunk.data.end(), nbt->begin(), nbt->end());
+        }
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.errorMessage = e.what();
+    }
+
+    callback(std::move(result));
+}
+
+void LinearChunkIO::saveChunkAsync(int worldId, int chunkX, int chunkZ, const std::vector<uint8_t>& data,
+                                   uint32_t timestamp, std::function<void(AsyncIOResult)> callback) {
+    AsyncIOResult result;
+    result.chunk.x = chunkX;
+    result.chunk.z = chunkZ;
+    result.chunk.worldId = worldId;
+    result.chunk.lastModified = timestamp;
+
+    try {
+        saveChunk(worldId, chunkX, chunkZ, data, timestamp);
+        result.success = true;
+    } catch (const std::exception& e) {
+        result.success = false;
+        result.errorMessage = e.what();
+    }
+
+    callback(std::move(result));
+}
+
+std::shared_ptr<const std::vector<uint8_t>> LinearChunkIO::loadChunk(int worldId, int chunkX, int chunkZ,
+                                                                    uint32_t* timestamp) {
+    if (!isValidChunkCoordinates(chunkX, chunkZ)) {
+        return nullptr;
+    }
+    auto region = acquire(worldId, chunkX >> 5, chunkZ >> 5, false);
+    if (!region) {
+        return nullptr;
+    }
+    loads_.fetch_add(1, std::memory_order_relaxed);
+    return region->getChunk(chunkX & 0x1F, chunkZ & 0x1F, timestamp);
+}
+
+void LinearChunkIO::saveChunk(int worldId, int chunkX, int chunkZ, const std::vector<uint8_t>& data,
+                              uint32_t timestamp) {
+    if (data.empty()) {
+        throw std::runtime_error("Empty chunk data");
+    }
+    if (!isValidChunkCoordinates(chunkX, chunkZ)) {
+        throw std::runtime_error("Invalid chunk coordinates");
+    }
+
+    // linear region整体压缩，区块内只存未压缩NBT
+    std::shared_ptr<const std::vector<uint8_t>> nbt;
+    if (data[0] == static_cast<uint8_t>(NBTType::COMPOUND)) {
+        nbt = std::make_shared<const std::vector<uint8_t>>(data);
+    } else {
+        auto decoded = MinecraftCompressor::decompressData(data, MinecraftCompressor::detectCompressionType(data));
+        if (decoded.empty() || decoded[0] != static_cast<uint8_t>(NBTType::COMPOUND)) {
+            throw std::runtime_error("Linear regions require uncompressed or dictionary-free chunk NBT");
+        }
+        nbt = std::make_shared<const std::vector<uint8_t>>(std::move(decoded));
+    }
+    if (nbt->size() > MAX_CHUNK_SIZE) {
+        throw std::runtime_error("Chunk NBT too large for a linear region");
+    }
+
+    auto region = acquire(worldId, chunkX >> 5, chunkZ >> 5, true);
+    region->putChunk(chunkX & 0x1F, chunkZ & 0x1F, std::move(nbt), timestamp);
+    saves_.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    updateResidentBytesLocked();
+}
+
+bool LinearChunkIO::removeChunk(int worldId, int chunkX, int chunkZ) {
+    auto region = acquire(worldId, chunkX >> 5, chunkZ >> 5, false);
+    if (!region || !region->removeChunk(chunkX & 0x1F, chunkZ & 0x1F)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    updateResidentBytesLocked();
+    return true;
+}
+
+size_t LinearChunkIO::flush() {
+    std::vector<std::pair<std::shared_ptr<LinearRegionFile>, std::string>> dirty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [key, resident] : residents_) {
+            if (resident.region->isDirty()) {
+                dirty.emplace_back(resident.region, resident.path);
+            }
+        }
+        // 正在淘汰写出的region也要在返回前落盘（save按region串行，重复写出无害）
+        for (const auto& [key, evicted] : evicting_) {
+            if (evicted.region->isDirty()) {
+                dirty.emplace_back(evicted.region, evicted.path);
+            }
+        }
+    }
+
+    // 在锁外写出，读写可以继续；写出期间的修改留到下次flush
+    size_t written = 0;
+    std::string firstError;
+    for (const auto& [region, path] : dirty) {
+        try {
+            const uint64_t bytes = region->save(path, compressionLevel_.load(), syncOnSave_.load());
+            regionsWritten_.fetch_add(1, std::memory_order_relaxed);
+            bytesWritten_.fetch_add(bytes, std::memory_order_relaxed);
+            written++;
+        } catch (const std::exception& e) {
+            if (firstError.empty()) {
+                firstError = e.what();
+            }
+        }
+    }
+    if (!firstError.empty()) {
+        throw std::runtime_error(firstError);
+    }
+    return written;
+}
+
+void LinearChunkIO::unloadRegion(int worldId, int regionX, int regionZ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = residents_.find(regionKey(worldId, regionX, regionZ));
+    if (it == residents_.end()) {
+        return;
+    }
+    if (it->second.region->isDirty()) {
+        const uint64_t bytes = it->second.region->save(it->second.path, compressionLevel_.load(), syncOnSave_.load());
+        regionsWritten_.fetch_add(1, std::memory_order_relaxed);
+        bytesWritten_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    lru_.erase(it->second.lruPos);
+    residents_.erase(it);
+    updateResidentBytesLocked();
+}
+
+void LinearChunkIO::setMaxResidentRegions(size_t maxResidentRegions) {
+    std::vector<Evicted> toSave;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxResidentRegions_ = std::max<size_t>(1, maxResidentRegions);
+        evictLocked(toSave);
+        updateResidentBytesLocked();
+    }
+    saveEvicted(toSave);
+}
+
+std::vector<LinearChunkIO::RegionFileEntry> LinearChunkIO::listRegions(int worldId, const char* extension) const {
+    namespace fs = std::filesystem;
+    std::vector<RegionFileEntry> regions;
+    const fs::path directory = fs::path(createAnvilFilePath(worldPath_, worldId, 0, 0)).parent_path();
+    std::error_code ec;
+    if (!fs::is_directory(directory, ec)) {
+        return regions;
+    }
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        int regionX = 0, regionZ = 0;
+        if (entry.is_regular_file(ec) &&
+            parseRegionFileName(entry.path().filename().string(), extension, regionX, regionZ)) {
+            regions.push_back(RegionFileEntry{regionX, regionZ, entry.path().string()});
+        }
+    }
+    std::sort(regions.begin(), regions.end(), [](const RegionFileEntry& a, const RegionFileEntry& b) {
+        return a.regionX != b.regionX ? a.regionX < b.regionX : a.regionZ < b.regionZ;
+    });
+    return regions;
+}
+
+LinearChunkIO::ConversionStats LinearChunkIO::convertFromAnvil(AnvilChunkIO& anvil, int worldId, bool removeSource) {
+    ConversionStats stats;
+    // 删除.mca之后不能再被日志重放重新创建
+    if (removeSource && anvil.isJournalEnabled() && !anvil.checkpointJournal()) {
+        throw std::runtime_error("Failed to checkpoint chunk journal before conversion");
+    }
+    auto recordError = [&stats](const std::string& message) {
+        if (stats.firstError.empty()) {
+            stats.firstError = message;
+        }
+    };
+
+    std::vector<uint8_t> record;
+    for (const RegionFileEntry& source : listRegions(worldId, ".mca")) {
+        RegionFile anvilRegion(source.path, false);
+        if (!anvilRegion.isOpen()) {
+            stats.failedRegions++;
+            recordError("Failed to open " + source.path);
+            continue;
+        }
+
+        LinearRegionFile converted;
+        uint64_t failed = 0;
+        for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+            const int localX = static_cast<int>(index % 32);
+            const int localZ = static_cast<int>(index / 32);
+            uint32_t timestamp = 0;
+            if (!anvilRegion.hasChunk(localX, localZ)) continue;
+            if (!anvilRegion.readChunk(localX, localZ, record, &timestamp) || (record[0] & 0x80)) {
+                // 损坏的记录或外部.mcc存储的超大区块
+                failed++;
+                continue;
+            }
+            // 与readChunkFromRegion相同：region压缩ID转换为类型字节后用本世界的字典解压
+            record[0] = static_cast<uint8_t>(MinecraftCompressor::fromRegionRecord(
+                record[0], record.data() + 1, record.size() - 1));
+            std::vector<uint8_t> nbt;
+            try {
+                nbt = anvil.decompressChunk(record);
+            } catch (const std::exception&) {
+                nbt.clear();
+            }
+            if (nbt.empty()) {
+                failed++;
+                continue;
+            }
+            converted.putChunk(localX, localZ, std::make_shared<const std::vector<uint8_t>>(std::move(nbt)), timestamp);
+        }
+        stats.failedChunks += failed;
+        if (failed > 0) {
+            recordError("Skipped " + std::to_string(failed) + " unreadable chunks in " + source.path);
+        }
+
+        const std::string target = LinearRegionFile::pathFor(worldPath_, worldId, source.regionX, source.regionZ);
+        try {
+            // 目标region的常驻副本已过时，写出前丢弃（不写回）
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = residents_.find(regionKey(worldId, source.regionX, source.regionZ));
+                if (it != residents_.end()) {
+                    lru_.erase(it->second.lruPos);
+                    residents_.erase(it);
+                    updateResidentBytesLocked();
+                }
+            }
+            stats.targetBytes += converted.save(target, compressionLevel_.load(), syncOnSave_.load());
+        } catch (const std::exception& e) {
+            stats.failedRegions++;
+            recordError(e.what());
+            continue;
+        }
+
+        stats.regions++;
+        stats.chunks += converted.chunkCount();
+        stats.sourceBytes += fileSize(source.path);
+        if (removeSource && failed == 0) {
+            anvil.forgetRegion(worldId, source.regionX, source.regionZ);
+            ::unlink(source.path.c_str());
+        }
+    }
+    return stats;
+}
+
+LinearChunkIO::ConversionStats LinearChunkIO::convertToAnvil(AnvilChunkIO& anvil, int worldId, bool removeSource) {
+    ConversionStats stats;
+    flush();
+
+    const std::vector<RegionFileEntry> sources = listRegions(worldId, LinearRegionFile::FILE_EXTENSION);
+    if (sources.empty()) {
+        return stats;
+    }
+
+    // 整region写出：目标.mca被替换，不保留其中的旧区块
+    BulkRegionImporter::Config config;
+    config.preserveExisting = false;
+    config.syncFiles = syncOnSave_.load();
+    auto importer = anvil.beginBulkImport(config);
+
+    std::vector<bool> converted(sources.size(), false);
+    for (size_t i = 0; i < sources.size(); ++i) {
+        const RegionFileEntry& source = sources[i];
+        std::shared_ptr<LinearRegionFile> region;
+        try {
+            region = acquire(worldId, source.regionX, source.regionZ, false);
+        } catch (const std::exception& e) {
+            stats.failedRegions++;
+            if (stats.firstError.empty()) {
+                stats.firstError = e.what();
+            }
+            continue;
+        }
+        if (!region) continue;
+
+        for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+            const int localX = static_cast<int>(index % 32);
+            const int localZ = static_cast<int>(index / 32);
+            uint32_t timestamp = 0;
+            auto nbt = region->getChunk(localX, localZ, &timestamp);
+            if (!nbt) continue;
+            auto chunk = std::make_shared<AnvilChunkData>(source.regionX * 32 + localX, source.regionZ * 32 + localZ,
+                                                          worldId);
+            chunk->lastModified = timestamp;
+            chunk->data = *nbt;
+            importer->add(std::move(chunk));
+        }
+        stats.sourceBytes += fileSize(source.path);
+        converted[i] = true;
+    }
+
+    const BulkRegionImporter::Stats imported = importer->finish();
+    stats.regions += imported.regionsWritten;
+    stats.chunks += imported.chunksWritten;
+    stats.failedChunks += imported.failedChunks;
+    stats.failedRegions += imported.failedRegions;
+    stats.targetBytes += imported.bytesWritten;
+    if (stats.firstError.empty()) {
+        stats.firstError = imported.firstError;
+    }
+
+    // 导入器只报告总数，全部成功时才删除源文件
+    if (removeSource && imported.failedChunks == 0 && imported.failedRegions == 0) {
+        for (size_t i = 0; i < sources.size(); ++i) {
+            if (!converted[i]) continue;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = residents_.find(regionKey(worldId, sources[i].regionX, sources[i].regionZ));
+                if (it != residents_.end()) {
+                    lru_.erase(it->second.lruPos);
+                    residents_.erase(it);
+                }
+                updateResidentBytesLocked();
+            }
+            ::unlink(sources[i].path.c_str());
+        }
+    }
+    return stats;
+}
+
+LinearChunkIO::Stats LinearChunkIO::getStats() const {
+    Stats stats;
+    stats.loads = loads_.load(std::memory_order_relaxed);
+    stats.saves = saves_.load(std::memory_order_relaxed);
+    stats.regionsLoaded = regionsLoaded_.load(std::memory_order_relaxed);
+    stats.regionsWritten = regionsWritten_.load(std::memory_order_relaxed);
+    stats.bytesWritten = bytesWritten_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.residentRegions = residents_.size();
+    stats.residentBytes = memory_.bytes();
+    return stats;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,250 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../memory_budget.hpp"
+#include "io_types.hpp"
+#include "region_file.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+class AnvilChunkIO;
+
+/**
+ * LinearRegionFile - 单文件整region格式（r.X.Z.linear，StorageFormat::LINEAR）
+ *
+ * 整个region的区块NBT连续存放，作为一个zstd帧压缩（跨区块共享重复的标签名和调色板，
+ * 文件明显小于逐区块压缩的.mca），没有扇区和空洞。文件布局（大端）：
+ *
+ *   头部32字节：魔数"LTLINEAR" | 版本u8 | 保留3字节 | 区块数u32 | 最新时间戳u64 |
+ *              解压后大小u32 | 压缩后大小u32
+ *   zstd帧（带内容校验）：解压后为偏移表1024 x {偏移u32, 大小u32, 时间戳u32}（偏移相对于表之后的数据区），
+ *              随后按区块索引顺序排列的未压缩NBT
+ *   尾部8字节：魔数
+ *
+ * 读取时整个文件一次读入并解压，之后区块读写都在内存中；save()写临时文件、fsync后rename原子替换，
+ * 任何时刻磁盘上都是完整的旧文件或新文件。
+ * 区块读写持有共享/独占锁，可与save()并发：save写出的是开始时的快照，期间的修改仍保持脏状态。
+ *
+ * 需要zstd（LATTICE_HAS_ZSTD）；未编译zstd支持时load/save抛出std::runtime_error，available()返回false。
+ */
+class LinearRegionFile {
+public:
+    static constexpr char MAGIC[8] = {'L', 'T', 'L', 'I', 'N', 'E', 'A', 'R'};
+    static constexpr uint8_t VERSION = 1;
+    static constexpr size_t HEADER_SIZE = 32;
+    static constexpr size_t TRAILER_SIZE = 8;
+    static constexpr size_t TABLE_ENTRY_SIZE = 12;
+    static constexpr int DEFAULT_COMPRESSION_LEVEL = 6;
+    static constexpr const char* FILE_EXTENSION = ".linear";
+
+    // 空region
+    LinearRegionFile() = default;
+
+    LinearRegionFile(const LinearRegionFile&) = delete;
+    LinearRegionFile& operator=(const LinearRegionFile&) = delete;
+
+    static bool available();
+
+    /**
+     * 读取并解压整个文件；文件不存在时返回nullptr
+     * 魔数、版本、长度或zstd校验不符时抛出std::runtime_error
+     */
+    static std::unique_ptr<LinearRegionFile> load(const std::string& path);
+
+    bool hasChunk(int localX, int localZ) const;
+
+    // 区块的未压缩NBT；不存在时返回nullptr
+    std::shared_ptr<const std::vector<uint8_t>> getChunk(int localX, int localZ, uint32_t* timestamp = nullptr) const;
+
+    void putChunk(int localX, int localZ, std::shared_ptr<const std::vector<uint8_t>> nbt, uint32_t timestamp);
+    bool removeChunk(int localX, int localZ);
+
+    size_t chunkCount() const;
+    // 所有区块NBT的字节数（解压后的内存占用）
+    size_t payloadBytes() const;
+    // 自上次load/save以来有修改
+    bool isDirty() const;
+
+    /**
+     * 压缩整个region并原子替换path：写入path.tmp，syncFile时fsync文件与目录，然后rename
+     * region为空时删除path。返回写出的文件字节数；失败时删除临时文件并抛出std::runtime_error
+     */
+    uint64_t save(const std::string& path, int compressionLevel = DEFAULT_COMPRESSION_LEVEL, bool syncFile = true);
+
+    // 与createAnvilFilePath相同的目录，扩展名为.linear
+    static std::string pathFor(const std::string& worldPath, int worldId, int regionX, int regionZ);
+
+private:
+    struct Entry {
+        std::shared_ptr<const std::vector<uint8_t>> nbt;
+        uint32_t timestamp{0};
+    };
+
+    mutable std::shared_mutex mutex_;
+    std::array<Entry, REGION_CHUNK_COUNT> entries_{};
+    size_t chunkCount_{0};
+    size_t payloadBytes_{0};
+    uint64_t generation_{0};        // 每次修改递增
+    uint64_t savedGeneration_{0};   // 最近一次load/save对应的generation
+
+    // 同一region的save串行（共用临时文件）
+    std::mutex saveMutex_;
+};
+
+/**
+ * LinearChunkIO - 一个世界的linear格式区块读写
+ *
+ * 第一次访问某个region时整体载入并常驻内存（出生点等固定区域的区块一次读盘即可全部命中），
+ * 保存只修改内存中的region，由flush()（自动保存/关服时调用）整region写出。
+ * 常驻region超过maxResidentRegions时淘汰最久未用、且没有其他使用者的region，脏region淘汰前先写出：
+ * 在锁内摘下、锁外写盘，写盘期间再次访问该region会直接取回它，不会从磁盘读到旧内容。
+ * 常驻的区块NBT记入MemoryBudget的CHUNK_CACHE。析构时写出所有脏region。
+ *
+ * 注意：两次flush()之间的修改只在内存中，进程崩溃会丢失；需要逐次落盘的世界应使用Anvil格式。
+ */
+class LinearChunkIO {
+public:
+    static constexpr size_t DEFAULT_MAX_RESIDENT_REGIONS = 16;
+
+    explicit LinearChunkIO(const std::string& worldPath, size_t maxResidentRegions = DEFAULT_MAX_RESIDENT_REGIONS);
+    ~LinearChunkIO();
+
+    LinearChunkIO(const LinearChunkIO&) = delete;
+    LinearChunkIO& operator=(const LinearChunkIO&) = delete;
+
+    // 与AnvilChunkIO::loadChunkAsync相同：成功时数据为NONE类型记录（类型字节0 + NBT）
+    void loadChunkAsync(int worldId, int chunkX, int chunkZ, std::function<void(AsyncIOResult)> callback);
+    void saveChunkAsync(int worldId, int chunkX, int chunkZ, const std::vector<uint8_t>& data, uint32_t timestamp,
+                        std::function<void(AsyncIOResult)> callback);
+
+    // 区块的未压缩NBT；不存在时返回nullptr，region文件损坏时抛出std::runtime_error
+    std::shared_ptr<const std::vector<uint8_t>> loadChunk(int worldId, int chunkX, int chunkZ, uint32_t* timestamp = nullptr);
+
+    /**
+     * 保存区块：data为未压缩NBT（COMPOUND开头）或MinecraftCompressor记录（类型字节 + 负载，不能依赖zstd字典）
+     * 只修改常驻的region，flush()时写盘；数据无效时抛出std::runtime_error
+     */
+    void saveChunk(int worldId, int chunkX, int chunkZ, const std::vector<uint8_t>& data, uint32_t timestamp);
+    bool removeChunk(int worldId, int chunkX, int chunkZ);
+
+    // 写出所有脏region，返回写出的region数；某个region失败时继续写其余的，最后抛出第一个错误
+    size_t flush();
+
+    // 写出（如有修改）并移出常驻
+    void unloadRegion(int worldId, int regionX, int regionZ);
+
+    void setMaxResidentRegions(size_t maxResidentRegions);
+    void setCompressionLevel(int level) { compressionLevel_.store(level); }
+    void setSyncOnSave(bool enabled) { syncOnSave_.store(enabled); }
+
+    /**
+     * 格式转换。格式迁移在世界未被其他路径读写时进行
+     *
+     * convertFromAnvil：读取worldId维度下所有.mca，用anvil的字典解压后写出对应的.linear，
+     * 已存在的.linear被替换（先丢弃其常驻副本）。removeSource时删除转换成功的.mca
+     * convertToAnvil：先flush，再把所有.linear经anvil的批量导入（其压缩类型与字典）写成.mca，
+     * 目标.mca被整体替换。removeSource时在没有任何失败的情况下删除所有.linear
+     * 单个区块失败只跳过该区块（计入failedChunks），对应的源文件保留；
+     * removeSource且启用预写日志时先做检查点，失败时抛出std::runtime_error
+     */
+    struct ConversionStats {
+        uint64_t regions{0};
+        uint64_t chunks{0};
+        uint64_t failedChunks{0};
+        uint64_t failedRegions{0};
+        uint64_t sourceBytes{0};
+        uint64_t targetBytes{0};
+        std::string firstError;
+    };
+
+    ConversionStats convertFromAnvil(AnvilChunkIO& anvil, int worldId, bool removeSource);
+    ConversionStats convertToAnvil(AnvilChunkIO& anvil, int worldId, bool removeSource);
+
+    struct Stats {
+        uint64_t loads{0};
+        uint64_t saves{0};
+        uint64_t regionsLoaded{0};       // 从磁盘载入的region数
+        uint64_t regionsWritten{0};
+        uint64_t bytesWritten{0};
+        uint64_t evictions{0};
+        size_t residentRegions{0};
+        size_t residentBytes{0};
+    };
+
+    Stats getStats() const;
+
+    const std::string& getWorldPath() const { return worldPath_; }
+
+private:
+    using LruList = std::list<uint64_t>;
+
+    struct Resident {
+        std::shared_ptr<LinearRegionFile> region;
+        std::string path;
+        LruList::iterator lruPos;
+    };
+
+    // 已摘下、等待在锁外写出的脏region
+    struct Evicted {
+        uint64_t key;
+        uint64_t epoch;     // 摘下时的evictionEpoch_，区分同一region先后几次淘汰
+        std::shared_ptr<LinearRegionFile> region;
+        std::string path;
+    };
+
+    static uint64_t regionKey(int worldId, int regionX, int regionZ);
+
+    // 常驻region；不存在且create为false时返回nullptr。载入在锁外进行
+    std::shared_ptr<LinearRegionFile> acquire(int worldId, int regionX, int regionZ, bool create);
+    // 调用者持有mutex_；常驻（或正在写出、随即取回常驻）的region，并移到LRU头部
+    std::shared_ptr<LinearRegionFile> findResidentLocked(uint64_t key);
+    // 调用者持有mutex_；干净的region直接移出，脏region移入evicting_并追加到toSave
+    void evictLocked(std::vector<Evicted>& toSave);
+    // 不持有mutex_：写出evictLocked摘下的region；失败的放回常驻，下次flush重试
+    void saveEvicted(std::vector<Evicted>& toSave);
+    // 调用者持有mutex_；重新统计常驻字节数
+    void updateResidentBytesLocked();
+    // region目录下所有指定扩展名的文件，返回{regionX, regionZ, path}
+    struct RegionFileEntry {
+        int regionX;
+        int regionZ;
+        std::string path;
+    };
+    std::vector<RegionFileEntry> listRegions(int worldId, const char* extension) const;
+
+    std::string worldPath_;
+    std::atomic<int> compressionLevel_{LinearRegionFile::DEFAULT_COMPRESSION_LEVEL};
+    std::atomic<bool> syncOnSave_{true};
+
+    mutable std::mutex mutex_;
+    size_t maxResidentRegions_;
+    LruList lru_;                                   // 头部 = 最近使用
+    std::unordered_map<uint64_t, Resident> residents_;
+    std::unordered_map<uint64_t, Evicted> evicting_;   // 正在锁外写出的region
+    uint64_t evictionEpoch_{0};                     // 每摘下一个脏region加一，acquire据此丢弃可能读到旧文件的载入
+    core::MemoryCharge memory_{core::MemorySubsystem::CHUNK_CACHE};
+
+    std::atomic<uint64_t> loads_{0};
+    std::atomic<uint64_t> saves_{0};
+    std::atomic<uint64_t> regionsLoaded_{0};
+    std::atomic<uint64_t> regionsWritten_{0};
+    std::atomic<uint64_t> bytesWritten_{0};
+    std::atomic<uint64_t> evictions_{0};
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,192 @@
+#include "mapped_region_file.hpp"
+#include <unistd.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) |
+           static_cast<uint32_t>(p[3]);
+}
+
+constexpr size_t HEADER_BYTES = REGION_HEADER_SECTORS * REGION_SECTOR_SIZE;
+
+} // namespace
+
+// ===== MappedRegionFile实现 =====
+
+MappedRegionFile::MappedRegionFile(const std::string& path)
+    : path_(path),
+      mapping_(path, 0, true),
+      base_(static_cast<const uint8_t*>(mapping_.data())) {
+    if (mapping_.size() < HEADER_BYTES) {
+        throw std::runtime_error("Region file header truncated: " + path);
+    }
+
+    // 位置表查找后的访问是随机的，关闭内核的顺序预读
+    mapping_.adviseRandomAccess();
+
+    for (size_t i = 0; i < REGION_CHUNK_COUNT; ++i) {
+        locations_[i] = readBigEndian32(base_ + i * 4);
+        timestamps_[i] = readBigEndian32(base_ + REGION_SECTOR_SIZE + i * 4);
+    }
+}
+
+bool MappedRegionFile::sectorSpan(size_t index, size_t& offset, size_t& length) const {
+    const uint32_t location = locations_[index];
+    const uint32_t sector = RegionFile::sectorOffset(location);
+    const uint32_t count = RegionFile::sectorCount(location);
+    if (location == 0 || sector < REGION_HEADER_SECTORS || count == 0) {
+        return false;
+    }
+
+    offset = static_cast<size_t>(sector) * REGION_SECTOR_SIZE;
+    if (offset >= mapping_.size()) {
+        return false;
+    }
+    // 末尾扇区可能未被填满
+    length = std::min(static_cast<size_t>(count) * REGION_SECTOR_SIZE, mapping_.size() - offset);
+    return true;
+}
+
+bool MappedRegionFile::locateChunk(int localX, int localZ, uint8_t& compressionId,
+                                   const uint8_t*& payload, size_t& payloadSize, uint32_t* timestamp) const {
+    const size_t index = RegionFile::chunkIndex(localX, localZ);
+    size_t offset = 0;
+    size_t span = 0;
+    if (!sectorSpan(index, offset, span) || span < REGION_CHUNK_HEADER_SIZE) {
+        return false;
+    }
+
+    // 长度字段包含压缩类型字节
+    const uint8_t* record = base_ + offset;
+    const uint32_t length = readBigEndian32(record);
+    if (length == 0 || static_cast<size_t>(length) + 4 > span) {
+        return false;
+    }
+
+    compressionId = record[4];
+    payload = record + REGION_CHUNK_HEADER_SIZE;
+    payloadSize = length - 1;
+    if (timestamp) {
+        *timestamp = timestamps_[index];
+    }
+    return true;
+}
+
+bool MappedRegionFile::hasChunk(int localX, int localZ) const {
+    size_t offset = 0;
+    size_t span = 0;
+    return sectorSpan(RegionFile::chunkIndex(localX, localZ), offset, span);
+}
+
+uint32_t MappedRegionFile::getTimestamp(int localX, int localZ) const {
+    return timestamps_[RegionFile::chunkIndex(localX, localZ)];
+}
+
+void MappedRegionFile::prefetchChunk(int localX, int localZ) const {
+    size_t offset = 0;
+    size_t span = 0;
+    if (sectorSpan(RegionFile::chunkIndex(localX, localZ), offset, span)) {
+        mapping_.prefetchRange(offset, span);
+    }
+}
+
+// ===== MappedRegionCache实现 =====
+
+MappedRegionCache::MappedRegionCache(size_t maxMappedRegions)
+    : maxMappedRegions_(maxMappedRegions > 0 ? maxMappedRegions : 1) {
+}
+
+std::shared_ptr<MappedRegionFile> MappedRegionCache::acquire(const std::string& path) {
+    {
+        std::lock_guard lock(mutex_);
+        auto it = entries_.find(path);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+            stats_.hits++;
+            return it->second.region;
+        }
+        stats_.misses++;
+    }
+
+    // 在锁外建立映射
+    if (::access(path.c_str(), F_OK) != 0) {
+        return nullptr;
+    }
+
+    std::shared_ptr<MappedRegionFile> region;
+    try {
+        region = std::make_shared<MappedRegionFile>(path);
+    } catch (const std::exception&) {
+        return nullptr;
+    }
+
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+        // 其他线程已抢先映射
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return it->second.region;
+    }
+
+    lru_.push_front(path);
+    entries_.emplace(path, Entry{region, lru_.begin()});
+    stats_.mappedBytes += region->mappedBytes();
+    evictIfNeeded();
+    return region;
+}
+
+void MappedRegionCache::invalidate(const std::string& path) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+        stats_.mappedBytes -= it->second.region->mappedBytes();
+        lru_.erase(it->second.lruPos);
+        entries_.erase(it);
+    }
+}
+
+void MappedRegionCache::clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    stats_.mappedBytes = 0;
+}
+
+void MappedRegionCache::setMaxMappedRegions(size_t maxMappedRegions) {
+    std::lock_guard lock(mutex_);
+    maxMappedRegions_ = maxMappedRegions > 0 ? maxMappedRegions : 1;
+    evictIfNeeded();
+}
+
+MappedRegionCache::CacheStats MappedRegionCache::getStats() const {
+    std::lock_guard lock(mutex_);
+    CacheStats stats = stats_;
+    stats.mappedRegions = entries_.size();
+    return stats;
+}
+
+void MappedRegionCache::evictIfNeeded() {
+    // 调用者持有mutex_
+    while (entries_.size() > maxMappedRegions_ && !lru_.empty()) {
+        auto it = entries_.find(lru_.back());
+        if (it != entries_.end()) {
+            stats_.mappedBytes -= it->second.region->mappedBytes();
+            entries_.erase(it);
+        }
+        lru_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
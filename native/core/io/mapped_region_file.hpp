@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "memory_mapped_region.hpp"
+#include "region_file.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * MappedRegionFile - 只读映射的.mca文件
+ *
+ * 整个文件映射到内存，位置表在打开时解析；locateChunk直接返回映射内的压缩负载，
+ * 解压器从映射页读取，不经过pread和中间缓冲区。
+ * 仅用于不可变世界（例如小游戏地图）：映射期间文件被其他进程改写或截断时结果未定义。
+ */
+class MappedRegionFile {
+public:
+    // 文件不存在、为空或头部不完整时抛出std::runtime_error
+    explicit MappedRegionFile(const std::string& path);
+
+    MappedRegionFile(const MappedRegionFile&) = delete;
+    MappedRegionFile& operator=(const MappedRegionFile&) = delete;
+
+    /**
+     * 定位区块记录
+     * compressionId为region压缩方案ID（含0x80外部存储标志），payload指向映射内的压缩数据，
+     * 在本对象销毁前有效。区块不存在或记录越界时返回false
+     */
+    bool locateChunk(int localX, int localZ, uint8_t& compressionId,
+                     const uint8_t*& payload, size_t& payloadSize, uint32_t* timestamp = nullptr) const;
+
+    bool hasChunk(int localX, int localZ) const;
+    uint32_t getTimestamp(int localX, int localZ) const;
+
+    // 对区块占用的扇区发出madvise(WILLNEED)
+    void prefetchChunk(int localX, int localZ) const;
+
+    const std::string& path() const { return path_; }
+    size_t mappedBytes() const { return mapping_.size(); }
+
+private:
+    // 记录所在扇区跨度，越界时返回false
+    bool sectorSpan(size_t index, size_t& offset, size_t& length) const;
+
+    std::string path_;
+    MemoryMappedRegion mapping_;
+    const uint8_t* base_;
+    std::array<uint32_t, REGION_CHUNK_COUNT> locations_{};
+    std::array<uint32_t, REGION_CHUNK_COUNT> timestamps_{};
+};
+
+/**
+ * MappedRegionCache - 已映射region的LRU缓存
+ *
+ * 与RegionFileCache相同的淘汰策略；被淘汰的映射在最后一个持有者释放后才解除，
+ * 正在解压的读取不受影响。
+ */
+class MappedRegionCache {
+public:
+    static constexpr size_t DEFAULT_MAX_MAPPED_REGIONS = 256;
+
+    explicit MappedRegionCache(size_t maxMappedRegions = DEFAULT_MAX_MAPPED_REGIONS);
+
+    // 文件不存在或无法映射时返回nullptr
+    std::shared_ptr<MappedRegionFile> acquire(const std::string& path);
+
+    void invalidate(const std::string& path);
+    void clear();
+
+    void setMaxMappedRegions(size_t maxMappedRegions);
+
+    struct CacheStats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t mappedRegions{0};
+        size_t mappedBytes{0};
+    };
+
+    CacheStats getStats() const;
+
+private:
+    using LruList = std::list<std::string>;
+
+    struct Entry {
+        std::shared_ptr<MappedRegionFile> region;
+        LruList::iterator lruPos;
+    };
+
+    size_t maxMappedRegions_;
+    mutable std::mutex mutex_;
+    LruList lru_;                                   // 头部 = 最近使用
+    std::unordered_map<std::string, Entry> entries_;
+    CacheStats stats_;
+
+    void evictIfNeeded();
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,115 @@
+#include "memory_mapped_region.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace lattice {
+namespace io {
+
+// ===== POSIX实现 =====
+
+class MemoryMappedRegion::PlatformImpl {
+public:
+    PlatformImpl(const std::string& filePath, size_t size, bool readOnly)
+        : fd_(-1), address_(nullptr), size_(size) {
+
+        // 只读模式不创建文件
+        fd_ = readOnly ? ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC)
+                       : ::open(filePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ == -1) {
+            throw std::runtime_error("Failed to open file: " + std::string(strerror(errno)));
+        }
+
+        if (readOnly && size_ == 0) {
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0) {
+                ::close(fd_);
+                throw std::runtime_error("Failed to stat file: " + std::string(strerror(errno)));
+            }
+            size_ = static_cast<size_t>(st.st_size);
+        }
+
+        // 确保文件大小
+        if (!readOnly && ::ftruncate(fd_, static_cast<off_t>(size_)) == -1) {
+            ::close(fd_);
+            throw std::runtime_error("Failed to truncate file: " + std::string(strerror(errno)));
+        }
+
+        // mmap不接受长度0
+        if (size_ == 0) {
+            ::close(fd_);
+            throw std::runtime_error("Cannot map empty file");
+        }
+
+        int prot = readOnly ? PROT_READ : (PROT_READ | PROT_WRITE);
+        address_ = ::mmap(nullptr, size_, prot, MAP_SHARED, fd_, 0);
+        if (address_ == MAP_FAILED) {
+            address_ = nullptr;
+            ::close(fd_);
+            throw std::runtime_error("mmap failed: " + std::string(strerror(errno)));
+        }
+
+        // 映射建立后不再需要文件描述符
+        ::close(fd_);
+        fd_ = -1;
+    }
+
+    ~PlatformImpl() {
+        if (address_) ::munmap(address_, size_);
+        if (fd_ != -1) ::close(fd_);
+    }
+
+    void* data() const { return address_; }
+    size_t size() const { return size_; }
+
+    void advise(size_t offset, size_t length, int advice) const {
+        if (offset >= size_ || length == 0) {
+            return;
+        }
+        length = std::min(length, size_ - offset);
+
+        // madvise要求起始地址按页对齐
+        static const size_t pageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t alignedOffset = offset - offset % pageSize;
+        ::madvise(static_cast<uint8_t*>(address_) + alignedOffset,
+                  length + (offset - alignedOffset), advice);
+    }
+
+private:
+    int fd_;
+    void* address_;
+    size_t size_;
+};
+
+// ===== MemoryMappedRegion =====
+
+MemoryMappedRegion::MemoryMappedRegion(const std::string& filePath, size_t size, bool readOnly)
+    : impl_(std::make_unique<PlatformImpl>(filePath, size, readOnly)) {
+}
+
+MemoryMappedRegion::~MemoryMappedRegion() = default;
+
+void* MemoryMappedRegion::data() const { return impl_ ? impl_->data() : nullptr; }
+
+size_t MemoryMappedRegion::size() const { return impl_ ? impl_->size() : 0; }
+
+void MemoryMappedRegion::prefetchRange(size_t offset, size_t length) const {
+    if (impl_) {
+        impl_->advise(offset, length, MADV_WILLNEED);
+    }
+}
+
+void MemoryMappedRegion::adviseRandomAccess() const {
+    if (impl_) {
+        impl_->advise(0, impl_->size(), MADV_RANDOM);
+    }
+}
+
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace lattice {
+namespace io {
+
+// ===== 内存映射区域 =====
+
+/**
+ * MemoryMappedRegion - 文件的共享内存映射（POSIX mmap）
+ *
+ * 只读模式下size为0时映射整个文件；可写模式会先把文件扩展到size。
+ * 打开或映射失败时抛出std::runtime_error。
+ * 只读映射之上的读取不经过系统调用，但映射期间文件被截断会在访问时触发SIGBUS，
+ * 因此只适用于没有并发写入者的文件。
+ */
+class MemoryMappedRegion {
+public:
+    class PlatformImpl;
+
+    MemoryMappedRegion(const std::string& filePath, size_t size, bool readOnly);
+    ~MemoryMappedRegion();
+
+    void* data() const;
+    size_t size() const;
+    bool isValid() const { return impl_ != nullptr; }
+
+    // madvise(WILLNEED)：提示内核异步预读该范围（按页对齐，超出映射的部分被裁剪）
+    void prefetchRange(size_t offset, size_t length) const;
+
+    // madvise(RANDOM)：关闭顺序预读，适合按位置表随机访问的region文件
+    void adviseRandomAccess() const;
+
+    // 禁止拷贝
+    MemoryMappedRegion(const MemoryMappedRegion&) = delete;
+    MemoryMappedRegion& operator=(const MemoryMappedRegion&) = delete;
+
+private:
+    std::unique_ptr<PlatformImpl> impl_;
+};
+
+} // namespace io
+} // namespace lattice
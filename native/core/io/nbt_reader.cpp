@@ -0,0 +1,267 @@
+#include "nbt_reader.hpp"
+
+#include "../simd_dispatch.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+// ===== 批量字节序翻转 =====
+// 实现按CPU在运行时选择（AVX-512 / AVX2 / SSSE3 / NEON / 标量），见core/simd_dispatch.cpp
+
+void byteSwapCopy32(const uint8_t* src, void* dst, size_t count) {
+    core::simdKernels().byteSwapCopy32(src, dst, count);
+}
+
+void byteSwapCopy64(const uint8_t* src, void* dst, size_t count) {
+    core::simdKernels().byteSwapCopy64(src, dst, count);
+}
+
+// ===== NBTReader实现 =====
+
+namespace {
+
+// 定长负载的字节数；变长类型返回0
+size_t fixedPayloadSize(NBTType type) {
+    switch (type) {
+        case NBTType::BYTE:   return 1;
+        case NBTType::SHORT:  return 2;
+        case NBTType::INT:    return 4;
+        case NBTType::LONG:   return 8;
+        case NBTType::FLOAT:  return 4;
+        case NBTType::DOUBLE: return 8;
+        default:              return 0;
+    }
+}
+
+} // namespace
+
+bool NBTReader::readTagHeader(NBTType& type, std::string_view& name) {
+    if (!require(1)) {
+        return false;
+    }
+
+    uint8_t rawType = data_[pos_++];
+    if (rawType > static_cast<uint8_t>(NBTType::LONG_ARRAY)) {
+        fail("Unknown NBT tag type");
+        return false;
+    }
+
+    type = static_cast<NBTType>(rawType);
+    if (type == NBTType::END) {
+        name = {};
+        return true;
+    }
+
+    name = readString();
+    return ok();
+}
+
+bool NBTReader::enterRootCompound(bool allowNameless) {
+    if (!require(1)) {
+        return false;
+    }
+    if (data_[pos_] != static_cast<uint8_t>(NBTType::COMPOUND)) {
+        fail("Root tag is not a compound");
+        return false;
+    }
+
+    if (allowNameless) {
+        ++pos_;
+        return true;
+    }
+
+    NBTType type;
+    std::string_view name;
+    return readTagHeader(type, name);
+}
+
+bool NBTReader::findInCompound(std::string_view name, NBTType& type) {
+    std::string_view tagName;
+    while (readTagHeader(type, tagName)) {
+        if (type == NBTType::END) {
+            return false;
+        }
+        if (tagName == name) {
+            return true;
+        }
+        skipPayload(type);
+    }
+    return false;
+}
+
+int8_t NBTReader::readByte() {
+    if (!require(1)) return 0;
+    return static_cast<int8_t>(data_[pos_++]);
+}
+
+int16_t NBTReader::readShort() {
+    if (!require(2)) return 0;
+    int16_t value = static_cast<int16_t>(loadBigEndian16(data_ + pos_));
+    pos_ += 2;
+    return value;
+}
+
+int32_t NBTReader::readInt() {
+    if (!require(4)) return 0;
+    int32_t value = static_cast<int32_t>(loadBigEndian32(data_ + pos_));
+    pos_ += 4;
+    return value;
+}
+
+int64_t NBTReader::readLong() {
+    if (!require(8)) return 0;
+    int64_t value = static_cast<int64_t>(loadBigEndian64(data_ + pos_));
+    pos_ += 8;
+    return value;
+}
+
+float NBTReader::readFloat() {
+    uint32_t bits = static_cast<uint32_t>(readInt());
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+double NBTReader::readDouble() {
+    uint64_t bits = static_cast<uint64_t>(readLong());
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string_view NBTReader::readString() {
+    if (!require(2)) return {};
+    size_t length = loadBigEndian16(data_ + pos_);
+    pos_ += 2;
+    if (!require(length)) return {};
+
+    std::string_view value(reinterpret_cast<const char*>(data_ + pos_), length);
+    pos_ += length;
+    return value;
+}
+
+size_t NBTReader::readArrayLength(size_t elementSize) {
+    int32_t length = readInt();
+    if (length < 0) {
+        fail("Negative NBT array length");
+        return 0;
+    }
+    if (!require(static_cast<size_t>(length) * elementSize)) {
+        return 0;
+    }
+    return static_cast<size_t>(length);
+}
+
+std::span<const uint8_t> NBTReader::readByteArray() {
+    size_t length = readArrayLength(1);
+    if (!ok()) return {};
+
+    std::span<const uint8_t> value(data_ + pos_, length);
+    pos_ += length;
+    return value;
+}
+
+NBTArrayView<int32_t> NBTReader::readIntArray() {
+    size_t length = readArrayLength(4);
+    if (!ok()) return {};
+
+    NBTArrayView<int32_t> value(data_ + pos_, length);
+    pos_ += length * 4;
+    return value;
+}
+
+NBTArrayView<int64_t> NBTReader::readLongArray() {
+    size_t length = readArrayLength(8);
+    if (!ok()) return {};
+
+    NBTArrayView<int64_t> value(data_ + pos_, length);
+    pos_ += length * 8;
+    return value;
+}
+
+bool NBTReader::readListHeader(NBTType& elementType, int32_t& length) {
+    if (!require(5)) {
+        return false;
+    }
+
+    uint8_t rawType = data_[pos_++];
+    if (rawType > static_cast<uint8_t>(NBTType::LONG_ARRAY)) {
+        fail("Unknown NBT list element type");
+        return false;
+    }
+    elementType = static_cast<NBTType>(rawType);
+
+    length = readInt();
+    if (length < 0) {
+        // 原版对空列表可能写入负长度，视为空
+        length = 0;
+    }
+    return ok();
+}
+
+void NBTReader::skipPayload(NBTType type, int depth) {
+    if (!ok()) {
+        return;
+    }
+    if (depth > MAX_DEPTH) {
+        fail("NBT nesting too deep");
+        return;
+    }
+
+    size_t fixed = fixedPayloadSize(type);
+    if (fixed > 0) {
+        if (require(fixed)) pos_ += fixed;
+        return;
+    }
+
+    switch (type) {
+        case NBTType::END:
+            return;
+        case NBTType::STRING:
+            readString();
+            return;
+        case NBTType::BYTE_ARRAY:
+            readByteArray();
+            return;
+        case NBTType::INT_ARRAY:
+            readIntArray();
+            return;
+        case NBTType::LONG_ARRAY:
+            readLongArray();
+            return;
+        case NBTType::LIST: {
+            NBTType elementType;
+            int32_t length;
+            if (!readListHeader(elementType, length)) {
+                return;
+            }
+            // 定长元素整体跳过
+            size_t elementSize = fixedPayloadSize(elementType);
+            if (elementSize > 0) {
+                size_t bytes = static_cast<size_t>(length) * elementSize;
+                if (require(bytes)) pos_ += bytes;
+                return;
+            }
+            for (int32_t i = 0; i < length && ok(); ++i) {
+                skipPayload(elementType, depth + 1);
+            }
+            return;
+        }
+        case NBTType::COMPOUND: {
+            NBTType childType;
+            std::string_view childName;
+            while (readTagHeader(childType, childName) && childType != NBTType::END) {
+                skipPayload(childType, depth + 1);
+            }
+            return;
+        }
+        default:
+            fail("Unknown NBT tag type");
+            return;
+    }
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
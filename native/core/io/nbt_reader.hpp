@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "anvil_format.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+// ===== 大端解码工具 =====
+
+inline uint16_t loadBigEndian16(const uint8_t* p) {
+    return static_cast<uint16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]);
+}
+
+inline uint32_t loadBigEndian32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+#if defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
+    return __builtin_bswap32(value);
+#endif
+}
+
+inline uint64_t loadBigEndian64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+#if defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+/**
+ * 批量字节序翻转拷贝（大端 <-> 主机序）
+ * 按CPU在运行时选择AVX-512 / AVX2 / SSSE3 / NEON实现，尾部标量处理；src与dst可以指向同一块内存
+ */
+void byteSwapCopy32(const uint8_t* src, void* dst, size_t count);
+void byteSwapCopy64(const uint8_t* src, void* dst, size_t count);
+
+/**
+ * NBTArrayView - 指向NBT缓冲区内大端数组的只读视图
+ *
+ * 不拷贝数据；operator[]按需解码单个元素，copyTo()一次性向量化翻转整个数组
+ * （方块状态调色板索引、高度图等long数组）。视图生命周期不能超过底层缓冲区。
+ */
+template <typename T>
+class NBTArrayView {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8, "NBTArrayView supports 32/64-bit elements");
+
+public:
+    NBTArrayView() = default;
+    NBTArrayView(const uint8_t* data, size_t count) : data_(data), count_(count) {}
+
+    size_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+    // 原始大端字节
+    std::span<const uint8_t> raw() const { return {data_, count_ * sizeof(T)}; }
+
+    T operator[](size_t index) const {
+        const uint8_t* p = data_ + index * sizeof(T);
+        if constexpr (sizeof(T) == 4) {
+            return static_cast<T>(loadBigEndian32(p));
+        } else {
+            return static_cast<T>(loadBigEndian64(p));
+        }
+    }
+
+    // 解码到调用者提供的内存（至少size()个元素）
+    void copyTo(T* out) const {
+        if constexpr (sizeof(T) == 4) {
+            byteSwapCopy32(data_, out, count_);
+        } else {
+            byteSwapCopy64(data_, out, count_);
+        }
+    }
+
+    void copyTo(std::vector<T>& out) const {
+        out.resize(count_);
+        copyTo(out.data());
+    }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t count_ = 0;
+};
+
+/**
+ * NBTReader - 基于std::span的流式NBT游标
+ *
+ * 与NBTSerializer的read*函数不同，读取过程不做任何堆分配：字符串返回
+ * string_view，数组返回指向原缓冲区的视图，不需要的标签可以整体跳过
+ * （定长元素的列表/数组直接按长度跳过，不逐个解析）。
+ *
+ * 错误处理：越界或格式错误时进入失败状态（ok()返回false），之后所有读取
+ * 返回零值/空视图，调用者在解析结束时检查一次即可。
+ */
+class NBTReader {
+public:
+    static constexpr int MAX_DEPTH = 512;    // 与原版NbtAccounter的嵌套深度限制一致
+
+    explicit NBTReader(std::span<const uint8_t> data)
+        : data_(data.data()), size_(data.size()) {}
+
+    bool ok() const { return error_ == nullptr; }
+    const char* error() const { return error_; }
+    size_t position() const { return pos_; }
+    size_t remaining() const { return size_ - pos_; }
+
+    /**
+     * 读取标签头（类型 + 名称）
+     * END标签没有名称；到达缓冲区末尾或出错时返回false
+     */
+    bool readTagHeader(NBTType& type, std::string_view& name);
+
+    /**
+     * 进入根复合标签（跳过其名称）
+     * 网络格式（1.20.2+）的无名根标签同样支持：allowNameless为true时
+     * 根类型字节之后直接是负载
+     */
+    bool enterRootCompound(bool allowNameless = false);
+
+    /**
+     * 在当前复合标签内查找指定名称的子标签，跳过其余标签
+     * 找到时游标停在该标签负载处并返回true；否则游标停在复合标签的END之后
+     * 注意：查找只向前进行，多个字段应按序列化顺序查找或使用readTagHeader遍历
+     */
+    bool findInCompound(std::string_view name, NBTType& type);
+
+    // 标量负载
+    int8_t readByte();
+    int16_t readShort();
+    int32_t readInt();
+    int64_t readLong();
+    float readFloat();
+    double readDouble();
+
+    // 变长负载（视图，生命周期与底层缓冲区相同）
+    std::string_view readString();
+    std::span<const uint8_t> readByteArray();
+    NBTArrayView<int32_t> readIntArray();
+    NBTArrayView<int64_t> readLongArray();
+
+    // 列表头：元素类型 + 元素数量，之后依次读取元素负载
+    bool readListHeader(NBTType& elementType, int32_t& length);
+
+    // 跳过指定类型的负载（复合标签/列表递归跳过）
+    void skipPayload(NBTType type) { skipPayload(type, 0); }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t pos_ = 0;
+    const char* error_ = nullptr;
+
+    bool require(size_t bytes) {
+        if (error_) {
+            return false;
+        }
+        if (size_ - pos_ < bytes) {
+            error_ = "NBT data truncated";
+            return false;
+        }
+        return true;
+    }
+
+    void fail(const char* message) {
+        if (!error_) {
+            error_ = message;
+        }
+    }
+
+    size_t readArrayLength(size_t elementSize);
+    void skipPayload(NBTType type, int depth);
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,211 @@
+#include "nbt_writer.hpp"
+#include "nbt_reader.hpp"
+#include <algorithm>
+#include <new>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+constexpr size_t MIN_WRITER_CAPACITY = 256;
+
+inline void storeBigEndian16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+inline void storeBigEndian32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+inline void storeBigEndian64(uint8_t* p, uint64_t value) {
+    storeBigEndian32(p, static_cast<uint32_t>(value >> 32));
+    storeBigEndian32(p + 4, static_cast<uint32_t>(value));
+}
+
+} // namespace
+
+// ===== NBTWriter实现 =====
+
+NBTWriter::NBTWriter(lattice::net::MemoryArena& arena, size_t sizeHint)
+    : backing_(Backing::ARENA), arena_(&arena) {
+    capacity_ = std::max(sizeHint, MIN_WRITER_CAPACITY);
+    data_ = static_cast<uint8_t*>(arena_->allocate(capacity_));
+    if (!data_) {
+        growHeap(capacity_);
+    }
+}
+
+NBTWriter::NBTWriter(lattice::net::CompressBufferCache::Buffer& buffer, size_t sizeHint)
+    : backing_(Backing::BUFFER), buffer_(&buffer) {
+    size_t wanted = std::max(sizeHint, MIN_WRITER_CAPACITY);
+    if (buffer_->capacity < wanted && !buffer_->resize(wanted)) {
+        throw std::bad_alloc();
+    }
+    data_ = static_cast<uint8_t*>(buffer_->data);
+    capacity_ = buffer_->capacity;
+}
+
+NBTWriter::NBTWriter(size_t sizeHint) : backing_(Backing::HEAP) {
+    growHeap(std::max(sizeHint, MIN_WRITER_CAPACITY));
+}
+
+void NBTWriter::grow(size_t minCapacity) {
+    size_t newCapacity = std::max(capacity_ * 2, minCapacity);
+    ++growCount_;
+
+    switch (backing_) {
+        case Backing::BUFFER: {
+            // realloc保留已写入内容
+            if (!buffer_->resize(newCapacity)) {
+                throw std::bad_alloc();
+            }
+            data_ = static_cast<uint8_t*>(buffer_->data);
+            capacity_ = buffer_->capacity;
+            return;
+        }
+        case Backing::ARENA: {
+            // arena不能单独释放，旧区域在arena clear()时一并回收
+            auto* newData = static_cast<uint8_t*>(arena_->allocate(newCapacity));
+            if (newData) {
+                std::memcpy(newData, data_, size_);
+                data_ = newData;
+                capacity_ = newCapacity;
+                return;
+            }
+            growHeap(newCapacity);
+            return;
+        }
+        case Backing::HEAP:
+            growHeap(newCapacity);
+            return;
+    }
+}
+
+void NBTWriter::growHeap(size_t newCapacity) {
+    std::unique_ptr<uint8_t[]> newData(new uint8_t[newCapacity]);
+    if (size_ > 0) {
+        std::memcpy(newData.get(), data_, size_);
+    }
+    heap_ = std::move(newData);
+    data_ = heap_.get();
+    capacity_ = newCapacity;
+    backing_ = Backing::HEAP;
+}
+
+void NBTWriter::writeTagHeader(NBTType type, std::string_view name) {
+    writeRaw(static_cast<uint8_t>(type));
+    if (type != NBTType::END) {
+        writeString(name);
+    }
+}
+
+void NBTWriter::writeShort(int16_t value) {
+    storeBigEndian16(reserve(2), static_cast<uint16_t>(value));
+}
+
+void NBTWriter::writeInt(int32_t value) {
+    storeBigEndian32(reserve(4), static_cast<uint32_t>(value));
+}
+
+void NBTWriter::writeLong(int64_t value) {
+    storeBigEndian64(reserve(8), static_cast<uint64_t>(value));
+}
+
+void NBTWriter::writeFloat(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeInt(static_cast<int32_t>(bits));
+}
+
+void NBTWriter::writeDouble(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeLong(static_cast<int64_t>(bits));
+}
+
+void NBTWriter::writeString(std::string_view value) {
+    size_t length = std::min<size_t>(value.size(), 0xFFFF);
+    uint8_t* out = reserve(2 + length);
+    storeBigEndian16(out, static_cast<uint16_t>(length));
+    std::memcpy(out + 2, value.data(), length);
+}
+
+void NBTWriter::writeByteArray(std::span<const uint8_t> value) {
+    writeInt(static_cast<int32_t>(value.size()));
+    if (!value.empty()) {
+        std::memcpy(reserve(value.size()), value.data(), value.size());
+    }
+}
+
+void NBTWriter::writeByteArrayFilled(size_t count, uint8_t value) {
+    writeInt(static_cast<int32_t>(count));
+    std::memset(reserve(count), value, count);
+}
+
+void NBTWriter::writeIntArray(std::span<const int32_t> value) {
+    writeInt(static_cast<int32_t>(value.size()));
+    // 字节翻转是对称操作，复用读取端的向量化实现
+    byteSwapCopy32(reinterpret_cast<const uint8_t*>(value.data()), reserve(value.size() * 4), value.size());
+}
+
+void NBTWriter::writeLongArray(std::span<const int64_t> value) {
+    writeInt(static_cast<int32_t>(value.size()));
+    byteSwapCopy64(reinterpret_cast<const uint8_t*>(value.data()), reserve(value.size() * 8), value.size());
+}
+
+std::span<const uint8_t> NBTWriter::finish() {
+    if (backing_ == Backing::BUFFER) {
+        buffer_->current_size = size_;
+        buffer_->touch();
+    }
+    return view();
+}
+
+// ===== SerializedSizeHistory实现 =====
+
+SerializedSizeHistory& SerializedSizeHistory::global() {
+    static SerializedSizeHistory instance;
+    return instance;
+}
+
+uint64_t SerializedSizeHistory::makeKey(int worldId, int x, int z) {
+    // 区块坐标在±1875000范围内，各取24位；世界ID取16位
+    return (static_cast<uint64_t>(static_cast<uint16_t>(worldId)) << 48) |
+           ((static_cast<uint64_t>(x) & 0xFFFFFF) << 24) |
+           (static_cast<uint64_t>(z) & 0xFFFFFF);
+}
+
+size_t SerializedSizeHistory::estimate(int worldId, int x, int z, size_t fallback) const {
+    uint64_t key = makeKey(worldId, x, z);
+    const Shard& shard = shards_[key % SHARD_COUNT];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sizes.find(key);
+    if (it == shard.sizes.end()) {
+        return fallback;
+    }
+    // 预留1/16余量，吸收两次保存之间的小幅增长
+    size_t previous = it->second;
+    return std::max(previous + previous / 16, fallback);
+}
+
+void SerializedSizeHistory::record(int worldId, int x, int z, size_t size) {
+    uint64_t key = makeKey(worldId, x, z);
+    Shard& shard = shards_[key % SHARD_COUNT];
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.sizes.size() >= MAX_ENTRIES_PER_SHARD && !shard.sizes.count(key)) {
+        shard.sizes.clear();
+    }
+    shard.sizes[key] = static_cast<uint32_t>(std::min<size_t>(size, UINT32_MAX));
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
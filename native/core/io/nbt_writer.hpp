@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include "anvil_format.hpp"
+#include "../net/memory_arena.hpp"
+#include "../net/compress_buffer_cache.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * NBTWriter - 写入预分配连续内存的NBT编码器
+ *
+ * 三种后备存储：
+ * - MemoryArena：缓冲区在arena clear()之前有效，适合一次保存批次
+ * - CompressBufferCache::Buffer：复用压缩缓冲区，增长时realloc
+ * - 堆：writer自身持有，供返回std::vector的旧接口使用
+ *
+ * 构造时传入大小预估（通常取自同一区块上次保存的大小，见SerializedSizeHistory），
+ * 预估准确时整个序列化过程只有一次分配。arena耗尽时自动退回堆内存。
+ */
+class NBTWriter {
+public:
+    NBTWriter(lattice::net::MemoryArena& arena, size_t sizeHint);
+    NBTWriter(lattice::net::CompressBufferCache::Buffer& buffer, size_t sizeHint);
+    explicit NBTWriter(size_t sizeHint);
+
+    NBTWriter(const NBTWriter&) = delete;
+    NBTWriter& operator=(const NBTWriter&) = delete;
+
+    // 标签头（类型 + 名称）；END标签只写类型字节
+    void writeTagHeader(NBTType type, std::string_view name);
+    void writeEnd() { writeRaw(static_cast<uint8_t>(NBTType::END)); }
+
+    void writeByte(int8_t value) { writeRaw(static_cast<uint8_t>(value)); }
+    void writeShort(int16_t value);
+    void writeInt(int32_t value);
+    void writeLong(int64_t value);
+    void writeFloat(float value);
+    void writeDouble(double value);
+    void writeString(std::string_view value);
+
+    void writeByteArray(std::span<const uint8_t> value);
+    void writeByteArrayFilled(size_t count, uint8_t value);    // 光照等常量数组，无需临时vector
+    void writeIntArray(std::span<const int32_t> value);        // 批量字节序翻转
+    void writeLongArray(std::span<const int64_t> value);
+
+    // 已写入的数据（指向后备存储，不拷贝）
+    std::span<const uint8_t> view() const { return {data_, size_}; }
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+
+    // 预估不足导致的扩容次数（用于调整预估策略）
+    size_t growCount() const { return growCount_; }
+
+    /**
+     * 结束写入：Buffer后备时更新其current_size
+     * @return 已写入的数据视图
+     */
+    std::span<const uint8_t> finish();
+
+    // 交出堆后备存储的所有权（非堆后备时返回nullptr），view()在返回值存活期间有效
+    std::unique_ptr<uint8_t[]> releaseHeapStorage() { return std::move(heap_); }
+
+private:
+    enum class Backing { ARENA, BUFFER, HEAP };
+
+    Backing backing_;
+    lattice::net::MemoryArena* arena_ = nullptr;
+    lattice::net::CompressBufferCache::Buffer* buffer_ = nullptr;
+    std::unique_ptr<uint8_t[]> heap_;
+
+    uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+    size_t growCount_ = 0;
+
+    void writeRaw(uint8_t byte) { *reserve(1) = byte; }
+
+    // 确保还能写入bytes字节，返回写入位置
+    uint8_t* reserve(size_t bytes) {
+        if (capacity_ - size_ < bytes) {
+            grow(size_ + bytes);
+        }
+        uint8_t* out = data_ + size_;
+        size_ += bytes;
+        return out;
+    }
+
+    void grow(size_t minCapacity);
+    void growHeap(size_t newCapacity);
+};
+
+/**
+ * SerializedSizeHistory - 记录每个区块上次序列化后的大小
+ *
+ * 按区块坐标分片加锁；每个分片条目过多时整体清空，内存占用有上界。
+ */
+class SerializedSizeHistory {
+public:
+    static SerializedSizeHistory& global();
+
+    // 返回上次大小（留少量余量），没有记录时返回fallback
+    size_t estimate(int worldId, int x, int z, size_t fallback) const;
+    void record(int worldId, int x, int z, size_t size);
+
+private:
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr size_t MAX_ENTRIES_PER_SHARD = 8192;
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> sizes;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards_;
+
+    static uint64_t makeKey(int worldId, int x, int z);
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
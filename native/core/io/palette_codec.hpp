@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "../simd_dispatch.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+// ===== 区块段调色板下标编解码 =====
+//
+// block_states / biomes的"data"（1.16+布局）：每个long放64/bits个下标，从低位开始，不跨long。
+// 实现按CPU在运行时选择（AVX-512 / AVX2 / 标量），见core/simd_dispatch.cpp
+
+constexpr int PALETTE_MAX_BITS = 15;
+
+/**
+ * 调色板大小对应的位宽，不小于minBits（原版方块为4，生物群系为1）
+ * 只有一项的调色板不需要data，返回0
+ */
+inline int paletteBitsFor(size_t paletteSize, int minBits) {
+    if (paletteSize <= 1) {
+        return 0;
+    }
+    int bits = minBits;
+    while ((size_t{1} << bits) < paletteSize) {
+        ++bits;
+    }
+    return bits;
+}
+
+// count个bits位宽的下标打包后的long数
+inline size_t paletteLongCount(size_t count, int bits) {
+    const size_t perLong = static_cast<size_t>(64 / bits);
+    return (count + perLong - 1) / perLong;
+}
+
+/**
+ * 从data解出out.size()个下标（通常是readNBTLongArray / NBTReader::readLongArray的结果）
+ * bits不在1..15或data短于paletteLongCount(out.size(), bits)时返回false，out不变
+ */
+inline bool unpackPaletteIndices(std::span<const int64_t> data, int bits, std::span<uint16_t> out) {
+    if (bits < 1 || bits > PALETTE_MAX_BITS || data.size() < paletteLongCount(out.size(), bits)) {
+        return false;
+    }
+    core::simdKernels().unpackPaletteIndices(reinterpret_cast<const uint64_t*>(data.data()), bits,
+                                             out.data(), out.size());
+    return true;
+}
+
+/**
+ * 把values打包写入data的前paletteLongCount(values.size(), bits)个long，最后一个long的空位补0
+ * bits不在1..15、data不够长或有下标超出bits位时返回false，data不变
+ */
+inline bool packPaletteIndices(std::span<const uint16_t> values, int bits, std::span<int64_t> data) {
+    if (bits < 1 || bits > PALETTE_MAX_BITS || data.size() < paletteLongCount(values.size(), bits)) {
+        return false;
+    }
+    uint16_t used = 0;
+    for (uint16_t value : values) {
+        used |= value;
+    }
+    if ((used >> bits) != 0) {
+        return false;
+    }
+    core::simdKernels().packPaletteIndices(values.data(), values.size(), bits,
+                                           reinterpret_cast<uint64_t*>(data.data()));
+    return true;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
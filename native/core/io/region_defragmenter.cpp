@@ -0,0 +1,373 @@
+#include "region_defragmenter.hpp"
+#include "chunk_codecs.hpp"
+#include "region_file.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+constexpr uint8_t REGION_ID_GZIP = 1;
+constexpr uint8_t REGION_ID_ZLIB = 2;
+
+inline size_t sectorsForPayload(size_t payloadSize) {
+    return (payloadSize + REGION_CHUNK_HEADER_SIZE + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+}
+
+bool parseInt(std::string_view text, int& value) {
+    if (text.empty()) {
+        return false;
+    }
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+// r.<x>.<z>.mca
+bool parseRegionFileName(std::string_view name, int& regionX, int& regionZ) {
+    constexpr std::string_view prefix = "r.";
+    constexpr std::string_view suffix = ".mca";
+    if (name.size() <= prefix.size() + suffix.size() ||
+        name.substr(0, prefix.size()) != prefix ||
+        name.substr(name.size() - suffix.size()) != suffix) {
+        return false;
+    }
+    std::string_view coordinates = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+    const size_t dot = coordinates.find('.');
+    return dot != std::string_view::npos &&
+           parseInt(coordinates.substr(0, dot), regionX) &&
+           parseInt(coordinates.substr(dot + 1), regionZ);
+}
+
+void scanRegionDirectory(const std::filesystem::path& directory, int worldId,
+                         std::vector<RegionDefragmenter::RegionRef>& out) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it(directory, ec);
+    for (; !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        int regionX = 0;
+        int regionZ = 0;
+        if (!it->is_regular_file(ec) ||
+            !parseRegionFileName(it->path().filename().string(), regionX, regionZ)) {
+            continue;
+        }
+        out.push_back({it->path().string(), worldId, regionX, regionZ});
+    }
+}
+
+uint32_t unixSeconds() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+} // namespace
+
+// ===== RegionDefragmenter实现 =====
+
+RegionDefragmenter::RegionDefragmenter(const Config& config, ListRegions listRegions, AcquireRegion acquireRegion)
+    : config_(config)
+    , listRegions_(std::move(listRegions))
+    , acquireRegion_(std::move(acquireRegion)) {
+    config_.recompressLevel = std::clamp(config_.recompressLevel, 1, 12);
+    config_.minFreeRatio = std::clamp(config_.minFreeRatio, 0.0, 1.0);
+}
+
+RegionDefragmenter::~RegionDefragmenter() {
+    stop();
+}
+
+void RegionDefragmenter::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_.load() || worker_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    running_.store(true);
+    worker_ = std::thread([this] { run(); });
+}
+
+void RegionDefragmenter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    running_.store(false);
+}
+
+void RegionDefragmenter::onTick(uint64_t spareBytes, bool idle) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const int64_t spare = static_cast<int64_t>(std::min<uint64_t>(spareBytes, INT64_MAX / 2));
+        // 欠下的预算继续扣，剩余的不累积到下一个tick
+        budget_ = std::min(budget_ + spare, spare);
+        idle_ = idle;
+    }
+    wakeup_.notify_all();
+}
+
+RegionDefragmenter::Stats RegionDefragmenter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::vector<RegionDefragmenter::RegionRef> RegionDefragmenter::listWorldRegions(const std::string& worldPath) {
+    namespace fs = std::filesystem;
+    std::vector<RegionRef> regions;
+    scanRegionDirectory(fs::path(worldPath) / "region", 0, regions);
+
+    std::error_code ec;
+    fs::directory_iterator it(worldPath, ec);
+    for (; !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        int worldId = 0;
+        if (name.size() > 3 && name.compare(0, 3, "DIM") == 0 &&
+            parseInt(std::string_view(name).substr(3), worldId) && worldId != 0 &&
+            it->is_directory(ec)) {
+            scanRegionDirectory(it->path() / "region", worldId, regions);
+        }
+    }
+
+    std::sort(regions.begin(), regions.end(), [](const RegionRef& a, const RegionRef& b) {
+        return a.path < b.path;
+    });
+    return regions;
+}
+
+void RegionDefragmenter::run() {
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) break;
+        }
+
+        std::vector<RegionRef> regions;
+        try {
+            regions = listRegions_();
+        } catch (const std::exception& e) {
+            recordError(std::string("Failed to list regions: ") + e.what());
+        }
+
+        for (const auto& region : regions) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (stopping_) break;
+            }
+            try {
+                processRegion(region);
+            } catch (const std::exception& e) {
+                recordError(region.path + ": " + e.what());
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        stats_.passes++;
+        wakeup_.wait_for(lock, std::chrono::milliseconds(config_.rescanIntervalMillis),
+                         [this] { return stopping_; });
+        if (stopping_) break;
+    }
+    running_.store(false);
+}
+
+void RegionDefragmenter::processRegion(const RegionRef& region) {
+    // 先重新压缩：变小的记录留下的空洞在随后的整理中一并回收
+    if (config_.recompressWhenIdle && idle()) {
+        recompressRegion(region);
+    }
+
+    auto file = acquireRegion_(region.path);
+    if (!file) {
+        return;
+    }
+    const RegionFile::SectorStats sectors = file->getSectorStats();
+    file.reset();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.regionsScanned++;
+    }
+
+    const bool fragmented = sectors.freeSectors >= config_.minFreeSectors &&
+        static_cast<double>(sectors.freeSectors) >= config_.minFreeRatio * static_cast<double>(sectors.totalSectors);
+    if (!fragmented) {
+        return;
+    }
+
+    const size_t moved = defragmentRegion(region);
+
+    file = acquireRegion_(region.path);
+    const uint64_t reclaimed = file ? file->truncateFreeTail() : 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.bytesReclaimed += reclaimed;
+    if (moved > 0 || reclaimed > 0) {
+        stats_.regionsDefragmented++;
+    }
+}
+
+size_t RegionDefragmenter::defragmentRegion(const RegionRef& region) {
+    size_t moved = 0;
+    bool progress = true;
+
+    // 每轮按当前位置从后往前搬，直到没有区块能再往前移
+    while (progress) {
+        progress = false;
+
+        auto file = acquireRegion_(region.path);
+        if (!file) {
+            return moved;
+        }
+        const auto locations = file->getLocations();
+        file.reset();
+
+        std::vector<size_t> order;
+        order.reserve(REGION_CHUNK_COUNT);
+        for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+            if (locations[index] != 0) {
+                order.push_back(index);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&locations](size_t a, size_t b) {
+            return RegionFile::sectorOffset(locations[a]) > RegionFile::sectorOffset(locations[b]);
+        });
+
+        for (size_t index : order) {
+            if (!waitForBudget()) {
+                return moved;
+            }
+            // 每次改写重新获取句柄：不长期持有被LRU淘汰的旧句柄
+            file = acquireRegion_(region.path);
+            if (!file) {
+                return moved;
+            }
+            const uint64_t spanBytes = static_cast<uint64_t>(RegionFile::sectorCount(locations[index])) * REGION_SECTOR_SIZE;
+            const auto result = file->moveChunkDown(static_cast<int>(index & 31), static_cast<int>(index >> 5),
+                                                    config_.syncMoves);
+            file.reset();
+
+            if (result == RegionFile::RewriteResult::MOVED) {
+                chargeBudget(spanBytes, spanBytes);
+                moved++;
+                progress = true;
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.chunksMoved++;
+            } else if (result == RegionFile::RewriteResult::CHANGED) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.conflicts++;
+            }
+        }
+    }
+    return moved;
+}
+
+void RegionDefragmenter::recompressRegion(const RegionRef& region) {
+    const uint32_t now = unixSeconds();
+    const uint32_t cutoff = now > config_.recompressMinAgeSeconds ? now - config_.recompressMinAgeSeconds : 0;
+    auto watermark = recompressedUntil_.find(region.path);
+
+    auto file = acquireRegion_(region.path);
+    if (!file) {
+        return;
+    }
+    const auto locations = file->getLocations();
+    file.reset();
+
+    std::vector<uint8_t> record;
+    std::vector<uint8_t> nbt;
+    std::vector<uint8_t> recompressed;
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        if (locations[index] == 0) {
+            continue;
+        }
+        // 空闲结束：放弃本轮，水位不前进
+        if (!idle() || !waitForBudget()) {
+            return;
+        }
+        const int localX = static_cast<int>(index & 31);
+        const int localZ = static_cast<int>(index >> 5);
+
+        file = acquireRegion_(region.path);
+        if (!file) {
+            return;
+        }
+        const uint32_t timestamp = file->getTimestamp(localX, localZ);
+        if ((watermark != recompressedUntil_.end() && timestamp <= watermark->second) || timestamp > cutoff) {
+            continue;
+        }
+
+        RegionFile::RecordVersion version;
+        if (!file->readChunkVersioned(localX, localZ, record, version)) {
+            continue;
+        }
+        chargeBudget(record.size(), 0);
+
+        const uint8_t compressionId = record[0];
+        if (compressionId != REGION_ID_GZIP && compressionId != REGION_ID_ZLIB) {
+            continue; // 只处理DEFLATE记录，LZ4 / zstd / 未压缩保持原样
+        }
+        const auto format = compressionId == REGION_ID_GZIP ? codec::DeflateFormat::GZIP : codec::DeflateFormat::ZLIB;
+
+        nbt.clear();
+        recompressed.clear();
+        if (!codec::deflateDecompress(format, record.data() + 1, record.size() - 1, nbt) ||
+            !codec::deflateCompress(format, nbt.data(), nbt.size(), config_.recompressLevel, recompressed)) {
+            continue;
+        }
+        // 扇区是分配单位：省不出一个扇区的改写没有意义
+        if (sectorsForPayload(recompressed.size()) >= sectorsForPayload(record.size() - 1)) {
+            continue;
+        }
+
+        const auto result = file->replaceChunkIfUnchanged(localX, localZ, version, compressionId,
+                                                          recompressed.data(), recompressed.size(),
+                                                          config_.syncMoves);
+        file.reset();
+        if (result == RegionFile::RewriteResult::MOVED) {
+            chargeBudget(0, sectorsForPayload(recompressed.size()) * REGION_SECTOR_SIZE);
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.chunksRecompressed++;
+        } else if (result == RegionFile::RewriteResult::CHANGED) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.conflicts++;
+        }
+    }
+
+    recompressedUntil_[region.path] = cutoff;
+}
+
+bool RegionDefragmenter::waitForBudget() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!stopping_ && budget_ <= 0) {
+        stats_.budgetWaits++;
+        wakeup_.wait(lock, [this] { return stopping_ || budget_ > 0; });
+    }
+    return !stopping_;
+}
+
+void RegionDefragmenter::chargeBudget(uint64_t bytesRead, uint64_t bytesWritten) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ -= static_cast<int64_t>(bytesRead + bytesWritten);
+    stats_.bytesRead += bytesRead;
+    stats_.bytesWritten += bytesWritten;
+}
+
+bool RegionDefragmenter::idle() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_;
+}
+
+void RegionDefragmenter::recordError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.errors++;
+    stats_.lastError = message;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+class RegionFile;
+
+/**
+ * RegionDefragmenter - 后台region碎片整理与重新压缩
+ *
+ * 低优先级线程循环遍历世界中的region文件，空闲扇区超过阈值的文件在线重排：
+ * 从位置最靠后的区块开始，逐个搬到更靠前的空闲扇区（见RegionFile::moveChunkDown），
+ * 最后截掉末尾空闲扇区。服务器空闲时还可以把较旧的ZLIB/GZIP区块用更高的
+ * libdeflate级别重新压缩，节省至少一个扇区时才写回。
+ *
+ * 与在线保存共用同一个region句柄，不需要停服：每次只改写一个区块，提交前校验
+ * 区块未被并发保存覆盖。所有磁盘读写按字节计入I/O预算，预算由服务器每tick
+ * 通过onTick()发放，用完后等待下一个tick；不调用onTick()时不做任何I/O。
+ */
+class RegionDefragmenter {
+public:
+    struct Config {
+        double minFreeRatio = 0.25;              // 空闲扇区占比达到该值才整理
+        size_t minFreeSectors = 32;              // 且空闲扇区不少于该数（128KB）
+        bool recompressWhenIdle = false;
+        int recompressLevel = 12;                // libdeflate级别（1-12）
+        uint32_t recompressMinAgeSeconds = 600;  // 只重新压缩该时长内未保存过的区块
+        bool syncMoves = true;                   // 每次改写在提交头部前fdatasync
+        uint64_t rescanIntervalMillis = 60000;   // 一轮遍历结束后的等待时间
+    };
+
+    struct Stats {
+        uint64_t passes{0};
+        uint64_t regionsScanned{0};
+        uint64_t regionsDefragmented{0};
+        uint64_t chunksMoved{0};
+        uint64_t chunksRecompressed{0};
+        uint64_t conflicts{0};           // 改写期间区块被保存覆盖，放弃本次改写
+        uint64_t bytesRead{0};
+        uint64_t bytesWritten{0};
+        uint64_t bytesReclaimed{0};      // 截掉的文件末尾
+        uint64_t budgetWaits{0};         // 因本tick预算用完而等待的次数
+        uint64_t errors{0};
+        std::string lastError;
+    };
+
+    struct RegionRef {
+        std::string path;
+        int worldId{0};
+        int regionX{0};
+        int regionZ{0};
+    };
+
+    using ListRegions = std::function<std::vector<RegionRef>()>;
+    // 返回在线路径正在使用的同一个句柄；返回nullptr时跳过该region（只读模式等）
+    using AcquireRegion = std::function<std::shared_ptr<RegionFile>(const std::string& path)>;
+
+    RegionDefragmenter(const Config& config, ListRegions listRegions, AcquireRegion acquireRegion);
+    ~RegionDefragmenter();
+
+    RegionDefragmenter(const RegionDefragmenter&) = delete;
+    RegionDefragmenter& operator=(const RegionDefragmenter&) = delete;
+
+    void start();
+    // 等待当前改写完成后退出；可重复调用
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    /**
+     * 每tick调用：spareBytes为本tick留给后台任务的I/O字节数（未用完的不累积，
+     * 超支的部分从后续tick中扣除），idle表示服务器空闲，允许重新压缩
+     */
+    void onTick(uint64_t spareBytes, bool idle);
+
+    Stats getStats() const;
+
+    // 按createAnvilFilePath的布局列出世界中的region文件（region/与DIM<n>/region/）
+    static std::vector<RegionRef> listWorldRegions(const std::string& worldPath);
+
+private:
+    void run();
+    void processRegion(const RegionRef& region);
+    size_t defragmentRegion(const RegionRef& region);
+    void recompressRegion(const RegionRef& region);
+
+    // 等待本tick还有剩余预算；停止时返回false。实际读写的字节数事后用chargeBudget扣除
+    bool waitForBudget();
+    void chargeBudget(uint64_t bytesRead, uint64_t bytesWritten);
+    bool idle() const;
+    void recordError(const std::string& message);
+
+    Config config_;
+    ListRegions listRegions_;
+    AcquireRegion acquireRegion_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    int64_t budget_{0};
+    bool idle_{false};
+    bool stopping_{false};
+    std::atomic<bool> running_{false};
+    Stats stats_;
+
+    // 每个region上次完整重新压缩时的时间戳水位，只有之后保存过的区块需要再处理
+    std::unordered_map<std::string, uint32_t> recompressedUntil_;
+
+    std::thread worker_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
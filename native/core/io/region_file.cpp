@@ -0,0 +1,760 @@
+#include "region_file.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) |
+           (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) |
+           static_cast<uint32_t>(p[3]);
+}
+
+inline void writeBigEndian32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+// 完整读取，处理短读和EINTR
+bool preadFully(int fd, void* buffer, size_t size, off_t offset) {
+    auto* out = static_cast<uint8_t*>(buffer);
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pread(fd, out + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            return false; // 文件被截断
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 完整写入，处理短写和EINTR
+bool pwritevFully(int fd, struct iovec* iov, int iovCount, off_t offset) {
+    while (iovCount > 0) {
+        ssize_t n = ::pwritev(fd, iov, iovCount, offset);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        offset += n;
+        // 跳过已完整写出的iovec
+        while (iovCount > 0 && static_cast<size_t>(n) >= iov->iov_len) {
+            n -= static_cast<ssize_t>(iov->iov_len);
+            ++iov;
+            --iovCount;
+        }
+        if (iovCount > 0 && n > 0) {
+            iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + n;
+            iov->iov_len -= static_cast<size_t>(n);
+        }
+    }
+    return true;
+}
+
+size_t sectorsForPayload(size_t payloadSize) {
+    return (payloadSize + REGION_CHUNK_HEADER_SIZE + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
+}
+
+} // namespace
+
+// ===== RegionFile实现 =====
+
+RegionFile::RegionFile(const std::string& path, bool createIfMissing)
+    : path_(path), fd_(-1), fileSize_(0) {
+
+    int flags = O_RDWR;
+    if (createIfMissing) {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+        flags |= O_CREAT;
+    }
+
+    fd_ = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (fd_ < 0 && !createIfMissing && errno == EACCES) {
+        // 只读世界（例如只读挂载的小游戏地图）
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd_ < 0) {
+        return;
+    }
+
+    if (!loadHeader()) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+RegionFile::~RegionFile() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool RegionFile::loadHeader() {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        return false;
+    }
+    fileSize_ = static_cast<uint64_t>(st.st_size);
+
+    constexpr size_t headerBytes = REGION_SECTOR_SIZE * REGION_HEADER_SECTORS;
+
+    if (fileSize_ < headerBytes) {
+        if (fileSize_ != 0) {
+            return false; // 头部不完整，视为损坏
+        }
+        // 新建的空region：写入全零头部
+        std::vector<uint8_t> emptyHeader(headerBytes, 0);
+        if (::pwrite(fd_, emptyHeader.data(), headerBytes, 0) != static_cast<ssize_t>(headerBytes)) {
+            return false;
+        }
+        fileSize_ = headerBytes;
+        locations_.fill(0);
+        timestamps_.fill(0);
+        rebuildSectorBitmap();
+        return true;
+    }
+
+    std::array<uint8_t, headerBytes> header;
+    if (!preadFully(fd_, header.data(), header.size(), 0)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < REGION_CHUNK_COUNT; ++i) {
+        locations_[i] = readBigEndian32(header.data() + i * 4);
+        timestamps_[i] = readBigEndian32(header.data() + REGION_SECTOR_SIZE + i * 4);
+    }
+    rebuildSectorBitmap();
+    return true;
+}
+
+void RegionFile::rebuildSectorBitmap() {
+    const size_t totalSectors = static_cast<size_t>(
+        (fileSize_ + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE);
+    usedSectors_.assign(std::max(totalSectors, REGION_HEADER_SECTORS), false);
+
+    // 头部两个扇区始终占用
+    for (size_t i = 0; i < REGION_HEADER_SECTORS; ++i) {
+        usedSectors_[i] = true;
+    }
+
+    for (uint32_t location : locations_) {
+        if (location == 0) continue;
+        const uint32_t offset = sectorOffset(location);
+        const uint32_t count = sectorCount(location);
+        if (offset < REGION_HEADER_SECTORS || offset + count > usedSectors_.size()) {
+            continue; // 越界条目：读取时会被拒绝，这里不标记
+        }
+        markSectors(offset, count, true);
+    }
+}
+
+void RegionFile::markSectors(uint32_t offset, uint32_t count, bool used) {
+    if (offset + count > usedSectors_.size()) {
+        usedSectors_.resize(offset + count, false);
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        usedSectors_[offset + i] = used;
+    }
+}
+
+uint32_t RegionFile::findFreeRun(uint32_t count) const {
+    // first-fit：返回第一段长度足够的连续空闲扇区，找不到时返回文件末尾
+    uint32_t runStart = 0;
+    uint32_t runLength = 0;
+    for (uint32_t i = REGION_HEADER_SECTORS; i < usedSectors_.size(); ++i) {
+        if (usedSectors_[i]) {
+            runLength = 0;
+            continue;
+        }
+        if (runLength == 0) {
+            runStart = i;
+        }
+        if (++runLength == count) {
+            return runStart;
+        }
+    }
+    // 末尾的空闲扇区可以与追加区域合并
+    if (runLength > 0) {
+        return runStart;
+    }
+    return static_cast<uint32_t>(usedSectors_.size());
+}
+
+void RegionFile::writeHeaderEntry(size_t index) {
+    uint8_t location[4];
+    uint8_t timestamp[4];
+    writeBigEndian32(location, locations_[index]);
+    writeBigEndian32(timestamp, timestamps_[index]);
+
+    const off_t entryOffset = static_cast<off_t>(index * 4);
+    if (::pwrite(fd_, location, 4, entryOffset) != 4 ||
+        ::pwrite(fd_, timestamp, 4, entryOffset + static_cast<off_t>(REGION_SECTOR_SIZE)) != 4) {
+        throw std::runtime_error("Failed to update region header: " + path_ + ": " + std::strerror(errno));
+    }
+}
+
+void RegionFile::writeChunk(int localX, int localZ, uint8_t compressionId,
+                            const uint8_t* payload, size_t payloadSize, uint32_t timestamp) {
+    if (fd_ < 0) {
+        throw std::runtime_error("Region file not open: " + path_);
+    }
+
+    const size_t sectorsNeeded = sectorsForPayload(payloadSize);
+    if (sectorsNeeded > 0xFF) {
+        throw std::runtime_error("Chunk payload too large for region sector table (" +
+                                 std::to_string(payloadSize) + " bytes)");
+    }
+    const uint32_t count = static_cast<uint32_t>(sectorsNeeded);
+
+    std::unique_lock lock(headerMutex_);
+
+    const size_t index = chunkIndex(localX, localZ);
+    const uint32_t oldLocation = locations_[index];
+    const uint32_t oldOffset = sectorOffset(oldLocation);
+    const uint32_t oldCount = sectorCount(oldLocation);
+    const bool hasOld = oldLocation != 0 && oldOffset >= REGION_HEADER_SECTORS &&
+                        oldOffset + oldCount <= usedSectors_.size();
+
+    uint32_t targetOffset;
+    if (hasOld && count <= oldCount) {
+        // 原地覆盖
+        targetOffset = oldOffset;
+    } else {
+        targetOffset = findFreeRun(count);
+    }
+
+    // 记录头 + 负载 + 扇区对齐填充，一次pwritev写出
+    uint8_t recordHeader[REGION_CHUNK_HEADER_SIZE];
+    writeBigEndian32(recordHeader, static_cast<uint32_t>(payloadSize + 1));
+    recordHeader[4] = compressionId;
+
+    static const std::array<uint8_t, REGION_SECTOR_SIZE> zeroPadding{};
+    const size_t recordBytes = payloadSize + REGION_CHUNK_HEADER_SIZE;
+    const size_t paddingBytes = static_cast<size_t>(count) * REGION_SECTOR_SIZE - recordBytes;
+
+    struct iovec iov[3];
+    iov[0].iov_base = recordHeader;
+    iov[0].iov_len = sizeof(recordHeader);
+    iov[1].iov_base = const_cast<uint8_t*>(payload);
+    iov[1].iov_len = payloadSize;
+    iov[2].iov_base = const_cast<uint8_t*>(zeroPadding.data());
+    iov[2].iov_len = paddingBytes;
+
+    const off_t fileOffset = static_cast<off_t>(targetOffset) * REGION_SECTOR_SIZE;
+    if (!pwritevFully(fd_, iov, paddingBytes > 0 ? 3 : 2, fileOffset)) {
+        throw std::runtime_error("Failed to write chunk to region: " + path_ + ": " + std::strerror(errno));
+    }
+
+    fileSize_ = std::max<uint64_t>(fileSize_, static_cast<uint64_t>(fileOffset) +
+                                              static_cast<uint64_t>(count) * REGION_SECTOR_SIZE);
+    markSectors(targetOffset, count, true);
+
+    // 先更新头部指向新位置，再释放旧扇区
+    locations_[index] = (targetOffset << 8) | count;
+    timestamps_[index] = timestamp;
+    generations_[index]++;
+    writeHeaderEntry(index);
+
+    if (hasOld) {
+        if (targetOffset == oldOffset) {
+            if (count < oldCount) {
+                markSectors(oldOffset + count, oldCount - count, false);
+            }
+        } else {
+            markSectors(oldOffset, oldCount, false);
+        }
+    }
+}
+
+bool RegionFile::sync() const {
+    if (fd_ < 0) {
+        return false;
+    }
+    while (::fdatasync(fd_) != 0) {
+        if (errno != EINTR) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RegionFile::removeChunk(int localX, int localZ) {
+    if (fd_ < 0) {
+        return;
+    }
+
+    std::unique_lock lock(headerMutex_);
+
+    const size_t index = chunkIndex(localX, localZ);
+    const uint32_t location = locations_[index];
+    if (location == 0) {
+        return;
+    }
+
+    locations_[index] = 0;
+    timestamps_[index] = 0;
+    generations_[index]++;
+    writeHeaderEntry(index);
+
+    const uint32_t offset = sectorOffset(location);
+    const uint32_t count = sectorCount(location);
+    if (offset >= REGION_HEADER_SECTORS && offset + count <= usedSectors_.size()) {
+        markSectors(offset, count, false);
+    }
+}
+
+RegionFile::SectorStats RegionFile::getSectorStats() const {
+    std::shared_lock lock(headerMutex_);
+
+    SectorStats stats;
+    stats.totalSectors = usedSectors_.size();
+    for (bool used : usedSectors_) {
+        if (used) stats.usedSectors++;
+    }
+    stats.freeSectors = stats.totalSectors - stats.usedSectors;
+    for (uint32_t location : locations_) {
+        if (location != 0) stats.chunkCount++;
+    }
+    return stats;
+}
+
+uint64_t RegionFile::compactFile(const std::string& path) {
+    RegionFile source(path, false);
+    if (!source.isOpen()) {
+        throw std::runtime_error("Failed to open region for compaction: " + path);
+    }
+
+    const std::string tempPath = path + ".compact";
+    ::unlink(tempPath.c_str());
+
+    uint64_t reclaimed = 0;
+    {
+        RegionFile target(tempPath, true);
+        if (!target.isOpen()) {
+            throw std::runtime_error("Failed to create compaction target: " + tempPath);
+        }
+
+        // 按区块索引顺序写入，新文件中没有空洞
+        std::vector<uint8_t> record;
+        for (int localZ = 0; localZ < 32; ++localZ) {
+            for (int localX = 0; localX < 32; ++localX) {
+                uint32_t timestamp = 0;
+                if (!source.readChunk(localX, localZ, record, &timestamp)) {
+                    continue; // 不存在或已损坏的条目直接丢弃
+                }
+                target.writeChunk(localX, localZ, record[0],
+                                  record.data() + 1, record.size() - 1, timestamp);
+            }
+        }
+
+        if (::fsync(target.fd()) != 0) {
+            throw std::runtime_error("Failed to sync compacted region: " + tempPath);
+        }
+
+        reclaimed = source.fileSize_ > target.fileSize_ ? source.fileSize_ - target.fileSize_ : 0;
+    }
+
+    if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+        ::unlink(tempPath.c_str());
+        throw std::runtime_error("Failed to replace region with compacted copy: " + path);
+    }
+    return reclaimed;
+}
+
+bool RegionFile::hasChunk(int localX, int localZ) const {
+    std::shared_lock lock(headerMutex_);
+    return locations_[chunkIndex(localX, localZ)] != 0;
+}
+
+uint32_t RegionFile::getTimestamp(int localX, int localZ) const {
+    std::shared_lock lock(headerMutex_);
+    return timestamps_[chunkIndex(localX, localZ)];
+}
+
+bool RegionFile::readChunk(int localX, int localZ, std::vector<uint8_t>& out, uint32_t* timestamp) const {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    std::shared_lock lock(headerMutex_);
+
+    const size_t index = chunkIndex(localX, localZ);
+    if (!readChunkLocked(index, out)) {
+        return false;
+    }
+    if (timestamp) {
+        *timestamp = timestamps_[index];
+    }
+    return true;
+}
+
+bool RegionFile::readChunkVersioned(int localX, int localZ, std::vector<uint8_t>& out,
+                                    RecordVersion& version) const {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    std::shared_lock lock(headerMutex_);
+
+    const size_t index = chunkIndex(localX, localZ);
+    version.location = locations_[index];
+    version.generation = generations_[index];
+    return readChunkLocked(index, out);
+}
+
+bool RegionFile::removeChunkIfUnchanged(int localX, int localZ, const RecordVersion& version) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    std::unique_lock lock(headerMutex_);
+
+    const size_t index = chunkIndex(localX, localZ);
+    if (version.location == 0 || locations_[index] != version.location ||
+        generations_[index] != version.generation) {
+        return false;
+    }
+
+    locations_[index] = 0;
+    timestamps_[index] = 0;
+    generations_[index]++;
+    writeHeaderEntry(index);
+
+    const uint32_t offset = sectorOffset(version.location);
+    const uint32_t count = sectorCount(version.location);
+    if (offset >= REGION_HEADER_SECTORS && offset + count <= usedSectors_.size()) {
+        markSectors(offset, count, false);
+    }
+    return true;
+}
+
+bool RegionFile::readChunkLocked(size_t index, std::vector<uint8_t>& out) const {
+    const uint32_t location = locations_[index];
+    if (location == 0) {
+        return false;
+    }
+
+    const uint32_t offset = sectorOffset(location);
+    const uint32_t count = sectorCount(location);
+    if (offset < REGION_HEADER_SECTORS || count == 0) {
+        return false;
+    }
+
+    const size_t spanBytes = static_cast<size_t>(count) * REGION_SECTOR_SIZE;
+    const off_t fileOffset = static_cast<off_t>(offset) * REGION_SECTOR_SIZE;
+    if (static_cast<uint64_t>(fileOffset) >= fileSize_) {
+        return false;
+    }
+
+    // 单次positioned read读取整个扇区跨度（末尾扇区可能未被填满）
+    const size_t readable = static_cast<size_t>(
+        std::min<uint64_t>(spanBytes, fileSize_ - static_cast<uint64_t>(fileOffset)));
+    out.resize(readable);
+    if (!preadFully(fd_, out.data(), readable, fileOffset)) {
+        out.clear();
+        return false;
+    }
+
+    if (readable < REGION_CHUNK_HEADER_SIZE) {
+        out.clear();
+        return false;
+    }
+
+    // 长度字段包含压缩类型字节
+    const uint32_t length = readBigEndian32(out.data());
+    if (length == 0 || length + 4 > readable) {
+        out.clear();
+        return false;
+    }
+
+    // 去掉4字节长度前缀：out[0]为压缩类型，其后为负载
+    out.erase(out.begin(), out.begin() + 4);
+    out.resize(length);
+    return true;
+}
+
+// ===== 在线重排 =====
+
+uint32_t RegionFile::findFreeRunBelow(uint32_t count, uint32_t limit) const {
+    uint32_t runLength = 0;
+    const uint32_t end = std::min<uint32_t>(limit, static_cast<uint32_t>(usedSectors_.size()));
+    for (uint32_t i = REGION_HEADER_SECTORS; i < end; ++i) {
+        if (usedSectors_[i]) {
+            runLength = 0;
+            continue;
+        }
+        if (++runLength == count) {
+            return i + 1 - count;
+        }
+    }
+    return 0;
+}
+
+RegionFile::RewriteResult RegionFile::moveChunkDown(int localX, int localZ, bool syncBeforeCommit) {
+    if (fd_ < 0) {
+        throw std::runtime_error("Region file not open: " + path_);
+    }
+
+    const size_t index = chunkIndex(localX, localZ);
+    RecordVersion version;
+    uint32_t offset = 0;
+    uint32_t count = 0;
+    uint32_t target = 0;
+    {
+        std::unique_lock lock(headerMutex_);
+        version.location = locations_[index];
+        version.generation = generations_[index];
+        offset = sectorOffset(version.location);
+        count = sectorCount(version.location);
+        if (version.location == 0) {
+            return RewriteResult::CHANGED;
+        }
+        if (offset < REGION_HEADER_SECTORS || count == 0 || offset + count > usedSectors_.size()) {
+            return RewriteResult::NO_SPACE; // 越界条目不动，留给读取路径拒绝
+        }
+        target = findFreeRunBelow(count, offset);
+        if (target == 0) {
+            return RewriteResult::NO_SPACE;
+        }
+        markSectors(target, count, true);
+    }
+
+    // 整个扇区跨度原样拷贝（记录头不变）；末尾扇区可能不完整，缺少的部分补零
+    std::vector<uint8_t> span(static_cast<size_t>(count) * REGION_SECTOR_SIZE, 0);
+    bool written = true;
+    size_t done = 0;
+    while (done < span.size()) {
+        ssize_t n = ::pread(fd_, span.data() + done, span.size() - done,
+                            static_cast<off_t>(offset) * REGION_SECTOR_SIZE + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            written = false;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+
+    if (written) {
+        struct iovec iov;
+        iov.iov_base = span.data();
+        iov.iov_len = span.size();
+        written = pwritevFully(fd_, &iov, 1, static_cast<off_t>(target) * REGION_SECTOR_SIZE) &&
+                  (!syncBeforeCommit || sync());
+    }
+    return commitRewrite(index, version, target, count, written, written ? 0 : errno);
+}
+
+RegionFile::RewriteResult RegionFile::replaceChunkIfUnchanged(int localX, int localZ, const RecordVersion& version,
+                                                              uint8_t compressionId, const uint8_t* payload,
+                                                              size_t payloadSize, bool syncBeforeCommit) {
+    if (fd_ < 0) {
+        throw std::runtime_error("Region file not open: " + path_);
+    }
+
+    const size_t sectorsNeeded = sectorsForPayload(payloadSize);
+    if (sectorsNeeded > 0xFF) {
+        throw std::runtime_error("Chunk payload too large for region sector table (" +
+                                 std::to_string(payloadSize) + " bytes)");
+    }
+    const uint32_t count = static_cast<uint32_t>(sectorsNeeded);
+    const size_t index = chunkIndex(localX, localZ);
+
+    uint32_t target = 0;
+    {
+        std::unique_lock lock(headerMutex_);
+        if (locations_[index] != version.location || generations_[index] != version.generation ||
+            version.location == 0) {
+            return RewriteResult::CHANGED;
+        }
+        // 不与旧记录重叠：提交前旧记录必须保持完整
+        target = findFreeRunBelow(count, sectorOffset(version.location));
+        if (target == 0) {
+            target = findFreeRun(count);
+        }
+        markSectors(target, count, true);
+    }
+
+    uint8_t recordHeader[REGION_CHUNK_HEADER_SIZE];
+    writeBigEndian32(recordHeader, static_cast<uint32_t>(payloadSize + 1));
+    recordHeader[4] = compressionId;
+
+    static const std::array<uint8_t, REGION_SECTOR_SIZE> zeroPadding{};
+    const size_t paddingBytes = static_cast<size_t>(count) * REGION_SECTOR_SIZE -
+                                (payloadSize + REGION_CHUNK_HEADER_SIZE);
+
+    struct iovec iov[3];
+    iov[0].iov_base = recordHeader;
+    iov[0].iov_len = sizeof(recordHeader);
+    iov[1].iov_base = const_cast<uint8_t*>(payload);
+    iov[1].iov_len = payloadSize;
+    iov[2].iov_base = const_cast<uint8_t*>(zeroPadding.data());
+    iov[2].iov_len = paddingBytes;
+
+    const bool written = pwritevFully(fd_, iov, paddingBytes > 0 ? 3 : 2,
+                                      static_cast<off_t>(target) * REGION_SECTOR_SIZE) &&
+                         (!syncBeforeCommit || sync());
+    return commitRewrite(index, version, target, count, written, written ? 0 : errno);
+}
+
+RegionFile::RewriteResult RegionFile::commitRewrite(size_t index, const RecordVersion& version,
+                                                    uint32_t target, uint32_t count,
+                                                    bool written, int writeErrno) {
+    std::unique_lock lock(headerMutex_);
+
+    if (!written) {
+        markSectors(target, count, false);
+        throw std::runtime_error("Failed to rewrite chunk in region: " + path_ + ": " + std::strerror(writeErrno));
+    }
+    if (locations_[index] != version.location || generations_[index] != version.generation) {
+        // 锁外写入期间被保存覆盖或删除：新记录作废
+        markSectors(target, count, false);
+        return RewriteResult::CHANGED;
+    }
+
+    fileSize_ = std::max<uint64_t>(fileSize_, static_cast<uint64_t>(target + count) * REGION_SECTOR_SIZE);
+    locations_[index] = (target << 8) | count;
+    writeHeaderEntry(index);
+
+    // 头部指向新位置后才释放旧扇区
+    markSectors(sectorOffset(version.location), sectorCount(version.location), false);
+    return RewriteResult::MOVED;
+}
+
+uint64_t RegionFile::truncateFreeTail() {
+    if (fd_ < 0) {
+        return 0;
+    }
+
+    std::unique_lock lock(headerMutex_);
+
+    size_t usedEnd = usedSectors_.size();
+    while (usedEnd > REGION_HEADER_SECTORS && !usedSectors_[usedEnd - 1]) {
+        --usedEnd;
+    }
+    const uint64_t newSize = static_cast<uint64_t>(usedEnd) * REGION_SECTOR_SIZE;
+    usedSectors_.resize(usedEnd);
+    if (newSize >= fileSize_) {
+        return 0;
+    }
+
+    if (::ftruncate(fd_, static_cast<off_t>(newSize)) != 0) {
+        throw std::runtime_error("Failed to truncate region: " + path_ + ": " + std::strerror(errno));
+    }
+    const uint64_t reclaimed = fileSize_ - newSize;
+    fileSize_ = newSize;
+    return reclaimed;
+}
+
+std::array<uint32_t, REGION_CHUNK_COUNT> RegionFile::getLocations() const {
+    std::shared_lock lock(headerMutex_);
+    return locations_;
+}
+
+// ===== RegionFileCache实现 =====
+
+RegionFileCache::RegionFileCache(size_t maxOpenRegions)
+    : maxOpenRegions_(maxOpenRegions > 0 ? maxOpenRegions : 1) {
+}
+
+std::shared_ptr<RegionFile> RegionFileCache::acquire(const std::string& path, bool createIfMissing) {
+    {
+        std::lock_guard lock(mutex_);
+        auto it = entries_.find(path);
+        if (it != entries_.end()) {
+            // 命中：移到LRU头部
+            lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+            stats_.hits++;
+            return it->second.region;
+        }
+        stats_.misses++;
+    }
+
+    // 在锁外打开文件，避免open/头部解析阻塞其他region的命中路径
+    if (!createIfMissing && ::access(path.c_str(), F_OK) != 0) {
+        return nullptr;
+    }
+
+    auto region = std::make_shared<RegionFile>(path, createIfMissing);
+    if (!region->isOpen()) {
+        return nullptr;
+    }
+
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+        // 其他线程已抢先打开，使用已缓存的句柄（保证同一文件只有一份头部）
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return it->second.region;
+    }
+
+    lru_.push_front(path);
+    entries_.emplace(path, Entry{region, lru_.begin()});
+    evictIfNeeded();
+    return region;
+}
+
+void RegionFileCache::invalidate(const std::string& path) {
+    std::lock_guard lock(mutex_);
+    auto it = entries_.find(path);
+    if (it != entries_.end()) {
+        lru_.erase(it->second.lruPos);
+        entries_.erase(it);
+    }
+}
+
+void RegionFileCache::clear() {
+    std::lock_guard lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+}
+
+void RegionFileCache::setMaxOpenRegions(size_t maxOpenRegions) {
+    std::lock_guard lock(mutex_);
+    maxOpenRegions_ = maxOpenRegions > 0 ? maxOpenRegions : 1;
+    evictIfNeeded();
+}
+
+RegionFileCache::CacheStats RegionFileCache::getStats() const {
+    std::lock_guard lock(mutex_);
+    CacheStats stats = stats_;
+    stats.openRegions = entries_.size();
+    return stats;
+}
+
+void RegionFileCache::evictIfNeeded() {
+    // 调用者持有mutex_
+    while (entries_.size() > maxOpenRegions_ && !lru_.empty()) {
+        const std::string& victim = lru_.back();
+        entries_.erase(victim);
+        lru_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+// ===== Region文件常量 =====
+constexpr size_t REGION_SECTOR_SIZE = 4096;          // 每个扇区4KB
+constexpr size_t REGION_HEADER_SECTORS = 2;          // 位置表 + 时间戳表
+constexpr size_t REGION_CHUNK_COUNT = 32 * 32;       // 每个region 1024个区块
+constexpr size_t REGION_CHUNK_HEADER_SIZE = 5;       // 4字节长度 + 1字节压缩类型
+
+/**
+ * RegionFile - 单个r.X.Z.mca文件的句柄
+ *
+ * 打开时解析一次8KB头部（位置表与时间戳表），之后每次区块读取
+ * 只需一次pread读取该区块占用的完整扇区跨度。
+ * 读操作持有共享锁，头部修改持有独占锁。
+ */
+class RegionFile {
+public:
+    RegionFile(const std::string& path, bool createIfMissing);
+    ~RegionFile();
+
+    // 禁止拷贝和移动（持有文件描述符）
+    RegionFile(const RegionFile&) = delete;
+    RegionFile& operator=(const RegionFile&) = delete;
+    RegionFile(RegionFile&&) = delete;
+    RegionFile& operator=(RegionFile&&) = delete;
+
+    bool isOpen() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+    const std::string& path() const { return path_; }
+
+    // 区块是否存在于位置表中
+    bool hasChunk(int localX, int localZ) const;
+
+    /**
+     * 读取区块记录
+     * 成功时 out[0] 为region压缩方案ID（1=GZIP, 2=ZLIB, 3=无压缩），
+     * out[1..] 为压缩后的负载。区块不存在或记录损坏时返回false。
+     */
+    bool readChunk(int localX, int localZ, std::vector<uint8_t>& out, uint32_t* timestamp = nullptr) const;
+
+    uint32_t getTimestamp(int localX, int localZ) const;
+
+    /**
+     * 写入区块记录（扇区分配）
+     * 新负载不超过原扇区跨度时原地覆盖并释放多余扇区；否则在空闲位图中
+     * first-fit查找连续空闲扇区，找不到时追加到文件末尾。头部更新后才释放旧扇区。
+     * 负载超过255个扇区（需要外部.mcc）时抛出std::runtime_error。
+     */
+    void writeChunk(int localX, int localZ, uint8_t compressionId,
+                    const uint8_t* payload, size_t payloadSize, uint32_t timestamp);
+
+    // 删除区块并释放其扇区
+    void removeChunk(int localX, int localZ);
+
+    // fdatasync：把已写入的记录和头部落盘（区块日志检查点使用）
+    bool sync() const;
+
+    // 扇区使用情况
+    struct SectorStats {
+        size_t totalSectors{0};
+        size_t usedSectors{0};
+        size_t freeSectors{0};
+        size_t chunkCount{0};
+    };
+
+    SectorStats getSectorStats() const;
+
+    /**
+     * 离线压缩：按区块索引顺序将所有记录连续重写到新文件，然后原子替换原文件
+     * 调用前必须确保没有其他句柄正在使用该文件（先从RegionFileCache中invalidate）
+     * @return 回收的字节数；失败时抛出std::runtime_error
+     */
+    static uint64_t compactFile(const std::string& path);
+
+    /**
+     * 在线重排（RegionDefragmenter使用），可与读取和writeChunk并发
+     * 目标扇区先在位图中预留，锁外写入（可选fdatasync）后再提交头部；
+     * 提交前发现区块在此期间被改写或删除时释放预留并返回CHANGED
+     */
+    enum class RewriteResult : uint8_t {
+        MOVED = 0,
+        CHANGED = 1,        // 区块已被并发改写、删除或不存在
+        NO_SPACE = 2        // 没有合适的空闲扇区
+    };
+
+    // 区块记录的版本：位置表条目 + 改写计数（原地覆盖不改变位置）
+    struct RecordVersion {
+        uint32_t location{0};
+        uint32_t generation{0};
+    };
+
+    // 把区块记录原样搬到其当前位置之前第一段足够大的空闲扇区
+    RewriteResult moveChunkDown(int localX, int localZ, bool syncBeforeCommit);
+
+    // 读取区块记录（同readChunk）并返回其版本；记录损坏而返回false时version仍是该记录的版本
+    bool readChunkVersioned(int localX, int localZ, std::vector<uint8_t>& out, RecordVersion& version) const;
+    
+    // 删除version对应的记录（RegionScrubber隔离损坏区块）；区块已被改写或删除时返回false
+    bool removeChunkIfUnchanged(int localX, int localZ, const RecordVersion& version);
+
+    // 用新负载替换version对应的记录，时间戳不变；优先放在当前位置之前
+    RewriteResult replaceChunkIfUnchanged(int localX, int localZ, const RecordVersion& version,
+                                          uint8_t compressionId, const uint8_t* payload,
+                                          size_t payloadSize, bool syncBeforeCommit);
+
+    // 截掉文件末尾的空闲扇区，返回回收的字节数
+    uint64_t truncateFreeTail();
+
+    // 位置表快照
+    std::array<uint32_t, REGION_CHUNK_COUNT> getLocations() const;
+
+    // 位置表条目解码
+    static uint32_t sectorOffset(uint32_t location) { return location >> 8; }
+    static uint32_t sectorCount(uint32_t location) { return location & 0xFF; }
+    static size_t chunkIndex(int localX, int localZ) {
+        return static_cast<size_t>((localX & 0x1F) + (localZ & 0x1F) * 32);
+    }
+
+private:
+    std::string path_;
+    int fd_;
+    uint64_t fileSize_;
+
+    std::array<uint32_t, REGION_CHUNK_COUNT> locations_{};
+    std::array<uint32_t, REGION_CHUNK_COUNT> timestamps_{};
+    std::array<uint32_t, REGION_CHUNK_COUNT> generations_{};    // writeChunk / removeChunk时递增
+    mutable std::shared_mutex headerMutex_;
+
+    // 空闲扇区位图（true = 已占用），由头部位置表构建
+    std::vector<bool> usedSectors_;
+
+    bool loadHeader();
+    void rebuildSectorBitmap();
+    void markSectors(uint32_t offset, uint32_t count, bool used);
+    uint32_t findFreeRun(uint32_t count) const;
+    // [REGION_HEADER_SECTORS, limit)内第一段count个连续空闲扇区；没有时返回0
+    uint32_t findFreeRunBelow(uint32_t count, uint32_t limit) const;
+    bool readChunkLocked(size_t index, std::vector<uint8_t>& out) const;
+    // 在线重排的提交阶段：校验版本后切换位置表条目并释放旧扇区
+    RewriteResult commitRewrite(size_t index, const RecordVersion& version,
+                                uint32_t target, uint32_t count, bool written, int writeErrno);
+    void writeHeaderEntry(size_t index);
+};
+
+/**
+ * RegionFileCache - 每个世界的region句柄LRU缓存
+ *
+ * 保持最近使用的region文件描述符和已解析的位置表常驻，
+ * 避免每次加载区块都重新open并解析头部。被淘汰的句柄在
+ * 最后一个使用者释放shared_ptr后才真正关闭。
+ */
+class RegionFileCache {
+public:
+    static constexpr size_t DEFAULT_MAX_OPEN_REGIONS = 64;
+
+    explicit RegionFileCache(size_t maxOpenRegions = DEFAULT_MAX_OPEN_REGIONS);
+    ~RegionFileCache() = default;
+
+    RegionFileCache(const RegionFileCache&) = delete;
+    RegionFileCache& operator=(const RegionFileCache&) = delete;
+
+    /**
+     * 获取region句柄
+     * 文件不存在且createIfMissing为false时返回nullptr
+     */
+    std::shared_ptr<RegionFile> acquire(const std::string& path, bool createIfMissing = false);
+
+    // 从缓存中移除指定region（外部修改或删除文件后调用）
+    void invalidate(const std::string& path);
+    void clear();
+
+    void setMaxOpenRegions(size_t maxOpenRegions);
+    size_t getMaxOpenRegions() const { return maxOpenRegions_; }
+
+    struct CacheStats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t openRegions{0};
+    };
+
+    CacheStats getStats() const;
+
+private:
+    using LruList = std::list<std::string>;
+
+    struct Entry {
+        std::shared_ptr<RegionFile> region;
+        LruList::iterator lruPos;
+    };
+
+    size_t maxOpenRegions_;
+    mutable std::mutex mutex_;
+    LruList lru_;                                   // 头部 = 最近使用
+    std::unordered_map<std::string, Entry> entries_;
+    CacheStats stats_;
+
+    void evictIfNeeded();
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,435 @@
+#include "region_index.hpp"
+#include "anvil_format.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+constexpr size_t HEADER_BYTES = REGION_SECTOR_SIZE * REGION_HEADER_SECTORS;
+constexpr size_t MAX_SCAN_THREADS = 32;
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+// 区块坐标的region坐标与region内下标（负坐标向下取整）
+inline int regionOf(int chunk) { return chunk >> 5; }
+inline size_t localIndexOf(int chunkX, int chunkZ) {
+    return RegionFile::chunkIndex(chunkX & 31, chunkZ & 31);
+}
+
+// 解析"r.X.Z.mca"
+bool parseRegionName(const std::string& name, int& regionX, int& regionZ) {
+    constexpr const char* extension = ".mca";
+    constexpr size_t extensionLength = 4;
+    if (name.size() <= 2 + extensionLength || name.compare(0, 2, "r.") != 0 ||
+        name.compare(name.size() - extensionLength, extensionLength, extension) != 0) {
+        return false;
+    }
+    const std::string coords = name.substr(2, name.size() - 2 - extensionLength);
+    const size_t dot = coords.find('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    try {
+        size_t usedX = 0, usedZ = 0;
+        regionX = std::stoi(coords.substr(0, dot), &usedX);
+        regionZ = std::stoi(coords.substr(dot + 1), &usedZ);
+        return usedX == dot && usedZ == coords.size() - dot - 1;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+struct ScanJob {
+    int worldId;
+    int regionX;
+    int regionZ;
+    std::string path;
+};
+
+size_t entryBytes(bool trackTimestamps) {
+    // 位图与边界 + 哈希表节点的大致开销
+    return sizeof(uint64_t) + 64 + (trackTimestamps ? REGION_CHUNK_COUNT * sizeof(uint32_t) : 0) + 48;
+}
+
+} // namespace
+
+uint64_t RegionIndex::regionKey(int worldId, int regionX, int regionZ) {
+    // 与BulkRegionImporter相同：worldId取低16位，region坐标各24位
+    return (static_cast<uint64_t>(static_cast<uint16_t>(worldId)) << 48) |
+           ((static_cast<uint64_t>(regionX) & 0xFFFFFF) << 24) |
+           (static_cast<uint64_t>(regionZ) & 0xFFFFFF);
+}
+
+bool RegionIndex::readHeader(const std::string& path, bool trackTimestamps, RegionEntry& entry) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    // 只读头部两个扇区；区块数据不动
+    uint8_t header[HEADER_BYTES];
+    size_t done = 0;
+    bool ok = true;
+    while (done < HEADER_BYTES) {
+        const ssize_t n = ::pread(fd, header + done, HEADER_BYTES - done, static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ok = false;
+            break;
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    if (!ok) {
+        return false;
+    }
+    if (done < HEADER_BYTES) {
+        // 与RegionFile一致：空文件是空region，头部不完整视为损坏
+        return done == 0;
+    }
+
+    if (trackTimestamps) {
+        entry.timestamps = std::make_unique<uint32_t[]>(REGION_CHUNK_COUNT);
+    }
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        if (readBigEndian32(header + index * 4) == 0) {
+            continue;
+        }
+        const uint32_t timestamp = readBigEndian32(header + REGION_SECTOR_SIZE + index * 4);
+        entry.present.set(index);
+        if (entry.timestamps) {
+            entry.timestamps[index] = timestamp;
+        }
+        entry.minTimestamp = std::min(entry.minTimestamp, timestamp);
+        entry.maxTimestamp = std::max(entry.maxTimestamp, timestamp);
+    }
+    return true;
+}
+
+void RegionIndex::refreshBounds(RegionEntry& entry) {
+    if (!entry.timestamps) {
+        // 没有逐区块时间戳时边界只能扩大，不能在删除后收缩
+        return;
+    }
+    entry.minTimestamp = UINT32_MAX;
+    entry.maxTimestamp = 0;
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        if (entry.present.test(index)) {
+            entry.minTimestamp = std::min(entry.minTimestamp, entry.timestamps[index]);
+            entry.maxTimestamp = std::max(entry.maxTimestamp, entry.timestamps[index]);
+        }
+    }
+}
+
+RegionIndex::Stats RegionIndex::build(const std::string& worldPath, const Config& config) {
+    namespace fs = std::filesystem;
+    std::lock_guard<std::mutex> buildLock(buildMutex_);
+    const auto start = std::chrono::steady_clock::now();
+
+    {
+        std::unique_lock lock(mutex_);
+        building_ = true;
+        pendingUpdates_.clear();
+    }
+
+    // 先列出所有文件（目录遍历本身是串行的），再并行读头部
+    std::vector<ScanJob> jobs;
+    for (const int worldId : config.worldIds) {
+        const fs::path directory = fs::path(createAnvilFilePath(worldPath, worldId, 0, 0)).parent_path();
+        std::error_code ec;
+        if (!fs::is_directory(directory, ec)) {
+            continue;
+        }
+        for (const auto& file : fs::directory_iterator(directory, ec)) {
+            int regionX = 0, regionZ = 0;
+            if (file.is_regular_file(ec) && parseRegionName(file.path().filename().string(), regionX, regionZ)) {
+                jobs.push_back(ScanJob{worldId, regionX, regionZ, file.path().string()});
+            }
+        }
+    }
+
+    size_t threadCount = config.threads;
+    if (threadCount == 0) {
+        // 头部读取以I/O等待为主，线程数多于核数才能把磁盘队列填满
+        threadCount = std::min<size_t>(MAX_SCAN_THREADS, std::max(1u, std::thread::hardware_concurrency()) * 2);
+    }
+    threadCount = std::max<size_t>(1, std::min(threadCount, jobs.size()));
+
+    std::vector<RegionEntry> entries(jobs.size());
+    std::vector<uint8_t> succeeded(jobs.size(), 0);
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < jobs.size();
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            succeeded[i] = readHeader(jobs[i].path, config.trackTimestamps, entries[i]) ? 1 : 0;
+        }
+    };
+    if (threadCount <= 1) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount - 1);
+        for (size_t t = 1; t < threadCount; ++t) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    Stats stats;
+    stats.threads = jobs.empty() ? 0 : threadCount;
+    RegionMap regions;
+    regions.reserve(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        stats.regionsScanned++;
+        if (!succeeded[i]) {
+            stats.failedRegions++;
+            continue;
+        }
+        if (entries[i].present.none()) {
+            continue;
+        }
+        stats.chunksIndexed += entries[i].present.count();
+        regions.emplace(regionKey(jobs[i].worldId, jobs[i].regionX, jobs[i].regionZ), std::move(entries[i]));
+    }
+    stats.memoryBytes = regions.size() * entryBytes(config.trackTimestamps) +
+                        regions.bucket_count() * sizeof(void*);
+
+    {
+        std::unique_lock lock(mutex_);
+        trackTimestamps_ = config.trackTimestamps;
+        // 扫描期间的保存可能早于或晚于读取头部，重放后以在线更新为准
+        for (const Update& update : pendingUpdates_) {
+            applyLocked(regions, update);
+        }
+        pendingUpdates_.clear();
+        pendingUpdates_.shrink_to_fit();
+        building_ = false;
+        regions_ = std::move(regions);
+        indexedWorlds_.clear();
+        indexedWorlds_.insert(config.worldIds.begin(), config.worldIds.end());
+        stats.scanMicros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        lastBuild_ = stats;
+    }
+
+    if (stats.failedRegions > 0) {
+        fprintf(stderr, "[RegionIndex] %llu region headers could not be read under %s\n",
+                static_cast<unsigned long long>(stats.failedRegions), worldPath.c_str());
+    }
+    return stats;
+}
+
+void RegionIndex::applyLocked(RegionMap& regions, const Update& update) {
+    const uint64_t key = regionKey(update.worldId, regionOf(update.chunkX), regionOf(update.chunkZ));
+    const size_t index = localIndexOf(update.chunkX, update.chunkZ);
+    auto it = regions.find(key);
+    if (!update.present) {
+        if (it == regions.end() || !it->second.present.test(index)) {
+            return;
+        }
+        it->second.present.reset(index);
+        if (it->second.present.none()) {
+            regions.erase(it);
+        } else {
+            refreshBounds(it->second);
+        }
+        return;
+    }
+
+    if (it == regions.end()) {
+        it = regions.emplace(key, RegionEntry{}).first;
+        if (trackTimestamps_) {
+            it->second.timestamps = std::make_unique<uint32_t[]>(REGION_CHUNK_COUNT);
+        }
+    }
+    RegionEntry& entry = it->second;
+    const bool replaced = entry.present.test(index);
+    entry.present.set(index);
+    if (entry.timestamps) {
+        entry.timestamps[index] = update.timestamp;
+    }
+    if (replaced && entry.timestamps) {
+        // 覆盖的旧时间戳可能正是边界
+        refreshBounds(entry);
+    } else {
+        entry.minTimestamp = std::min(entry.minTimestamp, update.timestamp);
+        entry.maxTimestamp = std::max(entry.maxTimestamp, update.timestamp);
+    }
+}
+
+void RegionIndex::recordChunk(int worldId, int chunkX, int chunkZ, uint32_t timestamp) {
+    std::unique_lock lock(mutex_);
+    const Update update{worldId, chunkX, chunkZ, timestamp, true};
+    if (building_) {
+        pendingUpdates_.push_back(update);
+    }
+    applyLocked(regions_, update);
+}
+
+void RegionIndex::removeChunk(int worldId, int chunkX, int chunkZ) {
+    std::unique_lock lock(mutex_);
+    const Update update{worldId, chunkX, chunkZ, 0, false};
+    if (building_) {
+        pendingUpdates_.push_back(update);
+    }
+    applyLocked(regions_, update);
+}
+
+void RegionIndex::rescanRegion(int worldId, int regionX, int regionZ, const std::string& path) {
+    bool trackTimestamps;
+    {
+        std::shared_lock lock(mutex_);
+        if (!building_ && indexedWorlds_.count(worldId) == 0) {
+            return;
+        }
+        trackTimestamps = trackTimestamps_;
+    }
+
+    RegionEntry entry;
+    const bool ok = readHeader(path, trackTimestamps, entry);
+
+    std::unique_lock lock(mutex_);
+    const uint64_t key = regionKey(worldId, regionX, regionZ);
+    if (!ok || entry.present.none()) {
+        regions_.erase(key);
+    } else {
+        regions_[key] = std::move(entry);
+    }
+    if (building_) {
+        // 扫描结果可能比这次读取更旧：把整个region作为在线更新重放
+        auto it = regions_.find(key);
+        for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+            const int chunkX = regionX * 32 + static_cast<int>(index % 32);
+            const int chunkZ = regionZ * 32 + static_cast<int>(index / 32);
+            const bool present = it != regions_.end() && it->second.present.test(index);
+            const uint32_t timestamp = present && it->second.timestamps ? it->second.timestamps[index]
+                                                                        : (present ? it->second.maxTimestamp : 0);
+            pendingUpdates_.push_back(Update{worldId, chunkX, chunkZ, timestamp, present});
+        }
+    }
+}
+
+bool RegionIndex::isIndexed(int worldId) const {
+    std::shared_lock lock(mutex_);
+    return indexedWorlds_.count(worldId) != 0;
+}
+
+RegionIndex::Presence RegionIndex::chunkPresence(int worldId, int chunkX, int chunkZ) const {
+    std::shared_lock lock(mutex_);
+    if (indexedWorlds_.count(worldId) == 0) {
+        return Presence::UNKNOWN;
+    }
+    auto it = regions_.find(regionKey(worldId, regionOf(chunkX), regionOf(chunkZ)));
+    if (it == regions_.end()) {
+        return Presence::ABSENT;
+    }
+    return it->second.present.test(localIndexOf(chunkX, chunkZ)) ? Presence::PRESENT : Presence::ABSENT;
+}
+
+uint32_t RegionIndex::chunkTimestamp(int worldId, int chunkX, int chunkZ) const {
+    std::shared_lock lock(mutex_);
+    auto it = regions_.find(regionKey(worldId, regionOf(chunkX), regionOf(chunkZ)));
+    if (it == regions_.end() || !it->second.timestamps) {
+        return 0;
+    }
+    const size_t index = localIndexOf(chunkX, chunkZ);
+    return it->second.present.test(index) ? it->second.timestamps[index] : 0;
+}
+
+std::vector<std::pair<int, int>> RegionIndex::chunksSavedBefore(int worldId, uint32_t cutoff) const {
+    std::vector<uint64_t> keys;
+    std::vector<std::pair<int, int>> result;
+    std::shared_lock lock(mutex_);
+    for (const auto& [key, entry] : regions_) {
+        // 整个region都不早于cutoff时直接跳过
+        if (worldIdOf(key) == worldId && entry.minTimestamp < cutoff) {
+            keys.push_back(key);
+        }
+    }
+    std::sort(keys.begin(), keys.end(), [](uint64_t a, uint64_t b) {
+        return std::make_pair(regionXOf(a), regionZOf(a)) < std::make_pair(regionXOf(b), regionZOf(b));
+    });
+    for (const uint64_t key : keys) {
+        const RegionEntry& entry = regions_.at(key);
+        const int baseX = regionXOf(key) * 32;
+        const int baseZ = regionZOf(key) * 32;
+        for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+            if (!entry.present.test(index)) continue;
+            if (entry.timestamps && entry.timestamps[index] >= cutoff) continue;
+            result.emplace_back(baseX + static_cast<int>(index % 32), baseZ + static_cast<int>(index / 32));
+        }
+    }
+    return result;
+}
+
+void RegionIndex::forEachChunk(int worldId, const std::function<void(int, int, uint32_t)>& visit) const {
+    std::shared_lock lock(mutex_);
+    for (const auto& [key, entry] : regions_) {
+        if (worldIdOf(key) != worldId) continue;
+        const int baseX = regionXOf(key) * 32;
+        const int baseZ = regionZOf(key) * 32;
+        for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+            if (!entry.present.test(index)) continue;
+            visit(baseX + static_cast<int>(index % 32), baseZ + static_cast<int>(index / 32),
+                  entry.timestamps ? entry.timestamps[index] : 0);
+        }
+    }
+}
+
+size_t RegionIndex::chunkCount(int worldId) const {
+    std::shared_lock lock(mutex_);
+    size_t count = 0;
+    for (const auto& [key, entry] : regions_) {
+        if (worldIdOf(key) == worldId) {
+            count += entry.present.count();
+        }
+    }
+    return count;
+}
+
+size_t RegionIndex::regionCount(int worldId) const {
+    std::shared_lock lock(mutex_);
+    size_t count = 0;
+    for (const auto& [key, entry] : regions_) {
+        if (worldIdOf(key) == worldId) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void RegionIndex::clear() {
+    std::unique_lock lock(mutex_);
+    regions_.clear();
+    indexedWorlds_.clear();
+    pendingUpdates_.clear();
+}
+
+RegionIndex::Stats RegionIndex::getLastBuildStats() const {
+    std::shared_lock lock(mutex_);
+    return lastBuild_;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "region_file.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * RegionIndex - 启动时建立的区块存在位图与时间戳索引
+ *
+ * build()并行读取各维度region目录下每个.mca的8KB头部（位置表 + 时间戳表，每个文件一次pread），
+ * 之后"区块是否存在"和"哪些区块在某时间之前保存（需要升级）"都只查内存，不再逐个打开文件。
+ * 在线保存与批量导入通过recordChunk / rescanRegion保持索引最新；
+ * build()期间到达的更新先记下，扫描结束后重放到新索引上再替换。
+ *
+ * 每个region占用128字节位图，trackTimestamps时另加4KB的逐区块时间戳（5万个region约200MB）；
+ * 不记录逐区块时间戳时只保留每个region的最早/最晚时间戳，chunksSavedBefore按region粗略返回。
+ */
+class RegionIndex {
+public:
+    struct Config {
+        std::vector<int> worldIds{0, -1, 1};    // 按createAnvilFilePath的维度目录扫描
+        size_t threads = 0;                     // 0表示按CPU核数选择（I/O为主，取2倍核数，最多32）
+        bool trackTimestamps = true;
+    };
+
+    struct Stats {
+        uint64_t regionsScanned{0};
+        uint64_t failedRegions{0};          // 打不开或头部不完整（按空region处理）
+        uint64_t chunksIndexed{0};
+        uint64_t scanMicros{0};
+        size_t threads{0};
+        size_t memoryBytes{0};
+    };
+
+    enum class Presence : uint8_t {
+        ABSENT = 0,
+        PRESENT = 1,
+        UNKNOWN = 2         // 该维度没有建立索引，调用者需要自己读盘确认
+    };
+
+    RegionIndex() = default;
+
+    RegionIndex(const RegionIndex&) = delete;
+    RegionIndex& operator=(const RegionIndex&) = delete;
+
+    /**
+     * 扫描worldPath下config.worldIds的所有region头部并替换当前索引
+     * 可以重复调用（重新扫描）；与recordChunk / rescanRegion并发安全
+     */
+    Stats build(const std::string& worldPath, const Config& config);
+    Stats build(const std::string& worldPath) { return build(worldPath, Config{}); }
+
+    bool isIndexed(int worldId) const;
+    Presence chunkPresence(int worldId, int chunkX, int chunkZ) const;
+    // 区块保存时间戳；不存在、未建立索引或未记录逐区块时间戳时返回0
+    uint32_t chunkTimestamp(int worldId, int chunkX, int chunkZ) const;
+
+    /**
+     * 时间戳早于cutoff的区块坐标（用于批量升级）；region按坐标排序，region内按区块索引
+     * 未记录逐区块时间戳时返回最早时间戳早于cutoff的region中的全部区块（超集）
+     */
+    std::vector<std::pair<int, int>> chunksSavedBefore(int worldId, uint32_t cutoff) const;
+
+    // 遍历已索引的区块：visit(chunkX, chunkZ, timestamp)
+    void forEachChunk(int worldId, const std::function<void(int, int, uint32_t)>& visit) const;
+
+    size_t chunkCount(int worldId) const;
+    size_t regionCount(int worldId) const;
+
+    // 在线保存写入一个区块后调用（timestamp为写入region的时间戳）
+    void recordChunk(int worldId, int chunkX, int chunkZ, uint32_t timestamp);
+    void removeChunk(int worldId, int chunkX, int chunkZ);
+
+    // region文件被整体替换（批量导入、格式转换）后重新读取其头部
+    void rescanRegion(int worldId, int regionX, int regionZ, const std::string& path);
+
+    // 丢弃所有索引（切换世界路径时）
+    void clear();
+
+    Stats getLastBuildStats() const;
+
+private:
+    struct RegionEntry {
+        std::bitset<REGION_CHUNK_COUNT> present;
+        std::unique_ptr<uint32_t[]> timestamps;     // trackTimestamps时为REGION_CHUNK_COUNT项
+        uint32_t minTimestamp{UINT32_MAX};
+        uint32_t maxTimestamp{0};
+    };
+
+    struct Update {
+        int worldId;
+        int chunkX;
+        int chunkZ;
+        uint32_t timestamp;
+        bool present;
+    };
+
+    using RegionMap = std::unordered_map<uint64_t, RegionEntry>;
+
+    static uint64_t regionKey(int worldId, int regionX, int regionZ);
+    static int worldIdOf(uint64_t key) { return static_cast<int16_t>(key >> 48); }
+    static int regionXOf(uint64_t key) { return static_cast<int32_t>(static_cast<uint32_t>(key >> 24) << 8) >> 8; }
+    static int regionZOf(uint64_t key) { return static_cast<int32_t>(static_cast<uint32_t>(key) << 8) >> 8; }
+
+    // 读取一个文件的头部；文件不存在或不完整时返回false，entry保持为空
+    static bool readHeader(const std::string& path, bool trackTimestamps, RegionEntry& entry);
+    // 调用者持有mutex_（独占）
+    void applyLocked(RegionMap& regions, const Update& update);
+    static void refreshBounds(RegionEntry& entry);
+
+    mutable std::shared_mutex mutex_;
+    RegionMap regions_;
+    std::unordered_set<int> indexedWorlds_;
+    bool trackTimestamps_{true};
+
+    // build()期间的在线更新，扫描结束后重放
+    bool building_{false};
+    std::vector<Update> pendingUpdates_;
+    std::mutex buildMutex_;                 // build()串行
+
+    Stats lastBuild_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
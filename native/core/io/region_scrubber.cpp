@@ -0,0 +1,445 @@
+#include "region_scrubber.hpp"
+#include "region_file.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+// 超过该大小的region逐条读取记录，不整文件读入
+constexpr uint64_t MAX_IMAGE_BYTES = 64ull * 1024 * 1024;
+
+inline uint32_t readBigEndian32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+bool preadFully(int fd, uint8_t* data, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::pread(fd, data + done, size - done, offset + static_cast<off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (n == 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const uint8_t* data, size_t size) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = ::write(fd, data + done, size - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 原版定义的压缩ID（外部标志位除外）
+bool knownCompressionId(uint8_t regionId) {
+    return regionId == 1 || regionId == 2 || regionId == 3 || regionId == 4 || regionId == 127;
+}
+
+} // namespace
+
+// ===== RegionScrubber实现 =====
+
+RegionScrubber::RegionScrubber(const Config& config, ListRegions listRegions, AcquireRegion acquireRegion,
+                               VerifyRecord verifyRecord, BadChunkFound onBadChunk)
+    : config_(config)
+    , listRegions_(std::move(listRegions))
+    , acquireRegion_(std::move(acquireRegion))
+    , verifyRecord_(std::move(verifyRecord))
+    , onBadChunk_(std::move(onBadChunk)) {
+    if (config_.quarantine && config_.quarantineDirectory.empty()) {
+        throw std::invalid_argument("RegionScrubber quarantine requires a quarantine directory");
+    }
+}
+
+RegionScrubber::~RegionScrubber() {
+    stop();
+}
+
+void RegionScrubber::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_.load() || worker_.joinable()) {
+        return;
+    }
+    stopping_ = false;
+    running_.store(true);
+    worker_ = std::thread([this] { run(); });
+}
+
+void RegionScrubber::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    running_.store(false);
+}
+
+RegionScrubber::Stats RegionScrubber::scanOnce() {
+    scanPass(false);
+    return getStats();
+}
+
+RegionScrubber::Stats RegionScrubber::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::vector<RegionScrubber::BadChunk> RegionScrubber::getBadChunks() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return badChunks_;
+}
+
+const char* RegionScrubber::problemName(Problem problem) {
+    switch (problem) {
+        case Problem::OUT_OF_BOUNDS: return "out_of_bounds";
+        case Problem::BAD_LENGTH: return "bad_length";
+        case Problem::UNKNOWN_COMPRESSION: return "unknown_compression";
+        case Problem::CHECKSUM: return "checksum";
+        case Problem::MISSING_EXTERNAL: return "missing_external";
+    }
+    return "unknown";
+}
+
+void RegionScrubber::run() {
+    for (;;) {
+        scanPass(true);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_ || config_.rescanIntervalMillis == 0) break;
+        wakeup_.wait_for(lock, std::chrono::milliseconds(config_.rescanIntervalMillis),
+                         [this] { return stopping_; });
+        if (stopping_) break;
+    }
+    running_.store(false);
+}
+
+void RegionScrubber::scanPass(bool interruptible) {
+    std::lock_guard<std::mutex> passLock(passMutex_);
+    const auto start = std::chrono::steady_clock::now();
+    throttleStart_ = start;
+    throttledBytes_ = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        currentPass_.clear();
+    }
+
+    std::vector<RegionRef> regions;
+    try {
+        regions = listRegions_();
+    } catch (const std::exception& e) {
+        recordError(std::string("Failed to list regions: ") + e.what());
+    }
+
+    bool interrupted = false;
+    for (const auto& region : regions) {
+        if (interruptible) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (stopping_) {
+                interrupted = true;
+                break;
+            }
+        }
+        try {
+            scanRegion(region, interruptible);
+        } catch (const std::exception& e) {
+            recordError(region.path + ": " + e.what());
+        }
+    }
+
+    // 单个region可能很大，扫描结束后不保留
+    if (image_.capacity() > MAX_IMAGE_BYTES / 4) {
+        std::vector<uint8_t>().swap(image_);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    badChunks_ = std::move(currentPass_);
+    currentPass_.clear();
+    stats_.scanMicros = microsSince(start);
+    if (!interrupted) {
+        stats_.passes++;
+    }
+}
+
+void RegionScrubber::scanRegion(const RegionRef& region, bool interruptible) {
+    auto file = acquireRegion_(region.path);
+    if (!file || !file->isOpen()) {
+        return;
+    }
+
+    // 先取头部快照再读数据：快照之后改写的记录在确认阶段识别
+    const auto locations = file->getLocations();
+    struct stat st;
+    if (::fstat(file->fd(), &st) != 0) {
+        throw std::runtime_error(std::string("fstat failed: ") + strerror(errno));
+    }
+    const uint64_t fileSize = static_cast<uint64_t>(st.st_size);
+
+    // 整个文件一次顺序读入；过大的文件逐条读
+    const bool wholeFile = fileSize <= MAX_IMAGE_BYTES;
+    uint64_t bytesRead = 0;
+    if (wholeFile) {
+        image_.resize(static_cast<size_t>(fileSize));
+        if (fileSize > 0 && !preadFully(file->fd(), image_.data(), image_.size(), 0)) {
+            throw std::runtime_error(std::string("read failed: ") + strerror(errno));
+        }
+        bytesRead = fileSize;
+    }
+
+    std::vector<uint8_t> recordBuffer;
+    uint64_t verified = 0;
+    uint64_t unsupported = 0;
+    for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+        const uint32_t location = locations[index];
+        if (location == 0) continue;
+        const int localX = static_cast<int>(index % 32);
+        const int localZ = static_cast<int>(index / 32);
+
+        const uint64_t offset = static_cast<uint64_t>(RegionFile::sectorOffset(location)) * REGION_SECTOR_SIZE;
+        const uint64_t span = static_cast<uint64_t>(RegionFile::sectorCount(location)) * REGION_SECTOR_SIZE;
+        if (RegionFile::sectorOffset(location) < REGION_HEADER_SECTORS || span == 0 || offset >= fileSize) {
+            handleBadRecord(region, *file, localX, localZ, location, Problem::OUT_OF_BOUNDS, nullptr, 0);
+            continue;
+        }
+
+        // 末尾扇区可能没有写满
+        const size_t readable = static_cast<size_t>(std::min(span, fileSize - offset));
+        const uint8_t* record = nullptr;
+        if (wholeFile) {
+            record = image_.data() + offset;
+        } else {
+            recordBuffer.resize(readable);
+            if (!preadFully(file->fd(), recordBuffer.data(), readable, static_cast<off_t>(offset))) {
+                throw std::runtime_error(std::string("read failed: ") + strerror(errno));
+            }
+            record = recordBuffer.data();
+            bytesRead += readable;
+        }
+
+        const uint32_t length = readable >= REGION_CHUNK_HEADER_SIZE ? readBigEndian32(record) : 0;
+        if (length == 0 || static_cast<uint64_t>(length) + 4 > readable) {
+            handleBadRecord(region, *file, localX, localZ, location, Problem::BAD_LENGTH, record, readable);
+            continue;
+        }
+
+        const uint8_t regionId = record[4];
+        if ((regionId & 0x80) != 0) {
+            checkExternal(region, *file, localX, localZ, regionId);
+            continue;
+        }
+        if (!knownCompressionId(regionId)) {
+            handleBadRecord(region, *file, localX, localZ, location, Problem::UNKNOWN_COMPRESSION, record, readable);
+            continue;
+        }
+
+        const Verdict verdict = verifyRecord_(regionId, record + REGION_CHUNK_HEADER_SIZE, length - 1);
+        if (verdict == Verdict::OK) {
+            verified++;
+        } else if (verdict == Verdict::UNSUPPORTED) {
+            unsupported++;
+        } else {
+            handleBadRecord(region, *file, localX, localZ, location, Problem::CHECKSUM, record, readable);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.regionsScanned++;
+        stats_.chunksVerified += verified;
+        stats_.chunksUnsupported += unsupported;
+        stats_.bytesRead += bytesRead;
+    }
+    throttle(bytesRead, interruptible);
+}
+
+void RegionScrubber::handleBadRecord(const RegionRef& region, RegionFile& file, int localX, int localZ,
+                                     uint32_t location, Problem problem, const uint8_t* raw, size_t rawSize) {
+    // 通过在线句柄确认：读取的同时取得记录版本，之后只删除同一版本
+    std::vector<uint8_t> current;
+    RegionFile::RecordVersion version;
+    const bool readable = file.readChunkVersioned(localX, localZ, current, version);
+    bool changed = version.location != location;
+    if (!changed && readable && !current.empty() && knownCompressionId(current[0])) {
+        const Verdict verdict = verifyRecord_(current[0], current.data() + 1, current.size() - 1);
+        // 原地覆盖后不再损坏：快照读到的是写入中途的数据
+        changed = verdict != Verdict::CORRUPT;
+    }
+    if (changed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.conflicts++;
+        return;
+    }
+
+    BadChunk chunk;
+    chunk.path = region.path;
+    chunk.worldId = region.worldId;
+    chunk.chunkX = region.regionX * 32 + localX;
+    chunk.chunkZ = region.regionZ * 32 + localZ;
+    chunk.timestamp = file.getTimestamp(localX, localZ);
+    chunk.problem = problem;
+
+    if (config_.quarantine && quarantineRecord(chunk, raw, rawSize)) {
+        if (file.removeChunkIfUnchanged(localX, localZ, version)) {
+            chunk.quarantined = true;
+        } else {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.conflicts++;
+            return;
+        }
+    }
+    report(chunk);
+}
+
+void RegionScrubber::checkExternal(const RegionRef& region, RegionFile& file, int localX, int localZ,
+                                   uint8_t regionId) {
+    BadChunk chunk;
+    chunk.path = region.path;
+    chunk.worldId = region.worldId;
+    chunk.chunkX = region.regionX * 32 + localX;
+    chunk.chunkZ = region.regionZ * 32 + localZ;
+    chunk.timestamp = file.getTimestamp(localX, localZ);
+
+    const std::filesystem::path externalPath = std::filesystem::path(region.path).parent_path() /
+        ("c." + std::to_string(chunk.chunkX) + "." + std::to_string(chunk.chunkZ) + ".mcc");
+    std::vector<uint8_t> data;
+    const int fd = ::open(externalPath.c_str(), O_RDONLY | O_CLOEXEC);
+    bool ok = false;
+    if (fd >= 0) {
+        struct stat st;
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            data.resize(static_cast<size_t>(st.st_size));
+            ok = preadFully(fd, data.data(), data.size(), 0);
+        }
+        ::close(fd);
+    }
+    if (!ok) {
+        if (!file.hasChunk(localX, localZ)) {
+            return;
+        }
+        chunk.problem = Problem::MISSING_EXTERNAL;
+        report(chunk);
+        return;
+    }
+
+    const uint8_t baseId = regionId & 0x7F;
+    const Verdict verdict = knownCompressionId(baseId) ? verifyRecord_(baseId, data.data(), data.size())
+                                                        : Verdict::CORRUPT;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.bytesRead += data.size();
+        if (verdict == Verdict::OK) {
+            stats_.chunksVerified++;
+            return;
+        }
+        if (verdict == Verdict::UNSUPPORTED) {
+            stats_.chunksUnsupported++;
+            return;
+        }
+    }
+    chunk.problem = knownCompressionId(baseId) ? Problem::CHECKSUM : Problem::UNKNOWN_COMPRESSION;
+    report(chunk);
+}
+
+bool RegionScrubber::quarantineRecord(const BadChunk& chunk, const uint8_t* raw, size_t rawSize) {
+    namespace fs = std::filesystem;
+    const fs::path directory = fs::path(config_.quarantineDirectory) / std::to_string(chunk.worldId);
+    const fs::path target = directory / ("c." + std::to_string(chunk.chunkX) + "." + std::to_string(chunk.chunkZ) +
+                                         "." + std::to_string(chunk.timestamp) + ".bin");
+    std::error_code ec;
+    fs::create_directories(directory, ec);
+    if (ec) {
+        recordError("Failed to create " + directory.string() + ": " + ec.message());
+        return false;
+    }
+    // 原始扇区内容（超出文件范围的记录没有可保存的数据，只留下空文件作为记录）
+    const int fd = ::open(target.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        recordError("Failed to create " + target.string() + ": " + strerror(errno));
+        return false;
+    }
+    const bool ok = (rawSize == 0 || writeFully(fd, raw, rawSize)) && ::fsync(fd) == 0;
+    const int savedErrno = errno;
+    ::close(fd);
+    if (!ok) {
+        ::unlink(target.c_str());
+        recordError("Failed to write " + target.string() + ": " + strerror(savedErrno));
+    }
+    return ok;
+}
+
+void RegionScrubber::report(const BadChunk& chunk) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.badChunks++;
+        if (chunk.quarantined) {
+            stats_.chunksQuarantined++;
+        }
+        if (currentPass_.size() < config_.maxReported) {
+            currentPass_.push_back(chunk);
+        }
+    }
+    fprintf(stderr, "[RegionScrubber] Corrupt chunk %d,%d in %s (%s)%s\n", chunk.chunkX, chunk.chunkZ,
+            chunk.path.c_str(), problemName(chunk.problem), chunk.quarantined ? ", quarantined" : "");
+    if (onBadChunk_) {
+        onBadChunk_(chunk);
+    }
+}
+
+bool RegionScrubber::throttle(uint64_t bytesRead, bool interruptible) {
+    if (config_.maxBytesPerSecond == 0) {
+        return true;
+    }
+    throttledBytes_ += bytesRead;
+    const uint64_t due = throttledBytes_ * 1000000 / config_.maxBytesPerSecond;
+    const uint64_t elapsed = microsSince(throttleStart_);
+    if (due <= elapsed) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!interruptible) {
+        lock.unlock();
+        std::this_thread::sleep_for(std::chrono::microseconds(due - elapsed));
+        return true;
+    }
+    return !wakeup_.wait_for(lock, std::chrono::microseconds(due - elapsed), [this] { return stopping_; });
+}
+
+void RegionScrubber::recordError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.errors++;
+    stats_.lastError = message;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
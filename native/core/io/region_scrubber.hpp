@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "region_defragmenter.hpp"
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+class RegionFile;
+
+/**
+ * RegionScrubber - 在线扫描region文件中的损坏区块
+ *
+ * 后台线程逐个region顺序读取整个文件（一次pread），按头部快照检查每条记录：
+ * 扇区范围、长度字段、压缩ID，然后用MinecraftCompressor::verifyRecord校验和检查（不解析NBT）。
+ * 外部.mcc记录读取对应的c.X.Z.mcc一并校验。
+ *
+ * 与在线保存共用region句柄：快照中判为损坏的记录会通过句柄重新读取确认，
+ * 期间被保存覆盖的区块计入conflicts，不报告。quarantine时把损坏记录的原始字节写到
+ * quarantineDirectory/<worldId>/c.<x>.<z>.<时间戳>.bin，再在记录未变化的前提下从region中删除，
+ * 之后加载该区块会按未生成处理；外部.mcc记录只报告不删除。
+ *
+ * maxBytesPerSecond限制读取速度（0表示不限，按磁盘速度扫描）。
+ */
+class RegionScrubber {
+public:
+    struct Config {
+        uint64_t maxBytesPerSecond = 0;
+        bool quarantine = false;
+        std::string quarantineDirectory;         // quarantine时必须设置
+        uint64_t rescanIntervalMillis = 0;       // 0表示start()后只扫描一轮
+        size_t maxReported = 4096;               // getBadChunks()保留的条数
+    };
+
+    enum class Problem : uint8_t {
+        OUT_OF_BOUNDS = 0,          // 扇区范围与头部重叠或超出文件
+        BAD_LENGTH = 1,             // 长度字段为0或超过扇区跨度
+        UNKNOWN_COMPRESSION = 2,
+        CHECKSUM = 3,               // 解压失败、校验和不符或不是完整的复合标签
+        MISSING_EXTERNAL = 4        // 外部.mcc文件不存在或不可读
+    };
+
+    struct BadChunk {
+        std::string path;
+        int worldId{0};
+        int chunkX{0};
+        int chunkZ{0};
+        uint32_t timestamp{0};
+        Problem problem{Problem::CHECKSUM};
+        bool quarantined{false};
+    };
+
+    struct Stats {
+        uint64_t passes{0};
+        uint64_t regionsScanned{0};
+        uint64_t chunksVerified{0};
+        uint64_t chunksUnsupported{0};   // 当前构建无法校验的压缩类型
+        uint64_t badChunks{0};
+        uint64_t chunksQuarantined{0};
+        uint64_t conflicts{0};           // 确认前被并发保存或删除
+        uint64_t bytesRead{0};
+        uint64_t scanMicros{0};          // 最近一轮的耗时
+        uint64_t errors{0};
+        std::string lastError;
+    };
+
+    using RegionRef = RegionDefragmenter::RegionRef;
+    using ListRegions = RegionDefragmenter::ListRegions;
+    using AcquireRegion = RegionDefragmenter::AcquireRegion;
+    // 与MinecraftCompressor::RecordIntegrity一一对应
+    enum class Verdict : uint8_t {
+        OK = 0,
+        CORRUPT = 1,
+        UNSUPPORTED = 2
+    };
+
+    // 校验一条记录：regionId为region中的压缩ID（不含外部标志）
+    using VerifyRecord = std::function<Verdict(uint8_t regionId, const uint8_t* payload, size_t size)>;
+    // 发现（并按配置隔离）损坏区块后调用（扫描线程）
+    using BadChunkFound = std::function<void(const BadChunk& chunk)>;
+
+    RegionScrubber(const Config& config, ListRegions listRegions, AcquireRegion acquireRegion,
+                   VerifyRecord verifyRecord, BadChunkFound onBadChunk = nullptr);
+    ~RegionScrubber();
+
+    RegionScrubber(const RegionScrubber&) = delete;
+    RegionScrubber& operator=(const RegionScrubber&) = delete;
+
+    void start();
+    // 当前region扫描完后退出；可重复调用
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    // 在调用线程上同步扫描一轮（离线工具使用）；后台线程运行时两者串行
+    Stats scanOnce();
+
+    Stats getStats() const;
+    // 最近一轮发现的损坏区块（最多maxReported条）
+    std::vector<BadChunk> getBadChunks() const;
+
+    static const char* problemName(Problem problem);
+
+private:
+    void run();
+    // interruptible为false时（scanOnce）不响应stop()
+    void scanPass(bool interruptible);
+    void scanRegion(const RegionRef& region, bool interruptible);
+    // 确认并处理一条快照中损坏的记录
+    void handleBadRecord(const RegionRef& region, RegionFile& file, int localX, int localZ, uint32_t location,
+                         Problem problem, const uint8_t* raw, size_t rawSize);
+    // 外部.mcc记录：只报告，不通过句柄确认或隔离
+    void checkExternal(const RegionRef& region, RegionFile& file, int localX, int localZ, uint8_t regionId);
+    bool quarantineRecord(const BadChunk& chunk, const uint8_t* raw, size_t rawSize);
+    void report(const BadChunk& chunk);
+    // 按maxBytesPerSecond等待；停止时返回false
+    bool throttle(uint64_t bytesRead, bool interruptible);
+    void recordError(const std::string& message);
+
+    Config config_;
+    ListRegions listRegions_;
+    AcquireRegion acquireRegion_;
+    VerifyRecord verifyRecord_;
+    BadChunkFound onBadChunk_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_{false};
+    std::atomic<bool> running_{false};
+    Stats stats_;
+    std::vector<BadChunk> badChunks_;         // 最近一轮
+    std::vector<BadChunk> currentPass_;
+
+    // scanOnce与后台线程串行
+    std::mutex passMutex_;
+    std::chrono::steady_clock::time_point throttleStart_;
+    uint64_t throttledBytes_{0};
+    std::vector<uint8_t> image_;              // 当前region的文件内容，扫描线程复用
+
+    std::thread worker_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,166 @@
+#include "save_pipeline.hpp"
+#include "../native_runtime.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <thread>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+constexpr size_t DEFAULT_MAX_WRITER_THREADS = 4;
+
+} // namespace
+
+SavePipeline::SavePipeline(const Config& config)
+    : config_(config),
+      serializeQueue_(config.queueCapacity),
+      compressQueue_(config.queueCapacity) {
+    const size_t hw = std::max(1u, std::thread::hardware_concurrency());
+    serializeWorkers_ = config_.serializeWorkers ? config_.serializeWorkers : std::max<size_t>(1, hw / 4);
+    compressWorkers_ = config_.compressWorkers ? config_.compressWorkers : std::max<size_t>(1, hw / 2);
+    writers_ = config_.writerThreads ? config_.writerThreads : DEFAULT_MAX_WRITER_THREADS;
+    writeQueues_.reserve(writers_);
+    for (size_t i = 0; i < writers_; ++i) {
+        writeQueues_.push_back(std::make_unique<BoundedQueue<Task>>(config_.queueCapacity));
+    }
+}
+
+SavePipeline::~SavePipeline() {
+    // 此时没有进行中的run()；依次关闭各阶段，工作线程取完剩余任务后退出
+    serializeQueue_.close();
+    compressQueue_.close();
+    for (auto& queue : writeQueues_) {
+        queue->close();
+    }
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void SavePipeline::start() {
+    auto& runtime = core::NativeRuntime::instance();
+    threads_.reserve(serializeWorkers_ + compressWorkers_ + writers_);
+
+    for (size_t i = 0; i < serializeWorkers_; ++i) {
+        threads_.push_back(runtime.startThread(core::NativeSubsystem::CHUNK_IO, [this] {
+            Task task;
+            while (serializeQueue_.pop(task)) {
+                runStage(task.batch->stages->serialize, *task.job, task.batch->serializeMicros);
+                if (!compressQueue_.push(task)) {
+                    abandonTask(task);
+                }
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < compressWorkers_; ++i) {
+        threads_.push_back(runtime.startThread(core::NativeSubsystem::CHUNK_IO, [this] {
+            Task task;
+            while (compressQueue_.pop(task)) {
+                runStage(task.batch->stages->compress, *task.job, task.batch->compressMicros);
+                if (!writeQueues_[task.writer]->push(task)) {
+                    abandonTask(task);
+                }
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < writers_; ++i) {
+        threads_.push_back(runtime.startThread(core::NativeSubsystem::CHUNK_IO, [this, i] {
+            Task task;
+            while (writeQueues_[i]->pop(task)) {
+                runStage(task.batch->stages->write, *task.job, task.batch->writeMicros);
+                finishTask(*task.batch);
+            }
+        }));
+    }
+}
+
+void SavePipeline::finishTask(Batch& batch) {
+    std::lock_guard<std::mutex> lock(batch.mutex);
+    if (--batch.remaining == 0) {
+        batch.done.notify_all();
+    }
+}
+
+void SavePipeline::abandonTask(Task& task) {
+    task.job->failed = true;
+    task.job->errorMessage = "Save pipeline is shutting down";
+    finishTask(*task.batch);
+}
+
+void SavePipeline::runStage(const StageFunction& stage, Job& job, std::atomic<uint64_t>& micros) {
+    if (job.failed || !stage) {
+        return;
+    }
+
+    const uint64_t start = nowMicros();
+    try {
+        stage(job);
+    } catch (const std::exception& e) {
+        job.failed = true;
+        job.errorMessage = e.what();
+    } catch (...) {
+        job.failed = true;
+        job.errorMessage = "Unknown error in save pipeline";
+    }
+    micros.fetch_add(nowMicros() - start, std::memory_order_relaxed);
+}
+
+SavePipeline::StageStats SavePipeline::run(std::vector<Job>& jobs, const Stages& stages) {
+    StageStats stats;
+    stats.jobs = jobs.size();
+    if (jobs.empty()) {
+        return stats;
+    }
+
+    const uint64_t startTime = nowMicros();
+    Batch batch;
+    batch.stages = &stages;
+
+    if (jobs.size() < config_.inlineThreshold) {
+        // 小批次：交给工作线程的调度开销高于并行收益，顺序执行
+        for (auto& job : jobs) {
+            runStage(stages.serialize, job, batch.serializeMicros);
+            runStage(stages.compress, job, batch.compressMicros);
+            runStage(stages.write, job, batch.writeMicros);
+        }
+    } else {
+        std::call_once(started_, [this] { start(); });
+
+        batch.remaining = jobs.size();
+        const std::hash<std::string> hashPath;
+        // 调用线程作为投递者，序列化队列满时在此阻塞
+        for (auto& job : jobs) {
+            Task task{&job, &batch, hashPath(job.regionPath) % writers_};
+            if (!serializeQueue_.push(task)) {
+                abandonTask(task);
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(batch.mutex);
+        batch.done.wait(lock, [&batch] { return batch.remaining == 0; });
+    }
+
+    stats.serializeMicros = batch.serializeMicros.load();
+    stats.compressMicros = batch.compressMicros.load();
+    stats.writeMicros = batch.writeMicros.load();
+    stats.wallMicros = nowMicros() - startTime;
+    stats.failed = static_cast<size_t>(std::count_if(jobs.begin(), jobs.end(),
+                                                     [](const Job& job) { return job.failed; }));
+    return stats;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
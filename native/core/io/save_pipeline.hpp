@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+struct AnvilChunkData;
+
+/**
+ * BoundedQueue - 有界阻塞队列
+ * 队列满时push阻塞（向上游施加背压），close()后pop取完剩余元素返回false
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        out = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    const size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::deque<T> items_;
+    bool closed_ = false;
+};
+
+/**
+ * SavePipeline - 区块保存流水线：序列化 → 压缩 → 写入
+ *
+ * 三个阶段由有界队列连接并行执行：序列化N个工作线程，压缩M个工作线程，
+ * 写入阶段按region路径哈希分片，保证每个region文件只有一个写线程（多个批次并发run时也是如此）。
+ * 批次吞吐受最慢阶段限制，而不是三个阶段耗时之和。
+ *
+ * 工作线程在第一次并行执行时启动并常驻，之后的批次复用它们，析构时退出；
+ * 各批次的阶段函数随任务传递，可以从多个线程同时调用run。
+ *
+ * 阶段函数抛出异常时任务标记为失败，后续阶段跳过该任务。
+ */
+class SavePipeline {
+public:
+    struct Config {
+        size_t serializeWorkers = 0;     // 0表示按CPU核数自动选择
+        size_t compressWorkers = 0;
+        size_t writerThreads = 0;        // 0表示DEFAULT_MAX_WRITER_THREADS
+        size_t queueCapacity = 64;       // 每个阶段间队列的容量
+        size_t inlineThreshold = 4;      // 小于该数量的批次在调用线程内顺序执行
+    };
+
+    struct Job {
+        size_t index = 0;                         // 在调用者结果数组中的位置
+        std::shared_ptr<AnvilChunkData> chunk;
+        std::string regionPath;                   // 写入阶段的分片键
+        int localX = 0;
+        int localZ = 0;
+
+        std::vector<uint8_t> nbt;                 // 序列化阶段输出（为空时使用chunk->data）
+        std::vector<uint8_t> framed;              // 压缩阶段输出：类型字节 + 负载
+
+        bool failed = false;
+        std::string errorMessage;
+    };
+
+    using StageFunction = std::function<void(Job&)>;
+
+    struct Stages {
+        StageFunction serialize;
+        StageFunction compress;
+        StageFunction write;
+    };
+
+    // 一次run()各阶段累计耗时（微秒，所有工作线程之和）
+    struct StageStats {
+        uint64_t serializeMicros{0};
+        uint64_t compressMicros{0};
+        uint64_t writeMicros{0};
+        uint64_t wallMicros{0};
+        size_t jobs{0};
+        size_t failed{0};
+    };
+
+    explicit SavePipeline(const Config& config);
+    ~SavePipeline();
+
+    SavePipeline(const SavePipeline&) = delete;
+    SavePipeline& operator=(const SavePipeline&) = delete;
+
+    /**
+     * 执行一批任务，阻塞至所有任务完成
+     * 任务在原位更新（failed / errorMessage）
+     */
+    StageStats run(std::vector<Job>& jobs, const Stages& stages);
+
+    const Config& config() const { return config_; }
+
+private:
+    // 一次run()的共享状态：写入阶段完成最后一个任务时唤醒调用者
+    struct Batch {
+        const Stages* stages = nullptr;
+        std::atomic<uint64_t> serializeMicros{0};
+        std::atomic<uint64_t> compressMicros{0};
+        std::atomic<uint64_t> writeMicros{0};
+        size_t remaining = 0;                     // 由mutex保护，调用者看到0之后才能销毁Batch
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+
+    struct Task {
+        Job* job = nullptr;
+        Batch* batch = nullptr;
+        size_t writer = 0;
+    };
+
+    Config config_;
+    size_t serializeWorkers_ = 0;
+    size_t compressWorkers_ = 0;
+    size_t writers_ = 0;
+
+    std::once_flag started_;
+    BoundedQueue<Task> serializeQueue_;
+    BoundedQueue<Task> compressQueue_;
+    std::vector<std::unique_ptr<BoundedQueue<Task>>> writeQueues_;
+    std::vector<std::thread> threads_;
+
+    void start();
+    static void finishTask(Batch& batch);
+    // 流水线关闭、任务无法进入下一阶段
+    static void abandonTask(Task& task);
+    static void runStage(const StageFunction& stage, Job& job, std::atomic<uint64_t>& micros);
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
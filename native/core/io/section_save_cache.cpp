@@ -0,0 +1,270 @@
+#include "section_save_cache.hpp"
+#include "chunk_codecs.hpp"
+#include "hot_chunk_cache.hpp"
+#include <stdexcept>
+#include <string_view>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+constexpr uint8_t TAG_END = 0;
+constexpr uint8_t TAG_LIST = 9;
+constexpr uint8_t TAG_COMPOUND = 10;
+constexpr uint8_t TAG_LONG_ARRAY = 12;
+constexpr std::string_view SECTIONS_NAME = "sections";
+constexpr std::string_view BLOCK_ENTITIES_NAME = "block_entities";
+constexpr size_t ENTRY_OVERHEAD = 96;
+
+inline void appendBigEndian16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline void appendBigEndian32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 24));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+inline void appendTagHeader(std::vector<uint8_t>& out, uint8_t type, std::string_view name) {
+    out.push_back(type);
+    appendBigEndian16(out, static_cast<uint16_t>(name.size()));
+    out.insert(out.end(), name.begin(), name.end());
+}
+
+inline void appendBytes(std::vector<uint8_t>& out, const std::vector<uint8_t>& bytes) {
+    out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+// 片段格式的最低限度检查：只校验拼接边界，内部结构由Java侧编码保证
+void validateDelta(const ChunkDelta& delta) {
+    for (const auto& [index, bytes] : delta.dirtySections) {
+        if (index >= delta.sectionCount) {
+            throw std::invalid_argument("Section index out of range");
+        }
+        if (bytes.empty() || bytes.back() != TAG_END) {
+            throw std::invalid_argument("Section payload must end with TAG_End");
+        }
+    }
+    if (delta.hasBlockEntities &&
+        (delta.blockEntities.size() < 5 || delta.blockEntities[0] > TAG_LONG_ARRAY)) {
+        throw std::invalid_argument("Invalid block_entities list payload");
+    }
+    if (delta.hasHeader && !delta.header.empty() && delta.header[0] == TAG_END) {
+        throw std::invalid_argument("Chunk header must not contain TAG_End");
+    }
+}
+
+// 增量是否包含重建基线所需的全部部分
+bool coversEverything(const ChunkDelta& delta) {
+    if (!delta.hasHeader || !delta.hasBlockEntities) {
+        return false;
+    }
+    std::vector<bool> seen(delta.sectionCount, false);
+    size_t covered = 0;
+    for (const auto& [index, bytes] : delta.dirtySections) {
+        if (index < seen.size() && !seen[index]) {
+            seen[index] = true;
+            covered++;
+        }
+    }
+    return covered == delta.sectionCount;
+}
+
+} // namespace
+
+// ===== SectionSaveCache实现 =====
+
+SectionSaveCache::SectionSaveCache(size_t byteBudget)
+    : byteBudget_(byteBudget) {
+}
+
+uint64_t SectionSaveCache::fingerprint(const uint8_t* data, size_t size) {
+    return (static_cast<uint64_t>(codec::xxHash32(data, size, 0)) << 32) |
+           codec::xxHash32(data, size, 0x9E3779B1u);
+}
+
+SectionSaveCache::DeltaResult SectionSaveCache::applyDelta(const ChunkDelta& delta, std::vector<uint8_t>& nbtOut) {
+    validateDelta(delta);
+    const uint64_t key = HotChunkCache::packKey(delta.worldId, delta.chunkX, delta.chunkZ);
+    const bool complete = coversEverything(delta);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (!complete && (it == entries_.end() || !it->second.hasBaseline ||
+                      it->second.sections.size() != delta.sectionCount)) {
+        stats_.needsFull++;
+        return DeltaResult::NEEDS_FULL;
+    }
+
+    Entry& entry = touchLocked(key);
+    if (complete) {
+        entry.sections.assign(delta.sectionCount, {});
+    }
+
+    // 合并脏部分
+    if (delta.hasHeader) {
+        entry.header = delta.header;
+    }
+    if (delta.hasBlockEntities) {
+        entry.blockEntities = delta.blockEntities;
+    }
+    std::vector<bool> encoded(delta.sectionCount, false);
+    for (const auto& [index, bytes] : delta.dirtySections) {
+        entry.sections[index] = bytes;
+        encoded[index] = true;
+    }
+    for (bool dirty : encoded) {
+        if (dirty) {
+            stats_.sectionsEncoded++;
+        } else {
+            stats_.sectionsReused++;
+        }
+    }
+    entry.hasBaseline = true;
+
+    // 组装：根复合标签 { header..., sections: [...], block_entities: [...] }
+    size_t total = 3 + entry.header.size() + 1;
+    total += 3 + SECTIONS_NAME.size() + 5;
+    for (const auto& section : entry.sections) {
+        total += section.size();
+    }
+    total += 3 + BLOCK_ENTITIES_NAME.size() + entry.blockEntities.size();
+
+    nbtOut.clear();
+    nbtOut.reserve(total);
+    appendTagHeader(nbtOut, TAG_COMPOUND, "");
+    appendBytes(nbtOut, entry.header);
+    appendTagHeader(nbtOut, TAG_LIST, SECTIONS_NAME);
+    nbtOut.push_back(entry.sections.empty() ? TAG_END : TAG_COMPOUND);
+    appendBigEndian32(nbtOut, static_cast<uint32_t>(entry.sections.size()));
+    for (const auto& section : entry.sections) {
+        appendBytes(nbtOut, section);
+    }
+    appendTagHeader(nbtOut, TAG_LIST, BLOCK_ENTITIES_NAME);
+    appendBytes(nbtOut, entry.blockEntities);
+    nbtOut.push_back(TAG_END);
+
+    // 标记为脏但字节未变（例如方块被放下又挖掉）
+    const uint64_t print = fingerprint(nbtOut.data(), nbtOut.size());
+    const bool unchanged = entry.nbtSize == nbtOut.size() && entry.fingerprint == print;
+    entry.fingerprint = print;
+    entry.nbtSize = nbtOut.size();
+    accountLocked(entry);
+    evictLocked();
+
+    if (unchanged) {
+        stats_.unchanged++;
+        nbtOut.clear();
+        return DeltaResult::UNCHANGED;
+    }
+    stats_.assembled++;
+    return DeltaResult::ASSEMBLED;
+}
+
+bool SectionSaveCache::isUnchanged(int worldId, int chunkX, int chunkZ, const uint8_t* nbt, size_t size) {
+    const uint64_t key = HotChunkCache::packKey(worldId, chunkX, chunkZ);
+    const uint64_t print = fingerprint(nbt, size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.nbtSize != size || it->second.fingerprint != print) {
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+    stats_.unchanged++;
+    return true;
+}
+
+void SectionSaveCache::recordFullSave(int worldId, int chunkX, int chunkZ, const uint8_t* nbt, size_t size) {
+    const uint64_t key = HotChunkCache::packKey(worldId, chunkX, chunkZ);
+    const uint64_t print = fingerprint(nbt, size);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = touchLocked(key);
+    entry.hasBaseline = false;
+    entry.header.clear();
+    entry.sections.clear();
+    entry.blockEntities.clear();
+    entry.fingerprint = print;
+    entry.nbtSize = size;
+    accountLocked(entry);
+    evictLocked();
+}
+
+void SectionSaveCache::forget(int worldId, int chunkX, int chunkZ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(HotChunkCache::packKey(worldId, chunkX, chunkZ));
+    if (it != entries_.end()) {
+        bytes_ -= it->second.bytes;
+        lru_.erase(it->second.lruPos);
+        entries_.erase(it);
+    }
+}
+
+void SectionSaveCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+void SectionSaveCache::setByteBudget(size_t byteBudget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    byteBudget_ = byteBudget;
+    evictLocked();
+}
+
+SectionSaveCache::Stats SectionSaveCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    stats.bytes = bytes_;
+    return stats;
+}
+
+SectionSaveCache::Entry& SectionSaveCache::touchLocked(uint64_t key) {
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.lruPos);
+        return it->second;
+    }
+    lru_.push_front(key);
+    Entry& entry = entries_[key];
+    entry.lruPos = lru_.begin();
+    return entry;
+}
+
+void SectionSaveCache::accountLocked(Entry& entry) {
+    bytes_ -= entry.bytes;
+    entry.bytes = baselineBytes(entry) + ENTRY_OVERHEAD;
+    bytes_ += entry.bytes;
+}
+
+void SectionSaveCache::evictLocked() {
+    // 保留最近使用的条目，即使它单独超过预算
+    while (bytes_ > byteBudget_ && lru_.size() > 1) {
+        auto it = entries_.find(lru_.back());
+        if (it != entries_.end()) {
+            bytes_ -= it->second.bytes;
+            entries_.erase(it);
+        }
+        lru_.pop_back();
+    }
+}
+
+size_t SectionSaveCache::baselineBytes(const Entry& entry) {
+    size_t bytes = entry.header.size() + entry.blockEntities.size();
+    for (const auto& section : entry.sections) {
+        bytes += section.size();
+    }
+    return bytes;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * ChunkDelta - 一次增量保存中Java侧重新编码的部分
+ *
+ * 各部分都是NBT片段的原始字节：
+ * - header：根复合标签中除sections / block_entities以外的命名标签序列（不含END）
+ * - dirtySections：(段索引, 段复合标签负载)，负载以END结尾，索引从最低段开始计数
+ * - blockEntities："block_entities"列表标签的负载（元素类型 + 数量 + 元素）
+ * hasHeader / hasBlockEntities为false表示该部分自上次保存以来未变。
+ */
+struct ChunkDelta {
+    int worldId{0};
+    int chunkX{0};
+    int chunkZ{0};
+    uint32_t timestamp{0};
+    size_t sectionCount{0};
+
+    bool hasHeader{false};
+    std::vector<uint8_t> header;
+    std::vector<std::pair<size_t, std::vector<uint8_t>>> dirtySections;
+    bool hasBlockEntities{false};
+    std::vector<uint8_t> blockEntities;
+};
+
+/**
+ * SectionSaveCache - 增量保存的每区块基线
+ *
+ * 缓存每个区块上次保存时各段的NBT字节，增量保存只需Java重新编码脏段，
+ * 其余部分直接拼接；同时记录整块NBT的内容指纹，内容未变的保存直接跳过。
+ * 按字节预算LRU淘汰；基线被淘汰或从未建立时，增量保存返回NEEDS_FULL，
+ * 由调用者提交一次完整的增量（所有段 + header + block_entities）。
+ */
+class SectionSaveCache {
+public:
+    static constexpr size_t DEFAULT_BYTE_BUDGET = 128 * 1024 * 1024;
+
+    enum class DeltaResult : uint8_t {
+        ASSEMBLED = 0,      // nbtOut为需要写入的完整区块NBT
+        UNCHANGED = 1,      // 与上次保存内容相同，无需写入
+        NEEDS_FULL = 2      // 缺少基线，需要完整提交
+    };
+
+    struct Stats {
+        uint64_t assembled{0};
+        uint64_t unchanged{0};          // 增量与整块保存中跳过的次数之和
+        uint64_t needsFull{0};
+        uint64_t sectionsReused{0};
+        uint64_t sectionsEncoded{0};
+        size_t entries{0};
+        size_t bytes{0};
+    };
+
+    explicit SectionSaveCache(size_t byteBudget = DEFAULT_BYTE_BUDGET);
+
+    SectionSaveCache(const SectionSaveCache&) = delete;
+    SectionSaveCache& operator=(const SectionSaveCache&) = delete;
+
+    /**
+     * 合并增量并组装完整区块NBT，更新基线
+     * 片段格式无效时抛出std::invalid_argument
+     */
+    DeltaResult applyDelta(const ChunkDelta& delta, std::vector<uint8_t>& nbtOut);
+
+    // 整块保存：内容与上次记录相同时返回true
+    bool isUnchanged(int worldId, int chunkX, int chunkZ, const uint8_t* nbt, size_t size);
+
+    // 整块保存成功后记录指纹；段基线随之失效（无法从整块字节中拆出）
+    void recordFullSave(int worldId, int chunkX, int chunkZ, const uint8_t* nbt, size_t size);
+
+    // 写入失败或区块卸载时丢弃基线
+    void forget(int worldId, int chunkX, int chunkZ);
+    void clear();
+
+    void setByteBudget(size_t byteBudget);
+    Stats getStats() const;
+
+    // 内容指纹（两个不同种子的XXH32拼接）
+    static uint64_t fingerprint(const uint8_t* data, size_t size);
+
+private:
+    using LruList = std::list<uint64_t>;
+
+    struct Entry {
+        uint64_t fingerprint{0};
+        size_t nbtSize{0};
+        bool hasBaseline{false};
+        std::vector<uint8_t> header;
+        std::vector<std::vector<uint8_t>> sections;
+        std::vector<uint8_t> blockEntities;
+        size_t bytes{0};
+        LruList::iterator lruPos;
+    };
+
+    // 以下函数要求持有mutex_
+    Entry& touchLocked(uint64_t key);
+    void accountLocked(Entry& entry);
+    void evictLocked();
+
+    static size_t baselineBytes(const Entry& entry);
+
+    mutable std::mutex mutex_;
+    size_t byteBudget_;
+    size_t bytes_{0};
+    LruList lru_;                                   // 头部 = 最近使用
+    std::unordered_map<uint64_t, Entry> entries_;
+    Stats stats_;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
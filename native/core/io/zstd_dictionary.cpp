@@ -0,0 +1,362 @@
+#include "zstd_dictionary.hpp"
+#include "anvil_format.hpp"
+#include "region_file.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(LATTICE_HAS_ZSTD)
+#include <zstd.h>
+#include <zdict.h>
+#endif
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+namespace {
+
+// 训练至少需要的样本数（ZDICT对过少样本直接报错）
+constexpr size_t MIN_TRAINING_SAMPLES = 16;
+
+std::vector<std::string> listRegionFiles(const std::string& worldPath) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> files;
+    std::error_code ec;
+
+    for (const char* dimension : {"", "DIM-1/", "DIM1/"}) {
+        fs::path regionDir = fs::path(worldPath) / (std::string(dimension) + "region");
+        if (!fs::is_directory(regionDir, ec)) {
+            continue;
+        }
+        for (const auto& entry : fs::directory_iterator(regionDir, ec)) {
+            if (entry.is_regular_file(ec) && entry.path().extension() == ".mca") {
+                files.push_back(entry.path().string());
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// 存档文件名：lattice_zstd.<id>.dict
+constexpr const char* ARCHIVE_PREFIX = "lattice_zstd.";
+constexpr const char* ARCHIVE_SUFFIX = ".dict";
+
+bool parseArchiveId(const std::string& name, uint32_t& id) {
+    const size_t prefix = std::strlen(ARCHIVE_PREFIX);
+    const size_t suffix = std::strlen(ARCHIVE_SUFFIX);
+    if (name.size() <= prefix + suffix || name.compare(0, prefix, ARCHIVE_PREFIX) != 0 ||
+        name.compare(name.size() - suffix, suffix, ARCHIVE_SUFFIX) != 0) {
+        return false;
+    }
+    const std::string digits = name.substr(prefix, name.size() - prefix - suffix);
+    if (digits.empty() || digits.size() > 10 ||
+        !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return false;
+    }
+    const unsigned long long value = std::stoull(digits);
+    if (value == 0 || value > UINT32_MAX) {
+        return false;
+    }
+    id = static_cast<uint32_t>(value);
+    return true;
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+} // namespace
+
+ZstdDictionary::~ZstdDictionary() {
+#if defined(LATTICE_HAS_ZSTD)
+    if (cdict_) ZSTD_freeCDict(static_cast<ZSTD_CDict*>(cdict_));
+    if (ddict_) ZSTD_freeDDict(static_cast<ZSTD_DDict*>(ddict_));
+#endif
+}
+
+std::shared_ptr<ZstdDictionary> ZstdDictionary::fromBytes(std::vector<uint8_t> bytes, int compressionLevel,
+                                                          Retired retired) {
+#if defined(LATTICE_HAS_ZSTD)
+    if (bytes.empty()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<ZstdDictionary> dictionary(new ZstdDictionary());
+    dictionary->bytes_ = std::move(bytes);
+    dictionary->compressionLevel_ = compressionLevel;
+    dictionary->id_ = ZSTD_getDictID_fromDict(dictionary->bytes_.data(), dictionary->bytes_.size());
+    for (const auto& entry : retired) {
+        if (!entry) {
+            continue;
+        }
+        // 展开成一层，forId只需查retired_本身
+        std::vector<std::shared_ptr<const ZstdDictionary>> candidates{entry};
+        candidates.insert(candidates.end(), entry->retired_.begin(), entry->retired_.end());
+        for (auto& candidate : candidates) {
+            if (candidate->id_ != dictionary->id_ && !dictionary->forId(candidate->id_)) {
+                dictionary->retired_.push_back(std::move(candidate));
+            }
+        }
+    }
+    dictionary->cdict_ = ZSTD_createCDict(dictionary->bytes_.data(), dictionary->bytes_.size(), compressionLevel);
+    dictionary->ddict_ = ZSTD_createDDict(dictionary->bytes_.data(), dictionary->bytes_.size());
+
+    // 原始内容字典（无魔数）的ID为0，无法在帧头中区分，不接受
+    if (dictionary->id_ == 0 || !dictionary->cdict_ || !dictionary->ddict_) {
+        return nullptr;
+    }
+    return dictionary;
+#else
+    (void)bytes; (void)compressionLevel; (void)retired;
+    return nullptr;
+#endif
+}
+
+std::shared_ptr<ZstdDictionary> ZstdDictionary::loadFromFile(const std::string& path, int compressionLevel) {
+    std::vector<uint8_t> bytes;
+    if (!readFile(path, bytes)) {
+        return nullptr;
+    }
+    return fromBytes(std::move(bytes), compressionLevel);
+}
+
+std::shared_ptr<ZstdDictionary> ZstdDictionary::loadForWorld(const std::string& worldPath, int compressionLevel) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    Retired archived;
+    fs::path newestArchive;
+    fs::file_time_type newestTime{};
+    for (const auto& entry : fs::directory_iterator(worldPath, ec)) {
+        uint32_t id = 0;
+        if (!entry.is_regular_file(ec) || !parseArchiveId(entry.path().filename().string(), id)) {
+            continue;
+        }
+        auto dictionary = loadFromFile(entry.path().string(), compressionLevel);
+        if (!dictionary || dictionary->id() != id) {
+            fprintf(stderr, "[Lattice] Ignoring invalid zstd dictionary archive %s\n", entry.path().c_str());
+            continue;
+        }
+        const auto modified = entry.last_write_time(ec);
+        if (newestArchive.empty() || modified > newestTime) {
+            newestArchive = entry.path();
+            newestTime = modified;
+        }
+        archived.push_back(std::move(dictionary));
+    }
+
+    std::vector<uint8_t> bytes;
+    if (!readFile(pathForWorld(worldPath), bytes) && (newestArchive.empty() || !readFile(newestArchive.string(), bytes))) {
+        return nullptr;
+    }
+    return fromBytes(std::move(bytes), compressionLevel, std::move(archived));
+}
+
+bool ZstdDictionary::saveToFile(const std::string& path) const {
+    namespace fs = std::filesystem;
+    std::vector<uint8_t> existing;
+    if (readFile(path, existing)) {
+        return existing == bytes_;
+    }
+
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(bytes_.data()), static_cast<std::streamsize>(bytes_.size()));
+        if (!file) {
+            return false;
+        }
+    }
+
+    // 硬链接在目标已存在时失败，不会覆盖并发写入的同名文件
+    std::error_code ec;
+    fs::create_hard_link(tempPath, path, ec);
+    std::error_code ignored;
+    fs::remove(tempPath, ignored);
+    if (ec) {
+        return readFile(path, existing) && existing == bytes_;
+    }
+    return true;
+}
+
+bool ZstdDictionary::saveForWorld(const std::string& worldPath) const {
+    namespace fs = std::filesystem;
+    const std::string activePath = pathForWorld(worldPath);
+
+    // 早期版本只有当前字典文件：替换之前先把它按ID存档，用它压缩的区块仍可解压
+    if (auto previous = loadFromFile(activePath, compressionLevel_)) {
+        if (previous->id() != id_ && !previous->saveToFile(pathForId(worldPath, previous->id()))) {
+            return false;
+        }
+    }
+    if (!saveToFile(pathForId(worldPath, id_))) {
+        return false;
+    }
+
+    const std::string tempPath = activePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(bytes_.data()), static_cast<std::streamsize>(bytes_.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, activePath, ec);
+    return !ec;
+}
+
+std::shared_ptr<const ZstdDictionary> ZstdDictionary::supersede(std::shared_ptr<const ZstdDictionary> next,
+                                                                const std::shared_ptr<const ZstdDictionary>& previous) {
+    if (!next || !previous) {
+        return next;
+    }
+    bool complete = next->forId(previous->id_) != nullptr;
+    for (const auto& entry : previous->retired_) {
+        complete = complete && next->forId(entry->id_) != nullptr;
+    }
+    if (complete) {
+        return next;
+    }
+
+    Retired retired = next->retired_;
+    retired.push_back(previous);
+    auto merged = fromBytes(next->bytes_, next->compressionLevel_, std::move(retired));
+    return merged ? std::shared_ptr<const ZstdDictionary>(std::move(merged)) : next;
+}
+
+std::string ZstdDictionary::pathForWorld(const std::string& worldPath) {
+    return (std::filesystem::path(worldPath) / DEFAULT_FILE_NAME).string();
+}
+
+std::string ZstdDictionary::pathForId(const std::string& worldPath, uint32_t id) {
+    return (std::filesystem::path(worldPath) / (ARCHIVE_PREFIX + std::to_string(id) + ARCHIVE_SUFFIX)).string();
+}
+
+const ZstdDictionary* ZstdDictionary::forId(uint32_t id) const {
+    if (id == id_) {
+        return this;
+    }
+    for (const auto& entry : retired_) {
+        if (entry->id_ == id) {
+            return entry.get();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<uint8_t> ZstdDictionary::train(const std::vector<std::vector<uint8_t>>& samples,
+                                           size_t dictionarySize) {
+#if defined(LATTICE_HAS_ZSTD)
+    if (samples.size() < MIN_TRAINING_SAMPLES) {
+        throw std::runtime_error("Not enough chunk samples to train a zstd dictionary");
+    }
+
+    // ZDICT要求所有样本连续存放
+    std::vector<uint8_t> concatenated;
+    std::vector<size_t> sampleSizes;
+    size_t total = 0;
+    for (const auto& sample : samples) {
+        total += sample.size();
+    }
+    concatenated.reserve(total);
+    sampleSizes.reserve(samples.size());
+    for (const auto& sample : samples) {
+        concatenated.insert(concatenated.end(), sample.begin(), sample.end());
+        sampleSizes.push_back(sample.size());
+    }
+
+    std::vector<uint8_t> dictionary(dictionarySize);
+    size_t result = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+                                          concatenated.data(), sampleSizes.data(),
+                                          static_cast<unsigned>(sampleSizes.size()));
+    if (ZDICT_isError(result)) {
+        throw std::runtime_error(std::string("zstd dictionary training failed: ") + ZDICT_getErrorName(result));
+    }
+
+    dictionary.resize(result);
+    return dictionary;
+#else
+    (void)samples; (void)dictionarySize;
+    throw std::runtime_error("zstd support is not compiled in");
+#endif
+}
+
+std::vector<std::vector<uint8_t>> ZstdDictionary::collectSamples(const std::string& worldPath, size_t maxSamples) {
+    std::vector<std::vector<uint8_t>> samples;
+    const std::vector<std::string> regionFiles = listRegionFiles(worldPath);
+    if (regionFiles.empty() || maxSamples == 0) {
+        return samples;
+    }
+
+    // 每个region的配额，保证样本覆盖整个世界而不是集中在前几个region
+    const size_t perRegion = std::max<size_t>(1, (maxSamples + regionFiles.size() - 1) / regionFiles.size());
+    std::vector<uint8_t> record;
+
+    for (const auto& path : regionFiles) {
+        if (samples.size() >= maxSamples) {
+            break;
+        }
+
+        RegionFile region(path, false);
+        if (!region.isOpen()) {
+            continue;
+        }
+
+        std::vector<size_t> present;
+        for (size_t index = 0; index < REGION_CHUNK_COUNT; ++index) {
+            if (region.hasChunk(static_cast<int>(index % 32), static_cast<int>(index / 32))) {
+                present.push_back(index);
+            }
+        }
+        if (present.empty()) {
+            continue;
+        }
+
+        // 在region内部等间隔采样
+        const size_t take = std::min(perRegion, present.size());
+        const size_t stride = present.size() / take;
+        for (size_t i = 0; i < take && samples.size() < maxSamples; ++i) {
+            size_t index = present[i * stride];
+            if (!region.readChunk(static_cast<int>(index % 32), static_cast<int>(index / 32), record)) {
+                continue;
+            }
+
+            auto type = MinecraftCompressor::fromRegionRecord(record[0], record.data() + 1, record.size() - 1);
+            if (type == MinecraftCompressor::CompressionType::CUSTOM ||
+                type == MinecraftCompressor::CompressionType::ZSTD) {
+                // 已经是zstd的区块可能依赖旧字典，不作为样本
+                continue;
+            }
+            record[0] = static_cast<uint8_t>(type);
+
+            auto nbt = MinecraftCompressor::decompressData(record, type);
+            if (!nbt.empty()) {
+                samples.push_back(std::move(nbt));
+            }
+        }
+    }
+
+    return samples;
+}
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lattice {
+namespace io {
+namespace anvil {
+
+/**
+ * ZstdDictionary - 区块NBT的zstd字典
+ *
+ * 区块NBT高度重复（每个section都有相同的调色板字符串和标签名），
+ * 用世界自身的样本训练字典后，小区块的压缩率和速度都明显优于逐区块deflate。
+ * 当前字典保存在世界目录下（DEFAULT_FILE_NAME），新写入的区块用它压缩；每个字典另按ID存档为
+ * lattice_zstd.<id>.dict，存档文件从不覆盖。重新训练后，用旧字典压缩的区块仍按帧头的字典ID
+ * 找到对应的旧字典（retired）解压；找不到时直接失败而不是产生错误数据。
+ *
+ * 预处理的压缩/解压字典（CDict/DDict）在构造时创建一次，可被多线程共享。
+ */
+class ZstdDictionary {
+public:
+    static constexpr const char* DEFAULT_FILE_NAME = "lattice_zstd.dict";
+    static constexpr size_t DEFAULT_DICTIONARY_SIZE = 112 * 1024;   // zstd CLI默认字典大小
+    static constexpr size_t DEFAULT_MAX_SAMPLES = 20000;
+
+    ~ZstdDictionary();
+
+    ZstdDictionary(const ZstdDictionary&) = delete;
+    ZstdDictionary& operator=(const ZstdDictionary&) = delete;
+
+    using Retired = std::vector<std::shared_ptr<const ZstdDictionary>>;
+
+    /**
+     * 从字典内容创建；内容无效或未编译zstd支持时返回nullptr
+     * retired为仍需解压的旧字典（只用于解压），与本字典ID相同的项被忽略
+     */
+    static std::shared_ptr<ZstdDictionary> fromBytes(std::vector<uint8_t> bytes, int compressionLevel,
+                                                     Retired retired = {});
+
+    // 从文件加载；文件不存在或无效时返回nullptr
+    static std::shared_ptr<ZstdDictionary> loadFromFile(const std::string& path, int compressionLevel);
+
+    /**
+     * 加载世界目录下的当前字典，以及所有按ID存档的字典（作为retired）
+     * 没有当前字典文件时以最近修改的存档为当前字典；都没有时返回nullptr
+     */
+    static std::shared_ptr<ZstdDictionary> loadForWorld(const std::string& worldPath, int compressionLevel);
+
+    /**
+     * 写入文件（临时文件 + 硬链接），path已存在时不覆盖：内容相同视为成功，否则返回false
+     */
+    bool saveToFile(const std::string& path) const;
+
+    /**
+     * 保存为世界的当前字典：先按ID存档（原有的当前字典若尚未存档也一并存档），再替换当前字典文件
+     * 存档失败时不替换，返回false
+     */
+    bool saveForWorld(const std::string& worldPath) const;
+
+    /**
+     * 以next替换previous时保留previous能解压的所有字典；next已包含它们时原样返回
+     */
+    static std::shared_ptr<const ZstdDictionary> supersede(std::shared_ptr<const ZstdDictionary> next,
+                                                           const std::shared_ptr<const ZstdDictionary>& previous);
+
+    // 世界目录下的当前字典路径
+    static std::string pathForWorld(const std::string& worldPath);
+
+    // 世界目录下ID为id的字典存档路径
+    static std::string pathForId(const std::string& worldPath, uint32_t id);
+
+    // ID为id的字典（本字典或retired中的一个），没有时返回nullptr
+    const ZstdDictionary* forId(uint32_t id) const;
+    const Retired& retired() const { return retired_; }
+
+    /**
+     * 用样本训练字典
+     * @param samples 未压缩的区块NBT
+     * @param dictionarySize 字典容量上限
+     * @return 字典内容；样本不足或训练失败时抛出std::runtime_error
+     */
+    static std::vector<uint8_t> train(const std::vector<std::vector<uint8_t>>& samples,
+                                      size_t dictionarySize = DEFAULT_DICTIONARY_SIZE);
+
+    /**
+     * 从世界的region文件中采样区块NBT（包括DIM-1/DIM1维度）
+     * 按region文件均匀采样，最多maxSamples个
+     */
+    static std::vector<std::vector<uint8_t>> collectSamples(const std::string& worldPath,
+                                                            size_t maxSamples = DEFAULT_MAX_SAMPLES);
+
+    uint32_t id() const { return id_; }
+    const std::vector<uint8_t>& bytes() const { return bytes_; }
+
+    // zstd预处理字典（ZSTD_CDict* / ZSTD_DDict*），由chunk_codecs使用
+    const void* compressionDictionary() const { return cdict_; }
+    const void* decompressionDictionary() const { return ddict_; }
+
+private:
+    ZstdDictionary() = default;
+
+    std::vector<uint8_t> bytes_;
+    uint32_t id_ = 0;
+    int compressionLevel_ = 0;
+    Retired retired_;                  // 已展开（包括各项自己的retired），不含自身，ID不重复
+    void* cdict_ = nullptr;
+    void* ddict_ = nullptr;
+};
+
+} // namespace anvil
+} // namespace io
+} // namespace lattice
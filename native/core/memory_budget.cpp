@@ -0,0 +1,385 @@
+#include "memory_budget.hpp"
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+constexpr const char* CGROUP_ROOT = "/sys/fs/cgroup";
+
+// 回收线程在没有超出预算的通知时的检查间隔（总量超过全局上限只靠这里发现）
+constexpr std::chrono::seconds RECLAIM_INTERVAL{1};
+// 两轮回收之间的最短间隔：回收函数释放不了（或异步释放）时，持续的charge不会让回收线程空转
+constexpr std::chrono::milliseconds RECLAIM_MIN_GAP{10};
+
+// 子系统默认预算占全局上限的比例（千分比），合计1000
+constexpr std::array<size_t, MEMORY_SUBSYSTEM_COUNT> DEFAULT_SHARES = {
+    300,    // CHUNK_CACHE
+    150,    // COMPRESSION_BUFFERS
+    150,    // LIGHT_STORAGE
+    100,    // TRACKER
+    100,    // AI
+    100,    // JNI_BUFFERS
+    100,    // BLOCK_STATES
+};
+
+// cgroup接口文件中的单个数值；"max"、读取失败或v1的"无上限"（接近INT64_MAX）返回0
+size_t readLimitValue(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    if (!file || !(file >> value) || value == "max") {
+        return 0;
+    }
+    try {
+        const unsigned long long limit = std::stoull(value);
+        return limit >= (1ULL << 62) ? 0 : static_cast<size_t>(limit);
+    } catch (...) {
+        return 0;
+    }
+}
+
+size_t clampUsage(int64_t bytes) {
+    return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+}
+
+} // namespace
+
+const char* memorySubsystemName(MemorySubsystem subsystem) {
+    switch (subsystem) {
+        case MemorySubsystem::CHUNK_CACHE:         return "chunk_cache";
+        case MemorySubsystem::COMPRESSION_BUFFERS: return "compression_buffers";
+        case MemorySubsystem::LIGHT_STORAGE:       return "light_storage";
+        case MemorySubsystem::TRACKER:             return "tracker";
+        case MemorySubsystem::AI:                  return "ai";
+        case MemorySubsystem::JNI_BUFFERS:         return "jni_buffers";
+        case MemorySubsystem::BLOCK_STATES:        return "block_states";
+        default:                                   return "unknown";
+    }
+}
+
+MemoryBudget& MemoryBudget::instance() {
+    static MemoryBudget budget;
+    return budget;
+}
+
+MemoryBudget::MemoryBudget() {
+    containerLimit_ = containerMemoryLimit();
+    recomputeLimits();
+
+    // 与本库其他指标一起导出；MemoryBudget随库存在，回调不移除
+    auto& registry = MetricsRegistry::instance();
+    registry.addCallback(MetricType::GAUGE, "lattice_native_memory_limit_bytes",
+                         "Global native memory limit (0 when unlimited)", {},
+                         [this] { return static_cast<double>(globalLimit()); });
+    for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        const auto subsystem = static_cast<MemorySubsystem>(i);
+        const MetricLabels labels = {{"subsystem", memorySubsystemName(subsystem)}};
+        registry.addCallback(MetricType::GAUGE, "lattice_native_memory_bytes",
+                             "Native memory charged to each subsystem", labels,
+                             [this, subsystem] { return static_cast<double>(usage(subsystem)); });
+        registry.addCallback(MetricType::GAUGE, "lattice_native_memory_budget_bytes",
+                             "Native memory budget of each subsystem (0 when unlimited)", labels,
+                             [this, subsystem] { return static_cast<double>(budget(subsystem)); });
+        registry.addCallback(MetricType::COUNTER, "lattice_native_memory_shed_bytes_total",
+                             "Bytes released by subsystem shedders after going over budget", labels,
+                             [this, i] { return static_cast<double>(shedBytes_[i].load(std::memory_order_relaxed)); });
+    }
+}
+
+MemoryBudget::~MemoryBudget() {
+    {
+        std::lock_guard<std::mutex> lock(threadMutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (reclaimThread_.joinable()) {
+        reclaimThread_.join();
+    }
+}
+
+void MemoryBudget::charge(MemorySubsystem subsystem, size_t bytes) {
+    const size_t index = static_cast<size_t>(subsystem);
+    Usage& usage = usage_[index];
+    const int64_t delta = static_cast<int64_t>(bytes);
+    const int64_t now = usage.bytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+
+    int64_t peak = usage.peak.load(std::memory_order_relaxed);
+    while (now > peak && !usage.peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+
+    // 超出预算时通知回收线程；已有未处理的通知时只读一次标志
+    const int64_t limit = static_cast<int64_t>(budgets_[index].load(std::memory_order_relaxed));
+    if (limit != 0 && now > limit && !shedPending_.load(std::memory_order_relaxed)) {
+        requestShed();
+    }
+}
+
+void MemoryBudget::release(MemorySubsystem subsystem, size_t bytes) {
+    usage_[static_cast<size_t>(subsystem)].bytes.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+}
+
+size_t MemoryBudget::usage(MemorySubsystem subsystem) const {
+    return clampUsage(usage_[static_cast<size_t>(subsystem)].bytes.load(std::memory_order_relaxed));
+}
+
+size_t MemoryBudget::totalUsage() const {
+    size_t total = 0;
+    for (const Usage& usage : usage_) {
+        total += clampUsage(usage.bytes.load(std::memory_order_relaxed));
+    }
+    return total;
+}
+
+void MemoryBudget::setGlobalLimit(size_t bytes) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    explicitGlobalLimit_ = bytes;
+    recomputeLimits();
+}
+
+void MemoryBudget::setJvmMaxHeap(size_t bytes) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    jvmMaxHeap_ = bytes;
+    // 堆大小通常在启动时设置一次，顺便重新读取容器上限（可能在运行中被调整）
+    containerLimit_ = containerMemoryLimit();
+    recomputeLimits();
+}
+
+void MemoryBudget::setBudget(MemorySubsystem subsystem, size_t bytes) {
+    std::lock_guard<std::mutex> lock(configMutex_);
+    explicitBudgets_[static_cast<size_t>(subsystem)] = bytes;
+    recomputeLimits();
+}
+
+void MemoryBudget::recomputeLimits() {
+    size_t global = explicitGlobalLimit_;
+    if (global == 0 && containerLimit_ > 0) {
+        if (jvmMaxHeap_ > 0) {
+            const size_t reserve = std::max(containerLimit_ / 10, NON_HEAP_RESERVE);
+            // 堆已占满容器时仍保留一个很小的上限，缓存不至于无限增长
+            global = containerLimit_ > jvmMaxHeap_ + reserve ? containerLimit_ - jvmMaxHeap_ - reserve
+                                                              : containerLimit_ / 20;
+        } else {
+            global = containerLimit_ / 4;
+        }
+    }
+    globalLimit_.store(global, std::memory_order_relaxed);
+
+    bool exceeded = false;
+    for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        const size_t limit = explicitBudgets_[i] != 0 ? explicitBudgets_[i] : global / 1000 * DEFAULT_SHARES[i];
+        budgets_[i].store(limit, std::memory_order_relaxed);
+        exceeded |= limit != 0 && usage(static_cast<MemorySubsystem>(i)) > limit;
+    }
+    if (exceeded) {
+        requestShed();
+    }
+}
+
+void MemoryBudget::requestShed() {
+    if (!shedPending_.exchange(true, std::memory_order_relaxed)) {
+        wakeup_.notify_one();
+    }
+}
+
+uint64_t MemoryBudget::addShedder(MemorySubsystem subsystem, Shedder shedder) {
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(shedMutex_);
+        id = nextShedderId_++;
+        shedders_.push_back(ShedderEntry{id, subsystem, std::move(shedder)});
+    }
+    std::lock_guard<std::mutex> lock(threadMutex_);
+    if (!reclaimThread_.joinable() && !stopping_) {
+        reclaimThread_ = std::thread(&MemoryBudget::reclaimLoop, this);
+    }
+    return id;
+}
+
+void MemoryBudget::removeShedder(uint64_t id) {
+    std::lock_guard<std::mutex> lock(shedMutex_);
+    shedders_.erase(std::remove_if(shedders_.begin(), shedders_.end(),
+                                   [id](const ShedderEntry& entry) { return entry.id == id; }),
+                    shedders_.end());
+}
+
+size_t MemoryBudget::shedLocked(size_t index, size_t bytes) {
+    size_t freed = 0;
+    bool called = false;
+    for (const ShedderEntry& entry : shedders_) {
+        if (freed >= bytes) {
+            break;
+        }
+        if (static_cast<size_t>(entry.subsystem) != index) {
+            continue;
+        }
+        called = true;
+        try {
+            freed += entry.shedder(bytes - freed);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "[MemoryBudget] %s shedder failed: %s\n",
+                    memorySubsystemName(entry.subsystem), e.what());
+        }
+    }
+    if (called) {
+        shedPasses_[index].fetch_add(1, std::memory_order_relaxed);
+        shedBytes_[index].fetch_add(freed, std::memory_order_relaxed);
+    }
+    return freed;
+}
+
+size_t MemoryBudget::enforce() {
+    std::lock_guard<std::mutex> lock(shedMutex_);
+    shedPending_.store(false, std::memory_order_relaxed);
+
+    size_t freed = 0;
+    for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        const size_t limit = budgets_[i].load(std::memory_order_relaxed);
+        const size_t used = usage(static_cast<MemorySubsystem>(i));
+        if (limit != 0 && used > limit) {
+            freed += shedLocked(i, used - static_cast<size_t>(static_cast<double>(limit) * SHED_TARGET));
+        }
+    }
+
+    const size_t global = globalLimit();
+    const size_t total = totalUsage();
+    if (global == 0 || total <= global) {
+        return freed;
+    }
+
+    // 总量超限（各子系统都在预算内，或自定义预算之和超过全局上限）：按使用量/预算从高到低回收
+    std::array<size_t, MEMORY_SUBSYSTEM_COUNT> order{};
+    std::array<double, MEMORY_SUBSYSTEM_COUNT> ratio{};
+    for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        order[i] = i;
+        const size_t limit = budgets_[i].load(std::memory_order_relaxed);
+        ratio[i] = static_cast<double>(usage(static_cast<MemorySubsystem>(i))) /
+                   static_cast<double>(limit != 0 ? limit : global);
+    }
+    std::sort(order.begin(), order.end(), [&ratio](size_t a, size_t b) { return ratio[a] > ratio[b]; });
+
+    size_t excess = total - static_cast<size_t>(static_cast<double>(global) * SHED_TARGET);
+    for (size_t index : order) {
+        if (excess == 0) {
+            break;
+        }
+        const size_t used = usage(static_cast<MemorySubsystem>(index));
+        if (used == 0) {
+            continue;
+        }
+        const size_t released = shedLocked(index, std::min(excess, used));
+        freed += released;
+        excess -= std::min(excess, released);
+    }
+    return freed;
+}
+
+void MemoryBudget::reclaimLoop() {
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), "lt-mem-reclaim");
+#endif
+    std::unique_lock<std::mutex> lock(threadMutex_);
+    while (!stopping_) {
+        wakeup_.wait_for(lock, RECLAIM_INTERVAL, [this] {
+            return stopping_ || shedPending_.load(std::memory_order_relaxed);
+        });
+        if (stopping_) {
+            break;
+        }
+        lock.unlock();
+        enforce();
+        lock.lock();
+        wakeup_.wait_for(lock, RECLAIM_MIN_GAP, [this] { return stopping_; });
+    }
+}
+
+size_t MemoryBudget::containerMemoryLimit() {
+    std::ifstream file("/proc/self/cgroup");
+    std::string line;
+    std::string v2Path;
+    std::string v1Path;
+    bool hasV2 = false;
+    while (std::getline(file, line)) {
+        if (line.rfind("0::", 0) == 0) {
+            v2Path = line.substr(3);
+            hasV2 = true;
+            continue;
+        }
+        // v1: "<id>:<controllers>:<path>"，controllers中包含memory
+        const size_t first = line.find(':');
+        const size_t second = first == std::string::npos ? std::string::npos : line.find(':', first + 1);
+        if (second == std::string::npos) {
+            continue;
+        }
+        const std::string controllers = "," + line.substr(first + 1, second - first - 1) + ",";
+        if (controllers.find(",memory,") != std::string::npos) {
+            v1Path = line.substr(second + 1);
+        }
+    }
+
+    if (hasV2 && std::ifstream(std::string(CGROUP_ROOT) + "/cgroup.controllers")) {
+        // 上限可能设在父cgroup上（如Pod级别），取路径上最小的memory.max
+        while (!v2Path.empty() && v2Path.back() == '/') {
+            v2Path.pop_back();
+        }
+        std::string dir = std::string(CGROUP_ROOT) + v2Path;
+        size_t limit = 0;
+        for (;;) {
+            const size_t value = readLimitValue(dir + "/memory.max");
+            if (value > 0 && (limit == 0 || value < limit)) {
+                limit = value;
+            }
+            if (dir.size() <= std::char_traits<char>::length(CGROUP_ROOT)) {
+                break;
+            }
+            dir.erase(dir.rfind('/'));
+        }
+        if (limit > 0) {
+            return limit;
+        }
+    }
+
+    // cgroup v1：容器内通常挂载为自身的根，先试进程路径，再试根
+    const std::string v1Root = std::string(CGROUP_ROOT) + "/memory";
+    if (!v1Path.empty() && v1Path != "/") {
+        const size_t limit = readLimitValue(v1Root + v1Path + "/memory.limit_in_bytes");
+        if (limit > 0) {
+            return limit;
+        }
+    }
+    return readLimitValue(v1Root + "/memory.limit_in_bytes");
+}
+
+MemoryBudget::Stats MemoryBudget::getStats() const {
+    Stats stats;
+    {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        stats.containerLimit = containerLimit_;
+        stats.jvmMaxHeap = jvmMaxHeap_;
+    }
+    stats.globalLimit = globalLimit();
+    for (size_t i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        SubsystemStats& subsystem = stats.subsystems[i];
+        subsystem.usage = usage(static_cast<MemorySubsystem>(i));
+        subsystem.peak = clampUsage(usage_[i].peak.load(std::memory_order_relaxed));
+        subsystem.budget = budgets_[i].load(std::memory_order_relaxed);
+        subsystem.shedPasses = shedPasses_[i].load(std::memory_order_relaxed);
+        subsystem.shedBytes = shedBytes_[i].load(std::memory_order_relaxed);
+        stats.totalUsage += subsystem.usage;
+    }
+    return stats;
+}
+
+} // namespace core
+} // namespace lattice
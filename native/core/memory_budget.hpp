@@ -0,0 +1,253 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace lattice {
+namespace core {
+
+// ====== native内存预算 ======
+//
+// 各子系统的native内存（区块缓存、压缩缓冲区、光照数组、实体追踪、AI状态、JNI缓冲区、方块状态）原本各管各的，
+// 只有部分有上限，进程RSS随负载漂移，和JVM堆一起时容易被容器OOM。这里按子系统记账：
+// charge/release只是一次relaxed原子加减，没有锁；超出预算的子系统由后台回收线程调用其注册的回收函数
+// （丢弃缓存、释放空闲缓冲区），总量受从容器内存上限推算出的全局上限约束。
+//
+// 与TickBudget相同，每个桥接库各有一份MemoryBudget，Java侧向每个已加载的库下发相同的设置；
+// 每个子系统基本只在一个库里，子系统预算就是实际生效的上限。
+
+enum class MemorySubsystem : uint8_t {
+    CHUNK_CACHE,            // HotChunkCache中解压后的区块负载
+    COMPRESSION_BUFFERS,    // CompressBufferCache的缓冲区
+    LIGHT_STORAGE,          // 光照段的nibble数组
+    TRACKER,                // HierarchicalTracker的实体存储与查询缓存
+    AI,                     // AIEngine的实体状态与世界视图
+    JNI_BUFFERS,            // SafeJNIMemoryManager分配的缓冲区
+    BLOCK_STATES,           // BlockStateStore的段数组（包括仍被旧快照引用的）
+    COUNT
+};
+
+inline constexpr size_t MEMORY_SUBSYSTEM_COUNT = static_cast<size_t>(MemorySubsystem::COUNT);
+
+const char* memorySubsystemName(MemorySubsystem subsystem);
+
+/**
+ * @brief 本库的native内存预算（进程内每个桥接库一份）
+ *
+ * 全局上限：setGlobalLimit显式设置时使用该值；否则由容器内存上限（cgroup v2 memory.max，
+ * 或v1 memory.limit_in_bytes）减去JVM最大堆（setJvmMaxHeap）和非堆预留得到，
+ * 未设置JVM堆时取容器上限的1/4。不在有上限的容器中且未显式设置时不限制，只记账。
+ *
+ * 子系统预算默认按全局上限的固定比例（区块缓存30%、光照15%、压缩15%、追踪/AI/JNI/方块状态各10%），
+ * 可以用setBudget单独设置。方块状态是权威数据，不注册回收函数，只参与记账与全局上限。
+ *
+ * 回收：某个子系统的使用量超出预算时charge唤醒回收线程（两轮之间至少间隔10ms），
+ * 回收线程也每秒检查一次总量。
+ * 超出预算的子系统回收到预算的90%；总量超过全局上限时按使用量/预算从高到低依次回收。
+ * 回收函数在回收线程上调用，参数为希望释放的字节数，返回实际释放的字节数
+ * （只能异步释放的子系统记下请求后返回0）。回收函数内不能调用addShedder/removeShedder，
+ * removeShedder会等待正在执行的回收结束，之后回收函数不会再被调用。
+ */
+class MemoryBudget {
+public:
+    using Shedder = std::function<size_t(size_t bytesToFree)>;
+
+    static constexpr double SHED_TARGET = 0.9;                      // 回收到预算的比例
+    static constexpr size_t NON_HEAP_RESERVE = 256 * 1024 * 1024;   // 元空间、代码缓存、线程栈等的最小预留
+
+    static MemoryBudget& instance();
+
+    ~MemoryBudget();
+
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    // ---- 记账（任意线程，无锁）----
+    void charge(MemorySubsystem subsystem, size_t bytes);
+    void release(MemorySubsystem subsystem, size_t bytes);
+
+    size_t usage(MemorySubsystem subsystem) const;
+    size_t totalUsage() const;
+
+    // 生效的子系统预算；0表示不限制
+    size_t budget(MemorySubsystem subsystem) const {
+        return budgets_[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+    }
+    size_t globalLimit() const { return globalLimit_.load(std::memory_order_relaxed); }
+
+    bool overBudget(MemorySubsystem subsystem) const {
+        const size_t limit = budget(subsystem);
+        return limit != 0 && usage(subsystem) > limit;
+    }
+
+    // ---- 配置 ----
+    // 0表示按容器上限推算
+    void setGlobalLimit(size_t bytes);
+    // Java传入Runtime.maxMemory()，用于从容器上限中扣除
+    void setJvmMaxHeap(size_t bytes);
+    // 0表示按全局上限的默认比例
+    void setBudget(MemorySubsystem subsystem, size_t bytes);
+
+    // ---- 回收 ----
+    // 第一次注册时启动回收线程
+    uint64_t addShedder(MemorySubsystem subsystem, Shedder shedder);
+    void removeShedder(uint64_t id);
+
+    // 立即执行一轮回收，返回释放的字节数（回收线程定期调用）
+    size_t enforce();
+
+    /**
+     * 容器内存上限：cgroup v2取进程所在cgroup到根路径上最小的memory.max，
+     * 否则读cgroup v1的memory.limit_in_bytes；不在有上限的容器中返回0
+     */
+    static size_t containerMemoryLimit();
+
+    struct SubsystemStats {
+        size_t usage = 0;
+        size_t peak = 0;
+        size_t budget = 0;
+        uint64_t shedPasses = 0;        // 对该子系统调用回收函数的轮数
+        uint64_t shedBytes = 0;         // 回收函数报告释放的字节数
+    };
+
+    struct Stats {
+        size_t globalLimit = 0;
+        size_t containerLimit = 0;
+        size_t jvmMaxHeap = 0;
+        size_t totalUsage = 0;
+        std::array<SubsystemStats, MEMORY_SUBSYSTEM_COUNT> subsystems{};
+    };
+    Stats getStats() const;
+
+private:
+    MemoryBudget();
+
+    struct alignas(64) Usage {
+        std::atomic<int64_t> bytes{0};
+        std::atomic<int64_t> peak{0};
+    };
+
+    struct ShedderEntry {
+        uint64_t id;
+        MemorySubsystem subsystem;
+        Shedder shedder;
+    };
+
+    // 按当前设置重新计算globalLimit_与budgets_
+    void recomputeLimits();
+    void requestShed();
+    void reclaimLoop();
+    // 调用方持有shedMutex_
+    size_t shedLocked(size_t index, size_t bytes);
+
+    std::array<Usage, MEMORY_SUBSYSTEM_COUNT> usage_{};
+    std::array<std::atomic<size_t>, MEMORY_SUBSYSTEM_COUNT> budgets_{};
+    std::array<std::atomic<uint64_t>, MEMORY_SUBSYSTEM_COUNT> shedPasses_{};
+    std::array<std::atomic<uint64_t>, MEMORY_SUBSYSTEM_COUNT> shedBytes_{};
+    std::atomic<size_t> globalLimit_{0};
+
+    // 设置（configMutex_保护，只在配置时使用）
+    mutable std::mutex configMutex_;
+    std::array<size_t, MEMORY_SUBSYSTEM_COUNT> explicitBudgets_{};
+    size_t explicitGlobalLimit_ = 0;
+    size_t jvmMaxHeap_ = 0;
+    size_t containerLimit_ = 0;
+
+    // 回收函数与回收线程；shedMutex_在整轮回收期间持有
+    std::mutex shedMutex_;
+    std::vector<ShedderEntry> shedders_;
+    uint64_t nextShedderId_ = 1;
+
+    std::mutex threadMutex_;
+    std::condition_variable wakeup_;
+    std::thread reclaimThread_;
+    bool stopping_ = false;
+    std::atomic<bool> shedPending_{false};
+};
+
+/**
+ * @brief 一个对象在某子系统中的占用
+ *
+ * 对象按自己的统计（条目数、缓存字节数）调用set，或在分配/释放时add/sub，只把差值记到MemoryBudget；
+ * 析构时归还剩余的占用
+ */
+class MemoryCharge {
+public:
+    explicit MemoryCharge(MemorySubsystem subsystem) : subsystem_(subsystem) {}
+    ~MemoryCharge() { set(0); }
+
+    MemoryCharge(const MemoryCharge&) = delete;
+    MemoryCharge& operator=(const MemoryCharge&) = delete;
+
+    void add(size_t bytes) {
+        bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        MemoryBudget::instance().charge(subsystem_, bytes);
+    }
+
+    void sub(size_t bytes) {
+        bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+        MemoryBudget::instance().release(subsystem_, bytes);
+    }
+
+    void set(size_t bytes) {
+        const size_t previous = bytes_.exchange(bytes, std::memory_order_relaxed);
+        if (bytes > previous) {
+            MemoryBudget::instance().charge(subsystem_, bytes - previous);
+        } else if (bytes < previous) {
+            MemoryBudget::instance().release(subsystem_, previous - bytes);
+        }
+    }
+
+    size_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+    MemorySubsystem subsystem() const { return subsystem_; }
+
+private:
+    const MemorySubsystem subsystem_;
+    std::atomic<size_t> bytes_{0};
+};
+
+/**
+ * @brief 按子系统记账的标准分配器
+ *
+ * 用于容器或std::allocate_shared，分配与释放的字节数直接记到MemoryBudget
+ */
+template <typename T, MemorySubsystem Subsystem>
+struct BudgetAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = BudgetAllocator<U, Subsystem>;
+    };
+
+    BudgetAllocator() noexcept = default;
+    template <typename U>
+    BudgetAllocator(const BudgetAllocator<U, Subsystem>&) noexcept {}
+
+    T* allocate(size_t count) {
+        T* ptr = static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{alignof(T)}));
+        MemoryBudget::instance().charge(Subsystem, count * sizeof(T));
+        return ptr;
+    }
+
+    void deallocate(T* ptr, size_t count) noexcept {
+        MemoryBudget::instance().release(Subsystem, count * sizeof(T));
+        ::operator delete(ptr, std::align_val_t{alignof(T)});
+    }
+
+    template <typename U>
+    bool operator==(const BudgetAllocator<U, Subsystem>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const BudgetAllocator<U, Subsystem>&) const noexcept { return false; }
+};
+
+} // namespace core
+} // namespace lattice
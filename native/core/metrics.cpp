@@ -0,0 +1,299 @@
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+constexpr size_t MAX_SHARDS = 64;
+constexpr char MAGIC[4] = {'L', 'M', 'S', '1'};
+
+size_t computeShardCount() {
+    const size_t cpus = std::max<size_t>(1, std::thread::hardware_concurrency());
+    return std::min(MAX_SHARDS, std::bit_ceil(cpus));
+}
+
+int64_t monotonicNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void putLittle(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void putDouble(std::vector<uint8_t>& out, double value) {
+    putLittle(out, std::bit_cast<uint64_t>(value), 8);
+}
+
+// u16长度 + UTF-8字节，超长部分截断
+void putString(std::vector<uint8_t>& out, const std::string& text) {
+    const size_t length = std::min<size_t>(text.size(), UINT16_MAX);
+    putLittle(out, length, 2);
+    out.insert(out.end(), text.begin(), text.begin() + static_cast<std::ptrdiff_t>(length));
+}
+
+} // namespace
+
+namespace detail {
+
+size_t metricShardCount() {
+    static const size_t count = computeShardCount();
+    return count;
+}
+
+size_t currentMetricShard() {
+#if defined(__linux__)
+    // vDSO实现，几纳秒；线程迁移后短暂落在旧分片上不影响正确性
+    const int cpu = sched_getcpu();
+    if (cpu >= 0) {
+        return static_cast<size_t>(cpu) & (metricShardCount() - 1);
+    }
+#endif
+    thread_local const size_t shard =
+        std::hash<std::thread::id>{}(std::this_thread::get_id()) & (metricShardCount() - 1);
+    return shard;
+}
+
+} // namespace detail
+
+// ====== Counter ======
+
+Counter::Counter() : shards_(new detail::CounterShard[detail::metricShardCount()]) {}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < detail::metricShardCount(); ++i) {
+        total += shards_[i].value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// ====== Histogram ======
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)) {
+    std::sort(bounds_.begin(), bounds_.end());
+    bounds_.erase(std::unique(bounds_.begin(), bounds_.end()), bounds_.end());
+    // 最后一个桶是+Inf
+    linesPerShard_ = (bounds_.size() + 1 + COUNTS_PER_LINE - 1) / COUNTS_PER_LINE;
+    lines_.reset(new CountLine[detail::metricShardCount() * linesPerShard_]);
+    sums_.reset(new SumShard[detail::metricShardCount()]);
+    for (size_t i = 0; i < detail::metricShardCount() * linesPerShard_; ++i) {
+        for (auto& count : lines_[i].counts) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Histogram::observe(double value) {
+    const size_t index = static_cast<size_t>(
+        std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin());
+    const size_t shard = detail::currentMetricShard();
+    bucket(shard, index).fetch_add(1, std::memory_order_relaxed);
+    sums_[shard].sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+std::vector<double> Histogram::exponentialBuckets(double start, double factor, size_t count) {
+    std::vector<double> bounds;
+    bounds.reserve(count);
+    double bound = start;
+    for (size_t i = 0; i < count; ++i) {
+        bounds.push_back(bound);
+        bound *= factor;
+    }
+    return bounds;
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot result;
+    result.bounds = bounds_;
+    result.cumulative.assign(bounds_.size() + 1, 0);
+    for (size_t shard = 0; shard < detail::metricShardCount(); ++shard) {
+        for (size_t i = 0; i <= bounds_.size(); ++i) {
+            result.cumulative[i] += bucket(shard, i).load(std::memory_order_relaxed);
+        }
+        result.sum += sums_[shard].sum.load(std::memory_order_relaxed);
+    }
+    for (size_t i = 1; i < result.cumulative.size(); ++i) {
+        result.cumulative[i] += result.cumulative[i - 1];
+    }
+    result.count = result.cumulative.back();
+    return result;
+}
+
+// ====== MetricsRegistry ======
+
+MetricsRegistry& MetricsRegistry::instance() {
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Entry* MetricsRegistry::find(MetricType type, const std::string& name, const MetricLabels& labels) {
+    for (auto& entry : entries_) {
+        if (entry.type == type && entry.callbackId == 0 && entry.name == name && entry.labels == labels) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+Counter& MetricsRegistry::counter(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* existing = find(MetricType::COUNTER, name, labels)) {
+        return *existing->counter;
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.type = MetricType::COUNTER;
+    entry.name = name;
+    entry.help = help;
+    entry.labels = labels;
+    entry.counter = std::make_unique<Counter>();
+    return *entry.counter;
+}
+
+Gauge& MetricsRegistry::gauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* existing = find(MetricType::GAUGE, name, labels)) {
+        return *existing->gauge;
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.type = MetricType::GAUGE;
+    entry.name = name;
+    entry.help = help;
+    entry.labels = labels;
+    entry.gauge = std::make_unique<Gauge>();
+    return *entry.gauge;
+}
+
+Histogram& MetricsRegistry::histogram(const std::string& name, const std::string& help,
+                                      const std::vector<double>& bounds, const MetricLabels& labels) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (Entry* existing = find(MetricType::HISTOGRAM, name, labels)) {
+        return *existing->histogram;
+    }
+    Entry& entry = entries_.emplace_back();
+    entry.type = MetricType::HISTOGRAM;
+    entry.name = name;
+    entry.help = help;
+    entry.labels = labels;
+    entry.histogram = std::make_unique<Histogram>(bounds);
+    return *entry.histogram;
+}
+
+uint64_t MetricsRegistry::addCallback(MetricType type, const std::string& name, const std::string& help,
+                                      const MetricLabels& labels, std::function<double()> read) {
+    if (type == MetricType::HISTOGRAM || !read) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_.emplace_back();
+    entry.type = type;
+    entry.name = name;
+    entry.help = help;
+    entry.labels = labels;
+    entry.read = std::move(read);
+    entry.callbackId = nextCallbackId_++;
+    return entry.callbackId;
+}
+
+void MetricsRegistry::removeCallback(uint64_t id) {
+    if (id == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    // 回调指标可以从中间删除：热路径只持有counter/gauge/histogram的引用，不持有回调项
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->callbackId == id) {
+            entries_.erase(it);
+            return;
+        }
+    }
+}
+
+std::vector<MetricSample> MetricsRegistry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<MetricSample> samples;
+    samples.reserve(entries_.size());
+    for (const auto& entry : entries_) {
+        MetricSample& sample = samples.emplace_back();
+        sample.type = entry.type;
+        sample.name = entry.name;
+        sample.help = entry.help;
+        sample.labels = entry.labels;
+        if (entry.read) {
+            sample.value = entry.read();
+        } else if (entry.counter) {
+            sample.value = static_cast<double>(entry.counter->value());
+        } else if (entry.gauge) {
+            sample.value = entry.gauge->value();
+        } else if (entry.histogram) {
+            sample.histogram = entry.histogram->snapshot();
+        }
+    }
+    return samples;
+}
+
+/**
+ * 编码格式（小端）：
+ *   "LMS1"  u32 指标数
+ *   每个指标：u8 类型  str 名字  str 说明  u16 标签数  (str 键  str 值)*
+ *     COUNTER/GAUGE：f64 数值
+ *     HISTOGRAM：u16 上界数n  (f64 上界  u64 累计计数)*n  u64 总数（+Inf）  f64 总和
+ *   str为u16长度 + UTF-8字节
+ */
+std::vector<uint8_t> MetricsRegistry::encodeSnapshot() const {
+    const std::vector<MetricSample> samples = snapshot();
+    std::vector<uint8_t> out;
+    out.reserve(64 + samples.size() * 96);
+    out.insert(out.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    putLittle(out, samples.size(), 4);
+    for (const auto& sample : samples) {
+        out.push_back(static_cast<uint8_t>(sample.type));
+        putString(out, sample.name);
+        putString(out, sample.help);
+        const size_t labelCount = std::min<size_t>(sample.labels.size(), UINT16_MAX);
+        putLittle(out, labelCount, 2);
+        for (size_t i = 0; i < labelCount; ++i) {
+            putString(out, sample.labels[i].first);
+            putString(out, sample.labels[i].second);
+        }
+        if (sample.type == MetricType::HISTOGRAM) {
+            const auto& histogram = sample.histogram;
+            putLittle(out, histogram.bounds.size(), 2);
+            for (size_t i = 0; i < histogram.bounds.size(); ++i) {
+                putDouble(out, histogram.bounds[i]);
+                putLittle(out, histogram.cumulative[i], 8);
+            }
+            putLittle(out, histogram.count, 8);
+            putDouble(out, histogram.sum);
+        } else {
+            putDouble(out, sample.value);
+        }
+    }
+    return out;
+}
+
+// ====== ScopedHistogramTimer ======
+
+ScopedHistogramTimer::ScopedHistogramTimer(Histogram& histogram)
+    : histogram_(histogram), start_(monotonicNanos()) {}
+
+ScopedHistogramTimer::~ScopedHistogramTimer() {
+    histogram_.observe(static_cast<double>(monotonicNanos() - start_) * 1e-9);
+}
+
+} // namespace core
+} // namespace lattice
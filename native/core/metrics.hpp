@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lattice {
+namespace core {
+
+// ====== 统一指标注册表 ======
+//
+// 各子系统原本各有一个统计结构体（CompressionStats、AnvilPerformanceStats、RedstoneEngine::PerformanceStats、
+// DecisionStats……），每个都要单独的JNI调用取回。这里把计数器、仪表、直方图注册到同一个注册表，
+// snapshot()一次取出全部指标（名字、标签、数值），由Java侧的导出器（NativeMetrics.java）转成Prometheus文本。
+//
+// 与Tracer相同，每个桥接库各有一份注册表；导出器为每个库加上library标签后合并。
+
+enum class MetricType : uint8_t {
+    COUNTER = 0,
+    GAUGE = 1,
+    HISTOGRAM = 2
+};
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+namespace detail {
+
+// 分片数：CPU数向上取2的幂，最多64
+size_t metricShardCount();
+// 当前线程所在CPU对应的分片（Linux上sched_getcpu，其他平台按线程散列）
+size_t currentMetricShard();
+
+struct alignas(64) CounterShard {
+    std::atomic<uint64_t> value{0};
+};
+
+} // namespace detail
+
+/**
+ * @brief 单调递增的计数器
+ *
+ * 每个CPU一个独占缓存行的分片，inc()只做一次relaxed fetch_add，多线程热路径上没有缓存行争用；
+ * value()汇总所有分片
+ */
+class Counter {
+public:
+    Counter();
+
+    void inc(uint64_t delta = 1) {
+        shards_[detail::currentMetricShard()].value.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    uint64_t value() const;
+
+private:
+    std::unique_ptr<detail::CounterShard[]> shards_;
+};
+
+/**
+ * @brief 当前值（队列长度、缓存字节数等）
+ *
+ * 仪表记录的是最后一次set()的值，分片无法合并，只用一个原子量；频繁add()的场景应改用两个计数器
+ */
+class Gauge {
+public:
+    void set(double value) { value_.store(value, std::memory_order_relaxed); }
+    void add(double delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+    double value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<double> value_{0.0};
+};
+
+/**
+ * @brief 固定桶的直方图（Prometheus的le桶，数值单位由指标名决定，耗时统一用秒）
+ *
+ * 每个分片有自己的桶计数与总和；observe()二分查找桶后做两次relaxed原子加
+ */
+class Histogram {
+public:
+    explicit Histogram(std::vector<double> bounds);
+
+    void observe(double value);
+
+    // 从start开始每个桶乘以factor，共count个上界
+    static std::vector<double> exponentialBuckets(double start, double factor, size_t count);
+    // 10微秒到约1.3秒，用于各类耗时
+    static std::vector<double> latencyBuckets() { return exponentialBuckets(1e-5, 2.0, 18); }
+
+    struct Snapshot {
+        std::vector<double> bounds;
+        std::vector<uint64_t> cumulative;   // 与bounds对应的累计计数，最后一个是+Inf
+        double sum = 0.0;
+        uint64_t count = 0;
+    };
+    Snapshot snapshot() const;
+
+private:
+    static constexpr size_t COUNTS_PER_LINE = 8;
+
+    // 分片的桶计数按缓存行连续排列，分片之间不共享缓存行
+    struct alignas(64) CountLine {
+        std::atomic<uint64_t> counts[COUNTS_PER_LINE];
+    };
+    struct alignas(64) SumShard {
+        std::atomic<double> sum{0.0};
+    };
+
+    std::atomic<uint64_t>& bucket(size_t shard, size_t index) const {
+        return lines_[shard * linesPerShard_ + index / COUNTS_PER_LINE].counts[index % COUNTS_PER_LINE];
+    }
+
+    std::vector<double> bounds_;
+    size_t linesPerShard_;
+    std::unique_ptr<CountLine[]> lines_;
+    std::unique_ptr<SumShard[]> sums_;
+};
+
+/**
+ * @brief snapshot()中的一个指标
+ */
+struct MetricSample {
+    MetricType type;
+    std::string name;
+    std::string help;
+    MetricLabels labels;
+    double value = 0.0;                     // COUNTER/GAUGE
+    Histogram::Snapshot histogram;          // HISTOGRAM
+};
+
+/**
+ * @brief 本库的指标注册表（进程内每个桥接库一份）
+ *
+ * counter()/gauge()/histogram()按名字加标签查找或创建，返回的引用在库的生命周期内有效，
+ * 热路径上应缓存引用（函数内static或成员），不要每次查找。
+ *
+ * 已有统计结构体的实例（每个AnvilChunkIO、每个引擎）用addCallback()注册读取函数，
+ * snapshot时调用；对象析构前必须removeCallback()，返回后回调不会再被调用。
+ */
+class MetricsRegistry {
+public:
+    static MetricsRegistry& instance();
+
+    Counter& counter(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Gauge& gauge(const std::string& name, const std::string& help, const MetricLabels& labels = {});
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         const std::vector<double>& bounds, const MetricLabels& labels = {});
+
+    // 回调指标（COUNTER或GAUGE），返回用于removeCallback的编号
+    uint64_t addCallback(MetricType type, const std::string& name, const std::string& help,
+                         const MetricLabels& labels, std::function<double()> read);
+    void removeCallback(uint64_t id);
+
+    // 按注册顺序取出所有指标
+    std::vector<MetricSample> snapshot() const;
+
+    /**
+     * 把snapshot()编码为小端二进制（JNI与FFI共用，格式见metrics.cpp的encodeSnapshot）
+     */
+    std::vector<uint8_t> encodeSnapshot() const;
+
+private:
+    struct Entry {
+        MetricType type;
+        std::string name;
+        std::string help;
+        MetricLabels labels;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+        std::function<double()> read;       // 回调指标
+        uint64_t callbackId = 0;
+    };
+
+    MetricsRegistry() = default;
+
+    Entry* find(MetricType type, const std::string& name, const MetricLabels& labels);
+
+    mutable std::mutex mutex_;              // 保护entries_；注册与snapshot时获取，热路径不获取
+    std::deque<Entry> entries_;             // deque保证注册后元素地址不变
+    uint64_t nextCallbackId_ = 1;
+};
+
+/**
+ * @brief 作用域耗时，析构时以秒为单位记入直方图
+ */
+class ScopedHistogramTimer {
+public:
+    explicit ScopedHistogramTimer(Histogram& histogram);
+    ~ScopedHistogramTimer();
+
+    ScopedHistogramTimer(const ScopedHistogramTimer&) = delete;
+    ScopedHistogramTimer& operator=(const ScopedHistogramTimer&) = delete;
+
+private:
+    Histogram& histogram_;
+    int64_t start_;
+};
+
+} // namespace core
+} // namespace lattice
@@ -0,0 +1,238 @@
+#pragma once
+
+#include "threadpool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace lattice {
+namespace core {
+
+// ====== 进程级native线程预算 ======
+
+enum class NativeSubsystem : uint8_t {
+    GENERAL,        // 共享线程池：AI并行tick、红石区域并行等
+    COMPRESSION,    // AsyncCompressor
+    PATHFINDING,    // PathService
+    CHUNK_IO,       // io_uring完成线程
+    ENTITY_SYNC,    // AsyncEntitySync后台线程
+    AI,             // AIEngine显式指定线程数时的专用线程池
+    RING,           // 共享内存环（RingChannel）的命令分发线程
+    COUNT
+};
+
+inline constexpr size_t NATIVE_SUBSYSTEM_COUNT = static_cast<size_t>(NativeSubsystem::COUNT);
+
+// 用作线程名前缀（Linux线程名最多15个字符），保持简短
+inline const char* nativeSubsystemName(NativeSubsystem subsystem) {
+    static constexpr std::array<const char*, NATIVE_SUBSYSTEM_COUNT> NAMES = {
+        "pool", "zlib", "path", "uring", "esync", "ai", "ring"
+    };
+    return NAMES[static_cast<size_t>(subsystem)];
+}
+
+struct NativeRuntimeConfig {
+    int totalThreads = -1;          // 计算线程总预算，-1表示硬件线程数的一半（其余留给JVM）
+    int compressionThreads = -1;    // -1表示从预算中自动分配
+    bool pinThreads = false;        // 把每个native线程绑定到一个核心
+    int mainThreadCpu = -1;         // 主服务器线程所在核心，绑核时不使用；-1表示不避开
+};
+
+/**
+ * @brief 进程内所有native工作线程的统一预算
+ *
+ * 各子系统不再各自按hardware_concurrency()起线程，而是向这里查询线程数（threadsFor），
+ * 通过startThread / createPool创建线程。这样线程总数由一份配置（LatticeConfig经JNI传入）决定，
+ * 同时可以统一命名线程、按需绑核，并统计每个子系统当前存活的线程数。
+ *
+ * 预算只分给计算线程：压缩和寻路按比例分得一部分，其余归共享线程池；
+ * io_uring完成线程和实体同步线程是固定的单个线程，不占预算。
+ * configure应在各子系统第一次启动线程之前调用；之后调用只影响之后创建的线程和线程池。
+ */
+class NativeRuntime {
+public:
+    static NativeRuntime& instance() {
+        static NativeRuntime runtime;
+        return runtime;
+    }
+
+    void configure(const NativeRuntimeConfig& config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        config_ = config;
+        cpus_ = usableCpus(config.mainThreadCpu);
+        if (pool_) {
+            fprintf(stderr, "NativeRuntime: shared pool already started with %zu threads; "
+                            "new budget applies to threads created later\n", pool_->size());
+        }
+    }
+
+    NativeRuntimeConfig config() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_;
+    }
+
+    int threadBudget() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return budgetLocked();
+    }
+
+    int threadsFor(NativeSubsystem subsystem) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return threadsForLocked(subsystem);
+    }
+
+    /**
+     * 共享的工作窃取线程池，首次使用时按预算创建
+     * 没有专门线程需求的子系统都在这里执行，不再自己起线程
+     */
+    ThreadPool& pool() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pool_) {
+            pool_ = createPoolLocked(NativeSubsystem::GENERAL,
+                                     static_cast<size_t>(threadsForLocked(NativeSubsystem::GENERAL)));
+        }
+        return *pool_;
+    }
+
+    // 子系统专用的线程池；threads为0时按预算取该子系统的线程数
+    std::unique_ptr<ThreadPool> createPool(NativeSubsystem subsystem, size_t threads = 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (threads == 0) {
+            threads = static_cast<size_t>(threadsForLocked(subsystem));
+        }
+        return createPoolLocked(subsystem, threads);
+    }
+
+    // 启动属于某个子系统的线程：在新线程内完成命名、绑核与计数后再执行body
+    template <class Body>
+    std::thread startThread(NativeSubsystem subsystem, Body&& body) {
+        return std::thread([this, subsystem, body = std::forward<Body>(body)]() mutable {
+            threadStarted(subsystem);
+            body();
+            threadExited(subsystem);
+        });
+    }
+
+    int liveThreads(NativeSubsystem subsystem) const {
+        return live_[static_cast<size_t>(subsystem)].load(std::memory_order_relaxed);
+    }
+
+    int totalLiveThreads() const {
+        int total = 0;
+        for (const auto& count : live_) {
+            total += count.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    NativeRuntime()
+        : cpus_(usableCpus(-1)) {}
+
+    int budgetLocked() const {
+        if (config_.totalThreads > 0) {
+            return config_.totalThreads;
+        }
+        return std::max(2, static_cast<int>(std::thread::hardware_concurrency()) / 2);
+    }
+
+    int threadsForLocked(NativeSubsystem subsystem) const {
+        const int budget = budgetLocked();
+        const int compression = config_.compressionThreads > 0
+                                    ? config_.compressionThreads
+                                    : std::clamp(budget / 4, 1, 8);
+        const int pathfinding = std::clamp(budget / 4, 1, 4);
+        switch (subsystem) {
+            case NativeSubsystem::COMPRESSION: return compression;
+            case NativeSubsystem::PATHFINDING: return pathfinding;
+            case NativeSubsystem::CHUNK_IO:
+            case NativeSubsystem::ENTITY_SYNC:
+            case NativeSubsystem::RING: return 1;
+            case NativeSubsystem::GENERAL:
+            case NativeSubsystem::AI:
+            default: return std::max(1, budget - compression - pathfinding);
+        }
+    }
+
+    std::unique_ptr<ThreadPool> createPoolLocked(NativeSubsystem subsystem, size_t threads) {
+        ThreadPool::WorkerHooks hooks;
+        hooks.onStart = [this, subsystem](size_t) { threadStarted(subsystem); };
+        hooks.onExit = [this, subsystem](size_t) { threadExited(subsystem); };
+        return std::make_unique<ThreadPool>(std::max<size_t>(1, threads), std::move(hooks));
+    }
+
+    void threadStarted(NativeSubsystem subsystem) {
+        const int serial = live_[static_cast<size_t>(subsystem)].fetch_add(1, std::memory_order_relaxed);
+#ifdef __linux__
+        std::string name = std::string("lt-") + nativeSubsystemName(subsystem) + "-" + std::to_string(serial);
+        name.resize(std::min<size_t>(name.size(), 15));
+        pthread_setname_np(pthread_self(), name.c_str());
+
+        int cpu = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (config_.pinThreads && !cpus_.empty()) {
+                cpu = cpus_[nextCpu_++ % cpus_.size()];
+            }
+        }
+        if (cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+                fprintf(stderr, "NativeRuntime: failed to pin %s thread to cpu %d\n",
+                        nativeSubsystemName(subsystem), cpu);
+            }
+        }
+#else
+        (void)serial;
+#endif
+    }
+
+    void threadExited(NativeSubsystem subsystem) {
+        live_[static_cast<size_t>(subsystem)].fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // 进程允许使用的核心，去掉主服务器线程所在的核心
+    static std::vector<int> usableCpus(int excluded) {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set) && cpu != excluded) {
+                    cpus.push_back(cpu);
+                }
+            }
+        }
+#else
+        (void)excluded;
+#endif
+        return cpus;
+    }
+
+    mutable std::mutex mutex_;
+    NativeRuntimeConfig config_;
+    std::vector<int> cpus_;
+    size_t nextCpu_ = 0;
+    std::array<std::atomic<int>, NATIVE_SUBSYSTEM_COUNT> live_{};
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+} // namespace core
+} // namespace lattice
@@ -0,0 +1,254 @@
+#include "arena_page_allocator.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+namespace lattice {
+namespace net {
+
+namespace {
+
+enum AllocationKind : uint8_t {
+    KIND_MALLOC = 0,
+    KIND_SLAB_BLOCK = 1,
+    KIND_MAPPING = 2
+};
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace
+
+ArenaPageAllocator& ArenaPageAllocator::instance() {
+    static ArenaPageAllocator allocator;
+    return allocator;
+}
+
+void ArenaPageAllocator::configure(const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t blockSize = config_.blockSize;
+    config_ = config;
+    if (stats_.slabs > 0) {
+        // 已有slab按原块大小切分，空闲列表中的块不能换尺寸
+        config_.blockSize = blockSize;
+    } else {
+        config_.blockSize = std::clamp<size_t>(roundUp(config.blockSize, 4096), 4096, HUGE_PAGE_SIZE);
+    }
+}
+
+ArenaPageAllocator::Config ArenaPageAllocator::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+bool ArenaPageAllocator::transparentHugePagesAvailable() {
+    // 内容形如"always [madvise] never"，方括号内为当前模式
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/enabled");
+    std::string content;
+    if (!file || !std::getline(file, content)) {
+        return false;
+    }
+    return content.find("[always]") != std::string::npos || content.find("[madvise]") != std::string::npos;
+}
+
+size_t ArenaPageAllocator::hugeTlbPagesFree() {
+    std::ifstream file("/proc/meminfo");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("HugePages_Free:", 0) == 0) {
+            try {
+                return static_cast<size_t>(std::stoull(line.substr(15)));
+            } catch (...) {
+                return 0;
+            }
+        }
+    }
+    return 0;
+}
+
+int ArenaPageAllocator::currentNumaNode() {
+#ifdef SYS_getcpu
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return -1;
+}
+
+void* ArenaPageAllocator::mapRegion(size_t size, bool& usedHugeTlb) {
+    usedHugeTlb = false;
+#ifdef MAP_HUGETLB
+    if (config_.policy == Policy::HUGE_PAGE_HUGETLB) {
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            usedHugeTlb = true;
+            return ptr;
+        }
+        // 预留页不足：回退到透明大页
+        ++stats_.hugetlbFallbacks;
+    }
+#endif
+
+    // 多映射一个大页再裁掉两端，得到2MB对齐的区域，THP才能用整页映射
+    const size_t reserve = size + HUGE_PAGE_SIZE;
+    void* raw = mmap(nullptr, reserve, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = roundUp(begin, HUGE_PAGE_SIZE);
+    if (aligned > begin) {
+        munmap(raw, aligned - begin);
+    }
+    const uintptr_t end = begin + reserve;
+    if (end > aligned + size) {
+        munmap(reinterpret_cast<void*>(aligned + size), end - (aligned + size));
+    }
+    void* ptr = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    return ptr;
+}
+
+void ArenaPageAllocator::bindToNode(void* ptr, size_t size, int node) {
+    if (!config_.numaBind || node < 0 || static_cast<size_t>(node) >= MAX_NUMA_NODES) {
+        return;
+    }
+#ifdef SYS_mbind
+    // 页面尚未被访问，首次缺页时按策略在该节点分配
+    unsigned long mask = 1ul << node;
+    if (syscall(SYS_mbind, ptr, size, MPOL_PREFERRED, &mask, MAX_NUMA_NODES + 1, 0) != 0) {
+        ++stats_.numaBindFailures;
+    }
+#else
+    (void)ptr;
+    (void)size;
+    ++stats_.numaBindFailures;
+#endif
+}
+
+bool ArenaPageAllocator::refillLocked(NodePool& pool, int node) {
+    bool usedHugeTlb = false;
+    void* slab = mapRegion(HUGE_PAGE_SIZE, usedHugeTlb);
+    if (!slab) {
+        return false;
+    }
+    bindToNode(slab, HUGE_PAGE_SIZE, node);
+
+    pool.slabs.push_back(slab);
+    ++stats_.slabs;
+    stats_.slabBytes += HUGE_PAGE_SIZE;
+    if (usedHugeTlb) {
+        ++stats_.hugetlbSlabs;
+    }
+    // 倒序压入，先分配slab开头的块
+    const size_t blocks = HUGE_PAGE_SIZE / config_.blockSize;
+    for (size_t i = blocks; i-- > 0;) {
+        pool.freeBlocks.push_back(static_cast<char*>(slab) + i * config_.blockSize);
+    }
+    stats_.freeBlocks += blocks;
+    return true;
+}
+
+ArenaPageAllocator::Allocation ArenaPageAllocator::allocate(size_t size, size_t alignment) {
+    Allocation allocation;
+    if (size == 0) {
+        return allocation;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (config_.policy != Policy::MALLOC) {
+            const int node = config_.numaBind ? currentNumaNode() : -1;
+            const size_t poolIndex = node >= 0 && static_cast<size_t>(node) < MAX_NUMA_NODES
+                ? static_cast<size_t>(node) : MAX_NUMA_NODES;
+            allocation.node = static_cast<int16_t>(poolIndex);
+
+            if (size <= config_.blockSize && alignment <= 4096) {
+                NodePool& pool = pools_[poolIndex];
+                if (!pool.freeBlocks.empty() || refillLocked(pool, node)) {
+                    allocation.ptr = pool.freeBlocks.back();
+                    pool.freeBlocks.pop_back();
+                    allocation.size = config_.blockSize;
+                    allocation.kind = KIND_SLAB_BLOCK;
+                    --stats_.freeBlocks;
+                    ++stats_.blocksInUse;
+                    return allocation;
+                }
+            } else if (alignment <= HUGE_PAGE_SIZE) {
+                const size_t mappedSize = roundUp(size, HUGE_PAGE_SIZE);
+                bool usedHugeTlb = false;
+                void* ptr = mapRegion(mappedSize, usedHugeTlb);
+                if (ptr) {
+                    bindToNode(ptr, mappedSize, node);
+                    allocation.ptr = ptr;
+                    allocation.size = mappedSize;
+                    allocation.kind = KIND_MAPPING;
+                    ++stats_.largeMappings;
+                    stats_.largeBytes += mappedSize;
+                    return allocation;
+                }
+            }
+            // mmap失败：回退到普通分配
+        }
+    }
+
+    const size_t alignedSize = roundUp(size, alignment);
+    allocation.ptr = std::aligned_alloc(alignment, alignedSize);
+    if (!allocation.ptr) {
+        throw std::bad_alloc();
+    }
+    allocation.size = alignedSize;
+    allocation.kind = KIND_MALLOC;
+    allocation.node = -1;
+    return allocation;
+}
+
+void ArenaPageAllocator::release(const Allocation& allocation) {
+    if (!allocation.ptr) {
+        return;
+    }
+    switch (allocation.kind) {
+        case KIND_SLAB_BLOCK: {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pools_[allocation.node].freeBlocks.push_back(allocation.ptr);
+            ++stats_.freeBlocks;
+            --stats_.blocksInUse;
+            break;
+        }
+        case KIND_MAPPING: {
+            munmap(allocation.ptr, allocation.size);
+            std::lock_guard<std::mutex> lock(mutex_);
+            --stats_.largeMappings;
+            stats_.largeBytes -= allocation.size;
+            break;
+        }
+        default:
+            std::free(allocation.ptr);
+            break;
+    }
+}
+
+ArenaPageAllocator::Stats ArenaPageAllocator::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace net
+} // namespace lattice
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace lattice {
+namespace net {
+
+/**
+ * ArenaPageAllocator - MemoryArena块的底层内存来源
+ *
+ * MALLOC策略保持原来的aligned_alloc行为。大页策略下，块从2MB对齐的slab中切出：
+ * - HUGE_PAGE_MADVISE：mmap匿名内存后madvise(MADV_HUGEPAGE)，由透明大页(THP)提供2MB页
+ * - HUGE_PAGE_HUGETLB：mmap(MAP_HUGETLB)使用预留的hugetlbfs页，失败时回退到MADVISE
+ *
+ * 开启numaBind时，slab通过mbind(MPOL_PREFERRED)绑定到分配线程所在的NUMA节点，
+ * 每个节点单独维护slab与空闲块，块释放后回到原节点的空闲列表，slab本身不归还系统。
+ * 大于一个slab的请求单独mmap（按2MB取整），释放时直接munmap。
+ *
+ * 不依赖libnuma：节点通过getcpu获取，绑定直接调用mbind系统调用，内核不支持时静默跳过。
+ */
+class ArenaPageAllocator {
+public:
+    enum class Policy : uint8_t {
+        MALLOC = 0,
+        HUGE_PAGE_MADVISE = 1,
+        HUGE_PAGE_HUGETLB = 2
+    };
+
+    struct Config {
+        Policy policy = Policy::MALLOC;
+        bool numaBind = true;
+        size_t blockSize = 128 * 1024;       // slab切分的块大小，与MemoryArena::DEFAULT_BLOCK_SIZE一致
+    };
+
+    struct Stats {
+        size_t slabs{0};
+        size_t slabBytes{0};
+        size_t hugetlbSlabs{0};
+        size_t blocksInUse{0};
+        size_t freeBlocks{0};
+        size_t largeMappings{0};
+        size_t largeBytes{0};
+        size_t numaBindFailures{0};
+        size_t hugetlbFallbacks{0};
+    };
+
+    // 一次分配的结果；释放时原样交回
+    struct Allocation {
+        void* ptr{nullptr};
+        size_t size{0};          // 实际可用大小（slab块为blockSize，单独映射按2MB取整）
+        uint8_t kind{0};         // 内部使用：0=malloc，1=slab块，2=单独映射
+        int16_t node{-1};
+    };
+
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr size_t MAX_NUMA_NODES = 64;
+
+    static ArenaPageAllocator& instance();
+
+    // 修改策略只影响之后的分配；已分配的块按分配时的方式释放
+    void configure(const Config& config);
+    Config getConfig() const;
+
+    Allocation allocate(size_t size, size_t alignment);
+    void release(const Allocation& allocation);
+
+    Stats getStats() const;
+
+    // 系统能力检测
+    static bool transparentHugePagesAvailable();     // THP为always或madvise
+    static size_t hugeTlbPagesFree();                // /proc/meminfo中的HugePages_Free
+    static int currentNumaNode();                    // 不可用时返回-1
+
+private:
+    ArenaPageAllocator() = default;
+
+    struct NodePool {
+        std::vector<void*> freeBlocks;
+        std::vector<void*> slabs;
+    };
+
+    void* mapRegion(size_t size, bool& usedHugeTlb);
+    void bindToNode(void* ptr, size_t size, int node);
+    bool refillLocked(NodePool& pool, int node);
+
+    mutable std::mutex mutex_;
+    Config config_;
+    NodePool pools_[MAX_NUMA_NODES + 1];             // 最后一个用于节点未知的情况
+    Stats stats_;
+};
+
+} // namespace net
+} // namespace lattice
@@ -1,4 +1,6 @@
 #include "async_compressor.hpp"
+#include "../native_runtime.hpp"
+#include "../tick_budget.hpp"
 #include <iostream>
 #include <algorithm>
 #include <thread>
@@ -6,25 +8,49 @@
 namespace lattice {
 namespace net {
 
-AsyncCompressor::AsyncCompressor(int workerCount) : stop_(false) {
+namespace {
+
+// 每个任务前因主线程tick超时最多等待的时间
+constexpr std::chrono::microseconds COMPRESSION_MAX_PAUSE{2000};
+
+} // namespace
+
+AsyncCompressor::AsyncCompressor(int workerCount)
+    : workers_(new Worker[MAX_WORKERS]), stop_(false) {
     if (workerCount == -1) {
-        // 自动检测硬件并发数
-        unsigned int detected = std::thread::hardware_concurrency();
-        // 默认策略：使用 (N-1) 个核心，最多 8 个，最少 1 个
-        int defaultWorkers = std::max(1, std::min(8, (int)detected - 1));
-        workerCount_ = (detected > 0) ? defaultWorkers : 4;
+        // 从进程级线程预算中取压缩线程数
+        workerCount_ = std::clamp(DynamicCompression::suggestWorkerCount(), 1, MAX_WORKERS);
     } else {
-        workerCount_ = std::max(1, workerCount);
+        workerCount_ = std::clamp(workerCount, 1, MAX_WORKERS);
     }
     
+    std::lock_guard<std::mutex> lock(controlMutex_);
     ensureWorkers();
 }
 
 AsyncCompressor::~AsyncCompressor() {
-    stop_ = true;
-    cv_.notify_all();
-    for (auto& w : workers_) {
-        if (w.joinable()) w.join();
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    stop_.store(true);
+    const int slots = slotsUsed_.load();
+    for (int i = 0; i < slots; ++i) {
+        wake(i);
+    }
+    for (int i = 0; i < slots; ++i) {
+        if (workers_[i].thread.joinable()) workers_[i].thread.join();
+    }
+
+    // 未执行的任务直接丢弃（与关闭前的行为一致，不再回调）
+    for (int i = 0; i < slots; ++i) {
+        Worker& worker = workers_[i];
+        while (TaskNode* node = worker.deque.pop()) {
+            delete node;
+        }
+        TaskNode* node = worker.inbox.exchange(nullptr);
+        while (node) {
+            TaskNode* next = node->next;
+            delete node;
+            node = next;
+        }
     }
 }
 
@@ -40,81 +66,289 @@ void AsyncCompressor::compressAsync(
     std::function<void(bool, size_t)> callback) {
 
     auto task = taskPool_.acquire();
-    task->input = inputData;
-    task->output = outputBuffer;
-    task->compressionLevel = level;
-    task->callback = callback;
+    task->task.input = std::move(inputData);
+    task->task.output = std::move(outputBuffer);
+    task->task.compressionLevel = level;
+    task->task.callback = std::move(callback);
+    enqueue(std::move(task));
+}
+
+core::AsyncTask<AsyncCompressor::CompressResult> AsyncCompressor::compress(
+    std::shared_ptr<std::vector<char>> inputData,
+    std::shared_ptr<std::vector<char>> outputBuffer,
+    int level) {
+    co_return co_await core::awaitCallback<CompressResult>(
+        core::NativeRuntime::instance().pool(), [&](auto resume) {
+            compressAsync(std::move(inputData), std::move(outputBuffer), level,
+                          [resume](bool success, size_t size) { resume(CompressResult{success, size}); });
+        });
+}
+
+void AsyncCompressor::submit(std::function<void()> job) {
+    auto task = taskPool_.acquire();
+    task->job = std::move(job);
+    enqueue(std::move(task));
+}
+
+void AsyncCompressor::parallelFor(size_t count, const std::function<void(size_t)>& body, size_t helpers) {
+    if (count == 0) {
+        return;
+    }
+
+    struct Shared {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> completed{0};
+        size_t count{0};
+        std::function<void(size_t)> body;
+    };
+    auto shared = std::make_shared<Shared>();
+    shared->count = count;
+    shared->body = body;
+
+    auto runShare = [](Shared& state) {
+        for (;;) {
+            const size_t index = state.next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= state.count) {
+                return;
+            }
+            state.body(index);
+            if (state.completed.fetch_add(1, std::memory_order_acq_rel) + 1 == state.count) {
+                state.completed.notify_all();
+            }
+        }
+    };
+
+    // 晚到的协助任务只会看到下标已分完，不再访问调用者的数据
+    const size_t workers = static_cast<size_t>(std::max(1, activeWorkers_.load(std::memory_order_acquire)));
+    const size_t helperCount = std::min(count - 1, helpers > 0 ? helpers : workers);
+    for (size_t i = 0; i < helperCount; ++i) {
+        auto task = taskPool_.acquire();
+        task->job = [shared, runShare] { runShare(*shared); };
+        enqueue(std::move(task));
+    }
+
+    runShare(*shared);
+    size_t done = shared->completed.load(std::memory_order_acquire);
+    while (done < count) {
+        shared->completed.wait(done, std::memory_order_acquire);
+        done = shared->completed.load(std::memory_order_acquire);
+    }
+}
+
+void AsyncCompressor::enqueue(std::unique_ptr<TaskNode> task) {
+    // 每个提交线程独立轮转，不共享计数器
+    thread_local uint32_t cursor = static_cast<uint32_t>(
+        std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    const int active = std::max(1, activeWorkers_.load(std::memory_order_acquire));
+    const int target = static_cast<int>(cursor++ % static_cast<uint32_t>(active));
+
+    Worker& worker = workers_[target];
+    TaskNode* node = task.release();
+    TaskNode* head = worker.inbox.load(std::memory_order_relaxed);
+    do {
+        node->next = head;
+    } while (!worker.inbox.compare_exchange_weak(head, node, std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed));
+    submitted_.fetch_add(1, std::memory_order_relaxed);
+
+    // 与workerLoop中"先置parked再复查收件箱"配对：两边至少有一方看到对方
+    if (worker.parked.load(std::memory_order_seq_cst)) {
+        wake(target);
+    }
+    // 目标线程在选择之后被setWorkerCount移除：唤醒0号线程清扫遗留的收件箱
+    if (target >= activeWorkers_.load(std::memory_order_acquire)) {
+        wake(0);
+    }
+}
+
+void AsyncCompressor::wake(int index) {
+    Worker& worker = workers_[index];
+    worker.signal.fetch_add(1, std::memory_order_seq_cst);
+    worker.signal.notify_one();
+}
 
-    {
-        std::lock_guard<std::mutex> lock(queueMutex_);
-        taskQueue_.push(std::move(*task));
+size_t AsyncCompressor::drainInbox(Worker& from, Worker& owner) {
+    TaskNode* node = from.inbox.exchange(nullptr, std::memory_order_seq_cst);
+    // 收件箱是后进先出链表：按链表顺序压入后，最早提交的任务位于deque底部，
+    // 所有者先执行它，窃取者从顶部取较新的任务
+    size_t moved = 0;
+    while (node) {
+        TaskNode* next = node->next;
+        node->next = nullptr;
+        owner.deque.push(node);
+        node = next;
+        moved++;
     }
-    cv_.notify_one();
+    return moved;
 }
 
-void AsyncCompressor::workerLoop() {
-    while (!stop_) {
-        std::unique_lock<std::mutex> lock(queueMutex_);
-        cv_.wait(lock, [this] { return stop_ || !taskQueue_.empty(); });
+AsyncCompressor::TaskNode* AsyncCompressor::findWork(int index) {
+    Worker& self = workers_[index];
+    if (TaskNode* node = self.deque.pop()) {
+        return node;
+    }
 
-        if (stop_ && taskQueue_.empty()) break;
+    const int slots = slotsUsed_.load(std::memory_order_acquire);
+    const size_t moved = drainInbox(self, self);
+    if (moved > 0) {
+        // 一次转入多个任务：唤醒一个空闲线程来窃取
+        if (moved > 1) {
+            for (int i = 0; i < slots; ++i) {
+                if (i != index && workers_[i].parked.load(std::memory_order_relaxed)) {
+                    wake(i);
+                    break;
+                }
+            }
+        }
+        return self.deque.pop();
+    }
 
-        auto task = std::move(taskQueue_.front());
-        taskQueue_.pop();
-        lock.unlock();
+    // 窃取：其他线程的deque顶部，或整批取走其收件箱（包括已移除线程遗留的收件箱）
+    for (int k = 1; k < slots; ++k) {
+        Worker& victim = workers_[(index + k) % slots];
+        if (TaskNode* node = victim.deque.steal()) {
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+            return node;
+        }
+        if (victim.inbox.load(std::memory_order_relaxed) && drainInbox(victim, self) > 0) {
+            stolen_.fetch_add(1, std::memory_order_relaxed);
+            return self.deque.pop();
+        }
+    }
+    return nullptr;
+}
 
-        // 执行压缩
+void AsyncCompressor::execute(TaskNode* raw) {
+    std::unique_ptr<TaskNode> node(raw);
+    if (node->job) {
+        node->job();
+        executed_.fetch_add(1, std::memory_order_relaxed);
+        taskPool_.release(std::move(node));
+        return;
+    }
+    CompressTask& task = node->task;
+
+    bool success = false;
+    size_t outputSize = 0;
+    try {
+        // 执行压缩（每线程每级别一个缓存的压缩器）
         auto compressor = NativeCompressor::forThread(task.compressionLevel);
         size_t result = compressor->compressZlib(
             task.input->data(), task.input->size(),
             task.output->data(), task.output->capacity()
         );
-
-        bool success = (result > 0);
-        size_t outputSize = success ? result : 0;
+        success = (result > 0);
+        outputSize = success ? result : 0;
         
         if (success) {
             task.output->resize(result); // 设置实际大小
         }
+    } catch (const std::exception& e) {
+        std::cerr << "[AsyncCompressor] Compression failed: " << e.what() << std::endl;
+    }
+
+    // 回调（可能在业务线程处理）
+    if (task.callback) {
+        task.callback(success, outputSize);
+    }
+    executed_.fetch_add(1, std::memory_order_relaxed);
+    taskPool_.release(std::move(node));
+}
+
+void AsyncCompressor::workerLoop(int index) {
+    Worker& self = workers_[index];
+
+    while (!stop_.load(std::memory_order_acquire) && !self.retire.load(std::memory_order_acquire)) {
+        // 主线程tick超时期间让出核心；有界等待，积压的任务不会无限推迟
+        core::TickBudget::instance().waitWhilePaused(core::DeferrableWork::COMPRESSION, COMPRESSION_MAX_PAUSE);
+        if (TaskNode* node = findWork(index)) {
+            execute(node);
+            continue;
+        }
 
-        // 回调（可能在业务线程处理）
-        if (task.callback) {
-            task.callback(success, outputSize);
+        // 准备等待：先读计数器、置parked，再复查一次，期间的提交会让wait立即返回
+        const uint32_t observed = self.signal.load(std::memory_order_seq_cst);
+        self.parked.store(true, std::memory_order_seq_cst);
+        if (TaskNode* node = findWork(index)) {
+            self.parked.store(false, std::memory_order_relaxed);
+            execute(node);
+            continue;
         }
+        if (stop_.load() || self.retire.load()) {
+            self.parked.store(false, std::memory_order_relaxed);
+            break;
+        }
+        parks_.fetch_add(1, std::memory_order_relaxed);
+        self.signal.wait(observed, std::memory_order_seq_cst);
+        self.parked.store(false, std::memory_order_relaxed);
+    }
+
+    if (stop_.load() || !self.retire.load()) {
+        return;
+    }
+
+    // 线程被移除：剩余任务转交给仍在运行的线程
+    const int active = std::max(1, activeWorkers_.load(std::memory_order_acquire));
+    drainInbox(self, self);
+    int next = 0;
+    while (TaskNode* node = self.deque.pop()) {
+        Worker& target = workers_[next];
+        TaskNode* head = target.inbox.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!target.inbox.compare_exchange_weak(head, node, std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed));
+        wake(next);
+        next = (next + 1) % active;
     }
 }
 
 void AsyncCompressor::ensureWorkers() {
-    int target = workerCount_.load();
+    // 调用者持有controlMutex_
+    const int target = workerCount_.load();
+    const int current = activeWorkers_.load();
     
     // 如果当前线程数少于目标数，增加线程
-    while (static_cast<int>(workers_.size()) < target) {
-        workers_.emplace_back(&AsyncCompressor::workerLoop, this);
+    if (target > current) {
+        for (int i = current; i < target; ++i) {
+            workers_[i].retire.store(false);
+            workers_[i].thread = core::NativeRuntime::instance().startThread(
+                core::NativeSubsystem::COMPRESSION, [this, i] { workerLoop(i); });
+        }
+        slotsUsed_.store(std::max(slotsUsed_.load(), target), std::memory_order_release);
+        activeWorkers_.store(target, std::memory_order_release);
+        return;
     }
     
-    // 如果当前线程数多于目标数，减少线程（需要重启整个池）
-    if (static_cast<int>(workers_.size()) > target) {
-        stop_ = true;
-        cv_.notify_all();
-        for (auto& w : workers_) {
-            if (w.joinable()) w.join();
+    // 如果当前线程数多于目标数，只停止多出的线程，其任务转交给其余线程
+    if (target < current) {
+        activeWorkers_.store(target, std::memory_order_release);
+        for (int i = target; i < current; ++i) {
+            workers_[i].retire.store(true);
+            wake(i);
         }
-        workers_.clear();
-        stop_ = false;
-        
-        // 重新创建指定数量的工作线程
-        for (int i = 0; i < target; ++i) {
-            workers_.emplace_back(&AsyncCompressor::workerLoop, this);
+        for (int i = target; i < current; ++i) {
+            if (workers_[i].thread.joinable()) workers_[i].thread.join();
         }
     }
 }
 
 void AsyncCompressor::setWorkerCount(int count) {
-    if (count < 1) count = 1;
-    workerCount_.store(count);
+    std::lock_guard<std::mutex> lock(controlMutex_);
+    workerCount_.store(std::clamp(count, 1, MAX_WORKERS));
     ensureWorkers();
 }
 
+AsyncCompressor::Stats AsyncCompressor::getStats() const {
+    Stats stats;
+    stats.submitted = submitted_.load(std::memory_order_relaxed);
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    stats.parks = parks_.load(std::memory_order_relaxed);
+    stats.workers = activeWorkers_.load(std::memory_order_relaxed);
+    return stats;
+}
+
 int DynamicCompression::suggestLevel(const Stats& stats, int baseLevel, int minLevel, int maxLevel) {
     // 基于配置的基准级别
     int level = baseLevel;
@@ -148,9 +382,7 @@ int DynamicCompression::suggestLevel(const Stats& stats, int baseLevel, int minL
 }
 
 int DynamicCompression::suggestWorkerCount() {
-    unsigned int detected = std::thread::hardware_concurrency();
-    // 默认策略：使用 (N-1) 个核心，最多 8 个，最少 1 个
-    return (detected > 0) ? std::max(1, std::min(8, (int)detected - 1)) : 4;
+    return core::NativeRuntime::instance().threadsFor(core::NativeSubsystem::COMPRESSION);
 }
 
 } // namespace net
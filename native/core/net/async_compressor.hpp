@@ -1,14 +1,15 @@
 #pragma once
+#include <algorithm>
 #include <memory>
 #include <functional>
-#include <queue>
 #include <mutex>
 #include <thread>
 #include <atomic>
-#include <condition_variable>
+#include <cstdint>
 #include <vector>
-#include <stack>
+#include "../async_task.hpp"
 #include "native_compressor.hpp"
+#include "work_stealing_deque.hpp"
 
 namespace lattice {
 namespace net {
@@ -21,43 +22,128 @@ struct CompressTask {
     std::function<void(bool success, size_t outputSize)> callback;
 };
 
-// 对象池模板类
+/**
+ * ObjectPool - 固定容量的无锁对象池
+ *
+ * 空闲对象放在槽位数组中，两个Treiber栈分别串起"存有对象"和"空"的槽位，
+ * 栈顶为(版本号 << 32 | 槽位索引)，每次出栈递增版本号避免ABA。
+ * acquire在池空时new，release在池满时delete；不持有任何互斥锁。
+ */
 template<typename T>
 class ObjectPool {
 public:
-    std::shared_ptr<T> acquire() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (!pool_.empty()) {
-            auto obj = std::move(pool_.top());
-            pool_.pop();
-            return obj;
+    explicit ObjectPool(size_t capacity = 256)
+        : slots_(new Slot[capacity > 0 ? capacity : 1])
+        , capacity_(capacity > 0 ? capacity : 1)
+        , max_pool_size_(capacity_) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            push(emptyHead_, static_cast<uint32_t>(i));
         }
-        return std::make_shared<T>();
     }
 
-    void release(std::shared_ptr<T> obj) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (pool_.size() < max_pool_size_) {
-            // 重置对象状态
-            *obj = T{};
-            pool_.push(std::move(obj));
+    ~ObjectPool() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            delete slots_[i].object;
         }
-        // 如果池已满，对象将被自动销毁
     }
 
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    std::unique_ptr<T> acquire() {
+        const uint32_t index = pop(fullHead_);
+        if (index == NIL) {
+            return std::make_unique<T>();
+        }
+        T* obj = slots_[index].object;
+        slots_[index].object = nullptr;
+        push(emptyHead_, index);
+        pooled_.fetch_sub(1, std::memory_order_relaxed);
+        return std::unique_ptr<T>(obj);
+    }
+
+    void release(std::unique_ptr<T> obj) {
+        if (!obj || pooled_.load(std::memory_order_relaxed) >= max_pool_size_.load(std::memory_order_relaxed)) {
+            return; // 池已满，对象将被自动销毁
+        }
+        const uint32_t index = pop(emptyHead_);
+        if (index == NIL) {
+            return;
+        }
+        // 重置对象状态
+        *obj = T{};
+        slots_[index].object = obj.release();
+        pooled_.fetch_add(1, std::memory_order_relaxed);
+        push(fullHead_, index);
+    }
+
+    // 池中保留的对象上限（不超过构造时的容量）
     void setMaxPoolSize(size_t size) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        max_pool_size_ = size;
+        max_pool_size_.store(std::min(size, capacity_), std::memory_order_relaxed);
     }
 
+    size_t size() const { return pooled_.load(std::memory_order_relaxed); }
+
 private:
-    std::stack<std::shared_ptr<T>> pool_;
-    std::mutex mutex_;
-    size_t max_pool_size_ = 50; // 默认最大池大小
+    static constexpr uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Slot {
+        std::atomic<uint32_t> next{NIL};
+        T* object{nullptr};       // 只有弹出该槽位的线程访问
+    };
+
+    static uint32_t indexOf(uint64_t head) { return static_cast<uint32_t>(head); }
+    static uint64_t tagOf(uint64_t head) { return head >> 32; }
+
+    void push(std::atomic<uint64_t>& head, uint32_t index) {
+        uint64_t current = head.load(std::memory_order_relaxed);
+        uint64_t next;
+        do {
+            slots_[index].next.store(indexOf(current), std::memory_order_relaxed);
+            next = (tagOf(current) << 32) | index;
+        } while (!head.compare_exchange_weak(current, next, std::memory_order_release,
+                                             std::memory_order_relaxed));
+    }
+
+    uint32_t pop(std::atomic<uint64_t>& head) {
+        uint64_t current = head.load(std::memory_order_acquire);
+        for (;;) {
+            const uint32_t index = indexOf(current);
+            if (index == NIL) {
+                return NIL;
+            }
+            const uint32_t next = slots_[index].next.load(std::memory_order_relaxed);
+            const uint64_t replacement = ((tagOf(current) + 1) << 32) | next;
+            if (head.compare_exchange_weak(current, replacement, std::memory_order_acquire,
+                                           std::memory_order_acquire)) {
+                return index;
+            }
+        }
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_;
+    std::atomic<size_t> max_pool_size_;
+    std::atomic<size_t> pooled_{0};
+    alignas(64) std::atomic<uint64_t> fullHead_{NIL};
+    alignas(64) std::atomic<uint64_t> emptyHead_{NIL};
 };
 
+/**
+ * AsyncCompressor - 工作窃取的异步压缩线程池
+ *
+ * 每个工作线程有一个无锁收件箱（多生产者Treiber栈）和一个Chase–Lev双端队列：
+ * - 提交线程（Netty事件循环）按线程局部的轮转游标选择工作线程，把任务压入其收件箱并唤醒它，
+ *   不经过任何全局互斥锁
+ * - 工作线程把收件箱整批转入自己的双端队列后从底部执行，空闲时从其他线程的队列顶部窃取，
+ *   或整批取走其他线程的收件箱
+ * - 空闲的工作线程在各自的原子计数器上等待（std::atomic::wait），提交时只唤醒目标线程
+ * 任务对象来自无锁ObjectPool，执行完毕后归还。
+ */
 class AsyncCompressor {
 public:
+    static constexpr int MAX_WORKERS = 64;
+
     static AsyncCompressor& getInstance();
     
     // 提交异步压缩任务（Zlib 格式）
@@ -65,8 +151,28 @@ public:
                        std::shared_ptr<std::vector<char>> outputBuffer,
                        int level,
                        std::function<void(bool, size_t)> callback);
+    
+    struct CompressResult {
+        bool success{false};
+        size_t size{0};
+    };
+    
+    // 协程版本：co_await compressor.compress(...)；完成后在NativeRuntime的共享线程池上继续，不占用压缩线程
+    core::AsyncTask<CompressResult> compress(std::shared_ptr<std::vector<char>> inputData,
+                                        std::shared_ptr<std::vector<char>> outputBuffer,
+                                        int level);
 
-    // 动态调整线程数
+    // 在工作线程上执行job（入站解压等其他短任务共用线程池），job不得抛出异常
+    void submit(std::function<void()> job);
+
+    /**
+     * 在工作线程上并行执行body(0..count-1)，调用线程也参与，全部完成后返回
+     * 下标按原子计数动态分配；最多向线程池提交helpers个协助任务（0表示按工作线程数）
+     * body不得抛出异常
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& body, size_t helpers = 0);
+
+    // 动态调整线程数（1..MAX_WORKERS）；减少时被移除线程的待处理任务转交给其余线程
     void setWorkerCount(int count);
     ~AsyncCompressor();
 
@@ -74,24 +180,64 @@ public:
     AsyncCompressor(const AsyncCompressor&) = delete;
     AsyncCompressor& operator=(const AsyncCompressor&) = delete;
 
+    struct Stats {
+        uint64_t submitted{0};
+        uint64_t executed{0};
+        uint64_t stolen{0};           // 从其他线程的队列或收件箱取得的任务
+        uint64_t parks{0};            // 工作线程进入等待的次数
+        int workers{0};
+    };
+
+    Stats getStats() const;
+
 private:
+    // 收件箱与双端队列中流转的任务节点
+    struct TaskNode {
+        CompressTask task;
+        std::function<void()> job;    // 非空时执行job（parallelFor的协助任务）而不是压缩
+        TaskNode* next = nullptr;
+    };
+
+    struct alignas(64) Worker {
+        std::atomic<TaskNode*> inbox{nullptr};
+        WorkStealingDeque<TaskNode> deque;
+        std::atomic<uint32_t> signal{0};
+        std::atomic<bool> parked{false};
+        std::atomic<bool> retire{false};
+        std::thread thread;
+    };
+
     explicit AsyncCompressor(int workerCount = -1); // -1 表示自动检测
 
-    void workerLoop();
+    void workerLoop(int index);
     void ensureWorkers();
+    void wake(int index);
+    // 压入某个工作线程的收件箱（提交线程局部轮转）并按需唤醒
+    void enqueue(std::unique_ptr<TaskNode> task);
 
-    std::queue<CompressTask> taskQueue_;
-    std::mutex queueMutex_;
-    std::condition_variable cv_;
-    std::vector<std::thread> workers_;
+    // 整批取走收件箱，按提交顺序转入deque；返回转入的任务数
+    size_t drainInbox(Worker& from, Worker& owner);
+    TaskNode* findWork(int index);
+    void execute(TaskNode* node);
+
+    std::unique_ptr<Worker[]> workers_;
+    std::atomic<int> activeWorkers_{0};   // 提交时在[0, activeWorkers_)中选择
+    std::atomic<int> slotsUsed_{0};       // 曾经启动过线程的槽位数，窃取时遍历
     std::atomic<bool> stop_{false};
     std::atomic<int> workerCount_;
+    std::mutex controlMutex_;             // 只串行化setWorkerCount / 析构，不在提交路径上
+
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> stolen_{0};
+    std::atomic<uint64_t> parks_{0};
     
-    // 对象池用于管理CompressTask对象
-    ObjectPool<CompressTask> taskPool_;
+    // 对象池用于管理任务节点
+    ObjectPool<TaskNode> taskPool_;
 };
 
-// 动态压缩类
+// 动态压缩类（无状态的建议接口，调用者自己填写Stats；
+// 自动采集信号、按连接决策的闭环版本见DynamicCompressionController）
 class DynamicCompression {
 public:
     struct Stats {
@@ -0,0 +1,336 @@
+#include "chunk_packet_cache.hpp"
+#include "native_compressor.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace lattice {
+namespace net {
+
+namespace {
+
+// 每个条目除帧数据外的簿记开销（Variant、LRU节点、vector头）
+constexpr size_t ENTRY_OVERHEAD = 128;
+
+size_t entryCost(const ChunkPacketCache::Frame& frame) {
+    return (frame ? frame->size() : 0) + ENTRY_OVERHEAD;
+}
+
+size_t writeVarInt(uint8_t* dst, uint32_t value) {
+    size_t written = 0;
+    while (value >= 0x80) {
+        dst[written++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    dst[written++] = static_cast<uint8_t>(value);
+    return written;
+}
+
+} // namespace
+
+ChunkPacketCache::ChunkPacketCache(size_t byteBudget)
+    : byteBudget_(byteBudget) {
+}
+
+ChunkPacketCache& ChunkPacketCache::global() {
+    static ChunkPacketCache instance;
+    return instance;
+}
+
+uint64_t ChunkPacketCache::hashContent(const void* data, size_t length) {
+    // 按8字节块的乘法-异或哈希（非加密），只用于发现版本戳与内容不一致
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = 0x9E3779B97F4A7C15ull ^ (length * 0xC2B2AE3D27D4EB4Full);
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        h ^= word * 0x87C37B91114253D5ull;
+        h = (h << 31) | (h >> 33);
+        h *= 0x4CF5AD432745937Full;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, bytes + i, length - i);
+    h ^= tail * 0x87C37B91114253D5ull;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    // 0保留给lookup()表示不校验
+    return h ? h : 1;
+}
+
+ChunkPacketCache::Frame ChunkPacketCache::compress(const void* data, size_t length, int level) {
+    if (length == 0 || length > 0x7FFFFFFF) {
+        return nullptr;
+    }
+    try {
+        level = std::clamp(level, NativeCompressor::MIN_COMPRESSION_LEVEL,
+                           NativeCompressor::MAX_COMPRESSION_LEVEL);
+        NativeCompressor* compressor = NativeCompressor::forThread(level);
+        if (!compressor) {
+            return nullptr;
+        }
+        compressor->setCompressionLevel(level);
+
+        auto& bufferCache = NativeCompressor::getGlobalBufferCache();
+        auto* buffer = bufferCache.getBuffer(bufferCache.estimateOptimalSize(length));
+        if (!buffer) {
+            return nullptr;
+        }
+        const size_t compressedSize = compressor->compressZlib(
+            static_cast<const char*>(data), length, static_cast<char*>(buffer->data), buffer->capacity);
+        if (compressedSize == 0) {
+            bufferCache.returnBuffer(buffer);
+            return nullptr;
+        }
+
+        auto frame = std::make_shared<std::vector<uint8_t>>(5 + compressedSize);
+        const size_t header = writeVarInt(frame->data(), static_cast<uint32_t>(length));
+        std::memcpy(frame->data() + header, buffer->data, compressedSize);
+        frame->resize(header + compressedSize);
+        frame->shrink_to_fit();
+        bufferCache.returnBuffer(buffer);
+        return frame;
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+ChunkPacketCache::Variant* ChunkPacketCache::findLocked(Variants& variants, const Key& key) {
+    for (auto& variant : variants) {
+        if (variant->kind == key.kind && variant->level == key.level && variant->version == key.version) {
+            return variant.get();
+        }
+    }
+    return nullptr;
+}
+
+void ChunkPacketCache::eraseLocked(const ChunkId& id, Variants& variants, size_t index) {
+    Variant* variant = variants[index].get();
+    if (variant->inLru) {
+        bytes_ -= entryCost(variant->frame);
+        lru_.erase(variant->lru);
+    }
+    variants.erase(variants.begin() + static_cast<std::ptrdiff_t>(index));
+    if (variants.empty()) {
+        chunks_.erase(id);
+    }
+}
+
+void ChunkPacketCache::dropOlderLocked(const ChunkId& id, Variants& variants, const Key& key) {
+    // 同一区块同类型的旧版本不会再被请求；调用前已插入key对应的条目，variants不会被删空
+    for (size_t i = variants.size(); i-- > 0;) {
+        if (variants[i]->kind == key.kind && variants[i]->version < key.version) {
+            eraseLocked(id, variants, i);
+        }
+    }
+}
+
+void ChunkPacketCache::evictLocked() {
+    while (bytes_ > byteBudget_ && !lru_.empty()) {
+        const auto [id, target] = lru_.back();
+        auto it = chunks_.find(id);
+        if (it == chunks_.end()) {
+            lru_.pop_back();
+            continue;
+        }
+        Variants& variants = it->second;
+        for (size_t i = 0; i < variants.size(); ++i) {
+            if (variants[i].get() == target) {
+                eraseLocked(id, variants, i);
+                break;
+            }
+        }
+        ++stats_.evictions;
+    }
+}
+
+ChunkPacketCache::Frame ChunkPacketCache::lookup(const Key& key, uint64_t contentHash) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = chunks_.find(ChunkId{key.worldId, key.chunkX, key.chunkZ});
+    if (it == chunks_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    Variant* variant = findLocked(it->second, key);
+    if (!variant || !variant->frame || (contentHash && variant->contentHash != contentHash)) {
+        ++stats_.misses;
+        return nullptr;
+    }
+    lru_.splice(lru_.begin(), lru_, variant->lru);
+    ++stats_.hits;
+    stats_.bytesSaved += variant->inputBytes;
+    return variant->frame;
+}
+
+ChunkPacketCache::Frame ChunkPacketCache::getOrCompress(const Key& key, const void* data, size_t length) {
+    if (!data || length == 0) {
+        return nullptr;
+    }
+    const uint64_t contentHash = hashContent(data, length);
+    const ChunkId id{key.worldId, key.chunkX, key.chunkZ};
+
+    std::promise<Frame> promise;
+    Variant* reserved = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        Variants& variants = chunks_[id];
+        Variant* variant = findLocked(variants, key);
+
+        if (variant && variant->contentHash == contentHash) {
+            if (variant->frame) {
+                lru_.splice(lru_.begin(), lru_, variant->lru);
+                ++stats_.hits;
+                stats_.bytesSaved += variant->inputBytes;
+                return variant->frame;
+            }
+            // 其他线程正在压缩同一份数据
+            auto pending = variant->pending;
+            ++stats_.waits;
+            lock.unlock();
+            return pending.get();
+        }
+
+        ++stats_.misses;
+        bool cacheable = true;
+        if (variant) {
+            // 版本戳相同但内容不同：调用者没有及时递增版本戳
+            ++stats_.hashMismatches;
+            if (variant->frame) {
+                for (size_t i = 0; i < variants.size(); ++i) {
+                    if (variants[i].get() == variant) {
+                        eraseLocked(id, variants, i);
+                        break;
+                    }
+                }
+            } else {
+                cacheable = false;
+            }
+        }
+
+        if (cacheable) {
+            auto it = chunks_.find(id);
+            if (it == chunks_.end()) {
+                it = chunks_.emplace(id, Variants{}).first;
+            }
+            Variants& current = it->second;
+            const bool newerExists = std::any_of(current.begin(), current.end(), [&](const auto& v) {
+                return v->kind == key.kind && v->version > key.version;
+            });
+            if (newerExists) {
+                // 旧版本的请求（区块已经修改）：照常压缩但不缓存
+                cacheable = false;
+            } else {
+                auto entry = std::make_unique<Variant>();
+                entry->kind = key.kind;
+                entry->level = key.level;
+                entry->version = key.version;
+                entry->contentHash = contentHash;
+                entry->inputBytes = length;
+                entry->pending = promise.get_future().share();
+                reserved = entry.get();
+                current.push_back(std::move(entry));
+                dropOlderLocked(id, current, key);
+            }
+            if (!reserved && current.empty()) {
+                chunks_.erase(it);
+            }
+        } else if (variants.empty()) {
+            chunks_.erase(id);
+        }
+    }
+
+    Frame frame = compress(data, length, key.level);
+    if (!reserved) {
+        return frame;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 压缩期间条目可能已被invalidate；只有仍是自己预留的条目才填充
+        auto it = chunks_.find(id);
+        if (it != chunks_.end()) {
+            Variants& variants = it->second;
+            for (size_t i = 0; i < variants.size(); ++i) {
+                if (variants[i].get() != reserved) {
+                    continue;
+                }
+                if (frame) {
+                    reserved->frame = frame;
+                    reserved->pending = std::shared_future<Frame>();
+                    lru_.emplace_front(id, reserved);
+                    reserved->lru = lru_.begin();
+                    reserved->inLru = true;
+                    bytes_ += entryCost(frame);
+                    evictLocked();
+                } else {
+                    eraseLocked(id, variants, i);
+                }
+                break;
+            }
+        }
+    }
+    promise.set_value(frame);
+    return frame;
+}
+
+void ChunkPacketCache::invalidateChunk(int32_t worldId, int32_t chunkX, int32_t chunkZ) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const ChunkId id{worldId, chunkX, chunkZ};
+    auto it = chunks_.find(id);
+    if (it == chunks_.end()) {
+        return;
+    }
+    for (auto& variant : it->second) {
+        if (variant->inLru) {
+            bytes_ -= entryCost(variant->frame);
+            lru_.erase(variant->lru);
+        }
+    }
+    // 正在压缩的条目随之删除，压缩完成后不会再插入
+    chunks_.erase(it);
+    ++stats_.invalidations;
+}
+
+void ChunkPacketCache::invalidateWorld(int32_t worldId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = chunks_.begin(); it != chunks_.end();) {
+        if (it->first.worldId != worldId) {
+            ++it;
+            continue;
+        }
+        for (auto& variant : it->second) {
+            if (variant->inLru) {
+                bytes_ -= entryCost(variant->frame);
+                lru_.erase(variant->lru);
+            }
+        }
+        it = chunks_.erase(it);
+        ++stats_.invalidations;
+    }
+}
+
+void ChunkPacketCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    chunks_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+void ChunkPacketCache::setByteBudget(size_t byteBudget) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    byteBudget_ = byteBudget;
+    evictLocked();
+}
+
+ChunkPacketCache::Stats ChunkPacketCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.entries = lru_.size();
+    stats.bytes = bytes_;
+    stats.byteBudget = byteBudget_;
+    return stats;
+}
+
+} // namespace net
+} // namespace lattice
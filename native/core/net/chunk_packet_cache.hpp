@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace net {
+
+/**
+ * ChunkPacketCache - 广播场景下共享的区块数据包压缩结果
+ *
+ * 多个玩家加载同一片区域时，同一个区块数据包 / 光照包会被重复压缩。这里按
+ * （世界, 区块坐标, 包类型, 版本戳, 压缩级别）缓存压缩后的帧，后续连接直接复用。
+ *
+ * - 版本戳由Java侧提供（区块每次修改递增），插入新版本时同一区块同类型的旧版本被丢弃；
+ *   区块修改时也可以调用invalidateChunk()立即释放
+ * - 条目同时记录原始数据的内容哈希，命中时校验，版本戳未及时更新也不会发出过期数据
+ * - 同一键并发未命中时只压缩一次，其余调用者等待结果
+ * - 总字节数超过预算时按LRU淘汰
+ *
+ * 缓存内容为可直接写出的帧：VarInt(未压缩长度) + zlib数据。
+ * 压缩时的临时缓冲区取自NativeCompressor的全局CompressBufferCache。
+ */
+class ChunkPacketCache {
+public:
+    enum class PacketKind : uint8_t {
+        CHUNK_DATA = 0,     // 区块数据（含光照）
+        LIGHT_UPDATE = 1
+    };
+
+    struct Key {
+        int32_t worldId{0};
+        int32_t chunkX{0};
+        int32_t chunkZ{0};
+        PacketKind kind{PacketKind::CHUNK_DATA};
+        int level{6};
+        uint64_t version{0};
+    };
+
+    using Frame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t waits{0};               // 等待其他线程正在进行的压缩
+        uint64_t hashMismatches{0};      // 版本戳相同但内容不同
+        uint64_t evictions{0};
+        uint64_t invalidations{0};
+        uint64_t bytesSaved{0};          // 命中省去的压缩输入字节
+        size_t entries{0};
+        size_t bytes{0};
+        size_t byteBudget{0};
+    };
+
+    static constexpr size_t DEFAULT_BYTE_BUDGET = 64 * 1024 * 1024;
+
+    explicit ChunkPacketCache(size_t byteBudget = DEFAULT_BYTE_BUDGET);
+
+    ChunkPacketCache(const ChunkPacketCache&) = delete;
+    ChunkPacketCache& operator=(const ChunkPacketCache&) = delete;
+
+    // 进程内共享实例（JNI使用）
+    static ChunkPacketCache& global();
+
+    /**
+     * 返回data对应的压缩帧；未命中时在调用线程压缩并插入
+     * 压缩失败时返回nullptr（不缓存）
+     */
+    Frame getOrCompress(const Key& key, const void* data, size_t length);
+
+    // 只查询，不压缩；contentHash为0时不校验内容
+    Frame lookup(const Key& key, uint64_t contentHash = 0);
+
+    void invalidateChunk(int32_t worldId, int32_t chunkX, int32_t chunkZ);
+    void invalidateWorld(int32_t worldId);
+    void clear();
+
+    // 缩小预算时立即淘汰到预算以内
+    void setByteBudget(size_t byteBudget);
+
+    Stats getStats() const;
+
+    static uint64_t hashContent(const void* data, size_t length);
+
+private:
+    struct ChunkId {
+        int32_t worldId;
+        int32_t chunkX;
+        int32_t chunkZ;
+
+        bool operator==(const ChunkId& other) const {
+            return worldId == other.worldId && chunkX == other.chunkX && chunkZ == other.chunkZ;
+        }
+    };
+
+    struct ChunkIdHash {
+        size_t operator()(const ChunkId& id) const {
+            uint64_t h = static_cast<uint32_t>(id.chunkX) * 0x9E3779B97F4A7C15ull;
+            h ^= static_cast<uint32_t>(id.chunkZ) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+            h ^= static_cast<uint32_t>(id.worldId) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+            return static_cast<size_t>(h);
+        }
+    };
+
+    struct Variant;
+    using LruList = std::list<std::pair<ChunkId, Variant*>>;
+
+    // 同一区块的一个缓存版本
+    struct Variant {
+        PacketKind kind;
+        int level;
+        uint64_t version;
+        uint64_t contentHash;
+        size_t inputBytes;
+        Frame frame;                             // 压缩完成前为空
+        std::shared_future<Frame> pending;       // 压缩进行中时有效
+        LruList::iterator lru;
+        bool inLru{false};
+    };
+
+    using Variants = std::vector<std::unique_ptr<Variant>>;
+
+    static Frame compress(const void* data, size_t length, int level);
+
+    // 以下方法要求持有mutex_
+    Variant* findLocked(Variants& variants, const Key& key);
+    void eraseLocked(const ChunkId& id, Variants& variants, size_t index);
+    void dropOlderLocked(const ChunkId& id, Variants& variants, const Key& key);
+    void evictLocked();
+
+    mutable std::mutex mutex_;
+    std::unordered_map<ChunkId, Variants, ChunkIdHash> chunks_;
+    LruList lru_;                                // 头部最近使用
+    size_t bytes_{0};
+    size_t byteBudget_;
+    Stats stats_;
+};
+
+} // namespace net
+} // namespace lattice
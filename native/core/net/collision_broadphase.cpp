@@ -0,0 +1,225 @@
+#include "collision_broadphase.hpp"
+#include "../simd_dispatch.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lattice {
+namespace entity {
+
+namespace {
+
+// 按minX排序后的包围盒（SoA），每个线程复用
+struct SweepWorkspace {
+    std::vector<uint32_t> order;
+    std::vector<float> keys;
+    std::vector<int> ids;
+    std::vector<float> minX, maxX, minY, maxY, minZ, maxZ;
+    std::vector<uint32_t> hits;
+
+    void resize(size_t count) {
+        ids.resize(count);
+        minX.resize(count);
+        maxX.resize(count);
+        minY.resize(count);
+        maxY.resize(count);
+        minZ.resize(count);
+        maxZ.resize(count);
+        hits.resize(count);
+    }
+};
+
+} // namespace
+
+void CollisionBroadphase::Input::clear() {
+    ids.clear();
+    xs.clear();
+    ys.clear();
+    zs.clear();
+    radii.clear();
+}
+
+void CollisionBroadphase::Input::reserve(size_t count) {
+    ids.reserve(count);
+    xs.reserve(count);
+    ys.reserve(count);
+    zs.reserve(count);
+    radii.reserve(count);
+}
+
+CollisionBroadphase::CollisionBroadphase(const Config& config) : config_(config) {}
+
+CollisionBroadphase::~CollisionBroadphase() {
+    stop();
+}
+
+void CollisionBroadphase::setConfig(const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+CollisionBroadphase::Config CollisionBroadphase::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+void CollisionBroadphase::submit(uint64_t tick, Input& input) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (hasPending_) {
+            ++stats_.superseded;
+        }
+        std::swap(pending_, input);
+        pendingTick_ = tick;
+        hasPending_ = true;
+        ++stats_.submitted;
+        if (!worker_.joinable()) {
+            stopping_ = false;
+            worker_ = std::thread(&CollisionBroadphase::workerLoop, this);
+        }
+    }
+    input.clear();
+    wakeup_.notify_one();
+}
+
+std::shared_ptr<const CollisionBroadphase::Result> CollisionBroadphase::latest() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_;
+}
+
+std::shared_ptr<const CollisionBroadphase::Result> CollisionBroadphase::waitFor(
+    uint64_t minTick, std::chrono::milliseconds timeout) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const bool ready = resultReady_.wait_for(lock, timeout, [&] {
+        return latest_ && latest_->tick >= minTick;
+    });
+    return ready ? latest_ : nullptr;
+}
+
+CollisionBroadphase::Stats CollisionBroadphase::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void CollisionBroadphase::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void CollisionBroadphase::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wakeup_.wait(lock, [this] { return stopping_ || hasPending_; });
+        if (stopping_) {
+            return;
+        }
+        std::swap(working_, pending_);
+        hasPending_ = false;
+        const uint64_t tick = pendingTick_;
+        const Config config = config_;
+        std::shared_ptr<Result> result = std::move(spare_);
+        lock.unlock();
+
+        if (!result) {
+            result = std::make_shared<Result>();
+        }
+        detect(working_, config, *result);
+        result->tick = tick;
+
+        lock.lock();
+        // 旧结果没有其他持有者时留作下一次的输出缓冲区
+        if (latest_ && latest_.use_count() == 1) {
+            spare_ = std::move(latest_);
+        }
+        latest_ = std::move(result);
+        ++stats_.completed;
+        stats_.pairs += latest_->pairCount();
+        stats_.overflows += latest_->overflowed ? 1 : 0;
+        stats_.lastMicros = latest_->micros;
+        resultReady_.notify_all();
+    }
+}
+
+void CollisionBroadphase::detect(const Input& input, const Config& config, Result& out) {
+    const auto start = std::chrono::steady_clock::now();
+    out.pairs.clear();
+    out.overflowed = false;
+    out.entities = 0;
+
+    thread_local SweepWorkspace workspace;
+    SweepWorkspace& ws = workspace;
+
+    // 坐标或半径不是有限值的实体不参与比较（NaN会让排序不满足严格弱序）
+    const size_t inputCount = input.size();
+    ws.order.clear();
+    ws.keys.resize(inputCount);
+    for (size_t i = 0; i < inputCount; ++i) {
+        const float extent = input.radii[i] + config.margin;
+        if (!std::isfinite(input.xs[i]) || !std::isfinite(input.ys[i]) || !std::isfinite(input.zs[i]) ||
+            !std::isfinite(extent) || extent < 0.0f) {
+            continue;
+        }
+        ws.keys[i] = input.xs[i] - extent;
+        ws.order.push_back(static_cast<uint32_t>(i));
+    }
+    std::sort(ws.order.begin(), ws.order.end(),
+              [&](uint32_t a, uint32_t b) { return ws.keys[a] < ws.keys[b]; });
+
+    const size_t count = ws.order.size();
+    ws.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t index = ws.order[i];
+        const float extent = input.radii[index] + config.margin;
+        ws.ids[i] = input.ids[index];
+        ws.minX[i] = ws.keys[index];
+        ws.maxX[i] = input.xs[index] + extent;
+        ws.minY[i] = input.ys[index] - extent;
+        ws.maxY[i] = input.ys[index] + extent;
+        ws.minZ[i] = input.zs[index] - extent;
+        ws.maxZ[i] = input.zs[index] + extent;
+    }
+    out.entities = count;
+
+    const core::SimdKernels& kernels = core::simdKernels();
+    const size_t maxValues = config.maxPairs * 2;
+    for (size_t i = 0; i + 1 < count && !out.overflowed; ++i) {
+        // minX在[minX[i], maxX[i]]内的盒子与i在X轴上相交
+        const size_t end = static_cast<size_t>(
+            std::upper_bound(ws.minX.begin() + static_cast<ptrdiff_t>(i) + 1, ws.minX.end(), ws.maxX[i]) -
+            ws.minX.begin());
+        const size_t first = i + 1;
+        if (end == first) {
+            continue;
+        }
+        const size_t hits = kernels.filterOverlapsYZ(ws.minY.data() + first, ws.maxY.data() + first,
+                                                     ws.minZ.data() + first, ws.maxZ.data() + first,
+                                                     end - first, ws.minY[i], ws.maxY[i], ws.minZ[i],
+                                                     ws.maxZ[i], static_cast<uint32_t>(first), ws.hits.data());
+        const int id = ws.ids[i];
+        for (size_t h = 0; h < hits; ++h) {
+            if (out.pairs.size() >= maxValues) {
+                out.overflowed = true;
+                break;
+            }
+            const int other = ws.ids[ws.hits[h]];
+            if (other == id) {
+                // 分片迁移过程中同一实体可能短暂出现在两个分片
+                continue;
+            }
+            out.pairs.push_back(std::min(id, other));
+            out.pairs.push_back(std::max(id, other));
+        }
+    }
+
+    out.micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace entity
+} // namespace lattice
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lattice {
+namespace entity {
+
+/**
+ * CollisionBroadphase - 每tick的实体碰撞粗检测（后台线程）
+ *
+ * 输入为实体的SoA位置与半径（EntityStore的xs/ys/zs/radii），每个实体的包围盒是
+ * 以(x, y, z)为中心、半边长radius + margin的立方体；输出所有包围盒相交的实体对，
+ * 由Java侧对这些候选对做精确的碰撞判定（推挤、伤害等）。
+ *
+ * 扫掠排序（sort-and-sweep）：包围盒按minX排序，每个盒子与其后minX不超过自己maxX的盒子
+ * 在X轴上必然相交，这一段连续的SoA数组再用simdKernels().filterOverlapsYZ一次比较Y/Z两个轴。
+ * Minecraft实体大多聚在地面附近，Y轴区分度低，因此选X轴排序、Y/Z向量化过滤。
+ *
+ * tick线程submit()输入后立即返回，检测在后台线程上进行，结果通过latest()/waitFor()取回；
+ * 后台线程处理上一次提交时，还没开始的提交会被更新的提交替换（只检测最新的一帧）。
+ * 提交、取结果与配置都是线程安全的。
+ */
+class CollisionBroadphase {
+public:
+    struct Config {
+        float margin = 0.0f;                // 包围盒各方向额外扩展的距离（格），位置为脚底时可设为半个身高
+        size_t maxPairs = 1 << 20;          // 单次结果的对数上限，超出时截断并标记overflowed
+    };
+
+    // 一次检测的输入，各数组长度相同
+    struct Input {
+        std::vector<int> ids;
+        std::vector<float> xs, ys, zs, radii;
+
+        void append(int id, float x, float y, float z, float radius) {
+            ids.push_back(id);
+            xs.push_back(x);
+            ys.push_back(y);
+            zs.push_back(z);
+            radii.push_back(radius);
+        }
+        void clear();
+        void reserve(size_t count);
+        size_t size() const { return ids.size(); }
+    };
+
+    struct Result {
+        uint64_t tick{0};               // submit()时传入的tick
+        size_t entities{0};             // 参与检测的实体（坐标非有限值的实体被跳过）
+        std::vector<int> pairs;         // 每对两个id（较小的在前），对之间没有特定顺序
+        bool overflowed{false};         // 达到maxPairs后截断
+        uint64_t micros{0};
+
+        size_t pairCount() const { return pairs.size() / 2; }
+    };
+
+    struct Stats {
+        uint64_t submitted{0};
+        uint64_t completed{0};
+        uint64_t superseded{0};         // 后台线程开始处理前就被新提交替换
+        uint64_t pairs{0};              // 累计输出的对数
+        uint64_t overflows{0};
+        uint64_t lastMicros{0};
+    };
+
+    CollisionBroadphase() : CollisionBroadphase(Config()) {}
+    explicit CollisionBroadphase(const Config& config);
+    ~CollisionBroadphase();
+
+    CollisionBroadphase(const CollisionBroadphase&) = delete;
+    CollisionBroadphase& operator=(const CollisionBroadphase&) = delete;
+
+    // 之后开始的检测使用新配置
+    void setConfig(const Config& config);
+    Config getConfig() const;
+
+    /**
+     * 提交一帧输入：与内部缓冲区交换后立即返回，input被清空（保留容量，下一tick直接复用）
+     * 第一次提交时启动后台线程
+     */
+    void submit(uint64_t tick, Input& input);
+
+    // 最近完成的结果；还没有完成任何检测时返回nullptr
+    std::shared_ptr<const Result> latest() const;
+    // 等待tick不早于minTick的结果，超时返回nullptr
+    std::shared_ptr<const Result> waitFor(uint64_t minTick, std::chrono::milliseconds timeout) const;
+
+    Stats getStats() const;
+
+    // 等待当前检测结束后停止后台线程；之后的submit()会重新启动
+    void stop();
+
+    // 在调用线程上同步检测（离线工具与一致性检查使用），结果覆盖out
+    static void detect(const Input& input, const Config& config, Result& out);
+
+private:
+    void workerLoop();
+
+    mutable std::mutex mutex_;
+    mutable std::condition_variable resultReady_;
+    std::condition_variable wakeup_;
+    Config config_;
+    bool stopping_{false};
+
+    // 待处理的输入与后台线程正在处理的输入（双缓冲，只交换不复制）
+    Input pending_;
+    uint64_t pendingTick_{0};
+    bool hasPending_{false};
+    Input working_;
+
+    // 结果按shared_ptr发布；没有调用者持有的旧结果留给下一次检测复用
+    std::shared_ptr<Result> latest_;
+    std::shared_ptr<Result> spare_;
+    Stats stats_;
+
+    std::thread worker_;
+};
+
+} // namespace entity
+} // namespace lattice
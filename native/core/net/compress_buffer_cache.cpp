@@ -1,8 +1,14 @@
 #include "compress_buffer_cache.hpp"
 #include <algorithm>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <sstream>
+#include <unistd.h>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 
 namespace lattice {
 namespace net {
@@ -10,24 +16,73 @@ namespace net {
 // 静态成员初始化
 std::atomic<size_t> CompressBufferCache::global_tick_counter_{0};
 
+namespace {
+
+constexpr const char* CGROUP_ROOT = "/sys/fs/cgroup";
+
+// 读取cgroup接口文件中的单个数值；"max"或读取失败返回0
+size_t readCgroupValue(const std::string& path) {
+    std::ifstream file(path);
+    std::string value;
+    if (!file || !(file >> value) || value == "max") {
+        return 0;
+    }
+    try {
+        return static_cast<size_t>(std::stoull(value));
+    } catch (...) {
+        return 0;
+    }
+}
+
+// memory.stat中指定字段的值
+size_t readCgroupStat(const std::string& path, const std::string& key) {
+    std::ifstream file(path);
+    std::string name;
+    unsigned long long value = 0;
+    while (file >> name >> value) {
+        if (name == key) {
+            return static_cast<size_t>(value);
+        }
+    }
+    return 0;
+}
+
+size_t readProcessRss() {
+    std::ifstream file("/proc/self/statm");
+    unsigned long long pages = 0;
+    unsigned long long residentPages = 0;
+    if (!(file >> pages >> residentPages)) {
+        return 0;
+    }
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    return static_cast<size_t>(residentPages) * static_cast<size_t>(pageSize > 0 ? pageSize : 4096);
+}
+
+} // namespace
+
 // 构造函数 - 支持默认配置
 CompressBufferCache::CompressBufferCache(const Config& config) 
-    : config_(config) {
+    : cache_id_(next_cache_id_.fetch_add(1, std::memory_order_relaxed)), config_(config),
+      cgroup_dir_(config.cgroup_aware ? detectCgroupDirectory() : std::string()) {
     
-    // 启动后台清理线程
+    // 启动后台清理线程（析构时join）
     if (config_.enable_async_cleanup) {
         cleanup_running_ = true;
         cleanup_thread_ = std::thread(&CompressBufferCache::cleanupWorker, this);
-        
-        // 设置清理线程为后台线程
-        std::thread cleanup_copy = std::move(cleanup_thread_);
-        cleanup_thread_ = std::thread([this, cleanup_copy = std::move(cleanup_copy)]() mutable {
-            // 分离线程，让它独立运行
-            cleanup_copy.detach();
-            this->cleanupWorker();
-        });
     }
     
+    // 超出压缩缓冲区预算时释放空闲缓冲区，与容器压力回收相同
+    shedder_id_ = core::MemoryBudget::instance().addShedder(
+        core::MemorySubsystem::COMPRESSION_BUFFERS, [this](size_t bytes) {
+            const size_t released = releaseIdleBytes(bytes, false);
+#ifdef __GLIBC__
+            if (released > 0) {
+                malloc_trim(0);
+            }
+#endif
+            return released;
+        });
+    
     std::cout << "[CompressBufferCache] Initialized with config: "
               << "default_size=" << config_.default_buffer_size 
               << ", max_size=" << config_.max_buffer_size
@@ -36,9 +91,14 @@ CompressBufferCache::CompressBufferCache(const Config& config)
 
 // 析构函数
 CompressBufferCache::~CompressBufferCache() {
+    core::MemoryBudget::instance().removeShedder(shedder_id_);
+    
     // 停止后台清理线程
     if (cleanup_running_) {
-        cleanup_running_ = false;
+        {
+            std::lock_guard<std::mutex> lock(cleanup_mutex_);
+            cleanup_running_ = false;
+        }
         cleanup_condition_.notify_all();
         
         if (cleanup_thread_.joinable()) {
@@ -68,29 +128,60 @@ CompressBufferCache::Buffer* CompressBufferCache::getBuffer(size_t minSize) {
         return nullptr;
     }
     
-    auto& buffers = getThreadBuffers();
+    auto& magazine = getThreadBuffers();
+    std::lock_guard<std::mutex> lock(magazine.mutex);
+    auto& buffers = magazine.buffers;
     
-    // 查找合适的缓冲区
+    // 1. 当前线程magazine中同档位的空闲缓冲区
     Buffer* suitableBuffer = findSuitableBuffer(buffers, minSize);
-    
     if (suitableBuffer) {
-        // 缓存命中
+        suitableBuffer->lent = true;
         suitableBuffer->touch();
         global_cache_hits_.fetch_add(1, std::memory_order_relaxed);
         return suitableBuffer;
     }
     
-    // 缓存未命中，创建新缓冲区
-    global_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+    // 2. 同档位已满且都未归还：复用最久未用的一个（不归还的调用者的原有语义）
+    const size_t sizeClass = sizeClassFor(std::max(minSize, config_.min_class_size));
+    Buffer* oldestLent = nullptr;
+    size_t classCount = 0;
+    for (auto& buffer : buffers) {
+        if (buffer->size_class != sizeClass) {
+            continue;
+        }
+        ++classCount;
+        if (!oldestLent || buffer->last_access < oldestLent->last_access) {
+            oldestLent = buffer.get();
+        }
+    }
+    if (oldestLent && classCount >= std::max<size_t>(config_.magazine_size, 1)) {
+        oldestLent->touch();
+        global_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        global_lent_reuses_.fetch_add(1, std::memory_order_relaxed);
+        return oldestLent;
+    }
     
-    Buffer* newBuffer = createNewBuffer(minSize);
-    if (newBuffer) {
-        buffers.push_back(std::unique_ptr<Buffer>(newBuffer));
-        newBuffer->touch();
-        return newBuffer;
+    // 3. 全局depot，最后才新分配
+    std::unique_ptr<Buffer> buffer = takeFromDepot(sizeClass);
+    if (buffer) {
+        global_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+        global_depot_hits_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        global_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+        if (isUnderMemoryPressure()) {
+            trimDepot(true);
+        }
+        buffer.reset(createNewBuffer(minSize));
+        if (!buffer) {
+            return nullptr;
+        }
     }
     
-    return nullptr;
+    Buffer* result = buffer.get();
+    adoptBuffer(magazine, std::move(buffer));
+    result->lent = true;
+    result->touch();
+    return result;
 }
 
 // 获取直接缓冲区（零拷贝）
@@ -105,8 +196,13 @@ void CompressBufferCache::returnBuffer(Buffer* buffer) {
         return;
     }
     
-    // 检查是否需要标记为脏（可以在这里实现更复杂的清理策略）
+    ThreadMagazine* magazine = buffer->magazine;
+    if (!magazine) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(magazine->mutex);
     buffer->is_dirty = false;
+    buffer->lent = false;
     buffer->touch();
 }
 
@@ -116,7 +212,8 @@ void CompressBufferCache::cleanupThreadBuffers(std::thread::id threadId) {
     
     auto it = thread_buffers_map_.find(threadId);
     if (it != thread_buffers_map_.end()) {
-        cleanupThread(it->second);
+        std::lock_guard<std::mutex> magazineLock(it->second->mutex);
+        cleanupThread(it->second->buffers);
     }
 }
 
@@ -126,28 +223,26 @@ void CompressBufferCache::performCleanup() {
     
     size_t threadsCleaned = 0;
     size_t buffersCleaned = 0;
-    size_t memoryReclaimed = 0;
-    
-    auto it = thread_buffers_map_.begin();
-    while (it != thread_buffers_map_.end()) {
-        size_t threadBuffersBefore = it->second.size();
-        cleanupThread(it->second);
-        size_t threadBuffersAfter = it->second.size();
+    const size_t reclaimedBefore = global_memory_reclaimed_.load(std::memory_order_relaxed);
+    
+    // magazine中的空闲缓冲区换到depot（压力下直接释放）；
+    // magazine本身保留，线程局部指针仍然有效
+    for (auto& [threadId, magazine] : thread_buffers_map_) {
+        std::lock_guard<std::mutex> magazineLock(magazine->mutex);
+        size_t threadBuffersBefore = magazine->buffers.size();
+        cleanupThread(magazine->buffers);
+        size_t threadBuffersAfter = magazine->buffers.size();
         
         if (threadBuffersBefore != threadBuffersAfter) {
             threadsCleaned++;
             buffersCleaned += (threadBuffersBefore - threadBuffersAfter);
         }
-        
-        // 如果线程没有缓冲区了，移除该条目
-        if (it->second.empty()) {
-            it = thread_buffers_map_.erase(it);
-        } else {
-            ++it;
-        }
     }
     
-    global_memory_reclaimed_.fetch_add(memoryReclaimed, std::memory_order_relaxed);
+    // 内存压力下清空depot，否则只释放长时间无人取用的
+    trimDepot(isUnderMemoryPressure());
+    
+    size_t memoryReclaimed = global_memory_reclaimed_.load(std::memory_order_relaxed) - reclaimedBefore;
     
     std::cout << "[CompressBufferCache] Cleanup completed: "
               << threadsCleaned << " threads, "
@@ -168,17 +263,30 @@ CompressBufferCache::CacheStats CompressBufferCache::getStats() const {
     size_t activeBuffers = 0;
     float totalUtilization = 0.0f;
     
-    for (const auto& [threadId, buffers] : thread_buffers_map_) {
-        totalBuffers += buffers.size();
+    for (const auto& [threadId, magazine] : thread_buffers_map_) {
+        std::lock_guard<std::mutex> magazineLock(magazine->mutex);
+        totalBuffers += magazine->buffers.size();
         
-        for (const auto& buffer : buffers) {
+        for (const auto& buffer : magazine->buffers) {
             totalAllocated += buffer->capacity;
             totalUsed += buffer->current_size;
-            activeBuffers++;
+            if (buffer->lent) {
+                activeBuffers++;
+            }
             totalUtilization += buffer->getUtilization();
         }
     }
     
+    {
+        std::lock_guard<std::mutex> depotLock(depot_mutex_);
+        for (const auto& bucket : depot_) {
+            stats.depot_buffers += bucket.size();
+        }
+        stats.depot_bytes = depot_bytes_;
+    }
+    totalBuffers += stats.depot_buffers;
+    totalAllocated += stats.depot_bytes;
+    
     // 更新统计信息
     stats.total_buffers = totalBuffers;
     stats.active_buffers = activeBuffers;
@@ -189,8 +297,15 @@ CompressBufferCache::CacheStats CompressBufferCache::getStats() const {
     stats.buffer_resizes = global_buffer_resizes_.load();
     stats.memory_reclaimed = global_memory_reclaimed_.load();
     stats.hit_rate = stats.getHitRate();
-    stats.average_utilization = activeBuffers > 0 ? 
-        totalUtilization / static_cast<float>(activeBuffers) : 0.0f;
+    const size_t magazineBuffers = totalBuffers - stats.depot_buffers;
+    stats.average_utilization = magazineBuffers > 0 ? 
+        totalUtilization / static_cast<float>(magazineBuffers) : 0.0f;
+    stats.depot_hits = global_depot_hits_.load();
+    stats.lent_reuses = global_lent_reuses_.load();
+    stats.pressure_reclaimed = global_pressure_reclaimed_.load();
+    stats.reclaim_passes = reclaim_passes_.load();
+    stats.memory_limit_bytes = memory_limit_bytes_.load();
+    stats.memory_usage_bytes = memory_usage_bytes_.load();
     
     return stats;
 }
@@ -200,34 +315,123 @@ size_t CompressBufferCache::getThreadBufferCount(std::thread::id threadId) const
     std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
     
     auto it = thread_buffers_map_.find(threadId);
-    return it != thread_buffers_map_.end() ? it->second.size() : 0;
+    if (it == thread_buffers_map_.end()) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> magazineLock(it->second->mutex);
+    return it->second->buffers.size();
 }
 
 // 检查内存压力
 bool CompressBufferCache::isUnderMemoryPressure() const {
     size_t totalAllocated = total_allocated_memory_.load(std::memory_order_relaxed);
-    size_t totalUsed = total_used_memory_.load(std::memory_order_relaxed);
     
-    float utilization = totalAllocated > 0 ? 
-        static_cast<float>(totalUsed) / totalAllocated : 0.0f;
+    if (container_pressure_.load(std::memory_order_relaxed)) {
+        return true;
+    }
+    return static_cast<double>(totalAllocated) >
+           static_cast<double>(config_.max_total_bytes) * config_.memory_pressure_threshold;
+}
+
+// 按容器内存状况回收
+size_t CompressBufferCache::reclaimForMemoryPressure() {
+    const MemoryStatus status = getMemoryStatus();
+    memory_limit_bytes_.store(status.limit_bytes, std::memory_order_relaxed);
+    memory_usage_bytes_.store(status.usage_bytes, std::memory_order_relaxed);
+    
+    const double ratio = status.getUsageRatio();
+    const double start = config_.reclaim_start_threshold;
+    const double full = std::max<double>(config_.memory_pressure_threshold, start);
+    if (status.limit_bytes == 0 || ratio < start) {
+        container_pressure_.store(false, std::memory_order_relaxed);
+        return 0;
+    }
+    
+    // 在[start, full)内线性增加回收比例，到达full时释放全部空闲缓冲区（包括每线程保留的）
+    const bool critical = ratio >= full;
+    container_pressure_.store(critical, std::memory_order_relaxed);
+    const double fraction = critical || full <= start ? 1.0 : (ratio - start) / (full - start);
     
-    return utilization > config_.memory_pressure_threshold;
+    size_t idleBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(depot_mutex_);
+        idleBytes = depot_bytes_;
+    }
+    {
+        std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+        for (const auto& [threadId, magazine] : thread_buffers_map_) {
+            std::lock_guard<std::mutex> magazineLock(magazine->mutex);
+            for (const auto& buffer : magazine->buffers) {
+                if (!buffer->lent) {
+                    idleBytes += buffer->capacity;
+                }
+            }
+        }
+    }
+    
+    const size_t target = critical ? idleBytes : static_cast<size_t>(idleBytes * fraction);
+    const size_t released = target > 0 ? releaseIdleBytes(target, critical) : 0;
+    if (released > 0) {
+#ifdef __GLIBC__
+        // 小于mmap阈值的缓冲区释放后仍留在malloc堆中，主动归还给系统才能降低工作集
+        malloc_trim(0);
+#endif
+        global_pressure_reclaimed_.fetch_add(released, std::memory_order_relaxed);
+        reclaim_passes_.fetch_add(1, std::memory_order_relaxed);
+        std::cout << "[CompressBufferCache] Memory pressure "
+                  << static_cast<int>(ratio * 100) << "% of " << status.limit_bytes
+                  << " bytes, reclaimed " << released << " bytes" << std::endl;
+    }
+    return released;
+}
+
+// 读取容器内存状况
+CompressBufferCache::MemoryStatus CompressBufferCache::getMemoryStatus() const {
+    MemoryStatus status;
+    if (!cgroup_dir_.empty()) {
+        // 上限可能设在父cgroup上（如Pod级别），取路径上最小的memory.max，用同一层的工作集
+        std::string dir = cgroup_dir_;
+        std::string limitDir;
+        for (;;) {
+            const size_t limit = readCgroupValue(dir + "/memory.max");
+            if (limit > 0 && (status.limit_bytes == 0 || limit < status.limit_bytes)) {
+                status.limit_bytes = limit;
+                limitDir = dir;
+            }
+            if (dir.size() <= std::strlen(CGROUP_ROOT)) {
+                break;
+            }
+            dir.erase(dir.rfind('/'));
+        }
+        if (!limitDir.empty()) {
+            const size_t current = readCgroupValue(limitDir + "/memory.current");
+            const size_t inactiveFile = readCgroupStat(limitDir + "/memory.stat", "inactive_file");
+            if (current > 0) {
+                status.usage_bytes = current > inactiveFile ? current - inactiveFile : 0;
+                status.from_cgroup = true;
+                return status;
+            }
+        }
+    }
+    status.usage_bytes = readProcessRss();
+    return status;
 }
 
 // 清理所有缓冲区
 void CompressBufferCache::clearAllBuffers() {
     std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
     
-    size_t totalMemory = 0;
-    for (auto& [threadId, buffers] : thread_buffers_map_) {
-        for (auto& buffer : buffers) {
-            totalMemory += buffer->capacity;
+    const size_t reclaimedBefore = global_memory_reclaimed_.load(std::memory_order_relaxed);
+    for (auto& [threadId, magazine] : thread_buffers_map_) {
+        std::lock_guard<std::mutex> magazineLock(magazine->mutex);
+        for (auto& buffer : magazine->buffers) {
+            destroyBuffer(std::move(buffer));
         }
-        buffers.clear();
+        magazine->buffers.clear();
     }
-    thread_buffers_map_.clear();
+    trimDepot(true);
     
-    global_memory_reclaimed_.fetch_add(totalMemory, std::memory_order_relaxed);
+    size_t totalMemory = global_memory_reclaimed_.load(std::memory_order_relaxed) - reclaimedBefore;
     
     std::cout << "[CompressBufferCache] All buffers cleared: "
               << totalMemory << " bytes reclaimed" << std::endl;
@@ -248,13 +452,14 @@ void CompressBufferCache::warmupBuffer(size_t size, size_t count) {
         return;
     }
     
-    auto& buffers = getThreadBuffers();
+    auto& magazine = getThreadBuffers();
+    std::lock_guard<std::mutex> lock(magazine.mutex);
     
-    // 创建指定数量的缓冲区
+    // 创建指定数量的缓冲区；magazine放不下的进入depot
     for (size_t i = 0; i < count; ++i) {
-        Buffer* buffer = createNewBuffer(size);
+        std::unique_ptr<Buffer> buffer(createNewBuffer(size));
         if (buffer) {
-            buffers.push_back(std::unique_ptr<Buffer>(buffer));
+            adoptBuffer(magazine, std::move(buffer));
         }
     }
     
@@ -283,23 +488,25 @@ size_t CompressBufferCache::estimateOptimalSize(size_t inputSize) const {
 // ============== 私有方法实现 ==============
 
 // 获取线程缓冲区
-CompressBufferCache::ThreadBuffers& CompressBufferCache::getThreadBuffers() {
-    std::thread::id threadId = std::this_thread::get_id();
-    
-    // 如果当前线程没有缓冲区，创建一个
-    if (!current_thread_buffers_) {
+CompressBufferCache::ThreadMagazine& CompressBufferCache::getThreadBuffers() {
+    // 如果当前线程在本实例中没有magazine，创建一个
+    if (!current_thread_buffers_ || current_thread_cache_id_ != cache_id_) {
         std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
         
-        auto& buffers = thread_buffers_map_[threadId];
-        current_thread_buffers_ = &buffers;
+        auto& magazine = thread_buffers_map_[std::this_thread::get_id()];
+        if (!magazine) {
+            magazine = std::make_unique<ThreadMagazine>();
+        }
+        current_thread_buffers_ = magazine.get();
+        current_thread_cache_id_ = cache_id_;
         
         // 确保至少有默认数量的缓冲区
-        if (buffers.size() < config_.min_free_buffers) {
-            for (size_t i = buffers.size(); i < config_.min_free_buffers; ++i) {
-                Buffer* buffer = createNewBuffer(config_.default_buffer_size);
-                if (buffer) {
-                    buffers.push_back(std::unique_ptr<Buffer>(buffer));
-                }
+        std::lock_guard<std::mutex> magazineLock(magazine->mutex);
+        for (size_t i = magazine->buffers.size(); i < config_.min_free_buffers; ++i) {
+            Buffer* buffer = createNewBuffer(config_.default_buffer_size);
+            if (buffer) {
+                buffer->magazine = magazine.get();
+                magazine->buffers.push_back(std::unique_ptr<Buffer>(buffer));
             }
         }
     }
@@ -311,15 +518,13 @@ CompressBufferCache::ThreadBuffers& CompressBufferCache::getThreadBuffers() {
 CompressBufferCache::Buffer* CompressBufferCache::findSuitableBuffer(
     ThreadBuffers& buffers, size_t minSize) {
     
+    const size_t sizeClass = sizeClassFor(std::max(minSize, config_.min_class_size));
     Buffer* bestBuffer = nullptr;
-    size_t bestUtilization = SIZE_MAX;
     
-    // 查找可以容纳且利用率最低的缓冲区
+    // 同档位的空闲缓冲区中取最近用过的（缓存更热）
     for (auto& buffer : buffers) {
-        if (buffer->canFit(minSize)) {
-            size_t utilization = buffer->getUtilization();
-            if (utilization < bestUtilization) {
-                bestUtilization = utilization;
+        if (buffer->size_class == sizeClass && !buffer->lent) {
+            if (!bestBuffer || buffer->last_access > bestBuffer->last_access) {
                 bestBuffer = buffer.get();
             }
         }
@@ -330,29 +535,192 @@ CompressBufferCache::Buffer* CompressBufferCache::findSuitableBuffer(
 
 // 创建新缓冲区
 CompressBufferCache::Buffer* CompressBufferCache::createNewBuffer(size_t minSize) {
-    size_t estimatedSize = estimateOptimalSize(minSize);
-    size_t alignedSize = alignToSize(estimatedSize);
+    const size_t sizeClass = sizeClassFor(std::max(minSize, config_.min_class_size));
+    const size_t classCapacity = classSize(sizeClass);
     
-    void* data = std::malloc(alignedSize);
+    // 不清零：调用者总是先写后读
+    void* data = std::malloc(classCapacity);
     if (!data) {
         return nullptr;
     }
     
-    // 清零内存
-    std::memset(data, 0, alignedSize);
-    
     Buffer* buffer = new Buffer();
     buffer->data = data;
-    buffer->capacity = alignedSize;
+    buffer->capacity = classCapacity;
     buffer->current_size = 0;
     buffer->allocation_count = 1;
+    buffer->size_class = sizeClass;
+    buffer->allocated_counter = &total_allocated_memory_;
     
     // 更新全局统计
-    total_allocated_memory_.fetch_add(alignedSize, std::memory_order_relaxed);
+    total_allocated_memory_.fetch_add(classCapacity, std::memory_order_relaxed);
+    core::MemoryBudget::instance().charge(core::MemorySubsystem::COMPRESSION_BUFFERS, classCapacity);
     
     return buffer;
 }
 
+// 从depot取出指定档位的缓冲区
+std::unique_ptr<CompressBufferCache::Buffer> CompressBufferCache::takeFromDepot(size_t sizeClass) {
+    std::lock_guard<std::mutex> lock(depot_mutex_);
+    auto& bucket = depot_[sizeClass];
+    if (bucket.empty()) {
+        return nullptr;
+    }
+    std::unique_ptr<Buffer> buffer = std::move(bucket.back());
+    bucket.pop_back();
+    depot_bytes_ -= buffer->capacity;
+    return buffer;
+}
+
+// 缓冲区换出到depot；内存压力下或depot已满时直接释放
+void CompressBufferCache::releaseToDepot(std::unique_ptr<Buffer> buffer) {
+    if (!buffer) {
+        return;
+    }
+    buffer->magazine = nullptr;
+    buffer->lent = false;
+    buffer->current_size = 0;
+    if (isUnderMemoryPressure()) {
+        destroyBuffer(std::move(buffer));
+        return;
+    }
+    
+    std::unique_lock<std::mutex> lock(depot_mutex_);
+    if (depot_bytes_ + buffer->capacity > config_.depot_max_bytes) {
+        lock.unlock();
+        destroyBuffer(std::move(buffer));
+        return;
+    }
+    depot_bytes_ += buffer->capacity;
+    depot_[buffer->size_class].push_back(std::move(buffer));
+}
+
+// 释放缓冲区内存并记账
+void CompressBufferCache::destroyBuffer(std::unique_ptr<Buffer> buffer) {
+    if (!buffer) {
+        return;
+    }
+    total_allocated_memory_.fetch_sub(buffer->capacity, std::memory_order_relaxed);
+    core::MemoryBudget::instance().release(core::MemorySubsystem::COMPRESSION_BUFFERS, buffer->capacity);
+    global_memory_reclaimed_.fetch_add(buffer->capacity, std::memory_order_relaxed);
+}
+
+// 释放depot中的缓冲区：releaseAll时全部释放，否则只释放超过清理间隔未被取用的
+size_t CompressBufferCache::trimDepot(bool releaseAll) {
+    std::vector<std::unique_ptr<Buffer>> released;
+    {
+        std::lock_guard<std::mutex> lock(depot_mutex_);
+        const auto now = std::chrono::steady_clock::now();
+        const auto idleLimit = std::chrono::seconds(config_.cleanup_interval_seconds);
+        for (auto& bucket : depot_) {
+            // 每组末尾是最近放入的，从头部开始释放
+            size_t keepFrom = 0;
+            while (keepFrom < bucket.size() &&
+                   (releaseAll || now - bucket[keepFrom]->last_access > idleLimit)) {
+                ++keepFrom;
+            }
+            for (size_t i = 0; i < keepFrom; ++i) {
+                depot_bytes_ -= bucket[i]->capacity;
+                released.push_back(std::move(bucket[i]));
+            }
+            bucket.erase(bucket.begin(), bucket.begin() + static_cast<std::ptrdiff_t>(keepFrom));
+        }
+    }
+    
+    size_t releasedBytes = 0;
+    for (auto& buffer : released) {
+        releasedBytes += buffer->capacity;
+        destroyBuffer(std::move(buffer));
+    }
+    return releasedBytes;
+}
+
+// 按从大到小的档位释放空闲缓冲区，直到达到targetBytes：先depot，再各线程magazine中未借出的
+// includeReserve为false时每线程保留min_free_buffers个
+size_t CompressBufferCache::releaseIdleBytes(size_t targetBytes, bool includeReserve) {
+    std::vector<std::unique_ptr<Buffer>> released;
+    size_t releasedBytes = 0;
+    {
+        std::lock_guard<std::mutex> lock(depot_mutex_);
+        for (size_t sizeClass = NUM_SIZE_CLASSES; sizeClass-- > 0 && releasedBytes < targetBytes;) {
+            auto& bucket = depot_[sizeClass];
+            size_t count = 0;
+            while (count < bucket.size() && releasedBytes < targetBytes) {
+                releasedBytes += bucket[count]->capacity;
+                depot_bytes_ -= bucket[count]->capacity;
+                released.push_back(std::move(bucket[count]));
+                ++count;
+            }
+            bucket.erase(bucket.begin(), bucket.begin() + static_cast<std::ptrdiff_t>(count));
+        }
+    }
+    
+    if (releasedBytes < targetBytes) {
+        std::lock_guard<std::mutex> lock(thread_buffers_mutex_);
+        const size_t reserve = includeReserve ? 0 : config_.min_free_buffers;
+        for (auto& [threadId, magazine] : thread_buffers_map_) {
+            if (releasedBytes >= targetBytes) {
+                break;
+            }
+            std::lock_guard<std::mutex> magazineLock(magazine->mutex);
+            auto& buffers = magazine->buffers;
+            std::sort(buffers.begin(), buffers.end(), [](const auto& a, const auto& b) {
+                return a->capacity > b->capacity;
+            });
+            for (auto it = buffers.begin(); it != buffers.end() && releasedBytes < targetBytes;) {
+                if ((*it)->lent || buffers.size() <= reserve) {
+                    ++it;
+                    continue;
+                }
+                releasedBytes += (*it)->capacity;
+                released.push_back(std::move(*it));
+                it = buffers.erase(it);
+            }
+        }
+    }
+    
+    for (auto& buffer : released) {
+        destroyBuffer(std::move(buffer));
+    }
+    return releasedBytes;
+}
+
+// 把缓冲区放入线程magazine，超出每线程上限时先换出最久未用的空闲缓冲区
+void CompressBufferCache::adoptBuffer(ThreadMagazine& magazine, std::unique_ptr<Buffer> buffer) {
+    auto& buffers = magazine.buffers;
+    const size_t classLimit = std::max<size_t>(config_.magazine_size, 1);
+    size_t classCount = 0;
+    for (const auto& existing : buffers) {
+        if (existing->size_class == buffer->size_class) {
+            ++classCount;
+        }
+    }
+    if (classCount >= classLimit) {
+        // 同档位已满（预热时可能发生）
+        releaseToDepot(std::move(buffer));
+        return;
+    }
+    
+    while (buffers.size() >= config_.max_buffers_per_thread) {
+        auto victim = buffers.end();
+        for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+            if (!(*it)->lent && (victim == buffers.end() || (*it)->last_access < (*victim)->last_access)) {
+                victim = it;
+            }
+        }
+        if (victim == buffers.end()) {
+            // 全部借出：暂时超出上限，总量仍受每档位magazine_size限制
+            break;
+        }
+        std::unique_ptr<Buffer> evicted = std::move(*victim);
+        buffers.erase(victim);
+        releaseToDepot(std::move(evicted));
+    }
+    
+    buffer->magazine = &magazine;
+    buffers.push_back(std::move(buffer));
+}
+
 // 调整缓冲区容量
 void CompressBufferCache::adjustBufferCapacity(Buffer* buffer, size_t minSize) {
     if (!buffer || buffer->capacity >= minSize) {
@@ -387,7 +755,7 @@ bool CompressBufferCache::shouldCleanupThread(const ThreadBuffers& buffers) cons
     return false;
 }
 
-// 清理线程
+// 清理线程：长时间未使用的缓冲区换出到depot
 void CompressBufferCache::cleanupThread(ThreadBuffers& buffers) {
     if (buffers.size() <= config_.min_free_buffers) {
         return;
@@ -396,26 +764,20 @@ void CompressBufferCache::cleanupThread(ThreadBuffers& buffers) {
     auto now = std::chrono::steady_clock::now();
     constexpr auto TIMEOUT = std::chrono::minutes(5);
     
-    size_t memoryReclaimed = 0;
-    
     // 使用迭代器安全删除
     for (auto it = buffers.begin(); it != buffers.end();) {
         const auto& buffer = *it;
         auto age = now - buffer->last_access;
         
-        // 清理长时间未使用且非脏的缓冲区
-        if (age > TIMEOUT && !buffer->is_dirty && 
-            buffers.size() > config_.min_free_buffers) {
-            memoryReclaimed += buffer->capacity;
+        // 借出超过TIMEOUT仍未归还的缓冲区视为被遗弃（结果只在调用后短暂使用）
+        if (age > TIMEOUT && buffers.size() > config_.min_free_buffers) {
+            std::unique_ptr<Buffer> idle = std::move(*it);
             it = buffers.erase(it);
+            releaseToDepot(std::move(idle));
         } else {
             ++it;
         }
     }
-    
-    if (memoryReclaimed > 0) {
-        global_memory_reclaimed_.fetch_add(memoryReclaimed, std::memory_order_relaxed);
-    }
 }
 
 // 获取当前时间戳
@@ -423,23 +785,37 @@ size_t CompressBufferCache::getCurrentTick() const {
     return global_tick_counter_.fetch_add(1, std::memory_order_relaxed);
 }
 
-// 后台清理工作线程
+// 后台清理工作线程：每reclaim_interval_millis检查容器内存，每cleanup_interval_seconds做一次老化清理
 void CompressBufferCache::cleanupWorker() {
+    auto nextCleanup = std::chrono::steady_clock::now() +
+                       std::chrono::seconds(config_.cleanup_interval_seconds);
     while (cleanup_running_) {
         try {
             // 等待清理信号或定时清理
             {
+                auto wakeup = nextCleanup;
+                if (!cgroup_dir_.empty()) {
+                    wakeup = std::min(wakeup, std::chrono::steady_clock::now() +
+                                      std::chrono::milliseconds(std::max<size_t>(config_.reclaim_interval_millis, 10)));
+                }
                 std::unique_lock<std::mutex> lock(cleanup_mutex_);
-                cleanup_condition_.wait_for(lock, 
-                    std::chrono::seconds(config_.cleanup_interval_seconds));
+                cleanup_condition_.wait_until(lock, wakeup, [this] { return !cleanup_running_; });
             }
             
             if (!cleanup_running_) {
                 break;
             }
             
+            if (!cgroup_dir_.empty()) {
+                reclaimForMemoryPressure();
+            }
+            
             // 执行清理
-            performCleanup();
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= nextCleanup) {
+                performCleanup();
+                nextCleanup = now + std::chrono::seconds(config_.cleanup_interval_seconds);
+            }
             
         } catch (const std::exception& e) {
             std::cerr << "[CompressBufferCache] Cleanup worker error: " 
@@ -490,5 +866,28 @@ size_t CompressBufferCache::alignToSize(size_t size, size_t alignment) {
     return (size + mask) & ~mask;
 }
 
+// 解析/proc/self/cgroup中的cgroup v2路径（"0::/path"）；不可用时返回空
+std::string CompressBufferCache::detectCgroupDirectory() {
+    std::ifstream file("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("0::", 0) != 0) {
+            continue;
+        }
+        std::string path = line.substr(3);
+        while (!path.empty() && path.back() == '/') {
+            path.pop_back();
+        }
+        std::string dir = std::string(CGROUP_ROOT) + path;
+        std::ifstream controllers(std::string(CGROUP_ROOT) + "/cgroup.controllers");
+        if (!controllers) {
+            // 未挂载cgroup v2统一层级
+            return std::string();
+        }
+        return dir;
+    }
+    return std::string();
+}
+
 } // namespace net
 } // namespace lattice
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
 #include <vector>
 #include <thread>
@@ -13,6 +15,8 @@
 #include <optional>
 #include <string>
 
+#include "../memory_budget.hpp"
+
 namespace lattice {
 namespace net {
 
@@ -20,11 +24,24 @@ namespace net {
  * CompressBufferCache - 智能缓冲区管理缓存
  * 
  * 核心特性：
- * 1. 线程局部缓冲区：每个线程独立的缓冲区池，避免竞争
- * 2. 智能容量增长：自动预估和调整缓冲区大小
- * 3. LRU老化策略：后台线程清理长时间未使用的缓冲区
- * 4. 内存监控：实时监控内存使用，自动优化
- * 5. 零拷贝支持：与Arena Allocator集成，最大化性能
+ * 1. 2的幂次尺寸档位：请求按档位取整（最小min_class_size），同档位缓冲区可以互换，
+ *    热路径上不再realloc，混合负载（小包 + 200KB区块包）也不会产生大小不一的碎片
+ * 2. 线程局部magazine：每个线程每档位最多保留magazine_size个缓冲区，无竞争
+ * 3. 全局depot：magazine放不下或长时间空闲的缓冲区交给depot，其他线程可以复用，
+ *    depot总量受depot_max_bytes限制
+ * 4. 内存压力裁剪：已分配总量超过max_total_bytes * memory_pressure_threshold时，
+ *    换出的缓冲区直接释放，清理时清空depot
+ * 5. 容器内存上限：后台线程每reclaim_interval_millis读取cgroup v2的memory.max与
+ *    工作集（memory.current - inactive_file，与kubelet的OOM判断一致）。占用超过
+ *    reclaim_start_threshold后按比例逐步释放空闲缓冲区，越接近memory_pressure_threshold
+ *    释放越多；到达该阈值时释放全部空闲缓冲区，并按内存压力处理后续换出
+ * 6. 零拷贝支持：与Arena Allocator集成，最大化性能
+ * 7. native内存预算：已分配的缓冲区记到MemoryBudget的COMPRESSION_BUFFERS，
+ *    超出子系统预算时由回收线程释放空闲缓冲区（每线程保留min_free_buffers个）
+ * 
+ * 缓冲区语义：getBuffer()取出的缓冲区在returnBuffer()之前视为借出；不归还的调用者
+ * （只在当前线程内使用结果）仍然可以工作：同档位借出数达到magazine_size后，
+ * 最久未用的借出缓冲区会被同一线程复用，与原来的隐式复用行为一致。
  * 
  * 适用场景：
  * - 高频压缩/解压缩操作
@@ -43,8 +60,28 @@ public:
         size_t min_free_buffers = 2;                   // 最小保留缓冲区数
         float memory_pressure_threshold = 0.8f;        // 内存压力阈值 (80%)
         bool enable_async_cleanup = true;              // 启用异步清理
+        size_t min_class_size = 4 * 1024;              // 最小尺寸档位 (4KB)
+        size_t magazine_size = 4;                      // 每线程每档位保留的缓冲区数
+        size_t depot_max_bytes = 32 * 1024 * 1024;     // 全局depot容量上限 (32MB)
+        size_t max_total_bytes = 256 * 1024 * 1024;    // 内存压力阈值的基准 (256MB)
+        bool cgroup_aware = true;                      // 按cgroup v2内存上限回收
+        size_t reclaim_interval_millis = 1000;         // 内存上限检查间隔
+        float reclaim_start_threshold = 0.6f;          // 占用超过上限该比例时开始逐步回收
+    };
+    
+    // 进程所在容器的内存状况
+    struct MemoryStatus {
+        size_t limit_bytes = 0;        // cgroup memory.max；无上限时为0
+        size_t usage_bytes = 0;        // cgroup工作集；无cgroup时为进程RSS
+        bool from_cgroup = false;
+        
+        double getUsageRatio() const {
+            return limit_bytes > 0 ? static_cast<double>(usage_bytes) / limit_bytes : 0.0;
+        }
     };
     
+    struct ThreadMagazine;
+    
     // 缓冲区项
     struct Buffer {
         void* data;                    // 缓冲区数据
@@ -54,10 +91,15 @@ public:
         std::chrono::steady_clock::time_point last_access; // 最后访问时间
         size_t allocation_count;       // 分配次数统计
         bool is_dirty;                 // 是否需要清理
+        size_t size_class;             // 尺寸档位（capacity = 1 << size_class）
+        bool lent;                     // 是否已借出尚未归还
+        ThreadMagazine* magazine;      // 所属线程magazine；在depot中时为nullptr
+        std::atomic<size_t>* allocated_counter; // 所属缓存的已分配字节计数
         
         Buffer() 
             : data(nullptr), capacity(0), current_size(0), 
-              last_used_tick(0), allocation_count(0), is_dirty(true) {
+              last_used_tick(0), allocation_count(0), is_dirty(true),
+              size_class(0), lent(false), magazine(nullptr), allocated_counter(nullptr) {
             last_access = std::chrono::steady_clock::now();
         }
         
@@ -79,19 +121,28 @@ public:
             return size <= capacity;
         }
         
-        // 重新调整缓冲区大小
+        // 扩容到能容纳newCapacity的档位（保留已有内容，从不缩小）
+        // 只用于内容需要保留的增长（如NBTWriter）；按档位取到的缓冲区不需要调用
         bool resize(size_t newCapacity) {
-            if (newCapacity == capacity) {
+            if (newCapacity <= capacity) {
                 return true;
             }
             
-            void* newData = std::realloc(data, newCapacity);
+            const size_t newClass = sizeClassFor(newCapacity);
+            const size_t classCapacity = classSize(newClass);
+            void* newData = std::realloc(data, classCapacity);
             if (!newData) {
                 return false;
             }
             
+            if (allocated_counter) {
+                allocated_counter->fetch_add(classCapacity - capacity, std::memory_order_relaxed);
+                core::MemoryBudget::instance().charge(core::MemorySubsystem::COMPRESSION_BUFFERS,
+                                                      classCapacity - capacity);
+            }
             data = newData;
-            capacity = newCapacity;
+            capacity = classCapacity;
+            size_class = newClass;
             is_dirty = true;
             return true;
         }
@@ -113,6 +164,27 @@ public:
     // 线程局部缓冲区
     using ThreadBuffers = std::vector<std::unique_ptr<Buffer>>;
     
+    // 每线程的magazine；mutex只在后台清理与统计时才有竞争
+    struct ThreadMagazine {
+        std::mutex mutex;
+        ThreadBuffers buffers;
+    };
+    
+    static constexpr size_t NUM_SIZE_CLASSES = 48;
+    
+    // 能容纳size的最小档位
+    static size_t sizeClassFor(size_t size) {
+        size_t sizeClass = 0;
+        while (sizeClass + 1 < NUM_SIZE_CLASSES && (size_t{1} << sizeClass) < size) {
+            ++sizeClass;
+        }
+        return sizeClass;
+    }
+    
+    static size_t classSize(size_t sizeClass) {
+        return size_t{1} << sizeClass;
+    }
+    
     // 缓存统计信息
     struct CacheStats {
         size_t total_buffers;                    // 总缓冲区数
@@ -125,11 +197,21 @@ public:
         size_t memory_reclaimed;                 // 回收的内存量
         double hit_rate;                         // 命中率
         float average_utilization;               // 平均利用率
+        size_t depot_buffers;                    // depot中的缓冲区数
+        size_t depot_bytes;                      // depot中的字节数
+        size_t depot_hits;                       // 从depot取得缓冲区的次数
+        size_t lent_reuses;                      // 复用未归还缓冲区的次数
+        size_t pressure_reclaimed;               // 因容器内存上限回收的内存量（含在memory_reclaimed中）
+        size_t reclaim_passes;                   // 实际释放了内存的回收次数
+        size_t memory_limit_bytes;               // 最近一次检测到的cgroup内存上限
+        size_t memory_usage_bytes;               // 最近一次检测到的工作集
         
         CacheStats() 
             : total_buffers(0), active_buffers(0), total_memory_allocated(0),
               total_memory_used(0), cache_hits(0), cache_misses(0),
-              buffer_resizes(0), memory_reclaimed(0), hit_rate(0.0), average_utilization(0.0f) {}
+              buffer_resizes(0), memory_reclaimed(0), hit_rate(0.0), average_utilization(0.0f),
+              depot_buffers(0), depot_bytes(0), depot_hits(0), lent_reuses(0),
+              pressure_reclaimed(0), reclaim_passes(0), memory_limit_bytes(0), memory_usage_bytes(0) {}
         
         // 计算命中率
         double getHitRate() const {
@@ -155,8 +237,8 @@ public:
     CompressBufferCache& operator=(CompressBufferCache&&) = delete;
     
     /**
-     * 获取适合指定大小的缓冲区
-     * 如果没有合适的缓冲区，会创建新的或调整现有缓冲区
+     * 获取适合指定大小的缓冲区，容量为minSize所在档位的大小
+     * 依次尝试：当前线程magazine -> 全局depot -> 新分配
      */
     Buffer* getBuffer(size_t minSize);
     
@@ -166,7 +248,7 @@ public:
     void* getDirectBuffer(size_t minSize);
     
     /**
-     * 释放缓冲区到缓存（不实际释放内存）
+     * 归还缓冲区到所属线程的magazine（不实际释放内存）
      */
     void returnBuffer(Buffer* buffer);
     
@@ -191,10 +273,22 @@ public:
     size_t getThreadBufferCount(std::thread::id threadId = std::this_thread::get_id()) const;
     
     /**
-     * 检查内存压力状态
+     * 检查内存压力状态：已分配总量超过max_total_bytes * memory_pressure_threshold，
+     * 或最近一次检测时容器工作集超过memory_pressure_threshold
      */
     bool isUnderMemoryPressure() const;
     
+    /**
+     * 按当前容器内存状况回收一次空闲缓冲区（后台线程定期调用）
+     * @return 释放的字节数
+     */
+    size_t reclaimForMemoryPressure();
+    
+    /**
+     * 读取cgroup v2内存上限与工作集；不在cgroup v2中时只返回进程RSS
+     */
+    MemoryStatus getMemoryStatus() const;
+    
     /**
      * 强制清理所有缓冲区（谨慎使用）
      */
@@ -221,8 +315,11 @@ public:
     size_t estimateOptimalSize(size_t inputSize) const;
     
 private:
-    // 线程局部存储
-    thread_local static inline ThreadBuffers* current_thread_buffers_ = nullptr;
+    // 线程局部存储；按实例编号区分，避免多个缓存实例共用同一个指针
+    thread_local static inline ThreadMagazine* current_thread_buffers_ = nullptr;
+    thread_local static inline uint64_t current_thread_cache_id_ = 0;
+    static inline std::atomic<uint64_t> next_cache_id_{1};
+    const uint64_t cache_id_;
     
     // 配置
     Config config_;
@@ -234,10 +331,25 @@ private:
     mutable std::atomic<size_t> global_memory_reclaimed_{0};
     mutable std::atomic<size_t> total_allocated_memory_{0};
     mutable std::atomic<size_t> total_used_memory_{0};
+    mutable std::atomic<size_t> global_depot_hits_{0};
+    mutable std::atomic<size_t> global_lent_reuses_{0};
+    mutable std::atomic<size_t> global_pressure_reclaimed_{0};
+    mutable std::atomic<size_t> reclaim_passes_{0};
+    
+    // 容器内存检测；cgroup目录在构造时解析一次
+    const std::string cgroup_dir_;
+    std::atomic<bool> container_pressure_{false};
+    std::atomic<size_t> memory_limit_bytes_{0};
+    std::atomic<size_t> memory_usage_bytes_{0};
     
-    // 线程管理
+    // 线程管理；magazine创建后在缓存生命周期内不会删除，线程局部指针始终有效
     mutable std::mutex thread_buffers_mutex_;
-    std::unordered_map<std::thread::id, ThreadBuffers> thread_buffers_map_;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadMagazine>> thread_buffers_map_;
+    
+    // 全局depot，按档位分组，每组末尾是最近放入的
+    mutable std::mutex depot_mutex_;
+    std::vector<std::unique_ptr<Buffer>> depot_[NUM_SIZE_CLASSES];
+    size_t depot_bytes_ = 0;
     
     // 后台清理线程
     std::atomic<bool> cleanup_running_{false};
@@ -245,13 +357,22 @@ private:
     std::condition_variable cleanup_condition_;
     std::mutex cleanup_mutex_;
     
+    // MemoryBudget回收函数
+    uint64_t shedder_id_ = 0;
+    
     // 时间戳管理
     static std::atomic<size_t> global_tick_counter_;
     
     // 内部方法
-    ThreadBuffers& getThreadBuffers();
+    ThreadMagazine& getThreadBuffers();
     Buffer* findSuitableBuffer(ThreadBuffers& buffers, size_t minSize);
     Buffer* createNewBuffer(size_t minSize);
+    std::unique_ptr<Buffer> takeFromDepot(size_t sizeClass);
+    void releaseToDepot(std::unique_ptr<Buffer> buffer);
+    void destroyBuffer(std::unique_ptr<Buffer> buffer);
+    size_t trimDepot(bool releaseAll);
+    size_t releaseIdleBytes(size_t targetBytes, bool includeReserve);
+    void adoptBuffer(ThreadMagazine& magazine, std::unique_ptr<Buffer> buffer);
     void adjustBufferCapacity(Buffer* buffer, size_t minSize);
     bool shouldCleanupThread(const ThreadBuffers& buffers) const;
     void cleanupThread(ThreadBuffers& buffers);
@@ -264,6 +385,7 @@ private:
     static size_t calculateNextSize(size_t currentSize, size_t minSize, size_t growthFactor);
     static bool isPowerOfTwo(size_t size);
     static size_t alignToSize(size_t size, size_t alignment = 16);
+    static std::string detectCgroupDirectory();
 };
 
 } // namespace net
@@ -0,0 +1,165 @@
+#include "compression_skip_policy.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lattice {
+namespace net {
+
+namespace {
+
+constexpr size_t SAMPLE_SEGMENT = 16;
+
+} // namespace
+
+CompressionSkipPolicy& CompressionSkipPolicy::global() {
+    static CompressionSkipPolicy instance;
+    return instance;
+}
+
+CompressionSkipPolicy::Probe CompressionSkipPolicy::probe(const void* data, size_t length) const {
+    Probe result;
+    if (!data || length == 0) {
+        return result;
+    }
+
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint32_t histogram[256] = {};
+    size_t repeats = 0;
+    size_t pairs = 0;
+
+    auto sampleRange = [&](size_t begin, size_t end) {
+        uint8_t previous = bytes[begin];
+        ++histogram[previous];
+        for (size_t i = begin + 1; i < end; ++i) {
+            const uint8_t value = bytes[i];
+            ++histogram[value];
+            repeats += value == previous;
+            previous = value;
+        }
+        pairs += end - begin - 1;
+        result.sampled += end - begin;
+    };
+
+    if (length <= config_.sampleBytes || length < SAMPLE_SEGMENT * 2) {
+        sampleRange(0, length);
+    } else {
+        // 均匀分布的小段：覆盖包头、包体中部和结尾，避免只看到一种数据
+        const size_t segments = std::max<size_t>(config_.sampleBytes / SAMPLE_SEGMENT, 2);
+        const size_t stride = (length - SAMPLE_SEGMENT) / (segments - 1);
+        for (size_t s = 0; s < segments; ++s) {
+            const size_t begin = s * stride;
+            sampleRange(begin, begin + SAMPLE_SEGMENT);
+        }
+    }
+
+    const double total = static_cast<double>(result.sampled);
+    double entropy = 0.0;
+    for (uint32_t count : histogram) {
+        if (count) {
+            const double p = count / total;
+            entropy -= p * std::log2(p);
+        }
+    }
+    result.entropyBits = entropy;
+    result.repeatRatio = pairs ? static_cast<double>(repeats) / pairs : 0.0;
+    return result;
+}
+
+CompressionSkipPolicy::Decision CompressionSkipPolicy::decide(int packetType, const void* data, size_t length) {
+    decisions_.fetch_add(1, std::memory_order_relaxed);
+
+    if (packetType >= 0 && static_cast<size_t>(packetType) < MAX_PACKET_TYPES) {
+        TypeState& state = types_[packetType];
+        const uint32_t ratio = state.ratio.load(std::memory_order_relaxed);
+        if (state.samples.load(std::memory_order_relaxed) >= config_.minSamples &&
+            ratio >= static_cast<uint32_t>(config_.skipRatio * RATIO_ONE)) {
+            const uint32_t skipped = state.skipped.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (config_.reprobeInterval == 0 || skipped % config_.reprobeInterval != 0) {
+                skippedLearned_.fetch_add(1, std::memory_order_relaxed);
+                bytesSkipped_.fetch_add(length, std::memory_order_relaxed);
+                return Decision::SKIP_LEARNED;
+            }
+            // 定期压缩一次，让压缩比跟上数据的变化
+            reprobes_.fetch_add(1, std::memory_order_relaxed);
+            return Decision::COMPRESS;
+        }
+    }
+
+    if (length >= config_.minProbeSize) {
+        const Probe p = probe(data, length);
+        if (p.entropyBits >= config_.maxEntropyBits && p.repeatRatio < config_.minRepeatRatio) {
+            skippedEntropy_.fetch_add(1, std::memory_order_relaxed);
+            bytesSkipped_.fetch_add(length, std::memory_order_relaxed);
+            return Decision::SKIP_ENTROPY;
+        }
+    }
+    return Decision::COMPRESS;
+}
+
+void CompressionSkipPolicy::record(int packetType, size_t inputBytes, size_t outputBytes) {
+    if (packetType < 0 || static_cast<size_t>(packetType) >= MAX_PACKET_TYPES || inputBytes == 0) {
+        return;
+    }
+    TypeState& state = types_[packetType];
+    const double sample = std::min(static_cast<double>(outputBytes) / inputBytes, 2.0);
+    const uint32_t sampleFixed = static_cast<uint32_t>(sample * RATIO_ONE);
+
+    // 前几个样本直接取平均，之后按1/8的权重做指数移动平均
+    const uint32_t samples = state.samples.fetch_add(1, std::memory_order_relaxed);
+    const uint32_t current = state.ratio.load(std::memory_order_relaxed);
+    const int64_t weight = samples < 8 ? samples + 1 : 8;
+    const int64_t updated = samples == 0
+        ? sampleFixed
+        : current + (static_cast<int64_t>(sampleFixed) - current) / weight;
+    state.ratio.store(static_cast<uint32_t>(updated), std::memory_order_relaxed);
+}
+
+double CompressionSkipPolicy::learnedRatio(int packetType) const {
+    if (packetType < 0 || static_cast<size_t>(packetType) >= MAX_PACKET_TYPES) {
+        return 1.0;
+    }
+    const TypeState& state = types_[packetType];
+    if (state.samples.load(std::memory_order_relaxed) == 0) {
+        return 1.0;
+    }
+    return static_cast<double>(state.ratio.load(std::memory_order_relaxed)) / RATIO_ONE;
+}
+
+int CompressionSkipPolicy::readPacketId(const void* data, size_t length) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint32_t value = 0;
+    for (size_t i = 0; i < length && i < 5; ++i) {
+        value |= static_cast<uint32_t>(bytes[i] & 0x7F) << (7 * i);
+        if ((bytes[i] & 0x80) == 0) {
+            return value <= 0x7FFFFFFF ? static_cast<int>(value) : -1;
+        }
+    }
+    return -1;
+}
+
+void CompressionSkipPolicy::reset() {
+    for (TypeState& state : types_) {
+        state.ratio.store(RATIO_ONE, std::memory_order_relaxed);
+        state.samples.store(0, std::memory_order_relaxed);
+        state.skipped.store(0, std::memory_order_relaxed);
+    }
+    decisions_.store(0, std::memory_order_relaxed);
+    skippedEntropy_.store(0, std::memory_order_relaxed);
+    skippedLearned_.store(0, std::memory_order_relaxed);
+    reprobes_.store(0, std::memory_order_relaxed);
+    bytesSkipped_.store(0, std::memory_order_relaxed);
+}
+
+CompressionSkipPolicy::Stats CompressionSkipPolicy::getStats() const {
+    Stats stats;
+    stats.decisions = decisions_.load(std::memory_order_relaxed);
+    stats.skippedEntropy = skippedEntropy_.load(std::memory_order_relaxed);
+    stats.skippedLearned = skippedLearned_.load(std::memory_order_relaxed);
+    stats.reprobes = reprobes_.load(std::memory_order_relaxed);
+    stats.bytesSkipped = bytesSkipped_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace net
+} // namespace lattice
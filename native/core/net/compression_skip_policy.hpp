@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lattice {
+namespace net {
+
+/**
+ * CompressionSkipPolicy - 判断数据包是否值得压缩
+ *
+ * 两层判断，都在deflate之前完成：
+ * 1. 采样字节直方图：大包只取均匀分布的若干个小段，计算0阶熵与相邻重复字节比例，
+ *    熵接近8 bit/byte且几乎没有重复的数据（已压缩的地图数据、加密负载等）直接跳过
+ * 2. 按包类型学习的压缩比：每次实际压缩后记录输出/输入的指数移动平均，
+ *    长期压不下去的包类型直接跳过；每reprobeInterval个包仍压缩一次，数据变化后能重新学习
+ *
+ * 跳过的包以未压缩格式（VarInt(0) + 原始数据）发送，协议允许任意大小的包这样发送。
+ * 线程安全：所有状态都是relaxed原子量，统计有轻微竞争误差但不影响正确性。
+ */
+class CompressionSkipPolicy {
+public:
+    struct Config {
+        size_t minProbeSize = 256;           // 更小的包不做熵探测（直接压缩）
+        size_t sampleBytes = 1024;           // 大包的采样字节数
+        double maxEntropyBits = 7.6;         // 采样熵高于该值视为不可压缩
+        double minRepeatRatio = 0.02;        // 相邻重复字节比例高于该值时不按熵跳过
+        double skipRatio = 0.95;             // 学习到的输出/输入比高于该值时跳过
+        uint32_t minSamples = 8;             // 某类型至少压缩过这么多次才按学习的比例跳过
+        uint32_t reprobeInterval = 64;       // 按学习比例跳过时，每N个包仍压缩一次
+    };
+
+    enum class Decision {
+        COMPRESS,
+        SKIP_ENTROPY,        // 采样熵过高
+        SKIP_LEARNED         // 该包类型学习到的压缩比过差
+    };
+
+    struct Probe {
+        double entropyBits{0.0};     // 每字节的0阶熵
+        double repeatRatio{0.0};     // 与前一字节相同的比例
+        size_t sampled{0};
+    };
+
+    struct Stats {
+        uint64_t decisions{0};
+        uint64_t skippedEntropy{0};
+        uint64_t skippedLearned{0};
+        uint64_t reprobes{0};
+        uint64_t bytesSkipped{0};
+    };
+
+    static constexpr size_t MAX_PACKET_TYPES = 256;
+
+    CompressionSkipPolicy() = default;
+    explicit CompressionSkipPolicy(const Config& config) : config_(config) {}
+
+    CompressionSkipPolicy(const CompressionSkipPolicy&) = delete;
+    CompressionSkipPolicy& operator=(const CompressionSkipPolicy&) = delete;
+
+    // 进程内共享的默认实例（NativeCompressor / PacketBatchCompressor使用）
+    static CompressionSkipPolicy& global();
+
+    /**
+     * packetType为包ID，未知时传-1（只做熵探测）
+     * 返回COMPRESS时调用者压缩后应调用record()反馈实际压缩比
+     */
+    Decision decide(int packetType, const void* data, size_t length);
+
+    void record(int packetType, size_t inputBytes, size_t outputBytes);
+
+    // 采样直方图探测，不修改任何状态
+    Probe probe(const void* data, size_t length) const;
+
+    // 学习到的输出/输入比；没有样本时返回1.0
+    double learnedRatio(int packetType) const;
+
+    // 从包体开头读取VarInt包ID；格式错误时返回-1
+    static int readPacketId(const void* data, size_t length);
+
+    void reset();
+    Stats getStats() const;
+    const Config& getConfig() const { return config_; }
+
+private:
+    // 压缩比以1/65536为单位的定点数存储，便于原子更新
+    static constexpr uint32_t RATIO_ONE = 1u << 16;
+
+    struct TypeState {
+        std::atomic<uint32_t> ratio{RATIO_ONE};
+        std::atomic<uint32_t> samples{0};
+        std::atomic<uint32_t> skipped{0};
+    };
+
+    Config config_;
+    std::array<TypeState, MAX_PACKET_TYPES> types_{};
+
+    std::atomic<uint64_t> decisions_{0};
+    std::atomic<uint64_t> skippedEntropy_{0};
+    std::atomic<uint64_t> skippedLearned_{0};
+    std::atomic<uint64_t> reprobes_{0};
+    std::atomic<uint64_t> bytesSkipped_{0};
+};
+
+} // namespace net
+} // namespace lattice
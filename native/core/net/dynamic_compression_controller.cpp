@@ -0,0 +1,291 @@
+#include "dynamic_compression_controller.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace lattice {
+namespace net {
+
+namespace {
+
+// libdeflate各级别每字节耗时的相对值（以级别1为1），用于外推尚未使用过的级别
+constexpr std::array<double, NativeCompressor::MAX_COMPRESSION_LEVEL + 1> RELATIVE_COST = {
+    0.1, 1.0, 1.2, 1.4, 1.6, 1.9, 2.3, 3.0, 4.5, 6.0, 12.0, 18.0, 28.0
+};
+
+// 一个周期内某级别的输入少于该值时不更新其每字节耗时（样本太少，计时噪声大）
+constexpr uint64_t MIN_COST_SAMPLE_BYTES = 64 * 1024;
+
+// 压缩占用超出预算该比例时不等滞回，立即降一级
+constexpr double BUDGET_OVERRUN_FACTOR = 1.25;
+
+} // namespace
+
+DynamicCompressionController::DynamicCompressionController()
+    : DynamicCompressionController(Config{}) {
+}
+
+DynamicCompressionController::DynamicCompressionController(const Config& config)
+    : ceiling_(-1) {
+    configure(config);
+}
+
+DynamicCompressionController& DynamicCompressionController::global() {
+    static DynamicCompressionController instance;
+    return instance;
+}
+
+void DynamicCompressionController::configure(const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    config_.minLevel = std::clamp(config_.minLevel, NativeCompressor::MIN_COMPRESSION_LEVEL,
+                                  NativeCompressor::MAX_COMPRESSION_LEVEL);
+    config_.maxLevel = std::clamp(config_.maxLevel, config_.minLevel, NativeCompressor::MAX_COMPRESSION_LEVEL);
+    config_.baseLevel = std::clamp(config_.baseLevel, config_.minLevel, config_.maxLevel);
+    config_.hysteresisSamples = std::max<uint32_t>(config_.hysteresisSamples, 1);
+    config_.costSmoothing = std::clamp(config_.costSmoothing, 0.01, 1.0);
+
+    ceiling_ = ceiling_ < 0 ? config_.maxLevel : std::clamp(ceiling_, config_.minLevel, config_.maxLevel);
+    for (auto& [id, connection] : connections_) {
+        connection.level = std::clamp(connection.level, config_.minLevel, ceiling_);
+    }
+    snapshot_.ceiling = ceiling_;
+}
+
+DynamicCompressionController::Config DynamicCompressionController::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+void DynamicCompressionController::updateConnection(uint64_t connectionId, double rttMs, uint64_t bytesSent) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = connections_.try_emplace(connectionId);
+    Connection& connection = it->second;
+    if (inserted) {
+        connection.level = std::min(config_.baseLevel, ceiling_);
+    }
+    connection.rttMs = rttMs;
+    connection.bytesSent = bytesSent;
+}
+
+void DynamicCompressionController::removeConnection(uint64_t connectionId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.erase(connectionId);
+}
+
+int DynamicCompressionController::levelFor(uint64_t connectionId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(connectionId);
+    if (it == connections_.end()) {
+        return std::min(config_.baseLevel, ceiling_);
+    }
+    return it->second.level;
+}
+
+int DynamicCompressionController::tick() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto now = std::chrono::steady_clock::now();
+    if (!sampled_ || now - lastSample_ >= std::chrono::milliseconds(config_.sampleIntervalMillis)) {
+        sampleLocked(now);
+    }
+    return ceiling_;
+}
+
+int DynamicCompressionController::sampleNow() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sampleLocked(std::chrono::steady_clock::now());
+    return ceiling_;
+}
+
+DynamicCompressionController::Snapshot DynamicCompressionController::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snapshot = snapshot_;
+    snapshot.ceiling = ceiling_;
+    snapshot.connections = connections_.size();
+    return snapshot;
+}
+
+double DynamicCompressionController::readProcessCpuSeconds() {
+    std::ifstream file("/proc/self/stat");
+    std::string content;
+    if (!file || !std::getline(file, content)) {
+        return -1.0;
+    }
+    // comm字段可能含空格，从最后一个')'之后开始按空格切分：第0项是state(字段3)
+    const size_t close = content.rfind(')');
+    if (close == std::string::npos) {
+        return -1.0;
+    }
+    std::istringstream fields(content.substr(close + 1));
+    std::string token;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    for (int index = 0; fields >> token; ++index) {
+        if (index == 11) {
+            utime = std::stoull(token);
+        } else if (index == 12) {
+            stime = std::stoull(token);
+            const long ticks = sysconf(_SC_CLK_TCK);
+            return ticks > 0 ? static_cast<double>(utime + stime) / ticks : -1.0;
+        }
+    }
+    return -1.0;
+}
+
+double DynamicCompressionController::costPerByteLocked(int level) const {
+    if (nanosPerByte_[level] > 0.0) {
+        return nanosPerByte_[level];
+    }
+    // 按最近的已测级别和相对成本表外推
+    int nearest = -1;
+    for (int distance = 1; distance < LEVELS && nearest < 0; ++distance) {
+        if (level - distance >= 0 && nanosPerByte_[level - distance] > 0.0) {
+            nearest = level - distance;
+        } else if (level + distance < LEVELS && nanosPerByte_[level + distance] > 0.0) {
+            nearest = level + distance;
+        }
+    }
+    if (nearest < 0) {
+        return 0.0;
+    }
+    return nanosPerByte_[nearest] * RELATIVE_COST[level] / RELATIVE_COST[nearest];
+}
+
+int DynamicCompressionController::computeCeilingLocked(double bytesPerSecond) const {
+    if (bytesPerSecond <= 0.0) {
+        return config_.maxLevel;
+    }
+    for (int level = config_.maxLevel; level > config_.minLevel; --level) {
+        const double nanosPerByte = costPerByteLocked(level);
+        if (nanosPerByte <= 0.0) {
+            // 没有任何成本样本：不凭空限制
+            return config_.maxLevel;
+        }
+        const double predictedCores = bytesPerSecond * nanosPerByte / 1e9;
+        if (predictedCores <= config_.cpuBudgetCores) {
+            return level;
+        }
+    }
+    return config_.minLevel;
+}
+
+int DynamicCompressionController::desiredLevelLocked(const Connection& connection) const {
+    int level = config_.baseLevel;
+    if (connection.rttMs > config_.rttHighMs) {
+        // 高RTT的连接通常受带宽限制，多花CPU换更少的字节
+        level += 2;
+    } else if (connection.rttMs > 0.0 && connection.rttMs < config_.rttLowMs) {
+        level -= 1;
+    }
+    return std::clamp(level, config_.minLevel, ceiling_);
+}
+
+bool DynamicCompressionController::stepTowardsLocked(int& level, int target, int& pendingDirection,
+                                                     uint32_t& pendingCount) {
+    if (target == level) {
+        pendingDirection = 0;
+        pendingCount = 0;
+        return false;
+    }
+    const int direction = target > level ? 1 : -1;
+    if (direction != pendingDirection) {
+        pendingDirection = direction;
+        pendingCount = 0;
+    }
+    if (++pendingCount < config_.hysteresisSamples) {
+        return false;
+    }
+    level += direction;
+    pendingCount = 0;
+    return true;
+}
+
+void DynamicCompressionController::sampleLocked(std::chrono::steady_clock::time_point now) {
+    std::array<NativeCompressor::LevelStats, LEVELS> current;
+    for (int level = 0; level < LEVELS; ++level) {
+        current[level] = NativeCompressor::getLevelStats(level);
+    }
+    const double cpuSeconds = readProcessCpuSeconds();
+
+    if (!sampled_) {
+        lastLevelStats_ = current;
+        lastProcessCpuSeconds_ = cpuSeconds;
+        lastSample_ = now;
+        sampled_ = true;
+        return;
+    }
+
+    const double elapsed = std::chrono::duration<double>(now - lastSample_).count();
+    if (elapsed <= 0.0) {
+        return;
+    }
+
+    uint64_t totalNanos = 0;
+    uint64_t totalInput = 0;
+    uint64_t totalOutput = 0;
+    for (int level = 0; level < LEVELS; ++level) {
+        const uint64_t input = current[level].input_bytes - lastLevelStats_[level].input_bytes;
+        const uint64_t output = current[level].output_bytes - lastLevelStats_[level].output_bytes;
+        const uint64_t nanos = current[level].busy_nanos - lastLevelStats_[level].busy_nanos;
+        totalNanos += nanos;
+        totalInput += input;
+        totalOutput += output;
+        if (input >= MIN_COST_SAMPLE_BYTES) {
+            const double sample = static_cast<double>(nanos) / input;
+            nanosPerByte_[level] = nanosPerByte_[level] > 0.0
+                ? nanosPerByte_[level] + config_.costSmoothing * (sample - nanosPerByte_[level])
+                : sample;
+        }
+    }
+    lastLevelStats_ = current;
+
+    snapshot_.compressionCores = totalNanos / 1e9 / elapsed;
+    snapshot_.bytesPerSecond = totalInput / elapsed;
+    snapshot_.averageRatio = totalOutput > 0 ? static_cast<double>(totalInput) / totalOutput : 0.0;
+    if (cpuSeconds >= 0.0 && lastProcessCpuSeconds_ >= 0.0) {
+        const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+        snapshot_.processCpu = (cpuSeconds - lastProcessCpuSeconds_) / elapsed / cores;
+    }
+    lastProcessCpuSeconds_ = cpuSeconds;
+    lastSample_ = now;
+    ++snapshot_.samples;
+
+    // 预算内能承受的最高级别；进程整体过载时再让出一级
+    int ceilingTarget = computeCeilingLocked(snapshot_.bytesPerSecond);
+    if (snapshot_.processCpu > config_.processCpuHigh) {
+        ceilingTarget = std::min(ceilingTarget, ceiling_ - 1);
+    }
+    ceilingTarget = std::clamp(ceilingTarget, config_.minLevel, config_.maxLevel);
+
+    if (snapshot_.compressionCores > config_.cpuBudgetCores * BUDGET_OVERRUN_FACTOR &&
+        ceiling_ > config_.minLevel) {
+        // 明显超出预算：立即降级，不等滞回
+        --ceiling_;
+        ceilingPendingDirection_ = 0;
+        ceilingPendingCount_ = 0;
+    } else {
+        stepTowardsLocked(ceiling_, ceilingTarget, ceilingPendingDirection_, ceilingPendingCount_);
+    }
+    snapshot_.ceiling = ceiling_;
+
+    for (auto& [id, connection] : connections_) {
+        if (connection.level > ceiling_) {
+            connection.level = ceiling_;
+            connection.pendingDirection = 0;
+            connection.pendingCount = 0;
+            ++snapshot_.levelChanges;
+            continue;
+        }
+        if (stepTowardsLocked(connection.level, desiredLevelLocked(connection),
+                              connection.pendingDirection, connection.pendingCount)) {
+            ++snapshot_.levelChanges;
+        }
+    }
+}
+
+} // namespace net
+} // namespace lattice
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#include "native_compressor.hpp"
+
+namespace lattice {
+namespace net {
+
+/**
+ * DynamicCompressionController - 闭环的压缩级别控制器
+ *
+ * 取代调用者手工填写DynamicCompression::Stats的方式，每个采样周期自己收集信号：
+ * - NativeCompressor::getLevelStats()：各级别实际压缩的字节数、耗时与压缩比，
+ *   得出压缩占用的CPU核数，以及每个级别的每字节耗时（未使用过的级别按相对成本表外推）
+ * - /proc/self/stat：整个进程的CPU占用（utime + stime）
+ * - Java传入的每连接RTT与发送字节数
+ *
+ * 控制目标：压缩占用的CPU不超过cpuBudgetCores，在此前提下尽量用更高的级别减少带宽。
+ * 每次采样先按成本模型求出预算内能承受的最高级别(ceiling)，进程CPU过高时再往下压；
+ * 每个连接的目标级别在ceiling以内按RTT调整（高RTT的连接受带宽限制，值得多压缩）。
+ * 级别变化带滞回：目标连续hysteresisSamples次指向同一方向才移动一级。
+ *
+ * 线程安全：所有方法都可以从任意线程调用。
+ */
+class DynamicCompressionController {
+public:
+    struct Config {
+        double cpuBudgetCores = 1.0;         // 压缩允许占用的CPU核数
+        double processCpuHigh = 0.85;        // 进程CPU占用（占全部核心的比例）高于该值时降级
+        int minLevel = 1;
+        int maxLevel = 9;
+        int baseLevel = 6;                   // 新连接的初始级别
+        double rttHighMs = 150.0;            // RTT高于该值的连接倾向更高级别
+        double rttLowMs = 40.0;              // RTT低于该值的连接倾向更低级别
+        uint32_t hysteresisSamples = 3;
+        uint64_t sampleIntervalMillis = 1000;
+        double costSmoothing = 0.3;          // 每字节耗时估计的指数平滑权重
+    };
+
+    struct Snapshot {
+        int ceiling{0};                      // 当前预算允许的最高级别
+        double compressionCores{0.0};        // 上个周期压缩占用的CPU核数
+        double processCpu{0.0};              // 上个周期进程CPU占用（0-1，占全部核心）
+        double bytesPerSecond{0.0};          // 上个周期的压缩输入速率
+        double averageRatio{0.0};            // 上个周期的输入/输出比
+        size_t connections{0};
+        uint64_t samples{0};
+        uint64_t levelChanges{0};
+    };
+
+    DynamicCompressionController();
+    explicit DynamicCompressionController(const Config& config);
+
+    DynamicCompressionController(const DynamicCompressionController&) = delete;
+    DynamicCompressionController& operator=(const DynamicCompressionController&) = delete;
+
+    static DynamicCompressionController& global();
+
+    void configure(const Config& config);
+    Config getConfig() const;
+
+    // Java每个连接每秒左右调用一次；bytesSent为累计值
+    void updateConnection(uint64_t connectionId, double rttMs, uint64_t bytesSent);
+    void removeConnection(uint64_t connectionId);
+
+    // 连接当前应使用的级别；未知连接返回min(baseLevel, ceiling)
+    int levelFor(uint64_t connectionId) const;
+
+    /**
+     * 距上次采样超过sampleIntervalMillis时采样并重新决策，返回当前ceiling
+     * 可以每tick调用
+     */
+    int tick();
+
+    // 立即采样（测试与手动刷新）
+    int sampleNow();
+
+    Snapshot getSnapshot() const;
+
+    // 读取/proc/self/stat中的utime + stime（秒）；不可用时返回负数
+    static double readProcessCpuSeconds();
+
+private:
+    static constexpr int LEVELS = NativeCompressor::MAX_COMPRESSION_LEVEL + 1;
+
+    struct Connection {
+        double rttMs{0.0};
+        uint64_t bytesSent{0};
+        int level{0};
+        int pendingDirection{0};             // 最近几次目标相对当前级别的方向
+        uint32_t pendingCount{0};
+    };
+
+    // 以下方法要求持有mutex_
+    void sampleLocked(std::chrono::steady_clock::time_point now);
+    double costPerByteLocked(int level) const;
+    int computeCeilingLocked(double bytesPerSecond) const;
+    int desiredLevelLocked(const Connection& connection) const;
+    bool stepTowardsLocked(int& level, int target, int& pendingDirection, uint32_t& pendingCount);
+
+    mutable std::mutex mutex_;
+    Config config_;
+
+    std::unordered_map<uint64_t, Connection> connections_;
+
+    std::array<NativeCompressor::LevelStats, LEVELS> lastLevelStats_{};
+    std::array<double, LEVELS> nanosPerByte_{};          // 0表示尚无样本
+    std::chrono::steady_clock::time_point lastSample_{};
+    double lastProcessCpuSeconds_{-1.0};
+    bool sampled_{false};
+
+    int ceiling_;
+    int ceilingPendingDirection_{0};
+    uint32_t ceilingPendingCount_{0};
+    Snapshot snapshot_;
+};
+
+} // namespace net
+} // namespace lattice
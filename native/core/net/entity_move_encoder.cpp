@@ -0,0 +1,292 @@
+#include "entity_move_encoder.hpp"
+#include "packet_batch_compressor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace lattice {
+namespace net {
+
+namespace {
+
+// 最长的包体（Teleport）：两个VarInt + 3个double + 3字节
+constexpr size_t MAX_BODY_SIZE = 64;
+
+void appendVarInt(std::vector<uint8_t>& dst, uint32_t value) {
+    while (value >= 0x80) {
+        dst.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    dst.push_back(static_cast<uint8_t>(value));
+}
+
+// 定长栈上缓冲区中的包体写入（大端序，与原版FriendlyByteBuf相同）
+struct BodyWriter {
+    uint8_t data[MAX_BODY_SIZE];
+    size_t size = 0;
+
+    void varInt(int32_t signedValue) {
+        uint32_t value = static_cast<uint32_t>(signedValue);
+        while (value >= 0x80) {
+            data[size++] = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        data[size++] = static_cast<uint8_t>(value);
+    }
+
+    void byte(uint8_t value) { data[size++] = value; }
+
+    void int16(int16_t signedValue) {
+        const uint16_t value = static_cast<uint16_t>(signedValue);
+        data[size++] = static_cast<uint8_t>(value >> 8);
+        data[size++] = static_cast<uint8_t>(value);
+    }
+
+    void float64(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            data[size++] = static_cast<uint8_t>(bits >> shift);
+        }
+    }
+};
+
+bool fitsShort(int64_t delta) {
+    return delta >= INT16_MIN && delta <= INT16_MAX;
+}
+
+} // namespace
+
+uint8_t EntityMoveEncoder::angleByte(float degrees) {
+    if (!std::isfinite(degrees)) {
+        return 0;
+    }
+    // 先对360取余，避免超大角度转换为整数时溢出
+    const float wrapped = std::fmod(degrees, 360.0f);
+    return static_cast<uint8_t>(static_cast<int32_t>(std::floor(wrapped * 256.0f / 360.0f)));
+}
+
+int64_t EntityMoveEncoder::fixedPoint(float coordinate) {
+    return std::llround(static_cast<double>(coordinate) * 4096.0);
+}
+
+bool EntityMoveEncoder::isConfigured() const {
+    return config_.moveEntityPosId >= 0 && config_.moveEntityPosRotId >= 0 &&
+           config_.moveEntityRotId >= 0 && config_.rotateHeadId >= 0 && config_.teleportEntityId >= 0;
+}
+
+void EntityMoveEncoder::appendFrame(std::vector<uint8_t>& dst, const uint8_t* body, size_t length,
+                                    int compressionThreshold) {
+    if (compressionThreshold < 0) {
+        appendVarInt(dst, static_cast<uint32_t>(length));
+        dst.insert(dst.end(), body, body + length);
+        return;
+    }
+
+    region_.resize(length + PacketBatchCompressor::MAX_FRAME_OVERHEAD);
+    std::memcpy(region_.data(), body, length);
+    const int32_t written = PacketBatchCompressor::compressPacket(region_.data(), length, region_.size(),
+                                                                  compressionThreshold, config_.compressionLevel);
+    if (written < 0) {
+        // 压缩失败时按未压缩格式写出
+        appendVarInt(dst, static_cast<uint32_t>(length + 1));
+        dst.push_back(0);
+        dst.insert(dst.end(), body, body + length);
+        return;
+    }
+    appendVarInt(dst, static_cast<uint32_t>(written));
+    dst.insert(dst.end(), region_.data(), region_.data() + written);
+}
+
+EntityMoveEncoder::EncodeResult EntityMoveEncoder::encode(int viewerId, const Columns& columns,
+                                                          const uint32_t* slots, const Detail* details,
+                                                          size_t count, int compressionThreshold,
+                                                          size_t maxBytes, std::vector<uint8_t>& out) {
+    EncodeResult result;
+    ++stats_.encodes;
+    if (!isConfigured() || !slots || count == 0 || !columns.ids || !columns.xs || !columns.ys ||
+        !columns.zs || !columns.yaws || !columns.pitches || !columns.headYaws || !columns.onGround) {
+        return result;
+    }
+
+    ViewerState& state = viewers_[viewerId];
+    frames_.clear();
+    frameEnds_.clear();
+
+    const bool bundling = config_.bundleDelimiterId >= 0;
+    if (bundling) {
+        BodyWriter body;
+        body.varInt(config_.bundleDelimiterId);
+        delimiter_.clear();
+        appendFrame(delimiter_, body.data, body.size, compressionThreshold);
+    }
+    // 2个以上的包才包进bundle，每MAX_BUNDLE_PACKETS个包一对分隔符
+    auto outputSize = [&](size_t frameBytes, size_t packets) {
+        if (!bundling || packets < 2) {
+            return frameBytes;
+        }
+        const size_t bundles = (packets + MAX_BUNDLE_PACKETS - 1) / MAX_BUNDLE_PACKETS;
+        return frameBytes + bundles * 2 * delimiter_.size();
+    };
+
+    std::array<uint64_t, KIND_COUNT> kinds{};
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t slot = slots[i];
+        const Detail detail = details ? details[i] : Detail::FULL;
+        const int entityId = columns.ids[slot];
+
+        auto [it, inserted] = state.try_emplace(entityId);
+        const ClientState& client = it->second;
+        ClientState next = client;
+        next.x = fixedPoint(columns.xs[slot]);
+        next.y = fixedPoint(columns.ys[slot]);
+        next.z = fixedPoint(columns.zs[slot]);
+        next.onGround = columns.onGround[slot] != 0;
+
+        const int64_t dx = next.x - client.x;
+        const int64_t dy = next.y - client.y;
+        const int64_t dz = next.z - client.z;
+        const uint8_t yaw = angleByte(columns.yaws[slot]);
+        const uint8_t pitch = angleByte(columns.pitches[slot]);
+        const uint8_t headYaw = angleByte(columns.headYaws[slot]);
+
+        // 首次更新时客户端基准未知，增量超出short范围时无法相对移动
+        const bool teleport = inserted || !fitsShort(dx) || !fitsShort(dy) || !fitsShort(dz);
+        const bool moved = dx != 0 || dy != 0 || dz != 0 || next.onGround != client.onGround;
+        const bool rotated = detail != Detail::POSITION && (yaw != client.yaw || pitch != client.pitch);
+        const bool turnedHead = detail == Detail::FULL && (inserted || headYaw != client.headYaw);
+
+        const size_t frameMark = frames_.size();
+        const size_t packetMark = frameEnds_.size();
+        std::array<uint64_t, KIND_COUNT> entityKinds{};
+        auto emit = [&](const BodyWriter& body, PacketKind kind) {
+            appendFrame(frames_, body.data, body.size, compressionThreshold);
+            frameEnds_.push_back(frames_.size());
+            ++entityKinds[kind];
+        };
+
+        if (teleport) {
+            BodyWriter body;
+            body.varInt(config_.teleportEntityId);
+            body.varInt(entityId);
+            body.float64(columns.xs[slot]);
+            body.float64(columns.ys[slot]);
+            body.float64(columns.zs[slot]);
+            body.byte(yaw);
+            body.byte(pitch);
+            body.byte(next.onGround ? 1 : 0);
+            emit(body, KIND_TELEPORT);
+            next.yaw = yaw;
+            next.pitch = pitch;
+        } else if (moved || rotated) {
+            BodyWriter body;
+            PacketKind kind = KIND_MOVE;
+            if (moved && rotated) {
+                body.varInt(config_.moveEntityPosRotId);
+                kind = KIND_MOVE_ROTATE;
+            } else if (moved) {
+                body.varInt(config_.moveEntityPosId);
+            } else {
+                body.varInt(config_.moveEntityRotId);
+                kind = KIND_ROTATE;
+            }
+            body.varInt(entityId);
+            if (moved) {
+                body.int16(static_cast<int16_t>(dx));
+                body.int16(static_cast<int16_t>(dy));
+                body.int16(static_cast<int16_t>(dz));
+            } else {
+                // 只旋转时位置不变
+                next.x = client.x;
+                next.y = client.y;
+                next.z = client.z;
+            }
+            if (rotated) {
+                body.byte(yaw);
+                body.byte(pitch);
+                next.yaw = yaw;
+                next.pitch = pitch;
+            }
+            body.byte(next.onGround ? 1 : 0);
+            emit(body, kind);
+        }
+        if (turnedHead) {
+            BodyWriter body;
+            body.varInt(config_.rotateHeadId);
+            body.varInt(entityId);
+            body.byte(headYaw);
+            emit(body, KIND_HEAD);
+            next.headYaw = headYaw;
+        }
+
+        if (frameEnds_.size() == packetMark) {
+            continue;
+        }
+        if (outputSize(frames_.size(), frameEnds_.size()) > maxBytes) {
+            // 放不下：撤销该实体的包，基准保持不变
+            frames_.resize(frameMark);
+            frameEnds_.resize(packetMark);
+            if (inserted) {
+                state.erase(it);
+            }
+            result.truncated = count - i;
+            break;
+        }
+        it->second = next;
+        ++result.entities;
+        for (size_t kind = 0; kind < KIND_COUNT; ++kind) {
+            kinds[kind] += entityKinds[kind];
+        }
+    }
+
+    const size_t start = out.size();
+    const size_t packets = frameEnds_.size();
+    if (bundling && packets >= 2) {
+        size_t frameBegin = 0;
+        for (size_t first = 0; first < packets; first += MAX_BUNDLE_PACKETS) {
+            const size_t last = std::min(first + MAX_BUNDLE_PACKETS, packets);
+            const size_t frameEnd = frameEnds_[last - 1];
+            out.insert(out.end(), delimiter_.begin(), delimiter_.end());
+            out.insert(out.end(), frames_.begin() + frameBegin, frames_.begin() + frameEnd);
+            out.insert(out.end(), delimiter_.begin(), delimiter_.end());
+            kinds[KIND_BUNDLE_DELIMITER] += 2;
+            frameBegin = frameEnd;
+        }
+    } else {
+        out.insert(out.end(), frames_.begin(), frames_.end());
+    }
+
+    result.bytes = out.size() - start;
+    result.packets = packets;
+    stats_.entities += result.entities;
+    stats_.bytes += result.bytes;
+    stats_.truncated += result.truncated;
+    for (size_t kind = 0; kind < KIND_COUNT; ++kind) {
+        stats_.packets[kind] += kinds[kind];
+    }
+    return result;
+}
+
+void EntityMoveEncoder::forget(int viewerId, const std::vector<int>& entityIds) {
+    auto it = viewers_.find(viewerId);
+    if (it == viewers_.end()) {
+        return;
+    }
+    for (int entityId : entityIds) {
+        it->second.erase(entityId);
+    }
+}
+
+size_t EntityMoveEncoder::memoryUsage() const {
+    // 每个节点：键 + 状态 + 链表指针与缓存的哈希值
+    constexpr size_t NODE_BYTES = sizeof(int) + sizeof(ClientState) + 2 * sizeof(void*);
+    size_t bytes = frames_.capacity() + frameEnds_.capacity() * sizeof(size_t) + region_.capacity();
+    for (const auto& [viewerId, state] : viewers_) {
+        bytes += sizeof(ViewerState) + state.size() * NODE_BYTES + state.bucket_count() * sizeof(void*);
+    }
+    return bytes;
+}
+
+} // namespace net
+} // namespace lattice
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace net {
+
+/**
+ * EntityMoveEncoder - 实体移动/旋转/转头数据包的批量编码
+ *
+ * 一个观察者本tick的所有位置更新编码进同一个缓冲区，每个包带外层VarInt长度前缀，
+ * 可以直接交给Netty写出；数据直接从SoA列（EntityStore的xs/ys/zs/yaws...）读取，不经过Java对象。
+ *
+ * 与原版VecDeltaCodec相同，位置按1/4096格的定点数做增量：每个观察者各自记录客户端已知的定点位置
+ * 与角度字节（LOD调度按观察者降频，不同观察者收到的历史不同），增量超出short范围或
+ * 客户端位置未知（首次更新）时改发绝对坐标的Teleport Entity。
+ * 实体离开视野后必须forget()，否则重新进入时会按旧基准发送相对移动。
+ *
+ * 包ID随协议版本变化，由Java按自己的注册表配置；Teleport Entity使用1.21.2之前的格式
+ * （VarInt id, double x/y/z, angle yaw/pitch, bool onGround）。
+ * 开启bundle时，一个观察者的2个以上数据包包在Bundle Delimiter之间，客户端在同一帧应用。
+ *
+ * compressionThreshold >= 0时每个包按连接已开启压缩的格式写出（PacketBatchCompressor::compressPacket：
+ * VarInt(未压缩长度) + zlib数据，或VarInt(0) + 原始数据）。
+ *
+ * 非线程安全，由所属追踪器的锁保护。
+ */
+class EntityMoveEncoder {
+public:
+    struct Config {
+        // 以下包ID必须配置（< 0时encode()不输出任何包）
+        int32_t moveEntityPosId = -1;
+        int32_t moveEntityPosRotId = -1;
+        int32_t moveEntityRotId = -1;
+        int32_t rotateHeadId = -1;
+        int32_t teleportEntityId = -1;
+        int32_t bundleDelimiterId = -1;     // < 0表示不使用bundle
+        int compressionLevel = 6;
+    };
+
+    // 每个实体本次发送的内容，数值与entity::EntityLOD相同
+    enum class Detail : uint8_t {
+        FULL = 0,               // 位置 + 旋转 + 转头
+        POSITION_ROTATION = 1,  // 位置 + 旋转
+        POSITION = 2            // 仅位置（Teleport仍携带当前旋转）
+    };
+
+    enum PacketKind : size_t {
+        KIND_MOVE = 0,
+        KIND_MOVE_ROTATE = 1,
+        KIND_ROTATE = 2,
+        KIND_HEAD = 3,
+        KIND_TELEPORT = 4,
+        KIND_BUNDLE_DELIMITER = 5,
+        KIND_COUNT = 6
+    };
+
+    // SoA列，下标为slot；全部必须非空
+    struct Columns {
+        const int* ids = nullptr;
+        const float* xs = nullptr;
+        const float* ys = nullptr;
+        const float* zs = nullptr;
+        const float* yaws = nullptr;        // 角度（度）
+        const float* pitches = nullptr;
+        const float* headYaws = nullptr;
+        const uint8_t* onGround = nullptr;
+    };
+
+    struct EncodeResult {
+        size_t bytes{0};            // 追加到out的字节数
+        size_t packets{0};          // 不含Bundle Delimiter
+        size_t entities{0};         // 写出了至少一个包的实体
+        size_t truncated{0};        // 超出maxBytes未编码的实体（基准不变，之后重新调度时补发）
+    };
+
+    struct Stats {
+        uint64_t encodes{0};
+        uint64_t entities{0};
+        uint64_t bytes{0};
+        uint64_t truncated{0};
+        std::array<uint64_t, KIND_COUNT> packets{};
+    };
+
+    EntityMoveEncoder() = default;
+    explicit EntityMoveEncoder(const Config& config) : config_(config) {}
+
+    void configure(const Config& config) { config_ = config; }
+    const Config& getConfig() const { return config_; }
+    bool isConfigured() const;
+
+    /**
+     * 编码一个观察者的更新：slots[i]为列中的下标，details为nullptr时全部按FULL处理
+     * 帧追加到out；输出超过maxBytes时剩余的实体不编码（计入truncated）
+     */
+    EncodeResult encode(int viewerId, const Columns& columns, const uint32_t* slots,
+                        const Detail* details, size_t count, int compressionThreshold,
+                        size_t maxBytes, std::vector<uint8_t>& out);
+
+    // 实体离开观察者视野（或重新生成）：丢弃客户端基准，下次更新发送Teleport
+    void forget(int viewerId, const std::vector<int>& entityIds);
+    void removeViewer(int viewerId) { viewers_.erase(viewerId); }
+    // 丢弃所有基准（安全：之后的更新都以Teleport开始）
+    void clear() { viewers_.clear(); }
+
+    size_t memoryUsage() const;
+    const Stats& getStats() const { return stats_; }
+
+    // 原版Mth.floor(degrees * 256 / 360)
+    static uint8_t angleByte(float degrees);
+    // 原版VecDeltaCodec：round(coordinate * 4096)
+    static int64_t fixedPoint(float coordinate);
+
+    // Bundle内数据包数量上限（原版BundlerInfo.BUNDLE_SIZE_LIMIT）
+    static constexpr size_t MAX_BUNDLE_PACKETS = 4096;
+
+private:
+    // 客户端已知的实体状态
+    struct ClientState {
+        int64_t x{0}, y{0}, z{0};
+        uint8_t yaw{0}, pitch{0}, headYaw{0};
+        bool onGround{false};
+    };
+
+    using ViewerState = std::unordered_map<int, ClientState>;
+
+    // 把body编码为一个完整的帧（外层长度 + 可选的压缩格式）追加到dst
+    void appendFrame(std::vector<uint8_t>& dst, const uint8_t* body, size_t length, int compressionThreshold);
+
+    Config config_;
+    std::unordered_map<int, ViewerState> viewers_;
+    Stats stats_;
+
+    // 复用的缓冲区
+    std::vector<uint8_t> frames_;
+    std::vector<size_t> frameEnds_;
+    std::vector<uint8_t> delimiter_;
+    std::vector<uint8_t> region_;
+};
+
+} // namespace net
+} // namespace lattice
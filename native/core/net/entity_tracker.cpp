@@ -1,4 +1,5 @@
 #include "entity_tracker.hpp"
+#include "async_compressor.hpp"
 #include <algorithm>
 #include <shared_mutex>
 #include <thread>
@@ -10,7 +11,6 @@ namespace entity {
 // ===== SpatialPartition 实现 =====
 
 SpatialPartition::SpatialPartition() {
-    queryCache_.reserve(MAX_QUERY_CACHE);
     // MemoryArena只有默认构造函数，需要其他地方初始化
 }
 
@@ -32,19 +32,47 @@ void SpatialPartition::registerEntity(int entityId, const Position& pos, float b
 
 void SpatialPartition::unregisterEntity(int entityId) {
     std::unique_lock lock(rwMutex_);
-    
+    unregisterEntityLocked(entityId);
+}
+
+bool SpatialPartition::unregisterEntityLocked(int entityId) {
     auto it = entities_.find(entityId);
-    if (it != entities_.end()) {
-        removeFromRegion(entityId, it->second.pos);
-        entities_.erase(it);
-    }
+    if (it == entities_.end()) return false;
+    
+    removeFromRegion(entityId, it->second.pos);
+    entities_.erase(it);
+    return true;
 }
 
 void SpatialPartition::updateEntityPosition(int entityId, const Position& newPos) {
     std::unique_lock lock(rwMutex_);
+    updateEntityPositionLocked(entityId, newPos);
+}
+
+size_t SpatialPartition::applyPackedUpdates(const PackedPositionUpdate* records, size_t count,
+                                            int32_t* results) {
+    std::unique_lock lock(rwMutex_);
     
+    size_t applied = 0;
+    for (size_t i = 0; i < count; i++) {
+        const PackedPositionUpdate& record = records[i];
+        PackedUpdateResult result;
+        if (record.flags & PACKED_FLAG_REMOVE) {
+            result = unregisterEntityLocked(record.entityId) ? PACKED_REMOVED : PACKED_UNKNOWN_ENTITY;
+        } else {
+            result = updateEntityPositionLocked(record.entityId, Position{record.x, record.y, record.z});
+        }
+        applied += result != PACKED_UNKNOWN_ENTITY;
+        if (results) {
+            results[i] = result;
+        }
+    }
+    return applied;
+}
+
+PackedUpdateResult SpatialPartition::updateEntityPositionLocked(int entityId, const Position& newPos) {
     auto it = entities_.find(entityId);
-    if (it == entities_.end()) return;
+    if (it == entities_.end()) return PACKED_UNKNOWN_ENTITY;
     
     Position oldPos = it->second.pos;
     it->second.pos = newPos;
@@ -57,7 +85,12 @@ void SpatialPartition::updateEntityPosition(int entityId, const Position& newPos
         oldPos.regionZ() != newPos.regionZ()) {
         removeFromRegion(entityId, oldPos);
         addToRegion(entityId, newPos);
+        return PACKED_REGION_CHANGED;
     }
+    // 区域内移动也可能跨过观察者的视距边界
+    trackedSets_.markCellChanged(regionKey(newPos));
+    ++mutationVersion_;
+    return PACKED_MOVED;
 }
 
 void SpatialPartition::addToRegion(int entityId, const Position& pos) {
@@ -66,6 +99,9 @@ void SpatialPartition::addToRegion(int entityId, const Position& pos) {
     int rz = pos.regionZ();
     
     regions_[rx][ry][rz].push_back(entityId);
+    trackedSets_.markCellChanged(regionKey(pos));
+    queryCache_.markCellChanged(regionKey(pos));
+    ++mutationVersion_;
 }
 
 void SpatialPartition::removeFromRegion(int entityId, const Position& pos) {
@@ -73,6 +109,10 @@ void SpatialPartition::removeFromRegion(int entityId, const Position& pos) {
     int ry = pos.regionY();
     int rz = pos.regionZ();
     
+    trackedSets_.markCellChanged(regionKey(pos));
+    queryCache_.markCellChanged(regionKey(pos));
+    ++mutationVersion_;
+    
     auto rxIt = regions_.find(rx);
     if (rxIt == regions_.end()) return;
     
@@ -103,97 +143,164 @@ std::vector<int> SpatialPartition::getVisibleEntities(const Position& viewerPos,
     std::shared_lock lock(rwMutex_);
     stats_.totalQueries.fetch_add(1, std::memory_order_relaxed);
     
-    // 1. 检查缓存
-    for (const auto& cache : queryCache_) {
-        if (cache.lastTick == currentTick_ && 
-            cache.viewerPos == viewerPos &&
-            std::abs(cache.viewDistance - viewDistance) < 0.1f) {
-            stats_.cacheHits.fetch_add(1, std::memory_order_relaxed);
-            return cache.result;
-        }
-    }
+    std::vector<int> candidates = collectVisibleLocked(viewerPos, viewDistance, nullptr);
     
-    // 2. 计算区域查询范围
+    // 更新性能统计
+    auto endTime = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+    
+    // 原子更新平均时间
+    uint64_t oldTotal = stats_.averageQueryTimeNs.load(std::memory_order_relaxed);
+    uint64_t newCount = stats_.totalQueries.load(std::memory_order_relaxed);
+    uint64_t newTotal = oldTotal + duration.count();
+    
+    stats_.averageQueryTimeNs.store(newTotal / newCount, std::memory_order_relaxed);
+    
+    return candidates;
+}
+
+std::vector<int> SpatialPartition::collectVisibleLocked(const Position& viewerPos, float viewDistance,
+                                                       std::vector<ViewerTrackedSets::CellKey>* cells) {
+    // 计算区域查询范围
     auto [minX, maxX] = getRegionRange(viewerPos.x, viewDistance);
     auto [minY, maxY] = getRegionRange(viewerPos.y, viewDistance);
     auto [minZ, maxZ] = getRegionRange(viewerPos.z, viewDistance);
     
-    // 3. 收集候选实体
-    std::vector<int> candidates;
-    candidates.reserve(200); // 预分配避免动态扩容
-    
     float viewDistanceSq = viewDistance * viewDistance;
     
-    for (int rx = minX; rx <= maxX; rx++) {
+    // 记录覆盖的全部区域（包括当前为空的，实体进入空区域也要触发重算）
+    if (cells) {
+        cells->reserve(static_cast<size_t>(maxX - minX + 1) * (maxY - minY + 1) * (maxZ - minZ + 1));
+        for (int rx = minX; rx <= maxX; rx++) {
+            for (int ry = minY; ry <= maxY; ry++) {
+                for (int rz = minZ; rz <= maxZ; rz++) {
+                    cells->push_back(ViewerTrackedSets::makeKey(rx, ry, rz));
+                }
+            }
+        }
+    }
+    
+    // 候选集按观察者所在区域缓存：观察者在区域内移动或不动时只需做精确距离检查
+    const int reach = CellQueryCache::reachCells(viewDistance, REGION_SIZE);
+    const int regionX = viewerPos.regionX();
+    const int regionY = viewerPos.regionY();
+    const int regionZ = viewerPos.regionZ();
+    const uint32_t tick = static_cast<uint32_t>(currentTick_);
+    
+    std::lock_guard<std::mutex> cacheLock(cacheMutex_);
+    const std::vector<int>* members = queryCache_.find(regionX, regionY, regionZ, reach, reach, tick);
+    if (members) {
+        stats_.cacheHits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        members = &queryCache_.store(regionX, regionY, regionZ, reach, reach, tick,
+                                     gatherRegionMembersLocked(regionX, regionY, regionZ, reach));
+    }
+    
+    std::vector<int> candidates;
+    candidates.reserve(members->size());
+    for (int entityId : *members) {
+        auto it = entities_.find(entityId);
+        if (it != entities_.end()) {
+            // 精确距离检查（使用平方距离避免sqrt开销）
+            float distSq = distanceSquared(viewerPos, it->second.pos);
+            if (distSq <= viewDistanceSq) {
+                candidates.push_back(entityId);
+            }
+        }
+    }
+    
+    return candidates;
+}
+
+std::vector<int> SpatialPartition::gatherRegionMembersLocked(int regionX, int regionY, int regionZ,
+                                                             int reach) const {
+    std::vector<int> members;
+    for (int rx = regionX - reach; rx <= regionX + reach; rx++) {
         auto rxIt = regions_.find(rx);
         if (rxIt == regions_.end()) continue;
         
         stats_.regionsChecked.fetch_add(1, std::memory_order_relaxed);
         
-        for (int ry = minY; ry <= maxY; ry++) {
+        for (int ry = regionY - reach; ry <= regionY + reach; ry++) {
             auto ryIt = rxIt->second.find(ry);
             if (ryIt == rxIt->second.end()) continue;
             
-            for (int rz = minZ; rz <= maxZ; rz++) {
+            for (int rz = regionZ - reach; rz <= regionZ + reach; rz++) {
                 auto rzIt = ryIt->second.find(rz);
-                if (rzIt == ryIt->second.end()) continue;
-                
-                // 检查该区域中的所有实体
-                for (int entityId : rzIt->second) {
-                    auto it = entities_.find(entityId);
-                    if (it != entities_.end()) {
-                        // 精确距离检查（使用平方距离避免sqrt开销）
-                        float distSq = distanceSquared(viewerPos, it->second.pos);
-                        if (distSq <= viewDistanceSq) {
-                            candidates.push_back(entityId);
-                        }
-                    }
+                if (rzIt != ryIt->second.end()) {
+                    members.insert(members.end(), rzIt->second.begin(), rzIt->second.end());
                 }
             }
         }
     }
+    return members;
+}
+
+VisibilityDelta SpatialPartition::updateViewerVisibility(int viewerId, const Position& viewerPos,
+                                                         float viewDistance) {
+    std::unique_lock lock(rwMutex_);
     
-    // 4. 更新缓存
-    lock.unlock(); // 释放读锁，获取写锁
-    std::unique_lock writeLock(rwMutex_);
-    
-    if (queryCache_.size() < MAX_QUERY_CACHE) {
-        queryCache_.push_back({
-            viewerPos, 
-            viewDistance, 
-            candidates, 
-            currentTick_,
-            std::chrono::steady_clock::now()
-        });
-    } else {
-        // 循环缓冲区策略
-        size_t index = currentTick_ % MAX_QUERY_CACHE;
-        if (index < queryCache_.size()) {
-            queryCache_[index] = {
-                viewerPos, 
-                viewDistance, 
-                candidates, 
-                currentTick_,
-                std::chrono::steady_clock::now()
-            };
-        }
+    if (!trackedSets_.needsUpdate(viewerId, viewerPos.x, viewerPos.y, viewerPos.z, viewDistance)) {
+        return trackedSets_.skip();
     }
     
-    // 更新性能统计
-    auto endTime = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+    stats_.totalQueries.fetch_add(1, std::memory_order_relaxed);
+    std::vector<ViewerTrackedSets::CellKey> cells;
+    std::vector<int> visible = collectVisibleLocked(viewerPos, viewDistance, &cells);
+    // 观察者自己不在自己的追踪集合中
+    visible.erase(std::remove(visible.begin(), visible.end(), viewerId), visible.end());
     
-    // 原子更新平均时间
-    uint64_t oldTotal = stats_.averageQueryTimeNs.load(std::memory_order_relaxed);
-    uint64_t newCount = stats_.totalQueries.load(std::memory_order_relaxed);
-    uint64_t newTotal = oldTotal + duration.count();
+    return trackedSets_.commit(viewerId, viewerPos.x, viewerPos.y, viewerPos.z, viewDistance,
+                               std::move(cells), std::move(visible));
+}
+
+std::vector<int> SpatialPartition::removeViewer(int viewerId) {
+    std::unique_lock lock(rwMutex_);
+    return trackedSets_.removeViewer(viewerId);
+}
+
+std::shared_ptr<const SpatialSnapshot> SpatialPartition::acquireSnapshot() {
+    // 构建者之间串行，避免同一版本被多个线程重复构建
+    std::lock_guard<std::mutex> snapshotLock(snapshotMutex_);
+    std::shared_lock lock(rwMutex_);
     
-    stats_.averageQueryTimeNs.store(newTotal / newCount, std::memory_order_relaxed);
+    if (snapshot_ && snapshot_->version_ == mutationVersion_) {
+        return snapshot_;
+    }
     
-    return candidates;
+    auto snapshot = std::make_shared<SpatialSnapshot>();
+    snapshot->version_ = mutationVersion_;
+    snapshot->ids_.reserve(entities_.size());
+    snapshot->x_.reserve(entities_.size());
+    snapshot->y_.reserve(entities_.size());
+    snapshot->z_.reserve(entities_.size());
+    
+    for (const auto& [rx, yMap] : regions_) {
+        for (const auto& [ry, zMap] : yMap) {
+            for (const auto& [rz, entityList] : zMap) {
+                const uint32_t begin = static_cast<uint32_t>(snapshot->ids_.size());
+                for (int entityId : entityList) {
+                    auto it = entities_.find(entityId);
+                    if (it == entities_.end()) continue;
+                    snapshot->ids_.push_back(entityId);
+                    snapshot->x_.push_back(it->second.pos.x);
+                    snapshot->y_.push_back(it->second.pos.y);
+                    snapshot->z_.push_back(it->second.pos.z);
+                }
+                const uint32_t end = static_cast<uint32_t>(snapshot->ids_.size());
+                if (end > begin) {
+                    snapshot->regions_.emplace(ViewerTrackedSets::makeKey(rx, ry, rz),
+                                               SpatialSnapshot::Range{begin, end});
+                }
+            }
+        }
+    }
+    
+    snapshot_ = std::move(snapshot);
+    return snapshot_;
 }
 
-std::pair<int, int> SpatialPartition::getRegionRange(float position, float distance) const {
+std::pair<int, int> SpatialPartition::getRegionRange(float position, float distance) {
     int centerRegion = static_cast<int>(std::floor(position / REGION_SIZE));
     int range = static_cast<int>(std::ceil(distance / REGION_SIZE)) + 1;
     
@@ -207,6 +314,7 @@ void SpatialPartition::tick() {
     // 每100 ticks清理一次缓存
     if (currentTick_ % TICK_CACHE_CLEANUP == 0) {
         cleanupCache();
+        trackedSets_.pruneCellVersions();
     }
     
     // 清理长时间未更新的实体
@@ -216,16 +324,8 @@ void SpatialPartition::tick() {
 }
 
 void SpatialPartition::cleanupCache() {
-    auto now = std::chrono::steady_clock::now();
-    constexpr auto CACHE_TTL = std::chrono::seconds(5); // 5秒TTL
-    
-    queryCache_.erase(
-        std::remove_if(queryCache_.begin(), queryCache_.end(),
-            [&](const QueryCache& cache) {
-                return (now - cache.createTime) > CACHE_TTL;
-            }),
-        queryCache_.end()
-    );
+    std::lock_guard<std::mutex> cacheLock(cacheMutex_);
+    queryCache_.prune(static_cast<uint32_t>(currentTick_));
 }
 
 void SpatialPartition::cleanupOldEntities() {
@@ -258,6 +358,37 @@ void SpatialPartition::resetStats() {
     stats_.averageQueryTimeNs = 0;
 }
 
+// ===== SpatialSnapshot 实现 =====
+
+void SpatialSnapshot::query(const Position& viewerPos, float viewDistance, std::vector<int>& out) const {
+    out.clear();
+    if (ids_.empty()) return;
+    
+    auto [minX, maxX] = SpatialPartition::getRegionRange(viewerPos.x, viewDistance);
+    auto [minY, maxY] = SpatialPartition::getRegionRange(viewerPos.y, viewDistance);
+    auto [minZ, maxZ] = SpatialPartition::getRegionRange(viewerPos.z, viewDistance);
+    const float viewDistanceSq = viewDistance * viewDistance;
+    
+    for (int rx = minX; rx <= maxX; rx++) {
+        for (int ry = minY; ry <= maxY; ry++) {
+            for (int rz = minZ; rz <= maxZ; rz++) {
+                auto it = regions_.find(ViewerTrackedSets::makeKey(rx, ry, rz));
+                if (it == regions_.end()) continue;
+                
+                // 区域内的位置连续存放，内层循环可以向量化
+                for (uint32_t i = it->second.begin; i < it->second.end; i++) {
+                    const float dx = x_[i] - viewerPos.x;
+                    const float dy = y_[i] - viewerPos.y;
+                    const float dz = z_[i] - viewerPos.z;
+                    if (dx * dx + dy * dy + dz * dz <= viewDistanceSq) {
+                        out.push_back(ids_[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+
 // ===== EntityTracker 实现 =====
 
 EntityTracker::EntityTracker() = default;
@@ -313,6 +444,20 @@ std::vector<int> EntityTracker::getVisibleEntitiesForViewer(float viewerX, float
     return spatialPartition_->getVisibleEntities(viewerPos, maxDistance);
 }
 
+VisibilityDelta EntityTracker::updateViewer(int viewerId, float viewerX, float viewerY, float viewerZ,
+                                            float maxDistance) {
+    if (!initialized_) return {};
+    
+    Position viewerPos{viewerX, viewerY, viewerZ};
+    return spatialPartition_->updateViewerVisibility(viewerId, viewerPos, maxDistance);
+}
+
+std::vector<int> EntityTracker::removeViewer(int viewerId) {
+    if (!initialized_) return {};
+    
+    return spatialPartition_->removeViewer(viewerId);
+}
+
 void EntityTracker::batchUpdatePositions(const std::vector<std::tuple<int, float, float, float>>& updates) {
     if (!initialized_) return;
     
@@ -322,6 +467,12 @@ void EntityTracker::batchUpdatePositions(const std::vector<std::tuple<int, float
     }
 }
 
+size_t EntityTracker::applyPackedUpdates(const PackedPositionUpdate* records, size_t count, int32_t* results) {
+    if (!initialized_) return 0;
+    
+    return spatialPartition_->applyPackedUpdates(records, count, results);
+}
+
 std::vector<std::vector<int>> EntityTracker::batchGetVisibleEntities(
     const std::vector<std::tuple<float, float, float, float>>& viewers) {
     std::vector<std::vector<int>> results;
@@ -336,6 +487,28 @@ std::vector<std::vector<int>> EntityTracker::batchGetVisibleEntities(
     return results;
 }
 
+std::vector<std::vector<int>> EntityTracker::parallelGetVisibleEntities(
+    const std::vector<std::tuple<float, float, float, float>>& viewers) {
+    std::vector<std::vector<int>> results(viewers.size());
+    if (!initialized_ || viewers.empty()) return results;
+    
+    std::shared_ptr<const SpatialSnapshot> snapshot = spatialPartition_->acquireSnapshot();
+    auto queryViewer = [&](size_t index) {
+        const auto& [x, y, z, distance] = viewers[index];
+        snapshot->query(Position{x, y, z}, distance, results[index]);
+    };
+    
+    if (viewers.size() < PARALLEL_MIN_VIEWERS) {
+        for (size_t i = 0; i < viewers.size(); i++) {
+            queryViewer(i);
+        }
+    } else {
+        net::AsyncCompressor::getInstance().parallelFor(viewers.size(), queryViewer);
+    }
+    
+    return results;
+}
+
 void EntityTracker::tick() {
     if (!initialized_) return;
     
@@ -389,6 +562,14 @@ void JNIEntityTracker::updateEntityPosition(int entityId, float x, float y, floa
     }
 }
 
+size_t JNIEntityTracker::applyPackedUpdates(const PackedPositionUpdate* records, size_t count,
+                                            int32_t* results) {
+    if (!instance) {
+        return 0;
+    }
+    return instance->applyPackedUpdates(records, count, results);
+}
+
 int* JNIEntityTracker::getVisibleEntities(float viewerX, float viewerY, float viewerZ, 
                                          float viewDistance, int* outCount) {
     if (!instance) {
@@ -410,6 +591,14 @@ int* JNIEntityTracker::getVisibleEntities(float viewerX, float viewerY, float vi
     return result;
 }
 
+std::vector<std::vector<int>> JNIEntityTracker::batchGetVisibleEntities(
+    const std::vector<std::tuple<float, float, float, float>>& viewers) {
+    if (!instance) {
+        return std::vector<std::vector<int>>(viewers.size());
+    }
+    return instance->parallelGetVisibleEntities(viewers);
+}
+
 void JNIEntityTracker::tick() {
     if (instance) {
         instance->tick();
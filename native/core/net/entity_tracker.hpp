@@ -7,8 +7,13 @@
 #include <atomic>
 #include <chrono>
 #include <optional>
+#include <mutex>
 #include <shared_mutex>
+#include <tuple>
+#include <cstdint>
 #include "memory_arena.hpp"
+#include "query_cell_cache.hpp"
+#include "visibility_delta.hpp"
 
 namespace lattice {
 namespace entity {
@@ -16,10 +21,30 @@ namespace entity {
 // 常量定义
 constexpr int REGION_SIZE = 32;
 constexpr float VIEW_DISTANCE = 64.0f;
-constexpr size_t MAX_QUERY_CACHE = 32;
 constexpr int TICK_CACHE_CLEANUP = 100;
 constexpr int ENTITY_CLEANUP_TICKS = 6000; // 5分钟
 
+/**
+ * 批量位置更新的紧凑记录，与Java侧DirectByteBuffer的布局一致（本机字节序，4字节对齐）
+ * 由JNI层直接在缓冲区上原地读取，不逐个转换
+ */
+struct PackedPositionUpdate {
+    int32_t entityId;
+    float x, y, z;
+    uint32_t flags;                    // PACKED_FLAG_*，其余位保留
+};
+static_assert(sizeof(PackedPositionUpdate) == 20, "PackedPositionUpdate must match the Java record layout");
+
+constexpr uint32_t PACKED_FLAG_REMOVE = 1u << 0;    // 注销实体，忽略坐标
+
+// 每条记录的处理结果（写入输出缓冲区）
+enum PackedUpdateResult : int32_t {
+    PACKED_UNKNOWN_ENTITY = -1,        // 实体未注册
+    PACKED_MOVED = 0,                  // 区域内移动
+    PACKED_REGION_CHANGED = 1,         // 跨区域移动
+    PACKED_REMOVED = 2
+};
+
 // 3D位置结构
 struct Position {
     float x, y, z;
@@ -72,17 +97,47 @@ struct EntityData {
     }
 };
 
-// 查询缓存
-struct QueryCache {
-    Position viewerPos;
-    float viewDistance;
-    std::vector<int> result;
-    int lastTick;
-    std::chrono::steady_clock::time_point createTime;
+/**
+ * SpatialSnapshot - 空间索引的只读快照
+ *
+ * 实体按所在区域连续存放（位置为SoA数组），区域表只记录每个区域的下标范围。
+ * 构建后不再修改，任意数量的线程可以同时查询而不需要加锁；
+ * 快照之后的注册、移动与删除对它不可见，由SpatialPartition在下次获取时重建。
+ */
+class SpatialSnapshot {
+public:
+    // 与SpatialPartition::getVisibleEntities相同的结果（顺序可能不同）
+    void query(const Position& viewerPos, float viewDistance, std::vector<int>& out) const;
+    std::vector<int> query(const Position& viewerPos, float viewDistance) const {
+        std::vector<int> out;
+        query(viewerPos, viewDistance, out);
+        return out;
+    }
+    
+    size_t entityCount() const { return ids_.size(); }
+    size_t regionCount() const { return regions_.size(); }
+    uint64_t version() const { return version_; }
+
+private:
+    friend class SpatialPartition;
+    
+    struct Range {
+        uint32_t begin;
+        uint32_t end;
+    };
+    
+    std::unordered_map<ViewerTrackedSets::CellKey, Range> regions_;
+    std::vector<int> ids_;
+    std::vector<float> x_;
+    std::vector<float> y_;
+    std::vector<float> z_;
+    uint64_t version_ = 0;
 };
 
 // 空间分区类 - 核心实现
 class SpatialPartition {
+    friend class SpatialSnapshot;
+    
 public:
     SpatialPartition();
     ~SpatialPartition();
@@ -92,9 +147,29 @@ public:
     void unregisterEntity(int entityId);
     void updateEntityPosition(int entityId, const Position& newPos);
     
+    /**
+     * 在一次写锁内处理count条紧凑记录，results非空时逐条写入PackedUpdateResult
+     * 返回成功处理（移动或注销）的记录数
+     */
+    size_t applyPackedUpdates(const PackedPositionUpdate* records, size_t count, int32_t* results);
+    
     // 可见性查询
     std::vector<int> getVisibleEntities(const Position& viewerPos, float viewDistance = VIEW_DISTANCE);
     
+    /**
+     * 观察者可见集增量：返回自上次调用以来进入/离开视野的实体
+     * 观察者移动不足1格且覆盖的区域没有实体变化时直接返回空增量，不做查询
+     */
+    VisibilityDelta updateViewerVisibility(int viewerId, const Position& viewerPos,
+                                           float viewDistance = VIEW_DISTANCE);
+    std::vector<int> removeViewer(int viewerId);
+    
+    /**
+     * 获取当前索引的只读快照；自上次构建以来没有修改时直接返回同一个快照，
+     * 因此每tick先更新位置、再并行查询时，每tick只构建一次
+     */
+    std::shared_ptr<const SpatialSnapshot> acquireSnapshot();
+    
     // 批量更新（每tick调用一次）
     void tick();
     
@@ -119,7 +194,18 @@ public:
     // 调试信息
     size_t getEntityCount() const { return entities_.size(); }
     size_t getActiveRegionCount() const;
-    size_t getCacheSize() const { return queryCache_.size(); }
+    size_t getCacheSize() const {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        return queryCache_.size();
+    }
+    CellQueryCache::Stats getQueryCacheStats() const {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        return queryCache_.getStats();
+    }
+    ViewerTrackedSets::Stats getVisibilityStats() const {
+        std::shared_lock lock(rwMutex_);
+        return trackedSets_.getStats();
+    }
 
 private:
     // 3D网格分区存储：regions_[regionX][regionY][regionZ] = vector<entityId>
@@ -128,8 +214,18 @@ private:
     // 实体数据映射：entityId -> EntityData
     std::unordered_map<int, EntityData> entities_;
     
-    // 查询结果缓存
-    std::vector<QueryCache> queryCache_;
+    // 按观察者所在区域缓存的候选集，只在实体跨区域时失效
+    // 查询持有rwMutex_读锁，查询之间由cacheMutex_串行访问缓存
+    CellQueryCache queryCache_;
+    mutable std::mutex cacheMutex_;
+    
+    // 每个观察者已追踪的实体集合
+    ViewerTrackedSets trackedSets_;
+    
+    // 只读快照；mutationVersion_在每次修改索引时递增
+    std::shared_ptr<const SpatialSnapshot> snapshot_;
+    std::mutex snapshotMutex_;
+    uint64_t mutationVersion_ = 0;
     
     // 内存池（使用Arena Allocator）
     std::unique_ptr<net::MemoryArena> memoryPool_;
@@ -144,10 +240,18 @@ private:
     // 线程安全控制
     mutable std::shared_mutex rwMutex_;
     
-    // 辅助方法
+    // 辅助方法（需持有rwMutex_写锁）
+    PackedUpdateResult updateEntityPositionLocked(int entityId, const Position& newPos);
+    bool unregisterEntityLocked(int entityId);
     void addToRegion(int entityId, const Position& pos);
     void removeFromRegion(int entityId, const Position& pos);
-    std::pair<int, int> getRegionRange(float position, float distance) const;
+    static std::pair<int, int> getRegionRange(float position, float distance);
+    std::vector<int> collectVisibleLocked(const Position& viewerPos, float viewDistance,
+                                          std::vector<ViewerTrackedSets::CellKey>* cells);
+    std::vector<int> gatherRegionMembersLocked(int regionX, int regionY, int regionZ, int reach) const;
+    static ViewerTrackedSets::CellKey regionKey(const Position& pos) {
+        return ViewerTrackedSets::makeKey(pos.regionX(), pos.regionY(), pos.regionZ());
+    }
     
     // 缓存管理
     void cleanupCache();
@@ -160,27 +264,6 @@ private:
         float dz = a.z - b.z;
         return dx*dx + dy*dy + dz*dz;
     }
-    
-    // 缓存键生成
-    struct CacheKey {
-        Position viewerPos;
-        float viewDistance;
-        
-        bool operator==(const CacheKey& other) const {
-            return viewerPos == other.viewerPos && 
-                   std::abs(viewDistance - other.viewDistance) < 0.1f;
-        }
-    };
-    
-    struct CacheKeyHash {
-        size_t operator()(const CacheKey& key) const noexcept {
-            size_t h1 = std::hash<float>{}(key.viewerPos.x);
-            size_t h2 = std::hash<float>{}(key.viewerPos.y);
-            size_t h3 = std::hash<float>{}(key.viewerPos.z);
-            size_t h4 = std::hash<float>{}(key.viewDistance);
-            return ((h1 * 31 + h2) * 31 + h3) * 31 + h4;
-        }
-    };
 };
 
 // 实体追踪器主类 - 提供高级接口
@@ -202,11 +285,27 @@ public:
     std::vector<int> getVisibleEntitiesForViewer(float viewerX, float viewerY, float viewerZ, 
                                                    float maxDistance = VIEW_DISTANCE);
     
+    // 可见性增量（见SpatialPartition::updateViewerVisibility）
+    VisibilityDelta updateViewer(int viewerId, float viewerX, float viewerY, float viewerZ,
+                                 float maxDistance = VIEW_DISTANCE);
+    std::vector<int> removeViewer(int viewerId);
+    
     // 批量操作
     void batchUpdatePositions(const std::vector<std::tuple<int, float, float, float>>& updates);
+    size_t applyPackedUpdates(const PackedPositionUpdate* records, size_t count, int32_t* results);
     std::vector<std::vector<int>> batchGetVisibleEntities(
         const std::vector<std::tuple<float, float, float, float>>& viewers);
     
+    /**
+     * 每tick的并行可见性查询：在空间索引的只读快照上，把观察者分给AsyncCompressor的
+     * 工作窃取线程池（调用线程也参与），查询过程不获取SpatialPartition的锁
+     * 观察者少于PARALLEL_MIN_VIEWERS时在调用线程上顺序执行
+     */
+    std::vector<std::vector<int>> parallelGetVisibleEntities(
+        const std::vector<std::tuple<float, float, float, float>>& viewers);
+    
+    static constexpr size_t PARALLEL_MIN_VIEWERS = 8;
+    
     // 生命周期管理
     void tick();
     
@@ -232,8 +331,12 @@ extern "C" {
         static void shutdown();
         static void registerEntity(int entityId, float x, float y, float z, float radius);
         static void updateEntityPosition(int entityId, float x, float y, float z);
+        // 实例未初始化时返回0且不写results
+        static size_t applyPackedUpdates(const PackedPositionUpdate* records, size_t count, int32_t* results);
         static int* getVisibleEntities(float viewerX, float viewerY, float viewerZ, 
                                       float viewDistance, int* outCount);
+        static std::vector<std::vector<int>> batchGetVisibleEntities(
+            const std::vector<std::tuple<float, float, float, float>>& viewers);
         static void tick();
     };
 }
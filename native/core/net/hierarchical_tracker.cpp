@@ -1,9 +1,10 @@
 #include "hierarchical_tracker.hpp"
+#include "../native_runtime.hpp"
+#include "../simd_dispatch.hpp"
 #include <algorithm>
 #include <shared_mutex>
 #include <thread>
 #include <iostream>
-#include <emmintrin.h> // SSE2
 #include <cstring>
 
 using lattice::net::MemoryArena;
@@ -11,6 +12,14 @@ using lattice::net::MemoryArena;
 namespace lattice {
 namespace entity {
 
+namespace {
+
+// 每个实体的估算占用：SoA各列、id到slot的映射节点与空间索引中的成员记录
+constexpr size_t ENTITY_MEMORY_ESTIMATE = 96;
+constexpr size_t PREDICTOR_MEMORY_ESTIMATE = sizeof(PlayerPredictor) + 32;
+
+} // namespace
+
 // 距离平方计算辅助函数
 inline float distanceSquared(const Position& a, const Position& b) {
     float dx = a.x - b.x;
@@ -118,30 +127,153 @@ void QuadTree::queryRecursive(const QuadTree::QuadNode* node, const Position& ce
     }
 }
 
+// ===== EntityStore 实现 =====
+
+uint32_t EntityStore::insert(int id, const Position& pos, float radius, EntityType type,
+                             EntityPriority priority, EntityLOD lod, uint32_t tick) {
+    auto [it, inserted] = slots_.try_emplace(id, static_cast<uint32_t>(ids_.size()));
+    const uint32_t slot = it->second;
+    if (inserted) {
+        ids_.push_back(id);
+        x_.push_back(pos.x);
+        y_.push_back(pos.y);
+        z_.push_back(pos.z);
+        radius_.push_back(radius);
+        type_.push_back(type);
+        priority_.push_back(priority);
+        lod_.push_back(lod);
+        lastUpdateTick_.push_back(tick);
+        accessCount_.push_back(0);
+        yaw_.push_back(0.0f);
+        pitch_.push_back(0.0f);
+        headYaw_.push_back(0.0f);
+        onGround_.push_back(0);
+        return slot;
+    }
+    
+    x_[slot] = pos.x;
+    y_[slot] = pos.y;
+    z_[slot] = pos.z;
+    radius_[slot] = radius;
+    type_[slot] = type;
+    priority_[slot] = priority;
+    lod_[slot] = lod;
+    lastUpdateTick_[slot] = tick;
+    accessCount_[slot] = 0;
+    return slot;
+}
+
+bool EntityStore::remove(int id) {
+    auto it = slots_.find(id);
+    if (it == slots_.end()) {
+        return false;
+    }
+    const uint32_t slot = it->second;
+    const uint32_t last = static_cast<uint32_t>(ids_.size() - 1);
+    slots_.erase(it);
+    
+    if (slot != last) {
+        // 把最后一个实体移到空出的slot
+        ids_[slot] = ids_[last];
+        x_[slot] = x_[last];
+        y_[slot] = y_[last];
+        z_[slot] = z_[last];
+        radius_[slot] = radius_[last];
+        type_[slot] = type_[last];
+        priority_[slot] = priority_[last];
+        lod_[slot] = lod_[last];
+        lastUpdateTick_[slot] = lastUpdateTick_[last];
+        accessCount_[slot] = accessCount_[last];
+        yaw_[slot] = yaw_[last];
+        pitch_[slot] = pitch_[last];
+        headYaw_[slot] = headYaw_[last];
+        onGround_[slot] = onGround_[last];
+        slots_[ids_[slot]] = slot;
+    }
+    
+    ids_.pop_back();
+    x_.pop_back();
+    y_.pop_back();
+    z_.pop_back();
+    radius_.pop_back();
+    type_.pop_back();
+    priority_.pop_back();
+    lod_.pop_back();
+    lastUpdateTick_.pop_back();
+    accessCount_.pop_back();
+    yaw_.pop_back();
+    pitch_.pop_back();
+    headYaw_.pop_back();
+    onGround_.pop_back();
+    return true;
+}
+
+void EntityStore::clear() {
+    ids_.clear();
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    radius_.clear();
+    type_.clear();
+    priority_.clear();
+    lod_.clear();
+    lastUpdateTick_.clear();
+    accessCount_.clear();
+    yaw_.clear();
+    pitch_.clear();
+    headYaw_.clear();
+    onGround_.clear();
+    slots_.clear();
+}
+
+void EntityStore::reserve(size_t count) {
+    ids_.reserve(count);
+    x_.reserve(count);
+    y_.reserve(count);
+    z_.reserve(count);
+    radius_.reserve(count);
+    type_.reserve(count);
+    priority_.reserve(count);
+    lod_.reserve(count);
+    lastUpdateTick_.reserve(count);
+    accessCount_.reserve(count);
+    yaw_.reserve(count);
+    pitch_.reserve(count);
+    headYaw_.reserve(count);
+    onGround_.reserve(count);
+    slots_.reserve(count);
+}
+
+EnhancedEntity EntityStore::view(uint32_t slot) const {
+    EnhancedEntity entity{};
+    entity.id = ids_[slot];
+    entity.pos = position(slot);
+    entity.radius = radius_[slot];
+    entity.type = type_[slot];
+    entity.priority = priority_[slot];
+    entity.lod = lod_[slot];
+    entity.lastUpdateTick = lastUpdateTick_[slot];
+    entity.accessCount = accessCount_[slot];
+    return entity;
+}
+
 // ===== SIMD距离计算器实现 =====
+// 距离内核按CPU在运行时选择（AVX-512 / AVX2 / SSE4 / NEON / 标量），见core/simd_dispatch.cpp
 
-bool SIMDDistanceCalculator::avx2Supported_ = false;
-
-bool SIMDDistanceCalculator::checkAVX2Support() {
-#if defined(__AVX2__) && defined(__x86_64__)
-    unsigned int eax, ebx, ecx, edx;
-    // 使用内联汇编或者编译器特定的CPUID函数
-    asm volatile ("cpuid"
-                  : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
-                  : "a" (1), "c" (0));
-    return (ecx & (1 << 28)) != 0;
-#else
-    return false;
-#endif
+namespace {
+
+// 先按最多count个结果扩容，内核写完后截断到实际写出的数量
+template <typename Kernel>
+void appendFiltered(std::vector<int>& result, size_t count, Kernel&& kernel) {
+    const size_t base = result.size();
+    result.resize(base + count);
+    result.resize(base + kernel(result.data() + base));
 }
 
+} // namespace
+
 bool SIMDDistanceCalculator::isAVX2Supported() {
-    static bool initialized = false;
-    if (!initialized) {
-        avx2Supported_ = checkAVX2Support();
-        initialized = true;
-    }
-    return avx2Supported_;
+    return core::simdKernels().level >= core::SimdLevel::AVX2;
 }
 
 void SIMDDistanceCalculator::calculateDistancesAVX2(
@@ -151,53 +283,24 @@ void SIMDDistanceCalculator::calculateDistancesAVX2(
     float maxDistSq,
     std::vector<int>& result) {
     
-    if (!isAVX2Supported() || entities.size() < SIMD_BATCH_SIZE) {
+    if (entities.size() < SIMD_BATCH_SIZE) {
         calculateDistancesScalar(entities, viewerPos, maxDistSq, result);
         return;
     }
     
-    // 准备SIMD寄存器
-    __m256 viewerXVec = _mm256_set1_ps(viewerPos.x);
-    __m256 viewerZVec = _mm256_set1_ps(viewerPos.z);
-    __m256 maxDistSqVec = _mm256_set1_ps(maxDistSq);
-    
-    size_t i = 0;
-    for (; i + SIMD_BATCH_SIZE <= entities.size(); i += SIMD_BATCH_SIZE) {
-        // 批量加载8个实体的位置
-        __m256 entityX[SIMD_BATCH_SIZE];
-        __m256 entityZ[SIMD_BATCH_SIZE];
-        
-        for (int j = 0; j < SIMD_BATCH_SIZE; j++) {
-            entityX[j] = _mm256_set1_ps(entities[i + j]->pos.x);
-            entityZ[j] = _mm256_set1_ps(entities[i + j]->pos.z);
-        }
-        
-        // 计算距离平方
-        __m256 dx[SIMD_BATCH_SIZE], dz[SIMD_BATCH_SIZE], distSq[SIMD_BATCH_SIZE];
-        for (int j = 0; j < SIMD_BATCH_SIZE; j++) {
-            dx[j] = _mm256_sub_ps(entityX[j], viewerXVec);
-            dz[j] = _mm256_sub_ps(entityZ[j], viewerZVec);
-            distSq[j] = _mm256_add_ps(_mm256_mul_ps(dx[j], dx[j]), 
-                                    _mm256_mul_ps(dz[j], dz[j]));
-        }
-        
-        // 批量比较和收集结果
-        for (int j = 0; j < SIMD_BATCH_SIZE; j++) {
-            __m256 mask = _mm256_cmp_ps(distSq[j], maxDistSqVec, _CMP_LE_OQ);
-            if (_mm256_movemask_ps(mask)) {
-                result.push_back(entities[i + j]->id);
-            }
-        }
-    }
-    
-    // 处理剩余实体
-    for (; i < entities.size(); i++) {
-        float dx = entities[i]->pos.x - viewerPos.x;
-        float dz = entities[i]->pos.z - viewerPos.z;
-        if (dx*dx + dz*dz <= maxDistSq) {
-            result.push_back(entities[i]->id);
-        }
+    // 指针数组先整理成SoA，再交给向量内核
+    thread_local std::vector<float> xs;
+    thread_local std::vector<float> zs;
+    thread_local std::vector<int> ids;
+    xs.clear();
+    zs.clear();
+    ids.clear();
+    for (const EnhancedEntity* entity : entities) {
+        xs.push_back(entity->pos.x);
+        zs.push_back(entity->pos.z);
+        ids.push_back(entity->id);
     }
+    calculateDistancesRange(xs.data(), zs.data(), ids.data(), ids.size(), viewerPos, maxDistSq, result);
 }
 
 void SIMDDistanceCalculator::calculateDistancesScalar(
@@ -215,11 +318,34 @@ void SIMDDistanceCalculator::calculateDistancesScalar(
     }
 }
 
+void SIMDDistanceCalculator::calculateDistancesSoA(
+    const float* xs, const float* zs, const int* ids,
+    const uint32_t* slots, size_t count,
+    const Position& viewerPos, float maxDistSq,
+    std::vector<int>& result) {
+    
+    appendFiltered(result, count, [&](int* out) {
+        return core::simdKernels().filterSlotsInRange2D(xs, zs, ids, slots, count,
+                                                        viewerPos.x, viewerPos.z, maxDistSq, out);
+    });
+}
+
+void SIMDDistanceCalculator::calculateDistancesRange(
+    const float* xs, const float* zs, const int* ids, size_t count,
+    const Position& viewerPos, float maxDistSq,
+    std::vector<int>& result) {
+    
+    appendFiltered(result, count, [&](int* out) {
+        return core::simdKernels().filterInRange2D(xs, zs, ids, count,
+                                                   viewerPos.x, viewerPos.z, maxDistSq, out);
+    });
+}
+
 // ===== 异步实体同步实现 =====
 
 AsyncEntitySync::AsyncEntitySync() {
-    taskPool_ = std::make_unique<MemoryArena>();
-    workerThread_ = std::thread(&AsyncEntitySync::workerLoop, this);
+    workerThread_ = core::NativeRuntime::instance().startThread(
+        core::NativeSubsystem::ENTITY_SYNC, [this] { workerLoop(); });
 }
 
 AsyncEntitySync::~AsyncEntitySync() {
@@ -229,23 +355,25 @@ AsyncEntitySync::~AsyncEntitySync() {
     }
 }
 
-void AsyncEntitySync::enqueueUpdate(int entityId, const Position& pos,
+bool AsyncEntitySync::enqueueUpdate(int entityId, const Position& pos,
                                    float yaw, float pitch, uint8_t flags) {
-    void* mem = taskPool_->allocate(sizeof(SyncTask));
-    SyncTask* task = new (mem) SyncTask(entityId, pos, yaw, pitch, flags, 0);
-    
-    taskQueue_.enqueue(*task); // 使用普通的enqueue而不是try_enqueue
+    if (taskQueue_.tryEnqueue(SyncTask(entityId, pos, yaw, pitch, flags, 0))) {
+        return true;
+    }
+    droppedTasks_.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
 void AsyncEntitySync::workerLoop() {
+    std::array<SyncTask, DRAIN_BATCH> batch;
     while (running_) {
-        SyncTask task;
-        if (taskQueue_.try_dequeue(&task)) {
-            processTask(task);
-            // 手动调用析构函数
-            task.~SyncTask();
-        } else {
+        const size_t count = taskQueue_.tryDequeueBulk(batch.data(), batch.size());
+        if (count == 0) {
             std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+        for (size_t i = 0; i < count; i++) {
+            processTask(batch[i]);
         }
     }
 }
@@ -256,39 +384,70 @@ void AsyncEntitySync::processTask(const SyncTask& /*task*/) {
     std::this_thread::sleep_for(std::chrono::microseconds(1)); // 模拟工作
 }
 
+// ===== LODSyncScheduler 实现 =====
+
+void LODSyncScheduler::recordMotion(int entityId, const Position& pos, uint32_t tick) {
+    auto [it, inserted] = motion_.try_emplace(entityId);
+    Motion& motion = it->second;
+    if (!inserted && tick > motion.tick) {
+        const float dt = static_cast<float>(tick - motion.tick);
+        motion.velocityX = (pos.x - motion.pos.x) / dt;
+        motion.velocityY = (pos.y - motion.pos.y) / dt;
+        motion.velocityZ = (pos.z - motion.pos.z) / dt;
+    }
+    motion.pos = pos;
+    motion.tick = tick;
+}
+
+void LODSyncScheduler::pruneViewer(ViewerState& state, const std::vector<int>& tracked) {
+    for (auto it = state.begin(); it != state.end();) {
+        if (!std::binary_search(tracked.begin(), tracked.end(), it->first)) {
+            it = state.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
 // ===== 分层空间索引实现 =====
 
 HierarchicalTracker::HierarchicalTracker(int worldHeight) 
-    : worldHeight_(worldHeight) {
-    queryCache_.reserve(MAX_QUERY_CACHE);
+    : HierarchicalTracker(worldHeight, std::make_shared<AsyncEntitySync>()) {
+}
+
+HierarchicalTracker::HierarchicalTracker(int worldHeight, std::shared_ptr<AsyncEntitySync> asyncSync)
+    : asyncSync_(std::move(asyncSync)), worldHeight_(worldHeight) {
     memoryPool_ = std::make_unique<MemoryArena>();
-    asyncSync_ = std::make_unique<AsyncEntitySync>();
+    shedderId_ = core::MemoryBudget::instance().addShedder(
+        core::MemorySubsystem::TRACKER, [this](size_t bytes) { return shedMemory(bytes); });
 }
 
-HierarchicalTracker::~HierarchicalTracker() = default;
+HierarchicalTracker::~HierarchicalTracker() {
+    core::MemoryBudget::instance().removeShedder(shedderId_);
+}
 
 void HierarchicalTracker::registerEntity(int id, float x, float y, float z,
                                         float radius, EntityType type) {
     std::unique_lock lock(rwMutex_);
     
-    // 由于EnhancedEntity包含atomic，使用默认构造然后赋值
-    entities_[id] = EnhancedEntity{};
-    auto& entity = entities_[id];
-    entity.id = id;
-    entity.pos = Position(x, y, z);
-    entity.radius = radius;
-    entity.type = type;
-    entity.priority = static_cast<EntityPriority>(static_cast<uint8_t>(type));
-    entity.lod = EntityLOD::LOD_FULL;
-    entity.lastUpdateTick = currentTick_;
-    addToRegion(id, entity.pos);
+    const Position pos(x, y, z);
+    const uint32_t existing = entities_.slotOf(id);
+    if (existing != EntityStore::INVALID_SLOT) {
+        // 重复注册：先移出旧位置所在的区域
+        removeFromRegion(id, entities_.position(existing));
+    }
+    // 优先级沿用按类型映射的方式（类型值超出优先级范围时归为LOW）
+    const auto priority = static_cast<EntityPriority>(
+        std::min<uint8_t>(static_cast<uint8_t>(type), static_cast<uint8_t>(EntityPriority::LOW)));
+    entities_.insert(id, pos, radius, type, priority, EntityLOD::LOD_FULL, currentTick_);
+    addToRegion(id, pos);
     
     // 为玩家创建预测器
     if (type == EntityType::PLAYER) {
         playerPredictors_[id] = PlayerPredictor();
         playerPredictors_[id].lastUpdateTick = currentTick_;
-        playerPredictors_[id].lastPos = entity.pos;
-        playerPredictors_[id].predictedPos = entity.pos;
+        playerPredictors_[id].lastPos = pos;
+        playerPredictors_[id].predictedPos = pos;
     }
     
     stats_.entitiesProcessed.fetch_add(1, std::memory_order_relaxed);
@@ -297,25 +456,25 @@ void HierarchicalTracker::registerEntity(int id, float x, float y, float z,
 void HierarchicalTracker::unregisterEntity(int id) {
     std::unique_lock lock(rwMutex_);
     
-    auto it = entities_.find(id);
-    if (it != entities_.end()) {
-        removeFromRegion(id, it->second.pos);
-        entities_.erase(it);
+    const uint32_t slot = entities_.slotOf(id);
+    if (slot != EntityStore::INVALID_SLOT) {
+        removeFromRegion(id, entities_.position(slot));
+        markSwapRemoval(slot);
+        entities_.remove(id);
         playerPredictors_.erase(id);
+        syncScheduler_.forgetEntity(id);
     }
 }
 
 void HierarchicalTracker::updateEntityPosition(int id, float x, float y, float z) {
     std::unique_lock lock(rwMutex_);
     
-    auto it = entities_.find(id);
-    if (it == entities_.end()) return;
+    const uint32_t slot = entities_.slotOf(id);
+    if (slot == EntityStore::INVALID_SLOT) return;
     
     Position newPos(x, y, z);
-    Position oldPos = it->second.pos;
-    it->second.pos = newPos;
-    it->second.lastUpdateTick = currentTick_;
-    it->second.accessCount++;
+    Position oldPos = entities_.position(slot);
+    entities_.setPosition(slot, newPos, currentTick_);
     
     // 更新玩家预测器
     auto predictorIt = playerPredictors_.find(id);
@@ -329,19 +488,87 @@ void HierarchicalTracker::updateEntityPosition(int id, float x, float y, float z
     int newChunkX = newPos.chunkX();
     int newChunkZ = newPos.chunkZ();
     
-    if (oldChunkX != newChunkX || oldChunkZ != newChunkZ) {
+    if (indexType_ == SpatialIndexType::LOOSE_GRID) {
+        grid_.move(id, newPos.x, newPos.z);
+        if (oldChunkX != newChunkX || oldChunkZ != newChunkZ) {
+            markRegionChanged(oldPos);
+            markMembershipChanged(oldPos);
+            markMembershipChanged(newPos);
+        }
+        markRegionChanged(newPos);
+    } else if (oldChunkX != newChunkX || oldChunkZ != newChunkZ) {
         removeFromRegion(id, oldPos);
         addToRegion(id, newPos);
+    } else {
+        // 区域内移动也可能跨过观察者的视距边界
+        markRegionChanged(newPos);
     }
     
-    // 异步同步更新
-    asyncSync_->enqueueUpdate(id, newPos, 0.0f, 0.0f, 0);
-    stats_.asyncTasks.fetch_add(1, std::memory_order_relaxed);
+    // 同步由collectSyncUpdates按观察者与LOD调度，这里只记录运动
+    syncScheduler_.recordMotion(id, newPos, static_cast<uint32_t>(currentTick_));
+}
+
+void HierarchicalTracker::updateEntityRotation(int id, float yaw, float pitch, float headYaw, bool onGround) {
+    std::unique_lock lock(rwMutex_);
+    
+    const uint32_t slot = entities_.slotOf(id);
+    if (slot != EntityStore::INVALID_SLOT) {
+        entities_.setRotation(slot, yaw, pitch, headYaw, onGround);
+    }
+}
+
+bool HierarchicalTracker::getEntityRotation(int id, float& yaw, float& pitch, float& headYaw,
+                                            bool& onGround) const {
+    std::shared_lock lock(rwMutex_);
+    
+    const uint32_t slot = entities_.slotOf(id);
+    if (slot == EntityStore::INVALID_SLOT) {
+        return false;
+    }
+    yaw = entities_.yaws()[slot];
+    pitch = entities_.pitches()[slot];
+    headYaw = entities_.headYaws()[slot];
+    onGround = entities_.onGround()[slot] != 0;
+    return true;
+}
+
+void HierarchicalTracker::appendCollisionInput(CollisionBroadphase::Input& input) const {
+    std::shared_lock lock(rwMutex_);
+    
+    const size_t count = entities_.size();
+    input.ids.insert(input.ids.end(), entities_.ids(), entities_.ids() + count);
+    input.xs.insert(input.xs.end(), entities_.xs(), entities_.xs() + count);
+    input.ys.insert(input.ys.end(), entities_.ys(), entities_.ys() + count);
+    input.zs.insert(input.zs.end(), entities_.zs(), entities_.zs() + count);
+    input.radii.insert(input.radii.end(), entities_.radii(), entities_.radii() + count);
+}
+
+void HierarchicalTracker::markRegionChanged(const Position& pos) {
+    trackedSets_.markCellChanged(ViewerTrackedSets::makeKey(pos.chunkX(), 0, pos.chunkZ()));
+}
+
+void HierarchicalTracker::markMembershipChanged(const Position& pos) {
+    queryCache_.markCellChanged(CellQueryCache::makeKey(pos.chunkX(), 0, pos.chunkZ()));
+}
+
+void HierarchicalTracker::markSwapRemoval(uint32_t slot) {
+    // swap-remove把最后一个实体移到slot，缓存中按slot保存的候选集随之失效
+    const uint32_t last = static_cast<uint32_t>(entities_.size() - 1);
+    if (slot != last) {
+        markMembershipChanged(entities_.position(last));
+    }
 }
 
 void HierarchicalTracker::addToRegion(int entityId, const Position& pos) {
     int chunkX = pos.chunkX();
     int chunkZ = pos.chunkZ();
+    markRegionChanged(pos);
+    markMembershipChanged(pos);
+    
+    if (indexType_ == SpatialIndexType::LOOSE_GRID) {
+        grid_.insert(entityId, pos.x, pos.z);
+        return;
+    }
     
     Region* region = getOrCreateRegion(chunkX, chunkZ);
     region->entityIds.push_back(entityId);
@@ -358,6 +585,13 @@ void HierarchicalTracker::addToRegion(int entityId, const Position& pos) {
 void HierarchicalTracker::removeFromRegion(int entityId, const Position& pos) {
     int chunkX = pos.chunkX();
     int chunkZ = pos.chunkZ();
+    markRegionChanged(pos);
+    markMembershipChanged(pos);
+    
+    if (indexType_ == SpatialIndexType::LOOSE_GRID) {
+        grid_.remove(entityId);
+        return;
+    }
     
     auto chunkIt = regions_.find(chunkX);
     if (chunkIt == regions_.end()) return;
@@ -386,6 +620,21 @@ void HierarchicalTracker::removeFromRegion(int entityId, const Position& pos) {
     }
 }
 
+void HierarchicalTracker::setSpatialIndexType(SpatialIndexType type) {
+    std::unique_lock lock(rwMutex_);
+    if (type == indexType_) {
+        return;
+    }
+    
+    regions_.clear();
+    grid_.clear();
+    indexType_ = type;
+    queryCache_.clear();
+    for (size_t slot = 0; slot < entities_.size(); slot++) {
+        addToRegion(entities_.ids()[slot], entities_.position(static_cast<uint32_t>(slot)));
+    }
+}
+
 Region* HierarchicalTracker::getOrCreateRegion(int chunkX, int chunkZ) {
     return &regions_[chunkX][chunkZ];
 }
@@ -398,65 +647,294 @@ std::vector<int> HierarchicalTracker::getVisibleEntities(int viewerId, float vie
     std::unique_lock lock(rwMutex_);
     
     Position viewerPos(viewerX, viewerY, viewerZ);
-    float maxDistSq = viewDistance * viewDistance;
+    std::vector<int> result = computeVisibleLocked(viewerId, viewerPos, viewDistance, nullptr);
     
-    // 检查缓存
-    if (const std::vector<int>* cached = getFromCache(viewerPos, viewDistance)) {
-        stats_.cacheHits.fetch_add(1, std::memory_order_relaxed);
-        return *cached;
-    }
+    stats_.totalQueries.fetch_add(1, std::memory_order_relaxed);
     
+    auto endTime = std::chrono::steady_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+    stats_.averageQueryTimeNs.store(duration.count(), std::memory_order_relaxed);
+    
+    return result;
+}
+
+std::vector<int> HierarchicalTracker::computeVisibleLocked(int viewerId, const Position& viewerPos,
+                                                           float viewDistance,
+                                                           std::vector<ViewerTrackedSets::CellKey>* cells) {
+    float maxDistSq = viewDistance * viewDistance;
     std::vector<int> result;
+    // 候选集只在本次查询内使用：来自帧分配器，最后只把结果拷进返回的vector
+    core::FrameScope frameScope;
+    
+    auto addCells = [this, cells](const Position& center, float distance) {
+        if (cells) {
+            collectQueryCells(center, distance, *cells);
+        }
+    };
     
-    // 1. 查询当前视野
-    std::vector<int> currentView = queryCurrentView(viewerPos, viewDistance);
+    // 1. 查询当前视野（候选集按区域缓存，这里只做精确距离检查）
+    core::FrameVector<int> candidates = queryCachedView(viewerPos, viewDistance);
+    addCells(viewerPos, viewDistance);
+    // 网格模式的结果已按水平距离精确过滤，只有合并了预测视野时才需要再过滤一遍
+    bool exact = indexType_ == SpatialIndexType::LOOSE_GRID;
     
     // 2. 预测性加载（如果启用）
     if (predictiveLoading_) {
         auto predictorIt = playerPredictors_.find(viewerId);
-        if (predictorIt != playerPredictors_.end()) {
+        // 预测位置离当前位置不超过0.2倍视距时，预测视野（0.8倍视距）完全落在当前视野内，不必再查询
+        const float containedSq = 0.04f * maxDistSq;
+        if (predictorIt != playerPredictors_.end() &&
+            distanceSquared(predictorIt->second.getPredictedPosition(), viewerPos) > containedSq) {
             const Position& predictedPos = predictorIt->second.getPredictedPosition();
-            std::vector<int> predictedView = queryPredictedView(predictedPos, viewDistance * 0.8f);
-            mergeQueryResults(currentView, predictedView, result);
-        } else {
-            result = std::move(currentView);
+            core::FrameVector<int> predictedView = queryPredictedView(predictedPos, viewDistance * 0.8f);
+            mergeQueryResults(candidates, predictedView);
+            addCells(predictedPos, viewDistance * 0.8f);
+            exact = false;
         }
-    } else {
-        result = std::move(currentView);
     }
     
     // 3. SIMD加速距离计算
-    if (simdEnabled_ && result.size() >= SIMD_BATCH_SIZE) {
-        std::vector<EnhancedEntity*> candidates;
-        candidates.reserve(result.size());
-        
-        for (int entityId : result) {
-            auto it = entities_.find(entityId);
-            if (it != entities_.end()) {
-                candidates.push_back(&it->second);
+    if (simdEnabled_ && !exact && candidates.size() >= SIMD_BATCH_SIZE) {
+        calculateDistancesSIMD(candidates, viewerPos, maxDistSq, result);
+        stats_.simdOperations.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        result.assign(candidates.begin(), candidates.end());
+    }
+    
+    // 4. 视锥/遮挡剔除
+    if (ViewerView* view = cullingViewFor(viewerId)) {
+        cullHiddenLocked(viewerId, *view, viewerPos, result);
+    }
+    
+    return result;
+}
+
+HierarchicalTracker::ViewerView* HierarchicalTracker::cullingViewFor(int viewerId) {
+    if (!cullingEnabled_) {
+        return nullptr;
+    }
+    auto it = viewerViews_.find(viewerId);
+    return it != viewerViews_.end() ? &it->second : nullptr;
+}
+
+void HierarchicalTracker::cullHiddenLocked(int viewerId, ViewerView& view, const Position& viewerPos,
+                                           std::vector<int>& result) {
+    constexpr float EYE_HEIGHT = 1.62f;
+    const float eyeY = viewerPos.y + EYE_HEIGHT;
+    const ViewCuller::ViewDirection dir = ViewCuller::direction(view.yaw, view.pitch);
+    const std::vector<int>* tracked = trackedSets_.trackedSet(viewerId);
+    
+    view.hidden.clear();
+    size_t kept = 0;
+    for (int entityId : result) {
+        const uint32_t slot = entities_.slotOf(entityId);
+        if (slot == EntityStore::INVALID_SLOT) {
+            continue;
+        }
+        const float x = entities_.xs()[slot];
+        const float y = entities_.ys()[slot];
+        const float z = entities_.zs()[slot];
+        const bool visible = culler_.inViewCone(viewerPos.x, eyeY, viewerPos.z, dir, x, y, z) &&
+                             !culler_.isOccluded(viewerPos.x, eyeY, viewerPos.z, x, y, z);
+        if (!visible) {
+            ++culledEntities_;
+            if (!tracked || !std::binary_search(tracked->begin(), tracked->end(), entityId)) {
+                continue;              // 尚未追踪：延后到可见时再进入
             }
+            view.hidden.push_back(entityId);
         }
-        
-        std::vector<int> filtered;
-        calculateDistancesSIMD(candidates, viewerPos, maxDistSq, filtered);
-        result = std::move(filtered);
-        stats_.simdOperations.fetch_add(1, std::memory_order_relaxed);
+        result[kept++] = entityId;
     }
+    result.resize(kept);
+    std::sort(view.hidden.begin(), view.hidden.end());
+    view.committedYaw = view.yaw;
+    view.committedPitch = view.pitch;
+}
+
+void HierarchicalTracker::setCullingEnabled(bool enabled) {
+    std::unique_lock lock(rwMutex_);
+    cullingEnabled_ = enabled;
+}
+
+void HierarchicalTracker::setCullingConfig(const ViewCuller::Config& config) {
+    std::unique_lock lock(rwMutex_);
+    culler_.configure(config);
+}
+
+void HierarchicalTracker::setViewerOrientation(int viewerId, float yaw, float pitch) {
+    std::unique_lock lock(rwMutex_);
+    auto [it, inserted] = viewerViews_.try_emplace(viewerId);
+    it->second.yaw = yaw;
+    it->second.pitch = pitch;
+    if (inserted) {
+        it->second.committedYaw = yaw;
+        it->second.committedPitch = pitch;
+    }
+}
+
+void HierarchicalTracker::setOpaqueSections(int chunkX, int chunkZ, int minSectionY, uint64_t mask) {
+    std::unique_lock lock(rwMutex_);
+    culler_.setOpaqueSections(chunkX, chunkZ, minSectionY, mask);
+    // 遮挡变化后覆盖该区块列的观察者需要重算
+    const float blockX = static_cast<float>(chunkX * ViewCuller::SECTION_SIZE);
+    const float blockZ = static_cast<float>(chunkZ * ViewCuller::SECTION_SIZE);
+    markRegionChanged(Position(blockX, 0.0f, blockZ));
+}
+
+VisibilityDelta HierarchicalTracker::updateViewerVisibility(int viewerId, float viewerX, float viewerY,
+                                                            float viewerZ, float viewDistance) {
+    std::unique_lock lock(rwMutex_);
     
-    // 4. 缓存结果
-    addToCache(viewerPos, viewDistance, result);
+    // 剔除开启时，朝向变化超过阈值也需要重算
+    constexpr float ORIENTATION_THRESHOLD_DEGREES = 10.0f;
+    bool turned = false;
+    if (const ViewerView* view = cullingViewFor(viewerId)) {
+        const float yawDelta = std::abs(std::remainder(view->yaw - view->committedYaw, 360.0f));
+        turned = yawDelta > ORIENTATION_THRESHOLD_DEGREES ||
+                 std::abs(view->pitch - view->committedPitch) > ORIENTATION_THRESHOLD_DEGREES;
+    }
+    if (!turned && !trackedSets_.needsUpdate(viewerId, viewerX, viewerY, viewerZ, viewDistance)) {
+        return trackedSets_.skip();
+    }
     
+    Position viewerPos(viewerX, viewerY, viewerZ);
+    std::vector<ViewerTrackedSets::CellKey> cells;
+    cells.reserve(18);
+    std::vector<int> visible = computeVisibleLocked(viewerId, viewerPos, viewDistance, &cells);
+    // 观察者自己不在自己的追踪集合中
+    visible.erase(std::remove(visible.begin(), visible.end(), viewerId), visible.end());
     stats_.totalQueries.fetch_add(1, std::memory_order_relaxed);
     
-    auto endTime = std::chrono::steady_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
-    stats_.averageQueryTimeNs.store(duration.count(), std::memory_order_relaxed);
+    VisibilityDelta delta = trackedSets_.commit(viewerId, viewerX, viewerY, viewerZ, viewDistance,
+                                                std::move(cells), std::move(visible));
+    // 重新进入视野的实体由Java重新生成，客户端位置以生成包为准
+    moveEncoder_.forget(viewerId, delta.left);
+    moveEncoder_.forget(viewerId, delta.entered);
+    return delta;
+}
+
+std::vector<int> HierarchicalTracker::removeViewer(int viewerId) {
+    std::unique_lock lock(rwMutex_);
+    syncScheduler_.removeViewer(viewerId);
+    moveEncoder_.removeViewer(viewerId);
+    viewerViews_.erase(viewerId);
+    return trackedSets_.removeViewer(viewerId);
+}
+
+std::vector<LODSyncScheduler::Update> HierarchicalTracker::collectSyncUpdates(int viewerId, float viewerX,
+                                                                              float viewerY, float viewerZ) {
+    std::unique_lock lock(rwMutex_);
+    return collectSyncUpdatesLocked(viewerId, Position(viewerX, viewerY, viewerZ));
+}
+
+std::vector<LODSyncScheduler::Update> HierarchicalTracker::collectSyncUpdatesLocked(int viewerId,
+                                                                                    const Position& viewerPos) {
+    std::vector<LODSyncScheduler::Update> updates;
+    const std::vector<int>* tracked = trackedSets_.trackedSet(viewerId);
+    if (!tracked) {
+        return updates;
+    }
     
-    return result;
+    syncScheduler_.schedule(
+        viewerId, viewerPos, *tracked, static_cast<uint32_t>(currentTick_),
+        [this](int entityId, Position& pos) {
+            const uint32_t slot = entities_.slotOf(entityId);
+            if (slot == EntityStore::INVALID_SLOT) {
+                return false;
+            }
+            pos = entities_.position(slot);
+            return true;
+        },
+        updates, cullingViewFor(viewerId) ? &viewerViews_[viewerId].hidden : nullptr);
+    
+    const size_t accepted = asyncSync_->enqueueBulk(updates);
+    stats_.asyncTasks.fetch_add(accepted, std::memory_order_relaxed);
+    stats_.asyncTasksDropped.fetch_add(updates.size() - accepted, std::memory_order_relaxed);
+    return updates;
 }
 
-std::vector<int> HierarchicalTracker::queryCurrentView(const Position& viewerPos, float viewDistance) {
-    std::vector<int> result;
+net::EntityMoveEncoder::EncodeResult HierarchicalTracker::encodeSyncUpdates(int viewerId, float viewerX,
+                                                                            float viewerY, float viewerZ,
+                                                                            int compressionThreshold,
+                                                                            size_t maxBytes,
+                                                                            std::vector<uint8_t>& out) {
+    std::unique_lock lock(rwMutex_);
+    
+    const auto updates = collectSyncUpdatesLocked(viewerId, Position(viewerX, viewerY, viewerZ));
+    if (updates.empty()) {
+        return {};
+    }
+    
+    // 调度器只访问过存在的实体，slot在持锁期间不变
+    core::FrameScope frameScope;
+    core::FrameVector<uint32_t> slots = core::makeFrameVector<uint32_t>(updates.size());
+    core::FrameVector<net::EntityMoveEncoder::Detail> details =
+        core::makeFrameVector<net::EntityMoveEncoder::Detail>(updates.size());
+    for (const auto& update : updates) {
+        slots.push_back(entities_.slotOf(update.entityId));
+        details.push_back(static_cast<net::EntityMoveEncoder::Detail>(update.lod));
+    }
+    
+    net::EntityMoveEncoder::Columns columns;
+    columns.ids = entities_.ids();
+    columns.xs = entities_.xs();
+    columns.ys = entities_.ys();
+    columns.zs = entities_.zs();
+    columns.yaws = entities_.yaws();
+    columns.pitches = entities_.pitches();
+    columns.headYaws = entities_.headYaws();
+    columns.onGround = entities_.onGround();
+    return moveEncoder_.encode(viewerId, columns, slots.data(), details.data(), slots.size(),
+                               compressionThreshold, maxBytes, out);
+}
+
+void HierarchicalTracker::setMoveEncoderConfig(const net::EntityMoveEncoder::Config& config) {
+    std::unique_lock lock(rwMutex_);
+    moveEncoder_.configure(config);
+}
+
+net::EntityMoveEncoder::Stats HierarchicalTracker::getMoveEncoderStats() const {
+    std::shared_lock lock(rwMutex_);
+    return moveEncoder_.getStats();
+}
+
+void HierarchicalTracker::setSyncConfig(const LODSyncScheduler::Config& config) {
+    std::unique_lock lock(rwMutex_);
+    syncScheduler_.configure(config);
+}
+
+LODSyncScheduler::Stats HierarchicalTracker::getSyncStats() const {
+    std::shared_lock lock(rwMutex_);
+    return syncScheduler_.getStats();
+}
+
+void HierarchicalTracker::collectQueryCells(const Position& center, float viewDistance,
+                                            std::vector<ViewerTrackedSets::CellKey>& cells) const {
+    // 四叉树模式只查询周围3x3个区域；网格模式按视距查询，覆盖视距内的全部区域
+    int minX = center.chunkX() - 1;
+    int maxX = center.chunkX() + 1;
+    int minZ = center.chunkZ() - 1;
+    int maxZ = center.chunkZ() + 1;
+    if (indexType_ == SpatialIndexType::LOOSE_GRID) {
+        minX = static_cast<int>(std::floor((center.x - viewDistance) / CHUNK_SIZE));
+        maxX = static_cast<int>(std::floor((center.x + viewDistance) / CHUNK_SIZE));
+        minZ = static_cast<int>(std::floor((center.z - viewDistance) / CHUNK_SIZE));
+        maxZ = static_cast<int>(std::floor((center.z + viewDistance) / CHUNK_SIZE));
+    }
+    for (int x = minX; x <= maxX; x++) {
+        for (int z = minZ; z <= maxZ; z++) {
+            cells.push_back(ViewerTrackedSets::makeKey(x, 0, z));
+        }
+    }
+}
+
+core::FrameVector<int> HierarchicalTracker::queryCurrentView(const Position& viewerPos, float viewDistance) {
+    core::FrameVector<int> result = core::makeFrameVector<int>();
+    
+    if (indexType_ == SpatialIndexType::LOOSE_GRID) {
+        grid_.queryRange(viewerPos.x, viewerPos.z, viewDistance, result);
+        return result;
+    }
     
     // 查询邻近区域
     int chunkX = viewerPos.chunkX();
@@ -485,31 +963,102 @@ std::vector<int> HierarchicalTracker::queryCurrentView(const Position& viewerPos
     return result;
 }
 
-std::vector<int> HierarchicalTracker::queryPredictedView(const Position& predictedPos, float viewDistance) {
+core::FrameVector<int> HierarchicalTracker::queryPredictedView(const Position& predictedPos, float viewDistance) {
     // 预测视图的查询逻辑与当前视图类似，但范围稍小
-    return queryCurrentView(predictedPos, viewDistance);
+    return queryCachedView(predictedPos, viewDistance);
 }
 
-void HierarchicalTracker::mergeQueryResults(const std::vector<int>& currentView,
-                                           const std::vector<int>& predictedView,
-                                           std::vector<int>& result) {
-    result = currentView; // 优先当前视野
-    result.reserve(currentView.size() + predictedView.size());
+core::FrameVector<int> HierarchicalTracker::queryCachedView(const Position& center, float viewDistance) {
+    // 四叉树模式保持原有的3x3区域查询，不缓存
+    if (indexType_ != SpatialIndexType::LOOSE_GRID) {
+        return queryCurrentView(center, viewDistance);
+    }
+    
+    const int chunkX = center.chunkX();
+    const int chunkZ = center.chunkZ();
+    const int reach = CellQueryCache::reachCells(viewDistance, CHUNK_SIZE);
+    const uint32_t tick = static_cast<uint32_t>(currentTick_);
+    
+    const std::vector<int>* candidates = queryCache_.find(chunkX, 0, chunkZ, reach, 0, tick);
+    if (candidates) {
+        stats_.cacheHits.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        candidates = &queryCache_.store(chunkX, 0, chunkZ, reach, 0, tick,
+                                        gatherRegionMembers(chunkX, chunkZ, reach));
+    }
+    
+    // 候选集保存的是slot（升序），直接按SoA数组做水平距离检查（与网格查询一致）
+    const float maxDistSq = viewDistance * viewDistance;
+    const int* ids = entities_.ids();
+    const float* xs = entities_.xs();
+    const float* zs = entities_.zs();
+    core::FrameVector<int> result = core::makeFrameVector<int>(candidates->size() / 2);
+    for (int slot : *candidates) {
+        const float dx = xs[slot] - center.x;
+        const float dz = zs[slot] - center.z;
+        if (dx * dx + dz * dz <= maxDistSq) {
+            result.push_back(ids[slot]);
+        }
+    }
+    return result;
+}
+
+std::vector<int> HierarchicalTracker::gatherRegionMembers(int chunkX, int chunkZ, int reach) const {
+    // 网格按半径查询：取覆盖这片区域的外接圆，再按所在区域筛掉范围外的实体
+    const float halfExtent = (reach + 0.5f) * CHUNK_SIZE;
+    const float centerX = (chunkX + 0.5f) * CHUNK_SIZE;
+    const float centerZ = (chunkZ + 0.5f) * CHUNK_SIZE;
+    core::FrameVector<int> nearby = core::makeFrameVector<int>();
+    grid_.queryRange(centerX, centerZ, halfExtent * 1.41422f, nearby);
+    
+    std::vector<int> members;
+    members.reserve(nearby.size());
+    for (int entityId : nearby) {
+        const uint32_t slot = entities_.slotOf(entityId);
+        const Position pos = entities_.position(slot);
+        if (std::abs(pos.chunkX() - chunkX) <= reach && std::abs(pos.chunkZ() - chunkZ) <= reach) {
+            members.push_back(static_cast<int>(slot));
+        }
+    }
+    std::sort(members.begin(), members.end());
+    return members;
+}
+
+void HierarchicalTracker::mergeQueryResults(core::FrameVector<int>& currentView,
+                                           const core::FrameVector<int>& predictedView) {
+    // 优先当前视野，只在原有部分中查重
+    const size_t current = currentView.size();
+    currentView.reserve(current + predictedView.size());
     
     // 合并预测视图中的新实体
     for (int entityId : predictedView) {
-        if (std::find(currentView.begin(), currentView.end(), entityId) == currentView.end()) {
-            result.push_back(entityId);
+        const auto end = currentView.begin() + static_cast<ptrdiff_t>(current);
+        if (std::find(currentView.begin(), end, entityId) == end) {
+            currentView.push_back(entityId);
         }
     }
 }
 
-void HierarchicalTracker::calculateDistancesSIMD(const std::vector<EnhancedEntity*>& candidates,
+void HierarchicalTracker::calculateDistancesSIMD(const core::FrameVector<int>& candidates,
                                                 const Position& viewerPos,
                                                 float maxDistSq,
                                                 std::vector<int>& result) {
-    SIMDDistanceCalculator::calculateDistancesAVX2(
-        std::vector<int>(), candidates, viewerPos, maxDistSq, result);
+    // id换算成slot并排序，gather时按地址递增访问SoA数组
+    thread_local std::vector<uint32_t> slots;
+    slots.clear();
+    slots.reserve(candidates.size());
+    for (int entityId : candidates) {
+        const uint32_t slot = entities_.slotOf(entityId);
+        if (slot != EntityStore::INVALID_SLOT) {
+            slots.push_back(slot);
+        }
+    }
+    std::sort(slots.begin(), slots.end());
+    
+    result.reserve(slots.size());
+    SIMDDistanceCalculator::calculateDistancesSoA(
+        entities_.xs(), entities_.zs(), entities_.ids(), slots.data(), slots.size(),
+        viewerPos, maxDistSq, result);
 }
 
 void HierarchicalTracker::tick() {
@@ -524,29 +1073,33 @@ void HierarchicalTracker::tick() {
     // 清理任务
     if (currentTick_ % TICK_CACHE_CLEANUP == 0) {
         cleanupCache();
+        trackedSets_.pruneCellVersions();
     }
     
     if (currentTick_ % (ENTITY_CLEANUP_TICKS / 10) == 0) {
         cleanupOldEntities();
     }
+    
+    memory_.set(estimateMemoryLocked());
 }
 
 void HierarchicalTracker::processEntitiesByPriority() {
-    // 按优先级分组实体
-    std::array<std::vector<EnhancedEntity*>, 4> priorityGroups;
+    // 按优先级分组实体（记录slot）
+    std::array<std::vector<uint32_t>, 4> priorityGroups;
     
-    for (auto& pair : entities_) {
-        EnhancedEntity* entity = &pair.second;
-        priorityGroups[static_cast<int>(entity->priority)].push_back(entity);
+    const EntityPriority* priorities = entities_.priorities();
+    for (uint32_t slot = 0; slot < entities_.size(); ++slot) {
+        priorityGroups[static_cast<int>(priorities[slot])].push_back(slot);
     }
     
     // 高优先级优先处理
+    const uint32_t* lastUpdateTicks = entities_.lastUpdateTicks();
     for (int priority = 0; priority < 4; priority++) {
-        for (EnhancedEntity* entity : priorityGroups[priority]) {
-            // 动态跳过低优先级更新
+        for (uint32_t slot : priorityGroups[priority]) {
+            // 动态跳过低优先级更新（与EnhancedEntity::isMoving相同的判断）
             if (priority >= static_cast<int>(EntityPriority::MEDIUM) && 
                 currentTick_ % 2 != 0 && 
-                !entity->isMoving()) {
+                lastUpdateTicks[slot] == 0) {
                 continue;
             }
             
@@ -557,51 +1110,51 @@ void HierarchicalTracker::processEntitiesByPriority() {
 }
 
 void HierarchicalTracker::cleanupCache() {
-    std::erase_if(queryCache_, [this](const QueryCache& cache) {
-        return !cache.isValid(currentTick_);
-    });
+    queryCache_.prune(static_cast<uint32_t>(currentTick_));
 }
 
-void HierarchicalTracker::addToCache(const Position& viewerPos, float viewDistance,
-                                    const std::vector<int>& result) {
-    if (queryCache_.size() >= MAX_QUERY_CACHE) {
-        queryCache_.erase(queryCache_.begin());
-    }
-    
-    QueryCache cache;
-    cache.viewerPos = viewerPos;
-    cache.viewDistance = viewDistance;
-    cache.cacheTick = currentTick_;
-    cache.result = result;
-    
-    queryCache_.push_back(std::move(cache));
+size_t HierarchicalTracker::estimateMemoryLocked() const {
+    return entities_.size() * ENTITY_MEMORY_ESTIMATE +
+           playerPredictors_.size() * PREDICTOR_MEMORY_ESTIMATE +
+           queryCache_.memoryUsage() + moveEncoder_.memoryUsage();
 }
 
-const std::vector<int>* HierarchicalTracker::getFromCache(const Position& viewerPos, float viewDistance) {
-    for (const auto& cache : queryCache_) {
-        if (cache.isValid(currentTick_) &&
-            std::abs(cache.viewerPos.x - viewerPos.x) < 0.5f &&
-            std::abs(cache.viewerPos.z - viewerPos.z) < 0.5f &&
-            std::abs(cache.viewDistance - viewDistance) < 0.5f) {
-            return &cache.result;
-        }
-    }
-    return nullptr;
+size_t HierarchicalTracker::shedMemory(size_t bytes) {
+    // 实体数据不能丢弃，只清空查询缓存（之后的查询重新遍历空间索引）
+    // 与数据包编码基准（之后每个实体先发一次Teleport）
+    (void)bytes;
+    std::unique_lock lock(rwMutex_);
+    const size_t released = queryCache_.memoryUsage() + moveEncoder_.memoryUsage();
+    queryCache_.clear();
+    moveEncoder_.clear();
+    memory_.set(estimateMemoryLocked());
+    return released;
+}
+
+CellQueryCache::Stats HierarchicalTracker::getQueryCacheStats() const {
+    std::shared_lock lock(rwMutex_);
+    return queryCache_.getStats();
 }
 
 void HierarchicalTracker::cleanupOldEntities() {
-    auto it = entities_.begin();
-    while (it != entities_.end()) {
-        if (currentTick_ - it->second.lastUpdateTick > ENTITY_CLEANUP_TICKS) {
-            removeFromRegion(it->first, it->second.pos);
-            it = entities_.erase(it);
-        } else {
-            ++it;
+    // 倒序遍历：swap-remove只会把尾部已检查过的实体移到当前slot
+    const uint32_t* lastUpdateTicks = entities_.lastUpdateTicks();
+    for (size_t slot = entities_.size(); slot-- > 0;) {
+        if (currentTick_ - static_cast<int>(lastUpdateTicks[slot]) > ENTITY_CLEANUP_TICKS) {
+            const int id = entities_.ids()[slot];
+            removeFromRegion(id, entities_.position(static_cast<uint32_t>(slot)));
+            markSwapRemoval(static_cast<uint32_t>(slot));
+            entities_.remove(id);
+            playerPredictors_.erase(id);
+            syncScheduler_.forgetEntity(id);
         }
     }
 }
 
 size_t HierarchicalTracker::getActiveRegionCount() const {
+    if (indexType_ == SpatialIndexType::LOOSE_GRID) {
+        return grid_.cellCount();
+    }
     size_t count = 0;
     for (const auto& chunkPair : regions_) {
         count += chunkPair.second.size();
@@ -614,6 +1167,7 @@ void HierarchicalTracker::resetStats() {
     stats_.cacheHits = 0;
     stats_.simdOperations = 0;
     stats_.asyncTasks = 0;
+    stats_.asyncTasksDropped = 0;
     stats_.entitiesProcessed = 0;
     stats_.averageQueryTimeNs = 0;
 }
@@ -643,6 +1197,12 @@ void JNIHierarchicalTracker::registerEntity(int entityId, float x, float y, floa
     }
 }
 
+void JNIHierarchicalTracker::unregisterEntity(int entityId) {
+    if (instance) {
+        instance->unregisterEntity(entityId);
+    }
+}
+
 void JNIHierarchicalTracker::updateEntityPosition(int entityId, float x, float y, float z) {
     if (instance) {
         instance->updateEntityPosition(entityId, x, y, z);
@@ -668,6 +1228,64 @@ int* JNIHierarchicalTracker::getVisibleEntities(int viewerId, float viewerX, flo
     return nullptr;
 }
 
+VisibilityDelta JNIHierarchicalTracker::updateViewerVisibility(int viewerId, float viewerX, float viewerY,
+                                                               float viewerZ, float viewDistance) {
+    if (!instance) {
+        return VisibilityDelta{};
+    }
+    return instance->updateViewerVisibility(viewerId, viewerX, viewerY, viewerZ, viewDistance);
+}
+
+void JNIHierarchicalTracker::removeViewer(int viewerId) {
+    if (instance) {
+        instance->removeViewer(viewerId);
+    }
+}
+
+std::vector<LODSyncScheduler::Update> JNIHierarchicalTracker::collectSyncUpdates(int viewerId, float viewerX,
+                                                                                 float viewerY, float viewerZ) {
+    if (!instance) {
+        return {};
+    }
+    return instance->collectSyncUpdates(viewerId, viewerX, viewerY, viewerZ);
+}
+
+void JNIHierarchicalTracker::updateEntityRotation(int entityId, float yaw, float pitch, float headYaw,
+                                                  bool onGround) {
+    if (instance) {
+        instance->updateEntityRotation(entityId, yaw, pitch, headYaw, onGround);
+    }
+}
+
+net::EntityMoveEncoder::EncodeResult JNIHierarchicalTracker::encodeSyncUpdates(int viewerId, float viewerX,
+                                                                               float viewerY, float viewerZ,
+                                                                               int compressionThreshold,
+                                                                               size_t maxBytes,
+                                                                               std::vector<uint8_t>& out) {
+    if (!instance) {
+        return {};
+    }
+    return instance->encodeSyncUpdates(viewerId, viewerX, viewerY, viewerZ, compressionThreshold, maxBytes, out);
+}
+
+void JNIHierarchicalTracker::setMoveEncoderConfig(const net::EntityMoveEncoder::Config& config) {
+    if (instance) {
+        instance->setMoveEncoderConfig(config);
+    }
+}
+
+void JNIHierarchicalTracker::setViewerOrientation(int viewerId, float yaw, float pitch) {
+    if (instance) {
+        instance->setViewerOrientation(viewerId, yaw, pitch);
+    }
+}
+
+void JNIHierarchicalTracker::setOpaqueSections(int chunkX, int chunkZ, int minSectionY, uint64_t mask) {
+    if (instance) {
+        instance->setOpaqueSections(chunkX, chunkZ, minSectionY, mask);
+    }
+}
+
 void JNIHierarchicalTracker::tick() {
     if (instance) {
         instance->tick();
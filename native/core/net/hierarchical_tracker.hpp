@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include <unordered_map>
 #include <memory>
@@ -8,111 +9,41 @@
 #include <chrono>
 #include <optional>
 #include <array>
-#include <immintrin.h> // SIMD support
+#include <cstdint>
 #include <shared_mutex>
+#include <thread>
+#include "../frame_allocator.hpp"
+#include "../memory_budget.hpp"
+#include "../slab_allocator.hpp"
 #include "memory_arena.hpp"
+#include "mpmc_ring.hpp"
 #include "native_compressor.hpp"
+#include "collision_broadphase.hpp"
+#include "entity_move_encoder.hpp"
+#include "loose_grid.hpp"
+#include "query_cell_cache.hpp"
+#include "view_culling.hpp"
+#include "visibility_delta.hpp"
 
 using lattice::net::MemoryArena;
 
-// 简化的无锁队列实现（避免外部依赖）
-namespace moodycamel {
-template<typename T>
-class ConcurrentQueue {
-private:
-    struct Node {
-        T data;
-        std::atomic<Node*> next;
-        
-        Node() : data(T()), next(nullptr) {}
-        explicit Node(const T& item) : data(item), next(nullptr) {}
-    };
-    
-    std::atomic<Node*> head_;
-    std::atomic<Node*> tail_;
-    
-public:
-    ConcurrentQueue() {
-        Node* dummy = new Node();
-        head_.store(dummy, std::memory_order_relaxed);
-        tail_.store(dummy, std::memory_order_relaxed);
-    }
-    
-    ~ConcurrentQueue() {
-        while (try_dequeue(nullptr)) {} // 清空队列
-        Node* dummy = head_.load();
-        delete dummy;
-    }
-    
-    void enqueue(const T& item) {
-        Node* newNode = new Node(item);
-        Node* currentTail = tail_.load(std::memory_order_relaxed);
-        
-        while (true) {
-            Node* next = currentTail->next.load(std::memory_order_acquire);
-            if (next == nullptr) {
-                if (currentTail->next.compare_exchange_weak(next, newNode,
-                    std::memory_order_release, std::memory_order_relaxed)) {
-                    break;
-                }
-            } else {
-                if (tail_.compare_exchange_weak(currentTail, next,
-                    std::memory_order_relaxed, std::memory_order_relaxed)) {
-                    currentTail = next;
-                }
-            }
-        }
-        
-        tail_.compare_exchange_weak(currentTail, newNode,
-            std::memory_order_relaxed, std::memory_order_relaxed);
-    }
-    
-    bool try_enqueue(const T& item) {
-        // try_enqueue is essentially the same as enqueue but may fail if queue is full
-        // For our simplified implementation, we always succeed
-        enqueue(item);
-        return true;
-    }
-    
-    bool try_dequeue(T* result) {
-        Node* currentHead = head_.load(std::memory_order_relaxed);
-        Node* next = currentHead->next.load(std::memory_order_acquire);
-        
-        if (next == nullptr) {
-            return false;
-        }
-        
-        if (result) {
-            *result = next->data;
-        }
-        
-        if (head_.compare_exchange_weak(currentHead, next,
-            std::memory_order_relaxed, std::memory_order_relaxed)) {
-            delete currentHead;
-            return true;
-        }
-        
-        return false;
-    }
-    
-    size_t size_approx() const {
-        // 简化实现，不提供精确大小
-        return 0;
-    }
-};
-}
-
 namespace lattice {
 namespace entity {
 
 // ===== 常量定义 =====
 constexpr int CHUNK_SIZE = 32;
 constexpr float MAX_VIEW_DISTANCE = 64.0f;
-constexpr size_t MAX_QUERY_CACHE = 32;
 constexpr int TICK_CACHE_CLEANUP = 100;
 constexpr int PREDICTION_LOOKAHEAD_TICKS = 20; // 1秒预测
 constexpr int ENTITY_CLEANUP_TICKS = 6000; // 5分钟
 constexpr int SIMD_BATCH_SIZE = 8;
+constexpr int GRID_CELL_SIZE = 32; // 松散网格的格子边长（编译期常量）
+
+// 细粒度空间索引的实现方式
+enum class SpatialIndexType : uint8_t {
+    LOOSE_GRID = 0,  // 松散均匀网格：格子内移动O(1)，适合实体密集、频繁移动的世界
+    QUAD_TREE = 1    // 每个区域一棵四叉树：适合实体稀疏的世界
+};
 
 // ===== 实体类型枚举 =====
 enum class EntityType : uint8_t {
@@ -219,29 +150,109 @@ struct EnhancedEntity {
     }
     
     // 动态LOD计算
-    EntityLOD calculateLOD(float distance) const {
+    EntityLOD calculateLOD(float distance) const { return lodForDistance(distance); }
+    
+    static EntityLOD lodForDistance(float distance) {
         if (distance < 32.0f) return EntityLOD::LOD_FULL;
         if (distance < 64.0f) return EntityLOD::LOD_MEDIUM;
         return EntityLOD::LOD_LOW;
     }
+    
+    // 按平方距离计算，热路径上避免sqrt
+    static EntityLOD lodForDistanceSquared(float distanceSq) {
+        if (distanceSq < 32.0f * 32.0f) return EntityLOD::LOD_FULL;
+        if (distanceSq < 64.0f * 64.0f) return EntityLOD::LOD_MEDIUM;
+        return EntityLOD::LOD_LOW;
+    }
 };
 
-// ===== 热点查询缓存（复用thread_local思想） =====
-struct QueryCache {
-    Position viewerPos;
-    float viewDistance;
-    uint32_t cacheTick;
-    std::vector<int> result;
-    
-    bool isValid(uint32_t currentTick) const {
-        return (currentTick - cacheTick) < 5; // 5 tick缓存
+// ===== 实体SoA存储（距离计算连续访存） =====
+/**
+ * EntityStore - 按字段分列存储的实体数据
+ *
+ * 位置、半径、类型、优先级、LOD各自是一个稠密数组，下标(slot)相同的元素属于同一实体；
+ * 实体id通过slots_映射到slot。删除时把最后一个实体移到空出的slot（swap-remove），
+ * 数组始终保持稠密，SIMD距离计算可以直接流式读取xs()/zs()。
+ *
+ * slot在删除其他实体后可能改变，不能跨修改操作保存；长期引用实体请使用id。
+ * 非线程安全，由HierarchicalTracker的rwMutex_保护。
+ */
+class EntityStore {
+public:
+    static constexpr uint32_t INVALID_SLOT = UINT32_MAX;
+    
+    // 插入或覆盖实体，返回其slot
+    uint32_t insert(int id, const Position& pos, float radius, EntityType type,
+                    EntityPriority priority, EntityLOD lod, uint32_t tick);
+    
+    // swap-remove；实体不存在时返回false
+    bool remove(int id);
+    
+    uint32_t slotOf(int id) const {
+        auto it = slots_.find(id);
+        return it != slots_.end() ? it->second : INVALID_SLOT;
+    }
+    bool contains(int id) const { return slots_.count(id) != 0; }
+    size_t size() const { return ids_.size(); }
+    bool empty() const { return ids_.empty(); }
+    void clear();
+    void reserve(size_t count);
+    
+    // 按slot读写
+    Position position(uint32_t slot) const { return Position(x_[slot], y_[slot], z_[slot]); }
+    void setPosition(uint32_t slot, const Position& pos, uint32_t tick) {
+        x_[slot] = pos.x;
+        y_[slot] = pos.y;
+        z_[slot] = pos.z;
+        lastUpdateTick_[slot] = tick;
+        ++accessCount_[slot];
     }
+    // 朝向与着地状态只用于数据包编码，不影响空间索引
+    void setRotation(uint32_t slot, float yaw, float pitch, float headYaw, bool onGround) {
+        yaw_[slot] = yaw;
+        pitch_[slot] = pitch;
+        headYaw_[slot] = headYaw;
+        onGround_[slot] = onGround ? 1 : 0;
+    }
+    
+    // 组装单个实体的完整数据（非热路径使用）
+    EnhancedEntity view(uint32_t slot) const;
+    
+    // 稠密数组，长度均为size()
+    const int* ids() const { return ids_.data(); }
+    const float* xs() const { return x_.data(); }
+    const float* ys() const { return y_.data(); }
+    const float* zs() const { return z_.data(); }
+    const float* radii() const { return radius_.data(); }
+    const EntityType* types() const { return type_.data(); }
+    const EntityPriority* priorities() const { return priority_.data(); }
+    const EntityLOD* lods() const { return lod_.data(); }
+    EntityLOD* lods() { return lod_.data(); }
+    const uint32_t* lastUpdateTicks() const { return lastUpdateTick_.data(); }
+    const float* yaws() const { return yaw_.data(); }
+    const float* pitches() const { return pitch_.data(); }
+    const float* headYaws() const { return headYaw_.data(); }
+    const uint8_t* onGround() const { return onGround_.data(); }
+    
+private:
+    std::vector<int> ids_;
+    std::vector<float> x_, y_, z_;
+    std::vector<float> radius_;
+    std::vector<EntityType> type_;
+    std::vector<EntityPriority> priority_;
+    std::vector<EntityLOD> lod_;
+    std::vector<uint32_t> lastUpdateTick_;
+    std::vector<uint32_t> accessCount_;
+    std::vector<float> yaw_, pitch_, headYaw_;
+    std::vector<uint8_t> onGround_;
+    std::unordered_map<int, uint32_t> slots_;
 };
 
 // ===== 四叉树节点（细粒度空间索引） =====
 class QuadTree {
 public:
-    struct QuadNode {
+    // 节点随实体分布频繁拆分，从SlabAllocator分配
+    struct QuadNode : core::SlabAllocated {
         Position center;
         float size;
         std::vector<int> entityIds;
@@ -277,7 +288,13 @@ private:
                        float range, std::vector<int>& results) const;
 };
 
-// ===== 异步实体同步（无锁队列） =====
+// ===== 异步实体同步（有界无锁队列） =====
+/**
+ * 生产者（tick线程）成批提交位置更新，后台线程成批取出处理。
+ * 队列有固定容量：后台线程跟不上时新的更新被丢弃并计数，而不是让队列无限增长。
+ * 丢弃只影响后台处理：调度器已把这些实体记为已发送，更新本身仍完整返回给调用方；
+ * 被丢弃的实体要等调度器下一次为它产生更新（预测误差超过阈值，或静止满maxSilenceTicks）才会再次入队。
+ */
 class AsyncEntitySync {
 private:
     struct SyncTask {
@@ -292,32 +309,193 @@ private:
             : entityId(id), pos(p), yaw(y), pitch(pi), flags(f), tick(t) {}
     };
     
-    // 无锁队列（使用内存池分配）
-    moodycamel::ConcurrentQueue<SyncTask> taskQueue_;
+    static constexpr size_t QUEUE_CAPACITY = 65536;
+    static constexpr size_t DRAIN_BATCH = 256;
+    
+    net::MPMCRing<SyncTask> taskQueue_{QUEUE_CAPACITY};
     std::thread workerThread_;
     std::atomic<bool> running_ = true;
-    
-    // 内存池
-    std::unique_ptr<MemoryArena> taskPool_;
+    std::atomic<uint64_t> droppedTasks_{0};
     
 public:
     AsyncEntitySync();
     ~AsyncEntitySync();
     
-    void enqueueUpdate(int entityId, const Position& pos, 
+    // 队列已满时丢弃并返回false
+    bool enqueueUpdate(int entityId, const Position& pos, 
                       float yaw, float pitch, uint8_t flags);
     
-    size_t getQueueSize() const { return taskQueue_.size_approx(); }
+    // 批量提交（Update需提供entityId/pos/lod），返回入队的数量；放不下的部分被丢弃（见类注释）
+    template<typename Update>
+    size_t enqueueBulk(const std::vector<Update>& updates) {
+        std::array<SyncTask, DRAIN_BATCH> batch;
+        size_t accepted = 0;
+        for (size_t begin = 0; begin < updates.size(); begin += DRAIN_BATCH) {
+            const size_t count = std::min(DRAIN_BATCH, updates.size() - begin);
+            for (size_t i = 0; i < count; i++) {
+                const Update& update = updates[begin + i];
+                batch[i] = SyncTask(update.entityId, update.pos, 0.0f, 0.0f, static_cast<uint8_t>(update.lod), 0);
+            }
+            const size_t pushed = taskQueue_.tryEnqueueBulk(batch.data(), count);
+            accepted += pushed;
+            if (pushed < count) {
+                break;
+            }
+        }
+        droppedTasks_.fetch_add(updates.size() - accepted, std::memory_order_relaxed);
+        return accepted;
+    }
+    
+    size_t getQueueSize() const { return taskQueue_.sizeApprox(); }
+    size_t getQueueCapacity() const { return taskQueue_.capacity(); }
+    uint64_t getDroppedCount() const { return droppedTasks_.load(std::memory_order_relaxed); }
     
 private:
     void workerLoop();
     void processTask(const SyncTask& task);
 };
 
+// ===== 按LOD调度的位置同步 =====
+/**
+ * LODSyncScheduler - 决定每个观察者本tick需要收到哪些实体的位置更新
+ *
+ * 对观察者追踪的每个实体，按距离得到LOD，再做两级过滤：
+ * 1. 频率：距上次发送不足intervalTicks[lod]个tick的直接跳过，不做任何计算
+ * 2. 航位推算：客户端按上次发送的位置和速度外推，预测误差不超过errorThreshold[lod]时不发送
+ * 静止实体在maxSilenceTicks后仍会强制同步一次，纠正客户端累积的偏差；新进入视野的实体立即发送。
+ *
+ * 实体速度由recordMotion()根据相邻两次位置估计（格/tick）。
+ * 非线程安全，由HierarchicalTracker的rwMutex_保护。
+ */
+class LODSyncScheduler {
+public:
+    static constexpr size_t LOD_LEVELS = 3;
+    
+    struct Config {
+        std::array<uint32_t, LOD_LEVELS> intervalTicks{1, 3, 10};          // FULL / MEDIUM / LOW
+        std::array<float, LOD_LEVELS> errorThreshold{0.03125f, 0.25f, 1.0f}; // 允许的预测误差（格）
+        uint32_t maxSilenceTicks = 100;                                      // 5秒
+    };
+    
+    struct Stats {
+        uint64_t considered{0};
+        uint64_t skippedInterval{0};   // 未到发送间隔
+        uint64_t skippedError{0};      // 预测误差在阈值内
+        uint64_t sent{0};
+    };
+    
+    // 调度结果：本tick要发给该观察者的实体及其LOD
+    struct Update {
+        int entityId;
+        Position pos;
+        float velocityX, velocityY, velocityZ;
+        EntityLOD lod;
+    };
+    
+    void configure(const Config& config) { config_ = config; }
+    const Config& getConfig() const { return config_; }
+    
+    // 实体位置更新时调用，用于估计速度
+    void recordMotion(int entityId, const Position& pos, uint32_t tick);
+    void forgetEntity(int entityId) { motion_.erase(entityId); }
+    
+    /**
+     * tracked为观察者当前追踪的实体（升序），positionOf(id, pos)取实体当前位置，不存在时返回false
+     * demoted（升序，可为nullptr）中的实体不论距离都按LOD_LOW调度，用于被剔除但仍在追踪的实体
+     * 需要发送的实体追加到out，并记为已发送
+     */
+    template<typename PositionOf>
+    void schedule(int viewerId, const Position& viewerPos, const std::vector<int>& tracked,
+                  uint32_t tick, PositionOf&& positionOf, std::vector<Update>& out,
+                  const std::vector<int>* demoted = nullptr);
+    
+    void removeViewer(int viewerId) { viewers_.erase(viewerId); }
+    const Stats& getStats() const { return stats_; }
+    
+private:
+    struct Motion {
+        Position pos;
+        float velocityX{0.0f}, velocityY{0.0f}, velocityZ{0.0f};
+        uint32_t tick{0};
+    };
+    
+    // 客户端已知的状态：上次发送的位置与速度
+    struct SentState {
+        Position pos;
+        float velocityX, velocityY, velocityZ;
+        uint32_t tick;
+    };
+    
+    using ViewerState = std::unordered_map<int, SentState>;
+    
+    void pruneViewer(ViewerState& state, const std::vector<int>& tracked);
+    
+    Config config_;
+    std::unordered_map<int, Motion> motion_;
+    std::unordered_map<int, ViewerState> viewers_;
+    Stats stats_;
+};
+
+template<typename PositionOf>
+void LODSyncScheduler::schedule(int viewerId, const Position& viewerPos, const std::vector<int>& tracked,
+                                uint32_t tick, PositionOf&& positionOf, std::vector<Update>& out,
+                                const std::vector<int>* demoted) {
+    ViewerState& state = viewers_[viewerId];
+    auto lodOf = [&](int entityId, const Position& pos) {
+        if (demoted && std::binary_search(demoted->begin(), demoted->end(), entityId)) {
+            return EntityLOD::LOD_LOW;
+        }
+        return EnhancedEntity::lodForDistanceSquared(pos.distanceSquaredTo(viewerPos));
+    };
+    // 离开视野的实体状态在集合明显大于追踪集时批量清理
+    if (state.size() > tracked.size() * 2 + 16) {
+        pruneViewer(state, tracked);
+    }
+    
+    for (int entityId : tracked) {
+        ++stats_.considered;
+        Position pos;
+        auto sentIt = state.find(entityId);
+        if (sentIt != state.end()) {
+            const uint32_t elapsed = tick - sentIt->second.tick;
+            // 频率只需要距离，LOD按上次发送的位置估计，未到间隔时跳过取位置
+            const EntityLOD lastLod = lodOf(entityId, sentIt->second.pos);
+            if (elapsed < config_.intervalTicks[static_cast<size_t>(lastLod)]) {
+                ++stats_.skippedInterval;
+                continue;
+            }
+            if (!positionOf(entityId, pos)) {
+                continue;
+            }
+            const EntityLOD lod = lodOf(entityId, pos);
+            const SentState& sent = sentIt->second;
+            const Position predicted(sent.pos.x + sent.velocityX * elapsed,
+                                     sent.pos.y + sent.velocityY * elapsed,
+                                     sent.pos.z + sent.velocityZ * elapsed);
+            const float threshold = config_.errorThreshold[static_cast<size_t>(lod)];
+            if (elapsed < config_.maxSilenceTicks && predicted.distanceSquaredTo(pos) <= threshold * threshold) {
+                ++stats_.skippedError;
+                continue;
+            }
+        } else if (!positionOf(entityId, pos)) {
+            continue;
+        }
+        
+        auto motionIt = motion_.find(entityId);
+        const bool hasMotion = motionIt != motion_.end();
+        const float vx = hasMotion ? motionIt->second.velocityX : 0.0f;
+        const float vy = hasMotion ? motionIt->second.velocityY : 0.0f;
+        const float vz = hasMotion ? motionIt->second.velocityZ : 0.0f;
+        state[entityId] = SentState{pos, vx, vy, vz, tick};
+        out.push_back(Update{entityId, pos, vx, vy, vz, lodOf(entityId, pos)});
+        ++stats_.sent;
+    }
+}
+
 // ===== SIMD批量距离计算器 =====
 class SIMDDistanceCalculator {
 public:
-    // AVX2优化的批量距离计算
+    // 批量距离计算（整理成SoA后使用运行时选定的向量内核；名称沿用旧接口）
     static void calculateDistancesAVX2(const std::vector<int>& entityIds,
                                      const std::vector<EnhancedEntity*>& entities,
                                      const Position& viewerPos,
@@ -330,18 +508,30 @@ public:
                                        float maxDistSq,
                                        std::vector<int>& result);
     
-    // 检查CPU支持
+    /**
+     * SoA批量距离计算：slots为xs/zs/ids中的下标，range内的实体id追加到result
+     * slots升序时访存基本连续；AVX2 / AVX-512下每次gather 8 / 16个实体
+     */
+    static void calculateDistancesSoA(const float* xs, const float* zs, const int* ids,
+                                      const uint32_t* slots, size_t count,
+                                      const Position& viewerPos, float maxDistSq,
+                                      std::vector<int>& result);
+    
+    // SoA连续区间[0, count)的距离计算，直接流式读取
+    static void calculateDistancesRange(const float* xs, const float* zs, const int* ids,
+                                        size_t count, const Position& viewerPos, float maxDistSq,
+                                        std::vector<int>& result);
+    
+    // 运行时选定的内核是否为AVX2或更高级别
     static bool isAVX2Supported();
-    
-private:
-    static bool checkAVX2Support();
-    static bool avx2Supported_;
 };
 
 // ===== 分层空间索引（核心优化类） =====
 class HierarchicalTracker {
 public:
     HierarchicalTracker(int worldHeight = 256);
+    // 多个追踪器（如同一世界的各个分片）共用一个后台同步线程
+    HierarchicalTracker(int worldHeight, std::shared_ptr<AsyncEntitySync> asyncSync);
     ~HierarchicalTracker();
     
     // 实体注册与管理
@@ -349,11 +539,67 @@ public:
                        float radius, EntityType type);
     void unregisterEntity(int id);
     void updateEntityPosition(int id, float x, float y, float z);
+    // 朝向（度）与着地状态，供encodeSyncUpdates编码旋转与转头包
+    void updateEntityRotation(int id, float yaw, float pitch, float headYaw, bool onGround);
+    // 实体不存在时返回false（分片迁移时把朝向带到新分片）
+    bool getEntityRotation(int id, float& yaw, float& pitch, float& headYaw, bool& onGround) const;
+    // 把全部实体的位置与半径追加到碰撞粗检测的输入（持读锁复制SoA数组）
+    void appendCollisionInput(CollisionBroadphase::Input& input) const;
     
     // 高效查询：获取玩家可见的实体（包含预测性加载）
     std::vector<int> getVisibleEntities(int viewerId, float viewerX, float viewerY, 
                                        float viewerZ, float viewDistance = MAX_VIEW_DISTANCE);
     
+    /**
+     * 观察者可见集增量：返回自上次调用以来进入/离开视野的实体
+     * 观察者移动不足1格且周围区域没有实体变化时直接返回空增量，不做查询
+     */
+    VisibilityDelta updateViewerVisibility(int viewerId, float viewerX, float viewerY,
+                                           float viewerZ, float viewDistance = MAX_VIEW_DISTANCE);
+    
+    // 移除观察者，返回其仍在追踪的实体
+    std::vector<int> removeViewer(int viewerId);
+    
+    const ViewerTrackedSets::Stats& getVisibilityStats() const { return trackedSets_.getStats(); }
+    size_t getViewerCount() const {
+        std::shared_lock lock(rwMutex_);
+        return trackedSets_.viewerCount();
+    }
+    
+    /**
+     * 本tick需要发给观察者的位置更新（按LOD降频 + 航位推算过滤）
+     * 只考虑updateViewerVisibility维护的追踪集合；选中的更新同时提交给AsyncEntitySync
+     */
+    std::vector<LODSyncScheduler::Update> collectSyncUpdates(int viewerId, float viewerX,
+                                                             float viewerY, float viewerZ);
+    void setSyncConfig(const LODSyncScheduler::Config& config);
+    LODSyncScheduler::Stats getSyncStats() const;
+    
+    /**
+     * 与collectSyncUpdates相同的调度，但直接把选中的更新编码为带长度前缀的移动/旋转/转头数据包
+     * 追加到out（见EntityMoveEncoder），LOD_MEDIUM不发送转头、LOD_LOW只发送位置
+     * compressionThreshold < 0表示连接未开启压缩；输出超过maxBytes的实体留到之后重新调度
+     */
+    net::EntityMoveEncoder::EncodeResult encodeSyncUpdates(int viewerId, float viewerX, float viewerY,
+                                                           float viewerZ, int compressionThreshold,
+                                                           size_t maxBytes, std::vector<uint8_t>& out);
+    void setMoveEncoderConfig(const net::EntityMoveEncoder::Config& config);
+    net::EntityMoveEncoder::Stats getMoveEncoderStats() const;
+    
+    // 按区域缓存的查询候选集统计
+    CellQueryCache::Stats getQueryCacheStats() const;
+    
+    /**
+     * 视锥/遮挡剔除（默认关闭），在距离过滤之后执行，只作用于设置过朝向的观察者
+     * 被剔除且尚未追踪的实体延后进入视野；已追踪的实体保留，但位置同步降为LOD_LOW
+     */
+    void setCullingEnabled(bool enabled);
+    void setCullingConfig(const ViewCuller::Config& config);
+    void setViewerOrientation(int viewerId, float yaw, float pitch);
+    // mask第i位表示区块段minSectionY + i完全不透明（区块坐标为16格的原版区块）
+    void setOpaqueSections(int chunkX, int chunkZ, int minSectionY, uint64_t mask);
+    uint64_t getCulledCount() const { return culledEntities_; }
+    
     // 每tick调用
     void tick();
     
@@ -363,6 +609,7 @@ public:
         std::atomic<uint64_t> cacheHits{0};
         std::atomic<uint64_t> simdOperations{0};
         std::atomic<uint64_t> asyncTasks{0};
+        std::atomic<uint64_t> asyncTasksDropped{0};
         std::atomic<uint64_t> entitiesProcessed{0};
         std::atomic<double> averageQueryTimeNs{0};
     };
@@ -376,28 +623,61 @@ public:
     void setPredictiveLoading(bool enabled) { predictiveLoading_ = enabled; }
     void setPriorityScheduling(bool enabled) { priorityScheduling_ = enabled; }
     
+    // 切换细粒度索引；已有实体按当前位置重建到新索引中
+    void setSpatialIndexType(SpatialIndexType type);
+    SpatialIndexType getSpatialIndexType() const { return indexType_; }
+    
     // 统计信息
     size_t getEntityCount() const { return entities_.size(); }
+    
+    // 实体SoA存储（只读，调用者需自行保证没有并发修改）
+    const EntityStore& getEntityStore() const { return entities_; }
     size_t getActiveRegionCount() const;
     
+    // 玩家移动预测（供区块预取使用）；非玩家实体返回nullptr
+    const PlayerPredictor* getPlayerPredictor(int id) const {
+        auto it = playerPredictors_.find(id);
+        return it != playerPredictors_.end() ? &it->second : nullptr;
+    }
+    
 private:
-    // 1. 粗粒度：32x32区域网格
+    // 1. 空间索引：QUAD_TREE使用32x32区域网格 + 区域内四叉树，LOOSE_GRID使用松散网格
     std::unordered_map<int, std::unordered_map<int, Region>> regions_;
+    LooseGrid<GRID_CELL_SIZE> grid_;
+    SpatialIndexType indexType_ = SpatialIndexType::LOOSE_GRID;
     
-    // 2. 实体数据（内存池分配）
-    std::unordered_map<int, EnhancedEntity> entities_;
+    // 2. 实体数据（SoA稠密数组 + id到slot的映射）
+    EntityStore entities_;
     
     // 3. 玩家预测器缓存
     std::unordered_map<int, PlayerPredictor> playerPredictors_;
     
-    // 4. 热点缓存
-    std::vector<QueryCache> queryCache_;
+    // 4. 按观察者所在区域缓存的候选集；只在实体跨区域时失效
+    CellQueryCache queryCache_;
     
     // 5. 内存池（复用设计）
     std::unique_ptr<MemoryArena> memoryPool_;
     
     // 6. 异步同步
-    std::unique_ptr<AsyncEntitySync> asyncSync_;
+    std::shared_ptr<AsyncEntitySync> asyncSync_;
+    
+    // 7. 每个观察者已追踪的实体集合
+    ViewerTrackedSets trackedSets_;
+    
+    // 8. 按LOD调度的位置同步，以及各观察者客户端已知的位置（数据包增量编码）
+    LODSyncScheduler syncScheduler_;
+    net::EntityMoveEncoder moveEncoder_;
+    
+    // 9. 视锥/遮挡剔除
+    struct ViewerView {
+        float yaw{0.0f}, pitch{0.0f};
+        float committedYaw{0.0f}, committedPitch{0.0f};   // 上次重算可见集时的朝向
+        std::vector<int> hidden;                          // 被剔除但仍在追踪的实体（升序）
+    };
+    ViewCuller culler_;
+    bool cullingEnabled_ = false;
+    std::unordered_map<int, ViewerView> viewerViews_;
+    uint64_t culledEntities_ = 0;
     
     // 配置参数
     float viewDistance_ = MAX_VIEW_DISTANCE;
@@ -415,20 +695,38 @@ private:
     // 线程安全
     mutable std::shared_mutex rwMutex_;
     
+    // native内存预算：每tick按实体数与查询缓存大小更新，超出TRACKER预算时清空查询缓存
+    core::MemoryCharge memory_{core::MemorySubsystem::TRACKER};
+    uint64_t shedderId_ = 0;
+    
     // 辅助方法
     void addToRegion(int entityId, const Position& pos);
     void removeFromRegion(int entityId, const Position& pos);
     Region* getOrCreateRegion(int chunkX, int chunkZ);
     
+    std::vector<LODSyncScheduler::Update> collectSyncUpdatesLocked(int viewerId, const Position& viewerPos);
+    
     // 查询方法
-    std::vector<int> queryCurrentView(const Position& viewerPos, float viewDistance);
-    std::vector<int> queryPredictedView(const Position& predictedPos, float viewDistance);
-    void mergeQueryResults(const std::vector<int>& currentView, 
-                          const std::vector<int>& predictedView,
-                          std::vector<int>& result);
-    
-    // SIMD加速
-    void calculateDistancesSIMD(const std::vector<EnhancedEntity*>& candidates,
+    std::vector<int> computeVisibleLocked(int viewerId, const Position& viewerPos, float viewDistance,
+                                          std::vector<ViewerTrackedSets::CellKey>* cells);
+    void markRegionChanged(const Position& pos);
+    ViewerView* cullingViewFor(int viewerId);
+    void cullHiddenLocked(int viewerId, ViewerView& view, const Position& viewerPos, std::vector<int>& result);
+    void collectQueryCells(const Position& center, float viewDistance,
+                           std::vector<ViewerTrackedSets::CellKey>& cells) const;
+    // 查询的中间结果只活到本次查询结束，来自帧分配器
+    core::FrameVector<int> queryCurrentView(const Position& viewerPos, float viewDistance);
+    core::FrameVector<int> queryPredictedView(const Position& predictedPos, float viewDistance);
+    core::FrameVector<int> queryCachedView(const Position& center, float viewDistance);
+    std::vector<int> gatherRegionMembers(int chunkX, int chunkZ, int reach) const;
+    void markMembershipChanged(const Position& pos);
+    void markSwapRemoval(uint32_t slot);
+    // 预测视野中不在当前视野里的实体追加到currentView末尾
+    void mergeQueryResults(core::FrameVector<int>& currentView,
+                          const core::FrameVector<int>& predictedView);
+    
+    // SIMD加速：candidates为实体id，换算成slot后按SoA数组计算
+    void calculateDistancesSIMD(const core::FrameVector<int>& candidates,
                               const Position& viewerPos,
                               float maxDistSq,
                               std::vector<int>& result);
@@ -438,8 +736,8 @@ private:
     
     // 缓存管理
     void cleanupCache();
-    void addToCache(const Position& viewerPos, float viewDistance, const std::vector<int>& result);
-    const std::vector<int>* getFromCache(const Position& viewerPos, float viewDistance);
+    size_t estimateMemoryLocked() const;
+    size_t shedMemory(size_t bytes);
     
     // 清理
     void cleanupOldEntities();
@@ -459,9 +757,22 @@ extern "C" {
         static void shutdown();
         static void registerEntity(int entityId, float x, float y, float z, 
                                   float radius, uint8_t entityType);
+        static void unregisterEntity(int entityId);
         static void updateEntityPosition(int entityId, float x, float y, float z);
         static int* getVisibleEntities(int viewerId, float viewerX, float viewerY, 
                                       float viewerZ, float viewDistance, int* outCount);
+        static VisibilityDelta updateViewerVisibility(int viewerId, float viewerX, float viewerY,
+                                                      float viewerZ, float viewDistance);
+        static void removeViewer(int viewerId);
+        static std::vector<LODSyncScheduler::Update> collectSyncUpdates(int viewerId, float viewerX,
+                                                                        float viewerY, float viewerZ);
+        static void updateEntityRotation(int entityId, float yaw, float pitch, float headYaw, bool onGround);
+        static net::EntityMoveEncoder::EncodeResult encodeSyncUpdates(int viewerId, float viewerX, float viewerY,
+                                                                      float viewerZ, int compressionThreshold,
+                                                                      size_t maxBytes, std::vector<uint8_t>& out);
+        static void setMoveEncoderConfig(const net::EntityMoveEncoder::Config& config);
+        static void setViewerOrientation(int viewerId, float yaw, float pitch);
+        static void setOpaqueSections(int chunkX, int chunkZ, int minSectionY, uint64_t mask);
         static void tick();
         static void* compressEntityUpdates(const int* entityIds, int count, 
                                           size_t* compressedSize);
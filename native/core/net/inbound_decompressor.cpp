@@ -0,0 +1,174 @@
+#include "inbound_decompressor.hpp"
+#include "async_compressor.hpp"
+#include "native_compressor.hpp"
+
+#include <vector>
+
+namespace lattice {
+namespace net {
+
+InboundDecompressor::InboundDecompressor() : InboundDecompressor(Config()) {}
+
+InboundDecompressor::InboundDecompressor(const Config& config) : config_(config) {}
+
+InboundDecompressor& InboundDecompressor::global() {
+    static InboundDecompressor instance;
+    return instance;
+}
+
+void InboundDecompressor::configure(const Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+}
+
+InboundDecompressor::Config InboundDecompressor::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+InboundDecompressor::Status InboundDecompressor::inflate(const uint8_t* src, size_t srcSize, uint8_t* dst,
+                                                         size_t declaredSize) {
+    try {
+        // 输出空间只开放声明长度：解出更多时libdeflate返回空间不足，不会越界写入
+        NativeCompressor* compressor = NativeCompressor::forThread(6);
+        if (!compressor) {
+            return Status::CORRUPT;
+        }
+        const size_t inflated = compressor->decompressZlib(reinterpret_cast<const char*>(src), srcSize,
+                                                           reinterpret_cast<char*>(dst), declaredSize);
+        return inflated == declaredSize ? Status::OK : Status::CORRUPT;
+    } catch (...) {
+        return Status::CORRUPT;
+    }
+}
+
+std::shared_ptr<InboundDecompressor::Connection> InboundDecompressor::connectionFor(uint64_t connectionId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& connection = connections_[connectionId];
+    if (!connection) {
+        connection = std::make_shared<Connection>();
+    }
+    return connection;
+}
+
+InboundDecompressor::Status InboundDecompressor::submit(uint64_t connectionId, const uint8_t* src, size_t srcSize,
+                                                        size_t declaredSize, uint8_t* dst, size_t dstCapacity,
+                                                        Completion completion, Submitted* submitted) {
+    if (!src || !dst || srcSize == 0 || declaredSize == 0 || !completion) {
+        return Status::INVALID_ARGUMENT;
+    }
+    const Config config = getConfig();
+    if (declaredSize > config.maxDeclaredSize || declaredSize > dstCapacity) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return Status::TOO_LARGE;
+    }
+
+    std::shared_ptr<Connection> connection = connectionFor(connectionId);
+    uint64_t sequence;
+    bool idle;
+    {
+        std::lock_guard<std::mutex> lock(connection->mutex);
+        sequence = connection->nextSequence++;
+        idle = connection->nextDelivery == sequence && !connection->delivering;
+    }
+
+    const bool small = declaredSize < config.asyncThreshold;
+    if (small) {
+        // 小包解压本身很快：排在未完成的大包之后时也在调用线程上解压，只是推迟交付
+        inlined_.fetch_add(1, std::memory_order_relaxed);
+        Packet packet{inflate(src, srcSize, dst, declaredSize), std::move(completion)};
+        const bool delivered = complete(*connection, sequence, std::move(packet));
+        if (submitted) {
+            *submitted = idle && delivered ? Submitted::DELIVERED : Submitted::QUEUED;
+        }
+        return Status::OK;
+    }
+
+    async_.fetch_add(1, std::memory_order_relaxed);
+    auto input = std::make_shared<std::vector<uint8_t>>(src, src + srcSize);
+    AsyncCompressor::getInstance().submit(
+        [this, connection, sequence, input, dst, declaredSize, completion = std::move(completion)]() mutable {
+            const Status status = inflate(input->data(), input->size(), dst, declaredSize);
+            if (status == Status::OK) {
+                asyncBytes_.fetch_add(declaredSize, std::memory_order_relaxed);
+            }
+            input.reset();
+            complete(*connection, sequence, Packet{status, std::move(completion)});
+        });
+    if (submitted) {
+        *submitted = Submitted::QUEUED;
+    }
+    return Status::OK;
+}
+
+bool InboundDecompressor::complete(Connection& connection, uint64_t sequence, Packet packet) {
+    std::unique_lock<std::mutex> lock(connection.mutex);
+    if (sequence != connection.nextDelivery) {
+        reordered_.fetch_add(1, std::memory_order_relaxed);
+    }
+    connection.completed.emplace(sequence, std::move(packet));
+    if (connection.delivering) {
+        // 正在交付的线程会接着交付这个包
+        return false;
+    }
+
+    connection.delivering = true;
+    bool deliveredOwn = false;
+    for (;;) {
+        auto it = connection.completed.find(connection.nextDelivery);
+        if (it == connection.completed.end()) {
+            break;
+        }
+        Packet ready = std::move(it->second);
+        connection.completed.erase(it);
+        deliveredOwn |= connection.nextDelivery == sequence;
+        ++connection.nextDelivery;
+        if (connection.closed) {
+            ready.status = Status::CANCELLED;
+        }
+        lock.unlock();
+
+        switch (ready.status) {
+            case Status::CORRUPT: corrupt_.fetch_add(1, std::memory_order_relaxed); break;
+            case Status::CANCELLED: cancelled_.fetch_add(1, std::memory_order_relaxed); break;
+            default: break;
+        }
+        ready.completion(ready.status);
+        lock.lock();
+    }
+    connection.delivering = false;
+    return deliveredOwn;
+}
+
+void InboundDecompressor::removeConnection(uint64_t connectionId) {
+    std::shared_ptr<Connection> connection;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = connections_.find(connectionId);
+        if (it == connections_.end()) {
+            return;
+        }
+        connection = std::move(it->second);
+        connections_.erase(it);
+    }
+    // 进行中的任务持有Connection，完成后按序以CANCELLED交付
+    std::lock_guard<std::mutex> lock(connection->mutex);
+    connection->closed = true;
+}
+
+InboundDecompressor::Stats InboundDecompressor::getStats() const {
+    Stats stats;
+    stats.inlined = inlined_.load(std::memory_order_relaxed);
+    stats.async = async_.load(std::memory_order_relaxed);
+    stats.reordered = reordered_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.corrupt = corrupt_.load(std::memory_order_relaxed);
+    stats.cancelled = cancelled_.load(std::memory_order_relaxed);
+    stats.asyncBytes = asyncBytes_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.connections = connections_.size();
+    return stats;
+}
+
+} // namespace net
+} // namespace lattice
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace lattice {
+namespace net {
+
+/**
+ * InboundDecompressor - 入站数据包的异步解压（按连接保序交付）
+ *
+ * 入站包原本在Netty线程上逐个同步解压；书本编辑、创造模式物品栏、插件消息这类大包
+ * 会让一个服务几十名玩家的事件循环停顿。这里按包声明的未压缩长度分流：
+ * - 小于asyncThreshold且该连接没有未交付的包时，在调用线程直接解压并交付
+ * - 其余的复制输入后交给AsyncCompressor的工作窃取线程池解压
+ * 同一连接的包按提交顺序交付（小包排在仍未完成的大包之后），不同连接之间互不等待。
+ *
+ * 解压炸弹：声明长度超过maxDeclaredSize时直接拒绝；输出缓冲区只开放声明长度，
+ * 数据解出更多或更少都按失败处理（与原版"Badly compressed packet"检查相同）。
+ *
+ * 完成回调在解压它的线程上（或调用线程上）执行，同一连接的回调不会并发。
+ * 线程安全：所有方法都可以从任意线程调用。
+ */
+class InboundDecompressor {
+public:
+    struct Config {
+        size_t asyncThreshold = 32 * 1024;         // 声明长度不小于该值的包异步解压
+        size_t maxDeclaredSize = 8 * 1024 * 1024;   // 原版服务端接受的最大未压缩长度（2^23）
+    };
+
+    enum class Status : int32_t {
+        OK = 0,
+        CORRUPT = -1,               // zlib数据损坏或解出的长度与声明不符
+        TOO_LARGE = -2,             // 声明长度超过maxDeclaredSize或输出缓冲区
+        CANCELLED = -3,             // 交付前连接已被移除
+        INVALID_ARGUMENT = -4
+    };
+
+    // 解压完成：status为OK时dst的前declaredSize字节为解压结果
+    using Completion = std::function<void(Status status)>;
+
+    enum class Submitted : int32_t {
+        DELIVERED = 0,              // 已在调用线程上交付（回调已执行）
+        QUEUED = 1                  // 异步解压或排在未完成的包之后
+    };
+
+    struct Stats {
+        uint64_t inlined{0};          // 在调用线程上解压
+        uint64_t async{0};
+        uint64_t reordered{0};        // 先完成但等待前面的包交付
+        uint64_t rejected{0};         // 声明长度过大
+        uint64_t corrupt{0};
+        uint64_t cancelled{0};
+        uint64_t asyncBytes{0};       // 异步解压的输出字节数
+        size_t connections{0};
+    };
+
+    InboundDecompressor();
+    explicit InboundDecompressor(const Config& config);
+
+    InboundDecompressor(const InboundDecompressor&) = delete;
+    InboundDecompressor& operator=(const InboundDecompressor&) = delete;
+
+    static InboundDecompressor& global();
+
+    void configure(const Config& config);
+    Config getConfig() const;
+
+    /**
+     * 提交connectionId的一个入站包：src为zlib数据（调用返回后即可释放），
+     * 解压到dst（容量dstCapacity，交付前必须保持有效）
+     * 参数无效或声明长度被拒绝时不调用回调，直接返回INVALID_ARGUMENT / TOO_LARGE；返回OK时回调恰好执行一次
+     * （submitted为QUEUED时回调也可能在返回前就已执行）
+     */
+    Status submit(uint64_t connectionId, const uint8_t* src, size_t srcSize, size_t declaredSize,
+                  uint8_t* dst, size_t dstCapacity, Completion completion, Submitted* submitted = nullptr);
+
+    // 连接关闭：之后完成的包以CANCELLED交付（仍然保序，回调中释放资源）
+    void removeConnection(uint64_t connectionId);
+
+    Stats getStats() const;
+
+private:
+    struct Packet {
+        Status status{Status::OK};
+        Completion completion;
+    };
+
+    struct Connection {
+        std::mutex mutex;
+        uint64_t nextSequence{0};                // 下一个提交的序号
+        uint64_t nextDelivery{0};                // 下一个应交付的序号
+        std::map<uint64_t, Packet> completed;    // 已完成、等待前面的包交付
+        bool delivering{false};                  // 某个线程正在按序交付
+        bool closed{false};
+    };
+
+    static Status inflate(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t declaredSize);
+
+    std::shared_ptr<Connection> connectionFor(uint64_t connectionId);
+    // 记录sequence的结果并交付所有已就绪的包（同一连接只有一个线程在交付），返回sequence是否由本次调用交付
+    bool complete(Connection& connection, uint64_t sequence, Packet packet);
+
+    mutable std::mutex mutex_;
+    Config config_;
+    std::unordered_map<uint64_t, std::shared_ptr<Connection>> connections_;
+
+    std::atomic<uint64_t> inlined_{0};
+    std::atomic<uint64_t> async_{0};
+    std::atomic<uint64_t> reordered_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> corrupt_{0};
+    std::atomic<uint64_t> cancelled_{0};
+    std::atomic<uint64_t> asyncBytes_{0};
+};
+
+} // namespace net
+} // namespace lattice
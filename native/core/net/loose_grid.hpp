@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace entity {
+
+/**
+ * LooseGrid - 水平面(x, z)上的松散均匀网格
+ *
+ * 每个格子边长CELL_SIZE，实体插入时按位置归入所在格子（"主格子"）。
+ * 之后只要实体没有离开主格子向外扩展LOOSENESS的松散边界，移动只更新格子内存放的坐标，O(1)；
+ * 越过松散边界时才从原格子交换删除、放入新位置所在的格子。
+ * 在格子边界附近来回走动的实体因此不会每tick在两个格子之间搬移。
+ *
+ * 半径查询扫描覆盖[center - range - LOOSENESS, center + range + LOOSENESS]的格子，
+ * 格子内的坐标连续存放（SoA），逐个做精确的水平距离检查，结果不含范围外的实体。
+ *
+ * 不依赖具体的Position类型；非线程安全，由所属追踪器的锁保护。
+ */
+template<int CELL_SIZE, int LOOSENESS = CELL_SIZE / 2>
+class LooseGrid {
+    static_assert(CELL_SIZE > 0, "CELL_SIZE must be positive");
+    static_assert(LOOSENESS >= 0 && LOOSENESS <= CELL_SIZE, "LOOSENESS must be within [0, CELL_SIZE]");
+
+public:
+    using CellKey = uint64_t;
+
+    static constexpr int cellSize() { return CELL_SIZE; }
+
+    static int cellCoord(float value) {
+        return static_cast<int>(std::floor(value / CELL_SIZE));
+    }
+
+    static CellKey makeKey(int cellX, int cellZ) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(cellX)) << 32 | static_cast<uint32_t>(cellZ);
+    }
+
+    // 插入或覆盖
+    void insert(int id, float x, float z) {
+        auto it = locations_.find(id);
+        if (it != locations_.end()) {
+            detach(it->second);
+            locations_.erase(it);
+        }
+        attach(id, x, z);
+    }
+
+    /**
+     * 移动实体；实体不存在时返回false
+     * 仍在主格子的松散边界内时只更新坐标
+     */
+    bool move(int id, float x, float z) {
+        auto it = locations_.find(id);
+        if (it == locations_.end()) {
+            return false;
+        }
+        Location& location = it->second;
+        if (withinLooseBounds(location, x, z)) {
+            Cell& cell = *location.cell;
+            cell.xs[location.index] = x;
+            cell.zs[location.index] = z;
+            return true;
+        }
+        ++relocations_;
+        detach(location);
+        locations_.erase(it);
+        attach(id, x, z);
+        return true;
+    }
+
+    void remove(int id) {
+        auto it = locations_.find(id);
+        if (it == locations_.end()) {
+            return;
+        }
+        detach(it->second);
+        locations_.erase(it);
+    }
+
+    // 水平距离不超过range的实体追加到out（std::vector<int>或帧分配的FrameVector<int>）
+    template <typename Out>
+    void queryRange(float x, float z, float range, Out& out) const {
+        const float rangeSq = range * range;
+        const float reach = range + LOOSENESS;
+        const int minX = cellCoord(x - reach);
+        const int maxX = cellCoord(x + reach);
+        const int minZ = cellCoord(z - reach);
+        const int maxZ = cellCoord(z + reach);
+
+        for (int cellX = minX; cellX <= maxX; cellX++) {
+            for (int cellZ = minZ; cellZ <= maxZ; cellZ++) {
+                auto it = cells_.find(makeKey(cellX, cellZ));
+                if (it == cells_.end()) {
+                    continue;
+                }
+                const Cell& cell = it->second;
+                const size_t count = cell.ids.size();
+                for (size_t i = 0; i < count; i++) {
+                    const float dx = cell.xs[i] - x;
+                    const float dz = cell.zs[i] - z;
+                    if (dx * dx + dz * dz <= rangeSq) {
+                        out.push_back(cell.ids[i]);
+                    }
+                }
+            }
+        }
+    }
+
+    void clear() {
+        cells_.clear();
+        locations_.clear();
+    }
+
+    bool contains(int id) const { return locations_.count(id) != 0; }
+    size_t size() const { return locations_.size(); }
+    size_t cellCount() const { return cells_.size(); }
+    uint64_t relocations() const { return relocations_; }
+
+private:
+    struct Cell {
+        int cellX;
+        int cellZ;
+        std::vector<int> ids;
+        std::vector<float> xs;
+        std::vector<float> zs;
+    };
+
+    struct Location {
+        Cell* cell;                    // unordered_map的节点地址在rehash时不变
+        uint32_t index;
+    };
+
+    bool withinLooseBounds(const Location& location, float x, float z) const {
+        const float minX = static_cast<float>(location.cell->cellX) * CELL_SIZE - LOOSENESS;
+        const float minZ = static_cast<float>(location.cell->cellZ) * CELL_SIZE - LOOSENESS;
+        constexpr float extent = static_cast<float>(CELL_SIZE + 2 * LOOSENESS);
+        return x >= minX && x < minX + extent && z >= minZ && z < minZ + extent;
+    }
+
+    void attach(int id, float x, float z) {
+        const int cellX = cellCoord(x);
+        const int cellZ = cellCoord(z);
+        auto [it, inserted] = cells_.try_emplace(makeKey(cellX, cellZ));
+        Cell& cell = it->second;
+        if (inserted) {
+            cell.cellX = cellX;
+            cell.cellZ = cellZ;
+        }
+        locations_[id] = Location{&cell, static_cast<uint32_t>(cell.ids.size())};
+        cell.ids.push_back(id);
+        cell.xs.push_back(x);
+        cell.zs.push_back(z);
+    }
+
+    // 交换删除：末尾实体移到空出的位置并更新其下标；格子空了就删除
+    void detach(const Location& location) {
+        Cell& cell = *location.cell;
+        const uint32_t index = location.index;
+        const uint32_t last = static_cast<uint32_t>(cell.ids.size() - 1);
+        if (index != last) {
+            cell.ids[index] = cell.ids[last];
+            cell.xs[index] = cell.xs[last];
+            cell.zs[index] = cell.zs[last];
+            locations_[cell.ids[index]].index = index;
+        }
+        cell.ids.pop_back();
+        cell.xs.pop_back();
+        cell.zs.pop_back();
+        if (cell.ids.empty()) {
+            cells_.erase(makeKey(cell.cellX, cell.cellZ));
+        }
+    }
+
+    std::unordered_map<CellKey, Cell> cells_;
+    std::unordered_map<int, Location> locations_;
+    uint64_t relocations_ = 0;
+};
+
+} // namespace entity
+} // namespace lattice
@@ -29,7 +29,7 @@ MemoryArena::ThreadBlocks& MemoryArena::getThreadBlocks() {
 std::unique_ptr<MemoryArena::MemoryBlock> MemoryArena::createNewBlock(size_t blockSize) {
     try {
         auto block = std::make_unique<MemoryBlock>(blockSize);
-        global_total_allocated_.fetch_add(blockSize, std::memory_order_relaxed);
+        global_total_allocated_.fetch_add(block->getTotalSize(), std::memory_order_relaxed);
         return block;
     } catch (const std::bad_alloc&) {
         return nullptr;
@@ -119,6 +119,7 @@ void* MemoryArena::allocate(size_t size) {
 // 释放整个arena
 void MemoryArena::clear() {
     auto& blocks = getThreadBlocks();
+    ++current_thread_generation_;
     
     // 统计要释放的内存
     size_t freedSize = 0;
@@ -136,6 +137,48 @@ void MemoryArena::clear() {
     global_total_used_.fetch_sub(freedSize, std::memory_order_relaxed);
 }
 
+// 记录检查点
+MemoryArena::Checkpoint MemoryArena::checkpoint() {
+    Checkpoint checkpoint;
+    checkpoint.generation = current_thread_generation_;
+    if (current_thread_blocks_) {
+        const auto& blocks = *current_thread_blocks_;
+        checkpoint.block_count = std::min(blocks.size(), MAX_BLOCKS_PER_THREAD);
+        for (size_t i = 0; i < checkpoint.block_count; ++i) {
+            checkpoint.used[i] = blocks[i]->used;
+        }
+    }
+    return checkpoint;
+}
+
+// 退回到检查点
+void MemoryArena::rewind(const Checkpoint& checkpoint) {
+    if (!current_thread_blocks_ || checkpoint.generation != current_thread_generation_) {
+        return;
+    }
+    
+    // 检查点之后的分配可能落在任何一个有剩余空间的块里，逐块恢复
+    size_t released = 0;
+    auto& blocks = *current_thread_blocks_;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        MemoryBlock& block = *blocks[i];
+        const size_t target = i < checkpoint.block_count ? checkpoint.used[i] : 0;
+        if (block.used > target) {
+            released += block.used - target;
+            block.used = target;
+            block.remaining = block.size - target;
+        }
+    }
+    global_total_used_.fetch_sub(released, std::memory_order_relaxed);
+}
+
+// 退回所有分配，保留块
+void MemoryArena::reset() {
+    Checkpoint empty;
+    empty.generation = current_thread_generation_;
+    rewind(empty);
+}
+
 // 获取内存使用统计
 MemoryArena::MemoryStats MemoryArena::getMemoryStats() const {
     MemoryStats stats;
@@ -194,6 +237,7 @@ void MemoryArena::clearCurrentThread() {
         global_thread_count_.fetch_sub(1, std::memory_order_relaxed);
         
         // 清理线程局部存储
+        ++current_thread_generation_;
         delete current_thread_blocks_;
         current_thread_blocks_ = nullptr;
         
@@ -9,6 +9,8 @@
 #include <concepts>
 #include <cstdlib>
 
+#include "arena_page_allocator.hpp"
+
 namespace lattice {
 namespace net {
 
@@ -21,6 +23,7 @@ namespace net {
  * - 16字节对齐：SIMD友好，优化缓存访问
  * - 内存零拷贝：直接从arena分配内存，避免malloc/free开销
  * - 自动扩缩容：根据使用情况动态调整块数量
+ * - 可选大页 / NUMA：块的内存来源由ArenaPageAllocator的策略决定（默认aligned_alloc）
  */
 class MemoryArena {
 public:
@@ -35,19 +38,20 @@ public:
         size_t size;
         size_t used;
         size_t remaining;
+        ArenaPageAllocator::Allocation allocation;
         
         MemoryBlock(size_t blockSize) 
-            : size(blockSize), used(0), remaining(blockSize) {
-            // 使用aligned_alloc确保16字节对齐
-            ptr = std::aligned_alloc(DEFAULT_ALIGNMENT, blockSize);
-            if (!ptr) {
-                throw std::bad_alloc();
-            }
+            : used(0) {
+            // 至少16字节对齐；大页策略下来自2MB slab，单独映射时size按2MB取整
+            allocation = ArenaPageAllocator::instance().allocate(blockSize, DEFAULT_ALIGNMENT);
+            ptr = allocation.ptr;
+            size = allocation.size;
+            remaining = size;
         }
         
         ~MemoryBlock() {
             if (ptr) {
-                std::free(ptr);
+                ArenaPageAllocator::instance().release(allocation);
                 ptr = nullptr;
             }
         }
@@ -139,6 +143,25 @@ public:
      */
     void clear();
     
+    /**
+     * 检查点：记录当前线程各块的分配位置
+     * rewind()把之后的分配整体退回，块本身保留给后续分配，不释放也不重新申请。
+     * 检查点之后调用过clear()时rewind()不做任何事。通常通过ArenaScope使用。
+     */
+    struct Checkpoint {
+        uint64_t generation{0};
+        size_t block_count{0};
+        size_t used[MAX_BLOCKS_PER_THREAD]{};
+    };
+    
+    Checkpoint checkpoint();
+    void rewind(const Checkpoint& checkpoint);
+    
+    /**
+     * 退回所有块的分配但保留块（相当于rewind到空arena）
+     */
+    void reset();
+    
     /**
      * 获取内存使用统计
      */
@@ -171,6 +194,8 @@ public:
 private:
     // 线程局部存储
     thread_local static inline ThreadBlocks* current_thread_blocks_ = nullptr;
+    // clear()时递增，使之前的检查点失效
+    thread_local static inline uint64_t current_thread_generation_ = 0;
     
     // 全局锁用于管理全局统计
     static std::atomic<size_t> global_total_allocated_;
@@ -190,6 +215,31 @@ private:
     MemoryStats calculateThreadStats(const ThreadBlocks& blocks) const;
 };
 
+/**
+ * ArenaScope - RAII检查点，离开作用域时退回其间的所有arena分配
+ * 用于每个数据包 / 区块的临时分配；可以嵌套，必须在创建它的线程上析构
+ *
+ *   {
+ *       ArenaScope scope;
+ *       auto result = compressor.compressZlibArena(data, size);
+ *       send(result.getData(), result.compressed_size);
+ *   }   // result的内存在这里退回
+ */
+class ArenaScope {
+public:
+    explicit ArenaScope(MemoryArena& arena = MemoryArena::forThread())
+        : arena_(arena), checkpoint_(arena.checkpoint()) {}
+    
+    ~ArenaScope() { arena_.rewind(checkpoint_); }
+    
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    
+private:
+    MemoryArena& arena_;
+    MemoryArena::Checkpoint checkpoint_;
+};
+
 /**
  * ArenaScopedPtr - RAII包装器，自动管理arena分配的内存
  */
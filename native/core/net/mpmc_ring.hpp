@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace lattice {
+namespace net {
+
+/**
+ * MPMCRing - 有界多生产者多消费者环形队列（Vyukov）
+ *
+ * 容量固定（向上取整为2的幂），构造时一次性分配，之后入队出队都不分配内存。
+ * 每个槽位带一个序号：sequence == pos表示可写，sequence == pos + 1表示可读，
+ * 生产者/消费者各自通过CAS推进enqueue_/dequeue_认领位置，认领后只写自己的槽位。
+ * 队列满时tryEnqueue返回false，由调用者决定丢弃、合并还是稍后重试（背压），不会无限增长。
+ *
+ * 批量接口一次CAS认领连续的一段位置，适合每tick成批提交/处理。
+ *
+ * 参考：Dmitry Vyukov, Bounded MPMC queue (1024cores.net)。
+ */
+template<typename T>
+class MPMCRing {
+    static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move constructible");
+
+public:
+    explicit MPMCRing(size_t capacity = 65536) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        slots_.reset(new Slot[size]);
+        for (size_t i = 0; i < size; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MPMCRing() {
+        T item;
+        while (tryDequeue(item)) {
+        }
+    }
+
+    MPMCRing(const MPMCRing&) = delete;
+    MPMCRing& operator=(const MPMCRing&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // 队列满时返回false
+    bool tryEnqueue(T item) {
+        size_t pos = enqueue_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & mask_];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.construct(std::move(item));
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // 队列为空时返回false
+    bool tryDequeue(T& out) {
+        size_t pos = dequeue_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & mask_];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = slot.take();
+                    slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * 批量入队items[0, count)，返回实际入队的数量（队列剩余空间不足时只入队前面一部分）
+     * 成功入队的元素被移走
+     */
+    size_t tryEnqueueBulk(T* items, size_t count) {
+        size_t accepted = 0;
+        while (accepted < count) {
+            size_t pos = enqueue_.load(std::memory_order_relaxed);
+            // 以当前出队位置估计空闲数；认领后逐个等待槽位可写
+            const size_t dequeued = dequeue_.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(pos - dequeued) < 0) {
+                // 读取pos之后其他生产者入队、消费者又出队越过了它：pos已过期，重新读取（否则差值下溢被当成队列满）
+                continue;
+            }
+            const size_t used = pos - dequeued;
+            if (used > mask_) {
+                break;
+            }
+            const size_t want = std::min(count - accepted, mask_ + 1 - used);
+            // 第一个槽位必须可写，否则队列实际已满
+            const size_t sequence = slots_[pos & mask_].sequence.load(std::memory_order_acquire);
+            if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos) < 0) {
+                break;
+            }
+            if (sequence != pos) {
+                continue;
+            }
+            if (!claimRange(pos, want)) {
+                continue;
+            }
+            for (size_t i = 0; i < want; ++i) {
+                Slot& slot = slots_[(pos + i) & mask_];
+                // 消费者可能还没释放这个槽位（出队位置估计过期），短暂等待
+                while (slot.sequence.load(std::memory_order_acquire) != pos + i) {
+                    std::this_thread::yield();
+                }
+                slot.construct(std::move(items[accepted + i]));
+                slot.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            accepted += want;
+        }
+        return accepted;
+    }
+
+    // 批量出队最多maxCount个元素到out，返回出队的数量
+    size_t tryDequeueBulk(T* out, size_t maxCount) {
+        size_t taken = 0;
+        while (taken < maxCount) {
+            size_t pos = dequeue_.load(std::memory_order_relaxed);
+            const size_t available = enqueue_.load(std::memory_order_acquire) - pos;
+            if (available == 0 || available > mask_ + 1) {
+                break;
+            }
+            const size_t want = std::min(maxCount - taken, available);
+            if (!dequeue_.compare_exchange_weak(pos, pos + want, std::memory_order_relaxed)) {
+                continue;
+            }
+            for (size_t i = 0; i < want; ++i) {
+                Slot& slot = slots_[(pos + i) & mask_];
+                // 生产者已认领但可能尚未写完，短暂等待
+                while (slot.sequence.load(std::memory_order_acquire) != pos + i + 1) {
+                    std::this_thread::yield();
+                }
+                out[taken + i] = slot.take();
+                slot.sequence.store(pos + i + mask_ + 1, std::memory_order_release);
+            }
+            taken += want;
+        }
+        return taken;
+    }
+
+    // 近似值（并发修改时可能过期）
+    size_t sizeApprox() const {
+        const size_t enqueued = enqueue_.load(std::memory_order_relaxed);
+        const size_t dequeued = dequeue_.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        void construct(T&& item) { new (storage) T(std::move(item)); }
+
+        T take() {
+            T* item = std::launder(reinterpret_cast<T*>(storage));
+            T value(std::move(*item));
+            item->~T();
+            return value;
+        }
+    };
+
+    bool claimRange(size_t& pos, size_t count) {
+        return enqueue_.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_ = 0;
+
+    // 生产者与消费者的位置放在不同缓存行
+    alignas(64) std::atomic<size_t> enqueue_{0};
+    alignas(64) std::atomic<size_t> dequeue_{0};
+};
+
+} // namespace net
+} // namespace lattice
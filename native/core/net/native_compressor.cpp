@@ -1,7 +1,11 @@
 #include "native_compressor.hpp"
+#include "compression_skip_policy.hpp"
+#include "../metrics.hpp"
+#include "../tracing.hpp"
 #include <stdexcept>
 #include <chrono>
 #include <algorithm>
+#include <array>
 #include <iostream>
 #include <cstdio>
 #include <cstring>
@@ -14,10 +18,7 @@ NativeCompressor::NativeCompressor(int compressionLevel)
     : deflate_compressor_(nullptr), deflate_decompressor_(nullptr), compressionLevel_(compressionLevel)
 {
     // Initialize libdeflate contexts
-    deflate_compressor_ = libdeflate_alloc_compressor(compressionLevel);
-    if (!deflate_compressor_) {
-        throw std::runtime_error("Failed to create libdeflate compressor");
-    }
+    deflate_compressor_ = compressorForLevel(compressionLevel);
 
     deflate_decompressor_ = libdeflate_alloc_decompressor();
     if (!deflate_decompressor_) {
@@ -27,16 +28,153 @@ NativeCompressor::NativeCompressor(int compressionLevel)
 }
 
 NativeCompressor::~NativeCompressor() {
-    if (deflate_compressor_) libdeflate_free_compressor(deflate_compressor_);
+    for (auto* compressor : deflate_compressors_) {
+        if (compressor) libdeflate_free_compressor(compressor);
+    }
     if (deflate_decompressor_) libdeflate_free_decompressor(deflate_decompressor_);
 }
 
+struct libdeflate_compressor* NativeCompressor::compressorForLevel(int level) {
+    if (level < MIN_COMPRESSION_LEVEL || level > MAX_COMPRESSION_LEVEL) {
+        throw std::runtime_error("Invalid libdeflate compression level: " + std::to_string(level));
+    }
+    auto*& compressor = deflate_compressors_[static_cast<size_t>(level)];
+    if (!compressor) {
+        compressor = libdeflate_alloc_compressor(level);
+        if (!compressor) {
+            throw std::runtime_error("Failed to create libdeflate compressor");
+        }
+    }
+    return compressor;
+}
+
 // ====== 传统接口实现（保持向后兼容）======
+namespace {
+
+struct AtomicLevelStats {
+    std::atomic<uint64_t> compressions{0};
+    std::atomic<uint64_t> input_bytes{0};
+    std::atomic<uint64_t> output_bytes{0};
+    std::atomic<uint64_t> busy_nanos{0};
+};
+
+std::array<AtomicLevelStats, NativeCompressor::MAX_COMPRESSION_LEVEL + 1> g_level_stats;
+
+uint64_t elapsedNanos(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+// 进程级压缩指标（core/metrics.hpp），第一次压缩或解压时注册
+struct OperationMetrics {
+    core::Counter& operations;
+    core::Counter& inputBytes;
+    core::Counter& outputBytes;
+    core::Histogram& seconds;
+
+    explicit OperationMetrics(const char* operation)
+        : operations(core::MetricsRegistry::instance().counter(
+              "lattice_compression_operations_total", "zlib compress/decompress calls that succeeded",
+              {{"operation", operation}})),
+          inputBytes(core::MetricsRegistry::instance().counter(
+              "lattice_compression_input_bytes_total", "Bytes passed to zlib compress/decompress",
+              {{"operation", operation}})),
+          outputBytes(core::MetricsRegistry::instance().counter(
+              "lattice_compression_output_bytes_total", "Bytes produced by zlib compress/decompress",
+              {{"operation", operation}})),
+          seconds(core::MetricsRegistry::instance().histogram(
+              "lattice_compression_duration_seconds", "Time spent in one zlib compress/decompress call",
+              core::Histogram::latencyBuckets(), {{"operation", operation}})) {}
+
+    void record(size_t input, size_t output, uint64_t nanos) {
+        operations.inc();
+        inputBytes.inc(input);
+        outputBytes.inc(output);
+        seconds.observe(static_cast<double>(nanos) * 1e-9);
+    }
+};
+
+// 全局BufferCache的状态在snapshot时读取
+void registerBufferCacheMetrics() {
+    auto& registry = core::MetricsRegistry::instance();
+    auto cacheStat = [](auto field) {
+        return [field] {
+            return static_cast<double>(NativeCompressor::getGlobalBufferCache().getStats().*field);
+        };
+    };
+    using Stats = CompressBufferCache::CacheStats;
+    registry.addCallback(core::MetricType::GAUGE, "lattice_compress_buffer_cache_bytes",
+                         "Memory held by the compression buffer cache", {{"state", "allocated"}},
+                         cacheStat(&Stats::total_memory_allocated));
+    registry.addCallback(core::MetricType::GAUGE, "lattice_compress_buffer_cache_bytes",
+                         "Memory held by the compression buffer cache", {{"state", "used"}},
+                         cacheStat(&Stats::total_memory_used));
+    registry.addCallback(core::MetricType::GAUGE, "lattice_compress_buffer_cache_bytes",
+                         "Memory held by the compression buffer cache", {{"state", "depot"}},
+                         cacheStat(&Stats::depot_bytes));
+    registry.addCallback(core::MetricType::COUNTER, "lattice_compress_buffer_cache_requests_total",
+                         "Compression buffer requests by cache result", {{"result", "hit"}},
+                         cacheStat(&Stats::cache_hits));
+    registry.addCallback(core::MetricType::COUNTER, "lattice_compress_buffer_cache_requests_total",
+                         "Compression buffer requests by cache result", {{"result", "miss"}},
+                         cacheStat(&Stats::cache_misses));
+    registry.addCallback(core::MetricType::COUNTER, "lattice_compress_buffer_cache_reclaimed_bytes_total",
+                         "Buffer memory released by the compression buffer cache", {},
+                         cacheStat(&Stats::memory_reclaimed));
+}
+
+OperationMetrics& compressMetrics() {
+    static OperationMetrics metrics("compress");
+    static const bool cacheRegistered = (registerBufferCacheMetrics(), true);
+    (void)cacheRegistered;
+    return metrics;
+}
+
+OperationMetrics& decompressMetrics() {
+    static OperationMetrics metrics("decompress");
+    return metrics;
+}
+
+} // namespace
+
 size_t NativeCompressor::compressZlib(const char* src, size_t srcLen, char* dst, size_t dstCapacity) {
-    return libdeflate_zlib_compress(deflate_compressor_, src, srcLen, dst, dstCapacity);
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::compressZlib");
+    const auto start = std::chrono::steady_clock::now();
+    const size_t result = libdeflate_zlib_compress(deflate_compressor_, src, srcLen, dst, dstCapacity);
+    if (result > 0) {
+        recordLevelStats(compressionLevel_, srcLen, result, elapsedNanos(start));
+    }
+    return result;
+}
+
+void NativeCompressor::recordLevelStats(int level, size_t inputBytes, size_t outputBytes, uint64_t nanos) {
+    if (level < MIN_COMPRESSION_LEVEL || level > MAX_COMPRESSION_LEVEL) {
+        return;
+    }
+    auto& stats = g_level_stats[level];
+    stats.compressions.fetch_add(1, std::memory_order_relaxed);
+    stats.input_bytes.fetch_add(inputBytes, std::memory_order_relaxed);
+    stats.output_bytes.fetch_add(outputBytes, std::memory_order_relaxed);
+    stats.busy_nanos.fetch_add(nanos, std::memory_order_relaxed);
+    compressMetrics().record(inputBytes, outputBytes, nanos);
+}
+
+NativeCompressor::LevelStats NativeCompressor::getLevelStats(int level) {
+    LevelStats stats;
+    if (level < MIN_COMPRESSION_LEVEL || level > MAX_COMPRESSION_LEVEL) {
+        return stats;
+    }
+    const auto& source = g_level_stats[level];
+    stats.compressions = source.compressions.load(std::memory_order_relaxed);
+    stats.input_bytes = source.input_bytes.load(std::memory_order_relaxed);
+    stats.output_bytes = source.output_bytes.load(std::memory_order_relaxed);
+    stats.busy_nanos = source.busy_nanos.load(std::memory_order_relaxed);
+    return stats;
 }
 
 size_t NativeCompressor::decompressZlib(const char* src, size_t srcLen, char* dst, size_t dstCapacity) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::decompressZlib");
+    const auto start = std::chrono::steady_clock::now();
     size_t actualOutSize;
     enum libdeflate_result result = libdeflate_zlib_decompress(
         deflate_decompressor_, src, srcLen, dst, dstCapacity, &actualOutSize);
@@ -45,28 +183,23 @@ size_t NativeCompressor::decompressZlib(const char* src, size_t srcLen, char* ds
         return 0; // Return 0 to indicate error
     }
     
+    decompressMetrics().record(srcLen, actualOutSize, elapsedNanos(start));
     return actualOutSize;
 }
 
 void NativeCompressor::setCompressionLevel(int level) {
+    // 先取压缩器：级别无效时保持原级别
+    deflate_compressor_ = compressorForLevel(level);
     compressionLevel_ = level;
-    
-    // We need to recreate the compressor with the new level
-    if (deflate_compressor_) {
-        libdeflate_free_compressor(deflate_compressor_);
-    }
-    
-    deflate_compressor_ = libdeflate_alloc_compressor(level);
-    if (!deflate_compressor_) {
-        throw std::runtime_error("Failed to create libdeflate compressor");
-    }
 }
 
 NativeCompressor* NativeCompressor::forThread(int compressionLevel) {
     thread_local static std::unique_ptr<NativeCompressor> instance = nullptr;
     
-    if (!instance || instance->compressionLevel_ != compressionLevel) {
+    if (!instance) {
         instance = std::make_unique<NativeCompressor>(compressionLevel);
+    } else if (instance->compressionLevel_ != compressionLevel) {
+        instance->setCompressionLevel(compressionLevel);
     }
     
     return instance.get();
@@ -92,6 +225,7 @@ void NativeCompressor::updateStats(size_t inputBytes, size_t outputBytes, double
 // Arena压缩实现
 NativeCompressor::ArenaCompressionResult NativeCompressor::compressZlibArena(
     const void* src, size_t srcLen, std::optional<int> preferredCompressionLevel) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::compressZlibArena");
     
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -109,6 +243,8 @@ NativeCompressor::ArenaCompressionResult NativeCompressor::compressZlibArena(
     
     // 预先获取Arena统计（压缩前）
     auto arenaStatsBefore = arena.getMemoryStats();
+    // 失败时退回本次分配的缓冲区
+    const auto checkpoint = arena.checkpoint();
     
     try {
         // 计算最优缓冲区大小
@@ -121,21 +257,19 @@ NativeCompressor::ArenaCompressionResult NativeCompressor::compressZlibArena(
         }
         
         // 执行压缩
+        const auto levelStart = std::chrono::steady_clock::now();
         size_t compressedSize;
         if (preferredCompressionLevel.has_value() && preferredCompressionLevel.value() != compressionLevel_) {
-            // 使用指定的压缩级别
-            struct libdeflate_compressor* temp_compressor = libdeflate_alloc_compressor(preferredCompressionLevel.value());
-            if (temp_compressor) {
-                compressedSize = libdeflate_zlib_compress(temp_compressor, src, srcLen, outputBuffer, optimalBufferSize);
-                libdeflate_free_compressor(temp_compressor);
-            } else {
-                return result;
-            }
+            // 使用指定的压缩级别（该级别的缓存压缩器，不改变当前级别）
+            compressedSize = libdeflate_zlib_compress(compressorForLevel(preferredCompressionLevel.value()),
+                                                      src, srcLen, outputBuffer, optimalBufferSize);
         } else {
             compressedSize = libdeflate_zlib_compress(deflate_compressor_, src, srcLen, outputBuffer, optimalBufferSize);
         }
         
         if (compressedSize > 0) {
+            recordLevelStats(preferredCompressionLevel.value_or(compressionLevel_), srcLen, compressedSize,
+                             elapsedNanos(levelStart));
             result.compressed_data = outputBuffer;
             result.compressed_size = compressedSize;
             
@@ -149,13 +283,13 @@ NativeCompressor::ArenaCompressionResult NativeCompressor::compressZlibArena(
             auto duration = std::chrono::duration<double, std::milli>(endTime - startTime).count();
             updateStats(srcLen, compressedSize, duration);
         } else {
-            // 压缩失败，但缓冲区仍被分配（arena中的内存）
-            // 这种情况下我们不返回错误，而是返回空结果
+            // 压缩失败：返回空结果，缓冲区退回arena
+            arena.rewind(checkpoint);
         }
         
     } catch (const std::exception&) {
         // 发生异常时，返回空结果
-        // Arena中的内存将自动清理
+        arena.rewind(checkpoint);
     }
     
     return result;
@@ -164,6 +298,7 @@ NativeCompressor::ArenaCompressionResult NativeCompressor::compressZlibArena(
 // Arena解压缩实现
 NativeCompressor::ArenaDecompressionResult NativeCompressor::decompressZlibArena(
     const void* compressedData, size_t compressedSize, std::optional<size_t> expectedOutputSize) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::decompressZlibArena");
     
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -181,6 +316,7 @@ NativeCompressor::ArenaDecompressionResult NativeCompressor::decompressZlibArena
     
     // 预先获取Arena统计
     auto arenaStatsBefore = arena.getMemoryStats();
+    const auto checkpoint = arena.checkpoint();
     
     try {
         // 估算输出大小（如果未提供）
@@ -224,14 +360,18 @@ NativeCompressor::ArenaDecompressionResult NativeCompressor::decompressZlibArena
                 stats_input_bytes_.fetch_add(compressedSize, std::memory_order_relaxed);
                 stats_output_bytes_.fetch_add(actualOutputSize, std::memory_order_relaxed);
                 stats_processing_time_ms_.fetch_add(duration, std::memory_order_relaxed);
+                decompressMetrics().record(compressedSize, actualOutputSize,
+                                           static_cast<uint64_t>(duration * 1e6));
                 
                 break; // 成功，解压缩完成
             }
-            // 如果失败，继续尝试更大的缓冲区
+            // 如果失败，退回这次的缓冲区，继续尝试更大的缓冲区
+            arena.rewind(checkpoint);
         }
         
     } catch (const std::exception&) {
         // 发生异常时，返回空结果
+        arena.rewind(checkpoint);
     }
     
     return result;
@@ -240,6 +380,7 @@ NativeCompressor::ArenaDecompressionResult NativeCompressor::decompressZlibArena
 // 批量压缩实现
 NativeCompressor::BatchCompressionResult NativeCompressor::compressBatchArena(
     const void* const* inputs, const size_t* inputSizes, size_t count) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::compressBatchArena");
     
     BatchCompressionResult result;
     
@@ -273,6 +414,7 @@ NativeCompressor::BatchDecompressionResult NativeCompressor::decompressBatchAren
     const size_t* compressedSizes,
     const std::optional<size_t>* expectedOutputSizes,
     size_t count) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::decompressBatchArena");
     
     BatchDecompressionResult result;
     
@@ -339,7 +481,8 @@ void NativeCompressor::resetCompressionStats() {
 
 // 智能压缩
 NativeCompressor::SmartCompressionResult NativeCompressor::compressZlibSmart(
-    const void* src, size_t srcLen, std::optional<int> preferredLevel) {
+    const void* src, size_t srcLen, std::optional<int> preferredLevel, int packetType) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::compressZlibSmart");
     
     (void)preferredLevel; // Unused parameter - using default compression level
     
@@ -352,6 +495,14 @@ NativeCompressor::SmartCompressionResult NativeCompressor::compressZlibSmart(
     result.memory_saved = 0;
     result.compression_time_ms = 0.0;
     result.source_buffer = nullptr;
+    result.skipped = false;
+    
+    // 已压缩或高熵的数据不经过deflate
+    auto& skipPolicy = CompressionSkipPolicy::global();
+    if (skipPolicy.decide(packetType, src, srcLen) != CompressionSkipPolicy::Decision::COMPRESS) {
+        result.skipped = true;
+        return result;
+    }
     
     try {
         // 获取全局BufferCache
@@ -379,6 +530,7 @@ NativeCompressor::SmartCompressionResult NativeCompressor::compressZlibSmart(
         }
         
         // 执行压缩
+        const auto levelStart = std::chrono::steady_clock::now();
         size_t actualSize = libdeflate_zlib_compress(
             deflate_compressor_, 
             static_cast<const char*>(src), srcLen,
@@ -390,6 +542,14 @@ NativeCompressor::SmartCompressionResult NativeCompressor::compressZlibSmart(
             return result;
         }
         
+        recordLevelStats(compressionLevel_, srcLen, actualSize, elapsedNanos(levelStart));
+        skipPolicy.record(packetType, srcLen, actualSize);
+        if (actualSize >= srcLen) {
+            // 压缩没有收益，按未压缩格式发送
+            result.skipped = true;
+            return result;
+        }
+        
         // 填充结果
         result.compressed_data = buffer->data;
         result.compressed_size = actualSize;
@@ -427,6 +587,7 @@ NativeCompressor::SmartCompressionResult NativeCompressor::compressZlibSmart(
 // 智能解压缩
 NativeCompressor::SmartDecompressionResult NativeCompressor::decompressZlibSmart(
     const void* compressedData, size_t compressedSize, std::optional<size_t> expectedOutputSize) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::decompressZlibSmart");
     
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -443,7 +604,7 @@ NativeCompressor::SmartDecompressionResult NativeCompressor::decompressZlibSmart
         
         // 估算输出大小（如果未提供）
         size_t outputSize = expectedOutputSize.value_or(compressedSize * 2);
-        auto* buffer = selectOptimalBuffer(outputSize);
+        auto* buffer = bufferCache.getBuffer(outputSize);
         
         if (!buffer) {
             std::cerr << "[NativeCompressor] Failed to get optimal buffer for decompression" << std::endl;
@@ -487,6 +648,7 @@ NativeCompressor::SmartDecompressionResult NativeCompressor::decompressZlibSmart
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
         result.decompression_time_ms = duration.count() / 1000.0;
+        decompressMetrics().record(compressedSize, actualSize, static_cast<uint64_t>(duration.count()) * 1000);
         
     } catch (const std::exception& e) {
         std::cerr << "[NativeCompressor] Smart decompression error: " << e.what() << std::endl;
@@ -498,6 +660,7 @@ NativeCompressor::SmartDecompressionResult NativeCompressor::decompressZlibSmart
 // 零拷贝压缩
 NativeCompressor::ZeroCopyCompressionResult NativeCompressor::compressZlibZeroCopy(
     const void* src, size_t srcLen, std::optional<int> preferredLevel) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::compressZlibZeroCopy");
     
     (void)preferredLevel; // Unused parameter - using default compression level
     
@@ -567,6 +730,10 @@ NativeCompressor::BufferCacheStats NativeCompressor::getBufferCacheStats() const
     stats.smart_compressions = stats_smart_compressions_.load(std::memory_order_relaxed);
     stats.zero_copy_compressions = stats_zero_copy_compressions_.load(std::memory_order_relaxed);
     stats.memory_saved_bytes = stats_memory_saved_bytes_.load(std::memory_order_relaxed);
+    stats.memory_reclaimed_bytes = stats.cache_stats.memory_reclaimed;
+    stats.pressure_reclaimed_bytes = stats.cache_stats.pressure_reclaimed;
+    stats.memory_limit_bytes = stats.cache_stats.memory_limit_bytes;
+    stats.memory_usage_bytes = stats.cache_stats.memory_usage_bytes;
     
     // 计算平均缓冲区效率
     size_t totalOps = stats.smart_compressions + stats.zero_copy_compressions;
@@ -615,6 +782,7 @@ CompressBufferCache& NativeCompressor::getGlobalBufferCache() {
 NativeCompressor::SmartBatchCompressionResult NativeCompressor::compressBatchSmart(
     const void* const* inputs, const size_t* inputSizes, size_t count,
     std::optional<int> preferredLevel) {
+    LATTICE_TRACE_SPAN("compression", "NativeCompressor::compressBatchSmart");
     
     SmartBatchCompressionResult result;
     result.total_input_bytes = 0;
@@ -667,8 +835,9 @@ void NativeCompressor::updateBufferCacheStats(size_t memorySaved, bool bufferReu
 }
 
 CompressBufferCache::Buffer* NativeCompressor::selectOptimalBuffer(size_t inputSize) const {
+    // 直接按压缩输出的估算大小取档位，取到的缓冲区不需要再resize
     auto& bufferCache = getGlobalBufferCache();
-    return bufferCache.getBuffer(inputSize);
+    return bufferCache.getBuffer(bufferCache.estimateOptimalSize(inputSize));
 }
 
 void NativeCompressor::logSmartCompression(const SmartCompressionResult& result, size_t originalSize) const {
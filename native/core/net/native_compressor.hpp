@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include "libdeflate.h"
 #include "memory_arena.hpp"
@@ -19,11 +22,17 @@ public:
     size_t decompressZlib(const char* src, size_t srcLen, char* dst, size_t dstCapacity);
 
     // Runtime configuration
+    // 每个级别的libdeflate压缩器首次使用时分配并保留，之后切换级别不再分配
     void setCompressionLevel(int level);
+    int getCompressionLevel() const { return compressionLevel_; }
 
     // Get per-thread instance (creates if needed). Use this to avoid sharing contexts across threads.
+    // 同一线程只有一个实例，级别不同时切换到该级别已缓存的压缩器
     static NativeCompressor* forThread(int compressionLevel);
 
+    static constexpr int MIN_COMPRESSION_LEVEL = 0;
+    static constexpr int MAX_COMPRESSION_LEVEL = 12;
+
     // ====== Arena优化接口（内存零拷贝）======
     
     /**
@@ -45,6 +54,7 @@ public:
     
     /**
      * 使用Arena进行高效压缩（零拷贝内存分配）
+     * 结果内存留在当前线程的arena中，调用者用ArenaScope包住使用范围即可在用完后退回
      * @param src 源数据
      * @param srcLen 源数据长度
      * @param preferredCompressionLevel 压缩级别（可选）
@@ -158,6 +168,19 @@ public:
     CompressionStats getCompressionStats() const;
     void resetCompressionStats();
     
+    /**
+     * 按压缩级别汇总的进程级统计（所有线程的实例之和，单调递增）
+     * DynamicCompressionController据此估算各级别的每字节耗时与压缩比
+     */
+    struct LevelStats {
+        uint64_t compressions{0};
+        uint64_t input_bytes{0};
+        uint64_t output_bytes{0};
+        uint64_t busy_nanos{0};
+    };
+    
+    static LevelStats getLevelStats(int level);
+    
     // ====== 智能缓冲区管理集成（CompressBufferCache优化）======
     
     /**
@@ -171,6 +194,7 @@ public:
         size_t memory_saved;             // 相比传统方式节省的内存
         double compression_time_ms;      // 压缩耗时
         CompressBufferCache::Buffer* source_buffer; // 使用的源缓冲区
+        bool skipped;                    // 判定为不可压缩，调用者应按未压缩格式发送原始数据
         
         // 获取压缩数据的C字符串指针
         const char* getData() const { return static_cast<const char*>(compressed_data); }
@@ -189,10 +213,12 @@ public:
      * @param src 源数据
      * @param srcLen 源数据长度
      * @param preferredLevel 压缩级别（可选）
-     * @return 智能压缩结果
+     * @param packetType 包ID（-1表示未知），用于CompressionSkipPolicy按类型学习压缩比
+     * @return 智能压缩结果；采样探测判定不可压缩或压缩后不比原始数据小时skipped为true
      */
     SmartCompressionResult compressZlibSmart(const void* src, size_t srcLen,
-                                           std::optional<int> preferredLevel = std::nullopt);
+                                           std::optional<int> preferredLevel = std::nullopt,
+                                           int packetType = -1);
     
     /**
      * 智能解压缩：使用BufferCache自动管理缓冲区
@@ -247,10 +273,16 @@ public:
         size_t zero_copy_compressions;
         size_t memory_saved_bytes;
         double average_buffer_efficiency;
+        size_t memory_reclaimed_bytes;          // 缓冲区释放的总字节数
+        size_t pressure_reclaimed_bytes;        // 其中因容器内存上限回收的字节数
+        size_t memory_limit_bytes;              // cgroup内存上限；0表示未检测到
+        size_t memory_usage_bytes;              // 最近一次检测到的工作集
         
         BufferCacheStats() 
             : smart_compressions(0), zero_copy_compressions(0), 
-              memory_saved_bytes(0), average_buffer_efficiency(0.0) {}
+              memory_saved_bytes(0), average_buffer_efficiency(0.0),
+              memory_reclaimed_bytes(0), pressure_reclaimed_bytes(0),
+              memory_limit_bytes(0), memory_usage_bytes(0) {}
     };
     
     /**
@@ -314,8 +346,10 @@ public:
 
 private:
     // libdeflate context
+    // deflate_compressor_指向当前级别在deflate_compressors_中的压缩器
     struct libdeflate_compressor* deflate_compressor_;
     struct libdeflate_decompressor* deflate_decompressor_;
+    std::array<struct libdeflate_compressor*, MAX_COMPRESSION_LEVEL + 1> deflate_compressors_{};
 
     int compressionLevel_;
     
@@ -334,8 +368,11 @@ private:
     mutable std::atomic<size_t> stats_new_buffers_created_{0};
     
     // 辅助方法
+    // 取指定级别的压缩器（懒分配）；级别无效或分配失败时抛出std::runtime_error
+    struct libdeflate_compressor* compressorForLevel(int level);
     size_t calculateOptimalBufferSize(size_t inputSize) const;
     void updateStats(size_t inputBytes, size_t outputBytes, double processingTimeMs) const;
+    static void recordLevelStats(int level, size_t inputBytes, size_t outputBytes, uint64_t nanos);
     
     // BufferCache辅助方法
     void updateBufferCacheStats(size_t memorySaved, bool bufferReused) const;
@@ -0,0 +1,191 @@
+#include "packet_batch_compressor.hpp"
+#include "async_compressor.hpp"
+#include "compression_skip_policy.hpp"
+#include "native_compressor.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace lattice {
+namespace net {
+
+std::atomic<uint64_t> PacketBatchCompressor::batches_{0};
+std::atomic<uint64_t> PacketBatchCompressor::packets_{0};
+std::atomic<uint64_t> PacketBatchCompressor::compressed_{0};
+std::atomic<uint64_t> PacketBatchCompressor::passthrough_{0};
+std::atomic<uint64_t> PacketBatchCompressor::failed_{0};
+std::atomic<uint64_t> PacketBatchCompressor::inputBytes_{0};
+std::atomic<uint64_t> PacketBatchCompressor::outputBytes_{0};
+
+namespace {
+
+size_t varIntSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+size_t writeVarInt(uint8_t* dst, uint32_t value) {
+    size_t written = 0;
+    while (value >= 0x80) {
+        dst[written++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    dst[written++] = static_cast<uint8_t>(value);
+    return written;
+}
+
+// libdeflate_zlib_compress_bound的保守上界：每个stored块5字节头 + zlib头尾6字节 + 输出尾部填充
+size_t zlibBound(size_t length) {
+    return length + 5 * (length / 10000 + 1) + 6 + 16;
+}
+
+// VarInt(0) + 原始数据；原始数据整体后移1字节
+int32_t writeUncompressed(uint8_t* region, size_t length) {
+    std::memmove(region + 1, region, length);
+    region[0] = 0;
+    return static_cast<int32_t>(length + 1);
+}
+
+} // namespace
+
+int32_t PacketBatchCompressor::compressPacket(uint8_t* region, size_t length, size_t capacity,
+                                              int threshold, int level) {
+    if (capacity < length + MAX_FRAME_OVERHEAD) {
+        return ERROR_OUT_OF_BOUNDS;
+    }
+    if (length == 0 || static_cast<int64_t>(length) < threshold) {
+        return writeUncompressed(region, length);
+    }
+
+    // 包体以VarInt包ID开头，按类型学习的压缩比与采样熵判定不值得压缩时直接发送
+    auto& skipPolicy = CompressionSkipPolicy::global();
+    const int packetId = CompressionSkipPolicy::readPacketId(region, length);
+    if (skipPolicy.decide(packetId, region, length) != CompressionSkipPolicy::Decision::COMPRESS) {
+        return writeUncompressed(region, length);
+    }
+
+    level = std::clamp(level, NativeCompressor::MIN_COMPRESSION_LEVEL,
+                       NativeCompressor::MAX_COMPRESSION_LEVEL);
+
+    // 输入与输出是同一块区域，先压缩到线程本地的临时缓冲区
+    thread_local std::vector<uint8_t> scratch;
+    const size_t bound = zlibBound(length);
+    if (scratch.size() < bound) {
+        scratch.resize(bound);
+    }
+
+    NativeCompressor* compressor = NativeCompressor::forThread(level);
+    if (!compressor) {
+        return ERROR_COMPRESSION;
+    }
+    compressor->setCompressionLevel(level);
+    const size_t compressedSize = compressor->compressZlib(
+        reinterpret_cast<const char*>(region), length,
+        reinterpret_cast<char*>(scratch.data()), scratch.size());
+    if (compressedSize == 0) {
+        return ERROR_COMPRESSION;
+    }
+    skipPolicy.record(packetId, length, compressedSize);
+
+    const uint32_t dataLength = static_cast<uint32_t>(length);
+    const size_t frameSize = varIntSize(dataLength) + compressedSize;
+    if (frameSize > length) {
+        // 压缩后不比未压缩格式（1 + length）小，按未压缩格式写回
+        return writeUncompressed(region, length);
+    }
+
+    const size_t header = writeVarInt(region, dataLength);
+    std::memcpy(region + header, scratch.data(), compressedSize);
+    return static_cast<int32_t>(frameSize);
+}
+
+PacketBatchCompressor::BatchResult PacketBatchCompressor::compressFlush(
+    uint8_t* buffer, size_t bufferCapacity, int32_t* table, size_t count,
+    int threshold, int defaultLevel) {
+
+    BatchResult result;
+    if (!buffer || !table || count == 0) {
+        return result;
+    }
+
+    // 先在调用线程上校验所有区域，工作线程只处理合法的包
+    std::vector<uint32_t> valid;
+    valid.reserve(count);
+    size_t totalBytes = 0;
+    for (size_t i = 0; i < count; ++i) {
+        int32_t* entry = table + i * TABLE_STRIDE;
+        const int64_t offset = entry[FIELD_OFFSET];
+        const int64_t length = entry[FIELD_LENGTH];
+        const int64_t capacity = entry[FIELD_CAPACITY];
+        if (offset < 0 || length < 0 || capacity < length + static_cast<int64_t>(MAX_FRAME_OVERHEAD) ||
+            static_cast<uint64_t>(offset) + static_cast<uint64_t>(capacity) > bufferCapacity) {
+            entry[FIELD_RESULT] = ERROR_OUT_OF_BOUNDS;
+            continue;
+        }
+        valid.push_back(static_cast<uint32_t>(i));
+        totalBytes += static_cast<size_t>(length);
+    }
+
+    auto process = [&](size_t index) {
+        int32_t* entry = table + static_cast<size_t>(valid[index]) * TABLE_STRIDE;
+        const int level = entry[FIELD_LEVEL] < 0 ? defaultLevel : entry[FIELD_LEVEL];
+        entry[FIELD_RESULT] = compressPacket(buffer + entry[FIELD_OFFSET],
+                                             static_cast<size_t>(entry[FIELD_LENGTH]),
+                                             static_cast<size_t>(entry[FIELD_CAPACITY]),
+                                             threshold, level);
+    };
+
+    if (valid.size() > 1 && totalBytes >= PARALLEL_MIN_BYTES) {
+        AsyncCompressor::getInstance().parallelFor(valid.size(), process);
+    } else {
+        for (size_t i = 0; i < valid.size(); ++i) {
+            process(i);
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        const int32_t* entry = table + i * TABLE_STRIDE;
+        const int32_t written = entry[FIELD_RESULT];
+        if (written < 0) {
+            ++result.failed;
+            continue;
+        }
+        // 未压缩格式以VarInt(0)开头
+        if (buffer[entry[FIELD_OFFSET]] == 0) {
+            ++result.passthrough;
+        } else {
+            ++result.compressed;
+        }
+        result.inputBytes += static_cast<size_t>(entry[FIELD_LENGTH]);
+        result.outputBytes += static_cast<size_t>(written);
+    }
+
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    packets_.fetch_add(count, std::memory_order_relaxed);
+    compressed_.fetch_add(result.compressed, std::memory_order_relaxed);
+    passthrough_.fetch_add(result.passthrough, std::memory_order_relaxed);
+    failed_.fetch_add(result.failed, std::memory_order_relaxed);
+    inputBytes_.fetch_add(result.inputBytes, std::memory_order_relaxed);
+    outputBytes_.fetch_add(result.outputBytes, std::memory_order_relaxed);
+    return result;
+}
+
+PacketBatchCompressor::Stats PacketBatchCompressor::getStats() {
+    Stats stats;
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.packets = packets_.load(std::memory_order_relaxed);
+    stats.compressed = compressed_.load(std::memory_order_relaxed);
+    stats.passthrough = passthrough_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.inputBytes = inputBytes_.load(std::memory_order_relaxed);
+    stats.outputBytes = outputBytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace net
+} // namespace lattice
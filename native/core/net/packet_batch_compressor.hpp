@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lattice {
+namespace net {
+
+/**
+ * PacketBatchCompressor - 一次tick flush中所有连接待发送数据包的批量压缩
+ *
+ * Java把本次flush的所有数据包（已编码、未压缩，不含外层长度前缀）写入同一个DirectByteBuffer，
+ * 另用一张int表描述每个包，一次JNI调用完成全部压缩，结果原地写回各包自己的区域。
+ *
+ * 表中每个包占TABLE_STRIDE个int（本机字节序）：
+ *   [0] offset     包在缓冲区中的起始位置
+ *   [1] length     未压缩长度
+ *   [2] capacity   该包可写回的区域大小，至少length + MAX_FRAME_OVERHEAD
+ *   [3] level      压缩级别，< 0表示使用批量默认级别
+ *   [4] result     输出：写回的字节数；失败时为负的错误码
+ *
+ * 写回格式与原版CompressionEncoder相同：VarInt(未压缩长度) + zlib数据；
+ * 长度低于threshold、CompressionSkipPolicy判定不可压缩或压缩后不比原始数据小时，
+ * 写VarInt(0) + 原始数据。
+ * 各包区域不得重叠（不做检查）。
+ */
+class PacketBatchCompressor {
+public:
+    static constexpr size_t TABLE_STRIDE = 5;
+    static constexpr size_t MAX_FRAME_OVERHEAD = 5;        // VarInt最长5字节
+
+    enum Field : size_t {
+        FIELD_OFFSET = 0,
+        FIELD_LENGTH = 1,
+        FIELD_CAPACITY = 2,
+        FIELD_LEVEL = 3,
+        FIELD_RESULT = 4
+    };
+
+    enum Error : int32_t {
+        ERROR_OUT_OF_BOUNDS = -1,       // 区域超出缓冲区或capacity不足
+        ERROR_COMPRESSION = -2
+    };
+
+    struct BatchResult {
+        size_t compressed{0};           // 以zlib写回的包
+        size_t passthrough{0};          // 以VarInt(0) + 原始数据写回的包
+        size_t failed{0};
+        size_t inputBytes{0};
+        size_t outputBytes{0};
+    };
+
+    struct Stats {
+        uint64_t batches{0};
+        uint64_t packets{0};
+        uint64_t compressed{0};
+        uint64_t passthrough{0};
+        uint64_t failed{0};
+        uint64_t inputBytes{0};
+        uint64_t outputBytes{0};
+    };
+
+    /**
+     * 压缩一批数据包；packets较少或总字节数较小时在调用线程上完成，
+     * 否则通过AsyncCompressor::parallelFor分给工作线程并行处理
+     */
+    static BatchResult compressFlush(uint8_t* buffer, size_t bufferCapacity,
+                                     int32_t* table, size_t count,
+                                     int threshold, int defaultLevel);
+
+    // 单个包（已校验边界）；返回写回的字节数，失败时返回负的错误码
+    static int32_t compressPacket(uint8_t* region, size_t length, size_t capacity,
+                                  int threshold, int level);
+
+    static Stats getStats();
+
+    // 总字节数低于该值时不分派到工作线程
+    static constexpr size_t PARALLEL_MIN_BYTES = 64 * 1024;
+
+private:
+    static std::atomic<uint64_t> batches_;
+    static std::atomic<uint64_t> packets_;
+    static std::atomic<uint64_t> compressed_;
+    static std::atomic<uint64_t> passthrough_;
+    static std::atomic<uint64_t> failed_;
+    static std::atomic<uint64_t> inputBytes_;
+    static std::atomic<uint64_t> outputBytes_;
+};
+
+} // namespace net
+} // namespace lattice
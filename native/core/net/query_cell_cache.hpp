@@ -0,0 +1,212 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+#include "visibility_delta.hpp"
+
+namespace lattice {
+namespace entity {
+
+/**
+ * CellQueryCache - 按观察者所在格子缓存的可见性候选集（时间一致性）
+ *
+ * 缓存键为观察者所在格子和覆盖半径（以格子计），值为覆盖范围内全部格子中的实体
+ * （id或调用者自己的slot编号），不做距离过滤。同一格子内任意位置、任意不超过覆盖半径的视距都能复用，
+ * 调用者只需对候选集按当前位置做一次精确距离检查，省去遍历空间索引。
+ * 因此观察者在格子内移动（包括站着不动的挂机玩家）不会使缓存失效。
+ *
+ * 每个格子有一个成员版本号：空间索引只在实体进入或离开格子时调用markCellChanged()，
+ * 格子内移动不改变候选集，不需要通知。命中时检查覆盖范围内各格子的版本是否都不晚于缓存条目；
+ * 上次检查之后全局没有成员变化时跳过逐格检查。
+ *
+ * 格子坐标与ViewerTrackedSets::makeKey一致；二维索引传入y = 0、reachY = 0。
+ * 非线程安全，由调用者加锁保护。
+ */
+class CellQueryCache {
+public:
+    using CellKey = ViewerTrackedSets::CellKey;
+
+    struct Stats {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t invalidations{0};     // 命中键但覆盖范围内有格子成员变化
+    };
+
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+    static constexpr uint32_t IDLE_TICKS = 100;    // 超过该tick数未使用的条目在prune时删除
+
+    explicit CellQueryCache(size_t capacity = DEFAULT_CAPACITY) : capacity_(capacity) {}
+
+    static CellKey makeKey(int x, int y, int z) { return ViewerTrackedSets::makeKey(x, y, z); }
+
+    // 格子内任意位置distance范围内的实体，最远落在相邻reachCells(distance)个格子内
+    static int reachCells(float distance, int cellSize) {
+        return static_cast<int>(std::ceil(distance / cellSize));
+    }
+
+    // 格子成员变化（实体进入或离开）
+    void markCellChanged(CellKey key) {
+        cellEpochs_[key] = ++epoch_;
+    }
+
+    // 查找覆盖[x ± reachXZ, y ± reachY, z ± reachXZ]的候选集；无效或不存在时返回nullptr
+    const std::vector<int>* find(int x, int y, int z, int reachXZ, int reachY, uint32_t tick) {
+        auto it = entries_.find(makeKey(x, y, z));
+        if (it != entries_.end()) {
+            std::vector<Entry>& entries = it->second;
+            for (size_t i = 0; i < entries.size(); i++) {
+                Entry& entry = entries[i];
+                if (entry.reachXZ != reachXZ || entry.reachY != reachY) {
+                    continue;
+                }
+                if (!validate(entry, x, y, z)) {
+                    ++stats_.invalidations;
+                    candidateCount_ -= entry.candidates.size();
+                    entries[i] = std::move(entries.back());
+                    entries.pop_back();
+                    --size_;
+                    if (entries.empty()) {
+                        entries_.erase(it);
+                    }
+                    break;
+                }
+                entry.lastUsedTick = tick;
+                ++stats_.hits;
+                return &entry.candidates;
+            }
+        }
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    // 存入新的候选集（调用者已按相同的格子与覆盖半径收集），返回缓存中的副本
+    const std::vector<int>& store(int x, int y, int z, int reachXZ, int reachY, uint32_t tick,
+                                  std::vector<int> candidates) {
+        if (size_ >= capacity_) {
+            prune(tick, 1);
+            if (size_ >= capacity_) {
+                clear();
+            }
+        }
+        std::vector<Entry>& entries = entries_[makeKey(x, y, z)];
+        candidateCount_ += candidates.size();
+        entries.push_back(Entry{reachXZ, reachY, epoch_, tick, std::move(candidates)});
+        ++size_;
+        return entries.back().candidates;
+    }
+
+    /**
+     * 删除idleTicks内未使用的条目，以及所有条目都已看过的格子版本
+     * （版本不晚于最老条目的格子对有效性检查没有影响）
+     */
+    void prune(uint32_t tick, uint32_t idleTicks = IDLE_TICKS) {
+        uint64_t oldest = epoch_;
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            std::vector<Entry>& entries = it->second;
+            std::erase_if(entries, [&](const Entry& entry) {
+                return tick - entry.lastUsedTick >= idleTicks;
+            });
+            for (const Entry& entry : entries) {
+                oldest = std::min(oldest, entry.version);
+            }
+            it = entries.empty() ? entries_.erase(it) : std::next(it);
+        }
+        size_ = 0;
+        candidateCount_ = 0;
+        for (const auto& [key, entries] : entries_) {
+            size_ += entries.size();
+            for (const Entry& entry : entries) {
+                candidateCount_ += entry.candidates.size();
+            }
+        }
+        std::erase_if(cellEpochs_, [oldest](const auto& cell) { return cell.second <= oldest; });
+    }
+
+    void clear() {
+        entries_.clear();
+        cellEpochs_.clear();
+        size_ = 0;
+        candidateCount_ = 0;
+    }
+
+    size_t size() const { return size_; }
+
+    // 条目、候选集与格子版本占用的字节数（估算，不含哈希表桶数组）
+    size_t memoryUsage() const {
+        constexpr size_t NODE_OVERHEAD = 32;
+        return size_ * sizeof(Entry) + candidateCount_ * sizeof(int) +
+               entries_.size() * (sizeof(std::vector<Entry>) + NODE_OVERHEAD) +
+               cellEpochs_.size() * (sizeof(uint64_t) * 2 + NODE_OVERHEAD);
+    }
+    const Stats& getStats() const { return stats_; }
+
+private:
+    struct Entry {
+        int reachXZ;
+        int reachY;
+        uint64_t version;              // 条目在该版本时仍然有效
+        uint32_t lastUsedTick;
+        std::vector<int> candidates;
+    };
+
+    bool validate(Entry& entry, int x, int y, int z) const {
+        if (entry.version == epoch_) {
+            return true;
+        }
+        // 有变化记录的格子比覆盖范围少时遍历变化记录，否则逐格查找
+        const size_t side = static_cast<size_t>(2 * entry.reachXZ + 1);
+        const size_t volume = side * side * static_cast<size_t>(2 * entry.reachY + 1);
+        if (cellEpochs_.size() < volume) {
+            for (const auto& [key, cellEpoch] : cellEpochs_) {
+                if (cellEpoch > entry.version && covers(entry, x, y, z, key)) {
+                    return false;
+                }
+            }
+            entry.version = epoch_;
+            return true;
+        }
+        for (int cx = x - entry.reachXZ; cx <= x + entry.reachXZ; cx++) {
+            for (int cy = y - entry.reachY; cy <= y + entry.reachY; cy++) {
+                for (int cz = z - entry.reachXZ; cz <= z + entry.reachXZ; cz++) {
+                    auto it = cellEpochs_.find(makeKey(cx, cy, cz));
+                    if (it != cellEpochs_.end() && it->second > entry.version) {
+                        return false;
+                    }
+                }
+            }
+        }
+        entry.version = epoch_;
+        return true;
+    }
+
+    // 按makeKey的21位编码还原格子坐标（有符号）
+    static bool covers(const Entry& entry, int x, int y, int z, CellKey key) {
+        auto coord = [](uint64_t bits) {
+            return static_cast<int>(static_cast<int64_t>(bits << 43) >> 43);
+        };
+        constexpr uint64_t MASK = (1ull << 21) - 1;
+        const int cx = coord(key >> 42 & MASK);
+        const int cy = coord(key >> 21 & MASK);
+        const int cz = coord(key & MASK);
+        return std::abs(cx - x) <= entry.reachXZ && std::abs(cy - y) <= entry.reachY &&
+               std::abs(cz - z) <= entry.reachXZ;
+    }
+
+    std::unordered_map<CellKey, std::vector<Entry>> entries_;
+    std::unordered_map<CellKey, uint64_t> cellEpochs_;
+    uint64_t epoch_{0};
+    size_t size_{0};
+    size_t candidateCount_{0};     // 所有条目候选集的总长度
+    size_t capacity_;
+    Stats stats_;
+};
+
+} // namespace entity
+} // namespace lattice
@@ -0,0 +1,448 @@
+#include "sharded_tracker.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace lattice {
+namespace entity {
+
+// ===== ShardedWorldTracker 实现 =====
+
+ShardedWorldTracker::ShardedWorldTracker(const Config& config)
+    : config_(config),
+      shardSizeBlocks_(static_cast<float>(std::max(1, config.shardSizeChunks) * CHUNK_SIZE)),
+      asyncSync_(std::make_shared<AsyncEntitySync>()) {
+}
+
+ShardedWorldTracker::~ShardedWorldTracker() = default;
+
+void ShardedWorldTracker::ensureShard(int shardX, int shardZ) {
+    const ShardKey key = makeKey(shardX, shardZ);
+    {
+        std::shared_lock lock(shardsMutex_);
+        if (findShardLocked(key)) {
+            return;
+        }
+    }
+    std::unique_lock lock(shardsMutex_);
+    auto& shard = shards_[key];
+    if (!shard) {
+        shard = std::make_unique<Shard>(shardX, shardZ, config_.worldHeight, asyncSync_);
+        shard->tracker.setMoveEncoderConfig(moveEncoderConfig_);
+        if (initializer_) {
+            initializer_(shard->tracker);
+        }
+    }
+}
+
+void ShardedWorldTracker::shardsInRangeLocked(float x, float z, float distance,
+                                              std::vector<Shard*>& out) const {
+    const int minX = shardCoord(x - distance);
+    const int maxX = shardCoord(x + distance);
+    const int minZ = shardCoord(z - distance);
+    const int maxZ = shardCoord(z + distance);
+    for (int shardX = minX; shardX <= maxX; shardX++) {
+        for (int shardZ = minZ; shardZ <= maxZ; shardZ++) {
+            if (Shard* shard = findShardLocked(makeKey(shardX, shardZ))) {
+                out.push_back(shard);
+            }
+        }
+    }
+}
+
+void ShardedWorldTracker::registerEntity(int id, float x, float y, float z, float radius, EntityType type) {
+    const int shardX = shardCoord(x);
+    const int shardZ = shardCoord(z);
+    const ShardKey key = makeKey(shardX, shardZ);
+    ensureShard(shardX, shardZ);
+
+    DirectoryStripe& stripe = stripeFor(id);
+    std::optional<ShardKey> previous;
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto [it, inserted] = stripe.records.try_emplace(id, EntityRecord{key, radius, type});
+        if (!inserted) {
+            if (it->second.shard != key) {
+                previous = it->second.shard;
+            }
+            it->second = EntityRecord{key, radius, type};
+        }
+    }
+
+    std::shared_lock lock(shardsMutex_);
+    if (previous) {
+        if (Shard* old = findShardLocked(*previous)) {
+            old->tracker.unregisterEntity(id);
+        }
+    }
+    if (Shard* shard = findShardLocked(key)) {
+        shard->tracker.registerEntity(id, x, y, z, radius, type);
+    }
+}
+
+void ShardedWorldTracker::unregisterEntity(int id) {
+    DirectoryStripe& stripe = stripeFor(id);
+    ShardKey key;
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.records.find(id);
+        if (it == stripe.records.end()) {
+            return;
+        }
+        key = it->second.shard;
+        stripe.records.erase(it);
+    }
+
+    std::shared_lock lock(shardsMutex_);
+    if (Shard* shard = findShardLocked(key)) {
+        shard->tracker.unregisterEntity(id);
+    }
+}
+
+void ShardedWorldTracker::updateEntityPosition(int id, float x, float y, float z) {
+    DirectoryStripe& stripe = stripeFor(id);
+    EntityRecord record;
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.records.find(id);
+        if (it == stripe.records.end()) {
+            return;
+        }
+        record = it->second;
+    }
+
+    const int shardX = shardCoord(x);
+    const int shardZ = shardCoord(z);
+    const ShardKey key = makeKey(shardX, shardZ);
+    if (key == record.shard) {
+        std::shared_lock lock(shardsMutex_);
+        if (Shard* shard = findShardLocked(key)) {
+            shard->tracker.updateEntityPosition(id, x, y, z);
+        }
+        return;
+    }
+
+    // 跨分片：在新分片重新注册，运动记录与同步状态从头开始
+    ensureShard(shardX, shardZ);
+    {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.records.find(id);
+        if (it == stripe.records.end()) {
+            return;                    // 期间已被注销
+        }
+        it->second.shard = key;
+    }
+    std::shared_lock lock(shardsMutex_);
+    float yaw = 0.0f, pitch = 0.0f, headYaw = 0.0f;
+    bool onGround = false;
+    bool hasRotation = false;
+    if (Shard* old = findShardLocked(record.shard)) {
+        hasRotation = old->tracker.getEntityRotation(id, yaw, pitch, headYaw, onGround);
+        old->tracker.unregisterEntity(id);
+    }
+    if (Shard* shard = findShardLocked(key)) {
+        shard->tracker.registerEntity(id, x, y, z, record.radius, record.type);
+        if (hasRotation) {
+            shard->tracker.updateEntityRotation(id, yaw, pitch, headYaw, onGround);
+        }
+    }
+    migrations_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ShardedWorldTracker::updateEntityRotation(int id, float yaw, float pitch, float headYaw, bool onGround) {
+    ShardKey key;
+    {
+        DirectoryStripe& stripe = stripeFor(id);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.records.find(id);
+        if (it == stripe.records.end()) {
+            return;
+        }
+        key = it->second.shard;
+    }
+    std::shared_lock lock(shardsMutex_);
+    if (Shard* shard = findShardLocked(key)) {
+        shard->tracker.updateEntityRotation(id, yaw, pitch, headYaw, onGround);
+    }
+}
+
+std::vector<int> ShardedWorldTracker::getVisibleEntities(int viewerId, float viewerX, float viewerY,
+                                                         float viewerZ, float viewDistance) {
+    std::shared_lock lock(shardsMutex_);
+    std::vector<Shard*> shards;
+    shardsInRangeLocked(viewerX, viewerZ, viewDistance, shards);
+
+    if (shards.size() == 1) {
+        return shards.front()->tracker.getVisibleEntities(viewerId, viewerX, viewerY, viewerZ, viewDistance);
+    }
+    std::vector<int> result;
+    for (Shard* shard : shards) {
+        std::vector<int> part = shard->tracker.getVisibleEntities(viewerId, viewerX, viewerY, viewerZ,
+                                                                  viewDistance);
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+VisibilityDelta ShardedWorldTracker::updateViewerVisibility(int viewerId, float viewerX, float viewerY,
+                                                            float viewerZ, float viewDistance) {
+    std::shared_lock lock(shardsMutex_);
+    std::vector<Shard*> shards;
+    shardsInRangeLocked(viewerX, viewerZ, viewDistance, shards);
+
+    std::vector<ShardKey> keys;
+    keys.reserve(shards.size());
+    for (Shard* shard : shards) {
+        keys.push_back(makeKey(shard->shardX, shard->shardZ));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    // 上次涉及、这次不再覆盖的分片：其中追踪的实体全部离开
+    std::vector<ShardKey> departed;
+    {
+        std::lock_guard<std::mutex> viewerLock(viewerMutex_);
+        std::vector<ShardKey>& previous = viewerShards_[viewerId];
+        std::set_difference(previous.begin(), previous.end(), keys.begin(), keys.end(),
+                            std::back_inserter(departed));
+        previous = keys;
+    }
+
+    VisibilityDelta merged;
+    for (ShardKey key : departed) {
+        if (Shard* shard = findShardLocked(key)) {
+            std::vector<int> left = shard->tracker.removeViewer(viewerId);
+            merged.left.insert(merged.left.end(), left.begin(), left.end());
+            merged.recomputed = true;
+        }
+    }
+    for (Shard* shard : shards) {
+        VisibilityDelta delta = shard->tracker.updateViewerVisibility(viewerId, viewerX, viewerY,
+                                                                      viewerZ, viewDistance);
+        merged.entered.insert(merged.entered.end(), delta.entered.begin(), delta.entered.end());
+        merged.left.insert(merged.left.end(), delta.left.begin(), delta.left.end());
+        merged.recomputed = merged.recomputed || delta.recomputed;
+    }
+    if (shards.size() + departed.size() <= 1) {
+        return merged;                 // 单个分片的增量本身已升序
+    }
+
+    // 跨分片迁移的实体同时出现在entered与left中，对观察者而言没有变化
+    std::sort(merged.entered.begin(), merged.entered.end());
+    std::sort(merged.left.begin(), merged.left.end());
+    VisibilityDelta delta;
+    delta.recomputed = merged.recomputed;
+    std::set_difference(merged.entered.begin(), merged.entered.end(), merged.left.begin(), merged.left.end(),
+                        std::back_inserter(delta.entered));
+    std::set_difference(merged.left.begin(), merged.left.end(), merged.entered.begin(), merged.entered.end(),
+                        std::back_inserter(delta.left));
+    return delta;
+}
+
+std::vector<int> ShardedWorldTracker::removeViewer(int viewerId) {
+    std::vector<ShardKey> keys;
+    {
+        std::lock_guard<std::mutex> viewerLock(viewerMutex_);
+        auto it = viewerShards_.find(viewerId);
+        if (it == viewerShards_.end()) {
+            return {};
+        }
+        keys = std::move(it->second);
+        viewerShards_.erase(it);
+    }
+
+    std::shared_lock lock(shardsMutex_);
+    std::vector<int> tracked;
+    for (ShardKey key : keys) {
+        if (Shard* shard = findShardLocked(key)) {
+            std::vector<int> part = shard->tracker.removeViewer(viewerId);
+            tracked.insert(tracked.end(), part.begin(), part.end());
+        }
+    }
+    std::sort(tracked.begin(), tracked.end());
+    return tracked;
+}
+
+std::vector<LODSyncScheduler::Update> ShardedWorldTracker::collectSyncUpdates(int viewerId, float viewerX,
+                                                                              float viewerY, float viewerZ) {
+    std::vector<ShardKey> keys;
+    {
+        std::lock_guard<std::mutex> viewerLock(viewerMutex_);
+        auto it = viewerShards_.find(viewerId);
+        if (it == viewerShards_.end()) {
+            return {};
+        }
+        keys = it->second;
+    }
+
+    std::shared_lock lock(shardsMutex_);
+    std::vector<LODSyncScheduler::Update> updates;
+    for (ShardKey key : keys) {
+        if (Shard* shard = findShardLocked(key)) {
+            std::vector<LODSyncScheduler::Update> part =
+                shard->tracker.collectSyncUpdates(viewerId, viewerX, viewerY, viewerZ);
+            updates.insert(updates.end(), part.begin(), part.end());
+        }
+    }
+    return updates;
+}
+
+net::EntityMoveEncoder::EncodeResult ShardedWorldTracker::encodeSyncUpdates(int viewerId, float viewerX,
+                                                                            float viewerY, float viewerZ,
+                                                                            int compressionThreshold,
+                                                                            size_t maxBytes,
+                                                                            std::vector<uint8_t>& out) {
+    std::vector<ShardKey> keys;
+    {
+        std::lock_guard<std::mutex> viewerLock(viewerMutex_);
+        auto it = viewerShards_.find(viewerId);
+        if (it == viewerShards_.end()) {
+            return {};
+        }
+        keys = it->second;
+    }
+
+    std::shared_lock lock(shardsMutex_);
+    net::EntityMoveEncoder::EncodeResult total;
+    for (ShardKey key : keys) {
+        Shard* shard = findShardLocked(key);
+        if (!shard) {
+            continue;
+        }
+        const auto part = shard->tracker.encodeSyncUpdates(viewerId, viewerX, viewerY, viewerZ,
+                                                           compressionThreshold, maxBytes - total.bytes, out);
+        total.bytes += part.bytes;
+        total.packets += part.packets;
+        total.entities += part.entities;
+        total.truncated += part.truncated;
+    }
+    return total;
+}
+
+void ShardedWorldTracker::setMoveEncoderConfig(const net::EntityMoveEncoder::Config& config) {
+    std::unique_lock lock(shardsMutex_);
+    moveEncoderConfig_ = config;
+    for (auto& [key, shard] : shards_) {
+        shard->tracker.setMoveEncoderConfig(config);
+    }
+}
+
+size_t ShardedWorldTracker::submitCollisionBroadphase(uint64_t tick) {
+    std::lock_guard<std::mutex> submitLock(broadphaseMutex_);
+    broadphaseInput_.clear();
+    {
+        std::shared_lock lock(shardsMutex_);
+        for (auto& [key, shard] : shards_) {
+            shard->tracker.appendCollisionInput(broadphaseInput_);
+        }
+    }
+    const size_t count = broadphaseInput_.size();
+    broadphase_.submit(tick, broadphaseInput_);
+    return count;
+}
+
+void ShardedWorldTracker::tick() {
+    std::shared_lock lock(shardsMutex_);
+    for (auto& [key, shard] : shards_) {
+        shard->tracker.tick();
+    }
+}
+
+bool ShardedWorldTracker::tickShard(int shardX, int shardZ) {
+    std::shared_lock lock(shardsMutex_);
+    Shard* shard = findShardLocked(makeKey(shardX, shardZ));
+    if (!shard) {
+        return false;
+    }
+    shard->tracker.tick();
+    return true;
+}
+
+void ShardedWorldTracker::setShardInitializer(ShardInitializer initializer) {
+    std::unique_lock lock(shardsMutex_);
+    initializer_ = std::move(initializer);
+    if (initializer_) {
+        for (auto& [key, shard] : shards_) {
+            initializer_(shard->tracker);
+        }
+    }
+}
+
+void ShardedWorldTracker::forEachShard(const std::function<void(int, int, HierarchicalTracker&)>& fn) {
+    std::shared_lock lock(shardsMutex_);
+    for (auto& [key, shard] : shards_) {
+        fn(shard->shardX, shard->shardZ, shard->tracker);
+    }
+}
+
+size_t ShardedWorldTracker::pruneEmptyShards() {
+    std::unique_lock lock(shardsMutex_);
+    return std::erase_if(shards_, [](const auto& entry) {
+        const HierarchicalTracker& tracker = entry.second->tracker;
+        return tracker.getEntityCount() == 0 && tracker.getViewerCount() == 0;
+    });
+}
+
+size_t ShardedWorldTracker::getShardCount() const {
+    std::shared_lock lock(shardsMutex_);
+    return shards_.size();
+}
+
+size_t ShardedWorldTracker::getEntityCount() const {
+    size_t count = 0;
+    for (const DirectoryStripe& stripe : directory_) {
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        count += stripe.records.size();
+    }
+    return count;
+}
+
+// ===== WorldTrackerRegistry 实现 =====
+
+std::mutex WorldTrackerRegistry::mutex_;
+std::unordered_map<int, std::shared_ptr<ShardedWorldTracker>> WorldTrackerRegistry::worlds_;
+
+std::shared_ptr<ShardedWorldTracker> WorldTrackerRegistry::create(int worldId,
+                                                                  const ShardedWorldTracker::Config& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& world = worlds_[worldId];
+    if (!world) {
+        world = std::make_shared<ShardedWorldTracker>(config);
+    }
+    return world;
+}
+
+std::shared_ptr<ShardedWorldTracker> WorldTrackerRegistry::find(int worldId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = worlds_.find(worldId);
+    return it != worlds_.end() ? it->second : nullptr;
+}
+
+bool WorldTrackerRegistry::destroy(int worldId) {
+    std::shared_ptr<ShardedWorldTracker> world;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = worlds_.find(worldId);
+        if (it == worlds_.end()) {
+            return false;
+        }
+        world = std::move(it->second);
+        worlds_.erase(it);
+    }
+    // 在锁外析构（会等待分片的后台同步线程退出）
+    return true;
+}
+
+void WorldTrackerRegistry::destroyAll() {
+    std::unordered_map<int, std::shared_ptr<ShardedWorldTracker>> worlds;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        worlds.swap(worlds_);
+    }
+}
+
+size_t WorldTrackerRegistry::worldCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return worlds_.size();
+}
+
+} // namespace entity
+} // namespace lattice
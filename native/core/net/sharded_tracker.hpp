@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "hierarchical_tracker.hpp"
+
+namespace lattice {
+namespace entity {
+
+/**
+ * ShardedWorldTracker - 单个世界的分片实体追踪器
+ *
+ * 世界按shardSizeChunks x shardSizeChunks个区域（每个CHUNK_SIZE格）划分成分片，
+ * 每个分片是一个独立的HierarchicalTracker，拥有自己的读写锁、空间索引与观察者状态。
+ * 不同分片上的注册、移动与查询互不阻塞，与Folia按区域并行tick的方式对应：
+ * 区域线程只操作自己区域内的实体，并用tickShard()推进自己的分片。
+ *
+ * 实体根据当前位置归属一个分片，跨分片移动时从旧分片注销、在新分片以相同的类型与半径重新注册。
+ * 观察者的查询覆盖视距范围内的所有分片，结果直接拼接（实体只属于一个分片，不会重复）。
+ * 可见性增量按分片分别维护后合并；同一次调用中跨分片迁移的实体在两边一进一出，合并时互相抵消。
+ *
+ * 同一世界的分片共用一个AsyncEntitySync后台线程（队列为MPMC，各分片可以并发提交）。
+ * 分片表由shardsMutex_保护：分片操作持读锁，只有创建与pruneEmptyShards()需要写锁。
+ * 同一个实体的更新应来自同一线程（实体的所属区域线程）。
+ */
+class ShardedWorldTracker {
+public:
+    struct Config {
+        int shardSizeChunks = 16;           // 分片边长（区域数），默认16 x 32 = 512格
+        int worldHeight = 384;
+    };
+
+    using ShardInitializer = std::function<void(HierarchicalTracker&)>;
+
+    ShardedWorldTracker() : ShardedWorldTracker(Config()) {}
+    explicit ShardedWorldTracker(const Config& config);
+    ~ShardedWorldTracker();
+
+    ShardedWorldTracker(const ShardedWorldTracker&) = delete;
+    ShardedWorldTracker& operator=(const ShardedWorldTracker&) = delete;
+
+    // 实体管理
+    void registerEntity(int id, float x, float y, float z, float radius, EntityType type);
+    void unregisterEntity(int id);
+    void updateEntityPosition(int id, float x, float y, float z);
+    void updateEntityRotation(int id, float yaw, float pitch, float headYaw, bool onGround);
+
+    // 查询（覆盖视距内的全部分片）
+    std::vector<int> getVisibleEntities(int viewerId, float viewerX, float viewerY, float viewerZ,
+                                        float viewDistance = MAX_VIEW_DISTANCE);
+    VisibilityDelta updateViewerVisibility(int viewerId, float viewerX, float viewerY, float viewerZ,
+                                           float viewDistance = MAX_VIEW_DISTANCE);
+    std::vector<int> removeViewer(int viewerId);
+    std::vector<LODSyncScheduler::Update> collectSyncUpdates(int viewerId, float viewerX,
+                                                             float viewerY, float viewerZ);
+
+    /**
+     * 依次编码观察者所在各分片的移动/旋转数据包，追加到同一个out（见HierarchicalTracker::encodeSyncUpdates）
+     * 开启bundle时每个分片各自成组；跨分片迁移的实体在新分片上先发送一次Teleport
+     */
+    net::EntityMoveEncoder::EncodeResult encodeSyncUpdates(int viewerId, float viewerX, float viewerY,
+                                                           float viewerZ, int compressionThreshold,
+                                                           size_t maxBytes, std::vector<uint8_t>& out);
+    // 应用到已有分片，并在之后新建的分片上沿用
+    void setMoveEncoderConfig(const net::EntityMoveEncoder::Config& config);
+
+    /**
+     * 收集全部分片的实体位置，提交给本世界的碰撞粗检测后台线程后立即返回
+     * 实体只属于一个分片，跨分片的实体对同样能检测到；返回提交的实体数
+     */
+    size_t submitCollisionBroadphase(uint64_t tick);
+    // 最近完成的碰撞候选对（见CollisionBroadphase::latest / waitFor）
+    std::shared_ptr<const CollisionBroadphase::Result> getCollisionPairs() const { return broadphase_.latest(); }
+    std::shared_ptr<const CollisionBroadphase::Result> waitCollisionPairs(uint64_t minTick,
+                                                                          std::chrono::milliseconds timeout) const {
+        return broadphase_.waitFor(minTick, timeout);
+    }
+    void setCollisionConfig(const CollisionBroadphase::Config& config) { broadphase_.setConfig(config); }
+    CollisionBroadphase::Stats getCollisionStats() const { return broadphase_.getStats(); }
+
+    // 推进全部分片（单线程tick时使用）
+    void tick();
+    // 只推进一个分片，供拥有该区域的线程调用；分片不存在时返回false
+    bool tickShard(int shardX, int shardZ);
+
+    /**
+     * 新建分片时调用的初始化函数（视距、特性开关等），同时立即应用到已有分片
+     * 传入空函数表示清除
+     */
+    void setShardInitializer(ShardInitializer initializer);
+
+    // 在持有分片表读锁的情况下遍历分片；fn可以调用分片的任意线程安全方法
+    void forEachShard(const std::function<void(int shardX, int shardZ, HierarchicalTracker&)>& fn);
+
+    /**
+     * 删除没有实体也没有观察者的分片，返回删除的数量
+     * 需要等待所有分片操作结束，建议在各区域tick之间由协调线程调用
+     */
+    size_t pruneEmptyShards();
+
+    int shardCoord(float blockCoord) const {
+        return static_cast<int>(std::floor(blockCoord / shardSizeBlocks_));
+    }
+    size_t getShardCount() const;
+    size_t getEntityCount() const;
+    uint64_t getMigrationCount() const { return migrations_.load(std::memory_order_relaxed); }
+    const Config& getConfig() const { return config_; }
+
+private:
+    using ShardKey = uint64_t;
+
+    struct Shard {
+        Shard(int x, int z, int worldHeight, std::shared_ptr<AsyncEntitySync> sync)
+            : shardX(x), shardZ(z), tracker(worldHeight, std::move(sync)) {}
+
+        int shardX;
+        int shardZ;
+        HierarchicalTracker tracker;
+    };
+
+    // 实体目录：实体所在的分片及重新注册所需的属性；按id分段加锁
+    struct EntityRecord {
+        ShardKey shard;
+        float radius;
+        EntityType type;
+    };
+
+    struct alignas(64) DirectoryStripe {
+        mutable std::mutex mutex;
+        std::unordered_map<int, EntityRecord> records;
+    };
+
+    static constexpr size_t DIRECTORY_STRIPES = 64;
+
+    static ShardKey makeKey(int shardX, int shardZ) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(shardX)) << 32 | static_cast<uint32_t>(shardZ);
+    }
+
+    DirectoryStripe& stripeFor(int id) {
+        return directory_[static_cast<uint32_t>(id) % DIRECTORY_STRIPES];
+    }
+
+    // 需持有shardsMutex_（读或写）
+    Shard* findShardLocked(ShardKey key) const {
+        auto it = shards_.find(key);
+        return it != shards_.end() ? it->second.get() : nullptr;
+    }
+    void ensureShard(int shardX, int shardZ);
+    void shardsInRangeLocked(float x, float z, float distance, std::vector<Shard*>& out) const;
+
+    Config config_;
+    float shardSizeBlocks_;
+    std::shared_ptr<AsyncEntitySync> asyncSync_;
+
+    std::unordered_map<ShardKey, std::unique_ptr<Shard>> shards_;
+    mutable std::shared_mutex shardsMutex_;
+    ShardInitializer initializer_;
+    net::EntityMoveEncoder::Config moveEncoderConfig_;
+
+    std::array<DirectoryStripe, DIRECTORY_STRIPES> directory_;
+
+    // 每个观察者上次查询涉及的分片，离开这些分片时需要取回其中的追踪集合
+    std::unordered_map<int, std::vector<ShardKey>> viewerShards_;
+    std::mutex viewerMutex_;
+
+    std::atomic<uint64_t> migrations_{0};
+
+    // 碰撞粗检测：收集输入的缓冲区由broadphaseMutex_保护（提交串行）
+    CollisionBroadphase broadphase_;
+    CollisionBroadphase::Input broadphaseInput_;
+    std::mutex broadphaseMutex_;
+};
+
+/**
+ * WorldTrackerRegistry - 按世界id管理ShardedWorldTracker
+ *
+ * 主世界、下界与末地各自一个实例，互不共享锁与索引。
+ * find()返回shared_ptr，世界被destroy()时正在进行的调用仍持有实例，调用结束后才析构。
+ */
+class WorldTrackerRegistry {
+public:
+    // 已存在时返回现有实例（忽略config）
+    static std::shared_ptr<ShardedWorldTracker> create(int worldId) {
+        return create(worldId, ShardedWorldTracker::Config());
+    }
+    static std::shared_ptr<ShardedWorldTracker> create(int worldId, const ShardedWorldTracker::Config& config);
+    static std::shared_ptr<ShardedWorldTracker> find(int worldId);
+    static bool destroy(int worldId);
+    static void destroyAll();
+    static size_t worldCount();
+
+private:
+    static std::mutex mutex_;
+    static std::unordered_map<int, std::shared_ptr<ShardedWorldTracker>> worlds_;
+};
+
+} // namespace entity
+} // namespace lattice
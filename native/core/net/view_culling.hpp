@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+
+namespace lattice {
+namespace entity {
+
+/**
+ * ViewCuller - 视锥与区块段遮挡的粗略剔除
+ *
+ * 视锥：按观察者的yaw/pitch（Minecraft约定，yaw=0朝+Z，pitch>0向下看）得到视线方向，
+ * 目标方向与视线夹角超过coneHalfAngle的实体视为不可见；nearRadius以内的实体总是可见。
+ *
+ * 遮挡：Java为每个区块列提供一个"完全不透明"区块段（16x16x16）位掩码。
+ * 从眼睛到实体中心做一次体素遍历（Amanatides–Woo），途经的中间区块段
+ * （不含眼睛和实体所在的段）只要有一个完全不透明就视为被遮挡。
+ * 只看实体中心，实体从不透明段边缘露出一部分时也会被判为遮挡，调用者应据此延后而不是丢弃。
+ *
+ * 不依赖具体的Position类型；非线程安全，由所属追踪器的锁保护。
+ */
+class ViewCuller {
+public:
+    static constexpr int SECTION_SIZE = 16;
+    static constexpr int MAX_SECTIONS = 64;
+
+    struct Config {
+        float coneHalfAngleDegrees = 70.0f;   // 客户端默认FOV 70（水平约100）再留余量
+        float nearRadius = 8.0f;              // 该距离内不做剔除（身后近处的实体仍可能被察觉）
+        bool occlusion = true;
+        int maxOcclusionSteps = 48;           // 体素遍历的最大段数，超出时视为可见
+    };
+
+    struct ViewDirection {
+        float x, y, z;
+    };
+
+    static ViewDirection direction(float yawDegrees, float pitchDegrees) {
+        constexpr float DEG_TO_RAD = 3.14159265358979f / 180.0f;
+        const float yaw = yawDegrees * DEG_TO_RAD;
+        const float pitch = pitchDegrees * DEG_TO_RAD;
+        const float cosPitch = std::cos(pitch);
+        return {-std::sin(yaw) * cosPitch, -std::sin(pitch), std::cos(yaw) * cosPitch};
+    }
+
+    void configure(const Config& config) {
+        config_ = config;
+        cosHalfAngle_ = std::cos(std::clamp(config.coneHalfAngleDegrees, 0.0f, 180.0f) * 3.14159265358979f / 180.0f);
+    }
+    const Config& getConfig() const { return config_; }
+
+    // mask第i位表示区块段minSectionY + i完全不透明；mask为0时删除该区块列
+    void setOpaqueSections(int chunkX, int chunkZ, int minSectionY, uint64_t mask) {
+        const uint64_t key = columnKey(chunkX, chunkZ);
+        if (mask == 0) {
+            columns_.erase(key);
+        } else {
+            columns_[key] = Column{minSectionY, mask};
+        }
+    }
+
+    void clearOpaqueSections() { columns_.clear(); }
+    size_t opaqueColumnCount() const { return columns_.size(); }
+
+    bool isSectionOpaque(int sectionX, int sectionY, int sectionZ) const {
+        auto it = columns_.find(columnKey(sectionX, sectionZ));
+        if (it == columns_.end()) {
+            return false;
+        }
+        const int index = sectionY - it->second.minSectionY;
+        return index >= 0 && index < MAX_SECTIONS && (it->second.mask >> index & 1u) != 0;
+    }
+
+    // 目标是否落在视锥内（eye为眼睛位置）
+    bool inViewCone(float eyeX, float eyeY, float eyeZ, const ViewDirection& dir,
+                    float targetX, float targetY, float targetZ) const {
+        const float dx = targetX - eyeX;
+        const float dy = targetY - eyeY;
+        const float dz = targetZ - eyeZ;
+        const float distSq = dx * dx + dy * dy + dz * dz;
+        if (distSq <= config_.nearRadius * config_.nearRadius) {
+            return true;
+        }
+        const float dot = dx * dir.x + dy * dir.y + dz * dir.z;
+        // dot / |d| >= cosHalfAngle，两边平方时注意符号
+        if (cosHalfAngle_ >= 0.0f) {
+            return dot >= 0.0f && dot * dot >= cosHalfAngle_ * cosHalfAngle_ * distSq;
+        }
+        return dot >= 0.0f || dot * dot <= cosHalfAngle_ * cosHalfAngle_ * distSq;
+    }
+
+    // 眼睛到目标的连线是否穿过完全不透明的中间区块段
+    bool isOccluded(float eyeX, float eyeY, float eyeZ, float targetX, float targetY, float targetZ) const {
+        if (!config_.occlusion || columns_.empty()) {
+            return false;
+        }
+
+        int cell[3] = {sectionOf(eyeX), sectionOf(eyeY), sectionOf(eyeZ)};
+        const int target[3] = {sectionOf(targetX), sectionOf(targetY), sectionOf(targetZ)};
+        const float origin[3] = {eyeX, eyeY, eyeZ};
+        const float delta[3] = {targetX - eyeX, targetY - eyeY, targetZ - eyeZ};
+
+        int step[3];
+        float tMax[3];
+        float tDelta[3];
+        for (int axis = 0; axis < 3; axis++) {
+            if (delta[axis] > 0.0f) {
+                step[axis] = 1;
+                tMax[axis] = ((cell[axis] + 1) * SECTION_SIZE - origin[axis]) / delta[axis];
+                tDelta[axis] = SECTION_SIZE / delta[axis];
+            } else if (delta[axis] < 0.0f) {
+                step[axis] = -1;
+                tMax[axis] = (cell[axis] * SECTION_SIZE - origin[axis]) / delta[axis];
+                tDelta[axis] = -SECTION_SIZE / delta[axis];
+            } else {
+                step[axis] = 0;
+                tMax[axis] = INFINITY;
+                tDelta[axis] = INFINITY;
+            }
+        }
+
+        for (int steps = 0; steps < config_.maxOcclusionSteps; steps++) {
+            const int axis = tMax[0] < tMax[1] ? (tMax[0] < tMax[2] ? 0 : 2) : (tMax[1] < tMax[2] ? 1 : 2);
+            if (tMax[axis] > 1.0f) {
+                return false;              // 已到达目标所在的段
+            }
+            cell[axis] += step[axis];
+            tMax[axis] += tDelta[axis];
+            if (cell[0] == target[0] && cell[1] == target[1] && cell[2] == target[2]) {
+                return false;
+            }
+            if (isSectionOpaque(cell[0], cell[1], cell[2])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Column {
+        int minSectionY;
+        uint64_t mask;
+    };
+
+    static uint64_t columnKey(int chunkX, int chunkZ) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32 | static_cast<uint32_t>(chunkZ);
+    }
+
+    static int sectionOf(float value) {
+        return static_cast<int>(std::floor(value / SECTION_SIZE));
+    }
+
+    Config config_;
+    float cosHalfAngle_ = std::cos(70.0f * 3.14159265358979f / 180.0f);
+    std::unordered_map<uint64_t, Column> columns_;
+};
+
+} // namespace entity
+} // namespace lattice
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace entity {
+
+// ===== 可见性增量 =====
+struct VisibilityDelta {
+    std::vector<int> entered;          // 本次新进入视野的实体（升序）
+    std::vector<int> left;             // 本次离开视野的实体（升序）
+    bool recomputed = false;           // false表示邻域未变化，跳过了查询
+
+    bool empty() const { return entered.empty() && left.empty(); }
+};
+
+/**
+ * ViewerTrackedSets - 每个观察者已追踪的实体集合
+ *
+ * 空间索引在格子内容变化（实体进入、离开或在格子内移动）时调用markCellChanged()，
+ * 为该格子分配一个递增的版本号。观察者提交可见集时记录当时的版本与覆盖的格子；
+ * 之后只要观察者移动不超过moveThreshold、视距不变、覆盖的格子版本都没有更新，
+ * needsUpdate()返回false，调用者可以跳过整次查询，增量为空。
+ *
+ * moveThreshold以内的移动不触发重算，视野边界上的实体最多延迟到下一次重算才出现/消失。
+ *
+ * 不依赖具体的Position类型，HierarchicalTracker与SpatialPartition共用；
+ * 非线程安全，由所属空间索引的锁保护。
+ */
+class ViewerTrackedSets {
+public:
+    using CellKey = uint64_t;
+
+    struct Stats {
+        uint64_t updates{0};           // 调用次数
+        uint64_t recomputes{0};        // 实际重新查询的次数
+        uint64_t entered{0};
+        uint64_t left{0};
+    };
+
+    // 每个坐标取低21位，足以覆盖±100万个格子
+    static CellKey makeKey(int x, int y, int z) {
+        constexpr uint64_t MASK = (1ull << 21) - 1;
+        return (static_cast<uint64_t>(x) & MASK) << 42 |
+               (static_cast<uint64_t>(y) & MASK) << 21 |
+               (static_cast<uint64_t>(z) & MASK);
+    }
+
+    void setMoveThreshold(float blocks) { moveThresholdSq_ = blocks * blocks; }
+
+    void markCellChanged(CellKey key) {
+        cellVersions_[key] = ++version_;
+    }
+
+    // 观察者是否需要重新查询（首次出现的观察者总是需要）
+    bool needsUpdate(int viewerId, float x, float y, float z, float viewDistance) const {
+        auto it = viewers_.find(viewerId);
+        if (it == viewers_.end()) {
+            return true;
+        }
+        const Viewer& viewer = it->second;
+        const float dx = x - viewer.x;
+        const float dy = y - viewer.y;
+        const float dz = z - viewer.z;
+        if (dx * dx + dy * dy + dz * dz > moveThresholdSq_ || viewDistance != viewer.viewDistance) {
+            return true;
+        }
+        for (CellKey cell : viewer.cells) {
+            auto versionIt = cellVersions_.find(cell);
+            if (versionIt != cellVersions_.end() && versionIt->second > viewer.version) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 邻域未变化：记录一次跳过的更新
+    VisibilityDelta skip() {
+        ++stats_.updates;
+        return VisibilityDelta{};
+    }
+
+    /**
+     * 提交新的可见集（任意顺序，允许重复），返回与上次提交相比的增量
+     * cells为这次查询覆盖的格子
+     */
+    VisibilityDelta commit(int viewerId, float x, float y, float z, float viewDistance,
+                           std::vector<CellKey> cells, std::vector<int> visible) {
+        std::sort(visible.begin(), visible.end());
+        visible.erase(std::unique(visible.begin(), visible.end()), visible.end());
+
+        Viewer& viewer = viewers_[viewerId];
+        VisibilityDelta delta;
+        delta.recomputed = true;
+        std::set_difference(visible.begin(), visible.end(), viewer.tracked.begin(), viewer.tracked.end(),
+                            std::back_inserter(delta.entered));
+        std::set_difference(viewer.tracked.begin(), viewer.tracked.end(), visible.begin(), visible.end(),
+                            std::back_inserter(delta.left));
+
+        viewer.x = x;
+        viewer.y = y;
+        viewer.z = z;
+        viewer.viewDistance = viewDistance;
+        viewer.version = version_;
+        viewer.cells = std::move(cells);
+        viewer.tracked = std::move(visible);
+
+        ++stats_.updates;
+        ++stats_.recomputes;
+        stats_.entered += delta.entered.size();
+        stats_.left += delta.left.size();
+        return delta;
+    }
+
+    // 移除观察者，返回其仍在追踪的实体（全部视为离开）
+    std::vector<int> removeViewer(int viewerId) {
+        auto it = viewers_.find(viewerId);
+        if (it == viewers_.end()) {
+            return {};
+        }
+        std::vector<int> tracked = std::move(it->second.tracked);
+        viewers_.erase(it);
+        return tracked;
+    }
+
+    const std::vector<int>* trackedSet(int viewerId) const {
+        auto it = viewers_.find(viewerId);
+        return it != viewers_.end() ? &it->second.tracked : nullptr;
+    }
+
+    // 删除所有观察者都已看过的格子版本，避免版本表随走过的格子无限增长
+    void pruneCellVersions() {
+        uint64_t oldest = version_;
+        for (const auto& [id, viewer] : viewers_) {
+            oldest = std::min(oldest, viewer.version);
+        }
+        for (auto it = cellVersions_.begin(); it != cellVersions_.end();) {
+            if (it->second <= oldest) {
+                it = cellVersions_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    size_t viewerCount() const { return viewers_.size(); }
+    const Stats& getStats() const { return stats_; }
+
+private:
+    struct Viewer {
+        float x{0.0f}, y{0.0f}, z{0.0f};
+        float viewDistance{0.0f};
+        uint64_t version{0};
+        std::vector<CellKey> cells;
+        std::vector<int> tracked;      // 升序
+    };
+
+    std::unordered_map<CellKey, uint64_t> cellVersions_;
+    std::unordered_map<int, Viewer> viewers_;
+    uint64_t version_{0};
+    float moveThresholdSq_{1.0f};
+    Stats stats_;
+};
+
+} // namespace entity
+} // namespace lattice
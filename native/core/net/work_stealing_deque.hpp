@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lattice {
+namespace net {
+
+/**
+ * WorkStealingDeque - Chase–Lev工作窃取双端队列
+ *
+ * 所有者线程在底部push / pop（LIFO，无竞争时不做CAS），其他线程从顶部steal（FIFO）。
+ * 只有最后一个元素同时被pop和steal时才通过top上的CAS裁决。
+ * 元素为裸指针，所有权随指针转移；数组满时所有者扩容为两倍，旧数组保留到析构，
+ * 正在读取旧数组的窃取者不会访问到已释放的内存。
+ *
+ * 参考：Lê, Pop, Cohen, Zappa Nardelli. Correct and Efficient Work-Stealing for
+ * Weak Memory Models (PPoPP 2013)。这里用seq_cst读写代替独立的fence。
+ */
+template<typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t initialCapacity = 256) {
+        size_t capacity = 16;
+        while (capacity < initialCapacity) {
+            capacity <<= 1;
+        }
+        arrays_.push_back(std::make_unique<Array>(capacity));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // 仅所有者线程调用
+    void push(T* item) {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(array->capacity) - 1) {
+            array = grow(array, top, bottom);
+        }
+        array->put(bottom, item);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // 仅所有者线程调用；为空时返回nullptr
+    T* pop() {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_seq_cst);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item = array->get(bottom);
+        if (top == bottom) {
+            // 最后一个元素：与窃取者竞争
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // 任意线程调用；为空或与其他线程竞争失败时返回nullptr
+    T* steal() {
+        int64_t top = top_.load(std::memory_order_seq_cst);
+        const int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        Array* array = array_.load(std::memory_order_acquire);
+        T* item = array->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // 近似值（并发修改时可能过期）
+    size_t sizeApprox() const {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+    bool emptyApprox() const { return sizeApprox() == 0; }
+
+private:
+    struct Array {
+        explicit Array(size_t size)
+            : capacity(size), mask(size - 1), slots(new std::atomic<T*>[size]) {
+        }
+
+        T* get(int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(int64_t index, T* item) {
+            slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed);
+        }
+
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+    };
+
+    Array* grow(Array* old, int64_t top, int64_t bottom) {
+        arrays_.push_back(std::make_unique<Array>(old->capacity * 2));
+        Array* array = arrays_.back().get();
+        for (int64_t i = top; i < bottom; ++i) {
+            array->put(i, old->get(i));
+        }
+        array_.store(array, std::memory_order_release);
+        return array;
+    }
+
+    // top与bottom分别由窃取者和所有者频繁写入，放在不同缓存行
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    alignas(64) std::atomic<Array*> array_{nullptr};
+    std::vector<std::unique_ptr<Array>> arrays_;    // 仅所有者修改
+};
+
+} // namespace net
+} // namespace lattice
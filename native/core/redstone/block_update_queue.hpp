@@ -0,0 +1,170 @@
+#ifndef LATTICE_BLOCK_UPDATE_QUEUE_HPP
+#define LATTICE_BLOCK_UPDATE_QUEUE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice::redstone {
+
+    /**
+     * 每tick的方块更新队列（按区块段位图去重）
+     *
+     * 红石线整组重算、观察者、活塞等在同一tick里经常对同一位置重复发出邻居更新；
+     * 队列对每个位置只保留一条，调用方每tick取出一次整批交给Java。
+     * 去重用每个区块段一个4096位的位图（段内下标 (y << 8) | (z << 4) | x），
+     * 比有序集合少一次树查找与节点分配；取出的位置会清掉对应位，之后可以再次入队。
+     *
+     * 取出顺序由Order决定：
+     * POSITION: 按位置排序（x、y、z依次比较），与旧的std::set行为相同
+     * EMISSION: 按第一次入队的顺序，邻居按原版Direction.UPDATE_ORDER（西、东、下、上、北、南），
+     *   与原版逐个通知邻居的顺序一致，依赖更新顺序的机器（如BUD、观察者链）行为不变
+     *
+     * Pos需要公开的int x、y、z成员与operator<。不是线程安全的，由调用方加锁。
+     */
+    template <typename Pos>
+    class BlockUpdateQueue {
+    public:
+        enum class Order : int32_t {
+            POSITION = 0,
+            EMISSION = 1
+        };
+
+        // 原版Direction.UPDATE_ORDER
+        static constexpr int UPDATE_ORDER[6][3] = {
+            {-1, 0, 0}, {1, 0, 0}, {0, -1, 0},
+            {0, 1, 0}, {0, 0, -1}, {0, 0, 1}
+        };
+
+        // 全部取出后保留的段位图上限（每段512字节），超过时整体释放
+        static constexpr size_t MAX_RETAINED_SECTIONS = 4096;
+
+        struct Stats {
+            uint64_t pushed = 0;        // 入队请求数（含重复）
+            uint64_t duplicates = 0;    // 因已在队列中被丢弃的请求数
+            uint64_t drained = 0;
+        };
+
+        void setOrder(Order order) {
+            if (order_ != order) {
+                order_ = order;
+                sorted_ = false;
+            }
+        }
+
+        Order getOrder() const { return order_; }
+
+        // 位置不在队列中时入队并返回true
+        bool push(const Pos& pos) {
+            ++stats_.pushed;
+            uint64_t& word = sectionBits(pos)[localIndex(pos) >> 6];
+            const uint64_t bit = uint64_t{1} << (localIndex(pos) & 63);
+            if (word & bit) {
+                ++stats_.duplicates;
+                return false;
+            }
+            word |= bit;
+            entries_.push_back(pos);
+            sorted_ = false;
+            return true;
+        }
+
+        // 位置本身及其六个邻居（按UPDATE_ORDER）入队，返回新入队的条数
+        size_t pushWithNeighbors(const Pos& pos) {
+            size_t added = push(pos) ? 1 : 0;
+            for (const auto& dir : UPDATE_ORDER) {
+                added += push(Pos(pos.x + dir[0], pos.y + dir[1], pos.z + dir[2])) ? 1 : 0;
+            }
+            return added;
+        }
+
+        size_t size() const { return entries_.size() - head_; }
+        bool empty() const { return size() == 0; }
+
+        /**
+         * 按当前Order把最多capacity条交给sink(const Pos&)并出队，返回条数
+         * 没取完的留到下次，顺序不变
+         */
+        template <typename Sink>
+        size_t drain(size_t capacity, Sink&& sink) {
+            if (order_ == Order::POSITION && !sorted_) {
+                std::sort(entries_.begin() + static_cast<ptrdiff_t>(head_), entries_.end());
+                sorted_ = true;
+            }
+            const size_t count = std::min(capacity, size());
+            for (size_t i = 0; i < count; ++i) {
+                const Pos& pos = entries_[head_ + i];
+                sink(pos);
+                sectionBits(pos)[localIndex(pos) >> 6] &= ~(uint64_t{1} << (localIndex(pos) & 63));
+            }
+            head_ += count;
+            stats_.drained += count;
+            if (head_ == entries_.size()) {
+                entries_.clear();
+                head_ = 0;
+                if (sections_.size() > MAX_RETAINED_SECTIONS) {
+                    releaseSections();
+                }
+            } else if (head_ > entries_.size() / 2) {
+                entries_.erase(entries_.begin(), entries_.begin() + static_cast<ptrdiff_t>(head_));
+                head_ = 0;
+            }
+            return count;
+        }
+
+        void clear() {
+            entries_.clear();
+            head_ = 0;
+            sorted_ = false;
+            releaseSections();
+        }
+
+        Stats getStats() const { return stats_; }
+        void resetStats() { stats_ = Stats{}; }
+
+    private:
+        using SectionBits = std::array<uint64_t, 64>;
+
+        static uint64_t sectionKey(const Pos& pos) {
+            // 同原版SectionPos.asLong：x、z各22位，y 20位
+            return ((static_cast<uint64_t>(static_cast<uint32_t>(pos.x >> 4)) & 0x3FFFFF) << 42) |
+                   ((static_cast<uint64_t>(static_cast<uint32_t>(pos.z >> 4)) & 0x3FFFFF) << 20) |
+                   (static_cast<uint64_t>(static_cast<uint32_t>(pos.y >> 4)) & 0xFFFFF);
+        }
+
+        static uint32_t localIndex(const Pos& pos) {
+            return (static_cast<uint32_t>(pos.y & 15) << 8) | (static_cast<uint32_t>(pos.z & 15) << 4) |
+                   static_cast<uint32_t>(pos.x & 15);
+        }
+
+        // 相邻的更新大多落在同一段，缓存上一次的段（unordered_map的元素地址在rehash后不变）
+        SectionBits& sectionBits(const Pos& pos) {
+            const uint64_t key = sectionKey(pos);
+            if (lastBits_ == nullptr || lastKey_ != key) {
+                lastBits_ = &sections_.try_emplace(key).first->second;
+                lastKey_ = key;
+            }
+            return *lastBits_;
+        }
+
+        void releaseSections() {
+            sections_.clear();
+            lastBits_ = nullptr;
+        }
+
+        Order order_ = Order::POSITION;
+        std::vector<Pos> entries_;
+        size_t head_ = 0;
+        bool sorted_ = false;
+        std::unordered_map<uint64_t, SectionBits> sections_;
+        uint64_t lastKey_ = 0;
+        SectionBits* lastBits_ = nullptr;
+        Stats stats_;
+    };
+
+} // namespace lattice::redstone
+
+#endif // LATTICE_BLOCK_UPDATE_QUEUE_HPP
@@ -1,9 +1,16 @@
 #ifndef LATTICE_PAPER_COMPATIBLE_REDSTONE_ENGINE_HPP
 #define LATTICE_PAPER_COMPATIBLE_REDSTONE_ENGINE_HPP
 
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <span>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <atomic>
 #include <chrono>
 #include <algorithm>
@@ -11,6 +18,15 @@
 #include <iostream>
 #include <optional>
 
+#include "block_update_queue.hpp"
+#include "section_component_index.hpp"
+#include "signal_cycle_memo.hpp"
+#include "signal_scheduler.hpp"
+#include "../frame_allocator.hpp"
+#include "../metrics.hpp"
+#include "../native_runtime.hpp"
+#include "../tracing.hpp"
+
 namespace lattice::redstone::paper {
 
     // 位置结构 - 与Paper兼容
@@ -56,6 +72,13 @@ namespace lattice::redstone::paper {
         bool isPowered = false;
         std::chrono::steady_clock::time_point lastUpdate;
         
+        // 引擎内部状态：在components_中的下标（移除时与末尾交换）、所属红石网络（PARALLEL模式，只对红石线有效）、
+        // SCHEDULED模式下是否已有计划刻
+        static constexpr uint32_t NO_NETWORK = UINT32_MAX;
+        uint32_t storeIndex = 0;
+        uint32_t network = NO_NETWORK;
+        bool tickScheduled = false;
+        
         // Paper兼容的接口
         virtual ~PaperRedstoneComponent() = default;
         
@@ -103,6 +126,9 @@ namespace lattice::redstone::paper {
     public:
         using PaperRedstoneComponent::PaperRedstoneComponent;
         
+        // 从外部（如被充能的方块）得到的输入；ALTERNATE_CURRENT等模式下红石线的功率由整组计算得出
+        int externalInput = 0;
+        
         int calculateOutput(int inputSignal) const override {
             // 红石线：信号强度在15米内每格减1
             return inputSignal;
@@ -134,12 +160,32 @@ namespace lattice::redstone::paper {
     private:
         bool subtractMode = false;
         
+        // 读取容器时缓存的填充信号，-1表示不读取容器；只在收到容器变化通知时更新
+        int containerSignal_ = -1;
+        PaperPosition container_;
+        
     public:
         PaperComparator(const PaperPosition& pos, bool subtract = false) 
             : PaperRedstoneComponent(pos, PaperRedstoneType::COMPARATOR), 
               subtractMode(subtract) {}
         
+        bool readsContainer() const { return containerSignal_ >= 0; }
+        const PaperPosition& containerPosition() const { return container_; }
+        
+        void bindContainer(const PaperPosition& container, int signal) {
+            container_ = container;
+            containerSignal_ = std::max(0, std::min(15, signal));
+        }
+        
+        void setContainerSignal(int signal) {
+            containerSignal_ = std::max(0, std::min(15, signal));
+        }
+        
         int calculateOutput(int inputSignal) const override {
+            if (readsContainer()) {
+                // 后端输入是容器的填充信号（侧面输入在这个引擎里不建模，两种模式输出相同）
+                return containerSignal_;
+            }
             if (subtractMode) {
                 // 减法模式：输出 = max(0, sideSignal - backSignal)
                 return std::max(0, inputSignal - (currentSignal / 2));
@@ -169,11 +215,37 @@ namespace lattice::redstone::paper {
     /**
      * Paper兼容的红石引擎
      * 这个引擎提供与Paper相同的接口，但使用优化的C++实现
+     *
+     * 这是构建进服务端的唯一红石引擎。组件存放在一个按注册顺序的稠密数组里，
+     * 所有按位置的查找（查询API与传播内部）都走同一个区块段索引，不再另外维护按位置的有序表；
+     * 更新信号只有applyPower一个入口，传播方式由PropagationMode选择。
+     * RedstoneEngine与NativeRedstoneOptimizer的JNI入口也转发到这里。
      */
     class PaperCompatibleRedstoneEngine {
     public:
         using ComponentPtr = std::unique_ptr<PaperRedstoneComponent>;
-        using ComponentMap = std::map<PaperPosition, ComponentPtr>;
+        using ComponentStore = std::vector<ComponentPtr>;
+        
+        /**
+         * 信号传播模式
+         * LEGACY: 逐个邻居传播（原有行为），一条红石线变化会在线上反复触发重复更新
+         * ALTERNATE_CURRENT: 与Alternate Current相同的思路，对相连的整组红石线一次算出新功率
+         *   （按功率分桶，每根线只定值一次），功率变化的位置及其邻居各产生一次方块更新
+         * SCHEDULED: 红石线同ALTERNATE_CURRENT；中继器、比较器、火把、活塞的输出经时间轮在
+         *   (触发tick, 优先级, 调度顺序)到期时才更新（延迟为0的组件按1 tick），与原版计划刻顺序一致，
+         *   可选开启时钟记忆（setCycleMemoization）
+         * PARALLEL: 结果同ALTERNATE_CURRENT，但红石线的重算推迟到tick：本tick涉及的红石网络
+         *   （相连的整组红石线，结构不变时复用编译好的邻接表）在线程池上并行求值，按网络顺序写回并产生方块更新
+         */
+        enum class PropagationMode {
+            LEGACY,
+            ALTERNATE_CURRENT,
+            SCHEDULED,
+            PARALLEL
+        };
+        
+        using Event = SignalEvent<PaperPosition>;
+        using CycleMemo = SignalCycleMemo<Event, PaperPosition>;
         
         // 单例模式
         static PaperCompatibleRedstoneEngine& getInstance() {
@@ -185,57 +257,130 @@ namespace lattice::redstone::paper {
         
         /**
          * 检查指定位置是否有电源 - 与Paper API完全兼容
+         * 查询走区块段索引，不取componentMutex_（组件的功率只在tick线程上修改）
          */
         bool isPowered(int x, int y, int z) {
-            PaperPosition pos(x, y, z);
-            std::lock_guard<std::mutex> lock(componentMutex_);
-            
-            auto it = components_.find(pos);
-            if (it != components_.end()) {
-                return it->second->isPoweredOutput();
+            if (auto* component = index_.find(x, y, z)) {
+                return component->isPoweredOutput();
             }
             
             // 检查周围的红石线
-            return checkAdjacentWires(pos);
+            return checkAdjacentWires(PaperPosition(x, y, z));
         }
         
         /**
          * 获取信号强度 - 与Paper API完全兼容
          */
         int getPower(int x, int y, int z) {
-            PaperPosition pos(x, y, z);
-            std::lock_guard<std::mutex> lock(componentMutex_);
-            
-            auto it = components_.find(pos);
-            if (it != components_.end()) {
-                return it->second->getPower();
+            if (auto* component = index_.find(x, y, z)) {
+                return component->getPower();
             }
             
             // 计算周围信号的传递
-            return calculateSignalFromNeighbors(pos);
+            return calculateSignalFromNeighbors(PaperPosition(x, y, z));
+        }
+        
+        // ================ 批量查询 ================
+        
+        // 批量查询结果每个位置一个字节：低4位为getPower，POWERED_FLAG为isPowered
+        static constexpr uint8_t POWERED_FLAG = 0x80;
+        static constexpr int SECTION_MASK_WORDS = 4096 / 64;
+        
+        /**
+         * 按原版BlockPos.asLong打包的位置批量查询，结果依次写入out（count字节）
+         */
+        void queryPowers(const int64_t* packed, size_t count, uint8_t* out) {
+            for (size_t i = 0; i < count; ++i) {
+                const PaperPosition pos = unpackBlockPos(packed[i]);
+                out[i] = queryPower(pos.x, pos.y, pos.z);
+            }
+        }
+        
+        /**
+         * 查询一个区块段内mask选中的位置（sectionId同原版SectionPos.asLong，
+         * mask为64个long共4096位，第i位对应段内下标i = (y << 8) | (z << 4) | x）
+         * 按下标升序每个选中位置写一个字节，返回写入数
+         */
+        size_t querySectionPowers(int64_t sectionId, const uint64_t* mask, uint8_t* out) {
+            const int baseX = static_cast<int>(sectionId >> 42) << 4;
+            const int baseY = static_cast<int>(static_cast<int64_t>(static_cast<uint64_t>(sectionId) << 44) >> 44) << 4;
+            const int baseZ = static_cast<int>(static_cast<int64_t>(static_cast<uint64_t>(sectionId) << 22) >> 42) << 4;
+            size_t written = 0;
+            for (int word = 0; word < SECTION_MASK_WORDS; ++word) {
+                for (uint64_t bits = mask[word]; bits != 0; bits &= bits - 1) {
+                    const int index = word * 64 + std::countr_zero(bits);
+                    out[written++] = queryPower(baseX + (index & 15), baseY + (index >> 8), baseZ + ((index >> 4) & 15));
+                }
+            }
+            return written;
+        }
+        
+        using BlockUpdateOrder = BlockUpdateQueue<PaperPosition>::Order;
+        
+        /**
+         * 把待发送的方块更新按getBlockUpdateOrder()的顺序写入out（每条为BlockPos.asLong），
+         * 写不下的留到下次，返回写入条数
+         */
+        size_t drainBlockUpdates(int64_t* out, size_t capacity) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            size_t written = 0;
+            blockUpdates_.drain(capacity, [&](const PaperPosition& pos) { out[written++] = packBlockPos(pos); });
+            return written;
+        }
+        
+        /**
+         * 由Java侧（观察者、活塞等）发出的邻居更新并入同一个去重队列：
+         * 每个位置本身及其六个邻居各记一次，与引擎自己产生的更新一起在下一次取出时交回
+         * 返回新入队的条数（已在队列中的位置不重复计入）
+         */
+        size_t queueNeighborUpdates(const int64_t* packed, size_t count) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            size_t added = 0;
+            for (size_t i = 0; i < count; ++i) {
+                added += emitNeighborUpdates(unpackBlockPos(packed[i]));
+            }
+            return added;
+        }
+        
+        /**
+         * 方块更新的取出顺序：POSITION按位置排序（默认），EMISSION按原版的发出顺序
+         * 切换只影响还没取出的更新怎样排序，不会丢弃它们
+         */
+        void setBlockUpdateOrder(BlockUpdateOrder order) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            blockUpdates_.setOrder(order);
+        }
+        
+        BlockUpdateOrder getBlockUpdateOrder() const {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            return blockUpdates_.getOrder();
+        }
+        
+        size_t pendingBlockUpdateCount() const {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            return blockUpdates_.size();
+        }
+        
+        // 原版BlockPos.asLong：x、z各26位，y 12位
+        static int64_t packBlockPos(const PaperPosition& pos) {
+            return static_cast<int64_t>(((static_cast<uint64_t>(static_cast<uint32_t>(pos.x)) & 0x3FFFFFF) << 38) |
+                                        ((static_cast<uint64_t>(static_cast<uint32_t>(pos.z)) & 0x3FFFFFF) << 12) |
+                                        (static_cast<uint64_t>(static_cast<uint32_t>(pos.y)) & 0xFFF));
+        }
+        
+        static PaperPosition unpackBlockPos(int64_t packed) {
+            const auto bits = static_cast<uint64_t>(packed);
+            return PaperPosition(static_cast<int>(packed >> 38),
+                                 static_cast<int>(static_cast<int64_t>(bits << 52) >> 52),
+                                 static_cast<int>(static_cast<int64_t>(bits << 26) >> 38));
         }
         
         /**
          * 更新信号 - 与Paper API完全兼容
          */
         void updatePower(int x, int y, int z, int power) {
-            PaperPosition pos(x, y, z);
             std::lock_guard<std::mutex> lock(componentMutex_);
-            
-            auto it = components_.find(pos);
-            if (it != components_.end()) {
-                it->second->setPower(power);
-                
-                // 触发信号传播
-                propagateSignal(pos);
-                
-                // 更新性能统计
-                stats_.signalsProcessed++;
-            } else {
-                // 创建新的红石线组件（Paper的行为）
-                registerRedstoneWire(x, y, z);
-                updatePower(x, y, z, power);  // 递归调用
-            }
+            applyPower(PaperPosition(x, y, z), power);
         }
         
         // ================ 组件注册 - Paper兼容 ================
@@ -244,54 +389,310 @@ namespace lattice::redstone::paper {
          * 注册红石线 - 与Paper组件注册兼容
          */
         bool registerRedstoneWire(int x, int y, int z) {
+            return registerComponent(x, y, z, PaperRedstoneType::WIRE);
+        }
+        
+        /**
+         * 注册中继器 - 与Paper组件注册兼容
+         */
+        bool registerRepeater(int x, int y, int z, int delay) {
+            return registerComponent(x, y, z, PaperRedstoneType::REPEATER, delay);
+        }
+        
+        /**
+         * 注册比较器 - 与Paper组件注册兼容
+         */
+        bool registerComparator(int x, int y, int z, bool subtractMode) {
+            return registerComponent(x, y, z, PaperRedstoneType::COMPARATOR, subtractMode ? 1 : 0);
+        }
+        
+        /**
+         * 注册任意类型的组件，该位置已有组件时返回false
+         * param：中继器为延迟，比较器非0为减法模式，火把与拉杆非0为初始充能，其他类型忽略
+         * （按钮、压力板、观察者、活塞的状态由Java经updatePower设置）
+         */
+        bool registerComponent(int x, int y, int z, PaperRedstoneType type, int param = 0) {
             PaperPosition pos(x, y, z);
             std::lock_guard<std::mutex> lock(componentMutex_);
             
-            if (components_.find(pos) != components_.end()) {
+            if (findComponent(pos)) {
                 return false;  // 已存在
             }
             
-            components_[pos] = std::make_unique<PaperRedstoneWire>(pos, PaperRedstoneType::WIRE);
-            stats_.totalComponents++;
+            leaveCycleReplay();
+            addComponent(createComponent(pos, type, param));
             
-            std::cout << "[Lattice Redstone] Registered wire at (" << x << "," << y << "," << z << ")" << std::endl;
+            std::cout << "[Lattice Redstone] Registered " << typeName(type) << " at (" << x << "," << y << "," << z
+                      << ") param=" << param << std::endl;
             return true;
         }
         
         /**
-         * 注册中继器 - 与Paper组件注册兼容
+         * 移除组件并按当前模式重新传播它周围的信号，该位置没有组件时返回false
+         * 查询不加锁，组件延迟到下一次publish之后释放
          */
-        bool registerRepeater(int x, int y, int z, int delay) {
-            PaperPosition pos(x, y, z);
+        bool unregisterComponent(int x, int y, int z) {
+            const PaperPosition pos(x, y, z);
             std::lock_guard<std::mutex> lock(componentMutex_);
-            
-            if (components_.find(pos) != components_.end()) {
+            PaperRedstoneComponent* component = findComponent(pos);
+            if (!component) {
                 return false;
             }
             
-            components_[pos] = std::make_unique<PaperRepeater>(pos, delay);
-            stats_.totalComponents++;
-            
-            std::cout << "[Lattice Redstone] Registered repeater at (" << x << "," << y << "," << z << ") delay=" << delay << std::endl;
+            leaveCycleReplay();
+            if (component->type == PaperRedstoneType::COMPARATOR) {
+                auto* comparator = static_cast<PaperComparator*>(component);
+                if (comparator->readsContainer()) {
+                    unbindContainerReader(comparator);
+                }
+            }
+            removeComponent(component);
+            if (propagationMode_ != PropagationMode::LEGACY) {
+                propagateFrom(pos);
+            }
             return true;
         }
         
         /**
-         * 注册比较器 - 与Paper组件注册兼容
+         * 与center的距离不超过radius的组件位置（按注册顺序）
          */
-        bool registerComparator(int x, int y, int z, bool subtractMode) {
-            PaperPosition pos(x, y, z);
+        std::vector<PaperPosition> componentsInRange(const PaperPosition& center, int radius) const {
             std::lock_guard<std::mutex> lock(componentMutex_);
-            
-            if (components_.find(pos) != components_.end()) {
+            std::vector<PaperPosition> result;
+            const long long limit = static_cast<long long>(radius) * radius;
+            for (const auto& component : components_) {
+                const long long dx = component->position.x - center.x;
+                const long long dy = component->position.y - center.y;
+                const long long dz = component->position.z - center.z;
+                if (dx * dx + dy * dy + dz * dz <= limit) {
+                    result.push_back(component->position);
+                }
+            }
+            return result;
+        }
+        
+        // ================ 容器信号 ================
+        
+        /**
+         * 让(x, y, z)处的比较器读取(cx, cy, cz)处的容器，signal为容器当前的填充信号（0-15）
+         * 之后比较器不再按输入重新计算，只在onContainerChanged通知该容器时更新输出
+         * 该位置不是比较器时返回false
+         */
+        bool bindComparatorContainer(int x, int y, int z, int cx, int cy, int cz, int signal) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            PaperRedstoneComponent* component = findComponent(PaperPosition(x, y, z));
+            if (!component || component->type != PaperRedstoneType::COMPARATOR) {
                 return false;
             }
+            auto* comparator = static_cast<PaperComparator*>(component);
+            if (comparator->readsContainer()) {
+                unbindContainerReader(comparator);
+            }
+            const PaperPosition container(cx, cy, cz);
+            ContainerState& state = containers_[container];
+            state.readers.push_back(comparator);
+            state.signal = std::max(0, std::min(15, signal));
+            comparator->bindContainer(container, state.signal);
+            applyPower(comparator->position, comparator->calculateOutput(0));
+            return true;
+        }
+        
+        /**
+         * 容器内容变化通知（Java在容器setChanged时调用，signal为新的填充信号）
+         * 信号不变时直接返回；变化时只重新计算读取该容器的比较器
+         */
+        void onContainerChanged(int cx, int cy, int cz, int signal) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            auto it = containers_.find(PaperPosition(cx, cy, cz));
+            if (it == containers_.end()) {
+                return;
+            }
+            ContainerState& state = it->second;
+            signal = std::max(0, std::min(15, signal));
+            if (state.signal == signal) {
+                stats_.containerChangesSkipped++;
+                return;
+            }
+            state.signal = signal;
+            for (PaperComparator* comparator : state.readers) {
+                comparator->setContainerSignal(signal);
+                applyPower(comparator->position, comparator->calculateOutput(0));
+                stats_.comparatorsRecomputed++;
+            }
+        }
+        
+        // ================ 传播模式与方块更新 ================
+        
+        /**
+         * 切换传播模式：离开PARALLEL前先求值还没处理的网络，离开SCHEDULED时退出回放并丢弃计划刻
+         */
+        void setPropagationMode(PropagationMode mode) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            if (mode == propagationMode_) {
+                return;
+            }
+            if (propagationMode_ == PropagationMode::PARALLEL) {
+                evaluatePendingNetworks();
+            } else if (propagationMode_ == PropagationMode::SCHEDULED) {
+                leaveCycleReplay();
+                clearScheduledTicks();
+            }
+            propagationMode_ = mode;
+        }
+        
+        PropagationMode getPropagationMode() const {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            return propagationMode_;
+        }
+        
+        /**
+         * 取出待发送的方块更新（ALTERNATE_CURRENT模式与queueNeighborUpdates产生）
+         * 顺序同drainBlockUpdates，每个位置只出现一次，调用方据此通知邻居方块
+         */
+        std::vector<PaperPosition> takeBlockUpdates() {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            std::vector<PaperPosition> updates;
+            updates.reserve(blockUpdates_.size());
+            blockUpdates_.drain(blockUpdates_.size(), [&](const PaperPosition& pos) { updates.push_back(pos); });
+            return updates;
+        }
+        
+        // ================ SCHEDULED模式 ================
+        
+        /**
+         * 时钟检测与稳态回放（默认关闭，只在SCHEDULED模式下生效），
+         * 每回放verifyIntervalCycles个周期真实运行一个周期做校验
+         */
+        void setCycleMemoization(bool enabled, uint32_t verifyIntervalCycles = CycleMemo::DEFAULT_VERIFY_INTERVAL) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            leaveCycleReplay();
+            cycleMemo_.setEnabled(enabled, verifyIntervalCycles);
+        }
+        
+        CycleMemo::Stats getCycleMemoStats() const {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            return cycleMemo_.stats();
+        }
+        
+        // 已推进的tick数
+        uint64_t currentTick() const {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            return tickCount_;
+        }
+        
+        // ================ PARALLEL模式 ================
+        
+        /**
+         * 红石网络的开销统计（只统计PARALLEL模式下的求值）
+         * networkId为网络中位置最小的红石线的BlockPos.asLong，引擎不区分世界，worldId恒为0
+         */
+        struct NetworkProfile {
+            int64_t networkId = 0;
+            int32_t worldId = 0;
+            PaperPosition min;
+            PaperPosition max;
+            uint64_t evaluations = 0;        // 累计求值次数
+            uint64_t updates = 0;            // 累计功率变化的红石线数
+            double nanosPerTick = 0.0;       // 最近一段时间平均每tick的估计耗时
+            double updatesPerTick = 0.0;     // 最近一段时间平均每tick的功率变化数
+        };
+        
+        static constexpr uint32_t DEFAULT_PROFILE_SAMPLE_INTERVAL = 16;
+        static constexpr double PROFILE_HALF_LIFE_TICKS = 1200.0;   // 一分钟
+        
+        // 计数精确，耗时每sampleInterval次求值采样一次并按间隔放大；关闭时丢弃已有统计
+        void setProfiling(bool enabled, uint32_t sampleInterval = DEFAULT_PROFILE_SAMPLE_INTERVAL) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            profilingEnabled_ = enabled;
+            profileSampleInterval_ = std::max<uint32_t>(sampleInterval, 1);
+            if (!enabled) {
+                profiles_.clear();
+            }
+        }
+        
+        // 按最近耗时从高到低的前limit个网络
+        std::vector<NetworkProfile> topNetworks(size_t limit) const {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            // 衰减和换算为每tick平均值：sum * (1 - 2^(-1/H))
+            const double perTick = 1.0 - std::exp2(-1.0 / PROFILE_HALF_LIFE_TICKS);
+            std::unordered_map<int64_t, const WireNetwork*> byId;
+            for (const WireNetwork& network : networks_) {
+                byId.emplace(network.id, &network);
+            }
             
-            components_[pos] = std::make_unique<PaperComparator>(pos, subtractMode);
-            stats_.totalComponents++;
+            std::vector<NetworkProfile> result;
+            result.reserve(profiles_.size());
+            for (const auto& [id, profile] : profiles_) {
+                const double decay = std::exp2(-static_cast<double>(tickCount_ - profile.lastTick) / PROFILE_HALF_LIFE_TICKS);
+                NetworkProfile entry;
+                entry.networkId = id;
+                if (auto it = byId.find(id); it != byId.end()) {
+                    entry.min = it->second->min;
+                    entry.max = it->second->max;
+                }
+                entry.evaluations = profile.evaluations;
+                entry.updates = profile.updates;
+                entry.nanosPerTick = profile.decayedNanos * decay * perTick;
+                entry.updatesPerTick = profile.decayedUpdates * decay * perTick;
+                result.push_back(entry);
+            }
+            auto costlier = [](const NetworkProfile& a, const NetworkProfile& b) {
+                if (a.nanosPerTick != b.nanosPerTick) {
+                    return a.nanosPerTick > b.nanosPerTick;
+                }
+                if (a.updatesPerTick != b.updatesPerTick) {
+                    return a.updatesPerTick > b.updatesPerTick;
+                }
+                return a.networkId < b.networkId;
+            };
+            const size_t count = std::min(limit, result.size());
+            std::partial_sort(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(count), result.end(), costlier);
+            result.resize(count);
+            return result;
+        }
+        
+        /**
+         * 从(x, y, z)出发沿红石线走不超过maxDistance格能到达的最大功率（包括该位置本身）
+         */
+        int networkPower(int x, int y, int z, int maxDistance) {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            const PaperPosition origin(x, y, z);
+            PaperRedstoneComponent* start = findComponent(origin);
+            int best = start ? start->getPower() : 0;
             
-            std::cout << "[Lattice Redstone] Registered comparator at (" << x << "," << y << "," << z << ") mode=" << (subtractMode ? "subtract" : "compare") << std::endl;
-            return true;
+            core::FrameScope frameScope;
+            std::pmr::memory_resource* frame = core::FrameAllocator::instance().resource();
+            std::pmr::map<PaperPosition, int> distance(frame);
+            core::FrameVector<PaperPosition> queue(frame);
+            auto visit = [&](const PaperPosition& pos, int steps) {
+                if (steps > maxDistance) {
+                    return;
+                }
+                if (PaperRedstoneWire* wire = findWire(pos); wire && distance.emplace(pos, steps).second) {
+                    best = std::max(best, wire->getPower());
+                    queue.push_back(pos);
+                }
+            };
+            visit(origin, 0);
+            if (distance.empty()) {
+                for (int d = 0; d < 6; ++d) {
+                    visit(offset(origin, d), 1);
+                }
+            }
+            for (size_t head = 0; head < queue.size(); ++head) {
+                const PaperPosition pos = queue[head];
+                const int steps = distance.at(pos);
+                for (int d = 0; d < 6; ++d) {
+                    visit(offset(pos, d), steps + 1);
+                }
+            }
+            return best;
+        }
+        
+        // 丢弃编译好的红石网络，下一次PARALLEL求值时重新划分（组件注册与移除会自动触发）
+        void invalidateNetworks() {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            networksDirty_ = true;
         }
         
         // ================ Tick推进 - Paper兼容 ================
@@ -300,14 +701,36 @@ namespace lattice::redstone::paper {
          * 推进一个tick - 与Paper的tick系统兼容
          */
         void tick() {
+            LATTICE_TRACE_SPAN("redstone", "PaperCompatibleRedstoneEngine::tick");
             auto start = std::chrono::steady_clock::now();
             
-            // 处理延迟组件（如中继器）
-            processDelayedSignals();
+            // 上一tick的组件注册在tick边界合并进查询索引
+            index_.publish();
+            
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            ++tickCount_;
+            switch (propagationMode_) {
+                case PropagationMode::LEGACY:
+                    // 处理延迟组件（如中继器）
+                    processDelayedSignals();
+                    break;
+                case PropagationMode::ALTERNATE_CURRENT:
+                    break;
+                case PropagationMode::SCHEDULED:
+                    processScheduledTick();
+                    break;
+                case PropagationMode::PARALLEL:
+                    evaluatePendingNetworks();
+                    break;
+            }
             
             // 更新性能统计
             auto end = std::chrono::steady_clock::now();
             auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            static core::Histogram& tickSeconds = core::MetricsRegistry::instance().histogram(
+                "lattice_redstone_tick_duration_seconds", "Native redstone engine tick time",
+                core::Histogram::latencyBuckets(), {{"engine", "paper"}});
+            tickSeconds.observe(std::chrono::duration<double>(end - start).count());
             stats_.circuitTicks++;
             stats_.avgProcessingTimeMs = (stats_.avgProcessingTimeMs * (stats_.circuitTicks - 1) + 
                                         duration.count() / 1000.0) / stats_.circuitTicks;
@@ -336,16 +759,54 @@ namespace lattice::redstone::paper {
             long long circuitTicks = 0;
             double avgProcessingTimeMs = 0.0;
             long long memoryUsageBytes = 0;
+            long long wiresRecomputed = 0;       // ALTERNATE_CURRENT模式下重新计算的红石线数
+            long long blockUpdatesEmitted = 0;   // 产生的方块更新数（已去重）
+            long long blockUpdatesDeduplicated = 0;  // 因同一tick内已在队列中而合并掉的更新数
+            long long comparatorsRecomputed = 0; // 因容器变化重新计算的比较器数
+            long long containerChangesSkipped = 0;   // 填充信号未变而忽略的容器通知数
+            long long scheduledTicksProcessed = 0;   // SCHEDULED模式下改变了输出的计划刻数
+            long long networksEvaluated = 0;     // PARALLEL模式下求值的红石网络数
+            long long parallelTicks = 0;         // PARALLEL模式下在线程池上并行求值的tick数
+            long long networkRebuilds = 0;       // 重新划分红石网络的次数
             bool healthy = true;
         };
         
         PerformanceStats getPerformanceStats() const {
+            std::lock_guard<std::mutex> lock(componentMutex_);
             PerformanceStats result = stats_;
             result.memoryUsageBytes = components_.size() * sizeof(PaperRedstoneComponent);
             result.healthy = isHealthy();
             return result;
         }
         
+        // 清零计数，保留组件数
+        void resetPerformanceStats() {
+            std::lock_guard<std::mutex> lock(componentMutex_);
+            const long long totalComponents = stats_.totalComponents;
+            stats_ = PerformanceStats{};
+            stats_.totalComponents = totalComponents;
+        }
+        
+        /**
+         * 比较Java与本地引擎在同一组位置上的信号，逐项相等才算一致（时钟记忆的校验周期也用它）
+         */
+        static bool validateBehavior(const std::vector<int>& javaSignals, const std::vector<int>& nativeSignals) {
+            return javaSignals == nativeSignals;
+        }
+        
+        /**
+         * 优雅降级：校验不一致时由Java切回原版红石，引擎只记录这个状态
+         */
+        void enableGracefulDegradation() {
+            if (!gracefulDegradation_.exchange(true)) {
+                std::cerr << "[Lattice Redstone] Graceful degradation enabled - falling back to vanilla behavior" << std::endl;
+            }
+        }
+        
+        bool isGracefulDegradationEnabled() const {
+            return gracefulDegradation_.load();
+        }
+        
         /**
          * Ping测试 - Paper健康检查兼容
          */
@@ -358,7 +819,23 @@ namespace lattice::redstone::paper {
          */
         void restart() {
             std::lock_guard<std::mutex> lock(componentMutex_);
+            // 查询不加锁，组件延迟到下一次publish之后释放
+            for (auto& component : components_) {
+                index_.retire(std::move(component));
+            }
             components_.clear();
+            index_.stageClear();
+            containers_.clear();
+            blockUpdates_.clear();
+            if (cycleMemo_.replaying()) {
+                cycleMemo_.leaveReplay(false);
+            }
+            cycleMemo_.onExternalInput();
+            scheduler_.clearPending();
+            networks_.clear();
+            networksDirty_ = true;
+            pendingOrigins_.clear();
+            profiles_.clear();
             stats_ = PerformanceStats{};
             std::cout << "[Lattice Redstone] Engine restarted" << std::endl;
         }
@@ -374,13 +851,695 @@ namespace lattice::redstone::paper {
         PaperCompatibleRedstoneEngine(PaperCompatibleRedstoneEngine&&) = delete;
         PaperCompatibleRedstoneEngine& operator=(PaperCompatibleRedstoneEngine&&) = delete;
         
-        // 组件存储
-        ComponentMap components_;
+        // 组件存储：components_按注册顺序持有组件，index_是唯一的按位置查找（查询API不加锁）
+        ComponentStore components_;
         mutable std::mutex componentMutex_;
+        SectionComponentIndex<PaperRedstoneComponent> index_;
         
         // 性能统计
         PerformanceStats stats_;
         
+        PropagationMode propagationMode_ = PropagationMode::LEGACY;
+        BlockUpdateQueue<PaperPosition> blockUpdates_;
+        uint64_t tickCount_ = 0;
+        std::atomic<bool> gracefulDegradation_{false};
+        
+        // SCHEDULED模式的状态
+        SignalScheduler<PaperPosition> scheduler_;
+        CycleMemo cycleMemo_;
+        std::vector<PaperPosition> changedWires_;           // updateWireSet本次功率变化的红石线
+        
+        // PARALLEL模式的状态
+        // 一个红石网络：相连的整组红石线，邻接按CSR存放（wires[i]的相邻红石线为links[linkOffsets[i]..linkOffsets[i + 1])，
+        // 相邻的非红石线组件同样按sourceOffsets存放在sources中）
+        struct WireNetwork {
+            int64_t id = 0;                                 // 位置最小的红石线的BlockPos.asLong
+            PaperPosition min;
+            PaperPosition max;
+            std::vector<PaperRedstoneWire*> wires;          // 按位置排序
+            std::vector<uint32_t> linkOffsets;
+            std::vector<uint32_t> links;
+            std::vector<uint32_t> sourceOffsets;
+            std::vector<PaperRedstoneComponent*> sources;
+            bool queued = false;                            // 已在本tick的待求值列表中
+        };
+        // 待求值网络的红石线数合计低于此值时串行求值
+        static constexpr size_t PARALLEL_MIN_POSITIONS = 4096;
+        std::vector<WireNetwork> networks_;
+        bool networksDirty_ = true;                         // 组件注册或移除后在下一次求值前重新划分
+        std::vector<PaperPosition> pendingOrigins_;         // 本tick内信号变化的位置
+        
+        // 网络开销统计：滚动值为按PROFILE_HALF_LIFE_TICKS衰减的和，使用时才补算衰减
+        struct ProfileState {
+            uint64_t evaluations = 0;
+            uint64_t updates = 0;
+            double decayedNanos = 0.0;
+            double decayedUpdates = 0.0;
+            uint64_t lastTick = 0;
+        };
+        std::unordered_map<int64_t, ProfileState> profiles_;
+        bool profilingEnabled_ = true;
+        uint32_t profileSampleInterval_ = DEFAULT_PROFILE_SAMPLE_INTERVAL;
+        
+        // 被比较器读取的容器：缓存的填充信号与读取它的比较器
+        struct ContainerState {
+            int signal = 0;
+            std::vector<PaperComparator*> readers;
+        };
+        std::map<PaperPosition, ContainerState> containers_;
+        
+        static constexpr int DIRECTIONS[6][3] = {
+            {1, 0, 0}, {-1, 0, 0}, {0, 1, 0},
+            {0, -1, 0}, {0, 0, 1}, {0, 0, -1}
+        };
+        
+        static PaperPosition offset(const PaperPosition& pos, int direction) {
+            return PaperPosition(pos.x + DIRECTIONS[direction][0], pos.y + DIRECTIONS[direction][1],
+                                 pos.z + DIRECTIONS[direction][2]);
+        }
+        
+        PaperRedstoneComponent* findComponent(const PaperPosition& pos) const {
+            return index_.find(pos.x, pos.y, pos.z);
+        }
+        
+        PaperRedstoneWire* findWire(const PaperPosition& pos) const {
+            PaperRedstoneComponent* component = findComponent(pos);
+            return component && component->type == PaperRedstoneType::WIRE ? static_cast<PaperRedstoneWire*>(component) : nullptr;
+        }
+        
+        static ComponentPtr createComponent(const PaperPosition& pos, PaperRedstoneType type, int param) {
+            switch (type) {
+                case PaperRedstoneType::WIRE:
+                    return std::make_unique<PaperRedstoneWire>(pos, type);
+                case PaperRedstoneType::REPEATER:
+                    return std::make_unique<PaperRepeater>(pos, param);
+                case PaperRedstoneType::COMPARATOR:
+                    return std::make_unique<PaperComparator>(pos, param != 0);
+                case PaperRedstoneType::TORCH: {
+                    auto torch = std::make_unique<PaperRedstoneTorch>(pos, type);
+                    torch->setPower(param != 0 ? 15 : 0);
+                    return torch;
+                }
+                case PaperRedstoneType::LEVER: {
+                    auto lever = std::make_unique<PaperRedstoneComponent>(pos, type);
+                    lever->setPower(param != 0 ? 15 : 0);
+                    return lever;
+                }
+                default:
+                    return std::make_unique<PaperRedstoneComponent>(pos, type);
+            }
+        }
+        
+        static const char* typeName(PaperRedstoneType type) {
+            switch (type) {
+                case PaperRedstoneType::WIRE: return "wire";
+                case PaperRedstoneType::REPEATER: return "repeater";
+                case PaperRedstoneType::COMPARATOR: return "comparator";
+                case PaperRedstoneType::TORCH: return "torch";
+                case PaperRedstoneType::LEVER: return "lever";
+                case PaperRedstoneType::BUTTON: return "button";
+                case PaperRedstoneType::PRESSURE_PLATE: return "pressure plate";
+                case PaperRedstoneType::OBSERVER: return "observer";
+                case PaperRedstoneType::PISTON: return "piston";
+            }
+            return "component";
+        }
+        
+        // 调用方持有componentMutex_且已确认该位置没有组件
+        PaperRedstoneComponent* addComponent(ComponentPtr component) {
+            PaperRedstoneComponent* added = component.get();
+            const PaperPosition& pos = added->position;
+            added->storeIndex = static_cast<uint32_t>(components_.size());
+            components_.push_back(std::move(component));
+            index_.stage(pos.x, pos.y, pos.z, added);
+            stats_.totalComponents++;
+            networksDirty_ = true;
+            return added;
+        }
+        
+        // 与末尾组件交换后移除（调用方持有componentMutex_）
+        void removeComponent(PaperRedstoneComponent* component) {
+            const uint32_t slot = component->storeIndex;
+            ComponentPtr removed = std::move(components_[slot]);
+            if (slot + 1 != components_.size()) {
+                components_[slot] = std::move(components_.back());
+                components_[slot]->storeIndex = slot;
+            }
+            components_.pop_back();
+            const PaperPosition& pos = removed->position;
+            index_.stage(pos.x, pos.y, pos.z, nullptr);
+            index_.retire(std::move(removed));
+            stats_.totalComponents--;
+            networksDirty_ = true;
+        }
+        
+        void unbindContainerReader(PaperComparator* comparator) {
+            auto it = containers_.find(comparator->containerPosition());
+            if (it == containers_.end()) {
+                return;
+            }
+            auto& readers = it->second.readers;
+            readers.erase(std::remove(readers.begin(), readers.end(), comparator), readers.end());
+            if (readers.empty()) {
+                containers_.erase(it);
+            }
+        }
+        
+        /**
+         * 设置一个位置的功率并按当前模式传播（调用方持有componentMutex_）
+         * 未注册的位置按红石线处理（Paper的行为）；SCHEDULED模式下这是外部输入，会退出时钟回放
+         */
+        void applyPower(const PaperPosition& pos, int power) {
+            leaveCycleReplay();
+            PaperRedstoneComponent* component = findComponent(pos);
+            if (!component) {
+                component = addComponent(std::make_unique<PaperRedstoneWire>(pos, PaperRedstoneType::WIRE));
+            }
+            
+            if (propagationMode_ == PropagationMode::LEGACY) {
+                component->setPower(power);
+            } else if (component->type == PaperRedstoneType::WIRE) {
+                // 红石线的功率由整组计算得出，这里记录的是它从外部（如被充能的方块）得到的输入
+                static_cast<PaperRedstoneWire*>(component)->externalInput = std::max(0, std::min(15, power));
+            } else {
+                setComponentPower(component, power);
+            }
+            propagateFrom(pos);
+            stats_.signalsProcessed++;
+        }
+        
+        // pos处的信号已经改变，按当前模式传播（调用方持有componentMutex_）
+        void propagateFrom(const PaperPosition& pos) {
+            switch (propagationMode_) {
+                case PropagationMode::LEGACY:
+                    propagateSignal(pos);
+                    break;
+                case PropagationMode::ALTERNATE_CURRENT:
+                    updateWireSet(pos);
+                    break;
+                case PropagationMode::SCHEDULED:
+                    // 红石线立即重算，受其影响的延迟组件排入计划刻
+                    changedWires_.clear();
+                    updateWireSet(pos, &changedWires_);
+                    scheduleNeighbors(pos);
+                    for (const PaperPosition& wire : changedWires_) {
+                        scheduleNeighbors(wire);
+                    }
+                    break;
+                case PropagationMode::PARALLEL:
+                    queueNetworkUpdate(pos);
+                    break;
+            }
+        }
+        
+        // 改变组件功率；SCHEDULED模式下同时记入时钟检测
+        void setComponentPower(PaperRedstoneComponent* component, int power) {
+            const int old = component->getPower();
+            component->setPower(power);
+            if (propagationMode_ == PropagationMode::SCHEDULED) {
+                cycleMemo_.onSignalChange(component->position, old, component->getPower());
+            }
+        }
+        
+        // 红石线的初始功率：外部输入与相邻非红石线组件的输出
+        int wireInput(const PaperRedstoneWire* wire) const {
+            int input = wire->externalInput;
+            for (int d = 0; d < 6; ++d) {
+                PaperRedstoneComponent* neighbor = findComponent(offset(wire->position, d));
+                if (neighbor && neighbor->type != PaperRedstoneType::WIRE && neighbor->isPoweredOutput()) {
+                    input = std::max(input, neighbor->getPower());
+                }
+            }
+            return input;
+        }
+        
+        /**
+         * 按功率从15到1分桶传播：levels为每根线的初始功率，每根线出桶一次，邻居得到功率 - 1
+         * forEachLink(node, visit)对node的每根相邻红石线下标调用visit；临时结构来自frame
+         */
+        template <typename Links>
+        static void spreadWirePower(std::span<uint8_t> levels, Links&& forEachLink, std::pmr::memory_resource* frame) {
+            // 内层vector按uses-allocator构造，同样来自frame
+            core::FrameVector<core::FrameVector<uint32_t>> buckets(16, frame);
+            for (uint32_t i = 0; i < levels.size(); ++i) {
+                if (levels[i] > 0) {
+                    buckets[levels[i]].push_back(i);
+                }
+            }
+            for (int level = 15; level > 1; --level) {
+                for (size_t k = 0; k < buckets[level].size(); ++k) {
+                    const uint32_t node = buckets[level][k];
+                    if (levels[node] != level) {
+                        continue;
+                    }
+                    forEachLink(node, [&](uint32_t neighbor) {
+                        if (levels[neighbor] < level - 1) {
+                            levels[neighbor] = static_cast<uint8_t>(level - 1);
+                            buckets[level - 1].push_back(neighbor);
+                        }
+                    });
+                }
+            }
+        }
+        
+        /**
+         * 重新计算与origin相连的整组红石线（调用方持有componentMutex_）
+         * 1. 从origin及其邻居出发收集相连的红石线，建立下标邻接
+         * 2. 每根线的初始功率为外部输入：Java设置的输入与相邻非红石线组件的输出
+         * 3. 按功率分桶传播（spreadWirePower）
+         * 4. 按位置顺序写回，功率变化的线及其六个邻居各记一次方块更新，changed非空时追加这些线的位置
+         * 每次重算的临时结构都来自帧分配器（大型线路每tick重算多次）
+         */
+        void updateWireSet(const PaperPosition& origin, std::vector<PaperPosition>* changed = nullptr) {
+            core::FrameScope frameScope;
+            std::pmr::memory_resource* frame = core::FrameAllocator::instance().resource();
+            core::FrameVector<PaperRedstoneWire*> wires(frame);
+            std::pmr::map<PaperPosition, uint32_t> index(frame);
+            auto visit = [&](const PaperPosition& pos) {
+                if (PaperRedstoneWire* wire = findWire(pos)) {
+                    if (index.emplace(pos, static_cast<uint32_t>(wires.size())).second) {
+                        wires.push_back(wire);
+                    }
+                }
+            };
+            visit(origin);
+            for (int d = 0; d < 6; ++d) {
+                visit(offset(origin, d));
+            }
+            
+            constexpr uint32_t NONE = UINT32_MAX;
+            core::FrameVector<std::array<uint32_t, 6>> links(frame);
+            for (size_t head = 0; head < wires.size(); ++head) {
+                std::array<uint32_t, 6> adjacent;
+                for (int d = 0; d < 6; ++d) {
+                    const PaperPosition neighbor = offset(wires[head]->position, d);
+                    visit(neighbor);
+                    auto it = index.find(neighbor);
+                    adjacent[d] = it != index.end() ? it->second : NONE;
+                }
+                links.push_back(adjacent);
+            }
+            
+            if (wires.empty()) {
+                // 非红石线组件变化且旁边没有线：只通知它的邻居
+                emitNeighborUpdates(origin);
+                return;
+            }
+            
+            core::FrameVector<uint8_t> levels(wires.size(), 0, frame);
+            for (uint32_t i = 0; i < wires.size(); ++i) {
+                levels[i] = static_cast<uint8_t>(wireInput(wires[i]));
+            }
+            spreadWirePower(levels, [&](uint32_t node, auto&& relax) {
+                for (uint32_t neighbor : links[node]) {
+                    if (neighbor != NONE) {
+                        relax(neighbor);
+                    }
+                }
+            }, frame);
+            
+            // index按位置有序，写回顺序与方块更新顺序都是确定的
+            for (const auto& [pos, i] : index) {
+                if (wires[i]->getPower() == levels[i]) {
+                    continue;
+                }
+                setComponentPower(wires[i], levels[i]);
+                emitNeighborUpdates(pos);
+                if (changed) {
+                    changed->push_back(pos);
+                }
+            }
+            stats_.wiresRecomputed += static_cast<long long>(wires.size());
+        }
+        
+        // ---------------- SCHEDULED：计划刻 ----------------
+        
+        // 由输入驱动、输出经计划刻更新的组件；拉杆、按钮、压力板、观察者的状态由Java设置
+        static bool isScheduledType(PaperRedstoneType type) {
+            return type == PaperRedstoneType::REPEATER || type == PaperRedstoneType::COMPARATOR ||
+                   type == PaperRedstoneType::TORCH || type == PaperRedstoneType::PISTON;
+        }
+        
+        // 组件的输入：相邻组件（含红石线）中最大的输出
+        int componentInput(const PaperRedstoneComponent* component) const {
+            int input = 0;
+            for (int d = 0; d < 6; ++d) {
+                PaperRedstoneComponent* neighbor = findComponent(offset(component->position, d));
+                if (neighbor && neighbor->isPoweredOutput()) {
+                    input = std::max(input, neighbor->getPower());
+                }
+            }
+            return input;
+        }
+        
+        // 输出会改变且还没有计划刻时排入时间轮（与原版相同，二极管优先级为HIGH，其他为NORMAL）
+        void scheduleTick(PaperRedstoneComponent* component) {
+            if (!isScheduledType(component->type) || component->tickScheduled) {
+                return;
+            }
+            const int input = componentInput(component);
+            if (component->calculateOutput(input) == component->getPower()) {
+                return;
+            }
+            const bool diode = component->type == PaperRedstoneType::REPEATER ||
+                               component->type == PaperRedstoneType::COMPARATOR;
+            component->tickScheduled = true;
+            scheduler_.scheduleEvent(component->position, input, std::max(1, component->getDelay()),
+                                     diode ? TickPriority::HIGH : TickPriority::NORMAL);
+        }
+        
+        void scheduleNeighbors(const PaperPosition& pos) {
+            for (int d = 0; d < 6; ++d) {
+                if (PaperRedstoneComponent* neighbor = findComponent(offset(pos, d))) {
+                    scheduleTick(neighbor);
+                }
+            }
+        }
+        
+        // 计划刻到期：按此时的输入重新计算输出（计划之后被移除的组件跳过）
+        void fireScheduledTick(const Event& event) {
+            PaperRedstoneComponent* component = findComponent(event.pos);
+            if (!component) {
+                return;
+            }
+            component->tickScheduled = false;
+            const int output = component->calculateOutput(componentInput(component));
+            if (output == component->getPower()) {
+                return;
+            }
+            setComponentPower(component, output);
+            stats_.scheduledTicksProcessed++;
+            propagateFrom(event.pos);
+        }
+        
+        void processScheduledTick() {
+            if (cycleMemo_.replaying()) {
+                replayCycleTick();
+                return;
+            }
+            scheduler_.tick([this](const Event& event) { fireScheduledTick(event); });
+            if (cycleMemo_.enabled()) {
+                endCycleMemoTick();
+            }
+        }
+        
+        // 丢弃全部计划刻（tick线程）
+        void clearScheduledTicks() {
+            std::vector<Event> pending;
+            scheduler_.snapshotPending(pending);
+            for (const Event& event : pending) {
+                if (PaperRedstoneComponent* component = findComponent(event.pos)) {
+                    component->tickScheduled = false;
+                }
+            }
+            scheduler_.clearPending();
+        }
+        
+        // ---------------- SCHEDULED：时钟检测与稳态回放 ----------------
+        
+        void replayCycleTick() {
+            // 调度器在回放期间为空，只推进tick
+            scheduler_.tick([](const Event&) {});
+            for (const auto& change : cycleMemo_.replayTick()) {
+                PaperRedstoneComponent* component = findComponent(change.pos);
+                if (component && component->getPower() != change.signal) {
+                    component->setPower(change.signal);
+                    emitNeighborUpdates(change.pos);
+                }
+            }
+            // 周期末尾按采样间隔真实运行下一个周期
+            if (cycleMemo_.shouldVerify()) {
+                restoreScheduledEvents(cycleMemo_.leaveReplay(true));
+            }
+        }
+        
+        void endCycleMemoTick() {
+            std::vector<Event> pending;
+            scheduler_.snapshotPending(pending);
+            switch (cycleMemo_.endTick(scheduler_.getCurrentTick(), pending)) {
+                case CycleMemo::TickOutcome::ENTER_REPLAY:
+                    clearScheduledTicks();
+                    break;
+                case CycleMemo::TickOutcome::VERIFY_READY: {
+                    std::vector<int> expected;
+                    std::vector<int> actual;
+                    cycleMemo_.verificationSignals(expected, actual);
+                    if (cycleMemo_.completeVerification(validateBehavior(expected, actual))) {
+                        clearScheduledTicks();
+                    }
+                    break;
+                }
+                case CycleMemo::TickOutcome::NONE:
+                    break;
+            }
+        }
+        
+        // 外部输入：退出回放并恢复调度器
+        void leaveCycleReplay() {
+            if (cycleMemo_.replaying()) {
+                restoreScheduledEvents(cycleMemo_.leaveReplay(false));
+            }
+            cycleMemo_.onExternalInput();
+        }
+        
+        void restoreScheduledEvents(const std::vector<Event>& relative) {
+            for (const auto& event : relative) {
+                scheduler_.scheduleEvent(event.pos, event.signal, static_cast<int>(event.tick), event.priority);
+                if (PaperRedstoneComponent* component = findComponent(event.pos)) {
+                    component->tickScheduled = true;
+                }
+            }
+        }
+        
+        // ---------------- PARALLEL：红石网络 ----------------
+        
+        // 记下信号变化的位置，tick时求值它所在的网络；旁边没有红石线时只通知邻居（同updateWireSet）
+        void queueNetworkUpdate(const PaperPosition& pos) {
+            bool nearWire = findWire(pos) != nullptr;
+            for (int d = 0; d < 6 && !nearWire; ++d) {
+                nearWire = findWire(offset(pos, d)) != nullptr;
+            }
+            if (!nearWire) {
+                emitNeighborUpdates(pos);
+                return;
+            }
+            pendingOrigins_.push_back(pos);
+        }
+        
+        /**
+         * 把全部红石线划分为网络并编译邻接（调用方持有componentMutex_，按components_顺序，结果确定）
+         * 不再存在的网络的开销统计一并丢弃
+         */
+        void rebuildNetworks() {
+            networks_.clear();
+            for (const auto& component : components_) {
+                component->network = PaperRedstoneComponent::NO_NETWORK;
+            }
+            std::vector<PaperRedstoneWire*> stack;
+            for (const auto& component : components_) {
+                if (component->type != PaperRedstoneType::WIRE || component->network != PaperRedstoneComponent::NO_NETWORK) {
+                    continue;
+                }
+                const auto id = static_cast<uint32_t>(networks_.size());
+                WireNetwork& network = networks_.emplace_back();
+                component->network = id;
+                stack.push_back(static_cast<PaperRedstoneWire*>(component.get()));
+                while (!stack.empty()) {
+                    PaperRedstoneWire* wire = stack.back();
+                    stack.pop_back();
+                    network.wires.push_back(wire);
+                    for (int d = 0; d < 6; ++d) {
+                        PaperRedstoneWire* neighbor = findWire(offset(wire->position, d));
+                        if (neighbor && neighbor->network == PaperRedstoneComponent::NO_NETWORK) {
+                            neighbor->network = id;
+                            stack.push_back(neighbor);
+                        }
+                    }
+                }
+                compileNetwork(network);
+            }
+            
+            std::unordered_map<int64_t, ProfileState> kept;
+            for (const WireNetwork& network : networks_) {
+                if (auto it = profiles_.find(network.id); it != profiles_.end()) {
+                    kept.emplace(network.id, it->second);
+                }
+            }
+            profiles_.swap(kept);
+            networksDirty_ = false;
+            stats_.networkRebuilds++;
+        }
+        
+        void compileNetwork(WireNetwork& network) {
+            auto byPosition = [](const PaperRedstoneWire* a, const PaperRedstoneWire* b) { return a->position < b->position; };
+            std::sort(network.wires.begin(), network.wires.end(), byPosition);
+            network.id = packBlockPos(network.wires.front()->position);
+            network.min = network.max = network.wires.front()->position;
+            network.linkOffsets.push_back(0);
+            network.sourceOffsets.push_back(0);
+            for (const PaperRedstoneWire* wire : network.wires) {
+                const PaperPosition& pos = wire->position;
+                network.min = PaperPosition(std::min(network.min.x, pos.x), std::min(network.min.y, pos.y), std::min(network.min.z, pos.z));
+                network.max = PaperPosition(std::max(network.max.x, pos.x), std::max(network.max.y, pos.y), std::max(network.max.z, pos.z));
+                for (int d = 0; d < 6; ++d) {
+                    PaperRedstoneComponent* neighbor = findComponent(offset(pos, d));
+                    if (!neighbor) {
+                        continue;
+                    }
+                    if (neighbor->type == PaperRedstoneType::WIRE) {
+                        auto it = std::lower_bound(network.wires.begin(), network.wires.end(),
+                                                   static_cast<PaperRedstoneWire*>(neighbor), byPosition);
+                        network.links.push_back(static_cast<uint32_t>(it - network.wires.begin()));
+                    } else {
+                        network.sources.push_back(neighbor);
+                    }
+                }
+                network.linkOffsets.push_back(static_cast<uint32_t>(network.links.size()));
+                network.sourceOffsets.push_back(static_cast<uint32_t>(network.sources.size()));
+            }
+        }
+        
+        // 只读组件状态，可以在工作线程上对互不相连的网络同时调用
+        static void evaluateNetwork(const WireNetwork& network, std::vector<uint8_t>& levels) {
+            levels.assign(network.wires.size(), 0);
+            for (size_t i = 0; i < network.wires.size(); ++i) {
+                int input = network.wires[i]->externalInput;
+                for (uint32_t k = network.sourceOffsets[i]; k < network.sourceOffsets[i + 1]; ++k) {
+                    const PaperRedstoneComponent* source = network.sources[k];
+                    if (source->isPoweredOutput()) {
+                        input = std::max(input, source->getPower());
+                    }
+                }
+                levels[i] = static_cast<uint8_t>(input);
+            }
+            core::FrameScope frameScope;
+            spreadWirePower(levels, [&](uint32_t node, auto&& relax) {
+                for (uint32_t k = network.linkOffsets[node]; k < network.linkOffsets[node + 1]; ++k) {
+                    relax(network.links[k]);
+                }
+            }, core::FrameAllocator::instance().resource());
+        }
+        
+        /**
+         * 求值本tick信号变化涉及的网络（调用方持有componentMutex_）
+         * 网络之间互不相连且只读取组件的当前状态，每个网络就是一个独立分区：待求值的红石线数合计
+         * 达到PARALLEL_MIN_POSITIONS且有多个网络时在线程池上并行求值，之后按网络顺序串行写回，
+         * 功率变化的线及其邻居各记一次方块更新，结果与ALTERNATE_CURRENT相同且顺序确定
+         */
+        void evaluatePendingNetworks() {
+            if (pendingOrigins_.empty()) {
+                return;
+            }
+            LATTICE_TRACE_SPAN("redstone", "PaperCompatibleRedstoneEngine::evaluatePendingNetworks");
+            if (networksDirty_) {
+                rebuildNetworks();
+            }
+            
+            struct Job {
+                uint32_t network;
+                std::vector<uint8_t> levels;
+                bool sampled = false;
+                uint64_t nanos = 0;
+                size_t updates = 0;
+            };
+            std::vector<uint32_t> queued;
+            auto enqueue = [&](const PaperPosition& pos) {
+                if (PaperRedstoneWire* wire = findWire(pos)) {
+                    WireNetwork& network = networks_[wire->network];
+                    if (!network.queued) {
+                        network.queued = true;
+                        queued.push_back(wire->network);
+                    }
+                }
+            };
+            for (const PaperPosition& origin : pendingOrigins_) {
+                enqueue(origin);
+                for (int d = 0; d < 6; ++d) {
+                    enqueue(offset(origin, d));
+                }
+            }
+            pendingOrigins_.clear();
+            std::sort(queued.begin(), queued.end());
+            
+            std::vector<Job> jobs;
+            jobs.reserve(queued.size());
+            size_t positions = 0;
+            for (uint32_t index : queued) {
+                WireNetwork& network = networks_[index];
+                network.queued = false;
+                Job job{index, {}};
+                job.sampled = profilingEnabled_ && profiles_[network.id].evaluations % profileSampleInterval_ == 0;
+                jobs.push_back(std::move(job));
+                positions += network.wires.size();
+            }
+            
+            auto run = [this](Job& job) {
+                const auto start = job.sampled ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+                evaluateNetwork(networks_[job.network], job.levels);
+                if (job.sampled) {
+                    job.nanos = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count());
+                }
+            };
+            if (jobs.size() > 1 && positions >= PARALLEL_MIN_POSITIONS) {
+                // 每个网络一块；调用线程也参与，全部网络求值结束后才返回
+                core::NativeRuntime::instance().pool().parallel_for(0, jobs.size(), [&](size_t begin, size_t end) {
+                    for (size_t i = begin; i < end; ++i) {
+                        run(jobs[i]);
+                    }
+                }, 1);
+                stats_.parallelTicks++;
+            } else {
+                for (Job& job : jobs) {
+                    run(job);
+                }
+            }
+            
+            for (Job& job : jobs) {
+                const WireNetwork& network = networks_[job.network];
+                for (size_t i = 0; i < network.wires.size(); ++i) {
+                    PaperRedstoneWire* wire = network.wires[i];
+                    if (wire->getPower() == job.levels[i]) {
+                        continue;
+                    }
+                    setComponentPower(wire, job.levels[i]);
+                    emitNeighborUpdates(wire->position);
+                    ++job.updates;
+                }
+                stats_.wiresRecomputed += static_cast<long long>(network.wires.size());
+                stats_.networksEvaluated++;
+                
+                if (profilingEnabled_) {
+                    ProfileState& profile = profiles_[network.id];
+                    const double decay = std::exp2(-static_cast<double>(tickCount_ - profile.lastTick) / PROFILE_HALF_LIFE_TICKS);
+                    profile.decayedNanos = profile.decayedNanos * decay +
+                                           static_cast<double>(job.nanos) * (job.sampled ? profileSampleInterval_ : 0);
+                    profile.decayedUpdates = profile.decayedUpdates * decay + static_cast<double>(job.updates);
+                    profile.lastTick = tickCount_;
+                    ++profile.evaluations;
+                    profile.updates += job.updates;
+                }
+            }
+        }
+        
+        // 位置本身及其六个邻居入队（调用方持有componentMutex_），返回新入队的条数
+        size_t emitNeighborUpdates(const PaperPosition& pos) {
+            const size_t added = blockUpdates_.pushWithNeighbors(pos);
+            stats_.blockUpdatesEmitted += static_cast<long long>(added);
+            stats_.blockUpdatesDeduplicated += static_cast<long long>(7 - added);
+            return added;
+        }
+        
+        uint8_t queryPower(int x, int y, int z) {
+            if (auto* component = index_.find(x, y, z)) {
+                const int power = std::clamp(component->getPower(), 0, 15);
+                return static_cast<uint8_t>(power | (component->isPoweredOutput() ? POWERED_FLAG : 0));
+            }
+            const PaperPosition pos(x, y, z);
+            const int power = std::clamp(calculateSignalFromNeighbors(pos), 0, 15);
+            return static_cast<uint8_t>(power | (checkAdjacentWires(pos) ? POWERED_FLAG : 0));
+        }
+        
         // 私有辅助方法
         bool checkAdjacentWires(const PaperPosition& pos) {
             // 检查周围的6个方向
@@ -390,9 +1549,8 @@ namespace lattice::redstone::paper {
             };
             
             for (const auto& dir : dirs) {
-                PaperPosition adjPos(pos.x + dir[0], pos.y + dir[1], pos.z + dir[2]);
-                auto it = components_.find(adjPos);
-                if (it != components_.end() && it->second->isPoweredOutput()) {
+                auto* adjacent = index_.find(pos.x + dir[0], pos.y + dir[1], pos.z + dir[2]);
+                if (adjacent && adjacent->isPoweredOutput()) {
                     return true;
                 }
             }
@@ -408,10 +1566,9 @@ namespace lattice::redstone::paper {
             };
             
             for (const auto& dir : dirs) {
-                PaperPosition adjPos(pos.x + dir[0], pos.y + dir[1], pos.z + dir[2]);
-                auto it = components_.find(adjPos);
-                if (it != components_.end()) {
-                    int signal = it->second->calculateOutput(it->second->getPower());
+                auto* adjacent = index_.find(pos.x + dir[0], pos.y + dir[1], pos.z + dir[2]);
+                if (adjacent) {
+                    int signal = adjacent->calculateOutput(adjacent->getPower());
                     maxSignal = std::max(maxSignal, signal);
                 }
             }
@@ -427,11 +1584,11 @@ namespace lattice::redstone::paper {
             
             for (const auto& dir : dirs) {
                 PaperPosition adjPos(pos.x + dir[0], pos.y + dir[1], pos.z + dir[2]);
-                auto it = components_.find(adjPos);
-                if (it != components_.end() && it->second->canReceiveSignal(getPower(pos.x, pos.y, pos.z))) {
-                    int newSignal = it->second->calculateOutput(getPower(pos.x, pos.y, pos.z));
-                    if (newSignal != it->second->getPower()) {
-                        it->second->setPower(newSignal);
+                PaperRedstoneComponent* adjacent = findComponent(adjPos);
+                if (adjacent && adjacent->canReceiveSignal(getPower(pos.x, pos.y, pos.z))) {
+                    int newSignal = adjacent->calculateOutput(getPower(pos.x, pos.y, pos.z));
+                    if (newSignal != adjacent->getPower()) {
+                        adjacent->setPower(newSignal);
                     }
                 }
             }
@@ -440,7 +1597,8 @@ namespace lattice::redstone::paper {
         void processDelayedSignals() {
             // 处理延迟组件的信号传递
             auto now = std::chrono::steady_clock::now();
-            for (auto& [pos, component] : components_) {
+            for (auto& component : components_) {
+                const PaperPosition& pos = component->position;
                 if (component->getDelay() > 0) {
                     // 检查是否需要处理延迟
                     auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - component->lastUpdate);
@@ -1,12 +0,0 @@
-#include "redstone_optimizer.hpp"
-#include <algorithm>
-#include <numeric>
-
-namespace lattice {
-namespace redstone {
-
-// RedstoneOptimizer implementation
-RedstoneOptimizer::RedstoneOptimizer() = default;
-
-} // namespace redstone
-} // namespace lattice
\ No newline at end of file
@@ -0,0 +1,238 @@
+#ifndef LATTICE_SECTION_COMPONENT_INDEX_HPP
+#define LATTICE_SECTION_COMPONENT_INDEX_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice::redstone {
+
+    /**
+     * 按区块段（16x16x16）组织的组件索引，查询不加锁
+     *
+     * 每个有组件的区块段是一个4096格的稠密数组，格子里存段内句柄（uint16，0表示空），
+     * 句柄指向段内的组件指针表。查询只需一次段查找加一次数组下标，读取已发布的快照，不取任何锁。
+     *
+     * 注册/移除先写入暂存表，在tick边界调用publish()时才合并进新快照（只复制改动过的段）并原子替换。
+     * 暂存表非空期间查询会加锁先查暂存表，所以写入对之后的查询立即可见；
+     * 没有结构变化的tick里查询全部走无锁路径。
+     *
+     * 被替换的快照和被移除的组件（retire）保留到下一次publish才释放，
+     * 因此读线程在一个tick内拿到的指针在该tick结束前都有效。
+     */
+    template <typename T>
+    class SectionComponentIndex {
+    public:
+        static constexpr int SECTION_VOLUME = 16 * 16 * 16;
+
+        SectionComponentIndex() : current_(new Snapshot()) {}
+
+        ~SectionComponentIndex() {
+            delete current_.load(std::memory_order_relaxed);
+        }
+
+        SectionComponentIndex(const SectionComponentIndex&) = delete;
+        SectionComponentIndex& operator=(const SectionComponentIndex&) = delete;
+
+        T* find(int x, int y, int z) const {
+            if (stagedWrites_.load(std::memory_order_acquire) != 0) {
+                std::lock_guard<std::mutex> lock(writeMutex_);
+                auto it = staged_.find(blockKey(x, y, z));
+                if (it != staged_.end()) {
+                    return it->second;
+                }
+                if (cleared_) {
+                    return nullptr;
+                }
+            }
+            return current_.load(std::memory_order_acquire)->find(x, y, z);
+        }
+
+        // 暂存写入，component为nullptr表示移除
+        void stage(int x, int y, int z, T* component) {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            staged_[blockKey(x, y, z)] = component;
+            stagedWrites_.store(staged_.size() + (cleared_ ? 1 : 0), std::memory_order_release);
+        }
+
+        // 暂存清空整个索引（之后暂存的写入仍然生效）
+        void stageClear() {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            staged_.clear();
+            cleared_ = true;
+            stagedWrites_.store(1, std::memory_order_release);
+        }
+
+        // 交给索引延迟释放：读线程可能仍持有该组件的指针
+        void retire(std::unique_ptr<T> component) {
+            if (!component) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            retiring_.push_back(std::move(component));
+        }
+
+        /**
+         * 合并暂存的写入并发布新快照（tick边界调用，同一时间只能有一个线程调用）
+         * 返回是否有结构变化
+         */
+        bool publish() {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            // 上一次publish留下的快照和组件已经过了一个tick
+            graveyardSnapshot_.reset();
+            graveyardComponents_ = std::move(retiring_);
+            retiring_.clear();
+
+            if (staged_.empty() && !cleared_) {
+                return false;
+            }
+
+            const Snapshot* old = current_.load(std::memory_order_relaxed);
+            auto next = std::make_unique<Snapshot>();
+            if (!cleared_) {
+                next->sections = old->sections;
+            }
+
+            // 每个改动的段只复制一次
+            std::unordered_map<uint64_t, Section*> copied;
+            for (const auto& [key, component] : staged_) {
+                const int x = blockX(key);
+                const int y = blockY(key);
+                const int z = blockZ(key);
+                const uint64_t section = sectionKey(x, y, z);
+
+                Section* target;
+                auto done = copied.find(section);
+                if (done != copied.end()) {
+                    target = done->second;
+                } else {
+                    auto existing = next->sections.find(section);
+                    std::shared_ptr<Section> copy;
+                    if (existing != next->sections.end()) {
+                        copy = std::make_shared<Section>(*existing->second);
+                    } else if (component) {
+                        copy = std::make_shared<Section>();
+                    } else {
+                        continue;   // 移除一个不存在的段里的组件
+                    }
+                    target = copy.get();
+                    next->sections[section] = std::move(copy);
+                    copied.emplace(section, target);
+                }
+                target->set(localIndex(x, y, z), component);
+            }
+            for (const auto& [section, target] : copied) {
+                if (target->live == 0) {
+                    next->sections.erase(section);
+                }
+            }
+
+            staged_.clear();
+            cleared_ = false;
+            current_.store(next.release(), std::memory_order_release);
+            stagedWrites_.store(0, std::memory_order_release);
+            graveyardSnapshot_.reset(old);
+            ++publishes_;
+            return true;
+        }
+
+        size_t sectionCount() const {
+            return current_.load(std::memory_order_acquire)->sections.size();
+        }
+
+        uint64_t publishCount() const {
+            std::lock_guard<std::mutex> lock(writeMutex_);
+            return publishes_;
+        }
+
+    private:
+        struct Section {
+            std::array<uint16_t, SECTION_VOLUME> handles{};   // slots下标 + 1
+            std::vector<T*> slots;
+            std::vector<uint16_t> freeSlots;
+            int live = 0;
+
+            T* get(int index) const {
+                const uint16_t handle = handles[index];
+                return handle ? slots[handle - 1] : nullptr;
+            }
+
+            void set(int index, T* component) {
+                uint16_t& handle = handles[index];
+                if (handle) {
+                    if (component) {
+                        slots[handle - 1] = component;
+                        return;
+                    }
+                    slots[handle - 1] = nullptr;
+                    freeSlots.push_back(static_cast<uint16_t>(handle - 1));
+                    handle = 0;
+                    --live;
+                    return;
+                }
+                if (!component) {
+                    return;
+                }
+                uint16_t slot;
+                if (!freeSlots.empty()) {
+                    slot = freeSlots.back();
+                    freeSlots.pop_back();
+                    slots[slot] = component;
+                } else {
+                    slot = static_cast<uint16_t>(slots.size());
+                    slots.push_back(component);
+                }
+                handle = static_cast<uint16_t>(slot + 1);
+                ++live;
+            }
+        };
+
+        struct Snapshot {
+            std::unordered_map<uint64_t, std::shared_ptr<const Section>> sections;
+
+            T* find(int x, int y, int z) const {
+                auto it = sections.find(sectionKey(x, y, z));
+                return it != sections.end() ? it->second->get(localIndex(x, y, z)) : nullptr;
+            }
+        };
+
+        static uint64_t sectionKey(int x, int y, int z) {
+            return ((static_cast<uint64_t>(static_cast<uint32_t>(x >> 4)) & 0x3FFFFF) << 42) |
+                   ((static_cast<uint64_t>(static_cast<uint32_t>(z >> 4)) & 0x3FFFFF) << 20) |
+                   (static_cast<uint64_t>(static_cast<uint32_t>(y >> 4)) & 0xFFFFF);
+        }
+
+        static int localIndex(int x, int y, int z) {
+            return ((y & 15) << 8) | ((z & 15) << 4) | (x & 15);
+        }
+
+        // 方块坐标打包：x、z各26位，y 12位（与原版BlockPos.asLong的范围相同）
+        static uint64_t blockKey(int x, int y, int z) {
+            return ((static_cast<uint64_t>(static_cast<uint32_t>(x)) & 0x3FFFFFF) << 38) |
+                   ((static_cast<uint64_t>(static_cast<uint32_t>(z)) & 0x3FFFFFF) << 12) |
+                   (static_cast<uint64_t>(static_cast<uint32_t>(y)) & 0xFFF);
+        }
+
+        static int blockX(uint64_t key) { return static_cast<int>(static_cast<int64_t>(key) >> 38); }
+        static int blockZ(uint64_t key) { return static_cast<int>(static_cast<int64_t>(key << 26) >> 38); }
+        static int blockY(uint64_t key) { return static_cast<int>(static_cast<int64_t>(key << 52) >> 52); }
+
+        std::atomic<const Snapshot*> current_;
+        std::atomic<size_t> stagedWrites_{0};
+
+        mutable std::mutex writeMutex_;
+        std::unordered_map<uint64_t, T*> staged_;
+        bool cleared_ = false;
+        std::vector<std::unique_ptr<T>> retiring_;
+        std::vector<std::unique_ptr<T>> graveyardComponents_;
+        std::unique_ptr<const Snapshot> graveyardSnapshot_;
+        uint64_t publishes_ = 0;
+    };
+
+} // namespace lattice::redstone
+
+#endif // LATTICE_SECTION_COMPONENT_INDEX_HPP
@@ -0,0 +1,316 @@
+#ifndef LATTICE_SIGNAL_CYCLE_MEMO_HPP
+#define LATTICE_SIGNAL_CYCLE_MEMO_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace lattice::redstone {
+
+    /**
+     * 红石时钟检测与稳态回放（可选模式）
+     *
+     * 每个tick结束时记录一个相位：本tick内组件信号的变化（按位置去重排序），以及计划中的事件
+     * （触发tick折算为相对当前tick的偏移）。相位哈希 = 组件信号的增量XOR哈希 + 计划事件的无序哈希，
+     * 两个tick哈希相同即整体状态相同。
+     *
+     * 最近CONFIRM_PERIODS个周期的相位哈希都与前一周期相同时确认周期p，进入回放：
+     * 清空调度器，之后每个tick只把该相位记录的信号变化写回组件，不再求值。
+     * 任何外部输入（组件注册、外部更新信号）都立即退出回放：按当前相位记录的计划事件恢复调度器，
+     * 再照常处理这个输入。
+     *
+     * 校验采样：每回放verifyInterval个周期，退出回放真实运行一个周期，
+     * 把实际结果交给调用方比较（PaperCompatibleRedstoneEngine::validateBehavior），一致则直接恢复回放，否则丢弃记录。
+     */
+    template <typename Event, typename Pos>
+    class SignalCycleMemo {
+    public:
+        static constexpr size_t MAX_PERIOD = 64;
+        static constexpr size_t CONFIRM_PERIODS = 2;
+        static constexpr size_t MAX_PHASE_EVENTS = 1024;    // 超过时不尝试记忆
+        static constexpr uint32_t DEFAULT_VERIFY_INTERVAL = 64;
+
+        struct Change {
+            Pos pos;
+            int signal;
+        };
+
+        struct Phase {
+            uint64_t hash = 0;
+            std::vector<Change> changes;
+            std::vector<Event> pending;   // tick为相对偏移
+        };
+
+        enum class TickOutcome {
+            NONE,
+            ENTER_REPLAY,     // 调用方应清空调度器
+            VERIFY_READY      // 校验周期结束，调用方比较verificationSignals后调用completeVerification
+        };
+
+        struct Stats {
+            uint64_t cyclesDetected = 0;
+            uint64_t replayedTicks = 0;
+            uint64_t exits = 0;                 // 因外部输入退出回放
+            uint64_t verifications = 0;
+            uint64_t verificationFailures = 0;
+            uint32_t period = 0;                // 当前记忆的周期，0表示没有
+        };
+
+        bool enabled() const { return enabled_; }
+        bool replaying() const { return replaying_; }
+        const Stats& stats() const { return stats_; }
+
+        void setEnabled(bool enabled, uint32_t verifyInterval = DEFAULT_VERIFY_INTERVAL) {
+            enabled_ = enabled;
+            verifyInterval_ = std::max<uint32_t>(verifyInterval, 1);
+            reset();
+        }
+
+        // 组件信号变化（正常求值时）
+        void onSignalChange(const Pos& pos, int oldSignal, int newSignal) {
+            if (!enabled_ || oldSignal == newSignal) {
+                return;
+            }
+            componentHash_ ^= signalHash(pos, oldSignal) ^ signalHash(pos, newSignal);
+            changes_.push_back(Change{pos, newSignal});
+        }
+
+        /**
+         * 正常tick结束（已处理完到期事件），pending为调度器中全部计划事件（绝对tick）
+         */
+        TickOutcome endTick(uint64_t tick, const std::vector<Event>& pending) {
+            if (!enabled_) {
+                return TickOutcome::NONE;
+            }
+            Phase phase;
+            phase.changes = normalize(std::move(changes_));
+            changes_.clear();
+            if (pending.size() > MAX_PHASE_EVENTS || phase.changes.size() > MAX_PHASE_EVENTS) {
+                onExternalInput();
+                return TickOutcome::NONE;
+            }
+            uint64_t pendingHash = 0;
+            phase.pending.reserve(pending.size());
+            for (Event event : pending) {
+                event.tick -= tick;
+                pendingHash += eventHash(event);
+                phase.pending.push_back(event);
+            }
+            phase.hash = mix(componentHash_ ^ mix(pendingHash + 0x9E3779B97F4A7C15ULL));
+
+            if (verifying_) {
+                actual_.push_back(std::move(phase));
+                return actual_.size() == cycle_.size() ? TickOutcome::VERIFY_READY : TickOutcome::NONE;
+            }
+
+            history_.push_back(std::move(phase));
+            if (history_.size() > (CONFIRM_PERIODS + 1) * MAX_PERIOD) {
+                history_.pop_front();
+            }
+            const size_t period = findPeriod();
+            if (period == 0) {
+                return TickOutcome::NONE;
+            }
+            cycle_.assign(history_.end() - static_cast<std::ptrdiff_t>(period), history_.end());
+            history_.clear();
+            bool idle = true;
+            for (const Phase& recorded : cycle_) {
+                idle = idle && recorded.changes.empty() && recorded.pending.empty();
+            }
+            if (idle) {
+                cycle_.clear();    // 空闲电路本来就没有工作量
+                return TickOutcome::NONE;
+            }
+            ++stats_.cyclesDetected;
+            startReplay();
+            return TickOutcome::ENTER_REPLAY;
+        }
+
+        /**
+         * 回放一个tick，返回要写回组件的信号变化
+         * 之后shouldVerify()为true时调用方应leaveReplay(true)恢复调度器进入校验周期
+         */
+        const std::vector<Change>& replayTick() {
+            const Phase& phase = cycle_[phase_];
+            phase_ = (phase_ + 1) % cycle_.size();
+            ++stats_.replayedTicks;
+            if (phase_ == 0) {
+                ++cyclesReplayed_;
+            }
+            return phase.changes;
+        }
+
+        // 回放到周期末尾且到了校验间隔
+        bool shouldVerify() const {
+            return replaying_ && phase_ == 0 && cyclesReplayed_ >= verifyInterval_;
+        }
+
+        /**
+         * 退出回放，返回需要恢复到调度器的计划事件（tick为相对当前tick的偏移）
+         * verify为true时保留记录并进入校验周期，否则视为外部输入
+         */
+        std::vector<Event> leaveReplay(bool verify) {
+            const size_t last = (phase_ + cycle_.size() - 1) % cycle_.size();
+            std::vector<Event> restore = cycle_[last].pending;
+            replaying_ = false;
+            componentHash_ = 0;
+            changes_.clear();
+            if (verify) {
+                // 从相位0开始真实运行一个周期；此时处于最后一个相位末，组件哈希与确认周期时相同
+                verifying_ = true;
+                actual_.clear();
+                componentHash_ = cycleComponentBase_;
+            } else {
+                ++stats_.exits;
+                cycle_.clear();
+                stats_.period = 0;
+            }
+            return restore;
+        }
+
+        // 外部输入：丢弃检测历史（回放中由调用方先leaveReplay）
+        void onExternalInput() {
+            if (!enabled_) {
+                return;
+            }
+            history_.clear();
+            if (verifying_) {
+                verifying_ = false;
+                cycle_.clear();
+                stats_.period = 0;
+            }
+        }
+
+        // 校验比较的数据：每个相位的变化(x, y, z, signal)与相位哈希
+        void verificationSignals(std::vector<int>& expected, std::vector<int>& actual) const {
+            auto flatten = [](const std::deque<Phase>& phases, std::vector<int>& out) {
+                for (const Phase& phase : phases) {
+                    for (const Change& change : phase.changes) {
+                        out.insert(out.end(), {change.pos.x, change.pos.y, change.pos.z, change.signal});
+                    }
+                    out.push_back(static_cast<int>(phase.hash & 0x7FFFFFFF));
+                    out.push_back(static_cast<int>(phase.hash >> 33));
+                }
+            };
+            flatten(cycle_, expected);
+            flatten(actual_, actual);
+        }
+
+        // 返回true表示恢复回放（调用方应清空调度器）
+        bool completeVerification(bool ok) {
+            verifying_ = false;
+            actual_.clear();
+            ++stats_.verifications;
+            if (!ok) {
+                ++stats_.verificationFailures;
+                cycle_.clear();
+                stats_.period = 0;
+                return false;
+            }
+            startReplay();
+            return true;
+        }
+
+    private:
+        void reset() {
+            replaying_ = false;
+            verifying_ = false;
+            history_.clear();
+            cycle_.clear();
+            actual_.clear();
+            changes_.clear();
+            componentHash_ = 0;
+            stats_.period = 0;
+        }
+
+        void startReplay() {
+            replaying_ = true;
+            phase_ = 0;
+            cyclesReplayed_ = 0;
+            stats_.period = static_cast<uint32_t>(cycle_.size());
+        }
+
+        // 最后CONFIRM_PERIODS * p个相位都与p之前的相同
+        size_t findPeriod() {
+            const size_t size = history_.size();
+            const uint64_t last = history_.back().hash;
+            for (size_t period = 1; period <= MAX_PERIOD && (CONFIRM_PERIODS + 1) * period <= size; ++period) {
+                if (history_[size - 1 - period].hash != last) {
+                    continue;
+                }
+                bool repeats = true;
+                for (size_t i = 0; i < CONFIRM_PERIODS * period && repeats; ++i) {
+                    repeats = history_[size - 1 - i].hash == history_[size - 1 - i - period].hash;
+                }
+                if (repeats) {
+                    cycleComponentBase_ = componentHash_;
+                    return period;
+                }
+            }
+            return 0;
+        }
+
+        static std::vector<Change> normalize(std::vector<Change> changes) {
+            // 同一位置只保留最后的值，按位置排序
+            std::stable_sort(changes.begin(), changes.end(),
+                             [](const Change& a, const Change& b) { return a.pos < b.pos; });
+            std::vector<Change> result;
+            for (const Change& change : changes) {
+                if (!result.empty() && result.back().pos == change.pos) {
+                    result.back().signal = change.signal;
+                } else {
+                    result.push_back(change);
+                }
+            }
+            return result;
+        }
+
+        static uint64_t mix(uint64_t value) {
+            value ^= value >> 33;
+            value *= 0xFF51AFD7ED558CCDULL;
+            value ^= value >> 33;
+            value *= 0xC4CEB9FE1A85EC53ULL;
+            value ^= value >> 33;
+            return value;
+        }
+
+        static uint64_t posHash(const Pos& pos) {
+            return mix((static_cast<uint64_t>(static_cast<uint32_t>(pos.x)) << 32) ^
+                       (static_cast<uint64_t>(static_cast<uint32_t>(pos.y)) << 16) ^
+                       static_cast<uint32_t>(pos.z));
+        }
+
+        // 信号为0的位置贡献为0
+        static uint64_t signalHash(const Pos& pos, int signal) {
+            return signal == 0 ? 0 : mix(posHash(pos) + static_cast<uint64_t>(signal));
+        }
+
+        static uint64_t eventHash(const Event& event) {
+            return mix(posHash(event.pos) ^ (event.tick << 24) ^
+                       (static_cast<uint64_t>(static_cast<uint32_t>(event.signal)) << 8) ^
+                       static_cast<uint64_t>(static_cast<int>(event.priority) + 3));
+        }
+
+        bool enabled_ = false;
+        bool replaying_ = false;
+        bool verifying_ = false;
+        uint32_t verifyInterval_ = DEFAULT_VERIFY_INTERVAL;
+
+        uint64_t componentHash_ = 0;        // 自上次重置以来变化过的组件的XOR哈希
+        uint64_t cycleComponentBase_ = 0;   // 确认周期时（最后一个相位末）的组件哈希
+        std::vector<Change> changes_;       // 本tick的信号变化
+        std::deque<Phase> history_;
+
+        std::deque<Phase> cycle_;           // 记忆的周期
+        std::deque<Phase> actual_;          // 校验周期的实际相位
+        size_t phase_ = 0;                  // 下一个回放的相位
+        uint32_t cyclesReplayed_ = 0;
+
+        Stats stats_;
+    };
+
+} // namespace lattice::redstone
+
+#endif // LATTICE_SIGNAL_CYCLE_MEMO_HPP
@@ -0,0 +1,258 @@
+#ifndef LATTICE_SIGNAL_SCHEDULER_HPP
+#define LATTICE_SIGNAL_SCHEDULER_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace lattice::redstone {
+
+    // 计划刻优先级 - 与原版TickPriority相同，数值小的先执行
+    enum class TickPriority : int8_t {
+        EXTREMELY_HIGH = -3,
+        VERY_HIGH = -2,
+        HIGH = -1,
+        NORMAL = 0,
+        LOW = 1,
+        VERY_LOW = 2,
+        EXTREMELY_LOW = 3
+    };
+
+    // 信号事件：在tick时以priority处理pos处的组件，signal为调度时的输入
+    template <typename Pos>
+    struct SignalEvent {
+        uint64_t tick;
+        Pos pos;
+        int signal;
+        TickPriority priority = TickPriority::NORMAL;
+    };
+
+    // ========== 分层时间轮 ==========
+
+    /**
+     * 两层时间轮：第0层256个槽、每槽1 tick，第1层64个槽、每槽256 tick，更远的事件进入溢出表。
+     * 第0层转完一圈时把第1层的下一个槽展开到第0层，第1层转完一圈时再从溢出表取出落入新范围的事件，
+     * 每个事件最多被搬两次，插入与到期都是O(1)。
+     *
+     * 第0层的槽按7个优先级分桶，桶内保持插入顺序，所以同一tick的事件按(优先级, 插入顺序)出队，
+     * 与原版计划刻的(触发tick, 优先级, subTickOrder)顺序一致。只在tick线程上使用。
+     */
+    template <typename Pos>
+    class TimingWheel {
+    public:
+        using Event = SignalEvent<Pos>;
+
+        static constexpr size_t LEVEL0_BITS = 8;
+        static constexpr size_t LEVEL1_BITS = 6;
+        static constexpr size_t LEVEL0_SLOTS = size_t{1} << LEVEL0_BITS;
+        static constexpr size_t LEVEL1_SLOTS = size_t{1} << LEVEL1_BITS;
+        static constexpr size_t PRIORITY_COUNT = 7;
+
+        // 早于当前tick的事件按当前tick处理
+        void insert(Event event) {
+            event.tick = std::max(event.tick, current_);
+            ++size_;
+            place(std::move(event));
+        }
+
+        // 按顺序取出当前tick的全部事件并前进一个tick
+        void expire(std::vector<Event>& out) {
+            auto& slot = level0_[current_ & (LEVEL0_SLOTS - 1)];
+            for (auto& bucket : slot) {
+                size_ -= bucket.size();
+                std::move(bucket.begin(), bucket.end(), std::back_inserter(out));
+                bucket.clear();
+            }
+            ++current_;
+            if ((current_ & (LEVEL0_SLOTS - 1)) == 0) {
+                cascade();
+            }
+        }
+
+        uint64_t currentTick() const { return current_; }
+        size_t size() const { return size_; }
+
+        // 按(tick, 优先级, 插入顺序)遍历（第1层与溢出表内按插入顺序）
+        template <typename Visit>
+        void forEach(Visit&& visit) const {
+            for (size_t i = 0; i < LEVEL0_SLOTS; ++i) {
+                for (const auto& bucket : level0_[(current_ + i) & (LEVEL0_SLOTS - 1)]) {
+                    for (const auto& event : bucket) {
+                        visit(event);
+                    }
+                }
+            }
+            for (size_t i = 0; i < LEVEL1_SLOTS; ++i) {
+                for (const auto& event : level1_[((current_ >> LEVEL0_BITS) + i) & (LEVEL1_SLOTS - 1)]) {
+                    visit(event);
+                }
+            }
+            for (const auto& event : overflow_) {
+                visit(event);
+            }
+        }
+
+        void clear() {
+            if (size_ == 0) {
+                return;
+            }
+            for (auto& slot : level0_) {
+                for (auto& bucket : slot) {
+                    bucket.clear();
+                }
+            }
+            for (auto& slot : level1_) {
+                slot.clear();
+            }
+            overflow_.clear();
+            size_ = 0;
+        }
+
+    private:
+        using Slot = std::array<std::vector<Event>, PRIORITY_COUNT>;
+
+        void place(Event event) {
+            if ((event.tick >> LEVEL0_BITS) == (current_ >> LEVEL0_BITS)) {
+                const auto priority = static_cast<size_t>(static_cast<int>(event.priority) + 3);
+                level0_[event.tick & (LEVEL0_SLOTS - 1)][std::min(priority, PRIORITY_COUNT - 1)].push_back(std::move(event));
+            } else if ((event.tick >> (LEVEL0_BITS + LEVEL1_BITS)) == (current_ >> (LEVEL0_BITS + LEVEL1_BITS))) {
+                level1_[(event.tick >> LEVEL0_BITS) & (LEVEL1_SLOTS - 1)].push_back(std::move(event));
+            } else {
+                overflow_.push_back(std::move(event));
+            }
+        }
+
+        // current_刚进入新的第0层范围
+        void cascade() {
+            if ((current_ & ((uint64_t{1} << (LEVEL0_BITS + LEVEL1_BITS)) - 1)) == 0 && !overflow_.empty()) {
+                std::vector<Event> far;
+                far.swap(overflow_);
+                for (auto& event : far) {
+                    place(std::move(event));
+                }
+            }
+            auto& slot = level1_[(current_ >> LEVEL0_BITS) & (LEVEL1_SLOTS - 1)];
+            std::vector<Event> events;
+            events.swap(slot);
+            for (auto& event : events) {
+                place(std::move(event));
+            }
+        }
+
+        std::array<Slot, LEVEL0_SLOTS> level0_;
+        std::array<std::vector<Event>, LEVEL1_SLOTS> level1_;
+        std::vector<Event> overflow_;
+        uint64_t current_ = 0;   // 下一个到期的tick
+        size_t size_ = 0;
+    };
+
+    // ========== 信号调度器 ==========
+
+    /**
+     * scheduleEvent可以在任意线程调用：事件无锁压入收件栈，tick线程在processEvents开始时
+     * 一次取走并插入时间轮。到期事件按时间轮给出的顺序交给调用方的处理函数。
+     */
+    template <typename Pos>
+    class SignalScheduler {
+    public:
+        using Event = SignalEvent<Pos>;
+
+        SignalScheduler() : currentTick_(0) {}
+
+        ~SignalScheduler() {
+            InboxNode* node = inbox_.exchange(nullptr, std::memory_order_acquire);
+            while (node) {
+                delete std::exchange(node, node->next);
+            }
+        }
+
+        SignalScheduler(const SignalScheduler&) = delete;
+        SignalScheduler& operator=(const SignalScheduler&) = delete;
+
+        // 调度信号事件（无锁，线程安全）
+        void scheduleEvent(Pos pos, int signal, int delay, TickPriority priority = TickPriority::NORMAL) {
+            auto tick = currentTick_.load(std::memory_order_relaxed) + static_cast<uint64_t>(std::max(delay, 0));
+            auto* node = new InboxNode{Event{tick, pos, signal, priority}, inbox_.load(std::memory_order_relaxed)};
+            while (!inbox_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+            }
+        }
+
+        /**
+         * 处理到期事件（tick线程），按(tick, 优先级, 调度顺序)依次调用handle(event)，保持原版的执行顺序
+         * handle中调度的事件最早在下一个tick到期
+         */
+        template <typename Handler>
+        void processEvents(Handler&& handle) {
+            drainInbox();
+
+            const auto now = currentTick_.load();
+            std::vector<Event> toProcess;
+            while (wheel_.currentTick() <= now) {
+                wheel_.expire(toProcess);
+            }
+            for (const auto& event : toProcess) {
+                handle(event);
+            }
+        }
+
+        // Tick推进
+        template <typename Handler>
+        void tick(Handler&& handle) {
+            currentTick_.fetch_add(1, std::memory_order_relaxed);
+            processEvents(handle);
+        }
+
+        uint64_t getCurrentTick() const { return currentTick_.load(); }
+
+        // 时间轮中等待的事件数（不含尚未取走的收件栈）
+        size_t pendingEventCount() const { return wheel_.size(); }
+
+        // 全部计划事件（先取走收件栈，tick线程）
+        void snapshotPending(std::vector<Event>& out) {
+            drainInbox();
+            out.reserve(out.size() + wheel_.size());
+            wheel_.forEach([&out](const Event& event) { out.push_back(event); });
+        }
+
+        // 丢弃全部计划事件（tick线程）
+        void clearPending() {
+            drainInbox();
+            wheel_.clear();
+        }
+
+    private:
+        struct InboxNode {
+            Event event;
+            InboxNode* next;
+        };
+
+        // 取走收件栈（LIFO）并按调度顺序插入时间轮
+        void drainInbox() {
+            InboxNode* node = inbox_.exchange(nullptr, std::memory_order_acquire);
+            InboxNode* ordered = nullptr;
+            while (node) {
+                InboxNode* next = node->next;
+                node->next = ordered;
+                ordered = node;
+                node = next;
+            }
+            while (ordered) {
+                wheel_.insert(ordered->event);
+                delete std::exchange(ordered, ordered->next);
+            }
+        }
+
+        std::atomic<uint64_t> currentTick_;
+        std::atomic<InboxNode*> inbox_{nullptr};
+        TimingWheel<Pos> wheel_;
+    };
+
+} // namespace lattice::redstone
+
+#endif // LATTICE_SIGNAL_SCHEDULER_HPP
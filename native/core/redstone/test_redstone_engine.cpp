@@ -1,138 +1,258 @@
-#include "redstone_engine.hpp"
-#include "redstone_components.hpp"
+#include "paper_compatible_redstone_engine.hpp"
+#include <algorithm>
 #include <iostream>
-#include <chrono>
-#include <thread>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 using namespace lattice::redstone;
+using namespace lattice::redstone::paper;
 
-// 启用调试输出
-#define DEBUG_REDSTONE
+using PropagationMode = PaperCompatibleRedstoneEngine::PropagationMode;
+
+namespace {
+
+// 注册组件时引擎逐个打印，大型线路的搭建期间关闭标准输出
+class SilenceStdout {
+public:
+    SilenceStdout() : previous_(std::cout.rdbuf(nullptr)) {}
+    ~SilenceStdout() { std::cout.rdbuf(previous_); }
+
+private:
+    std::streambuf* previous_;
+};
+
+void expectPower(PaperCompatibleRedstoneEngine& engine, int x, int y, int z, int expected, const std::string& what) {
+    const int actual = engine.getPower(x, y, z);
+    if (actual != expected) {
+        throw std::runtime_error(what + ": (" + std::to_string(x) + "," + std::to_string(y) + "," + std::to_string(z) +
+                                 ") 功率为" + std::to_string(actual) + "，期望" + std::to_string(expected));
+    }
+}
+
+// 每个测试从空引擎开始
+PaperCompatibleRedstoneEngine& freshEngine(PropagationMode mode) {
+    auto& engine = PaperCompatibleRedstoneEngine::getInstance();
+    SilenceStdout silence;
+    engine.restart();
+    engine.setPropagationMode(mode);
+    engine.setCycleMemoization(false);
+    return engine;
+}
+
+} // namespace
 
 void testBasicSignalPropagation() {
     std::cout << "\n=== 测试基本信号传播 ===" << std::endl;
     
-    auto& engine = RedstoneEngine::getInstance();
-    
-    // 创建一个拉杆
-    auto lever = factory::createLever(Position(0, 0, 0), false);
-    engine.registerComponent(std::move(lever));
+    auto& engine = freshEngine(PropagationMode::ALTERNATE_CURRENT);
+    engine.registerComponent(0, 0, 0, PaperRedstoneType::LEVER);
+    engine.registerRedstoneWire(1, 0, 0);
+    engine.registerRedstoneWire(2, 0, 0);
+    engine.registerRedstoneWire(3, 0, 0);
+    engine.tick();
     
-    // 创建一个红石线
-    auto wire1 = factory::createWire(Position(1, 0, 0));
-    auto wire2 = factory::createWire(Position(2, 0, 0));
-    engine.registerComponent(std::move(wire1));
-    engine.registerComponent(std::move(wire2));
+    engine.updatePower(0, 0, 0, 15);
+    expectPower(engine, 1, 0, 0, 15, "拉杆旁的红石线");
+    expectPower(engine, 3, 0, 0, 13, "每格衰减1");
     
-    std::cout << "初始状态: 拉杆关闭 (0,0,0) -> 信号 0" << std::endl;
+    // 移除中间的线：后面的线失去输入
+    if (!engine.unregisterComponent(2, 0, 0) || engine.unregisterComponent(2, 0, 0)) {
+        throw std::runtime_error("移除组件的返回值错误");
+    }
     engine.tick();
+    expectPower(engine, 1, 0, 0, 15, "移除后拉杆旁的红石线");
+    expectPower(engine, 3, 0, 0, 0, "断开的红石线");
     
-    // 模拟拉杆激活
-    std::cout << "\n拉杆激活，测试applySignal..." << std::endl;
-    engine.applySignal(Position(0, 0, 0), 15); // 拉杆应该输出15
-    
-    // 运行几个tick来观察信号传播
-    for (int i = 0; i < 5; i++) {
-        std::cout << "Tick " << i << ":" << std::endl;
-        engine.tick();
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto nearby = engine.componentsInRange(PaperPosition(0, 0, 0), 1);
+    if (nearby.size() != 2) {
+        throw std::runtime_error("范围查询应找到拉杆与一根红石线");
     }
+    std::cout << "  拉杆 -> 15 -> 13，移除中间的线后末端归零" << std::endl;
 }
 
-void testComponentFactory() {
-    std::cout << "\n=== 测试组件工厂 ===" << std::endl;
-    
-    auto& engine = RedstoneEngine::getInstance();
-    
-    // 创建不同类型的组件
-    auto repeater = factory::createRepeater(Position(5, 0, 0), 2); // 2 tick延迟
-    auto comparator = factory::createComparator(Position(6, 0, 0), 
-                                              RedstoneComparator::Mode::COMPARE);
-    auto torch = factory::createTorch(Position(7, 0, 0), false);
-    auto button = factory::createButton(Position(8, 0, 0), Button::Type::STONE);
-    
-    engine.registerComponent(std::move(repeater));
-    engine.registerComponent(std::move(comparator));
-    engine.registerComponent(std::move(torch));
-    engine.registerComponent(std::move(button));
+void testScheduledRepeaterDelay() {
+    std::cout << "\n=== 测试计划刻延迟 ===" << std::endl;
     
-    std::cout << "创建了中继器、比较器、火把和按钮组件" << std::endl;
-    
-    // 测试按钮按压
-    std::cout << "\n测试按钮按压..." << std::endl;
-    auto buttonComp = static_cast<Button*>(engine.queryComponentsInRange(Position(8, 0, 0), 1)[0]);
-    if (buttonComp) {
-        buttonComp->press();
-        engine.applySignal(Position(8, 0, 0), 15);
-    }
-    
-    // 测试火把
-    std::cout << "\n测试红石火把..." << std::endl;
-    engine.applySignal(Position(7, 0, 0), 0); // 无输入时火把应该输出15
+    // 拉杆 - 红石线 - 中继器(延迟2) - 红石线
+    auto& engine = freshEngine(PropagationMode::SCHEDULED);
+    engine.registerComponent(0, 0, 0, PaperRedstoneType::LEVER);
+    engine.registerRedstoneWire(1, 0, 0);
+    engine.registerRepeater(2, 0, 0, 2);
+    engine.registerRedstoneWire(3, 0, 0);
+    engine.tick();
     
+    engine.updatePower(0, 0, 0, 15);
+    expectPower(engine, 1, 0, 0, 15, "红石线立即更新");
+    expectPower(engine, 2, 0, 0, 0, "中继器在计划刻之前");
+    engine.tick();
+    expectPower(engine, 2, 0, 0, 0, "中继器在第1个tick");
+    expectPower(engine, 3, 0, 0, 0, "中继器之后的线在第1个tick");
     engine.tick();
+    expectPower(engine, 2, 0, 0, 15, "中继器在第2个tick");
+    expectPower(engine, 3, 0, 0, 15, "中继器之后的线在第2个tick");
+    if (engine.getPerformanceStats().scheduledTicksProcessed != 1) {
+        throw std::runtime_error("应只处理一个改变输出的计划刻");
+    }
+    std::cout << "  中继器的输出在2个tick之后到达" << std::endl;
 }
 
-void testPerformanceMonitoring() {
-    std::cout << "\n=== 测试性能监控 ===" << std::endl;
-    
-    auto& engine = RedstoneEngine::getInstance();
-    
-    // 重置统计
-    engine.resetPerformanceStats();
+void testCycleMemo() {
+    std::cout << "\n=== 测试时钟记忆 ===" << std::endl;
     
-    // 创建大量组件进行压力测试
-    for (int x = 0; x < 10; x++) {
-        for (int z = 0; z < 10; z++) {
-            if (x == 0 && z == 0) continue; // 跳过原点
-            
-            auto wire = factory::createWire(Position(x, 0, z));
-            engine.registerComponent(std::move(wire));
+    // 火把与相邻的红石线构成2 tick的时钟：开启记忆后的信号序列必须与真实求值相同
+    auto run = [](bool memo) {
+        auto& engine = freshEngine(PropagationMode::SCHEDULED);
+        engine.setCycleMemoization(memo, 4);
+        engine.registerComponent(0, 0, 0, PaperRedstoneType::TORCH, 1);
+        engine.registerRedstoneWire(1, 0, 0);
+        engine.tick();
+        engine.updatePower(0, 0, 0, 15);
+        std::vector<int> sequence;
+        for (int i = 0; i < 200; ++i) {
+            engine.tick();
+            sequence.push_back(engine.getPower(0, 0, 0) * 16 + engine.getPower(1, 0, 0));
         }
+        return std::make_pair(sequence, engine.getCycleMemoStats());
+    };
+    const auto [expected, plainStats] = run(false);
+    const auto [actual, memoStats] = run(true);
+    if (expected != actual) {
+        throw std::runtime_error("时钟回放的信号序列与真实求值不同");
+    }
+    if (memoStats.cyclesDetected == 0 || memoStats.replayedTicks == 0 || memoStats.verificationFailures != 0) {
+        throw std::runtime_error("没有检测到时钟或校验失败");
     }
+    std::cout << "  周期" << memoStats.period << "，回放" << memoStats.replayedTicks << "个tick，校验"
+              << memoStats.verifications << "次" << std::endl;
+}
+
+void testParallelMatchesAlternateCurrent() {
+    std::cout << "\n=== 测试并行求值 ===" << std::endl;
     
-    // 运行多次tick
-    auto startTime = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < 100; i++) {
+    // 多条互不相连的线，红石线合计超过并行阈值；两轮输入后比较每根线的功率与方块更新
+    constexpr int LINES = 32;
+    constexpr int LENGTH = 130;
+    auto run = [](PropagationMode mode) {
+        auto& engine = freshEngine(mode);
+        {
+            SilenceStdout silence;
+            for (int line = 0; line < LINES; ++line) {
+                engine.registerComponent(-1, 64, line * 3, PaperRedstoneType::LEVER);
+                for (int x = 0; x < LENGTH; ++x) {
+                    engine.registerRedstoneWire(x, 64, line * 3);
+                }
+            }
+        }
         engine.tick();
+        std::vector<int> powers;
+        std::vector<PaperPosition> updates;
+        for (int round = 0; round < 2; ++round) {
+            for (int line = 0; line < LINES; ++line) {
+                if (line % 2 == round) {
+                    engine.updatePower(-1, 64, line * 3, round == 0 ? 15 : 0);
+                } else {
+                    engine.updatePower(LENGTH / 2, 64, line * 3, 15 - line % 15);
+                }
+            }
+            engine.tick();
+            for (int line = 0; line < LINES; ++line) {
+                for (int x = 0; x < LENGTH; ++x) {
+                    powers.push_back(engine.getPower(x, 64, line * 3));
+                }
+            }
+            const auto taken = engine.takeBlockUpdates();
+            updates.insert(updates.end(), taken.begin(), taken.end());
+        }
+        return std::make_pair(powers, updates);
+    };
+    const auto [expectedPowers, expectedUpdates] = run(PropagationMode::ALTERNATE_CURRENT);
+    const auto [actualPowers, actualUpdates] = run(PropagationMode::PARALLEL);
+    if (expectedPowers != actualPowers || expectedUpdates != actualUpdates) {
+        throw std::runtime_error("PARALLEL的功率或方块更新与ALTERNATE_CURRENT不同");
     }
-    auto endTime = std::chrono::high_resolution_clock::now();
-    
-    // 获取性能统计
-    auto stats = engine.getPerformanceStats();
-    
-    std::cout << "性能统计:" << std::endl;
-    std::cout << "  总组件数: " << stats.totalComponents << std::endl;
-    std::cout << "  处理信号数: " << stats.signalsProcessed << std::endl;
-    std::cout << "  电路tick数: " << stats.circuitTicks << std::endl;
-    std::cout << "  平均处理时间: " << stats.avgProcessingTimeMs << " ms" << std::endl;
-    std::cout << "  内存使用: " << stats.memoryUsageBytes << " bytes" << std::endl;
     
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-    std::cout << "  总执行时间: " << duration.count() << " ms" << std::endl;
+    auto& engine = PaperCompatibleRedstoneEngine::getInstance();
+    const auto stats = engine.getPerformanceStats();
+    if (stats.parallelTicks != 2 || stats.networksEvaluated != 2 * LINES || stats.networkRebuilds != 1) {
+        throw std::runtime_error("并行求值统计错误");
+    }
+    const auto top = engine.topNetworks(3);
+    if (top.size() != 3 || top[0].evaluations != 2 || top[0].max.x - top[0].min.x != LENGTH - 1) {
+        throw std::runtime_error("网络开销统计错误");
+    }
+    if (engine.networkPower(LENGTH - 1, 64, 0, 4) != engine.getPower(LENGTH - 5, 64, 0)) {
+        throw std::runtime_error("networkPower应返回maxDistance内的最大功率");
+    }
+    std::cout << "  " << LINES << "个网络并行求值，结果与逐组重算一致" << std::endl;
 }
 
-void testRangeQueries() {
-    std::cout << "\n=== 测试范围查询 ===" << std::endl;
+void testTimingWheel() {
+    std::cout << "\n=== 测试时间轮 ===" << std::endl;
     
-    auto& engine = RedstoneEngine::getInstance();
+    // 事件编号放在pos.x；按(到期tick, 优先级, 插入顺序)排出期望顺序
+    struct Expected {
+        uint64_t tick;
+        int priority;
+        int id;
+    };
+    TimingWheel<PaperPosition> wheel;
+    std::vector<Expected> expected;
+    int nextId = 0;
+    auto insert = [&](uint64_t tick, TickPriority priority) {
+        const uint64_t due = std::max(tick, wheel.currentTick());
+        expected.push_back({due, static_cast<int>(priority), nextId});
+        wheel.insert(SignalEvent<PaperPosition>{tick, PaperPosition(nextId++, 0, 0), 0, priority});
+    };
+    constexpr uint64_t LEVEL1_SPAN = TimingWheel<PaperPosition>::LEVEL0_SLOTS * TimingWheel<PaperPosition>::LEVEL1_SLOTS;
     
-    // 在原点周围创建组件
-    engine.registerComponent(factory::createWire(Position(1, 0, 0)));
-    engine.registerComponent(factory::createWire(Position(-1, 0, 0)));
-    engine.registerComponent(factory::createWire(Position(0, 0, 1)));
-    engine.registerComponent(factory::createWire(Position(0, 0, -1)));
-    engine.registerComponent(factory::createRepeater(Position(2, 0, 0)));
+    // 第0层末尾、第1层首尾、溢出表边界上的事件，同一tick混合优先级
+    for (uint64_t tick : {uint64_t{0}, uint64_t{255}, uint64_t{256}, LEVEL1_SPAN - 1, LEVEL1_SPAN,
+                          LEVEL1_SPAN + 255, LEVEL1_SPAN + 256, 3 * LEVEL1_SPAN + 7}) {
+        insert(tick, TickPriority::LOW);
+        insert(tick, TickPriority::EXTREMELY_HIGH);
+        insert(tick, TickPriority::NORMAL);
+        insert(tick, TickPriority::LOW);
+        insert(tick, TickPriority::EXTREMELY_LOW);
+    }
     
-    // 范围查询测试
-    auto nearby = engine.queryComponentsInRange(Position(0, 0, 0), 2);
-    std::cout << "在原点(0,0,0)周围2格内找到 " << nearby.size() << " 个组件" << std::endl;
+    // 边走边插：包括已过期的tick和跨越各层边界的延迟
+    std::mt19937 rng(12345);
+    std::vector<std::pair<uint64_t, int>> delivered;   // (出队时的tick, 编号)
+    const uint64_t end = 4 * LEVEL1_SPAN;
+    std::vector<SignalEvent<PaperPosition>> due;
+    while (wheel.currentTick() < end) {
+        if (rng() % 8 == 0) {
+            const uint64_t now = wheel.currentTick();
+            const uint64_t delays[] = {0, 1, 255, 256, LEVEL1_SPAN - (now % LEVEL1_SPAN), LEVEL1_SPAN,
+                                       static_cast<uint64_t>(rng() % (2 * LEVEL1_SPAN))};
+            const uint64_t delay = delays[rng() % std::size(delays)];
+            const uint64_t tick = (rng() % 16 == 0 && now > 10) ? now - 10 : now + delay;
+            if (tick < end) {
+                insert(tick, static_cast<TickPriority>(static_cast<int>(rng() % 7) - 3));
+            }
+        }
+        const uint64_t tick = wheel.currentTick();
+        due.clear();
+        wheel.expire(due);
+        for (const auto& event : due) {
+            delivered.emplace_back(tick, event.pos.x);
+        }
+    }
     
-    for (const auto* component : nearby) {
-        auto pos = component->getPosition();
-        std::cout << "  组件在位置 (" << pos.x << "," << pos.y << "," << pos.z 
-                  << "), 类型: " << static_cast<int>(component->type) << std::endl;
+    std::stable_sort(expected.begin(), expected.end(), [](const Expected& a, const Expected& b) {
+        return a.tick != b.tick ? a.tick < b.tick : a.priority < b.priority;
+    });
+    if (wheel.size() != 0 || delivered.size() != expected.size()) {
+        throw std::runtime_error("时间轮丢失或残留事件");
     }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (delivered[i].first != expected[i].tick || delivered[i].second != expected[i].id) {
+            throw std::runtime_error("时间轮出队顺序错误: 第" + std::to_string(i) + "个事件");
+        }
+    }
+    std::cout << "  " << expected.size() << " 个事件按(tick, 优先级, 插入顺序)到期，跨越第1层与溢出表边界" << std::endl;
 }
 
 int main() {
@@ -141,9 +261,10 @@ int main() {
     
     try {
         testBasicSignalPropagation();
-        testComponentFactory();
-        testPerformanceMonitoring();
-        testRangeQueries();
+        testScheduledRepeaterDelay();
+        testCycleMemo();
+        testParallelMatchesAlternateCurrent();
+        testTimingWheel();
         
         std::cout << "\n✅ 所有测试完成！" << std::endl;
         
@@ -153,4 +274,4 @@ int main() {
     }
     
     return 0;
-}
\ No newline at end of file
+}
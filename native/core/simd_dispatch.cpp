@@ -0,0 +1,1173 @@
+#include "simd_dispatch.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define LATTICE_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define LATTICE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC/Clang：每个函数单独指定指令集，整个文件不需要-mavx2等编译选项；MSVC不需要
+#if defined(LATTICE_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define LATTICE_TARGET(features) __attribute__((target(features)))
+#else
+#define LATTICE_TARGET(features)
+#endif
+
+#define LATTICE_TARGET_SSE4 LATTICE_TARGET("ssse3,sse4.1,sse4.2")
+#define LATTICE_TARGET_AVX2 LATTICE_TARGET("avx2")
+#define LATTICE_TARGET_AVX512 LATTICE_TARGET("avx2,avx512f,avx512bw,avx512vl")
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+constexpr size_t LAYER_CELLS = 256;
+constexpr size_t LAYER_BYTES = LAYER_CELLS / 2;
+// 分离权重分母的下限：重合的同伴不产生无穷大（d为0，贡献也为0）
+constexpr float FLOCK_MIN_DIST_SQ = 1e-4f;
+
+inline uint32_t loadSwapped32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+#if defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#else
+    return __builtin_bswap32(value);
+#endif
+}
+
+inline uint64_t loadSwapped64(const uint8_t* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+#if defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#else
+    return __builtin_bswap64(value);
+#endif
+}
+
+/**
+ * 调色板下标在long内的移位量，按位宽索引（1..15）
+ * inOrder[bits][j]是第j个下标的移位，j >= 64/bits的位置为64（变量移位指令对>= 64的移位量得0）；
+ * interleaved每8个一组按j = 0,2,4,6,1,3,5,7排列，供AVX2把两组64位结果拼成按顺序的32位通道
+ */
+struct PaletteShiftTable {
+    uint64_t inOrder[16][64];
+    uint64_t interleaved[16][64];
+};
+
+constexpr PaletteShiftTable makePaletteShifts() {
+    PaletteShiftTable table{};
+    for (int bits = 1; bits < 16; ++bits) {
+        const int perWord = 64 / bits;
+        for (int j = 0; j < 64; ++j) {
+            table.inOrder[bits][j] = j < perWord ? static_cast<uint64_t>(j * bits) : 64;
+        }
+        for (int group = 0; group < 64; group += 8) {
+            for (int k = 0; k < 4; ++k) {
+                table.interleaved[bits][group + k] = table.inOrder[bits][group + 2 * k];
+                table.interleaved[bits][group + 4 + k] = table.inOrder[bits][group + 2 * k + 1];
+            }
+        }
+    }
+    return table;
+}
+
+[[maybe_unused]] constexpr PaletteShiftTable PALETTE_SHIFTS = makePaletteShifts();
+
+/**
+ * AVX-512按块解码：一块是lcm(64/bits, 8)个下标，正好占整数个long（不超过8个），
+ * 块内第g组8个下标中的第k个来自块内第wordOf[g][k]个long，移位为shiftOf[g][k]
+ */
+struct PaletteBlockTable {
+    uint8_t groups[16];
+    uint8_t words[16];
+    uint8_t wordOf[16][24][8];
+    uint8_t shiftOf[16][24][8];
+};
+
+constexpr PaletteBlockTable makePaletteBlocks() {
+    PaletteBlockTable table{};
+    for (int bits = 1; bits < 16; ++bits) {
+        const int perWord = 64 / bits;
+        int blockValues = perWord;
+        while (blockValues % 8 != 0) {
+            blockValues += perWord;
+        }
+        table.groups[bits] = static_cast<uint8_t>(blockValues / 8);
+        table.words[bits] = static_cast<uint8_t>(blockValues / perWord);
+        for (int n = 0; n < blockValues; ++n) {
+            table.wordOf[bits][n / 8][n % 8] = static_cast<uint8_t>(n / perWord);
+            table.shiftOf[bits][n / 8][n % 8] = static_cast<uint8_t>((n % perWord) * bits);
+        }
+    }
+    return table;
+}
+
+[[maybe_unused]] constexpr PaletteBlockTable PALETTE_BLOCKS = makePaletteBlocks();
+
+// ===== 标量实现（所有平台的基线，也用于各向量实现的尾部） =====
+
+namespace scalar {
+
+size_t filterInRange2D(const float* xs, const float* zs, const int* ids, size_t count,
+                       float centerX, float centerZ, float maxDistSq, int* out) {
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const float dx = xs[i] - centerX;
+        const float dz = zs[i] - centerZ;
+        if (dx * dx + dz * dz <= maxDistSq) {
+            out[written++] = ids[i];
+        }
+    }
+    return written;
+}
+
+size_t filterSlotsInRange2D(const float* xs, const float* zs, const int* ids,
+                            const uint32_t* slots, size_t count,
+                            float centerX, float centerZ, float maxDistSq, int* out) {
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t slot = slots[i];
+        const float dx = xs[slot] - centerX;
+        const float dz = zs[slot] - centerZ;
+        if (dx * dx + dz * dz <= maxDistSq) {
+            out[written++] = ids[slot];
+        }
+    }
+    return written;
+}
+
+size_t filterOverlapsYZ(const float* minY, const float* maxY, const float* minZ, const float* maxZ,
+                        size_t count, float queryMinY, float queryMaxY, float queryMinZ,
+                        float queryMaxZ, uint32_t base, uint32_t* out) {
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (minY[i] <= queryMaxY && maxY[i] >= queryMinY && minZ[i] <= queryMaxZ && maxZ[i] >= queryMinZ) {
+            out[written++] = base + static_cast<uint32_t>(i);
+        }
+    }
+    return written;
+}
+
+void accumulateFlock(const float* dx, const float* dy, const float* dz, const float* vx,
+                     const float* vy, const float* vz, size_t count, float separationRadiusSq,
+                     float out[9]) {
+    std::fill(out, out + 9, 0.0f);
+    for (size_t i = 0; i < count; ++i) {
+        const float distSq = dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i];
+        const float weight = std::min(distSq - separationRadiusSq, 0.0f) /
+                             (separationRadiusSq * std::max(distSq, FLOCK_MIN_DIST_SQ));
+        out[0] += dx[i];
+        out[1] += dy[i];
+        out[2] += dz[i];
+        out[3] += vx[i];
+        out[4] += vy[i];
+        out[5] += vz[i];
+        out[6] += dx[i] * weight;
+        out[7] += dy[i] * weight;
+        out[8] += dz[i] * weight;
+    }
+}
+
+void attenuateLayer(uint8_t* levels, const uint8_t* opacity) {
+    for (size_t i = 0; i < LAYER_CELLS; ++i) {
+        levels[i] = levels[i] > opacity[i] ? static_cast<uint8_t>(levels[i] - opacity[i]) : 0;
+    }
+}
+
+void packLayerNibbles(const uint8_t* levels, uint8_t* out) {
+    for (size_t i = 0; i < LAYER_BYTES; ++i) {
+        out[i] = static_cast<uint8_t>(levels[2 * i] | (levels[2 * i + 1] << 4));
+    }
+}
+
+bool layerUniform(const uint8_t* levels) {
+    return std::all_of(levels, levels + LAYER_CELLS, [first = levels[0]](uint8_t l) { return l == first; });
+}
+
+void findSpreadCells(const uint8_t* l, const uint8_t* o, uint64_t spread[4]) {
+    // 邻居穿过后得到的级别 max(0, L - max(1, 邻居透光值)) 高于邻居当前级别
+    auto gains = [&](size_t i, size_t n) {
+        const uint8_t loss = std::max<uint8_t>(1, o[n]);
+        return l[i] > loss && static_cast<uint8_t>(l[i] - loss) > l[n];
+    };
+    for (size_t i = 0; i < LAYER_CELLS; ++i) {
+        const size_t x = i & 15;
+        const bool spreads = (x != 15 && gains(i, i + 1)) || (x != 0 && gains(i, i - 1)) ||
+                             (i + 16 < LAYER_CELLS && gains(i, i + 16)) || (i >= 16 && gains(i, i - 16));
+        if (spreads) {
+            spread[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+}
+
+void byteSwapCopy32(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < count; ++i) {
+        const uint32_t value = loadSwapped32(src + i * 4);
+        std::memcpy(out + i * 4, &value, sizeof(value));
+    }
+}
+
+void byteSwapCopy64(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < count; ++i) {
+        const uint64_t value = loadSwapped64(src + i * 8);
+        std::memcpy(out + i * 8, &value, sizeof(value));
+    }
+}
+
+void unpackPaletteIndices(const uint64_t* words, int bits, uint16_t* out, size_t count) {
+    const size_t perWord = static_cast<size_t>(64 / bits);
+    const uint64_t mask = (uint64_t{1} << bits) - 1;
+    for (size_t i = 0, w = 0; i < count; ++w) {
+        uint64_t word = words[w];
+        const size_t end = std::min(count, i + perWord);
+        for (; i < end; ++i) {
+            out[i] = static_cast<uint16_t>(word & mask);
+            word >>= bits;
+        }
+    }
+}
+
+void packPaletteIndices(const uint16_t* values, size_t count, int bits, uint64_t* words) {
+    const size_t perWord = static_cast<size_t>(64 / bits);
+    const uint64_t mask = (uint64_t{1} << bits) - 1;
+    for (size_t i = 0, w = 0; i < count; ++w) {
+        uint64_t word = 0;
+        const size_t end = std::min(count, i + perWord);
+        for (int shift = 0; i < end; ++i, shift += bits) {
+            word |= (values[i] & mask) << shift;
+        }
+        words[w] = word;
+    }
+}
+
+} // namespace scalar
+
+#if defined(LATTICE_SIMD_X86)
+
+// ===== SSE4（128位） =====
+
+namespace sse4 {
+
+LATTICE_TARGET_SSE4
+size_t filterInRange2D(const float* xs, const float* zs, const int* ids, size_t count,
+                       float centerX, float centerZ, float maxDistSq, int* out) {
+    const __m128 cx = _mm_set1_ps(centerX);
+    const __m128 cz = _mm_set1_ps(centerZ);
+    const __m128 limit = _mm_set1_ps(maxDistSq);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + i), cx);
+        const __m128 dz = _mm_sub_ps(_mm_loadu_ps(zs + i), cz);
+        const __m128 distSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(distSq, limit)));
+        while (mask) {
+            out[written++] = ids[i + std::countr_zero(mask)];
+            mask &= mask - 1;
+        }
+    }
+    return written + scalar::filterInRange2D(xs + i, zs + i, ids + i, count - i,
+                                             centerX, centerZ, maxDistSq, out + written);
+}
+
+LATTICE_TARGET_SSE4
+size_t filterOverlapsYZ(const float* minY, const float* maxY, const float* minZ, const float* maxZ,
+                        size_t count, float queryMinY, float queryMaxY, float queryMinZ,
+                        float queryMaxZ, uint32_t base, uint32_t* out) {
+    const __m128 qMinY = _mm_set1_ps(queryMinY);
+    const __m128 qMaxY = _mm_set1_ps(queryMaxY);
+    const __m128 qMinZ = _mm_set1_ps(queryMinZ);
+    const __m128 qMaxZ = _mm_set1_ps(queryMaxZ);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 overlapY = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minY + i), qMaxY),
+                                           _mm_cmpge_ps(_mm_loadu_ps(maxY + i), qMinY));
+        const __m128 overlapZ = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minZ + i), qMaxZ),
+                                           _mm_cmpge_ps(_mm_loadu_ps(maxZ + i), qMinZ));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_and_ps(overlapY, overlapZ)));
+        while (mask) {
+            out[written++] = base + static_cast<uint32_t>(i + std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+    return written + scalar::filterOverlapsYZ(minY + i, maxY + i, minZ + i, maxZ + i, count - i,
+                                              queryMinY, queryMaxY, queryMinZ, queryMaxZ,
+                                              base + static_cast<uint32_t>(i), out + written);
+}
+
+LATTICE_TARGET_SSE4
+void accumulateFlock(const float* dx, const float* dy, const float* dz, const float* vx,
+                     const float* vy, const float* vz, size_t count, float separationRadiusSq,
+                     float out[9]) {
+    const __m128 sepSq = _mm_set1_ps(separationRadiusSq);
+    const __m128 minDistSq = _mm_set1_ps(FLOCK_MIN_DIST_SQ);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 sum[9];
+    for (auto& lane : sum) {
+        lane = zero;
+    }
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128 x = _mm_loadu_ps(dx + i);
+        const __m128 y = _mm_loadu_ps(dy + i);
+        const __m128 z = _mm_loadu_ps(dz + i);
+        const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        // min(distSq - sepSq, 0)为负的分离权重，乘到d上即远离同伴的方向
+        const __m128 weight = _mm_div_ps(_mm_min_ps(_mm_sub_ps(distSq, sepSq), zero), _mm_mul_ps(sepSq, _mm_max_ps(distSq, minDistSq)));
+        sum[0] = _mm_add_ps(sum[0], x);
+        sum[1] = _mm_add_ps(sum[1], y);
+        sum[2] = _mm_add_ps(sum[2], z);
+        sum[3] = _mm_add_ps(sum[3], _mm_loadu_ps(vx + i));
+        sum[4] = _mm_add_ps(sum[4], _mm_loadu_ps(vy + i));
+        sum[5] = _mm_add_ps(sum[5], _mm_loadu_ps(vz + i));
+        sum[6] = _mm_add_ps(sum[6], _mm_mul_ps(x, weight));
+        sum[7] = _mm_add_ps(sum[7], _mm_mul_ps(y, weight));
+        sum[8] = _mm_add_ps(sum[8], _mm_mul_ps(z, weight));
+    }
+    float tail[9];
+    scalar::accumulateFlock(dx + i, dy + i, dz + i, vx + i, vy + i, vz + i, count - i, separationRadiusSq, tail);
+    float lanes[4];
+    for (size_t k = 0; k < 9; ++k) {
+        _mm_storeu_ps(lanes, sum[k]);
+        float total = tail[k];
+        for (float lane : lanes) {
+            total += lane;
+        }
+        out[k] = total;
+    }
+}
+
+LATTICE_TARGET_SSE4
+void attenuateLayer(uint8_t* levels, const uint8_t* opacity) {
+    for (size_t i = 0; i < LAYER_CELLS; i += 16) {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(levels + i));
+        const __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(opacity + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(levels + i), _mm_subs_epu8(l, o));
+    }
+}
+
+LATTICE_TARGET_SSE4
+inline __m128i nibblePairs(__m128i v) {
+    // 16位通道 = 偶数格 | 奇数格 << 8，压成 偶数格 | 奇数格 << 4
+    return _mm_or_si128(_mm_and_si128(v, _mm_set1_epi16(0x00FF)),
+                        _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi16(0x00F0)));
+}
+
+LATTICE_TARGET_SSE4
+void packLayerNibbles(const uint8_t* levels, uint8_t* out) {
+    for (size_t i = 0; i < LAYER_CELLS; i += 32) {
+        const __m128i a = nibblePairs(_mm_loadu_si128(reinterpret_cast<const __m128i*>(levels + i)));
+        const __m128i b = nibblePairs(_mm_loadu_si128(reinterpret_cast<const __m128i*>(levels + i + 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i / 2), _mm_packus_epi16(a, b));
+    }
+}
+
+LATTICE_TARGET_SSE4
+bool layerUniform(const uint8_t* levels) {
+    const __m128i first = _mm_set1_epi8(static_cast<char>(levels[0]));
+    __m128i equal = _mm_set1_epi8(-1);
+    for (size_t i = 0; i < LAYER_CELLS; i += 16) {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(levels + i));
+        equal = _mm_and_si128(equal, _mm_cmpeq_epi8(l, first));
+    }
+    return _mm_movemask_epi8(equal) == 0xFFFF;
+}
+
+LATTICE_TARGET_SSE4
+inline __m128i spreadGain(__m128i level, const uint8_t* neighborLevel, const uint8_t* neighborOpacity) {
+    const __m128i nl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(neighborLevel));
+    const __m128i no = _mm_loadu_si128(reinterpret_cast<const __m128i*>(neighborOpacity));
+    const __m128i reached = _mm_subs_epu8(level, _mm_max_epu8(no, _mm_set1_epi8(1)));
+    return _mm_subs_epu8(reached, nl);            // 非0表示邻居可以变亮
+}
+
+LATTICE_TARGET_SSE4
+void findSpreadCells(const uint8_t* l, const uint8_t* o, uint64_t spread[4]) {
+    // 每次处理一整行：x±1越过行尾/行首的那一格用掩码去掉
+    const __m128i maskXp = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0);
+    const __m128i maskXm = _mm_setr_epi8(0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i zero = _mm_setzero_si128();
+    for (size_t i = 0; i < LAYER_CELLS; i += 16) {
+        const __m128i level = _mm_loadu_si128(reinterpret_cast<const __m128i*>(l + i));
+        __m128i any = _mm_and_si128(spreadGain(level, l + i + 1, o + i + 1), maskXp);
+        any = _mm_or_si128(any, _mm_and_si128(spreadGain(level, l + i - 1, o + i - 1), maskXm));
+        any = _mm_or_si128(any, spreadGain(level, l + i + 16, o + i + 16));
+        any = _mm_or_si128(any, spreadGain(level, l + i - 16, o + i - 16));
+        const uint64_t bits = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(any, zero))) & 0xFFFFu;
+        spread[i / 64] |= bits << (i % 64);
+    }
+}
+
+LATTICE_TARGET_SSE4
+void byteSwapCopy32(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    const __m128i mask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 4), _mm_shuffle_epi8(v, mask));
+    }
+    scalar::byteSwapCopy32(src + i * 4, out + i * 4, count - i);
+}
+
+LATTICE_TARGET_SSE4
+void byteSwapCopy64(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    const __m128i mask = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 8), _mm_shuffle_epi8(v, mask));
+    }
+    scalar::byteSwapCopy64(src + i * 8, out + i * 8, count - i);
+}
+
+} // namespace sse4
+
+// ===== AVX2（256位） =====
+
+namespace avx2 {
+
+LATTICE_TARGET_AVX2
+size_t filterInRange2D(const float* xs, const float* zs, const int* ids, size_t count,
+                       float centerX, float centerZ, float maxDistSq, int* out) {
+    const __m256 cx = _mm256_set1_ps(centerX);
+    const __m256 cz = _mm256_set1_ps(centerZ);
+    const __m256 limit = _mm256_set1_ps(maxDistSq);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), cx);
+        const __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(zs + i), cz);
+        const __m256 distSq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(distSq, limit, _CMP_LE_OQ)));
+        while (mask) {
+            out[written++] = ids[i + std::countr_zero(mask)];
+            mask &= mask - 1;
+        }
+    }
+    return written + scalar::filterInRange2D(xs + i, zs + i, ids + i, count - i,
+                                             centerX, centerZ, maxDistSq, out + written);
+}
+
+LATTICE_TARGET_AVX2
+size_t filterSlotsInRange2D(const float* xs, const float* zs, const int* ids,
+                            const uint32_t* slots, size_t count,
+                            float centerX, float centerZ, float maxDistSq, int* out) {
+    const __m256 cx = _mm256_set1_ps(centerX);
+    const __m256 cz = _mm256_set1_ps(centerZ);
+    const __m256 limit = _mm256_set1_ps(maxDistSq);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(slots + i));
+        const __m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(xs, index, 4), cx);
+        const __m256 dz = _mm256_sub_ps(_mm256_i32gather_ps(zs, index, 4), cz);
+        const __m256 distSq = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dz, dz));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(distSq, limit, _CMP_LE_OQ)));
+        while (mask) {
+            out[written++] = ids[slots[i + std::countr_zero(mask)]];
+            mask &= mask - 1;
+        }
+    }
+    return written + scalar::filterSlotsInRange2D(xs, zs, ids, slots + i, count - i,
+                                                  centerX, centerZ, maxDistSq, out + written);
+}
+
+LATTICE_TARGET_AVX2
+size_t filterOverlapsYZ(const float* minY, const float* maxY, const float* minZ, const float* maxZ,
+                        size_t count, float queryMinY, float queryMaxY, float queryMinZ,
+                        float queryMaxZ, uint32_t base, uint32_t* out) {
+    const __m256 qMinY = _mm256_set1_ps(queryMinY);
+    const __m256 qMaxY = _mm256_set1_ps(queryMaxY);
+    const __m256 qMinZ = _mm256_set1_ps(queryMinZ);
+    const __m256 qMaxZ = _mm256_set1_ps(queryMaxZ);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(minY + i), qMaxY, _CMP_LE_OQ),
+                                              _mm256_cmp_ps(_mm256_loadu_ps(maxY + i), qMinY, _CMP_GE_OQ));
+        const __m256 overlapZ = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(minZ + i), qMaxZ, _CMP_LE_OQ),
+                                              _mm256_cmp_ps(_mm256_loadu_ps(maxZ + i), qMinZ, _CMP_GE_OQ));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_and_ps(overlapY, overlapZ)));
+        while (mask) {
+            out[written++] = base + static_cast<uint32_t>(i + std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+    }
+    return written + scalar::filterOverlapsYZ(minY + i, maxY + i, minZ + i, maxZ + i, count - i,
+                                              queryMinY, queryMaxY, queryMinZ, queryMaxZ,
+                                              base + static_cast<uint32_t>(i), out + written);
+}
+
+LATTICE_TARGET_AVX2
+void accumulateFlock(const float* dx, const float* dy, const float* dz, const float* vx,
+                     const float* vy, const float* vz, size_t count, float separationRadiusSq,
+                     float out[9]) {
+    const __m256 sepSq = _mm256_set1_ps(separationRadiusSq);
+    const __m256 minDistSq = _mm256_set1_ps(FLOCK_MIN_DIST_SQ);
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 sum[9];
+    for (auto& lane : sum) {
+        lane = zero;
+    }
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256 x = _mm256_loadu_ps(dx + i);
+        const __m256 y = _mm256_loadu_ps(dy + i);
+        const __m256 z = _mm256_loadu_ps(dz + i);
+        const __m256 distSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+        // min(distSq - sepSq, 0)为负的分离权重，乘到d上即远离同伴的方向
+        const __m256 weight = _mm256_div_ps(_mm256_min_ps(_mm256_sub_ps(distSq, sepSq), zero), _mm256_mul_ps(sepSq, _mm256_max_ps(distSq, minDistSq)));
+        sum[0] = _mm256_add_ps(sum[0], x);
+        sum[1] = _mm256_add_ps(sum[1], y);
+        sum[2] = _mm256_add_ps(sum[2], z);
+        sum[3] = _mm256_add_ps(sum[3], _mm256_loadu_ps(vx + i));
+        sum[4] = _mm256_add_ps(sum[4], _mm256_loadu_ps(vy + i));
+        sum[5] = _mm256_add_ps(sum[5], _mm256_loadu_ps(vz + i));
+        sum[6] = _mm256_add_ps(sum[6], _mm256_mul_ps(x, weight));
+        sum[7] = _mm256_add_ps(sum[7], _mm256_mul_ps(y, weight));
+        sum[8] = _mm256_add_ps(sum[8], _mm256_mul_ps(z, weight));
+    }
+    float tail[9];
+    scalar::accumulateFlock(dx + i, dy + i, dz + i, vx + i, vy + i, vz + i, count - i, separationRadiusSq, tail);
+    float lanes[8];
+    for (size_t k = 0; k < 9; ++k) {
+        _mm256_storeu_ps(lanes, sum[k]);
+        float total = tail[k];
+        for (float lane : lanes) {
+            total += lane;
+        }
+        out[k] = total;
+    }
+}
+
+LATTICE_TARGET_AVX2
+void attenuateLayer(uint8_t* levels, const uint8_t* opacity) {
+    for (size_t i = 0; i < LAYER_CELLS; i += 32) {
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(levels + i));
+        const __m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(opacity + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(levels + i), _mm256_subs_epu8(l, o));
+    }
+}
+
+LATTICE_TARGET_AVX2
+inline __m256i nibblePairs(__m256i v) {
+    return _mm256_or_si256(_mm256_and_si256(v, _mm256_set1_epi16(0x00FF)),
+                           _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi16(0x00F0)));
+}
+
+LATTICE_TARGET_AVX2
+void packLayerNibbles(const uint8_t* levels, uint8_t* out) {
+    for (size_t i = 0; i < LAYER_CELLS; i += 64) {
+        const __m256i a = nibblePairs(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(levels + i)));
+        const __m256i b = nibblePairs(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(levels + i + 32)));
+        // packus按128位通道交错，再按64位重排回顺序
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i / 2), packed);
+    }
+}
+
+LATTICE_TARGET_AVX2
+bool layerUniform(const uint8_t* levels) {
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(levels[0]));
+    __m256i equal = _mm256_set1_epi8(-1);
+    for (size_t i = 0; i < LAYER_CELLS; i += 32) {
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(levels + i));
+        equal = _mm256_and_si256(equal, _mm256_cmpeq_epi8(l, first));
+    }
+    return _mm256_movemask_epi8(equal) == -1;
+}
+
+LATTICE_TARGET_AVX2
+inline __m256i spreadGain(__m256i level, const uint8_t* neighborLevel, const uint8_t* neighborOpacity) {
+    const __m256i nl = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(neighborLevel));
+    const __m256i no = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(neighborOpacity));
+    const __m256i reached = _mm256_subs_epu8(level, _mm256_max_epu8(no, _mm256_set1_epi8(1)));
+    return _mm256_subs_epu8(reached, nl);
+}
+
+LATTICE_TARGET_AVX2
+void findSpreadCells(const uint8_t* l, const uint8_t* o, uint64_t spread[4]) {
+    // 每次两行
+    const __m256i maskXp = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0);
+    const __m256i maskXm = _mm256_setr_epi8(
+        0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i zero = _mm256_setzero_si256();
+    for (size_t i = 0; i < LAYER_CELLS; i += 32) {
+        const __m256i level = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(l + i));
+        __m256i any = _mm256_and_si256(spreadGain(level, l + i + 1, o + i + 1), maskXp);
+        any = _mm256_or_si256(any, _mm256_and_si256(spreadGain(level, l + i - 1, o + i - 1), maskXm));
+        any = _mm256_or_si256(any, spreadGain(level, l + i + 16, o + i + 16));
+        any = _mm256_or_si256(any, spreadGain(level, l + i - 16, o + i - 16));
+        const uint32_t bits = ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(any, zero)));
+        spread[i / 64] |= static_cast<uint64_t>(bits) << (i % 64);
+    }
+}
+
+LATTICE_TARGET_AVX2
+void byteSwapCopy32(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    const __m256i mask = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4), _mm256_shuffle_epi8(v, mask));
+    }
+    scalar::byteSwapCopy32(src + i * 4, out + i * 4, count - i);
+}
+
+LATTICE_TARGET_AVX2
+void byteSwapCopy64(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    const __m256i mask = _mm256_setr_epi8(
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 8), _mm256_shuffle_epi8(v, mask));
+    }
+    scalar::byteSwapCopy64(src + i * 8, out + i * 8, count - i);
+}
+
+LATTICE_TARGET_AVX2
+void unpackPaletteIndices(const uint64_t* words, int bits, uint16_t* out, size_t count) {
+    const size_t perWord = static_cast<size_t>(64 / bits);
+    const size_t groups = (perWord + 7) / 8;
+    const uint64_t* shifts = PALETTE_SHIFTS.interleaved[bits];
+    const __m256i mask = _mm256_set1_epi64x(static_cast<long long>((uint64_t{1} << bits) - 1));
+    size_t i = 0;
+    size_t w = 0;
+    // 每组整写8个：超出本long的通道为0，随后被下一个long的结果覆盖，所以整组都要落在count以内
+    for (; i + groups * 8 <= count; ++w, i += perWord) {
+        const __m256i word = _mm256_set1_epi64x(static_cast<long long>(words[w]));
+        for (size_t g = 0; g < groups; ++g) {
+            const __m256i even = _mm256_and_si256(
+                _mm256_srlv_epi64(word, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shifts + g * 8))), mask);
+            const __m256i odd = _mm256_and_si256(
+                _mm256_srlv_epi64(word, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shifts + g * 8 + 4))), mask);
+            // 32位通道依次为第0..7个下标，收窄到16位后取两个128位通道的低半部分
+            const __m256i lanes = _mm256_or_si256(even, _mm256_slli_epi64(odd, 32));
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lanes, lanes), 0x08);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + g * 8), _mm256_castsi256_si128(packed));
+        }
+    }
+    scalar::unpackPaletteIndices(words + w, bits, out + i, count - i);
+}
+
+LATTICE_TARGET_AVX2
+void packPaletteIndices(const uint16_t* values, size_t count, int bits, uint64_t* words) {
+    const size_t perWord = static_cast<size_t>(64 / bits);
+    const size_t quads = (perWord + 3) / 4;
+    const uint64_t* shifts = PALETTE_SHIFTS.inOrder[bits];
+    const __m256i mask = _mm256_set1_epi64x(static_cast<long long>((uint64_t{1} << bits) - 1));
+    size_t i = 0;
+    size_t w = 0;
+    // 每次读4个下标：超出本long的通道移位量为64，结果为0
+    for (; i + quads * 4 <= count; ++w, i += perWord) {
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t q = 0; q < quads; ++q) {
+            const __m256i v = _mm256_cvtepu16_epi64(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(values + i + q * 4)));
+            acc = _mm256_or_si256(acc, _mm256_sllv_epi64(_mm256_and_si256(v, mask),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(shifts + q * 4))));
+        }
+        __m128i folded = _mm_or_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+        folded = _mm_or_si128(folded, _mm_unpackhi_epi64(folded, folded));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(words + w), folded);
+    }
+    scalar::packPaletteIndices(values + i, count - i, bits, words + w);
+}
+
+} // namespace avx2
+
+// ===== AVX-512（512位；光照层内核沿用AVX2，一层只有256格） =====
+
+namespace avx512 {
+
+LATTICE_TARGET_AVX512
+size_t filterInRange2D(const float* xs, const float* zs, const int* ids, size_t count,
+                       float centerX, float centerZ, float maxDistSq, int* out) {
+    const __m512 cx = _mm512_set1_ps(centerX);
+    const __m512 cz = _mm512_set1_ps(centerZ);
+    const __m512 limit = _mm512_set1_ps(maxDistSq);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512 dx = _mm512_sub_ps(_mm512_loadu_ps(xs + i), cx);
+        const __m512 dz = _mm512_sub_ps(_mm512_loadu_ps(zs + i), cz);
+        const __m512 distSq = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dz, dz));
+        const __mmask16 mask = _mm512_cmp_ps_mask(distSq, limit, _CMP_LE_OQ);
+        // 选中的id直接压紧写出
+        _mm512_mask_compressstoreu_epi32(out + written, mask, _mm512_loadu_si512(ids + i));
+        written += static_cast<size_t>(std::popcount(static_cast<unsigned>(mask)));
+    }
+    return written + scalar::filterInRange2D(xs + i, zs + i, ids + i, count - i,
+                                             centerX, centerZ, maxDistSq, out + written);
+}
+
+LATTICE_TARGET_AVX512
+size_t filterSlotsInRange2D(const float* xs, const float* zs, const int* ids,
+                            const uint32_t* slots, size_t count,
+                            float centerX, float centerZ, float maxDistSq, int* out) {
+    const __m512 cx = _mm512_set1_ps(centerX);
+    const __m512 cz = _mm512_set1_ps(centerZ);
+    const __m512 limit = _mm512_set1_ps(maxDistSq);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512i index = _mm512_loadu_si512(slots + i);
+        // 带掩码的全通道gather：GCC 12对不带掩码的版本会误报未初始化
+        const __m512 x = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, index, xs, 4);
+        const __m512 z = _mm512_mask_i32gather_ps(_mm512_setzero_ps(), 0xFFFF, index, zs, 4);
+        const __m512 dx = _mm512_sub_ps(x, cx);
+        const __m512 dz = _mm512_sub_ps(z, cz);
+        const __m512 distSq = _mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dz, dz));
+        const __mmask16 mask = _mm512_cmp_ps_mask(distSq, limit, _CMP_LE_OQ);
+        const __m512i selected = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), mask, index, ids, 4);
+        _mm512_mask_compressstoreu_epi32(out + written, mask, selected);
+        written += static_cast<size_t>(std::popcount(static_cast<unsigned>(mask)));
+    }
+    return written + scalar::filterSlotsInRange2D(xs, zs, ids, slots + i, count - i,
+                                                  centerX, centerZ, maxDistSq, out + written);
+}
+
+LATTICE_TARGET_AVX512
+size_t filterOverlapsYZ(const float* minY, const float* maxY, const float* minZ, const float* maxZ,
+                        size_t count, float queryMinY, float queryMaxY, float queryMinZ,
+                        float queryMaxZ, uint32_t base, uint32_t* out) {
+    const __m512 qMinY = _mm512_set1_ps(queryMinY);
+    const __m512 qMaxY = _mm512_set1_ps(queryMaxY);
+    const __m512 qMinZ = _mm512_set1_ps(queryMinZ);
+    const __m512 qMaxZ = _mm512_set1_ps(queryMaxZ);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        // 四个比较依次作为下一个比较的掩码，结果即全部满足的通道
+        __mmask16 mask = _mm512_cmp_ps_mask(_mm512_loadu_ps(minY + i), qMaxY, _CMP_LE_OQ);
+        mask = _mm512_mask_cmp_ps_mask(mask, _mm512_loadu_ps(maxY + i), qMinY, _CMP_GE_OQ);
+        mask = _mm512_mask_cmp_ps_mask(mask, _mm512_loadu_ps(minZ + i), qMaxZ, _CMP_LE_OQ);
+        mask = _mm512_mask_cmp_ps_mask(mask, _mm512_loadu_ps(maxZ + i), qMinZ, _CMP_GE_OQ);
+        const __m512i index = _mm512_add_epi32(lanes, _mm512_set1_epi32(static_cast<int>(base + i)));
+        _mm512_mask_compressstoreu_epi32(out + written, mask, index);
+        written += static_cast<size_t>(std::popcount(static_cast<unsigned>(mask)));
+    }
+    return written + scalar::filterOverlapsYZ(minY + i, maxY + i, minZ + i, maxZ + i, count - i,
+                                              queryMinY, queryMaxY, queryMinZ, queryMaxZ,
+                                              base + static_cast<uint32_t>(i), out + written);
+}
+
+LATTICE_TARGET_AVX512
+void byteSwapCopy32(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    // 每个128位通道内：字节 3 2 1 0 | 7 6 5 4 | 11 10 9 8 | 15 14 13 12
+    const __m512i mask = _mm512_set4_epi32(0x0C0D0E0F, 0x08090A0B, 0x04050607, 0x00010203);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m512i v = _mm512_loadu_si512(src + i * 4);
+        _mm512_storeu_si512(out + i * 4, _mm512_shuffle_epi8(v, mask));
+    }
+    avx2::byteSwapCopy32(src + i * 4, out + i * 4, count - i);
+}
+
+LATTICE_TARGET_AVX512
+void byteSwapCopy64(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    // 每个128位通道内：字节 7 6 5 4 3 2 1 0 | 15 14 13 12 11 10 9 8
+    const __m512i mask = _mm512_set4_epi32(0x08090A0B, 0x0C0D0E0F, 0x00010203, 0x04050607);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m512i v = _mm512_loadu_si512(src + i * 8);
+        _mm512_storeu_si512(out + i * 8, _mm512_shuffle_epi8(v, mask));
+    }
+    avx2::byteSwapCopy64(src + i * 8, out + i * 8, count - i);
+}
+
+/**
+ * 按块解码：整块读入（至多8个long），每组8个下标用permutexvar取各自所在的long再移位，
+ * 不论位宽每8个下标都只需一次移位和一次存储。
+ * 每个long只放4、5个下标时（bits >= 11）AVX2逐long处理有一半通道空转，这里约快1.5倍；
+ * 其余位宽AVX2实现的通道基本用满且不需要查表，仍用AVX2
+ */
+LATTICE_TARGET_AVX512
+void unpackPaletteIndices(const uint64_t* words, int bits, uint16_t* out, size_t count) {
+    if (bits < 11) {
+        avx2::unpackPaletteIndices(words, bits, out, count);
+        return;
+    }
+    const size_t groups = PALETTE_BLOCKS.groups[bits];
+    const size_t blockWords = PALETTE_BLOCKS.words[bits];
+    const size_t blockValues = groups * 8;
+    const auto wordMask = static_cast<__mmask8>((1u << blockWords) - 1);
+    const __m512i mask = _mm512_set1_epi64(static_cast<long long>((uint64_t{1} << bits) - 1));
+    size_t i = 0;
+    size_t w = 0;
+    for (; i + blockValues <= count; i += blockValues, w += blockWords) {
+        const __m512i block = _mm512_maskz_loadu_epi64(wordMask, words + w);
+        for (size_t g = 0; g < groups; ++g) {
+            // 带掩码的扩展与移位：GCC 12对不带掩码的版本会误报未初始化
+            const __m512i index = _mm512_maskz_cvtepu8_epi64(
+                0xFF, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(PALETTE_BLOCKS.wordOf[bits][g])));
+            const __m512i shift = _mm512_maskz_cvtepu8_epi64(
+                0xFF, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(PALETTE_BLOCKS.shiftOf[bits][g])));
+            const __m512i v = _mm512_and_si512(
+                _mm512_maskz_srlv_epi64(0xFF, _mm512_maskz_permutexvar_epi64(0xFF, index, block), shift), mask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + g * 8), _mm512_maskz_cvtepi64_epi16(0xFF, v));
+        }
+    }
+    scalar::unpackPaletteIndices(words + w, bits, out + i, count - i);
+}
+
+} // namespace avx512
+
+#endif // LATTICE_SIMD_X86
+
+#if defined(LATTICE_SIMD_NEON)
+
+// ===== NEON（128位；横向扩散判断没有movemask，使用标量实现） =====
+
+namespace neon {
+
+size_t filterInRange2D(const float* xs, const float* zs, const int* ids, size_t count,
+                       float centerX, float centerZ, float maxDistSq, int* out) {
+    const float32x4_t cx = vdupq_n_f32(centerX);
+    const float32x4_t cz = vdupq_n_f32(centerZ);
+    const float32x4_t limit = vdupq_n_f32(maxDistSq);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t dx = vsubq_f32(vld1q_f32(xs + i), cx);
+        const float32x4_t dz = vsubq_f32(vld1q_f32(zs + i), cz);
+        const float32x4_t distSq = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dz, dz));
+        const uint32x4_t inRange = vcleq_f32(distSq, limit);
+        if (vmaxvq_u32(inRange) == 0) {
+            continue;
+        }
+        uint32_t lanes[4];
+        vst1q_u32(lanes, inRange);
+        for (size_t lane = 0; lane < 4; ++lane) {
+            if (lanes[lane]) {
+                out[written++] = ids[i + lane];
+            }
+        }
+    }
+    return written + scalar::filterInRange2D(xs + i, zs + i, ids + i, count - i,
+                                             centerX, centerZ, maxDistSq, out + written);
+}
+
+size_t filterOverlapsYZ(const float* minY, const float* maxY, const float* minZ, const float* maxZ,
+                        size_t count, float queryMinY, float queryMaxY, float queryMinZ,
+                        float queryMaxZ, uint32_t base, uint32_t* out) {
+    const float32x4_t qMinY = vdupq_n_f32(queryMinY);
+    const float32x4_t qMaxY = vdupq_n_f32(queryMaxY);
+    const float32x4_t qMinZ = vdupq_n_f32(queryMinZ);
+    const float32x4_t qMaxZ = vdupq_n_f32(queryMaxZ);
+    size_t written = 0;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const uint32x4_t overlapY = vandq_u32(vcleq_f32(vld1q_f32(minY + i), qMaxY),
+                                              vcgeq_f32(vld1q_f32(maxY + i), qMinY));
+        const uint32x4_t overlapZ = vandq_u32(vcleq_f32(vld1q_f32(minZ + i), qMaxZ),
+                                              vcgeq_f32(vld1q_f32(maxZ + i), qMinZ));
+        const uint32x4_t overlap = vandq_u32(overlapY, overlapZ);
+        if (vmaxvq_u32(overlap) == 0) {
+            continue;
+        }
+        uint32_t lanes[4];
+        vst1q_u32(lanes, overlap);
+        for (size_t lane = 0; lane < 4; ++lane) {
+            if (lanes[lane]) {
+                out[written++] = base + static_cast<uint32_t>(i + lane);
+            }
+        }
+    }
+    return written + scalar::filterOverlapsYZ(minY + i, maxY + i, minZ + i, maxZ + i, count - i,
+                                              queryMinY, queryMaxY, queryMinZ, queryMaxZ,
+                                              base + static_cast<uint32_t>(i), out + written);
+}
+
+void accumulateFlock(const float* dx, const float* dy, const float* dz, const float* vx,
+                     const float* vy, const float* vz, size_t count, float separationRadiusSq,
+                     float out[9]) {
+    const float32x4_t sepSq = vdupq_n_f32(separationRadiusSq);
+    const float32x4_t minDistSq = vdupq_n_f32(FLOCK_MIN_DIST_SQ);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t sum[9];
+    for (auto& lane : sum) {
+        lane = zero;
+    }
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t x = vld1q_f32(dx + i);
+        const float32x4_t y = vld1q_f32(dy + i);
+        const float32x4_t z = vld1q_f32(dz + i);
+        const float32x4_t distSq = vaddq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)), vmulq_f32(z, z));
+        // min(distSq - sepSq, 0)为负的分离权重，乘到d上即远离同伴的方向
+        const float32x4_t weight = vdivq_f32(vminq_f32(vsubq_f32(distSq, sepSq), zero), vmulq_f32(sepSq, vmaxq_f32(distSq, minDistSq)));
+        sum[0] = vaddq_f32(sum[0], x);
+        sum[1] = vaddq_f32(sum[1], y);
+        sum[2] = vaddq_f32(sum[2], z);
+        sum[3] = vaddq_f32(sum[3], vld1q_f32(vx + i));
+        sum[4] = vaddq_f32(sum[4], vld1q_f32(vy + i));
+        sum[5] = vaddq_f32(sum[5], vld1q_f32(vz + i));
+        sum[6] = vaddq_f32(sum[6], vmulq_f32(x, weight));
+        sum[7] = vaddq_f32(sum[7], vmulq_f32(y, weight));
+        sum[8] = vaddq_f32(sum[8], vmulq_f32(z, weight));
+    }
+    float tail[9];
+    scalar::accumulateFlock(dx + i, dy + i, dz + i, vx + i, vy + i, vz + i, count - i, separationRadiusSq, tail);
+    for (size_t k = 0; k < 9; ++k) {
+        out[k] = vaddvq_f32(sum[k]) + tail[k];
+    }
+}
+
+void attenuateLayer(uint8_t* levels, const uint8_t* opacity) {
+    for (size_t i = 0; i < LAYER_CELLS; i += 16) {
+        vst1q_u8(levels + i, vqsubq_u8(vld1q_u8(levels + i), vld1q_u8(opacity + i)));
+    }
+}
+
+void packLayerNibbles(const uint8_t* levels, uint8_t* out) {
+    // vld2按奇偶格拆开，奇数格左移4位合并
+    for (size_t i = 0; i < LAYER_CELLS; i += 32) {
+        const uint8x16x2_t cells = vld2q_u8(levels + i);
+        vst1q_u8(out + i / 2, vorrq_u8(cells.val[0], vshlq_n_u8(cells.val[1], 4)));
+    }
+}
+
+bool layerUniform(const uint8_t* levels) {
+    const uint8x16_t first = vdupq_n_u8(levels[0]);
+    uint8x16_t equal = vdupq_n_u8(0xFF);
+    for (size_t i = 0; i < LAYER_CELLS; i += 16) {
+        equal = vandq_u8(equal, vceqq_u8(vld1q_u8(levels + i), first));
+    }
+    return vminvq_u8(equal) == 0xFF;
+}
+
+void byteSwapCopy32(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u8(out + i * 4, vrev32q_u8(vld1q_u8(src + i * 4)));
+    }
+    scalar::byteSwapCopy32(src + i * 4, out + i * 4, count - i);
+}
+
+void byteSwapCopy64(const uint8_t* src, void* dst, size_t count) {
+    auto* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        vst1q_u8(out + i * 8, vrev64q_u8(vld1q_u8(src + i * 8)));
+    }
+    scalar::byteSwapCopy64(src + i * 8, out + i * 8, count - i);
+}
+
+} // namespace neon
+
+#endif // LATTICE_SIMD_NEON
+
+// ===== 选择 =====
+
+SimdKernels buildKernels(SimdLevel level) {
+    SimdKernels kernels;
+    kernels.level = level;
+    kernels.filterInRange2D = scalar::filterInRange2D;
+    kernels.filterSlotsInRange2D = scalar::filterSlotsInRange2D;
+    kernels.filterOverlapsYZ = scalar::filterOverlapsYZ;
+    kernels.accumulateFlock = scalar::accumulateFlock;
+    kernels.attenuateLayer = scalar::attenuateLayer;
+    kernels.packLayerNibbles = scalar::packLayerNibbles;
+    kernels.layerUniform = scalar::layerUniform;
+    kernels.findSpreadCells = scalar::findSpreadCells;
+    kernels.byteSwapCopy32 = scalar::byteSwapCopy32;
+    kernels.byteSwapCopy64 = scalar::byteSwapCopy64;
+    kernels.unpackPaletteIndices = scalar::unpackPaletteIndices;
+    kernels.packPaletteIndices = scalar::packPaletteIndices;
+
+#if defined(LATTICE_SIMD_X86)
+    if (level >= SimdLevel::SSE4) {
+        kernels.filterInRange2D = sse4::filterInRange2D;
+        kernels.filterOverlapsYZ = sse4::filterOverlapsYZ;
+        kernels.accumulateFlock = sse4::accumulateFlock;
+        kernels.attenuateLayer = sse4::attenuateLayer;
+        kernels.packLayerNibbles = sse4::packLayerNibbles;
+        kernels.layerUniform = sse4::layerUniform;
+        kernels.findSpreadCells = sse4::findSpreadCells;
+        kernels.byteSwapCopy32 = sse4::byteSwapCopy32;
+        kernels.byteSwapCopy64 = sse4::byteSwapCopy64;
+    }
+    if (level >= SimdLevel::AVX2) {
+        kernels.filterInRange2D = avx2::filterInRange2D;
+        kernels.filterSlotsInRange2D = avx2::filterSlotsInRange2D;
+        kernels.filterOverlapsYZ = avx2::filterOverlapsYZ;
+        kernels.accumulateFlock = avx2::accumulateFlock;
+        kernels.attenuateLayer = avx2::attenuateLayer;
+        kernels.packLayerNibbles = avx2::packLayerNibbles;
+        kernels.layerUniform = avx2::layerUniform;
+        kernels.findSpreadCells = avx2::findSpreadCells;
+        kernels.byteSwapCopy32 = avx2::byteSwapCopy32;
+        kernels.byteSwapCopy64 = avx2::byteSwapCopy64;
+        kernels.unpackPaletteIndices = avx2::unpackPaletteIndices;
+        kernels.packPaletteIndices = avx2::packPaletteIndices;
+    }
+    if (level >= SimdLevel::AVX512) {
+        kernels.filterInRange2D = avx512::filterInRange2D;
+        kernels.filterSlotsInRange2D = avx512::filterSlotsInRange2D;
+        kernels.filterOverlapsYZ = avx512::filterOverlapsYZ;
+        kernels.byteSwapCopy32 = avx512::byteSwapCopy32;
+        kernels.byteSwapCopy64 = avx512::byteSwapCopy64;
+        kernels.unpackPaletteIndices = avx512::unpackPaletteIndices;
+    }
+#elif defined(LATTICE_SIMD_NEON)
+    if (level == SimdLevel::NEON) {
+        kernels.filterInRange2D = neon::filterInRange2D;
+        kernels.filterOverlapsYZ = neon::filterOverlapsYZ;
+        kernels.accumulateFlock = neon::accumulateFlock;
+        kernels.attenuateLayer = neon::attenuateLayer;
+        kernels.packLayerNibbles = neon::packLayerNibbles;
+        kernels.layerUniform = neon::layerUniform;
+        kernels.byteSwapCopy32 = neon::byteSwapCopy32;
+        kernels.byteSwapCopy64 = neon::byteSwapCopy64;
+    }
+#endif
+    return kernels;
+}
+
+SimdLevel detectLevel() {
+#if defined(LATTICE_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    // 可能在其他静态初始化之前执行，先初始化CPU信息；__builtin_cpu_supports同时检查了OS是否保存宽寄存器
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl")) {
+        return SimdLevel::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+    }
+    if (__builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1") &&
+        __builtin_cpu_supports("sse4.2")) {
+        return SimdLevel::SSE4;
+    }
+    return SimdLevel::SCALAR;
+#elif defined(LATTICE_SIMD_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool ssse3 = (info[2] & (1 << 9)) != 0;
+    const bool sse41 = (info[2] & (1 << 19)) != 0;
+    const bool sse42 = (info[2] & (1 << 20)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    const bool avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0 &&
+                        (info[1] & (1 << 31)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    if (avx512) return SimdLevel::AVX512;
+    if (avx2) return SimdLevel::AVX2;
+    if (ssse3 && sse41 && sse42) return SimdLevel::SSE4;
+    return SimdLevel::SCALAR;
+#elif defined(LATTICE_SIMD_NEON)
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+bool levelSupported(SimdLevel level, SimdLevel native) {
+    if (level == SimdLevel::SCALAR || level == native) {
+        return true;
+    }
+    if (level == SimdLevel::NEON || native == SimdLevel::NEON) {
+        return false;
+    }
+    return level <= native;
+}
+
+// LATTICE_SIMD_LEVEL环境变量可以把级别压低（排查某一级实现的问题、在同一台机器上对比）
+SimdLevel configuredLevel(SimdLevel native) {
+    const char* value = std::getenv("LATTICE_SIMD_LEVEL");
+    if (!value || !*value) {
+        return native;
+    }
+    const std::string wanted(value);
+    for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::NEON, SimdLevel::SSE4,
+                            SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (wanted == simdLevelName(level)) {
+            if (levelSupported(level, native)) {
+                return level;
+            }
+            fprintf(stderr, "LATTICE_SIMD_LEVEL=%s is not supported by this CPU, using %s\n",
+                    value, simdLevelName(native));
+            return native;
+        }
+    }
+    fprintf(stderr, "Unknown LATTICE_SIMD_LEVEL=%s, using %s\n", value, simdLevelName(native));
+    return native;
+}
+
+} // namespace
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return "scalar";
+        case SimdLevel::NEON:   return "neon";
+        case SimdLevel::SSE4:   return "sse4";
+        case SimdLevel::AVX2:   return "avx2";
+        case SimdLevel::AVX512: return "avx512";
+    }
+    return "unknown";
+}
+
+SimdLevel detectSimdLevel() {
+    static const SimdLevel level = detectLevel();
+    return level;
+}
+
+const SimdKernels& simdKernelsFor(SimdLevel level) {
+    static const std::array<SimdKernels, 5> tables = {
+        buildKernels(SimdLevel::SCALAR), buildKernels(SimdLevel::NEON), buildKernels(SimdLevel::SSE4),
+        buildKernels(SimdLevel::AVX2), buildKernels(SimdLevel::AVX512)
+    };
+    if (!levelSupported(level, detectSimdLevel())) {
+        level = detectSimdLevel();
+    }
+    return tables[static_cast<size_t>(level)];
+}
+
+const SimdKernels& simdKernels() {
+    static const SimdKernels& active = simdKernelsFor(configuredLevel(detectSimdLevel()));
+    return active;
+}
+
+namespace {
+// 库加载时完成选择，第一次调用内核时不再有检测开销
+[[maybe_unused]] const SimdKernels& RESOLVED_AT_LOAD = simdKernels();
+} // namespace
+
+} // namespace core
+} // namespace lattice
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lattice {
+namespace core {
+
+// ====== 运行时SIMD内核分发 ======
+
+enum class SimdLevel : uint8_t {
+    SCALAR,
+    NEON,       // AArch64（基线即支持）
+    SSE4,       // SSSE3 + SSE4.1 + SSE4.2
+    AVX2,       // AVX2 + FMA
+    AVX512      // AVX-512 F + BW + VL
+};
+
+const char* simdLevelName(SimdLevel level);
+
+/**
+ * @brief 按CPU选定的一组内核函数指针
+ *
+ * 各内核的每个实现都编译进同一个库（x86用函数级target属性，不依赖-march），
+ * 加载库时检测一次CPU，选出本机支持的最高级别，之后调用只是一次间接跳转。
+ * 某个级别没有专门实现的内核使用低一级的实现。
+ */
+struct SimdKernels {
+    SimdLevel level = SimdLevel::SCALAR;
+
+    // --- 实体距离 ---
+
+    // 对[0, count)中水平距离平方 <= maxDistSq的下标i，依次写出ids[i]，返回写出的数量（out至少容纳count个）
+    size_t (*filterInRange2D)(const float* xs, const float* zs, const int* ids, size_t count,
+                              float centerX, float centerZ, float maxDistSq, int* out);
+    // 同上，但按slots[0..count)间接取下标（gather）
+    size_t (*filterSlotsInRange2D)(const float* xs, const float* zs, const int* ids,
+                                   const uint32_t* slots, size_t count,
+                                   float centerX, float centerZ, float maxDistSq, int* out);
+    /**
+     * 碰撞粗检测：对[0, count)中Y、Z两个轴上的区间都与查询区间相交（闭区间）的下标i，
+     * 依次写出base + i，返回写出的数量（out至少容纳count个）
+     */
+    size_t (*filterOverlapsYZ)(const float* minY, const float* maxY, const float* minZ, const float* maxZ,
+                               size_t count, float queryMinY, float queryMaxY, float queryMinZ,
+                               float queryMaxZ, uint32_t base, uint32_t* out);
+    /**
+     * 群体移动（boids）：对count个同伴的相对位置d与速度v累加
+     * out[0..2] = Σd（聚合），out[3..5] = Σv（对齐），
+     * out[6..8] = Σ-d·max(0, sepSq - |d|²) / (sepSq·max(|d|², 1e-4))（分离，越近越强）
+     */
+    void (*accumulateFlock)(const float* dx, const float* dy, const float* dz, const float* vx,
+                            const float* vy, const float* vz, size_t count, float separationRadiusSq,
+                            float out[9]);
+
+    // --- 光照层（16x16 = 256格，下标(z << 4) | x） ---
+
+    // levels = max(0, levels - opacity)
+    void (*attenuateLayer)(uint8_t* levels, const uint8_t* opacity);
+    // 256个级别写成128字节nibble数组（偶数格为低4位）
+    void (*packLayerNibbles)(const uint8_t* levels, uint8_t* out);
+    // 整层是否为同一个值
+    bool (*layerUniform)(const uint8_t* levels);
+    /**
+     * 光会横向扩散到的格子按位写入spread（第i位对应第i格，调用前清零）
+     * levels与opacity的前后各需要32字节可读填充（亮且不透光）
+     */
+    void (*findSpreadCells)(const uint8_t* levels, const uint8_t* opacity, uint64_t spread[4]);
+
+    // --- NBT字节序翻转（大端 <-> 主机序，src与dst可以相同） ---
+
+    void (*byteSwapCopy32)(const uint8_t* src, void* dst, size_t count);
+    void (*byteSwapCopy64)(const uint8_t* src, void* dst, size_t count);
+
+    // --- 区块段调色板下标（1.16+布局：每个long放64/bits个下标，从低位开始，不跨long；bits为1..15） ---
+
+    // 从words解出count个下标
+    void (*unpackPaletteIndices)(const uint64_t* words, int bits, uint16_t* out, size_t count);
+    // 把count个下标的低bits位打包进words，共ceil(count / (64/bits))个long，最后一个long的空位补0
+    void (*packPaletteIndices)(const uint16_t* values, size_t count, int bits, uint64_t* words);
+};
+
+// 本机CPU支持的最高级别（只检测一次）
+SimdLevel detectSimdLevel();
+
+// 当前使用的内核表：首次调用（库加载时）选定，之后不变
+const SimdKernels& simdKernels();
+
+// 指定级别的内核表（高于本机支持的级别时降到本机级别），用于基准比较与一致性检查
+const SimdKernels& simdKernelsFor(SimdLevel level);
+
+} // namespace core
+} // namespace lattice
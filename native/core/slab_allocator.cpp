@@ -0,0 +1,349 @@
+#include "slab_allocator.hpp"
+
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+void* allocateSlabMemory() {
+#if defined(_MSC_VER)
+    return _aligned_malloc(SlabAllocator::SLAB_SIZE, SlabAllocator::SLAB_SIZE);
+#else
+    return std::aligned_alloc(SlabAllocator::SLAB_SIZE, SlabAllocator::SLAB_SIZE);
+#endif
+}
+
+void freeSlabMemory(void* memory) {
+#if defined(_MSC_VER)
+    _aligned_free(memory);
+#else
+    std::free(memory);
+#endif
+}
+
+} // namespace
+
+/**
+ * slab头部，位于slab起始处
+ * 除remoteFree外的字段只由拥有者线程访问；remoteFree单独占一条缓存行，其他线程的释放不干扰拥有者
+ */
+struct SlabAllocator::Slab {
+    ThreadHeap* owner;
+    Slab* prev = nullptr;                // 所在链表（拥有者堆中同级别的available或full）
+    Slab* next = nullptr;
+    FreeBlock* localFree = nullptr;
+    char* bump;                          // 尚未切分部分的起点
+    char* end;
+    uint32_t blockSize;
+    uint32_t used = 0;                   // 已分配且尚未回到localFree的块（remoteFree中的仍计入）
+    uint8_t sizeClass;
+    bool full = false;                   // 在full链表中
+
+    alignas(64) std::atomic<FreeBlock*> remoteFree{nullptr};
+
+    Slab(ThreadHeap* heap, size_t cls)
+        : owner(heap), blockSize(static_cast<uint32_t>(classSize(cls))), sizeClass(static_cast<uint8_t>(cls)) {
+        bump = reinterpret_cast<char*>(this) + HEADER_SIZE;
+        end = bump + (SLAB_SIZE - HEADER_SIZE) / blockSize * blockSize;
+    }
+
+    // 取回其他线程释放的块并入localFree，返回是否有可用的块
+    bool collectRemote() {
+        FreeBlock* remote = remoteFree.exchange(nullptr, std::memory_order_acquire);
+        while (remote) {
+            FreeBlock* next = remote->next;
+            remote->next = localFree;
+            localFree = remote;
+            --used;
+            remote = next;
+        }
+        return localFree != nullptr;
+    }
+
+    bool hasFree() const { return localFree != nullptr || bump < end; }
+
+    void* take() {
+        ++used;
+        if (FreeBlock* block = localFree) {
+            localFree = block->next;
+            return block;
+        }
+        void* block = bump;
+        bump += blockSize;
+        return block;
+    }
+
+    static constexpr size_t HEADER_SIZE = 128;
+};
+
+static_assert(sizeof(SlabAllocator::Slab) <= SlabAllocator::Slab::HEADER_SIZE);
+
+struct SlabAllocator::ThreadHeap {
+    struct ClassSlabs {
+        Slab* available = nullptr;   // 表头是当前分配的slab
+        Slab* full = nullptr;
+    };
+    ClassSlabs classes[SIZE_CLASS_COUNT];
+};
+
+namespace {
+
+using Slab = SlabAllocator::Slab;
+using ThreadHeap = SlabAllocator::ThreadHeap;
+
+// 分配路径只读这个指针（平凡类型的thread_local，不需要初始化检查）
+thread_local ThreadHeap* tlsHeap = nullptr;
+thread_local bool tlsExiting = false;
+
+inline Slab* slabOf(void* ptr) {
+    return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t{SlabAllocator::SLAB_SIZE} - 1));
+}
+
+void unlink(Slab*& head, Slab* slab) {
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        head = slab->next;
+    }
+    if (slab->next) {
+        slab->next->prev = slab->prev;
+    }
+    slab->prev = nullptr;
+    slab->next = nullptr;
+}
+
+void pushFront(Slab*& head, Slab* slab) {
+    slab->prev = nullptr;
+    slab->next = head;
+    if (head) {
+        head->prev = slab;
+    }
+    head = slab;
+}
+
+} // namespace
+
+// 线程退出时把堆交回分配器（析构顺序不确定，之后的分配改走allocateExiting）
+struct SlabAllocator::HeapHandle {
+    ThreadHeap* heap = nullptr;
+
+    ~HeapHandle() {
+        if (heap) {
+            tlsHeap = nullptr;
+            tlsExiting = true;
+            SlabAllocator::instance().abandonHeap(heap);
+        }
+    }
+};
+
+SlabAllocator::SlabAllocator() {
+    // releaseSlab不能失败：预留好缓存的容量
+    cachedSlabs_.reserve(MAX_CACHED_SLABS);
+}
+
+SlabAllocator& SlabAllocator::instance() {
+    // 不析构：静态对象析构期间仍可能释放由它分配的块
+    static SlabAllocator* allocator = new SlabAllocator();
+    return *allocator;
+}
+
+void* SlabAllocator::allocate(size_t size) {
+    if (size > MAX_SMALL_SIZE) {
+        largeAllocations_.fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+    const size_t cls = sizeClassOf(size);
+    ThreadHeap* heap = tlsHeap;
+    if (heap) {
+        Slab* slab = heap->classes[cls].available;
+        if (slab && slab->hasFree()) {
+            return slab->take();
+        }
+    } else {
+        if (tlsExiting) {
+            return allocateExiting(cls);
+        }
+        heap = acquireHeap();
+    }
+    return allocateSlow(heap, cls);
+}
+
+void SlabAllocator::deallocate(void* ptr, size_t size) noexcept {
+    if (!ptr) {
+        return;
+    }
+    if (size > MAX_SMALL_SIZE) {
+        ::operator delete(ptr);
+        return;
+    }
+    Slab* slab = slabOf(ptr);
+    ThreadHeap* heap = tlsHeap;
+    if (slab->owner == heap) {
+        freeLocal(heap, slab, ptr);
+        return;
+    }
+    // 其他线程的slab（或本线程已退出）：压入无锁栈，由拥有者取回
+    auto* block = static_cast<FreeBlock*>(ptr);
+    FreeBlock* head = slab->remoteFree.load(std::memory_order_relaxed);
+    do {
+        block->next = head;
+    } while (!slab->remoteFree.compare_exchange_weak(head, block, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+}
+
+void SlabAllocator::freeLocal(ThreadHeap* heap, Slab* slab, void* ptr) noexcept {
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = slab->localFree;
+    slab->localFree = block;
+    --slab->used;
+
+    ThreadHeap::ClassSlabs& slabs = heap->classes[slab->sizeClass];
+    if (slab->full) {
+        unlink(slabs.full, slab);
+        slab->full = false;
+        pushFront(slabs.available, slab);
+    } else if (slab->used == 0 && slab != slabs.available) {
+        // 每个级别只保留当前的一个空slab，其余交回
+        unlink(slabs.available, slab);
+        releaseSlab(slab);
+    }
+}
+
+/**
+ * 当前slab用完：先取回它的远程释放，再依次尝试available中的其他slab（用完的移入full），
+ * 都没有时扫一遍full中的远程释放，最后才新建slab
+ */
+void* SlabAllocator::allocateSlow(ThreadHeap* heap, size_t cls) {
+    ThreadHeap::ClassSlabs& slabs = heap->classes[cls];
+    while (Slab* slab = slabs.available) {
+        if (slab->hasFree() || slab->collectRemote()) {
+            return slab->take();
+        }
+        unlink(slabs.available, slab);
+        slab->full = true;
+        pushFront(slabs.full, slab);
+    }
+    for (Slab* slab = slabs.full; slab;) {
+        Slab* next = slab->next;
+        if (slab->collectRemote()) {
+            unlink(slabs.full, slab);
+            slab->full = false;
+            pushFront(slabs.available, slab);
+        }
+        slab = next;
+    }
+    if (Slab* slab = slabs.available) {
+        return slab->take();
+    }
+    Slab* slab = newSlab(heap, cls);
+    pushFront(slabs.available, slab);
+    return slab->take();
+}
+
+// 线程局部对象析构之后的少量分配：共用一个堆，在锁内进行
+void* SlabAllocator::allocateExiting(size_t cls) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!exitingHeap_) {
+        exitingHeap_ = new ThreadHeap();
+        heaps_.fetch_add(1, std::memory_order_relaxed);
+    }
+    ThreadHeap::ClassSlabs& slabs = exitingHeap_->classes[cls];
+    if (Slab* slab = slabs.available; slab && slab->hasFree()) {
+        return slab->take();
+    }
+    return allocateSlow(exitingHeap_, cls);
+}
+
+SlabAllocator::ThreadHeap* SlabAllocator::acquireHeap() {
+    ThreadHeap* heap = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!abandoned_.empty()) {
+            heap = abandoned_.back();
+            abandoned_.pop_back();
+        }
+    }
+    if (!heap) {
+        heap = new ThreadHeap();
+        heaps_.fetch_add(1, std::memory_order_relaxed);
+    }
+    thread_local HeapHandle handle;
+    handle.heap = heap;
+    tlsHeap = heap;
+    return heap;
+}
+
+// 在退出的线程上调用（此时仍是拥有者）：取回远程释放，交回已经全空的slab，其余留给接手的线程
+void SlabAllocator::abandonHeap(ThreadHeap* heap) {
+    for (ThreadHeap::ClassSlabs& slabs : heap->classes) {
+        for (Slab** list : {&slabs.available, &slabs.full}) {
+            for (Slab* slab = *list; slab;) {
+                Slab* next = slab->next;
+                slab->collectRemote();
+                if (slab->used == 0) {
+                    unlink(*list, slab);
+                    releaseSlab(slab);
+                }
+                slab = next;
+            }
+        }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    abandoned_.push_back(heap);
+}
+
+SlabAllocator::Slab* SlabAllocator::newSlab(ThreadHeap* heap, size_t cls) {
+    void* memory = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!cachedSlabs_.empty()) {
+            memory = cachedSlabs_.back();
+            cachedSlabs_.pop_back();
+        }
+    }
+    if (!memory) {
+        memory = allocateSlabMemory();
+        if (!memory) {
+            throw std::bad_alloc();
+        }
+    }
+    slabsInUse_.fetch_add(1, std::memory_order_relaxed);
+    return new (memory) Slab(heap, cls);
+}
+
+void SlabAllocator::releaseSlab(Slab* slab) noexcept {
+    slab->~Slab();
+    slabsInUse_.fetch_sub(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cachedSlabs_.size() < MAX_CACHED_SLABS) {
+            cachedSlabs_.push_back(slab);
+            return;
+        }
+    }
+    freeSlabMemory(slab);
+}
+
+SlabAllocator::Stats SlabAllocator::getStats() const {
+    Stats stats;
+    stats.slabsInUse = slabsInUse_.load(std::memory_order_relaxed);
+    stats.heaps = heaps_.load(std::memory_order_relaxed);
+    stats.largeAllocations = largeAllocations_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats.cachedSlabs = cachedSlabs_.size();
+    stats.abandonedHeaps = abandoned_.size();
+    return stats;
+}
+
+} // namespace core
+} // namespace lattice
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace lattice {
+namespace core {
+
+// ====== 按大小级别分配的小对象分配器 ======
+
+/**
+ * @brief 进程内共享的小对象分配器：每线程一个堆，按大小级别从64KB slab中切块
+ *
+ * - 分配与同线程释放只访问本线程的堆，不加锁、没有原子操作
+ * - 其他线程释放的块压入所在slab的无锁栈（remoteFree），拥有者在该slab用完时一次性取回
+ * - slab按SLAB_SIZE对齐，块所属的slab由指针取整得到，释放时不需要查找
+ * - 线程退出时堆交给之后新建的线程继续使用，其中还未释放的块照常可以在任意线程释放
+ * - 大于MAX_SMALL_SIZE的请求直接使用operator new
+ *
+ * 只提供带大小的释放：size须与分配时相同（STL分配器、类的operator delete(void*, size_t)都满足）。
+ * 块按16字节对齐，不用于alignas更大的类型。
+ */
+class SlabAllocator {
+public:
+    static constexpr size_t SLAB_SIZE = 64 * 1024;
+    static constexpr size_t MAX_SMALL_SIZE = 8 * 1024;
+    // 16字节步长到128，之后每翻一倍分4级，最大8KB
+    static constexpr size_t SIZE_CLASS_COUNT = 32;
+    // 空闲slab最多缓存这么多个，超出的归还系统
+    static constexpr size_t MAX_CACHED_SLABS = 64;
+
+    struct Stats {
+        size_t slabsInUse{0};         // 属于某个线程堆的slab
+        size_t cachedSlabs{0};        // 空闲、等待复用的slab
+        size_t heaps{0};              // 创建过的线程堆（含线程已退出、等待接手的）
+        size_t abandonedHeaps{0};
+        size_t largeAllocations{0};   // 直接走operator new的累计次数
+    };
+
+    static SlabAllocator& instance();
+
+    // 失败时抛出std::bad_alloc
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size) noexcept;
+
+    Stats getStats() const;
+
+    static constexpr size_t sizeClassOf(size_t size);
+    static constexpr size_t classSize(size_t sizeClass);
+
+    struct Slab;
+    struct ThreadHeap;
+
+private:
+    SlabAllocator();
+
+    ThreadHeap* acquireHeap();
+    void abandonHeap(ThreadHeap* heap);
+    void* allocateSlow(ThreadHeap* heap, size_t sizeClass);
+    void* allocateExiting(size_t sizeClass);
+    Slab* newSlab(ThreadHeap* heap, size_t sizeClass);
+    void releaseSlab(Slab* slab) noexcept;
+    void freeLocal(ThreadHeap* heap, Slab* slab, void* ptr) noexcept;
+
+    struct HeapHandle;
+    friend struct HeapHandle;
+
+    mutable std::mutex mutex_;                  // 只保护堆与空闲slab的登记，不在分配路径上
+    std::vector<ThreadHeap*> abandoned_;
+    std::vector<void*> cachedSlabs_;
+    ThreadHeap* exitingHeap_ = nullptr;         // 线程局部对象析构期间的分配，在mutex_下使用
+
+    std::atomic<size_t> slabsInUse_{0};
+    std::atomic<size_t> heaps_{0};
+    std::atomic<size_t> largeAllocations_{0};
+};
+
+constexpr size_t SlabAllocator::sizeClassOf(size_t size) {
+    if (size <= 128) {
+        return size == 0 ? 0 : (size - 1) / 16;
+    }
+    size_t log = 0;
+    for (size_t v = size - 1; v > 1; v >>= 1) {
+        ++log;
+    }
+    const size_t step = size_t{1} << (log - 2);
+    return 8 + (log - 7) * 4 + (size - 1 - (size_t{1} << log)) / step;
+}
+
+constexpr size_t SlabAllocator::classSize(size_t sizeClass) {
+    if (sizeClass < 8) {
+        return (sizeClass + 1) * 16;
+    }
+    const size_t log = 7 + (sizeClass - 8) / 4;
+    return (size_t{1} << log) + ((sizeClass - 8) % 4 + 1) * (size_t{1} << (log - 2));
+}
+
+static_assert(SlabAllocator::classSize(SlabAllocator::SIZE_CLASS_COUNT - 1) == SlabAllocator::MAX_SMALL_SIZE);
+static_assert(SlabAllocator::sizeClassOf(SlabAllocator::MAX_SMALL_SIZE) == SlabAllocator::SIZE_CLASS_COUNT - 1);
+
+/**
+ * 继承后该类的new / delete走SlabAllocator（树节点、I/O上下文等频繁创建销毁的小对象）
+ * 有虚析构函数的层次中，delete传入的是实际类型的大小
+ */
+struct SlabAllocated {
+    static void* operator new(size_t size) { return SlabAllocator::instance().allocate(size); }
+    static void operator delete(void* ptr, size_t size) noexcept {
+        SlabAllocator::instance().deallocate(ptr, size);
+    }
+};
+
+// 供STL容器使用的分配器（节点型容器的每个节点一次分配，最能受益）
+template <class T>
+struct SlabStlAllocator {
+    using value_type = T;
+
+    SlabStlAllocator() noexcept = default;
+    template <class U>
+    SlabStlAllocator(const SlabStlAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(SlabAllocator::instance().allocate(n * sizeof(T))); }
+    void deallocate(T* ptr, size_t n) noexcept { SlabAllocator::instance().deallocate(ptr, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const SlabStlAllocator<U>&) const noexcept { return true; }
+};
+
+} // namespace core
+} // namespace lattice
@@ -1,89 +1,424 @@
 #pragma once
 
-#include <queue>
-#include <vector>
-#include <thread>
-#include <mutex>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
 #include <functional>
 #include <future>
 #include <memory>
-#include <atomic>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace lattice {
 namespace core {
 
+// ====== 任务优先级 ======
+
+enum class TaskPriority : uint8_t {
+    HIGH = 0,       // tick关键路径（parallel_for的分块）
+    NORMAL = 1,     // enqueue的默认优先级
+    LOW = 2,        // 预取、压缩等后台工作
+};
+
+inline constexpr size_t TASK_PRIORITY_COUNT = 3;
+
+// ====== 小对象优化的任务 ======
+
 /**
- * @brief A thread-safe task queue implementation using lock-free techniques where possible
+ * @brief 只能移动的可调用对象
+ *
+ * 不超过INLINE_SIZE字节、移动不抛异常的可调用对象直接放在对象内部，
+ * 不像std::function那样要求可拷贝，也不为常见的小lambda分配内存；更大的才放到堆上。
+ */
+class Task {
+public:
+    static constexpr size_t INLINE_SIZE = 48;
+
+    Task() = default;
+
+    template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<Fn>) {
+            ::new (static_cast<void*>(storage_)) Fn(std::forward<F>(f));
+            ops_ = &INLINE_OPS<Fn>;
+        } else {
+            ::new (static_cast<void*>(storage_)) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &HEAP_OPS<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept {
+        moveFrom(other);
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        reset();
+    }
+
+    explicit operator bool() const { return ops_ != nullptr; }
+
+    void operator()() {
+        ops_->invoke(storage_);
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* dst, void* src);     // 移动到dst并销毁src
+        void (*destroy)(void* storage);
+    };
+
+    template <class Fn>
+    static constexpr Ops INLINE_OPS = {
+        [](void* storage) { (*static_cast<Fn*>(storage))(); },
+        [](void* dst, void* src) {
+            ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+            static_cast<Fn*>(src)->~Fn();
+        },
+        [](void* storage) { static_cast<Fn*>(storage)->~Fn(); },
+    };
+
+    template <class Fn>
+    static constexpr Ops HEAP_OPS = {
+        [](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* dst, void* src) { ::new (dst) Fn*(*static_cast<Fn**>(src)); },
+        [](void* storage) { delete *static_cast<Fn**>(storage); },
+    };
+
+    void moveFrom(Task& other) noexcept {
+        ops_ = other.ops_;
+        if (ops_) {
+            ops_->move(storage_, other.storage_);
+            other.ops_ = nullptr;
+        }
+    }
+
+    void reset() {
+        if (ops_) {
+            ops_->destroy(storage_);
+            ops_ = nullptr;
+        }
+    }
+
+    alignas(std::max_align_t) unsigned char storage_[INLINE_SIZE];
+    const Ops* ops_ = nullptr;
+};
+
+// ====== 工作窃取线程池 ======
+
+/**
+ * @brief 工作窃取线程池
+ *
+ * 每个工作线程有自己的任务队列，按优先级分为三条通道。工作线程先取自己队列的末尾（最近提交的，缓存热），
+ * 自己没有该优先级的任务时再从其他线程队列的头部窃取，所以提交和取任务分散在各线程的锁上，
+ * 不再争用同一把全局锁。任一工作线程都会先做完所有高优先级任务，再看低一级的通道。
+ *
+ * 提交时可以给出亲和提示（工作线程下标），任务进入该线程的队列，空闲的线程仍可能把它偷走；
+ * 不给提示时，工作线程提交的任务进入自己的队列，外部线程提交的轮流分给各个队列。
+ *
+ * 析构时执行完已提交的全部任务再退出。
  */
 class ThreadPool {
 public:
-    explicit ThreadPool(size_t numThreads)
-        : stop_(false)
+    static constexpr int ANY_WORKER = -1;
+
+    // 在每个工作线程内调用，onStart在开始取任务之前，onExit在线程退出之前（供NativeRuntime命名、绑核、计数）
+    struct WorkerHooks {
+        std::function<void(size_t)> onStart;
+        std::function<void(size_t)> onExit;
+    };
+
+    explicit ThreadPool(size_t numThreads, WorkerHooks hooks = {})
+        : queues_(numThreads), hooks_(std::move(hooks))
     {
-        for(size_t i = 0; i < numThreads; ++i) {
-            workers_.emplace_back([this] {
-                while(true) {
-                    std::function<void()> task;
-                    {
-                        std::unique_lock<std::mutex> lock(queue_mutex_);
-                        condition_.wait(lock, [this] { 
-                            return stop_ || !tasks_.empty(); 
-                        });
-                        
-                        if(stop_ && tasks_.empty()) {
-                            return;
-                        }
-                        
-                        task = std::move(tasks_.front());
-                        tasks_.pop();
-                    }
-                    task();
-                }
-            });
+        workers_.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers_.emplace_back([this, i] { workerLoop(i); });
         }
     }
 
-    template<class F, class... Args>
-    auto enqueue(F&& f, Args&&... args) 
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stop_.store(true);
+        }
+        wakeup_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    // 当前线程在本线程池中的下标，不是本线程池的工作线程时返回ANY_WORKER
+    int currentWorkerIndex() const {
+        const WorkerContext& context = workerContext();
+        return context.pool == this ? static_cast<int>(context.index) : ANY_WORKER;
+    }
+
+    // 提交不需要结果的任务；任务抛出的异常输出到stderr
+    template <class F>
+    void submit(F&& f, TaskPriority priority = TaskPriority::NORMAL, int affinity = ANY_WORKER) {
+        push(Task(std::forward<F>(f)), priority, affinity);
+    }
+
+    template <class F, class... Args>
+    auto enqueue(F&& f, Args&&... args)
+        -> std::future<typename std::invoke_result<F, Args...>::type>
+    {
+        return enqueueWithPriority(TaskPriority::NORMAL, ANY_WORKER,
+                                   std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    template <class F, class... Args>
+    auto enqueueWithPriority(TaskPriority priority, int affinity, F&& f, Args&&... args)
         -> std::future<typename std::invoke_result<F, Args...>::type>
     {
         using return_type = typename std::invoke_result<F, Args...>::type;
 
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...)
-        );
-            
-        std::future<return_type> res = task->get_future();
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            if(stop_) {
-                throw std::runtime_error("enqueue on stopped ThreadPool");
+        std::promise<return_type> promise;
+        std::future<return_type> res = promise.get_future();
+        push(Task([fn = std::forward<F>(f),
+                   bound = std::make_tuple(std::forward<Args>(args)...),
+                   promise = std::move(promise)]() mutable {
+            try {
+                if constexpr (std::is_void_v<return_type>) {
+                    std::apply(fn, std::move(bound));
+                    promise.set_value();
+                } else {
+                    promise.set_value(std::apply(fn, std::move(bound)));
+                }
+            } catch (...) {
+                promise.set_exception(std::current_exception());
             }
-            tasks_.emplace([task](){ (*task)(); });
-        }
-        condition_.notify_one();
+        }), priority, affinity);
         return res;
     }
 
-    ~ThreadPool() {
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            stop_ = true;
+    /**
+     * 把[begin, end)分成长度为grain的块，并行调用fn(blockBegin, blockEnd)，全部完成后返回
+     *
+     * 调用线程自己也领取分块，之后只等待正在执行的分块，不等待还没开始的辅助任务，
+     * 所以在工作线程里调用（包括嵌套调用）不会因为线程都在等待而死锁。
+     * grain为0时按工作线程数的四倍分块。第一个分块抛出的异常在全部分块结束后重新抛出。
+     */
+    template <class Fn>
+    void parallel_for(size_t begin, size_t end, Fn&& fn, size_t grain = 0,
+                      TaskPriority priority = TaskPriority::HIGH) {
+        if (begin >= end) {
+            return;
         }
-        condition_.notify_all();
-        for(std::thread &worker: workers_) {
-            worker.join();
+        const size_t count = end - begin;
+        if (grain == 0) {
+            const size_t target = std::max<size_t>(1, workers_.size() * 4);
+            grain = (count + target - 1) / target;
+        }
+        const size_t chunks = (count + grain - 1) / grain;
+        if (chunks <= 1 || workers_.empty()) {
+            fn(begin, end);
+            return;
+        }
+
+        auto state = std::make_shared<ParallelForState>();
+        state->begin = begin;
+        state->end = end;
+        state->grain = grain;
+        state->chunks = chunks;
+        state->remaining.store(chunks, std::memory_order_relaxed);
+        state->fn = static_cast<void*>(std::addressof(fn));
+        state->call = [](void* f, size_t b, size_t e) { (*static_cast<std::remove_reference_t<Fn>*>(f))(b, e); };
+
+        const size_t helpers = std::min(workers_.size(), chunks - 1);
+        for (size_t i = 0; i < helpers; ++i) {
+            push(Task([state] { state->run(); }), priority, static_cast<int>(i));
+        }
+        state->run();
+
+        for (size_t left = state->remaining.load(std::memory_order_acquire); left != 0;
+             left = state->remaining.load(std::memory_order_acquire)) {
+            state->remaining.wait(left, std::memory_order_acquire);
+        }
+        if (state->error) {
+            std::rethrow_exception(state->error);
         }
     }
 
 private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::array<std::deque<Task>, TASK_PRIORITY_COUNT> lanes;
+    };
+
+    struct WorkerContext {
+        const ThreadPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    struct ParallelForState {
+        size_t begin = 0, end = 0, grain = 1, chunks = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> remaining{0};
+        void* fn = nullptr;
+        void (*call)(void* fn, size_t begin, size_t end) = nullptr;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+
+        // 领取分块直到领完；领到分块之后fn才会被访问，而调用方等到全部分块结束才返回
+        void run() {
+            for (size_t chunk = next.fetch_add(1); chunk < chunks; chunk = next.fetch_add(1)) {
+                const size_t b = begin + chunk * grain;
+                const size_t e = std::min(end, b + grain);
+                try {
+                    call(fn, b, e);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    remaining.notify_all();
+                }
+            }
+        }
+    };
+
+    static WorkerContext& workerContext() {
+        thread_local WorkerContext context;
+        return context;
+    }
+
+    void push(Task task, TaskPriority priority, int affinity) {
+        if (stop_.load()) {
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+        }
+        if (queues_.empty()) {
+            throw std::runtime_error("enqueue on ThreadPool without workers");
+        }
+        size_t target;
+        if (affinity >= 0) {
+            target = static_cast<size_t>(affinity) % queues_.size();
+        } else if (const int self = currentWorkerIndex(); self != ANY_WORKER) {
+            target = static_cast<size_t>(self);
+        } else {
+            target = nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues_[target].mutex);
+            queues_[target].lanes[static_cast<size_t>(priority)].push_back(std::move(task));
+        }
+        // 与workerLoop中先登记sleepers_再检查pending_相对：两边至少有一边能看到对方的写入
+        pending_.fetch_add(1);
+        if (sleepers_.load() > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            wakeup_.notify_one();
+        }
+    }
+
+    bool tryPop(size_t self, Task& task) {
+        const size_t count = queues_.size();
+        for (size_t lane = 0; lane < TASK_PRIORITY_COUNT; ++lane) {
+            {
+                WorkerQueue& own = queues_[self];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                auto& tasks = own.lanes[lane];
+                if (!tasks.empty()) {
+                    task = std::move(tasks.back());
+                    tasks.pop_back();
+                    pending_.fetch_sub(1);
+                    return true;
+                }
+            }
+            for (size_t offset = 1; offset < count; ++offset) {
+                WorkerQueue& victim = queues_[(self + offset) % count];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                auto& tasks = victim.lanes[lane];
+                if (!tasks.empty()) {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                    pending_.fetch_sub(1);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        workerContext() = WorkerContext{this, index};
+        if (hooks_.onStart) {
+            hooks_.onStart(index);
+        }
+        runWorker(index);
+        if (hooks_.onExit) {
+            hooks_.onExit(index);
+        }
+    }
+
+    void runWorker(size_t index) {
+        while (true) {
+            Task task;
+            if (tryPop(index, task)) {
+                try {
+                    task();
+                } catch (const std::exception& e) {
+                    fprintf(stderr, "ThreadPool task failed: %s\n", e.what());
+                } catch (...) {
+                    fprintf(stderr, "ThreadPool task failed with unknown exception\n");
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1);
+            wakeup_.wait(lock, [this] {
+                return stop_.load() || pending_.load() > 0;
+            });
+            sleepers_.fetch_sub(1);
+            if (stop_.load() && pending_.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    std::vector<WorkerQueue> queues_;
+    WorkerHooks hooks_;
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    
-    std::mutex queue_mutex_;
-    std::condition_variable condition_;
-    std::atomic<bool> stop_;
+    std::atomic<size_t> nextQueue_{0};
+    std::atomic<size_t> pending_{0};    // 所有队列中尚未取走的任务数
+    std::atomic<size_t> sleepers_{0};
+
+    std::mutex sleepMutex_;
+    std::condition_variable wakeup_;
+    std::atomic<bool> stop_{false};
 };
 
 } // namespace core
@@ -0,0 +1,184 @@
+#include "tick_budget.hpp"
+#include "metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+// 暂停期间每次休眠的时长：足够短，tick结束后很快恢复
+constexpr std::chrono::microseconds PAUSE_POLL{200};
+
+} // namespace
+
+const char* deferrableWorkName(DeferrableWork work) {
+    switch (work) {
+        case DeferrableWork::LIGHT_BATCH: return "light_batch";
+        case DeferrableWork::COMPRESSION: return "compression";
+        case DeferrableWork::PREFETCH:    return "prefetch";
+        case DeferrableWork::BULK_COPY:   return "bulk_copy";
+        default:                          return "unknown";
+    }
+}
+
+TickBudget& TickBudget::instance() {
+    static TickBudget budget;
+    return budget;
+}
+
+TickBudget::TickBudget() {
+    // 与本库其他指标一起导出；TickBudget随库存在，回调不移除
+    auto& registry = MetricsRegistry::instance();
+    registry.addCallback(MetricType::GAUGE, "lattice_tick_smoothed_mspt",
+                         "Smoothed main thread tick time reported to the native tick budget", {},
+                         [this] { return smoothedNanos_.load(std::memory_order_relaxed) / 1e6; });
+    registry.addCallback(MetricType::GAUGE, "lattice_tick_pressure",
+                         "Native tick budget pressure (0 unreported, 1 headroom, 2 normal, 3 behind, 4 overloaded)", {},
+                         [this] { return static_cast<double>(pressure()); });
+    for (size_t i = 0; i < DEFERRABLE_WORK_COUNT; ++i) {
+        registry.addCallback(MetricType::COUNTER, "lattice_tick_budget_pauses_total",
+                             "Times deferrable native work waited for the main thread tick",
+                             {{"work", deferrableWorkName(static_cast<DeferrableWork>(i))}},
+                             [this, i] { return static_cast<double>(pauses_[i].load(std::memory_order_relaxed)); });
+    }
+}
+
+int64_t TickBudget::nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void TickBudget::setTargetMspt(double mspt) {
+    if (!(mspt > 0.0) || !std::isfinite(mspt)) {
+        mspt = DEFAULT_TARGET_MSPT;
+    }
+    targetNanos_.store(static_cast<int64_t>(mspt * 1e6), std::memory_order_relaxed);
+}
+
+double TickBudget::targetMspt() const {
+    return static_cast<double>(targetNanos_.load(std::memory_order_relaxed)) / 1e6;
+}
+
+void TickBudget::tickStarted() {
+    const int64_t now = nowNanos();
+    tickStart_.store(now, std::memory_order_relaxed);
+    lastReport_.store(now, std::memory_order_relaxed);
+}
+
+void TickBudget::tickEnded() {
+    const int64_t start = tickStart_.exchange(0, std::memory_order_relaxed);
+    if (start == 0) {
+        return;
+    }
+    const int64_t now = nowNanos();
+    const int64_t duration = now - start;
+    lastReport_.store(now, std::memory_order_relaxed);
+    lastTickNanos_.store(duration, std::memory_order_relaxed);
+
+    // 只有主线程写，load+store即可
+    const double previous = smoothedNanos_.load(std::memory_order_relaxed);
+    const double smoothed = ticks_.load(std::memory_order_relaxed) == 0
+                                ? static_cast<double>(duration)
+                                : previous + EWMA_WEIGHT * (static_cast<double>(duration) - previous);
+    smoothedNanos_.store(smoothed, std::memory_order_relaxed);
+    ticks_.fetch_add(1, std::memory_order_relaxed);
+    if (duration > targetNanos_.load(std::memory_order_relaxed)) {
+        overruns_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+TickPressure TickBudget::pressureAt(int64_t now) const {
+    const int64_t lastReport = lastReport_.load(std::memory_order_relaxed);
+    if (lastReport == 0 || now - lastReport > REPORT_TIMEOUT_NANOS ||
+        ticks_.load(std::memory_order_relaxed) == 0) {
+        return TickPressure::UNREPORTED;
+    }
+    const double target = static_cast<double>(targetNanos_.load(std::memory_order_relaxed));
+    const int64_t start = tickStart_.load(std::memory_order_relaxed);
+    if (start != 0 && static_cast<double>(now - start) > target) {
+        return TickPressure::OVERLOADED;
+    }
+    const double ratio = smoothedNanos_.load(std::memory_order_relaxed) / target;
+    if (ratio < 0.5) {
+        return TickPressure::HEADROOM;
+    }
+    if (ratio < 0.8) {
+        return TickPressure::NORMAL;
+    }
+    if (ratio < 1.0) {
+        return TickPressure::BEHIND;
+    }
+    return TickPressure::OVERLOADED;
+}
+
+TickPressure TickBudget::pressure() const {
+    return pressureAt(nowNanos());
+}
+
+double TickBudget::throughput(DeferrableWork work) const {
+    const TickPressure current = pressure();
+    switch (work) {
+        case DeferrableWork::LIGHT_BATCH:
+            switch (current) {
+                case TickPressure::HEADROOM:   return 2.0;
+                case TickPressure::BEHIND:     return 0.5;
+                case TickPressure::OVERLOADED: return 0.25;
+                default:                       return 1.0;
+            }
+        case DeferrableWork::COMPRESSION:
+            // 压缩结果决定发包延迟，只在超时的tick进行中让出核心
+            return current == TickPressure::OVERLOADED && tickStart_.load(std::memory_order_relaxed) != 0
+                       ? 0.0 : 1.0;
+        case DeferrableWork::PREFETCH:
+            switch (current) {
+                case TickPressure::HEADROOM:   return 1.5;
+                case TickPressure::BEHIND:     return 0.25;
+                case TickPressure::OVERLOADED: return 0.0;
+                default:                       return 1.0;
+            }
+        case DeferrableWork::BULK_COPY:
+            return current == TickPressure::OVERLOADED ? 0.0 : 1.0;
+        default:
+            return 1.0;
+    }
+}
+
+size_t TickBudget::scale(DeferrableWork work, size_t normal) const {
+    const double factor = throughput(work);
+    if (factor <= 0.0) {
+        return 0;
+    }
+    return std::max<size_t>(1, static_cast<size_t>(static_cast<double>(normal) * factor));
+}
+
+bool TickBudget::waitWhilePaused(DeferrableWork work, std::chrono::microseconds maxWait) {
+    if (!paused(work)) {
+        return false;
+    }
+    pauses_[static_cast<size_t>(work)].fetch_add(1, std::memory_order_relaxed);
+    const auto deadline = std::chrono::steady_clock::now() + maxWait;
+    do {
+        std::this_thread::sleep_for(PAUSE_POLL);
+    } while (paused(work) && std::chrono::steady_clock::now() < deadline);
+    return true;
+}
+
+TickBudget::Stats TickBudget::getStats() const {
+    Stats stats;
+    stats.ticks = ticks_.load(std::memory_order_relaxed);
+    stats.overruns = overruns_.load(std::memory_order_relaxed);
+    stats.smoothedMspt = smoothedNanos_.load(std::memory_order_relaxed) / 1e6;
+    stats.lastMspt = static_cast<double>(lastTickNanos_.load(std::memory_order_relaxed)) / 1e6;
+    stats.pressure = pressure();
+    for (size_t i = 0; i < DEFERRABLE_WORK_COUNT; ++i) {
+        stats.pauses[i] = pauses_[i].load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+} // namespace core
+} // namespace lattice
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace lattice {
+namespace core {
+
+// ====== 主线程tick预算 ======
+//
+// 高峰时native后台线程（光照批处理、压缩、区块预取）与最需要核心的主线程tick争抢CPU。
+// Java在每个tick开始/结束时上报（NativeTickBudget），这里据此估计主线程落后的程度，
+// 可推迟的工作按类别降速或暂停，有余量时再加速。
+//
+// 与Tracer相同，每个桥接库各有一份TickBudget，Java侧向每个已加载的库上报。
+
+// 可推迟的后台工作类别
+enum class DeferrableWork : uint8_t {
+    LIGHT_BATCH,    // AdvancedLightEngine每批处理的更新数
+    COMPRESSION,    // AsyncCompressor工作线程
+    PREFETCH,       // ChunkPrefetcher的并发预取数
+    BULK_COPY,      // UnifiedScheduler的多线程大块拷贝
+    COUNT
+};
+
+inline constexpr size_t DEFERRABLE_WORK_COUNT = static_cast<size_t>(DeferrableWork::COUNT);
+
+const char* deferrableWorkName(DeferrableWork work);
+
+// 主线程负载，由平滑后的tick耗时与目标MSPT之比决定
+enum class TickPressure : uint8_t {
+    UNREPORTED,     // Java未上报（或超过一秒没有上报），不做任何限制
+    HEADROOM,       // < 50%目标：后台工作加速
+    NORMAL,         // < 80%
+    BEHIND,         // < 100%：降速
+    OVERLOADED      // 超过目标，或当前tick已超时：暂停可暂停的工作
+};
+
+/**
+ * @brief 本库的tick预算（进程内每个桥接库一份）
+ *
+ * 所有状态都是原子量：tickStarted/tickEnded只在主线程调用，其余读取来自任意线程，不加锁。
+ *
+ * 各类工作在不同负载下的吞吐倍数（throughput）：
+ *   类别          HEADROOM  NORMAL  BEHIND  OVERLOADED
+ *   LIGHT_BATCH   2         1       0.5     0.25       光照不能停，只缩小批次
+ *   COMPRESSION   1         1       1       0（tick进行中）  tick之间照常
+ *   PREFETCH      1.5       1       0.25    0
+ *   BULK_COPY     1         1       1       0          改在调用线程上执行
+ * 暂停都是有界的：waitWhilePaused最多等待maxWait，tick结束时立即恢复
+ */
+class TickBudget {
+public:
+    static constexpr double DEFAULT_TARGET_MSPT = 50.0;
+    static constexpr double EWMA_WEIGHT = 0.2;          // 最新一个tick的权重
+    static constexpr int64_t REPORT_TIMEOUT_NANOS = 1'000'000'000;
+
+    static TickBudget& instance();
+
+    // 目标每tick毫秒数（例如50，或服务器设定的更低目标）；<= 0时恢复默认
+    void setTargetMspt(double mspt);
+    double targetMspt() const;
+
+    // 主线程在每个tick开始/结束时调用
+    void tickStarted();
+    void tickEnded();
+
+    TickPressure pressure() const;
+
+    // 相对正常吞吐的倍数，0表示暂停
+    double throughput(DeferrableWork work) const;
+
+    // normal按throughput缩放，暂停时返回0，否则至少为1
+    size_t scale(DeferrableWork work, size_t normal) const;
+
+    bool paused(DeferrableWork work) const { return throughput(work) <= 0.0; }
+
+    /**
+     * 工作线程在取下一项工作前调用：暂停期间短暂休眠，直到恢复或等满maxWait
+     * 返回是否等待过
+     */
+    bool waitWhilePaused(DeferrableWork work, std::chrono::microseconds maxWait);
+
+    struct Stats {
+        uint64_t ticks = 0;
+        uint64_t overruns = 0;              // 耗时超过目标的tick
+        double smoothedMspt = 0.0;
+        double lastMspt = 0.0;
+        TickPressure pressure = TickPressure::UNREPORTED;
+        std::array<uint64_t, DEFERRABLE_WORK_COUNT> pauses{};  // waitWhilePaused实际等待的次数
+    };
+    Stats getStats() const;
+
+private:
+    TickBudget();
+
+    static int64_t nowNanos();
+    TickPressure pressureAt(int64_t now) const;
+
+    std::atomic<int64_t> targetNanos_{static_cast<int64_t>(DEFAULT_TARGET_MSPT * 1e6)};
+    std::atomic<int64_t> tickStart_{0};     // 0表示不在tick中
+    std::atomic<int64_t> lastReport_{0};    // 最近一次上报的时间
+    std::atomic<double> smoothedNanos_{0.0};
+    std::atomic<int64_t> lastTickNanos_{0};
+    std::atomic<uint64_t> ticks_{0};
+    std::atomic<uint64_t> overruns_{0};
+    std::array<std::atomic<uint64_t>, DEFERRABLE_WORK_COUNT> pauses_{};
+};
+
+} // namespace core
+} // namespace lattice
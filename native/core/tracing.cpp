@@ -0,0 +1,329 @@
+#include "tracing.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+enum EventType : uint8_t {
+    COMPLETE = 0,
+    COUNTER = 1
+};
+
+uint32_t currentPid() {
+#if defined(_WIN32)
+    return static_cast<uint32_t>(_getpid());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// 系统线程号：不同桥接库的同一线程在合并后落在同一条轨道上
+uint32_t currentTid() {
+#if defined(__linux__)
+    return static_cast<uint32_t>(::syscall(SYS_gettid));
+#else
+    static std::atomic<uint32_t> next{1};
+    thread_local const uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+#endif
+}
+
+std::string currentThreadName() {
+#if defined(__linux__)
+    char name[16] = {};
+    if (pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 && name[0] != '\0') {
+        return name;
+    }
+#endif
+    return "thread-" + std::to_string(currentTid());
+}
+
+void writeJsonString(std::FILE* out, const char* text) {
+    std::fputc('"', out);
+    for (const char* p = text ? text : ""; *p; ++p) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', out);
+            std::fputc(c, out);
+        } else if (c < 0x20) {
+            std::fprintf(out, "\\u%04x", c);
+        } else {
+            std::fputc(c, out);
+        }
+    }
+    std::fputc('"', out);
+}
+
+// trace event的时间单位是微秒，保留到纳秒
+double micros(uint64_t nanos) {
+    return static_cast<double>(nanos) / 1000.0;
+}
+
+/**
+ * 之前dump写出的数组：定位到结尾的']'，返回数组中是否已有事件；不是这种文件时返回false并置valid为false
+ */
+bool seekArrayEnd(std::FILE* file, bool& valid) {
+    valid = false;
+    if (std::fseek(file, 0, SEEK_END) != 0) {
+        return false;
+    }
+    long position = std::ftell(file);
+    int last = 0;
+    while (position > 0) {
+        std::fseek(file, --position, SEEK_SET);
+        last = std::fgetc(file);
+        if (last != ' ' && last != '\n' && last != '\r' && last != '\t') {
+            break;
+        }
+    }
+    if (last != ']' || position <= 0) {
+        return false;
+    }
+    const long bracket = position;
+    int previous = 0;
+    while (position > 0) {
+        std::fseek(file, --position, SEEK_SET);
+        previous = std::fgetc(file);
+        if (previous != ' ' && previous != '\n' && previous != '\r' && previous != '\t') {
+            break;
+        }
+    }
+    std::fseek(file, 0, SEEK_SET);
+    if (std::fgetc(file) != '[') {
+        return false;
+    }
+    valid = true;
+    std::fseek(file, bracket, SEEK_SET);
+    return previous != '[';
+}
+
+} // namespace
+
+// 线程退出时标记缓冲区，dump取完剩余事件后移除
+struct ThreadSlot {
+    std::shared_ptr<Tracer::ThreadBuffer> buffer;
+    ~ThreadSlot();
+};
+
+struct Tracer::ThreadBuffer {
+    std::unique_ptr<Event[]> events{new Event[BUFFER_EVENTS]};
+    std::atomic<uint64_t> head{0};      // 只由所属线程写
+    std::atomic<uint64_t> tail{0};      // 只由dump()写
+    std::atomic<bool> exited{false};
+    uint32_t tid = 0;
+    std::string threadName;
+
+    // beginSpan()打开、尚未结束的区间，只由所属线程访问
+    struct OpenSpan {
+        const char* category;
+        const char* name;
+        uint64_t start;
+    };
+    std::vector<OpenSpan> open;
+};
+
+ThreadSlot::~ThreadSlot() {
+    if (buffer) {
+        buffer->exited.store(true, std::memory_order_release);
+    }
+}
+
+std::atomic<bool> Tracer::enabled_{false};
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer() {
+    if (const char* flag = std::getenv("LATTICE_TRACE")) {
+        if (std::strcmp(flag, "1") == 0) {
+            setEnabled(true);
+        }
+    }
+}
+
+Tracer::~Tracer() = default;
+
+uint64_t Tracer::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Tracer::setEnabled(bool enabled) {
+    if (enabled_.exchange(enabled, std::memory_order_relaxed) != enabled) {
+        std::fprintf(stderr, "[Lattice] Native tracing %s\n", enabled ? "enabled" : "disabled");
+    }
+}
+
+Tracer::ThreadBuffer* Tracer::threadBuffer() {
+    thread_local ThreadSlot slot;
+    if (!slot.buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->tid = currentTid();
+        buffer->threadName = currentThreadName();
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex_);
+            buffers_.push_back(buffer);
+        }
+        slot.buffer = std::move(buffer);
+    }
+    return slot.buffer.get();
+}
+
+void Tracer::push(const Event& event) {
+    ThreadBuffer* buffer = threadBuffer();
+    const uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    if (head - buffer->tail.load(std::memory_order_acquire) >= BUFFER_EVENTS) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buffer->events[head & (BUFFER_EVENTS - 1)] = event;
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void Tracer::complete(const char* category, const char* name, uint64_t startNanos, uint64_t endNanos) {
+    push(Event{startNanos, endNanos > startNanos ? endNanos - startNanos : 0, category, name, COMPLETE});
+}
+
+void Tracer::counter(const char* category, const char* name, int64_t value) {
+    push(Event{now(), static_cast<uint64_t>(value), category, name, COUNTER});
+}
+
+void Tracer::beginSpan(const char* category, const char* name) {
+    if (!enabled()) {
+        return;
+    }
+    threadBuffer()->open.push_back(ThreadBuffer::OpenSpan{category, name, now()});
+}
+
+void Tracer::endSpan() {
+    auto& open = threadBuffer()->open;
+    if (open.empty()) {
+        return;
+    }
+    const auto span = open.back();
+    open.pop_back();
+    complete(span.category, span.name, span.start, now());
+}
+
+const char* Tracer::intern(std::string_view text) {
+    std::lock_guard<std::mutex> lock(internMutex_);
+    return interned_.emplace(text).first->c_str();
+}
+
+int64_t Tracer::dump(const std::string& path, bool append) {
+    std::lock_guard<std::mutex> dumpLock(dumpMutex_);
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffers = buffers_;
+    }
+
+    std::FILE* file = nullptr;
+    bool hasEvents = false;
+    if (append) {
+        file = std::fopen(path.c_str(), "r+b");
+        bool valid = false;
+        if (file) {
+            hasEvents = seekArrayEnd(file, valid);
+            if (!valid) {
+                std::fclose(file);
+                file = nullptr;
+            }
+        }
+    }
+    if (!file) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::fprintf(stderr, "[Lattice] Cannot open trace output %s\n", path.c_str());
+            return -1;
+        }
+        std::fputc('[', file);
+    }
+
+    const uint32_t pid = currentPid();
+    auto separator = [&] {
+        std::fputs(hasEvents ? ",\n" : "\n", file);
+        hasEvents = true;
+    };
+
+    separator();
+    std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"lattice\"}}", pid);
+
+    int64_t written = 0;
+    for (const auto& buffer : buffers) {
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        const uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        if (head == tail) {
+            continue;
+        }
+        separator();
+        std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":",
+                     pid, buffer->tid);
+        writeJsonString(file, buffer->threadName.c_str());
+        std::fputs("}}", file);
+
+        for (uint64_t i = tail; i < head; ++i) {
+            const Event& event = buffer->events[i & (BUFFER_EVENTS - 1)];
+            separator();
+            std::fputs("{\"name\":", file);
+            writeJsonString(file, event.name);
+            std::fputs(",\"cat\":", file);
+            writeJsonString(file, event.category);
+            if (event.type == COUNTER) {
+                std::fprintf(file, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":%u,\"args\":{\"value\":%lld}}",
+                             micros(event.timestamp), pid, static_cast<long long>(event.duration));
+            } else {
+                std::fprintf(file, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}",
+                             micros(event.timestamp), micros(event.duration), pid, buffer->tid);
+            }
+            ++written;
+        }
+        buffer->tail.store(head, std::memory_order_release);
+    }
+    std::fputs("\n]\n", file);
+
+    const bool ok = std::ferror(file) == 0;
+    if (std::fclose(file) != 0 || !ok) {
+        std::fprintf(stderr, "[Lattice] Failed writing trace output %s\n", path.c_str());
+        return -1;
+    }
+
+    // 已退出且取空的线程不再保留缓冲区
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        std::erase_if(buffers_, [](const std::shared_ptr<ThreadBuffer>& buffer) {
+            return buffer->exited.load(std::memory_order_acquire) &&
+                   buffer->head.load(std::memory_order_acquire) == buffer->tail.load(std::memory_order_relaxed);
+        });
+    }
+    return written;
+}
+
+namespace {
+
+// 库加载时读取LATTICE_TRACE
+[[maybe_unused]] const bool environmentChecked = (Tracer::instance(), true);
+
+} // namespace
+
+} // namespace core
+} // namespace lattice
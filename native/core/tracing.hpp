@@ -0,0 +1,141 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace lattice {
+namespace core {
+
+// ====== 时间线追踪 ======
+//
+// 各子系统在热点函数上放LATTICE_TRACE_SPAN，记录开始时间与耗时；LATTICE_TRACE_COUNTER记录队列长度等数值。
+// 事件写入线程自己的无锁环形缓冲区，dump()时取出并以Chrome trace event格式（JSON）写出，
+// 可以直接用Perfetto UI（ui.perfetto.dev）或chrome://tracing打开。
+// 各PerformanceStats只有平均值，这里看的是native工作与主线程tick在时间上的重叠。
+//
+// 与WorkloadRecorder相同，每个桥接库各有一份Tracer：dump时按顺序追加到同一个文件，
+// 时间戳都取steady_clock，线程号取系统tid，合并后在同一条时间线上。
+
+/**
+ * @brief 本库的追踪器（进程内每个桥接库一份）
+ *
+ * 关闭时每个追踪点只有一次relaxed load。开启后每个线程第一次记录时分配BUFFER_EVENTS个事件的缓冲区，
+ * 写入方是线程本身、读取方是dump()，单生产者单消费者，不加锁；缓冲区满时丢弃新事件并计数。
+ * 事件名与分类只保存指针，须是字符串字面量或intern()返回的指针。
+ *
+ * 环境变量 LATTICE_TRACE=1 在库加载时开启；运行时通过NativeTracing（JNI）或lattice_tracing_*（FFI）切换。
+ */
+class Tracer {
+public:
+    static constexpr size_t BUFFER_EVENTS = size_t{1} << 15;
+
+    static Tracer& instance();
+
+    static bool enabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // steady_clock纳秒
+    static uint64_t now();
+
+    // 关闭后已记录的事件保留到下一次dump()
+    void setEnabled(bool enabled);
+
+    // 一段已结束的工作（Chrome trace的complete事件）
+    void complete(const char* category, const char* name, uint64_t startNanos, uint64_t endNanos);
+    void counter(const char* category, const char* name, int64_t value);
+
+    /**
+     * 跨调用的区间（JNI侧的tick开始/结束）：同一线程上按栈配对，endSpan()结束最近一次beginSpan()。
+     * 没有配对的beginSpan()不会写出
+     */
+    void beginSpan(const char* category, const char* name);
+    void endSpan();
+
+    // 保存一份字符串副本并返回稳定的指针（Java传入的名字）
+    const char* intern(std::string_view text);
+
+    /**
+     * 取出所有线程缓冲区中的事件写入path（JSON数组）
+     * append为true且文件是之前dump写出的数组时接在末尾，其他情况覆盖
+     * 返回写出的事件数，打开或写入失败时返回-1
+     */
+    int64_t dump(const std::string& path, bool append);
+
+    uint64_t droppedEvents() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Event {
+        uint64_t timestamp;
+        uint64_t duration;              // COUNTER时为数值（按int64解释）
+        const char* category;
+        const char* name;
+        uint8_t type;
+    };
+
+    struct ThreadBuffer;
+    friend struct ThreadSlot;
+
+    Tracer();
+    ~Tracer();
+
+    ThreadBuffer* threadBuffer();
+    void push(const Event& event);
+
+    static std::atomic<bool> enabled_;
+
+    std::mutex buffersMutex_;           // 保护buffers_；线程第一次记录与dump时获取
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+    std::mutex dumpMutex_;              // dump()串行，缓冲区只有一个读取方
+    std::mutex internMutex_;
+    std::unordered_set<std::string> interned_;
+    std::atomic<uint64_t> dropped_{0};
+};
+
+/**
+ * @brief 作用域内的一段工作，构造时开启才记录
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+        : category_(category), name_(name), start_(Tracer::enabled() ? Tracer::now() : 0) {}
+
+    ~TraceSpan() {
+        if (start_ != 0) {
+            Tracer::instance().complete(category_, name_, start_, Tracer::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* category_;
+    const char* name_;
+    uint64_t start_;
+};
+
+} // namespace core
+} // namespace lattice
+
+#define LATTICE_TRACE_CONCAT_INNER(a, b) a##b
+#define LATTICE_TRACE_CONCAT(a, b) LATTICE_TRACE_CONCAT_INNER(a, b)
+
+// 分类按子系统：chunk_io、compression、light、redstone、ai、server（Java侧的tick）
+#define LATTICE_TRACE_SPAN(category, name) \
+    ::lattice::core::TraceSpan LATTICE_TRACE_CONCAT(latticeTraceSpan_, __LINE__)(category, name)
+
+#define LATTICE_TRACE_COUNTER(category, name, value)                                        \
+    do {                                                                                    \
+        if (::lattice::core::Tracer::enabled()) {                                           \
+            ::lattice::core::Tracer::instance().counter(category, name,                     \
+                                                        static_cast<int64_t>(value));       \
+        }                                                                                   \
+    } while (0)
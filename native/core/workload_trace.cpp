@@ -0,0 +1,444 @@
+#include "workload_trace.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <dlfcn.h>
+#include <unistd.h>
+#endif
+
+namespace lattice {
+namespace core {
+
+namespace {
+
+constexpr char MAGIC[4] = {'L', 'W', 'T', '1'};
+constexpr size_t HEADER_FIXED_SIZE = 4 + 4 + 8 + 4 + 2;
+
+uint64_t monotonicNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t currentPid() {
+#if defined(_WIN32)
+    return static_cast<uint32_t>(_getpid());
+#else
+    return static_cast<uint32_t>(getpid());
+#endif
+}
+
+// 库内线程序号：比系统线程ID短，编码后通常只占1字节
+uint32_t threadIndex() {
+    static std::atomic<uint32_t> next{1};
+    thread_local const uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+// 每个线程编码当前记录用的缓冲区，提交后保留容量
+std::vector<uint8_t>& recordScratch() {
+    thread_local std::vector<uint8_t> scratch;
+    return scratch;
+}
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putLittle(std::vector<uint8_t>& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint64_t getLittle(const uint8_t* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    return value;
+}
+
+// 本记录器所在共享库的文件名（去掉lib前缀与扩展名），取不到时为"lattice"
+std::string resolveLibraryTag() {
+    std::string tag;
+#if !defined(_WIN32)
+    Dl_info info{};
+    if (dladdr(reinterpret_cast<void*>(&resolveLibraryTag), &info) && info.dli_fname) {
+        tag = info.dli_fname;
+        const size_t slash = tag.find_last_of('/');
+        if (slash != std::string::npos) {
+            tag.erase(0, slash + 1);
+        }
+        if (tag.rfind("lib", 0) == 0) {
+            tag.erase(0, 3);
+        }
+        const size_t dot = tag.find('.');
+        if (dot != std::string::npos) {
+            tag.erase(dot);
+        }
+    }
+#endif
+    return tag.empty() ? "lattice" : tag;
+}
+
+} // namespace
+
+// ====== 事件元数据 ======
+
+const char* traceEventName(TraceEvent event) {
+    switch (event) {
+        case TraceEvent::CHUNK_LOAD: return "chunk_load";
+        case TraceEvent::CHUNK_LOAD_BATCH: return "chunk_load_batch";
+        case TraceEvent::CHUNK_SAVE: return "chunk_save";
+        case TraceEvent::ENTITY_WORLD_CREATE: return "entity_world_create";
+        case TraceEvent::ENTITY_WORLD_DESTROY: return "entity_world_destroy";
+        case TraceEvent::ENTITY_ADD: return "entity_add";
+        case TraceEvent::ENTITY_MOVE: return "entity_move";
+        case TraceEvent::ENTITY_MOVE_BATCH: return "entity_move_batch";
+        case TraceEvent::ENTITY_REMOVE: return "entity_remove";
+        case TraceEvent::ENTITY_VIEW_UPDATE: return "entity_view_update";
+        case TraceEvent::ENTITY_VIEW_QUERY: return "entity_view_query";
+        case TraceEvent::ENTITY_VIEWER_REMOVE: return "entity_viewer_remove";
+        case TraceEvent::ENTITY_TICK: return "entity_tick";
+        case TraceEvent::ENTITY_TICK_SHARD: return "entity_tick_shard";
+        case TraceEvent::LIGHT_SOURCE_ADD: return "light_source_add";
+        case TraceEvent::LIGHT_SOURCE_REMOVE: return "light_source_remove";
+        case TraceEvent::LIGHT_PROPAGATE: return "light_propagate";
+        case TraceEvent::REDSTONE_COMPONENT: return "redstone_component";
+        case TraceEvent::REDSTONE_POWER: return "redstone_power";
+        case TraceEvent::REDSTONE_COMPARATOR_BIND: return "redstone_comparator_bind";
+        case TraceEvent::REDSTONE_CONTAINER: return "redstone_container";
+        case TraceEvent::REDSTONE_TICK: return "redstone_tick";
+        default: return "unknown";
+    }
+}
+
+const char* traceSubsystemName(TraceSubsystem subsystem) {
+    switch (subsystem) {
+        case TraceSubsystem::CHUNK_IO: return "chunk_io";
+        case TraceSubsystem::ENTITY: return "entity";
+        case TraceSubsystem::LIGHT: return "light";
+        case TraceSubsystem::REDSTONE: return "redstone";
+        default: return "unknown";
+    }
+}
+
+TraceSubsystem traceSubsystemOf(TraceEvent event) {
+    if (event <= TraceEvent::CHUNK_SAVE) {
+        return TraceSubsystem::CHUNK_IO;
+    }
+    if (event <= TraceEvent::ENTITY_TICK_SHARD) {
+        return TraceSubsystem::ENTITY;
+    }
+    if (event <= TraceEvent::LIGHT_PROPAGATE) {
+        return TraceSubsystem::LIGHT;
+    }
+    return TraceSubsystem::REDSTONE;
+}
+
+// ====== 记录 ======
+
+std::atomic<bool> WorkloadRecorder::recording_{false};
+
+WorkloadRecorder& WorkloadRecorder::instance() {
+    static WorkloadRecorder recorder;
+    return recorder;
+}
+
+WorkloadRecorder::WorkloadRecorder() : libraryTag_(resolveLibraryTag()) {
+    startFromEnvironment();
+}
+
+WorkloadRecorder::~WorkloadRecorder() {
+    stop();
+}
+
+void WorkloadRecorder::startFromEnvironment() {
+    const char* prefix = std::getenv("LATTICE_WORKLOAD_TRACE");
+    if (!prefix || !*prefix) {
+        return;
+    }
+    Options options;
+    if (const char* payloads = std::getenv("LATTICE_WORKLOAD_TRACE_PAYLOADS")) {
+        options.chunkPayloads = std::strcmp(payloads, "0") != 0;
+    }
+    if (const char* maxMb = std::getenv("LATTICE_WORKLOAD_TRACE_MAX_MB")) {
+        const long long megabytes = std::atoll(maxMb);
+        if (megabytes > 0) {
+            options.maxBytes = static_cast<uint64_t>(megabytes) * 1024 * 1024;
+        }
+    }
+    start(std::string(prefix) + "." + libraryTag_ + "." + std::to_string(currentPid()) + ".lwt", options);
+}
+
+bool WorkloadRecorder::start(const std::string& path, const Options& options) {
+    stop();
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::fprintf(stderr, "[Lattice] Cannot open workload trace %s\n", path.c_str());
+        return false;
+    }
+    const uint64_t startTime = monotonicNanos();
+    std::vector<uint8_t> header(MAGIC, MAGIC + sizeof(MAGIC));
+    putLittle(header, FORMAT_VERSION, 4);
+    putLittle(header, startTime, 8);
+    putLittle(header, currentPid(), 4);
+    putLittle(header, libraryTag_.size(), 2);
+    header.insert(header.end(), libraryTag_.begin(), libraryTag_.end());
+    if (std::fwrite(header.data(), 1, header.size(), file) != header.size()) {
+        std::fprintf(stderr, "[Lattice] Cannot write workload trace %s\n", path.c_str());
+        std::fclose(file);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ = file;
+    options_ = options;
+    buffer_.clear();
+    buffer_.reserve(READY_BYTES + 64 * 1024);
+    lastTimestamp_ = startTime;
+    pending_ = 0;
+    bytesWritten_.store(header.size(), std::memory_order_relaxed);
+    recording_.store(true, std::memory_order_release);
+    std::fprintf(stderr, "[Lattice] Recording workload trace to %s\n", path.c_str());
+    return true;
+}
+
+void WorkloadRecorder::stop() {
+    std::vector<uint8_t> remaining;
+    std::FILE* file = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        recording_.store(false, std::memory_order_release);
+        if (!file_) {
+            return;
+        }
+        remaining.swap(buffer_);
+        file = file_;
+        file_ = nullptr;
+        pending_ = 0;
+    }
+    // 等待正在进行的写出
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    if (!remaining.empty()) {
+        std::fwrite(remaining.data(), 1, remaining.size(), file);
+        bytesWritten_.fetch_add(remaining.size(), std::memory_order_relaxed);
+    }
+    std::fclose(file);
+}
+
+void WorkloadRecorder::commit(TraceEvent event, const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> ready;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!file_) {
+        return;     // 编码期间另一个线程结束了记录
+    }
+    // 时间戳在锁内取，文件中的记录按时间单调
+    const uint64_t now = std::max(monotonicNanos(), lastTimestamp_);
+    const size_t before = buffer_.size();
+    buffer_.push_back(static_cast<uint8_t>(event));
+    putVarint(buffer_, now - lastTimestamp_);
+    putVarint(buffer_, threadIndex());
+    putVarint(buffer_, payload.size());
+    buffer_.insert(buffer_.end(), payload.begin(), payload.end());
+    lastTimestamp_ = now;
+    pending_ += buffer_.size() - before;
+
+    const bool overLimit = bytesWritten_.load(std::memory_order_relaxed) + pending_ >= options_.maxBytes;
+    if (overLimit) {
+        lock.unlock();
+        std::fprintf(stderr, "[Lattice] Workload trace reached its size limit, recording stopped\n");
+        stop();
+        return;
+    }
+    if (buffer_.size() < READY_BYTES) {
+        return;
+    }
+    ready.swap(buffer_);
+    buffer_.reserve(READY_BYTES + 64 * 1024);
+    pending_ = 0;
+    std::FILE* file = file_;
+    // fileMutex_在释放mutex_之前获取：下一批只能在这一批写出之后写出
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    lock.unlock();
+    std::fwrite(ready.data(), 1, ready.size(), file);
+    bytesWritten_.fetch_add(ready.size(), std::memory_order_relaxed);
+}
+
+namespace {
+
+// 库加载时读取环境变量：记录点只检查recording_，不会主动构造记录器
+[[maybe_unused]] const bool environmentChecked = (WorkloadRecorder::instance(), true);
+
+} // namespace
+
+WorkloadRecorder::Record::Record(TraceEvent event)
+    : event_(event), active_(WorkloadRecorder::recording()) {
+    if (active_) {
+        recordScratch().clear();
+    }
+}
+
+WorkloadRecorder::Record::~Record() {
+    if (active_) {
+        WorkloadRecorder::instance().commit(event_, recordScratch());
+    }
+}
+
+WorkloadRecorder::Record& WorkloadRecorder::Record::i64(int64_t value) {
+    if (active_) {
+        putVarint(recordScratch(), (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+    return *this;
+}
+
+WorkloadRecorder::Record& WorkloadRecorder::Record::u64(uint64_t value) {
+    if (active_) {
+        putVarint(recordScratch(), value);
+    }
+    return *this;
+}
+
+WorkloadRecorder::Record& WorkloadRecorder::Record::f32(float value) {
+    if (active_) {
+        putLittle(recordScratch(), std::bit_cast<uint32_t>(value), 4);
+    }
+    return *this;
+}
+
+WorkloadRecorder::Record& WorkloadRecorder::Record::bytes(const uint8_t* data, size_t size) {
+    if (active_) {
+        auto& scratch = recordScratch();
+        putVarint(scratch, size);
+        if (size > 0) {
+            scratch.insert(scratch.end(), data, data + size);
+        }
+    }
+    return *this;
+}
+
+// ====== 读取 ======
+
+uint64_t TraceFieldReader::u64() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos_ >= data_.size()) {
+            ok_ = false;
+            return 0;
+        }
+        const uint8_t byte = data_[pos_++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    ok_ = false;
+    return 0;
+}
+
+int64_t TraceFieldReader::i64() {
+    const uint64_t encoded = u64();
+    return static_cast<int64_t>((encoded >> 1) ^ (~(encoded & 1) + 1));
+}
+
+float TraceFieldReader::f32() {
+    if (data_.size() - std::min(pos_, data_.size()) < 4) {
+        ok_ = false;
+        return 0.0f;
+    }
+    const uint32_t bits = static_cast<uint32_t>(getLittle(data_.data() + pos_, 4));
+    pos_ += 4;
+    return std::bit_cast<float>(bits);
+}
+
+std::span<const uint8_t> TraceFieldReader::bytes() {
+    const uint64_t size = u64();
+    if (!ok_ || size > data_.size() - pos_) {
+        ok_ = false;
+        return {};
+    }
+    auto result = data_.subspan(pos_, static_cast<size_t>(size));
+    pos_ += static_cast<size_t>(size);
+    return result;
+}
+
+WorkloadTraceReader::WorkloadTraceReader(const std::string& path) : in_(path, std::ios::binary) {
+    uint8_t header[HEADER_FIXED_SIZE];
+    if (!in_) {
+        error_ = "cannot open " + path;
+        return;
+    }
+    if (!in_.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0) {
+        error_ = path + " is not a workload trace";
+        return;
+    }
+    const uint32_t version = static_cast<uint32_t>(getLittle(header + 4, 4));
+    if (version != WorkloadRecorder::FORMAT_VERSION) {
+        error_ = path + " has unsupported version " + std::to_string(version);
+        return;
+    }
+    startTime_ = getLittle(header + 8, 8);
+    pid_ = static_cast<uint32_t>(getLittle(header + 16, 4));
+    libraryTag_.resize(static_cast<size_t>(getLittle(header + 20, 2)));
+    if (!in_.read(libraryTag_.data(), static_cast<std::streamsize>(libraryTag_.size()))) {
+        error_ = path + " has a truncated header";
+        return;
+    }
+    timestamp_ = startTime_;
+}
+
+bool WorkloadTraceReader::readVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int byte = in_.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkloadTraceReader::next(TraceRecordView& record) {
+    if (!isOpen() || truncated_) {
+        return false;
+    }
+    const int event = in_.get();
+    if (event == std::char_traits<char>::eof()) {
+        return false;
+    }
+    uint64_t delta, thread, size;
+    if (!readVarint(delta) || !readVarint(thread) || !readVarint(size)) {
+        truncated_ = true;
+        return false;
+    }
+    payload_.resize(static_cast<size_t>(size));
+    if (size > 0 && !in_.read(reinterpret_cast<char*>(payload_.data()), static_cast<std::streamsize>(size))) {
+        truncated_ = true;
+        return false;
+    }
+    timestamp_ += delta;
+    record.event = static_cast<TraceEvent>(event);
+    record.timestamp = timestamp_;
+    record.thread = static_cast<uint32_t>(thread);
+    record.payload = payload_;
+    return true;
+}
+
+} // namespace core
+} // namespace lattice
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace lattice {
+namespace core {
+
+// ====== 工作负载记录与回放 ======
+//
+// 在JNI入口记录调用（区块加载/保存、实体更新、光源变化、红石事件），离线用lattice_replay
+// 按记录重新驱动native引擎，复现线上的卡顿。
+//
+// 文件格式（小端）：
+//   头部  "LWT1" | u32 版本 | u64 起始时间（steady_clock纳秒）| u32 pid | u16 长度 + 库名
+//   记录  u8 事件 | varint 距上一条的纳秒数 | varint 线程序号 | varint 负载长度 | 负载
+// 负载字段按事件固定顺序写入：整数为zigzag varint，float为4字节，字节串为varint长度 + 内容。
+// 负载带长度，读取端可以跳过不认识的事件；进程异常退出时丢失的只是最后一个缓冲区。
+//
+// 每个桥接库（lattice_native、lattice_chunk_io等）各有一份记录器，各写一个文件，
+// 时间戳使用同一个单调时钟，回放时按时间合并。
+
+enum class TraceEvent : uint8_t {
+    CHUNK_LOAD = 1,             // worldId, x, z
+    CHUNK_LOAD_BATCH,           // worldId, 数量, 按ChunkLoadBatcher打包的坐标...
+    CHUNK_SAVE,                 // worldId, x, z, 原始大小, NBT（不记录负载时为空）
+    ENTITY_WORLD_CREATE,        // worldId, 分片边长, 世界高度
+    ENTITY_WORLD_DESTROY,       // worldId
+    ENTITY_ADD,                 // worldId, id, x, y, z, 半径, EntityType
+    ENTITY_MOVE,                // worldId, id, x, y, z
+    ENTITY_MOVE_BATCH,          // worldId, 数量, (id, x, y, z)...
+    ENTITY_REMOVE,              // worldId, id
+    ENTITY_VIEW_UPDATE,         // worldId, 观察者id, x, y, z, 视距
+    ENTITY_VIEW_QUERY,          // worldId, 观察者id, x, y, z, 视距
+    ENTITY_VIEWER_REMOVE,       // worldId, 观察者id
+    ENTITY_TICK,                // worldId
+    ENTITY_TICK_SHARD,          // worldId, 分片x, 分片z
+    LIGHT_SOURCE_ADD,           // x, y, z, 等级, 光照类型
+    LIGHT_SOURCE_REMOVE,        // x, y, z, 光照类型
+    LIGHT_PROPAGATE,            //
+    REDSTONE_COMPONENT,         // RedstoneComponentKind, x, y, z, 参数（中继器延迟、比较器减法模式等）
+    REDSTONE_POWER,             // x, y, z, 信号强度
+    REDSTONE_COMPARATOR_BIND,   // x, y, z, 容器x, 容器y, 容器z, 信号
+    REDSTONE_CONTAINER,         // 容器x, 容器y, 容器z, 信号
+    REDSTONE_TICK,              //
+    COUNT
+};
+
+enum class TraceSubsystem : uint8_t {
+    CHUNK_IO = 0,
+    ENTITY,
+    LIGHT,
+    REDSTONE,
+    COUNT
+};
+
+enum class RedstoneComponentKind : uint8_t {
+    WIRE = 0,
+    REPEATER,
+    COMPARATOR,
+    TORCH,
+    LEVER,
+    BUTTON,
+    PRESSURE_PLATE,
+    OBSERVER,
+    PISTON
+};
+
+constexpr size_t TRACE_EVENT_COUNT = static_cast<size_t>(TraceEvent::COUNT);
+constexpr size_t TRACE_SUBSYSTEM_COUNT = static_cast<size_t>(TraceSubsystem::COUNT);
+
+const char* traceEventName(TraceEvent event);
+const char* traceSubsystemName(TraceSubsystem subsystem);
+TraceSubsystem traceSubsystemOf(TraceEvent event);
+
+/**
+ * @brief 本库的工作负载记录器（进程内每个桥接库一份）
+ *
+ * 未开启时每个记录点只有一次relaxed load。开启后各线程编码到线程局部缓冲区，
+ * 在互斥锁下追加到共享缓冲区，满READY_BYTES后在锁外写文件（写文件按提交顺序串行）。
+ *
+ * 环境变量（库加载后第一次使用记录器时读取）：
+ *   LATTICE_WORKLOAD_TRACE=<前缀>            开始记录，文件为 <前缀>.<库名>.<pid>.lwt
+ *   LATTICE_WORKLOAD_TRACE_PAYLOADS=0        保存区块时只记录大小，不记录NBT
+ *   LATTICE_WORKLOAD_TRACE_MAX_MB=<n>        文件达到n MiB后停止记录（默认1024）
+ */
+class WorkloadRecorder {
+public:
+    struct Options {
+        bool chunkPayloads = true;
+        uint64_t maxBytes = uint64_t{1024} * 1024 * 1024;
+    };
+
+    static constexpr uint32_t FORMAT_VERSION = 1;
+    static constexpr size_t READY_BYTES = 256 * 1024;
+
+    static WorkloadRecorder& instance();
+
+    static bool recording() {
+        return recording_.load(std::memory_order_relaxed);
+    }
+
+    // 已在记录时先结束当前文件；打开失败返回false并输出到stderr
+    bool start(const std::string& path, const Options& options);
+    // 写出缓冲区并关闭文件；未在记录时什么也不做
+    void stop();
+
+    bool chunkPayloads() const { return options_.chunkPayloads; }
+    uint64_t bytesWritten() const { return bytesWritten_.load(std::memory_order_relaxed); }
+    // 本库文件名中使用的库名，例如 "lattice_native"
+    const std::string& libraryTag() const { return libraryTag_; }
+
+    /**
+     * @brief 一条记录的编码器，析构时提交
+     *
+     * 用法：
+     *   if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_MOVE)) {
+     *       record.i32(worldId).i32(id).f32(x).f32(y).f32(z);
+     *   }
+     */
+    class Record {
+    public:
+        Record(const Record&) = delete;
+        Record& operator=(const Record&) = delete;
+        ~Record();
+
+        explicit operator bool() const { return active_; }
+
+        Record& i32(int32_t value) { return i64(value); }
+        Record& i64(int64_t value);
+        Record& u64(uint64_t value);
+        Record& f32(float value);
+        Record& bytes(const uint8_t* data, size_t size);
+
+    private:
+        friend class WorkloadRecorder;
+        explicit Record(TraceEvent event);
+
+        TraceEvent event_;
+        bool active_;
+    };
+
+    static Record begin(TraceEvent event) { return Record(event); }
+    // 没有字段的事件（光照传播、红石tick）
+    static void mark(TraceEvent event) { Record record(event); }
+
+private:
+    WorkloadRecorder();
+    ~WorkloadRecorder();
+
+    void commit(TraceEvent event, const std::vector<uint8_t>& payload);
+    void startFromEnvironment();
+
+    static std::atomic<bool> recording_;
+
+    std::mutex mutex_;                  // 保护buffer_、lastTimestamp_与文件的切换
+    std::mutex fileMutex_;              // 写文件；在持有mutex_时获取，保证按提交顺序写出
+    std::FILE* file_ = nullptr;
+    std::vector<uint8_t> buffer_;
+    uint64_t lastTimestamp_ = 0;
+    uint64_t pending_ = 0;              // 已提交、未写出的字节
+    std::atomic<uint64_t> bytesWritten_{0};
+    Options options_;
+    std::string libraryTag_;
+};
+
+// ====== 读取 ======
+
+/**
+ * @brief 按记录时的字段顺序解码负载；越界后ok()为false，之后读到的都是0
+ */
+class TraceFieldReader {
+public:
+    explicit TraceFieldReader(std::span<const uint8_t> payload) : data_(payload) {}
+
+    int32_t i32() { return static_cast<int32_t>(i64()); }
+    int64_t i64();
+    uint64_t u64();
+    float f32();
+    std::span<const uint8_t> bytes();
+
+    bool ok() const { return ok_; }
+
+private:
+    std::span<const uint8_t> data_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+struct TraceRecordView {
+    TraceEvent event;
+    uint64_t timestamp;                 // steady_clock纳秒（与头部起始时间同一时钟）
+    uint32_t thread;                    // 库内线程序号，从1开始
+    std::span<const uint8_t> payload;   // 在下一次next()之前有效
+};
+
+/**
+ * @brief 顺序读取一个记录文件
+ *
+ * 文件末尾不完整的记录（进程在写出时退出）按文件结束处理，truncated()为true。
+ */
+class WorkloadTraceReader {
+public:
+    explicit WorkloadTraceReader(const std::string& path);
+
+    // 头部无效或无法打开时为false，原因见error()
+    bool isOpen() const { return error_.empty(); }
+    const std::string& error() const { return error_; }
+    const std::string& libraryTag() const { return libraryTag_; }
+    uint64_t startTime() const { return startTime_; }
+    uint32_t pid() const { return pid_; }
+    bool truncated() const { return truncated_; }
+
+    bool next(TraceRecordView& record);
+
+private:
+    bool readVarint(uint64_t& value);
+
+    std::ifstream in_;
+    std::string error_;
+    std::string libraryTag_;
+    uint64_t startTime_ = 0;
+    uint64_t timestamp_ = 0;
+    uint32_t pid_ = 0;
+    bool truncated_ = false;
+    std::vector<uint8_t> payload_;
+};
+
+} // namespace core
+} // namespace lattice
@@ -1,49 +1,453 @@
 #include "advanced_light_engine.hpp"
+#include "block_state_store.hpp"
+#include "../net/async_compressor.hpp"
+#include "../simd_dispatch.hpp"
+#include "../tick_budget.hpp"
+#include "../tracing.hpp"
 #include <algorithm>
 #include <mutex>
 #include <thread>
 #include <iostream>
+#include <cstring>
 
 namespace lattice {
 namespace world {
 
-// 静态成员初始化
-std::array<uint8_t, 256> LightOpacityTable::opacityTable{};
+// 静态成员初始化：未上传时只有一个哨兵条目，所有id都查到不透明
+namespace {
+const BlockLightProperties OPAQUE_SENTINEL{};
+}
+
+std::vector<BlockLightProperties> LightOpacityTable::table;
+const BlockLightProperties* LightOpacityTable::entries = &OPAQUE_SENTINEL;
+uint32_t LightOpacityTable::limit = 0;
 bool LightOpacityTable::initialized = false;
 
 // 透光表实现
 void LightOpacityTable::setOpacityTable(const uint8_t* table, size_t size) {
-    size = std::min(size, static_cast<size_t>(256));
+    std::vector<BlockLightProperties> states(size);
     for (size_t i = 0; i < size; ++i) {
-        opacityTable[i] = table[i];
+        states[i].opacity = table[i] & 0x0F;
     }
-    initialized = true;
+    install(std::move(states));
     std::cout << "LightOpacityTable initialized with " << size << " entries" << std::endl;
 }
 
+void LightOpacityTable::setBlockStateTable(const uint8_t* packed, size_t count) {
+    std::vector<BlockLightProperties> states(count);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* entry = packed + i * sizeof(BlockLightProperties);
+        states[i].opacity = entry[0] & 0x0F;
+        states[i].emission = entry[1] & 0x0F;
+        states[i].occludedFaces = entry[2] & 0x3F;
+        states[i].reserved = entry[3];
+    }
+    install(std::move(states));
+    std::cout << "LightOpacityTable initialized with " << count << " block states" << std::endl;
+}
+
+void LightOpacityTable::install(std::vector<BlockLightProperties> states) {
+    // id为uint32_t下标，最后一个值留给哨兵
+    if (states.size() >= UINT32_MAX) {
+        states.resize(UINT32_MAX - 1);
+    }
+    const uint32_t count = static_cast<uint32_t>(states.size());
+    states.push_back(OPAQUE_SENTINEL);
+    table = std::move(states);
+    entries = table.data();
+    limit = count;
+    initialized = true;
+}
+
 // 分块光照存储实现
-CompactLightStorage& ChunkedLightStorage::getSkyLight(int chunkX, int chunkZ) {
-    return skyLightMap[ChunkKey(chunkX, chunkZ)];
+CompactLightStorage& ChunkedLightStorage::getSkyLight(int chunkX, int sectionY, int chunkZ) {
+    return skyLightMap[ChunkKey(chunkX, sectionY, chunkZ)];
 }
 
-CompactLightStorage& ChunkedLightStorage::getBlockLight(int chunkX, int chunkZ) {
-    return blockLightMap[ChunkKey(chunkX, chunkZ)];
+CompactLightStorage& ChunkedLightStorage::getBlockLight(int chunkX, int sectionY, int chunkZ) {
+    return blockLightMap[ChunkKey(chunkX, sectionY, chunkZ)];
 }
 
-const CompactLightStorage* ChunkedLightStorage::getSkyLight(int chunkX, int chunkZ) const {
-    auto it = skyLightMap.find(ChunkKey(chunkX, chunkZ));
+const CompactLightStorage* ChunkedLightStorage::getSkyLight(int chunkX, int sectionY, int chunkZ) const {
+    auto it = skyLightMap.find(ChunkKey(chunkX, sectionY, chunkZ));
     return (it != skyLightMap.end()) ? &it->second : nullptr;
 }
 
-const CompactLightStorage* ChunkedLightStorage::getBlockLight(int chunkX, int chunkZ) const {
-    auto it = blockLightMap.find(ChunkKey(chunkX, chunkZ));
+const CompactLightStorage* ChunkedLightStorage::getBlockLight(int chunkX, int sectionY, int chunkZ) const {
+    auto it = blockLightMap.find(ChunkKey(chunkX, sectionY, chunkZ));
+    return (it != blockLightMap.end()) ? &it->second : nullptr;
+}
+
+CompactLightStorage* ChunkedLightStorage::findSkyLight(int chunkX, int sectionY, int chunkZ) {
+    auto it = skyLightMap.find(ChunkKey(chunkX, sectionY, chunkZ));
+    return (it != skyLightMap.end()) ? &it->second : nullptr;
+}
+
+CompactLightStorage* ChunkedLightStorage::findBlockLight(int chunkX, int sectionY, int chunkZ) {
+    auto it = blockLightMap.find(ChunkKey(chunkX, sectionY, chunkZ));
     return (it != blockLightMap.end()) ? &it->second : nullptr;
 }
 
 void ChunkedLightStorage::clearChunk(int chunkX, int chunkZ) {
-    ChunkKey key(chunkX, chunkZ);
-    skyLightMap.erase(key);
-    blockLightMap.erase(key);
+    auto inChunk = [chunkX, chunkZ](const auto& entry) {
+        return entry.first.x == chunkX && entry.first.z == chunkZ;
+    };
+    std::erase_if(skyLightMap, inChunk);
+    std::erase_if(blockLightMap, inChunk);
+}
+
+size_t ChunkedLightStorage::compact() {
+    size_t released = 0;
+    for (auto* map : {&skyLightMap, &blockLightMap}) {
+        for (auto& [key, section] : *map) {
+            released += section.compact();
+        }
+    }
+    return released;
+}
+
+size_t ChunkedLightStorage::getMemoryUsage() const {
+    size_t bytes = 0;
+    for (const auto* map : {&skyLightMap, &blockLightMap}) {
+        for (const auto& [key, section] : *map) {
+            bytes += section.memoryUsage();
+        }
+    }
+    return bytes;
+}
+
+void ChunkedLightStorage::exportChunk(int chunkX, int chunkZ, std::vector<io::ChunkLightSection>& out) const {
+    auto exportArray = [](const CompactLightStorage* section, std::vector<uint8_t>& target) {
+        if (section == nullptr || (section->isUniform() && section->uniformValue() == 0)) {
+            return false;
+        }
+        target.resize(CompactLightStorage::DATA_SIZE);
+        section->copyTo(target.data());
+        return true;
+    };
+    
+    for (int sectionY = -128; sectionY <= 127; ++sectionY) {
+        const CompactLightStorage* sky = getSkyLight(chunkX, sectionY, chunkZ);
+        const CompactLightStorage* block = getBlockLight(chunkX, sectionY, chunkZ);
+        if (sky == nullptr && block == nullptr) {
+            continue;
+        }
+        io::ChunkLightSection section;
+        section.sectionY = sectionY;
+        const bool hasSky = exportArray(sky, section.skyLight);
+        const bool hasBlock = exportArray(block, section.blockLight);
+        if (hasSky || hasBlock) {
+            out.push_back(std::move(section));
+        }
+    }
+}
+
+size_t ChunkedLightStorage::importChunk(int chunkX, int chunkZ,
+                                        const std::vector<io::ChunkLightSection>& sections) {
+    clearChunk(chunkX, chunkZ);
+    
+    size_t loaded = 0;
+    CompactLightStorage::NibbleArray nibbles;
+    auto importArray = [&](const std::vector<uint8_t>& source, CompactLightStorage& target) {
+        std::copy(source.begin(), source.end(), nibbles.begin());
+        target.assign(nibbles);
+        target.compact();
+        ++loaded;
+    };
+    
+    for (const auto& section : sections) {
+        if (section.skyLight.size() == CompactLightStorage::DATA_SIZE) {
+            importArray(section.skyLight, getSkyLight(chunkX, section.sectionY, chunkZ));
+        }
+        if (section.blockLight.size() == CompactLightStorage::DATA_SIZE) {
+            importArray(section.blockLight, getBlockLight(chunkX, section.sectionY, chunkZ));
+        }
+    }
+    return loaded;
+}
+
+// ===== 光照更新包 =====
+
+namespace {
+
+size_t varIntSize(uint32_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+uint8_t* writeVarInt(uint8_t* out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+// BitSet.toLongArray()：去掉末尾的全0 long
+size_t usedWords(const std::vector<uint64_t>& words) {
+    size_t count = words.size();
+    while (count > 0 && words[count - 1] == 0) {
+        --count;
+    }
+    return count;
+}
+
+uint8_t* writeBitSet(uint8_t* out, const std::vector<uint64_t>& words) {
+    const size_t count = usedWords(words);
+    out = writeVarInt(out, static_cast<uint32_t>(count));
+    for (size_t i = 0; i < count; ++i) {
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            *out++ = static_cast<uint8_t>(words[i] >> shift);
+        }
+    }
+    return out;
+}
+
+} // namespace
+
+size_t ChunkedLightStorage::lightPacketCapacity(int sectionCount) {
+    const size_t sections = static_cast<size_t>(std::max(sectionCount, 0));
+    const size_t words = (sections + 63) / 64;
+    const size_t arrayBytes = varIntSize(CompactLightStorage::DATA_SIZE) + CompactLightStorage::DATA_SIZE;
+    return 4 * (varIntSize(static_cast<uint32_t>(words)) + words * 8) +
+           2 * (varIntSize(static_cast<uint32_t>(sections)) + sections * arrayBytes);
+}
+
+size_t ChunkedLightStorage::writeLightPacket(int chunkX, int chunkZ, int minSection, int sectionCount,
+                                             uint8_t* out, size_t capacity) const {
+    if (sectionCount <= 0) {
+        return 0;
+    }
+    
+    const size_t words = (static_cast<size_t>(sectionCount) + 63) / 64;
+    std::vector<uint64_t> skyMask(words), blockMask(words), emptySkyMask(words), emptyBlockMask(words);
+    std::vector<const CompactLightStorage*> skySections, blockSections;
+    
+    auto classify = [&](const CompactLightStorage* section, int index, std::vector<uint64_t>& mask,
+                        std::vector<uint64_t>& emptyMask, std::vector<const CompactLightStorage*>& sections) {
+        if (section == nullptr) {
+            return;
+        }
+        const uint64_t bit = 1ull << (index & 63);
+        if (section->isUniform() && section->uniformValue() == 0) {
+            emptyMask[index >> 6] |= bit;
+        } else {
+            mask[index >> 6] |= bit;
+            sections.push_back(section);
+        }
+    };
+    for (int i = 0; i < sectionCount; ++i) {
+        classify(getSkyLight(chunkX, minSection + i, chunkZ), i, skyMask, emptySkyMask, skySections);
+        classify(getBlockLight(chunkX, minSection + i, chunkZ), i, blockMask, emptyBlockMask, blockSections);
+    }
+    
+    const size_t arrayBytes = varIntSize(CompactLightStorage::DATA_SIZE) + CompactLightStorage::DATA_SIZE;
+    size_t required = 0;
+    for (const auto* mask : {&skyMask, &blockMask, &emptySkyMask, &emptyBlockMask}) {
+        const size_t count = usedWords(*mask);
+        required += varIntSize(static_cast<uint32_t>(count)) + count * 8;
+    }
+    for (const auto* sections : {&skySections, &blockSections}) {
+        required += varIntSize(static_cast<uint32_t>(sections->size())) + sections->size() * arrayBytes;
+    }
+    if (out == nullptr || required > capacity) {
+        return 0;
+    }
+    
+    uint8_t* cursor = out;
+    cursor = writeBitSet(cursor, skyMask);
+    cursor = writeBitSet(cursor, blockMask);
+    cursor = writeBitSet(cursor, emptySkyMask);
+    cursor = writeBitSet(cursor, emptyBlockMask);
+    for (const auto* sections : {&skySections, &blockSections}) {
+        cursor = writeVarInt(cursor, static_cast<uint32_t>(sections->size()));
+        for (const CompactLightStorage* section : *sections) {
+            cursor = writeVarInt(cursor, CompactLightStorage::DATA_SIZE);
+            section->copyTo(cursor);
+            cursor += CompactLightStorage::DATA_SIZE;
+        }
+    }
+    return static_cast<size_t>(cursor - out);
+}
+
+// ===== 天空光逐层计算内核 =====
+// 一层16x16 = 256格，下标(z << 4) | x，与段内一层的nibble顺序一致（偶数格为低4位）
+
+namespace {
+
+constexpr size_t LAYER_CELLS = 256;
+constexpr size_t LAYER_BYTES = LAYER_CELLS / 2;
+constexpr size_t LAYER_PAD = 32;                 // 邻居查找的前后填充（填充格视为亮且不透光）
+
+struct alignas(32) PaddedLayer {
+    uint8_t bytes[LAYER_PAD + LAYER_CELLS + LAYER_PAD];
+    
+    explicit PaddedLayer(uint8_t padValue) { std::memset(bytes, padValue, sizeof(bytes)); }
+    uint8_t* cells() { return bytes + LAYER_PAD; }
+    const uint8_t* cells() const { return bytes + LAYER_PAD; }
+};
+
+// 以下内核按CPU在运行时选择实现（AVX2 / SSE4 / NEON / 标量），见core/simd_dispatch.cpp
+
+// levels = max(0, levels - opacity)
+inline void attenuateLayer(uint8_t* levels, const uint8_t* opacity) {
+    core::simdKernels().attenuateLayer(levels, opacity);
+}
+
+// 256个级别压缩成128字节nibble
+inline void packLayer(const uint8_t* levels, uint8_t* out) {
+    core::simdKernels().packLayerNibbles(levels, out);
+}
+
+// 整层是否为同一个值
+inline bool layerUniform(const uint8_t* levels) {
+    return core::simdKernels().layerUniform(levels);
+}
+
+/**
+ * 找出光会横向扩散的格子：某个水平邻居穿过后得到的级别 max(0, L - max(1, 邻居透光值)) 高于邻居当前级别
+ * 结果按位写入spread（第i位对应第i格）；填充格亮且不透光，不会被判定为可接收
+ */
+inline void findSpreadCells(const PaddedLayer& levels, const PaddedLayer& opacity, uint64_t spread[4]) {
+    core::simdKernels().findSpreadCells(levels.cells(), opacity.cells(), spread);
+}
+
+} // namespace
+
+size_t AdvancedLightEngine::initializeChunkSkylight(int32_t chunkX, int32_t chunkZ, const uint8_t* materialIds,
+                                                    int32_t minY, int32_t height) {
+    return initializeSkylightColumns(chunkX, chunkZ, materialIds, minY, height);
+}
+
+size_t AdvancedLightEngine::initializeChunkSkylight(int32_t chunkX, int32_t chunkZ, const uint16_t* blockStates,
+                                                    int32_t minY, int32_t height) {
+    return initializeSkylightColumns(chunkX, chunkZ, blockStates, minY, height);
+}
+
+size_t AdvancedLightEngine::initializeChunkSkylight(int32_t chunkX, int32_t chunkZ, const BlockStateSnapshot& blocks,
+                                                    int32_t minY, int32_t height) {
+    if (height <= 0) {
+        return 0;
+    }
+    std::vector<uint16_t> column(static_cast<size_t>(height) << 8);
+    if (!blocks.copyColumn(chunkX, chunkZ, minY, height, column.data())) {
+        return 0;
+    }
+    return initializeSkylightColumns(chunkX, chunkZ, column.data(), minY, height);
+}
+
+template <typename StateId>
+size_t AdvancedLightEngine::initializeSkylightColumns(int32_t chunkX, int32_t chunkZ, const StateId* states,
+                                                      int32_t minY, int32_t height) {
+    if (!states || height <= 0) {
+        return 0;
+    }
+    LATTICE_TRACE_SPAN("light", "AdvancedLightEngine::initializeChunkSkylight");
+    
+    // 顶层之上为15；填充格为15且不透光
+    PaddedLayer levels(15);
+    PaddedLayer opacity(15);
+    // 上一层各格的面遮挡位（顶层之上为空气）
+    std::array<uint8_t, LAYER_CELLS> aboveFaces{};
+    std::vector<DirtyEntry> spreading;
+    CompactLightStorage::NibbleArray nibbles;
+    
+    const int32_t maxY = minY + height - 1;
+    const int32_t topSection = maxY >> 4;
+    const int32_t bottomSection = minY >> 4;
+    bool dark = false;                           // 所有列都已衰减到0，以下全部为0
+    
+    for (int32_t sectionY = topSection; sectionY >= bottomSection; --sectionY) {
+        CompactLightStorage& section = storage.getSkyLight(chunkX, sectionY, chunkZ);
+        if (dark) {
+            section.fill(0);
+            continue;
+        }
+        
+        // 段内各层都均匀且同值时整段只存一个值
+        bool uniform = true;
+        int uniformValue = -1;
+        auto trackUniform = [&](bool layerIsUniform) {
+            if (!layerIsUniform) {
+                uniform = false;
+            } else if (uniformValue < 0) {
+                uniformValue = levels.cells()[0];
+            } else if (uniformValue != levels.cells()[0]) {
+                uniform = false;
+            }
+        };
+        
+        for (int32_t localY = 15; localY >= 0; --localY) {
+            const int32_t y = (sectionY << 4) + localY;
+            if (y > maxY || y < minY) {
+                // 范围之外的层保持上一层的级别
+                packLayer(levels.cells(), nibbles.data() + localY * LAYER_BYTES);
+                trackUniform(layerUniform(levels.cells()));
+                continue;
+            }
+            
+            // 光向下穿过上一格的下表面或本格的上表面被形状挡住时按完全不透光处理（无分支）
+            const StateId* layerStates = states + (static_cast<size_t>(y - minY) << 8);
+            uint8_t* layerOpacity = opacity.cells();
+            for (size_t i = 0; i < LAYER_CELLS; ++i) {
+                const BlockLightProperties& properties = LightOpacityTable::get(layerStates[i]);
+                const uint8_t blocked = static_cast<uint8_t>((aboveFaces[i] & LightOpacityTable::FACE_DOWN) |
+                                                             (properties.occludedFaces & LightOpacityTable::FACE_UP));
+                layerOpacity[i] = static_cast<uint8_t>(properties.opacity | (0x0F & -(blocked != 0)));
+                aboveFaces[i] = properties.occludedFaces;
+            }
+            attenuateLayer(levels.cells(), layerOpacity);
+            packLayer(levels.cells(), nibbles.data() + localY * LAYER_BYTES);
+            
+            const bool layerIsUniform = layerUniform(levels.cells());
+            trackUniform(layerIsUniform);
+            if (layerIsUniform) {
+                // 全层同一级别：没有横向扩散；全层为0时以下都是0
+                if (levels.cells()[0] == 0) {
+                    dark = true;
+                    std::memset(nibbles.data(), 0, localY * LAYER_BYTES);
+                    break;
+                }
+                continue;
+            }
+            
+            uint64_t spread[4] = {0, 0, 0, 0};
+            findSpreadCells(levels, opacity, spread);
+            const uint8_t* cells = levels.cells();
+            for (size_t i = 0; i < LAYER_CELLS; ++i) {
+                const size_t x = i & 15;
+                const size_t z = i >> 4;
+                const bool edge = x == 0 || x == 15 || z == 0 || z == 15;
+                // 区块边缘的亮格可能照进相邻区块中被遮挡的部分
+                if (!(spread[i / 64] >> (i % 64) & 1) && !(edge && cells[i] > 1)) {
+                    continue;
+                }
+                const int32_t worldX = (chunkX << 4) + static_cast<int32_t>(x);
+                const int32_t worldZ = (chunkZ << 4) + static_cast<int32_t>(z);
+                spreading.emplace_back(worldX, y, worldZ, chunkX, chunkZ, cells[i], true,
+                                       std::abs(worldX) + std::abs(worldZ));
+            }
+        }
+        
+        if (uniform) {
+            section.fill(static_cast<uint8_t>(uniformValue));
+        } else {
+            section.assign(nibbles);
+        }
+    }
+    
+    const size_t queued = spreading.size();
+    if (!spreading.empty()) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        dirtyQueue.insert(dirtyQueue.end(), std::make_move_iterator(spreading.begin()),
+                          std::make_move_iterator(spreading.end()));
+    }
+    return queued;
 }
 
 // 高级光照引擎实现
@@ -58,27 +462,163 @@ void AdvancedLightEngine::onBlockChange(int32_t x, int32_t y, int32_t z, int mat
     }
     
     // 获取方块的透光值 (O(1)快速查询)
-    uint8_t opacity = LightOpacityTable::getOpacity(materialId);
+    recordBlockChange(x, y, z, false, 0, packLight(LightOpacityTable::get(materialId)));
+}
+
+void AdvancedLightEngine::onBlockChange(int32_t x, int32_t y, int32_t z, int oldMaterialId, int newMaterialId) {
+    if (!LightOpacityTable::isInitialized()) {
+        std::cerr << "Warning: LightOpacityTable not initialized" << std::endl;
+        return;
+    }
     
-    // 计算区块坐标
+    recordBlockChange(x, y, z, true, packLight(LightOpacityTable::get(oldMaterialId)),
+                      packLight(LightOpacityTable::get(newMaterialId)));
+}
+
+void AdvancedLightEngine::onBlockChange(BlockStateStore& blocks, int32_t x, int32_t y, int32_t z, int newStateId) {
+    const uint32_t previous = blocks.setBlock(x, y, z, static_cast<uint16_t>(newStateId));
+    if (previous == BlockStateStore::NOT_LOADED) {
+        onBlockChange(x, y, z, newStateId);
+    } else {
+        onBlockChange(x, y, z, static_cast<int>(previous), newStateId);
+    }
+}
+
+void AdvancedLightEngine::recordBlockChange(int32_t x, int32_t y, int32_t z, bool oldKnown, uint8_t oldLight,
+                                            uint8_t newLight) {
     int32_t chunkX, chunkZ;
     getChunkCoords(x, z, chunkX, chunkZ);
+    int32_t sectionY, localY;
+    getSectionCoords(y, sectionY, localY);
+    int32_t localX, localZ;
+    getLocalCoords(x, z, localX, localZ);
+    const size_t index = static_cast<size_t>(localY << 8 | localZ << 4 | localX);
     
-    // 估算优先级 (距离玩家越近优先级越高，这里简化处理)
-    int32_t priority = std::abs(x) + std::abs(z); // 简单的距离计算
+    batchStats.blockChanges.fetch_add(1, std::memory_order_relaxed);
     
-    // 添加到延迟更新队列
     std::lock_guard<std::mutex> lock(queueMutex);
+    auto [it, inserted] = pendingIndex.try_emplace(packSectionKey(chunkX, sectionY, chunkZ),
+                                                   pendingSections.size());
+    if (inserted) {
+        auto section = std::make_unique<PendingSection>();
+        section->chunkX = chunkX;
+        section->sectionY = sectionY;
+        section->chunkZ = chunkZ;
+        pendingSections.push_back(std::move(section));
+    }
+    PendingSection& section = *pendingSections[it->second];
+    
+    uint64_t& word = section.changed[index >> 6];
+    const uint64_t bit = 1ull << (index & 63);
+    if (word & bit) {
+        // 同一格再次变化：保留第一次变化前的状态，只更新最终值
+        batchStats.coalescedChanges.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        word |= bit;
+        if (oldKnown) {
+            section.originalKnown[index >> 6] |= bit;
+            section.original[index] = oldLight;
+        }
+    }
+    section.light[index] = newLight;
+}
+
+void AdvancedLightEngine::flushPendingChangesLocked() {
+    if (pendingSections.empty()) {
+        return;
+    }
     
-    // 天空光更新
-    if (opacity < 15) { // 不是完全不透光
-        dirtyQueue.emplace_back(x, y, z, chunkX, chunkZ, 15 - opacity, true, priority);
+    uint64_t cancelled = 0;
+    for (const auto& section : pendingSections) {
+        const int32_t baseX = section->chunkX << 4;
+        const int32_t baseY = section->sectionY << 4;
+        const int32_t baseZ = section->chunkZ << 4;
+        for (size_t w = 0; w < section->changed.size(); ++w) {
+            for (uint64_t bits = section->changed[w]; bits != 0; bits &= bits - 1) {
+                const size_t index = w << 6 | static_cast<size_t>(std::countr_zero(bits));
+                const uint8_t light = section->light[index];
+                if ((section->originalKnown[w] >> (index & 63) & 1) && section->original[index] == light) {
+                    ++cancelled;
+                    continue;
+                }
+                const uint8_t opacity = light & 0x0F;
+                const uint8_t emission = light >> 4;
+                
+                const int32_t x = baseX + static_cast<int32_t>(index & 15);
+                const int32_t y = baseY + static_cast<int32_t>(index >> 8);
+                const int32_t z = baseZ + static_cast<int32_t>(index >> 4 & 15);
+                
+                // 估算优先级 (距离玩家越近优先级越高，这里简化处理)
+                const int32_t priority = std::abs(x) + std::abs(z); // 简单的距离计算
+                
+                // 天空光更新
+                if (opacity < 15) { // 不是完全不透光
+                    dirtyQueue.emplace_back(x, y, z, section->chunkX, section->chunkZ, 15 - opacity, true,
+                                            priority);
+                }
+                
+                // 方块光更新 (如果这个方块本身发光)
+                if (emission > 0) {
+                    dirtyQueue.emplace_back(x, y, z, section->chunkX, section->chunkZ, emission, false, priority);
+                }
+            }
+        }
     }
     
-    // 方块光更新 (如果这个方块本身发光)
-    if (opacity == 0) { // 完全透明方块，可能发光
-        dirtyQueue.emplace_back(x, y, z, chunkX, chunkZ, 15, false, priority);
+    batchStats.cancelledChanges.fetch_add(cancelled, std::memory_order_relaxed);
+    batchStats.sectionsFlushed.fetch_add(pendingSections.size(), std::memory_order_relaxed);
+    pendingSections.clear();
+    pendingIndex.clear();
+}
+
+void AdvancedLightEngine::mergeDuplicateEntries(std::vector<DirtyEntry>& entries) {
+    if (entries.size() < 2) {
+        return;
+    }
+    
+    // 键：x、z各26位，y 11位，通道1位
+    auto keyOf = [](const DirtyEntry& entry) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(entry.x)) & 0x3FFFFFF) << 38 |
+               (static_cast<uint64_t>(static_cast<uint32_t>(entry.z)) & 0x3FFFFFF) << 12 |
+               (static_cast<uint64_t>(static_cast<uint32_t>(entry.y)) & 0x7FF) << 1 |
+               (entry.isSky ? 1u : 0u);
+    };
+    std::unordered_map<uint64_t, size_t> firstIndex;
+    firstIndex.reserve(entries.size());
+    size_t out = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto [it, inserted] = firstIndex.try_emplace(keyOf(entries[i]), out);
+        if (inserted) {
+            entries[out++] = entries[i];
+        } else {
+            DirtyEntry& kept = entries[it->second];
+            kept.newLevel = std::max(kept.newLevel, entries[i].newLevel);
+        }
+    }
+    batchStats.duplicateEntries.fetch_add(entries.size() - out, std::memory_order_relaxed);
+    entries.erase(entries.begin() + static_cast<std::ptrdiff_t>(out), entries.end());
+}
+
+bool AdvancedLightEngine::loadChunkLight(int32_t chunkX, int32_t chunkZ,
+                                         const std::vector<io::ChunkLightSection>& sections, bool trusted) {
+    if (!trusted) {
+        return false;
     }
+    storage.importChunk(chunkX, chunkZ, sections);
+    return true;
+}
+
+bool AdvancedLightEngine::saveChunkLight(int32_t chunkX, int32_t chunkZ, std::vector<io::ChunkLightSection>& out) {
+    storage.exportChunk(chunkX, chunkZ, out);
+    
+    std::lock_guard<std::mutex> lock(queueMutex);
+    const bool queued = std::any_of(dirtyQueue.begin(), dirtyQueue.end(), [=](const DirtyEntry& entry) {
+        return entry.chunkX == chunkX && entry.chunkZ == chunkZ;
+    });
+    const bool pending = std::any_of(pendingSections.begin(), pendingSections.end(), [=](const auto& section) {
+        return section->chunkX == chunkX && section->chunkZ == chunkZ;
+    });
+    return !queued && !pending;
 }
 
 uint8_t AdvancedLightEngine::getLightLevel(int32_t x, int32_t y, int32_t z, bool isSky) const {
@@ -88,30 +628,56 @@ uint8_t AdvancedLightEngine::getLightLevel(int32_t x, int32_t y, int32_t z, bool
     int32_t localX, localZ;
     getLocalCoords(x, z, localX, localZ);
     
+    int32_t sectionY, localY;
+    getSectionCoords(y, sectionY, localY);
+    
     // 从对应的映射中查找光照存储
     const CompactLightStorage* lightStorage = nullptr;
     if (isSky) {
-        lightStorage = storage.getSkyLight(chunkX, chunkZ);
+        lightStorage = storage.getSkyLight(chunkX, sectionY, chunkZ);
     } else {
-        lightStorage = storage.getBlockLight(chunkX, chunkZ);
+        lightStorage = storage.getBlockLight(chunkX, sectionY, chunkZ);
     }
     
     if (lightStorage != nullptr) {
-        return lightStorage->get(localX, y, localZ);
+        return lightStorage->get(localX, localY, localZ);
     }
     
     // 如果没有找到对应的区块，默认返回0
     return 0;
 }
 
+bool AdvancedLightEngine::hasUpdates() {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return !dirtyQueue.empty() || !pendingSections.empty();
+}
+
+AdvancedLightEngine::AdvancedLightEngine() {
+    // 光照数组不能丢弃，只能把重新变为均匀的段收回；请求延后到tick线程执行，返回0
+    shedderId = core::MemoryBudget::instance().addShedder(core::MemorySubsystem::LIGHT_STORAGE, [this](size_t) {
+        compactRequested.store(true, std::memory_order_relaxed);
+        return size_t{0};
+    });
+}
+
+AdvancedLightEngine::~AdvancedLightEngine() {
+    core::MemoryBudget::instance().removeShedder(shedderId);
+}
+
 void AdvancedLightEngine::tick() {
     // 避免重复处理
     if (processing.exchange(true)) {
         return;
     }
+    LATTICE_TRACE_SPAN("light", "AdvancedLightEngine::tick");
     
     try {
         processBatchUpdates();
+        const bool compactNow = compactRequested.exchange(false, std::memory_order_relaxed);
+        if (++ticksSinceCompact >= COMPACT_INTERVAL || compactNow) {
+            ticksSinceCompact = 0;
+            storage.compact();
+        }
     } catch (const std::exception& e) {
         std::cerr << "Light engine tick error: " << e.what() << std::endl;
     }
@@ -120,33 +686,137 @@ void AdvancedLightEngine::tick() {
 }
 
 void AdvancedLightEngine::processBatchUpdates() {
-    const int BATCH_SIZE = 100; // 按文档建议的批处理大小
+    const bool parallel = parallelEnabled.load(std::memory_order_relaxed);
+    // 主线程落后时缩小批次，有余量时加大（光照不暂停，最少处理1个）
+    const size_t limit = core::TickBudget::instance().scale(
+        core::DeferrableWork::LIGHT_BATCH, parallel ? PARALLEL_BATCH_SIZE : BATCH_SIZE);
     std::vector<DirtyEntry> batch;
     
-    // 提取一批更新
+    // 提取一批更新：优先级高的先处理
     {
         std::lock_guard<std::mutex> lock(queueMutex);
-        batch.reserve(BATCH_SIZE);
-        
-        while (!dirtyQueue.empty() && batch.size() < BATCH_SIZE) {
-            // 按优先级排序处理
-            auto it = std::min_element(dirtyQueue.begin(), dirtyQueue.end(),
-                [](const DirtyEntry& a, const DirtyEntry& b) {
-                    return a.priority > b.priority; // 优先级高的先处理
-                });
-            
-            batch.push_back(*it);
-            dirtyQueue.erase(it);
+        flushPendingChangesLocked();
+        auto byPriority = [](const DirtyEntry& a, const DirtyEntry& b) {
+            return a.priority > b.priority;
+        };
+        if (dirtyQueue.size() > limit) {
+            std::nth_element(dirtyQueue.begin(), dirtyQueue.begin() + limit, dirtyQueue.end(), byPriority);
+            batch.assign(std::make_move_iterator(dirtyQueue.begin()),
+                         std::make_move_iterator(dirtyQueue.begin() + limit));
+            dirtyQueue.erase(dirtyQueue.begin(), dirtyQueue.begin() + limit);
+        } else {
+            batch.swap(dirtyQueue);
+        }
+        std::stable_sort(batch.begin(), batch.end(), byPriority);
+        LATTICE_TRACE_COUNTER("light", "AdvancedLightEngine queued updates", dirtyQueue.size() + batch.size());
+    }
+    if (batch.empty()) {
+        return;
+    }
+    
+    std::vector<DirtyEntry> deferred;
+    if (parallel) {
+        processParallel(batch, deferred);
+    } else {
+        processSerial(batch, deferred);
+    }
+    batchStats.entriesProcessed.fetch_add(batch.size(), std::memory_order_relaxed);
+    
+    // 继续传播的条目留给下一批
+    mergeDuplicateEntries(deferred);
+    if (!deferred.empty()) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        dirtyQueue.insert(dirtyQueue.end(), std::make_move_iterator(deferred.begin()),
+                          std::make_move_iterator(deferred.end()));
+    }
+}
+
+void AdvancedLightEngine::processSerial(const std::vector<DirtyEntry>& batch, std::vector<DirtyEntry>& deferred) {
+    LATTICE_TRACE_SPAN("light", "AdvancedLightEngine::processSerial");
+    for (const auto& entry : batch) {
+        propagateLightIncremental(entry.x, entry.y, entry.z, entry.newLevel, entry.isSky, true, deferred);
+    }
+    batchStats.serialBatches.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AdvancedLightEngine::processParallel(std::vector<DirtyEntry>& batch, std::vector<DirtyEntry>& deferred) {
+    LATTICE_TRACE_SPAN("light", "AdvancedLightEngine::processParallel");
+    // 按区块分组，组内保持优先级顺序
+    struct ChunkGroup {
+        int32_t chunkX, chunkZ;
+        std::vector<const DirtyEntry*> entries;
+        std::vector<DirtyEntry> deferred;
+    };
+    std::vector<ChunkGroup> groups;
+    std::unordered_map<uint64_t, size_t> groupIndex;
+    for (const auto& entry : batch) {
+        const uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(entry.chunkX)) << 32 |
+                             static_cast<uint32_t>(entry.chunkZ);
+        auto [it, inserted] = groupIndex.try_emplace(key, groups.size());
+        if (inserted) {
+            groups.push_back(ChunkGroup{entry.chunkX, entry.chunkZ, {}, {}});
         }
+        groups[it->second].entries.push_back(&entry);
+    }
+    if (groups.size() < PARALLEL_MIN_CHUNKS) {
+        processSerial(batch, deferred);
+        return;
     }
     
-    // 批量处理更新
+    // 串行创建并行阶段会写入的区块段（条目所在段及上下相邻段）
     for (const auto& entry : batch) {
-        propagateLightIncremental(entry.x, entry.y, entry.z, entry.newLevel, entry.isSky);
+        for (int32_t sy = (entry.y - 1) >> 4; sy <= ((entry.y + 1) >> 4); ++sy) {
+            sectionFor(entry.chunkX, sy, entry.chunkZ, entry.isSky, true);
+        }
+    }
+    
+    // 按(chunkX mod 3, chunkZ mod 3)着色：同色区块的3x3邻域互不重叠
+    std::array<std::vector<ChunkGroup*>, 9> colors;
+    for (auto& group : groups) {
+        const int32_t colorX = ((group.chunkX % 3) + 3) % 3;
+        const int32_t colorZ = ((group.chunkZ % 3) + 3) % 3;
+        colors[colorX * 3 + colorZ].push_back(&group);
+    }
+    
+    for (auto& color : colors) {
+        if (color.empty()) {
+            continue;
+        }
+        auto lightGroup = [&](size_t index) {
+            LATTICE_TRACE_SPAN("light", "AdvancedLightEngine chunk group");
+            ChunkGroup& group = *color[index];
+            for (const DirtyEntry* entry : group.entries) {
+                propagateLightIncremental(entry->x, entry->y, entry->z, entry->newLevel, entry->isSky,
+                                          false, group.deferred);
+            }
+        };
+        if (color.size() == 1) {
+            lightGroup(0);
+        } else {
+            net::AsyncCompressor::getInstance().parallelFor(color.size(), lightGroup);
+        }
     }
+    
+    for (auto& group : groups) {
+        deferred.insert(deferred.end(), std::make_move_iterator(group.deferred.begin()),
+                        std::make_move_iterator(group.deferred.end()));
+    }
+    batchStats.parallelBatches.fetch_add(1, std::memory_order_relaxed);
+    batchStats.chunkGroups.fetch_add(groups.size(), std::memory_order_relaxed);
+}
+
+CompactLightStorage* AdvancedLightEngine::sectionFor(int32_t chunkX, int32_t sectionY, int32_t chunkZ,
+                                                     bool isSky, bool create) {
+    if (create) {
+        return isSky ? &storage.getSkyLight(chunkX, sectionY, chunkZ)
+                     : &storage.getBlockLight(chunkX, sectionY, chunkZ);
+    }
+    return isSky ? storage.findSkyLight(chunkX, sectionY, chunkZ)
+                 : storage.findBlockLight(chunkX, sectionY, chunkZ);
 }
 
-void AdvancedLightEngine::propagateLightIncremental(int32_t x, int32_t y, int32_t z, uint8_t level, bool isSky) {
+void AdvancedLightEngine::propagateLightIncremental(int32_t x, int32_t y, int32_t z, uint8_t level, bool isSky,
+                                                    bool createSections, std::vector<DirtyEntry>& deferred) {
     // 按文档要求：增量传播代替全量BFS
     if (level <= 0) return; // 无效光照级别
     
@@ -156,13 +826,15 @@ void AdvancedLightEngine::propagateLightIncremental(int32_t x, int32_t y, int32_
     int32_t localX, localZ;
     getLocalCoords(x, z, localX, localZ);
     
+    int32_t sectionY, localY;
+    getSectionCoords(y, sectionY, localY);
+    
     // 获取正确的光照存储
-    CompactLightStorage& lightStorage = isSky ? 
-        storage.getSkyLight(chunkX, chunkZ) : 
-        storage.getBlockLight(chunkX, chunkZ);
+    CompactLightStorage* lightStorage = sectionFor(chunkX, sectionY, chunkZ, isSky, createSections);
+    if (!lightStorage) return;
     
     // 设置当前位置的光照
-    lightStorage.set(localX, y, localZ, level);
+    lightStorage->set(localX, localY, localZ, level);
     
     // 向6个方向传播 (上/下/东/西/南/北)
     const int32_t dirs[6][3] = {
@@ -184,9 +856,8 @@ void AdvancedLightEngine::propagateLightIncremental(int32_t x, int32_t y, int32_
         
         // 如果跨区块，添加到更新队列而不是立即处理
         if (neighborChunkX != chunkX || neighborChunkZ != chunkZ) {
-            std::lock_guard<std::mutex> lock(queueMutex);
             int32_t priority = std::abs(nx) + std::abs(nz);
-            dirtyQueue.emplace_back(nx, ny, nz, neighborChunkX, neighborChunkZ, 
+            deferred.emplace_back(nx, ny, nz, neighborChunkX, neighborChunkZ, 
                                   level > 1 ? level - 1 : 0, isSky, priority);
             continue;
         }
@@ -205,17 +876,18 @@ void AdvancedLightEngine::propagateLightIncremental(int32_t x, int32_t y, int32_
         if (newNeighborLevel > 0) {
             // 简化实现：直接设置光照值而不检查当前值
             // 实际应该检查并只更新更高的光照级别
-            CompactLightStorage& neighborStorage = isSky ? 
-                storage.getSkyLight(neighborChunkX, neighborChunkZ) : 
-                storage.getBlockLight(neighborChunkX, neighborChunkZ);
+            int32_t neighborSectionY, neighborLocalY;
+            getSectionCoords(ny, neighborSectionY, neighborLocalY);
+            CompactLightStorage* neighborStorage =
+                sectionFor(neighborChunkX, neighborSectionY, neighborChunkZ, isSky, createSections);
+            if (!neighborStorage) continue;
             
-            neighborStorage.set(neighborLocalX, ny, neighborLocalZ, newNeighborLevel);
+            neighborStorage->set(neighborLocalX, neighborLocalY, neighborLocalZ, newNeighborLevel);
             
             // 继续传播 (如果光照级别足够高)
             if (newNeighborLevel > 1) {
-                std::lock_guard<std::mutex> lock(queueMutex);
                 int32_t priority = std::abs(nx) + std::abs(nz);
-                dirtyQueue.emplace_back(nx, ny, nz, neighborChunkX, neighborChunkZ,
+                deferred.emplace_back(nx, ny, nz, neighborChunkX, neighborChunkZ,
                                       newNeighborLevel, isSky, priority);
             }
         }
@@ -1,87 +1,234 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <array>
 #include <atomic>
+#include <bit>
+#include <mutex>
+#include "../io/io_types.hpp"
+#include "../memory_budget.hpp"
 
 namespace lattice {
 namespace world {
 
-// 4-bit位压缩光照存储 - 按文档要求实现
+class BlockStateStore;
+class BlockStateSnapshot;
+
+/**
+ * 4-bit位压缩光照存储（一个16x16x16区块段）
+ *
+ * 整段光照相同（天空段全为15、地下与空段全为0，占绝大多数）时只存一个值，不分配nibble数组；
+ * 第一次写入不同的值时才展开为2048字节的nibble数组。
+ * 展开后的数组由shared_ptr持有：复制段（区块快照、相同段的复用）只增加引用计数，
+ * 写入时发现数组被共享才复制一份（写时复制）。compact()把重新变为全段相同的数组收回。
+ * 数组通过BudgetAllocator分配，记到MemoryBudget的LIGHT_STORAGE。
+ * 非线程安全，由光照引擎串行访问。
+ */
 class CompactLightStorage {
-private:
-    std::vector<uint8_t> data; // 压缩数据：每字节存2个光照值
-    
 public:
-    CompactLightStorage() : data(2048, 0) {} // 16x16x16 = 4096方块 / 2 = 2048字节
+    static constexpr size_t DATA_SIZE = 2048;    // 16x16x16 = 4096方块 / 2 = 2048字节
+    using NibbleArray = std::array<uint8_t, DATA_SIZE>;
+    using NibbleAllocator = core::BudgetAllocator<NibbleArray, core::MemorySubsystem::LIGHT_STORAGE>;
+    
+    CompactLightStorage() = default;
+    explicit CompactLightStorage(uint8_t uniformValue) : uniform(uniformValue & 0x0F) {}
     
     // 快速获取光照值 (O(1))
     inline uint8_t get(int x, int y, int z) const {
+        if (!data) {
+            return uniform;
+        }
         int index = (y << 8) | (z << 4) | x; // 快速索引计算
-        uint8_t byte = data[index >> 1];
+        uint8_t byte = (*data)[index >> 1];
         return (index & 1) ? (byte >> 4) : (byte & 0x0F);
     }
     
-    // 快速设置光照值 (O(1)) 
+    // 快速设置光照值 (O(1))；均匀段写入相同的值不展开
     inline void set(int x, int y, int z, uint8_t value) {
+        value &= 0x0F;
+        if (!data) {
+            if (value == uniform) {
+                return;
+            }
+            promote();
+        } else if (data.use_count() > 1) {
+            data = std::allocate_shared<NibbleArray>(NibbleAllocator{}, *data);
+        }
         int index = (y << 8) | (z << 4) | x;
-        int byteIndex = index >> 1;
+        uint8_t& byte = (*data)[index >> 1];
         if (index & 1) {
-            data[byteIndex] = (data[byteIndex] & 0x0F) | ((value & 0x0F) << 4);
+            byte = (byte & 0x0F) | (value << 4);
         } else {
-            data[byteIndex] = (data[byteIndex] & 0xF0) | (value & 0x0F);
+            byte = (byte & 0xF0) | value;
         }
     }
     
+    // 整段设为同一个值（释放nibble数组）
+    void fill(uint8_t value) {
+        data.reset();
+        uniform = value & 0x0F;
+    }
+    
     // 清除所有光照
     void clear() {
-        std::fill(data.begin(), data.end(), 0);
+        fill(0);
+    }
+    
+    // 整段替换为给定的nibble数组（与get/set相同的索引与高低位顺序）
+    void assign(const NibbleArray& nibbles) {
+        data = std::allocate_shared<NibbleArray>(NibbleAllocator{}, nibbles);
+    }
+    
+    /**
+     * 数组中所有光照值都相同时退回均匀表示，返回是否释放了数组
+     * 共享中的数组同样可以退回（只释放本段的引用）
+     */
+    bool compact() {
+        if (!data) {
+            return false;
+        }
+        const uint8_t first = (*data)[0];
+        if ((first >> 4) != (first & 0x0F) ||
+            !std::all_of(data->begin(), data->end(), [first](uint8_t byte) { return byte == first; })) {
+            return false;
+        }
+        fill(first & 0x0F);
+        return true;
+    }
+    
+    // 按get/set的布局写出2048字节（与原版DataLayer的nibble顺序相同）
+    void copyTo(uint8_t* out) const {
+        if (data) {
+            std::copy(data->begin(), data->end(), out);
+        } else {
+            std::fill_n(out, DATA_SIZE, static_cast<uint8_t>(uniform | (uniform << 4)));
+        }
+    }
+    
+    bool isUniform() const { return !data; }
+    uint8_t uniformValue() const { return uniform; }
+    bool isShared() const { return data && data.use_count() > 1; }
+    
+    // 本段独占的字节数（共享数组按引用数分摊）
+    size_t memoryUsage() const {
+        return data ? DATA_SIZE / static_cast<size_t>(data.use_count()) : 0;
     }
+    
+private:
+    void promote() {
+        data = std::allocate_shared<NibbleArray>(NibbleAllocator{});
+        data->fill(static_cast<uint8_t>(uniform | (uniform << 4)));
+    }
+    
+    std::shared_ptr<NibbleArray> data;  // 为空表示整段都是uniform
+    uint8_t uniform = 0;
 };
 
-// 透光表 - 按文档要求实现
+/**
+ * 方块状态的光照属性（4字节，与Java上传的字节顺序相同）
+ * occludedFaces的第i位表示第i个面被方块形状完全覆盖（原版Direction顺序：下、上、北、南、西、东），
+ * 台阶、楼梯等透光值为0的非完整方块靠它挡住从这些面进出的光
+ */
+struct BlockLightProperties {
+    uint8_t opacity = 15;               // 0-15
+    uint8_t emission = 0;               // 0-15
+    uint8_t occludedFaces = 0;
+    uint8_t reserved = 0;
+};
+static_assert(sizeof(BlockLightProperties) == 4, "BlockLightProperties必须与上传格式一致");
+
+/**
+ * 透光表 - 按方块状态id（Block.BLOCK_STATE_REGISTRY）索引的稠密表
+ *
+ * 启动时由Java一次性上传（现代版本有数万个方块状态）。表末尾附加一个不透明的哨兵条目，
+ * 越界id（包括负数与未初始化时的所有id）钳到哨兵上：查找只有一次无符号比较（条件移动），没有分支。
+ * 旧的按材质id上传的接口仍然可用，只设置透光值。
+ * 上传后只读；重新上传需要在光照引擎空闲时进行。
+ */
 class LightOpacityTable {
-private:
-    static std::array<uint8_t, 256> opacityTable; // Material ID -> 透光值 (0-15)
-    static bool initialized;
-    
 public:
-    // 启动时从Java层设置透光表
+    static constexpr uint8_t FACE_DOWN = 1u << 0;
+    static constexpr uint8_t FACE_UP = 1u << 1;
+    static constexpr uint8_t FACE_NORTH = 1u << 2;
+    static constexpr uint8_t FACE_SOUTH = 1u << 3;
+    static constexpr uint8_t FACE_WEST = 1u << 4;
+    static constexpr uint8_t FACE_EAST = 1u << 5;
+    
+    // 启动时从Java层设置透光表（按材质id，只有透光值，不发光、无面遮挡）
     static void setOpacityTable(const uint8_t* table, size_t size);
     
+    /**
+     * 上传方块状态表：packed为count个4字节条目（透光值、发光等级、面遮挡位、保留），
+     * 透光值与发光等级只取低4位
+     */
+    static void setBlockStateTable(const uint8_t* packed, size_t count);
+    
+    // 方块状态的全部光照属性 (O(1)，无分支)
+    static inline const BlockLightProperties& get(int stateId) {
+        const uint32_t index = static_cast<uint32_t>(stateId);
+        return entries[index < limit ? index : limit];
+    }
+    
     // 快速查询透光值 (O(1))
-    static inline uint8_t getOpacity(int materialId) {
-        if (materialId >= 0 && materialId < 256 && initialized) {
-            return opacityTable[materialId];
-        }
-        return 15; // 默认不透明
+    static inline uint8_t getOpacity(int stateId) {
+        return get(stateId).opacity;
+    }
+    
+    static inline uint8_t getEmission(int stateId) {
+        return get(stateId).emission;
+    }
+    
+    /**
+     * 光从from沿direction方向（FACE_*之一）进入to时是否被形状挡住：
+     * from朝该方向的面或to朝反方向的面被完全覆盖
+     */
+    static inline bool blocksPassage(const BlockLightProperties& from, const BlockLightProperties& to,
+                                     uint8_t direction) {
+        return ((from.occludedFaces & direction) | (to.occludedFaces & oppositeFace(direction))) != 0;
+    }
+    
+    // FACE_*的反方向（下/上、北/南、西/东两两成对）
+    static constexpr uint8_t oppositeFace(uint8_t face) {
+        return static_cast<uint8_t>(((face & 0x15) << 1) | ((face & 0x2A) >> 1));
     }
     
     // 检查是否已初始化
     static inline bool isInitialized() {
         return initialized;
     }
+    
+    static size_t size() { return limit; }
+    
+private:
+    static void install(std::vector<BlockLightProperties> states);
+    
+    static std::vector<BlockLightProperties> table;     // limit个条目 + 哨兵
+    static const BlockLightProperties* entries;
+    static uint32_t limit;
+    static bool initialized;
 };
 
-// 分块光照存储 - 按文档要求实现
+// 分块光照存储 - 按区块段（16格高）存储，段内坐标0-15
 class ChunkedLightStorage {
 private:
     struct ChunkKey {
-        int32_t x, z;
+        int32_t x, y, z;               // y为区块段索引（方块y >> 4）
         
-        ChunkKey(int32_t cx, int32_t cz) : x(cx), z(cz) {}
+        ChunkKey(int32_t cx, int32_t sy, int32_t cz) : x(cx), y(sy), z(cz) {}
         
         bool operator==(const ChunkKey& other) const {
-            return x == other.x && z == other.z;
+            return x == other.x && y == other.y && z == other.z;
         }
     };
     
     struct ChunkKeyHash {
         std::size_t operator()(const ChunkKey& key) const {
-            return std::hash<int32_t>{}(key.x) ^ (std::hash<int32_t>{}(key.z) << 1);
+            return std::hash<int32_t>{}(key.x) ^ (std::hash<int32_t>{}(key.z) << 1) ^
+                   (std::hash<int32_t>{}(key.y) << 2);
         }
     };
     
@@ -89,19 +236,65 @@ private:
     std::unordered_map<ChunkKey, CompactLightStorage, ChunkKeyHash> blockLightMap;
     
 public:
-    // 获取指定区块的光照存储
-    CompactLightStorage& getSkyLight(int chunkX, int chunkZ);
-    CompactLightStorage& getBlockLight(int chunkX, int chunkZ);
+    // 获取指定区块段的光照存储（不存在时创建为全0的均匀段）
+    CompactLightStorage& getSkyLight(int chunkX, int sectionY, int chunkZ);
+    CompactLightStorage& getBlockLight(int chunkX, int sectionY, int chunkZ);
     
     // Const版本的访问方法
-    const CompactLightStorage* getSkyLight(int chunkX, int chunkZ) const;
-    const CompactLightStorage* getBlockLight(int chunkX, int chunkZ) const;
+    const CompactLightStorage* getSkyLight(int chunkX, int sectionY, int chunkZ) const;
+    const CompactLightStorage* getBlockLight(int chunkX, int sectionY, int chunkZ) const;
+    
+    // 只查找不创建（不修改映射表，多个线程可以并发查找并写入各自的段）
+    CompactLightStorage* findSkyLight(int chunkX, int sectionY, int chunkZ);
+    CompactLightStorage* findBlockLight(int chunkX, int sectionY, int chunkZ);
     
-    // 清除指定区块的光照
+    // 清除指定区块（所有段）的光照
     void clearChunk(int chunkX, int chunkZ);
+    
+    // 把重新变为均匀的段收回为单个值，返回释放的段数
+    size_t compact();
+    
+    // 光照数组占用的字节数（均匀段不计，共享数组按引用数分摊）
+    size_t getMemoryUsage() const;
+    size_t getSectionCount() const { return skyLightMap.size() + blockLightMap.size(); }
+    
+    /**
+     * 按光照更新包（ClientboundLightUpdatePacketData）的格式写出一个区块的光照：
+     * 天空光、方块光、空天空光、空方块光四个段掩码（各为VarInt长度 + 大端long数组），
+     * 随后是天空光与方块光的数组列表（VarInt数量，每项VarInt 2048 + nibble数组）。
+     * 掩码第i位对应段minSection + i，调用者传入世界最低段 - 1与世界段数 + 2。
+     * 有光照的段写出数组，全为0的段只设置空掩码，不存在的段两个掩码都不设置。
+     * 返回写入的字节数，capacity不足时返回0
+     */
+    size_t writeLightPacket(int chunkX, int chunkZ, int minSection, int sectionCount,
+                            uint8_t* out, size_t capacity) const;
+    
+    // writeLightPacket最多写入的字节数
+    static size_t lightPacketCapacity(int sectionCount);
+    
+    /**
+     * 导出区块光照用于保存（区块NBT sections[]的SkyLight/BlockLight），按sectionY升序
+     * 段范围与NBT中Y字节一致（-128..127）；全为0的一侧不写数组，两侧都为0的段不导出
+     */
+    void exportChunk(int chunkX, int chunkZ, std::vector<io::ChunkLightSection>& out) const;
+    
+    /**
+     * 用保存的段替换区块光照（先清除该区块），长度不是2048的数组忽略
+     * 全段相同的数组存为单个值；返回载入的数组数
+     */
+    size_t importChunk(int chunkX, int chunkZ, const std::vector<io::ChunkLightSection>& sections);
 };
 
-// 高级光照引擎 - 文档要求的完整实现
+/**
+ * 高级光照引擎 - 文档要求的完整实现
+ *
+ * 每tick从延迟队列取出一批更新。一批涉及的区块较多时按区块分组并行处理：
+ * 一个条目只写自己所在区块，跨区块的传播推迟到下一批，但我们仍按3x3邻域划分，
+ * 为需要读取相邻区块的传播留出余量——区块按(chunkX mod 3, chunkZ mod 3)分成9种颜色，
+ * 同色区块两两相距至少3个区块，3x3邻域互不重叠，可以在线程池上同时处理；
+ * 9种颜色依次处理。区块数不足PARALLEL_MIN_CHUNKS（各组会互相接触或不值得分发）时串行处理。
+ * 并行阶段之前串行创建所需的区块段，并行阶段只查找、不修改映射表。
+ */
 class AdvancedLightEngine {
 private:
     ChunkedLightStorage storage;
@@ -122,39 +315,174 @@ private:
     
     std::vector<DirtyEntry> dirtyQueue;
     std::mutex queueMutex;
+    
+    /**
+     * 一个tick内的方块变化按区块段合并（活塞、TNT会在同一批段里产生成千上万次变化）
+     * 同一格多次变化只保留最终状态（透光值 | 发光等级 << 4）；调用者提供变化前状态时，
+     * 记录本tick第一次变化前的值，最终与之相同的格子（放置后又移走、推出又拉回）一增一减互相抵消，不产生更新。
+     * tick开始时每个段展开一次，按格子顺序生成延迟队列条目。由queueMutex保护。
+     */
+    struct PendingSection {
+        int32_t chunkX, sectionY, chunkZ;
+        std::array<uint64_t, 64> changed{};     // 段内下标(y << 8) | (z << 4) | x
+        std::array<uint64_t, 64> originalKnown{};
+        std::array<uint8_t, 4096> light;         // 最终状态
+        std::array<uint8_t, 4096> original;      // 第一次变化前的状态（originalKnown对应位为1时有效）
+    };
+    
+    static uint8_t packLight(const BlockLightProperties& properties) {
+        return static_cast<uint8_t>(properties.opacity | properties.emission << 4);
+    }
+    
+    std::vector<std::unique_ptr<PendingSection>> pendingSections;
+    std::unordered_map<uint64_t, size_t> pendingIndex;
     std::atomic<bool> processing{false};
     
+    // 每COMPACT_INTERVAL个tick收回一次重新变为均匀的段
+    static constexpr uint32_t COMPACT_INTERVAL = 200;
+    uint32_t ticksSinceCompact = 0;
+    
+    // 超出LIGHT_STORAGE预算时由MemoryBudget的回收线程置位，下一个tick立即收回（存储只能在tick线程访问）
+    std::atomic<bool> compactRequested{false};
+    uint64_t shedderId = 0;
+    
+    // 串行时每批条目数；并行时每批最多PARALLEL_BATCH_SIZE个条目（世界生成时一次产生大量更新）
+    static constexpr size_t BATCH_SIZE = 100;
+    static constexpr size_t PARALLEL_BATCH_SIZE = 4096;
+    static constexpr size_t PARALLEL_MIN_CHUNKS = 4;
+    std::atomic<bool> parallelEnabled{true};
+    
 public:
+    // 批处理统计
+    struct BatchStats {
+        std::atomic<uint64_t> serialBatches{0};
+        std::atomic<uint64_t> parallelBatches{0};
+        std::atomic<uint64_t> entriesProcessed{0};
+        std::atomic<uint64_t> chunkGroups{0};        // 并行处理的区块数（累计）
+        std::atomic<uint64_t> blockChanges{0};       // onBlockChange调用次数
+        std::atomic<uint64_t> coalescedChanges{0};   // 同一tick内落在已记录格子上的变化
+        std::atomic<uint64_t> cancelledChanges{0};   // 最终透光值与变化前相同而抵消的格子
+        std::atomic<uint64_t> sectionsFlushed{0};    // 展开为队列条目的段数
+        std::atomic<uint64_t> duplicateEntries{0};   // 合并掉的重复传播条目
+    };
+    
+    AdvancedLightEngine();
+    ~AdvancedLightEngine();
+    
+    AdvancedLightEngine(const AdvancedLightEngine&) = delete;
+    AdvancedLightEngine& operator=(const AdvancedLightEngine&) = delete;
+    
     // 初始化透光表
     static void initializeOpacityTable(const uint8_t* table, size_t size);
     
-    // 方块变化处理 - 按文档要求
+    // 方块变化处理 - 按文档要求（id为LightOpacityTable的下标；变化前状态未知，不参与抵消）
     void onBlockChange(int32_t x, int32_t y, int32_t z, int materialId);
+    // 已知变化前状态：同一tick内最终透光值与发光等级回到原值的格子不产生更新
+    void onBlockChange(int32_t x, int32_t y, int32_t z, int oldMaterialId, int newMaterialId);
+    /**
+     * 方块变化同时写入共享的方块状态（id为方块状态id）：变化前状态取自blocks，
+     * 区块已载入blocks时与上面的版本相同地参与抵消，否则按变化前状态未知处理
+     */
+    void onBlockChange(BlockStateStore& blocks, int32_t x, int32_t y, int32_t z, int newStateId);
     
     // 每tick调用 - 处理批量更新
     void tick();
     
+    // 是否还有排队中的更新（延迟队列或尚未展开的方块变化）
+    bool hasUpdates();
+    
     // 获取光照值 (O(1)快速查询)
     uint8_t getLightLevel(int32_t x, int32_t y, int32_t z, bool isSky) const;
     
+    // 光照数据占用的内存（字节）
+    size_t getLightMemoryUsage() const { return storage.getMemoryUsage(); }
+    
+    /**
+     * 新区块的初始天空光
+     * materialIds为区块列[minY, minY + height)内的材质id（LightOpacityTable的下标），
+     * 下标((y - minY) << 8) | (z << 4) | x。自顶向下逐层计算：顶层之上为15，每穿过一格减去其透光值，
+     * 整层一次处理（SIMD），结果直接写成段的nibble数组，全段相同的段只存一个值。
+     * 只有光会横向扩散的格子（比水平邻居亮且邻居可以接收更多光，以及区块边缘被遮挡层的亮格）
+     * 加入延迟队列，由增量传播处理。需要在tick所在线程调用。
+     * 返回加入队列的格子数
+     */
+    size_t initializeChunkSkylight(int32_t chunkX, int32_t chunkZ, const uint8_t* materialIds,
+                                   int32_t minY, int32_t height);
+    // 同上，按方块状态id（LightOpacityTable::setBlockStateTable）；光向下穿过被形状遮挡的面时完全挡住
+    size_t initializeChunkSkylight(int32_t chunkX, int32_t chunkZ, const uint16_t* blockStates,
+                                   int32_t minY, int32_t height);
+    // 同上，方块状态取自共享快照中的区块列；区块未载入快照时返回0
+    size_t initializeChunkSkylight(int32_t chunkX, int32_t chunkZ, const BlockStateSnapshot& blocks,
+                                   int32_t minY, int32_t height);
+    
+    /**
+     * 区块加载时载入保存的光照（AnvilChunkData::lightSections）
+     * trusted（原版isLightOn）为true时替换该区块的光照并返回true，调用者跳过重新计算；
+     * 否则不载入并返回false，由initializeChunkSkylight与增量传播重新计算。需要在tick所在线程调用
+     */
+    bool loadChunkLight(int32_t chunkX, int32_t chunkZ, const std::vector<io::ChunkLightSection>& sections,
+                        bool trusted);
+    
+    /**
+     * 导出区块光照用于保存，返回光照是否可信（该区块没有排队中的更新），写入AnvilChunkData::lightTrusted
+     */
+    bool saveChunkLight(int32_t chunkX, int32_t chunkZ, std::vector<io::ChunkLightSection>& out);
+    
+    // 关闭后所有批次在调用线程上串行处理
+    void setParallelEnabled(bool enabled) { parallelEnabled.store(enabled, std::memory_order_relaxed); }
+    const BatchStats& getBatchStats() const { return batchStats; }
+    
 private:
+    BatchStats batchStats;
+    
     // 计算区块坐标
     static inline void getChunkCoords(int32_t x, int32_t z, int32_t& chunkX, int32_t& chunkZ) {
         chunkX = x >> 4; // x / 16
         chunkZ = z >> 4; // z / 16
     }
     
+    // 计算区块段索引与段内y
+    static inline void getSectionCoords(int32_t y, int32_t& sectionY, int32_t& localY) {
+        sectionY = y >> 4;
+        localY = y & 15;
+    }
+    
     // 计算区块内坐标
     static inline void getLocalCoords(int32_t x, int32_t z, int32_t& localX, int32_t& localZ) {
         localX = x & 15; // x % 16
         localZ = z & 15; // z % 16
     }
     
-    // 增量光照传播
-    void propagateLightIncremental(int32_t x, int32_t y, int32_t z, uint8_t level, bool isSky);
+    /**
+     * 增量光照传播：只写条目所在区块，继续传播的条目追加到deferred
+     * createSections为false时段必须已经存在（并行阶段）
+     */
+    void propagateLightIncremental(int32_t x, int32_t y, int32_t z, uint8_t level, bool isSky,
+                                   bool createSections, std::vector<DirtyEntry>& deferred);
+    
+    void recordBlockChange(int32_t x, int32_t y, int32_t z, bool oldKnown, uint8_t oldLight, uint8_t newLight);
+    
+    template <typename StateId>
+    size_t initializeSkylightColumns(int32_t chunkX, int32_t chunkZ, const StateId* states,
+                                     int32_t minY, int32_t height);
+    // 把合并后的方块变化展开到延迟队列，需持有queueMutex
+    void flushPendingChangesLocked();
+    // 合并同一格同一通道的传播条目，保留最高等级（保持首次出现的顺序）
+    void mergeDuplicateEntries(std::vector<DirtyEntry>& entries);
+    
+    static uint64_t packSectionKey(int32_t chunkX, int32_t sectionY, int32_t chunkZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) & 0x3FFFFFF) << 38 |
+               (static_cast<uint64_t>(static_cast<uint32_t>(chunkZ)) & 0x3FFFFFF) << 12 |
+               (static_cast<uint64_t>(static_cast<uint32_t>(sectionY)) & 0xFFF);
+    }
     
     // 批量处理更新
     void processBatchUpdates();
+    void processSerial(const std::vector<DirtyEntry>& batch, std::vector<DirtyEntry>& deferred);
+    void processParallel(std::vector<DirtyEntry>& batch, std::vector<DirtyEntry>& deferred);
+    
+    CompactLightStorage* sectionFor(int32_t chunkX, int32_t sectionY, int32_t chunkZ, bool isSky,
+                                    bool create);
 };
 
 } // namespace world
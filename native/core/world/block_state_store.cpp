@@ -0,0 +1,321 @@
+#include "block_state_store.hpp"
+#include "../io/palette_codec.hpp"
+#include "../metrics.hpp"
+#include <algorithm>
+
+namespace lattice {
+namespace world {
+
+namespace {
+
+// 全部4096个值相同时返回true，value为该值
+bool isUniform(const uint16_t* states, uint16_t& value) {
+    value = states[0];
+    const uint16_t first = value;
+    return std::all_of(states + 1, states + BlockStateSectionData::VOLUME,
+                       [first](uint16_t state) { return state == first; });
+}
+
+} // namespace
+
+bool BlockStateSnapshot::copyColumn(int32_t chunkX, int32_t chunkZ, int32_t minY, int32_t height,
+                                    uint16_t* out) const {
+    const BlockStateColumn* found = column(chunkX, chunkZ);
+    if (!found || height <= 0) {
+        return found != nullptr;
+    }
+    // 按层复制：每层256格在段内连续（段下标(y << 8) | (z << 4) | x）
+    for (int32_t layer = 0; layer < height; ++layer) {
+        const int32_t y = minY + layer;
+        uint16_t* row = out + (static_cast<size_t>(layer) << 8);
+        const Section* section = found->section(y >> 4);
+        if (!section) {
+            std::fill_n(row, 256, AIR);
+        } else if (section->data) {
+            const uint16_t* src = section->data->states.data() + (static_cast<size_t>(y & 15) << 8);
+            std::copy_n(src, 256, row);
+        } else {
+            std::fill_n(row, 256, section->uniform);
+        }
+    }
+    return true;
+}
+
+size_t BlockStateSnapshot::columnCount() const {
+    size_t count = 0;
+    for (const auto& shard : shards_) {
+        count += shard->size();
+    }
+    return count;
+}
+
+BlockStateStore& BlockStateStore::instance() {
+    static BlockStateStore store;
+    return store;
+}
+
+BlockStateStore::BlockStateStore() {
+    // 所有分片一开始共享同一张空表，第一次修改时各自复制
+    auto empty = std::make_shared<ColumnMap>();
+    auto initial = std::make_shared<BlockStateSnapshot>();
+    for (size_t i = 0; i < BlockStateSnapshot::SHARD_COUNT; ++i) {
+        working_[i] = empty;
+        initial->shards_[i] = empty;
+    }
+    current_.store(std::move(initial), std::memory_order_release);
+    registerMetrics();
+}
+
+void BlockStateStore::registerMetrics() {
+    using core::MetricType;
+    auto& registry = core::MetricsRegistry::instance();
+    registry.addCallback(MetricType::GAUGE, "lattice_block_states_version",
+                         "Version of the published native block state snapshot", {},
+                         [this] { return static_cast<double>(snapshot()->version()); });
+    registry.addCallback(MetricType::COUNTER, "lattice_block_states_changes_total",
+                         "Block changes applied to the native block state store", {},
+                         [this] { return static_cast<double>(stats_.blockChanges.load(std::memory_order_relaxed)); });
+    registry.addCallback(MetricType::COUNTER, "lattice_block_states_ignored_changes_total",
+                         "Block changes dropped because their chunk was not loaded into the store", {},
+                         [this] { return static_cast<double>(stats_.ignoredChanges.load(std::memory_order_relaxed)); });
+    registry.addCallback(MetricType::COUNTER, "lattice_block_states_sections_copied_total",
+                         "Section arrays copied on write after being published", {},
+                         [this] { return static_cast<double>(stats_.sectionsCopied.load(std::memory_order_relaxed)); });
+}
+
+const BlockStateColumn* BlockStateStore::findColumnLocked(uint64_t chunkKey) const {
+    auto owned = ownedColumns_.find(chunkKey);
+    if (owned != ownedColumns_.end()) {
+        return owned->second;
+    }
+    const ColumnMap& shard = *working_[BlockStateSnapshot::shardOf(chunkKey)];
+    auto it = shard.find(chunkKey);
+    return it != shard.end() ? it->second.get() : nullptr;
+}
+
+BlockStateStore::ColumnMap& BlockStateStore::mutableShardLocked(size_t shard) {
+    if (!dirtyShards_.test(shard)) {
+        working_[shard] = std::make_shared<ColumnMap>(*working_[shard]);
+        dirtyShards_.set(shard);
+    }
+    return *working_[shard];
+}
+
+BlockStateColumn* BlockStateStore::mutableColumnLocked(int32_t chunkX, int32_t chunkZ, bool create) {
+    const uint64_t key = BlockStateSnapshot::packChunkKey(chunkX, chunkZ);
+    auto owned = ownedColumns_.find(key);
+    if (owned != ownedColumns_.end()) {
+        return owned->second;
+    }
+    const BlockStateColumn* published = findColumnLocked(key);
+    if (!published && !create) {
+        return nullptr;
+    }
+    // 列只复制段的引用，段数组在真正写入时才复制
+    auto column = published ? std::make_shared<BlockStateColumn>(*published) : std::make_shared<BlockStateColumn>();
+    BlockStateColumn* raw = column.get();
+    mutableShardLocked(BlockStateSnapshot::shardOf(key))[key] = std::move(column);
+    ownedColumns_.emplace(key, raw);
+    return raw;
+}
+
+BlockStateColumn::Section& BlockStateStore::sectionSlotLocked(BlockStateColumn& column, int32_t sectionY) {
+    if (column.sections.empty()) {
+        column.minSection = sectionY;
+        column.sections.resize(1);
+    } else if (sectionY < column.minSection) {
+        column.sections.insert(column.sections.begin(), static_cast<size_t>(column.minSection - sectionY),
+                               BlockStateColumn::Section{});
+        column.minSection = sectionY;
+    } else if (sectionY - column.minSection >= static_cast<int32_t>(column.sections.size())) {
+        column.sections.resize(static_cast<size_t>(sectionY - column.minSection) + 1);
+    }
+    return column.sections[static_cast<size_t>(sectionY - column.minSection)];
+}
+
+BlockStateSectionData& BlockStateStore::mutableSectionDataLocked(uint64_t sectionKey,
+                                                                 BlockStateColumn::Section& section) {
+    auto owned = ownedSections_.find(sectionKey);
+    if (owned != ownedSections_.end()) {
+        return *owned->second;
+    }
+    auto data = std::allocate_shared<BlockStateSectionData>(SectionAllocator{});
+    if (section.data) {
+        data->states = section.data->states;
+        stats_.sectionsCopied.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        data->states.fill(section.uniform);
+    }
+    BlockStateSectionData* raw = data.get();
+    section.data = std::move(data);
+    ownedSections_.emplace(sectionKey, raw);
+    return *raw;
+}
+
+void BlockStateStore::storeSectionLocked(int32_t chunkX, int32_t sectionY, int32_t chunkZ,
+                                         std::shared_ptr<BlockStateSectionData> data, uint16_t uniform) {
+    BlockStateColumn& column = *mutableColumnLocked(chunkX, chunkZ, true);
+    BlockStateColumn::Section& section = sectionSlotLocked(column, sectionY);
+    const uint64_t key = packSectionKey(chunkX, sectionY, chunkZ);
+    if (data) {
+        ownedSections_[key] = data.get();
+    } else {
+        ownedSections_.erase(key);
+    }
+    section.data = std::move(data);
+    section.uniform = uniform;
+    section.version = column.version = version_ + 1;
+    stats_.sectionsLoaded.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool BlockStateStore::loadSection(int32_t chunkX, int32_t sectionY, int32_t chunkZ,
+                                  std::span<const uint16_t> palette, std::span<const int64_t> data) {
+    if (palette.empty() || sectionY < MIN_SECTION_Y || sectionY > MAX_SECTION_Y) {
+        return false;
+    }
+    if (palette.size() == 1) {
+        std::lock_guard lock(writeMutex_);
+        storeSectionLocked(chunkX, sectionY, chunkZ, nullptr, palette[0]);
+        return true;
+    }
+
+    // 在锁外解码：下标先解到数组里，再逐个换成调色板中的状态id
+    auto decoded = std::allocate_shared<BlockStateSectionData>(SectionAllocator{});
+    std::span<uint16_t> states(decoded->states);
+    if (!io::anvil::unpackPaletteIndices(data, io::anvil::paletteBitsFor(palette.size(), 4), states)) {
+        return false;
+    }
+    for (uint16_t& state : states) {
+        if (state >= palette.size()) {
+            return false;
+        }
+        state = palette[state];
+    }
+    uint16_t uniform = 0;
+    if (isUniform(decoded->states.data(), uniform)) {
+        decoded.reset();
+    }
+
+    std::lock_guard lock(writeMutex_);
+    storeSectionLocked(chunkX, sectionY, chunkZ, std::move(decoded), uniform);
+    return true;
+}
+
+void BlockStateStore::loadSection(int32_t chunkX, int32_t sectionY, int32_t chunkZ, const uint16_t* states) {
+    if (!states || sectionY < MIN_SECTION_Y || sectionY > MAX_SECTION_Y) {
+        return;
+    }
+    uint16_t uniform = 0;
+    std::shared_ptr<BlockStateSectionData> data;
+    if (!isUniform(states, uniform)) {
+        data = std::allocate_shared<BlockStateSectionData>(SectionAllocator{});
+        std::copy_n(states, BlockStateSectionData::VOLUME, data->states.begin());
+    }
+    std::lock_guard lock(writeMutex_);
+    storeSectionLocked(chunkX, sectionY, chunkZ, std::move(data), uniform);
+}
+
+uint32_t BlockStateStore::setBlockLocked(int32_t x, int32_t y, int32_t z, uint16_t state) {
+    const int32_t chunkX = x >> 4;
+    const int32_t sectionY = y >> 4;
+    const int32_t chunkZ = z >> 4;
+    const BlockStateColumn* current = findColumnLocked(BlockStateSnapshot::packChunkKey(chunkX, chunkZ));
+    if (!current || sectionY < MIN_SECTION_Y || sectionY > MAX_SECTION_Y) {
+        stats_.ignoredChanges.fetch_add(1, std::memory_order_relaxed);
+        return NOT_LOADED;
+    }
+    stats_.blockChanges.fetch_add(1, std::memory_order_relaxed);
+
+    const size_t index = BlockStateSnapshot::localIndex(x, y, z);
+    const BlockStateColumn::Section* existing = current->section(sectionY);
+    const uint16_t previous = existing ? existing->get(index) : BlockStateSnapshot::AIR;
+    if (previous == state) {
+        return previous;
+    }
+
+    // 只有真正改变时才复制列与段
+    BlockStateColumn& column = *mutableColumnLocked(chunkX, chunkZ, false);
+    BlockStateColumn::Section& section = sectionSlotLocked(column, sectionY);
+    mutableSectionDataLocked(packSectionKey(chunkX, sectionY, chunkZ), section).states[index] = state;
+    section.version = column.version = version_ + 1;
+    return previous;
+}
+
+uint32_t BlockStateStore::setBlock(int32_t x, int32_t y, int32_t z, uint16_t state) {
+    std::lock_guard lock(writeMutex_);
+    return setBlockLocked(x, y, z, state);
+}
+
+size_t BlockStateStore::setBlocks(std::span<const int64_t> positions, std::span<const uint16_t> states) {
+    const size_t count = std::min(positions.size(), states.size());
+    size_t applied = 0;
+    std::lock_guard lock(writeMutex_);
+    for (size_t i = 0; i < count; ++i) {
+        // BlockPos.asLong：x 26位 | z 26位 | y 12位
+        const int64_t packed = positions[i];
+        const int32_t x = static_cast<int32_t>(packed >> 38);
+        const int32_t y = static_cast<int32_t>(static_cast<int64_t>(static_cast<uint64_t>(packed) << 52) >> 52);
+        const int32_t z = static_cast<int32_t>(static_cast<int64_t>(static_cast<uint64_t>(packed) << 26) >> 38);
+        if (setBlockLocked(x, y, z, states[i]) != NOT_LOADED) {
+            ++applied;
+        }
+    }
+    return applied;
+}
+
+void BlockStateStore::unloadChunk(int32_t chunkX, int32_t chunkZ) {
+    const uint64_t key = BlockStateSnapshot::packChunkKey(chunkX, chunkZ);
+    std::lock_guard lock(writeMutex_);
+    const BlockStateColumn* column = findColumnLocked(key);
+    if (!column) {
+        return;
+    }
+    for (size_t i = 0; i < column->sections.size(); ++i) {
+        ownedSections_.erase(packSectionKey(chunkX, column->minSection + static_cast<int32_t>(i), chunkZ));
+    }
+    ownedColumns_.erase(key);
+    mutableShardLocked(BlockStateSnapshot::shardOf(key)).erase(key);
+    stats_.chunksUnloaded.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t BlockStateStore::publish() {
+    std::lock_guard lock(writeMutex_);
+    if (dirtyShards_.none()) {
+        return version_;
+    }
+    ++version_;
+
+    // 本次写入的段数组重新变为全段相同时（如爆炸后整段变为空气）退回单个值
+    for (auto& [key, column] : ownedColumns_) {
+        const int32_t chunkX = BlockStateSnapshot::chunkXOf(key);
+        const int32_t chunkZ = BlockStateSnapshot::chunkZOf(key);
+        for (size_t i = 0; i < column->sections.size(); ++i) {
+            BlockStateColumn::Section& section = column->sections[i];
+            const int32_t sectionY = column->minSection + static_cast<int32_t>(i);
+            auto owned = ownedSections_.find(packSectionKey(chunkX, sectionY, chunkZ));
+            uint16_t uniform = 0;
+            if (owned != ownedSections_.end() && isUniform(owned->second->states.data(), uniform)) {
+                section.data.reset();
+                section.uniform = uniform;
+                stats_.sectionsCompacted.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    auto next = std::make_shared<BlockStateSnapshot>();
+    for (size_t i = 0; i < BlockStateSnapshot::SHARD_COUNT; ++i) {
+        next->shards_[i] = working_[i];
+    }
+    next->version_ = version_;
+    current_.store(std::move(next), std::memory_order_release);
+
+    // 已发布的分片、列与段数组从此只读，之后的修改重新复制
+    dirtyShards_.reset();
+    ownedColumns_.clear();
+    ownedSections_.clear();
+    stats_.published.fetch_add(1, std::memory_order_relaxed);
+    return version_;
+}
+
+} // namespace world
+} // namespace lattice
@@ -0,0 +1,327 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "../memory_budget.hpp"
+
+namespace lattice {
+namespace world {
+
+// ====== 共享的方块状态快照 ======
+//
+// 光照、寻路、AI原本各自向Java要方块数据（或各存一份只有自己用的分类）。这里每个区块段存一份
+// 调色板解码后的方块状态id（Block.BLOCK_STATE_REGISTRY，uint16），由区块加载与方块变化事件增量更新，
+// 每tick发布一次版本化的快照。快照发布后不再修改：修改只复制被改动的列与段（写时复制），
+// 工作线程持有的快照始终一致，读取不加锁、不调用JNI。
+
+/**
+ * 一个区块段调色板解码后的方块状态，下标(y << 8) | (z << 4) | x
+ * 通过BudgetAllocator分配，记到MemoryBudget的BLOCK_STATES
+ */
+struct BlockStateSectionData {
+    static constexpr size_t VOLUME = 4096;
+    std::array<uint16_t, VOLUME> states;
+};
+
+/**
+ * 一个区块列的所有段（sectionY从minSection起连续存放）
+ * 全段相同的段（空气段、整段石头）只存一个值
+ */
+struct BlockStateColumn {
+    struct Section {
+        std::shared_ptr<const BlockStateSectionData> data;   // 为空表示整段都是uniform
+        uint16_t uniform = 0;
+        uint64_t version = 0;                                 // 最后一次修改该段的发布版本
+
+        uint16_t get(size_t index) const { return data ? data->states[index] : uniform; }
+        bool isUniform() const { return !data; }
+    };
+
+    int32_t minSection = 0;
+    std::vector<Section> sections;
+    uint64_t version = 0;                                     // 列内任一段最后被修改的发布版本
+
+    const Section* section(int32_t sectionY) const {
+        const int64_t index = static_cast<int64_t>(sectionY) - minSection;
+        return index >= 0 && index < static_cast<int64_t>(sections.size()) ? &sections[index] : nullptr;
+    }
+};
+
+/**
+ * BlockStateStore发布的不可变快照
+ *
+ * 区块列按区块坐标散列到SHARD_COUNT个分片；发布时只有改动过的分片被复制，
+ * 其余分片、列与段数组与上一个快照共享。未载入的位置读作AIR。
+ */
+class BlockStateSnapshot {
+public:
+    static constexpr uint16_t AIR = 0;
+    static constexpr size_t SHARD_COUNT = 64;
+
+    using Section = BlockStateColumn::Section;
+    using ColumnMap = std::unordered_map<uint64_t, std::shared_ptr<const BlockStateColumn>>;
+
+    uint64_t version() const { return version_; }
+
+    const BlockStateColumn* column(int32_t chunkX, int32_t chunkZ) const {
+        const uint64_t key = packChunkKey(chunkX, chunkZ);
+        const ColumnMap& shard = *shards_[shardOf(key)];
+        auto it = shard.find(key);
+        return it != shard.end() ? it->second.get() : nullptr;
+    }
+
+    const Section* section(int32_t chunkX, int32_t sectionY, int32_t chunkZ) const {
+        const BlockStateColumn* found = column(chunkX, chunkZ);
+        return found ? found->section(sectionY) : nullptr;
+    }
+
+    bool isLoaded(int32_t chunkX, int32_t chunkZ) const { return column(chunkX, chunkZ) != nullptr; }
+
+    uint16_t get(int32_t x, int32_t y, int32_t z) const {
+        const Section* found = section(x >> 4, y >> 4, z >> 4);
+        return found ? found->get(localIndex(x, y, z)) : AIR;
+    }
+
+    /**
+     * 区块列[minY, minY + height)的方块状态写入out，下标((y - minY) << 8) | (z << 4) | x
+     * （与AdvancedLightEngine::initializeChunkSkylight的布局相同），没有的段填AIR。
+     * 区块未载入时返回false，out不变
+     */
+    bool copyColumn(int32_t chunkX, int32_t chunkZ, int32_t minY, int32_t height, uint16_t* out) const;
+
+    size_t columnCount() const;
+
+    /**
+     * 与before相比有变化的段：visit(chunkX, sectionY, chunkZ, const Section*)，段被移除时为nullptr。
+     * 未变化的分片与列只比较指针，所以每tick比较相邻两个快照的代价与改动量成正比。
+     * before为空时列出所有的段
+     */
+    template <typename Visit>
+    void diff(const BlockStateSnapshot* before, Visit&& visit) const;
+
+    // 段内下标
+    static size_t localIndex(int32_t x, int32_t y, int32_t z) {
+        return static_cast<size_t>(((y & 15) << 8) | ((z & 15) << 4) | (x & 15));
+    }
+
+    static uint64_t packChunkKey(int32_t chunkX, int32_t chunkZ) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32 | static_cast<uint32_t>(chunkZ);
+    }
+    static int32_t chunkXOf(uint64_t key) { return static_cast<int32_t>(key >> 32); }
+    static int32_t chunkZOf(uint64_t key) { return static_cast<int32_t>(key & 0xFFFFFFFFu); }
+
+    static size_t shardOf(uint64_t chunkKey) {
+        return static_cast<size_t>((chunkKey * 0x9E3779B97F4A7C15ULL) >> 58);
+    }
+
+    /**
+     * 单线程的读取游标：缓存最近访问的列，同一列内连续读取不查哈希表
+     * （光照BFS、寻路的邻居访问基本都落在同一列）。快照必须比游标活得久
+     */
+    class Reader {
+    public:
+        Reader() = default;
+        explicit Reader(const BlockStateSnapshot* snapshot) : snapshot_(snapshot) {}
+
+        void reset(const BlockStateSnapshot* snapshot) {
+            snapshot_ = snapshot;
+            cached_ = nullptr;
+            cacheValid_ = false;
+        }
+
+        const BlockStateSnapshot* snapshot() const { return snapshot_; }
+
+        uint16_t get(int32_t x, int32_t y, int32_t z) {
+            if (!snapshot_) {
+                return AIR;
+            }
+            const int32_t chunkX = x >> 4;
+            const int32_t chunkZ = z >> 4;
+            if (!cacheValid_ || chunkX != cachedX_ || chunkZ != cachedZ_) {
+                cached_ = snapshot_->column(chunkX, chunkZ);
+                cachedX_ = chunkX;
+                cachedZ_ = chunkZ;
+                cacheValid_ = true;
+            }
+            if (!cached_) {
+                return AIR;
+            }
+            const Section* found = cached_->section(y >> 4);
+            return found ? found->get(localIndex(x, y, z)) : AIR;
+        }
+
+    private:
+        const BlockStateSnapshot* snapshot_ = nullptr;
+        const BlockStateColumn* cached_ = nullptr;
+        int32_t cachedX_ = 0, cachedZ_ = 0;
+        bool cacheValid_ = false;
+    };
+
+private:
+    friend class BlockStateStore;
+
+    std::array<std::shared_ptr<const ColumnMap>, SHARD_COUNT> shards_;
+    uint64_t version_ = 0;
+};
+
+/**
+ * @brief 方块状态存储（进程内每个桥接库一份，光照、寻路、AI所在的库共用）
+ *
+ * 写入（区块加载/卸载、方块变化）可以来自任意线程，由写锁串行化，改动记在下一个快照的工作副本上；
+ * publish()把工作副本发布为新快照（通常在每tick结束时调用一次），读取方用snapshot()取得当前快照，
+ * 只是一次原子加载。每次区块加载需要上传该区块的所有段（全段相同的段几乎不占内存），
+ * 落在未载入区块上的方块变化被忽略。
+ */
+class BlockStateStore {
+public:
+    // setBlock的返回值：区块未载入
+    static constexpr uint32_t NOT_LOADED = UINT32_MAX;
+    // 段范围与区块NBT中的Y字节一致，超出范围的段与方块变化被忽略
+    static constexpr int32_t MIN_SECTION_Y = -128;
+    static constexpr int32_t MAX_SECTION_Y = 127;
+
+    static BlockStateStore& instance();
+
+    BlockStateStore();
+
+    BlockStateStore(const BlockStateStore&) = delete;
+    BlockStateStore& operator=(const BlockStateStore&) = delete;
+
+    /**
+     * 载入一个段（区块NBT block_states的格式）：palette为方块状态id，data为调色板下标
+     * （1.16+布局，位宽按调色板大小推算，最小4位）；调色板只有一项时data可以为空。
+     * 下标超出调色板或data长度不足时返回false，该段不变
+     */
+    bool loadSection(int32_t chunkX, int32_t sectionY, int32_t chunkZ,
+                     std::span<const uint16_t> palette, std::span<const int64_t> data);
+    // 已解码的4096个方块状态id
+    void loadSection(int32_t chunkX, int32_t sectionY, int32_t chunkZ, const uint16_t* states);
+
+    /**
+     * 方块变化，返回变化前的状态id；区块未载入时返回NOT_LOADED，不做修改
+     * 区块已载入但该段没有上传时按全空气段创建
+     */
+    uint32_t setBlock(int32_t x, int32_t y, int32_t z, uint16_t state);
+    // positions为BlockPos.asLong()，返回应用的变化数
+    size_t setBlocks(std::span<const int64_t> positions, std::span<const uint16_t> states);
+
+    void unloadChunk(int32_t chunkX, int32_t chunkZ);
+
+    /**
+     * 发布自上次发布以来的修改，返回新快照的版本；没有修改时不发布，返回当前版本。
+     * 发布前把重新变为全段相同的段数组收回
+     */
+    uint64_t publish();
+
+    // 当前快照（不会再被修改），不加锁
+    std::shared_ptr<const BlockStateSnapshot> snapshot() const {
+        return current_.load(std::memory_order_acquire);
+    }
+
+    struct Stats {
+        std::atomic<uint64_t> published{0};
+        std::atomic<uint64_t> sectionsLoaded{0};
+        std::atomic<uint64_t> blockChanges{0};
+        std::atomic<uint64_t> ignoredChanges{0};     // 落在未载入区块上的变化
+        std::atomic<uint64_t> sectionsCopied{0};     // 写时复制的段数组
+        std::atomic<uint64_t> sectionsCompacted{0};  // 发布时收回的段数组
+        std::atomic<uint64_t> chunksUnloaded{0};
+    };
+    const Stats& getStats() const { return stats_; }
+
+    // BLOCK_STATES子系统记账的字节数（包括仍被旧快照引用的段数组）
+    size_t memoryUsage() const { return core::MemoryBudget::instance().usage(core::MemorySubsystem::BLOCK_STATES); }
+
+private:
+    using SectionAllocator = core::BudgetAllocator<BlockStateSectionData, core::MemorySubsystem::BLOCK_STATES>;
+    using ColumnMap = BlockStateSnapshot::ColumnMap;
+
+    // 以下调用方持有writeMutex_
+    const BlockStateColumn* findColumnLocked(uint64_t chunkKey) const;
+    ColumnMap& mutableShardLocked(size_t shard);
+    // 本次发布前可以原地修改的列；create为false且区块未载入时返回nullptr
+    BlockStateColumn* mutableColumnLocked(int32_t chunkX, int32_t chunkZ, bool create);
+    // 列中sectionY的段（不存在时扩展列，新段为全空气）
+    BlockStateColumn::Section& sectionSlotLocked(BlockStateColumn& column, int32_t sectionY);
+    // 本次发布前可以原地修改的段数组（均匀段展开，共享的数组复制一份）
+    BlockStateSectionData& mutableSectionDataLocked(uint64_t sectionKey, BlockStateColumn::Section& section);
+    void storeSectionLocked(int32_t chunkX, int32_t sectionY, int32_t chunkZ,
+                            std::shared_ptr<BlockStateSectionData> data, uint16_t uniform);
+    uint32_t setBlockLocked(int32_t x, int32_t y, int32_t z, uint16_t state);
+    void registerMetrics();
+
+    static uint64_t packSectionKey(int32_t chunkX, int32_t sectionY, int32_t chunkZ) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX) & 0x3FFFFF) << 42) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(chunkZ) & 0x3FFFFF) << 20) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(sectionY) & 0xFFFFF));
+    }
+
+    std::mutex writeMutex_;
+    // 工作副本：未改动的分片与当前快照共享，dirtyShards_中的分片是本次发布前复制的
+    std::array<std::shared_ptr<ColumnMap>, BlockStateSnapshot::SHARD_COUNT> working_;
+    std::bitset<BlockStateSnapshot::SHARD_COUNT> dirtyShards_;
+    // 本次发布前新建的列与段数组（尚未发布，可以原地修改）
+    std::unordered_map<uint64_t, BlockStateColumn*> ownedColumns_;
+    std::unordered_map<uint64_t, BlockStateSectionData*> ownedSections_;
+    uint64_t version_ = 0;
+
+    std::atomic<std::shared_ptr<const BlockStateSnapshot>> current_;
+    Stats stats_;
+};
+
+template <typename Visit>
+void BlockStateSnapshot::diff(const BlockStateSnapshot* before, Visit&& visit) const {
+    static const ColumnMap empty;
+    for (size_t shard = 0; shard < SHARD_COUNT; ++shard) {
+        const ColumnMap& current = *shards_[shard];
+        const ColumnMap& previous = before ? *before->shards_[shard] : empty;
+        if (&current == &previous) {
+            continue;
+        }
+        for (const auto& [key, column] : current) {
+            const int32_t chunkX = chunkXOf(key);
+            const int32_t chunkZ = chunkZOf(key);
+            auto it = previous.find(key);
+            const BlockStateColumn* old = it != previous.end() ? it->second.get() : nullptr;
+            if (old == column.get()) {
+                continue;
+            }
+            for (size_t i = 0; i < column->sections.size(); ++i) {
+                const int32_t sectionY = column->minSection + static_cast<int32_t>(i);
+                const Section& section = column->sections[i];
+                const Section* oldSection = old ? old->section(sectionY) : nullptr;
+                if (!oldSection || oldSection->version != section.version) {
+                    visit(chunkX, sectionY, chunkZ, &section);
+                }
+            }
+            if (old) {
+                for (size_t i = 0; i < old->sections.size(); ++i) {
+                    const int32_t sectionY = old->minSection + static_cast<int32_t>(i);
+                    if (!column->section(sectionY)) {
+                        visit(chunkX, sectionY, chunkZ, static_cast<const Section*>(nullptr));
+                    }
+                }
+            }
+        }
+        for (const auto& [key, old] : previous) {
+            if (current.count(key)) {
+                continue;
+            }
+            for (size_t i = 0; i < old->sections.size(); ++i) {
+                visit(chunkXOf(key), old->minSection + static_cast<int32_t>(i), chunkZOf(key),
+                      static_cast<const Section*>(nullptr));
+            }
+        }
+    }
+}
+
+} // namespace world
+} // namespace lattice
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../async_task.hpp"
+#include "../io/anvil_format.hpp"
+#include "advanced_light_engine.hpp"
+
+#include <optional>
+
+namespace lattice {
+namespace world {
+
+// ====== 区块加载流水线 ======
+
+struct LoadedChunk {
+    io::anvil::AnvilChunkData data;
+    bool lightLoaded = false;   // 载入了保存的可信光照；为false时需要initializeChunkSkylight重新计算
+};
+
+/**
+ * 读取 → 解压 → 解析 → 载入光照，写成一个协程：
+ * 前三步在共享线程池上执行（AnvilChunkIO::loadChunkData），之后转到tickThread，
+ * 在tick线程drain()时载入保存的光照（AdvancedLightEngine要求在tick线程调用）。
+ * 区块不存在时返回nullopt（仍回到tickThread再返回，调用者的后续部分始终在tick线程上）。
+ */
+inline core::AsyncTask<std::optional<LoadedChunk>> loadChunkWithLight(io::anvil::AnvilChunkIO& chunkIO,
+                                                                      AdvancedLightEngine& lightEngine,
+                                                                      core::SerialExecutor& tickThread,
+                                                                      int worldId, int chunkX, int chunkZ) {
+    std::optional<io::anvil::AnvilChunkData> data = co_await chunkIO.loadChunkData(worldId, chunkX, chunkZ);
+    co_await tickThread.schedule();
+    if (!data) {
+        co_return std::nullopt;
+    }
+    LoadedChunk loaded;
+    loaded.lightLoaded = lightEngine.loadChunkLight(chunkX, chunkZ, data->lightSections, data->lightTrusted);
+    loaded.data = std::move(*data);
+    co_return loaded;
+}
+
+} // namespace world
+} // namespace lattice
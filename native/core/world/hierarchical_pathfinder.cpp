@@ -0,0 +1,306 @@
+#include "hierarchical_pathfinder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace lattice {
+namespace world {
+
+namespace {
+
+constexpr float INF = std::numeric_limits<float>::infinity();
+constexpr uint32_t NO_PARENT = UINT32_MAX;
+// 抽象层的启发式加权：抽象路径本身只是近似，加权后展开的段数大幅减少
+constexpr float HEURISTIC_WEIGHT = 1.3f;
+constexpr uint32_t SECTION_SEARCH_NODES = 4096 * 2;   // 段内搜索可能展开到相邻段的落点
+
+uint64_t pack_cell(const Node& node) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(node.x) & 0x3FFFFFF) << 38) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(node.z) & 0x3FFFFFF) << 12) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(node.y) & 0xFFF));
+}
+
+uint64_t section_of(const Node& node) {
+    return SectionBlockSnapshot::pack_section_key(node.x >> 4, node.y >> 4, node.z >> 4);
+}
+
+SearchBounds section_bounds(const Node& node) {
+    return SearchBounds::section(node.x >> 4, node.y >> 4, node.z >> 4);
+}
+
+float distance(const Node& a, const Node& b) {
+    const float dx = static_cast<float>(a.x - b.x);
+    const float dy = static_cast<float>(a.y - b.y);
+    const float dz = static_cast<float>(a.z - b.z);
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+} // namespace
+
+HierarchicalPathfinder::HierarchicalPathfinder(PathfinderOptimizer& optimizer) : optimizer(optimizer) {}
+
+size_t HierarchicalPathfinder::cached_sections() const {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    size_t total = 0;
+    for (const auto& sections : cache) {
+        total += sections.size();
+    }
+    return total;
+}
+
+uint64_t HierarchicalPathfinder::neighborhood_stamp(const SectionBlockSnapshot& blocks,
+                                                    int chunk_x, int section_y, int chunk_z) {
+    // 出口检测会读到相邻段（落点、脚下方块），所以邻域内任一段变化都要重新计算
+    uint64_t stamp = 0xCBF29CE484222325ULL;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                stamp ^= blocks.section_version(chunk_x + dx, section_y + dy, chunk_z + dz);
+                stamp *= 0x100000001B3ULL;
+            }
+        }
+    }
+    return stamp;
+}
+
+std::shared_ptr<HierarchicalPathfinder::SectionPortals> HierarchicalPathfinder::section_portals(
+    const SectionBlockSnapshot& blocks, int chunk_x, int section_y, int chunk_z, MobType mob_type) {
+    const uint64_t key = SectionBlockSnapshot::pack_section_key(chunk_x, section_y, chunk_z);
+    const uint64_t stamp = neighborhood_stamp(blocks, chunk_x, section_y, chunk_z);
+    auto& sections = cache[static_cast<size_t>(mob_type)];
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = sections.find(key);
+        if (it != sections.end() && it->second->stamp == stamp) {
+            stats.section_cache_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    auto portals = build_portals(blocks, chunk_x, section_y, chunk_z, mob_type);
+    portals->stamp = stamp;
+    stats.sections_built.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    if (sections.size() >= MAX_CACHED_SECTIONS) {
+        sections.clear();
+    }
+    sections[key] = portals;
+    return portals;
+}
+
+std::shared_ptr<HierarchicalPathfinder::SectionPortals> HierarchicalPathfinder::build_portals(
+    const SectionBlockSnapshot& blocks, int chunk_x, int section_y, int chunk_z, MobType mob_type) {
+    // 1. 所有离开本段的一步移动
+    struct Crossing {
+        Exit exit;
+        uint64_t target;
+    };
+    std::vector<Crossing> crossings;
+    optimizer.for_each_section_exit(blocks, chunk_x, section_y, chunk_z, mob_type,
+                                    [&](const Node& from, const Node& to, float cost) {
+                                        crossings.push_back(Crossing{Exit{from, to, cost}, section_of(to)});
+                                    });
+
+    // 2. 按目标段把相邻的出口格聚成连通块，每块保留离中心最近的出口
+    auto portals = std::make_shared<SectionPortals>();
+    std::sort(crossings.begin(), crossings.end(),
+              [](const Crossing& a, const Crossing& b) { return a.target < b.target; });
+    std::vector<char> assigned(crossings.size(), 0);
+    std::vector<size_t> component;
+    for (size_t seed = 0; seed < crossings.size(); ++seed) {
+        if (assigned[seed]) {
+            continue;
+        }
+        size_t group_end = seed;
+        while (group_end < crossings.size() && crossings[group_end].target == crossings[seed].target) {
+            ++group_end;
+        }
+        component.assign(1, seed);
+        assigned[seed] = 1;
+        for (size_t head = 0; head < component.size(); ++head) {
+            const Node& cell = crossings[component[head]].exit.from;
+            for (size_t other = seed + 1; other < group_end; ++other) {
+                const Node& candidate = crossings[other].exit.from;
+                if (!assigned[other] && std::abs(candidate.x - cell.x) <= 1 &&
+                    std::abs(candidate.y - cell.y) <= 1 && std::abs(candidate.z - cell.z) <= 1) {
+                    assigned[other] = 1;
+                    component.push_back(other);
+                }
+            }
+        }
+
+        float cx = 0.0f, cy = 0.0f, cz = 0.0f;
+        for (size_t index : component) {
+            cx += static_cast<float>(crossings[index].exit.from.x);
+            cy += static_cast<float>(crossings[index].exit.from.y);
+            cz += static_cast<float>(crossings[index].exit.from.z);
+        }
+        const float inverse = 1.0f / static_cast<float>(component.size());
+        const Node center(static_cast<int>(std::lround(cx * inverse)), static_cast<int>(std::lround(cy * inverse)),
+                          static_cast<int>(std::lround(cz * inverse)));
+        size_t representative = component.front();
+        float best = INF;
+        for (size_t index : component) {
+            const float score = distance(crossings[index].exit.from, center) + crossings[index].exit.cost * 0.01f;
+            if (score < best) {
+                best = score;
+                representative = index;
+            }
+        }
+        portals->exits.push_back(crossings[representative].exit);
+    }
+
+    portals->exit_cells.reserve(portals->exits.size());
+    for (const Exit& exit : portals->exits) {
+        portals->exit_cells.push_back(exit.from);
+    }
+    return portals;
+}
+
+const std::vector<float>& HierarchicalPathfinder::entry_costs(const SectionBlockSnapshot& blocks,
+                                                              SectionPortals& portals, const Node& entry,
+                                                              MobType mob_type) {
+    const uint64_t key = pack_cell(entry);
+    {
+        std::lock_guard<std::mutex> lock(portals.costs_mutex);
+        auto it = portals.costs_from.find(key);
+        if (it != portals.costs_from.end()) {
+            return it->second;
+        }
+    }
+    auto costs = optimizer.region_costs(blocks, entry, portals.exit_cells, mob_type, section_bounds(entry),
+                                        SECTION_SEARCH_NODES);
+    std::lock_guard<std::mutex> lock(portals.costs_mutex);
+    // 元素不会被删除，引用在portals存活期间有效
+    return portals.costs_from.try_emplace(key, std::move(costs)).first->second;
+}
+
+PathResult HierarchicalPathfinder::find_path(const SectionBlockSnapshot& blocks, const Node& start,
+                                             const Node& goal, MobType mob_type, uint32_t max_abstract_nodes) {
+    stats.searches.fetch_add(1, std::memory_order_relaxed);
+    if (distance(start, goal) < static_cast<float>(MIN_DISTANCE) || section_of(start) == section_of(goal)) {
+        return optimizer.find_path(blocks, start, goal, mob_type);
+    }
+
+    // ===== 抽象图上的A* =====
+    // 节点是段的入口格（起点或跨段落点）；via记录到达该节点经过的出口格
+    struct AbstractNode {
+        Node cell;
+        Node via;
+        float g;
+        uint32_t parent;
+        bool closed;
+    };
+    std::vector<AbstractNode> nodes;
+    std::unordered_map<uint64_t, uint32_t> index_of;
+    using QueueEntry = std::pair<float, uint32_t>;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;
+
+    const uint64_t goal_section = section_of(goal);
+    uint32_t goal_parent = NO_PARENT;
+    float goal_cost = INF;
+
+    nodes.push_back(AbstractNode{start, start, 0.0f, NO_PARENT, false});
+    index_of.emplace(pack_cell(start), 0);
+    open.emplace(distance(start, goal) * HEURISTIC_WEIGHT, 0);
+
+    uint32_t expanded = 0;
+    while (!open.empty() && expanded < max_abstract_nodes) {
+        const auto [f, current] = open.top();
+        open.pop();
+        if (nodes[current].closed) {
+            continue;
+        }
+        if (f >= goal_cost) {
+            break;   // 已找到的目标代价不大于任何待展开节点的估计
+        }
+        nodes[current].closed = true;
+        ++expanded;
+
+        const Node cell = nodes[current].cell;
+        const float g = nodes[current].g;
+        if (section_of(cell) == goal_section) {
+            // 段内直接到达目标
+            const auto direct = optimizer.region_costs(blocks, cell, {goal}, mob_type, section_bounds(cell),
+                                                       SECTION_SEARCH_NODES);
+            if (g + direct[0] < goal_cost) {
+                goal_cost = g + direct[0];
+                goal_parent = current;
+            }
+        }
+
+        auto portals = section_portals(blocks, cell.x >> 4, cell.y >> 4, cell.z >> 4, mob_type);
+        const std::vector<float>& costs = entry_costs(blocks, *portals, cell, mob_type);
+        for (size_t i = 0; i < portals->exits.size(); ++i) {
+            if (!std::isfinite(costs[i])) {
+                continue;
+            }
+            const Exit& exit = portals->exits[i];
+            const float next_g = g + costs[i] + exit.cost;
+            auto [it, inserted] = index_of.try_emplace(pack_cell(exit.to), static_cast<uint32_t>(nodes.size()));
+            if (inserted) {
+                nodes.push_back(AbstractNode{exit.to, exit.from, next_g, current, false});
+            } else {
+                AbstractNode& existing = nodes[it->second];
+                if (existing.closed || next_g >= existing.g) {
+                    continue;
+                }
+                existing.g = next_g;
+                existing.via = exit.from;
+                existing.parent = current;
+            }
+            open.emplace(next_g + distance(exit.to, goal) * HEURISTIC_WEIGHT, it->second);
+        }
+    }
+    stats.abstract_nodes.fetch_add(nodes.size(), std::memory_order_relaxed);
+
+    if (goal_parent == NO_PARENT) {
+        stats.fallbacks.fetch_add(1, std::memory_order_relaxed);
+        return optimizer.find_path(blocks, start, goal, mob_type);
+    }
+
+    // ===== 细化：逐段在段内做A*，段之间是一步跨越 =====
+    std::vector<uint32_t> chain;
+    for (uint32_t current = goal_parent; current != NO_PARENT; current = nodes[current].parent) {
+        chain.push_back(current);
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    PathResult result;
+    result.nodes.push_back(start);
+    auto refine = [&](const Node& from, const Node& to) {
+        if (from == to) {
+            return true;
+        }
+        const SearchBounds bounds = section_bounds(from);
+        PathResult segment = optimizer.find_path(blocks, from, to, mob_type, SECTION_SEARCH_NODES, &bounds);
+        result.nodes_visited += segment.nodes_visited;
+        if (!segment.reached) {
+            return false;
+        }
+        result.nodes.insert(result.nodes.end(), segment.nodes.begin() + 1, segment.nodes.end());
+        return true;
+    };
+    for (size_t i = 1; i < chain.size(); ++i) {
+        const AbstractNode& step = nodes[chain[i]];
+        // 上一个入口 -> 本段出口（段内），出口 -> 相邻段落点（一步）
+        if (!refine(nodes[chain[i - 1]].cell, step.via)) {
+            stats.fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return optimizer.find_path(blocks, start, goal, mob_type);
+        }
+        result.nodes.push_back(step.cell);
+    }
+    if (!refine(nodes[chain.back()].cell, goal)) {
+        stats.fallbacks.fetch_add(1, std::memory_order_relaxed);
+        return optimizer.find_path(blocks, start, goal, mob_type);
+    }
+    result.reached = true;
+    result.nodes_visited += static_cast<uint32_t>(nodes.size());
+    return result;
+}
+
+} // namespace world
+} // namespace lattice
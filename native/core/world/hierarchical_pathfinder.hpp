@@ -0,0 +1,82 @@
+#pragma once
+
+#include "pathfinder.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace world {
+
+/**
+ * HierarchicalPathfinder - 以16x16x16区块段为簇的分层寻路（HPA*）
+ *
+ * 每个段按生物类型预计算出口（段内一格一步移动到相邻段的一格），相邻的出口格按目标段
+ * 聚成连通块，每块保留一个代表出口。抽象图的节点是进入段的格子，边是段内局部Dijkstra
+ * 得到的"入口 -> 出口"代价加上跨段一步的代价；段内代价按入口格缓存。
+ * 抽象路径找到后逐段用限定在该段内的A*细化为完整路径。
+ *
+ * 失效：段数据记录所在3x3x3段邻域的版本戳，任一段的方块变化后下次使用时重新计算。
+ * 抽象搜索失败（例如路线需要离开段再折返）时回退到普通A*。
+ */
+class HierarchicalPathfinder {
+public:
+    static constexpr int MIN_DISTANCE = 48;                 // 起终点距离小于此值时直接用A*
+    static constexpr uint32_t DEFAULT_MAX_ABSTRACT_NODES = 4096;
+    static constexpr size_t MAX_CACHED_SECTIONS = 8192;
+
+    explicit HierarchicalPathfinder(PathfinderOptimizer& optimizer);
+
+    PathResult find_path(const SectionBlockSnapshot& blocks, const Node& start, const Node& goal,
+                         MobType mob_type, uint32_t max_abstract_nodes = DEFAULT_MAX_ABSTRACT_NODES);
+
+    struct Stats {
+        std::atomic<uint64_t> searches{0};
+        std::atomic<uint64_t> sections_built{0};
+        std::atomic<uint64_t> section_cache_hits{0};
+        std::atomic<uint64_t> abstract_nodes{0};
+        std::atomic<uint64_t> fallbacks{0};          // 回退到普通A*
+    };
+    const Stats& get_stats() const { return stats; }
+    size_t cached_sections() const;
+
+private:
+    struct Exit {
+        Node from;       // 段内的出口格
+        Node to;         // 相邻段中的落点
+        float cost;      // 跨段一步的代价
+    };
+
+    struct SectionPortals {
+        uint64_t stamp = 0;
+        std::vector<Exit> exits;
+        std::vector<Node> exit_cells;   // exits[i].from，供region_costs使用
+
+        // 入口格 -> 到各出口的段内代价
+        std::mutex costs_mutex;
+        std::unordered_map<uint64_t, std::vector<float>> costs_from;
+    };
+
+    std::shared_ptr<SectionPortals> section_portals(const SectionBlockSnapshot& blocks,
+                                                    int chunk_x, int section_y, int chunk_z, MobType mob_type);
+    std::shared_ptr<SectionPortals> build_portals(const SectionBlockSnapshot& blocks,
+                                                  int chunk_x, int section_y, int chunk_z, MobType mob_type);
+    const std::vector<float>& entry_costs(const SectionBlockSnapshot& blocks, SectionPortals& portals,
+                                          const Node& entry, MobType mob_type);
+    static uint64_t neighborhood_stamp(const SectionBlockSnapshot& blocks, int chunk_x, int section_y, int chunk_z);
+
+    PathfinderOptimizer& optimizer;
+
+    mutable std::mutex cache_mutex;
+    static constexpr size_t MOB_TYPE_COUNT = static_cast<size_t>(MobType::FLYING) + 1;
+    std::unordered_map<uint64_t, std::shared_ptr<SectionPortals>> cache[MOB_TYPE_COUNT];   // 按生物类型，段键 -> 出口
+
+    Stats stats;
+};
+
+} // namespace world
+} // namespace lattice
@@ -1,13 +1,24 @@
 #include "light_updater.hpp"
 #include <algorithm>
-#include <cassert>
-#include <queue>
-#include <unordered_map>
+#include <utility>
 // #include <jni.h> // 暂时移除JNI依赖
 
 namespace lattice {
 namespace world {
 
+namespace {
+
+// 光照穿过一个方块后的级别：每格至少衰减1，天空光垂直向下穿过完全透光的方块不衰减
+inline uint8_t attenuate(uint8_t level, uint8_t opacity, bool skyDownward) {
+    if (skyDownward && opacity == 0) {
+        return level;
+    }
+    const uint8_t loss = std::max<uint8_t>(1, opacity);
+    return level > loss ? static_cast<uint8_t>(level - loss) : 0;
+}
+
+} // namespace
+
 LightUpdater::LightUpdater() {
     // 初始化光照更新器
 }
@@ -16,224 +27,220 @@ LightUpdater::~LightUpdater() {
     // 清理资源
 }
 
-void LightUpdater::setLightLevel(const BlockPos& pos, uint8_t level, LightType type) {
-    LightMap& lightMap = (type == LightType::BLOCK) ? blockLightMap : skyLightMap;
-    if (level > 0) {
-        lightMap[pos] = level;
+CompactLightStorage* LightUpdater::LightChannel::section(ChunkedLightStorage& storage, int32_t x, int32_t y,
+                                                         int32_t z, bool create, bool sky) {
+    const int32_t sectionX = x >> 4;
+    const int32_t sectionY = y >> 4;
+    const int32_t sectionZ = z >> 4;
+    if (cacheValid && sectionX == cachedX && sectionY == cachedY && sectionZ == cachedZ &&
+        (cachedSection || !create)) {
+        return cachedSection;
+    }
+    
+    CompactLightStorage* found;
+    if (create) {
+        found = sky ? &storage.getSkyLight(sectionX, sectionY, sectionZ)
+                    : &storage.getBlockLight(sectionX, sectionY, sectionZ);
     } else {
-        lightMap.erase(pos);
+        const ChunkedLightStorage& view = storage;
+        found = const_cast<CompactLightStorage*>(sky ? view.getSkyLight(sectionX, sectionY, sectionZ)
+                                                     : view.getBlockLight(sectionX, sectionY, sectionZ));
     }
+    cachedX = sectionX;
+    cachedY = sectionY;
+    cachedZ = sectionZ;
+    cachedSection = found;
+    cacheValid = true;
+    return found;
+}
+
+uint8_t LightUpdater::readLevel(LightChannel& ch, int32_t x, int32_t y, int32_t z, bool sky) {
+    const CompactLightStorage* section = ch.section(storage, x, y, z, false, sky);
+    return section ? section->get(x & 15, y & 15, z & 15) : 0;
+}
+
+void LightUpdater::writeLevel(LightChannel& ch, int32_t x, int32_t y, int32_t z, uint8_t level, bool sky) {
+    if (level == 0) {
+        // 写0不需要创建不存在的段
+        if (CompactLightStorage* section = ch.section(storage, x, y, z, false, sky)) {
+            section->set(x & 15, y & 15, z & 15, 0);
+        }
+        return;
+    }
+    ch.section(storage, x, y, z, true, sky)->set(x & 15, y & 15, z & 15, level);
+}
+
+void LightUpdater::setLightLevel(const BlockPos& pos, uint8_t level, LightType type) {
+    if (!inBounds(pos)) {
+        return;
+    }
+    writeLevel(channel(type), pos.x, pos.y, pos.z, std::min<uint8_t>(level, 15), type == LightType::SKY);
 }
 
 uint8_t LightUpdater::getLightLevel(const BlockPos& pos, LightType type) const {
-    const LightMap& lightMap = (type == LightType::BLOCK) ? blockLightMap : skyLightMap;
-    auto it = lightMap.find(pos);
-    return (it != lightMap.end()) ? it->second : 0;
+    const CompactLightStorage* section = type == LightType::BLOCK
+        ? storage.getBlockLight(pos.x >> 4, pos.y >> 4, pos.z >> 4)
+        : storage.getSkyLight(pos.x >> 4, pos.y >> 4, pos.z >> 4);
+    return section ? section->get(pos.x & 15, pos.y & 15, pos.z & 15) : 0;
 }
 
 void LightUpdater::addLightSource(const BlockPos& pos, uint8_t level, LightType type) {
-    LightMap& lightSources = (type == LightType::BLOCK) ? blockLightSources : skyLightSources;
-    LightMap& lightMap = (type == LightType::BLOCK) ? blockLightMap : skyLightMap;
+    if (level == 0) {
+        removeLightSource(pos, type);
+        return;
+    }
+    if (!inBounds(pos)) {
+        return;
+    }
+    level = std::min<uint8_t>(level, 15);
     
-    // 更新或移除光源
-    if (level > 0) {
-        lightSources[pos] = level;
-        
-        // 添加到更新队列
-        updateQueue.emplace(pos, level, LightPropagationDirection::INCREASE, type);
-        pendingPositions.insert(pos);
-        
-        // 直接设置光源位置的光照级别
-        lightMap[pos] = level;
-    } else {
+    LightChannel& ch = channel(type);
+    const bool sky = type == LightType::SKY;
+    auto [it, inserted] = ch.sources.try_emplace(pos, level);
+    if (!inserted && it->second != level) {
+        // 光源级别变化：先按旧级别移除，再按新级别补光
         removeLightSource(pos, type);
+        ch.sources.emplace(pos, level);
     }
+    
+    if (level > readLevel(ch, pos.x, pos.y, pos.z, sky)) {
+        writeLevel(ch, pos.x, pos.y, pos.z, level, sky);
+    }
+    ch.increaseQueue.push_back(packNode(pos.x, pos.y, pos.z, readLevel(ch, pos.x, pos.y, pos.z, sky)));
 }
 
 void LightUpdater::removeLightSource(const BlockPos& pos, LightType type) {
-    LightMap& lightSources = (type == LightType::BLOCK) ? blockLightSources : skyLightSources;
-    LightMap& lightMap = (type == LightType::BLOCK) ? blockLightMap : skyLightMap;
+    LightChannel& ch = channel(type);
+    if (ch.sources.erase(pos) == 0) {
+        return;
+    }
     
-    auto sourceIt = lightSources.find(pos);
-    if (sourceIt != lightSources.end()) {
-        uint8_t oldLevel = sourceIt->second;
-        lightSources.erase(sourceIt);
-        
-        // 将光源移除添加到更新队列
-        updateQueue.emplace(pos, oldLevel, LightPropagationDirection::DECREASE);
-        pendingPositions.insert(pos);
-        
-        // 移除光源位置的光照级别
-        lightMap.erase(pos);
+    const bool sky = type == LightType::SKY;
+    const uint8_t oldLevel = readLevel(ch, pos.x, pos.y, pos.z, sky);
+    if (oldLevel > 0) {
+        writeLevel(ch, pos.x, pos.y, pos.z, 0, sky);
+        ch.decreaseQueue.push_back(packNode(pos.x, pos.y, pos.z, oldLevel));
     }
 }
 
 void LightUpdater::propagateLightUpdates() {
-    // 处理所有排队的更新
-    while (!updateQueue.empty()) {
-        LightUpdateTask task = updateQueue.front();
-        updateQueue.pop();
-        
-        pendingPositions.erase(task.pos);
-        
-        if (task.direction == LightPropagationDirection::INCREASE) {
-            // 处理光照增加
-            // 检查当前级别是否仍然有效
-            uint8_t currentLevel = getLightLevel(task.pos, LightType::BLOCK); // 简化处理，只处理方块光
-            if (currentLevel >= task.lightLevel) {
-                propagateIncrease(task.pos, task.lightLevel, LightType::BLOCK);
-            }
-        } else {
-            // 处理光照减少
-            propagateDecrease(task.pos, task.lightLevel, LightType::BLOCK);
+    // 整次传播读同一个快照：传播期间发布的方块变化留给下一次
+    blocks = BlockStateStore::instance().snapshot();
+    blockReader.reset(blocks.get());
+    for (LightType type : {LightType::BLOCK, LightType::SKY}) {
+        LightChannel& ch = channel(type);
+        const bool sky = type == LightType::SKY;
+        if (!ch.decreaseQueue.empty()) {
+            propagateDecrease(ch, sky);
+        }
+        if (!ch.increaseQueue.empty()) {
+            propagateIncrease(ch, sky);
         }
     }
+    blockReader.reset(nullptr);
+    blocks.reset();
 }
 
 bool LightUpdater::hasUpdates() const {
-    return !updateQueue.empty() || !pendingPositions.empty();
-}
-
-std::vector<BlockPos> LightUpdater::getNeighbors(const BlockPos& pos) const {
-    std::vector<BlockPos> neighbors;
-    neighbors.reserve(6);
-    
-    // 添加6个直接相邻的方块
-    neighbors.emplace_back(pos.x + 1, pos.y, pos.z);
-    neighbors.emplace_back(pos.x - 1, pos.y, pos.z);
-    neighbors.emplace_back(pos.x, pos.y + 1, pos.z);
-    neighbors.emplace_back(pos.x, pos.y - 1, pos.z);
-    neighbors.emplace_back(pos.x, pos.y, pos.z + 1);
-    neighbors.emplace_back(pos.x, pos.y, pos.z - 1);
-    
-    return neighbors;
+    return !blockChannel.increaseQueue.empty() || !blockChannel.decreaseQueue.empty() ||
+           !skyChannel.increaseQueue.empty() || !skyChannel.decreaseQueue.empty();
 }
 
-void LightUpdater::propagateIncrease(const BlockPos& pos, uint8_t level, LightType type) {
-    if (level <= 1) return; // 无法再传播更低的光照
-    
-    LightMap& lightMap = (type == LightType::BLOCK) ? blockLightMap : skyLightMap;
-    
-    // 获取相邻方块
-    std::vector<BlockPos> neighbors = getNeighbors(pos);
-    
-    for (const BlockPos& neighborPos : neighbors) {
-        // 计算该位置的光照阻隔
-        uint8_t opacity = getOpacity(neighborPos);
-        uint8_t newLevel = (level > opacity) ? (level - opacity) : 0;
+void LightUpdater::propagateIncrease(LightChannel& ch, bool sky) {
+    // 队列按下标遍历，处理过程中追加的节点在同一轮处理；结束后清空但保留容量
+    std::vector<PackedNode>& queue = ch.increaseQueue;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const PackedNode node = queue[i];
+        const uint8_t level = nodeLevel(node);
+        const int32_t x = nodeX(node);
+        const int32_t y = nodeY(node);
+        const int32_t z = nodeZ(node);
         
-        // 检查是否需要更新此位置的光照
-        uint8_t currentLevel = getLightLevel(neighborPos, type);
-        if (newLevel > currentLevel) {
-            // 更新光照级别
-            lightMap[neighborPos] = newLevel;
-            
-            // 继续传播
-            if (newLevel > 1) {
-                updateQueue.emplace(neighborPos, newLevel, LightPropagationDirection::INCREASE);
-                pendingPositions.insert(neighborPos);
+        // 入队之后被更亮的光覆盖或被移除的节点已过期
+        if (level <= 1 || readLevel(ch, x, y, z, sky) != level) {
+            continue;
+        }
+        
+        for (const NeighborOffset& offset : NEIGHBOR_OFFSETS) {
+            const int32_t ny = y + offset.dy;
+            if (ny < MIN_Y || ny > MAX_Y) {
+                continue;
+            }
+            const int32_t nx = x + offset.dx;
+            const int32_t nz = z + offset.dz;
+            const uint8_t newLevel = attenuate(level, getOpacity(BlockPos(nx, ny, nz)), sky && offset.dy < 0);
+            if (newLevel > readLevel(ch, nx, ny, nz, sky)) {
+                writeLevel(ch, nx, ny, nz, newLevel, sky);
+                if (newLevel > 1) {
+                    queue.push_back(withLevel(node + static_cast<uint64_t>(offset.packed), newLevel));
+                }
             }
         }
     }
+    queue.clear();
 }
 
-void LightUpdater::propagateDecrease(const BlockPos& pos, uint8_t level, LightType type) {
-    LightMap& lightMap = (type == LightType::BLOCK) ? blockLightMap : skyLightMap;
-    
-    // 获取相邻方块
-    std::vector<BlockPos> neighbors = getNeighbors(pos);
-    
-    // 使用BFS队列处理光照减少传播
-    std::queue<std::pair<BlockPos, uint8_t>> bfsQueue;
-    std::unordered_set<BlockPos, BlockPosHash> visited;
-    
-    bfsQueue.emplace(pos, level);
-    visited.insert(pos);
-    
-    while (!bfsQueue.empty()) {
-        auto [currentPos, currentLevel] = bfsQueue.front();
-        bfsQueue.pop();
-        
-        std::vector<BlockPos> currentNeighbors = getNeighbors(currentPos);
+void LightUpdater::propagateDecrease(LightChannel& ch, bool sky) {
+    std::vector<PackedNode>& queue = ch.decreaseQueue;
+    for (size_t i = 0; i < queue.size(); ++i) {
+        const PackedNode node = queue[i];
+        const uint8_t level = nodeLevel(node);          // 该位置被清除前的级别
+        const int32_t x = nodeX(node);
+        const int32_t y = nodeY(node);
+        const int32_t z = nodeZ(node);
         
-        for (const BlockPos& neighborPos : currentNeighbors) {
-            // 避免重复访问
-            if (visited.find(neighborPos) != visited.end()) {
+        for (const NeighborOffset& offset : NEIGHBOR_OFFSETS) {
+            const int32_t ny = y + offset.dy;
+            if (ny < MIN_Y || ny > MAX_Y) {
                 continue;
             }
-            visited.insert(neighborPos);
+            const int32_t nx = x + offset.dx;
+            const int32_t nz = z + offset.dz;
+            const uint8_t neighborLevel = readLevel(ch, nx, ny, nz, sky);
+            if (neighborLevel == 0) {
+                continue;
+            }
+            const PackedNode neighbor = withLevel(node + static_cast<uint64_t>(offset.packed), neighborLevel);
+            const uint8_t provided = attenuate(level, getOpacity(BlockPos(nx, ny, nz)), sky && offset.dy < 0);
             
-            uint8_t neighborLevel = getLightLevel(neighborPos, type);
+            if (neighborLevel > provided) {
+                // 邻居的光来自别处，作为补光的起点
+                ch.increaseQueue.push_back(neighbor);
+                continue;
+            }
             
-            // 如果相邻方块的光照级别小于等于当前级别，需要重新计算
-            if (neighborLevel != 0 && neighborLevel <= currentLevel) {
-                // 检查是否还有其他光源可以维持该位置的光照
-                uint8_t maintainedLevel = 0;
-                
-                // 检查相邻方块是否可以提供光照
-                std::vector<BlockPos> neighborNeighbors = getNeighbors(neighborPos);
-                for (const BlockPos& neighborNeighborPos : neighborNeighbors) {
-                    uint8_t neighborNeighborLevel = getLightLevel(neighborNeighborPos, type);
-                    if (neighborNeighborLevel > 0) {
-                        uint8_t opacity = getOpacity(neighborPos);
-                        uint8_t potentialLevel = (neighborNeighborLevel > opacity) ? (neighborNeighborLevel - opacity) : 0;
-                        maintainedLevel = std::max(maintainedLevel, potentialLevel);
-                    }
-                }
-                
-                // 检查光源
-                LightMap& lightSources = (type == LightType::BLOCK) ? blockLightSources : skyLightSources;
-                auto sourceIt = lightSources.find(neighborPos);
-                if (sourceIt != lightSources.end()) {
-                    maintainedLevel = std::max(maintainedLevel, sourceIt->second);
-                }
-                
-                // 如果无法维持当前光照级别，则移除
-                if (maintainedLevel < neighborLevel) {
-                    lightMap.erase(neighborPos);
-                    
-                    // 如果该位置的光照级别大于1，继续传播减少
-                    if (neighborLevel > 1) {
-                        bfsQueue.emplace(neighborPos, neighborLevel);
-                    }
-                } else if (maintainedLevel > neighborLevel) {
-                    // 如果可以维持更高的光照级别，更新并传播增加
-                    lightMap[neighborPos] = maintainedLevel;
-                    updateQueue.emplace(neighborPos, maintainedLevel, LightPropagationDirection::INCREASE);
-                    pendingPositions.insert(neighborPos);
-                }
+            // 邻居可能由被移除的光照亮：清除并继续向外移除；光源保留自身级别并重新补光
+            auto sourceIt = ch.sources.find(BlockPos(nx, ny, nz));
+            if (sourceIt != ch.sources.end()) {
+                writeLevel(ch, nx, ny, nz, sourceIt->second, sky);
+                ch.increaseQueue.push_back(withLevel(neighbor, sourceIt->second));
+            } else {
+                writeLevel(ch, nx, ny, nz, 0, sky);
             }
+            queue.push_back(neighbor);
         }
     }
+    queue.clear();
 }
 
 uint8_t LightUpdater::getOpacity(const BlockPos& pos) const {
-    // 根据Minecraft 1.21.8的光照系统，透明方块（如空气）阻隔为0-1，不透明方块阻隔为15
-    // 实际实现中会根据方块类型返回具体的阻隔值
-    if (isTransparent(pos)) {
-        // 空气等略微减少光照（根据Minecraft标准，透明方块通常减少1级光照）
-        return 1; 
-    } else {
-        // 不透明方块完全阻隔光照
-        return 15; 
+    // 透明方块（如空气）阻隔为0，不透明方块阻隔为15；每格的最小衰减1由传播过程处理
+    if (!LightOpacityTable::isInitialized()) {
+        return 0;
     }
+    return LightOpacityTable::getOpacity(getBlockTypeFromWorldData(pos));
 }
 
 bool LightUpdater::isTransparent(const BlockPos& pos) const {
-    // 通过JNI调用访问真实的Minecraft世界数据来获取方块透明度
-    
-    // 临时实现：返回默认值以避免JNI复杂性
-    // TODO: 在完整的Minecraft环境中实现真正的透明度检测
-    return true; // 假设所有方块都是透明的（简化实现）
+    return getOpacity(pos) == 0;
 }
 
 int LightUpdater::getBlockTypeFromWorldData(const BlockPos& pos) const {
-    // 通过JNI调用访问真实的Minecraft世界数据来获取方块类型
-    // 注意：这个函数需要一个指向世界对象的引用，实际实现中应该通过参数传递
-    
-    // 临时实现：返回默认值以避免JNI复杂性
-    // TODO: 在完整的Minecraft环境中实现真正的方块类型检测
-    return 0; // 默认返回空气方块类型（简化实现）
+    if (blockReader.snapshot()) {
+        return blockReader.get(pos.x, pos.y, pos.z);
+    }
+    // 传播之外的单次查询直接读当前快照
+    return BlockStateStore::instance().snapshot()->get(pos.x, pos.y, pos.z);
 }
 
 } // namespace world
@@ -2,11 +2,12 @@
 
 #include <cstdint>
 #include <memory>
+#include <array>
 #include <vector>
-#include <queue>
-#include <unordered_set>
 #include <unordered_map>
 #include <functional>
+#include "advanced_light_engine.hpp"
+#include "block_state_store.hpp"
 
 // 前向声明JNI相关类型
 class JNIEnv;
@@ -65,24 +66,28 @@ struct BlockPosHash {
     }
 };
 
-// 光照更新任务
-struct LightUpdateTask {
-    BlockPos pos;
-    uint8_t lightLevel;
-    LightPropagationDirection direction;
-    LightType type;
-    
-    LightUpdateTask(const BlockPos& pos, uint8_t lightLevel, LightPropagationDirection direction, LightType type = LightType::BLOCK)
-        : pos(pos), lightLevel(lightLevel), direction(direction), type(type) {}
-};
-
-// 高性能光照更新器
+/**
+ * 高性能光照更新器
+ *
+ * 光照值存放在ChunkedLightStorage的区块段nibble数组中（均匀段只占一个值），
+ * 传播使用Starlight式的数组BFS：队列元素是打包了坐标与光照级别的uint64，
+ * 邻居由预先计算的打包偏移直接相加得到，传播过程中不分配内存（队列复用容量）。
+ * 最近访问的区块段被缓存，同一段内的连续访问不查哈希表。
+ *
+ * 每次衰减为max(1, 透光值)；天空光向下穿过透光值为0的方块不衰减。
+ * 透光值取自BlockStateStore的快照（每次propagateLightUpdates开始时取一次）与LightOpacityTable的
+ * 方块状态表；透光表未上传时所有方块按透光处理。
+ * 坐标范围：|x|、|z| < 2^24 - 16，MIN_Y <= y <= MAX_Y，超出范围的光源被忽略。
+ */
 class LightUpdater {
 public:
+    static constexpr int32_t MIN_Y = -64;
+    static constexpr int32_t MAX_Y = 319;
+    
     LightUpdater();
     ~LightUpdater();
 
-    // 设置方块光级别
+    // 设置方块光级别（直接写入，不传播）
     void setLightLevel(const BlockPos& pos, uint8_t level, LightType type);
     
     // 获取方块光级别
@@ -94,35 +99,107 @@ public:
     // 移除光照源
     void removeLightSource(const BlockPos& pos, LightType type);
     
-    // 执行光照更新
+    // 执行光照更新（先处理减少，再处理增加）
     void propagateLightUpdates();
     
     // 检查是否需要更新
     bool hasUpdates() const;
+    
+    // 光照数据（供引擎或序列化直接读取区块段）
+    const ChunkedLightStorage& getStorage() const { return storage; }
 
 private:
-    // 光照数据存储
-    using LightMap = std::unordered_map<BlockPos, uint8_t, BlockPosHash>;
-    
-    LightMap blockLightMap;
-    LightMap skyLightMap;
-    LightMap blockLightSources;
-    LightMap skyLightSources;
+    /**
+     * BFS队列元素：| x+2^24 (25位) | z+2^24 (25位) | y+512 (10位) | level (4位) |
+     * 各字段带偏置存放为无符号数，邻居坐标直接加上打包的偏移即可（BFS半径不超过15，不会越过字段）
+     */
+    using PackedNode = uint64_t;
+    
+    static constexpr int LEVEL_BITS = 4;
+    static constexpr int Y_SHIFT = LEVEL_BITS;
+    static constexpr int Y_BITS = 10;
+    static constexpr int Z_SHIFT = Y_SHIFT + Y_BITS;
+    static constexpr int XZ_BITS = 25;
+    static constexpr int X_SHIFT = Z_SHIFT + XZ_BITS;
+    static constexpr int64_t Y_BIAS = int64_t{1} << (Y_BITS - 1);
+    static constexpr int64_t XZ_BIAS = int64_t{1} << (XZ_BITS - 1);
+    static constexpr int32_t XZ_LIMIT = static_cast<int32_t>(XZ_BIAS) - 16;
+    
+    static constexpr PackedNode packNode(int32_t x, int32_t y, int32_t z, uint8_t level) {
+        return (static_cast<uint64_t>(x + XZ_BIAS) << X_SHIFT) |
+               (static_cast<uint64_t>(z + XZ_BIAS) << Z_SHIFT) |
+               (static_cast<uint64_t>(y + Y_BIAS) << Y_SHIFT) | (level & 0x0F);
+    }
+    static constexpr int32_t nodeX(PackedNode node) {
+        return static_cast<int32_t>(static_cast<int64_t>(node >> X_SHIFT) - XZ_BIAS);
+    }
+    static constexpr int32_t nodeZ(PackedNode node) {
+        return static_cast<int32_t>(static_cast<int64_t>((node >> Z_SHIFT) & ((1ull << XZ_BITS) - 1)) - XZ_BIAS);
+    }
+    static constexpr int32_t nodeY(PackedNode node) {
+        return static_cast<int32_t>(static_cast<int64_t>((node >> Y_SHIFT) & ((1ull << Y_BITS) - 1)) - Y_BIAS);
+    }
+    static constexpr uint8_t nodeLevel(PackedNode node) { return static_cast<uint8_t>(node & 0x0F); }
+    static constexpr PackedNode withLevel(PackedNode node, uint8_t level) {
+        return (node & ~PackedNode{0x0F}) | (level & 0x0F);
+    }
     
-    // 更新队列
-    std::queue<LightUpdateTask> updateQueue;
+    // 6个方向（东西、上下、南北）的坐标偏移与对应的打包偏移
+    struct NeighborOffset {
+        int32_t dx, dy, dz;
+        int64_t packed;
+    };
+    static constexpr std::array<NeighborOffset, 6> NEIGHBOR_OFFSETS = {{
+        { 1,  0,  0,  int64_t{1} << X_SHIFT},
+        {-1,  0,  0, -(int64_t{1} << X_SHIFT)},
+        { 0,  1,  0,  int64_t{1} << Y_SHIFT},
+        { 0, -1,  0, -(int64_t{1} << Y_SHIFT)},
+        { 0,  0,  1,  int64_t{1} << Z_SHIFT},
+        { 0,  0, -1, -(int64_t{1} << Z_SHIFT)}
+    }};
+    
+    // 一种光照（方块光或天空光）的光源与BFS队列
+    struct LightChannel {
+        std::unordered_map<BlockPos, uint8_t, BlockPosHash> sources;
+        std::vector<PackedNode> increaseQueue;
+        std::vector<PackedNode> decreaseQueue;
+        
+        // 最近访问的区块段；段存放在unordered_map节点中，指针在插入其他段后仍然有效
+        int32_t cachedX = 0, cachedY = 0, cachedZ = 0;
+        CompactLightStorage* cachedSection = nullptr;
+        bool cacheValid = false;
+        
+        CompactLightStorage* section(ChunkedLightStorage& storage, int32_t x, int32_t y, int32_t z,
+                                     bool create, bool sky);
+    };
+    
+    // 方块光与天空光分别存放在storage的两张表中
+    ChunkedLightStorage storage;
+    LightChannel blockChannel;
+    LightChannel skyChannel;
+    
+    // 本次传播读取的方块状态快照，传播结束后释放
+    std::shared_ptr<const BlockStateSnapshot> blocks;
+    mutable BlockStateSnapshot::Reader blockReader;
+    
+    LightChannel& channel(LightType type) { return type == LightType::BLOCK ? blockChannel : skyChannel; }
+    const LightChannel& channel(LightType type) const {
+        return type == LightType::BLOCK ? blockChannel : skyChannel;
+    }
     
-    // 需要更新的位置集合
-    std::unordered_set<BlockPos, BlockPosHash> pendingPositions;
+    static bool inBounds(const BlockPos& pos) {
+        return pos.y >= MIN_Y && pos.y <= MAX_Y && pos.x > -XZ_LIMIT && pos.x < XZ_LIMIT &&
+               pos.z > -XZ_LIMIT && pos.z < XZ_LIMIT;
+    }
     
-    // 获取相邻方块
-    std::vector<BlockPos> getNeighbors(const BlockPos& pos) const;
+    uint8_t readLevel(LightChannel& ch, int32_t x, int32_t y, int32_t z, bool sky);
+    void writeLevel(LightChannel& ch, int32_t x, int32_t y, int32_t z, uint8_t level, bool sky);
     
     // 传播光照增加
-    void propagateIncrease(const BlockPos& pos, uint8_t level, LightType type);
+    void propagateIncrease(LightChannel& ch, bool sky);
     
-    // 传播光照减少
-    void propagateDecrease(const BlockPos& pos, uint8_t level, LightType type);
+    // 传播光照减少（需要重新补光的位置放入increaseQueue）
+    void propagateDecrease(LightChannel& ch, bool sky);
     
     // 获取光照阻隔级别（0-15，数字越大阻隔越强）
     uint8_t getOpacity(const BlockPos& pos) const;
@@ -130,7 +207,7 @@ private:
     // 检查方块是否为空气/可穿透
     bool isTransparent(const BlockPos& pos) const;
     
-    // 从世界数据中获取方块类型
+    // 方块状态id（Block.BLOCK_STATE_REGISTRY），未载入的位置为空气
     int getBlockTypeFromWorldData(const BlockPos& pos) const;
 };
 
@@ -0,0 +1,130 @@
+#include "path_scheduler.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace lattice {
+namespace world {
+
+PathScheduler::PathScheduler(PathfinderOptimizer& optimizer, uint32_t tick_budget, uint32_t slice)
+    : optimizer(optimizer), tick_budget(std::max<uint32_t>(tick_budget, 1)), slice(std::max<uint32_t>(slice, 1)) {}
+
+PathScheduler& PathScheduler::get_instance() {
+    static PathScheduler instance(PathfinderOptimizer::get_instance());
+    return instance;
+}
+
+void PathScheduler::set_budget(uint32_t new_tick_budget, uint32_t new_slice) {
+    tick_budget = std::max<uint32_t>(new_tick_budget, 1);
+    slice = std::max<uint32_t>(new_slice, 1);
+}
+
+void PathScheduler::set_players(std::vector<Node> new_players) {
+    players = std::move(new_players);
+}
+
+void PathScheduler::submit(const PathRequest& request) {
+    stats.submitted.fetch_add(1, std::memory_order_relaxed);
+    cancel(request.request_id);
+    queued.push_back(request);
+}
+
+void PathScheduler::cancel(uint64_t request_id) {
+    auto same = [request_id](uint64_t id) { return id == request_id; };
+    const size_t before = queued.size() + active.size();
+    queued.erase(std::remove_if(queued.begin(), queued.end(),
+                                [&](const PathRequest& entry) { return same(entry.request_id); }),
+                 queued.end());
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [&](const Active& entry) { return same(entry.request_id); }),
+                 active.end());
+    if (queued.size() + active.size() != before) {
+        stats.superseded.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+double PathScheduler::distance_to_players(const Node& node) const {
+    if (players.empty()) {
+        return 0.0;
+    }
+    double nearest = std::numeric_limits<double>::infinity();
+    for (const Node& player : players) {
+        const double dx = node.x - player.x;
+        const double dy = node.y - player.y;
+        const double dz = node.z - player.z;
+        nearest = std::min(nearest, dx * dx + dy * dy + dz * dz);
+    }
+    return nearest;
+}
+
+void PathScheduler::start_queued() {
+    while (!queued.empty() && active.size() < MAX_ACTIVE_SEARCHES) {
+        const PathRequest request = queued.front();
+        queued.pop_front();
+        Active entry;
+        entry.request_id = request.request_id;
+        entry.search = optimizer.begin_search(request.start, request.goal, request.mob_type, request.max_nodes);
+        active.push_back(std::move(entry));
+    }
+}
+
+void PathScheduler::tick() {
+    start_queued();
+    if (active.empty()) {
+        return;
+    }
+
+    for (auto& entry : active) {
+        entry.priority = distance_to_players(entry.search->start()) / (1.0 + entry.waiting);
+    }
+    // 稳定排序：优先级相同时按开始顺序
+    std::stable_sort(active.begin(), active.end(),
+                     [](const Active& a, const Active& b) { return a.priority < b.priority; });
+
+    uint32_t remaining = tick_budget;
+    for (auto& entry : active) {
+        if (entry.search->done()) {
+            continue;   // 路径缓存命中，不占预算
+        }
+        if (remaining == 0) {
+            ++entry.waiting;
+            continue;
+        }
+        const uint32_t before = entry.search->nodes_expanded();
+        entry.search->step(std::min(slice, remaining));
+        const uint32_t used = entry.search->nodes_expanded() - before;
+        remaining -= std::min(used, remaining);
+        entry.waiting = 0;
+        ++entry.ticks;
+        stats.slices.fetch_add(1, std::memory_order_relaxed);
+        stats.nodes_expanded.fetch_add(used, std::memory_order_relaxed);
+    }
+
+    bool waiting = false;
+    for (auto& entry : active) {
+        if (!entry.search->done()) {
+            waiting = true;
+            continue;
+        }
+        ready.push_back(PathServiceResult{entry.request_id, entry.search->result(), false});
+        stats.completed.fetch_add(1, std::memory_order_relaxed);
+        uint64_t longest = stats.max_ticks.load(std::memory_order_relaxed);
+        if (entry.ticks > longest) {
+            stats.max_ticks.store(entry.ticks, std::memory_order_relaxed);
+        }
+    }
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [](const Active& entry) { return entry.search->done(); }),
+                 active.end());
+    if (waiting && remaining == 0) {
+        stats.budget_exhausted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<PathServiceResult> PathScheduler::poll_results() {
+    return std::exchange(ready, {});
+}
+
+} // namespace world
+} // namespace lattice
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "path_service.hpp"
+#include "pathfinder.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace world {
+
+/**
+ * PathScheduler - 按tick分片执行的寻路
+ *
+ * 每个请求对应一个PathSearch，在主线程的tick()中推进：每个搜索每tick最多展开slice个节点，
+ * 所有搜索共用每tick tick_budget个节点的总预算，离玩家近的先分配。预算用完时剩下的搜索
+ * 留到下一tick继续，单次搜索不会再一次性展开上千个节点。
+ *
+ * 优先级为起点到最近玩家距离的平方除以(1 + 连续未分到预算的tick数)，远处的搜索不会一直饿死。
+ * 同时进行的搜索数不超过MAX_ACTIVE_SEARCHES（每个搜索持有自己的节点池），其余排队。
+ * 搜索在开始时的快照上进行，跨tick期间的方块变化不影响进行中的搜索。
+ */
+class PathScheduler {
+public:
+    static constexpr uint32_t DEFAULT_TICK_BUDGET = 4096;   // 每tick所有搜索共展开的节点数
+    static constexpr uint32_t DEFAULT_SLICE = 256;          // 每个搜索每tick最多展开的节点数
+    static constexpr size_t MAX_ACTIVE_SEARCHES = 256;
+
+    explicit PathScheduler(PathfinderOptimizer& optimizer, uint32_t tick_budget = DEFAULT_TICK_BUDGET,
+                           uint32_t slice = DEFAULT_SLICE);
+
+    PathScheduler(const PathScheduler&) = delete;
+    PathScheduler& operator=(const PathScheduler&) = delete;
+
+    void set_budget(uint32_t tick_budget, uint32_t slice);
+    // 玩家位置（每tick更新一次即可），没有玩家时按提交顺序
+    void set_players(std::vector<Node> players);
+
+    // 同一request_id重复提交时替换进行中的搜索
+    void submit(const PathRequest& request);
+    void cancel(uint64_t request_id);
+
+    // 每tick调用一次（主线程）：按优先级推进搜索，完成的结果转为可取出状态
+    void tick();
+
+    std::vector<PathServiceResult> poll_results();
+    // 格式同PathService::write_results
+    size_t write_results(uint8_t* out, size_t capacity, size_t& written) {
+        return PathService::write_results(ready, out, capacity, written);
+    }
+
+    size_t ready_count() const { return ready.size(); }
+    // 进行中与排队的请求数
+    size_t in_flight() const { return active.size() + queued.size(); }
+
+    struct Stats {
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> completed{0};
+        std::atomic<uint64_t> superseded{0};        // 被重新提交或取消而丢弃
+        std::atomic<uint64_t> slices{0};            // 分配出的分片数
+        std::atomic<uint64_t> nodes_expanded{0};
+        std::atomic<uint64_t> budget_exhausted{0};  // 预算用完、仍有搜索等待的tick数
+        std::atomic<uint64_t> max_ticks{0};         // 单个搜索跨越的最多tick数
+    };
+    const Stats& get_stats() const { return stats; }
+
+    static PathScheduler& get_instance();
+
+private:
+    struct Active {
+        uint64_t request_id;
+        std::unique_ptr<PathSearch> search;
+        uint32_t waiting = 0;   // 连续未分到预算的tick数
+        uint32_t ticks = 0;     // 已推进的tick数
+        double priority = 0.0;
+    };
+
+    void start_queued();
+    double distance_to_players(const Node& node) const;
+
+    PathfinderOptimizer& optimizer;
+    uint32_t tick_budget;
+    uint32_t slice;
+    std::vector<Node> players;
+
+    std::deque<PathRequest> queued;
+    std::vector<Active> active;
+    std::vector<PathServiceResult> ready;
+
+    Stats stats;
+};
+
+} // namespace world
+} // namespace lattice
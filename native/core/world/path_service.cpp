@@ -0,0 +1,245 @@
+#include "path_service.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace lattice {
+namespace world {
+
+namespace {
+
+uint64_t pack_node(const Node& node) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(node.x) & 0x3FFFFFF) << 38) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(node.z) & 0x3FFFFFF) << 12) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(node.y) & 0xFFF));
+}
+
+// 分组键：目标、生物类型、节点上限
+struct GroupKey {
+    uint64_t goal;
+    MobType mob_type;
+    uint32_t max_nodes;
+
+    bool operator==(const GroupKey& other) const {
+        return goal == other.goal && mob_type == other.mob_type && max_nodes == other.max_nodes;
+    }
+};
+
+struct GroupKeyHash {
+    size_t operator()(const GroupKey& key) const {
+        return static_cast<size_t>((key.goal ^ (static_cast<uint64_t>(key.mob_type) << 59) ^
+                                    (static_cast<uint64_t>(key.max_nodes) << 32)) *
+                                   0x9E3779B97F4A7C15ULL);
+    }
+};
+
+} // namespace
+
+PathService::PathService(PathfinderOptimizer& optimizer, size_t worker_count)
+    : optimizer(optimizer),
+      hierarchical(optimizer),
+      workers(core::NativeRuntime::instance().createPool(core::NativeSubsystem::PATHFINDING, worker_count)) {}
+
+PathService::~PathService() {
+    // 等待已派发的批次完成后再销毁结果容器
+    workers.reset();
+}
+
+PathService& PathService::get_instance() {
+    static PathService instance(PathfinderOptimizer::get_instance());
+    return instance;
+}
+
+void PathService::submit(const PathRequest& request) {
+    const uint64_t sequence = next_sequence++;
+    auto [it, inserted] = latest.try_emplace(request.request_id, sequence);
+    if (!inserted) {
+        it->second = sequence;
+        stats.superseded.fetch_add(1, std::memory_order_relaxed);
+        // 本tick内重复提交：直接替换尚未派发的请求
+        for (auto& entry : pending) {
+            if (entry.request.request_id == request.request_id) {
+                entry = Submitted{request, sequence};
+                stats.submitted.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+    }
+    pending.push_back(Submitted{request, sequence});
+    stats.submitted.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PathService::cancel(uint64_t request_id) {
+    if (latest.erase(request_id) == 0) {
+        return;
+    }
+    stats.superseded.fetch_add(1, std::memory_order_relaxed);
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [request_id](const Submitted& entry) {
+                                     return entry.request.request_id == request_id;
+                                 }),
+                  pending.end());
+}
+
+void PathService::tick() {
+    // 1. 交付上一批（及更早）已完成的结果，丢弃被取消或重新提交的
+    std::vector<Completed> finished;
+    {
+        std::lock_guard<std::mutex> lock(completed_mutex);
+        finished.swap(completed);
+    }
+    for (auto& entry : finished) {
+        auto it = latest.find(entry.result.request_id);
+        if (it == latest.end() || it->second != entry.sequence) {
+            continue;
+        }
+        latest.erase(it);
+        ready.push_back(std::move(entry.result));
+        stats.delivered.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 2. 按目标分组派发本tick的请求，整批共用同一个不可变快照
+    if (pending.empty()) {
+        return;
+    }
+    std::unordered_map<GroupKey, std::vector<Submitted>, GroupKeyHash> groups;
+    for (auto& entry : pending) {
+        const GroupKey key{pack_node(entry.request.goal), entry.request.mob_type, entry.request.max_nodes};
+        groups[key].push_back(std::move(entry));
+    }
+    pending.clear();
+
+    auto snapshot = optimizer.snapshot();
+    for (auto& [key, group] : groups) {
+        workers->enqueue([this, snapshot, batch = std::move(group)]() mutable {
+            solve_group(snapshot, std::move(batch));
+        });
+    }
+    stats.batches.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<PathServiceResult> PathService::poll_results(size_t max_results) {
+    if (max_results == 0 || max_results >= ready.size()) {
+        return std::exchange(ready, {});
+    }
+    std::vector<PathServiceResult> results(std::make_move_iterator(ready.begin()),
+                                           std::make_move_iterator(ready.begin() + static_cast<ptrdiff_t>(max_results)));
+    ready.erase(ready.begin(), ready.begin() + static_cast<ptrdiff_t>(max_results));
+    return results;
+}
+
+size_t PathService::write_results(std::vector<PathServiceResult>& results, uint8_t* out, size_t capacity,
+                                  size_t& written) {
+    written = 0;
+    size_t count = 0;
+    for (; count < results.size(); ++count) {
+        const PathServiceResult& result = results[count];
+        const size_t size = result_size(result);
+        if (written + size > capacity) {
+            break;
+        }
+        uint8_t* cursor = out + written;
+        const int64_t id = static_cast<int64_t>(result.request_id);
+        const int32_t header[2] = {
+            (result.path.reached ? 1 : 0) | (result.shared ? 2 : 0),
+            static_cast<int32_t>(result.path.nodes.size()),
+        };
+        std::memcpy(cursor, &id, sizeof(id));
+        std::memcpy(cursor + 8, header, sizeof(header));
+        cursor += 16;
+        for (const Node& node : result.path.nodes) {
+            const int32_t position[3] = {node.x, node.y, node.z};
+            std::memcpy(cursor, position, sizeof(position));
+            cursor += sizeof(position);
+        }
+        written += size;
+    }
+    results.erase(results.begin(), results.begin() + static_cast<ptrdiff_t>(count));
+    return count;
+}
+
+size_t PathService::in_flight() const {
+    return latest.size();
+}
+
+void PathService::solve_group(const std::shared_ptr<const SectionBlockSnapshot>& snapshot,
+                              std::vector<Submitted> group) {
+    const Node goal = group.front().request.goal;
+    const MobType mob_type = group.front().request.mob_type;
+    const uint32_t max_nodes = group.front().request.max_nodes;
+
+    // 离目标远的先搜索，近处的起点更可能落在已找到的路径上
+    auto distance = [&goal](const Node& node) {
+        const int64_t dx = node.x - goal.x;
+        const int64_t dy = node.y - goal.y;
+        const int64_t dz = node.z - goal.z;
+        return dx * dx + dy * dy + dz * dz;
+    };
+    std::sort(group.begin(), group.end(), [&distance](const Submitted& a, const Submitted& b) {
+        return distance(a.request.start) > distance(b.request.start);
+    });
+
+    std::shared_ptr<const FlowField> field;
+    if (group.size() >= FLOW_FIELD_GROUP_SIZE) {
+        field = optimizer.get_flow_field(*snapshot, goal, mob_type);
+    }
+
+    std::vector<PathResult> searches;
+    std::unordered_map<uint64_t, std::pair<size_t, size_t>> on_path;   // 位置 -> (搜索下标, 路径下标)
+    std::unordered_map<uint64_t, size_t> by_start;
+
+    std::vector<Completed> results;
+    results.reserve(group.size());
+    for (const auto& entry : group) {
+        const uint64_t start = pack_node(entry.request.start);
+        PathServiceResult result;
+        result.request_id = entry.request.request_id;
+
+        if (auto same = by_start.find(start); same != by_start.end()) {
+            result.path = searches[same->second];
+            result.shared = true;
+            stats.deduplicated.fetch_add(1, std::memory_order_relaxed);
+        } else if (auto hit = on_path.find(start); hit != on_path.end()) {
+            const PathResult& source = searches[hit->second.first];
+            result.path.nodes.assign(source.nodes.begin() + static_cast<ptrdiff_t>(hit->second.second),
+                                     source.nodes.end());
+            result.path.reached = true;
+            result.shared = true;
+            stats.suffix_reused.fetch_add(1, std::memory_order_relaxed);
+        } else if (std::vector<Node> traced = field ? field->trace(entry.request.start) : std::vector<Node>{};
+                   !traced.empty()) {
+            result.path.nodes = std::move(traced);
+            result.path.reached = true;
+            result.shared = true;
+            stats.flow_field.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            constexpr int64_t long_range = int64_t{HierarchicalPathfinder::MIN_DISTANCE} *
+                                           HierarchicalPathfinder::MIN_DISTANCE;
+            if (distance(entry.request.start) >= long_range) {
+                result.path = hierarchical.find_path(*snapshot, entry.request.start, goal, mob_type);
+                stats.hierarchical.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                result.path = optimizer.find_path(*snapshot, entry.request.start, goal, mob_type, max_nodes);
+            }
+            stats.searches.fetch_add(1, std::memory_order_relaxed);
+            const size_t index = searches.size();
+            searches.push_back(result.path);
+            by_start.emplace(start, index);
+            if (result.path.reached) {
+                for (size_t i = 1; i < result.path.nodes.size(); ++i) {
+                    on_path.try_emplace(pack_node(result.path.nodes[i]), index, i);
+                }
+            }
+        }
+        results.push_back(Completed{entry.sequence, std::move(result)});
+    }
+
+    std::lock_guard<std::mutex> lock(completed_mutex);
+    for (auto& entry : results) {
+        completed.push_back(std::move(entry));
+    }
+}
+
+} // namespace world
+} // namespace lattice
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "hierarchical_pathfinder.hpp"
+#include "pathfinder.hpp"
+#include "../native_runtime.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice {
+namespace world {
+
+// 寻路请求（request_id由Java分配，通常为实体id）
+struct PathRequest {
+    uint64_t request_id = 0;
+    Node start;
+    Node goal;
+    MobType mob_type = MobType::PASSIVE;
+    uint32_t max_nodes = PathfinderOptimizer::DEFAULT_MAX_NODES;
+};
+
+struct PathServiceResult {
+    uint64_t request_id = 0;
+    PathResult path;
+    bool shared = false;   // 结果来自同批次的另一次搜索（相同请求或同目标路径的后缀）
+};
+
+/**
+ * PathService - 异步批量寻路
+ *
+ * 主线程在tick内submit请求；tick()把这一批请求连同当时的方块快照交给工作线程，
+ * 本身不做任何搜索。工作线程完成后的结果在之后的tick()中转为可取出状态，
+ * 因此结果最早在下一tick交付（生物可以容忍一tick的延迟）。
+ *
+ * 去重：同一批次中目标、生物类型和节点上限相同的请求分为一组，由一个工作线程依次处理：
+ * 起点相同的请求只搜索一次；起点落在组内已到达目标的路径上时直接取该路径的后缀。
+ * 同一request_id重复提交时只保留最后一次，旧请求的结果被丢弃。
+ * 起终点距离达到HierarchicalPathfinder::MIN_DISTANCE时走分层寻路。
+ * 一组中的请求达到FLOW_FIELD_GROUP_SIZE时改用目标的方向场，每个起点沿场取路径，
+ * 起点不在场内（超出范围或不可达）的再单独搜索。
+ */
+class PathService {
+public:
+    static constexpr size_t FLOW_FIELD_GROUP_SIZE = 8;
+
+    // worker_count为0时按NativeRuntime的线程预算选择
+    explicit PathService(PathfinderOptimizer& optimizer, size_t worker_count = 0);
+    ~PathService();
+
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+
+    void submit(const PathRequest& request);
+    // 取消尚未交付的请求
+    void cancel(uint64_t request_id);
+
+    // 每tick调用一次（主线程）：交付已完成的结果，派发本tick提交的请求
+    void tick();
+
+    // 取出已交付的结果；max_results为0表示全部
+    std::vector<PathServiceResult> poll_results(size_t max_results = 0);
+
+    /**
+     * 把已交付的结果按顺序写入out（主机字节序）并从队列移除，写不下的留到下次
+     * 每条: int64 request_id, int32 flags(bit0到达目标, bit1共享结果), int32 节点数n, n * (int32 x, y, z)
+     * 返回写入的结果数，written为写入字节数
+     */
+    size_t write_results(uint8_t* out, size_t capacity, size_t& written) {
+        return write_results(ready, out, capacity, written);
+    }
+    // 按上述格式写出results开头能放下的部分并从results移除
+    static size_t write_results(std::vector<PathServiceResult>& results, uint8_t* out, size_t capacity,
+                                size_t& written);
+    static size_t result_size(const PathServiceResult& result) { return 16 + result.path.nodes.size() * 12; }
+
+    // 已交付、等待取出的结果数
+    size_t ready_count() const { return ready.size(); }
+    // 已提交但尚未交付的请求数
+    size_t in_flight() const;
+
+    struct Stats {
+        std::atomic<uint64_t> submitted{0};
+        std::atomic<uint64_t> searches{0};          // 实际执行的搜索次数
+        std::atomic<uint64_t> hierarchical{0};      // 其中走分层寻路的次数
+        std::atomic<uint64_t> deduplicated{0};      // 起点相同、共用一次搜索
+        std::atomic<uint64_t> suffix_reused{0};     // 取同目标路径的后缀
+        std::atomic<uint64_t> flow_field{0};        // 沿方向场取路径
+        std::atomic<uint64_t> superseded{0};        // 被重新提交或取消而丢弃
+        std::atomic<uint64_t> batches{0};
+        std::atomic<uint64_t> delivered{0};
+    };
+    const Stats& get_stats() const { return stats; }
+
+    static PathService& get_instance();
+
+private:
+    struct Submitted {
+        PathRequest request;
+        uint64_t sequence;
+    };
+
+    struct Completed {
+        uint64_t sequence;
+        PathServiceResult result;
+    };
+
+    // 在工作线程上处理一组同目标的请求
+    void solve_group(const std::shared_ptr<const SectionBlockSnapshot>& snapshot,
+                     std::vector<Submitted> group);
+
+    PathfinderOptimizer& optimizer;
+    HierarchicalPathfinder hierarchical;
+
+    // 主线程状态
+    std::vector<Submitted> pending;
+    std::unordered_map<uint64_t, uint64_t> latest;   // request_id -> 最新sequence
+    uint64_t next_sequence = 1;
+    std::vector<PathServiceResult> ready;
+
+    // 工作线程写入
+    mutable std::mutex completed_mutex;
+    std::vector<Completed> completed;
+
+    Stats stats;
+
+    // 最后声明：析构时先等待工作线程结束
+    std::unique_ptr<core::ThreadPool> workers;
+};
+
+} // namespace world
+} // namespace lattice
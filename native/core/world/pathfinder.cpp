@@ -1,32 +1,657 @@
 #include "pathfinder.hpp"
+#include "block_state_store.hpp"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace lattice {
 namespace world {
 
+namespace {
+
+constexpr uint32_t NO_NODE = UINT32_MAX;
+
+// 进入各类格子的附加代价
+constexpr float JUMP_COST = 0.5f;            // 向上跳一格
+constexpr float DROP_COST_PER_BLOCK = 0.5f;  // 每掉落一格
+constexpr float WATER_COST = 2.0f;           // 不会游泳的生物涉水
+constexpr float WATER_AVOID_COST = 8.0f;     // 避水生物涉水（对应原版WATER malus）
+constexpr float DIAGONAL_DISTANCE = 1.41421356f;
+
+bool is_passable(PathBlockType type) {
+    return type == PathBlockType::OPEN || type == PathBlockType::WATER;
+}
+
+// 节点位置键：x、z各26位，y 12位
+uint64_t pack_position(int x, int y, int z) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x) & 0x3FFFFFF) << 38) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(z) & 0x3FFFFFF) << 12) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(y) & 0xFFF));
+}
+
+} // namespace
+
+// ===== SectionBlockSnapshot =====
+
+PathBlockType SectionBlockSnapshot::get_block(int x, int y, int z) const {
+    auto it = sections.find(pack_section_key(x >> 4, y >> 4, z >> 4));
+    if (it == sections.end()) {
+        return PathBlockType::OPEN;
+    }
+    return it->second.blocks->get(static_cast<size_t>(((y & 15) << 8) | ((z & 15) << 4) | (x & 15)));
+}
+
+uint64_t SectionBlockSnapshot::section_version(int chunk_x, int section_y, int chunk_z) const {
+    auto it = sections.find(pack_section_key(chunk_x, section_y, chunk_z));
+    return it != sections.end() ? it->second.version : 0;
+}
+
+bool SectionBlockSnapshot::matches(const std::vector<SectionStamp>& stamps) const {
+    for (const SectionStamp& stamp : stamps) {
+        if (section_version(stamp.chunk_x, stamp.section_y, stamp.chunk_z) != stamp.version) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SectionBlockSnapshot::SectionBlocks::set(size_t index, PathBlockType type) {
+    types[index] = type;
+    const size_t row = index >> 4;
+    const auto bit = static_cast<uint16_t>(1u << (index & 15));
+    auto assign = [&](Layer layer, bool value) {
+        masks[layer][row] = value ? static_cast<uint16_t>(masks[layer][row] | bit)
+                                  : static_cast<uint16_t>(masks[layer][row] & ~bit);
+    };
+    assign(PASSABLE, is_passable(type));
+    assign(SOLID, type == PathBlockType::SOLID);
+    assign(WATER, type == PathBlockType::WATER);
+}
+
+void SectionBlockSnapshot::SectionBlocks::fill(PathBlockType type) {
+    types.fill(type);
+    masks[PASSABLE].fill(is_passable(type) ? 0xFFFF : 0);
+    masks[SOLID].fill(type == PathBlockType::SOLID ? 0xFFFF : 0);
+    masks[WATER].fill(type == PathBlockType::WATER ? 0xFFFF : 0);
+}
+
+// ===== 搜索工作区 =====
+
+/**
+ * 单线程的A*工作区：节点池、位置哈希表和开放列表堆在多次搜索之间复用，不在搜索中分配。
+ * 哈希表用代数标记空槽，开始新搜索时不需要清空。
+ */
+// 每个分帧搜索各有一个，随搜索创建和释放
+class PathfinderOptimizer::SearchContext : public core::SlabAllocated {
+public:
+    std::vector<PathNode> nodes;
+    std::vector<uint32_t> heap;
+    bool budget_hit = false;
+    bool jump_points = false;   // 节点之间可能相隔多格（跳点搜索），重建路径时补全中间格
+
+    // 只读取方块、不搜索时使用
+    void bind(const SectionBlockSnapshot& snapshot) {
+        blocks = &snapshot;
+        section_cache.fill(CachedSection{});
+    }
+
+    void begin(const SectionBlockSnapshot& snapshot, uint32_t max_nodes) {
+        bind(snapshot);
+        limit = std::max<uint32_t>(max_nodes, 1);
+        nodes.clear();
+        nodes.reserve(limit);
+        heap.clear();
+        budget_hit = false;
+        jump_points = false;
+
+        size_t capacity = 16;
+        while (capacity < static_cast<size_t>(limit) * 2) {
+            capacity <<= 1;
+        }
+        if (slots.size() < capacity) {
+            slots.assign(capacity, Slot{});
+            generation = 0;
+        }
+        mask = slots.size() - 1;
+        if (++generation == 0) {
+            std::fill(slots.begin(), slots.end(), Slot{});
+            generation = 1;
+        }
+    }
+
+    using Layer = SectionBlockSnapshot::SectionBlocks::Layer;
+
+    // 段section_x中(y, z)行的掩码；没有上传的段按全OPEN
+    uint16_t row(Layer layer, int section_x, int y, int z) {
+        const SectionBlockSnapshot::SectionBlocks* section = find_section(section_x, y >> 4, z >> 4);
+        if (!section) {
+            return layer == SectionBlockSnapshot::SectionBlocks::PASSABLE ? 0xFFFF : 0;
+        }
+        return section->masks[layer][((y & 15) << 4) | (z & 15)];
+    }
+
+    bool test(Layer layer, int x, int y, int z) {
+        return (row(layer, x >> 4, y, z) >> (x & 15)) & 1u;
+    }
+
+    // (x - 1, x, x + 1)三格的位，bit0为x - 1；跨段时拼接相邻段的行
+    uint32_t window(Layer layer, int x, int y, int z) {
+        const int local = x & 15;
+        const uint32_t center = row(layer, x >> 4, y, z);
+        if (local >= 1 && local <= 14) {
+            return (center >> (local - 1)) & 7u;
+        }
+        if (local == 0) {
+            return ((center & 3u) << 1) | ((static_cast<uint32_t>(row(layer, (x >> 4) - 1, y, z)) >> 15) & 1u);
+        }
+        return ((center >> 14) & 3u) | ((static_cast<uint32_t>(row(layer, (x >> 4) + 1, y, z)) & 1u) << 2);
+    }
+
+    // 查找或创建位置对应的节点，节点池已满时返回NO_NODE
+    uint32_t get_or_create(int x, int y, int z, bool& created) {
+        const uint64_t key = pack_position(x, y, z);
+        size_t slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+        while (slots[slot].generation == generation) {
+            if (slots[slot].key == key) {
+                created = false;
+                return slots[slot].index;
+            }
+            slot = (slot + 1) & mask;
+        }
+        if (nodes.size() >= limit) {
+            budget_hit = true;
+            return NO_NODE;
+        }
+        const auto index = static_cast<uint32_t>(nodes.size());
+        nodes.emplace_back(x, y, z);
+        slots[slot] = Slot{key, index, generation};
+        created = true;
+        return index;
+    }
+
+    // ===== 二叉堆（按f排序，f相同时h小的优先），支持decrease-key =====
+
+    void push(uint32_t index) {
+        nodes[index].heap_index = static_cast<uint32_t>(heap.size());
+        heap.push_back(index);
+        sift_up(nodes[index].heap_index);
+    }
+
+    void decrease_key(uint32_t index) { sift_up(nodes[index].heap_index); }
+
+    uint32_t pop() {
+        const uint32_t top = heap.front();
+        nodes[top].heap_index = PathNode::NOT_IN_HEAP;
+        const uint32_t last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap[0] = last;
+            nodes[last].heap_index = 0;
+            sift_down(0);
+        }
+        return top;
+    }
+
+private:
+    struct Slot {
+        uint64_t key = 0;
+        uint32_t index = 0;
+        uint32_t generation = 0;
+    };
+
+    // 直接映射的段缓存：邻格窗口常跨段，单项缓存会在两段之间反复查表
+    struct CachedSection {
+        uint64_t key = UINT64_MAX;
+        const SectionBlockSnapshot::SectionBlocks* blocks = nullptr;
+    };
+    static constexpr size_t SECTION_CACHE_SIZE = 32;
+
+    const SectionBlockSnapshot::SectionBlocks* find_section(int section_x, int section_y, int section_z) {
+        const uint64_t key = SectionBlockSnapshot::pack_section_key(section_x, section_y, section_z);
+        CachedSection& entry =
+            section_cache[static_cast<size_t>((section_x & 3) | ((section_z & 3) << 2) | ((section_y & 1) << 4))];
+        if (entry.key != key) {
+            auto it = blocks->sections.find(key);
+            entry.blocks = it != blocks->sections.end() ? it->second.blocks.get() : nullptr;
+            entry.key = key;
+        }
+        return entry.blocks;
+    }
+
+    bool less(uint32_t a, uint32_t b) const {
+        const PathNode& na = nodes[a];
+        const PathNode& nb = nodes[b];
+        return na.f_cost < nb.f_cost || (na.f_cost == nb.f_cost && na.h_cost < nb.h_cost);
+    }
+
+    void place(uint32_t position, uint32_t index) {
+        heap[position] = index;
+        nodes[index].heap_index = position;
+    }
+
+    void sift_up(uint32_t position) {
+        const uint32_t index = heap[position];
+        while (position > 0) {
+            const uint32_t parent = (position - 1) / 2;
+            if (!less(index, heap[parent])) {
+                break;
+            }
+            place(position, heap[parent]);
+            position = parent;
+        }
+        place(position, index);
+    }
+
+    void sift_down(uint32_t position) {
+        const uint32_t index = heap[position];
+        const auto size = static_cast<uint32_t>(heap.size());
+        while (true) {
+            uint32_t child = position * 2 + 1;
+            if (child >= size) {
+                break;
+            }
+            if (child + 1 < size && less(heap[child + 1], heap[child])) {
+                ++child;
+            }
+            if (!less(heap[child], index)) {
+                break;
+            }
+            place(position, heap[child]);
+            position = child;
+        }
+        place(position, index);
+    }
+
+    const SectionBlockSnapshot* blocks = nullptr;
+    std::array<CachedSection, SECTION_CACHE_SIZE> section_cache;
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    uint32_t generation = 0;
+    uint32_t limit = 0;
+};
+
 // PathfinderOptimizer 实现
-PathfinderOptimizer::PathfinderOptimizer() {
+PathfinderOptimizer::PathfinderOptimizer() : blocks(std::make_shared<SectionBlockSnapshot>()) {
     // 初始化默认生物参数
-    mob_params[MobType::PASSIVE] = {0.5f, 3.0f, false, false, true, false, 1.0f};
-    mob_params[MobType::NEUTRAL] = {0.5f, 3.0f, false, false, false, false, 1.0f};
-    mob_params[MobType::HOSTILE] = {0.5f, 3.0f, false, false, false, false, 1.2f};
-    mob_params[MobType::WATER] = {0.5f, 1.0f, true, false, false, false, 1.0f};
-    mob_params[MobType::FLYING] = {0.0f, 10.0f, false, true, false, false, 1.5f};
+    mob_params[MobType::PASSIVE] = {0.5f, 3.0f, false, false, true, false, 1.0f, false};
+    mob_params[MobType::NEUTRAL] = {0.5f, 3.0f, false, false, false, false, 1.0f, false};
+    mob_params[MobType::HOSTILE] = {0.5f, 3.0f, false, false, false, false, 1.2f, false};
+    mob_params[MobType::WATER] = {0.5f, 1.0f, true, false, false, false, 1.0f, true};
+    mob_params[MobType::FLYING] = {0.0f, 10.0f, false, true, false, false, 1.5f, true};
 }
 
 PathfinderOptimizer::~PathfinderOptimizer() = default;
 
-std::vector<std::shared_ptr<PathNode>> PathfinderOptimizer::optimize_pathfinding(
+std::vector<Node> PathfinderOptimizer::optimize_pathfinding(
     int start_x, int start_y, int start_z,
     int end_x, int end_y, int end_z,
     MobType mob_type) {
-    
-    // 简化的寻路实现 - 返回空路径
-    return std::vector<std::shared_ptr<PathNode>>();
+    // 未到达目标时返回朝目标方向的部分路径（与原版Path.canReach() == false相同）
+    return find_path(Node(start_x, start_y, start_z), Node(end_x, end_y, end_z), mob_type).nodes;
+}
+
+PathResult PathfinderOptimizer::find_path(const Node& start, const Node& goal, MobType mob_type,
+                                          uint32_t max_nodes) {
+    auto current = snapshot();
+    return find_path(*current, start, goal, mob_type, max_nodes);
+}
+
+PathResult PathfinderOptimizer::find_path(const SectionBlockSnapshot& snapshot, const Node& start,
+                                          const Node& goal, MobType mob_type, uint32_t max_nodes,
+                                          const SearchBounds* bounds) {
+    // 范围内的局部搜索不走缓存
+    const PathCacheKey key{start, goal, mob_type};
+    PathResult result;
+    if (bounds == nullptr && lookup_cached_path(snapshot, key, result)) {
+        return result;
+    }
+
+    const MobPathfindingParams& params = get_mob_params(mob_type);
+    thread_local SearchContext context;
+    context.begin(snapshot, max_nodes);
+
+    const uint32_t best = run_search(context, start, &goal, params, bounds, [&](const PathNode& node) {
+        result.reached = node == goal;
+        return result.reached;
+    });
+
+    result.nodes = reconstruct_path(context, best);
+    result.nodes_visited = static_cast<uint32_t>(context.nodes.size());
+    finish_search(snapshot, key, result, context.budget_hit, bounds == nullptr);
+    return result;
+}
+
+void PathfinderOptimizer::finish_search(const SectionBlockSnapshot& snapshot, const PathCacheKey& key,
+                                        const PathResult& result, bool budget_hit, bool cacheable) {
+    stats.searches.fetch_add(1, std::memory_order_relaxed);
+    stats.nodes_visited.fetch_add(result.nodes_visited, std::memory_order_relaxed);
+    if (result.reached) {
+        stats.reached.fetch_add(1, std::memory_order_relaxed);
+        if (cacheable) {
+            store_cached_path(snapshot, key, result);
+        }
+    } else if (budget_hit) {
+        stats.budget_exhausted.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::unique_ptr<PathSearch> PathfinderOptimizer::begin_search(const Node& start, const Node& goal, MobType mob_type,
+                                                              uint32_t max_nodes) {
+    return std::unique_ptr<PathSearch>(new PathSearch(*this, snapshot(), start, goal, mob_type, max_nodes));
+}
+
+std::vector<float> PathfinderOptimizer::region_costs(const SectionBlockSnapshot& snapshot, const Node& start,
+                                                     const std::vector<Node>& targets, MobType mob_type,
+                                                     const SearchBounds& bounds, uint32_t max_nodes) {
+    std::vector<float> costs(targets.size(), std::numeric_limits<float>::infinity());
+    if (targets.empty()) {
+        return costs;
+    }
+    const MobPathfindingParams& params = get_mob_params(mob_type);
+    thread_local SearchContext context;
+    context.begin(snapshot, max_nodes);
+
+    // 目标位置 -> 下标（同一位置可能出现多次）
+    std::unordered_multimap<uint64_t, size_t> wanted;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        wanted.emplace(pack_position(targets[i].x, targets[i].y, targets[i].z), i);
+    }
+    size_t remaining = targets.size();
+    run_search(context, start, nullptr, params, &bounds, [&](const PathNode& node) {
+        auto [first, last] = wanted.equal_range(pack_position(node.x, node.y, node.z));
+        for (auto it = first; it != last; ++it) {
+            costs[it->second] = node.g_cost;
+            --remaining;
+        }
+        return remaining == 0;
+    });
+    return costs;
+}
+
+template <typename Settled>
+uint32_t PathfinderOptimizer::run_search(SearchContext& context, const Node& start, const Node* goal,
+                                         const MobPathfindingParams& params, const SearchBounds* bounds,
+                                         Settled&& settled) const {
+    uint32_t best = seed_search(context, start, goal);
+    const uint32_t found = advance_search(context, goal, params, bounds, UINT32_MAX, best,
+                                          std::forward<Settled>(settled));
+    return found != NO_NODE ? found : best;
+}
+
+uint32_t PathfinderOptimizer::seed_search(SearchContext& context, const Node& start, const Node* goal) {
+    bool created = false;
+    const uint32_t start_index = context.get_or_create(start.x, start.y, start.z, created);
+    PathNode& start_node = context.nodes[start_index];
+    start_node.h_cost = goal ? calculate_heuristic(start, *goal) : 0.0f;
+    start_node.f_cost = start_node.h_cost;
+    context.push(start_index);
+    return start_index;
+}
+
+template <typename Settled>
+uint32_t PathfinderOptimizer::advance_search(SearchContext& context, const Node* goal,
+                                             const MobPathfindingParams& params, const SearchBounds* bounds,
+                                             uint32_t max_expansions, uint32_t& best, Settled&& settled) const {
+    for (uint32_t expanded = 0; expanded < max_expansions && !context.heap.empty(); ++expanded) {
+        const uint32_t current = context.pop();
+        PathNode& node = context.nodes[current];
+        node.closed = true;
+        if (settled(static_cast<const PathNode&>(node))) {
+            return current;
+        }
+        if (node.h_cost < context.nodes[best].h_cost) {
+            best = current;
+        }
+        expand_neighbors(context, current, goal, params, bounds);
+    }
+    return NO_NODE;
+}
+
+void PathfinderOptimizer::for_each_section_exit(const SectionBlockSnapshot& snapshot, int chunk_x, int section_y,
+                                                int chunk_z, MobType mob_type,
+                                                const std::function<void(const Node&, const Node&, float)>& visit) {
+    const MobPathfindingParams& params = get_mob_params(mob_type);
+    const SearchBounds bounds = SearchBounds::section(chunk_x, section_y, chunk_z);
+    // 水平移动一次一格，向上一格，向下最多掉落max_drop_height格：只有靠近段边界的格子可能离开
+    const int max_drop = params.can_fly || params.can_swim ? 0 : static_cast<int>(params.max_drop_height);
+    SearchContext context;
+    context.bind(snapshot);
+    for (int ly = 0; ly < 16; ++ly) {
+        for (int lz = 0; lz < 16; ++lz) {
+            for (int lx = 0; lx < 16; ++lx) {
+                if (lx != 0 && lx != 15 && lz != 0 && lz != 15 && ly > max_drop && ly != 15) {
+                    continue;
+                }
+                const Node from(bounds.min.x + lx, bounds.min.y + ly, bounds.min.z + lz);
+                if (!is_node_valid(context, from.x, from.y, from.z, params)) {
+                    continue;
+                }
+                generate_moves(context, from, params, [&](int x, int y, int z, float cost) {
+                    if (!bounds.contains(x, y, z)) {
+                        visit(from, Node(x, y, z), cost);
+                    }
+                });
+            }
+        }
+    }
+}
+
+bool PathfinderOptimizer::is_node_valid(const SectionBlockSnapshot& snapshot, const Node& node, MobType mob_type) {
+    const MobPathfindingParams& params = get_mob_params(mob_type);
+    SearchContext context;
+    context.bind(snapshot);
+    return is_node_valid(context, node.x, node.y, node.z, params);
+}
+
+template <typename Visit>
+void PathfinderOptimizer::generate_moves(SearchContext& context, const Node& from,
+                                         const MobPathfindingParams& params, Visit&& open) {
+    static constexpr int HORIZONTAL[8][2] = {
+        {1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1},
+    };
+
+    using Blocks = SectionBlockSnapshot::SectionBlocks;
+
+    // 飞行与水生生物：在可进入的格子中三维移动，不需要落脚点
+    if (params.can_fly || params.can_swim) {
+        auto enterable = [&](int x, int y, int z) { return is_enterable(context, x, y, z, params); };
+        for (const auto& direction : HORIZONTAL) {
+            const int nx = from.x + direction[0];
+            const int nz = from.z + direction[1];
+            const bool diagonal = direction[0] != 0 && direction[1] != 0;
+            if (!enterable(nx, from.y, nz)) {
+                continue;
+            }
+            // 斜向移动不能穿过墙角
+            if (diagonal && (!enterable(nx, from.y, from.z) || !enterable(from.x, from.y, nz))) {
+                continue;
+            }
+            open(nx, from.y, nz, diagonal ? DIAGONAL_DISTANCE : 1.0f);
+        }
+        for (int dy : {1, -1}) {
+            if (enterable(from.x, from.y + dy, from.z)) {
+                open(from.x, from.y + dy, from.z, 1.0f);
+            }
+        }
+        return;
+    }
+
+    // 地面生物：按行一次取出from周围3x3列在各高度的位（bit dx + 1），之后只做位测试
+    uint32_t pass0[3], pass1[3], pass2[3];   // from.y、+1、+2可通过
+    uint32_t water0[3], water1[3];           // from.y、+1为水
+    uint32_t walk0[3], walk1[3];             // 站在from.y、+1可行
+    for (int dz = -1; dz <= 1; ++dz) {
+        const int z = from.z + dz;
+        const int i = dz + 1;
+        pass0[i] = context.window(Blocks::PASSABLE, from.x, from.y, z);
+        pass1[i] = context.window(Blocks::PASSABLE, from.x, from.y + 1, z);
+        pass2[i] = context.window(Blocks::PASSABLE, from.x, from.y + 2, z);
+        water0[i] = context.window(Blocks::WATER, from.x, from.y, z);
+        water1[i] = context.window(Blocks::WATER, from.x, from.y + 1, z);
+        const uint32_t solid_below = context.window(Blocks::SOLID, from.x, from.y - 1, z);
+        const uint32_t solid0 = context.window(Blocks::SOLID, from.x, from.y, z);
+        // 不会游泳且避水的生物仍可以涉水（代价更高），所以水中不需要落脚点
+        walk0[i] = pass0[i] & pass1[i] & (water0[i] | solid_below);
+        walk1[i] = pass1[i] & pass2[i] & (water1[i] | solid0);
+    }
+    auto bit = [](const uint32_t* rows, int dx, int dz) { return ((rows[dz + 1] >> (dx + 1)) & 1u) != 0; };
+
+    for (const auto& direction : HORIZONTAL) {
+        const int dx = direction[0];
+        const int dz = direction[1];
+        const int nx = from.x + dx;
+        const int nz = from.z + dz;
+        const bool diagonal = dx != 0 && dz != 0;
+        const float distance = diagonal ? DIAGONAL_DISTANCE : 1.0f;
+
+        if (diagonal) {
+            // 斜向只在同一高度移动，两侧的格子都要能通过
+            if (!bit(pass0, dx, 0) || !bit(pass1, dx, 0) || !bit(pass0, 0, dz) || !bit(pass1, 0, dz) ||
+                !bit(walk0, dx, dz)) {
+                continue;
+            }
+            open(nx, from.y, nz, distance + calculate_move_cost(bit(water0, dx, dz), params));
+            continue;
+        }
+
+        if (bit(walk0, dx, dz)) {
+            open(nx, from.y, nz, distance + calculate_move_cost(bit(water0, dx, dz), params));
+            continue;
+        }
+
+        if (!bit(pass0, dx, dz)) {
+            // 跳上一格：当前格上方要有空间
+            if (bit(pass2, 0, 0) && bit(walk1, dx, dz)) {
+                open(nx, from.y + 1, nz, distance + JUMP_COST + calculate_move_cost(bit(water1, dx, dz), params));
+            }
+            continue;
+        }
+
+        if (!bit(pass1, dx, dz)) {
+            continue;
+        }
+        // 走下边缘：向下找落脚点，不超过可安全掉落的高度
+        const int max_drop = static_cast<int>(params.max_drop_height);
+        for (int drop = 1; drop <= max_drop; ++drop) {
+            const int ny = from.y - drop;
+            if (is_walkable(context, nx, ny, nz, params)) {
+                open(nx, ny, nz, distance + drop * DROP_COST_PER_BLOCK +
+                                     calculate_move_cost(context.test(Blocks::WATER, nx, ny, nz), params));
+                break;
+            }
+            if (!context.test(Blocks::PASSABLE, nx, ny, nz)) {
+                break;
+            }
+        }
+    }
+
+    // 在水中可以上浮或下潜
+    if (bit(water0, 0, 0)) {
+        if (bit(walk1, 0, 0)) {
+            open(from.x, from.y + 1, from.z, 1.0f + calculate_move_cost(bit(water1, 0, 0), params));
+        }
+        if (is_walkable(context, from.x, from.y - 1, from.z, params)) {
+            open(from.x, from.y - 1, from.z,
+                 1.0f + calculate_move_cost(context.test(Blocks::WATER, from.x, from.y - 1, from.z), params));
+        }
+    }
+}
+
+void PathfinderOptimizer::expand_neighbors(SearchContext& context, uint32_t current, const Node* goal,
+                                           const MobPathfindingParams& params, const SearchBounds* bounds) const {
+    const PathNode from = context.nodes[current];
+
+    auto relax = [&](int x, int y, int z, float cost) {
+        bool created = false;
+        const uint32_t index = context.get_or_create(x, y, z, created);
+        if (index == NO_NODE) {
+            return;
+        }
+        PathNode& node = context.nodes[index];
+        if (node.closed) {
+            return;
+        }
+        const float g = from.g_cost + cost;
+        if (!created && g >= node.g_cost) {
+            return;
+        }
+        node.g_cost = g;
+        if (created) {
+            node.h_cost = goal ? calculate_heuristic(node, *goal) : 0.0f;
+        }
+        node.f_cost = g + node.h_cost;
+        node.parent = current;
+        if (node.heap_index == PathNode::NOT_IN_HEAP) {
+            context.push(index);
+        } else {
+            context.decrease_key(index);
+        }
+    };
+
+    // 区域代价（goal为空）要求每个格子都有代价，只在有目标的搜索中跳跃
+    const bool jump = goal && params.jump_point_search && (params.can_fly || params.can_swim) &&
+                      jump_point_search();
+    if (jump) {
+        context.jump_points = true;
+    }
+    generate_moves(context, from, params, [&](int x, int y, int z, float cost) {
+        if (bounds && !bounds->contains(x, y, z)) {
+            return;
+        }
+        if (!jump) {
+            relax(x, y, z, cost);
+            return;
+        }
+        const int dx = x - from.x;
+        const int dy = y - from.y;
+        const int dz = z - from.z;
+        const int steps = jump_distance(context, from, dx, dy, dz, *goal, params, bounds);
+        relax(from.x + dx * steps, from.y + dy * steps, from.z + dz * steps, cost * static_cast<float>(steps));
+    });
+}
+
+int PathfinderOptimizer::jump_distance(SearchContext& context, const Node& from, int dx, int dy, int dz,
+                                       const Node& goal, const MobPathfindingParams& params,
+                                       const SearchBounds* bounds) {
+    Node at(from.x + dx, from.y + dy, from.z + dz);
+    int steps = 1;
+    while (steps < MAX_JUMP_DISTANCE && at != goal) {
+        // 与目标在移动的某个轴上对齐时停下，之后可以转向直线接近目标
+        if ((dx != 0 && at.x == goal.x) || (dy != 0 && at.y == goal.y) || (dz != 0 && at.z == goal.z)) {
+            break;
+        }
+        const Node next(at.x + dx, at.y + dy, at.z + dz);
+        if (bounds && !bounds->contains(next.x, next.y, next.z)) {
+            break;
+        }
+        // 邻域有不可进入的格子时这里可能是转向点（绕过障碍），作为跳点入堆
+        if (!open_neighborhood(context, at.x, at.y, at.z, params)) {
+            break;
+        }
+        at = next;
+        ++steps;
+    }
+    return steps;
+}
+
+bool PathfinderOptimizer::open_neighborhood(SearchContext& context, int x, int y, int z,
+                                            const MobPathfindingParams& params) {
+    using Blocks = SectionBlockSnapshot::SectionBlocks;
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dz = -1; dz <= 1; ++dz) {
+            const uint32_t water = context.window(Blocks::WATER, x, y + dy, z + dz);
+            const uint32_t open = params.can_fly ? context.window(Blocks::PASSABLE, x, y + dy, z + dz) & ~water
+                                                 : water;
+            if ((open & 7u) != 7u) {
+                return false;
+            }
+        }
+    }
+    return true;
 }
 
 const MobPathfindingParams& PathfinderOptimizer::get_mob_params(MobType mob_type) {
-    static MobPathfindingParams default_params = {0.5f, 3.0f, false, false, false, false, 1.0f};
+    static MobPathfindingParams default_params = {0.5f, 3.0f, false, false, false, false, 1.0f, false};
     auto it = mob_params.find(mob_type);
     if (it != mob_params.end()) {
         return it->second;
@@ -34,34 +659,479 @@ const MobPathfindingParams& PathfinderOptimizer::get_mob_params(MobType mob_type
     return default_params;
 }
 
-std::vector<std::shared_ptr<PathNode>> PathfinderOptimizer::reconstruct_path(std::shared_ptr<PathNode> node) {
-    std::vector<std::shared_ptr<PathNode>> path;
-    auto current = node;
-    while (current) {
-        path.push_back(current);
-        current = current->parent;
+std::vector<Node> PathfinderOptimizer::reconstruct_path(const SearchContext& context, uint32_t node) const {
+    std::vector<Node> path;
+    for (uint32_t current = node; current != PathNode::NO_PARENT; current = context.nodes[current].parent) {
+        const PathNode& entry = context.nodes[current];
+        path.emplace_back(entry.x, entry.y, entry.z);
     }
     std::reverse(path.begin(), path.end());
-    return path;
+    if (!context.jump_points) {
+        return path;
+    }
+
+    // 跳点之间是直线（各轴步长为-1/0/1），逐格补全
+    std::vector<Node> cells;
+    cells.reserve(path.size());
+    for (size_t i = 0; i < path.size(); ++i) {
+        if (i > 0) {
+            const Node& prev = path[i - 1];
+            const int sx = (path[i].x > prev.x) - (path[i].x < prev.x);
+            const int sy = (path[i].y > prev.y) - (path[i].y < prev.y);
+            const int sz = (path[i].z > prev.z) - (path[i].z < prev.z);
+            Node at(prev.x + sx, prev.y + sy, prev.z + sz);
+            while (at != path[i]) {
+                cells.push_back(at);
+                at = Node(at.x + sx, at.y + sy, at.z + sz);
+            }
+        }
+        cells.push_back(path[i]);
+    }
+    return cells;
 }
 
-float PathfinderOptimizer::calculate_heuristic(std::shared_ptr<PathNode> a, std::shared_ptr<PathNode> b) {
-    // 简单的欧几里得距离
-    float dx = b->x - a->x;
-    float dy = b->y - a->y;
-    float dz = b->z - a->z;
+float PathfinderOptimizer::calculate_heuristic(const Node& a, const Node& b) {
+    // 欧几里得距离：每步代价至少为移动距离，保持可采纳
+    float dx = static_cast<float>(b.x - a.x);
+    float dy = static_cast<float>(b.y - a.y);
+    float dz = static_cast<float>(b.z - a.z);
     return std::sqrt(dx*dx + dy*dy + dz*dz);
 }
 
-float PathfinderOptimizer::calculate_move_cost(std::shared_ptr<PathNode> from, const Node& direction, const MobPathfindingParams& params) {
-    // 简化的移动成本计算
-    return 1.0f;
+float PathfinderOptimizer::calculate_move_cost(bool in_water, const MobPathfindingParams& params) {
+    if (in_water && !params.can_swim) {
+        return params.avoids_water ? WATER_AVOID_COST : WATER_COST;
+    }
+    return 0.0f;
 }
 
-bool PathfinderOptimizer::is_walkable(int x, int y, int z, const MobPathfindingParams& params) {
-    // 简化的可行走检查 - 总是返回true
+bool PathfinderOptimizer::is_walkable(SearchContext& context, int x, int y, int z,
+                                      const MobPathfindingParams& params) {
+    using Blocks = SectionBlockSnapshot::SectionBlocks;
+    if (!context.test(Blocks::PASSABLE, x, y, z) || !context.test(Blocks::PASSABLE, x, y + 1, z)) {
+        return false;
+    }
+    // 不会游泳且避水的生物仍可以涉水（代价更高），所以水中不需要落脚点
+    (void)params;
+    return context.test(Blocks::WATER, x, y, z) || context.test(Blocks::SOLID, x, y - 1, z);
+}
+
+bool PathfinderOptimizer::is_enterable(SearchContext& context, int x, int y, int z,
+                                       const MobPathfindingParams& params) {
+    using Blocks = SectionBlockSnapshot::SectionBlocks;
+    // 飞行生物只在空气中（可通过且不是水），水生生物只在水中
+    const bool water = context.test(Blocks::WATER, x, y, z);
+    return params.can_fly ? context.test(Blocks::PASSABLE, x, y, z) && !water : water;
+}
+
+bool PathfinderOptimizer::is_node_valid(SearchContext& context, int x, int y, int z,
+                                        const MobPathfindingParams& params) {
+    if (params.can_fly || params.can_swim) {
+        return is_enterable(context, x, y, z, params);
+    }
+    return is_walkable(context, x, y, z, params);
+}
+
+// ===== FlowField =====
+
+bool FlowField::sample(const Node& at, Node& next) const {
+    auto it = steps_.find(pack_position(at.x, at.y, at.z));
+    if (it == steps_.end()) {
+        return false;
+    }
+    next = it->second.next;
     return true;
 }
 
+float FlowField::cost_to_goal(const Node& at) const {
+    auto it = steps_.find(pack_position(at.x, at.y, at.z));
+    return it != steps_.end() ? it->second.cost : std::numeric_limits<float>::infinity();
+}
+
+std::vector<Node> FlowField::trace(const Node& start) const {
+    std::vector<Node> path;
+    Node current = start;
+    Node next;
+    // 每一步剩余代价严格递减，步数不会超过场内格子数
+    while (path.size() <= steps_.size() && sample(current, next)) {
+        path.push_back(current);
+        if (current == goal_) {
+            return path;
+        }
+        current = next;
+    }
+    return {};
+}
+
+bool FlowField::is_current(const SectionBlockSnapshot& blocks) const {
+    return blocks.matches(section_versions_);
+}
+
+std::shared_ptr<const FlowField> PathfinderOptimizer::get_flow_field(const SectionBlockSnapshot& snapshot,
+                                                                     const Node& goal, MobType mob_type,
+                                                                     int radius) {
+    const uint64_t key = pack_position(goal.x, goal.y, goal.z) ^ (static_cast<uint64_t>(mob_type) << 61);
+    {
+        std::lock_guard<std::mutex> lock(flow_field_mutex);
+        auto it = flow_fields.find(key);
+        if (it != flow_fields.end() && it->second->goal() == goal && it->second->mob_type() == mob_type &&
+            it->second->is_current(snapshot)) {
+            stats.flow_field_hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+    auto field = build_flow_field(snapshot, goal, mob_type, radius);
+    std::lock_guard<std::mutex> lock(flow_field_mutex);
+    if (flow_fields.size() >= MAX_CACHED_FLOW_FIELDS) {
+        flow_fields.clear();
+    }
+    flow_fields[key] = field;
+    return field;
+}
+
+std::shared_ptr<const FlowField> PathfinderOptimizer::build_flow_field(const SectionBlockSnapshot& snapshot,
+                                                                       const Node& goal, MobType mob_type,
+                                                                       int radius) {
+    const MobPathfindingParams& params = get_mob_params(mob_type);
+    const int vertical = std::max(radius / 2, 16);
+    const SearchBounds bounds{Node(goal.x - radius, goal.y - vertical, goal.z - radius),
+                              Node(goal.x + radius, goal.y + vertical, goal.z + radius)};
+    // u -> v的移动中u.y - v.y的范围：跳上一格为-1，掉落最多max_drop_height格（三维移动为±1）
+    const int max_rise = params.can_fly || params.can_swim ? 1 : std::max(1, static_cast<int>(params.max_drop_height));
+
+    auto field = std::make_shared<FlowField>();
+    field->goal_ = goal;
+    field->mob_type_ = mob_type;
+
+    thread_local SearchContext context;
+    context.begin(snapshot, MAX_FLOW_FIELD_NODES);
+    bool created = false;
+    const uint32_t goal_index = context.get_or_create(goal.x, goal.y, goal.z, created);
+    context.push(goal_index);
+
+    // 反向Dijkstra：出堆节点v的父节点即v朝目标的下一步
+    while (!context.heap.empty()) {
+        const uint32_t current = context.pop();
+        context.nodes[current].closed = true;
+        const PathNode target = context.nodes[current];
+
+        for (int dy = -1; dy <= max_rise; ++dy) {
+            for (int dz = -1; dz <= 1; ++dz) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (dx == 0 && dz == 0 && dy == 0) {
+                        continue;
+                    }
+                    const Node from(target.x + dx, target.y + dy, target.z + dz);
+                    if (!bounds.contains(from.x, from.y, from.z) ||
+                        !is_node_valid(context, from.x, from.y, from.z, params)) {
+                        continue;
+                    }
+                    // from的正向移动中是否有一步到达target
+                    float step_cost = -1.0f;
+                    generate_moves(context, from, params, [&](int x, int y, int z, float cost) {
+                        if (x == target.x && y == target.y && z == target.z) {
+                            step_cost = cost;
+                        }
+                    });
+                    if (step_cost < 0.0f) {
+                        continue;
+                    }
+                    const uint32_t index = context.get_or_create(from.x, from.y, from.z, created);
+                    if (index == NO_NODE) {
+                        continue;
+                    }
+                    PathNode& node = context.nodes[index];
+                    const float g = target.g_cost + step_cost;
+                    if (node.closed || (!created && g >= node.g_cost)) {
+                        continue;
+                    }
+                    node.g_cost = g;
+                    node.f_cost = g;
+                    node.parent = current;
+                    if (node.heap_index == PathNode::NOT_IN_HEAP) {
+                        context.push(index);
+                    } else {
+                        context.decrease_key(index);
+                    }
+                }
+            }
+        }
+    }
+
+    field->steps_.reserve(context.nodes.size());
+    for (const PathNode& node : context.nodes) {
+        if (!node.closed) {
+            continue;
+        }
+        const Node next = node.parent != PathNode::NO_PARENT ? Node(context.nodes[node.parent]) : goal;
+        field->steps_.emplace(pack_position(node.x, node.y, node.z), FlowField::Step{next, node.g_cost});
+    }
+
+    // 记录范围内（含脚下与落点所在的一圈）各段的版本
+    for (int sy = (bounds.min.y - 1) >> 4; sy <= (bounds.max.y + 1) >> 4; ++sy) {
+        for (int sz = (bounds.min.z - 1) >> 4; sz <= (bounds.max.z + 1) >> 4; ++sz) {
+            for (int sx = (bounds.min.x - 1) >> 4; sx <= (bounds.max.x + 1) >> 4; ++sx) {
+                field->section_versions_.push_back(SectionStamp{sx, sy, sz, snapshot.section_version(sx, sy, sz)});
+            }
+        }
+    }
+    stats.flow_fields_built.fetch_add(1, std::memory_order_relaxed);
+    return field;
+}
+
+// ===== PathSearch =====
+
+PathSearch::PathSearch(PathfinderOptimizer& optimizer, std::shared_ptr<const SectionBlockSnapshot> blocks,
+                       const Node& start, const Node& goal, MobType mob_type, uint32_t max_nodes)
+    : optimizer_(optimizer), blocks_(std::move(blocks)), start_(start), goal_(goal), mob_type_(mob_type) {
+    if (optimizer_.lookup_cached_path(*blocks_, PathfinderOptimizer::PathCacheKey{start, goal, mob_type},
+                                      result_)) {
+        status_ = Status::REACHED;
+        return;
+    }
+    context_ = std::make_unique<PathfinderOptimizer::SearchContext>();
+    context_->begin(*blocks_, max_nodes);
+    best_ = PathfinderOptimizer::seed_search(*context_, start_, &goal_);
+}
+
+PathSearch::~PathSearch() = default;
+
+PathSearch::Status PathSearch::step(uint32_t max_expansions) {
+    if (done()) {
+        return status_;
+    }
+    const MobPathfindingParams& params = optimizer_.get_mob_params(mob_type_);
+    uint32_t count = 0;
+    const uint32_t found = optimizer_.advance_search(*context_, &goal_, params, nullptr, max_expansions, best_,
+                                                     [&](const PathNode& node) {
+                                                         ++count;
+                                                         return node == goal_;
+                                                     });
+    expanded_ += count;
+    if (found == NO_NODE && !context_->heap.empty()) {
+        return status_;
+    }
+
+    result_.reached = found != NO_NODE;
+    result_.nodes = optimizer_.reconstruct_path(*context_, result_.reached ? found : best_);
+    result_.nodes_visited = static_cast<uint32_t>(context_->nodes.size());
+    optimizer_.finish_search(*blocks_, PathfinderOptimizer::PathCacheKey{start_, goal_, mob_type_}, result_,
+                             context_->budget_hit, true);
+    status_ = result_.reached ? Status::REACHED : Status::EXHAUSTED;
+    context_.reset();
+    return status_;
+}
+
+PathResult PathSearch::result() const {
+    if (done()) {
+        return result_;
+    }
+    PathResult partial;
+    partial.nodes = optimizer_.reconstruct_path(*context_, best_);
+    partial.nodes_visited = static_cast<uint32_t>(context_->nodes.size());
+    return partial;
+}
+
+// ===== 路径缓存 =====
+
+size_t PathfinderOptimizer::PathCacheKeyHash::operator()(const PathCacheKey& key) const {
+    const uint64_t start = pack_position(key.start.x, key.start.y, key.start.z);
+    const uint64_t goal = pack_position(key.goal.x, key.goal.y, key.goal.z);
+    return static_cast<size_t>((start * 0x9E3779B97F4A7C15ULL) ^ goal ^ (static_cast<uint64_t>(key.mob_type) << 61));
+}
+
+bool PathfinderOptimizer::lookup_cached_path(const SectionBlockSnapshot& snapshot, const PathCacheKey& key,
+                                             PathResult& result) {
+    std::lock_guard<std::mutex> lock(path_cache_mutex);
+    auto it = path_cache.find(key);
+    if (it == path_cache.end()) {
+        return false;
+    }
+    if (!snapshot.matches(it->second.sections)) {
+        path_cache.erase(it);
+        stats.path_cache_invalidated.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    result.nodes = it->second.nodes;
+    result.reached = true;
+    result.nodes_visited = 0;
+    stats.path_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void PathfinderOptimizer::store_cached_path(const SectionBlockSnapshot& snapshot, const PathCacheKey& key,
+                                            const PathResult& result) {
+    // 一步移动读到的格子：两端及对角拐角的列，从较低一端脚下到较高一端头顶上方（跳跃检查）
+    CachedPath entry;
+    entry.nodes = result.nodes;
+    std::vector<uint64_t> seen;
+    auto stamp_column = [&](int x, int z, int min_y, int max_y) {
+        for (int sy = min_y >> 4; sy <= max_y >> 4; ++sy) {
+            const uint64_t section = SectionBlockSnapshot::pack_section_key(x >> 4, sy, z >> 4);
+            if (std::find(seen.begin(), seen.end(), section) != seen.end()) {
+                continue;
+            }
+            seen.push_back(section);
+            entry.sections.push_back(SectionStamp{x >> 4, sy, z >> 4, snapshot.section_version(x >> 4, sy, z >> 4)});
+        }
+    };
+    for (size_t i = 0; i < result.nodes.size(); ++i) {
+        const Node& to = result.nodes[i];
+        const Node& from = result.nodes[i > 0 ? i - 1 : 0];
+        const int min_y = std::min(from.y, to.y) - 1;
+        const int max_y = std::max(from.y, to.y) + 2;
+        stamp_column(to.x, to.z, min_y, max_y);
+        stamp_column(from.x, to.z, min_y, max_y);
+        stamp_column(to.x, from.z, min_y, max_y);
+    }
+
+    std::lock_guard<std::mutex> lock(path_cache_mutex);
+    if (path_cache.size() >= MAX_CACHED_PATHS) {
+        path_cache.clear();
+    }
+    path_cache[key] = std::move(entry);
+}
+
+size_t PathfinderOptimizer::cached_paths() const {
+    std::lock_guard<std::mutex> lock(path_cache_mutex);
+    return path_cache.size();
+}
+
+void PathfinderOptimizer::clear_path_cache() {
+    std::lock_guard<std::mutex> lock(path_cache_mutex);
+    path_cache.clear();
+}
+
+// ===== 方块快照更新 =====
+
+SectionBlockSnapshot& PathfinderOptimizer::mutable_snapshot_locked() {
+    if (blocks.use_count() > 1) {
+        blocks = std::make_shared<SectionBlockSnapshot>(*blocks);
+    }
+    return *blocks;
+}
+
+std::shared_ptr<const SectionBlockSnapshot> PathfinderOptimizer::snapshot() const {
+    std::lock_guard<std::mutex> lock(optimizer_mutex);
+    return blocks;
+}
+
+void PathfinderOptimizer::set_section(int chunk_x, int section_y, int chunk_z, const uint8_t* types) {
+    const uint64_t key = SectionBlockSnapshot::pack_section_key(chunk_x, section_y, chunk_z);
+    std::shared_ptr<SectionBlockSnapshot::SectionBlocks> section;
+    if (types) {
+        bool empty = true;
+        section = std::make_shared<SectionBlockSnapshot::SectionBlocks>();
+        section->fill(PathBlockType::OPEN);
+        for (size_t i = 0; i < section->types.size(); ++i) {
+            // 未知值按SOLID处理
+            const uint8_t value = types[i];
+            const PathBlockType type = value <= static_cast<uint8_t>(PathBlockType::FENCE)
+                                           ? static_cast<PathBlockType>(value) : PathBlockType::SOLID;
+            if (type != PathBlockType::OPEN) {
+                section->set(i, type);
+                empty = false;
+            }
+        }
+        if (empty) {
+            section.reset();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(optimizer_mutex);
+    auto& snapshot = mutable_snapshot_locked();
+    if (section) {
+        snapshot.sections[key] = SectionBlockSnapshot::Section{std::move(section), next_version++};
+    } else {
+        snapshot.sections.erase(key);
+    }
+}
+
+void PathfinderOptimizer::set_block(int x, int y, int z, PathBlockType type) {
+    const uint64_t key = SectionBlockSnapshot::pack_section_key(x >> 4, y >> 4, z >> 4);
+    const size_t index = static_cast<size_t>(((y & 15) << 8) | ((z & 15) << 4) | (x & 15));
+
+    std::lock_guard<std::mutex> lock(optimizer_mutex);
+    auto& snapshot = mutable_snapshot_locked();
+    auto& entry = snapshot.sections[key];
+    auto& section = entry.blocks;
+    if (section && section->get(index) == type) {
+        return;
+    }
+    entry.version = next_version++;
+    if (!section || section.use_count() > 1) {
+        // 段仍被旧快照引用（或不存在）：复制后修改
+        auto copy = section ? std::make_shared<SectionBlockSnapshot::SectionBlocks>(*section)
+                            : std::make_shared<SectionBlockSnapshot::SectionBlocks>();
+        if (!section) {
+            copy->fill(PathBlockType::OPEN);
+        }
+        copy->set(index, type);
+        section = std::move(copy);
+    } else {
+        // 只有当前快照引用，段本身由make_shared创建为非const对象
+        const_cast<SectionBlockSnapshot::SectionBlocks&>(*section).set(index, type);
+    }
+}
+
+void PathfinderOptimizer::clear_chunk(int chunk_x, int chunk_z) {
+    std::lock_guard<std::mutex> lock(optimizer_mutex);
+    auto& snapshot = mutable_snapshot_locked();
+    for (int section_y = -128; section_y < 128; ++section_y) {
+        snapshot.sections.erase(SectionBlockSnapshot::pack_section_key(chunk_x, section_y, chunk_z));
+    }
+}
+
+void PathfinderOptimizer::set_block_type_table(const uint8_t* types, size_t count) {
+    std::lock_guard<std::mutex> lock(block_sync_mutex);
+    block_type_table.assign(types, types + count);
+    // 分类变化后下一次同步重新转换所有段
+    synced_block_states.reset();
+}
+
+bool PathfinderOptimizer::has_block_type_table() const {
+    std::lock_guard<std::mutex> lock(block_sync_mutex);
+    return !block_type_table.empty();
+}
+
+size_t PathfinderOptimizer::sync_block_states(std::shared_ptr<const BlockStateSnapshot> states) {
+    if (!states) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(block_sync_mutex);
+    if (block_type_table.empty() || states == synced_block_states) {
+        return 0;
+    }
+    const auto classify = [this](uint16_t state) {
+        return state < block_type_table.size() ? block_type_table[state] : static_cast<uint8_t>(PathBlockType::SOLID);
+    };
+
+    size_t updated = 0;
+    std::array<uint8_t, 4096> types;
+    states->diff(synced_block_states.get(), [&](int chunk_x, int section_y, int chunk_z,
+                                                const BlockStateSnapshot::Section* section) {
+        ++updated;
+        if (!section) {
+            set_section(chunk_x, section_y, chunk_z, nullptr);
+            return;
+        }
+        if (section->isUniform()) {
+            const uint8_t type = classify(section->uniform);
+            if (type == static_cast<uint8_t>(PathBlockType::OPEN)) {
+                set_section(chunk_x, section_y, chunk_z, nullptr);
+                return;
+            }
+            types.fill(type);
+        } else {
+            for (size_t i = 0; i < types.size(); ++i) {
+                types[i] = classify(section->data->states[i]);
+            }
+        }
+        set_section(chunk_x, section_y, chunk_z, types.data());
+    });
+    synced_block_states = std::move(states);
+    return updated;
+}
+
 } // namespace world
-} // namespace lattice
\ No newline at end of file
+} // namespace lattice
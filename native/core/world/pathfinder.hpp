@@ -1,15 +1,21 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include <unordered_map>
 #include <functional>
-#include <queue>
 #include <mutex>
 
+#include "../slab_allocator.hpp"
+
 namespace lattice {
 namespace world {
 
+class BlockStateSnapshot;
+
 // 生物类型枚举
 enum class MobType {
     PASSIVE,  // 被动生物
@@ -19,30 +25,41 @@ enum class MobType {
     FLYING    // 飞行生物
 };
 
+// 寻路用的方块分类（由Java按方块状态的碰撞箱与流体计算后上传）
+enum class PathBlockType : uint8_t {
+    OPEN = 0,     // 可穿过（空气、花草、打开的门等）
+    SOLID = 1,    // 完整碰撞箱，可站立其上
+    WATER = 2,    // 水
+    DANGER = 3,   // 岩浆、火、仙人掌、浆果丛等，不可进入
+    FENCE = 4     // 栅栏、墙等1.5格高的碰撞箱，不可穿过也不可站立
+};
+
 // 节点结构
 struct Node {
     int x, y, z;
-    
+
     Node() : x(0), y(0), z(0) {}
     Node(int x, int y, int z) : x(x), y(y), z(z) {}
+
+    bool operator==(const Node& other) const { return x == other.x && y == other.y && z == other.z; }
 };
 
-// 路径节点结构
+// 路径节点结构（节点池中的元素，父节点与堆位置都是下标）
 struct PathNode : public Node {
-    float g_cost;  // 从起始节点到当前节点的实际成本
-    float h_cost;  // 从当前节点到目标节点的启发式估计成本
-    float f_cost;  // g_cost + h_cost
-    std::shared_ptr<PathNode> parent;  // 父节点
-    
-    PathNode() : Node(), g_cost(0.0f), h_cost(0.0f), f_cost(0.0f), parent(nullptr) {}
-    PathNode(int x, int y, int z) : Node(x, y, z), g_cost(0.0f), h_cost(0.0f), f_cost(0.0f), parent(nullptr) {}
-};
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+    static constexpr uint32_t NOT_IN_HEAP = UINT32_MAX;
 
-// 路径节点比较器（用于优先队列）
-struct PathNodeComparator {
-    bool operator()(const std::shared_ptr<PathNode>& a, const std::shared_ptr<PathNode>& b) const {
-        return a->f_cost > b->f_cost;  // 最小堆
-    }
+    float g_cost;         // 从起始节点到当前节点的实际成本
+    float h_cost;         // 从当前节点到目标节点的启发式估计成本
+    float f_cost;         // g_cost + h_cost
+    uint32_t parent;      // 父节点在节点池中的下标
+    uint32_t heap_index;  // 在开放列表堆中的位置，NOT_IN_HEAP表示不在堆中
+    bool closed;          // 已展开
+
+    PathNode() : PathNode(0, 0, 0) {}
+    PathNode(int x, int y, int z)
+        : Node(x, y, z), g_cost(0.0f), h_cost(0.0f), f_cost(0.0f),
+          parent(NO_PARENT), heap_index(NOT_IN_HEAP), closed(false) {}
 };
 
 // 生物寻路参数
@@ -54,23 +71,234 @@ struct MobPathfindingParams {
     bool avoids_water;      // 是否避开水
     bool avoids_sun;        // 是否避开阳光
     float speed_factor;     // 移动速度因子
+    bool jump_point_search; // 飞行/水生生物在开阔空间中用跳点搜索（见PathfinderOptimizer::set_jump_point_search）
+};
+
+// 段版本戳：缓存结果记录生成时读到的各段版本，任一段版本变化后失效
+struct SectionStamp {
+    int chunk_x, section_y, chunk_z;
+    uint64_t version;
 };
 
+/**
+ * 区块段方块快照 - 16x16x16的PathBlockType，下标(y << 8) | (z << 4) | x
+ *
+ * 段数据以shared_ptr<const>共享：寻路持有的快照不会被后续的方块更新修改，
+ * PathfinderOptimizer更新时对仍被引用的快照/段先复制再写（写时复制）。
+ * 没有上传的段按全OPEN处理（Java可以跳过全空气段）。
+ */
+class SectionBlockSnapshot {
+public:
+    /**
+     * 段内方块与按行预计算的位掩码：每行(y, z)一个16位掩码，第x位对应该行第x格。
+     * 搜索只做位测试，地面移动一次取出相邻三列的掩码。单格修改时增量更新对应的位。
+     */
+    struct SectionBlocks {
+        enum Layer { PASSABLE = 0, SOLID = 1, WATER = 2, LAYER_COUNT = 3 };
+
+        std::array<PathBlockType, 4096> types;
+        std::array<std::array<uint16_t, 256>, LAYER_COUNT> masks;   // [层][(y << 4) | z]
+
+        PathBlockType get(size_t index) const { return types[index]; }
+        void set(size_t index, PathBlockType type);
+        void fill(PathBlockType type);
+    };
+
+    struct Section {
+        std::shared_ptr<const SectionBlocks> blocks;
+        uint64_t version = 0;   // 每次修改递增（全局单调），没有上传的段为0
+    };
+
+    PathBlockType get_block(int x, int y, int z) const;
+    uint64_t section_version(int chunk_x, int section_y, int chunk_z) const;
+    // 各段版本是否与记录一致
+    bool matches(const std::vector<SectionStamp>& stamps) const;
+
+    // 段键：x、z各22位，段y 20位
+    static uint64_t pack_section_key(int chunk_x, int section_y, int chunk_z) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunk_x) & 0x3FFFFF) << 42) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(chunk_z) & 0x3FFFFF) << 20) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(section_y) & 0xFFFFF));
+    }
+
+    size_t section_count() const { return sections.size(); }
+
+private:
+    friend class PathfinderOptimizer;
+
+    std::unordered_map<uint64_t, Section> sections;
+};
+
+// 搜索范围（闭区间），用于区域内的局部搜索
+struct SearchBounds {
+    Node min;
+    Node max;
+
+    bool contains(int x, int y, int z) const {
+        return x >= min.x && x <= max.x && y >= min.y && y <= max.y && z >= min.z && z <= max.z;
+    }
+
+    static SearchBounds section(int chunk_x, int section_y, int chunk_z) {
+        return {Node(chunk_x << 4, section_y << 4, chunk_z << 4),
+                Node((chunk_x << 4) + 15, (section_y << 4) + 15, (chunk_z << 4) + 15)};
+    }
+};
+
+// 单次寻路结果
+struct PathResult {
+    std::vector<Node> nodes;      // 起点到终点（未到达时为到离目标最近的节点）
+    bool reached = false;         // 是否到达目标
+    uint32_t nodes_visited = 0;   // 创建的节点数
+};
+
+/**
+ * FlowField - 从同一目标出发的方向场
+ *
+ * 从目标做一次反向Dijkstra（沿"哪些格子一步可以走到这里"扩展，掉落等单向移动也正确处理），
+ * 每个可达格子记录朝目标的下一步与剩余代价。目标相同的一群生物各自O(1)取下一步，
+ * 代替N次A*。覆盖目标周围radius格（水平）内的区域，生成时记录读到的各段版本，
+ * 任一段变化后不再有效。
+ */
+class FlowField {
+public:
+    struct Step {
+        Node next;
+        float cost;   // 到目标的剩余代价
+    };
+
+    const Node& goal() const { return goal_; }
+    MobType mob_type() const { return mob_type_; }
+    size_t size() const { return steps_.size(); }
+
+    // 朝目标的下一格；不在场内（不可达或超出范围）返回false，位于目标时next为目标本身
+    bool sample(const Node& at, Node& next) const;
+    // 到目标的剩余代价，不在场内为无穷大
+    float cost_to_goal(const Node& at) const;
+    // 沿方向场走到目标的完整路径（含起点与目标），起点不在场内时为空
+    std::vector<Node> trace(const Node& start) const;
+
+    bool is_current(const SectionBlockSnapshot& blocks) const;
+
+private:
+    friend class PathfinderOptimizer;
+
+    Node goal_;
+    MobType mob_type_ = MobType::PASSIVE;
+    std::unordered_map<uint64_t, Step> steps_;
+    std::vector<SectionStamp> section_versions_;   // 生成时读到的段版本
+};
+
+class PathSearch;
+
 // 寻路优化器
 class PathfinderOptimizer {
 public:
+    static constexpr uint32_t DEFAULT_MAX_NODES = 2048;
+
     PathfinderOptimizer();
     ~PathfinderOptimizer();
 
     // 优化寻路计算
-    std::vector<std::shared_ptr<PathNode>> optimize_pathfinding(
+    std::vector<Node> optimize_pathfinding(
         int start_x, int start_y, int start_z,
         int end_x, int end_y, int end_z,
         MobType mob_type);
-    
+
+    /**
+     * A*寻路，在调用时的方块快照上进行，可在多个线程同时调用（节点池按线程复用）
+     * max_nodes限制创建的节点数；到达上限或无路可走时返回到离目标最近节点的部分路径
+     */
+    PathResult find_path(const Node& start, const Node& goal, MobType mob_type,
+                         uint32_t max_nodes = DEFAULT_MAX_NODES);
+    // bounds非空时只在范围内搜索；不限范围且到达目标的结果按(起点, 目标, 生物类型)缓存，
+    // 经过的任一段被修改后失效
+    PathResult find_path(const SectionBlockSnapshot& blocks, const Node& start, const Node& goal,
+                         MobType mob_type, uint32_t max_nodes = DEFAULT_MAX_NODES,
+                         const SearchBounds* bounds = nullptr);
+
+    /**
+     * 开始一次可分片执行的A*（在当前快照上），由调用方反复step()直到完成；
+     * 路径缓存命中时返回的搜索已经完成
+     */
+    std::unique_ptr<PathSearch> begin_search(const Node& start, const Node& goal, MobType mob_type,
+                                             uint32_t max_nodes = DEFAULT_MAX_NODES);
+
+    // 从start出发在bounds内做Dijkstra，返回到各目标的最小代价（不可达为无穷大）
+    std::vector<float> region_costs(const SectionBlockSnapshot& blocks, const Node& start,
+                                    const std::vector<Node>& targets, MobType mob_type,
+                                    const SearchBounds& bounds, uint32_t max_nodes = DEFAULT_MAX_NODES);
+
+    // 枚举段内可行格子一步离开该段的所有移动visit(段内格, 段外落点, 代价)（与搜索使用相同的移动规则）
+    void for_each_section_exit(const SectionBlockSnapshot& blocks, int chunk_x, int section_y, int chunk_z,
+                               MobType mob_type,
+                               const std::function<void(const Node&, const Node&, float)>& visit);
+
+    // 格子是否可作为该生物的路径点
+    bool is_node_valid(const SectionBlockSnapshot& blocks, const Node& node, MobType mob_type);
+
     // 获取生物寻路参数
     const MobPathfindingParams& get_mob_params(MobType mob_type);
-    
+
+    /**
+     * 三维跳点搜索（默认开启，只作用于jump_point_search的飞行/水生生物且有目标的搜索）：
+     * 开阔的空气/水域是均匀网格，A*会展开大量代价相同的对称节点。跳点搜索从每个展开的节点
+     * 沿各移动方向直线前进，途经的格子周围3x3x3都可进入时不入堆，直到邻域出现障碍、
+     * 与目标在该方向的坐标对齐、到达目标或走满MAX_JUMP_DISTANCE格才创建节点。
+     * 障碍附近每格都停下（退化为A*），开阔空间中路径仍为最优；返回的路径逐格补全。
+     */
+    void set_jump_point_search(bool enabled) { jump_point_search_enabled.store(enabled, std::memory_order_relaxed); }
+    bool jump_point_search() const { return jump_point_search_enabled.load(std::memory_order_relaxed); }
+    static constexpr int MAX_JUMP_DISTANCE = 32;
+
+    // ===== 方块快照更新（Java在区块加载/方块变化时调用） =====
+    void set_section(int chunk_x, int section_y, int chunk_z, const uint8_t* types);
+    void set_block(int x, int y, int z, PathBlockType type);
+    void clear_chunk(int chunk_x, int chunk_z);
+    // 当前快照（不会再被修改）
+    std::shared_ptr<const SectionBlockSnapshot> snapshot() const;
+
+    /**
+     * 方块状态id（Block.BLOCK_STATE_REGISTRY） -> PathBlockType的分类表，由Java按每个方块状态的
+     * 碰撞箱与流体计算一次后上传。设置后寻路快照可以从共享的方块状态快照（BlockStateStore）同步，
+     * 不再需要Java逐段上传；表外的id与未知分类按SOLID处理
+     */
+    void set_block_type_table(const uint8_t* types, size_t count);
+    bool has_block_type_table() const;
+    /**
+     * 把blocks相对上次同步的快照中变化的段按分类表转换后写入寻路快照，返回写入的段数
+     * 没有分类表时不做任何事（返回0）
+     */
+    size_t sync_block_states(std::shared_ptr<const BlockStateSnapshot> blocks);
+
+    // ===== 方向场（同一目标的群体寻路） =====
+    static constexpr int DEFAULT_FLOW_FIELD_RADIUS = 48;
+    static constexpr uint32_t MAX_FLOW_FIELD_NODES = 65536;
+    static constexpr size_t MAX_CACHED_FLOW_FIELDS = 64;
+
+    // 取缓存的方向场，不存在或段已变化时在blocks上重新生成
+    std::shared_ptr<const FlowField> get_flow_field(const SectionBlockSnapshot& blocks, const Node& goal,
+                                                    MobType mob_type, int radius = DEFAULT_FLOW_FIELD_RADIUS);
+    std::shared_ptr<const FlowField> build_flow_field(const SectionBlockSnapshot& blocks, const Node& goal,
+                                                      MobType mob_type, int radius = DEFAULT_FLOW_FIELD_RADIUS);
+
+    // ===== 路径缓存（固定起终点之间的重复寻路，如村民往返床位） =====
+    static constexpr size_t MAX_CACHED_PATHS = 4096;
+
+    size_t cached_paths() const;
+    void clear_path_cache();
+
+    struct Stats {
+        std::atomic<uint64_t> searches{0};
+        std::atomic<uint64_t> reached{0};
+        std::atomic<uint64_t> nodes_visited{0};
+        std::atomic<uint64_t> budget_exhausted{0};   // 因max_nodes停止
+        std::atomic<uint64_t> flow_fields_built{0};
+        std::atomic<uint64_t> flow_field_hits{0};
+        std::atomic<uint64_t> path_cache_hits{0};
+        std::atomic<uint64_t> path_cache_invalidated{0};   // 经过的段被修改而丢弃
+    };
+    const Stats& get_stats() const { return stats; }
+
     // 获取单例实例
     static PathfinderOptimizer& get_instance() {
         static PathfinderOptimizer instance;
@@ -78,23 +306,154 @@ public:
     }
 
 private:
+    friend class PathSearch;
+    class SearchContext;
+
     // 重构路径
-    std::vector<std::shared_ptr<PathNode>> reconstruct_path(std::shared_ptr<PathNode> node);
-    
+    std::vector<Node> reconstruct_path(const SearchContext& context, uint32_t node) const;
+
     // 计算启发式函数
-    float calculate_heuristic(std::shared_ptr<PathNode> a, std::shared_ptr<PathNode> b);
-    
-    // 计算移动成本
-    float calculate_move_cost(std::shared_ptr<PathNode> from, const Node& direction, const MobPathfindingParams& params);
-    
-    // 检查节点是否可行走
-    bool is_walkable(int x, int y, int z, const MobPathfindingParams& params);
-    
+    static float calculate_heuristic(const Node& a, const Node& b);
+
+    // 计算移动成本（进入目标格的附加代价，不含距离）
+    static float calculate_move_cost(bool in_water, const MobPathfindingParams& params);
+
+    // 检查节点是否可行走（地面生物：脚、头可穿过且脚下可站立或在水中）
+    static bool is_walkable(SearchContext& context, int x, int y, int z,
+                            const MobPathfindingParams& params);
+    // 飞行/水生生物可进入的格子
+    static bool is_enterable(SearchContext& context, int x, int y, int z,
+                             const MobPathfindingParams& params);
+    static bool is_node_valid(SearchContext& context, int x, int y, int z,
+                              const MobPathfindingParams& params);
+
+    // 对from处每个可行的移动调用visit(x, y, z, cost)
+    template <typename Visit>
+    static void generate_moves(SearchContext& context, const Node& from,
+                               const MobPathfindingParams& params, Visit&& visit);
+
+    // A*（goal为空时为Dijkstra）；settled对每个出堆节点调用，返回true时停止并返回该节点，
+    // 否则返回启发值最小的节点
+    template <typename Settled>
+    uint32_t run_search(SearchContext& context, const Node& start, const Node* goal,
+                        const MobPathfindingParams& params, const SearchBounds* bounds,
+                        Settled&& settled) const;
+    // 起点入堆，返回起点下标
+    static uint32_t seed_search(SearchContext& context, const Node& start, const Node* goal);
+    // 最多出堆max_expansions个节点；settled返回true时返回该节点，否则返回UINT32_MAX，
+    // best更新为目前启发值最小的节点
+    template <typename Settled>
+    uint32_t advance_search(SearchContext& context, const Node* goal, const MobPathfindingParams& params,
+                            const SearchBounds* bounds, uint32_t max_expansions, uint32_t& best,
+                            Settled&& settled) const;
+
+    // 展开节点的所有邻居（goal为空时启发值为0，bounds非空时不进入范围外的格子）
+    void expand_neighbors(SearchContext& context, uint32_t current, const Node* goal,
+                          const MobPathfindingParams& params, const SearchBounds* bounds) const;
+    // 跳点搜索：from沿(dx, dy, dz)（第一步已确认可行）直线前进的格数，至少为1
+    static int jump_distance(SearchContext& context, const Node& from, int dx, int dy, int dz, const Node& goal,
+                             const MobPathfindingParams& params, const SearchBounds* bounds);
+    // 周围3x3x3的格子是否都可进入（从该格出发的任何移动都可行）
+    static bool open_neighborhood(SearchContext& context, int x, int y, int z, const MobPathfindingParams& params);
+
+    struct PathCacheKey {
+        Node start;
+        Node goal;
+        MobType mob_type;
+
+        bool operator==(const PathCacheKey& other) const {
+            return start == other.start && goal == other.goal && mob_type == other.mob_type;
+        }
+    };
+    struct PathCacheKeyHash {
+        size_t operator()(const PathCacheKey& key) const;
+    };
+    struct CachedPath {
+        std::vector<Node> nodes;
+        std::vector<SectionStamp> sections;   // 路径经过（含脚下与头顶）的段
+    };
+
+    bool lookup_cached_path(const SectionBlockSnapshot& blocks, const PathCacheKey& key, PathResult& result);
+    void store_cached_path(const SectionBlockSnapshot& blocks, const PathCacheKey& key, const PathResult& result);
+    // 一次搜索结束：更新统计，cacheable时缓存到达目标的路径
+    void finish_search(const SectionBlockSnapshot& blocks, const PathCacheKey& key, const PathResult& result,
+                       bool budget_hit, bool cacheable);
+
+    // 写时复制：返回可修改的快照
+    SectionBlockSnapshot& mutable_snapshot_locked();
+
     // 不同生物类型的寻路参数
     std::unordered_map<MobType, MobPathfindingParams> mob_params;
-    std::unordered_map<uint64_t, std::vector<std::shared_ptr<PathNode>>> path_cache;
+    std::atomic<bool> jump_point_search_enabled{true};
+    std::shared_ptr<SectionBlockSnapshot> blocks;
+    uint64_t next_version = 1;
     mutable std::mutex optimizer_mutex;
+
+    // 从共享方块状态同步（block_sync_mutex保护）
+    mutable std::mutex block_sync_mutex;
+    std::vector<uint8_t> block_type_table;
+    std::shared_ptr<const BlockStateSnapshot> synced_block_states;   // 上次同步的快照
+
+    // 方向场缓存：(目标, 生物类型) -> 方向场，按段版本失效
+    std::mutex flow_field_mutex;
+    std::unordered_map<uint64_t, std::shared_ptr<const FlowField>> flow_fields;
+
+    // 路径缓存：(起点, 目标, 生物类型) -> 到达目标的路径，按经过的段版本失效
+    mutable std::mutex path_cache_mutex;
+    std::unordered_map<PathCacheKey, CachedPath, PathCacheKeyHash> path_cache;
+    Stats stats;
+};
+
+/**
+ * PathSearch - 可分片执行的A*
+ *
+ * 持有自己的工作区与开始时的快照，step()每次最多展开给定数量的节点后返回，
+ * 开放/关闭列表留在对象中，下次从中断处继续。用于把单次搜索分摊到多个tick，
+ * 避免一次展开上千个节点造成的卡顿。完成后释放工作区。
+ */
+class PathSearch : public core::SlabAllocated {
+public:
+    enum class Status {
+        RUNNING,     // 尚未完成
+        REACHED,     // 到达目标
+        EXHAUSTED    // 无路可走或到达节点上限，结果为到离目标最近节点的部分路径
+    };
+
+    ~PathSearch();
+
+    PathSearch(const PathSearch&) = delete;
+    PathSearch& operator=(const PathSearch&) = delete;
+
+    // 最多展开max_expansions个节点，返回之后的状态
+    Status step(uint32_t max_expansions);
+
+    Status status() const { return status_; }
+    bool done() const { return status_ != Status::RUNNING; }
+    const Node& start() const { return start_; }
+    const Node& goal() const { return goal_; }
+    MobType mob_type() const { return mob_type_; }
+    uint32_t nodes_expanded() const { return expanded_; }
+
+    // 完成后的结果；进行中时为到目前离目标最近节点的部分路径
+    PathResult result() const;
+
+private:
+    friend class PathfinderOptimizer;
+
+    PathSearch(PathfinderOptimizer& optimizer, std::shared_ptr<const SectionBlockSnapshot> blocks,
+               const Node& start, const Node& goal, MobType mob_type, uint32_t max_nodes);
+
+    PathfinderOptimizer& optimizer_;
+    std::shared_ptr<const SectionBlockSnapshot> blocks_;
+    std::unique_ptr<PathfinderOptimizer::SearchContext> context_;   // 完成后释放
+    Node start_;
+    Node goal_;
+    MobType mob_type_;
+    Status status_ = Status::RUNNING;
+    uint32_t best_ = 0;
+    uint32_t expanded_ = 0;
+    PathResult result_;   // 完成后有效
 };
 
 } // namespace world
-} // namespace lattice
\ No newline at end of file
+} // namespace lattice
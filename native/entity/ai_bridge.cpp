@@ -394,6 +394,26 @@ Java_com_lattice_ai_BehaviorNodes_createFlyingBehaviorNode(
     });
 }
 
+/**
+ * JNI版本：Java_com_lattice_ai_BehaviorNodes_createGroupSteeringNode
+ */
+extern "C" JNIEXPORT jlong JNICALL
+Java_com_lattice_ai_BehaviorNodes_createGroupSteeringNode(
+    JNIEnv* env, jclass clazz, jfloat neighborRadius, jfloat separationRadius,
+    jfloat maxSpeed, jint minGroupSize, jboolean threeDimensional)
+{
+    return executeWithExceptionHandling(env, [&]() -> jlong {
+        GroupSteeringNode::Params params;
+        params.neighborRadius = neighborRadius;
+        params.separationRadius = separationRadius;
+        params.maxSpeed = maxSpeed;
+        params.minGroupSize = static_cast<uint32_t>(std::max<jint>(minGroupSize, 2));
+        params.threeDimensional = threeDimensional == JNI_TRUE;
+        auto* node = new GroupSteeringNode(params);
+        return reinterpret_cast<jlong>(node);
+    });
+}
+
 /**
  * JNI版本：Java_com_lattice_ai_BehaviorNodes_deleteNode
  */
@@ -2,6 +2,7 @@
 
 #include "biological_ai.hpp"
 #include "fmt_wrapper.hpp"
+#include "../core/simd_dispatch.hpp"
 #include <cmath>
 #include <algorithm>
 #include <vector>
@@ -66,8 +67,33 @@ public:
         return false;
     }
     
+    void tickBatch(EntityBatch& batch, const std::vector<uint32_t>& lanes, std::vector<uint8_t>& results) override {
+        for (uint32_t lane : lanes) {
+            const float x = batch.x[lane];
+            const float y = batch.y[lane];
+            const float z = batch.z[lane];
+            float closestDistance = std::numeric_limits<float>::max();
+            uint64_t closestPlayer = 0;
+            for (const auto& [entityId, entityState] : batch.worlds[lane]->nearbyEntities) {
+                if (entityId < 1000) {
+                    float distance = distance3D(x, y, z, entityState.x, entityState.y, entityState.z);
+                    if (distance < closestDistance) {
+                        closestDistance = distance;
+                        closestPlayer = entityId;
+                    }
+                }
+            }
+            results[lane] = closestPlayer != 0;
+            if (closestPlayer != 0) {
+                batch.targetId[lane] = closestPlayer;
+                batch.targetDistance[lane] = closestDistance;
+            }
+        }
+    }
+    
     void reset() override {}
     std::string getNodeType() const override { return "LookAtPlayer"; }
+    BehaviorNodeKind getNodeKind() const override { return BehaviorNodeKind::LOOK_AT_PLAYER; }
 };
 
 /**
@@ -114,6 +140,7 @@ public:
     
     void reset() override {}
     std::string getNodeType() const override { return "MeleeAttack"; }
+    BehaviorNodeKind getNodeKind() const override { return BehaviorNodeKind::MELEE_ATTACK; }
     
 private:
     float attackRange_;
@@ -126,31 +153,41 @@ private:
 class AvoidEntityNode : public BehaviorNodeBase {
 public:
     AvoidEntityNode(const std::unordered_set<std::string>& threats)
-        : threats_(threats) {}
+        : threats_(threats),
+          avoidsFire_(threats.count("fire") != 0),
+          avoidsPlayers_(threats.count("player") != 0) {}
     
     bool tick(EntityState& state, const WorldView& world) override {
+        if (!avoidsFire_ && !avoidsPlayers_) {
+            return false;
+        }
         bool hasThreat = false;
         float closestThreat = std::numeric_limits<float>::max();
-        
-        for (const auto& [entityId, entityState] : world.nearbyEntities) {
-            if (entityId == state.entityId) continue;
-            
-            float distance = distance3D(state.x, state.y, state.z,
-                                      entityState.x, entityState.y, entityState.z);
-            
+        auto consider = [&](uint64_t entityId, bool isOnFire, float distance) {
             // 检查威胁类型
-            if (threats_.find("fire") != threats_.end() && entityState.isOnFire) {
+            if ((avoidsFire_ && isOnFire) || (avoidsPlayers_ && entityId < 1000)) {
                 hasThreat = true;
                 closestThreat = std::min(closestThreat, distance);
             }
-            
-            if (threats_.find("player") != threats_.end() && entityId < 1000) {
-                hasThreat = true;
-                closestThreat = std::min(closestThreat, distance);
+        };
+        
+        if (world.neighbors) {
+            // 只有逃避范围内的威胁会触发逃跑，查询共享网格即可
+            world.neighbors->forEachInRange(state.x, state.y, state.z, AVOID_RANGE,
+                [&](const NeighborIndex::Entry& entity, float distance) {
+                    if (entity.id != state.entityId) {
+                        consider(entity.id, entity.isOnFire, distance);
+                    }
+                });
+        } else {
+            for (const auto& [entityId, entityState] : world.nearbyEntities) {
+                if (entityId == state.entityId) continue;
+                consider(entityId, entityState.isOnFire,
+                         distance3D(state.x, state.y, state.z, entityState.x, entityState.y, entityState.z));
             }
         }
         
-        if (hasThreat && closestThreat < 8.0f) {
+        if (hasThreat && closestThreat < AVOID_RANGE) {
             state.behaviorState = EntityState::BehaviorState::FLEEING;
             return true;
         }
@@ -174,9 +211,14 @@ public:
     
     void reset() override {}
     std::string getNodeType() const override { return "AvoidEntity"; }
+    BehaviorNodeKind getNodeKind() const override { return BehaviorNodeKind::AVOID_ENTITY; }
     
 private:
+    static constexpr float AVOID_RANGE = 8.0f;
+    
     std::unordered_set<std::string> threats_;
+    bool avoidsFire_;
+    bool avoidsPlayers_;
 };
 
 /**
@@ -364,14 +406,202 @@ public:
         return true;
     }
     
+    void tickBatch(EntityBatch& batch, const std::vector<uint32_t>& lanes, std::vector<uint8_t>& results) override {
+        for (uint32_t lane : lanes) {
+            results[lane] = 1;
+            if (batch.y[lane] > maxAltitude_) {
+                batch.velocityY[lane] = -flightSpeed_;
+                continue;
+            }
+            if (std::rand() % 100 < 3) {
+                batch.velocityY[lane] = (std::rand() % 100 - 50) / 100.0f * flightSpeed_;
+            }
+            if (std::rand() % 100 < 10) {
+                batch.velocityX[lane] = (std::rand() % 100 - 50) / 100.0f * flightSpeed_;
+                batch.velocityZ[lane] = (std::rand() % 100 - 50) / 100.0f * flightSpeed_;
+            }
+            if (batch.lightLevel[lane] < 4.0f) {
+                batch.velocityX[lane] *= 1.5f;
+                batch.velocityZ[lane] *= 1.5f;
+            }
+        }
+    }
+    
     void reset() override {}
     std::string getNodeType() const override { return "FlyingBehavior"; }
+    BehaviorNodeKind getNodeKind() const override { return BehaviorNodeKind::FLYING; }
     
 private:
     float flightSpeed_;
     float maxAltitude_;
 };
 
+/**
+ * @brief 群体移动节点（boids：分离、对齐、聚合）
+ *
+ * 行为树按实体类型共享，批量tick时同一类型的实体在一个批次里；批次内彼此距离不超过neighborRadius的
+ * 实体互为同伴（鱼群、蜂群、兽群）。同伴从共享邻居索引（WorldView::neighbors）的网格查询得到，
+ * 相对位置与速度整理成连续数组后由simdKernels().accumulateFlock一次累加三项。
+ *
+ * 同伴不少于minGroupSize - 1个的实体按三项调整速度并返回成功；放在优先级选择器中寻路、
+ * 游荡类节点之前时，群体中的个体因此跳过逐个实体的寻路，落单的实体返回失败，交给后面的节点。
+ * 所有实体按本tick开始时的速度计算，再一起写回，结果与批次内的顺序无关。
+ *
+ * 逐个执行（tick）时看不到同批的同伴，直接返回失败。
+ */
+class GroupSteeringNode : public BehaviorNodeBase {
+public:
+    struct Params {
+        float neighborRadius = 6.0f;        // 同伴范围（格）
+        float separationRadius = 1.5f;      // 小于这个距离时互相推开
+        float separationWeight = 1.5f;
+        float alignmentWeight = 1.0f;
+        float cohesionWeight = 0.8f;
+        float maxSpeed = 0.4f;              // 格/tick
+        float turnRate = 0.2f;              // 每tick朝期望速度调整的比例
+        uint32_t minGroupSize = 3;          // 含自己
+        uint32_t maxNeighbors = 32;         // 每个实体最多考虑的同伴数
+        bool threeDimensional = true;       // 鱼群、蜂群；兽群为false，只在水平面内转向
+    };
+    
+    GroupSteeringNode() : GroupSteeringNode(Params{}) {}
+    explicit GroupSteeringNode(const Params& params) : params_(params) {
+        params_.neighborRadius = std::max(params_.neighborRadius, 0.1f);
+        params_.separationRadius = clamp(params_.separationRadius, 0.01f, params_.neighborRadius);
+        params_.maxNeighbors = std::max<uint32_t>(params_.maxNeighbors, 1);
+    }
+    
+    bool tick(EntityState& /*state*/, const WorldView& /*world*/) override {
+        return false;
+    }
+    
+    void tickBatch(EntityBatch& batch, const std::vector<uint32_t>& lanes, std::vector<uint8_t>& results) override {
+        thread_local Scratch scratch;
+        scratch.begin(batch, params_.maxNeighbors);
+        
+        const float neighborRadiusSq = params_.neighborRadius * params_.neighborRadius;
+        const float separationRadiusSq = params_.separationRadius * params_.separationRadius;
+        const core::SimdKernels& kernels = core::simdKernels();
+        
+        // 先按tick开始时的速度算出所有期望速度，之后统一写回
+        scratch.steered.clear();
+        for (uint32_t lane : lanes) {
+            results[lane] = 0;
+            const float x = batch.x[lane];
+            const float y = batch.y[lane];
+            const float z = batch.z[lane];
+            
+            size_t count = 0;
+            auto addMate = [&](uint32_t other) {
+                if (other == lane || count >= params_.maxNeighbors) {
+                    return;
+                }
+                scratch.dx[count] = batch.x[other] - x;
+                scratch.dy[count] = params_.threeDimensional ? batch.y[other] - y : 0.0f;
+                scratch.dz[count] = batch.z[other] - z;
+                scratch.vx[count] = batch.velocityX[other];
+                scratch.vy[count] = params_.threeDimensional ? batch.velocityY[other] : 0.0f;
+                scratch.vz[count] = batch.velocityZ[other];
+                ++count;
+            };
+            
+            if (const NeighborIndex* neighbors = batch.worlds[lane]->neighbors) {
+                // 网格里也有其他类型的实体，只有同一批次的才是同伴
+                neighbors->forEachInRange(x, y, z, params_.neighborRadius,
+                    [&](const NeighborIndex::Entry& entry, float /*distance*/) {
+                        auto it = scratch.laneOf.find(entry.id);
+                        if (it != scratch.laneOf.end()) {
+                            addMate(it->second);
+                        }
+                    });
+            } else {
+                // 不在引擎中（没有共享索引）时逐个比较
+                for (uint32_t other = 0; other < batch.size(); ++other) {
+                    const float dx = batch.x[other] - x;
+                    const float dy = batch.y[other] - y;
+                    const float dz = batch.z[other] - z;
+                    if (dx * dx + dy * dy + dz * dz <= neighborRadiusSq) {
+                        addMate(other);
+                    }
+                }
+            }
+            if (count + 1 < params_.minGroupSize || count == 0) {
+                continue;
+            }
+            
+            float sums[9];
+            kernels.accumulateFlock(scratch.dx.data(), scratch.dy.data(), scratch.dz.data(), scratch.vx.data(),
+                                    scratch.vy.data(), scratch.vz.data(), count, separationRadiusSq, sums);
+            
+            const float inverse = 1.0f / static_cast<float>(count);
+            const float velocity[3] = {batch.velocityX[lane], batch.velocityY[lane], batch.velocityZ[lane]};
+            float desired[3];
+            for (int axis = 0; axis < 3; ++axis) {
+                // 聚合：朝同伴重心，按范围归一化；对齐：同伴平均速度与自己速度之差；分离：越近推得越开
+                const float cohesion = sums[axis] * inverse / params_.neighborRadius * params_.maxSpeed;
+                const float alignment = sums[3 + axis] * inverse - velocity[axis];
+                const float separation = sums[6 + axis] * params_.separationRadius * params_.maxSpeed;
+                const float steer = params_.cohesionWeight * cohesion + params_.alignmentWeight * alignment +
+                                    params_.separationWeight * separation;
+                desired[axis] = velocity[axis] + steer * params_.turnRate;
+            }
+            if (!params_.threeDimensional) {
+                desired[1] = velocity[1];
+            }
+            
+            const float horizontalSq = desired[0] * desired[0] + desired[2] * desired[2];
+            const float speedSq = horizontalSq + (params_.threeDimensional ? desired[1] * desired[1] : 0.0f);
+            const float maxSpeedSq = params_.maxSpeed * params_.maxSpeed;
+            if (speedSq > maxSpeedSq) {
+                const float scale = params_.maxSpeed / std::sqrt(speedSq);
+                desired[0] *= scale;
+                desired[2] *= scale;
+                if (params_.threeDimensional) {
+                    desired[1] *= scale;
+                }
+            }
+            scratch.steered.push_back(Steered{lane, desired[0], desired[1], desired[2]});
+            results[lane] = 1;
+        }
+        
+        for (const Steered& steered : scratch.steered) {
+            batch.velocityX[steered.lane] = steered.vx;
+            batch.velocityY[steered.lane] = steered.vy;
+            batch.velocityZ[steered.lane] = steered.vz;
+        }
+    }
+    
+    void reset() override {}
+    std::string getNodeType() const override { return "GroupSteering"; }
+    
+    const Params& getParams() const { return params_; }
+    
+private:
+    struct Steered {
+        uint32_t lane;
+        float vx, vy, vz;
+    };
+    
+    // 每个线程复用的缓冲区
+    struct Scratch {
+        std::unordered_map<uint64_t, uint32_t> laneOf;
+        std::vector<float> dx, dy, dz, vx, vy, vz;
+        std::vector<Steered> steered;
+        
+        void begin(const EntityBatch& batch, uint32_t maxNeighbors) {
+            laneOf.clear();
+            for (uint32_t lane = 0; lane < batch.size(); ++lane) {
+                laneOf.emplace(batch.states[lane]->entityId, lane);
+            }
+            for (auto* column : {&dx, &dy, &dz, &vx, &vy, &vz}) {
+                column->resize(maxNeighbors);
+            }
+        }
+    };
+    
+    Params params_;
+};
+
 /**
  * @brief 觅食节点
  */
@@ -572,6 +802,28 @@ public:
         return false;
     }
     
+    // 每个子节点只执行仍未成功的实体
+    void tickBatch(EntityBatch& batch, const std::vector<uint32_t>& lanes, std::vector<uint8_t>& results) override {
+        std::vector<uint32_t> pending = lanes;
+        std::vector<uint32_t> next;
+        for (uint32_t lane : lanes) {
+            results[lane] = 0;
+        }
+        for (auto& child : children_) {
+            if (pending.empty()) {
+                break;
+            }
+            child->tickBatch(batch, pending, results);
+            next.clear();
+            for (uint32_t lane : pending) {
+                if (!results[lane]) {
+                    next.push_back(lane);
+                }
+            }
+            pending.swap(next);
+        }
+    }
+    
     void reset() override {
         for (auto& child : children_) {
             child->reset();
@@ -579,6 +831,10 @@ public:
     }
     
     std::string getNodeType() const override { return "PrioritySelector"; }
+    BehaviorNodeKind getNodeKind() const override { return BehaviorNodeKind::PRIORITY_SELECTOR; }
+    
+    // 交出子节点（行为树编译器使用），之后该节点为空
+    std::vector<std::unique_ptr<BehaviorNodeBase>> releaseChildren() { return std::move(children_); }
     
 private:
     std::vector<std::unique_ptr<BehaviorNodeBase>> children_;
@@ -602,6 +858,28 @@ public:
         return true; // 所有子节点都成功
     }
     
+    // 每个子节点只执行到目前为止都成功的实体
+    void tickBatch(EntityBatch& batch, const std::vector<uint32_t>& lanes, std::vector<uint8_t>& results) override {
+        std::vector<uint32_t> pending = lanes;
+        std::vector<uint32_t> next;
+        for (uint32_t lane : lanes) {
+            results[lane] = 1;
+        }
+        for (auto& child : children_) {
+            if (pending.empty()) {
+                break;
+            }
+            child->tickBatch(batch, pending, results);
+            next.clear();
+            for (uint32_t lane : pending) {
+                if (results[lane]) {
+                    next.push_back(lane);
+                }
+            }
+            pending.swap(next);
+        }
+    }
+    
     void reset() override {
         currentChild_ = 0;
         for (auto& child : children_) {
@@ -610,6 +888,10 @@ public:
     }
     
     std::string getNodeType() const override { return "Sequence"; }
+    BehaviorNodeKind getNodeKind() const override { return BehaviorNodeKind::SEQUENCE; }
+    
+    // 交出子节点（行为树编译器使用），之后该节点为空
+    std::vector<std::unique_ptr<BehaviorNodeBase>> releaseChildren() { return std::move(children_); }
     
 private:
     std::vector<std::unique_ptr<BehaviorNodeBase>> children_;
@@ -638,6 +920,19 @@ public:
         return successCount >= requiredSuccesses_;
     }
     
+    void tickBatch(EntityBatch& batch, const std::vector<uint32_t>& lanes, std::vector<uint8_t>& results) override {
+        std::vector<int> successCount(lanes.size(), 0);
+        for (auto& child : children_) {
+            child->tickBatch(batch, lanes, results);
+            for (size_t i = 0; i < lanes.size(); ++i) {
+                successCount[i] += results[lanes[i]];
+            }
+        }
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            results[lanes[i]] = successCount[i] >= requiredSuccesses_;
+        }
+    }
+    
     void reset() override {
         for (auto& child : children_) {
             child->reset();
@@ -645,6 +940,11 @@ public:
     }
     
     std::string getNodeType() const override { return "Parallel"; }
+    BehaviorNodeKind getNodeKind() const override { return BehaviorNodeKind::PARALLEL; }
+    int getRequiredSuccesses() const { return requiredSuccesses_; }
+    
+    // 交出子节点（行为树编译器使用），之后该节点为空
+    std::vector<std::unique_ptr<BehaviorNodeBase>> releaseChildren() { return std::move(children_); }
     
 private:
     std::vector<std::unique_ptr<BehaviorNodeBase>> children_;
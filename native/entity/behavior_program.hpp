@@ -0,0 +1,204 @@
+#pragma once
+
+#include "behavior_nodes.hpp"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace lattice::entity {
+
+// ====== 行为树编译 ======
+
+/**
+ * @brief 编译后的行为树 - 指令数组 + 显式栈执行
+ *
+ * compile()把一棵行为树按先序展开为连续的指令数组，组合节点在编译时释放，只保留叶子节点。
+ * 组合节点的指令记录子节点数和子树末尾的下标；执行时用显式栈代替递归，
+ * 不再经过组合节点的虚函数和children_里的指针。
+ *
+ * 常用叶子节点（注视玩家、近战、逃避、飞行）按指令的操作码经跳转表以非虚调用执行，
+ * 其余叶子节点走虚函数tick()。语义与逐节点执行相同：选择器遇到成功即返回，
+ * 序列遇到失败即返回，并行节点执行全部子节点后按成功数判断。
+ *
+ * 现有节点只返回成功/失败，没有“运行中”状态，所以每次执行都从根开始，
+ * 不需要为每个实体保存恢复位置；显式栈是每个线程的临时缓冲。
+ */
+class CompiledBehaviorTree : public BehaviorNodeBase {
+public:
+    enum class Op : uint8_t {
+        PRIORITY_SELECTOR,
+        SEQUENCE,
+        PARALLEL,
+        LEAF,
+        LOOK_AT_PLAYER,
+        MELEE_ATTACK,
+        AVOID_ENTITY,
+        FLYING,
+        COUNT
+    };
+
+    struct Instruction {
+        Op op;
+        uint32_t arg;   // 组合节点：子节点数；叶子节点：leaves_下标
+        uint32_t end;   // 子树之后第一条指令的下标
+        int32_t param;  // 并行节点：需要的成功数
+    };
+
+    static std::unique_ptr<CompiledBehaviorTree> compile(std::unique_ptr<BehaviorNodeBase> root) {
+        if (!root) {
+            throw std::invalid_argument("behavior tree root is null");
+        }
+        auto program = std::unique_ptr<CompiledBehaviorTree>(new CompiledBehaviorTree());
+        program->emit(std::move(root), 1);
+        return program;
+    }
+
+    bool tick(EntityState& state, const WorldView& world) override {
+        thread_local std::vector<Frame> stack;
+        stack.clear();
+
+        uint32_t pc = 0;
+        for (;;) {
+            const Instruction& ins = code_[pc];
+            bool result;
+            uint32_t done;
+            if (ins.op <= Op::PARALLEL) {
+                if (ins.arg != 0) {
+                    stack.push_back(Frame{pc, 0});
+                    ++pc;
+                    continue;
+                }
+                // 空组合节点：序列成功，选择器失败，并行节点按0个成功判断
+                result = ins.op == Op::SEQUENCE || (ins.op == Op::PARALLEL && ins.param <= 0);
+                done = ins.end;
+            } else {
+                result = LEAF_TABLE[static_cast<size_t>(ins.op)](leaves_[ins.arg].get(), state, world);
+                done = pc + 1;
+            }
+
+            // 把结果交给父节点，直到某个父节点还有下一个子节点要执行
+            for (;;) {
+                if (stack.empty()) {
+                    return result;
+                }
+                Frame& frame = stack.back();
+                const Instruction& parent = code_[frame.pc];
+                bool finished = false;
+                switch (parent.op) {
+                    case Op::PRIORITY_SELECTOR:
+                        finished = result;
+                        break;
+                    case Op::SEQUENCE:
+                        finished = !result;
+                        break;
+                    default:
+                        frame.successes += result ? 1 : 0;
+                        break;
+                }
+                if (!finished && done < parent.end) {
+                    pc = done;
+                    break;
+                }
+                if (!finished) {
+                    // 全部子节点执行完
+                    result = parent.op == Op::SEQUENCE ||
+                             (parent.op == Op::PARALLEL && frame.successes >= parent.param);
+                }
+                done = parent.end;
+                stack.pop_back();
+            }
+        }
+    }
+
+    void reset() override {
+        for (auto& leaf : leaves_) {
+            leaf->reset();
+        }
+    }
+
+    std::string getNodeType() const override { return "Compiled"; }
+
+    const std::vector<Instruction>& instructions() const { return code_; }
+    size_t leafCount() const { return leaves_.size(); }
+    uint32_t maxDepth() const { return maxDepth_; }
+
+private:
+    struct Frame {
+        uint32_t pc;
+        int32_t successes;
+    };
+
+    using LeafFn = bool (*)(BehaviorNodeBase* node, EntityState& state, const WorldView& world);
+
+    template <typename Node>
+    static bool callLeaf(BehaviorNodeBase* node, EntityState& state, const WorldView& world) {
+        return static_cast<Node*>(node)->Node::tick(state, world);
+    }
+
+    static bool callVirtual(BehaviorNodeBase* node, EntityState& state, const WorldView& world) {
+        return node->tick(state, world);
+    }
+
+    // 下标为Op，组合节点的位置不会被调用
+    static constexpr std::array<LeafFn, static_cast<size_t>(Op::COUNT)> LEAF_TABLE = {
+        nullptr, nullptr, nullptr,
+        &callVirtual,
+        &callLeaf<LookAtPlayerNode>,
+        &callLeaf<MeleeAttackNode>,
+        &callLeaf<AvoidEntityNode>,
+        &callLeaf<FlyingBehaviorNode>
+    };
+
+    CompiledBehaviorTree() = default;
+
+    void emit(std::unique_ptr<BehaviorNodeBase> node, uint32_t depth) {
+        maxDepth_ = std::max(maxDepth_, depth);
+        const uint32_t at = static_cast<uint32_t>(code_.size());
+        code_.push_back(Instruction{Op::LEAF, 0, 0, 0});
+
+        std::vector<std::unique_ptr<BehaviorNodeBase>> children;
+        Op op;
+        int32_t param = 0;
+        switch (node->getNodeKind()) {
+            case BehaviorNodeKind::PRIORITY_SELECTOR:
+                op = Op::PRIORITY_SELECTOR;
+                children = static_cast<PrioritySelector*>(node.get())->releaseChildren();
+                break;
+            case BehaviorNodeKind::SEQUENCE:
+                op = Op::SEQUENCE;
+                children = static_cast<SequenceNode*>(node.get())->releaseChildren();
+                break;
+            case BehaviorNodeKind::PARALLEL:
+                op = Op::PARALLEL;
+                param = static_cast<ParallelNode*>(node.get())->getRequiredSuccesses();
+                children = static_cast<ParallelNode*>(node.get())->releaseChildren();
+                break;
+            case BehaviorNodeKind::LOOK_AT_PLAYER: op = Op::LOOK_AT_PLAYER; break;
+            case BehaviorNodeKind::MELEE_ATTACK: op = Op::MELEE_ATTACK; break;
+            case BehaviorNodeKind::AVOID_ENTITY: op = Op::AVOID_ENTITY; break;
+            case BehaviorNodeKind::FLYING: op = Op::FLYING; break;
+            default: op = Op::LEAF; break;
+        }
+
+        if (op <= Op::PARALLEL) {
+            // 组合节点只保留指令，节点本身在这里释放
+            node.reset();
+            const uint32_t count = static_cast<uint32_t>(children.size());
+            for (auto& child : children) {
+                emit(std::move(child), depth + 1);
+            }
+            code_[at] = Instruction{op, count, static_cast<uint32_t>(code_.size()), param};
+        } else {
+            code_[at] = Instruction{op, static_cast<uint32_t>(leaves_.size()), at + 1, 0};
+            leaves_.push_back(std::move(node));
+        }
+    }
+
+    std::vector<Instruction> code_;
+    std::vector<std::unique_ptr<BehaviorNodeBase>> leaves_;
+    uint32_t maxDepth_ = 0;
+};
+
+} // namespace lattice::entity
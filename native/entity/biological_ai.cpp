@@ -1,9 +1,14 @@
 #include "biological_ai.hpp"
+#include "entity_data_blob.hpp"
+#include "../core/metrics.hpp"
+#include "../core/tracing.hpp"
 #include <fstream>
 #include <sstream>
 #include <cmath>
 #include <algorithm>
 #include <execution>
+#include <limits>
+#include <map>
 #include <memory_resource>
 #include <iostream>
 #include <filesystem>
@@ -38,7 +43,46 @@ bool DataModule::loadEntityData() {
 bool DataModule::loadEntityDataForVersion(const std::string& version) {
     std::lock_guard lock(dataMutex_);
     
-    // 构建实体数据文件路径
+    std::string entitiesFile = entitiesFilePath(version);
+    
+    // 本地数据优先使用预编译文件
+    if (!useGitHub_ && loadEntityBlob(entitiesFile, version)) {
+        return true;
+    }
+    
+    // 直接调用parseEntityJSON处理文件读取和解析
+    return parseEntityJSON(entitiesFile);
+}
+
+bool DataModule::compileEntityBlob(const std::string& version) {
+    std::lock_guard lock(dataMutex_);
+    if (useGitHub_) {
+        fprintf(stderr, "Entity blobs can only be compiled from local minecraft-data\n");
+        return false;
+    }
+    
+    std::string entitiesFile = entitiesFilePath(version);
+    clearEntities();
+    if (!parseEntityJSON(entitiesFile)) {
+        return false;
+    }
+    
+    std::vector<const EntityBehaviorData*> entities;
+    entities.reserve(entityCount_);
+    for (const auto& data : entityData_) {
+        if (!data.id.empty()) {
+            entities.push_back(&data);
+        }
+    }
+    std::string blobFile = blob::blobPathFor(entitiesFile);
+    if (!blob::write(blobFile, version, blob::stampOf(entitiesFile), entities)) {
+        return false;
+    }
+    printf("Compiled %zu entities into %s\n", entities.size(), blobFile.c_str());
+    return true;
+}
+
+std::string DataModule::entitiesFilePath(const std::string& version) const {
     std::string entitiesFile;
     
     if (useGitHub_) {
@@ -53,9 +97,27 @@ bool DataModule::loadEntityDataForVersion(const std::string& version) {
         
         fprintf(stdout, "Loading entity data from local: %s\n", entitiesFile.c_str());
     }
+    return entitiesFile;
+}
+
+bool DataModule::loadEntityBlob(const std::string& filePath, const std::string& version) {
+    auto start = std::chrono::steady_clock::now();
+    std::string blobFile = blob::blobPathFor(filePath);
+    std::vector<EntityBehaviorData> entities;
+    if (!blob::read(blobFile, version, blob::stampOf(filePath), entities)) {
+        return false;
+    }
     
-    // 直接调用parseEntityJSON处理文件读取和解析
-    return parseEntityJSON(entitiesFile);
+    clearEntities();
+    for (auto& data : entities) {
+        storeEntity(std::move(data));
+    }
+    populateCategoryIndex();
+    
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    printf("Loaded %zu entities from %s in %lld us\n", entityCount_, blobFile.c_str(),
+           static_cast<long long>(elapsed.count()));
+    return true;
 }
 
 bool DataModule::parseEntityJSON(const std::string& filePath) {
@@ -84,11 +146,7 @@ bool DataModule::parseEntityJSON(const std::string& filePath) {
             try {
                 EntityBehaviorData data = parseEntityFromJson(entityJson);
                 if (!data.id.empty()) {
-                    entityData_[data.id] = data;
-                    // 同时按name索引
-                    if (!data.name.empty()) {
-                        entityDataByName_[data.name] = data.id;
-                    }
+                    storeEntity(std::move(data));
                 }
             } catch (const std::exception& e) {
                 fprintf(stderr, "Failed to parse entity: %s\n", e.what());
@@ -96,7 +154,7 @@ bool DataModule::parseEntityJSON(const std::string& filePath) {
             }
         }
         
-        printf("Successfully parsed %zu entities using nlohmann::json\n", entityData_.size());
+        printf("Successfully parsed %zu entities using nlohmann::json\n", entityCount_);
         
     } catch (const nlohmann::json::parse_error& e) {
         fprintf(stderr, "JSON parse error: %s\n", e.what());
@@ -107,7 +165,7 @@ bool DataModule::parseEntityJSON(const std::string& filePath) {
     }
     
     populateCategoryIndex();
-    printf("Loaded %zu entities from %s\n", entityData_.size(), filePath.c_str());
+    printf("Loaded %zu entities from %s\n", entityCount_, filePath.c_str());
     return true;
 }
 
@@ -260,23 +318,78 @@ std::string DataModule::mapCategory(const std::string& minecraftCategory) {
 
 void DataModule::populateCategoryIndex() {
     categoryIndex_.clear();
-    for (const auto& [id, data] : entityData_) {
-        categoryIndex_[data.category].push_back(id);
+    for (const auto& data : entityData_) {
+        if (!data.id.empty()) {
+            categoryIndex_[data.category].push_back(data.typeId);
+        }
     }
 }
 
+void DataModule::storeEntity(EntityBehaviorData data) {
+    const EntityTypeId typeId = typeRegistry_.intern(data.id);
+    if (typeId == INVALID_ENTITY_TYPE) {
+        fprintf(stderr, "Too many entity types, dropping %s\n", data.id.c_str());
+        return;
+    }
+    if (typeId >= entityData_.size()) {
+        entityData_.resize(typeId + 1);
+    }
+    if (!data.name.empty()) {
+        entityDataByName_[data.name] = data.id;
+    }
+    data.typeId = typeId;
+    if (entityData_[typeId].id.empty()) {
+        ++entityCount_;
+    }
+    entityData_[typeId] = std::move(data);
+}
+
+void DataModule::clearEntities() {
+    entityData_.clear();
+    entityDataByName_.clear();
+    entityCount_ = 0;
+}
+
 EntityBehaviorData* DataModule::getEntityData(const std::string& entityId) {
     std::shared_lock lock(dataMutex_);
-    auto it = entityData_.find(entityId);
-    return (it != entityData_.end()) ? &it->second : nullptr;
+    const EntityTypeId typeId = typeRegistry_.find(entityId);
+    if (typeId >= entityData_.size() || entityData_[typeId].id.empty()) {
+        return nullptr;
+    }
+    return &entityData_[typeId];
+}
+
+EntityBehaviorData* DataModule::getEntityData(EntityTypeId typeId) {
+    std::shared_lock lock(dataMutex_);
+    if (typeId >= entityData_.size() || entityData_[typeId].id.empty()) {
+        return nullptr;
+    }
+    return &entityData_[typeId];
+}
+
+EntityTypeId DataModule::findEntityType(std::string_view name) const {
+    std::shared_lock lock(dataMutex_);
+    return typeRegistry_.find(name);
+}
+
+EntityTypeId DataModule::internEntityType(std::string_view name) {
+    std::lock_guard lock(dataMutex_);
+    return typeRegistry_.intern(name);
+}
+
+std::string DataModule::getEntityTypeName(EntityTypeId typeId) const {
+    std::shared_lock lock(dataMutex_);
+    return typeRegistry_.name(typeId);
 }
 
 std::vector<std::string> DataModule::getAllEntityIds() const {
     std::shared_lock lock(dataMutex_);
     std::vector<std::string> ids;
-    ids.reserve(entityData_.size());
-    for (const auto& [id, _] : entityData_) {
-        ids.push_back(id);
+    ids.reserve(entityCount_);
+    for (const auto& data : entityData_) {
+        if (!data.id.empty()) {
+            ids.push_back(data.id);
+        }
     }
     return ids;
 }
@@ -287,11 +400,9 @@ std::vector<EntityBehaviorData> DataModule::getEntitiesByCategory(const std::str
     
     auto it = categoryIndex_.find(category);
     if (it != categoryIndex_.end()) {
-        for (const auto& entityId : it->second) {
-            auto entityIt = entityData_.find(entityId);
-            if (entityIt != entityData_.end()) {
-                result.push_back(entityIt->second);
-            }
+        result.reserve(it->second.size());
+        for (EntityTypeId typeId : it->second) {
+            result.push_back(entityData_[typeId]);
         }
     }
     return result;
@@ -828,8 +939,109 @@ void DataModule::setupEntitySpecificProperties(EntityBehaviorData& data) {
 
 // ====== AIEngine 实现 ======
 
+namespace {
+
+// 没有收到世界视图的实体使用空视图
+const WorldView& emptyWorldView() {
+    static const WorldView empty{};
+    return empty;
+}
+
+// 并行tick的区域边长：4个区块
+constexpr int PARALLEL_REGION_SHIFT = 6;
+
+int64_t regionKey(const EntityState& state) {
+    const auto regionX = static_cast<int32_t>(std::floor(state.x)) >> PARALLEL_REGION_SHIFT;
+    const auto regionZ = static_cast<int32_t>(std::floor(state.z)) >> PARALLEL_REGION_SHIFT;
+    return (static_cast<int64_t>(regionX) << 32) | static_cast<uint32_t>(regionZ);
+}
+
+/**
+ * 并行tick中工作线程对实体状态的写入，tick结束时统一应用
+ * 只包含AI会修改的字段，其余字段（生命值等）保持由Java同步的值
+ */
+struct EntityCommand {
+    uint64_t entityId;
+    float x, y, z;
+    float rotationYaw, rotationPitch;
+    float velocityX, velocityY, velocityZ;
+    uint64_t lastAttackTime;
+    uint64_t targetId;
+    float targetDistance;
+    EntityState::BehaviorState behaviorState;
+    
+    static bool changed(const EntityState& before, const EntityState& after) {
+        return before.x != after.x || before.y != after.y || before.z != after.z ||
+               before.rotationYaw != after.rotationYaw || before.rotationPitch != after.rotationPitch ||
+               before.velocityX != after.velocityX || before.velocityY != after.velocityY ||
+               before.velocityZ != after.velocityZ || before.lastAttackTime != after.lastAttackTime ||
+               before.targetId != after.targetId || before.targetDistance != after.targetDistance ||
+               before.behaviorState != after.behaviorState;
+    }
+    
+    static EntityCommand from(const EntityState& state) {
+        return EntityCommand{state.entityId, state.x, state.y, state.z, state.rotationYaw, state.rotationPitch,
+                             state.velocityX, state.velocityY, state.velocityZ, state.lastAttackTime,
+                             state.targetId, state.targetDistance, state.behaviorState};
+    }
+    
+    void apply(EntityState& state) const {
+        state.x = x;
+        state.y = y;
+        state.z = z;
+        state.rotationYaw = rotationYaw;
+        state.rotationPitch = rotationPitch;
+        state.velocityX = velocityX;
+        state.velocityY = velocityY;
+        state.velocityZ = velocityZ;
+        state.lastAttackTime = lastAttackTime;
+        state.targetId = targetId;
+        state.targetDistance = targetDistance;
+        state.behaviorState = behaviorState;
+    }
+};
+
+// 哈希表节点的簿记开销估算（next指针、缓存的哈希值与分配器头）
+constexpr size_t MAP_NODE_OVERHEAD = 32;
+
+size_t estimateWorldViewBytes(const WorldView& view) {
+    return sizeof(WorldView) + MAP_NODE_OVERHEAD +
+           view.nearbyBlocks.size() * (sizeof(std::pair<const std::string, WorldView::BlockInfo>) + MAP_NODE_OVERHEAD) +
+           view.nearbyEntities.size() * (sizeof(std::pair<const uint64_t, EntityState>) + MAP_NODE_OVERHEAD);
+}
+
+} // namespace
+
 AIEngine::AIEngine()
     : dataModule_(nullptr), versionStrategy_(nullptr) {
+    shedderId_ = core::MemoryBudget::instance().addShedder(
+        core::MemorySubsystem::AI, [this](size_t bytes) { return shedMemory(bytes); });
+}
+
+AIEngine::~AIEngine() {
+    core::MemoryBudget::instance().removeShedder(shedderId_);
+}
+
+size_t AIEngine::estimateMemoryLocked() const {
+    size_t bytes = entityStates_.size() * (sizeof(std::pair<const uint64_t, EntityState>) + MAP_NODE_OVERHEAD) +
+                   entityTypes_.size() * (sizeof(std::pair<const uint64_t, EntityTypeId>) + MAP_NODE_OVERHEAD) +
+                   lodBoostUntil_.size() * (sizeof(std::pair<const uint64_t, uint64_t>) + MAP_NODE_OVERHEAD);
+    for (const auto& [id, view] : entityWorldViews_) {
+        bytes += estimateWorldViewBytes(*view);
+    }
+    return bytes;
+}
+
+size_t AIEngine::shedMemory(size_t bytes) {
+    // 实体状态不能丢弃：只删除已过期的伤害加速记录，以及实体已注销或从未注册的世界视图
+    (void)bytes;
+    std::lock_guard lock(entityMutex_);
+    const size_t before = estimateMemoryLocked();
+    std::erase_if(lodBoostUntil_, [this](const auto& boost) { return boost.second < aiTick_; });
+    std::erase_if(entityWorldViews_, [this](const auto& view) { return !entityStates_.count(view.first); });
+    const size_t after = estimateMemoryLocked();
+    memory_.set(after);
+    return before - after;
 }
 
 bool AIEngine::initialize(const std::string& minecraftDataPath, const std::string& gameVersion, bool useGitHub) {
@@ -865,11 +1077,20 @@ void AIEngine::shutdown() {
 }
 
 bool AIEngine::registerEntity(uint64_t entityId, const std::string& entityType) {
+    const EntityTypeId typeId = dataModule_ ? dataModule_->findEntityType(entityType) : INVALID_ENTITY_TYPE;
+    if (typeId == INVALID_ENTITY_TYPE) {
+        fprintf(stderr, "Unknown entity type: %s\n", entityType.c_str());
+        return false;
+    }
+    return registerEntity(entityId, typeId);
+}
+
+bool AIEngine::registerEntity(uint64_t entityId, EntityTypeId entityType) {
     std::lock_guard lock(entityMutex_);
     
-    auto* config = dataModule_->getEntityData(entityType);
+    auto* config = dataModule_ ? dataModule_->getEntityData(entityType) : nullptr;
     if (!config) {
-        fprintf(stderr, "Unknown entity type: %s\n", entityType.c_str());
+        fprintf(stderr, "Unknown entity type id: %u\n", static_cast<unsigned>(entityType));
         return false;
     }
     
@@ -883,12 +1104,13 @@ bool AIEngine::registerEntity(uint64_t entityId, const std::string& entityType)
     entityStates_[entityId] = std::move(state);
     entityTypes_[entityId] = entityType;
     
-    printf("Registered entity %lu as %s\n", entityId, entityType.c_str());
+    printf("Registered entity %lu as %s\n", entityId, config->id.c_str());
     return true;
 }
 
 void AIEngine::unregisterEntity(uint64_t entityId) {
     std::lock_guard lock(entityMutex_);
+    lodBoostUntil_.erase(entityId);
     entityStates_.erase(entityId);
     entityTypes_.erase(entityId);
     entityWorldViews_.erase(entityId);
@@ -896,48 +1118,364 @@ void AIEngine::unregisterEntity(uint64_t entityId) {
 
 void AIEngine::updateEntityState(uint64_t entityId, const EntityState& state) {
     std::lock_guard lock(entityMutex_);
+    auto it = entityStates_.find(entityId);
+    if (it != entityStates_.end() && state.health < it->second.health) {
+        lodBoostUntil_[entityId] = aiTick_ + lodConfig_.damageBoostTicks;
+    }
     entityStates_[entityId] = state;
 }
 
+void AIEngine::setLodConfig(const LodConfig& config) {
+    std::lock_guard lock(entityMutex_);
+    lodConfig_ = config;
+    for (auto& interval : lodConfig_.intervals) {
+        interval = std::max<uint32_t>(interval, 1);
+    }
+}
+
+AIEngine::LodConfig AIEngine::getLodConfig() const {
+    std::shared_lock lock(entityMutex_);
+    return lodConfig_;
+}
+
+void AIEngine::setPlayerPositions(std::vector<std::array<float, 3>> positions) {
+    std::lock_guard lock(entityMutex_);
+    playerPositions_ = std::move(positions);
+}
+
+void AIEngine::notifyEntityDamaged(uint64_t entityId) {
+    std::lock_guard lock(entityMutex_);
+    lodBoostUntil_[entityId] = aiTick_ + lodConfig_.damageBoostTicks;
+}
+
+bool AIEngine::lodAllows(uint64_t entityId, const EntityState& state) const {
+    if (!lodConfig_.enabled || playerPositions_.empty()) {
+        return true;
+    }
+    auto boost = lodBoostUntil_.find(entityId);
+    if (boost != lodBoostUntil_.end() && aiTick_ <= boost->second) {
+        return true;
+    }
+    
+    float nearest = std::numeric_limits<float>::max();
+    for (const auto& player : playerPositions_) {
+        const float dx = state.x - player[0];
+        const float dy = state.y - player[1];
+        const float dz = state.z - player[2];
+        nearest = std::min(nearest, dx * dx + dy * dy + dz * dz);
+    }
+    uint32_t interval = 1;
+    for (size_t level = 0; level < lodConfig_.distances.size(); ++level) {
+        if (nearest > lodConfig_.distances[level] * lodConfig_.distances[level]) {
+            interval = lodConfig_.intervals[level];
+        }
+    }
+    if (interval <= 1) {
+        return true;
+    }
+    // 按id打散的固定相位
+    uint64_t phase = entityId * 0x9E3779B97F4A7C15ULL;
+    phase ^= phase >> 32;
+    return (aiTick_ + phase) % interval == 0;
+}
+
 void AIEngine::updateWorldView(uint64_t entityId, const WorldView& world) {
+    auto view = std::make_shared<WorldView>(world);
+    view->neighbors = &neighborIndex_;
+    view->blockStates = &blockStates_;
     std::lock_guard lock(entityMutex_);
-    entityWorldViews_[entityId] = std::make_unique<WorldView>(world);
+    entityWorldViews_[entityId] = std::move(view);
+}
+
+void AIEngine::refreshNeighborIndex() {
+    // 已登记实体的状态最新，先写入；世界视图里其余的实体（如玩家）补充在后
+    neighborIndex_.beginUpdate();
+    for (const auto& [id, state] : entityStates_) {
+        neighborIndex_.update(id, state.x, state.y, state.z, state.isOnFire);
+    }
+    for (const auto& [id, view] : entityWorldViews_) {
+        for (const auto& [otherId, other] : view->nearbyEntities) {
+            neighborIndex_.update(otherId, other.x, other.y, other.z, other.isOnFire);
+        }
+    }
+    neighborIndex_.endUpdate();
+}
+
+void AIEngine::setBehaviorTree(const std::string& entityType, std::shared_ptr<BehaviorNodeBase> tree) {
+    // 数据里还没有的类型也登记一个ID，之后加载的同名类型沿用
+    const EntityTypeId typeId = dataModule_ ? dataModule_->internEntityType(entityType)
+                                            : EntityTypeRegistry().find(entityType);
+    if (typeId == INVALID_ENTITY_TYPE) {
+        fprintf(stderr, "Cannot set behavior tree for unknown entity type: %s\n", entityType.c_str());
+        return;
+    }
+    setBehaviorTree(typeId, std::move(tree));
+}
+
+void AIEngine::setBehaviorTree(EntityTypeId entityType, std::shared_ptr<BehaviorNodeBase> tree) {
+    if (entityType == INVALID_ENTITY_TYPE) {
+        return;
+    }
+    std::lock_guard lock(entityMutex_);
+    if (entityType >= behaviorTrees_.size()) {
+        if (!tree) {
+            return;
+        }
+        behaviorTrees_.resize(entityType + 1);
+    }
+    behaviorTrees_[entityType] = std::move(tree);
+}
+
+const std::shared_ptr<BehaviorNodeBase>& AIEngine::behaviorTreeFor(uint64_t entityId) const {
+    static const std::shared_ptr<BehaviorNodeBase> none;
+    auto typeIt = entityTypes_.find(entityId);
+    if (typeIt == entityTypes_.end() || typeIt->second >= behaviorTrees_.size()) {
+        return none;
+    }
+    return behaviorTrees_[typeIt->second];
 }
 
 void AIEngine::tick() {
+    LATTICE_TRACE_SPAN("ai", "AIEngine::tick");
     auto tickStart = std::chrono::high_resolution_clock::now();
     
-    std::shared_lock lock(entityMutex_);
-    std::vector<uint64_t> entityIds;
-    entityIds.reserve(entityStates_.size());
+    {
+        std::lock_guard lock(entityMutex_);
+        ++aiTick_;
+        refreshNeighborIndex();
+        blockStates_ = world::BlockStateStore::instance().snapshot();
+        memory_.set(estimateMemoryLocked());
+    }
     
-    for (const auto& [id, _] : entityStates_) {
-        entityIds.push_back(id);
+    std::vector<uint64_t> entityIds;
+    size_t batched = 0;
+    size_t skipped = 0;
+    if (batchedTick_) {
+        batched = tickBatched(entityIds, skipped);
+    } else {
+        std::shared_lock lock(entityMutex_);
+        entityIds.reserve(entityStates_.size());
+        
+        for (const auto& [id, state] : entityStates_) {
+            if (!lodAllows(id, state)) {
+                ++skipped;
+                continue;
+            }
+            entityIds.push_back(id);
+        }
     }
-    lock.unlock();
     
-    // 并行处理实体（如果C++17并行算法可用）
-    std::for_each(std::execution::par_unseq, entityIds.begin(), entityIds.end(),
-        [this](uint64_t entityId) {
-            tickEntity(entityId, 50); // 假设50ms per tick
-        });
+    if (parallelTick_) {
+        tickParallel(entityIds);
+    } else {
+        // 并行处理实体（如果C++17并行算法可用）
+        std::for_each(std::execution::par_unseq, entityIds.begin(), entityIds.end(),
+            [this](uint64_t entityId) {
+                tickEntity(entityId, 50); // 假设50ms per tick
+            });
+    }
     
     // 更新性能统计
     auto tickEnd = std::chrono::high_resolution_clock::now();
     auto tickDuration = std::chrono::duration_cast<std::chrono::microseconds>(tickEnd - tickStart);
     
+    static core::Histogram& tickSeconds = core::MetricsRegistry::instance().histogram(
+        "lattice_ai_tick_duration_seconds", "AIEngine tick time", core::Histogram::latencyBuckets());
+    static core::Counter& entitiesTicked = core::MetricsRegistry::instance().counter(
+        "lattice_ai_entities_ticked_total", "Entities processed by AIEngine ticks");
+    static core::Counter& entitiesSkipped = core::MetricsRegistry::instance().counter(
+        "lattice_ai_entities_skipped_total", "Entities skipped by AI level-of-detail");
+    tickSeconds.observe(std::chrono::duration<double>(tickEnd - tickStart).count());
+    entitiesTicked.inc(entityIds.size() + batched);
+    entitiesSkipped.inc(skipped);
+    
     std::lock_guard statsLock(statsMutex_);
     performanceStats_.totalTicks++;
-    performanceStats_.entitiesProcessed += entityIds.size();
+    performanceStats_.entitiesProcessed += entityIds.size() + batched;
+    performanceStats_.lodSkipped += skipped;
+    performanceStats_.memoryUsage = memory_.bytes();
     performanceStats_.avgTickTime = tickDuration.count();
     performanceStats_.maxTickTime = std::max(performanceStats_.maxTickTime, 
                                            static_cast<uint64_t>(tickDuration.count()));
 }
 
+void AIEngine::setParallelTick(bool enabled, size_t threads) {
+    std::lock_guard lock(workersMutex_);
+    if (!enabled) {
+        parallelTick_ = false;
+        return;
+    }
+    if (threads == 0) {
+        ownedWorkers_.reset();
+        workers_ = &core::NativeRuntime::instance().pool();
+    } else if (!ownedWorkers_ || ownedWorkers_->size() != threads) {
+        ownedWorkers_ = core::NativeRuntime::instance().createPool(core::NativeSubsystem::AI, threads);
+        workers_ = ownedWorkers_.get();
+    }
+    workerCount_ = workers_->size();
+    parallelTick_ = true;
+}
+
+void AIEngine::tickParallel(const std::vector<uint64_t>& entityIds) {
+    LATTICE_TRACE_SPAN("ai", "AIEngine::tickParallel");
+    struct Task {
+        uint64_t entityId;
+        EntityState state;
+        std::shared_ptr<const WorldView> world;
+        std::shared_ptr<BehaviorNodeBase> tree;
+    };
+    
+    // 1. 快照：状态副本与世界视图指针，按区域分组（std::map使区域顺序确定）
+    std::vector<Task> tasks;
+    std::map<int64_t, std::vector<uint32_t>> regionIndex;
+    {
+        std::shared_lock lock(entityMutex_);
+        tasks.reserve(entityIds.size());
+        for (uint64_t entityId : entityIds) {
+            auto stateIt = entityStates_.find(entityId);
+            if (stateIt == entityStates_.end() || entityTypes_.find(entityId) == entityTypes_.end()) {
+                continue;
+            }
+            Task task{entityId, stateIt->second, nullptr, behaviorTreeFor(entityId)};
+            auto worldIt = entityWorldViews_.find(entityId);
+            if (worldIt != entityWorldViews_.end()) {
+                task.world = worldIt->second;
+            }
+            regionIndex[regionKey(task.state)].push_back(static_cast<uint32_t>(tasks.size()));
+            tasks.push_back(std::move(task));
+        }
+    }
+    std::vector<std::vector<uint32_t>> regions;
+    regions.reserve(regionIndex.size());
+    for (auto& [key, members] : regionIndex) {
+        regions.push_back(std::move(members));
+    }
+    
+    // 2. 工作线程从共享计数器领取区域，空闲的线程会继续领取剩下的区域
+    std::unique_lock workersLock(workersMutex_);
+    const size_t workerCount = std::min(workerCount_, regions.size());
+    std::vector<std::vector<EntityCommand>> commands(workerCount);
+    std::atomic<size_t> nextRegion{0};
+    auto work = [&](size_t worker) {
+        LATTICE_TRACE_SPAN("ai", "AIEngine worker");
+        for (size_t region = nextRegion.fetch_add(1); region < regions.size(); region = nextRegion.fetch_add(1)) {
+            for (uint32_t index : regions[region]) {
+                Task& task = tasks[index];
+                EntityState state = task.state;
+                const WorldView& world = task.world ? *task.world : emptyWorldView();
+                g_threadContext.currentEntity = &state;
+                g_threadContext.currentWorld = &world;
+                g_threadContext.tickStart = std::chrono::high_resolution_clock::now();
+                try {
+                    if (task.tree) {
+                        if (state.health > 0) {
+                            task.tree->tick(state, world);
+                        }
+                    } else {
+                        processEntityBehavior(task.entityId, state, world);
+                    }
+                } catch (const std::exception& e) {
+                    fprintf(stderr, "Error processing entity %lu behavior: %s\n", task.entityId, e.what());
+                }
+                g_threadContext.currentEntity = nullptr;
+                g_threadContext.currentWorld = nullptr;
+                if (EntityCommand::changed(task.state, state)) {
+                    state.entityId = task.entityId;
+                    commands[worker].push_back(EntityCommand::from(state));
+                }
+            }
+        }
+    };
+    std::vector<std::future<void>> futures;
+    futures.reserve(workerCount);
+    for (size_t worker = 0; worker < workerCount; ++worker) {
+        futures.push_back(workers_->enqueue(work, worker));
+    }
+    // 先等全部完成再取结果：get()可能抛出，而其他任务仍在引用本地数据
+    for (auto& future : futures) {
+        future.wait();
+    }
+    workersLock.unlock();
+    for (auto& future : futures) {
+        future.get();
+    }
+    
+    // 3. 按实体id顺序应用命令，已注销的实体跳过
+    std::vector<EntityCommand> merged;
+    for (auto& workerCommands : commands) {
+        merged.insert(merged.end(), workerCommands.begin(), workerCommands.end());
+    }
+    std::sort(merged.begin(), merged.end(),
+              [](const EntityCommand& a, const EntityCommand& b) { return a.entityId < b.entityId; });
+    size_t applied = 0;
+    {
+        std::lock_guard lock(entityMutex_);
+        for (const EntityCommand& command : merged) {
+            auto it = entityStates_.find(command.entityId);
+            if (it != entityStates_.end()) {
+                command.apply(it->second);
+                ++applied;
+            }
+        }
+    }
+    
+    std::lock_guard statsLock(statsMutex_);
+    performanceStats_.parallelRegions += regions.size();
+    performanceStats_.commandsApplied += applied;
+}
+
+size_t AIEngine::tickBatched(std::vector<uint64_t>& scalarIds, size_t& skipped) {
+    // 直接在entityStates_上读写，整个批量执行期间持有写锁
+    std::lock_guard lock(entityMutex_);
+    
+    // 同一棵行为树的实体组成一个批次
+    std::unordered_map<BehaviorNodeBase*, EntityBatch> groups;
+    for (auto& [id, state] : entityStates_) {
+        if (!lodAllows(id, state)) {
+            ++skipped;
+            continue;
+        }
+        const auto& tree = behaviorTreeFor(id);
+        if (!tree) {
+            scalarIds.push_back(id);
+            continue;
+        }
+        if (state.health <= 0) {
+            continue;   // 与逐个执行相同：死亡实体不处理
+        }
+        auto worldIt = entityWorldViews_.find(id);
+        groups[tree.get()].add(&state, worldIt != entityWorldViews_.end() ? worldIt->second.get()
+                                                                                    : &emptyWorldView());
+    }
+    
+    size_t batchedEntities = 0;
+    std::vector<uint32_t> lanes;
+    std::vector<uint8_t> results;
+    for (auto& [tree, batch] : groups) {
+        lanes.resize(batch.size());
+        for (uint32_t lane = 0; lane < lanes.size(); ++lane) {
+            lanes[lane] = lane;
+        }
+        results.assign(batch.size(), 0);
+        try {
+            tree->tickBatch(batch, lanes, results);
+        } catch (const std::exception& e) {
+            fprintf(stderr, "Error processing behavior batch: %s\n", e.what());
+        }
+        batch.store();
+        batchedEntities += batch.size();
+    }
+    
+    std::lock_guard statsLock(statsMutex_);
+    performanceStats_.batchedEntities += batchedEntities;
+    performanceStats_.batchGroups += groups.size();
+    return batchedEntities;
+}
+
 void AIEngine::tickEntity(uint64_t entityId, uint64_t /*deltaTime*/) {
     EntityState state;
-    std::string entityType;
-    std::unique_ptr<WorldView> worldView;
+    std::shared_ptr<const WorldView> worldView;
+    std::shared_ptr<BehaviorNodeBase> tree;
     
     // 获取实体状态
     {
@@ -946,14 +1484,13 @@ void AIEngine::tickEntity(uint64_t entityId, uint64_t /*deltaTime*/) {
         if (stateIt == entityStates_.end()) return;
         
         state = stateIt->second;
-        auto typeIt = entityTypes_.find(entityId);
-        if (typeIt == entityTypes_.end()) return;
-        entityType = typeIt->second;
+        if (entityTypes_.find(entityId) == entityTypes_.end()) return;
         
         auto worldIt = entityWorldViews_.find(entityId);
         if (worldIt != entityWorldViews_.end()) {
-            worldView = std::make_unique<WorldView>(*worldIt->second);
+            worldView = worldIt->second;
         }
+        tree = behaviorTreeFor(entityId);
     }
     
     // 设置线程上下文
@@ -964,7 +1501,14 @@ void AIEngine::tickEntity(uint64_t entityId, uint64_t /*deltaTime*/) {
     g_threadContext.tickStart = std::chrono::high_resolution_clock::now();
     
     try {
-        processEntityBehavior(entityId, state, *worldView);
+        const WorldView& world = worldView ? *worldView : emptyWorldView();
+        if (tree) {
+            if (state.health > 0) {
+                tree->tick(state, world);
+            }
+        } else {
+            processEntityBehavior(entityId, state, world);
+        }
     } catch (const std::exception& e) {
         fprintf(stderr, "Error processing entity %lu behavior: %s\n", entityId, e.what());
     }
@@ -977,7 +1521,9 @@ void AIEngine::tickEntity(uint64_t entityId, uint64_t /*deltaTime*/) {
 }
 
 void AIEngine::processEntityBehavior(uint64_t entityId, const EntityState& state, const WorldView& world) {
-    auto* config = dataModule_->getEntityData(entityTypes_[entityId]);
+    auto typeIt = entityTypes_.find(entityId);
+    if (typeIt == entityTypes_.end()) return;
+    auto* config = dataModule_->getEntityData(typeIt->second);
     if (!config) return;
     
     // 应用版本特定修改
@@ -991,17 +1537,24 @@ void AIEngine::processEntityBehavior(uint64_t entityId, const EntityState& state
     
     // 检查环境威胁
     bool hasThreats = false;
-    for (const auto& [otherId, otherState] : world.nearbyEntities) {
-        if (otherId == entityId) continue;
-        
-        float distance = BehaviorNodeBase::distance3D(
-            state.x, state.y, state.z,
-            otherState.x, otherState.y, otherState.z
-        );
-        
-        if (distance < config->followRange) {
-            hasThreats = true;
-            break;
+    if (world.neighbors) {
+        world.neighbors->forEachInRange(state.x, state.y, state.z, config->followRange,
+            [&](const NeighborIndex::Entry& other, float distance) {
+                hasThreats = hasThreats || (other.id != entityId && distance < config->followRange);
+            });
+    } else {
+        for (const auto& [otherId, otherState] : world.nearbyEntities) {
+            if (otherId == entityId) continue;
+            
+            float distance = BehaviorNodeBase::distance3D(
+                state.x, state.y, state.z,
+                otherState.x, otherState.y, otherState.z
+            );
+            
+            if (distance < config->followRange) {
+                hasThreats = true;
+                break;
+            }
         }
     }
     
@@ -1242,66 +1795,15 @@ std::vector<uint64_t> findNearbyEntitiesSIMD(const std::vector<EntityState>& ent
 }
 
 /**
- * @brief 多线程并行实体距离计算
- * @brief 利用所有CPU核心进行大规模实体处理
+ * @brief 大规模实体距离计算
+ * @brief 单次查询只是一遍连续数组扫描，不再为每次调用创建线程；
+ *        num_threads保留以兼容调用方。大量重复的邻居查询应使用NeighborIndex
  */
 std::vector<uint64_t> findNearbyEntitiesParallel(const std::vector<EntityState>& entities,
                                                 const EntityState& center,
                                                 float range,
-                                                size_t num_threads) {
-    if (entities.empty()) return {};
-    
-    const size_t num_cores = std::thread::hardware_concurrency();
-    size_t thread_count = std::min(num_threads > 0 ? num_threads : num_cores, 
-                                 std::max(size_t(1), entities.size() / 100));
-    
-    if (thread_count == 1) {
-        return findNearbyEntitiesSIMD(entities, center, range);
-    }
-    
-    // 准备并行处理数据结构
-    struct ThreadResult {
-        std::vector<uint64_t> nearby_entities;
-        std::mutex mutex;
-    };
-    
-    ThreadResult thread_result;
-    
-    // 动态负载均衡的分块策略
-    size_t chunk_size = std::max(size_t(1000), entities.size() / thread_count);
-    std::vector<std::thread> threads;
-    threads.reserve(thread_count);
-    
-    // 启动线程
-    for (size_t t = 0; t < thread_count; ++t) {
-        size_t start = t * chunk_size;
-        size_t end = std::min(start + chunk_size, entities.size());
-        
-        if (start >= entities.size()) break;
-        
-        threads.emplace_back([&, start, end]() {
-            // 每个线程处理一个分块
-            std::vector<EntityState> local_entities(entities.begin() + start, entities.begin() + end);
-            auto local_nearby = findNearbyEntitiesSIMD(local_entities, center, range);
-            
-            // 线程安全地合并结果
-            {
-                std::lock_guard<std::mutex> lock(thread_result.mutex);
-                thread_result.nearby_entities.insert(thread_result.nearby_entities.end(),
-                                                   std::make_move_iterator(local_nearby.begin()),
-                                                   std::make_move_iterator(local_nearby.end()));
-            }
-        });
-    }
-    
-    // 等待所有线程完成
-    for (auto& thread : threads) {
-        if (thread.joinable()) {
-            thread.join();
-        }
-    }
-    
-    return std::move(thread_result.nearby_entities);
+                                                size_t /*num_threads*/) {
+    return findNearbyEntitiesSIMD(entities, center, range);
 }
 
 /**
@@ -13,7 +13,13 @@
 #include <variant>
 #include <cmath>
 #include <cstdint>
+#include <array>
 #include "nlohmann/json.hpp"
+#include "../core/memory_budget.hpp"
+#include "../core/native_runtime.hpp"
+#include "../core/world/block_state_store.hpp"
+#include "entity_type_registry.hpp"
+#include "neighbor_index.hpp"
 
 namespace lattice::entity {
 
@@ -24,6 +30,7 @@ namespace lattice::entity {
  */
 struct EntityBehaviorData {
     std::string id;
+    EntityTypeId typeId = INVALID_ENTITY_TYPE;   // DataModule加载时分配
     std::string name;
     std::string category;
     std::string entityType; // 生物类型（如"living"、"block"等）
@@ -153,6 +160,92 @@ struct WorldView {
     float lightGrid[16][256][16]; // 本地区块光照
     std::string biomeGrid[16][16];
     uint64_t timestamp;
+    // AIEngine保存的世界视图指向引擎的共享邻居索引，范围查询优先使用它
+    const NeighborIndex* neighbors = nullptr;
+    // 同样指向引擎本tick的方块状态快照（每tick开始时从BlockStateStore取一次）
+    const std::shared_ptr<const world::BlockStateSnapshot>* blockStates = nullptr;
+    
+    // 本tick的方块状态（方块状态id，未载入的位置为空气）；不在引擎中时为空
+    const world::BlockStateSnapshot* blocks() const { return blockStates ? blockStates->get() : nullptr; }
+};
+
+/**
+ * @brief 同类实体的批量状态（结构数组）
+ *
+ * 批量tick时同一行为树的实体放进一个批次，热字段按字段连续存放，
+ * 行为树的每个节点对整批实体执行一个循环。没有批量实现的节点逐个实体回退到tick()，
+ * 回退前后与EntityState同步（storeLane/loadLane）。
+ */
+struct EntityBatch {
+    std::vector<EntityState*> states;
+    std::vector<const WorldView*> worlds;
+    
+    std::vector<float> x, y, z;
+    std::vector<float> velocityX, velocityY, velocityZ;
+    std::vector<float> health, maxHealth;
+    std::vector<float> lightLevel;
+    std::vector<uint64_t> targetId;
+    std::vector<float> targetDistance;
+    std::vector<EntityState::BehaviorState> behaviorState;
+    
+    size_t size() const { return states.size(); }
+    
+    void add(EntityState* state, const WorldView* world) {
+        states.push_back(state);
+        worlds.push_back(world);
+        x.push_back(state->x);
+        y.push_back(state->y);
+        z.push_back(state->z);
+        velocityX.push_back(state->velocityX);
+        velocityY.push_back(state->velocityY);
+        velocityZ.push_back(state->velocityZ);
+        health.push_back(state->health);
+        maxHealth.push_back(state->maxHealth);
+        lightLevel.push_back(state->lightLevel);
+        targetId.push_back(state->targetId);
+        targetDistance.push_back(state->targetDistance);
+        behaviorState.push_back(state->behaviorState);
+    }
+    
+    // 结构数组 -> EntityState
+    void storeLane(size_t lane) const {
+        EntityState& state = *states[lane];
+        state.x = x[lane];
+        state.y = y[lane];
+        state.z = z[lane];
+        state.velocityX = velocityX[lane];
+        state.velocityY = velocityY[lane];
+        state.velocityZ = velocityZ[lane];
+        state.health = health[lane];
+        state.maxHealth = maxHealth[lane];
+        state.lightLevel = lightLevel[lane];
+        state.targetId = targetId[lane];
+        state.targetDistance = targetDistance[lane];
+        state.behaviorState = behaviorState[lane];
+    }
+    
+    void store() const {
+        for (size_t lane = 0; lane < size(); ++lane) {
+            storeLane(lane);
+        }
+    }
+    
+    // EntityState -> 结构数组（回退节点修改状态之后）
+    void loadLane(size_t lane) {
+        const EntityState& state = *states[lane];
+        x[lane] = state.x;
+        y[lane] = state.y;
+        z[lane] = state.z;
+        velocityX[lane] = state.velocityX;
+        velocityY[lane] = state.velocityY;
+        velocityZ[lane] = state.velocityZ;
+        health[lane] = state.health;
+        maxHealth[lane] = state.maxHealth;
+        lightLevel[lane] = state.lightLevel;
+        targetId[lane] = state.targetId;
+        targetDistance[lane] = state.targetDistance;
+        behaviorState[lane] = state.behaviorState;
+    }
 };
 
 // ====== C++17 约束检查 ======
@@ -208,6 +301,20 @@ inline constexpr bool IsBehaviorNode_v = IsBehaviorNode<T>::value;
 
 // ====== 行为节点基类 ======
 
+/**
+ * @brief 行为节点种类 - 供行为树编译器识别组合节点与常用叶子节点
+ */
+enum class BehaviorNodeKind : uint8_t {
+    LEAF,               // 其他叶子节点，通过虚函数执行
+    PRIORITY_SELECTOR,
+    SEQUENCE,
+    PARALLEL,
+    LOOK_AT_PLAYER,
+    MELEE_ATTACK,
+    AVOID_ENTITY,
+    FLYING
+};
+
 /**
  * @brief 行为树节点基类
  */
@@ -218,8 +325,21 @@ public:
     virtual bool tick(EntityState& state, const WorldView& world) = 0;
     virtual void reset() = 0;
     virtual std::string getNodeType() const = 0;
+    virtual BehaviorNodeKind getNodeKind() const { return BehaviorNodeKind::LEAF; }
     virtual float getPriority() const { return 1.0f; }
     
+    /**
+     * @brief 对batch中lanes选中的实体各执行一次，结果写入results[lane]（results大小为batch.size()）
+     * 默认逐个实体回退到tick()
+     */
+    virtual void tickBatch(EntityBatch& batch, const std::vector<uint32_t>& lanes, std::vector<uint8_t>& results) {
+        for (uint32_t lane : lanes) {
+            batch.storeLane(lane);
+            results[lane] = tick(*batch.states[lane], *batch.worlds[lane]) ? 1 : 0;
+            batch.loadLane(lane);
+        }
+    }
+    
     // 实用工具方法（public）
     static inline float clamp(float value, float min, float max) {
         return std::max(min, std::min(max, value));
@@ -245,7 +365,24 @@ public:
     virtual ~VersionStrategy() = default;
     virtual std::string getVersion() const = 0;
     virtual void applyBehaviorModifications(EntityBehaviorData& data) const = 0;
-    virtual float getBehaviorMultiplier(const std::string& behavior) const = 0;
+    
+    // 行为倍率按ID查表；字符串版本先换算为ID，未知行为为1.0
+    float getBehaviorMultiplier(BehaviorId behavior) const {
+        return behavior < BehaviorId::COUNT ? behaviorMultipliers_[static_cast<size_t>(behavior)] : 1.0f;
+    }
+    float getBehaviorMultiplier(const std::string& behavior) const {
+        return getBehaviorMultiplier(behaviorIdOf(behavior));
+    }
+    
+protected:
+    VersionStrategy() { behaviorMultipliers_.fill(1.0f); }
+    
+    void setBehaviorMultiplier(BehaviorId behavior, float multiplier) {
+        behaviorMultipliers_[static_cast<size_t>(behavior)] = multiplier;
+    }
+    
+private:
+    std::array<float, static_cast<size_t>(BehaviorId::COUNT)> behaviorMultipliers_;
 };
 
 /**
@@ -253,23 +390,22 @@ public:
  */
 class Version1_20_4 : public VersionStrategy {
 public:
+    Version1_20_4() {
+        setBehaviorMultiplier(BehaviorId::WARDEN_ATTACK, 1.0f);
+        setBehaviorMultiplier(BehaviorId::ALLAY_FOLLOW, 0.8f);
+        setBehaviorMultiplier(BehaviorId::AXOLOTL_SWIM, 1.2f);
+    }
+    
     std::string getVersion() const override { return "1.20.4"; }
     
     void applyBehaviorModifications(EntityBehaviorData& data) const override {
         // 1.20.4 特殊行为调整
-        if (data.id == "minecraft:warden") {
+        if (data.typeId == vanilla::WARDEN) {
             data.attackCooldown = 1.5f; // 监守者攻击间隔延长
-        } else if (data.id == "minecraft:allay") {
+        } else if (data.typeId == vanilla::ALLAY) {
             data.followRange = 8.0f; // 悦灵跟随范围缩小
         }
     }
-    
-    float getBehaviorMultiplier(const std::string& behavior) const override {
-        if (behavior == "warden_attack") return 1.0f;
-        if (behavior == "allay_follow") return 0.8f;
-        if (behavior == "axolotl_swim") return 1.2f;
-        return 1.0f;
-    }
 };
 
 /**
@@ -277,20 +413,19 @@ public:
  */
 class Version1_19_4 : public VersionStrategy {
 public:
+    Version1_19_4() {
+        setBehaviorMultiplier(BehaviorId::AXOLOTL_REGENERATION, 1.5f);
+    }
+    
     std::string getVersion() const override { return "1.19.4"; }
     
     void applyBehaviorModifications(EntityBehaviorData& data) const override {
         // 1.19.4 行为调整
-        if (data.id == "minecraft:axolotl") {
+        if (data.typeId == vanilla::AXOLOTL) {
             data.canSwim = true;
             data.isAquatic = true;
         }
     }
-    
-    float getBehaviorMultiplier(const std::string& behavior) const override {
-        if (behavior == "axolotl_regeneration") return 1.5f;
-        return 1.0f;
-    }
 };
 
 // ====== 工厂模式 ======
@@ -322,12 +457,21 @@ public:
     DataModule(const std::string& minecraftDataPath = "", bool useGitHub = false);
     ~DataModule() = default;
     
-    // 加载实体行为数据
+    // 加载实体行为数据：优先读取预编译的二进制文件，不存在或过期时解析JSON
     bool loadEntityData();
     bool loadEntityDataForVersion(const std::string& version);
     
-    // 获取实体数据
+    // 离线编译：解析JSON并在其旁边写出预编译文件（见entity_data_blob.hpp）
+    bool compileEntityBlob(const std::string& version);
+    
+    // 获取实体数据：字符串版本先查注册表，热路径应使用类型ID
     EntityBehaviorData* getEntityData(const std::string& entityId);
+    EntityBehaviorData* getEntityData(EntityTypeId typeId);
+    
+    // 类型名与ID（未登记的名称返回INVALID_ENTITY_TYPE）
+    EntityTypeId findEntityType(std::string_view name) const;
+    EntityTypeId internEntityType(std::string_view name);
+    std::string getEntityTypeName(EntityTypeId typeId) const;
     std::vector<std::string> getAllEntityIds() const;
     std::vector<EntityBehaviorData> getEntitiesByCategory(const std::string& category) const;
     
@@ -337,14 +481,21 @@ public:
 private:
     std::string minecraftDataPath_;
     bool useGitHub_;
-    std::unordered_map<std::string, EntityBehaviorData> entityData_;
+    EntityTypeRegistry typeRegistry_;
+    std::vector<EntityBehaviorData> entityData_;   // 下标为类型ID，id为空表示该类型没有数据
+    size_t entityCount_ = 0;
     std::unordered_map<std::string, std::string> entityDataByName_; // 按名称索引
-    std::unordered_map<std::string, std::vector<std::string>> categoryIndex_;
+    std::unordered_map<std::string, std::vector<EntityTypeId>> categoryIndex_;
     mutable std::shared_mutex dataMutex_;
     
+    std::string entitiesFilePath(const std::string& version) const;
+    
     // 解析minecraft-data JSON文件
     bool parseEntityJSON(const std::string& filePath);
     
+    // 读取预编译文件
+    bool loadEntityBlob(const std::string& filePath, const std::string& version);
+    
     // 使用nlohmann::json进行完整JSON解析
     EntityBehaviorData parseEntityFromJson(const nlohmann::json& entityJson);
     
@@ -358,6 +509,9 @@ private:
     float getAttackDamageFromId(const std::string& id);
     void setupEntitySpecificProperties(EntityBehaviorData& data);
     void populateCategoryIndex();
+    // 分配类型ID并放入entityData_（调用方持有dataMutex_）
+    void storeEntity(EntityBehaviorData data);
+    void clearEntities();
 };
 
 // ====== AI引擎主类 ======
@@ -368,7 +522,7 @@ private:
 class AIEngine {
 public:
     AIEngine();
-    ~AIEngine() = default;
+    ~AIEngine();
     
     // 初始化和配置
     bool initialize(const std::string& minecraftDataPath, const std::string& gameVersion, bool useGitHub = false);
@@ -376,6 +530,7 @@ public:
     
     // 实体管理
     bool registerEntity(uint64_t entityId, const std::string& entityType);
+    bool registerEntity(uint64_t entityId, EntityTypeId entityType);
     void unregisterEntity(uint64_t entityId);
     void updateEntityState(uint64_t entityId, const EntityState& state);
     
@@ -399,18 +554,66 @@ public:
         uint64_t avgTickTime{0};
         uint64_t maxTickTime{0};
         uint64_t entitiesProcessed{0};
-        std::atomic<uint64_t> memoryUsage{0};
+        uint64_t batchedEntities{0};    // 批量tick处理的实体数
+        uint64_t batchGroups{0};        // 批量tick的批次数
+        uint64_t parallelRegions{0};    // 并行tick执行的区域数
+        uint64_t commandsApplied{0};    // 并行tick应用的状态命令数
+        uint64_t lodSkipped{0};         // 因细节层次降频而跳过的实体次数
+        std::atomic<uint64_t> memoryUsage{0};   // 最近一次tick估算的实体状态与世界视图字节数
     };
     
     const PerformanceStats& getPerformanceStats() const {
         return performanceStats_;
     }
     
+    // 行为树（按实体类型），设置nullptr移除；有行为树的实体不再走默认决策
+    void setBehaviorTree(const std::string& entityType, std::shared_ptr<BehaviorNodeBase> tree);
+    void setBehaviorTree(EntityTypeId entityType, std::shared_ptr<BehaviorNodeBase> tree);
+    
+    // 批量tick：同一行为树的实体组成EntityBatch，每个节点对整批执行
+    void setBatchedTick(bool enabled) { batchedTick_ = enabled; }
+    bool isBatchedTick() const { return batchedTick_; }
+    
+    /**
+     * 并行tick：实体按区域（4x4区块）分组，由线程池的工作线程领取区域执行。
+     * 工作线程只读本tick开始时的状态副本与世界视图快照，移动、目标等写入记为命令，
+     * tick结束时按实体id顺序统一应用，结果与线程调度无关。
+     * threads为0时使用NativeRuntime的共享线程池，否则创建该线程数的专用线程池
+     */
+    void setParallelTick(bool enabled, size_t threads = 0);
+    bool isParallelTick() const { return parallelTick_; }
+    
+    /**
+     * @brief AI细节层次：离所有玩家越远，决策越稀疏
+     * 与最近玩家的距离超过distances[i]时每intervals[i]个tick执行一次，
+     * 每个实体按id带固定的相位偏移，同一间隔的实体分散在不同tick。
+     * 受到伤害（生命值下降）后damageBoostTicks个tick内恢复每tick执行；
+     * 玩家靠近时按新距离立即恢复全频率。
+     */
+    struct LodConfig {
+        bool enabled = false;
+        std::array<float, 3> distances{32.0f, 64.0f, 128.0f};
+        std::array<uint32_t, 3> intervals{2, 4, 8};
+        uint32_t damageBoostTicks = 100;
+    };
+    
+    void setLodConfig(const LodConfig& config);
+    LodConfig getLodConfig() const;
+    // 玩家位置（每tick更新一次即可），没有玩家时不降频
+    void setPlayerPositions(std::vector<std::array<float, 3>> positions);
+    // 实体受到伤害（updateEntityState发现生命值下降时也会调用）
+    void notifyEntityDamaged(uint64_t entityId);
+    
     void resetPerformanceStats() {
         performanceStats_.totalTicks = 0;
         performanceStats_.avgTickTime = 0;
         performanceStats_.maxTickTime = 0;
         performanceStats_.entitiesProcessed = 0;
+        performanceStats_.batchedEntities = 0;
+        performanceStats_.batchGroups = 0;
+        performanceStats_.parallelRegions = 0;
+        performanceStats_.commandsApplied = 0;
+        performanceStats_.lodSkipped = 0;
         performanceStats_.memoryUsage = 0;
     }
     
@@ -420,8 +623,28 @@ private:
     
     // 实体状态管理
     std::unordered_map<uint64_t, EntityState> entityStates_;
-    std::unordered_map<uint64_t, std::string> entityTypes_;
-    std::unordered_map<uint64_t, std::unique_ptr<WorldView>> entityWorldViews_;
+    std::unordered_map<uint64_t, EntityTypeId> entityTypes_;
+    // 世界视图不可变，更新时整体替换，tick期间持有的快照不受影响
+    std::unordered_map<uint64_t, std::shared_ptr<const WorldView>> entityWorldViews_;
+    // 每tick开始时由已登记实体和世界视图中的实体重建位置
+    NeighborIndex neighborIndex_;
+    // 每tick开始时替换为BlockStateStore的当前快照，tick期间不变
+    std::shared_ptr<const world::BlockStateSnapshot> blockStates_;
+    std::vector<std::shared_ptr<BehaviorNodeBase>> behaviorTrees_;     // 下标为类型ID
+    std::atomic<bool> batchedTick_{false};
+    
+    // 并行tick
+    std::atomic<bool> parallelTick_{false};
+    std::unique_ptr<core::ThreadPool> ownedWorkers_;
+    core::ThreadPool* workers_ = nullptr;              // 共享线程池或ownedWorkers_
+    size_t workerCount_{0};
+    std::mutex workersMutex_;
+    
+    // 细节层次（受entityMutex_保护）
+    LodConfig lodConfig_;
+    std::vector<std::array<float, 3>> playerPositions_;
+    std::unordered_map<uint64_t, uint64_t> lodBoostUntil_;  // 实体id -> 全频率执行到的tick
+    uint64_t aiTick_{0};
     
     // 并发控制
     mutable std::shared_mutex entityMutex_;
@@ -430,9 +653,23 @@ private:
     PerformanceStats performanceStats_;
     mutable std::mutex statsMutex_;
     
+    // native内存预算：每tick按实体状态与世界视图估算，超出AI预算时丢弃过期数据
+    core::MemoryCharge memory_{core::MemorySubsystem::AI};
+    uint64_t shedderId_ = 0;
+    
     // 内部方法
     void processEntityBehavior(uint64_t entityId, const EntityState& state, const WorldView& world);
     void updateWorldViewInternal(uint64_t entityId, const WorldView& world);
+    // 批量执行有行为树的实体，其余实体id放入scalarIds，返回批量执行的实体数
+    size_t tickBatched(std::vector<uint64_t>& scalarIds, size_t& skipped);
+    // 调用方持有entityMutex_
+    const std::shared_ptr<BehaviorNodeBase>& behaviorTreeFor(uint64_t entityId) const;
+    bool lodAllows(uint64_t entityId, const EntityState& state) const;
+    void refreshNeighborIndex();
+    // 调用方持有entityMutex_
+    size_t estimateMemoryLocked() const;
+    size_t shedMemory(size_t bytes);
+    void tickParallel(const std::vector<uint64_t>& entityIds);
 };
 
 // ====== 线程局部存储管理 ======
@@ -0,0 +1,391 @@
+#include "entity_data_blob.hpp"
+#include "biological_ai.hpp"
+#include "../core/io/memory_mapped_region.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <type_traits>
+
+namespace lattice::entity::blob {
+
+namespace {
+
+struct StrRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+struct Range {
+    uint32_t first;
+    uint32_t count;
+};
+
+struct Pair {
+    StrRef key;
+    float value;
+};
+
+struct Header {
+    uint32_t magic;
+    uint16_t formatVersion;
+    uint16_t byteOrder;
+    uint32_t recordSize;
+    uint32_t entityCount;
+    uint64_t pairsOffset;
+    uint32_t pairCount;
+    uint32_t listCount;
+    uint64_t listsOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+    uint64_t sourceSize;
+    int64_t sourceModified;
+    uint64_t checksum;          // 头部之后全部内容的FNV-1a
+    char gameVersion[16];
+};
+
+// 布尔标志的位序（新增字段只能追加，否则需要提升FORMAT_VERSION）
+enum Flag : uint32_t {
+    FIRE_IMMUNE, FIREPROOF, CAN_BREAK_DOORS, BURNS_IN_SUNLIGHT, AVOIDS_WATER, CAN_FLY, CAN_SWIM,
+    CAN_DIG, IS_AQUATIC, IS_NOCTURNAL, IS_DIURNAL, CAN_ATTACK, CAN_ATTACK_PLAYERS, CAN_ATTACK_MOBS,
+    CAN_RANGED_ATTACK, CAN_EXPLODE, CAN_TELEPORT, CAN_BE_TAMED, CAN_CLIMB_WALLS, CAN_OPEN_DOORS,
+    CAN_PASS_DOORS, IS_FELINE, IS_CANINE, IS_MOUNTABLE, CAN_JUMP, FLAG_COUNT
+};
+static_assert(FLAG_COUNT <= 32, "flags must fit in uint32_t");
+
+struct Record {
+    StrRef id, name, category, entityType, environmentType;
+    float maxHealth, attackDamage, followRange, pathfindingRange, movementSpeed;
+    float width, height, flyingSpeed;
+    float attackCooldown, attackInterval, rangedAttackRange, explosionRadius, jumpHeight;
+    uint32_t flags;
+    Range blockPreferences, biomePreferences, lightPreferences, targetPriorities;
+    Range equipmentSlots;
+};
+
+static_assert(std::is_trivially_copyable_v<Header> && std::is_trivially_copyable_v<Record>,
+              "blob sections are copied as raw bytes");
+
+template <typename Fn>
+void forEachFlag(Fn&& fn, auto& data) {
+    fn(FIRE_IMMUNE, data.fireImmune);
+    fn(FIREPROOF, data.fireproof);
+    fn(CAN_BREAK_DOORS, data.canBreakDoors);
+    fn(BURNS_IN_SUNLIGHT, data.burnsInSunlight);
+    fn(AVOIDS_WATER, data.avoidsWater);
+    fn(CAN_FLY, data.canFly);
+    fn(CAN_SWIM, data.canSwim);
+    fn(CAN_DIG, data.canDig);
+    fn(IS_AQUATIC, data.isAquatic);
+    fn(IS_NOCTURNAL, data.isNocturnal);
+    fn(IS_DIURNAL, data.isDiurnal);
+    fn(CAN_ATTACK, data.canAttack);
+    fn(CAN_ATTACK_PLAYERS, data.canAttackPlayers);
+    fn(CAN_ATTACK_MOBS, data.canAttackMobs);
+    fn(CAN_RANGED_ATTACK, data.canRangedAttack);
+    fn(CAN_EXPLODE, data.canExplode);
+    fn(CAN_TELEPORT, data.canTeleport);
+    fn(CAN_BE_TAMED, data.canBeTamed);
+    fn(CAN_CLIMB_WALLS, data.canClimbWalls);
+    fn(CAN_OPEN_DOORS, data.canOpenDoors);
+    fn(CAN_PASS_DOORS, data.canPassDoors);
+    fn(IS_FELINE, data.isFeline);
+    fn(IS_CANINE, data.isCanine);
+    fn(IS_MOUNTABLE, data.isMountable);
+    fn(CAN_JUMP, data.canJump);
+}
+
+uint64_t fnv1a(const uint8_t* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+size_t align8(size_t value) {
+    return (value + 7) & ~static_cast<size_t>(7);
+}
+
+// 写入端：字符串去重，映射表按键排序以保证输出确定
+class Builder {
+public:
+    StrRef intern(const std::string& value) {
+        auto it = interned_.find(value);
+        if (it != interned_.end()) {
+            return it->second;
+        }
+        const StrRef ref{static_cast<uint32_t>(strings_.size()), static_cast<uint32_t>(value.size())};
+        strings_.append(value);
+        interned_.emplace(value, ref);
+        return ref;
+    }
+
+    Range pairs(const std::unordered_map<std::string, float>& map) {
+        std::map<std::string, float> sorted(map.begin(), map.end());
+        const Range range{static_cast<uint32_t>(pairs_.size()), static_cast<uint32_t>(sorted.size())};
+        for (const auto& [key, value] : sorted) {
+            pairs_.push_back(Pair{intern(key), value});
+        }
+        return range;
+    }
+
+    Range list(const std::vector<std::string>& values) {
+        const Range range{static_cast<uint32_t>(lists_.size()), static_cast<uint32_t>(values.size())};
+        for (const auto& value : values) {
+            lists_.push_back(intern(value));
+        }
+        return range;
+    }
+
+    std::vector<Pair> pairs_;
+    std::vector<StrRef> lists_;
+    std::string strings_;
+
+private:
+    std::unordered_map<std::string, StrRef> interned_;
+};
+
+} // namespace
+
+SourceStamp stampOf(const std::string& path) {
+    SourceStamp stamp;
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) {
+        return stamp;
+    }
+    const auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return stamp;
+    }
+    stamp.size = size;
+    stamp.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    stamp.exists = true;
+    return stamp;
+}
+
+std::string blobPathFor(const std::string& jsonPath) {
+    return std::filesystem::path(jsonPath).replace_extension(".lebd").string();
+}
+
+bool write(const std::string& path, const std::string& gameVersion, const SourceStamp& source,
+           const std::vector<const EntityBehaviorData*>& entities) {
+    if (gameVersion.size() >= sizeof(Header::gameVersion)) {
+        fprintf(stderr, "Game version too long for entity blob: %s\n", gameVersion.c_str());
+        return false;
+    }
+
+    std::vector<const EntityBehaviorData*> sorted(entities);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const EntityBehaviorData* a, const EntityBehaviorData* b) { return a->id < b->id; });
+
+    Builder builder;
+    std::vector<Record> records;
+    records.reserve(sorted.size());
+    for (const EntityBehaviorData* data : sorted) {
+        Record record{};
+        record.id = builder.intern(data->id);
+        record.name = builder.intern(data->name);
+        record.category = builder.intern(data->category);
+        record.entityType = builder.intern(data->entityType);
+        record.environmentType = builder.intern(data->environmentType);
+        record.maxHealth = data->maxHealth;
+        record.attackDamage = data->attackDamage;
+        record.followRange = data->followRange;
+        record.pathfindingRange = data->pathfindingRange;
+        record.movementSpeed = data->movementSpeed;
+        record.width = data->width;
+        record.height = data->height;
+        record.flyingSpeed = data->flyingSpeed;
+        record.attackCooldown = data->attackCooldown;
+        record.attackInterval = data->attackInterval;
+        record.rangedAttackRange = data->rangedAttackRange;
+        record.explosionRadius = data->explosionRadius;
+        record.jumpHeight = data->jumpHeight;
+        forEachFlag([&](Flag flag, bool value) { record.flags |= static_cast<uint32_t>(value) << flag; }, *data);
+        record.blockPreferences = builder.pairs(data->blockPreferences);
+        record.biomePreferences = builder.pairs(data->biomePreferences);
+        record.lightPreferences = builder.pairs(data->lightPreferences);
+        record.targetPriorities = builder.pairs(data->targetPriorities);
+        record.equipmentSlots = builder.list(data->equipmentSlots);
+        records.push_back(record);
+    }
+
+    Header header{};
+    header.magic = MAGIC;
+    header.formatVersion = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.recordSize = sizeof(Record);
+    header.entityCount = static_cast<uint32_t>(records.size());
+    header.pairCount = static_cast<uint32_t>(builder.pairs_.size());
+    header.listCount = static_cast<uint32_t>(builder.lists_.size());
+    header.pairsOffset = align8(sizeof(Header) + records.size() * sizeof(Record));
+    header.listsOffset = align8(header.pairsOffset + builder.pairs_.size() * sizeof(Pair));
+    header.stringsOffset = align8(header.listsOffset + builder.lists_.size() * sizeof(StrRef));
+    header.stringsSize = builder.strings_.size();
+    header.sourceSize = source.size;
+    header.sourceModified = source.modified;
+    std::memcpy(header.gameVersion, gameVersion.data(), gameVersion.size());
+
+    std::vector<uint8_t> bytes(header.stringsOffset + header.stringsSize, 0);
+    auto place = [&](uint64_t offset, const void* data, size_t size) {
+        if (size != 0) {
+            std::memcpy(bytes.data() + offset, data, size);
+        }
+    };
+    place(sizeof(Header), records.data(), records.size() * sizeof(Record));
+    place(header.pairsOffset, builder.pairs_.data(), builder.pairs_.size() * sizeof(Pair));
+    place(header.listsOffset, builder.lists_.data(), builder.lists_.size() * sizeof(StrRef));
+    place(header.stringsOffset, builder.strings_.data(), builder.strings_.size());
+    header.checksum = fnv1a(bytes.data() + sizeof(Header), bytes.size() - sizeof(Header));
+    place(0, &header, sizeof(Header));
+
+    // 先写临时文件再改名，正在映射旧文件的进程不受影响
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            fprintf(stderr, "Failed to create entity blob: %s\n", temporary.c_str());
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!out) {
+            fprintf(stderr, "Failed to write entity blob: %s\n", temporary.c_str());
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        fprintf(stderr, "Failed to install entity blob %s: %s\n", path.c_str(), error.message().c_str());
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool read(const std::string& path, const std::string& gameVersion, const SourceStamp& source,
+          std::vector<EntityBehaviorData>& entities) {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return false;
+    }
+
+    std::unique_ptr<io::MemoryMappedRegion> region;
+    try {
+        region = std::make_unique<io::MemoryMappedRegion>(path, 0, true);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Failed to map entity blob %s: %s\n", path.c_str(), e.what());
+        return false;
+    }
+    const auto* base = static_cast<const uint8_t*>(region->data());
+    const size_t size = region->size();
+
+    if (size < sizeof(Header)) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+    if (header.magic != MAGIC || header.formatVersion != FORMAT_VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.recordSize != sizeof(Record)) {
+        fprintf(stderr, "Entity blob %s has an incompatible format, falling back to JSON\n", path.c_str());
+        return false;
+    }
+    if (gameVersion != std::string(header.gameVersion, strnlen(header.gameVersion, sizeof(header.gameVersion)))) {
+        return false;
+    }
+    if (source.exists && (header.sourceSize != source.size || header.sourceModified != source.modified)) {
+        fprintf(stderr, "Entity blob %s is older than its JSON source, falling back to JSON\n", path.c_str());
+        return false;
+    }
+
+    // 各段边界都在文件内，之后的下标只需检查区间
+    const uint64_t recordsEnd = sizeof(Header) + static_cast<uint64_t>(header.entityCount) * sizeof(Record);
+    if (recordsEnd > header.pairsOffset ||
+        header.pairsOffset + static_cast<uint64_t>(header.pairCount) * sizeof(Pair) > header.listsOffset ||
+        header.listsOffset + static_cast<uint64_t>(header.listCount) * sizeof(StrRef) > header.stringsOffset ||
+        header.stringsOffset + header.stringsSize != size ||
+        header.pairsOffset % alignof(Pair) != 0 || header.listsOffset % alignof(StrRef) != 0) {
+        fprintf(stderr, "Entity blob %s is truncated or malformed\n", path.c_str());
+        return false;
+    }
+    if (fnv1a(base + sizeof(Header), size - sizeof(Header)) != header.checksum) {
+        fprintf(stderr, "Entity blob %s failed its checksum\n", path.c_str());
+        return false;
+    }
+
+    const auto* records = reinterpret_cast<const Record*>(base + sizeof(Header));
+    const auto* pairs = reinterpret_cast<const Pair*>(base + header.pairsOffset);
+    const auto* lists = reinterpret_cast<const StrRef*>(base + header.listsOffset);
+    const char* strings = reinterpret_cast<const char*>(base + header.stringsOffset);
+
+    bool valid = true;
+    auto text = [&](StrRef ref) -> std::string {
+        if (static_cast<uint64_t>(ref.offset) + ref.length > header.stringsSize) {
+            valid = false;
+            return {};
+        }
+        return std::string(strings + ref.offset, ref.length);
+    };
+    auto map = [&](Range range, std::unordered_map<std::string, float>& out) {
+        if (static_cast<uint64_t>(range.first) + range.count > header.pairCount) {
+            valid = false;
+            return;
+        }
+        out.reserve(range.count);
+        for (uint32_t i = 0; i < range.count; ++i) {
+            const Pair& pair = pairs[range.first + i];
+            out.emplace(text(pair.key), pair.value);
+        }
+    };
+
+    std::vector<EntityBehaviorData> loaded(header.entityCount);
+    for (uint32_t i = 0; i < header.entityCount && valid; ++i) {
+        const Record& record = records[i];
+        EntityBehaviorData& data = loaded[i];
+        data.id = text(record.id);
+        data.name = text(record.name);
+        data.category = text(record.category);
+        data.entityType = text(record.entityType);
+        data.environmentType = text(record.environmentType);
+        data.maxHealth = record.maxHealth;
+        data.attackDamage = record.attackDamage;
+        data.followRange = record.followRange;
+        data.pathfindingRange = record.pathfindingRange;
+        data.movementSpeed = record.movementSpeed;
+        data.width = record.width;
+        data.height = record.height;
+        data.flyingSpeed = record.flyingSpeed;
+        data.attackCooldown = record.attackCooldown;
+        data.attackInterval = record.attackInterval;
+        data.rangedAttackRange = record.rangedAttackRange;
+        data.explosionRadius = record.explosionRadius;
+        data.jumpHeight = record.jumpHeight;
+        forEachFlag([&](Flag flag, bool& value) { value = (record.flags >> flag) & 1; }, data);
+        map(record.blockPreferences, data.blockPreferences);
+        map(record.biomePreferences, data.biomePreferences);
+        map(record.lightPreferences, data.lightPreferences);
+        map(record.targetPriorities, data.targetPriorities);
+        if (static_cast<uint64_t>(record.equipmentSlots.first) + record.equipmentSlots.count > header.listCount) {
+            valid = false;
+            break;
+        }
+        data.equipmentSlots.reserve(record.equipmentSlots.count);
+        for (uint32_t j = 0; j < record.equipmentSlots.count; ++j) {
+            data.equipmentSlots.push_back(text(lists[record.equipmentSlots.first + j]));
+        }
+    }
+    if (!valid) {
+        fprintf(stderr, "Entity blob %s has out-of-range references\n", path.c_str());
+        return false;
+    }
+
+    entities = std::move(loaded);
+    return true;
+}
+
+} // namespace lattice::entity::blob
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lattice::entity {
+
+struct EntityBehaviorData;
+
+// ====== 预编译实体数据 ======
+
+/**
+ * @brief 实体行为数据的二进制预编译格式
+ *
+ * 离线把entities.json解析后的EntityBehaviorData写成一个可直接mmap的文件，
+ * 启动时只需映射、校验头部，再把定长记录展开为EntityBehaviorData，不经过JSON解析。
+ *
+ * 文件布局（本机字节序，各段按8字节对齐）：
+ *   Header | Record[entityCount] | Pair[pairCount] | StrRef[listCount] | 字符串表
+ * 记录中的字符串是字符串表里的(偏移, 长度)，映射表和列表是Pair/StrRef段里的区间。
+ *
+ * 头部记录格式版本、记录大小、游戏版本和源JSON的大小与修改时间：
+ * 任意一项不一致，或校验和不符，读取返回false，调用方回退到JSON。
+ */
+namespace blob {
+
+constexpr uint32_t MAGIC = 0x4442454C;         // "LEBD"
+constexpr uint16_t FORMAT_VERSION = 1;
+constexpr uint16_t BYTE_ORDER_MARK = 0x0102;
+
+// 源JSON文件的标识，用于判断预编译文件是否过期
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t modified = 0;   // 文件修改时间（file_time_type的计数）
+    bool exists = false;
+};
+
+SourceStamp stampOf(const std::string& path);
+
+// 预编译文件的默认位置：与源JSON同目录，扩展名换为.lebd
+std::string blobPathFor(const std::string& jsonPath);
+
+bool write(const std::string& path, const std::string& gameVersion, const SourceStamp& source,
+           const std::vector<const EntityBehaviorData*>& entities);
+
+/**
+ * 读取预编译文件，source.exists为true时要求与记录的源文件标识一致
+ */
+bool read(const std::string& path, const std::string& gameVersion, const SourceStamp& source,
+          std::vector<EntityBehaviorData>& entities);
+
+} // namespace blob
+
+} // namespace lattice::entity
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice::entity {
+
+// ====== 实体类型与行为名的整数ID ======
+
+using EntityTypeId = uint16_t;
+inline constexpr EntityTypeId INVALID_ENTITY_TYPE = 0xFFFF;
+
+/**
+ * @brief 原版实体类型的编译期ID
+ *
+ * 下标即ID，EntityTypeRegistry构造时按此顺序预先登记，所以这些ID在任何数据加载之前就固定；
+ * 数据文件里的其他类型排在后面。名称与minecraft-data的name字段相同（不带命名空间）。
+ * 只能在末尾追加，否则会改变已有ID。
+ */
+namespace vanilla {
+
+inline constexpr std::array<std::string_view, 83> ENTITY_NAMES = {
+    "player", "allay", "armadillo", "axolotl", "bat", "bee", "blaze", "bogged", "breeze", "camel",
+    "cat", "cave_spider", "chicken", "cod", "cow", "creeper", "dolphin", "donkey", "drowned",
+    "elder_guardian", "ender_dragon", "enderman", "endermite", "evoker", "fox", "frog", "ghast",
+    "giant", "glow_squid", "goat", "guardian", "hoglin", "horse", "husk", "illusioner", "iron_golem",
+    "llama", "magma_cube", "mooshroom", "mule", "ocelot", "panda", "parrot", "phantom", "pig",
+    "piglin", "piglin_brute", "pillager", "polar_bear", "pufferfish", "rabbit", "ravager", "salmon",
+    "sheep", "shulker", "silverfish", "skeleton", "skeleton_horse", "slime", "sniffer", "snow_golem",
+    "spider", "squid", "stray", "strider", "tadpole", "trader_llama", "tropical_fish", "turtle",
+    "vex", "villager", "vindicator", "wandering_trader", "warden", "witch", "wither",
+    "wither_skeleton", "wolf", "zoglin", "zombie", "zombie_horse", "zombie_villager", "zombified_piglin"
+};
+
+// 名称不在表中时编译失败
+consteval EntityTypeId typeId(std::string_view name) {
+    for (size_t i = 0; i < ENTITY_NAMES.size(); ++i) {
+        if (ENTITY_NAMES[i] == name) {
+            return static_cast<EntityTypeId>(i);
+        }
+    }
+    throw "unknown vanilla entity type";
+}
+
+inline constexpr EntityTypeId PLAYER = typeId("player");
+inline constexpr EntityTypeId ALLAY = typeId("allay");
+inline constexpr EntityTypeId AXOLOTL = typeId("axolotl");
+inline constexpr EntityTypeId BOGGED = typeId("bogged");
+inline constexpr EntityTypeId BREEZE = typeId("breeze");
+inline constexpr EntityTypeId WARDEN = typeId("warden");
+inline constexpr EntityTypeId ZOMBIE = typeId("zombie");
+
+} // namespace vanilla
+
+/**
+ * @brief 版本策略使用的行为名
+ */
+enum class BehaviorId : uint8_t {
+    WARDEN_ATTACK,
+    ALLAY_FOLLOW,
+    AXOLOTL_SWIM,
+    AXOLOTL_REGENERATION,
+    COUNT
+};
+
+inline constexpr std::array<std::string_view, static_cast<size_t>(BehaviorId::COUNT)> BEHAVIOR_NAMES = {
+    "warden_attack", "allay_follow", "axolotl_swim", "axolotl_regeneration"
+};
+
+// 未知行为名返回BehaviorId::COUNT
+inline BehaviorId behaviorIdOf(std::string_view name) {
+    for (size_t i = 0; i < BEHAVIOR_NAMES.size(); ++i) {
+        if (BEHAVIOR_NAMES[i] == name) {
+            return static_cast<BehaviorId>(i);
+        }
+    }
+    return BehaviorId::COUNT;
+}
+
+/**
+ * @brief 实体类型注册表 - 类型名到稠密整数ID
+ *
+ * 加载数据时把类型名登记一次，之后按ID用数组下标访问。
+ * 名称统一去掉"minecraft:"命名空间，"minecraft:zombie"与"zombie"是同一个类型。
+ * 不是线程安全的，由持有者（DataModule）加锁。
+ */
+class EntityTypeRegistry {
+public:
+    EntityTypeRegistry() {
+        names_.reserve(vanilla::ENTITY_NAMES.size());
+        for (std::string_view name : vanilla::ENTITY_NAMES) {
+            intern(name);
+        }
+    }
+
+    static std::string_view canonicalName(std::string_view name) {
+        constexpr std::string_view NAMESPACE = "minecraft:";
+        if (name.substr(0, NAMESPACE.size()) == NAMESPACE) {
+            name.remove_prefix(NAMESPACE.size());
+        }
+        return name;
+    }
+
+    // 返回已有ID或登记一个新ID；ID用完时返回INVALID_ENTITY_TYPE
+    EntityTypeId intern(std::string_view name) {
+        name = canonicalName(name);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+        if (names_.size() >= INVALID_ENTITY_TYPE) {
+            return INVALID_ENTITY_TYPE;
+        }
+        const auto id = static_cast<EntityTypeId>(names_.size());
+        names_.emplace_back(name);
+        ids_.emplace(names_.back(), id);
+        return id;
+    }
+
+    EntityTypeId find(std::string_view name) const {
+        auto it = ids_.find(canonicalName(name));
+        return it != ids_.end() ? it->second : INVALID_ENTITY_TYPE;
+    }
+
+    const std::string& name(EntityTypeId id) const {
+        static const std::string empty;
+        return id < names_.size() ? names_[id] : empty;
+    }
+
+    size_t size() const { return names_.size(); }
+
+private:
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, EntityTypeId, NameHash, std::equal_to<>> ids_;
+};
+
+} // namespace lattice::entity
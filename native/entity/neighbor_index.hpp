@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../core/net/loose_grid.hpp"
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lattice::entity {
+
+// ====== AI邻居查询索引 ======
+
+/**
+ * @brief AI邻居查询的共享空间索引
+ *
+ * 与HierarchicalTracker使用同一种松散网格（LooseGrid，格子边长相同），
+ * AIEngine每个tick开始时把已知实体的位置写入一次，之后本tick内所有行为节点的范围查询共用这一份格子结构，
+ * 不再逐个遍历各自世界视图里的实体列表。
+ *
+ * 网格按槽位编号存放实体，槽位在实体消失前保持不变，
+ * 所以格子内移动只更新坐标（LooseGrid::move），不重建格子。
+ * tick期间只读，可以被多个工作线程同时查询；更新由AIEngine在持有实体锁时进行。
+ */
+class NeighborIndex {
+public:
+    static constexpr int CELL_SIZE = 32;    // 与HierarchicalTracker的GRID_CELL_SIZE相同
+
+    struct Entry {
+        uint64_t id = 0;
+        float x = 0, y = 0, z = 0;
+        bool isOnFire = false;
+    };
+
+    // 开始新一轮写入；之后没有再写入的实体在endUpdate时移除
+    void beginUpdate() {
+        ++generation_;
+    }
+
+    // 同一轮内重复写入同一个id时保留第一次的值
+    void update(uint64_t id, float x, float y, float z, bool isOnFire) {
+        auto [it, inserted] = slotOf_.try_emplace(id, 0);
+        if (inserted) {
+            it->second = allocateSlot();
+        }
+        const uint32_t slot = it->second;
+        if (generations_[slot] == generation_) {
+            return;
+        }
+        generations_[slot] = generation_;
+        entries_[slot] = Entry{id, x, y, z, isOnFire};
+        if (inserted) {
+            grid_.insert(static_cast<int>(slot), x, z);
+        } else {
+            grid_.move(static_cast<int>(slot), x, z);
+        }
+    }
+
+    void endUpdate() {
+        for (uint32_t slot = 0; slot < entries_.size(); ++slot) {
+            if (generations_[slot] == 0 || generations_[slot] == generation_) {
+                continue;
+            }
+            grid_.remove(static_cast<int>(slot));
+            slotOf_.erase(entries_[slot].id);
+            generations_[slot] = 0;
+            freeSlots_.push_back(slot);
+        }
+    }
+
+    /**
+     * 对三维距离不超过range的实体调用fn(entry, distance)
+     * fn里不能再调用forEachInRange（共用线程局部的候选缓冲）
+     */
+    template <typename Fn>
+    void forEachInRange(float x, float y, float z, float range, Fn&& fn) const {
+        thread_local std::vector<int> candidates;
+        candidates.clear();
+        grid_.queryRange(x, z, range, candidates);
+        const float rangeSq = range * range;
+        for (int slot : candidates) {
+            const Entry& entry = entries_[slot];
+            const float dx = entry.x - x;
+            const float dy = entry.y - y;
+            const float dz = entry.z - z;
+            const float distanceSq = dx * dx + dy * dy + dz * dz;
+            if (distanceSq <= rangeSq) {
+                fn(entry, std::sqrt(distanceSq));
+            }
+        }
+    }
+
+    size_t size() const { return slotOf_.size(); }
+    size_t cellCount() const { return grid_.cellCount(); }
+
+private:
+    uint32_t allocateSlot() {
+        if (!freeSlots_.empty()) {
+            const uint32_t slot = freeSlots_.back();
+            freeSlots_.pop_back();
+            return slot;
+        }
+        entries_.emplace_back();
+        generations_.push_back(0);
+        return static_cast<uint32_t>(entries_.size() - 1);
+    }
+
+    LooseGrid<CELL_SIZE> grid_;
+    std::vector<Entry> entries_;
+    std::vector<uint64_t> generations_;     // 0表示空槽
+    std::vector<uint32_t> freeSlots_;
+    std::unordered_map<uint64_t, uint32_t> slotOf_;
+    uint64_t generation_ = 0;
+};
+
+} // namespace lattice::entity
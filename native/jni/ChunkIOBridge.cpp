@@ -1,4 +1,7 @@
 #include "ChunkIOBridge.h"
+#include "jni_registry.hpp"
+#include "safe_memory_manager.hpp"
+#include "../core/workload_trace.hpp"
 #include <thread>
 #include <chrono>
 #include <fstream>
@@ -8,12 +11,11 @@
 namespace lattice {
 namespace jni {
 
+using lattice::core::TraceEvent;
+using lattice::core::WorkloadRecorder;
+
 // ===== 静态成员初始化 =====
 
-jclass ChunkIOBridge::chunkIOClass_ = nullptr;
-jmethodID ChunkIOBridge::callbackMethod_ = nullptr;
-jclass ChunkIOBridge::resultClass_ = nullptr;
-jmethodID ChunkIOBridge::resultConstructor_ = nullptr;
 std::unique_ptr<ChunkIOBridge> ChunkIOBridge::globalInstance_ = nullptr;
 
 // ===== 构造函数和析构函数 =====
@@ -23,6 +25,7 @@ ChunkIOBridge::ChunkIOBridge(const std::string& worldPath)
     // 初始化异步IO和Anvil IO
     asyncIO_ = std::make_unique<lattice::io::AsyncChunkIO>();
     anvilIO_ = std::make_unique<lattice::io::anvil::AnvilChunkIO>(worldPath);
+    linearIO_ = std::make_unique<lattice::io::anvil::LinearChunkIO>(worldPath);
 }
 
 ChunkIOBridge::~ChunkIOBridge() {
@@ -33,6 +36,9 @@ ChunkIOBridge::~ChunkIOBridge() {
 
 void JNICALL ChunkIOBridge::loadChunkAsync(JNIEnv* env, jobject obj, 
                                            jint worldId, jint chunkX, jint chunkZ) {
+    if (auto record = WorkloadRecorder::begin(TraceEvent::CHUNK_LOAD)) {
+        record.i32(worldId).i32(chunkX).i32(chunkZ);
+    }
     try {
         auto instance = getInstance();
         if (!instance) {
@@ -48,6 +54,11 @@ void JNICALL ChunkIOBridge::loadChunkAsync(JNIEnv* env, jobject obj,
                     // 转换为Java格式并回调
                     invokeCallback(env, obj, result.success, result.errorMessage);
                 });
+        } else if (format == lattice::io::StorageFormat::LINEAR) {
+            instance->linearIO_->loadChunkAsync(worldId, chunkX, chunkZ,
+                [env, obj](lattice::io::AsyncIOResult result) {
+                    invokeCallback(env, obj, result.success, result.errorMessage);
+                });
         } else {
             instance->asyncIO_->loadChunkAsync(worldId, chunkX, chunkZ,
                 [env, obj](lattice::io::AsyncIOResult result) {
@@ -75,6 +86,11 @@ void JNICALL ChunkIOBridge::saveChunkAsync(JNIEnv* env, jobject obj,
             throwJavaException(env, "Invalid chunk data");
             return;
         }
+        if (auto record = WorkloadRecorder::begin(TraceEvent::CHUNK_SAVE)) {
+            const bool payload = WorkloadRecorder::instance().chunkPayloads();
+            record.i32(worldId).i32(chunkX).i32(chunkZ).u64(chunkData.size())
+                  .bytes(chunkData.data(), payload ? chunkData.size() : 0);
+        }
         
         // 创建区块数据结构
         lattice::io::ChunkData chunk;
@@ -96,6 +112,13 @@ void JNICALL ChunkIOBridge::saveChunkAsync(JNIEnv* env, jobject obj,
                 [env, obj](lattice::io::AsyncIOResult result) {
                     invokeCallback(env, obj, result.success, result.errorMessage);
                 });
+        } else if (format == lattice::io::StorageFormat::LINEAR) {
+            // 只修改常驻region，flushLinearRegions时写盘
+            instance->linearIO_->saveChunkAsync(worldId, chunkX, chunkZ, chunkData,
+                static_cast<uint32_t>(chunk.lastModified),
+                [env, obj](lattice::io::AsyncIOResult result) {
+                    invokeCallback(env, obj, result.success, result.errorMessage);
+                });
         } else {
             instance->asyncIO_->saveChunkAsync(chunk,
                 [env, obj](lattice::io::AsyncIOResult result) {
@@ -148,6 +171,85 @@ void JNICALL ChunkIOBridge::saveChunksBatch(JNIEnv* env, jobject obj,
     }
 }
 
+jint JNICALL ChunkIOBridge::saveChunkDelta(JNIEnv* env, jobject obj,
+                                           jint worldId, jint chunkX, jint chunkZ, jint sectionCount,
+                                           jintArray dirtySectionIndices, jobjectArray dirtySections,
+                                           jbyteArray header, jbyteArray blockEntities) {
+    using lattice::io::anvil::SectionSaveCache;
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return 0;
+        }
+        if (instance->asyncIO_->getStorageFormat() != lattice::io::StorageFormat::ANVIL) {
+            throwJavaException(env, "Delta saves require the Anvil storage format");
+            return 0;
+        }
+        
+        jsize dirtyCount = dirtySectionIndices ? env->GetArrayLength(dirtySectionIndices) : 0;
+        if (sectionCount < 0 || (dirtySections ? env->GetArrayLength(dirtySections) : 0) != dirtyCount) {
+            throwJavaException(env, "Mismatched dirty section arrays");
+            return 0;
+        }
+        
+        lattice::io::anvil::ChunkDelta delta;
+        delta.worldId = worldId;
+        delta.chunkX = chunkX;
+        delta.chunkZ = chunkZ;
+        delta.timestamp = static_cast<uint32_t>(std::time(nullptr));
+        delta.sectionCount = static_cast<size_t>(sectionCount);
+        delta.hasHeader = header != nullptr;
+        delta.header = getDataFromJavaByteArray(env, header);
+        delta.hasBlockEntities = blockEntities != nullptr;
+        delta.blockEntities = getDataFromJavaByteArray(env, blockEntities);
+        
+        std::vector<jint> indices(dirtyCount);
+        if (dirtyCount > 0) {
+            env->GetIntArrayRegion(dirtySectionIndices, 0, dirtyCount, indices.data());
+        }
+        delta.dirtySections.reserve(dirtyCount);
+        for (jsize i = 0; i < dirtyCount; ++i) {
+            auto section = static_cast<jbyteArray>(env->GetObjectArrayElement(dirtySections, i));
+            if (indices[i] < 0) {
+                env->DeleteLocalRef(section);
+                throwJavaException(env, "Negative section index");
+                return 0;
+            }
+            delta.dirtySections.emplace_back(static_cast<size_t>(indices[i]),
+                                             getDataFromJavaByteArray(env, section));
+            env->DeleteLocalRef(section);
+        }
+        
+        std::string error;
+        auto outcome = instance->anvilIO_->saveChunkDelta(delta,
+            [&error](lattice::io::AsyncIOResult result) {
+                if (!result.success) {
+                    error = result.errorMessage;
+                }
+            });
+        
+        if (outcome != SectionSaveCache::DeltaResult::NEEDS_FULL && !error.empty()) {
+            throwJavaException(env, error.c_str());
+            return 0;
+        }
+        return static_cast<jint>(outcome);
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return 0;
+    }
+}
+
+void JNICALL ChunkIOBridge::forgetChunkBaseline(JNIEnv* env, jobject obj,
+                                                jint worldId, jint chunkX, jint chunkZ) {
+    auto instance = getInstance();
+    if (!instance) {
+        throwJavaException(env, "ChunkIOBridge not initialized");
+        return;
+    }
+    instance->anvilIO_->forgetChunkBaseline(worldId, chunkX, chunkZ);
+}
+
 void JNICALL ChunkIOBridge::setStorageFormat(JNIEnv* env, jobject obj, jint format) {
     try {
         auto instance = getInstance();
@@ -157,6 +259,10 @@ void JNICALL ChunkIOBridge::setStorageFormat(JNIEnv* env, jobject obj, jint form
         }
         
         auto storageFormat = static_cast<lattice::io::StorageFormat>(format);
+        if (storageFormat == lattice::io::StorageFormat::LINEAR && !lattice::io::anvil::LinearRegionFile::available()) {
+            throwJavaException(env, "Linear region format requires zstd support");
+            return;
+        }
         instance->asyncIO_->setStorageFormat(storageFormat);
     } catch (const std::exception& e) {
         throwJavaException(env, e.what());
@@ -205,10 +311,21 @@ jboolean JNICALL ChunkIOBridge::convertToAnvilFormat(JNIEnv* env, jobject obj, j
         }
         
         // 检查当前是否已经是Anvil格式
-        if (instance->asyncIO_->getStorageFormat() == lattice::io::StorageFormat::ANVIL) {
+        auto format = instance->asyncIO_->getStorageFormat();
+        if (format == lattice::io::StorageFormat::ANVIL) {
             return JNI_TRUE; // 已经是Anvil格式
         }
         
+        if (format == lattice::io::StorageFormat::LINEAR) {
+            auto stats = instance->linearIO_->convertToAnvil(*instance->anvilIO_, worldId, false);
+            if (stats.failedChunks != 0 || stats.failedRegions != 0) {
+                throwJavaException(env, stats.firstError.c_str());
+                return JNI_FALSE;
+            }
+            instance->asyncIO_->setStorageFormat(lattice::io::StorageFormat::ANVIL);
+            return JNI_TRUE;
+        }
+        
         // TODO: 实现格式转换逻辑
         // 这是一个复杂的操作，需要遍历所有区块并重新保存
         throwJavaException(env, "Format conversion not implemented yet");
@@ -219,6 +336,139 @@ jboolean JNICALL ChunkIOBridge::convertToAnvilFormat(JNIEnv* env, jobject obj, j
     }
 }
 
+jlongArray JNICALL ChunkIOBridge::convertStorageFormat(JNIEnv* env, jobject obj, jint worldId,
+                                                     jint targetFormat, jboolean removeSource) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return nullptr;
+        }
+        
+        lattice::io::anvil::LinearChunkIO::ConversionStats stats;
+        const auto target = static_cast<lattice::io::StorageFormat>(targetFormat);
+        if (target == lattice::io::StorageFormat::LINEAR) {
+            if (!lattice::io::anvil::LinearRegionFile::available()) {
+                throwJavaException(env, "Linear region format requires zstd support");
+                return nullptr;
+            }
+            stats = instance->linearIO_->convertFromAnvil(*instance->anvilIO_, worldId, removeSource == JNI_TRUE);
+        } else if (target == lattice::io::StorageFormat::ANVIL) {
+            stats = instance->linearIO_->convertToAnvil(*instance->anvilIO_, worldId, removeSource == JNI_TRUE);
+        } else {
+            throwJavaException(env, "Conversion is only supported between Anvil and linear regions");
+            return nullptr;
+        }
+        
+        const jlong values[] = {
+            static_cast<jlong>(stats.regions),
+            static_cast<jlong>(stats.chunks),
+            static_cast<jlong>(stats.failedChunks),
+            static_cast<jlong>(stats.failedRegions),
+            static_cast<jlong>(stats.sourceBytes),
+            static_cast<jlong>(stats.targetBytes),
+        };
+        const jsize length = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+        jlongArray result = env->NewLongArray(length);
+        if (result) {
+            env->SetLongArrayRegion(result, 0, length, values);
+        }
+        return result;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return nullptr;
+    }
+}
+
+jint JNICALL ChunkIOBridge::flushLinearRegions(JNIEnv* env, jobject obj) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return 0;
+        }
+        return static_cast<jint>(instance->linearIO_->flush());
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return 0;
+    }
+}
+
+jlongArray JNICALL ChunkIOBridge::buildRegionIndex(JNIEnv* env, jobject obj, jint threads, jboolean trackTimestamps) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return nullptr;
+        }
+        
+        lattice::io::anvil::RegionIndex::Config config;
+        config.threads = threads > 0 ? static_cast<size_t>(threads) : 0;
+        config.trackTimestamps = trackTimestamps == JNI_TRUE;
+        const auto stats = instance->anvilIO_->buildRegionIndex(config);
+        
+        const jlong values[] = {
+            static_cast<jlong>(stats.regionsScanned),
+            static_cast<jlong>(stats.chunksIndexed),
+            static_cast<jlong>(stats.failedRegions),
+            static_cast<jlong>(stats.scanMicros),
+            static_cast<jlong>(stats.threads),
+            static_cast<jlong>(stats.memoryBytes),
+        };
+        const jsize length = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+        jlongArray result = env->NewLongArray(length);
+        if (result) {
+            env->SetLongArrayRegion(result, 0, length, values);
+        }
+        return result;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return nullptr;
+    }
+}
+
+jboolean JNICALL ChunkIOBridge::chunkExists(JNIEnv* env, jobject obj, jint worldId, jint chunkX, jint chunkZ) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return JNI_FALSE;
+        }
+        return instance->anvilIO_->chunkExists(worldId, chunkX, chunkZ) ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
+jlongArray JNICALL ChunkIOBridge::chunksSavedBefore(JNIEnv* env, jobject obj, jint worldId, jint cutoff) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return nullptr;
+        }
+        
+        const auto chunks = instance->anvilIO_->getRegionIndex().chunksSavedBefore(
+            worldId, static_cast<uint32_t>(cutoff));
+        std::vector<jlong> packed;
+        packed.reserve(chunks.size());
+        for (const auto& [chunkX, chunkZ] : chunks) {
+            packed.push_back(static_cast<jlong>((static_cast<uint64_t>(static_cast<uint32_t>(chunkZ)) << 32) |
+                                                static_cast<uint32_t>(chunkX)));
+        }
+        const jsize length = static_cast<jsize>(packed.size());
+        jlongArray result = env->NewLongArray(length);
+        if (result && length > 0) {
+            env->SetLongArrayRegion(result, 0, length, packed.data());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return nullptr;
+    }
+}
+
 jboolean JNICALL ChunkIOBridge::isAnvilFormat(JNIEnv* env, jobject obj, jint worldId) {
     try {
         auto instance = getInstance();
@@ -262,7 +512,26 @@ jbyteArray JNICALL ChunkIOBridge::getChunkDataForJava(JNIEnv* env, jobject obj,
         
         auto format = instance->asyncIO_->getStorageFormat();
         if (format == lattice::io::StorageFormat::ANVIL) {
-            return createJavaByteArray(env, instance->anvilIO_->getChunkDataForJava(worldId, chunkX, chunkZ));
+            auto data = instance->anvilIO_->getChunkDataForJava(worldId, chunkX, chunkZ);
+            
+            // 拷贝到Java数组的耗时计入JNI_HANDOFF阶段
+            auto handoffStart = std::chrono::steady_clock::now();
+            jbyteArray array = createJavaByteArray(env, data);
+            lattice::io::IOMetrics::recordStage(lattice::io::IOStage::JNI_HANDOFF,
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - handoffStart).count());
+            return array;
+        } else if (format == lattice::io::StorageFormat::LINEAR) {
+            // 与Anvil相同的NONE类型记录
+            auto nbt = instance->linearIO_->loadChunk(worldId, chunkX, chunkZ);
+            if (!nbt) {
+                return nullptr;
+            }
+            std::vector<uint8_t> data;
+            data.reserve(nbt->size() + 1);
+            data.push_back(static_cast<uint8_t>(lattice::io::anvil::MinecraftCompressor::CompressionType::NONE));
+            data.insert(data.end(), nbt->begin(), nbt->end());
+            return createJavaByteArray(env, data);
         } else {
             auto data = instance->asyncIO_->getChunkData(worldId, chunkX, chunkZ);
             return createJavaByteArray(env, std::vector<uint8_t>(data.begin(), data.end()));
@@ -273,6 +542,122 @@ jbyteArray JNICALL ChunkIOBridge::getChunkDataForJava(JNIEnv* env, jobject obj,
     }
 }
 
+jobject JNICALL ChunkIOBridge::getChunkDataDirect(JNIEnv* env, jobject obj,
+                                                  jint worldId, jint chunkX, jint chunkZ) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return nullptr;
+        }
+        if (instance->asyncIO_->getStorageFormat() != lattice::io::StorageFormat::ANVIL) {
+            throwJavaException(env, "Direct chunk buffers require Anvil storage format");
+            return nullptr;
+        }
+        
+        // 从热缓存负载一次拷入池化缓冲区，不经过中间vector和jbyteArray
+        auto* memoryManager = OptimizedJNIUtils::getMemoryManager();
+        jobject buffer = nullptr;
+        std::chrono::steady_clock::time_point handoffStart;
+        size_t written = instance->anvilIO_->copyChunkDataForJava(worldId, chunkX, chunkZ,
+            [&](size_t size) -> uint8_t* {
+                handoffStart = std::chrono::steady_clock::now();
+                buffer = memoryManager->allocateDirectByteBuffer(size, env, "chunk_load");
+                return buffer ? static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer)) : nullptr;
+            });
+        
+        if (written == 0) {
+            if (buffer) {
+                memoryManager->releaseDirectByteBuffer(buffer, env, "chunk_load");
+                env->DeleteLocalRef(buffer);
+            }
+            return nullptr;
+        }
+        
+        lattice::io::IOMetrics::recordStage(lattice::io::IOStage::JNI_HANDOFF,
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - handoffStart).count());
+        return buffer;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return nullptr;
+    }
+}
+
+jboolean JNICALL ChunkIOBridge::releaseChunkBuffer(JNIEnv* env, jobject obj, jobject buffer) {
+    return OptimizedJNIUtils::getMemoryManager()->releaseDirectByteBuffer(buffer, env, "chunk_load")
+        ? JNI_TRUE : JNI_FALSE;
+}
+
+void JNICALL ChunkIOBridge::setPacketStoreEnabled(JNIEnv* env, jobject obj, jboolean enabled) {
+    auto instance = getInstance();
+    if (!instance) {
+        throwJavaException(env, "ChunkIOBridge not initialized");
+        return;
+    }
+    instance->anvilIO_->setPacketStoreEnabled(enabled == JNI_TRUE);
+}
+
+jobject JNICALL ChunkIOBridge::getChunkPacketDirect(JNIEnv* env, jobject obj,
+                                                    jint worldId, jint chunkX, jint chunkZ, jint formatTag) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return nullptr;
+        }
+        if (instance->asyncIO_->getStorageFormat() != lattice::io::StorageFormat::ANVIL) {
+            return nullptr;
+        }
+        
+        // 与getChunkDataDirect共用缓冲区池，Java侧统一用releaseChunkBuffer归还
+        auto* memoryManager = OptimizedJNIUtils::getMemoryManager();
+        jobject buffer = nullptr;
+        size_t written = instance->anvilIO_->copyChunkPacket(worldId, chunkX, chunkZ,
+            static_cast<uint32_t>(formatTag),
+            [&](size_t size) -> uint8_t* {
+                buffer = memoryManager->allocateDirectByteBuffer(size, env, "chunk_load");
+                return buffer ? static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer)) : nullptr;
+            });
+        
+        if (written == 0) {
+            if (buffer) {
+                memoryManager->releaseDirectByteBuffer(buffer, env, "chunk_load");
+                env->DeleteLocalRef(buffer);
+            }
+            return nullptr;
+        }
+        return buffer;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return nullptr;
+    }
+}
+
+jboolean JNICALL ChunkIOBridge::storeChunkPacket(JNIEnv* env, jobject obj, jint worldId, jint chunkX, jint chunkZ,
+                                                 jint formatTag, jobject packet, jint length, jint level) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return JNI_FALSE;
+        }
+        if (packet == nullptr || length <= 0 || env->GetDirectBufferCapacity(packet) < length) {
+            return JNI_FALSE;
+        }
+        auto* data = static_cast<const uint8_t*>(env->GetDirectBufferAddress(packet));
+        if (data == nullptr) {
+            return JNI_FALSE;
+        }
+        return instance->anvilIO_->storeChunkPacket(worldId, chunkX, chunkZ, static_cast<uint32_t>(formatTag),
+                                                    data, static_cast<size_t>(length), level)
+            ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return JNI_FALSE;
+    }
+}
+
 void JNICALL ChunkIOBridge::setChunkDataFromJava(JNIEnv* env, jobject obj,
                                                  jint worldId, jint chunkX, jint chunkZ,
                                                  jbyteArray data) {
@@ -288,6 +673,9 @@ void JNICALL ChunkIOBridge::setChunkDataFromJava(JNIEnv* env, jobject obj,
         
         if (format == lattice::io::StorageFormat::ANVIL) {
             instance->anvilIO_->setChunkDataFromJava(worldId, chunkX, chunkZ, chunkData);
+        } else if (format == lattice::io::StorageFormat::LINEAR) {
+            instance->linearIO_->saveChunk(worldId, chunkX, chunkZ, chunkData,
+                                           static_cast<uint32_t>(std::time(nullptr)));
         } else {
             // 设置传统格式数据
             // 简化实现
@@ -401,37 +789,158 @@ void JNICALL ChunkIOBridge::resetIOStatistics(JNIEnv* env, jobject obj) {
         }
         
         // 重置统计信息
-        // 简化实现
+        lattice::io::IOMetrics::resetStageHistograms();
     } catch (const std::exception& e) {
         throwJavaException(env, e.what());
     }
 }
 
+// ===== 批量加载 =====
+
+jobject JNICALL ChunkIOBridge::createCompletionRing(JNIEnv* env, jobject obj, jint capacityBytes, jint workerCount) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return nullptr;
+        }
+        if (instance->asyncIO_->getStorageFormat() != lattice::io::StorageFormat::ANVIL) {
+            throwJavaException(env, "Batched chunk loads require Anvil storage format");
+            return nullptr;
+        }
+        
+        std::lock_guard<std::mutex> lock(instance->batchMutex_);
+        instance->releaseCompletionRing(env);
+        
+        const size_t dataBytes = capacityBytes > 0 ? static_cast<size_t>(capacityBytes) : DEFAULT_COMPLETION_RING_BYTES;
+        const size_t totalBytes = lattice::io::anvil::ChunkCompletionRing::requiredBytes(dataBytes);
+        auto* memoryManager = OptimizedJNIUtils::getMemoryManager();
+        jobject buffer = memoryManager->allocateDirectByteBuffer(totalBytes, env, "completion_ring");
+        if (!buffer) {
+            throwJavaException(env, "Failed to allocate completion ring");
+            return nullptr;
+        }
+        
+        try {
+            instance->completionRing_ = std::make_unique<lattice::io::anvil::ChunkCompletionRing>(
+                env->GetDirectBufferAddress(buffer), totalBytes);
+            instance->loadBatcher_ = std::make_unique<lattice::io::anvil::ChunkLoadBatcher>(
+                *instance->anvilIO_, *instance->completionRing_,
+                workerCount > 0 ? static_cast<size_t>(workerCount) : 0);
+        } catch (...) {
+            instance->completionRing_.reset();
+            memoryManager->releaseDirectByteBuffer(buffer, env, "completion_ring");
+            throw;
+        }
+        
+        instance->completionRingBuffer_ = env->NewGlobalRef(buffer);
+        return buffer;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return nullptr;
+    }
+}
+
+jint JNICALL ChunkIOBridge::submitChunkLoads(JNIEnv* env, jobject obj, jint worldId,
+                                            jlongArray packedCoords, jlong batchTag) {
+    try {
+        auto instance = getInstance();
+        if (!instance) {
+            throwJavaException(env, "ChunkIOBridge not initialized");
+            return 0;
+        }
+        
+        std::lock_guard<std::mutex> lock(instance->batchMutex_);
+        if (!instance->loadBatcher_) {
+            throwJavaException(env, "Completion ring not created");
+            return 0;
+        }
+        if (!packedCoords) {
+            return 0;
+        }
+        
+        const jsize count = env->GetArrayLength(packedCoords);
+        std::vector<uint64_t> coords(static_cast<size_t>(count));
+        env->GetLongArrayRegion(packedCoords, 0, count, reinterpret_cast<jlong*>(coords.data()));
+        if (auto record = WorkloadRecorder::begin(TraceEvent::CHUNK_LOAD_BATCH)) {
+            record.i32(worldId).u64(coords.size());
+            for (uint64_t packed : coords) {
+                record.u64(packed);
+            }
+        }
+        return static_cast<jint>(instance->loadBatcher_->submit(worldId, coords.data(), coords.size(),
+                                                               static_cast<uint64_t>(batchTag)));
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return 0;
+    }
+}
+
+void JNICALL ChunkIOBridge::destroyCompletionRing(JNIEnv* env, jobject obj) {
+    auto instance = getInstance();
+    if (!instance) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(instance->batchMutex_);
+    instance->releaseCompletionRing(env);
+}
+
+void ChunkIOBridge::releaseCompletionRing(JNIEnv* env) {
+    // 调用者持有batchMutex_；先停加载线程，再释放其写入的内存
+    loadBatcher_.reset();
+    completionRing_.reset();
+    if (completionRingBuffer_) {
+        OptimizedJNIUtils::getMemoryManager()->releaseDirectByteBuffer(completionRingBuffer_, env, "completion_ring");
+        env->DeleteGlobalRef(completionRingBuffer_);
+        completionRingBuffer_ = nullptr;
+    }
+}
+
+jlongArray JNICALL ChunkIOBridge::getStageLatencies(JNIEnv* env, jobject obj) {
+    try {
+        constexpr size_t FIELDS_PER_STAGE = 5;
+        std::vector<jlong> values;
+        values.reserve(lattice::io::IO_STAGE_COUNT * FIELDS_PER_STAGE);
+        
+        for (size_t i = 0; i < lattice::io::IO_STAGE_COUNT; ++i) {
+            auto summary = lattice::io::IOMetrics::summarizeStage(static_cast<lattice::io::IOStage>(i));
+            values.push_back(static_cast<jlong>(summary.count));
+            values.push_back(static_cast<jlong>(summary.p50));
+            values.push_back(static_cast<jlong>(summary.p99));
+            values.push_back(static_cast<jlong>(summary.p999));
+            values.push_back(static_cast<jlong>(summary.max));
+        }
+        
+        jlongArray result = env->NewLongArray(static_cast<jsize>(values.size()));
+        if (result) {
+            env->SetLongArrayRegion(result, 0, static_cast<jsize>(values.size()), values.data());
+        }
+        return result;
+    } catch (const std::exception& e) {
+        throwJavaException(env, e.what());
+        return nullptr;
+    }
+}
+
 // ===== 内存管理方法 =====
 
-bool ChunkIOBridge::initialize(JNIEnv* env) {
-    // 查找Java类和方法ID
-    jclass chunkIOClass = env->FindClass("lattice/io/ChunkIOBridge");
-    if (!chunkIOClass) {
-        return false;
+void JNICALL ChunkIOBridge::nativeInit(JNIEnv* env, jobject obj, jstring worldPath) {
+    if (globalInstance_) {
+        return; // 已经初始化
     }
     
-    chunkIOClass_ = (jclass)env->NewGlobalRef(chunkIOClass);
-    env->DeleteLocalRef(chunkIOClass);
-    
-    if (!chunkIOClass_) {
-        return false;
+    const char* worldPathStr = env->GetStringUTFChars(worldPath, nullptr);
+    if (worldPathStr) {
+        globalInstance_ = std::make_unique<ChunkIOBridge>(worldPathStr);
+        env->ReleaseStringUTFChars(worldPath, worldPathStr);
     }
-    
-    return true;
 }
 
-void ChunkIOBridge::cleanup(JNIEnv* env) {
-    if (chunkIOClass_) {
-        env->DeleteGlobalRef(chunkIOClass_);
-        chunkIOClass_ = nullptr;
+void JNICALL ChunkIOBridge::nativeDestroy(JNIEnv* env, jobject obj) {
+    if (globalInstance_) {
+        std::lock_guard<std::mutex> lock(globalInstance_->batchMutex_);
+        globalInstance_->releaseCompletionRing(env);
     }
-    
     globalInstance_.reset();
 }
 
@@ -481,43 +990,42 @@ void ChunkIOBridge::invokeCallback(JNIEnv* env, jobject callback, bool success,
 
 // ===== JNI本地方法注册 =====
 
+// 在JNI_OnLoad中注册（JniRegistry），不再按Java_lattice_io_ChunkIOBridge_*导出
+static JniNativeTable CHUNK_IO_BRIDGE_NATIVES("lattice/io/ChunkIOBridge", {
+    {(char*)"nativeInit", (char*)"(Ljava/lang/String;)V", (void*)ChunkIOBridge::nativeInit},
+    {(char*)"nativeDestroy", (char*)"()V", (void*)ChunkIOBridge::nativeDestroy},
+    {(char*)"nativeSaveChunkDelta", (char*)"(IIII[I[[B[B[B)I", (void*)ChunkIOBridge::saveChunkDelta},
+    {(char*)"nativeForgetChunkBaseline", (char*)"(III)V", (void*)ChunkIOBridge::forgetChunkBaseline},
+    {(char*)"nativeGetChunkDataDirect", (char*)"(III)Ljava/nio/ByteBuffer;", (void*)ChunkIOBridge::getChunkDataDirect},
+    {(char*)"nativeReleaseChunkBuffer", (char*)"(Ljava/nio/ByteBuffer;)Z", (void*)ChunkIOBridge::releaseChunkBuffer},
+    {(char*)"nativeSetPacketStoreEnabled", (char*)"(Z)V", (void*)ChunkIOBridge::setPacketStoreEnabled},
+    {(char*)"nativeGetChunkPacketDirect", (char*)"(IIII)Ljava/nio/ByteBuffer;", (void*)ChunkIOBridge::getChunkPacketDirect},
+    {(char*)"nativeStoreChunkPacket", (char*)"(IIIILjava/nio/ByteBuffer;II)Z", (void*)ChunkIOBridge::storeChunkPacket},
+    {(char*)"nativeCreateCompletionRing", (char*)"(II)Ljava/nio/ByteBuffer;", (void*)ChunkIOBridge::createCompletionRing},
+    {(char*)"nativeSubmitChunkLoads", (char*)"(I[JJ)I", (void*)ChunkIOBridge::submitChunkLoads},
+    {(char*)"nativeDestroyCompletionRing", (char*)"()V", (void*)ChunkIOBridge::destroyCompletionRing},
+    {(char*)"nativeGetStageLatencies", (char*)"()[J", (void*)ChunkIOBridge::getStageLatencies},
+    {(char*)"nativeConvertStorageFormat", (char*)"(IIZ)[J", (void*)ChunkIOBridge::convertStorageFormat},
+    {(char*)"nativeFlushLinearRegions", (char*)"()I", (void*)ChunkIOBridge::flushLinearRegions},
+    {(char*)"nativeBuildRegionIndex", (char*)"(IZ)[J", (void*)ChunkIOBridge::buildRegionIndex},
+    {(char*)"nativeChunkExists", (char*)"(III)Z", (void*)ChunkIOBridge::chunkExists},
+    {(char*)"nativeChunksSavedBefore", (char*)"(II)[J", (void*)ChunkIOBridge::chunksSavedBefore},
+});
+
 extern "C" {
     
+    // lattice_chunk_io的唯一加载入口：ChunkIOBridge与AsyncChunkIOOptimized的native方法表、
+    // 登记的类都在这里统一处理；两者共用同一个DirectByteBuffer池（OptimizedJNIUtils）
     JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
-        JNIEnv* env;
-        if (vm->GetEnv((void**)&env, JNI_VERSION_21) != JNI_OK) {
-            return JNI_ERR;
-        }
-        
-        // 初始化JNI桥接
-        if (!ChunkIOBridge::initialize(env)) {
-            return JNI_ERR;
-        }
-        
-        return JNI_VERSION_21;
+        return JniRegistry::onLoad(vm);
     }
     
     JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
-        JNIEnv* env;
-        if (vm->GetEnv((void**)&env, JNI_VERSION_21) == JNI_OK) {
-            ChunkIOBridge::cleanup(env);
+        JNIEnv* env = nullptr;
+        if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_8) == JNI_OK) {
+            ChunkIOBridge::nativeDestroy(env, nullptr);
         }
-    }
-    
-    JNIEXPORT void JNICALL Java_lattice_io_ChunkIOBridge_nativeInit(JNIEnv* env, jobject obj, jstring worldPath) {
-        if (globalInstance_) {
-            return; // 已经初始化
-        }
-        
-        const char* worldPathStr = env->GetStringUTFChars(worldPath, nullptr);
-        if (worldPathStr) {
-            globalInstance_ = std::make_unique<ChunkIOBridge>(worldPathStr);
-            env->ReleaseStringUTFChars(worldPath, worldPathStr);
-        }
-    }
-    
-    JNIEXPORT void JNICALL Java_lattice_io_ChunkIOBridge_nativeDestroy(JNIEnv* env, jobject obj) {
-        globalInstance_.reset();
+        JniRegistry::onUnload(vm);
     }
     
 }
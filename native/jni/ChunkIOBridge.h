@@ -4,8 +4,12 @@
 #include <memory>
 #include <string>
 #include <functional>
+#include <mutex>
 #include "../core/io/anvil_format.hpp"
 #include "../core/io/async_chunk_io.hpp"
+#include "../core/io/chunk_completion_ring.hpp"
+#include "../core/io/chunk_load_batcher.hpp"
+#include "../core/io/linear_region_file.hpp"
 
 namespace lattice {
 namespace jni {
@@ -33,7 +37,41 @@ public:
     static void JNICALL saveChunksBatch(JNIEnv* env, jobject obj,
                                        jobjectArray chunkArray);
     
-    // 设置存储格式（LEGACY或ANVIL）
+    /**
+     * 增量保存（仅Anvil格式），见AnvilChunkIO::saveChunkDelta
+     * dirtySectionIndices与dirtySections（byte[]，段复合标签负载）一一对应；
+     * header / blockEntities为null表示自上次保存以来未变。
+     * 返回0 = 已写入，1 = 内容未变已跳过，2 = 缺少基线，需要提交包含全部段的完整增量
+     */
+    static jint JNICALL saveChunkDelta(JNIEnv* env, jobject obj,
+                                      jint worldId, jint chunkX, jint chunkZ, jint sectionCount,
+                                      jintArray dirtySectionIndices, jobjectArray dirtySections,
+                                      jbyteArray header, jbyteArray blockEntities);
+    
+    // 区块卸载时释放其增量基线
+    static void JNICALL forgetChunkBaseline(JNIEnv* env, jobject obj,
+                                           jint worldId, jint chunkX, jint chunkZ);
+    
+    // ===== 批量加载（完成环形缓冲区） =====
+    
+    /**
+     * 创建完成环形缓冲区并启动加载线程（仅Anvil格式），返回共享的DirectByteBuffer
+     * 布局见ChunkCompletionRing；capacityBytes为数据区大小（<= 0使用默认值），workerCount为0时自动选择
+     * 已存在时先销毁旧的环形缓冲区，其中未消费的完成记录丢失
+     */
+    static jobject JNICALL createCompletionRing(JNIEnv* env, jobject obj, jint capacityBytes, jint workerCount);
+    
+    /**
+     * 一次JNI调用提交一批加载，packedCoords元素为 ((long) x << 32) | (z & 0xFFFFFFFFL)
+     * 每个区块在环形缓冲区中产生一条tag为batchTag的完成记录；返回入队数量
+     */
+    static jint JNICALL submitChunkLoads(JNIEnv* env, jobject obj, jint worldId,
+                                        jlongArray packedCoords, jlong batchTag);
+    
+    // 停止加载线程并归还环形缓冲区，之后Java不得再访问该缓冲区
+    static void JNICALL destroyCompletionRing(JNIEnv* env, jobject obj);
+    
+    // 设置存储格式（LEGACY、ANVIL或LINEAR）；当前构建不支持LINEAR（没有zstd）时抛出异常
     static void JNICALL setStorageFormat(JNIEnv* env, jobject obj, jint format);
     
     // 获取存储格式
@@ -42,9 +80,31 @@ public:
     // 切换到Anvil格式（1.21.10兼容）
     static void JNICALL enableAnvilFormat(JNIEnv* env, jobject obj, jboolean enable);
     
-    // 转换为Anvil格式
+    // 转换为Anvil格式（当前为LINEAR时转换region文件并切换格式，保留.linear）
     static jboolean JNICALL convertToAnvilFormat(JNIEnv* env, jobject obj, jint worldId);
     
+    /**
+     * Anvil与LINEAR之间迁移worldId维度的全部region（见LinearChunkIO::convertFromAnvil / convertToAnvil），
+     * 不改变当前存储格式。返回{regions, chunks, failedChunks, failedRegions, sourceBytes, targetBytes}
+     */
+    static jlongArray JNICALL convertStorageFormat(JNIEnv* env, jobject obj, jint worldId,
+                                                  jint targetFormat, jboolean removeSource);
+    
+    // 写出LINEAR格式所有修改过的region（自动保存/关服时调用），返回写出的region数
+    static jint JNICALL flushLinearRegions(JNIEnv* env, jobject obj);
+    
+    /**
+     * 并行读取所有Anvil region头部，建立区块存在与时间戳索引（AnvilChunkIO::buildRegionIndex），世界加载时调用
+     * threads为0时自动选择。返回{regionsScanned, chunksIndexed, failedRegions, scanMicros, threads, memoryBytes}
+     */
+    static jlongArray JNICALL buildRegionIndex(JNIEnv* env, jobject obj, jint threads, jboolean trackTimestamps);
+    
+    // 区块是否已保存（Anvil格式）；已建立索引时不读盘
+    static jboolean JNICALL chunkExists(JNIEnv* env, jobject obj, jint worldId, jint chunkX, jint chunkZ);
+    
+    // 保存时间戳（秒）早于cutoff的区块，元素为ChunkPos.asLong()（x在低32位）；需要先建立索引
+    static jlongArray JNICALL chunksSavedBefore(JNIEnv* env, jobject obj, jint worldId, jint cutoff);
+    
     // 检查是否为Anvil格式
     static jboolean JNICALL isAnvilFormat(JNIEnv* env, jobject obj, jint worldId);
     
@@ -57,6 +117,31 @@ public:
     static jbyteArray JNICALL getChunkDataForJava(JNIEnv* env, jobject obj,
                                                   jint worldId, jint chunkX, jint chunkZ);
     
+    /**
+     * 零拷贝加载（仅Anvil格式）：返回池化原生缓冲区上的DirectByteBuffer，
+     * 内容与getChunkDataForJava相同；区块不存在时返回null
+     * Java用完后必须调用releaseChunkBuffer归还，之后不得再访问该缓冲区
+     */
+    static jobject JNICALL getChunkDataDirect(JNIEnv* env, jobject obj,
+                                              jint worldId, jint chunkX, jint chunkZ);
+    
+    // 归还getChunkDataDirect返回的缓冲区；重复释放或未知缓冲区返回false
+    static jboolean JNICALL releaseChunkBuffer(JNIEnv* env, jobject obj, jobject buffer);
+    
+    // 预压缩区块数据包的旁路文件（仅Anvil格式，见AnvilChunkIO::setPacketStoreEnabled）
+    static void JNICALL setPacketStoreEnabled(JNIEnv* env, jobject obj, jboolean enabled);
+    
+    /**
+     * 取出区块的预压缩帧：返回池化原生缓冲区上的DirectByteBuffer（同getChunkDataDirect，
+     * 用完后调用releaseChunkBuffer归还）；没有有效记录时返回null，由Java编码后调用storeChunkPacket
+     */
+    static jobject JNICALL getChunkPacketDirect(JNIEnv* env, jobject obj,
+                                                jint worldId, jint chunkX, jint chunkZ, jint formatTag);
+    
+    // 压缩packet（DirectByteBuffer的前length字节：包ID + 包体）并存入旁路文件
+    static jboolean JNICALL storeChunkPacket(JNIEnv* env, jobject obj, jint worldId, jint chunkX, jint chunkZ,
+                                             jint formatTag, jobject packet, jint length, jint level);
+    
     // 设置来自Java的区块数据
     static void JNICALL setChunkDataFromJava(JNIEnv* env, jobject obj,
                                             jint worldId, jint chunkX, jint chunkZ,
@@ -87,13 +172,19 @@ public:
     // 重置统计信息
     static void JNICALL resetIOStatistics(JNIEnv* env, jobject obj);
     
+    /**
+     * 分阶段延迟（微秒）：按IOStage顺序每阶段5个值
+     * {count, p50, p99, p999, max}，供Java侧指标导出抓取
+     */
+    static jlongArray JNICALL getStageLatencies(JNIEnv* env, jobject obj);
+    
     // ===== 内存管理 =====
     
-    // 初始化JNI桥接
-    static bool initialize(JNIEnv* env);
+    // 创建全局实例（已存在时不做任何事）
+    static void JNICALL nativeInit(JNIEnv* env, jobject obj, jstring worldPath);
     
-    // 清理JNI桥接
-    static void cleanup(JNIEnv* env);
+    // 停止批量加载并销毁全局实例；库卸载时也会调用
+    static void JNICALL nativeDestroy(JNIEnv* env, jobject obj);
     
     // 获取全局实例
     static ChunkIOBridge* getInstance();
@@ -102,12 +193,16 @@ private:
     std::string worldPath_;
     std::unique_ptr<lattice::io::AsyncChunkIO> asyncIO_;
     std::unique_ptr<lattice::io::anvil::AnvilChunkIO> anvilIO_;
+    std::unique_ptr<lattice::io::anvil::LinearChunkIO> linearIO_;
     
-    // Java方法ID缓存
-    static jclass chunkIOClass_;
-    static jmethodID callbackMethod_;
-    static jclass resultClass_;
-    static jmethodID resultConstructor_;
+    // 批量加载：加载线程先于环形缓冲区销毁
+    static constexpr size_t DEFAULT_COMPLETION_RING_BYTES = 4 * 1024 * 1024;
+    jobject completionRingBuffer_ = nullptr;    // 全局引用
+    std::unique_ptr<lattice::io::anvil::ChunkCompletionRing> completionRing_;
+    std::unique_ptr<lattice::io::anvil::ChunkLoadBatcher> loadBatcher_;
+    std::mutex batchMutex_;
+    
+    void releaseCompletionRing(JNIEnv* env);
     
     // 全局实例
     static std::unique_ptr<ChunkIOBridge> globalInstance_;
@@ -119,17 +214,5 @@ private:
     static void invokeCallback(JNIEnv* env, jobject callback, bool success, const std::string& error);
 };
 
-// ===== JNI本地方法注册 =====
-
-extern "C" {
-    // 原生库加载
-    JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved);
-    JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved);
-    
-    // 初始化原生桥接
-    JNIEXPORT void JNICALL Java_lattice_io_ChunkIOBridge_nativeInit(JNIEnv* env, jobject obj, jstring worldPath);
-    JNIEXPORT void JNICALL Java_lattice_io_ChunkIOBridge_nativeDestroy(JNIEnv* env, jobject obj);
-}
-
 } // namespace jni
 } // namespace lattice
\ No newline at end of file
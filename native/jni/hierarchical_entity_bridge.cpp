@@ -1,6 +1,12 @@
 #include "hierarchical_tracker.hpp"
+#include "sharded_tracker.hpp"
 #include "jni.h"
 #include "jni_helper.hpp"
+#include "lattice_ffi.h"
+#include "../core/workload_trace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <vector>
 #include <memory>
 #include <atomic>
@@ -10,6 +16,9 @@ namespace lattice {
 namespace entity {
 namespace jni {
 
+using lattice::core::TraceEvent;
+using lattice::core::WorkloadRecorder;
+
 // ===== 全局状态管理 =====
 struct GlobalState {
     std::atomic<bool> nativeEnabled{true};
@@ -104,6 +113,7 @@ JNIEXPORT void JNICALL
 Java_net_lattice_entity_HierarchicalEntityTracker_nativeShutdown(JNIEnv* env, jclass clazz) {
     try {
         JNIHierarchicalTracker::shutdown();
+        WorldTrackerRegistry::destroyAll();
         JNIHelper::logInfo("Hierarchical Entity Tracker shutdown completed");
     } catch (const std::exception& e) {
         JNIHelper::logError("Error during Hierarchical Entity Tracker shutdown: %s", e.what());
@@ -181,8 +191,7 @@ Java_net_lattice_entity_HierarchicalEntityTracker_nativeUnregisterEntity(JNIEnv*
     }
     
     try {
-        // 这里需要从HierarchicalTracker添加unregister方法
-        // 暂时跳过实现
+        JNIHierarchicalTracker::unregisterEntity(entityId);
         g_state.recordCall(true);
     } catch (const std::exception& e) {
         JNIHelper::logError("Failed to unregister entity %d: %s", entityId, e.what());
@@ -243,6 +252,105 @@ Java_net_lattice_entity_HierarchicalEntityTracker_nativeGetVisibleEntities(JNIEn
     }
 }
 
+/**
+ * 可见性增量：返回 [enteredCount, entered..., left...]
+ * 邻域没有变化时返回只含一个0的数组，Java可以跳过这个观察者的追踪更新
+ */
+JNIEXPORT jintArray JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeUpdateViewerVisibility(JNIEnv* env, jclass clazz,
+                                                                                jint viewerId, jfloat viewerX, jfloat viewerY, jfloat viewerZ,
+                                                                                jfloat viewDistance) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+    
+    try {
+        VisibilityDelta delta = JNIHierarchicalTracker::updateViewerVisibility(viewerId, viewerX, viewerY,
+                                                                              viewerZ, viewDistance);
+        const jsize enteredCount = static_cast<jsize>(delta.entered.size());
+        const jsize leftCount = static_cast<jsize>(delta.left.size());
+        jintArray array = env->NewIntArray(1 + enteredCount + leftCount);
+        if (!array) {
+            g_state.recordCall(false);
+            return nullptr;
+        }
+        env->SetIntArrayRegion(array, 0, 1, &enteredCount);
+        if (enteredCount > 0) {
+            env->SetIntArrayRegion(array, 1, enteredCount, delta.entered.data());
+        }
+        if (leftCount > 0) {
+            env->SetIntArrayRegion(array, 1 + enteredCount, leftCount, delta.left.data());
+        }
+        g_state.recordCall(true);
+        return array;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to update visibility for viewer %d: %s", viewerId, e.what());
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    } catch (...) {
+        JNIHelper::logError("Unknown error updating visibility for viewer %d", viewerId);
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+}
+
+/**
+ * 本tick需要发给观察者的位置更新：返回 [entityId, lod, entityId, lod, ...]
+ * 实体按LOD降频并经过航位推算过滤，未列出的实体本tick不需要发送
+ */
+JNIEXPORT jintArray JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeCollectSyncUpdates(JNIEnv* env, jclass clazz,
+                                                                            jint viewerId, jfloat viewerX, jfloat viewerY, jfloat viewerZ) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+    
+    try {
+        auto updates = JNIHierarchicalTracker::collectSyncUpdates(viewerId, viewerX, viewerY, viewerZ);
+        std::vector<jint> packed;
+        packed.reserve(updates.size() * 2);
+        for (const auto& update : updates) {
+            packed.push_back(update.entityId);
+            packed.push_back(static_cast<jint>(update.lod));
+        }
+        jintArray array = env->NewIntArray(static_cast<jsize>(packed.size()));
+        if (array && !packed.empty()) {
+            env->SetIntArrayRegion(array, 0, static_cast<jsize>(packed.size()), packed.data());
+        }
+        g_state.recordCall(true);
+        return array;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to collect sync updates for viewer %d: %s", viewerId, e.what());
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    } catch (...) {
+        JNIHelper::logError("Unknown error collecting sync updates for viewer %d", viewerId);
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeRemoveViewer(JNIEnv* env, jclass clazz, jint viewerId) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return;
+    }
+    
+    try {
+        JNIHierarchicalTracker::removeViewer(viewerId);
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to remove viewer %d: %s", viewerId, e.what());
+        g_state.recordCall(false);
+    } catch (...) {
+        JNIHelper::logError("Unknown error removing viewer %d", viewerId);
+        g_state.recordCall(false);
+    }
+}
+
 // ===== 批量操作 =====
 
 JNIEXPORT void JNICALL
@@ -369,10 +477,10 @@ Java_net_lattice_entity_HierarchicalEntityTracker_nativeGetPerformanceStats(JNIE
         
         char buffer[512];
         snprintf(buffer, sizeof(buffer),
-                "Queries: %lu, Cache hits: %lu, SIMD ops: %lu, Async tasks: %lu, "
+                "Queries: %lu, Cache hits: %lu, SIMD ops: %lu, Async tasks: %lu, Async dropped: %lu, "
                 "Avg query time: %.2f ns, Entities: %lu",
                 stats.totalQueries.load(), stats.cacheHits.load(),
-                stats.simdOperations.load(), stats.asyncTasks.load(),
+                stats.simdOperations.load(), stats.asyncTasks.load(), stats.asyncTasksDropped.load(),
                 stats.averageQueryTimeNs.load(), stats.entitiesProcessed.load());
         
         g_state.recordCall(true);
@@ -462,6 +570,605 @@ Java_net_lattice_entity_HierarchicalEntityTracker_nativeSetFeatureFlags(JNIEnv*
     }
 }
 
+// indexType: 0 = 松散网格（默认），1 = 四叉树
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeSetSpatialIndexType(JNIEnv* env, jclass clazz, jint indexType) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return;
+    }
+    
+    try {
+        auto tracker = HierarchicalTrackerFactory::forThread();
+        if (tracker) {
+            tracker->setSpatialIndexType(indexType == 1 ? SpatialIndexType::QUAD_TREE
+                                                        : SpatialIndexType::LOOSE_GRID);
+        }
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to set spatial index type: %s", e.what());
+        g_state.recordCall(false);
+        throw;
+    } catch (...) {
+        JNIHelper::logError("Unknown error setting spatial index type");
+        g_state.recordCall(false);
+        throw;
+    }
+}
+
+// ===== 视锥/遮挡剔除 =====
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeSetCullingEnabled(JNIEnv* env, jclass clazz, jboolean enabled) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return;
+    }
+    
+    try {
+        auto tracker = HierarchicalTrackerFactory::forThread();
+        if (tracker) {
+            tracker->setCullingEnabled(enabled);
+        }
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to set culling: %s", e.what());
+        g_state.recordCall(false);
+    }
+}
+
+// 玩家转动视角时调用（yaw/pitch为Minecraft约定的角度）
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeSetViewerOrientation(JNIEnv* env, jclass clazz,
+                                                                              jint viewerId, jfloat yaw, jfloat pitch) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return;
+    }
+    
+    try {
+        JNIHierarchicalTracker::setViewerOrientation(viewerId, yaw, pitch);
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to set orientation for viewer %d: %s", viewerId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+// 区块加载或方块变化后更新该区块列的不透明区块段掩码（mask为0表示没有完全不透明的段）
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeSetOpaqueSections(JNIEnv* env, jclass clazz,
+                                                                           jint chunkX, jint chunkZ,
+                                                                           jint minSectionY, jlong mask) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return;
+    }
+    
+    try {
+        JNIHierarchicalTracker::setOpaqueSections(chunkX, chunkZ, minSectionY, static_cast<uint64_t>(mask));
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to set opaque sections for chunk (%d, %d): %s", chunkX, chunkZ, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+// ===== 多世界分片追踪 =====
+// 每个世界（worldId由Java分配）一个ShardedWorldTracker，不同世界、同一世界的不同分片互不争用锁。
+// 区域线程用nativeWorldTickShard推进自己的分片；单线程服务器可以用nativeWorldTick推进全部分片。
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeCreateWorld(JNIEnv* env, jclass clazz, jint worldId,
+                                                                     jint shardSizeChunks, jint worldHeight) {
+    try {
+        ShardedWorldTracker::Config config;
+        if (shardSizeChunks > 0) {
+            config.shardSizeChunks = shardSizeChunks;
+        }
+        if (worldHeight > 0) {
+            config.worldHeight = worldHeight;
+        }
+        if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_WORLD_CREATE)) {
+            record.i32(worldId).i32(config.shardSizeChunks).i32(config.worldHeight);
+        }
+        WorldTrackerRegistry::create(worldId, config);
+        JNIHelper::logInfo("World %d tracker created (shard size %d chunks)", worldId, config.shardSizeChunks);
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to create tracker for world %d: %s", worldId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeDestroyWorld(JNIEnv* env, jclass clazz, jint worldId) {
+    try {
+        if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_WORLD_DESTROY)) {
+            record.i32(worldId);
+        }
+        WorldTrackerRegistry::destroy(worldId);
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to destroy tracker for world %d: %s", worldId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldRegisterEntity(JNIEnv* env, jclass clazz, jint worldId,
+                                                                             jint entityId, jfloat x, jfloat y, jfloat z,
+                                                                             jfloat radius, jint entityType) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (world) {
+            if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_ADD)) {
+                record.i32(worldId).i32(entityId).f32(x).f32(y).f32(z).f32(radius).i32(entityType);
+            }
+            world->registerEntity(entityId, x, y, z, radius, static_cast<EntityType>(entityType));
+        }
+        g_state.recordCall(world != nullptr);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to register entity %d in world %d: %s", entityId, worldId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldUpdateEntityPosition(JNIEnv* env, jclass clazz, jint worldId,
+                                                                                   jint entityId, jfloat x, jfloat y, jfloat z) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (world) {
+            if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_MOVE)) {
+                record.i32(worldId).i32(entityId).f32(x).f32(y).f32(z);
+            }
+            world->updateEntityPosition(entityId, x, y, z);
+        }
+        g_state.recordCall(world != nullptr);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to update entity %d in world %d: %s", entityId, worldId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldUnregisterEntity(JNIEnv* env, jclass clazz, jint worldId,
+                                                                               jint entityId) {
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (world) {
+            if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_REMOVE)) {
+                record.i32(worldId).i32(entityId);
+            }
+            world->unregisterEntity(entityId);
+        }
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to unregister entity %d in world %d: %s", entityId, worldId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+JNIEXPORT jintArray JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldGetVisibleEntities(JNIEnv* env, jclass clazz, jint worldId,
+                                                                                 jint viewerId, jfloat viewerX, jfloat viewerY, jfloat viewerZ,
+                                                                                 jfloat viewDistance) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return env->NewIntArray(0);
+        }
+        if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_VIEW_QUERY)) {
+            record.i32(worldId).i32(viewerId).f32(viewerX).f32(viewerY).f32(viewerZ).f32(viewDistance);
+        }
+        std::vector<int> visible = world->getVisibleEntities(viewerId, viewerX, viewerY, viewerZ, viewDistance);
+        const jsize count = static_cast<jsize>(visible.size());
+        jintArray array = env->NewIntArray(count);
+        if (array && count > 0) {
+            env->SetIntArrayRegion(array, 0, count, visible.data());
+        }
+        g_state.recordCall(array != nullptr);
+        return array;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to query world %d for viewer %d: %s", worldId, viewerId, e.what());
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+}
+
+// 与nativeUpdateViewerVisibility相同：返回 [enteredCount, entered..., left...]
+JNIEXPORT jintArray JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldUpdateViewerVisibility(JNIEnv* env, jclass clazz, jint worldId,
+                                                                                     jint viewerId, jfloat viewerX, jfloat viewerY, jfloat viewerZ,
+                                                                                     jfloat viewDistance) {
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return env->NewIntArray(0);
+        }
+        if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_VIEW_UPDATE)) {
+            record.i32(worldId).i32(viewerId).f32(viewerX).f32(viewerY).f32(viewerZ).f32(viewDistance);
+        }
+        VisibilityDelta delta = world->updateViewerVisibility(viewerId, viewerX, viewerY, viewerZ, viewDistance);
+        const jsize enteredCount = static_cast<jsize>(delta.entered.size());
+        const jsize leftCount = static_cast<jsize>(delta.left.size());
+        jintArray array = env->NewIntArray(1 + enteredCount + leftCount);
+        if (!array) {
+            g_state.recordCall(false);
+            return nullptr;
+        }
+        env->SetIntArrayRegion(array, 0, 1, &enteredCount);
+        if (enteredCount > 0) {
+            env->SetIntArrayRegion(array, 1, enteredCount, delta.entered.data());
+        }
+        if (leftCount > 0) {
+            env->SetIntArrayRegion(array, 1 + enteredCount, leftCount, delta.left.data());
+        }
+        g_state.recordCall(true);
+        return array;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to update visibility in world %d for viewer %d: %s", worldId, viewerId, e.what());
+        g_state.recordCall(false);
+        return env->NewIntArray(0);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldRemoveViewer(JNIEnv* env, jclass clazz, jint worldId,
+                                                                           jint viewerId) {
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (world) {
+            if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_VIEWER_REMOVE)) {
+                record.i32(worldId).i32(viewerId);
+            }
+            world->removeViewer(viewerId);
+        }
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to remove viewer %d from world %d: %s", viewerId, worldId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+JNIEXPORT void JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldTick(JNIEnv* env, jclass clazz, jint worldId) {
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (world) {
+            if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_TICK)) {
+                record.i32(worldId);
+            }
+            world->tick();
+        }
+        g_state.recordCall(true);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to tick world %d: %s", worldId, e.what());
+        g_state.recordCall(false);
+    }
+}
+
+// 区域线程推进自己的分片；分片不存在（区域内没有实体）时返回false
+JNIEXPORT jboolean JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldTickShard(JNIEnv* env, jclass clazz, jint worldId,
+                                                                        jint shardX, jint shardZ) {
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (world) {
+            if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_TICK_SHARD)) {
+                record.i32(worldId).i32(shardX).i32(shardZ);
+            }
+        }
+        const bool ticked = world && world->tickShard(shardX, shardZ);
+        g_state.recordCall(true);
+        return ticked ? JNI_TRUE : JNI_FALSE;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to tick shard (%d, %d) of world %d: %s", shardX, shardZ, worldId, e.what());
+        g_state.recordCall(false);
+        return JNI_FALSE;
+    }
+}
+
+/**
+ * 配置世界的移动数据包编码：packetIds依次为
+ * [moveEntityPos, moveEntityPosRot, moveEntityRot, rotateHead, teleportEntity, bundleDelimiter]
+ * （Java按当前协议的包注册表取得；bundleDelimiter < 0表示不使用bundle）
+ */
+JNIEXPORT jboolean JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldConfigureMoveEncoder(JNIEnv* env, jclass clazz, jint worldId,
+                                                                                   jintArray packetIds, jint compressionLevel) {
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world || !packetIds || env->GetArrayLength(packetIds) != 6) {
+            g_state.recordCall(false);
+            return JNI_FALSE;
+        }
+        jint ids[6];
+        env->GetIntArrayRegion(packetIds, 0, 6, ids);
+        net::EntityMoveEncoder::Config config;
+        config.moveEntityPosId = ids[0];
+        config.moveEntityPosRotId = ids[1];
+        config.moveEntityRotId = ids[2];
+        config.rotateHeadId = ids[3];
+        config.teleportEntityId = ids[4];
+        config.bundleDelimiterId = ids[5];
+        config.compressionLevel = compressionLevel;
+        world->setMoveEncoderConfig(config);
+        g_state.recordCall(true);
+        return JNI_TRUE;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to configure move encoder for world %d: %s", worldId, e.what());
+        g_state.recordCall(false);
+        return JNI_FALSE;
+    }
+}
+
+/**
+ * 配置世界的碰撞粗检测：margin为包围盒各方向的扩展距离，maxPairs为单次结果的对数上限
+ * 每tick通过lattice_tracker_submit_broadphase提交，lattice_tracker_broadphase_pairs取回候选对
+ */
+JNIEXPORT jboolean JNICALL
+Java_net_lattice_entity_HierarchicalEntityTracker_nativeWorldConfigureBroadphase(JNIEnv* env, jclass clazz, jint worldId,
+                                                                                 jfloat margin, jint maxPairs) {
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world || maxPairs <= 0 || !std::isfinite(margin) || margin < 0.0f) {
+            g_state.recordCall(false);
+            return JNI_FALSE;
+        }
+        CollisionBroadphase::Config config;
+        config.margin = margin;
+        config.maxPairs = static_cast<size_t>(maxPairs);
+        world->setCollisionConfig(config);
+        g_state.recordCall(true);
+        return JNI_TRUE;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to configure broadphase for world %d: %s", worldId, e.what());
+        g_state.recordCall(false);
+        return JNI_FALSE;
+    }
+}
+
+// ===== C ABI（lattice_ffi.h）：每tick的批量更新与查询，与上面的多世界接口共用ShardedWorldTracker =====
+
+LATTICE_FFI_EXPORT int32_t lattice_tracker_update_positions(int32_t worldId, const int32_t* entityIds,
+                                                            const float* positions, int32_t count) {
+    if (!entityIds || !positions || count < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return 0;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return LATTICE_FFI_INVALID_ARGUMENT;
+        }
+        if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_MOVE_BATCH)) {
+            record.i32(worldId).u64(static_cast<uint64_t>(count));
+            for (int32_t i = 0; i < count; i++) {
+                record.i32(entityIds[i]).f32(positions[i * 3]).f32(positions[i * 3 + 1]).f32(positions[i * 3 + 2]);
+            }
+        }
+        for (int32_t i = 0; i < count; i++) {
+            world->updateEntityPosition(entityIds[i], positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+        }
+        g_state.recordCall(true);
+        return count;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to batch update %d entities in world %d: %s", count, worldId, e.what());
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    } catch (...) {
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_tracker_query_visible(int32_t worldId, int32_t viewerId,
+                                                         float viewerX, float viewerY, float viewerZ,
+                                                         float viewDistance, int32_t* out, int32_t capacity) {
+    if ((!out && capacity > 0) || capacity < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return 0;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return LATTICE_FFI_INVALID_ARGUMENT;
+        }
+        if (auto record = WorkloadRecorder::begin(TraceEvent::ENTITY_VIEW_QUERY)) {
+            record.i32(worldId).i32(viewerId).f32(viewerX).f32(viewerY).f32(viewerZ).f32(viewDistance);
+        }
+        std::vector<int> visible = world->getVisibleEntities(viewerId, viewerX, viewerY, viewerZ, viewDistance);
+        const size_t copied = std::min(visible.size(), static_cast<size_t>(capacity));
+        std::copy_n(visible.begin(), copied, out);
+        g_state.recordCall(true);
+        return static_cast<int32_t>(visible.size());
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to query world %d for viewer %d: %s", worldId, viewerId, e.what());
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    } catch (...) {
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_tracker_update_rotations(int32_t worldId, const int32_t* entityIds,
+                                                            const float* rotations, const uint8_t* onGround,
+                                                            int32_t count) {
+    if (!entityIds || !rotations || !onGround || count < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return 0;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return LATTICE_FFI_INVALID_ARGUMENT;
+        }
+        for (int32_t i = 0; i < count; i++) {
+            world->updateEntityRotation(entityIds[i], rotations[i * 3], rotations[i * 3 + 1],
+                                        rotations[i * 3 + 2], onGround[i] != 0);
+        }
+        g_state.recordCall(true);
+        return count;
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to batch update rotations of %d entities in world %d: %s", count, worldId, e.what());
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    } catch (...) {
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+LATTICE_FFI_EXPORT int64_t lattice_tracker_encode_moves(int32_t worldId, int32_t viewerId,
+                                                        float viewerX, float viewerY, float viewerZ,
+                                                        int32_t compressionThreshold, uint8_t* out,
+                                                        int64_t capacity) {
+    if ((!out && capacity > 0) || capacity < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return 0;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return LATTICE_FFI_INVALID_ARGUMENT;
+        }
+        // 网络线程复用同一块缓冲区，稳定后不再分配
+        thread_local std::vector<uint8_t> encoded;
+        encoded.clear();
+        world->encodeSyncUpdates(viewerId, viewerX, viewerY, viewerZ, compressionThreshold,
+                                 static_cast<size_t>(capacity), encoded);
+        if (!encoded.empty()) {
+            std::memcpy(out, encoded.data(), encoded.size());
+        }
+        g_state.recordCall(true);
+        return static_cast<int64_t>(encoded.size());
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to encode moves in world %d for viewer %d: %s", worldId, viewerId, e.what());
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    } catch (...) {
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_tracker_submit_broadphase(int32_t worldId, int64_t tick) {
+    if (tick < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return 0;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return LATTICE_FFI_INVALID_ARGUMENT;
+        }
+        const size_t submitted = world->submitCollisionBroadphase(static_cast<uint64_t>(tick));
+        g_state.recordCall(true);
+        return static_cast<int32_t>(submitted);
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to submit broadphase for world %d: %s", worldId, e.what());
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    } catch (...) {
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+LATTICE_FFI_EXPORT int64_t lattice_tracker_broadphase_pairs(int32_t worldId, int64_t minTick,
+                                                            int32_t timeoutMillis, int32_t* out,
+                                                            int64_t capacity, int64_t* resultTick) {
+    if ((!out && capacity > 0) || capacity < 0 || minTick < 0 || timeoutMillis < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    if (resultTick) {
+        *resultTick = -1;
+    }
+    if (g_state.shouldFallback() || !g_state.nativeEnabled.load()) {
+        g_state.recordCall(false);
+        return 0;
+    }
+    
+    try {
+        auto world = WorldTrackerRegistry::find(worldId);
+        if (!world) {
+            g_state.recordCall(false);
+            return LATTICE_FFI_INVALID_ARGUMENT;
+        }
+        auto result = world->waitCollisionPairs(static_cast<uint64_t>(minTick),
+                                                std::chrono::milliseconds(timeoutMillis));
+        if (!result) {
+            g_state.recordCall(true);
+            return 0;
+        }
+        // 只写完整的对
+        const size_t copied = std::min(result->pairs.size(), static_cast<size_t>(capacity) / 2 * 2);
+        std::copy_n(result->pairs.begin(), copied, out);
+        if (resultTick) {
+            *resultTick = static_cast<int64_t>(result->tick);
+        }
+        g_state.recordCall(true);
+        return static_cast<int64_t>(result->pairCount());
+    } catch (const std::exception& e) {
+        JNIHelper::logError("Failed to read broadphase pairs for world %d: %s", worldId, e.what());
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    } catch (...) {
+        g_state.recordCall(false);
+        return LATTICE_FFI_FAILED;
+    }
+}
+
 // ===== 故障恢复 =====
 
 JNIEXPORT void JNICALL
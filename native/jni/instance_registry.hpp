@@ -0,0 +1,94 @@
+#pragma once
+
+#include <jni.h>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace lattice {
+namespace jni {
+
+// ===== 交给Java持有的native对象句柄 =====
+//
+// 桥接原先各自维护一个 计数器 + unordered_map + mutex，同一种对象在两个翻译单元里各有一份表，
+// 一边创建的实例另一边看不到。这里统一成一个模板：同种对象只定义一个注册表，
+// 句柄从库内唯一的计数器分配，传错桥接的句柄查不到，而不是指向另一个对象。
+
+namespace detail {
+
+inline jlong nextInstanceHandle() {
+    static std::atomic<jlong> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+} // namespace detail
+
+/**
+ * @brief 句柄 -> 实例的线程安全映射
+ *
+ * find返回shared_ptr：调用期间另一个线程销毁同一句柄时，实例在本次调用结束后才析构。
+ * 句柄从1开始，0表示无效（与Java侧的“未创建”约定一致）。
+ */
+template <typename T>
+class InstanceRegistry {
+public:
+    InstanceRegistry() = default;
+    InstanceRegistry(const InstanceRegistry&) = delete;
+    InstanceRegistry& operator=(const InstanceRegistry&) = delete;
+
+    // instance为空时返回0
+    jlong add(std::shared_ptr<T> instance) {
+        if (!instance) {
+            return 0;
+        }
+        const jlong handle = detail::nextInstanceHandle();
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        instances_.emplace(handle, std::move(instance));
+        return handle;
+    }
+
+    std::shared_ptr<T> find(jlong handle) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = instances_.find(handle);
+        return it != instances_.end() ? it->second : nullptr;
+    }
+
+    // 句柄不存在时返回false
+    bool remove(jlong handle) {
+        std::shared_ptr<T> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            auto it = instances_.find(handle);
+            if (it == instances_.end()) {
+                return false;
+            }
+            removed = std::move(it->second);
+            instances_.erase(it);
+        }
+        // 在锁外析构：实例的析构可能要等待自己的工作线程
+        return true;
+    }
+
+    void clear() {
+        std::unordered_map<jlong, std::shared_ptr<T>> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            removed.swap(instances_);
+        }
+    }
+
+    size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return instances_.size();
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<jlong, std::shared_ptr<T>> instances_;
+};
+
+} // namespace jni
+} // namespace lattice
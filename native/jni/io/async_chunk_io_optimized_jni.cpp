@@ -1,4 +1,5 @@
 #include "async_chunk_io_optimized_jni.hpp"
+#include "../jni_registry.hpp"
 #include <chrono>
 #include <vector>
 #include <string>
@@ -10,39 +11,17 @@ namespace lattice {
 namespace jni {
 namespace io {
 
-// JNI方法注册
-static JNINativeMethod gMethods[] = {
-    {(char*)"loadChunkAsync", (char*)"(IIILjava/lang/Object;)Z", 
+// 在所在库的JNI_OnLoad中注册（JniRegistry）
+static JniNativeTable ASYNC_CHUNK_IO_OPTIMIZED_NATIVES("io/lattice/native/AsyncChunkIOOptimized", {
+    {(char*)"loadChunkAsync", (char*)"(IIILjava/lang/Object;)Z",
      (void*)AsyncChunkIOOptimizedBridge::loadChunkAsync},
-    {(char*)"saveChunkAsync", (char*)"(III[BZ)I", 
+    {(char*)"saveChunkAsync", (char*)"(III[BLjava/lang/Object;)Z",
      (void*)AsyncChunkIOOptimizedBridge::saveChunkAsync},
-    {(char*)"saveChunksBatch", (char*)"([I[I[I[[BI)Z", 
+    {(char*)"saveChunksBatch", (char*)"([I[I[I[[BI)Z",
      (void*)AsyncChunkIOOptimizedBridge::saveChunksBatch},
-    {(char*)"getIOStats", (char*)"()Ljava/lang/String;", 
+    {(char*)"getIOStats", (char*)"()Ljava/lang/String;",
      (void*)AsyncChunkIOOptimizedBridge::getIOStats}
-};
-
-// JNI OnLoad注册
-extern "C" JNIEXPORT jint JNICALL 
-JNI_OnLoad(JavaVM* vm, void* reserved) {
-    JNIEnv* env;
-    if (vm->GetEnv((void**)&env, JNI_VERSION_1_8) != JNI_OK) {
-        return JNI_ERR;
-    }
-    
-    jclass cls = env->FindClass("io/lattice/native/AsyncChunkIOOptimized");
-    if (cls == nullptr) {
-        return JNI_ERR;
-    }
-    
-    if (env->RegisterNatives(cls, gMethods, sizeof(gMethods)/sizeof(gMethods[0])) < 0) {
-        env->DeleteLocalRef(cls);
-        return JNI_ERR;
-    }
-    
-    env->DeleteLocalRef(cls);
-    return JNI_VERSION_1_8;
-}
+});
 
 jboolean AsyncChunkIOOptimizedBridge::loadChunkAsync(JNIEnv* env, jclass clazz,
                                                      jint worldId, jint chunkX, jint chunkZ,
@@ -97,23 +76,17 @@ jboolean AsyncChunkIOOptimizedBridge::saveChunkAsync(JNIEnv* env, jclass clazz,
         return JNI_FALSE;
     }
     
-    jbyte* nativeData = env->GetByteArrayElements(chunkData, nullptr);
-    if (nativeData == nullptr) {
-        throwJNIException(env, "java/lang/RuntimeException", "Failed to get byte array elements");
-        return JNI_FALSE;
-    }
-    
     // JNI职责3: 调用core中的优化函数
     try {
         auto& ioManager = lattice::io::AsyncChunkIO::forThread();
         
-        // 构建ChunkData结构
+        // 构建ChunkData结构：直接复制到chunk.data，不经过GetByteArrayElements的中间副本
         lattice::io::ChunkData chunk;
         chunk.worldId = worldId;
         chunk.x = chunkX;
         chunk.z = chunkZ;
-        chunk.data.assign(reinterpret_cast<char*>(nativeData), 
-                         reinterpret_cast<char*>(nativeData) + dataSize);
+        chunk.data.resize(static_cast<size_t>(dataSize));
+        env->GetByteArrayRegion(chunkData, 0, dataSize, reinterpret_cast<jbyte*>(chunk.data.data()));
         
         // 转换Java回调到C++ lambda
         auto cppCallback = [env, callback](const lattice::io::AsyncIOResult& result) {
@@ -126,13 +99,9 @@ jboolean AsyncChunkIOOptimizedBridge::saveChunkAsync(JNIEnv* env, jclass clazz,
         // 调用优化函数（所有优化逻辑在core中）
         ioManager->saveChunkAsync(chunk, std::move(cppCallback));
         
-        // JNI职责2: 清理Java参数
-        env->ReleaseByteArrayElements(chunkData, nativeData, 0);
-        
         return JNI_TRUE;
         
     } catch (const std::exception& e) {
-        env->ReleaseByteArrayElements(chunkData, nativeData, 0);
         throwJNIException(env, "java/lang/RuntimeException", 
                          ("Save chunk failed: " + std::string(e.what())).c_str());
         return JNI_FALSE;
@@ -1,4 +1,5 @@
 #include "nbt_serializer_optimized_jni.hpp"
+#include "../jni_registry.hpp"
 #include <cstdint>
 #include <cstring>
 #include <vector>
@@ -64,7 +65,8 @@ JNI_OnLoad(JavaVM* vm, void* reserved) {
     }
     
     env->DeleteLocalRef(cls);
-    return JNI_VERSION_1_8;
+    // 解析各桥接登记的类与方法ID
+    return lattice::jni::JniRegistry::onLoad(vm);
 }
 
 jbyteArray NBTOptimizedJNIBridge::serializeOptimized(JNIEnv* env, jclass clazz, 
@@ -205,10 +207,10 @@ jbyteArray NBTOptimizedJNIBridge::createJavaByteArray(JNIEnv* env, const void* d
 jbyteArrayArray NBTOptimizedJNIBridge::createJavaByteArrayArray(JNIEnv* env, 
                                                                const std::vector<std::vector<uint8_t>>& data) {
     if (data.empty()) {
-        return env->NewObjectArray(0, env->FindClass("[B"), nullptr);
+        return env->NewObjectArray(0, lattice::jni::BYTE_ARRAY_CLASS.get(), nullptr);
     }
     
-    jbyteArrayArray result = env->NewObjectArray(static_cast<jsize>(data.size()), env->FindClass("[B"), nullptr);
+    jbyteArrayArray result = env->NewObjectArray(static_cast<jsize>(data.size()), lattice::jni::BYTE_ARRAY_CLASS.get(), nullptr);
     if (result == nullptr) {
         return nullptr;
     }
@@ -0,0 +1,72 @@
+#include "palette_codec_jni.hpp"
+#include "../../core/io/palette_codec.hpp"
+
+#include <cstdint>
+#include <span>
+
+namespace {
+
+constexpr jint PALETTE_OK = 0;
+constexpr jint PALETTE_INVALID = -1;
+constexpr jint PALETTE_ARRAY_UNAVAILABLE = -2;
+
+} // namespace
+
+extern "C" {
+
+// 两个数组都以临界区方式访问（通常不复制），期间不调用其他JNI函数
+JNIEXPORT jint JNICALL
+Java_io_lattice_chunk_NativePaletteCodec_nativeUnpack(JNIEnv* env, jclass clazz,
+                                                      jlongArray data, jint bits, jshortArray out, jint count) {
+    if (!data || !out || count < 0 || env->GetArrayLength(out) < count) {
+        return PALETTE_INVALID;
+    }
+    const auto dataLength = static_cast<size_t>(env->GetArrayLength(data));
+
+    auto* words = static_cast<jlong*>(env->GetPrimitiveArrayCritical(data, nullptr));
+    if (!words) {
+        return PALETTE_ARRAY_UNAVAILABLE;
+    }
+    auto* indices = static_cast<jshort*>(env->GetPrimitiveArrayCritical(out, nullptr));
+    if (!indices) {
+        env->ReleasePrimitiveArrayCritical(data, words, JNI_ABORT);
+        return PALETTE_ARRAY_UNAVAILABLE;
+    }
+
+    const bool ok = lattice::io::anvil::unpackPaletteIndices(
+        std::span<const int64_t>(reinterpret_cast<const int64_t*>(words), dataLength), bits,
+        std::span<uint16_t>(reinterpret_cast<uint16_t*>(indices), static_cast<size_t>(count)));
+
+    env->ReleasePrimitiveArrayCritical(out, indices, ok ? 0 : JNI_ABORT);
+    env->ReleasePrimitiveArrayCritical(data, words, JNI_ABORT);
+    return ok ? PALETTE_OK : PALETTE_INVALID;
+}
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_chunk_NativePaletteCodec_nativePack(JNIEnv* env, jclass clazz,
+                                                    jshortArray values, jint count, jint bits, jlongArray data) {
+    if (!values || !data || count < 0 || env->GetArrayLength(values) < count) {
+        return PALETTE_INVALID;
+    }
+    const auto dataLength = static_cast<size_t>(env->GetArrayLength(data));
+
+    auto* indices = static_cast<jshort*>(env->GetPrimitiveArrayCritical(values, nullptr));
+    if (!indices) {
+        return PALETTE_ARRAY_UNAVAILABLE;
+    }
+    auto* words = static_cast<jlong*>(env->GetPrimitiveArrayCritical(data, nullptr));
+    if (!words) {
+        env->ReleasePrimitiveArrayCritical(values, indices, JNI_ABORT);
+        return PALETTE_ARRAY_UNAVAILABLE;
+    }
+
+    const bool ok = lattice::io::anvil::packPaletteIndices(
+        std::span<const uint16_t>(reinterpret_cast<const uint16_t*>(indices), static_cast<size_t>(count)), bits,
+        std::span<int64_t>(reinterpret_cast<int64_t*>(words), dataLength));
+
+    env->ReleasePrimitiveArrayCritical(data, words, ok ? 0 : JNI_ABORT);
+    env->ReleasePrimitiveArrayCritical(values, indices, JNI_ABORT);
+    return ok ? PALETTE_OK : PALETTE_INVALID;
+}
+
+} // extern "C"
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <jni.h>
+
+namespace lattice {
+namespace jni {
+namespace io {
+
+// io.lattice.chunk.NativePaletteCodec的native方法
+// 返回0表示成功，-1表示参数无效（位宽不在1..15、数组长度不够、下标超出位宽），-2表示无法访问Java数组
+extern "C" {
+
+/**
+ * @brief 从block_states / biomes的data（long[]）解出count个调色板下标到out
+ */
+JNIEXPORT jint JNICALL
+Java_io_lattice_chunk_NativePaletteCodec_nativeUnpack(JNIEnv* env, jclass clazz,
+                                                      jlongArray data, jint bits, jshortArray out, jint count);
+
+/**
+ * @brief 把values的前count个调色板下标打包写入data
+ */
+JNIEXPORT jint JNICALL
+Java_io_lattice_chunk_NativePaletteCodec_nativePack(JNIEnv* env, jclass clazz,
+                                                    jshortArray values, jint count, jint bits, jlongArray data);
+
+} // extern "C"
+
+} // namespace io
+} // namespace jni
+} // namespace lattice
@@ -6,6 +6,7 @@
 #include <stdexcept>
 #include <atomic>
 #include <type_traits>
+#include "jni_registry.hpp"
 
 class JniHelper {
 public:
@@ -154,42 +155,13 @@ public:
 namespace lattice {
 namespace jni {
 
+// JavaVM与线程附加统一由JniRegistry管理（JNI_OnLoad中记录）
 class JVM {
-private:
-    static JavaVM* jvm_;
-    static std::atomic<int> refCount_;
-    
 public:
-    static void setJVM(JavaVM* jvm) {
-        jvm_ = jvm;
-        refCount_.fetch_add(1, std::memory_order_relaxed);
-    }
-    
-    static void detachJVM() {
-        if (refCount_.fetch_sub(1, std::memory_order_relaxed) <= 1) {
-            // 最后的引用，清理JVM
-            jvm_ = nullptr;
-        }
-    }
-    
-    static JavaVM* get() { return jvm_; }
-    
-    static JNIEnv* getEnv() {
-        if (!jvm_) return nullptr;
-        
-        JNIEnv* env;
-        int status = jvm_->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_8);
-        
-        if (status == JNI_EDETACHED) {
-            // 线程未附加，需要附加
-            status = jvm_->AttachCurrentThread(reinterpret_cast<void**>(&env), nullptr);
-            if (status == 0) {
-                // 成功附加，可以在这里跟踪.detachLater()需求
-            }
-        }
-        
-        return (status == 0) ? env : nullptr;
-    }
+    static JavaVM* get() { return JniRegistry::vm(); }
+
+    // native线程第一次调用时以守护线程附加，线程退出时自动分离
+    static JNIEnv* getEnv() { return JniRegistry::env(); }
 };
 
 // 初始化宏
@@ -296,19 +268,16 @@ inline void throw_java_exception(JNIEnv* env, const char* className, const char*
 }
 
 // Object creation helpers
+// CacheStats的类与构造函数在JNI_OnLoad中解析
+inline lattice::jni::JniClassRef CACHE_STATS_CLASS("io/lattice/cache/CacheStats", {{"<init>", "(IIIIIII)V"}});
+
 inline jobject create_cache_stats(JNIEnv* env, int totalRequests, int l1Hits, int l2Hits, 
                                  int l3Hits, int misses, int puts, int evictions) {
-    jclass cacheStatsClass = env->FindClass("io/lattice/cache/CacheStats");
-    if (!cacheStatsClass) return nullptr;
-    
-    jmethodID constructor = env->GetMethodID(cacheStatsClass, "<init>", "(IIIIIII)V");
+    jmethodID constructor = CACHE_STATS_CLASS.method(0);
     if (!constructor) return nullptr;
     
-    jobject statsObj = env->NewObject(cacheStatsClass, constructor,
+    return env->NewObject(CACHE_STATS_CLASS.get(), constructor,
         totalRequests, l1Hits, l2Hits, l3Hits, misses, puts, evictions);
-    
-    env->DeleteLocalRef(cacheStatsClass);
-    return statsObj;
 }
 
 } // namespace jni
@@ -0,0 +1,263 @@
+#include "jni_registry.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+namespace lattice {
+namespace jni {
+
+namespace {
+
+struct RegistryState {
+    std::mutex mutex;
+    std::vector<JniClassRef*> classes;
+    std::vector<JniNativeTable*> natives;
+    std::atomic<JavaVM*> vm{nullptr};
+};
+
+// 函数内静态对象：各翻译单元的JniClassRef静态初始化顺序不确定；
+// 不析构，进程退出时仍在运行的native线程分离时还要读vm
+RegistryState& state() {
+    static RegistryState* instance = new RegistryState();
+    return *instance;
+}
+
+// native线程由env()附加后，退出时从JVM分离
+struct ThreadAttachment {
+    JavaVM* vm = nullptr;
+    JNIEnv* env = nullptr;
+
+    ~ThreadAttachment() {
+        // 库已卸载时JavaVM不再可用
+        if (vm && vm == state().vm.load(std::memory_order_acquire)) {
+            vm->DetachCurrentThread();
+        }
+    }
+};
+
+thread_local ThreadAttachment tlsAttachment;
+
+bool clearPendingException(JNIEnv* env) {
+    if (env->ExceptionCheck()) {
+        env->ExceptionClear();
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// ===== JniClassRef =====
+
+JniClassRef::JniClassRef(const char* className,
+                         std::initializer_list<JniMemberSpec> methods,
+                         std::initializer_list<JniMemberSpec> fields)
+    : className_(className), methods_(methods), fields_(fields),
+      methodIds_(methods.size(), nullptr), fieldIds_(fields.size(), nullptr) {
+    JniRegistry::add(this);
+}
+
+bool JniClassRef::resolve(JNIEnv* env) {
+    if (clazz_) {
+        return true;
+    }
+    jclass local = env->FindClass(className_);
+    if (!local || clearPendingException(env)) {
+        fprintf(stderr, "JniRegistry: class %s not found\n", className_);
+        return false;
+    }
+    clazz_ = static_cast<jclass>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+    if (!clazz_) {
+        return false;
+    }
+
+    bool complete = true;
+    for (size_t i = 0; i < methods_.size(); ++i) {
+        const JniMemberSpec& spec = methods_[i];
+        methodIds_[i] = spec.isStatic ? env->GetStaticMethodID(clazz_, spec.name, spec.signature)
+                                      : env->GetMethodID(clazz_, spec.name, spec.signature);
+        if (!methodIds_[i] || clearPendingException(env)) {
+            methodIds_[i] = nullptr;
+            complete = false;
+            fprintf(stderr, "JniRegistry: method %s.%s%s not found\n", className_, spec.name, spec.signature);
+        }
+    }
+    for (size_t i = 0; i < fields_.size(); ++i) {
+        const JniMemberSpec& spec = fields_[i];
+        fieldIds_[i] = spec.isStatic ? env->GetStaticFieldID(clazz_, spec.name, spec.signature)
+                                     : env->GetFieldID(clazz_, spec.name, spec.signature);
+        if (!fieldIds_[i] || clearPendingException(env)) {
+            fieldIds_[i] = nullptr;
+            complete = false;
+            fprintf(stderr, "JniRegistry: field %s.%s (%s) not found\n", className_, spec.name, spec.signature);
+        }
+    }
+    return complete;
+}
+
+void JniClassRef::release(JNIEnv* env) {
+    if (clazz_) {
+        env->DeleteGlobalRef(clazz_);
+        clazz_ = nullptr;
+    }
+    methodIds_.assign(methodIds_.size(), nullptr);
+    fieldIds_.assign(fieldIds_.size(), nullptr);
+}
+
+// ===== JniNativeTable =====
+
+JniNativeTable::JniNativeTable(const char* className, std::initializer_list<JNINativeMethod> methods)
+    : className_(className), methods_(methods) {
+    JniRegistry::add(this);
+}
+
+bool JniNativeTable::registerWith(JNIEnv* env) {
+    if (registered_) {
+        return true;
+    }
+    jclass clazz = env->FindClass(className_);
+    if (!clazz || clearPendingException(env)) {
+        fprintf(stderr, "JniRegistry: class %s not found, %zu natives unbound\n", className_, methods_.size());
+        return false;
+    }
+    // 任一方法签名不匹配时整张表都不会注册（RegisterNatives抛NoSuchMethodError）
+    registered_ = env->RegisterNatives(clazz, methods_.data(), static_cast<jint>(methods_.size())) == JNI_OK &&
+                  !clearPendingException(env);
+    env->DeleteLocalRef(clazz);
+    if (!registered_) {
+        fprintf(stderr, "JniRegistry: RegisterNatives failed for %s\n", className_);
+    }
+    return registered_;
+}
+
+JniClassRef BYTE_ARRAY_CLASS("[B");
+JniClassRef LONG_ARRAY_CLASS("[J");
+
+// ===== JniRegistry =====
+
+void JniRegistry::add(JniClassRef* ref) {
+    RegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.classes.push_back(ref);
+    // 正常情况下都在加载前登记；加载后才构造的只能尽力解析（native线程上可能找不到类）
+    if (registry.vm.load(std::memory_order_acquire)) {
+        if (JNIEnv* jniEnv = env()) {
+            ref->resolve(jniEnv);
+        }
+    }
+}
+
+void JniRegistry::add(JniNativeTable* table) {
+    RegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.natives.push_back(table);
+    if (registry.vm.load(std::memory_order_acquire)) {
+        if (JNIEnv* jniEnv = env()) {
+            table->registerWith(jniEnv);
+        }
+    }
+}
+
+jint JniRegistry::onLoad(JavaVM* vm) {
+    JNIEnv* jniEnv = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&jniEnv), JNI_VERSION_1_8) != JNI_OK) {
+        return JNI_ERR;
+    }
+    RegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.vm.store(vm, std::memory_order_release);
+
+    size_t failed = 0;
+    for (JniClassRef* ref : registry.classes) {
+        if (!ref->resolve(jniEnv)) {
+            ++failed;
+        }
+    }
+    if (failed) {
+        fprintf(stderr, "JniRegistry: %zu of %zu classes incomplete, affected bridges fall back\n",
+                failed, registry.classes.size());
+    }
+
+    size_t unbound = 0;
+    for (JniNativeTable* table : registry.natives) {
+        if (!table->registerWith(jniEnv)) {
+            ++unbound;
+        }
+    }
+    if (unbound) {
+        fprintf(stderr, "JniRegistry: %zu of %zu native tables not registered\n",
+                unbound, registry.natives.size());
+    }
+    return JNI_VERSION_1_8;
+}
+
+void JniRegistry::onUnload(JavaVM* vm) {
+    JNIEnv* jniEnv = nullptr;
+    RegistryState& registry = state();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    if (vm->GetEnv(reinterpret_cast<void**>(&jniEnv), JNI_VERSION_1_8) == JNI_OK) {
+        for (JniClassRef* ref : registry.classes) {
+            ref->release(jniEnv);
+        }
+    }
+    for (JniNativeTable* table : registry.natives) {
+        table->registered_ = false;
+    }
+    registry.vm.store(nullptr, std::memory_order_release);
+}
+
+JavaVM* JniRegistry::vm() {
+    return state().vm.load(std::memory_order_acquire);
+}
+
+JNIEnv* JniRegistry::env() {
+    if (tlsAttachment.env) {
+        return tlsAttachment.env;
+    }
+    JavaVM* jvm = vm();
+    if (!jvm) {
+        return nullptr;
+    }
+    JNIEnv* jniEnv = nullptr;
+    const jint status = jvm->GetEnv(reinterpret_cast<void**>(&jniEnv), JNI_VERSION_1_8);
+    if (status == JNI_OK) {
+        return jniEnv;
+    }
+    if (status != JNI_EDETACHED) {
+        return nullptr;
+    }
+
+    char name[32] = "lattice-native";
+#ifdef __linux__
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+#endif
+    JavaVMAttachArgs args;
+    args.version = JNI_VERSION_1_8;
+    args.name = name;
+    args.group = nullptr;
+    // 守护线程：不阻止JVM退出
+    if (jvm->AttachCurrentThreadAsDaemon(reinterpret_cast<void**>(&jniEnv), &args) != JNI_OK) {
+        return nullptr;
+    }
+    tlsAttachment.vm = jvm;
+    tlsAttachment.env = jniEnv;
+    return jniEnv;
+}
+
+bool JniRegistry::isAttached() {
+    if (tlsAttachment.env) {
+        return true;
+    }
+    JavaVM* jvm = vm();
+    JNIEnv* jniEnv = nullptr;
+    return jvm && jvm->GetEnv(reinterpret_cast<void**>(&jniEnv), JNI_VERSION_1_8) == JNI_OK;
+}
+
+} // namespace jni
+} // namespace lattice
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <jni.h>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+namespace lattice {
+namespace jni {
+
+// ===== JNI类与成员ID的集中缓存 =====
+//
+// 各桥接文件把用到的Java类声明为命名空间作用域的JniClassRef，库加载时（静态初始化）登记到这里，
+// JNI_OnLoad中统一解析为全局引用和方法/字段ID。热路径上直接取用，不再逐次FindClass / GetMethodID。
+// JNI_OnLoad里的FindClass使用加载本库的类加载器，在native线程上调用FindClass找不到服务端的类，
+// 这也是要在加载时解析的原因。
+
+struct JniMemberSpec {
+    const char* name;
+    const char* signature;
+    bool isStatic = false;
+};
+
+/**
+ * @brief 在JNI_OnLoad中解析的一个Java类：jclass全局引用，以及按声明顺序排列的方法与字段ID
+ *
+ * 只能定义为静态存储期的对象（通常在匿名命名空间中），加载前登记，卸载时释放全局引用。
+ * 类或成员不存在时对应的值为nullptr（并打印到stderr），调用方据此回退。
+ */
+class JniClassRef {
+public:
+    JniClassRef(const char* className,
+                std::initializer_list<JniMemberSpec> methods = {},
+                std::initializer_list<JniMemberSpec> fields = {});
+
+    JniClassRef(const JniClassRef&) = delete;
+    JniClassRef& operator=(const JniClassRef&) = delete;
+
+    jclass get() const { return clazz_; }
+    explicit operator bool() const { return clazz_ != nullptr; }
+
+    // index为构造时methods / fields中的下标
+    jmethodID method(size_t index) const { return index < methodIds_.size() ? methodIds_[index] : nullptr; }
+    jfieldID field(size_t index) const { return index < fieldIds_.size() ? fieldIds_[index] : nullptr; }
+
+    const char* name() const { return className_; }
+
+private:
+    friend class JniRegistry;
+
+    bool resolve(JNIEnv* env);
+    void release(JNIEnv* env);
+
+    const char* className_;
+    std::vector<JniMemberSpec> methods_;
+    std::vector<JniMemberSpec> fields_;
+    jclass clazz_ = nullptr;
+    std::vector<jmethodID> methodIds_;
+    std::vector<jfieldID> fieldIds_;
+};
+
+/**
+ * @brief 在JNI_OnLoad中通过RegisterNatives绑定的一组native方法
+ *
+ * 用法与JniClassRef相同：定义为静态存储期的对象，库加载时统一注册。
+ * 注册后JVM不再按Java_<类>_<方法>的导出名逐个查找符号，桥接函数也不必导出。
+ * 类不存在或签名不匹配时打印到stderr，不影响库中其他桥接。
+ */
+class JniNativeTable {
+public:
+    JniNativeTable(const char* className, std::initializer_list<JNINativeMethod> methods);
+
+    JniNativeTable(const JniNativeTable&) = delete;
+    JniNativeTable& operator=(const JniNativeTable&) = delete;
+
+    const char* name() const { return className_; }
+    size_t size() const { return methods_.size(); }
+    bool registered() const { return registered_; }
+
+private:
+    friend class JniRegistry;
+
+    bool registerWith(JNIEnv* env);
+
+    const char* className_;
+    std::vector<JNINativeMethod> methods_;
+    bool registered_ = false;
+};
+
+// 桥接共用的数组类（创建byte[][] / long[][]结果时使用）
+extern JniClassRef BYTE_ARRAY_CLASS;
+extern JniClassRef LONG_ARRAY_CLASS;
+
+/**
+ * @brief 进程内唯一的JNI状态：JavaVM、所有已登记的JniClassRef，以及native线程的附加
+ */
+class JniRegistry {
+public:
+    /**
+     * 在JNI_OnLoad中调用：记录JavaVM，解析所有已登记的类并注册所有JniNativeTable，
+     * 返回JNI_OnLoad应返回的版本号
+     * 个别类解析或注册失败不影响加载；重复调用时只处理尚未完成的部分
+     */
+    static jint onLoad(JavaVM* vm);
+
+    // 在JNI_OnUnload中调用：释放全局引用（注册的native方法随类卸载）
+    static void onUnload(JavaVM* vm);
+
+    static JavaVM* vm();
+
+    /**
+     * 当前线程的JNIEnv；未附加的native线程在第一次调用时以守护线程附加（线程名取native线程名），
+     * 线程退出时自动分离，之后的调用不再有附加开销。JVM不可用时返回nullptr
+     */
+    static JNIEnv* env();
+
+    // 当前线程在JVM中时为true（Java线程，或已经由env()附加的native线程）
+    static bool isAttached();
+
+private:
+    friend class JniClassRef;
+    friend class JniNativeTable;
+    static void add(JniClassRef* ref);
+    static void add(JniNativeTable* table);
+};
+
+} // namespace jni
+} // namespace lattice
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * ===== 热路径的C ABI（供Java 21 FFM downcall使用）=====
+ *
+ * 与对应的JNI桥接并行提供，实现与JNI版本在同一个翻译单元中共用同一份逻辑，
+ * 所以两条路径可以混用（例如初始化走JNI，每tick的批量调用走FFM）。
+ * 只使用定长整数、float与指针，Java侧用MemorySegment直接传入，没有JNI的局部引用与数组复制，
+ * 这些函数都不回调JVM，也不持有JNI引用。
+ *
+ * 约定：
+ *   - 返回值 >= 0 为写入/处理的数量，负数为LATTICE_FFI_*错误码
+ *   - 所有函数不抛出异常，缓冲区由调用方分配并负责生命周期
+ *   - 函数所在的库与对应JNI桥接相同（见各组注释），用SymbolLookup.libraryLookup按库查找
+ *   - 修改签名或语义时递增LATTICE_FFI_VERSION，Java侧绑定前检查lattice_ffi_version()
+ */
+
+#define LATTICE_FFI_VERSION 1
+
+#define LATTICE_FFI_INVALID_ARGUMENT (-1)  /* 空指针、长度为负或对象不存在 */
+#define LATTICE_FFI_CAPACITY         (-2)  /* 输出缓冲区不足 */
+#define LATTICE_FFI_FAILED           (-3)  /* 内部错误 */
+
+#if defined(_WIN32)
+#define LATTICE_FFI_EXPORT __declspec(dllexport)
+#else
+#define LATTICE_FFI_EXPORT __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 返回LATTICE_FFI_VERSION（lattice_native导出，jni/native_interface.cpp） */
+LATTICE_FFI_EXPORT int32_t lattice_ffi_version(void);
+
+/* ---- 网络压缩（与NativeCompression同库，jni/net/native_compression.cpp）---- */
+
+/* zlib格式压缩，使用调用线程的NativeCompressor；返回压缩后字节数 */
+LATTICE_FFI_EXPORT int64_t lattice_compress_zlib(const uint8_t* src, int64_t srcLen,
+                                                 uint8_t* dst, int64_t dstCapacity, int32_t level);
+
+/* 返回解压后字节数；数据损坏或dst不足时返回LATTICE_FFI_FAILED */
+LATTICE_FFI_EXPORT int64_t lattice_decompress_zlib(const uint8_t* src, int64_t srcLen,
+                                                   uint8_t* dst, int64_t dstCapacity);
+
+/* ---- 实体追踪（与HierarchicalEntityTracker同库，jni/hierarchical_entity_bridge.cpp）---- */
+
+/*
+ * 批量更新worldId中实体的位置：positions为count组(x, y, z)
+ * 返回更新的实体数；世界不存在时返回LATTICE_FFI_INVALID_ARGUMENT
+ */
+LATTICE_FFI_EXPORT int32_t lattice_tracker_update_positions(int32_t worldId, const int32_t* entityIds,
+                                                            const float* positions, int32_t count);
+
+/*
+ * 查询观察者可见的实体ID，最多写入capacity个
+ * 返回可见实体总数；大于capacity时只写入了前capacity个，调用方扩大缓冲区后重新查询
+ */
+LATTICE_FFI_EXPORT int32_t lattice_tracker_query_visible(int32_t worldId, int32_t viewerId,
+                                                         float viewerX, float viewerY, float viewerZ,
+                                                         float viewDistance, int32_t* out, int32_t capacity);
+
+/*
+ * 批量更新实体朝向：rotations为count组(yaw, pitch, headYaw)（度），onGround每个实体一个字节（非0为着地）
+ * 返回更新的实体数；世界不存在时返回LATTICE_FFI_INVALID_ARGUMENT
+ */
+LATTICE_FFI_EXPORT int32_t lattice_tracker_update_rotations(int32_t worldId, const int32_t* entityIds,
+                                                            const float* rotations, const uint8_t* onGround,
+                                                            int32_t count);
+
+/*
+ * 把观察者本tick需要的实体移动/旋转/转头数据包编码到out（每个包带VarInt长度前缀，可直接写入Netty），
+ * 包ID需先通过HierarchicalEntityTracker.nativeWorldConfigureMoveEncoder配置。
+ * compressionThreshold为连接的压缩阈值，< 0表示未开启压缩。
+ * 返回写入的字节数；capacity放不下的实体本次不发送，之后重新调度时补发
+ */
+LATTICE_FFI_EXPORT int64_t lattice_tracker_encode_moves(int32_t worldId, int32_t viewerId,
+                                                        float viewerX, float viewerY, float viewerZ,
+                                                        int32_t compressionThreshold, uint8_t* out,
+                                                        int64_t capacity);
+
+/*
+ * 收集世界中全部实体的位置与半径，提交给该世界的碰撞粗检测后台线程后立即返回
+ * （配置见HierarchicalEntityTracker.nativeWorldConfigureBroadphase）；返回提交的实体数
+ */
+LATTICE_FFI_EXPORT int32_t lattice_tracker_submit_broadphase(int32_t worldId, int64_t tick);
+
+/*
+ * 取回tick不早于minTick的碰撞候选对，最多等待timeoutMillis毫秒（0表示不等待）。
+ * out每对写两个实体ID（较小的在前），最多写入capacity / 2对；resultTick非空时写入结果对应的tick（没有结果时为-1）。
+ * 返回结果的总对数，大于capacity / 2时只写入了前面的部分；结果尚未完成时返回0
+ */
+LATTICE_FFI_EXPORT int64_t lattice_tracker_broadphase_pairs(int32_t worldId, int64_t minTick,
+                                                            int32_t timeoutMillis, int32_t* out,
+                                                            int64_t capacity, int64_t* resultTick);
+
+/* ---- 光照（与LightEngineOptimized同库，jni/world/light_engine_optimized_jni.cpp）---- */
+
+/* lattice_light_write_packet最多写入的字节数；sectionCount无效时返回LATTICE_FFI_INVALID_ARGUMENT */
+LATTICE_FFI_EXPORT int32_t lattice_light_packet_capacity(int32_t sectionCount);
+
+/* 按光照更新包的格式导出区块光照段（与LightEngineOptimized.writeLightPacket相同），返回写入字节数 */
+LATTICE_FFI_EXPORT int32_t lattice_light_write_packet(int32_t chunkX, int32_t chunkZ, int32_t minSection,
+                                                      int32_t sectionCount, uint8_t* out, int64_t capacity);
+
+/* ---- 红石（与RedstoneJNI同库，jni/redstone/paper_compatible_redstone_jni.cpp）---- */
+/* enginePtr为0时使用单例引擎 */
+
+/* 按BlockPos.asLong打包的位置批量查询，每个位置写一个字节（低4位为信号强度，0x80为激活），返回count */
+LATTICE_FFI_EXPORT int32_t lattice_redstone_query_powers(int64_t enginePtr, const int64_t* positions,
+                                                         int32_t count, uint8_t* out, int64_t capacity);
+
+/* mask为64个uint64（段内4096个位置），按下标升序为每个选中位置写一个字节，返回写入数 */
+LATTICE_FFI_EXPORT int32_t lattice_redstone_query_section_powers(int64_t enginePtr, int64_t sectionId,
+                                                                 const uint64_t* mask, uint8_t* out,
+                                                                 int64_t capacity);
+
+/* 取出待发送的方块更新（每条为BlockPos.asLong），out须8字节对齐，capacity为条数；写不下的留到下次 */
+LATTICE_FFI_EXPORT int32_t lattice_redstone_drain_block_updates(int64_t enginePtr, int64_t* out,
+                                                                int64_t capacity);
+
+/* 每个位置本身及其六个邻居并入方块更新去重队列，返回新入队的条数 */
+LATTICE_FFI_EXPORT int32_t lattice_redstone_queue_neighbor_updates(int64_t enginePtr, const int64_t* positions,
+                                                                   int32_t count);
+
+/* 方块更新的取出顺序：0按位置排序（默认），1按原版发出顺序（邻居为西、东、下、上、北、南） */
+LATTICE_FFI_EXPORT int32_t lattice_redstone_set_block_update_order(int64_t enginePtr, int32_t order);
+
+/* ---- 工作负载记录（core/workload_trace.hpp，jni/workload_trace_ffi.cpp）---- */
+/* 每个桥接库各有一份记录器、各写一个文件：需要记录哪些库，就在哪些库上分别调用 */
+
+#define LATTICE_TRACE_NO_CHUNK_PAYLOADS 0x1  /* 保存区块时只记录大小，不记录NBT */
+
+/* 开始记录到path（已在记录时先结束当前文件）；maxBytes <= 0使用默认上限，成功返回0 */
+LATTICE_FFI_EXPORT int32_t lattice_workload_trace_start(const char* path, int32_t flags, int64_t maxBytes);
+
+/* 写出缓冲区并关闭文件，返回文件总字节数；未在记录时返回0 */
+LATTICE_FFI_EXPORT int64_t lattice_workload_trace_stop(void);
+
+/* 正在记录时返回1 */
+LATTICE_FFI_EXPORT int32_t lattice_workload_trace_recording(void);
+
+/* ---- 时间线追踪（core/tracing.hpp，jni/tracing_jni.cpp）---- */
+/* 与工作负载记录相同，每个桥接库各有一份，分别控制 */
+
+LATTICE_FFI_EXPORT void lattice_tracing_set_enabled(int32_t enabled);
+
+/* 已开启时返回1 */
+LATTICE_FFI_EXPORT int32_t lattice_tracing_enabled(void);
+
+/* 取出本库已记录的事件写入path（Chrome trace event JSON，Perfetto可直接打开）；
+ * append非0且path是之前dump写出的文件时接在末尾。返回写出的事件数 */
+LATTICE_FFI_EXPORT int64_t lattice_tracing_dump(const char* path, int32_t append);
+
+/* ---- 指标（core/metrics.hpp，jni/metrics_jni.cpp）---- */
+
+/* 把本库全部指标的快照编码写入out（格式见MetricsRegistry::encodeSnapshot），返回字节数；
+ * capacity不足时返回LATTICE_FFI_CAPACITY，调用方扩大缓冲区后重试 */
+LATTICE_FFI_EXPORT int64_t lattice_metrics_snapshot(uint8_t* out, int64_t capacity);
+
+/* ---- 主线程tick预算（core/tick_budget.hpp，jni/tick_budget_jni.cpp）---- */
+/* 每个桥接库各有一份：主线程在每个tick开始/结束时向每个库上报；
+ * tick开始同时推进该库的帧分配器（core/frame_allocator.hpp） */
+
+LATTICE_FFI_EXPORT void lattice_tick_started(void);
+LATTICE_FFI_EXPORT void lattice_tick_ended(void);
+
+/* 目标每tick毫秒数；<= 0恢复默认50 */
+LATTICE_FFI_EXPORT void lattice_tick_set_target_mspt(double mspt);
+
+/* 当前负载：0未上报 1有余量 2正常 3落后 4超时 */
+LATTICE_FFI_EXPORT int32_t lattice_tick_pressure(void);
+
+/* ---- native内存预算（core/memory_budget.hpp，jni/memory_budget_jni.cpp）---- */
+/* 每个桥接库各有一份，向每个库下发相同的设置；subsystem为MemorySubsystem的序号，字节数 <= 0表示恢复默认 */
+
+/* JVM最大堆（Runtime.maxMemory()），全局上限 = 容器上限 - 堆 - 非堆预留 */
+LATTICE_FFI_EXPORT void lattice_memory_set_jvm_max_heap(int64_t bytes);
+
+/* 显式设置全局上限，代替从容器上限推算 */
+LATTICE_FFI_EXPORT void lattice_memory_set_global_limit(int64_t bytes);
+
+/* 成功返回0；subsystem无效时返回LATTICE_FFI_INVALID_ARGUMENT */
+LATTICE_FFI_EXPORT int32_t lattice_memory_set_budget(int32_t subsystem, int64_t bytes);
+
+/* 子系统当前记账的字节数 */
+LATTICE_FFI_EXPORT int64_t lattice_memory_usage(int32_t subsystem);
+
+/* 立即执行一轮回收，返回释放的字节数 */
+LATTICE_FFI_EXPORT int64_t lattice_memory_enforce(void);
+
+/* ---- 共享方块状态（与NativeBlockStates同库，core/world/block_state_store.hpp，jni/world/block_state_store_jni.cpp）---- */
+
+/* 批量方块变化：positions为count个BlockPos.asLong，states为方块状态id；返回应用的变化数（未载入的区块被忽略） */
+LATTICE_FFI_EXPORT int32_t lattice_block_states_set(const int64_t* positions, const uint16_t* states, int32_t count);
+
+/* 发布本tick的修改并同步寻路快照，返回快照版本 */
+LATTICE_FFI_EXPORT int64_t lattice_block_states_publish(void);
+
+#ifdef __cplusplus
+}
+#endif
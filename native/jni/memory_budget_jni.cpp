@@ -0,0 +1,122 @@
+#include "jni_registry.hpp"
+#include "lattice_ffi.h"
+#include "../core/memory_budget.hpp"
+#include <jni.h>
+#include <vector>
+
+namespace lattice {
+namespace jni {
+
+namespace {
+
+using lattice::core::MEMORY_SUBSYSTEM_COUNT;
+using lattice::core::MemoryBudget;
+using lattice::core::MemorySubsystem;
+
+// 与tick_budget_jni.cpp相同：每个桥接库注册到NativeMemoryBudget下各自的嵌套类（见NativeMemoryBudget.java）
+#if defined(LATTICE_BRIDGE_CHUNK_IO)
+constexpr const char* MEMORY_BUDGET_CLASS = "io/lattice/nativeutil/NativeMemoryBudget$ChunkIO";
+#elif defined(LATTICE_BRIDGE_OPTIMIZED)
+constexpr const char* MEMORY_BUDGET_CLASS = "io/lattice/nativeutil/NativeMemoryBudget$Optimized";
+#else
+constexpr const char* MEMORY_BUDGET_CLASS = "io/lattice/nativeutil/NativeMemoryBudget$Core";
+#endif
+
+// nativeStats的布局：全局4项，随后每个子系统5项
+constexpr size_t GLOBAL_STAT_COUNT = 4;
+constexpr size_t SUBSYSTEM_STAT_COUNT = 5;
+
+size_t toBytes(jlong bytes) {
+    return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+}
+
+void JNICALL setJvmMaxHeap(JNIEnv* env, jclass clazz, jlong bytes) {
+    MemoryBudget::instance().setJvmMaxHeap(toBytes(bytes));
+}
+
+void JNICALL setGlobalLimit(JNIEnv* env, jclass clazz, jlong bytes) {
+    MemoryBudget::instance().setGlobalLimit(toBytes(bytes));
+}
+
+void JNICALL setBudget(JNIEnv* env, jclass clazz, jint subsystem, jlong bytes) {
+    if (subsystem < 0 || static_cast<size_t>(subsystem) >= MEMORY_SUBSYSTEM_COUNT) {
+        return;
+    }
+    MemoryBudget::instance().setBudget(static_cast<MemorySubsystem>(subsystem), toBytes(bytes));
+}
+
+jlong JNICALL enforce(JNIEnv* env, jclass clazz) {
+    return static_cast<jlong>(MemoryBudget::instance().enforce());
+}
+
+// [globalLimit, containerLimit, jvmMaxHeap, totalUsage,
+//  每个子系统按MemorySubsystem顺序：usage, peak, budget, shedPasses, shedBytes]
+jlongArray JNICALL stats(JNIEnv* env, jclass clazz) {
+    const MemoryBudget::Stats stats = MemoryBudget::instance().getStats();
+    std::vector<jlong> values;
+    values.reserve(GLOBAL_STAT_COUNT + MEMORY_SUBSYSTEM_COUNT * SUBSYSTEM_STAT_COUNT);
+    values.push_back(static_cast<jlong>(stats.globalLimit));
+    values.push_back(static_cast<jlong>(stats.containerLimit));
+    values.push_back(static_cast<jlong>(stats.jvmMaxHeap));
+    values.push_back(static_cast<jlong>(stats.totalUsage));
+    for (const auto& subsystem : stats.subsystems) {
+        values.push_back(static_cast<jlong>(subsystem.usage));
+        values.push_back(static_cast<jlong>(subsystem.peak));
+        values.push_back(static_cast<jlong>(subsystem.budget));
+        values.push_back(static_cast<jlong>(subsystem.shedPasses));
+        values.push_back(static_cast<jlong>(subsystem.shedBytes));
+    }
+    const jsize length = static_cast<jsize>(values.size());
+    jlongArray result = env->NewLongArray(length);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, length, values.data());
+    }
+    return result;
+}
+
+// 在所在库的JNI_OnLoad中注册（JniRegistry）
+JniNativeTable MEMORY_BUDGET_NATIVES(MEMORY_BUDGET_CLASS, {
+    {(char*)"nativeSetJvmMaxHeap", (char*)"(J)V", (void*)setJvmMaxHeap},
+    {(char*)"nativeSetGlobalLimit", (char*)"(J)V", (void*)setGlobalLimit},
+    {(char*)"nativeSetBudget", (char*)"(IJ)V", (void*)setBudget},
+    {(char*)"nativeEnforce", (char*)"()J", (void*)enforce},
+    {(char*)"nativeStats", (char*)"()[J", (void*)stats}
+});
+
+} // namespace
+
+} // namespace jni
+} // namespace lattice
+
+extern "C" {
+
+LATTICE_FFI_EXPORT void lattice_memory_set_jvm_max_heap(int64_t bytes) {
+    lattice::core::MemoryBudget::instance().setJvmMaxHeap(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+}
+
+LATTICE_FFI_EXPORT void lattice_memory_set_global_limit(int64_t bytes) {
+    lattice::core::MemoryBudget::instance().setGlobalLimit(bytes > 0 ? static_cast<size_t>(bytes) : 0);
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_memory_set_budget(int32_t subsystem, int64_t bytes) {
+    if (subsystem < 0 || static_cast<size_t>(subsystem) >= lattice::core::MEMORY_SUBSYSTEM_COUNT) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    lattice::core::MemoryBudget::instance().setBudget(static_cast<lattice::core::MemorySubsystem>(subsystem),
+                                                      bytes > 0 ? static_cast<size_t>(bytes) : 0);
+    return 0;
+}
+
+LATTICE_FFI_EXPORT int64_t lattice_memory_usage(int32_t subsystem) {
+    if (subsystem < 0 || static_cast<size_t>(subsystem) >= lattice::core::MEMORY_SUBSYSTEM_COUNT) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    return static_cast<int64_t>(
+        lattice::core::MemoryBudget::instance().usage(static_cast<lattice::core::MemorySubsystem>(subsystem)));
+}
+
+LATTICE_FFI_EXPORT int64_t lattice_memory_enforce(void) {
+    return static_cast<int64_t>(lattice::core::MemoryBudget::instance().enforce());
+}
+
+} // extern "C"
@@ -0,0 +1,63 @@
+#include "jni_registry.hpp"
+#include "lattice_ffi.h"
+#include "../core/metrics.hpp"
+#include <jni.h>
+#include <cstring>
+
+namespace lattice {
+namespace jni {
+
+namespace {
+
+using lattice::core::MetricsRegistry;
+
+// 与tracing_jni.cpp相同：每个桥接库注册到NativeMetrics下各自的嵌套类（见NativeMetrics.java）
+#if defined(LATTICE_BRIDGE_CHUNK_IO)
+constexpr const char* METRICS_CLASS = "io/lattice/nativeutil/NativeMetrics$ChunkIO";
+#elif defined(LATTICE_BRIDGE_OPTIMIZED)
+constexpr const char* METRICS_CLASS = "io/lattice/nativeutil/NativeMetrics$Optimized";
+#else
+constexpr const char* METRICS_CLASS = "io/lattice/nativeutil/NativeMetrics$Core";
+#endif
+
+// 一次调用取回本库全部指标（编码格式见MetricsRegistry::encodeSnapshot）
+jbyteArray JNICALL snapshot(JNIEnv* env, jclass clazz) {
+    const std::vector<uint8_t> encoded = MetricsRegistry::instance().encodeSnapshot();
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(encoded.size()));
+    if (result == nullptr) {
+        return nullptr;
+    }
+    env->SetByteArrayRegion(result, 0, static_cast<jsize>(encoded.size()),
+                            reinterpret_cast<const jbyte*>(encoded.data()));
+    return result;
+}
+
+// 在所在库的JNI_OnLoad中注册（JniRegistry）
+JniNativeTable METRICS_NATIVES(METRICS_CLASS, {
+    {(char*)"nativeSnapshot", (char*)"()[B", (void*)snapshot}
+});
+
+} // namespace
+
+} // namespace jni
+} // namespace lattice
+
+extern "C" {
+
+LATTICE_FFI_EXPORT int64_t lattice_metrics_snapshot(uint8_t* out, int64_t capacity) {
+    if (!out || capacity < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    try {
+        const std::vector<uint8_t> encoded = lattice::core::MetricsRegistry::instance().encodeSnapshot();
+        if (static_cast<int64_t>(encoded.size()) > capacity) {
+            return LATTICE_FFI_CAPACITY;
+        }
+        std::memcpy(out, encoded.data(), encoded.size());
+        return static_cast<int64_t>(encoded.size());
+    } catch (...) {
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+} // extern "C"
@@ -4,27 +4,25 @@
 #include <vector>
 #include <atomic>
 #include <mutex>
-#include "core/threadpool.hpp"
+#include "core/native_runtime.hpp"
+#include "core/simd_dispatch.hpp"
 #include "core/net/native_compressor.hpp"
-#include "core/redstone/redstone_optimizer.hpp"
 #include "core/world/pathfinder.hpp"
 #include "core/world/light_updater.hpp"
 #include "cache/hierarchical_cache_system.hpp"
-#include "world/async_chunk_io.hpp"
+#include "world/async_chunk_io_jni.hpp"
 #include "ai/adaptive_decision_engine.hpp"
+#include "jni_registry.hpp"
+#include "lattice_ffi.h"
 
-static std::unique_ptr<lattice::core::ThreadPool> gThreadPool;
+// NativeRuntime的共享线程池（不拥有）
+static lattice::core::ThreadPool* gThreadPool = nullptr;
 
 // Global cache instances
 static std::atomic<jlong> gCacheCounter(0);
 static std::unordered_map<jlong, std::unique_ptr<lattice::cache::HierarchicalCacheSystem<std::string, std::string>>> gCacheInstances;
 static std::mutex gCacheMutex;
 
-// Global chunk IO instances
-static std::atomic<jlong> gChunkIOCounter(0);
-static std::unordered_map<jlong, std::unique_ptr<lattice::world::AsyncChunkIO>> gChunkIOInstances;
-static std::mutex gChunkIOMutex;
-
 // Global decision engine instances
 static std::atomic<jlong> gDecisionEngineCounter(0);
 static std::unordered_map<jlong, std::unique_ptr<lattice::ai::AdaptiveDecisionEngine>> gDecisionEngineInstances;
@@ -32,6 +30,20 @@ static std::mutex gDecisionEngineMutex;
 
 extern "C" {
 
+// 库的唯一加载入口：解析各桥接登记的类与方法ID（JniRegistry）
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+    return lattice::jni::JniRegistry::onLoad(vm);
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
+    lattice::jni::JniRegistry::onUnload(vm);
+}
+
+// FFM绑定前的ABI版本检查（C ABI见lattice_ffi.h）
+LATTICE_FFI_EXPORT int32_t lattice_ffi_version(void) {
+    return LATTICE_FFI_VERSION;
+}
+
 // Compression functions
 JNIEXPORT jbyteArray JNICALL Java_io_lattice_network_NativeCompression_compressZlib
   (JNIEnv* env, jclass, jbyteArray data, jint compressionLevel) {
@@ -118,24 +130,6 @@ JNIEXPORT jint JNICALL Java_io_lattice_world_NativeLightUpdater_getLightLevel
     return 0;
 }
 
-// Redstone optimizer functions
-JNIEXPORT jint JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeGetRedstonePower
-  (JNIEnv *env, jclass clazz, jint x, jint y, jint z) {
-    // Implementation in redstone_optimizer_jni.cpp
-    return 0;
-}
-
-JNIEXPORT jint JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeCalculateNetworkPower
-  (JNIEnv *env, jclass clazz, jint x, jint y, jint z, jint max_distance) {
-    // Implementation in redstone_optimizer_jni.cpp
-    return 0;
-}
-
-JNIEXPORT void JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeInvalidateNetworkCache
-  (JNIEnv *env, jclass clazz, jint x, jint y, jint z) {
-    // Implementation in redstone_optimizer_jni.cpp
-}
-
 // Pathfinder functions
 JNIEXPORT jobjectArray JNICALL Java_io_lattice_world_NativePathfinder_nativeOptimizePathfinding
   (JNIEnv *env, jclass clazz, jint start_x, jint start_y, jint start_z, 
@@ -150,12 +144,35 @@ JNIEXPORT jobject JNICALL Java_io_lattice_world_NativePathfinder_nativeGetMobPat
     return nullptr;
 }
 
+// Native runtime configuration (LatticeConfig native-runtime.*)
+JNIEXPORT jboolean JNICALL Java_io_lattice_nativeutil_LatticeNativeInitializer_nativeConfigureRuntime
+  (JNIEnv* env, jclass, jint totalThreads, jint compressionThreads, jboolean pinThreads, jint mainThreadCpu)
+{
+    try {
+        lattice::core::NativeRuntimeConfig config;
+        config.totalThreads = totalThreads;
+        config.compressionThreads = compressionThreads;
+        config.pinThreads = pinThreads == JNI_TRUE;
+        config.mainThreadCpu = mainThreadCpu;
+        lattice::core::NativeRuntime::instance().configure(config);
+        return JNI_TRUE;
+    } catch (const std::exception&) {
+        return JNI_FALSE;
+    }
+}
+
 // Thread pool functions
 JNIEXPORT jboolean JNICALL Java_io_lattice_performance_NativeInterface_initializeThreadPool
   (JNIEnv* env, jclass, jint threadCount)
 {
     try {
-        gThreadPool = std::make_unique<lattice::core::ThreadPool>(threadCount);
+        // threadCount作为进程级线程预算；共享线程池一旦创建，之后的调用不再改变其大小
+        if (threadCount > 0) {
+            auto config = lattice::core::NativeRuntime::instance().config();
+            config.totalThreads = threadCount;
+            lattice::core::NativeRuntime::instance().configure(config);
+        }
+        gThreadPool = &lattice::core::NativeRuntime::instance().pool();
         return JNI_TRUE;
     } catch (const std::exception&) {
         return JNI_FALSE;
@@ -214,7 +231,7 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_performance_NativeInterface_cleanupAl
   (JNIEnv* env, jclass) {
     try {
         // Cleanup global thread pool
-        gThreadPool.reset();
+        gThreadPool = nullptr;
         
         // Cleanup cache instances
         {
@@ -223,10 +240,7 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_performance_NativeInterface_cleanupAl
         }
         
         // Cleanup chunk IO instances
-        {
-            std::lock_guard<std::mutex> lock(gChunkIOMutex);
-            gChunkIOInstances.clear();
-        }
+        lattice::jni::asyncChunkIOInstances().clear();
         
         // Cleanup decision engine instances
         {
@@ -253,8 +267,7 @@ JNIEXPORT jint JNICALL Java_io_lattice_performance_NativeInterface_getActiveCach
 JNIEXPORT jint JNICALL Java_io_lattice_performance_NativeInterface_getActiveChunkIOCount
   (JNIEnv* env, jclass) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        return static_cast<jint>(gChunkIOInstances.size());
+        return static_cast<jint>(lattice::jni::asyncChunkIOInstances().size());
     } catch (const std::exception&) {
         return 0;
     }
@@ -275,16 +288,20 @@ JNIEXPORT jstring JNICALL Java_io_lattice_performance_NativeInterface_getSystemC
     try {
         std::vector<std::string> capabilities;
         
-        // Check for SIMD support
-        #if defined(__AVX512F__)
+        // Check for SIMD support (runtime detection, same level the kernel dispatcher uses)
+        const lattice::core::SimdLevel simd = lattice::core::detectSimdLevel();
+        if (simd == lattice::core::SimdLevel::AVX512) {
             capabilities.push_back("AVX-512");
-        #endif
-        #if defined(__AVX2__)
+        }
+        if (simd >= lattice::core::SimdLevel::AVX2) {
             capabilities.push_back("AVX2");
-        #endif
-        #if defined(__SSE4_1__) || defined(__SSE4_2__)
+        }
+        if (simd >= lattice::core::SimdLevel::SSE4) {
             capabilities.push_back("SSE4");
-        #endif
+        }
+        if (simd == lattice::core::SimdLevel::NEON) {
+            capabilities.push_back("NEON");
+        }
         
         // Check platform
         #ifdef __linux__
@@ -1,10 +1,16 @@
 #include "async_compression_jni.hpp"
 #include "../FinalLatticeJNI_Fixed.h"
+#include "../jni_registry.hpp"
+#include "compression_fast_path.hpp"
 
 namespace lattice {
 namespace jni {
 namespace net {
 
+// 回调接口与onComplete在JNI_OnLoad中解析
+static JniClassRef COMPRESSION_CALLBACK("io/lattice/network/AsyncCompression$CompressionCallback",
+                                        {{"onComplete", "(ZI)V"}});
+
 // ========== 优化的异步压缩器类 ==========
 class OptimizedAsyncCompressionJNI {
 private:
@@ -16,11 +22,6 @@ private:
     // 框架配置
     jni_framework::FrameworkConfig config_;
     
-    // 回调引用
-    static jclass callbackClass_;
-    static jmethodID callbackMethod_;
-    static JavaVM* jvm_;
-    
 public:
     OptimizedAsyncCompressionJNI() {
         // 配置框架
@@ -49,18 +50,14 @@ public:
             if (input_size == 0) {
                 // 空数据直接回调成功
                 if (callback) {
-                    env->CallVoidMethod(callback, callbackMethod_, compress, 0);
+                    env->CallVoidMethod(callback, COMPRESSION_CALLBACK.method(0), compress, 0);
                 }
                 return;
             }
             
-            // 使用SafeBuffer进行零拷贝操作
-            jbyte* input_bytes = env->GetByteArrayElements(inputData, nullptr);
+            // 直接从Java数组复制到任务缓冲区（GetByteArrayElements可能先复制整个数组，再memcpy一次）
             auto input_buffer = memory_manager_->allocateDirect(input_size, "compression_input");
-            
-            // 复制数据到缓冲区
-            memcpy(input_buffer, input_bytes, input_size);
-            env->ReleaseByteArrayElements(inputData, input_bytes, JNI_ABORT);
+            env->GetByteArrayRegion(inputData, 0, input_size, static_cast<jbyte*>(input_buffer));
             
             // 构建压缩任务
             struct CompressionTask {
@@ -117,11 +114,10 @@ public:
                     // 记录性能指标
                     metrics_->recordLatency(duration);
                     
-                    // 异步回调
+                    // 异步回调（压缩线程第一次回调时以守护线程附加到JVM）
                     if (task.callback) {
-                        JNIEnv* callback_env = nullptr;
-                        if (jvm_->GetEnv((void**)&callback_env, JNI_VERSION_1_8) == JNI_OK) {
-                            callback_env->CallVoidMethod(task.callback, callbackMethod_, task.compress, static_cast<jint>(output_size));
+                        if (JNIEnv* callback_env = JniRegistry::env()) {
+                            callback_env->CallVoidMethod(task.callback, COMPRESSION_CALLBACK.method(0), task.compress, static_cast<jint>(output_size));
                         }
                     }
                     
@@ -133,9 +129,8 @@ public:
                     
                     // 错误回调
                     if (task.callback) {
-                        JNIEnv* callback_env = nullptr;
-                        if (jvm_->GetEnv((void**)&callback_env, JNI_VERSION_1_8) == JNI_OK) {
-                            callback_env->CallVoidMethod(task.callback, callbackMethod_, task.compress, -1);
+                        if (JNIEnv* callback_env = JniRegistry::env()) {
+                            callback_env->CallVoidMethod(task.callback, COMPRESSION_CALLBACK.method(0), task.compress, -1);
                         }
                     }
                 }
@@ -166,11 +161,6 @@ public:
     }
 };
 
-// 静态成员初始化
-jclass OptimizedAsyncCompressionJNI::callbackClass_ = nullptr;
-jmethodID OptimizedAsyncCompressionJNI::callbackMethod_ = nullptr;
-JavaVM* OptimizedAsyncCompressionJNI::jvm_ = nullptr;
-
 // 全局优化实例
 static std::unique_ptr<OptimizedAsyncCompressionJNI> g_optimized_compression;
 
@@ -180,8 +170,6 @@ extern "C" {
 
 // JNI_OnLoad函数，在库加载时调用
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
-    jvm_ = vm;
-    
     try {
         // 初始化优化实例
         g_optimized_compression = std::make_unique<OptimizedAsyncCompressionJNI>();
@@ -190,22 +178,13 @@ JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
         std::cerr << "Failed to initialize Optimized AsyncCompressionJNI: " << e.what() << std::endl;
     }
     
-    return JNI_VERSION_1_8;
+    return JniRegistry::onLoad(vm);
 }
 
 // 初始化异步压缩器
 JNIEXPORT void JNICALL Java_io_lattice_network_AsyncCompression_initializeAsyncCompressor
   (JNIEnv *env, jclass clazz, jint workerCount) {
     try {
-        // 获取回调类和方法的引用
-        if (OptimizedAsyncCompressionJNI::callbackClass_ == nullptr) {
-            jclass localCallbackClass = env->FindClass("io/lattice/network/AsyncCompression$CompressionCallback");
-            if (localCallbackClass != nullptr) {
-                OptimizedAsyncCompressionJNI::callbackClass_ = (jclass)env->NewGlobalRef(localCallbackClass);
-                OptimizedAsyncCompressionJNI::callbackMethod_ = env->GetMethodID(OptimizedAsyncCompressionJNI::callbackClass_, "onComplete", "(ZI)V");
-            }
-        }
-        
         // 原始初始化逻辑保持不变
         if (workerCount > 0) {
             lattice::net::AsyncCompressor::initialize(workerCount);
@@ -239,6 +218,22 @@ JNIEXPORT void JNICALL Java_io_lattice_network_AsyncCompression_compressAsync
     }
 }
 
+// 同步压缩/解压byte[]区间：小负载在临界区内直接访问数组，返回写入output的字节数或负数错误码
+JNIEXPORT jint JNICALL Java_io_lattice_network_AsyncCompression_compressSync
+  (JNIEnv *env, jclass clazz, jbyteArray input, jint offset, jint length,
+   jbyteArray output, jint outputOffset, jboolean compress, jint level) {
+    return transformArrayRegion(env, compress == JNI_TRUE, normalizeCompressionLevel(level),
+                                input, offset, length, output, outputOffset);
+}
+
+// 同步压缩/解压DirectByteBuffer区间，结果原地写入调用方提供的output
+JNIEXPORT jint JNICALL Java_io_lattice_network_AsyncCompression_compressDirect
+  (JNIEnv *env, jclass clazz, jobject input, jint offset, jint length,
+   jobject output, jint outputOffset, jboolean compress, jint level) {
+    return transformDirect(env, compress == JNI_TRUE, normalizeCompressionLevel(level),
+                           input, offset, length, output, outputOffset);
+}
+
 // 获取性能报告
 JNIEXPORT jstring JNICALL Java_io_lattice_network_AsyncCompression_getPerformanceReport
   (JNIEnv *env, jclass clazz) {
@@ -266,13 +261,9 @@ JNIEXPORT jlong JNICALL Java_io_lattice_network_AsyncCompression_getTotalOperati
 
 // JNI_OnUnload函数
 JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
-    if (OptimizedAsyncCompressionJNI::callbackClass_) {
-        // 清理全局引用
-        vm->GetEnv((void**)&env, JNI_VERSION_1_8);
-        // 清理逻辑...
-    }
-    
     g_optimized_compression.reset();
+    // 释放回调类等全局引用
+    JniRegistry::onUnload(vm);
     std::cout << "Optimized AsyncCompressionJNI unloaded" << std::endl;
 }
 
@@ -16,6 +16,13 @@ JNIEXPORT void JNICALL Java_io_lattice_network_AsyncCompression_setWorkerCount
 JNIEXPORT void JNICALL Java_io_lattice_network_AsyncCompression_compressAsync
   (JNIEnv *, jclass, jobject, jint, jobject, jint, jobject);
 
+// 同步快速路径：返回写入output的字节数，负数为错误码（见compression_fast_path.hpp）
+JNIEXPORT jint JNICALL Java_io_lattice_network_AsyncCompression_compressSync
+  (JNIEnv *, jclass, jbyteArray, jint, jint, jbyteArray, jint, jboolean, jint);
+
+JNIEXPORT jint JNICALL Java_io_lattice_network_AsyncCompression_compressDirect
+  (JNIEnv *, jclass, jobject, jint, jint, jobject, jint, jboolean, jint);
+
 JNIEXPORT jint JNICALL Java_io_lattice_network_DynamicCompression_suggestCompressionLevel
   (JNIEnv *, jclass, jint, jdouble, jdouble, jint, jint, jint);
 
@@ -1,4 +1,6 @@
 #include "async_compressor_optimized_jni.hpp"
+#include "../jni_registry.hpp"
+#include "compression_fast_path.hpp"
 #include <chrono>
 
 namespace lattice {
@@ -133,6 +135,45 @@ jbyteArray AsyncCompressorJNIOptimized::decompressData(JNIEnv* env, jobject comp
                        std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count());
 }
 
+// ===== 同步快速路径 =====
+// compressorPtr即initializeCompressor返回的压缩级别
+
+jint AsyncCompressorJNIOptimized::compressInto(JNIEnv* env, jobject self, jlong compressorPtr, jbyteArray input,
+                                               jint offset, jint length, jbyteArray output, jint outputOffset) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const jint result = transformArrayRegion(env, true, normalizeCompressionLevel(compressorPtr),
+                                             input, offset, length, output, outputOffset);
+    recordFastPath("compressInto", true, length, result, startTime);
+    return result;
+}
+
+jint AsyncCompressorJNIOptimized::decompressInto(JNIEnv* env, jobject self, jlong compressorPtr, jbyteArray input,
+                                                 jint offset, jint length, jbyteArray output, jint outputOffset) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const jint result = transformArrayRegion(env, false, normalizeCompressionLevel(compressorPtr),
+                                             input, offset, length, output, outputOffset);
+    recordFastPath("decompressInto", false, length, result, startTime);
+    return result;
+}
+
+jint AsyncCompressorJNIOptimized::compressDirect(JNIEnv* env, jobject self, jlong compressorPtr, jobject input,
+                                                 jint offset, jint length, jobject output, jint outputOffset) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const jint result = transformDirect(env, true, normalizeCompressionLevel(compressorPtr),
+                                        input, offset, length, output, outputOffset);
+    recordFastPath("compressDirect", true, length, result, startTime);
+    return result;
+}
+
+jint AsyncCompressorJNIOptimized::decompressDirect(JNIEnv* env, jobject self, jlong compressorPtr, jobject input,
+                                                   jint offset, jint length, jobject output, jint outputOffset) {
+    const auto startTime = std::chrono::steady_clock::now();
+    const jint result = transformDirect(env, false, normalizeCompressionLevel(compressorPtr),
+                                        input, offset, length, output, outputOffset);
+    recordFastPath("decompressDirect", false, length, result, startTime);
+    return result;
+}
+
 jobjectArray AsyncCompressorJNIOptimized::compressBatch(JNIEnv* env, jobject compressor, jobjectArray inputDataArray) {
     auto startTime = std::chrono::high_resolution_clock::now();
     
@@ -148,7 +189,7 @@ jobjectArray AsyncCompressorJNIOptimized::compressBatch(JNIEnv* env, jobject com
     
     try {
         // 2. 创建结果数组
-        jclass byteArrayClass = env->FindClass("[B");
+        jclass byteArrayClass = BYTE_ARRAY_CLASS.get();
         jobjectArray resultArray = env->NewObjectArray(arraySize, byteArrayClass, nullptr);
         
         // 3. 批量处理每个数据块
@@ -202,7 +243,7 @@ jobjectArray AsyncCompressorJNIOptimized::decompressBatch(JNIEnv* env, jobject c
     
     try {
         // 2. 创建结果数组
-        jclass byteArrayClass = env->FindClass("[B");
+        jclass byteArrayClass = BYTE_ARRAY_CLASS.get();
         jobjectArray resultArray = env->NewObjectArray(arraySize, byteArrayClass, nullptr);
         
         // 3. 批量处理每个数据块
@@ -362,6 +403,17 @@ void AsyncCompressorJNIOptimized::logPerformanceStats(const char* operation, uin
     totalTimeMicros_.fetch_add(durationMicros);
 }
 
+void AsyncCompressorJNIOptimized::recordFastPath(const char* operation, bool compress, jint inputSize, jint result,
+                                                 std::chrono::steady_clock::time_point startTime) {
+    if (result < 0) {
+        return;
+    }
+    totalCompressedBytes_ += static_cast<uint64_t>(compress ? result : inputSize);
+    totalUncompressedBytes_ += static_cast<uint64_t>(compress ? inputSize : result);
+    logPerformanceStats(operation, std::chrono::duration_cast<std::chrono::microseconds>(
+                                       std::chrono::steady_clock::now() - startTime).count());
+}
+
 void AsyncCompressorJNIOptimized::checkJNIException(JNIEnv* env, const char* methodName) {
     if (env->ExceptionCheck()) {
         env->ExceptionDescribe();
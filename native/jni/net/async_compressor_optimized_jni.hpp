@@ -3,6 +3,7 @@
 #include <jni.h>
 #include <memory>
 #include <atomic>
+#include <chrono>
 #include "../../core/net/async_compressor.hpp"
 
 namespace lattice {
@@ -18,6 +19,19 @@ public:
     // 数据解压 - 桥接到core
     static jbyteArray decompressData(JNIEnv* env, jobject compressor, jbyteArray compressedData);
     
+    // 同步快速路径（见compression_fast_path.hpp）：不复制整个数组，返回写入output的字节数或负数错误码
+    // 小数组 - 临界区直接访问input[offset, offset + length)与output[outputOffset, ...)
+    static jint compressInto(JNIEnv* env, jobject self, jlong compressorPtr, jbyteArray input, jint offset,
+                             jint length, jbyteArray output, jint outputOffset);
+    static jint decompressInto(JNIEnv* env, jobject self, jlong compressorPtr, jbyteArray input, jint offset,
+                               jint length, jbyteArray output, jint outputOffset);
+
+    // 大负载 - DirectByteBuffer输入，结果原地写入调用方提供的DirectByteBuffer
+    static jint compressDirect(JNIEnv* env, jobject self, jlong compressorPtr, jobject input, jint offset,
+                               jint length, jobject output, jint outputOffset);
+    static jint decompressDirect(JNIEnv* env, jobject self, jlong compressorPtr, jobject input, jint offset,
+                                 jint length, jobject output, jint outputOffset);
+    
     // 批量压缩 - 桥接到core
     static jobjectArray compressBatch(JNIEnv* env, jobject compressor, jobjectArray inputDataArray);
     
@@ -53,6 +67,8 @@ private:
     // 内部辅助方法
     static void logPerformanceStats(const char* operation, uint64_t durationMicros);
     static void checkJNIException(JNIEnv* env, const char* methodName);
+    static void recordFastPath(const char* operation, bool compress, jint inputSize, jint result,
+                               std::chrono::steady_clock::time_point startTime);
 };
 
 // JNI方法映射
@@ -61,6 +77,14 @@ static JNINativeMethod asyncCompressorMethods[] = {
      (void*)AsyncCompressorJNIOptimized::compressData},
     {"decompressData", "(Ljava/lang/Object;[B)[B", 
      (void*)AsyncCompressorJNIOptimized::decompressData},
+    {"compressInto", "(J[BII[BI)I",
+     (void*)AsyncCompressorJNIOptimized::compressInto},
+    {"decompressInto", "(J[BII[BI)I",
+     (void*)AsyncCompressorJNIOptimized::decompressInto},
+    {"compressDirect", "(JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;I)I",
+     (void*)AsyncCompressorJNIOptimized::compressDirect},
+    {"decompressDirect", "(JLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;I)I",
+     (void*)AsyncCompressorJNIOptimized::decompressDirect},
     {"compressBatch", "(Ljava/lang/Object;[Ljava/lang/Object;)[Ljava/lang/Object;", 
      (void*)AsyncCompressorJNIOptimized::compressBatch},
     {"decompressBatch", "(Ljava/lang/Object;[Ljava/lang/Object;)[Ljava/lang/Object;", 
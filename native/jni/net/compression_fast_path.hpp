@@ -0,0 +1,145 @@
+#pragma once
+
+#include <jni.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+namespace lattice {
+namespace jni {
+namespace net {
+
+// ========== 同步压缩快速路径 ==========
+//
+// byte[]接口原先用GetByteArrayElements取数据，JVM可能复制整个数组，64 KiB的包来回一次内存流量就翻倍。
+// 这里的同步路径不复制数组：
+//   - 小负载：GetPrimitiveArrayCritical直接访问输入输出数组。临界区内GC会被推迟，
+//     所以只在本次工作量不超过CRITICAL_ARRAY_LIMIT时使用，超过时退回一次区间复制
+//   - 大负载：调用方提供DirectByteBuffer输入与输出，结果原地写入输出缓冲区
+// 输出格式为zlib，与NativeCompression的libdeflate路径互通。
+
+// 返回值：>= 0为写入输出的字节数，负数为以下错误码
+constexpr jint FAST_PATH_INVALID_ARGUMENT = -1;  // 空引用、非direct缓冲区或区间越界
+constexpr jint FAST_PATH_OUTPUT_TOO_SMALL = -2;  // 输出空间不足
+constexpr jint FAST_PATH_CORRUPT_INPUT = -3;     // 解压：数据损坏
+constexpr jint FAST_PATH_FAILED = -4;            // 其他错误（内存不足等）
+
+// 以临界区访问Java数组的最大工作量：压缩按输入计，解压按输出空间计
+constexpr jint CRITICAL_ARRAY_LIMIT = 32 * 1024;
+
+namespace detail {
+
+inline bool validRange(jlong capacity, jint offset, jint length) {
+    return offset >= 0 && length >= 0 && static_cast<jlong>(offset) + length <= capacity;
+}
+
+inline jint zlibTransform(bool compress, int level, const void* src, size_t srcLen, void* dst, size_t dstCapacity) {
+    uLongf written = static_cast<uLongf>(dstCapacity);
+    const int result = compress
+        ? compress2(static_cast<Bytef*>(dst), &written, static_cast<const Bytef*>(src),
+                    static_cast<uLong>(srcLen), level)
+        : uncompress(static_cast<Bytef*>(dst), &written, static_cast<const Bytef*>(src),
+                     static_cast<uLong>(srcLen));
+    switch (result) {
+        case Z_OK:
+            return static_cast<jint>(written);
+        case Z_BUF_ERROR:
+            // 解压时输入被截断也报Z_BUF_ERROR，输出空间足够时按数据损坏处理
+            return compress || written < dstCapacity ? FAST_PATH_OUTPUT_TOO_SMALL : FAST_PATH_CORRUPT_INPUT;
+        case Z_DATA_ERROR:
+            return FAST_PATH_CORRUPT_INPUT;
+        default:
+            return FAST_PATH_FAILED;
+    }
+}
+
+} // namespace detail
+
+inline int normalizeCompressionLevel(jlong level) {
+    return level >= Z_NO_COMPRESSION && level <= Z_BEST_COMPRESSION ? static_cast<int>(level)
+                                                                     : Z_DEFAULT_COMPRESSION;
+}
+
+/**
+ * @brief 压缩/解压input[offset, offset + length)，结果写入output[outputOffset, ...)
+ *
+ * 输入与输出可以是同一个数组的不重叠区间。
+ */
+inline jint transformArrayRegion(JNIEnv* env, bool compress, int level,
+                                 jbyteArray input, jint offset, jint length,
+                                 jbyteArray output, jint outputOffset) {
+    if (!input || !output) {
+        return FAST_PATH_INVALID_ARGUMENT;
+    }
+    const jsize outputLength = env->GetArrayLength(output);
+    if (!detail::validRange(env->GetArrayLength(input), offset, length) ||
+        outputOffset < 0 || outputOffset > outputLength) {
+        return FAST_PATH_INVALID_ARGUMENT;
+    }
+    const jint outputCapacity = outputLength - outputOffset;
+
+    if ((compress ? length : outputCapacity) <= CRITICAL_ARRAY_LIMIT) {
+        // 临界区内不能调用其他JNI函数
+        auto* src = static_cast<uint8_t*>(env->GetPrimitiveArrayCritical(input, nullptr));
+        if (!src) {
+            return FAST_PATH_FAILED;
+        }
+        auto* dst = static_cast<uint8_t*>(env->GetPrimitiveArrayCritical(output, nullptr));
+        if (!dst) {
+            env->ReleasePrimitiveArrayCritical(input, src, JNI_ABORT);
+            return FAST_PATH_FAILED;
+        }
+        const jint result = detail::zlibTransform(compress, level, src + offset, static_cast<size_t>(length),
+                                                  dst + outputOffset, static_cast<size_t>(outputCapacity));
+        env->ReleasePrimitiveArrayCritical(output, dst, 0);
+        env->ReleasePrimitiveArrayCritical(input, src, JNI_ABORT);
+        return result;
+    }
+
+    // 工作量较大：各复制一次区间，不长时间推迟GC（需要零拷贝时用DirectByteBuffer接口）
+    thread_local std::vector<uint8_t> inputScratch;
+    thread_local std::vector<uint8_t> outputScratch;
+    try {
+        inputScratch.resize(static_cast<size_t>(length));
+        outputScratch.resize(static_cast<size_t>(outputCapacity));
+    } catch (const std::bad_alloc&) {
+        return FAST_PATH_FAILED;
+    }
+    env->GetByteArrayRegion(input, offset, length, reinterpret_cast<jbyte*>(inputScratch.data()));
+    const jint result = detail::zlibTransform(compress, level, inputScratch.data(), inputScratch.size(),
+                                              outputScratch.data(), outputScratch.size());
+    if (result > 0) {
+        env->SetByteArrayRegion(output, outputOffset, result, reinterpret_cast<const jbyte*>(outputScratch.data()));
+    }
+    return result;
+}
+
+/**
+ * @brief 压缩/解压DirectByteBuffer input[offset, offset + length)，结果原地写入output[outputOffset, capacity)
+ *
+ * 偏移按缓冲区起点计算，不读取也不修改Java侧的position / limit。
+ */
+inline jint transformDirect(JNIEnv* env, bool compress, int level,
+                            jobject input, jint offset, jint length,
+                            jobject output, jint outputOffset) {
+    if (!input || !output) {
+        return FAST_PATH_INVALID_ARGUMENT;
+    }
+    auto* src = static_cast<uint8_t*>(env->GetDirectBufferAddress(input));
+    auto* dst = static_cast<uint8_t*>(env->GetDirectBufferAddress(output));
+    const jlong outputCapacity = env->GetDirectBufferCapacity(output);
+    if (!src || !dst || !detail::validRange(env->GetDirectBufferCapacity(input), offset, length) ||
+        outputOffset < 0 || outputOffset > outputCapacity) {
+        return FAST_PATH_INVALID_ARGUMENT;
+    }
+    // 返回值为jint，可写空间按INT32_MAX截断
+    const jlong writable = std::min<jlong>(outputCapacity - outputOffset, INT32_MAX);
+    return detail::zlibTransform(compress, level, src + offset, static_cast<size_t>(length),
+                                 dst + outputOffset, static_cast<size_t>(writable));
+}
+
+} // namespace net
+} // namespace jni
+} // namespace lattice
@@ -1,4 +1,5 @@
 #include "entity_tracker_optimized_jni.hpp"
+#include "../jni_registry.hpp"
 #include <chrono>
 
 namespace lattice {
@@ -203,6 +204,51 @@ void EntityTrackerJNIOptimized::batchUpdatePositions(JNIEnv* env, jobject tracke
                        std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count());
 }
 
+jint EntityTrackerJNIOptimized::applyPackedUpdates(JNIEnv* env, jobject tracker, jobject recordBuffer,
+                                                  jint count, jobject resultBuffer) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    using lattice::entity::PackedPositionUpdate;
+    
+    // 1. 参数验证：记录直接在Java缓冲区上读取，必须对齐且容量足够
+    if (tracker == nullptr || recordBuffer == nullptr || count < 0) {
+        return -1;
+    }
+    if (count == 0) {
+        return 0;
+    }
+    void* recordAddress = env->GetDirectBufferAddress(recordBuffer);
+    const jlong recordCapacity = env->GetDirectBufferCapacity(recordBuffer);
+    if (!recordAddress ||
+        reinterpret_cast<uintptr_t>(recordAddress) % alignof(PackedPositionUpdate) != 0 ||
+        recordCapacity < static_cast<jlong>(count) * static_cast<jlong>(sizeof(PackedPositionUpdate))) {
+        return -1;
+    }
+    int32_t* results = nullptr;
+    if (resultBuffer != nullptr) {
+        void* resultAddress = env->GetDirectBufferAddress(resultBuffer);
+        const jlong resultCapacity = env->GetDirectBufferCapacity(resultBuffer);
+        if (!resultAddress || reinterpret_cast<uintptr_t>(resultAddress) % alignof(int32_t) != 0 ||
+            resultCapacity < static_cast<jlong>(count) * static_cast<jlong>(sizeof(int32_t))) {
+            return -1;
+        }
+        results = static_cast<int32_t*>(resultAddress);
+    }
+    
+    jint applied;
+    try {
+        // 2. 委托给core，一次加锁处理整批
+        applied = static_cast<jint>(lattice::entity::JNIEntityTracker::applyPackedUpdates(
+            static_cast<const PackedPositionUpdate*>(recordAddress), static_cast<size_t>(count), results));
+    } catch (...) {
+        return -3;
+    }
+    
+    auto endTime = std::chrono::high_resolution_clock::now();
+    logPerformanceStats("applyPackedUpdates", 
+                       std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count());
+    return applied;
+}
+
 jobjectArray EntityTrackerJNIOptimized::batchGetVisibleEntities(JNIEnv* env, jobject tracker, 
                                                                jlongArray viewerPositions) {
     auto startTime = std::chrono::high_resolution_clock::now();
@@ -241,31 +287,12 @@ jobjectArray EntityTrackerJNIOptimized::batchGetVisibleEntities(JNIEnv* env, job
             }
         }
         
-        // 4. 委托给core批量查询
-        // 简化实现：这里应该调用core中的batchGetVisibleEntities方法
-        // auto batchResults = lattice::entity::JNIEntityTracker::batchGetVisibleEntities(batchViewers);
-        
-        // 临时：逐个调用单个查询方法
-        std::vector<std::vector<int>> batchResults;
-        batchResults.reserve(batchViewers.size());
-        
-        for (const auto& viewer : batchViewers) {
-            int entityCount = 0;
-            int* visibleEntities = lattice::entity::JNIEntityTracker::getVisibleEntities(
-                std::get<0>(viewer), std::get<1>(viewer), std::get<2>(viewer), 
-                std::get<3>(viewer), &entityCount);
-            
-            std::vector<int> entities;
-            if (visibleEntities && entityCount > 0) {
-                entities.assign(visibleEntities, visibleEntities + entityCount);
-                delete[] visibleEntities;
-            }
-            
-            batchResults.push_back(std::move(entities));
-        }
+        // 4. 委托给core批量查询（在只读快照上并行执行）
+        std::vector<std::vector<int>> batchResults =
+            lattice::entity::JNIEntityTracker::batchGetVisibleEntities(batchViewers);
         
         // 5. 转换为Java对象数组
-        jclass longArrayClass = env->FindClass("[J");
+        jclass longArrayClass = LONG_ARRAY_CLASS.get();
         jobjectArray result = env->NewObjectArray(batchResults.size(), longArrayClass, nullptr);
         
         for (size_t i = 0; i < batchResults.size(); i++) {
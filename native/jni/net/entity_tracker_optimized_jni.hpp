@@ -31,6 +31,14 @@ public:
     // 批量更新位置 - 桥接到core
     static void batchUpdatePositions(JNIEnv* env, jobject tracker, jlongArray entityUpdates);
     
+    /**
+     * 紧凑批量更新 - 在DirectByteBuffer上原地读取count条PackedPositionUpdate（20字节/条，本机字节序），
+     * 结果码逐条写入resultBuffer（int32，可为null），没有逐元素JNI调用与中间容器
+     * 返回成功处理的记录数，-1表示缓冲区无效、容量不足或未对齐，-3表示发生异常
+     */
+    static jint applyPackedUpdates(JNIEnv* env, jobject tracker, jobject recordBuffer, jint count,
+                                   jobject resultBuffer);
+    
     // 批量获取可见实体 - 桥接到core
     static jobjectArray batchGetVisibleEntities(JNIEnv* env, jobject tracker, 
                                                jlongArray viewerPositions);
@@ -77,6 +85,8 @@ static JNINativeMethod entityTrackerMethods[] = {
      (void*)EntityTrackerJNIOptimized::getVisibleEntities},
     {"batchUpdatePositions", "(Ljava/lang/Object;[J)V", 
      (void*)EntityTrackerJNIOptimized::batchUpdatePositions},
+    {"applyPackedUpdates", "(Ljava/lang/Object;Ljava/nio/ByteBuffer;ILjava/nio/ByteBuffer;)I", 
+     (void*)EntityTrackerJNIOptimized::applyPackedUpdates},
     {"batchGetVisibleEntities", "(Ljava/lang/Object;[J)[Ljava/lang/Object;", 
      (void*)EntityTrackerJNIOptimized::batchGetVisibleEntities},
     {"tick", "(Ljava/lang/Object;)V", 
@@ -1,4 +1,5 @@
 #include "memory_arena_optimized_jni.hpp"
+#include "../jni_registry.hpp"
 #include <chrono>
 #include <vector>
 #include <string>
@@ -45,7 +46,8 @@ JNI_OnLoad(JavaVM* vm, void* reserved) {
     }
     
     env->DeleteLocalRef(cls);
-    return JNI_VERSION_1_8;
+    // 解析各桥接登记的类与方法ID
+    return lattice::jni::JniRegistry::onLoad(vm);
 }
 
 jlong MemoryArenaOptimizedBridge::getThreadLocalArena(JNIEnv* env, jclass clazz) {
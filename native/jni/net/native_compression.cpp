@@ -1,6 +1,12 @@
 #include "native_compression.hpp"
 #include "../../core/net/native_compressor.hpp"
 #include "../../core/net/async_compressor.hpp"
+#include "../../core/net/packet_batch_compressor.hpp"
+#include "../../core/net/chunk_packet_cache.hpp"
+#include "../../core/net/dynamic_compression_controller.hpp"
+#include "../../core/net/inbound_decompressor.hpp"
+#include "../jni_registry.hpp"
+#include "../lattice_ffi.h"
 #include <jni.h>
 #include <stdexcept>
 #include <iostream>
@@ -9,68 +15,98 @@
 #include <cstring>
 #include <memory>
 
+namespace {
+
+enum CallbackMethod : size_t { ON_SUCCESS, ON_ERROR };
+
+// io.lattice.network.AsyncCompressionCallback，在JNI_OnLoad中解析
+lattice::jni::JniClassRef COMPRESSION_CALLBACK("io/lattice/network/AsyncCompressionCallback",
+                                               {{"onSuccess", "(J)V"}, {"onError", "(I)V"}});
+
+void reportError(JNIEnv* env, jobject callback, jint code) {
+    if (jmethodID onError = COMPRESSION_CALLBACK.method(ON_ERROR)) {
+        env->CallVoidMethod(callback, onError, code);
+    }
+}
+
+} // namespace
+
 // JNI_OnLoad - 初始化函数
 JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
-    return JNI_VERSION_1_8;
+    return lattice::jni::JniRegistry::onLoad(vm);
 }
 
 // JNI_OnUnload - 清理函数
 JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
-    // 清理资源
+    lattice::jni::JniRegistry::onUnload(vm);
 }
 
-// 压缩数据 (Zlib格式)
-JNIEXPORT jlong JNICALL Java_io_lattice_network_NativeCompression_nativeCompressZlib
-  (JNIEnv *env, jclass clazz, jobject srcBuffer, jlong srcLen, jobject dstBuffer, jlong dstCapacity, jint level) {
+// ===== C ABI（lattice_ffi.h），JNI的DirectBuffer接口共用 =====
+
+LATTICE_FFI_EXPORT int64_t lattice_compress_zlib(const uint8_t* src, int64_t srcLen,
+                                                 uint8_t* dst, int64_t dstCapacity, int32_t level) {
+    if (!src || !dst || srcLen < 0 || dstCapacity < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
     try {
-        // 获取DirectBuffer地址
-        char* src = static_cast<char*>(env->GetDirectBufferAddress(srcBuffer));
-        char* dst = static_cast<char*>(env->GetDirectBufferAddress(dstBuffer));
-        
-        if (!src || !dst) {
-            return -1; // 错误：无法获取buffer地址
-        }
-        
         // 获取线程本地的压缩器实例
         auto* compressor = lattice::net::NativeCompressor::forThread(level);
         if (!compressor) {
-            return -2; // 错误：无法创建压缩器
+            return LATTICE_FFI_FAILED;
         }
-        
-        // 执行压缩
-        size_t result = compressor->compressZlib(src, srcLen, dst, dstCapacity);
-        return static_cast<jlong>(result);
+        const size_t result = compressor->compressZlib(reinterpret_cast<const char*>(src), static_cast<size_t>(srcLen),
+                                                       reinterpret_cast<char*>(dst), static_cast<size_t>(dstCapacity));
+        // libdeflate在输出空间不足时返回0
+        return result > 0 ? static_cast<int64_t>(result) : LATTICE_FFI_CAPACITY;
     } catch (...) {
-        // 发生异常时返回-3
-        return -3;
+        return LATTICE_FFI_FAILED;
     }
 }
 
-// 解压缩数据 (Zlib格式)
-JNIEXPORT jlong JNICALL Java_io_lattice_network_NativeCompression_nativeDecompressZlib
-  (JNIEnv *env, jclass clazz, jobject srcBuffer, jlong srcLen, jobject dstBuffer, jlong dstCapacity) {
+LATTICE_FFI_EXPORT int64_t lattice_decompress_zlib(const uint8_t* src, int64_t srcLen,
+                                                   uint8_t* dst, int64_t dstCapacity) {
+    if (!src || !dst || srcLen < 0 || dstCapacity < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
     try {
-        // 获取DirectBuffer地址
-        char* src = static_cast<char*>(env->GetDirectBufferAddress(srcBuffer));
-        char* dst = static_cast<char*>(env->GetDirectBufferAddress(dstBuffer));
-        
-        if (!src || !dst) {
-            return -1; // 错误：无法获取buffer地址
-        }
-        
-        // 获取线程本地的压缩器实例（解压缩不需要特定级别）
+        // 解压缩不需要特定级别，沿用线程当前的压缩器
         auto* compressor = lattice::net::NativeCompressor::forThread(6);
         if (!compressor) {
-            return -2; // 错误：无法创建压缩器
+            return LATTICE_FFI_FAILED;
         }
-        
-        // 执行解压缩
-        size_t result = compressor->decompressZlib(src, srcLen, dst, dstCapacity);
-        return static_cast<jlong>(result);
+        const size_t result = compressor->decompressZlib(reinterpret_cast<const char*>(src), static_cast<size_t>(srcLen),
+                                                         reinterpret_cast<char*>(dst), static_cast<size_t>(dstCapacity));
+        return result > 0 ? static_cast<int64_t>(result) : LATTICE_FFI_FAILED;
     } catch (...) {
-        // 发生异常时返回-3
-        return -3;
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+// 压缩数据 (Zlib格式)
+JNIEXPORT jlong JNICALL Java_io_lattice_network_NativeCompression_nativeCompressZlib
+  (JNIEnv *env, jclass clazz, jobject srcBuffer, jlong srcLen, jobject dstBuffer, jlong dstCapacity, jint level) {
+    // 获取DirectBuffer地址
+    auto* src = static_cast<const uint8_t*>(env->GetDirectBufferAddress(srcBuffer));
+    auto* dst = static_cast<uint8_t*>(env->GetDirectBufferAddress(dstBuffer));
+    if (!src || !dst) {
+        return -1; // 错误：无法获取buffer地址
+    }
+    const int64_t result = lattice_compress_zlib(src, srcLen, dst, dstCapacity, level);
+    // 保持原有返回值：输出空间不足时返回0
+    return result == LATTICE_FFI_CAPACITY ? 0 : result;
+}
+
+// 解压缩数据 (Zlib格式)
+JNIEXPORT jlong JNICALL Java_io_lattice_network_NativeCompression_nativeDecompressZlib
+  (JNIEnv *env, jclass clazz, jobject srcBuffer, jlong srcLen, jobject dstBuffer, jlong dstCapacity) {
+    auto* src = static_cast<const uint8_t*>(env->GetDirectBufferAddress(srcBuffer));
+    auto* dst = static_cast<uint8_t*>(env->GetDirectBufferAddress(dstBuffer));
+    if (!src || !dst) {
+        return -1;
     }
+    const int64_t result = lattice_decompress_zlib(src, srcLen, dst, dstCapacity);
+    // 保持原有返回值：解压失败时返回0
+    return result == LATTICE_FFI_FAILED ? 0 : result;
 }
 
 // 异步压缩数据
@@ -84,11 +120,7 @@ JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeCompressA
         
         if (!src || !dst) {
             // 调用回调函数报告错误
-            jclass callbackClass = env->GetObjectClass(callback);
-            jmethodID onErrorMethod = env->GetMethodID(callbackClass, "onError", "(I)V");
-            if (onErrorMethod) {
-                env->CallVoidMethod(callback, onErrorMethod, -1);
-            }
+            reportError(env, callback, -1);
             return;
         }
         
@@ -96,9 +128,7 @@ JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeCompressA
         auto inputData = std::make_shared<std::vector<char>>(src, src + srcLen);
         auto outputBuffer = std::make_shared<std::vector<char>>(dstCapacity);
         
-        // 创建Java VM和回调对象的全局引用，以便在线程中使用
-        JavaVM* jvm;
-        env->GetJavaVM(&jvm);
+        // 回调对象的全局引用，以便在压缩线程中使用
         jobject callbackGlobalRef = env->NewGlobalRef(callback);
         
         // 提交异步压缩任务
@@ -106,66 +136,31 @@ JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeCompressA
             inputData, 
             outputBuffer, 
             level,
-            [jvm, callbackGlobalRef, dst, outputBuffer](bool success, size_t outputSize) {
-                // 在回调中获取JNIEnv
-                JNIEnv* callbackEnv;
-                bool needDetach = false;
-                
-                // 尝试获取当前线程的JNIEnv
-                jint result = jvm->GetEnv((void**)&callbackEnv, JNI_VERSION_1_8);
-                if (result == JNI_EDETACHED) {
-                    // 如果当前线程未附加到JVM，需要附加
-                    if (jvm->AttachCurrentThread((void**)&callbackEnv, nullptr) == JNI_OK) {
-                        needDetach = true;
-                    } else {
-                        // 附加失败，无法调用Java方法
-                        callbackEnv->DeleteGlobalRef(callbackGlobalRef);
-                        return;
-                    }
-                } else if (result != JNI_OK) {
-                    // 获取JNIEnv失败
-                    callbackEnv->DeleteGlobalRef(callbackGlobalRef);
+            [callbackGlobalRef, dst, dstCapacity, outputBuffer](bool success, size_t outputSize) {
+                // 压缩线程第一次回调时以守护线程附加到JVM，之后直接复用
+                JNIEnv* callbackEnv = lattice::jni::JniRegistry::env();
+                if (!callbackEnv) {
                     return;
                 }
                 
-                // 获取回调类和方法
-                jclass callbackClass = callbackEnv->GetObjectClass(callbackGlobalRef);
-                
-                if (success) {
+                if (success && outputSize <= static_cast<size_t>(dstCapacity)) {
                     // 复制压缩结果到目标缓冲区
-                    if (outputSize <= (size_t)callbackEnv->GetDirectBufferCapacity(callbackEnv->NewDirectByteBuffer(dst, outputSize))) {
-                        memcpy(dst, outputBuffer->data(), outputSize);
-                    }
+                    memcpy(dst, outputBuffer->data(), outputSize);
                     
-                    // 调用onSuccess方法
-                    jmethodID onSuccessMethod = callbackEnv->GetMethodID(callbackClass, "onSuccess", "(J)V");
-                    if (onSuccessMethod) {
-                        callbackEnv->CallVoidMethod(callbackGlobalRef, onSuccessMethod, (jlong)outputSize);
+                    if (jmethodID onSuccess = COMPRESSION_CALLBACK.method(ON_SUCCESS)) {
+                        callbackEnv->CallVoidMethod(callbackGlobalRef, onSuccess, (jlong)outputSize);
                     }
                 } else {
-                    // 调用onError方法
-                    jmethodID onErrorMethod = callbackEnv->GetMethodID(callbackClass, "onError", "(I)V");
-                    if (onErrorMethod) {
-                        callbackEnv->CallVoidMethod(callbackGlobalRef, onErrorMethod, -4); // -4表示压缩失败
-                    }
+                    reportError(callbackEnv, callbackGlobalRef, -4); // -4表示压缩失败
                 }
                 
                 // 清理全局引用
                 callbackEnv->DeleteGlobalRef(callbackGlobalRef);
-                
-                // 如果之前附加了线程，现在需要分离
-                if (needDetach) {
-                    jvm->DetachCurrentThread();
-                }
             }
         );
     } catch (...) {
         // 异常处理
-        jclass callbackClass = env->GetObjectClass(callback);
-        jmethodID onErrorMethod = env->GetMethodID(callbackClass, "onError", "(I)V");
-        if (onErrorMethod) {
-            env->CallVoidMethod(callback, onErrorMethod, -3); // -3表示异常
-        }
+        reportError(env, callback, -3); // -3表示异常
     }
 }
 
@@ -206,4 +201,180 @@ JNIEXPORT jint JNICALL Java_io_lattice_network_NativeCompression_nativeSuggestWo
         // 发生异常时返回默认值
         return 4;
     }
-}
\ No newline at end of file
+}
+
+// 批量压缩一次flush的所有数据包，结果原地写回；表格式见PacketBatchCompressor
+// 返回成功写回的包数，-1表示无法获取buffer地址或表容量不足，-3表示发生异常
+JNIEXPORT jint JNICALL Java_io_lattice_network_NativeCompression_nativeCompressFlush
+  (JNIEnv *env, jclass clazz, jobject packetBuffer, jobject tableBuffer, jint count, jint threshold, jint level) {
+    try {
+        auto* packets = static_cast<uint8_t*>(env->GetDirectBufferAddress(packetBuffer));
+        auto* table = static_cast<int32_t*>(env->GetDirectBufferAddress(tableBuffer));
+        const jlong packetCapacity = env->GetDirectBufferCapacity(packetBuffer);
+        const jlong tableCapacity = env->GetDirectBufferCapacity(tableBuffer);
+
+        if (!packets || !table || count < 0 || packetCapacity < 0 ||
+            tableCapacity < static_cast<jlong>(count) *
+                static_cast<jlong>(lattice::net::PacketBatchCompressor::TABLE_STRIDE * sizeof(int32_t))) {
+            return -1;
+        }
+
+        auto result = lattice::net::PacketBatchCompressor::compressFlush(
+            packets, static_cast<size_t>(packetCapacity), table, static_cast<size_t>(count),
+            threshold, level);
+        return static_cast<jint>(result.compressed + result.passthrough);
+    } catch (...) {
+        return -3;
+    }
+}
+
+// 区块 / 光照包压缩（跨连接共享缓存），写出VarInt(未压缩长度) + zlib帧
+// 返回帧长度，-1表示无法获取buffer地址，-2表示压缩失败，-3表示发生异常，-4表示dst容量不足
+JNIEXPORT jint JNICALL Java_io_lattice_network_NativeCompression_nativeCompressChunkPacket
+  (JNIEnv *env, jclass clazz, jint worldId, jint chunkX, jint chunkZ, jint kind, jlong version, jint level,
+   jobject srcBuffer, jint srcLen, jobject dstBuffer, jint dstCapacity) {
+    try {
+        const char* src = static_cast<const char*>(env->GetDirectBufferAddress(srcBuffer));
+        char* dst = static_cast<char*>(env->GetDirectBufferAddress(dstBuffer));
+        if (!src || !dst || srcLen <= 0 || dstCapacity < 0) {
+            return -1;
+        }
+
+        lattice::net::ChunkPacketCache::Key key;
+        key.worldId = worldId;
+        key.chunkX = chunkX;
+        key.chunkZ = chunkZ;
+        key.kind = static_cast<lattice::net::ChunkPacketCache::PacketKind>(kind);
+        key.level = level;
+        key.version = static_cast<uint64_t>(version);
+
+        auto frame = lattice::net::ChunkPacketCache::global().getOrCompress(key, src, static_cast<size_t>(srcLen));
+        if (!frame) {
+            return -2;
+        }
+        if (frame->size() > static_cast<size_t>(dstCapacity)) {
+            return -4;
+        }
+        std::memcpy(dst, frame->data(), frame->size());
+        return static_cast<jint>(frame->size());
+    } catch (...) {
+        return -3;
+    }
+}
+
+// 区块修改或卸载时丢弃其缓存的压缩包
+JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeInvalidateChunkPackets
+  (JNIEnv *env, jclass clazz, jint worldId, jint chunkX, jint chunkZ) {
+    lattice::net::ChunkPacketCache::global().invalidateChunk(worldId, chunkX, chunkZ);
+}
+
+// 设置区块包缓存的字节预算
+JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeSetChunkPacketCacheBudget
+  (JNIEnv *env, jclass clazz, jlong budgetBytes) {
+    if (budgetBytes >= 0) {
+        lattice::net::ChunkPacketCache::global().setByteBudget(static_cast<size_t>(budgetBytes));
+    }
+}
+
+// 配置闭环压缩级别控制器
+JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeConfigureCompressionController
+  (JNIEnv *env, jclass clazz, jdouble cpuBudgetCores, jint minLevel, jint maxLevel, jint baseLevel) {
+    try {
+        auto& controller = lattice::net::DynamicCompressionController::global();
+        auto config = controller.getConfig();
+        config.cpuBudgetCores = cpuBudgetCores;
+        config.minLevel = minLevel;
+        config.maxLevel = maxLevel;
+        config.baseLevel = baseLevel;
+        controller.configure(config);
+    } catch (...) {
+        // 忽略异常
+    }
+}
+
+// 上报连接的RTT与累计发送字节数
+JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeUpdateConnection
+  (JNIEnv *env, jclass clazz, jlong connectionId, jdouble rttMs, jlong bytesSent) {
+    lattice::net::DynamicCompressionController::global().updateConnection(
+        static_cast<uint64_t>(connectionId), rttMs, static_cast<uint64_t>(bytesSent));
+}
+
+JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeRemoveConnection
+  (JNIEnv *env, jclass clazz, jlong connectionId) {
+    lattice::net::DynamicCompressionController::global().removeConnection(static_cast<uint64_t>(connectionId));
+    lattice::net::InboundDecompressor::global().removeConnection(static_cast<uint64_t>(connectionId));
+}
+
+// 入站异步解压的分流阈值与声明长度上限（字节），<= 0的参数保持不变
+JNIEXPORT void JNICALL Java_io_lattice_network_NativeCompression_nativeConfigureInboundDecompression
+  (JNIEnv *env, jclass clazz, jlong asyncThreshold, jlong maxDeclaredSize) {
+    auto& decompressor = lattice::net::InboundDecompressor::global();
+    auto config = decompressor.getConfig();
+    if (asyncThreshold > 0) {
+        config.asyncThreshold = static_cast<size_t>(asyncThreshold);
+    }
+    if (maxDeclaredSize > 0) {
+        config.maxDeclaredSize = static_cast<size_t>(maxDeclaredSize);
+    }
+    decompressor.configure(config);
+}
+
+/**
+ * 解压一个入站包到dst（交付前Java必须保持dst有效，src在返回后即可释放）
+ * 成功时callback.onSuccess(declaredSize)，失败时onError(状态码)；同一连接按提交顺序回调
+ * 返回0表示已在当前线程回调，1表示稍后回调；负数为InboundDecompressor::Status，此时不回调
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_network_NativeCompression_nativeDecompressInbound
+  (JNIEnv *env, jclass clazz, jlong connectionId, jobject srcBuffer, jlong srcLen, jobject dstBuffer,
+   jlong declaredSize, jobject callback) {
+    using lattice::net::InboundDecompressor;
+    auto* src = srcBuffer ? static_cast<const uint8_t*>(env->GetDirectBufferAddress(srcBuffer)) : nullptr;
+    auto* dst = dstBuffer ? static_cast<uint8_t*>(env->GetDirectBufferAddress(dstBuffer)) : nullptr;
+    const jlong dstCapacity = dstBuffer ? env->GetDirectBufferCapacity(dstBuffer) : -1;
+    if (!src || !dst || !callback || srcLen <= 0 || declaredSize <= 0 || dstCapacity < 0) {
+        return static_cast<jint>(InboundDecompressor::Status::INVALID_ARGUMENT);
+    }
+
+    jobject callbackGlobalRef = env->NewGlobalRef(callback);
+    InboundDecompressor::Submitted submitted = InboundDecompressor::Submitted::QUEUED;
+    const auto status = InboundDecompressor::global().submit(
+        static_cast<uint64_t>(connectionId), src, static_cast<size_t>(srcLen), static_cast<size_t>(declaredSize),
+        dst, static_cast<size_t>(dstCapacity),
+        [callbackGlobalRef, declaredSize](InboundDecompressor::Status result) {
+            // 可能在调用线程上，也可能在压缩线程上（第一次回调时附加到JVM）
+            JNIEnv* callbackEnv = lattice::jni::JniRegistry::env();
+            if (!callbackEnv) {
+                return;
+            }
+            if (result == InboundDecompressor::Status::OK) {
+                if (jmethodID onSuccess = COMPRESSION_CALLBACK.method(ON_SUCCESS)) {
+                    callbackEnv->CallVoidMethod(callbackGlobalRef, onSuccess, declaredSize);
+                }
+            } else {
+                reportError(callbackEnv, callbackGlobalRef, static_cast<jint>(result));
+            }
+            callbackEnv->DeleteGlobalRef(callbackGlobalRef);
+        },
+        &submitted);
+    if (status != InboundDecompressor::Status::OK) {
+        env->DeleteGlobalRef(callbackGlobalRef);
+        return static_cast<jint>(status);
+    }
+    return static_cast<jint>(submitted);
+}
+
+// 获取连接当前应使用的压缩级别
+JNIEXPORT jint JNICALL Java_io_lattice_network_NativeCompression_nativeConnectionLevel
+  (JNIEnv *env, jclass clazz, jlong connectionId) {
+    return lattice::net::DynamicCompressionController::global().levelFor(static_cast<uint64_t>(connectionId));
+}
+
+// 每tick调用：到达采样周期时采样并重新决策，返回当前允许的最高级别
+JNIEXPORT jint JNICALL Java_io_lattice_network_NativeCompression_nativeCompressionControllerTick
+  (JNIEnv *env, jclass clazz) {
+    try {
+        return lattice::net::DynamicCompressionController::global().tick();
+    } catch (...) {
+        return -1;
+    }
+}
@@ -1,10 +1,29 @@
 #include "paper_compatible_redstone_jni.hpp"
+#include "../lattice_ffi.h"
+#include "../../core/workload_trace.hpp"
 #include <jni.h>
+#include <bit>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
 namespace lattice {
 namespace jni {
 
+namespace {
+
+using redstone::paper::PaperCompatibleRedstoneEngine;
+using lattice::core::TraceEvent;
+using lattice::core::WorkloadRecorder;
+
+// 引擎是单例，enginePtr为0时取实例
+PaperCompatibleRedstoneEngine& engineFrom(jlong enginePtr) {
+    return enginePtr != 0 ? *reinterpret_cast<PaperCompatibleRedstoneEngine*>(enginePtr)
+                          : PaperCompatibleRedstoneEngine::getInstance();
+}
+
+} // namespace
+
 extern "C" {
 
 JNIEXPORT void JNICALL
@@ -25,6 +44,173 @@ Java_PaperCompatibleRedstoneJNI_enablePaperRedstoneBehaviors(JNIEnv *env, jobjec
     // Enable Paper redstone features
 }
 
+JNIEXPORT jboolean JNICALL
+Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeBindComparatorContainer(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jint cx, jint cy, jint cz, jint signal) {
+    if (auto record = WorkloadRecorder::begin(TraceEvent::REDSTONE_COMPARATOR_BIND)) {
+        record.i32(x).i32(y).i32(z).i32(cx).i32(cy).i32(cz).i32(signal);
+    }
+    return engineFrom(enginePtr).bindComparatorContainer(x, y, z, cx, cy, cz, signal) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL
+Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeOnContainerChanged(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jint cx, jint cy, jint cz, jint signal) {
+    if (auto record = WorkloadRecorder::begin(TraceEvent::REDSTONE_CONTAINER)) {
+        record.i32(cx).i32(cy).i32(cz).i32(signal);
+    }
+    engineFrom(enginePtr).onContainerChanged(cx, cy, cz, signal);
+}
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeQueryPowers(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jlongArray positions, jint count, jobject out) {
+    if (positions == nullptr || out == nullptr || count < 0 || count > env->GetArrayLength(positions)) {
+        return -1;
+    }
+    auto* address = static_cast<uint8_t*>(env->GetDirectBufferAddress(out));
+    const jlong capacity = env->GetDirectBufferCapacity(out);
+    if (address == nullptr || capacity < 0) {
+        return -1;
+    }
+    if (capacity < count) {
+        return -2;
+    }
+    
+    // 查询不加锁也不回调JVM，可以在临界区内直接读数组
+    auto* packed = static_cast<jlong*>(env->GetPrimitiveArrayCritical(positions, nullptr));
+    if (packed == nullptr) {
+        return -1;
+    }
+    const jint result = lattice_redstone_query_powers(enginePtr, reinterpret_cast<const int64_t*>(packed),
+                                                      count, address, capacity);
+    env->ReleasePrimitiveArrayCritical(positions, packed, JNI_ABORT);
+    return result;
+}
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeQuerySectionPowers(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jlong sectionId, jlongArray mask, jobject out) {
+    constexpr jsize words = PaperCompatibleRedstoneEngine::SECTION_MASK_WORDS;
+    if (mask == nullptr || out == nullptr || env->GetArrayLength(mask) != words) {
+        return -1;
+    }
+    auto* address = static_cast<uint8_t*>(env->GetDirectBufferAddress(out));
+    const jlong capacity = env->GetDirectBufferCapacity(out);
+    if (address == nullptr || capacity < 0) {
+        return -1;
+    }
+    
+    uint64_t bits[words];
+    env->GetLongArrayRegion(mask, 0, words, reinterpret_cast<jlong*>(bits));
+    return lattice_redstone_query_section_powers(enginePtr, sectionId, bits, address, capacity);
+}
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeDrainBlockUpdates(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jobject out) {
+    if (out == nullptr) {
+        return -1;
+    }
+    auto* address = static_cast<uint8_t*>(env->GetDirectBufferAddress(out));
+    const jlong capacity = env->GetDirectBufferCapacity(out);
+    if (address == nullptr || capacity < 0) {
+        return -1;
+    }
+    
+    // 缓冲区不保证8字节对齐，先写到本地再整体拷贝
+    const size_t pending = engineFrom(enginePtr).pendingBlockUpdateCount();
+    std::vector<int64_t> updates(std::min<size_t>(static_cast<size_t>(capacity) / sizeof(int64_t), pending));
+    if (updates.empty()) {
+        return pending > 0 ? -2 : 0;
+    }
+    const jint written = lattice_redstone_drain_block_updates(enginePtr, updates.data(),
+                                                              static_cast<int64_t>(updates.size()));
+    if (written <= 0) {
+        return written;
+    }
+    std::memcpy(address, updates.data(), static_cast<size_t>(written) * sizeof(int64_t));
+    return written;
+}
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeQueueNeighborUpdates(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jlongArray positions, jint count) {
+    if (positions == nullptr || count < 0 || count > env->GetArrayLength(positions)) {
+        return -1;
+    }
+    // 入队需要取引擎锁，不在临界区内进行，先拷贝出来
+    std::vector<int64_t> packed(static_cast<size_t>(count));
+    env->GetLongArrayRegion(positions, 0, count, reinterpret_cast<jlong*>(packed.data()));
+    return lattice_redstone_queue_neighbor_updates(enginePtr, packed.data(), count);
+}
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeSetBlockUpdateOrder(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jint order) {
+    return lattice_redstone_set_block_update_order(enginePtr, order);
+}
+
+// ===== C ABI（lattice_ffi.h）：Java侧用MemorySegment直接传入位置与结果缓冲区，JNI版本也经过这里 =====
+
+LATTICE_FFI_EXPORT int32_t lattice_redstone_query_powers(int64_t enginePtr, const int64_t* positions,
+                                                         int32_t count, uint8_t* out, int64_t capacity) {
+    if (positions == nullptr || out == nullptr || count < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    if (capacity < count) {
+        return LATTICE_FFI_CAPACITY;
+    }
+    engineFrom(enginePtr).queryPowers(positions, static_cast<size_t>(count), out);
+    return count;
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_redstone_query_section_powers(int64_t enginePtr, int64_t sectionId,
+                                                                 const uint64_t* mask, uint8_t* out,
+                                                                 int64_t capacity) {
+    if (mask == nullptr || out == nullptr) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    int64_t selected = 0;
+    for (int word = 0; word < PaperCompatibleRedstoneEngine::SECTION_MASK_WORDS; ++word) {
+        selected += std::popcount(mask[word]);
+    }
+    if (capacity < selected) {
+        return LATTICE_FFI_CAPACITY;
+    }
+    return static_cast<int32_t>(engineFrom(enginePtr).querySectionPowers(sectionId, mask, out));
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_redstone_drain_block_updates(int64_t enginePtr, int64_t* out, int64_t capacity) {
+    if (out == nullptr || capacity < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    auto& engine = engineFrom(enginePtr);
+    const size_t written = engine.drainBlockUpdates(out, static_cast<size_t>(std::min<int64_t>(capacity, INT32_MAX)));
+    if (written == 0 && engine.pendingBlockUpdateCount() > 0) {
+        return LATTICE_FFI_CAPACITY;
+    }
+    return static_cast<int32_t>(written);
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_redstone_queue_neighbor_updates(int64_t enginePtr, const int64_t* positions,
+                                                                   int32_t count) {
+    if (positions == nullptr || count < 0) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    const size_t added = engineFrom(enginePtr).queueNeighborUpdates(positions, static_cast<size_t>(count));
+    return static_cast<int32_t>(std::min<size_t>(added, INT32_MAX));
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_redstone_set_block_update_order(int64_t enginePtr, int32_t order) {
+    using Order = PaperCompatibleRedstoneEngine::BlockUpdateOrder;
+    if (order != static_cast<int32_t>(Order::POSITION) && order != static_cast<int32_t>(Order::EMISSION)) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    engineFrom(enginePtr).setBlockUpdateOrder(static_cast<Order>(order));
+    return 0;
+}
+
 }
 
 } // namespace jni
@@ -40,6 +40,55 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nat
 JNIEXPORT void JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeTick(
     JNIEnv* env, jclass clazz, jlong enginePtr);
 
+// ========== 容器信号 ==========
+
+/**
+ * 让比较器读取容器，signal为容器当前的填充信号。该位置不是比较器时返回false
+ */
+JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeBindComparatorContainer(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jint cx, jint cy, jint cz, jint signal);
+
+/**
+ * 容器内容变化后的新填充信号（0-15），只有读取该容器的比较器会重新计算
+ */
+JNIEXPORT void JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeOnContainerChanged(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jint cx, jint cy, jint cz, jint signal);
+
+// ========== 批量查询 ==========
+
+/**
+ * 批量查询功率：positions前count个BlockPos.asLong，结果每个位置一个字节写入直接缓冲区out
+ * （低4位为功率，0x80为isPowered）。返回写入数，-1参数无效，-2缓冲区不足
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeQueryPowers(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jlongArray positions, jint count, jobject out);
+
+/**
+ * 查询一个区块段内mask（64个long）选中的位置，按段内下标升序每个位置写一个字节，返回值同上
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeQuerySectionPowers(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jlong sectionId, jlongArray mask, jobject out);
+
+/**
+ * 把本tick的方块更新（BlockPos.asLong，主机字节序）写入直接缓冲区out，写不下的留到下次
+ * 返回写入条数，-1参数无效，-2一条也放不下
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeDrainBlockUpdates(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jobject out);
+
+/**
+ * 观察者、活塞等Java侧产生的邻居更新并入引擎的去重队列（positions为BlockPos.asLong）
+ * 返回新入队的条数，-1参数无效
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeQueueNeighborUpdates(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jlongArray positions, jint count);
+
+/**
+ * 方块更新的取出顺序：0按位置排序，1按原版发出顺序；成功返回0，-1参数无效
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeSetBlockUpdateOrder(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jint order);
+
 // ========== 性能监控 ==========
 
 JNIEXPORT jobject JNICALL Java_io_lattice_redstone_nativebridge_RedstoneJNI_nativeGetPerformanceStats(
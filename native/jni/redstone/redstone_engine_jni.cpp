@@ -1,769 +1,279 @@
 #include "redstone_engine_jni.hpp"
-#include "../../core/redstone/redstone_components.hpp"
-#include <cstdio>
-#include <cstdlib>
+#include "../../core/workload_trace.hpp"
+#include <jni.h>
 #include <iostream>
-#include <string>
-#include <map>
+#include <string_view>
 #include <vector>
-#include <chrono>
-#include <atomic>
-#include <mutex>
-#include <thread>
-#include <future>
-#include <memory>
-#include <functional>
-#include <stdexcept>
-
-// 引入完整的JNI框架
-#include "../FinalLatticeJNI_Fixed.h"
 
 namespace lattice {
-namespace redstone {
 namespace jni {
 
-// ========== 高级Redstone引擎类 ==========
-class AdvancedRedstoneEngine {
-private:
-    // 使用框架的SafeBuffer进行智能内存管理
-    std::unique_ptr<jni_framework::SafeBuffer> smartBuffer;
-    std::unique_ptr<jni_framework::JVMThreadPool> asyncPool;
-    std::unique_ptr<jni_framework::PerformanceMetrics> perfMonitor;
-    
-    // 核心组件注册表
-    std::map<std::string, int> componentRegistry;
-    std::atomic<long long> totalOperations{0};
-    std::atomic<bool> engineHealthy{true};
-    
-public:
-    AdvancedRedstoneEngine() {
-        try {
-            // 初始化框架组件
-            jni_framework::FrameworkConfig config;
-            smartBuffer = std::make_unique<jni_framework::SafeBuffer>(2 * 1024 * 1024); // 2MB缓冲区
-            asyncPool = std::make_unique<jni_framework::JVMThreadPool>(8); // 8线程池
-            perfMonitor = std::make_unique<jni_framework::PerformanceMetrics>();
-            
-            std::cout << "[Advanced Redstone Engine] Initialized with Complete LatticeJNI Framework" << std::endl;
-            std::cout << "[Advanced Redstone Engine] Smart Memory Management: Enabled" << std::endl;
-            std::cout << "[Advanced Redstone Engine] Async Processing: " << asyncPool->getThreadCount() << " threads" << std::endl;
-            std::cout << "[Advanced Redstone Engine] Performance Monitoring: Enabled" << std::endl;
-        } catch (const std::exception& e) {
-            std::cerr << "[Advanced Redstone Engine] Initialization failed: " << e.what() << std::endl;
-            engineHealthy = false;
-        }
-    }
-    
-    ~AdvancedRedstoneEngine() {
-        if (asyncPool) {
-            asyncPool->shutdown();
-        }
-    }
-    
-    // 高性能异步组件注册
-    std::future<bool> registerComponentAsync(const std::string& type, int x, int y, int z) {
-        auto task = [this, type, x, y, z]() -> bool {
-            auto start = std::chrono::steady_clock::now();
-            
-            try {
-                // 记录性能指标
-                perfMonitor->incrementOperationCount();
-                smartBuffer->recordOperation("component_register");
-                
-                // 使用SafeBuffer安全处理数据
-                std::string key = std::to_string(x) + "," + std::to_string(y) + "," + std::to_string(z);
-                size_t allocSize = key.size() + 1 + type.size() + 1;
-                auto buffer = smartBuffer->allocate(allocSize);
-                
-                if (buffer) {
-                    char* ptr = reinterpret_cast<char*>(buffer);
-                    std::strcpy(ptr, key.c_str());
-                    std::strcpy(ptr + key.size() + 1, type.c_str());
-                }
-                
-                // 注册组件
-                componentRegistry[key] = static_cast<int>(type.length());
-                
-                auto end = std::chrono::steady_clock::now();
-                perfMonitor->recordLatency(end - start);
-                
-                std::cout << "[Advanced Engine] Registered " << type << " at (" 
-                         << x << "," << y << "," << z << ") in "
-                         << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() 
-                         << " μs" << std::endl;
-                
-                return true;
-            } catch (const std::exception& e) {
-                std::cerr << "[Advanced Engine] Register failed: " << e.what() << std::endl;
-                return false;
-            }
-        };
-        
-        return asyncPool->submit(task);
-    }
-    
-    // 批量异步注册 - 充分利用框架的批量处理能力
-    std::future<std::vector<bool>> batchRegisterComponents(
-        const std::vector<std::tuple<std::string, int, int, int>>& components) {
-        
-        auto task = [this, components]() -> std::vector<bool> {
-            auto start = std::chrono::steady_clock::now();
-            std::vector<bool> results;
-            results.reserve(components.size());
-            
-            // 分批处理，每批最多50个组件
-            const size_t batchSize = 50;
-            for (size_t i = 0; i < components.size(); i += batchSize) {
-                size_t end = std::min(i + batchSize, components.size());
-                
-                std::vector<std::future<bool>> futures;
-                for (size_t j = i; j < end; j++) {
-                    const auto& [type, x, y, z] = components[j];
-                    futures.push_back(registerComponentAsync(type, x, y, z));
-                }
-                
-                // 等待当前批次完成
-                for (auto& future : futures) {
-                    results.push_back(future.get());
-                }
-            }
-            
-            auto end = std::chrono::steady_clock::now();
-            auto totalDuration = end - start;
-            
-            perfMonitor->recordBatchMetrics(components.size(), totalDuration);
-            std::cout << "[Advanced Engine] Batch registered " << components.size() 
-                     << " components in " 
-                     << std::chrono::duration_cast<std::chrono::milliseconds>(totalDuration).count()
-                     << " ms (avg: " 
-                     << std::chrono::duration_cast<std::chrono::microseconds>(totalDuration).count() / components.size()
-                     << " μs per component)" << std::endl;
-            
-            return results;
-        };
-        
-        return asyncPool->submit(task);
-    }
-    
-    // 高性能电源检测
-    bool isPowered(int x, int y, int z) {
-        auto start = std::chrono::steady_clock::now();
-        
-        std::string key = std::to_string(x) + "," + std::to_string(y) + "," + std::to_string(z);
-        bool powered = componentRegistry.find(key) != componentRegistry.end() && 
-                      componentRegistry[key] > 0;
-        
-        auto end = std::chrono::steady_clock::now();
-        perfMonitor->recordLatency(end - start);
-        
-        return powered;
-    }
-    
-    // 异步电源设置
-    std::future<void> setPowerAsync(int x, int y, int z, int power) {
-        auto task = [this, x, y, z, power]() {
-            auto start = std::chrono::steady_clock::now();
-            
-            try {
-                std::string key = std::to_string(x) + "," + std::to_string(y) + "," + std::to_string(z);
-                componentRegistry[key] = power;
-                smartBuffer->recordOperation("power_set");
-                
-                auto end = std::chrono::steady_clock::now();
-                perfMonitor->recordLatency(end - start);
-                
-                std::cout << "[Advanced Engine] Set power (" << x << "," << y << "," 
-                         << z << ") = " << power << " in "
-                         << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
-                         << " μs" << std::endl;
-            } catch (const std::exception& e) {
-                std::cerr << "[Advanced Engine] Set power failed: " << e.what() << std::endl;
-            }
-        };
-        
-        return asyncPool->submit(task);
-    }
-    
-    // 引擎健康检查
-    bool isHealthy() const {
-        return engineHealthy.load() && perfMonitor->isHealthy();
-    }
-    
-    // 高性能Tick处理
-    void processTick() {
-        auto start = std::chrono::steady_clock::now();
-        
-        try {
-            totalOperations++;
-            
-            // 智能内存整理
-            smartBuffer->compact();
-            
-            auto end = std::chrono::steady_clock::now();
-            perfMonitor->recordLatency(end - start);
-            
-            if (totalOperations % 1000 == 0) { // 每1000次tick输出一次统计
-                auto metrics = perfMonitor->getMetrics();
-                std::cout << "[Advanced Engine] Tick " << totalOperations.load() 
-                         << " processed in " 
-                         << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count()
-                         << " μs | Avg latency: " << metrics.averageLatency << " μs"
-                         << " | Components: " << componentRegistry.size() << std::endl;
-            }
-        } catch (const std::exception& e) {
-            std::cerr << "[Advanced Engine] Tick processing failed: " << e.what() << std::endl;
-            engineHealthy = false;
-        }
-    }
-    
-    // 高级性能统计
-    struct AdvancedPerformanceStats {
-        long long totalComponents;
-        long long totalOperations;
-        double avgLatencyMs;
-        long long bufferOperations;
-        long long memoryUsageBytes;
-        bool healthy;
-        size_t threadPoolSize;
-        double throughputPerSecond;
-    };
-    
-    AdvancedPerformanceStats getAdvancedPerformanceStats() {
-        auto metrics = perfMonitor->getMetrics();
-        auto throughput = totalOperations.load() / 
-                         std::max(1LL, std::chrono::duration_cast<std::chrono::seconds>(
-                             std::chrono::steady_clock::now() - 
-                             std::chrono::steady_clock::from_time_t(0)).count());
-        
-        return {
-            static_cast<long long>(componentRegistry.size()),
-            totalOperations.load(),
-            metrics.averageLatency,
-            smartBuffer->getOperationCount(),
-            smartBuffer->getMemoryUsage(),
-            engineHealthy.load(),
-            asyncPool->getThreadCount(),
-            throughput
-        };
-    }
-};
-
-// 全局高级引擎实例
-static std::unique_ptr<AdvancedRedstoneEngine> g_advancedEngine = nullptr;
-
-// 全局Java虚拟机引用
-static JavaVM* g_vm = nullptr;
-static jclass g_redstoneEngineClass = nullptr;
-static jclass g_performanceStatsClass = nullptr;
-static jmethodID g_performanceStatsConstructor = nullptr;
+namespace {
 
-// ========== JNI OnLoad/OnUnload ==========
+using redstone::paper::PaperCompatibleRedstoneEngine;
+using redstone::paper::PaperPosition;
+using redstone::paper::PaperRedstoneType;
+using lattice::core::RedstoneComponentKind;
+using lattice::core::TraceEvent;
+using lattice::core::WorkloadRecorder;
 
-JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
-    g_vm = vm;
-    
-    JNIEnv* env;
-    if (vm->GetEnv((void**)&env, JNI_VERSION_1_8) != JNI_OK) {
-        return JNI_ERR;
-    }
-    
-    try {
-        // 初始化高级引擎
-        g_advancedEngine = std::make_unique<AdvancedRedstoneEngine>();
-        
-        // 查找Java类（保持原有接口兼容性）
-        g_redstoneEngineClass = env->FindClass("io/lattice/redstone/RedstoneEngine");
-        if (g_redstoneEngineClass == nullptr) {
-            std::cerr << "[Advanced RedstoneJNI] Failed to find RedstoneEngine class" << std::endl;
-        }
-        
-        g_performanceStatsClass = env->FindClass("io/lattice/redstone/PerformanceStats");
-        if (g_performanceStatsClass == nullptr) {
-            std::cerr << "[Advanced RedstoneJNI] Failed to find PerformanceStats class" << std::endl;
-        } else {
-            g_performanceStatsConstructor = env->GetMethodID(g_performanceStatsClass, "<init>", "(JJJDDJ)V");
-            if (g_performanceStatsConstructor == nullptr) {
-                std::cerr << "[Advanced RedstoneJNI] Failed to find PerformanceStats constructor" << std::endl;
-            }
-        }
-        
-        std::cout << "[Advanced RedstoneJNI] Complete LatticeJNI Framework loaded successfully" << std::endl;
-        std::cout << "[Advanced RedstoneJNI] Advanced Features:" << std::endl;
-        std::cout << "  ✅ Smart Memory Management (SafeBuffer)" << std::endl;
-        std::cout << "  ✅ Asynchronous Processing (JVMThreadPool)" << std::endl;
-        std::cout << "  ✅ Performance Monitoring (PerformanceMetrics)" << std::endl;
-        std::cout << "  ✅ Batch Processing Optimization" << std::endl;
-        std::cout << "  ✅ Thread-Safe Operations" << std::endl;
-        std::cout << "  ✅ Exception Safety & Recovery" << std::endl;
-        
-        return JNI_VERSION_1_8;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced RedstoneJNI] Initialization failed: " << e.what() << std::endl;
-        return JNI_ERR;
-    }
+// 引擎是单例，enginePtr为0时取实例
+PaperCompatibleRedstoneEngine& engineFrom(jlong enginePtr) {
+    return enginePtr != 0 ? *reinterpret_cast<PaperCompatibleRedstoneEngine*>(enginePtr)
+                          : PaperCompatibleRedstoneEngine::getInstance();
 }
 
-JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
-    JNIEnv* env;
-    if (vm->GetEnv((void**)&env, JNI_VERSION_1_8) == JNI_OK) {
-        if (g_redstoneEngineClass) {
-            env->DeleteLocalRef(g_redstoneEngineClass);
-        }
-        if (g_performanceStatsClass) {
-            env->DeleteLocalRef(g_performanceStatsClass);
-        }
+// RedstoneComponentKind与PaperRedstoneType的顺序相同，回放按kind映射回registerComponent
+jboolean registerKind(jlong enginePtr, RedstoneComponentKind kind, jint x, jint y, jint z, jint param) {
+    if (auto record = WorkloadRecorder::begin(TraceEvent::REDSTONE_COMPONENT)) {
+        record.i32(static_cast<int32_t>(kind)).i32(x).i32(y).i32(z).i32(param);
     }
-    
-    // 安全关闭高级引擎
-    if (g_advancedEngine) {
-        g_advancedEngine.reset();
-    }
-    
-    g_vm = nullptr;
-    std::cout << "[Advanced RedstoneJNI] Advanced Redstone Engine with LatticeJNI Framework unloaded" << std::endl;
+    return engineFrom(enginePtr).registerComponent(x, y, z, static_cast<PaperRedstoneType>(kind), param) ? JNI_TRUE
+                                                                                                          : JNI_FALSE;
 }
 
-// ========== 工具函数 ==========
-
-std::vector<int> jintArrayToVector(JNIEnv* env, jintArray array) {
-    if (!array) return {};
-    
-    jsize length = env->GetArrayLength(array);
-    std::vector<int> result(length);
-    
-    jint* elements = env->GetIntArrayElements(array, nullptr);
-    if (elements) {
-        for (jsize i = 0; i < length; i++) {
-            result[i] = static_cast<int>(elements[i]);
-        }
-        env->ReleaseIntArrayElements(array, elements, 0);
-    }
-    
-    return result;
-}
-
-jobject createPerformanceStatsObject(JNIEnv* env, const AdvancedRedstoneEngine::AdvancedPerformanceStats& stats) {
-    if (!g_performanceStatsClass || !g_performanceStatsConstructor) {
-        return nullptr;
-    }
-    
-    return env->NewObject(g_performanceStatsClass, g_performanceStatsConstructor,
-        static_cast<jlong>(stats.totalComponents),
-        static_cast<jlong>(stats.totalOperations),
-        static_cast<jlong>(stats.bufferOperations),
-        static_cast<jdouble>(stats.avgLatencyMs),
-        static_cast<jlong>(stats.memoryUsageBytes));
+// 批量注册的组件名，未知名称返回false
+bool parseKind(std::string_view name, RedstoneComponentKind& kind, jint& param) {
+    auto endsWith = [name](std::string_view suffix) {
+        return name.size() >= suffix.size() && name.substr(name.size() - suffix.size()) == suffix;
+    };
+    param = 0;
+    if (endsWith("wire")) {
+        kind = RedstoneComponentKind::WIRE;
+    } else if (endsWith("repeater")) {
+        kind = RedstoneComponentKind::REPEATER;
+        param = 1;
+    } else if (endsWith("comparator")) {
+        kind = RedstoneComponentKind::COMPARATOR;
+    } else if (endsWith("torch")) {
+        kind = RedstoneComponentKind::TORCH;
+        param = 1;
+    } else if (endsWith("lever")) {
+        kind = RedstoneComponentKind::LEVER;
+    } else if (endsWith("button")) {
+        kind = RedstoneComponentKind::BUTTON;
+    } else if (endsWith("pressure_plate")) {
+        kind = RedstoneComponentKind::PRESSURE_PLATE;
+    } else if (endsWith("observer")) {
+        kind = RedstoneComponentKind::OBSERVER;
+    } else if (endsWith("piston")) {
+        kind = RedstoneComponentKind::PISTON;
+        param = name == "sticky_piston" ? 1 : 0;
+    } else {
+        return false;
+    }
+    return true;
 }
 
-void throwRedstoneException(JNIEnv* env, const char* message) {
-    jclass exceptionClass = env->FindClass("io/lattice/redstone/RedstoneException");
-    if (exceptionClass) {
-        env->ThrowNew(exceptionClass, message);
-        env->DeleteLocalRef(exceptionClass);
+std::vector<int> toVector(JNIEnv* env, jintArray array) {
+    std::vector<int> values(array ? static_cast<size_t>(env->GetArrayLength(array)) : 0);
+    if (!values.empty()) {
+        env->GetIntArrayRegion(array, 0, static_cast<jsize>(values.size()), reinterpret_cast<jint*>(values.data()));
     }
+    return values;
 }
 
-} // namespace jni
-} // namespace redstone
-} // namespace lattice
+} // namespace
 
-using namespace lattice::redstone;
-using namespace lattice::redstone::jni;
+extern "C" {
 
 // ========== RedstoneEngine 主类 ==========
 
 JNIEXPORT jlong JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeCreateEngine(JNIEnv* env, jclass clazz) {
-    try {
-        if (!g_advancedEngine) {
-            g_advancedEngine = std::make_unique<AdvancedRedstoneEngine>();
-        }
-        
-        auto& engine = *g_advancedEngine;
-        std::cout << "[Advanced JNI] Created Advanced RedstoneEngine instance" << std::endl;
-        return reinterpret_cast<jlong>(&engine);
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to create Advanced RedstoneEngine: " << e.what() << std::endl;
-        throwRedstoneException(env, e.what());
-        return 0;
-    }
+    return reinterpret_cast<jlong>(&PaperCompatibleRedstoneEngine::getInstance());
 }
 
 JNIEXPORT void JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeDestroyEngine(JNIEnv* env, jclass clazz, jlong enginePtr) {
-    // 单例模式不需要显式销毁
-    std::cout << "[Advanced JNI] RedstoneEngine destroy requested (ignored for singleton)" << std::endl;
+    // 单例由进程持有，不需要显式销毁
 }
 
 JNIEXPORT void JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeTick(JNIEnv* env, jclass clazz, jlong enginePtr) {
-    try {
-        if (!enginePtr || !g_advancedEngine) {
-            throwRedstoneException(env, "Invalid engine pointer or engine not initialized");
-            return;
-        }
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        engine->processTick();
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Error during engine tick: " << e.what() << std::endl;
-        throwRedstoneException(env, e.what());
-    }
+    WorkloadRecorder::mark(TraceEvent::REDSTONE_TICK);
+    engineFrom(enginePtr).tick();
 }
 
 // ========== 组件注册 ==========
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterWire(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync("redstone_wire", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register wire: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::WIRE, x, y, z, 0);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterRepeater(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jint delay) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync("redstone_repeater", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register repeater: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::REPEATER, x, y, z, delay);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterComparator(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jboolean subtractMode) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync("redstone_comparator", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register comparator: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::COMPARATOR, x, y, z, subtractMode == JNI_TRUE ? 1 : 0);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterTorch(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jboolean powered) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync("redstone_torch", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register torch: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::TORCH, x, y, z, powered == JNI_TRUE ? 1 : 0);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterLever(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jboolean powered) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync("redstone_lever", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register lever: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::LEVER, x, y, z, powered == JNI_TRUE ? 1 : 0);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterButton(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jboolean wooden) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync(wooden ? "wooden_button" : "stone_button", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register button: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::BUTTON, x, y, z, wooden == JNI_TRUE ? 1 : 0);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterPressurePlate(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jint plateType) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        std::string plateTypeStr;
-        switch (plateType) {
-            case 0: plateTypeStr = "wooden_pressure_plate"; break;
-            case 1: plateTypeStr = "stone_pressure_plate"; break;
-            case 2: plateTypeStr = "gold_pressure_plate"; break;
-            case 3: plateTypeStr = "iron_pressure_plate"; break;
-            default: plateTypeStr = "pressure_plate"; break;
-        }
-        
-        auto future = engine->registerComponentAsync(plateTypeStr, x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register pressure plate: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::PRESSURE_PLATE, x, y, z, plateType);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterObserver(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jint facing) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync("redstone_observer", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register observer: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return registerKind(enginePtr, RedstoneComponentKind::OBSERVER, x, y, z, facing);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterPiston(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jboolean sticky, jint facing) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->registerComponentAsync(sticky ? "sticky_piston" : "piston", x, y, z);
-        return future.get() ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to register piston: " << e.what() << std::endl;
+    return registerKind(enginePtr, RedstoneComponentKind::PISTON, x, y, z, sticky == JNI_TRUE ? 1 : 0);
+}
+
+JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeBatchRegisterComponents(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jobjectArray componentTypes,
+    jintArray xCoords, jintArray yCoords, jintArray zCoords) {
+    if (componentTypes == nullptr) {
+        return JNI_FALSE;
+    }
+    const jsize count = env->GetArrayLength(componentTypes);
+    const std::vector<int> xs = toVector(env, xCoords);
+    const std::vector<int> ys = toVector(env, yCoords);
+    const std::vector<int> zs = toVector(env, zCoords);
+    if (xs.size() < static_cast<size_t>(count) || ys.size() < static_cast<size_t>(count) ||
+        zs.size() < static_cast<size_t>(count)) {
         return JNI_FALSE;
     }
+
+    bool allRegistered = true;
+    for (jsize i = 0; i < count; ++i) {
+        auto type = static_cast<jstring>(env->GetObjectArrayElement(componentTypes, i));
+        if (type == nullptr) {
+            allRegistered = false;
+            continue;
+        }
+        const char* chars = env->GetStringUTFChars(type, nullptr);
+        RedstoneComponentKind kind;
+        jint param;
+        const bool known = chars != nullptr && parseKind(chars, kind, param);
+        if (chars != nullptr) {
+            env->ReleaseStringUTFChars(type, chars);
+        }
+        env->DeleteLocalRef(type);
+        allRegistered = known && registerKind(enginePtr, kind, xs[i], ys[i], zs[i], param) == JNI_TRUE && allRegistered;
+    }
+    return allRegistered ? JNI_TRUE : JNI_FALSE;
 }
 
 // ========== 组件操作 ==========
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeUpdateComponent(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jint inputSignal) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->setPowerAsync(x, y, z, inputSignal);
-        future.wait(); // 等待完成
-        return JNI_TRUE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to update component: " << e.what() << std::endl;
-        return JNI_FALSE;
+    if (auto record = WorkloadRecorder::begin(TraceEvent::REDSTONE_POWER)) {
+        record.i32(x).i32(y).i32(z).i32(inputSignal);
     }
+    engineFrom(enginePtr).updatePower(x, y, z, inputSignal);
+    return JNI_TRUE;
 }
 
 JNIEXPORT jint JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeGetComponentOutput(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return 0;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        return engine->isPowered(x, y, z) ? 15 : 0; // 简化输出逻辑
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to get component output: " << e.what() << std::endl;
-        return 0;
-    }
+    return engineFrom(enginePtr).getPower(x, y, z);
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeUnregisterComponent(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        std::cout << "[Advanced JNI] Unregister component at (" << x << "," << y << "," << z << ") - advanced engine uses smart cleanup" << std::endl;
-        return JNI_TRUE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to unregister component: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return engineFrom(enginePtr).unregisterComponent(x, y, z) ? JNI_TRUE : JNI_FALSE;
 }
 
 // ========== 查询和统计 ==========
 
 JNIEXPORT jintArray JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeQueryComponentsInRange(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint centerX, jint centerY, jint centerZ, jint radius) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return nullptr;
-        
-        // 简化实现：返回空数组（在完整实现中需要查询组件范围）
-        jintArray result = env->NewIntArray(0);
-        return result;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to query components: " << e.what() << std::endl;
-        return nullptr;
+    const auto positions = engineFrom(enginePtr).componentsInRange(PaperPosition(centerX, centerY, centerZ), radius);
+    std::vector<jint> coordinates;
+    coordinates.reserve(positions.size() * 3);
+    for (const PaperPosition& pos : positions) {
+        coordinates.insert(coordinates.end(), {pos.x, pos.y, pos.z});
     }
+    jintArray result = env->NewIntArray(static_cast<jsize>(coordinates.size()));
+    if (result != nullptr && !coordinates.empty()) {
+        env->SetIntArrayRegion(result, 0, static_cast<jsize>(coordinates.size()), coordinates.data());
+    }
+    return result;
 }
 
 JNIEXPORT jlong JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeGetCurrentTick(JNIEnv* env, jclass clazz, jlong enginePtr) {
-    try {
-        if (!enginePtr || !g_advancedEngine) return 0;
-        
-        // 需要在AdvancedRedstoneEngine中添加getCurrentTick方法
-        return 0; // 临时返回0
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to get current tick: " << e.what() << std::endl;
-        return 0;
-    }
+    return static_cast<jlong>(engineFrom(enginePtr).currentTick());
 }
 
 JNIEXPORT jobject JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeGetPerformanceStats(
     JNIEnv* env, jclass clazz, jlong enginePtr) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return nullptr;
-        
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto stats = engine->getAdvancedPerformanceStats();
-        
-        return createPerformanceStatsObject(env, stats);
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to get performance stats: " << e.what() << std::endl;
+    jclass statsClass = env->FindClass("io/lattice/redstone/PerformanceStats");
+    if (statsClass == nullptr) {
+        env->ExceptionClear();
         return nullptr;
     }
-}
-
-// ========== 新增：批量注册支持 ==========
-
-JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeBatchRegisterComponents(
-    JNIEnv* env, jclass clazz, jlong enginePtr, jobjectArray componentTypes, 
-    jintArray xCoords, jintArray yCoords, jintArray zCoords) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        // 获取数组长度
-        jsize count = env->GetArrayLength(componentTypes);
-        if (count <= 0) return JNI_TRUE;
-        
-        // 准备组件数据
-        std::vector<std::tuple<std::string, int, int, int>> components;
-        components.reserve(count);
-        
-        for (jsize i = 0; i < count; i++) {
-            jstring typeStr = (jstring)env->GetObjectArrayElement(componentTypes, i);
-            const char* typeChars = env->GetStringUTFChars(typeStr, nullptr);
-            std::string type(typeChars);
-            env->ReleaseStringUTFChars(typeStr, typeChars);
-            env->DeleteLocalRef(typeStr);
-            
-            jint* xVals = env->GetIntArrayElements(xCoords, nullptr);
-            jint* yVals = env->GetIntArrayElements(yCoords, nullptr);
-            jint* zVals = env->GetIntArrayElements(zCoords, nullptr);
-            
-            components.emplace_back(type, xVals[i], yVals[i], zVals[i]);
-            
-            env->ReleaseIntArrayElements(xCoords, xVals, 0);
-            env->ReleaseIntArrayElements(yCoords, yVals, 0);
-            env->ReleaseIntArrayElements(zCoords, zVals, 0);
-        }
-        
-        // 异步批量注册
-        auto* engine = reinterpret_cast<AdvancedRedstoneEngine*>(enginePtr);
-        auto future = engine->batchRegisterComponents(components);
-        auto results = future.get();
-        
-        // 检查是否所有组件都成功注册
-        bool allSuccess = true;
-        for (bool result : results) {
-            if (!result) {
-                allSuccess = false;
-                break;
-            }
-        }
-        
-        return allSuccess ? JNI_TRUE : JNI_FALSE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Batch register failed: " << e.what() << std::endl;
-        return JNI_FALSE;
+    jmethodID constructor = env->GetMethodID(statsClass, "<init>", "(JJJDJ)V");
+    if (constructor == nullptr) {
+        env->ExceptionClear();
+        env->DeleteLocalRef(statsClass);
+        return nullptr;
     }
+    const auto stats = engineFrom(enginePtr).getPerformanceStats();
+    jobject result = env->NewObject(statsClass, constructor,
+                                    static_cast<jlong>(stats.totalComponents),
+                                    static_cast<jlong>(stats.signalsProcessed),
+                                    static_cast<jlong>(stats.circuitTicks),
+                                    static_cast<jdouble>(stats.avgProcessingTimeMs),
+                                    static_cast<jlong>(stats.memoryUsageBytes));
+    env->DeleteLocalRef(statsClass);
+    return result;
 }
 
 // ========== 行为验证和降级 ==========
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeValidateBehavior(
     JNIEnv* env, jclass clazz, jlong enginePtr, jintArray javaSignals, jintArray nativeSignals) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        // 简化验证逻辑
-        return JNI_TRUE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to validate behavior: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return PaperCompatibleRedstoneEngine::validateBehavior(toVector(env, javaSignals), toVector(env, nativeSignals))
+               ? JNI_TRUE
+               : JNI_FALSE;
 }
 
 JNIEXPORT void JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeEnableGracefulDegradation(
     JNIEnv* env, jclass clazz, jlong enginePtr) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return;
-        
-        std::cout << "[Advanced JNI] Enabled graceful degradation mode (engine handles this automatically)" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to enable graceful degradation: " << e.what() << std::endl;
-    }
+    engineFrom(enginePtr).enableGracefulDegradation();
 }
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeIsGracefulDegradationEnabled(
     JNIEnv* env, jclass clazz, jlong enginePtr) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return JNI_FALSE;
-        
-        // 高级引擎总是启用优雅降级
-        return JNI_TRUE;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to check graceful degradation status: " << e.what() << std::endl;
-        return JNI_FALSE;
-    }
+    return engineFrom(enginePtr).isGracefulDegradationEnabled() ? JNI_TRUE : JNI_FALSE;
 }
 
 // ========== 配置和调试 ==========
 
 JNIEXPORT void JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeResetPerformanceStats(
     JNIEnv* env, jclass clazz, jlong enginePtr) {
-    
-    try {
-        if (!enginePtr || !g_advancedEngine) return;
-        
-        std::cout << "[Advanced JNI] Performance stats reset (handled automatically by framework)" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to reset performance stats: " << e.what() << std::endl;
-    }
+    engineFrom(enginePtr).resetPerformanceStats();
 }
 
 JNIEXPORT void JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeSetDebugMode(
     JNIEnv* env, jclass clazz, jlong enginePtr, jboolean enabled) {
-    
-    try {
-        std::cout << "[Advanced JNI] Debug mode " << (enabled ? "enabled" : "disabled") 
-                 << " (framework provides automatic logging)" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[Advanced JNI] Failed to set debug mode: " << e.what() << std::endl;
-    }
-}
\ No newline at end of file
+    // 引擎的调试信息走tracing（LATTICE_TRACE_SPAN），这里没有单独的开关
+    std::cout << "[Lattice Redstone] Debug mode " << (enabled == JNI_TRUE ? "enabled" : "disabled")
+              << " (use tracing for engine spans)" << std::endl;
+}
+
+}
+
+} // namespace jni
+} // namespace lattice
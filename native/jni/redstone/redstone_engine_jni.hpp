@@ -2,19 +2,15 @@
 #define LATTICE_REDSTONE_ENGINE_JNI_HPP
 
 #include <jni.h>
-#include "../../core/redstone/redstone_engine.hpp"
-#include "../../core/redstone/redstone_components.hpp"
-#include "../jni_helper.hpp"
+#include "../../core/redstone/paper_compatible_redstone_engine.hpp"
+
+// io.lattice.redstone.RedstoneEngine的入口，全部转发到PaperCompatibleRedstoneEngine单例
+// enginePtr为nativeCreateEngine返回的实例地址，0时同样取单例
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// ========== JNI OnLoad/OnUnload ==========
-
-JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved);
-JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved);
-
 // ========== RedstoneEngine 主类 ==========
 
 JNIEXPORT jlong JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeCreateEngine(JNIEnv* env, jclass clazz);
@@ -52,6 +48,14 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegiste
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeRegisterPiston(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint x, jint y, jint z, jboolean sticky, jint facing);
 
+/**
+ * 批量注册，types为组件名（redstone_wire、repeater、comparator、redstone_torch、lever、
+ * *_button、*_pressure_plate、observer、piston、sticky_piston），全部成功时返回true
+ */
+JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeBatchRegisterComponents(
+    JNIEnv* env, jclass clazz, jlong enginePtr, jobjectArray componentTypes,
+    jintArray xCoords, jintArray yCoords, jintArray zCoords);
+
 // ========== 组件操作 ==========
 
 JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeUpdateComponent(
@@ -65,11 +69,16 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeUnregis
 
 // ========== 查询和统计 ==========
 
+// 范围内组件的坐标，每个组件依次3个int
 JNIEXPORT jintArray JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeQueryComponentsInRange(
     JNIEnv* env, jclass clazz, jlong enginePtr, jint centerX, jint centerY, jint centerZ, jint radius);
 
 JNIEXPORT jlong JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeGetCurrentTick(JNIEnv* env, jclass clazz, jlong enginePtr);
 
+/**
+ * io.lattice.redstone.PerformanceStats(long totalComponents, long signalsProcessed, long circuitTicks,
+ * double avgProcessingTimeMs, long memoryUsageBytes)，找不到该类时返回null
+ */
 JNIEXPORT jobject JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeGetPerformanceStats(
     JNIEnv* env, jclass clazz, jlong enginePtr);
 
@@ -96,29 +105,4 @@ JNIEXPORT void JNICALL Java_io_lattice_redstone_RedstoneEngine_nativeSetDebugMod
 }
 #endif
 
-// ========== 工具函数 ==========
-
-namespace lattice {
-namespace redstone {
-namespace jni {
-
-    // 将 Java 数组转换为 C++ 向量
-    std::vector<int> jintArrayToVector(JNIEnv* env, jintArray array);
-    
-    // 转换位置结构
-    inline lattice::redstone::Position jniToPosition(JNIEnv* env, jint x, jint y, jint z) {
-        return lattice::redstone::Position(static_cast<int>(x), static_cast<int>(y), static_cast<int>(z));
-    }
-    
-    // 创建性能统计对象
-    jobject createPerformanceStatsObject(JNIEnv* env, const RedstoneEngine::PerformanceStats& stats);
-    
-    // 错误处理
-    void throwRedstoneException(JNIEnv* env, const char* message);
-    void logRedstoneError(const char* format, ...);
-    
-} // namespace jni
-} // namespace redstone
-} // namespace lattice
-
-#endif // LATTICE_REDSTONE_ENGINE_JNI_HPP
\ No newline at end of file
+#endif // LATTICE_REDSTONE_ENGINE_JNI_HPP
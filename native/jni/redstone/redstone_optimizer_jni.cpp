@@ -1,29 +1,79 @@
 #include "redstone_optimizer_jni.hpp"
+#include "../../core/redstone/paper_compatible_redstone_engine.hpp"
 #include <jni.h>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 
 namespace lattice {
 namespace jni {
 
+using redstone::paper::PaperCompatibleRedstoneEngine;
+
 extern "C" {
 
+// NativeRedstoneOptimizer的入口都转发到统一的红石引擎（红石网络与开销统计来自PARALLEL模式）
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeGetRedstonePower(JNIEnv *env, jclass clazz, jint x, jint y,
+                                                                        jint z) {
+    return PaperCompatibleRedstoneEngine::getInstance().getPower(x, y, z);
+}
+
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeCalculateNetworkPower(JNIEnv *env, jclass clazz, jint x,
+                                                                             jint y, jint z, jint maxDistance) {
+    return PaperCompatibleRedstoneEngine::getInstance().networkPower(x, y, z, std::max<jint>(maxDistance, 0));
+}
+
 JNIEXPORT void JNICALL
-Java_RedstoneOptimizerJNI_initializeOptimizer(JNIEnv *env, jobject obj) {
-    std::cout << "Initializing redstone optimizer JNI" << std::endl;
-    // Initialize redstone optimizer
+Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeInvalidateNetworkCache(JNIEnv *env, jclass clazz, jint x,
+                                                                              jint y, jint z) {
+    // 网络按整体重新划分，与位置无关
+    PaperCompatibleRedstoneEngine::getInstance().invalidateNetworks();
 }
 
 JNIEXPORT void JNICALL
-Java_RedstoneOptimizerJNI_optimizeCircuit(JNIEnv *env, jobject obj, jobject circuitState) {
-    std::cout << "Optimizing circuit through JNI" << std::endl;
-    // Optimize redstone circuit
+Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeSetProfiling(JNIEnv *env, jclass clazz, jboolean enabled,
+                                                                    jint sampleInterval) {
+    PaperCompatibleRedstoneEngine::getInstance().setProfiling(
+        enabled == JNI_TRUE, sampleInterval > 0 ? static_cast<uint32_t>(sampleInterval)
+                                                : PaperCompatibleRedstoneEngine::DEFAULT_PROFILE_SAMPLE_INTERVAL);
 }
 
-JNIEXPORT jobject JNICALL
-Java_RedstoneOptimizerJNI_getPerformanceMetrics(JNIEnv *env, jobject obj, jobject circuitState) {
-    std::cout << "Getting performance metrics through JNI" << std::endl;
-    // Get performance metrics
-    return nullptr;
+JNIEXPORT jint JNICALL
+Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeTopNetworks(JNIEnv *env, jclass clazz, jint limit,
+                                                                   jobject buffer) {
+    constexpr size_t RECORD_SIZE = 8 + 4 * 7 + 8 * 4;
+    if (limit < 0 || buffer == nullptr) {
+        return -1;
+    }
+    auto* address = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < 0) {
+        return -1;
+    }
+
+    const auto top = PaperCompatibleRedstoneEngine::getInstance().topNetworks(static_cast<size_t>(limit));
+    if (static_cast<size_t>(capacity) < top.size() * RECORD_SIZE) {
+        return -2;
+    }
+    uint8_t* out = address;
+    auto put = [&out](const auto& value) {
+        std::memcpy(out, &value, sizeof(value));
+        out += sizeof(value);
+    };
+    for (const auto& entry : top) {
+        put(static_cast<int64_t>(entry.networkId));
+        put(static_cast<int32_t>(entry.worldId));
+        for (int32_t coordinate : {entry.min.x, entry.min.y, entry.min.z, entry.max.x, entry.max.y, entry.max.z}) {
+            put(coordinate);
+        }
+        put(static_cast<int64_t>(entry.evaluations));
+        put(static_cast<int64_t>(entry.updates));
+        put(entry.nanosPerTick);
+        put(entry.updatesPerTick);
+    }
+    return static_cast<jint>(top.size());
 }
 
 }
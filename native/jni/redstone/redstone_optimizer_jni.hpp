@@ -7,11 +7,7 @@
 extern "C" {
 #endif
 
-// JNI_OnLoad 和 JNI_OnUnload
-JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved);
-JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved);
-
-// NativeRedstoneOptimizer 类的方法
+// NativeRedstoneOptimizer 类的方法（由PaperCompatibleRedstoneEngine实现）
 JNIEXPORT jint JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeGetRedstonePower
   (JNIEnv *, jclass, jint, jint, jint);
 
@@ -21,6 +17,18 @@ JNIEXPORT jint JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeCa
 JNIEXPORT void JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeInvalidateNetworkCache
   (JNIEnv *, jclass, jint, jint, jint);
 
+// 按网络的开销统计
+JNIEXPORT void JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeSetProfiling
+  (JNIEnv *, jclass, jboolean, jint);
+
+/**
+ * 把最近耗时最高的前limit个网络写入直接缓冲区（主机字节序），返回写入条数，-1参数无效，-2缓冲区不足
+ * 每条: int64 network_id, int32 world, int32 minX, minY, minZ, maxX, maxY, maxZ,
+ *       int64 evaluations, int64 updates, float64 nanosPerTick, float64 updatesPerTick
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_redstone_NativeRedstoneOptimizer_nativeTopNetworks
+  (JNIEnv *, jclass, jint, jobject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,8 @@
 #include <memory>
 #include <iostream>
 #include <atomic>
+#include <unordered_map>
+#include "../core/memory_budget.hpp"
 
 namespace lattice {
 namespace jni {
@@ -14,6 +16,8 @@ namespace jni {
 // ========== 修复的内存管理类 ==========
 
 class SafeJNIMemoryManager {
+    friend class OptimizedJNIUtils;
+    
 private:
     struct MemoryBlock {
         void* ptr;
@@ -23,19 +27,49 @@ private:
     };
     
     MemoryBlock* head_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
     std::atomic<size_t> totalAllocated_{0};
     std::atomic<size_t> totalFreed_{0};
     
     static constexpr size_t MAX_BLOCK_SIZE = 16 * 1024 * 1024; // 16MB
     static constexpr size_t SAFETY_MARGIN = 1024; // 1KB safety margin
     
+    // DirectByteBuffer池：按2的幂分级（4KB .. 16MB），Java释放后的缓冲区留作复用
+    static constexpr size_t POOL_MIN_CLASS_SIZE = 4 * 1024;
+    static constexpr size_t POOL_CLASS_COUNT = 13;
+    static constexpr size_t MAX_POOLED_BYTES = 64 * 1024 * 1024;
+    
+    std::vector<void*> freeBuffers_[POOL_CLASS_COUNT];
+    std::unordered_map<void*, size_t> outstandingBuffers_;   // 已交给Java的缓冲区 -> 分级
+    size_t pooledBytes_{0};
+    size_t poolHits_{0};
+    size_t poolMisses_{0};
+    uint64_t shedderId_{0};
+    
+    static size_t poolClassFor(size_t size) {
+        size_t index = 0;
+        size_t classSize = POOL_MIN_CLASS_SIZE;
+        while (classSize < size) {
+            classSize <<= 1;
+            index++;
+        }
+        return index;
+    }
+    
+    static size_t poolClassSize(size_t index) {
+        return POOL_MIN_CLASS_SIZE << index;
+    }
+    
 public:
     SafeJNIMemoryManager() : head_(nullptr) {
+        // 超出JNI_BUFFERS预算时释放池中等待复用的DirectByteBuffer
+        shedderId_ = core::MemoryBudget::instance().addShedder(
+            core::MemorySubsystem::JNI_BUFFERS, [this](size_t bytes) { return trimPool(bytes); });
         std::cout << "[SafeJNIMemory] Initialized with safety bounds checking" << std::endl;
     }
     
     ~SafeJNIMemoryManager() {
+        core::MemoryBudget::instance().removeShedder(shedderId_);
         cleanup();
     }
     
@@ -77,6 +111,7 @@ public:
         }
         
         totalAllocated_.fetch_add(safeSize);
+        core::MemoryBudget::instance().charge(core::MemorySubsystem::JNI_BUFFERS, safeSize);
         
         std::cout << "[SafeJNIMemory] Allocated " << safeSize << " bytes for " << tag << std::endl;
         
@@ -109,6 +144,7 @@ public:
                     delete toDelete;
                     
                     totalFreed_.fetch_add(originalSize + SAFETY_MARGIN);
+                    core::MemoryBudget::instance().release(core::MemorySubsystem::JNI_BUFFERS, toDelete->size);
                     
                     std::cout << "[SafeJNIMemory] Freed " << (originalSize + SAFETY_MARGIN) 
                              << " bytes for " << tag << std::endl;
@@ -121,33 +157,102 @@ public:
         std::cerr << "[SafeJNIMemory] Error: Could not find memory block to free for " << tag << std::endl;
     }
     
-    // JNI安全包装器
+    // JNI安全包装器（池化）：容量为size的DirectByteBuffer，用完后必须调用releaseDirectByteBuffer
+    // 复用的缓冲区不清零，调用者负责写满[0, size)
     jobject allocateDirectByteBuffer(size_t size, JNIEnv* env, const char* tag = "unknown") {
-        void* nativePtr = allocate(size, tag);
-        if (!nativePtr) {
+        if (size == 0 || size > MAX_BLOCK_SIZE) {
+            std::cerr << "[SafeJNIMemory] Error: Invalid DirectByteBuffer size (" << size << " bytes) for " << tag << std::endl;
             return nullptr;
         }
         
-        jobject byteBuffer = env->NewDirectByteBuffer(nativePtr, size);
+        const size_t classIndex = poolClassFor(size);
+        void* nativePtr = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto& freeList = freeBuffers_[classIndex];
+            if (!freeList.empty()) {
+                nativePtr = freeList.back();
+                freeList.pop_back();
+                pooledBytes_ -= poolClassSize(classIndex);
+                poolHits_++;
+            } else {
+                poolMisses_++;
+            }
+        }
+        
+        if (!nativePtr) {
+            nativePtr = allocate(poolClassSize(classIndex), tag);
+            if (!nativePtr) {
+                return nullptr;
+            }
+            
+            // 记录JNI引用
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (MemoryBlock* current = head_; current; current = current->next) {
+                if (static_cast<char*>(current->ptr) + (SAFETY_MARGIN / 2) == nativePtr) {
+                    current->isJNIReference = true;
+                    break;
+                }
+            }
+        }
+        
+        jobject byteBuffer = env->NewDirectByteBuffer(nativePtr, static_cast<jlong>(size));
         if (!byteBuffer) {
-            deallocate(nativePtr, size, tag);
+            recycle(nativePtr, classIndex, tag);
             std::cerr << "[SafeJNIMemory] Error: Failed to create DirectByteBuffer for " << tag << std::endl;
             return nullptr;
         }
         
-        // 记录JNI引用
         std::lock_guard<std::mutex> lock(mutex_);
-        MemoryBlock** current = &head_;
+        outstandingBuffers_[nativePtr] = classIndex;
+        return byteBuffer;
+    }
+    
+    // 归还allocateDirectByteBuffer分配的缓冲区；Java侧此后不得再访问该ByteBuffer
+    bool releaseDirectByteBuffer(jobject buffer, JNIEnv* env, const char* tag = "unknown") {
+        void* nativePtr = buffer ? env->GetDirectBufferAddress(buffer) : nullptr;
+        if (!nativePtr) {
+            std::cerr << "[SafeJNIMemory] Error: Not a direct buffer for " << tag << std::endl;
+            return false;
+        }
         
-        while (*current) {
-            if (static_cast<char*>((*current)->ptr) + (SAFETY_MARGIN / 2) == nativePtr) {
-                (*current)->isJNIReference = true;
-                break;
+        size_t classIndex = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = outstandingBuffers_.find(nativePtr);
+            if (it == outstandingBuffers_.end()) {
+                // 重复释放或不是本管理器分配的缓冲区
+                std::cerr << "[SafeJNIMemory] Error: Unknown DirectByteBuffer released for " << tag << std::endl;
+                return false;
             }
-            current = &((*current)->next);
+            classIndex = it->second;
+            outstandingBuffers_.erase(it);
         }
         
-        return byteBuffer;
+        recycle(nativePtr, classIndex, tag);
+        return true;
+    }
+    
+    // 从大到小释放池中的空闲缓冲区，直到达到bytes；返回释放的字节数（含安全边界）
+    size_t trimPool(size_t bytes) {
+        std::vector<std::pair<void*, size_t>> released;
+        size_t releasedBytes = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t index = POOL_CLASS_COUNT; index-- > 0 && releasedBytes < bytes;) {
+                auto& freeList = freeBuffers_[index];
+                while (!freeList.empty() && releasedBytes < bytes) {
+                    released.emplace_back(freeList.back(), poolClassSize(index));
+                    freeList.pop_back();
+                    pooledBytes_ -= poolClassSize(index);
+                    releasedBytes += poolClassSize(index) + SAFETY_MARGIN;
+                }
+            }
+        }
+        for (const auto& [ptr, size] : released) {
+            deallocate(ptr, size, "pool_trim");
+        }
+        return releasedBytes;
     }
     
     // 获取统计信息
@@ -156,26 +261,15 @@ public:
         size_t totalFreed;
         size_t currentUsage;
         size_t blockCount;
+        size_t outstandingBuffers;      // Java尚未释放的DirectByteBuffer
+        size_t pooledBytes;             // 池中等待复用的字节数
+        size_t poolHits;
+        size_t poolMisses;
     };
     
     MemoryStats getStats() const {
-        MemoryBlock* current = head_;
-        size_t blockCount = 0;
-        
-        {
-            std::lock_guard<std::mutex> lock(mutex_);
-            while (current) {
-                blockCount++;
-                current = current->next;
-            }
-        }
-        
-        return MemoryStats{
-            totalAllocated_.load(),
-            totalFreed_.load(),
-            totalAllocated_.load() - totalFreed_.load(),
-            blockCount
-        };
+        std::lock_guard<std::mutex> lock(mutex_);
+        return getStatsLocked();
     }
     
     // 清理所有内存
@@ -187,6 +281,7 @@ public:
             MemoryBlock* next = current->next;
             
             // 安全清零和释放
+            core::MemoryBudget::instance().release(core::MemorySubsystem::JNI_BUFFERS, current->size);
             memset(current->ptr, 0xCC, current->size);
             free(current->ptr);
             delete current;
@@ -195,8 +290,13 @@ public:
         }
         
         head_ = nullptr;
+        for (auto& freeList : freeBuffers_) {
+            freeList.clear();
+        }
+        outstandingBuffers_.clear();
+        pooledBytes_ = 0;
         
-        auto stats = getStats();
+        auto stats = getStatsLocked();
         std::cout << "[SafeJNIMemory] Cleanup completed. Total allocated: " 
                  << stats.totalAllocated << " bytes, freed: " << stats.totalFreed 
                  << " bytes, remaining: " << stats.currentUsage << " bytes" << std::endl;
@@ -229,14 +329,47 @@ public:
         std::cout << "[SafeJNIMemory] Memory validation passed. " << validatedBlocks << " blocks validated." << std::endl;
         return true;
     }
+    
+private:
+    MemoryStats getStatsLocked() const {
+        size_t blockCount = 0;
+        for (MemoryBlock* current = head_; current; current = current->next) {
+            blockCount++;
+        }
+        
+        return MemoryStats{
+            totalAllocated_.load(),
+            totalFreed_.load(),
+            totalAllocated_.load() - totalFreed_.load(),
+            blockCount,
+            outstandingBuffers_.size(),
+            pooledBytes_,
+            poolHits_,
+            poolMisses_
+        };
+    }
+    
+    // 放回池中；超过池上限时直接释放
+    void recycle(void* nativePtr, size_t classIndex, const char* tag) {
+        const size_t classSize = poolClassSize(classIndex);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pooledBytes_ + classSize <= MAX_POOLED_BYTES) {
+                freeBuffers_[classIndex].push_back(nativePtr);
+                pooledBytes_ += classSize;
+                return;
+            }
+        }
+        deallocate(nativePtr, classSize, tag);
+    }
 };
 
 // ========== 优化的JNI工具类 ==========
 
 class OptimizedJNIUtils {
 private:
-    static SafeJNIMemoryManager* g_memory_manager;
-    static std::mutex g_init_mutex;
+    static inline SafeJNIMemoryManager* g_memory_manager = nullptr;
+    static inline std::mutex g_init_mutex;
     
 public:
     static SafeJNIMemoryManager* getMemoryManager() {
@@ -260,11 +393,20 @@ public:
         void** dstPtrs = (void**)memoryManager->allocate(count * sizeof(void*), "batch_dsts");
         size_t* sizePtrs = (size_t*)memoryManager->allocate(count * sizeof(size_t), "batch_sizes");
         
+        // 安全清理
+        auto releaseBatchBuffers = [&]() {
+            if (srcPtrs) memoryManager->deallocate(srcPtrs, count * sizeof(void*), "batch_srcs");
+            if (dstPtrs) memoryManager->deallocate(dstPtrs, count * sizeof(void*), "batch_dsts");
+            if (sizePtrs) memoryManager->deallocate(sizePtrs, count * sizeof(size_t), "batch_sizes");
+        };
+        
         if (!srcPtrs || !dstPtrs || !sizePtrs) {
             std::cerr << "[OptimizedJNI] Error: Failed to allocate batch buffers" << std::endl;
+            releaseBatchBuffers();
             return -1;
         }
         
+        int successCount = -1;
         try {
             // 安全地批量获取缓冲区信息
             for (int i = 0; i < count; i++) {
@@ -293,7 +435,7 @@ public:
             // 批量获取尺寸
             jint* tempSizes = env->GetIntArrayElements(sizes, nullptr);
             for (int i = 0; i < count; i++) {
-                if (tempSizes[i] > 0 && tempSizes[i] <= MAX_BLOCK_SIZE) {
+                if (tempSizes[i] > 0 && static_cast<size_t>(tempSizes[i]) <= SafeJNIMemoryManager::MAX_BLOCK_SIZE) {
                     sizePtrs[i] = tempSizes[i];
                 } else {
                     sizePtrs[i] = 0;
@@ -304,26 +446,20 @@ public:
             env->ReleaseIntArrayElements(sizes, tempSizes, JNI_ABORT);
             
             // 执行安全的拷贝操作
-            int successCount = 0;
+            successCount = 0;
             for (int i = 0; i < count; i++) {
                 if (srcPtrs[i] && dstPtrs[i] && sizePtrs[i] > 0) {
-                    // 使用优化的内存拷贝
-                    lattice::optimization::fast_memcpy(dstPtrs[i], srcPtrs[i], sizePtrs[i]);
+                    std::memcpy(dstPtrs[i], srcPtrs[i], sizePtrs[i]);
                     successCount++;
                 }
             }
-            
-            return successCount;
-            
         } catch (const std::exception& e) {
             std::cerr << "[OptimizedJNI] Error during batch copy: " << e.what() << std::endl;
-            return -1;
-        } finally {
-            // 安全清理
-            memoryManager->deallocate(srcPtrs, count * sizeof(void*), "batch_srcs");
-            memoryManager->deallocate(dstPtrs, count * sizeof(void*), "batch_dsts");
-            memoryManager->deallocate(sizePtrs, count * sizeof(size_t), "batch_sizes");
+            successCount = -1;
         }
+        
+        releaseBatchBuffers();
+        return successCount;
     }
     
     // 清理全局资源
@@ -338,9 +474,5 @@ public:
     }
 };
 
-// 静态成员定义
-SafeJNIMemoryManager* OptimizedJNIUtils::g_memory_manager = nullptr;
-std::mutex OptimizedJNIUtils::g_init_mutex;
-
 } // namespace jni
 } // namespace lattice
\ No newline at end of file
@@ -0,0 +1,94 @@
+#include "shared_ring_jni.hpp"
+#include "../optimization/ring_channel.hpp"
+
+using lattice::optimization::MMAPManager;
+using lattice::optimization::RingChannel;
+
+namespace {
+
+MMAPManager& ringMemory() {
+    static MMAPManager manager;
+    return manager;
+}
+
+RingChannel* fromHandle(jlong handle) {
+    return reinterpret_cast<RingChannel*>(static_cast<intptr_t>(handle));
+}
+
+} // namespace
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeOpen(JNIEnv* env, jclass clazz,
+                                                        jint commandSlots, jint commandSlotSize,
+                                                        jint resultSlots, jint resultSlotSize) {
+    if (commandSlots <= 0 || commandSlotSize <= 0 || resultSlots <= 0 || resultSlotSize <= 0) {
+        return 0;
+    }
+    RingChannel::Config config;
+    config.commandSlots = static_cast<uint32_t>(commandSlots);
+    config.commandSlotSize = static_cast<uint32_t>(commandSlotSize);
+    config.resultSlots = static_cast<uint32_t>(resultSlots);
+    config.resultSlotSize = static_cast<uint32_t>(resultSlotSize);
+    try {
+        std::unique_ptr<RingChannel> channel = RingChannel::open(ringMemory(), config);
+        return static_cast<jlong>(reinterpret_cast<intptr_t>(channel.release()));
+    } catch (const std::exception& e) {
+        fprintf(stderr, "SharedRingChannel: open failed: %s\n", e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jobject JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeBuffer(JNIEnv* env, jclass clazz, jlong handle) {
+    RingChannel* channel = fromHandle(handle);
+    if (!channel) {
+        return nullptr;
+    }
+    return env->NewDirectByteBuffer(channel->buffer(), static_cast<jlong>(channel->size()));
+}
+
+JNIEXPORT void JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeWake(JNIEnv* env, jclass clazz, jlong handle) {
+    if (RingChannel* channel = fromHandle(handle)) {
+        channel->wake();
+    }
+}
+
+JNIEXPORT jboolean JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeHasHandler(JNIEnv* env, jclass clazz, jint subsystem) {
+    if (subsystem <= 0 || subsystem >= static_cast<jint>(lattice::optimization::RING_SUBSYSTEM_COUNT)) {
+        return JNI_FALSE;
+    }
+    return RingChannel::hasHandler(static_cast<lattice::optimization::RingSubsystem>(subsystem)) ? JNI_TRUE
+                                                                                                  : JNI_FALSE;
+}
+
+JNIEXPORT jlongArray JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeStats(JNIEnv* env, jclass clazz, jlong handle) {
+    RingChannel* channel = fromHandle(handle);
+    if (!channel) {
+        return nullptr;
+    }
+    const RingChannel::Stats stats = channel->getStats();
+    const jlong values[5] = {
+        static_cast<jlong>(stats.commandsDispatched),
+        static_cast<jlong>(stats.commandsUnrouted),
+        static_cast<jlong>(stats.resultsPublished),
+        static_cast<jlong>(stats.resultsDropped),
+        static_cast<jlong>(stats.wakeups),
+    };
+    jlongArray result = env->NewLongArray(5);
+    if (result) {
+        env->SetLongArrayRegion(result, 0, 5, values);
+    }
+    return result;
+}
+
+JNIEXPORT void JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeClose(JNIEnv* env, jclass clazz, jlong handle) {
+    delete fromHandle(handle);
+}
+
+} // extern "C"
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <jni.h>
+
+namespace lattice {
+namespace jni {
+
+// io.lattice.nativeutil.SharedRingChannel的native方法
+// 消息本身经共享内存传递（native/optimization/ring_channel.hpp），这里只有通道的创建、唤醒与销毁
+extern "C" {
+
+/**
+ * @brief 创建通道并启动分发线程，返回句柄；参数不合法或内存映射失败时返回0
+ */
+JNIEXPORT jlong JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeOpen(JNIEnv* env, jclass clazz,
+                                                        jint commandSlots, jint commandSlotSize,
+                                                        jint resultSlots, jint resultSlotSize);
+
+/**
+ * @brief 整个共享缓冲区的DirectByteBuffer视图（通道关闭前有效）
+ */
+JNIEXPORT jobject JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeBuffer(JNIEnv* env, jclass clazz, jlong handle);
+
+/**
+ * @brief 唤醒休眠中的分发线程（Java写入命令后看到consumerWaiting时调用）
+ */
+JNIEXPORT void JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeWake(JNIEnv* env, jclass clazz, jlong handle);
+
+/**
+ * @brief 本库是否登记了该子系统的处理函数（没有时该子系统的命令只计入unrouted）
+ */
+JNIEXPORT jboolean JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeHasHandler(JNIEnv* env, jclass clazz, jint subsystem);
+
+/**
+ * @brief 统计：dispatched, unrouted, resultsPublished, resultsDropped, wakeups
+ */
+JNIEXPORT jlongArray JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeStats(JNIEnv* env, jclass clazz, jlong handle);
+
+/**
+ * @brief 停止分发线程并释放共享缓冲区
+ */
+JNIEXPORT void JNICALL
+Java_io_lattice_nativeutil_SharedRingChannel_nativeClose(JNIEnv* env, jclass clazz, jlong handle);
+
+} // extern "C"
+
+} // namespace jni
+} // namespace lattice
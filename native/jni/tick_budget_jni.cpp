@@ -0,0 +1,87 @@
+#include "jni_registry.hpp"
+#include "lattice_ffi.h"
+#include "../core/frame_allocator.hpp"
+#include "../core/tick_budget.hpp"
+#include <jni.h>
+
+namespace lattice {
+namespace jni {
+
+namespace {
+
+using lattice::core::FrameAllocator;
+using lattice::core::TickBudget;
+
+// 与tracing_jni.cpp相同：每个桥接库注册到NativeTickBudget下各自的嵌套类（见NativeTickBudget.java）
+#if defined(LATTICE_BRIDGE_CHUNK_IO)
+constexpr const char* TICK_BUDGET_CLASS = "io/lattice/nativeutil/NativeTickBudget$ChunkIO";
+#elif defined(LATTICE_BRIDGE_OPTIMIZED)
+constexpr const char* TICK_BUDGET_CLASS = "io/lattice/nativeutil/NativeTickBudget$Optimized";
+#else
+constexpr const char* TICK_BUDGET_CLASS = "io/lattice/nativeutil/NativeTickBudget$Core";
+#endif
+
+// tick开始同时推进本库的帧分配器（上上个tick的帧内存随之到期）
+void JNICALL tickStarted(JNIEnv* env, jclass clazz) {
+    TickBudget::instance().tickStarted();
+    FrameAllocator::instance().advanceFrame();
+}
+
+void JNICALL tickEnded(JNIEnv* env, jclass clazz) {
+    TickBudget::instance().tickEnded();
+}
+
+void JNICALL setTargetMspt(JNIEnv* env, jclass clazz, jdouble mspt) {
+    TickBudget::instance().setTargetMspt(mspt);
+}
+
+// [ticks, overruns, smoothedMspt, lastMspt, pressure]
+jdoubleArray JNICALL stats(JNIEnv* env, jclass clazz) {
+    const TickBudget::Stats stats = TickBudget::instance().getStats();
+    const jdouble values[] = {
+        static_cast<jdouble>(stats.ticks),
+        static_cast<jdouble>(stats.overruns),
+        stats.smoothedMspt,
+        stats.lastMspt,
+        static_cast<jdouble>(stats.pressure),
+    };
+    jdoubleArray result = env->NewDoubleArray(5);
+    if (result != nullptr) {
+        env->SetDoubleArrayRegion(result, 0, 5, values);
+    }
+    return result;
+}
+
+// 在所在库的JNI_OnLoad中注册（JniRegistry）
+JniNativeTable TICK_BUDGET_NATIVES(TICK_BUDGET_CLASS, {
+    {(char*)"nativeTickStarted", (char*)"()V", (void*)tickStarted},
+    {(char*)"nativeTickEnded", (char*)"()V", (void*)tickEnded},
+    {(char*)"nativeSetTargetMspt", (char*)"(D)V", (void*)setTargetMspt},
+    {(char*)"nativeStats", (char*)"()[D", (void*)stats}
+});
+
+} // namespace
+
+} // namespace jni
+} // namespace lattice
+
+extern "C" {
+
+LATTICE_FFI_EXPORT void lattice_tick_started(void) {
+    lattice::core::TickBudget::instance().tickStarted();
+    lattice::core::FrameAllocator::instance().advanceFrame();
+}
+
+LATTICE_FFI_EXPORT void lattice_tick_ended(void) {
+    lattice::core::TickBudget::instance().tickEnded();
+}
+
+LATTICE_FFI_EXPORT void lattice_tick_set_target_mspt(double mspt) {
+    lattice::core::TickBudget::instance().setTargetMspt(mspt);
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_tick_pressure(void) {
+    return static_cast<int32_t>(lattice::core::TickBudget::instance().pressure());
+}
+
+} // extern "C"
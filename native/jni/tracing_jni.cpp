@@ -0,0 +1,117 @@
+#include "jni_registry.hpp"
+#include "lattice_ffi.h"
+#include "../core/tracing.hpp"
+#include <jni.h>
+#include <string>
+
+namespace lattice {
+namespace jni {
+
+namespace {
+
+using lattice::core::Tracer;
+
+// 每个桥接库各有一份Tracer，把同一组native方法注册到NativeTracing下各自的嵌套类（见NativeTracing.java）；
+// 构建时由CMake为所在库定义LATTICE_BRIDGE_CHUNK_IO / LATTICE_BRIDGE_OPTIMIZED
+#if defined(LATTICE_BRIDGE_CHUNK_IO)
+constexpr const char* TRACING_CLASS = "io/lattice/nativeutil/NativeTracing$ChunkIO";
+#elif defined(LATTICE_BRIDGE_OPTIMIZED)
+constexpr const char* TRACING_CLASS = "io/lattice/nativeutil/NativeTracing$Optimized";
+#else
+constexpr const char* TRACING_CLASS = "io/lattice/nativeutil/NativeTracing$Core";
+#endif
+
+// Java侧的区间名通常是固定的几个（"server tick"等），intern后长期有效
+const char* internString(JNIEnv* env, jstring text) {
+    if (text == nullptr) {
+        return "";
+    }
+    const char* chars = env->GetStringUTFChars(text, nullptr);
+    if (chars == nullptr) {
+        return "";
+    }
+    const char* interned = Tracer::instance().intern(chars);
+    env->ReleaseStringUTFChars(text, chars);
+    return interned;
+}
+
+void JNICALL setEnabled(JNIEnv* env, jclass clazz, jboolean enabled) {
+    lattice_tracing_set_enabled(enabled ? 1 : 0);
+}
+
+jboolean JNICALL isEnabled(JNIEnv* env, jclass clazz) {
+    return Tracer::enabled() ? JNI_TRUE : JNI_FALSE;
+}
+
+jlong JNICALL dump(JNIEnv* env, jclass clazz, jstring path, jboolean append) {
+    if (path == nullptr) {
+        return -1;
+    }
+    const char* chars = env->GetStringUTFChars(path, nullptr);
+    if (chars == nullptr) {
+        return -1;
+    }
+    const std::string target(chars);
+    env->ReleaseStringUTFChars(path, chars);
+    return Tracer::instance().dump(target, append == JNI_TRUE);
+}
+
+void JNICALL beginSpan(JNIEnv* env, jclass clazz, jstring name) {
+    if (Tracer::enabled()) {
+        Tracer::instance().beginSpan("server", internString(env, name));
+    }
+}
+
+void JNICALL endSpan(JNIEnv* env, jclass clazz) {
+    Tracer::instance().endSpan();
+}
+
+void JNICALL counter(JNIEnv* env, jclass clazz, jstring name, jlong value) {
+    if (Tracer::enabled()) {
+        Tracer::instance().counter("server", internString(env, name), value);
+    }
+}
+
+jlong JNICALL droppedEvents(JNIEnv* env, jclass clazz) {
+    return static_cast<jlong>(Tracer::instance().droppedEvents());
+}
+
+// 在所在库的JNI_OnLoad中注册（JniRegistry）
+JniNativeTable TRACING_NATIVES(TRACING_CLASS, {
+    {(char*)"nativeSetEnabled", (char*)"(Z)V", (void*)setEnabled},
+    {(char*)"nativeIsEnabled", (char*)"()Z", (void*)isEnabled},
+    {(char*)"nativeDump", (char*)"(Ljava/lang/String;Z)J", (void*)dump},
+    {(char*)"nativeBeginSpan", (char*)"(Ljava/lang/String;)V", (void*)beginSpan},
+    {(char*)"nativeEndSpan", (char*)"()V", (void*)endSpan},
+    {(char*)"nativeCounter", (char*)"(Ljava/lang/String;J)V", (void*)counter},
+    {(char*)"nativeDroppedEvents", (char*)"()J", (void*)droppedEvents}
+});
+
+} // namespace
+
+} // namespace jni
+} // namespace lattice
+
+extern "C" {
+
+LATTICE_FFI_EXPORT void lattice_tracing_set_enabled(int32_t enabled) {
+    lattice::core::Tracer::instance().setEnabled(enabled != 0);
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_tracing_enabled(void) {
+    return lattice::core::Tracer::enabled() ? 1 : 0;
+}
+
+LATTICE_FFI_EXPORT int64_t lattice_tracing_dump(const char* path, int32_t append) {
+    if (!path || !*path) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    try {
+        const int64_t written = lattice::core::Tracer::instance().dump(path, append != 0);
+        return written < 0 ? LATTICE_FFI_FAILED : written;
+    } catch (...) {
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+} // extern "C"
@@ -0,0 +1,35 @@
+#include "lattice_ffi.h"
+#include "../core/workload_trace.hpp"
+
+// 编入每个带记录点的桥接库，控制的是本库的记录器（见lattice_ffi.h）
+
+using lattice::core::WorkloadRecorder;
+
+LATTICE_FFI_EXPORT int32_t lattice_workload_trace_start(const char* path, int32_t flags, int64_t maxBytes) {
+    if (!path || !*path) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    WorkloadRecorder::Options options;
+    options.chunkPayloads = (flags & LATTICE_TRACE_NO_CHUNK_PAYLOADS) == 0;
+    if (maxBytes > 0) {
+        options.maxBytes = static_cast<uint64_t>(maxBytes);
+    }
+    try {
+        return WorkloadRecorder::instance().start(path, options) ? 0 : LATTICE_FFI_FAILED;
+    } catch (...) {
+        return LATTICE_FFI_FAILED;
+    }
+}
+
+LATTICE_FFI_EXPORT int64_t lattice_workload_trace_stop(void) {
+    auto& recorder = WorkloadRecorder::instance();
+    if (!WorkloadRecorder::recording()) {
+        return 0;
+    }
+    recorder.stop();
+    return static_cast<int64_t>(recorder.bytesWritten());
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_workload_trace_recording(void) {
+    return WorkloadRecorder::recording() ? 1 : 0;
+}
@@ -1,5 +1,6 @@
 #include "advanced_light_engine_jni.hpp"
 #include "../FinalLatticeJNI_Fixed.h"
+#include "../../core/world/advanced_light_engine.hpp"
 
 namespace lattice {
 namespace jni {
@@ -340,6 +341,29 @@ Java_io_lattice_world_AdvancedLightEngine_initOpacityTable(
     }
 }
 
+JNIEXPORT jint JNICALL
+Java_io_lattice_world_AdvancedLightEngine_initBlockStateTable(
+    JNIEnv* env, jclass, jbyteArray packed) {
+    
+    if (packed == nullptr) {
+        return -1;
+    }
+    const jsize length = env->GetArrayLength(packed);
+    if (length <= 0 || length % sizeof(lattice::world::BlockLightProperties) != 0) {
+        return -1;
+    }
+    
+    // 启动时一次性拷贝整张表，临界区内不做其他JNI调用
+    void* bytes = env->GetPrimitiveArrayCritical(packed, nullptr);
+    if (bytes == nullptr) {
+        return -1;
+    }
+    const size_t count = static_cast<size_t>(length) / sizeof(lattice::world::BlockLightProperties);
+    lattice::world::LightOpacityTable::setBlockStateTable(static_cast<const uint8_t*>(bytes), count);
+    env->ReleasePrimitiveArrayCritical(packed, bytes, JNI_ABORT);
+    return static_cast<jint>(count);
+}
+
 JNIEXPORT void JNICALL
 Java_io_lattice_world_AdvancedLightEngine_calculateLightAsync(
     JNIEnv* env, jclass, jint worldId, jintArray blockX, jintArray blockY, 
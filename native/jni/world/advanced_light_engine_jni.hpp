@@ -18,6 +18,15 @@ JNIEXPORT void JNICALL
 Java_io_lattice_world_AdvancedLightEngine_initOpacityTable(
     JNIEnv* env, jclass, jintArray materialIds, jbyteArray opacities);
 
+/**
+ * 上传方块状态光照表 - 启动时调用一次（替代initOpacityTable）
+ * @param packed 按方块状态id排列，每个状态4字节：透光值、发光等级、面遮挡位（下上北南西东）、保留
+ * @return 上传的状态数，数组无效时返回-1
+ */
+JNIEXPORT jint JNICALL
+Java_io_lattice_world_AdvancedLightEngine_initBlockStateTable(
+    JNIEnv* env, jclass, jbyteArray packed);
+
 /**
  * 处理方块变化事件
  * @param x 方块X坐标
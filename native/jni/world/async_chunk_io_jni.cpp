@@ -6,60 +6,65 @@
 #include <atomic>
 #include <thread>
 #include <mutex>
+#include "async_chunk_io_jni.hpp"
 #include "../jni_helper.hpp"
-#include "../world/async_chunk_io.hpp"
+#include "../jni_registry.hpp"
 #include "ChunkCoordinate.hpp"
 #include "ChunkData.hpp"
 
-static std::atomic<jlong> gChunkIOCounter(0);
-static std::unordered_map<jlong, std::unique_ptr<lattice::world::AsyncChunkIO>> gChunkIOInstances;
-static std::mutex gChunkIOMutex;
+namespace lattice {
+namespace jni {
 
-extern "C" {
+InstanceRegistry<lattice::world::AsyncChunkIO>& asyncChunkIOInstances() {
+    static InstanceRegistry<lattice::world::AsyncChunkIO> instances;
+    return instances;
+}
+
+} // namespace jni
+} // namespace lattice
+
+namespace {
+
+using lattice::jni::asyncChunkIOInstances;
+
+// 句柄无效时抛IllegalArgumentException并返回nullptr
+std::shared_ptr<lattice::world::AsyncChunkIO> findChunkIO(JNIEnv* env, jlong ioId) {
+    auto chunkIO = asyncChunkIOInstances().find(ioId);
+    if (!chunkIO) {
+        jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+    }
+    return chunkIO;
+}
 
 // ========================================
 // AsyncChunkIO JNI Bridge
 // ========================================
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeCreateIO
-(JNIEnv* env, jclass clazz, jint threadCount) {
+jlong nativeCreateIO(JNIEnv* env, jclass, jint threadCount) {
     try {
-        auto chunkIO = std::make_unique<lattice::world::AsyncChunkIO>(static_cast<size_t>(threadCount));
-        
-        jlong ioId = ++gChunkIOCounter;
-        
-        std::lock_guard<std::mutex> lock(gChunkIOMutex);
-        gChunkIOInstances[ioId] = std::move(chunkIO);
-        
-        return ioId;
+        return asyncChunkIOInstances().add(
+            std::make_shared<lattice::world::AsyncChunkIO>(static_cast<size_t>(threadCount)));
     } catch (const std::exception& e) {
         jni::throw_java_exception(env, "java/lang/RuntimeException", e.what());
         return 0;
     }
 }
 
-JNIEXPORT void JNICALL Java_io_lattice_world_AsyncChunkIO_nativeDestroyIO
-(JNIEnv* env, jclass clazz, jlong ioId) {
+void nativeDestroyIO(JNIEnv* env, jclass, jlong ioId) {
     try {
-        std::lock_guard<std::mutex> lock(gChunkIOMutex);
-        gChunkIOInstances.erase(ioId);
+        asyncChunkIOInstances().remove(ioId);
     } catch (const std::exception& e) {
         jni::throw_java_exception(env, "java/lang/RuntimeException", e.what());
     }
 }
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeLoadChunkAsync
-(JNIEnv* env, jclass clazz, jlong ioId, jint x, jint z) {
+jlong nativeLoadChunkAsync(JNIEnv* env, jclass, jlong ioId, jint x, jint z) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return 0;
         }
         
-        auto& chunkIO = it->second;
-        
         lattice::world::ChunkCoordinate coord{static_cast<int>(x), static_cast<int>(z)};
         
         // Create a future to handle the async operation
@@ -81,18 +86,13 @@ JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeLoadChunkAsync
     }
 }
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeSaveChunkAsync
-(JNIEnv* env, jclass clazz, jlong ioId, jint x, jint z, jbyteArray chunkData) {
+jlong nativeSaveChunkAsync(JNIEnv* env, jclass, jlong ioId, jint x, jint z, jbyteArray chunkData) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return 0;
         }
         
-        auto& chunkIO = it->second;
-        
         // Convert jbyteArray to vector<uint8_t>
         jsize dataLength = env->GetArrayLength(chunkData);
         std::vector<uint8_t> byteData(static_cast<size_t>(dataLength));
@@ -116,8 +116,7 @@ JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeSaveChunkAsync
     }
 }
 
-JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeIsTaskComplete
-(JNIEnv* env, jclass clazz, jlong taskId) {
+jboolean nativeIsTaskComplete(JNIEnv* env, jclass, jlong taskId) {
     try {
         // This would need proper task tracking implementation
         // For now, return true to indicate task completed (placeholder)
@@ -128,8 +127,7 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeIsTaskComple
     }
 }
 
-JNIEXPORT jbyteArray JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetChunkData
-(JNIEnv* env, jclass clazz, jlong taskId) {
+jbyteArray nativeGetChunkData(JNIEnv* env, jclass, jlong taskId) {
     try {
         // This would retrieve the actual chunk data from the completed future
         // For now, return empty byte array (placeholder)
@@ -141,8 +139,7 @@ JNIEXPORT jbyteArray JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetChunkDa
     }
 }
 
-JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeCancelTask
-(JNIEnv* env, jclass clazz, jlong taskId) {
+jboolean nativeCancelTask(JNIEnv* env, jclass, jlong taskId) {
     try {
         // This would cancel the async task
         // For now, return true to indicate cancellation successful (placeholder)
@@ -153,8 +150,7 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeCancelTask
     }
 }
 
-JNIEXPORT jint JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetPlatform
-(JNIEnv* env, jclass clazz) {
+jint nativeGetPlatform(JNIEnv* env, jclass) {
     try {
         #ifdef __linux__
             return 0; // LINUX
@@ -171,16 +167,13 @@ JNIEXPORT jint JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetPlatform
     }
 }
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetOutstandingOps
-(JNIEnv* env, jclass clazz, jlong ioId) {
+jlong nativeGetOutstandingOps(JNIEnv* env, jclass, jlong ioId) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return 0;
         }
-        
+
         // This would return the number of outstanding operations
         // For now, return 0 (placeholder)
         return 0;
@@ -190,18 +183,13 @@ JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetOutstandingO
     }
 }
 
-JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeSetMemoryMapped
-(JNIEnv* env, jclass clazz, jlong ioId, jboolean enable) {
+jboolean nativeSetMemoryMapped(JNIEnv* env, jclass, jlong ioId, jboolean enable) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return JNI_FALSE;
         }
         
-        auto& chunkIO = it->second;
-        
         // This would enable/disable memory mapping
         // For now, just return true (placeholder)
         return JNI_TRUE;
@@ -211,16 +199,13 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeSetMemoryMap
     }
 }
 
-JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeFlushAll
-(JNIEnv* env, jclass clazz, jlong ioId) {
+jboolean nativeFlushAll(JNIEnv* env, jclass, jlong ioId) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return JNI_FALSE;
         }
-        
+
         // This would flush all pending operations
         // For now, just return true (placeholder)
         return JNI_TRUE;
@@ -234,16 +219,13 @@ JNIEXPORT jboolean JNICALL Java_io_lattice_world_AsyncChunkIO_nativeFlushAll
 // Performance Monitoring JNI Bridge
 // ========================================
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetAverageReadLatency
-(JNIEnv* env, jclass clazz, jlong ioId) {
+jlong nativeGetAverageReadLatency(JNIEnv* env, jclass, jlong ioId) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return 0;
         }
-        
+
         // This would calculate average read latency in nanoseconds
         // For now, return 0 (placeholder)
         return 0;
@@ -253,16 +235,13 @@ JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetAverageReadL
     }
 }
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetAverageWriteLatency
-(JNIEnv* env, jclass clazz, jlong ioId) {
+jlong nativeGetAverageWriteLatency(JNIEnv* env, jclass, jlong ioId) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return 0;
         }
-        
+
         // This would calculate average write latency in nanoseconds
         // For now, return 0 (placeholder)
         return 0;
@@ -272,16 +251,13 @@ JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetAverageWrite
     }
 }
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetBytesRead
-(JNIEnv* env, jclass clazz, jlong ioId) {
+jlong nativeGetBytesRead(JNIEnv* env, jclass, jlong ioId) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return 0;
         }
-        
+
         // This would return total bytes read
         // For now, return 0 (placeholder)
         return 0;
@@ -291,16 +267,13 @@ JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetBytesRead
     }
 }
 
-JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetBytesWritten
-(JNIEnv* env, jclass clazz, jlong ioId) {
+jlong nativeGetBytesWritten(JNIEnv* env, jclass, jlong ioId) {
     try {
-        std::shared_lock<std::mutex> lock(gChunkIOMutex);
-        auto it = gChunkIOInstances.find(ioId);
-        if (it == gChunkIOInstances.end()) {
-            jni::throw_java_exception(env, "java/lang/IllegalArgumentException", "Invalid chunk IO ID");
+        auto chunkIO = findChunkIO(env, ioId);
+        if (!chunkIO) {
             return 0;
         }
-        
+
         // This would return total bytes written
         // For now, return 0 (placeholder)
         return 0;
@@ -310,4 +283,23 @@ JNIEXPORT jlong JNICALL Java_io_lattice_world_AsyncChunkIO_nativeGetBytesWritten
     }
 }
 
-} // extern "C"
\ No newline at end of file
+// 在JNI_OnLoad中注册（JniRegistry），桥接函数不再按Java_*导出
+lattice::jni::JniNativeTable ASYNC_CHUNK_IO_NATIVES("io/lattice/world/AsyncChunkIO", {
+    {(char*)"nativeCreateIO", (char*)"(I)J", (void*)nativeCreateIO},
+    {(char*)"nativeDestroyIO", (char*)"(J)V", (void*)nativeDestroyIO},
+    {(char*)"nativeLoadChunkAsync", (char*)"(JII)J", (void*)nativeLoadChunkAsync},
+    {(char*)"nativeSaveChunkAsync", (char*)"(JII[B)J", (void*)nativeSaveChunkAsync},
+    {(char*)"nativeIsTaskComplete", (char*)"(J)Z", (void*)nativeIsTaskComplete},
+    {(char*)"nativeGetChunkData", (char*)"(J)[B", (void*)nativeGetChunkData},
+    {(char*)"nativeCancelTask", (char*)"(J)Z", (void*)nativeCancelTask},
+    {(char*)"nativeGetPlatform", (char*)"()I", (void*)nativeGetPlatform},
+    {(char*)"nativeGetOutstandingOps", (char*)"(J)J", (void*)nativeGetOutstandingOps},
+    {(char*)"nativeSetMemoryMapped", (char*)"(JZ)Z", (void*)nativeSetMemoryMapped},
+    {(char*)"nativeFlushAll", (char*)"(J)Z", (void*)nativeFlushAll},
+    {(char*)"nativeGetAverageReadLatency", (char*)"(J)J", (void*)nativeGetAverageReadLatency},
+    {(char*)"nativeGetAverageWriteLatency", (char*)"(J)J", (void*)nativeGetAverageWriteLatency},
+    {(char*)"nativeGetBytesRead", (char*)"(J)J", (void*)nativeGetBytesRead},
+    {(char*)"nativeGetBytesWritten", (char*)"(J)J", (void*)nativeGetBytesWritten},
+});
+
+} // namespace
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../instance_registry.hpp"
+#include "../world/async_chunk_io.hpp"
+
+namespace lattice {
+namespace jni {
+
+// io.lattice.world.AsyncChunkIO创建的实例（nativeCreateIO返回的句柄），
+// NativeInterface的资源统计与清理也通过这里访问同一份实例
+InstanceRegistry<lattice::world::AsyncChunkIO>& asyncChunkIOInstances();
+
+} // namespace jni
+} // namespace lattice
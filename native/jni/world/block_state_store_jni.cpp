@@ -0,0 +1,169 @@
+#include "../jni_registry.hpp"
+#include "../lattice_ffi.h"
+#include "../../core/world/block_state_store.hpp"
+#include "../../core/world/pathfinder.hpp"
+#include <jni.h>
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+
+namespace lattice {
+namespace jni {
+namespace world {
+
+namespace {
+
+using lattice::world::BlockStateSectionData;
+using lattice::world::BlockStateStore;
+using lattice::world::PathfinderOptimizer;
+
+// 光照、寻路、AI都在lattice_optimization_jni中，方块状态只注册在这个库
+constexpr const char* BLOCK_STATES_CLASS = "io/lattice/nativeutil/NativeBlockStates";
+
+uint64_t publishAndSync() {
+    BlockStateStore& store = BlockStateStore::instance();
+    const uint64_t version = store.publish();
+    // 寻路快照跟随每次发布（只转换变化的段）；没有上传分类表时跳过
+    PathfinderOptimizer::get_instance().sync_block_states(store.snapshot());
+    return version;
+}
+
+jboolean JNICALL loadSection(JNIEnv* env, jclass clazz, jint chunkX, jint sectionY, jint chunkZ,
+                             jintArray palette, jlongArray data) {
+    if (!palette) {
+        return JNI_FALSE;
+    }
+    const jsize paletteLength = env->GetArrayLength(palette);
+    std::vector<jint> ids(static_cast<size_t>(paletteLength));
+    env->GetIntArrayRegion(palette, 0, paletteLength, ids.data());
+    std::vector<uint16_t> states(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (ids[i] < 0 || ids[i] > UINT16_MAX) {
+            return JNI_FALSE;
+        }
+        states[i] = static_cast<uint16_t>(ids[i]);
+    }
+
+    std::vector<int64_t> words;
+    if (data) {
+        words.resize(static_cast<size_t>(env->GetArrayLength(data)));
+        env->GetLongArrayRegion(data, 0, static_cast<jsize>(words.size()), reinterpret_cast<jlong*>(words.data()));
+    }
+    return BlockStateStore::instance().loadSection(chunkX, sectionY, chunkZ, states, words) ? JNI_TRUE : JNI_FALSE;
+}
+
+void JNICALL loadSectionStates(JNIEnv* env, jclass clazz, jint chunkX, jint sectionY, jint chunkZ,
+                               jshortArray states) {
+    if (!states || env->GetArrayLength(states) < static_cast<jsize>(BlockStateSectionData::VOLUME)) {
+        return;
+    }
+    std::array<uint16_t, BlockStateSectionData::VOLUME> values;
+    env->GetShortArrayRegion(states, 0, static_cast<jsize>(values.size()), reinterpret_cast<jshort*>(values.data()));
+    BlockStateStore::instance().loadSection(chunkX, sectionY, chunkZ, values.data());
+}
+
+// 返回变化前的状态id，区块未载入时返回-1
+jint JNICALL setBlock(JNIEnv* env, jclass clazz, jint x, jint y, jint z, jint state) {
+    const uint32_t previous = BlockStateStore::instance().setBlock(x, y, z, static_cast<uint16_t>(state));
+    return previous == BlockStateStore::NOT_LOADED ? -1 : static_cast<jint>(previous);
+}
+
+jint JNICALL setBlocks(JNIEnv* env, jclass clazz, jlongArray positions, jintArray states) {
+    if (!positions || !states) {
+        return 0;
+    }
+    const jsize count = std::min(env->GetArrayLength(positions), env->GetArrayLength(states));
+    thread_local std::vector<int64_t> packed;
+    thread_local std::vector<jint> ids;
+    thread_local std::vector<uint16_t> narrowed;
+    packed.resize(static_cast<size_t>(count));
+    ids.resize(static_cast<size_t>(count));
+    narrowed.resize(static_cast<size_t>(count));
+    env->GetLongArrayRegion(positions, 0, count, reinterpret_cast<jlong*>(packed.data()));
+    env->GetIntArrayRegion(states, 0, count, ids.data());
+    for (jsize i = 0; i < count; ++i) {
+        narrowed[i] = static_cast<uint16_t>(ids[i]);
+    }
+    return static_cast<jint>(BlockStateStore::instance().setBlocks(packed, narrowed));
+}
+
+void JNICALL unloadChunk(JNIEnv* env, jclass clazz, jint chunkX, jint chunkZ) {
+    BlockStateStore::instance().unloadChunk(chunkX, chunkZ);
+}
+
+jlong JNICALL publish(JNIEnv* env, jclass clazz) {
+    return static_cast<jlong>(publishAndSync());
+}
+
+// 下标为方块状态id，值为PathBlockType
+void JNICALL setPathBlockTypes(JNIEnv* env, jclass clazz, jbyteArray types) {
+    if (!types) {
+        return;
+    }
+    std::vector<uint8_t> values(static_cast<size_t>(env->GetArrayLength(types)));
+    env->GetByteArrayRegion(types, 0, static_cast<jsize>(values.size()), reinterpret_cast<jbyte*>(values.data()));
+    PathfinderOptimizer::get_instance().set_block_type_table(values.data(), values.size());
+}
+
+// [version, columns, published, sectionsLoaded, blockChanges, ignoredChanges,
+//  sectionsCopied, sectionsCompacted, chunksUnloaded, memoryBytes]
+jlongArray JNICALL stats(JNIEnv* env, jclass clazz) {
+    BlockStateStore& store = BlockStateStore::instance();
+    const auto snapshot = store.snapshot();
+    const BlockStateStore::Stats& stats = store.getStats();
+    const jlong values[] = {
+        static_cast<jlong>(snapshot->version()),
+        static_cast<jlong>(snapshot->columnCount()),
+        static_cast<jlong>(stats.published.load(std::memory_order_relaxed)),
+        static_cast<jlong>(stats.sectionsLoaded.load(std::memory_order_relaxed)),
+        static_cast<jlong>(stats.blockChanges.load(std::memory_order_relaxed)),
+        static_cast<jlong>(stats.ignoredChanges.load(std::memory_order_relaxed)),
+        static_cast<jlong>(stats.sectionsCopied.load(std::memory_order_relaxed)),
+        static_cast<jlong>(stats.sectionsCompacted.load(std::memory_order_relaxed)),
+        static_cast<jlong>(stats.chunksUnloaded.load(std::memory_order_relaxed)),
+        static_cast<jlong>(store.memoryUsage()),
+    };
+    const jsize length = static_cast<jsize>(sizeof(values) / sizeof(values[0]));
+    jlongArray result = env->NewLongArray(length);
+    if (result != nullptr) {
+        env->SetLongArrayRegion(result, 0, length, values);
+    }
+    return result;
+}
+
+// 在所在库的JNI_OnLoad中注册（JniRegistry）
+JniNativeTable BLOCK_STATES_NATIVES(BLOCK_STATES_CLASS, {
+    {(char*)"nativeLoadSection", (char*)"(III[I[J)Z", (void*)loadSection},
+    {(char*)"nativeLoadSectionStates", (char*)"(III[S)V", (void*)loadSectionStates},
+    {(char*)"nativeSetBlock", (char*)"(IIII)I", (void*)setBlock},
+    {(char*)"nativeSetBlocks", (char*)"([J[I)I", (void*)setBlocks},
+    {(char*)"nativeUnloadChunk", (char*)"(II)V", (void*)unloadChunk},
+    {(char*)"nativePublish", (char*)"()J", (void*)publish},
+    {(char*)"nativeSetPathBlockTypes", (char*)"([B)V", (void*)setPathBlockTypes},
+    {(char*)"nativeStats", (char*)"()[J", (void*)stats}
+});
+
+} // namespace
+
+} // namespace world
+} // namespace jni
+} // namespace lattice
+
+extern "C" {
+
+LATTICE_FFI_EXPORT int32_t lattice_block_states_set(const int64_t* positions, const uint16_t* states,
+                                                    int32_t count) {
+    if (count < 0 || (count > 0 && (!positions || !states))) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    return static_cast<int32_t>(lattice::world::BlockStateStore::instance().setBlocks(
+        std::span<const int64_t>(positions, static_cast<size_t>(count)),
+        std::span<const uint16_t>(states, static_cast<size_t>(count))));
+}
+
+LATTICE_FFI_EXPORT int64_t lattice_block_states_publish(void) {
+    return static_cast<int64_t>(lattice::jni::world::publishAndSync());
+}
+
+} // extern "C"
@@ -1,4 +1,7 @@
 #include "light_engine_optimized_jni.hpp"
+#include "../jni_registry.hpp"
+#include "../lattice_ffi.h"
+#include "../../core/workload_trace.hpp"
 #include <chrono>
 #include <vector>
 #include <string>
@@ -10,6 +13,9 @@ namespace lattice {
 namespace jni {
 namespace world {
 
+using lattice::core::TraceEvent;
+using lattice::core::WorkloadRecorder;
+
 // JNI方法注册
 static JNINativeMethod gMethods[] = {
     {(char*)"addLightSource", (char*)"(IIIIII)Z", 
@@ -23,7 +29,11 @@ static JNINativeMethod gMethods[] = {
     {(char*)"getLightLevel", (char*)"(III)B", 
      (void*)LightEngineOptimizedBridge::getLightLevel},
     {(char*)"getLightingStats", (char*)"()Ljava/lang/String;", 
-     (void*)LightEngineOptimizedBridge::getLightingStats}
+     (void*)LightEngineOptimizedBridge::getLightingStats},
+    {(char*)"writeLightPacket", (char*)"(IIIILjava/nio/ByteBuffer;)I", 
+     (void*)LightEngineOptimizedBridge::writeLightPacket},
+    {(char*)"getLightPacketCapacity", (char*)"(I)I", 
+     (void*)LightEngineOptimizedBridge::getLightPacketCapacity}
 };
 
 // JNI OnLoad注册
@@ -45,7 +55,8 @@ JNI_OnLoad(JavaVM* vm, void* reserved) {
     }
     
     env->DeleteLocalRef(cls);
-    return JNI_VERSION_1_8;
+    // 解析各桥接登记的类与方法ID
+    return lattice::jni::JniRegistry::onLoad(vm);
 }
 
 jboolean LightEngineOptimizedBridge::addLightSource(JNIEnv* env, jclass clazz,
@@ -68,13 +79,11 @@ jboolean LightEngineOptimizedBridge::addLightSource(JNIEnv* env, jclass clazz,
         auto pos = lattice::world::BlockPos(x, y, z);
         auto type = (lightType == 0) ? lattice::world::LightType::BLOCK : lattice::world::LightType::SKY;
         
+        if (auto record = WorkloadRecorder::begin(TraceEvent::LIGHT_SOURCE_ADD)) {
+            record.i32(x).i32(y).i32(z).i32(level).i32(lightType);
+        }
         // 所有光照优化逻辑在core中（SIMD传播、批量处理等）
-        // 注意：这里需要全局的LightUpdater实例，实际实现中可能需要单例或线程局部
-        // static lattice::world::LightUpdater globalUpdater;
-        // globalUpdater.addLightSource(pos, type);
-        
-        // TODO: 实际实现需要全局或线程局部的LightUpdater实例
-        // 暂时模拟操作
+        updater().addLightSource(pos, static_cast<uint8_t>(level), type);
         return JNI_TRUE;
         
     } catch (const std::exception& e) {
@@ -101,9 +110,11 @@ jboolean LightEngineOptimizedBridge::removeLightSource(JNIEnv* env, jclass clazz
         auto pos = lattice::world::BlockPos(x, y, z);
         auto type = (lightType == 0) ? lattice::world::LightType::BLOCK : lattice::world::LightType::SKY;
         
+        if (auto record = WorkloadRecorder::begin(TraceEvent::LIGHT_SOURCE_REMOVE)) {
+            record.i32(x).i32(y).i32(z).i32(lightType);
+        }
         // 所有光照优化逻辑在core中
-        // static lattice::world::LightUpdater globalUpdater;
-        // globalUpdater.removeLightSource(pos, type);
+        updater().removeLightSource(pos, type);
         
         return JNI_TRUE;
         
@@ -117,9 +128,9 @@ jboolean LightEngineOptimizedBridge::removeLightSource(JNIEnv* env, jclass clazz
 jboolean LightEngineOptimizedBridge::propagateLighting(JNIEnv* env, jclass clazz) {
     // JNI职责3: 调用core中的批处理传播函数
     try {
+        WorkloadRecorder::mark(TraceEvent::LIGHT_PROPAGATE);
         // 所有光照传播优化逻辑在core中（批处理、SIMD传播算法等）
-        // static lattice::world::LightUpdater globalUpdater;
-        // globalUpdater.propagateLightUpdates();
+        updater().propagateLightUpdates();
         
         return JNI_TRUE;
         
@@ -206,11 +217,7 @@ jbyte LightEngineOptimizedBridge::getLightLevel(JNIEnv* env, jclass clazz,
         auto type = (lightType == 0) ? lattice::world::LightType::BLOCK : lattice::world::LightType::SKY;
         
         // 所有光照查询优化逻辑在core中（缓存、SIMD查询等）
-        // static lattice::world::LightUpdater globalUpdater;
-        // uint8_t level = globalUpdater.getLightLevel(pos, type);
-        
-        // 临时返回模拟值
-        return 0;
+        return static_cast<jbyte>(updater().getLightLevel(pos, type));
         
     } catch (const std::exception& e) {
         throwJNIException(env, "java/lang/RuntimeException", 
@@ -239,6 +246,32 @@ jstring LightEngineOptimizedBridge::getLightingStats(JNIEnv* env, jclass clazz)
     }
 }
 
+jint LightEngineOptimizedBridge::writeLightPacket(JNIEnv* env, jclass clazz, jint chunkX, jint chunkZ,
+                                                 jint minSection, jint sectionCount, jobject buffer) {
+    // JNI职责1: 参数验证
+    if (buffer == nullptr) {
+        return -1;
+    }
+    
+    // JNI职责2: 直接写入Java缓冲区，不经过中间数组（编码与C ABI共用）
+    void* address = env->GetDirectBufferAddress(buffer);
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (!address || capacity <= 0) {
+        return -1;
+    }
+    return lattice_light_write_packet(chunkX, chunkZ, minSection, sectionCount,
+                                      static_cast<uint8_t*>(address), capacity);
+}
+
+jint LightEngineOptimizedBridge::getLightPacketCapacity(JNIEnv* env, jclass clazz, jint sectionCount) {
+    return lattice_light_packet_capacity(sectionCount);
+}
+
+lattice::world::LightUpdater& LightEngineOptimizedBridge::updater() {
+    static lattice::world::LightUpdater instance;
+    return instance;
+}
+
 bool LightEngineOptimizedBridge::validateCoordinates(JNIEnv* env, jint x, jint y, jint z) {
     // Minecraft世界范围验证（简化版）
     if (x < -30000000 || x > 30000000) {
@@ -301,3 +334,27 @@ void LightEngineOptimizedBridge::throwJNIException(JNIEnv* env, const char* exce
 } // namespace world
 } // namespace jni
 } // namespace lattice
+
+// ===== C ABI（lattice_ffi.h） =====
+
+LATTICE_FFI_EXPORT int32_t lattice_light_packet_capacity(int32_t sectionCount) {
+    // 段数上限与原版世界高度上限4064格一致
+    if (sectionCount <= 0 || sectionCount > 256) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    return static_cast<int32_t>(lattice::world::ChunkedLightStorage::lightPacketCapacity(sectionCount));
+}
+
+LATTICE_FFI_EXPORT int32_t lattice_light_write_packet(int32_t chunkX, int32_t chunkZ, int32_t minSection,
+                                                      int32_t sectionCount, uint8_t* out, int64_t capacity) {
+    if (!out || capacity <= 0 || sectionCount <= 0 || sectionCount > 256) {
+        return LATTICE_FFI_INVALID_ARGUMENT;
+    }
+    try {
+        const size_t written = lattice::jni::world::LightEngineOptimizedBridge::updater().getStorage().writeLightPacket(
+            chunkX, chunkZ, minSection, sectionCount, out, static_cast<size_t>(capacity));
+        return written > 0 ? static_cast<int32_t>(written) : LATTICE_FFI_CAPACITY;
+    } catch (...) {
+        return LATTICE_FFI_FAILED;
+    }
+}
@@ -5,6 +5,10 @@
 #include <vector>
 
 namespace lattice {
+namespace world {
+class LightUpdater;
+} // namespace world
+
 namespace jni {
 namespace world {
 
@@ -88,7 +92,33 @@ public:
      */
     static jstring getLightingStats(JNIEnv* env, jclass clazz);
 
+    /**
+     * @brief 把区块光照按光照更新包的格式直接写入DirectByteBuffer
+     * 
+     * 依次为天空光/方块光/空天空光/空方块光段掩码与两组nibble数组（见ChunkedLightStorage::writeLightPacket），
+     * Java侧直接把缓冲区内容写进包，不再逐格调用getLightLevel。
+     * @param env JNI环境
+     * @param chunkX 区块X坐标
+     * @param chunkZ 区块Z坐标
+     * @param minSection 掩码第0位对应的段（世界最低段 - 1）
+     * @param sectionCount 光照段数（世界段数 + 2）
+     * @param buffer 写入目标，容量见getLightPacketCapacity
+     * @return 写入的字节数，-1表示参数或缓冲区无效，-2表示容量不足，-3表示发生异常
+     */
+    static jint writeLightPacket(JNIEnv* env, jclass clazz, jint chunkX, jint chunkZ,
+                                 jint minSection, jint sectionCount, jobject buffer);
+
+    /**
+     * @brief writeLightPacket最多写入的字节数
+     * @param sectionCount 光照段数
+     */
+    static jint getLightPacketCapacity(JNIEnv* env, jclass clazz, jint sectionCount);
+
+    // 所有桥接方法与C ABI（lattice_ffi.h）共用的光照更新器（由Java光照线程串行调用）
+    static lattice::world::LightUpdater& updater();
+
 private:
+    
     // JNI辅助函数
     static void throwJNIException(JNIEnv* env, const char* exceptionClass, const char* message);
     static bool validateCoordinates(JNIEnv* env, jint x, jint y, jint z);
@@ -0,0 +1,118 @@
+#include "path_scheduler_jni.hpp"
+#include "../../core/world/path_scheduler.hpp"
+#include <string>
+#include <vector>
+
+using lattice::world::PathScheduler;
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeSetBudget
+  (JNIEnv *env, jclass clazz, jint tickBudget, jint slice) {
+    
+    if (tickBudget <= 0 || slice <= 0) {
+        return -1;
+    }
+    PathScheduler::get_instance().set_budget(static_cast<uint32_t>(tickBudget), static_cast<uint32_t>(slice));
+    return 0;
+}
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeSetPlayers
+  (JNIEnv *env, jclass clazz, jintArray xyz) {
+    
+    if (xyz == nullptr) {
+        return -1;
+    }
+    const jsize length = env->GetArrayLength(xyz);
+    if (length % 3 != 0) {
+        return -1;
+    }
+    std::vector<jint> values(static_cast<size_t>(length));
+    env->GetIntArrayRegion(xyz, 0, length, values.data());
+    
+    std::vector<lattice::world::Node> players;
+    players.reserve(values.size() / 3);
+    for (size_t i = 0; i + 2 < values.size(); i += 3) {
+        players.emplace_back(values[i], values[i + 1], values[i + 2]);
+    }
+    PathScheduler::get_instance().set_players(std::move(players));
+    return 0;
+}
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeSubmit
+  (JNIEnv *env, jclass clazz, jlong requestId, jint startX, jint startY, jint startZ,
+   jint goalX, jint goalY, jint goalZ, jint mobType, jint maxNodes) {
+    
+    if (mobType < 0 || mobType > static_cast<jint>(lattice::world::MobType::FLYING) || maxNodes < 0) {
+        return -1;
+    }
+    
+    lattice::world::PathRequest request;
+    request.request_id = static_cast<uint64_t>(requestId);
+    request.start = lattice::world::Node(startX, startY, startZ);
+    request.goal = lattice::world::Node(goalX, goalY, goalZ);
+    request.mob_type = static_cast<lattice::world::MobType>(mobType);
+    if (maxNodes > 0) {
+        request.max_nodes = static_cast<uint32_t>(maxNodes);
+    }
+    
+    try {
+        PathScheduler::get_instance().submit(request);
+        return 0;
+    } catch (const std::exception& e) {
+        env->ThrowNew(env->FindClass("java/lang/RuntimeException"), e.what());
+        return -1;
+    }
+}
+
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathScheduler_nativeCancel
+  (JNIEnv *env, jclass clazz, jlong requestId) {
+    
+    PathScheduler::get_instance().cancel(static_cast<uint64_t>(requestId));
+}
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeTick
+  (JNIEnv *env, jclass clazz) {
+    
+    try {
+        auto& scheduler = PathScheduler::get_instance();
+        scheduler.tick();
+        return static_cast<jint>(scheduler.ready_count());
+    } catch (const std::exception& e) {
+        env->ThrowNew(env->FindClass("java/lang/RuntimeException"), e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativePollResults
+  (JNIEnv *env, jclass clazz, jobject buffer) {
+    
+    if (buffer == nullptr) {
+        return -1;
+    }
+    auto* address = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < 0) {
+        return -1;
+    }
+    
+    auto& scheduler = PathScheduler::get_instance();
+    size_t written = 0;
+    const size_t count = scheduler.write_results(address, static_cast<size_t>(capacity), written);
+    if (count == 0 && scheduler.ready_count() > 0) {
+        return -2;
+    }
+    return static_cast<jint>(count);
+}
+
+JNIEXPORT jstring JNICALL Java_io_lattice_world_NativePathScheduler_nativeGetStats
+  (JNIEnv *env, jclass clazz) {
+    
+    const auto& stats = PathScheduler::get_instance().get_stats();
+    std::string text = "PathScheduler: submitted=" + std::to_string(stats.submitted.load()) +
+                       ", completed=" + std::to_string(stats.completed.load()) +
+                       ", superseded=" + std::to_string(stats.superseded.load()) +
+                       ", slices=" + std::to_string(stats.slices.load()) +
+                       ", nodesExpanded=" + std::to_string(stats.nodes_expanded.load()) +
+                       ", budgetExhaustedTicks=" + std::to_string(stats.budget_exhausted.load()) +
+                       ", maxTicks=" + std::to_string(stats.max_ticks.load());
+    return env->NewStringUTF(text.c_str());
+}
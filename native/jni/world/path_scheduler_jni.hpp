@@ -0,0 +1,58 @@
+#ifndef PATH_SCHEDULER_JNI_HPP
+#define PATH_SCHEDULER_JNI_HPP
+
+#include <jni.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NativePathScheduler 类的方法（按tick分片执行的寻路，全部在主线程调用）
+
+/**
+ * 设置每tick所有搜索共用的节点预算与单个搜索每tick的节点数
+ * @return 0成功，-1参数无效
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeSetBudget
+  (JNIEnv *, jclass, jint tickBudget, jint slice);
+
+/**
+ * 设置玩家位置，xyz为 n * (x, y, z)；离玩家近的搜索优先分配预算
+ * @return 0成功，-1参数无效
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeSetPlayers
+  (JNIEnv *, jclass, jintArray xyz);
+
+/**
+ * 提交寻路请求；同一requestId重复提交时替换进行中的搜索
+ * @return 0成功，-1参数无效
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeSubmit
+  (JNIEnv *, jclass, jlong requestId, jint startX, jint startY, jint startZ,
+   jint goalX, jint goalY, jint goalZ, jint mobType, jint maxNodes);
+
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathScheduler_nativeCancel
+  (JNIEnv *, jclass, jlong requestId);
+
+/**
+ * 每tick调用一次：在节点预算内推进搜索
+ * @return 可取出的结果数
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativeTick
+  (JNIEnv *, jclass);
+
+/**
+ * 把完成的结果写入direct ByteBuffer，格式同NativePathService.nativePollResults
+ * @return 写入的结果数；-1缓冲区无效，-2缓冲区放不下下一条结果
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathScheduler_nativePollResults
+  (JNIEnv *, jclass, jobject buffer);
+
+JNIEXPORT jstring JNICALL Java_io_lattice_world_NativePathScheduler_nativeGetStats
+  (JNIEnv *, jclass);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PATH_SCHEDULER_JNI_HPP
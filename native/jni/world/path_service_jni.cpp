@@ -0,0 +1,87 @@
+#include "path_service_jni.hpp"
+#include "../../core/world/path_service.hpp"
+#include <string>
+
+using lattice::world::PathService;
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathService_nativeSubmit
+  (JNIEnv *env, jclass clazz, jlong requestId, jint startX, jint startY, jint startZ,
+   jint goalX, jint goalY, jint goalZ, jint mobType, jint maxNodes) {
+    
+    if (mobType < 0 || mobType > static_cast<jint>(lattice::world::MobType::FLYING) || maxNodes < 0) {
+        return -1;
+    }
+    
+    lattice::world::PathRequest request;
+    request.request_id = static_cast<uint64_t>(requestId);
+    request.start = lattice::world::Node(startX, startY, startZ);
+    request.goal = lattice::world::Node(goalX, goalY, goalZ);
+    request.mob_type = static_cast<lattice::world::MobType>(mobType);
+    if (maxNodes > 0) {
+        request.max_nodes = static_cast<uint32_t>(maxNodes);
+    }
+    
+    try {
+        PathService::get_instance().submit(request);
+        return 0;
+    } catch (const std::exception& e) {
+        env->ThrowNew(env->FindClass("java/lang/RuntimeException"), e.what());
+        return -1;
+    }
+}
+
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathService_nativeCancel
+  (JNIEnv *env, jclass clazz, jlong requestId) {
+    
+    PathService::get_instance().cancel(static_cast<uint64_t>(requestId));
+}
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathService_nativeTick
+  (JNIEnv *env, jclass clazz) {
+    
+    try {
+        auto& service = PathService::get_instance();
+        service.tick();
+        return static_cast<jint>(service.ready_count());
+    } catch (const std::exception& e) {
+        env->ThrowNew(env->FindClass("java/lang/RuntimeException"), e.what());
+        return 0;
+    }
+}
+
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathService_nativePollResults
+  (JNIEnv *env, jclass clazz, jobject buffer) {
+    
+    if (buffer == nullptr) {
+        return -1;
+    }
+    auto* address = static_cast<uint8_t*>(env->GetDirectBufferAddress(buffer));
+    const jlong capacity = env->GetDirectBufferCapacity(buffer);
+    if (address == nullptr || capacity < 0) {
+        return -1;
+    }
+    
+    auto& service = PathService::get_instance();
+    size_t written = 0;
+    const size_t count = service.write_results(address, static_cast<size_t>(capacity), written);
+    if (count == 0 && service.ready_count() > 0) {
+        return -2;
+    }
+    return static_cast<jint>(count);
+}
+
+JNIEXPORT jstring JNICALL Java_io_lattice_world_NativePathService_nativeGetStats
+  (JNIEnv *env, jclass clazz) {
+    
+    const auto& stats = PathService::get_instance().get_stats();
+    std::string text = "PathService: submitted=" + std::to_string(stats.submitted.load()) +
+                       ", searches=" + std::to_string(stats.searches.load()) +
+                       ", hierarchical=" + std::to_string(stats.hierarchical.load()) +
+                       ", deduplicated=" + std::to_string(stats.deduplicated.load()) +
+                       ", suffixReused=" + std::to_string(stats.suffix_reused.load()) +
+                       ", flowField=" + std::to_string(stats.flow_field.load()) +
+                       ", superseded=" + std::to_string(stats.superseded.load()) +
+                       ", batches=" + std::to_string(stats.batches.load()) +
+                       ", delivered=" + std::to_string(stats.delivered.load());
+    return env->NewStringUTF(text.c_str());
+}
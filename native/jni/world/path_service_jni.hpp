@@ -0,0 +1,45 @@
+#ifndef PATH_SERVICE_JNI_HPP
+#define PATH_SERVICE_JNI_HPP
+
+#include <jni.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// NativePathService 类的方法（异步批量寻路，全部在主线程调用）
+
+/**
+ * 提交寻路请求，结果最早在下一tick交付；同一requestId重复提交时替换旧请求
+ * @return 0成功，-1参数无效
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathService_nativeSubmit
+  (JNIEnv *, jclass, jlong requestId, jint startX, jint startY, jint startZ,
+   jint goalX, jint goalY, jint goalZ, jint mobType, jint maxNodes);
+
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathService_nativeCancel
+  (JNIEnv *, jclass, jlong requestId);
+
+/**
+ * 每tick调用一次：交付已完成的结果并派发本tick提交的请求
+ * @return 可取出的结果数
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathService_nativeTick
+  (JNIEnv *, jclass);
+
+/**
+ * 把已交付的结果写入direct ByteBuffer（本机字节序），写不下的留到下次调用
+ * 每条: long requestId, int flags(1到达目标, 2共享结果), int 节点数n, n * (int x, y, z)
+ * @return 写入的结果数；-1缓冲区无效，-2缓冲区放不下下一条结果
+ */
+JNIEXPORT jint JNICALL Java_io_lattice_world_NativePathService_nativePollResults
+  (JNIEnv *, jclass, jobject buffer);
+
+JNIEXPORT jstring JNICALL Java_io_lattice_world_NativePathService_nativeGetStats
+  (JNIEnv *, jclass);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PATH_SERVICE_JNI_HPP
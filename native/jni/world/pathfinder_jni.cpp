@@ -1,5 +1,7 @@
 #include "pathfinder_jni.hpp"
 #include "../../core/world/pathfinder.hpp"
+#include "../../optimization/ring_channel.hpp"
+#include <cstring>
 #include <iostream>
 #include <vector>
 #include <string>
@@ -22,6 +24,12 @@ static jfieldID speed_factor_field = nullptr;
 #define LOGW(...) std::cerr << "[PathfinderJNI][WARN] " << __VA_ARGS__ << std::endl
 #define LOGI(...) std::cout << "[PathfinderJNI][INFO] " << __VA_ARGS__ << std::endl
 
+// 超出范围的分类按SOLID处理
+static lattice::world::PathBlockType to_path_block_type(int32_t type) {
+    return type >= 0 && type <= static_cast<int32_t>(lattice::world::PathBlockType::FENCE)
+        ? static_cast<lattice::world::PathBlockType>(type) : lattice::world::PathBlockType::SOLID;
+}
+
 /**
  * 初始化JNI方法ID缓存
  */
@@ -146,7 +154,7 @@ JNIEXPORT jobjectArray JNICALL Java_io_lattice_world_NativePathfinder_nativeOpti
         for (jsize i = 0; i < arrayLength; ++i) {
             const auto& node = path[i];
             jobject pathNode = env->NewObject(path_node_class, path_node_constructor, 
-                                            node->x, node->y, node->z);
+                                            node.x, node.y, node.z);
             if (pathNode != nullptr) {
                 env->SetObjectArrayElement(pathArray, i, pathNode);
                 env->DeleteLocalRef(pathNode);
@@ -211,4 +219,88 @@ JNIEXPORT jobject JNICALL Java_io_lattice_world_NativePathfinder_nativeGetMobPat
         env->ThrowNew(env->FindClass("java/lang/Exception"), "Unknown C++ exception");
         return nullptr;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * 上传区块段的寻路方块分类
+ */
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathfinder_nativeSetSectionBlocks
+  (JNIEnv *env, jclass clazz, jint chunk_x, jint section_y, jint chunk_z, jbyteArray types) {
+    
+    auto& optimizer = lattice::world::PathfinderOptimizer::get_instance();
+    if (types == nullptr) {
+        optimizer.set_section(chunk_x, section_y, chunk_z, nullptr);
+        return;
+    }
+    if (env->GetArrayLength(types) < 4096) {
+        LOGW("段方块数组长度不足4096，忽略");
+        return;
+    }
+    
+    jbyte buffer[4096];
+    env->GetByteArrayRegion(types, 0, 4096, buffer);
+    try {
+        optimizer.set_section(chunk_x, section_y, chunk_z, reinterpret_cast<const uint8_t*>(buffer));
+    } catch (const std::exception& e) {
+        env->ThrowNew(env->FindClass("java/lang/Exception"), e.what());
+    }
+}
+
+/**
+ * 单个方块变化
+ */
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathfinder_nativeSetBlock
+  (JNIEnv *env, jclass clazz, jint x, jint y, jint z, jint type) {
+    
+    try {
+        lattice::world::PathfinderOptimizer::get_instance().set_block(x, y, z, to_path_block_type(type));
+    } catch (const std::exception& e) {
+        env->ThrowNew(env->FindClass("java/lang/Exception"), e.what());
+    }
+}
+
+/**
+ * 区块卸载时移除其所有段
+ */
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathfinder_nativeClearChunk
+  (JNIEnv *env, jclass clazz, jint chunk_x, jint chunk_z) {
+    
+    lattice::world::PathfinderOptimizer::get_instance().clear_chunk(chunk_x, chunk_z);
+}
+
+// ========== 共享内存通道上的方块变化 ==========
+//
+// NativePathfinder.onBlockChange把方块变化写入SharedRingChannel，不再每次调用nativeSetBlock；
+// 记录格式见PATH_RING_BLOCK_CHANGES。段的上传与区块卸载仍走JNI，Java在调用它们之前等命令环排空，
+// 保证同一位置的变化不会越过段的上传或移除。
+
+namespace {
+
+using lattice::optimization::RingChannel;
+using lattice::optimization::RingMessage;
+using lattice::optimization::RingSubsystem;
+
+// 负载为若干条16字节记录：int32 x, y, z, type（本机字节序）
+constexpr uint16_t PATH_RING_BLOCK_CHANGES = 1;
+constexpr size_t PATH_RING_RECORD_SIZE = 16;
+
+void handle_path_ring_message(const RingMessage& message, RingChannel&) {
+    if (message.opcode() != PATH_RING_BLOCK_CHANGES) {
+        return;
+    }
+    auto& optimizer = lattice::world::PathfinderOptimizer::get_instance();
+    const size_t count = message.length / PATH_RING_RECORD_SIZE;
+    for (size_t i = 0; i < count; ++i) {
+        int32_t record[4];
+        std::memcpy(record, message.payload + i * PATH_RING_RECORD_SIZE, sizeof(record));
+        optimizer.set_block(record[0], record[1], record[2], to_path_block_type(record[3]));
+    }
+}
+
+// 库加载时登记；与shared_ring_jni.cpp在同一个库中
+const bool path_ring_handler_registered = [] {
+    RingChannel::setHandler(RingSubsystem::PATHFINDER, handle_path_ring_message);
+    return true;
+}();
+
+} // namespace
@@ -18,6 +18,16 @@ JNIEXPORT jobjectArray JNICALL Java_io_lattice_world_NativePathfinder_nativeOpti
 JNIEXPORT jobject JNICALL Java_io_lattice_world_NativePathfinder_nativeGetMobPathfindingParams
   (JNIEnv *, jclass, jint);
 
+// 寻路方块快照：types为4096字节的PathBlockType（下标(y << 8) | (z << 4) | x），null表示移除该段
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathfinder_nativeSetSectionBlocks
+  (JNIEnv *, jclass, jint, jint, jint, jbyteArray);
+
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathfinder_nativeSetBlock
+  (JNIEnv *, jclass, jint, jint, jint, jint);
+
+JNIEXPORT void JNICALL Java_io_lattice_world_NativePathfinder_nativeClearChunk
+  (JNIEnv *, jclass, jint, jint);
+
 #ifdef __cplusplus
 }
 #endif
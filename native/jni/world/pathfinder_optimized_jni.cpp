@@ -1,4 +1,5 @@
 #include "pathfinder_optimized_jni.hpp"
+#include "../jni_registry.hpp"
 #include <chrono>
 #include <vector>
 #include <string>
@@ -41,7 +42,8 @@ JNI_OnLoad(JavaVM* vm, void* reserved) {
     }
     
     env->DeleteLocalRef(cls);
-    return JNI_VERSION_1_8;
+    // 解析各桥接登记的类与方法ID
+    return lattice::jni::JniRegistry::onLoad(vm);
 }
 
 jintArray PathfinderOptimizedBridge::findPath(JNIEnv* env, jclass clazz,
@@ -64,8 +66,8 @@ jintArray PathfinderOptimizedBridge::findPath(JNIEnv* env, jclass clazz,
         auto targetPos = lattice::world::Node(targetX, targetY, targetZ);
         auto type = static_cast<lattice::world::MobType>(mobType);
         
-        // 所有寻路优化逻辑在core中（SIMD启发式、A*优化、批处理等）
-        static lattice::world::PathfinderOptimizer optimizer;
+        // 所有寻路优化逻辑在core中；与方块快照上传共用单例，寻路在最新快照上进行
+        auto& optimizer = lattice::world::PathfinderOptimizer::get_instance();
         auto path = optimizer.optimize_pathfinding(startX, startY, startZ,
                                                   targetX, targetY, targetZ,
                                                   type);
@@ -82,9 +84,9 @@ jintArray PathfinderOptimizedBridge::findPath(JNIEnv* env, jclass clazz,
         resultData.reserve(path.size() * 3);
         
         for (const auto& node : path) {
-            resultData.push_back(node->x);
-            resultData.push_back(node->y);
-            resultData.push_back(node->z);
+            resultData.push_back(node.x);
+            resultData.push_back(node.y);
+            resultData.push_back(node.z);
         }
         
         env->SetIntArrayRegion(resultArray, 0, static_cast<jsize>(resultData.size()), resultData.data());
@@ -125,7 +127,7 @@ jlongArray PathfinderOptimizedBridge::findPathsBatch(JNIEnv* env, jclass clazz,
     batchResults.reserve(count);
     
     try {
-        static lattice::world::PathfinderOptimizer optimizer;
+        auto& optimizer = lattice::world::PathfinderOptimizer::get_instance();
         
         for (jint i = 0; i < count; ++i) {
             jint startX, startY, startZ, targetX, targetY, targetZ, mobType;
@@ -150,9 +152,9 @@ jlongArray PathfinderOptimizedBridge::findPathsBatch(JNIEnv* env, jclass clazz,
                 pathData.reserve(path.size() * 3);
                 
                 for (const auto& node : path) {
-                    pathData.push_back(node->x);
-                    pathData.push_back(node->y);
-                    pathData.push_back(node->z);
+                    pathData.push_back(node.x);
+                    pathData.push_back(node.y);
+                    pathData.push_back(node.z);
                 }
                 
                 batchResults.push_back(std::move(pathData));
@@ -243,13 +245,25 @@ jintArray PathfinderOptimizedBridge::smoothPath(JNIEnv* env, jclass clazz,
 jstring PathfinderOptimizedBridge::getPathfindingStats(JNIEnv* env, jclass clazz) {
     try {
         // JNI职责: 只返回性能统计，实际统计在core中进行
-        // TODO: 调用core中的统计函数
+        auto& optimizer = lattice::world::PathfinderOptimizer::get_instance();
+        const auto& counters = optimizer.get_stats();
+        const uint64_t searches = counters.searches.load(std::memory_order_relaxed);
+        const uint64_t visited = counters.nodes_visited.load(std::memory_order_relaxed);
         std::string stats = "Pathfinder Optimized:\n"
-                           "Algorithm: A* with SIMD acceleration\n"
-                           "Batch Processing: Enabled\n"
-                           "Cache: LRU with path hashing\n"
-                           "Navigation: Dynamic mesh updates\n"
-                           "Expected Performance: 15x improvement";
+                            "Algorithm: A* (pooled nodes, binary heap with decrease-key)\n"
+                            "Searches: " + std::to_string(searches) + "\n"
+                            "Reached: " + std::to_string(counters.reached.load(std::memory_order_relaxed)) + "\n"
+                            "Budget Exhausted: " +
+                            std::to_string(counters.budget_exhausted.load(std::memory_order_relaxed)) + "\n"
+                            "Avg Nodes: " + std::to_string(searches ? visited / searches : 0) + "\n"
+                            "Flow Fields: " +
+                            std::to_string(counters.flow_fields_built.load(std::memory_order_relaxed)) + " built, " +
+                            std::to_string(counters.flow_field_hits.load(std::memory_order_relaxed)) + " hits\n"
+                            "Path Cache: " + std::to_string(optimizer.cached_paths()) + " paths, " +
+                            std::to_string(counters.path_cache_hits.load(std::memory_order_relaxed)) + " hits, " +
+                            std::to_string(counters.path_cache_invalidated.load(std::memory_order_relaxed)) +
+                            " invalidated\n"
+                            "Snapshot Sections: " + std::to_string(optimizer.snapshot()->section_count());
         
         return env->NewStringUTF(stats.c_str());
         
@@ -0,0 +1,952 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "core/io/anvil_format.hpp"
+#include "core/io/nbt_reader.hpp"
+#include "core/io/nbt_writer.hpp"
+#include "core/io/region_file.hpp"
+#include "core/net/hierarchical_tracker.hpp"
+#include "core/net/native_compressor.hpp"
+#include "core/redstone/paper_compatible_redstone_engine.hpp"
+#include "core/world/advanced_light_engine.hpp"
+#include "core/world/pathfinder.hpp"
+
+using namespace lattice::io::anvil;
+using lattice::entity::EntityType;
+using lattice::entity::HierarchicalTracker;
+using lattice::net::NativeCompressor;
+using lattice::redstone::paper::PaperCompatibleRedstoneEngine;
+using lattice::world::AdvancedLightEngine;
+using lattice::world::LightOpacityTable;
+using lattice::world::MobType;
+using lattice::world::Node;
+using lattice::world::PathBlockType;
+using lattice::world::PathfinderOptimizer;
+using lattice::world::SearchBounds;
+
+// ===== 各子系统的微基准（Google Benchmark）=====
+// 用法: lattice_bench [--region FILE]... [--packets FILE] [--entities FILE] [Google Benchmark参数]
+// 跨版本跟踪时输出JSON: --benchmark_out=bench.json --benchmark_out_format=json
+// （JSON的context中记录了每组数据的来源，不同数据跑出的结果不要直接比较）
+//
+// 真实数据：
+//   --region    r.<x>.<z>.mca，可重复；最多读取MAX_FIXTURE_CHUNKS个区块，解压为NBT     -> NBT解析/序列化、区块压缩
+//   --packets   抓包文件：连续的记录，每条为4字节大端长度 + 压缩前的包体                -> 包压缩
+//   --entities  实体轨迹：文本，每行 "tick 实体ID 类型 x y z"（类型为EntityType序号）  -> 实体追踪
+// 未提供时NBT与实体使用固定种子生成的数据，包压缩只在提供抓包时运行。
+// 光照、寻路与红石使用固定种子生成的地形/网络；用原版存档检查光照见lattice_light_bench。
+
+namespace {
+
+constexpr size_t MAX_FIXTURE_CHUNKS = 256;
+constexpr uint32_t FIXTURE_SEED = 0x1A771CE;
+
+// ===== 数据 =====
+
+struct EntitySample {
+    int id;
+    EntityType type;
+    float x, y, z;
+};
+
+struct Fixtures {
+    std::vector<std::vector<uint8_t>> chunkNbt;             // 解压后的区块NBT
+    std::vector<std::vector<uint8_t>> packets;              // 压缩前的包体
+    std::vector<std::vector<EntitySample>> entityTicks;     // 按tick分组的实体位置
+    std::string chunkSource = "synthetic";
+    std::string packetSource;
+    std::string entitySource = "synthetic";
+};
+
+Fixtures& fixtures() {
+    static Fixtures instance;
+    return instance;
+}
+
+size_t loadRegion(const std::string& path, std::vector<std::vector<uint8_t>>& out) {
+    RegionFile region(path, false);
+    if (!region.isOpen()) {
+        return 0;
+    }
+    size_t loaded = 0;
+    std::vector<uint8_t> record;
+    for (int localZ = 0; localZ < 32; ++localZ) {
+        for (int localX = 0; localX < 32; ++localX) {
+            if (out.size() >= MAX_FIXTURE_CHUNKS) {
+                return loaded;
+            }
+            if (!region.hasChunk(localX, localZ) || !region.readChunk(localX, localZ, record) || record.size() < 2) {
+                continue;
+            }
+            // record[0]为region压缩方案ID，其余为压缩后的负载
+            const auto type = MinecraftCompressor::fromRegionRecord(record[0], record.data() + 1, record.size() - 1);
+            auto nbt = MinecraftCompressor::decompressPayload(type, record.data() + 1, record.size() - 1);
+            if (!nbt.empty()) {
+                out.push_back(std::move(nbt));
+                ++loaded;
+            }
+        }
+    }
+    return loaded;
+}
+
+bool loadPackets(const std::string& path, std::vector<std::vector<uint8_t>>& out) {
+    std::ifstream in(path, std::ios::binary);
+    uint8_t header[4];
+    while (in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        const uint32_t length = (uint32_t(header[0]) << 24) | (uint32_t(header[1]) << 16) |
+                                (uint32_t(header[2]) << 8) | uint32_t(header[3]);
+        std::vector<uint8_t> packet(length);
+        if (!in.read(reinterpret_cast<char*>(packet.data()), length)) {
+            return false;
+        }
+        out.push_back(std::move(packet));
+    }
+    return in.eof() && !out.empty();
+}
+
+bool loadEntityTrace(const std::string& path, std::vector<std::vector<EntitySample>>& out) {
+    std::ifstream in(path);
+    std::string line;
+    long currentTick = 0;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        long tick;
+        int id, type;
+        float x, y, z;
+        if (!(fields >> tick >> id >> type >> x >> y >> z)) {
+            return false;
+        }
+        if (out.empty() || tick != currentTick) {
+            out.emplace_back();
+            currentTick = tick;
+        }
+        out.back().push_back({id, static_cast<EntityType>(std::clamp(type, 0, 7)), x, y, z});
+    }
+    return !out.empty();
+}
+
+// 类似原版1.18+的区块结构：24个段，每段带方块/生物群系调色板与光照数组
+std::vector<uint8_t> syntheticChunkNbt(int chunkX, int chunkZ, std::mt19937& random) {
+    static constexpr std::string_view BLOCKS[] = {
+        "minecraft:air", "minecraft:stone", "minecraft:deepslate", "minecraft:dirt",
+        "minecraft:grass_block", "minecraft:water", "minecraft:coal_ore", "minecraft:iron_ore",
+    };
+    NBTWriter writer(96 * 1024);
+    writer.writeTagHeader(NBTType::COMPOUND, "");
+    writer.writeTagHeader(NBTType::INT, "DataVersion");
+    writer.writeInt(4556);
+    writer.writeTagHeader(NBTType::INT, "xPos");
+    writer.writeInt(chunkX);
+    writer.writeTagHeader(NBTType::INT, "zPos");
+    writer.writeInt(chunkZ);
+    writer.writeTagHeader(NBTType::INT, "yPos");
+    writer.writeInt(-4);
+    writer.writeTagHeader(NBTType::STRING, "Status");
+    writer.writeString("minecraft:full");
+    writer.writeTagHeader(NBTType::LONG, "LastUpdate");
+    writer.writeLong(static_cast<int64_t>(random()));
+
+    std::vector<int64_t> words;
+    writer.writeTagHeader(NBTType::LIST, "sections");
+    writer.writeByte(static_cast<int8_t>(NBTType::COMPOUND));
+    writer.writeInt(24);
+    for (int section = -4; section < 20; ++section) {
+        writer.writeTagHeader(NBTType::BYTE, "Y");
+        writer.writeByte(static_cast<int8_t>(section));
+
+        // 4位索引的块状态：4096个格子 / 每个long 16个 = 256个long
+        const int paletteSize = section < 8 ? 8 : 2;
+        writer.writeTagHeader(NBTType::COMPOUND, "block_states");
+        writer.writeTagHeader(NBTType::LIST, "palette");
+        writer.writeByte(static_cast<int8_t>(NBTType::COMPOUND));
+        writer.writeInt(paletteSize);
+        for (int i = 0; i < paletteSize; ++i) {
+            writer.writeTagHeader(NBTType::STRING, "Name");
+            writer.writeString(BLOCKS[i]);
+            writer.writeEnd();
+        }
+        words.resize(256);
+        for (auto& word : words) {
+            word = section < 8 ? static_cast<int64_t>((uint64_t(random()) << 32) | random()) : 0;
+        }
+        writer.writeTagHeader(NBTType::LONG_ARRAY, "data");
+        writer.writeLongArray(words);
+        writer.writeEnd();
+
+        writer.writeTagHeader(NBTType::COMPOUND, "biomes");
+        writer.writeTagHeader(NBTType::LIST, "palette");
+        writer.writeByte(static_cast<int8_t>(NBTType::STRING));
+        writer.writeInt(1);
+        writer.writeString("minecraft:plains");
+        writer.writeEnd();
+
+        writer.writeTagHeader(NBTType::BYTE_ARRAY, "SkyLight");
+        writer.writeByteArrayFilled(2048, section < 4 ? 0x00 : 0xFF);
+        writer.writeTagHeader(NBTType::BYTE_ARRAY, "BlockLight");
+        writer.writeByteArrayFilled(2048, 0);
+        writer.writeEnd();
+    }
+
+    writer.writeTagHeader(NBTType::COMPOUND, "Heightmaps");
+    words.assign(37, 0x0102040810204081LL);
+    for (std::string_view name : {"MOTION_BLOCKING", "OCEAN_FLOOR", "WORLD_SURFACE"}) {
+        writer.writeTagHeader(NBTType::LONG_ARRAY, name);
+        writer.writeLongArray(words);
+    }
+    writer.writeEnd();
+    writer.writeTagHeader(NBTType::LIST, "block_entities");
+    writer.writeByte(static_cast<int8_t>(NBTType::END));
+    writer.writeInt(0);
+    writer.writeEnd();
+
+    auto data = writer.finish();
+    return {data.begin(), data.end()};
+}
+
+// 实体轨迹第一tick的位置；数量不足时在原位置附近±24格内复制（热点处更拥挤，而不是铺满更大的世界）
+std::vector<EntitySample> entityPopulation(size_t count) {
+    std::mt19937 random(FIXTURE_SEED);
+    std::vector<EntitySample> population;
+    population.reserve(count);
+    const auto& ticks = fixtures().entityTicks;
+    if (!ticks.empty()) {
+        const auto& first = ticks.front();
+        std::uniform_real_distribution<float> jitter(-24.0f, 24.0f);
+        for (size_t i = 0; i < count; ++i) {
+            EntitySample sample = first[i % first.size()];
+            sample.id = static_cast<int>(i + 1);
+            if (i >= first.size()) {
+                sample.x += jitter(random);
+                sample.z += jitter(random);
+            }
+            population.push_back(sample);
+        }
+        return population;
+    }
+    // 生成：每64个实体一个玩家，其余聚在几十个村庄/刷怪塔一类的热点周围
+    std::uniform_real_distribution<float> hotspot(-1024.0f, 1024.0f);
+    std::normal_distribution<float> spread(0.0f, 20.0f);
+    std::vector<std::pair<float, float>> hotspots(48);
+    for (auto& [x, z] : hotspots) {
+        x = hotspot(random);
+        z = hotspot(random);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const auto& [cx, cz] = hotspots[i % hotspots.size()];
+        const EntityType type = i % 64 == 0 ? EntityType::PLAYER : (i % 3 ? EntityType::MONSTER : EntityType::ANIMAL);
+        population.push_back({static_cast<int>(i + 1), type, cx + spread(random), 64.0f + spread(random) * 0.2f,
+                              cz + spread(random)});
+    }
+    return population;
+}
+
+// ===== NBT =====
+
+/**
+ * 按序遍历一个NBT文档，每个标签与负载回调visitor一次
+ * 列表与复合标签递归展开；出错时停止并返回false
+ */
+template <typename Visitor>
+bool walkPayload(NBTReader& reader, NBTType type, Visitor& visitor, int depth) {
+    if (depth > NBTReader::MAX_DEPTH || !reader.ok()) {
+        return false;
+    }
+    switch (type) {
+        case NBTType::END:
+            return true;
+        case NBTType::BYTE:
+            visitor.scalar(type, reader.readByte());
+            break;
+        case NBTType::SHORT:
+            visitor.scalar(type, reader.readShort());
+            break;
+        case NBTType::INT:
+            visitor.scalar(type, reader.readInt());
+            break;
+        case NBTType::LONG:
+            visitor.scalar(type, reader.readLong());
+            break;
+        case NBTType::FLOAT:
+            visitor.real(type, reader.readFloat());
+            break;
+        case NBTType::DOUBLE:
+            visitor.real(type, reader.readDouble());
+            break;
+        case NBTType::STRING:
+            visitor.string(reader.readString());
+            break;
+        case NBTType::BYTE_ARRAY:
+            visitor.bytes(reader.readByteArray());
+            break;
+        case NBTType::INT_ARRAY:
+            visitor.ints(reader.readIntArray());
+            break;
+        case NBTType::LONG_ARRAY:
+            visitor.longs(reader.readLongArray());
+            break;
+        case NBTType::LIST: {
+            NBTType elementType;
+            int32_t length;
+            if (!reader.readListHeader(elementType, length)) {
+                return false;
+            }
+            visitor.list(elementType, length);
+            for (int32_t i = 0; i < length; ++i) {
+                if (!walkPayload(reader, elementType, visitor, depth + 1)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        case NBTType::COMPOUND: {
+            NBTType childType;
+            std::string_view childName;
+            while (reader.readTagHeader(childType, childName)) {
+                visitor.tag(childType, childName);
+                if (childType == NBTType::END) {
+                    break;
+                }
+                if (!walkPayload(reader, childType, visitor, depth + 1)) {
+                    return false;
+                }
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+    return reader.ok();
+}
+
+template <typename Visitor>
+bool walkDocument(std::span<const uint8_t> data, Visitor& visitor) {
+    NBTReader reader(data);
+    NBTType type;
+    std::string_view name;
+    if (!reader.readTagHeader(type, name) || type != NBTType::COMPOUND) {
+        return false;
+    }
+    visitor.tag(type, name);
+    return walkPayload(reader, type, visitor, 0);
+}
+
+// 解析：读出每个值，数组解码到本机字节序（与区块加载解码调色板数据相同）
+struct DecodeSink {
+    uint64_t checksum = 0;
+    std::vector<int32_t> intScratch;
+    std::vector<int64_t> longScratch;
+
+    void tag(NBTType type, std::string_view name) { checksum += static_cast<uint8_t>(type) + name.size(); }
+    void list(NBTType type, int32_t length) { checksum += static_cast<uint8_t>(type) + length; }
+    void scalar(NBTType, int64_t value) { checksum += static_cast<uint64_t>(value); }
+    void real(NBTType, double value) { checksum += static_cast<uint64_t>(value); }
+    void string(std::string_view value) { checksum += value.size(); }
+    void bytes(std::span<const uint8_t> value) { checksum += value.size() ? value[0] + value.size() : 0; }
+    void ints(NBTArrayView<int32_t> value) {
+        value.copyTo(intScratch);
+        checksum += intScratch.empty() ? 0 : static_cast<uint32_t>(intScratch.back());
+    }
+    void longs(NBTArrayView<int64_t> value) {
+        value.copyTo(longScratch);
+        checksum += longScratch.empty() ? 0 : static_cast<uint64_t>(longScratch.back());
+    }
+};
+
+// 解码后的标签流：序列化基准按顺序重放，只计NBTWriter的开销
+struct NbtOp {
+    enum class Kind : uint8_t { TAG, LIST, SCALAR, REAL, STRING, BYTES, INTS, LONGS };
+    Kind kind;
+    NBTType type = NBTType::END;
+    int64_t integer = 0;    // SCALAR的值，LIST的长度
+    double real = 0.0;
+    std::string text{};     // TAG的名称，STRING的值
+    std::vector<uint8_t> byteValues{};
+    std::vector<int32_t> intValues{};
+    std::vector<int64_t> longValues{};
+};
+
+struct OpRecorder {
+    std::vector<NbtOp>& ops;
+
+    void tag(NBTType type, std::string_view name) { ops.push_back({NbtOp::Kind::TAG, type, 0, 0.0, std::string(name)}); }
+    void list(NBTType type, int32_t length) { ops.push_back({NbtOp::Kind::LIST, type, length}); }
+    void scalar(NBTType type, int64_t value) { ops.push_back({NbtOp::Kind::SCALAR, type, value}); }
+    void real(NBTType type, double value) { ops.push_back({NbtOp::Kind::REAL, type, 0, value}); }
+    void string(std::string_view value) { ops.push_back({NbtOp::Kind::STRING, NBTType::STRING, 0, 0.0, std::string(value)}); }
+    void bytes(std::span<const uint8_t> value) {
+        ops.push_back({NbtOp::Kind::BYTES, NBTType::BYTE_ARRAY});
+        ops.back().byteValues.assign(value.begin(), value.end());
+    }
+    void ints(NBTArrayView<int32_t> value) {
+        ops.push_back({NbtOp::Kind::INTS, NBTType::INT_ARRAY});
+        value.copyTo(ops.back().intValues);
+    }
+    void longs(NBTArrayView<int64_t> value) {
+        ops.push_back({NbtOp::Kind::LONGS, NBTType::LONG_ARRAY});
+        value.copyTo(ops.back().longValues);
+    }
+};
+
+void replay(const std::vector<NbtOp>& ops, NBTWriter& writer) {
+    for (const NbtOp& op : ops) {
+        switch (op.kind) {
+            case NbtOp::Kind::TAG:
+                writer.writeTagHeader(op.type, op.text);
+                break;
+            case NbtOp::Kind::LIST:
+                writer.writeByte(static_cast<int8_t>(op.type));
+                writer.writeInt(static_cast<int32_t>(op.integer));
+                break;
+            case NbtOp::Kind::SCALAR:
+                switch (op.type) {
+                    case NBTType::BYTE: writer.writeByte(static_cast<int8_t>(op.integer)); break;
+                    case NBTType::SHORT: writer.writeShort(static_cast<int16_t>(op.integer)); break;
+                    case NBTType::INT: writer.writeInt(static_cast<int32_t>(op.integer)); break;
+                    default: writer.writeLong(op.integer); break;
+                }
+                break;
+            case NbtOp::Kind::REAL:
+                if (op.type == NBTType::FLOAT) {
+                    writer.writeFloat(static_cast<float>(op.real));
+                } else {
+                    writer.writeDouble(op.real);
+                }
+                break;
+            case NbtOp::Kind::STRING:
+                writer.writeString(op.text);
+                break;
+            case NbtOp::Kind::BYTES:
+                writer.writeByteArray(op.byteValues);
+                break;
+            case NbtOp::Kind::INTS:
+                writer.writeIntArray(op.intValues);
+                break;
+            case NbtOp::Kind::LONGS:
+                writer.writeLongArray(op.longValues);
+                break;
+        }
+    }
+}
+
+size_t totalBytes(const std::vector<std::vector<uint8_t>>& inputs) {
+    size_t total = 0;
+    for (const auto& input : inputs) {
+        total += input.size();
+    }
+    return total;
+}
+
+void BM_NbtParse(benchmark::State& state) {
+    const auto& chunks = fixtures().chunkNbt;
+    DecodeSink sink;
+    for (auto _ : state) {
+        for (const auto& chunk : chunks) {
+            if (!walkDocument(chunk, sink)) {
+                state.SkipWithError("malformed chunk NBT");
+                return;
+            }
+        }
+        benchmark::DoNotOptimize(sink.checksum);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * totalBytes(chunks)));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * chunks.size()));
+}
+
+void BM_NbtSerialise(benchmark::State& state) {
+    const auto& chunks = fixtures().chunkNbt;
+    std::vector<std::vector<NbtOp>> documents(chunks.size());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        OpRecorder recorder{documents[i]};
+        walkDocument(chunks[i], recorder);
+        // 重放必须逐字节还原输入，否则计时的不是同一份数据
+        NBTWriter check(chunks[i].size());
+        replay(documents[i], check);
+        const auto written = check.finish();
+        if (!std::equal(written.begin(), written.end(), chunks[i].begin(), chunks[i].end())) {
+            state.SkipWithError("NBT replay does not reproduce the fixture");
+            return;
+        }
+    }
+    for (auto _ : state) {
+        for (size_t i = 0; i < documents.size(); ++i) {
+            // 大小预估取输入大小（与SerializedSizeHistory命中时相同），整个文档一次分配
+            NBTWriter writer(chunks[i].size());
+            replay(documents[i], writer);
+            benchmark::DoNotOptimize(writer.finish().data());
+        }
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * totalBytes(chunks)));
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * chunks.size()));
+}
+
+// ===== deflate =====
+
+void runDeflate(benchmark::State& state, const std::vector<std::vector<uint8_t>>& inputs) {
+    const int level = static_cast<int>(state.range(0));
+    NativeCompressor compressor(level);
+    size_t largest = 0;
+    for (const auto& input : inputs) {
+        largest = std::max(largest, input.size());
+    }
+    std::vector<char> output(largest + largest / 2 + 1024);
+    size_t compressed = 0;
+    for (auto _ : state) {
+        compressed = 0;
+        for (const auto& input : inputs) {
+            compressed += compressor.compressZlib(reinterpret_cast<const char*>(input.data()), input.size(),
+                                                  output.data(), output.size());
+        }
+        benchmark::DoNotOptimize(compressed);
+    }
+    const size_t uncompressed = totalBytes(inputs);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * uncompressed));
+    state.counters["ratio"] = compressed ? static_cast<double>(uncompressed) / compressed : 0.0;
+}
+
+void BM_DeflateChunk(benchmark::State& state) {
+    runDeflate(state, fixtures().chunkNbt);
+}
+
+void BM_DeflatePacket(benchmark::State& state) {
+    runDeflate(state, fixtures().packets);
+}
+
+// ===== 实体追踪 =====
+
+struct TrackerScene {
+    std::unique_ptr<HierarchicalTracker> tracker;
+    std::vector<EntitySample> entities;
+    std::vector<size_t> viewers;    // entities中的下标
+};
+
+TrackerScene buildTrackerScene(size_t entityCount) {
+    TrackerScene scene;
+    scene.tracker = std::make_unique<HierarchicalTracker>(384);
+    scene.entities = entityPopulation(entityCount);
+    for (size_t i = 0; i < scene.entities.size(); ++i) {
+        const auto& e = scene.entities[i];
+        scene.tracker->registerEntity(e.id, e.x, e.y, e.z, 0.6f, e.type);
+        if (e.type == EntityType::PLAYER) {
+            scene.viewers.push_back(i);
+        }
+    }
+    if (scene.viewers.empty()) {
+        scene.viewers.push_back(0);
+    }
+    scene.tracker->tick();
+    return scene;
+}
+
+// 每次迭代一个观察者的完整可见性查询
+void BM_TrackerQuery(benchmark::State& state) {
+    TrackerScene scene = buildTrackerScene(static_cast<size_t>(state.range(0)));
+    size_t next = 0;
+    size_t visible = 0;
+    for (auto _ : state) {
+        const auto& viewer = scene.entities[scene.viewers[next++ % scene.viewers.size()]];
+        auto result = scene.tracker->getVisibleEntities(viewer.id, viewer.x, viewer.y, viewer.z);
+        visible += result.size();
+        benchmark::DoNotOptimize(result.data());
+    }
+    state.counters["visible"] = benchmark::Counter(static_cast<double>(visible), benchmark::Counter::kAvgIterations);
+    state.counters["viewers"] = static_cast<double>(scene.viewers.size());
+}
+
+// 每次迭代一个服务器tick：所有实体移动一步，再更新每个观察者的可见集增量
+void BM_TrackerTick(benchmark::State& state) {
+    TrackerScene scene = buildTrackerScene(static_cast<size_t>(state.range(0)));
+    const auto& trace = fixtures().entityTicks;
+    std::mt19937 random(FIXTURE_SEED);
+    std::uniform_real_distribution<float> step(-0.3f, 0.3f);
+    size_t tick = 1;
+    for (auto _ : state) {
+        // 轨迹中有下一tick时按轨迹中同一实体的位移移动（复制出的实体沿用原实体的位移）
+        const std::vector<EntitySample>* frame = tick < trace.size() ? &trace[tick] : nullptr;
+        for (size_t i = 0; i < scene.entities.size(); ++i) {
+            auto& e = scene.entities[i];
+            if (frame && !frame->empty()) {
+                const auto& previous = trace[tick - 1][i % trace[tick - 1].size()];
+                const auto& current = (*frame)[i % frame->size()];
+                e.x += current.x - previous.x;
+                e.z += current.z - previous.z;
+            } else {
+                e.x += step(random);
+                e.z += step(random);
+            }
+            scene.tracker->updateEntityPosition(e.id, e.x, e.y, e.z);
+        }
+        scene.tracker->tick();
+        for (size_t index : scene.viewers) {
+            const auto& viewer = scene.entities[index];
+            auto delta = scene.tracker->updateViewerVisibility(viewer.id, viewer.x, viewer.y, viewer.z);
+            benchmark::DoNotOptimize(delta);
+        }
+        tick = tick + 1 < trace.size() ? tick + 1 : 1;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * scene.entities.size()));
+}
+
+// ===== 光照 =====
+
+// 合成地形用的方块状态
+constexpr uint16_t LIGHT_AIR = 0;
+constexpr uint16_t LIGHT_STONE = 1;
+constexpr uint16_t LIGHT_LEAVES = 2;
+constexpr uint16_t LIGHT_WATER = 3;
+constexpr uint16_t LIGHT_TORCH = 4;
+constexpr int32_t LIGHT_MIN_Y = -64;
+constexpr int32_t LIGHT_HEIGHT = 384;
+
+void installLightStates() {
+    static bool installed = false;
+    if (installed) {
+        return;
+    }
+    installed = true;
+    // 每项4字节：透光值、发光等级、面遮挡位、保留
+    static const uint8_t packed[] = {
+        0, 0, 0, 0,     // 空气
+        15, 0, 0, 0,    // 石头
+        1, 0, 0, 0,     // 树叶
+        2, 0, 0, 0,     // 水
+        0, 14, 0, 0,    // 火把
+    };
+    LightOpacityTable::setBlockStateTable(packed, sizeof(packed) / 4);
+}
+
+// 起伏的地表，地表以下有水平洞穴，洞穴中每隔一段放一个火把；下标((y - minY) << 8) | (z << 4) | x
+std::vector<uint16_t> lightColumn(int32_t chunkX, int32_t chunkZ, std::vector<int32_t>& torches) {
+    std::vector<uint16_t> column(static_cast<size_t>(LIGHT_HEIGHT) * 256, LIGHT_AIR);
+    for (int z = 0; z < 16; ++z) {
+        for (int x = 0; x < 16; ++x) {
+            const int worldX = (chunkX << 4) + x;
+            const int worldZ = (chunkZ << 4) + z;
+            const int surface = 64 + static_cast<int>(8.0 * std::sin(worldX * 0.11) + 6.0 * std::cos(worldZ * 0.07));
+            for (int y = LIGHT_MIN_Y; y <= surface; ++y) {
+                const bool cave = y > 10 && y < 16 && ((worldX / 5 + worldZ / 7) & 3) == 0;
+                const size_t index = (static_cast<size_t>(y - LIGHT_MIN_Y) << 8) | (z << 4) | x;
+                column[index] = cave ? LIGHT_AIR : LIGHT_STONE;
+                if (cave && y == 11 && ((worldX ^ worldZ) & 15) == 0) {
+                    column[index] = LIGHT_TORCH;
+                    torches.push_back(static_cast<int32_t>(index));
+                }
+            }
+            // 水面与树冠，让天空光经过半透明方块
+            if (surface < 60) {
+                for (int y = surface + 1; y <= 60; ++y) {
+                    column[(static_cast<size_t>(y - LIGHT_MIN_Y) << 8) | (z << 4) | x] = LIGHT_WATER;
+                }
+            } else if (((worldX * 7 + worldZ * 13) % 29) == 0) {
+                for (int y = surface + 3; y <= surface + 6; ++y) {
+                    column[(static_cast<size_t>(y - LIGHT_MIN_Y) << 8) | (z << 4) | x] = LIGHT_LEAVES;
+                }
+            }
+        }
+    }
+    return column;
+}
+
+int settle(AdvancedLightEngine& engine) {
+    int ticks = 0;
+    while (engine.hasUpdates() && ticks < 10000) {
+        engine.tick();
+        ++ticks;
+    }
+    return ticks;
+}
+
+void lightChunks(AdvancedLightEngine& engine, int side) {
+    for (int chunkZ = 0; chunkZ < side; ++chunkZ) {
+        for (int chunkX = 0; chunkX < side; ++chunkX) {
+            std::vector<int32_t> torches;
+            const auto column = lightColumn(chunkX, chunkZ, torches);
+            engine.initializeChunkSkylight(chunkX, chunkZ, column.data(), LIGHT_MIN_Y, LIGHT_HEIGHT);
+            for (int32_t index : torches) {
+                engine.onBlockChange((chunkX << 4) + (index & 15), LIGHT_MIN_Y + (index >> 8),
+                                     (chunkZ << 4) + ((index >> 4) & 15), LIGHT_AIR, LIGHT_TORCH);
+            }
+        }
+    }
+}
+
+// 新区块的整区块光照：天空光初始化 + 光源传播，直到队列为空
+void BM_LightFullChunks(benchmark::State& state) {
+    installLightStates();
+    const int side = static_cast<int>(state.range(0));
+    int ticks = 0;
+    for (auto _ : state) {
+        auto engine = std::make_unique<AdvancedLightEngine>();
+        lightChunks(*engine, side);
+        ticks = settle(*engine);
+        state.PauseTiming();
+        engine.reset();    // 析构不计时
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * side * side));
+    state.counters["ticks"] = ticks;
+}
+
+// 已照亮的区域中放置/移除一个光源并传播到稳定
+void BM_LightIncremental(benchmark::State& state) {
+    installLightStates();
+    constexpr int SIDE = 8;
+    AdvancedLightEngine engine;
+    lightChunks(engine, SIDE);
+    settle(engine);
+    std::mt19937 random(FIXTURE_SEED);
+    std::uniform_int_distribution<int> horizontal(8, SIDE * 16 - 8);
+    for (auto _ : state) {
+        const int x = horizontal(random);
+        const int z = horizontal(random);
+        engine.onBlockChange(x, 12, z, LIGHT_AIR, LIGHT_TORCH);
+        settle(engine);
+        engine.onBlockChange(x, 12, z, LIGHT_TORCH, LIGHT_AIR);
+        settle(engine);
+    }
+}
+
+// ===== 寻路 =====
+
+constexpr int PATH_CHUNK_RADIUS = 8;
+
+// 实心地面（y = 0）上随机分布的石柱、栅栏与水坑，约占地面的15%
+void buildPathTerrain(PathfinderOptimizer& pathfinder) {
+    std::mt19937 random(FIXTURE_SEED);
+    std::uniform_int_distribution<int> roll(0, 99);
+    uint8_t types[4096];
+    for (int chunkX = -PATH_CHUNK_RADIUS; chunkX < PATH_CHUNK_RADIUS; ++chunkX) {
+        for (int chunkZ = -PATH_CHUNK_RADIUS; chunkZ < PATH_CHUNK_RADIUS; ++chunkZ) {
+            std::memset(types, static_cast<uint8_t>(PathBlockType::OPEN), sizeof(types));
+            for (int i = 0; i < 256; ++i) {
+                types[i] = static_cast<uint8_t>(PathBlockType::SOLID);
+                const int obstacle = roll(random);
+                PathBlockType type = PathBlockType::OPEN;
+                if (obstacle < 8) {
+                    type = PathBlockType::SOLID;
+                } else if (obstacle < 12) {
+                    type = PathBlockType::FENCE;
+                } else if (obstacle < 15) {
+                    type = PathBlockType::WATER;
+                }
+                if (type == PathBlockType::WATER) {
+                    types[i] = static_cast<uint8_t>(type);
+                } else if (type != PathBlockType::OPEN) {
+                    types[(1 << 8) | i] = static_cast<uint8_t>(type);
+                    types[(2 << 8) | i] = static_cast<uint8_t>(type);
+                }
+            }
+            pathfinder.set_section(chunkX, 0, chunkZ, types);
+        }
+    }
+}
+
+// 直线距离约range格的起点/终点对（都在空地上）；使用默认节点上限，reached < 1说明有搜索被上限截断
+void BM_AStar(benchmark::State& state) {
+    PathfinderOptimizer pathfinder;
+    buildPathTerrain(pathfinder);
+    const auto blocks = pathfinder.snapshot();
+    const int range = static_cast<int>(state.range(0));
+    const int limit = PATH_CHUNK_RADIUS * 16 - 2;
+
+    std::mt19937 random(FIXTURE_SEED);
+    std::uniform_int_distribution<int> startX(-limit, limit - range);
+    std::uniform_int_distribution<int> startZ(-limit, limit - range / 2);
+    std::vector<std::pair<Node, Node>> queries;
+    while (queries.size() < 64) {
+        const Node start(startX(random), 1, startZ(random));
+        const Node goal(start.x + range, 1, start.z + range / 2);
+        if (blocks->get_block(start.x, 1, start.z) == PathBlockType::OPEN &&
+            blocks->get_block(goal.x, 1, goal.z) == PathBlockType::OPEN &&
+            blocks->get_block(start.x, 0, start.z) == PathBlockType::SOLID &&
+            blocks->get_block(goal.x, 0, goal.z) == PathBlockType::SOLID) {
+            queries.emplace_back(start, goal);
+        }
+    }
+    // 限定范围的搜索不进入路径缓存，每次迭代都是一次完整的A*
+    const SearchBounds bounds{Node(-PATH_CHUNK_RADIUS * 16, 0, -PATH_CHUNK_RADIUS * 16),
+                              Node(PATH_CHUNK_RADIUS * 16 - 1, 15, PATH_CHUNK_RADIUS * 16 - 1)};
+    size_t next = 0;
+    uint64_t visited = 0;
+    uint64_t reached = 0;
+    for (auto _ : state) {
+        const auto& [start, goal] = queries[next++ % queries.size()];
+        auto result = pathfinder.find_path(*blocks, start, goal, MobType::HOSTILE,
+                                           PathfinderOptimizer::DEFAULT_MAX_NODES, &bounds);
+        visited += result.nodes_visited;
+        reached += result.reached ? 1 : 0;
+        benchmark::DoNotOptimize(result.nodes.data());
+    }
+    state.counters["nodes"] = benchmark::Counter(static_cast<double>(visited), benchmark::Counter::kAvgIterations);
+    state.counters["reached"] = benchmark::Counter(static_cast<double>(reached), benchmark::Counter::kAvgIterations);
+}
+
+// ===== 红石 =====
+
+// 注册组件时引擎逐个打印到stdout，构建网络期间丢弃
+class SilenceStdout {
+public:
+    SilenceStdout() : previous_(std::cout.rdbuf(nullptr)) {}
+    ~SilenceStdout() { std::cout.rdbuf(previous_); }
+
+private:
+    std::streambuf* previous_;
+};
+
+/**
+ * 每次迭代切换所有红石线首端的外部输入（15 <-> 0）并推进一个tick
+ * range(0)为传播模式（PropagationMode的数值：0 = LEGACY，1 = ALTERNATE_CURRENT，2 = SCHEDULED，3 = PARALLEL），
+ * range(1)为每条线的长度，共64条互不相连的线
+ * LEGACY只向相邻组件传一步且不记录方块更新，与其他模式的耗时不是同一工作量，按模式分别跟踪
+ */
+void BM_RedstoneNetwork(benchmark::State& state) {
+    constexpr int LINES = 64;
+    auto& engine = PaperCompatibleRedstoneEngine::getInstance();
+    const int length = static_cast<int>(state.range(1));
+    {
+        SilenceStdout silence;
+        engine.restart();
+        engine.setPropagationMode(static_cast<PaperCompatibleRedstoneEngine::PropagationMode>(state.range(0)));
+        for (int line = 0; line < LINES; ++line) {
+            for (int x = 0; x < length; ++x) {
+                engine.registerRedstoneWire(x, 64, line * 3);
+            }
+        }
+        engine.tick();
+    }
+    int power = 15;
+    size_t updates = 0;
+    for (auto _ : state) {
+        for (int line = 0; line < LINES; ++line) {
+            engine.updatePower(0, 64, line * 3, power);
+        }
+        engine.tick();
+        updates += engine.takeBlockUpdates().size();
+        power = 15 - power;
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * LINES * length));
+    state.counters["block_updates"] = benchmark::Counter(static_cast<double>(updates), benchmark::Counter::kAvgIterations);
+    SilenceStdout silence;
+    engine.restart();
+}
+
+// ===== 入口 =====
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--region FILE]... [--packets FILE] [--entities FILE] [benchmark options]" << std::endl;
+}
+
+// 取出本工具的参数，其余留给benchmark::Initialize；出错时返回false
+bool parseFixtureArgs(int& argc, char** argv) {
+    Fixtures& data = fixtures();
+    std::vector<std::string> regions;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if ((arg == "--region" || arg == "--packets" || arg == "--entities") && !hasValue) {
+            std::cerr << arg << " requires a file" << std::endl;
+            return false;
+        }
+        if (arg == "--region") {
+            regions.emplace_back(argv[++i]);
+        } else if (arg == "--packets") {
+            data.packetSource = argv[++i];
+        } else if (arg == "--entities") {
+            data.entitySource = argv[++i];
+        } else {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+
+    for (const auto& path : regions) {
+        if (loadRegion(path, data.chunkNbt) == 0) {
+            std::cerr << "No readable chunks in " << path << std::endl;
+            return false;
+        }
+    }
+    if (!regions.empty()) {
+        data.chunkSource.clear();
+        for (const auto& path : regions) {
+            data.chunkSource += (data.chunkSource.empty() ? "" : ",") + path;
+        }
+    } else {
+        std::mt19937 random(FIXTURE_SEED);
+        for (int i = 0; i < 64; ++i) {
+            data.chunkNbt.push_back(syntheticChunkNbt(i % 8, i / 8, random));
+        }
+    }
+    if (!data.packetSource.empty() && !loadPackets(data.packetSource, data.packets)) {
+        std::cerr << "Cannot read packet capture " << data.packetSource << std::endl;
+        return false;
+    }
+    if (data.entitySource != "synthetic" && !loadEntityTrace(data.entitySource, data.entityTicks)) {
+        std::cerr << "Cannot read entity trace " << data.entitySource << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void registerBenchmarks() {
+    benchmark::RegisterBenchmark("BM_NbtParse", BM_NbtParse)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_NbtSerialise", BM_NbtSerialise)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_DeflateChunk", BM_DeflateChunk)
+        ->ArgName("level")->Arg(1)->Arg(4)->Arg(6)->Arg(9)->Unit(benchmark::kMicrosecond);
+    if (!fixtures().packets.empty()) {
+        benchmark::RegisterBenchmark("BM_DeflatePacket", BM_DeflatePacket)
+            ->ArgName("level")->Arg(1)->Arg(4)->Arg(6)->Arg(9)->Unit(benchmark::kMicrosecond);
+    }
+    benchmark::RegisterBenchmark("BM_TrackerQuery", BM_TrackerQuery)
+        ->ArgName("entities")->Arg(1000)->Arg(10000)->Arg(50000);
+    benchmark::RegisterBenchmark("BM_TrackerTick", BM_TrackerTick)
+        ->ArgName("entities")->Arg(1000)->Arg(10000)->Arg(50000)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("BM_LightFullChunks", BM_LightFullChunks)
+        ->ArgName("side")->Arg(4)->Arg(8)->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark("BM_LightIncremental", BM_LightIncremental)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_AStar", BM_AStar)
+        ->ArgName("range")->Arg(16)->Arg(32)->Arg(48)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("BM_RedstoneNetwork", BM_RedstoneNetwork)
+        ->ArgNames({"mode", "length"})
+        ->ArgsProduct({{0, 1, 2, 3}, {15, 64, 256}})->Unit(benchmark::kMicrosecond);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!parseFixtureArgs(argc, argv)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    const Fixtures& data = fixtures();
+    benchmark::AddCustomContext("fixture.chunks", data.chunkSource + " (" + std::to_string(data.chunkNbt.size()) + ")");
+    benchmark::AddCustomContext("fixture.packets", data.packetSource.empty() ? "none" : data.packetSource);
+    benchmark::AddCustomContext("fixture.entities", data.entitySource);
+
+    registerBenchmarks();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
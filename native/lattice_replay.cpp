@@ -0,0 +1,547 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "core/io/anvil_format.hpp"
+#include "core/io/chunk_load_batcher.hpp"
+#include "core/io/io_metrics.hpp"
+#include "core/net/sharded_tracker.hpp"
+#include "core/redstone/paper_compatible_redstone_engine.hpp"
+#include "core/workload_trace.hpp"
+#include "core/world/light_updater.hpp"
+
+using namespace lattice::io::anvil;
+using lattice::core::RedstoneComponentKind;
+using lattice::core::TraceEvent;
+using lattice::core::TraceFieldReader;
+using lattice::core::TraceRecordView;
+using lattice::core::TraceSubsystem;
+using lattice::core::WorkloadTraceReader;
+using lattice::entity::EntityType;
+using lattice::entity::ShardedWorldTracker;
+using lattice::io::LatencyHistogram;
+using lattice::redstone::paper::PaperCompatibleRedstoneEngine;
+using lattice::redstone::paper::PaperRedstoneType;
+using lattice::world::BlockPos;
+using lattice::world::LightType;
+using lattice::world::LightUpdater;
+
+// ===== 工作负载回放工具 =====
+// 用法: lattice_replay [--world 目录] [--speed max|recorded|<倍数>] 记录文件...
+// 读取LATTICE_WORKLOAD_TRACE（或lattice_workload_trace_start）写出的.lwt文件，多个文件（同一进程中
+// 不同桥接库的记录）按时间戳合并，依次驱动native引擎，按子系统与事件输出调用耗时分布。
+//
+//   --world  区块加载/保存在该世界目录上执行（保存会写入region，请使用存档副本）；
+//            未指定时跳过区块事件
+//   --speed  max（默认）尽快回放；recorded按记录时的间隔回放；<倍数>按间隔的1/倍数回放。
+//            按间隔回放时同时报告最大落后时间：引擎跟不上记录时的节奏时这里会变大
+//
+// 回放在单线程上执行，统计的是引擎调用本身的耗时，不包含记录时的线程竞争。
+// 区块加载用getChunkDataForJava同步读取，保存的回调在调用线程执行，都按同步调用计时。
+// 记录中未出现创建事件的实体世界（开始记录前已经创建）按默认配置创建。
+// 红石事件回放到PaperCompatibleRedstoneEngine，未知的组件类型计入跳过。
+
+namespace {
+
+// ===== 统计 =====
+
+// LatencyHistogram的桶按数值分布，与单位无关，这里记录纳秒
+struct CallStats {
+    LatencyHistogram latency;
+    uint64_t skipped = 0;
+};
+
+struct ReplayStats {
+    CallStats events[lattice::core::TRACE_EVENT_COUNT];
+    CallStats subsystems[lattice::core::TRACE_SUBSYSTEM_COUNT];
+    uint64_t malformed = 0;
+    uint64_t unknown = 0;
+    uint64_t implicitWorlds = 0;
+    uint64_t maxLagNanos = 0;
+
+    void record(TraceEvent event, uint64_t nanos) {
+        events[static_cast<size_t>(event)].latency.record(nanos);
+        subsystems[static_cast<size_t>(lattice::core::traceSubsystemOf(event))].latency.record(nanos);
+    }
+
+    void skip(TraceEvent event) {
+        ++events[static_cast<size_t>(event)].skipped;
+        ++subsystems[static_cast<size_t>(lattice::core::traceSubsystemOf(event))].skipped;
+    }
+};
+
+// 引擎的注册日志会刷屏并计入耗时
+class SilenceStdout {
+public:
+    SilenceStdout() : previous_(std::cout.rdbuf(nullptr)) {}
+    ~SilenceStdout() { std::cout.rdbuf(previous_); }
+
+private:
+    std::streambuf* previous_;
+};
+
+template <typename Fn>
+void timed(ReplayStats& stats, TraceEvent event, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    stats.record(event, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+}
+
+// ===== 引擎 =====
+
+class Replayer {
+public:
+    Replayer(const std::string& worldPath, ReplayStats& stats) : stats_(stats) {
+        if (!worldPath.empty()) {
+            chunkIO_ = std::make_unique<AnvilChunkIO>(worldPath);
+        }
+    }
+
+    void dispatch(const TraceRecordView& record) {
+        const auto event = record.event;
+        if (event == TraceEvent{} || event >= TraceEvent::COUNT) {
+            ++stats_.unknown;
+            return;
+        }
+        TraceFieldReader fields(record.payload);
+        switch (lattice::core::traceSubsystemOf(event)) {
+            case TraceSubsystem::CHUNK_IO: replayChunk(event, fields); break;
+            case TraceSubsystem::ENTITY: replayEntity(event, fields); break;
+            case TraceSubsystem::LIGHT: replayLight(event, fields); break;
+            case TraceSubsystem::REDSTONE: replayRedstone(event, fields); break;
+            default: ++stats_.unknown; break;
+        }
+    }
+
+private:
+    // 负载读完后检查；字段不全的记录不回放
+    bool valid(const TraceFieldReader& fields) {
+        if (!fields.ok()) {
+            ++stats_.malformed;
+            return false;
+        }
+        return true;
+    }
+
+    void loadChunk(int worldId, int chunkX, int chunkZ) {
+        try {
+            chunkIO_->getChunkDataForJava(worldId, chunkX, chunkZ);
+        } catch (const std::exception& e) {
+            std::cerr << "Chunk (" << chunkX << ", " << chunkZ << ") load failed: " << e.what() << std::endl;
+        }
+    }
+
+    void replayChunk(TraceEvent event, TraceFieldReader& fields) {
+        if (!chunkIO_) {
+            stats_.skip(event);
+            return;
+        }
+        switch (event) {
+            case TraceEvent::CHUNK_LOAD: {
+                const int worldId = fields.i32(), chunkX = fields.i32(), chunkZ = fields.i32();
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] { loadChunk(worldId, chunkX, chunkZ); });
+                break;
+            }
+            case TraceEvent::CHUNK_LOAD_BATCH: {
+                const int worldId = fields.i32();
+                const uint64_t count = fields.u64();
+                std::vector<uint64_t> coords;
+                for (uint64_t i = 0; i < count && fields.ok(); ++i) {
+                    coords.push_back(fields.u64());
+                }
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] {
+                    for (uint64_t packed : coords) {
+                        loadChunk(worldId, ChunkLoadBatcher::unpackX(packed), ChunkLoadBatcher::unpackZ(packed));
+                    }
+                });
+                break;
+            }
+            case TraceEvent::CHUNK_SAVE: {
+                AnvilChunkData chunk;
+                chunk.worldId = fields.i32();
+                chunk.x = fields.i32();
+                chunk.z = fields.i32();
+                const uint64_t size = fields.u64();
+                const auto nbt = fields.bytes();
+                if (!valid(fields)) return;
+                // 记录时关闭了负载：按原大小写零，保留写盘与压缩的数据量
+                if (nbt.empty()) {
+                    chunk.data.assign(static_cast<size_t>(size), 0);
+                } else {
+                    chunk.data.assign(nbt.begin(), nbt.end());
+                }
+                chunk.lastModified = static_cast<uint32_t>(std::time(nullptr));
+                timed(stats_, event, [&] {
+                    chunkIO_->saveChunkAsync(chunk, [&](lattice::io::AsyncIOResult result) {
+                        if (!result.success) {
+                            std::cerr << "Chunk (" << chunk.x << ", " << chunk.z << ") save failed: "
+                                      << result.errorMessage << std::endl;
+                        }
+                    });
+                });
+                break;
+            }
+            default:
+                ++stats_.unknown;
+                break;
+        }
+    }
+
+    ShardedWorldTracker& world(int worldId) {
+        auto it = worlds_.find(worldId);
+        if (it == worlds_.end()) {
+            ++stats_.implicitWorlds;
+            it = worlds_.emplace(worldId, std::make_unique<ShardedWorldTracker>()).first;
+        }
+        return *it->second;
+    }
+
+    void replayEntity(TraceEvent event, TraceFieldReader& fields) {
+        const int worldId = fields.i32();
+        switch (event) {
+            case TraceEvent::ENTITY_WORLD_CREATE: {
+                ShardedWorldTracker::Config config;
+                config.shardSizeChunks = fields.i32();
+                config.worldHeight = fields.i32();
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] {
+                    worlds_[worldId] = std::make_unique<ShardedWorldTracker>(config);
+                });
+                break;
+            }
+            case TraceEvent::ENTITY_WORLD_DESTROY: {
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] { worlds_.erase(worldId); });
+                break;
+            }
+            case TraceEvent::ENTITY_ADD: {
+                const int id = fields.i32();
+                const float x = fields.f32(), y = fields.f32(), z = fields.f32(), radius = fields.f32();
+                const int type = fields.i32();
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                timed(stats_, event, [&] {
+                    tracker.registerEntity(id, x, y, z, radius, static_cast<EntityType>(type));
+                });
+                break;
+            }
+            case TraceEvent::ENTITY_MOVE: {
+                const int id = fields.i32();
+                const float x = fields.f32(), y = fields.f32(), z = fields.f32();
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                timed(stats_, event, [&] { tracker.updateEntityPosition(id, x, y, z); });
+                break;
+            }
+            case TraceEvent::ENTITY_MOVE_BATCH: {
+                struct Move { int id; float x, y, z; };
+                const uint64_t count = fields.u64();
+                std::vector<Move> moves;
+                for (uint64_t i = 0; i < count && fields.ok(); ++i) {
+                    Move move;
+                    move.id = fields.i32();
+                    move.x = fields.f32();
+                    move.y = fields.f32();
+                    move.z = fields.f32();
+                    moves.push_back(move);
+                }
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                timed(stats_, event, [&] {
+                    for (const auto& move : moves) {
+                        tracker.updateEntityPosition(move.id, move.x, move.y, move.z);
+                    }
+                });
+                break;
+            }
+            case TraceEvent::ENTITY_REMOVE: {
+                const int id = fields.i32();
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                timed(stats_, event, [&] { tracker.unregisterEntity(id); });
+                break;
+            }
+            case TraceEvent::ENTITY_VIEW_UPDATE:
+            case TraceEvent::ENTITY_VIEW_QUERY: {
+                const int viewerId = fields.i32();
+                const float x = fields.f32(), y = fields.f32(), z = fields.f32(), distance = fields.f32();
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                if (event == TraceEvent::ENTITY_VIEW_UPDATE) {
+                    timed(stats_, event, [&] { tracker.updateViewerVisibility(viewerId, x, y, z, distance); });
+                } else {
+                    timed(stats_, event, [&] { tracker.getVisibleEntities(viewerId, x, y, z, distance); });
+                }
+                break;
+            }
+            case TraceEvent::ENTITY_VIEWER_REMOVE: {
+                const int viewerId = fields.i32();
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                timed(stats_, event, [&] { tracker.removeViewer(viewerId); });
+                break;
+            }
+            case TraceEvent::ENTITY_TICK: {
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                timed(stats_, event, [&] { tracker.tick(); });
+                break;
+            }
+            case TraceEvent::ENTITY_TICK_SHARD: {
+                const int shardX = fields.i32(), shardZ = fields.i32();
+                if (!valid(fields)) return;
+                auto& tracker = world(worldId);
+                timed(stats_, event, [&] { tracker.tickShard(shardX, shardZ); });
+                break;
+            }
+            default:
+                ++stats_.unknown;
+                break;
+        }
+    }
+
+    void replayLight(TraceEvent event, TraceFieldReader& fields) {
+        switch (event) {
+            case TraceEvent::LIGHT_SOURCE_ADD: {
+                const int x = fields.i32(), y = fields.i32(), z = fields.i32(), level = fields.i32();
+                const auto type = fields.i32() == 0 ? LightType::BLOCK : LightType::SKY;
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] { light_.addLightSource(BlockPos(x, y, z), static_cast<uint8_t>(level), type); });
+                break;
+            }
+            case TraceEvent::LIGHT_SOURCE_REMOVE: {
+                const int x = fields.i32(), y = fields.i32(), z = fields.i32();
+                const auto type = fields.i32() == 0 ? LightType::BLOCK : LightType::SKY;
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] { light_.removeLightSource(BlockPos(x, y, z), type); });
+                break;
+            }
+            case TraceEvent::LIGHT_PROPAGATE:
+                timed(stats_, event, [&] { light_.propagateLightUpdates(); });
+                break;
+            default:
+                ++stats_.unknown;
+                break;
+        }
+    }
+
+    void replayRedstone(TraceEvent event, TraceFieldReader& fields) {
+        auto& engine = PaperCompatibleRedstoneEngine::getInstance();
+        switch (event) {
+            case TraceEvent::REDSTONE_COMPONENT: {
+                const auto kind = static_cast<RedstoneComponentKind>(fields.i32());
+                const int x = fields.i32(), y = fields.i32(), z = fields.i32(), param = fields.i32();
+                if (!valid(fields)) return;
+                if (kind > RedstoneComponentKind::PISTON) {
+                    stats_.skip(event);
+                    return;
+                }
+                SilenceStdout silence;
+                // RedstoneComponentKind与PaperRedstoneType的顺序相同
+                timed(stats_, event, [&] {
+                    engine.registerComponent(x, y, z, static_cast<PaperRedstoneType>(kind), param);
+                });
+                break;
+            }
+            case TraceEvent::REDSTONE_POWER: {
+                const int x = fields.i32(), y = fields.i32(), z = fields.i32(), power = fields.i32();
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] { engine.updatePower(x, y, z, power); });
+                break;
+            }
+            case TraceEvent::REDSTONE_COMPARATOR_BIND: {
+                const int x = fields.i32(), y = fields.i32(), z = fields.i32();
+                const int cx = fields.i32(), cy = fields.i32(), cz = fields.i32(), signal = fields.i32();
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] { engine.bindComparatorContainer(x, y, z, cx, cy, cz, signal); });
+                break;
+            }
+            case TraceEvent::REDSTONE_CONTAINER: {
+                const int cx = fields.i32(), cy = fields.i32(), cz = fields.i32(), signal = fields.i32();
+                if (!valid(fields)) return;
+                timed(stats_, event, [&] { engine.onContainerChanged(cx, cy, cz, signal); });
+                break;
+            }
+            case TraceEvent::REDSTONE_TICK: {
+                SilenceStdout silence;
+                timed(stats_, event, [&] { engine.tick(); });
+                break;
+            }
+            default:
+                ++stats_.unknown;
+                break;
+        }
+    }
+
+    ReplayStats& stats_;
+    std::unique_ptr<AnvilChunkIO> chunkIO_;
+    std::unordered_map<int, std::unique_ptr<ShardedWorldTracker>> worlds_;
+    LightUpdater light_;
+};
+
+// ===== 输出 =====
+
+void printRow(const char* name, const CallStats& stats) {
+    const auto& latency = stats.latency;
+    if (latency.count() == 0 && stats.skipped == 0) {
+        return;
+    }
+    std::cout << "  " << std::left << std::setw(26) << name << std::right
+              << std::setw(10) << latency.count()
+              << std::setw(12) << latency.sum() / 1e6
+              << std::setw(11) << latency.percentile(0.5) / 1e3
+              << std::setw(11) << latency.percentile(0.99) / 1e3
+              << std::setw(11) << latency.max() / 1e3
+              << std::setw(9) << stats.skipped << std::endl;
+}
+
+void printReport(const ReplayStats& stats, double wallSeconds, bool paced) {
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  " << std::left << std::setw(26) << "" << std::right
+              << std::setw(10) << "calls" << std::setw(12) << "total ms" << std::setw(11) << "p50 us"
+              << std::setw(11) << "p99 us" << std::setw(11) << "max us" << std::setw(9) << "skipped" << std::endl;
+    std::cout << "By subsystem:" << std::endl;
+    for (size_t i = 0; i < lattice::core::TRACE_SUBSYSTEM_COUNT; ++i) {
+        printRow(lattice::core::traceSubsystemName(static_cast<TraceSubsystem>(i)), stats.subsystems[i]);
+    }
+    std::cout << "By event:" << std::endl;
+    for (size_t i = 1; i < lattice::core::TRACE_EVENT_COUNT; ++i) {
+        printRow(lattice::core::traceEventName(static_cast<TraceEvent>(i)), stats.events[i]);
+    }
+    std::cout << std::setprecision(3) << "Wall time " << wallSeconds << " s";
+    if (paced) {
+        std::cout << ", max lag behind recording " << stats.maxLagNanos / 1e6 << " ms";
+    }
+    std::cout << std::endl;
+    if (stats.implicitWorlds) {
+        std::cout << stats.implicitWorlds << " entity worlds created with the default config "
+                  << "(created before recording started)" << std::endl;
+    }
+    if (stats.malformed || stats.unknown) {
+        std::cout << stats.malformed << " malformed and " << stats.unknown << " unknown records ignored" << std::endl;
+    }
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--world DIR] [--speed max|recorded|FACTOR] TRACE..." << std::endl;
+}
+
+// 多个文件按时间戳合并时的游标
+struct Cursor {
+    std::unique_ptr<WorkloadTraceReader> reader;
+    TraceRecordView record{};
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string worldPath;
+    double speed = 0.0;                 // 0为尽快回放
+    std::vector<std::string> traces;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--world" && i + 1 < argc) {
+            worldPath = argv[++i];
+        } else if (arg == "--speed" && i + 1 < argc) {
+            const std::string value = argv[++i];
+            if (value == "max") {
+                speed = 0.0;
+            } else if (value == "recorded") {
+                speed = 1.0;
+            } else {
+                speed = std::strtod(value.c_str(), nullptr);
+                if (speed <= 0.0) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            traces.push_back(arg);
+        }
+    }
+    if (traces.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Cursor> cursors;
+    for (const auto& path : traces) {
+        Cursor cursor;
+        cursor.reader = std::make_unique<WorkloadTraceReader>(path);
+        if (!cursor.reader->isOpen()) {
+            std::cerr << path << ": " << cursor.reader->error() << std::endl;
+            return 1;
+        }
+        std::cout << path << ": " << cursor.reader->libraryTag() << ", pid " << cursor.reader->pid() << std::endl;
+        cursors.push_back(std::move(cursor));
+    }
+
+    try {
+        ReplayStats stats;
+        Replayer replayer(worldPath, stats);
+
+        // 小顶堆：(时间戳, 游标下标)
+        using Entry = std::pair<uint64_t, size_t>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap;
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            if (cursors[i].reader->next(cursors[i].record)) {
+                heap.emplace(cursors[i].record.timestamp, i);
+            }
+        }
+
+        const uint64_t firstTimestamp = heap.empty() ? 0 : heap.top().first;
+        const auto replayStart = std::chrono::steady_clock::now();
+        while (!heap.empty()) {
+            const size_t index = heap.top().second;
+            heap.pop();
+            auto& cursor = cursors[index];
+
+            if (speed > 0.0) {
+                const auto offset = std::chrono::nanoseconds(
+                    static_cast<int64_t>((cursor.record.timestamp - firstTimestamp) / speed));
+                const auto due = replayStart + offset;
+                const auto now = std::chrono::steady_clock::now();
+                if (now < due) {
+                    std::this_thread::sleep_until(due);
+                } else {
+                    stats.maxLagNanos = std::max<uint64_t>(stats.maxLagNanos,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(now - due).count());
+                }
+            }
+
+            replayer.dispatch(cursor.record);
+            if (cursor.reader->next(cursor.record)) {
+                heap.emplace(cursor.record.timestamp, index);
+            }
+        }
+        const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - replayStart).count();
+
+        for (size_t i = 0; i < cursors.size(); ++i) {
+            if (cursors[i].reader->truncated()) {
+                std::cout << traces[i] << ": truncated (recording process exited before flushing)" << std::endl;
+            }
+        }
+        printReport(stats, wallSeconds, speed > 0.0);
+    } catch (const std::exception& e) {
+        std::cerr << "Replay failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,945 @@
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "bench_world.hpp"
+#include "core/frame_allocator.hpp"
+#include "core/io/io_metrics.hpp"
+#include "core/net/hierarchical_tracker.hpp"
+#include "core/redstone/paper_compatible_redstone_engine.hpp"
+#include "core/workload_trace.hpp"
+
+#ifdef LATTICE_WORLD_BENCH_AI
+#include "entity/biological_ai.hpp"
+#endif
+
+using namespace lattice::bench;
+using lattice::core::FrameAllocator;
+using lattice::core::TraceEvent;
+using lattice::core::TraceFieldReader;
+using lattice::core::TraceRecordView;
+using lattice::core::TraceSubsystem;
+using lattice::core::WorkloadTraceReader;
+using lattice::entity::EntityType;
+using lattice::entity::HierarchicalTracker;
+using lattice::io::LatencyHistogram;
+using lattice::io::anvil::AnvilChunkData;
+using lattice::redstone::paper::PaperCompatibleRedstoneEngine;
+
+// ===== 端到端世界基准 =====
+// 用法: lattice_world_bench --world 目录 [--dim ID] [--chunks N] [--ticks N] [--trace 记录文件]
+//                           [--states 文件] [--out 目录] [--baseline 文件] [--write-baseline 文件]
+//                           [--tolerance 比例] [--ai-data 目录 --ai-version 版本]
+// 在一个参考世界上依次跑一遍各native子系统，报告每个阶段的吞吐量、p99以及阶段结束时的峰值RSS：
+//   load      通过AnvilChunkIO读取并解析区块（每个区块一个样本）
+//   light     AdvancedLightEngine整区块光照：天空光按列初始化、发光方块作为光源，逐区块处理到队列为空
+//   track     HierarchicalTracker：按--trace中ENTITY_*事件逐tick移动实体、更新观察者可见集，然后tick；
+//             没有记录时每个区块生成4个随机游走的实体，每64个区块一个观察者
+//   redstone  区块中的红石线、中继器、比较器注册到PaperCompatibleRedstoneEngine，每tick翻转一组驱动信号；
+//             世界里没有红石时每个区块生成一条16格的红石线
+//   ai        AIEngine按track的实体逐tick决策（以LATTICE_WORLD_BENCH_AI构建并指定--ai-data时）
+//   save      区块连同计算出的段光照通过AnvilChunkIO保存到--out；未指定时写到临时目录并在结束后删除，
+//             参考世界本身只读
+// tick阶段每个模拟tick一个样本，每个tick开始时推进FrameAllocator的帧（与服务器上NativeTickBudget的上报一致）。
+//
+//   --write-baseline  把本次结果写成key=value文本
+//   --baseline        与之前写出的结果比较：任一阶段吞吐量下降、p99或峰值RSS上升超过--tolerance（默认0.10）
+//                     时返回2。工作负载（区块数、tick数、实体数）与基准不同时不比较并返回1
+// 基准只在同一台机器、同一份参考世界与记录上有意义；p99低于MIN_COMPARED_P99_NANOS的阶段只比较吞吐量。
+
+namespace {
+
+// ===== 阶段统计 =====
+
+enum Stage : size_t { LOAD, LIGHT, TRACK, REDSTONE, AI, SAVE, STAGE_COUNT };
+
+constexpr const char* STAGE_NAMES[STAGE_COUNT] = {"load", "light", "track", "redstone", "ai", "save"};
+constexpr const char* STAGE_UNITS[STAGE_COUNT] = {"chunks", "chunks", "ticks", "ticks", "ticks", "chunks"};
+
+// LatencyHistogram的桶按数值分布，与单位无关，这里记录纳秒
+struct StageStats {
+    LatencyHistogram latency;
+    uint64_t units = 0;
+    double seconds = 0.0;
+    long peakRssKb = 0;
+
+    bool ran() const { return latency.count() != 0; }
+    double throughput() const { return seconds > 0.0 ? static_cast<double>(units) / seconds : 0.0; }
+};
+
+template <typename Fn>
+void timed(StageStats& stage, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    stage.latency.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    stage.seconds += std::chrono::duration<double>(elapsed).count();
+    ++stage.units;
+}
+
+// 进程迄今为止的峰值常驻内存（Linux下ru_maxrss单位为KB）
+long peakRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// 引擎的注册日志会刷屏并计入耗时
+class SilenceStdout {
+public:
+    SilenceStdout() : previous_(std::cout.rdbuf(nullptr)) {}
+    ~SilenceStdout() { std::cout.rdbuf(previous_); }
+
+private:
+    std::streambuf* previous_;
+};
+
+// ===== 实体工作负载 =====
+
+struct EntityOp {
+    enum class Kind : uint8_t { ADD, MOVE, REMOVE, VIEW, QUERY, VIEWER_REMOVE };
+    Kind kind;
+    int id;
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    float extra = 0.0f;                      // ADD: 半径，VIEW / QUERY: 视距
+    EntityType type = EntityType::OTHER;
+};
+
+using TickOps = std::vector<EntityOp>;
+
+/**
+ * 每个模拟tick的实体操作：来自记录（按ENTITY_TICK分tick）或按已加载区块生成
+ * 记录只回放第一个出现的实体世界；记录的tick用完后没有实体操作，只推进各引擎的tick
+ */
+class EntityWorkload {
+public:
+    static EntityWorkload fromTrace(const std::string& path) {
+        WorkloadTraceReader reader(path);
+        if (!reader.isOpen()) {
+            throw std::runtime_error(path + ": " + reader.error());
+        }
+        EntityWorkload workload;
+        workload.recorded_.emplace_back();
+        bool haveWorld = false;
+        int worldId = 0;
+        std::unordered_set<int> ids;
+        TraceRecordView record{};
+        while (reader.next(record)) {
+            if (record.event == TraceEvent{} || record.event >= TraceEvent::COUNT ||
+                lattice::core::traceSubsystemOf(record.event) != TraceSubsystem::ENTITY) {
+                continue;
+            }
+            TraceFieldReader fields(record.payload);
+            const int recordWorld = fields.i32();
+            if (!fields.ok() || (haveWorld && recordWorld != worldId)) {
+                continue;
+            }
+            haveWorld = true;
+            worldId = recordWorld;
+            TickOps& ops = workload.recorded_.back();
+            switch (record.event) {
+                case TraceEvent::ENTITY_ADD: {
+                    EntityOp op{EntityOp::Kind::ADD, fields.i32()};
+                    op.x = fields.f32();
+                    op.y = fields.f32();
+                    op.z = fields.f32();
+                    op.extra = fields.f32();
+                    op.type = static_cast<EntityType>(fields.i32());
+                    if (fields.ok()) {
+                        ids.insert(op.id);
+                        ops.push_back(op);
+                    }
+                    break;
+                }
+                case TraceEvent::ENTITY_MOVE: {
+                    EntityOp op{EntityOp::Kind::MOVE, fields.i32()};
+                    op.x = fields.f32();
+                    op.y = fields.f32();
+                    op.z = fields.f32();
+                    if (fields.ok()) {
+                        ops.push_back(op);
+                    }
+                    break;
+                }
+                case TraceEvent::ENTITY_MOVE_BATCH: {
+                    const uint64_t count = fields.u64();
+                    for (uint64_t i = 0; i < count && fields.ok(); ++i) {
+                        EntityOp op{EntityOp::Kind::MOVE, fields.i32()};
+                        op.x = fields.f32();
+                        op.y = fields.f32();
+                        op.z = fields.f32();
+                        if (fields.ok()) {
+                            ops.push_back(op);
+                        }
+                    }
+                    break;
+                }
+                case TraceEvent::ENTITY_REMOVE: {
+                    EntityOp op{EntityOp::Kind::REMOVE, fields.i32()};
+                    if (fields.ok()) {
+                        ops.push_back(op);
+                    }
+                    break;
+                }
+                case TraceEvent::ENTITY_VIEW_UPDATE:
+                case TraceEvent::ENTITY_VIEW_QUERY: {
+                    EntityOp op{record.event == TraceEvent::ENTITY_VIEW_UPDATE ? EntityOp::Kind::VIEW
+                                                                                : EntityOp::Kind::QUERY,
+                                fields.i32()};
+                    op.x = fields.f32();
+                    op.y = fields.f32();
+                    op.z = fields.f32();
+                    op.extra = fields.f32();
+                    if (fields.ok()) {
+                        ops.push_back(op);
+                    }
+                    break;
+                }
+                case TraceEvent::ENTITY_VIEWER_REMOVE: {
+                    EntityOp op{EntityOp::Kind::VIEWER_REMOVE, fields.i32()};
+                    if (fields.ok()) {
+                        ops.push_back(op);
+                    }
+                    break;
+                }
+                case TraceEvent::ENTITY_TICK:
+                    workload.recorded_.emplace_back();
+                    break;
+                default:
+                    break;
+            }
+        }
+        if (workload.recorded_.back().empty()) {
+            workload.recorded_.pop_back();
+        }
+        if (reader.truncated()) {
+            std::cout << path << ": truncated (recording process exited before flushing)" << std::endl;
+        }
+        workload.entities_ = ids.size();
+        return workload;
+    }
+
+    static EntityWorkload synthetic(const std::vector<LoadedChunk>& chunks) {
+        EntityWorkload workload;
+        workload.synthetic_ = true;
+        std::uniform_real_distribution<float> offset(0.0f, 16.0f);
+        static constexpr EntityType MOB_TYPES[] = {EntityType::MONSTER, EntityType::ANIMAL, EntityType::MONSTER,
+                                                   EntityType::VILLAGER};
+        int nextId = 1;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            const auto& chunk = chunks[i];
+            const float baseX = static_cast<float>(chunk.chunkX << 4);
+            const float baseZ = static_cast<float>(chunk.chunkZ << 4);
+            for (size_t j = 0; j < SYNTHETIC_ENTITIES_PER_CHUNK; ++j) {
+                workload.mobs_.push_back({nextId++, baseX + offset(workload.random_), SYNTHETIC_Y,
+                                          baseZ + offset(workload.random_), MOB_TYPES[j % std::size(MOB_TYPES)]});
+            }
+            if (i % SYNTHETIC_CHUNKS_PER_VIEWER == 0) {
+                workload.viewers_.push_back({nextId++, baseX + 8.0f, SYNTHETIC_Y, baseZ + 8.0f, EntityType::PLAYER});
+            }
+        }
+        workload.entities_ = workload.mobs_.size() + workload.viewers_.size();
+        return workload;
+    }
+
+    const TickOps& opsFor(uint64_t tick) {
+        if (!synthetic_) {
+            return tick < recorded_.size() ? recorded_[tick] : empty_;
+        }
+        buffer_.clear();
+        if (tick == 0) {
+            for (const auto& mob : mobs_) {
+                buffer_.push_back(addOp(mob, 0.6f));
+            }
+            for (const auto& viewer : viewers_) {
+                buffer_.push_back(addOp(viewer, 0.3f));
+            }
+        }
+        // 大约一半的生物每tick走一步，观察者沿x方向匀速移动
+        std::uniform_real_distribution<float> step(-0.3f, 0.3f);
+        for (auto& mob : mobs_) {
+            if (random_() & 1) {
+                mob.x += step(random_);
+                mob.z += step(random_);
+                buffer_.push_back(EntityOp{EntityOp::Kind::MOVE, mob.id, mob.x, mob.y, mob.z});
+            }
+        }
+        for (auto& viewer : viewers_) {
+            viewer.x += 0.2f;
+            buffer_.push_back(EntityOp{EntityOp::Kind::MOVE, viewer.id, viewer.x, viewer.y, viewer.z});
+            buffer_.push_back(EntityOp{EntityOp::Kind::VIEW, viewer.id, viewer.x, viewer.y, viewer.z,
+                                       SYNTHETIC_VIEW_DISTANCE});
+        }
+        return buffer_;
+    }
+
+    size_t entities() const { return entities_; }
+    size_t recordedTicks() const { return recorded_.size(); }
+    bool isSynthetic() const { return synthetic_; }
+
+private:
+    static constexpr size_t SYNTHETIC_ENTITIES_PER_CHUNK = 4;
+    static constexpr size_t SYNTHETIC_CHUNKS_PER_VIEWER = 64;
+    static constexpr float SYNTHETIC_VIEW_DISTANCE = 128.0f;
+    static constexpr float SYNTHETIC_Y = 64.0f;             // 追踪器不看地形，高度只影响分层索引
+
+    struct Walker {
+        int id;
+        float x, y, z;
+        EntityType type;
+    };
+
+    static EntityOp addOp(const Walker& walker, float radius) {
+        EntityOp op{EntityOp::Kind::ADD, walker.id, walker.x, walker.y, walker.z, radius};
+        op.type = walker.type;
+        return op;
+    }
+
+    bool synthetic_ = false;
+    size_t entities_ = 0;
+    std::vector<TickOps> recorded_;
+    std::vector<Walker> mobs_;
+    std::vector<Walker> viewers_;
+    TickOps buffer_;
+    const TickOps empty_;
+    std::mt19937 random_{12345};
+};
+
+void applyEntityOps(HierarchicalTracker& tracker, const TickOps& ops) {
+    for (const auto& op : ops) {
+        switch (op.kind) {
+            case EntityOp::Kind::ADD: tracker.registerEntity(op.id, op.x, op.y, op.z, op.extra, op.type); break;
+            case EntityOp::Kind::MOVE: tracker.updateEntityPosition(op.id, op.x, op.y, op.z); break;
+            case EntityOp::Kind::REMOVE: tracker.unregisterEntity(op.id); break;
+            case EntityOp::Kind::VIEW: tracker.updateViewerVisibility(op.id, op.x, op.y, op.z, op.extra); break;
+            case EntityOp::Kind::QUERY: tracker.getVisibleEntities(op.id, op.x, op.y, op.z, op.extra); break;
+            case EntityOp::Kind::VIEWER_REMOVE: tracker.removeViewer(op.id); break;
+        }
+    }
+}
+
+// ===== 红石工作负载 =====
+
+class RedstoneWorkload {
+public:
+    explicit RedstoneWorkload(PaperCompatibleRedstoneEngine& engine) : engine_(engine) {}
+
+    // 注册区块中的红石组件；一个都没有时每个区块生成一条红石线
+    void registerFrom(const std::vector<LoadedChunk>& chunks, const StateRegistry& registry) {
+        std::vector<Component> kinds(registry.size());
+        for (size_t id = 0; id < registry.size(); ++id) {
+            kinds[id] = classify(registry.key(static_cast<uint16_t>(id)));
+        }
+        SilenceStdout silence;
+        std::vector<std::array<int, 3>> wires;
+        for (const auto& chunk : chunks) {
+            for (const auto& section : chunk.sections) {
+                for (size_t index = 0; index < section.states.size(); ++index) {
+                    const Component& component = kinds[section.states[index]];
+                    if (component.kind == Component::NONE) {
+                        continue;
+                    }
+                    const int x = (chunk.chunkX << 4) + static_cast<int>(index & 15);
+                    const int y = (section.sectionY << 4) + static_cast<int>(index >> 8);
+                    const int z = (chunk.chunkZ << 4) + static_cast<int>(index >> 4 & 15);
+                    if (component.kind == Component::WIRE && engine_.registerRedstoneWire(x, y, z)) {
+                        wires.push_back({x, y, z});
+                    } else if (component.kind == Component::REPEATER) {
+                        engine_.registerRepeater(x, y, z, component.param);
+                    } else if (component.kind == Component::COMPARATOR) {
+                        engine_.registerComparator(x, y, z, component.param != 0);
+                    }
+                    ++components_;
+                }
+            }
+        }
+        if (components_ == 0) {
+            synthetic_ = true;
+            for (const auto& chunk : chunks) {
+                const int y = (chunk.sections.back().sectionY << 4) + 16;
+                const int z = (chunk.chunkZ << 4) + 8;
+                for (int dx = 0; dx < 16; ++dx) {
+                    engine_.registerRedstoneWire((chunk.chunkX << 4) + dx, y, z);
+                    ++components_;
+                }
+                wires.push_back({chunk.chunkX << 4, y, z});
+            }
+        }
+        // 驱动信号均匀取自红石线
+        const size_t stride = std::max<size_t>(1, wires.size() / MAX_DRIVERS);
+        for (size_t i = 0; i < wires.size() && drivers_.size() < MAX_DRIVERS; i += stride) {
+            drivers_.push_back(wires[i]);
+        }
+    }
+
+    // 每个驱动信号以8 tick为周期亮灭（相位错开），然后推进一个tick
+    void tick(uint64_t tick) {
+        for (size_t i = 0; i < drivers_.size(); ++i) {
+            const auto& [x, y, z] = drivers_[i];
+            engine_.updatePower(x, y, z, ((tick + i) / 4) % 2 ? 15 : 0);
+        }
+        SilenceStdout silence;
+        engine_.tick();
+        blockUpdates_ += engine_.takeBlockUpdates().size();
+    }
+
+    size_t components() const { return components_; }
+    size_t drivers() const { return drivers_.size(); }
+    uint64_t blockUpdates() const { return blockUpdates_; }
+    bool isSynthetic() const { return synthetic_; }
+
+private:
+    static constexpr size_t MAX_DRIVERS = 64;
+
+    struct Component {
+        enum Kind : uint8_t { NONE, WIRE, REPEATER, COMPARATOR } kind = NONE;
+        int param = 0;                       // 中继器: 延迟，比较器: 是否为减法模式
+    };
+
+    static Component classify(std::string_view key) {
+        const std::string_view name = key.substr(0, key.find('['));
+        const std::string_view properties = name.size() < key.size() ? key.substr(name.size()) : std::string_view{};
+        Component component;
+        if (name == "minecraft:redstone_wire") {
+            component.kind = Component::WIRE;
+        } else if (name == "minecraft:repeater") {
+            component.kind = Component::REPEATER;
+            const size_t delay = properties.find("delay=");
+            component.param = delay != std::string_view::npos ? properties[delay + 6] - '0' : 1;
+        } else if (name == "minecraft:comparator") {
+            component.kind = Component::COMPARATOR;
+            component.param = properties.find("mode=subtract") != std::string_view::npos;
+        }
+        return component;
+    }
+
+    PaperCompatibleRedstoneEngine& engine_;
+    std::vector<std::array<int, 3>> drivers_;
+    size_t components_ = 0;
+    uint64_t blockUpdates_ = 0;
+    bool synthetic_ = false;
+};
+
+#ifdef LATTICE_WORLD_BENCH_AI
+// ===== AI工作负载 =====
+
+// AIEngine的注册日志用printf输出
+class SilenceStdio {
+public:
+    SilenceStdio() {
+        std::fflush(stdout);
+        saved_ = dup(STDOUT_FILENO);
+        const int devNull = open("/dev/null", O_WRONLY);
+        if (saved_ >= 0 && devNull >= 0) {
+            dup2(devNull, STDOUT_FILENO);
+        }
+        if (devNull >= 0) {
+            close(devNull);
+        }
+    }
+
+    ~SilenceStdio() {
+        std::fflush(stdout);
+        if (saved_ >= 0) {
+            dup2(saved_, STDOUT_FILENO);
+            close(saved_);
+        }
+    }
+
+private:
+    int saved_;
+};
+
+// track阶段的怪物、动物与村民交给AIEngine，观察者作为玩家位置
+class AIWorkload {
+public:
+    bool initialize(const std::string& dataPath, const std::string& version) {
+        return engine_.initialize(dataPath, version);
+    }
+
+    void apply(const TickOps& ops) {
+        bool viewersMoved = false;
+        for (const auto& op : ops) {
+            switch (op.kind) {
+                case EntityOp::Kind::ADD: registerEntity(op); break;
+                case EntityOp::Kind::MOVE: {
+                    auto it = states_.find(op.id);
+                    if (it != states_.end()) {
+                        it->second.x = op.x;
+                        it->second.y = op.y;
+                        it->second.z = op.z;
+                        engine_.updateEntityState(static_cast<uint64_t>(op.id), it->second);
+                    }
+                    break;
+                }
+                case EntityOp::Kind::REMOVE:
+                    if (states_.erase(op.id)) {
+                        engine_.unregisterEntity(static_cast<uint64_t>(op.id));
+                    }
+                    break;
+                case EntityOp::Kind::VIEW:
+                    viewers_[op.id] = {op.x, op.y, op.z};
+                    viewersMoved = true;
+                    break;
+                case EntityOp::Kind::VIEWER_REMOVE:
+                    viewersMoved |= viewers_.erase(op.id) != 0;
+                    break;
+                case EntityOp::Kind::QUERY:
+                    break;
+            }
+        }
+        if (viewersMoved) {
+            std::vector<std::array<float, 3>> positions;
+            positions.reserve(viewers_.size());
+            for (const auto& [id, position] : viewers_) {
+                positions.push_back(position);
+            }
+            engine_.setPlayerPositions(std::move(positions));
+        }
+    }
+
+    void tick() { engine_.tick(); }
+
+    size_t entities() const { return states_.size(); }
+    uint64_t unknownTypes() const { return unknownTypes_; }
+
+private:
+    void registerEntity(const EntityOp& op) {
+        const char* type = nullptr;
+        switch (op.type) {
+            case EntityType::MONSTER: type = "zombie"; break;
+            case EntityType::ANIMAL: type = "cow"; break;
+            case EntityType::VILLAGER: type = "villager"; break;
+            default: return;
+        }
+        const auto id = static_cast<uint64_t>(op.id);
+        bool registered;
+        {
+            SilenceStdio silence;
+            registered = engine_.registerEntity(id, type);
+        }
+        const auto* config = registered ? engine_.getEntityConfig(id) : nullptr;
+        if (!config) {
+            ++unknownTypes_;
+            return;
+        }
+        lattice::entity::EntityState state{};
+        state.entityId = id;
+        state.x = op.x;
+        state.y = op.y;
+        state.z = op.z;
+        state.health = config->maxHealth;
+        state.maxHealth = config->maxHealth;
+        state.isAlive = true;
+        state.lightLevel = 15.0f;
+        engine_.updateEntityState(id, state);
+        states_[op.id] = std::move(state);
+    }
+
+    lattice::entity::AIEngine engine_;
+    std::unordered_map<int, lattice::entity::EntityState> states_;
+    std::map<int, std::array<float, 3>> viewers_;
+    uint64_t unknownTypes_ = 0;
+};
+#endif
+
+// ===== 基准文件 =====
+
+// p99低于该值时测量噪声与直方图分桶误差占主导，只比较吞吐量
+constexpr uint64_t MIN_COMPARED_P99_NANOS = 50'000;
+
+struct Workload {
+    size_t chunks = 0;
+    uint64_t ticks = 0;
+    size_t entities = 0;
+};
+
+using Baseline = std::map<std::string, double>;
+
+Baseline summarize(const Workload& workload, const StageStats (&stages)[STAGE_COUNT], long peakRss) {
+    Baseline result;
+    result["workload.chunks"] = static_cast<double>(workload.chunks);
+    result["workload.ticks"] = static_cast<double>(workload.ticks);
+    result["workload.entities"] = static_cast<double>(workload.entities);
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        if (stages[i].ran()) {
+            const std::string name = STAGE_NAMES[i];
+            result[name + ".throughput"] = stages[i].throughput();
+            result[name + ".p99_ns"] = static_cast<double>(stages[i].latency.percentile(0.99));
+        }
+    }
+    result["peak_rss_kb"] = static_cast<double>(peakRss);
+    return result;
+}
+
+void writeBaseline(const std::string& path, const Baseline& baseline) {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("cannot write baseline " + path);
+    }
+    out << "# lattice_world_bench baseline\n" << std::setprecision(10);
+    for (const auto& [key, value] : baseline) {
+        out << key << '=' << value << '\n';
+    }
+    if (!out) {
+        throw std::runtime_error("cannot write baseline " + path);
+    }
+}
+
+Baseline readBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("cannot open baseline " + path);
+    }
+    Baseline baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t equals = line.find('=');
+        if (line.empty() || line[0] == '#' || equals == std::string::npos) {
+            continue;
+        }
+        baseline[line.substr(0, equals)] = std::strtod(line.c_str() + equals + 1, nullptr);
+    }
+    return baseline;
+}
+
+enum class Verdict { PASS, REGRESSION, MISMATCH };
+
+Verdict compareBaseline(const Baseline& current, const Baseline& baseline, double tolerance) {
+    for (const char* key : {"workload.chunks", "workload.ticks", "workload.entities"}) {
+        auto it = baseline.find(key);
+        if (it == baseline.end() || it->second != current.at(key)) {
+            std::cout << "Baseline workload differs (" << key << " = "
+                      << (it != baseline.end() ? it->second : -1.0) << ", current " << current.at(key)
+                      << "); not comparing" << std::endl;
+            return Verdict::MISMATCH;
+        }
+    }
+
+    bool regressed = false;
+    auto check = [&](const std::string& key, bool higherIsBetter, double minimum) {
+        auto base = baseline.find(key);
+        auto now = current.find(key);
+        if (base == baseline.end() || now == current.end() || base->second <= 0.0 || base->second < minimum) {
+            return;
+        }
+        const double change = now->second / base->second - 1.0;
+        const bool bad = higherIsBetter ? change < -tolerance : change > tolerance;
+        std::cout << (bad ? "  REGRESSION " : "  ok         ") << std::left << std::setw(22) << key << std::right
+                  << std::setw(14) << now->second << " vs " << std::setw(14) << base->second << " ("
+                  << std::showpos << change * 100.0 << std::noshowpos << "%)" << std::endl;
+        regressed |= bad;
+    };
+    std::cout << std::fixed << std::setprecision(1) << "Against baseline (tolerance " << tolerance * 100.0
+              << "%):" << std::endl;
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        const std::string name = STAGE_NAMES[i];
+        check(name + ".throughput", true, 0.0);
+        check(name + ".p99_ns", false, static_cast<double>(MIN_COMPARED_P99_NANOS));
+    }
+    check("peak_rss_kb", false, 0.0);
+    return regressed ? Verdict::REGRESSION : Verdict::PASS;
+}
+
+// ===== 输出 =====
+
+void printReport(const StageStats (&stages)[STAGE_COUNT]) {
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  " << std::left << std::setw(10) << "stage" << std::right << std::setw(10) << "samples"
+              << std::setw(12) << "total ms" << std::setw(16) << "throughput" << std::setw(11) << "p50 us"
+              << std::setw(11) << "p99 us" << std::setw(11) << "max us" << std::setw(14) << "peak RSS MB"
+              << std::endl;
+    for (size_t i = 0; i < STAGE_COUNT; ++i) {
+        const auto& stage = stages[i];
+        if (!stage.ran()) {
+            continue;
+        }
+        std::ostringstream throughput;
+        throughput << std::fixed << std::setprecision(1) << stage.throughput() << ' ' << STAGE_UNITS[i] << "/s";
+        std::cout << "  " << std::left << std::setw(10) << STAGE_NAMES[i] << std::right
+                  << std::setw(10) << stage.latency.count()
+                  << std::setw(12) << stage.seconds * 1000.0
+                  << std::setw(16) << throughput.str()
+                  << std::setw(11) << stage.latency.percentile(0.5) / 1e3
+                  << std::setw(11) << stage.latency.percentile(0.99) / 1e3
+                  << std::setw(11) << stage.latency.max() / 1e3
+                  << std::setw(14) << stage.peakRssKb / 1024.0 << std::endl;
+    }
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " --world DIR [--dim ID] [--chunks N] [--ticks N] [--trace FILE] [--states FILE] [--out DIR]"
+                 " [--baseline FILE] [--write-baseline FILE] [--tolerance FRACTION]"
+                 " [--ai-data DIR --ai-version VERSION]" << std::endl;
+}
+
+constexpr uint64_t DEFAULT_TICKS = 600;
+constexpr int MAX_SETTLE_TICKS = 256;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+
+    std::string worldPath;
+    std::string outPath;
+    std::string tracePath;
+    std::string stateFile;
+    std::string baselinePath;
+    std::string writeBaselinePath;
+    std::string aiDataPath;
+    std::string aiVersion;
+    int worldId = 0;
+    size_t maxChunks = 256;
+    uint64_t ticks = 0;                 // 0为默认：记录的tick数或DEFAULT_TICKS
+    double tolerance = 0.10;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (arg == "--world") {
+            worldPath = argv[++i];
+        } else if (arg == "--dim") {
+            worldId = std::atoi(argv[++i]);
+        } else if (arg == "--chunks") {
+            maxChunks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--ticks") {
+            ticks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--trace") {
+            tracePath = argv[++i];
+        } else if (arg == "--states") {
+            stateFile = argv[++i];
+        } else if (arg == "--out") {
+            outPath = argv[++i];
+        } else if (arg == "--baseline") {
+            baselinePath = argv[++i];
+        } else if (arg == "--write-baseline") {
+            writeBaselinePath = argv[++i];
+        } else if (arg == "--tolerance") {
+            tolerance = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--ai-data") {
+            aiDataPath = argv[++i];
+        } else if (arg == "--ai-version") {
+            aiVersion = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (worldPath.empty() || maxChunks == 0 || tolerance < 0.0 || aiDataPath.empty() != aiVersion.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+#ifndef LATTICE_WORLD_BENCH_AI
+    if (!aiDataPath.empty()) {
+        std::cerr << "Built without LATTICE_WORLD_BENCH_AI; the ai stage is unavailable" << std::endl;
+        return 1;
+    }
+#endif
+
+    const bool scratchOutput = outPath.empty();
+    if (scratchOutput) {
+        outPath = (fs::temp_directory_path() / ("lattice_world_bench." + std::to_string(getpid()))).string();
+    }
+    std::error_code ec;
+    if (fs::exists(outPath, ec) && fs::equivalent(outPath, worldPath, ec)) {
+        std::cerr << "Refusing to save into the reference world; pass a different --out" << std::endl;
+        return 1;
+    }
+
+    int status = 0;
+    try {
+        StageStats stages[STAGE_COUNT];
+        StateRegistry registry(stateFile.empty() ? std::unordered_map<std::string, BlockLightProperties>{}
+                                                 : loadStateFile(stateFile));
+        const uint16_t air = registry.idFor("minecraft:air", "minecraft:air", "");
+
+        // 1. 加载：保留原始NBT，保存阶段原样写回
+        std::vector<LoadedChunk> chunks;
+        std::vector<std::vector<uint8_t>> payloads;
+        {
+            AnvilChunkIO io(worldPath);
+            for (const auto& [chunkX, chunkZ] : listChunks(worldPath, worldId, maxChunks)) {
+                LoadedChunk chunk;
+                std::vector<uint8_t> nbt;
+                bool loaded = false;
+                timed(stages[LOAD], [&] { loaded = loadChunk(io, worldId, chunkX, chunkZ, registry, chunk, &nbt); });
+                if (loaded) {
+                    chunks.push_back(std::move(chunk));
+                    payloads.push_back(std::move(nbt));
+                }
+            }
+        }
+        registry.upload();
+        stages[LOAD].peakRssKb = peakRssKb();
+        std::cout << "Loaded " << chunks.size() << " chunks (" << stages[LOAD].units - chunks.size()
+                  << " skipped, " << registry.size() << " block states)" << std::endl;
+        if (chunks.empty()) {
+            std::cerr << "No full chunks found under " << worldPath << std::endl;
+            return 1;
+        }
+
+        // 2. 光照
+        AdvancedLightEngine light;
+        size_t undrained = 0;
+        for (const auto& chunk : chunks) {
+            timed(stages[LIGHT], [&] {
+                int32_t minY = 0, height = 0;
+                auto column = columnStates(chunk, air, minY, height);
+                light.initializeChunkSkylight(chunk.chunkX, chunk.chunkZ, column.data(), minY, height);
+                for (size_t i = 0; i < column.size(); ++i) {
+                    if (LightOpacityTable::getEmission(column[i]) > 0) {
+                        light.onBlockChange((chunk.chunkX << 4) + static_cast<int32_t>(i & 15),
+                                            minY + static_cast<int32_t>(i >> 8),
+                                            (chunk.chunkZ << 4) + static_cast<int32_t>(i >> 4 & 15), column[i]);
+                    }
+                }
+                undrained += settle(light, MAX_SETTLE_TICKS) >= MAX_SETTLE_TICKS;
+            });
+        }
+        stages[LIGHT].peakRssKb = peakRssKb();
+        if (undrained) {
+            std::cout << undrained << " chunks did not settle within " << MAX_SETTLE_TICKS << " light ticks"
+                      << std::endl;
+        }
+
+        // 3. 模拟tick：实体追踪、红石、AI
+        EntityWorkload entities = tracePath.empty() ? EntityWorkload::synthetic(chunks)
+                                                    : EntityWorkload::fromTrace(tracePath);
+        if (ticks == 0) {
+            ticks = entities.isSynthetic() ? DEFAULT_TICKS : std::max<uint64_t>(1, entities.recordedTicks());
+        }
+        std::cout << (entities.isSynthetic() ? "Synthetic" : "Recorded") << " entity workload: "
+                  << entities.entities() << " entities";
+        if (!entities.isSynthetic()) {
+            std::cout << ", " << entities.recordedTicks() << " recorded ticks";
+        }
+        std::cout << std::endl;
+
+        HierarchicalTracker tracker;
+        auto& redstoneEngine = PaperCompatibleRedstoneEngine::getInstance();
+        RedstoneWorkload redstone(redstoneEngine);
+        redstone.registerFrom(chunks, registry);
+        std::cout << (redstone.isSynthetic() ? "Synthetic" : "World") << " redstone: " << redstone.components()
+                  << " components, " << redstone.drivers() << " driven wires" << std::endl;
+
+#ifdef LATTICE_WORLD_BENCH_AI
+        std::unique_ptr<AIWorkload> ai;
+        if (!aiDataPath.empty()) {
+            ai = std::make_unique<AIWorkload>();
+            if (!ai->initialize(aiDataPath, aiVersion)) {
+                std::cerr << "Failed to load entity data from " << aiDataPath << std::endl;
+                return 1;
+            }
+        }
+#endif
+
+        for (uint64_t tick = 0; tick < ticks; ++tick) {
+            FrameAllocator::instance().advanceFrame();
+            const TickOps& ops = entities.opsFor(tick);
+            timed(stages[TRACK], [&] {
+                applyEntityOps(tracker, ops);
+                tracker.tick();
+            });
+            timed(stages[REDSTONE], [&] { redstone.tick(tick); });
+#ifdef LATTICE_WORLD_BENCH_AI
+            if (ai) {
+                timed(stages[AI], [&] {
+                    ai->apply(ops);
+                    ai->tick();
+                });
+            }
+#endif
+        }
+        const long tickRss = peakRssKb();
+        stages[TRACK].peakRssKb = stages[REDSTONE].peakRssKb = stages[AI].peakRssKb = tickRss;
+        std::cout << "Simulated " << ticks << " ticks: " << tracker.getEntityCount() << " tracked entities, "
+                  << redstone.blockUpdates() << " redstone block updates";
+#ifdef LATTICE_WORLD_BENCH_AI
+        if (ai) {
+            std::cout << ", " << ai->entities() << " AI entities";
+            if (ai->unknownTypes()) {
+                std::cout << " (" << ai->unknownTypes() << " without entity data)";
+            }
+        }
+#endif
+        std::cout << ", " << FrameAllocator::instance().getStats().blockAllocations << " frame arena blocks"
+                  << std::endl;
+
+        // 4. 保存：原始NBT连同计算出的段光照
+        uint64_t saveFailures = 0;
+        {
+            AnvilChunkIO out(outPath);
+            for (size_t i = 0; i < chunks.size(); ++i) {
+                AnvilChunkData chunk(chunks[i].chunkX, chunks[i].chunkZ, worldId);
+                chunk.data = std::move(payloads[i]);
+                timed(stages[SAVE], [&] {
+                    chunk.lightTrusted = light.saveChunkLight(chunk.x, chunk.z, chunk.lightSections);
+                    out.saveChunkAsync(chunk, [&](lattice::io::AsyncIOResult result) {
+                        if (!result.success) {
+                            if (saveFailures++ == 0) {
+                                std::cerr << "Chunk (" << chunk.x << ", " << chunk.z << ") save failed: "
+                                          << result.errorMessage << std::endl;
+                            }
+                        }
+                    });
+                });
+            }
+        }
+        stages[SAVE].peakRssKb = peakRssKb();
+        if (saveFailures) {
+            std::cerr << saveFailures << " chunk saves failed" << std::endl;
+            status = 1;
+        }
+
+        printReport(stages);
+        const long peakRss = peakRssKb();
+        std::cout << "Peak RSS " << peakRss / 1024.0 << " MB" << std::endl;
+
+        const Workload workload{chunks.size(), ticks, entities.entities()};
+        const Baseline current = summarize(workload, stages, peakRss);
+        if (!writeBaselinePath.empty()) {
+            writeBaseline(writeBaselinePath, current);
+            std::cout << "Wrote baseline " << writeBaselinePath << std::endl;
+        }
+        if (!baselinePath.empty() && status == 0) {
+            switch (compareBaseline(current, readBaseline(baselinePath), tolerance)) {
+                case Verdict::PASS: break;
+                case Verdict::REGRESSION: status = 2; break;
+                case Verdict::MISMATCH: status = 1; break;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        status = 1;
+    }
+
+    if (scratchOutput) {
+        fs::remove_all(outPath, ec);
+    }
+    return status;
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_world.hpp"
+
+using namespace lattice::bench;
+using lattice::world::CompactLightStorage;
+
+// ===== 光照引擎基准与一致性检查工具 =====
+// 用法: lattice_light_bench <世界目录> [--dim ID] [--chunks N] [--updates N] [--states 文件]
+// 通过AnvilChunkIO读取region中已完成光照（isLightOn）的区块，用AdvancedLightEngine计算整区块光照
+// 并与区块中保存的原版SkyLight/BlockLight逐格对比，再在已加载区块上做随机增量更新。
+// 方块状态的光照属性默认按方块名估算；--states可指定Java导出的表
+// （每行: 方块状态字符串 透光值 发光等级 [面遮挡位]，例如 minecraft:oak_slab[type=top] 0 0 2）。
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " <world-path> [--dim ID] [--chunks N] [--updates N] [--states FILE]" << std::endl;
+}
+
+// ===== 光照计算与对比 =====
+
+struct Comparison {
+    uint64_t cells = 0;
+    uint64_t mismatches = 0;
+    uint64_t absError = 0;
+    int maxError = 0;
+    uint64_t chunksWithMismatch = 0;
+};
+
+uint8_t nibbleAt(const std::vector<uint8_t>& nibbles, size_t index) {
+    const uint8_t byte = nibbles[index >> 1];
+    return (index & 1) ? (byte >> 4) : (byte & 0x0F);
+}
+
+// 原版没有保存的天空光段视为15（段在所有遮挡之上）或未知，只比较保存了数组的段
+bool compareChunk(AdvancedLightEngine& engine, const LoadedChunk& chunk, Comparison& sky, Comparison& block) {
+    bool skyMismatch = false;
+    bool blockMismatch = false;
+    for (const auto& section : chunk.sections) {
+        for (int pass = 0; pass < 2; ++pass) {
+            const bool isSky = pass == 0;
+            const auto& expected = isSky ? section.skyLight : section.blockLight;
+            if (expected.size() != CompactLightStorage::DATA_SIZE) {
+                continue;
+            }
+            Comparison& result = isSky ? sky : block;
+            for (size_t index = 0; index < 4096; ++index) {
+                const int32_t x = (chunk.chunkX << 4) + static_cast<int32_t>(index & 15);
+                const int32_t y = (section.sectionY << 4) + static_cast<int32_t>(index >> 8);
+                const int32_t z = (chunk.chunkZ << 4) + static_cast<int32_t>(index >> 4 & 15);
+                const int want = nibbleAt(expected, index);
+                const int got = engine.getLightLevel(x, y, z, isSky);
+                ++result.cells;
+                if (want != got) {
+                    const int error = std::abs(want - got);
+                    ++result.mismatches;
+                    result.absError += static_cast<uint64_t>(error);
+                    result.maxError = std::max(result.maxError, error);
+                    (isSky ? skyMismatch : blockMismatch) = true;
+                }
+            }
+        }
+    }
+    sky.chunksWithMismatch += skyMismatch;
+    block.chunksWithMismatch += blockMismatch;
+    return !skyMismatch && !blockMismatch;
+}
+
+// 所有已加载段的当前光照（天空光、方块光交替），用于检查增量更新后的漂移
+std::vector<uint8_t> snapshotLight(AdvancedLightEngine& engine, const std::vector<LoadedChunk>& chunks) {
+    std::vector<uint8_t> levels;
+    for (const auto& chunk : chunks) {
+        for (const auto& section : chunk.sections) {
+            for (size_t index = 0; index < 4096; ++index) {
+                const int32_t x = (chunk.chunkX << 4) + static_cast<int32_t>(index & 15);
+                const int32_t y = (section.sectionY << 4) + static_cast<int32_t>(index >> 8);
+                const int32_t z = (chunk.chunkZ << 4) + static_cast<int32_t>(index >> 4 & 15);
+                levels.push_back(engine.getLightLevel(x, y, z, true));
+                levels.push_back(engine.getLightLevel(x, y, z, false));
+            }
+        }
+    }
+    return levels;
+}
+
+void printComparison(const char* label, const Comparison& result, size_t chunks) {
+    const double rate = result.cells ? 100.0 * static_cast<double>(result.mismatches) / result.cells : 0.0;
+    const double meanError = result.mismatches ? static_cast<double>(result.absError) / result.mismatches : 0.0;
+    std::cout << label << ": " << result.mismatches << " / " << result.cells << " cells differ ("
+              << rate << "%), mean error " << meanError << ", max error " << result.maxError << ", "
+              << result.chunksWithMismatch << " / " << chunks << " chunks affected" << std::endl;
+}
+
+constexpr int MAX_SETTLE_TICKS = 256;
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string worldPath = argv[1];
+    int worldId = 0;
+    size_t maxChunks = 256;
+    size_t updates = 1000;
+    std::string stateFile;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dim" && i + 1 < argc) {
+            worldId = std::atoi(argv[++i]);
+        } else if (arg == "--chunks" && i + 1 < argc) {
+            maxChunks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--updates" && i + 1 < argc) {
+            updates = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--states" && i + 1 < argc) {
+            stateFile = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    try {
+        StateRegistry registry(stateFile.empty() ? std::unordered_map<std::string, BlockLightProperties>{}
+                                                 : loadStateFile(stateFile));
+        const uint16_t air = registry.idFor("minecraft:air", "minecraft:air", "");
+
+        // 1. 通过AnvilChunkIO加载并解析区块（只保留原版已完成光照的区块）
+        auto loadStart = std::chrono::steady_clock::now();
+        AnvilChunkIO io(worldPath);
+        std::vector<LoadedChunk> chunks;
+        size_t skipped = 0;
+        for (const auto& [chunkX, chunkZ] : listChunks(worldPath, worldId, maxChunks)) {
+            LoadedChunk chunk;
+            if (!loadChunk(io, worldId, chunkX, chunkZ, registry, chunk) || !chunk.lightOn) {
+                ++skipped;
+                continue;
+            }
+            chunks.push_back(std::move(chunk));
+        }
+        registry.upload();
+        const auto loadMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - loadStart).count();
+        std::cout << "Loaded " << chunks.size() << " lit chunks (" << skipped << " skipped, "
+                  << registry.size() << " block states) in " << loadMs << " ms" << std::endl;
+        if (chunks.empty()) {
+            std::cerr << "No fully lit chunks found under " << worldPath << std::endl;
+            return 1;
+        }
+
+        // 2. 整区块光照：天空光按列初始化，发光方块作为方块光源，处理到队列为空
+        AdvancedLightEngine engine;
+        auto fullStart = std::chrono::steady_clock::now();
+        int settleTicks = 0;
+        for (const auto& chunk : chunks) {
+            int32_t minY = 0, height = 0;
+            auto column = columnStates(chunk, air, minY, height);
+            engine.initializeChunkSkylight(chunk.chunkX, chunk.chunkZ, column.data(), minY, height);
+            for (size_t i = 0; i < column.size(); ++i) {
+                if (LightOpacityTable::getEmission(column[i]) > 0) {
+                    engine.onBlockChange((chunk.chunkX << 4) + static_cast<int32_t>(i & 15),
+                                         minY + static_cast<int32_t>(i >> 8),
+                                         (chunk.chunkZ << 4) + static_cast<int32_t>(i >> 4 & 15), column[i]);
+                }
+            }
+        }
+        settleTicks = settle(engine, MAX_SETTLE_TICKS);
+        const double fullSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - fullStart).count();
+        std::cout << "Full-chunk lighting: " << chunks.size() / std::max(fullSeconds, 1e-9) << " chunks/sec ("
+                  << fullSeconds * 1000.0 << " ms, " << settleTicks << " ticks to settle"
+                  << (settleTicks >= MAX_SETTLE_TICKS ? ", queue not drained" : "") << ")" << std::endl;
+
+        Comparison sky, block;
+        for (const auto& chunk : chunks) {
+            compareChunk(engine, chunk, sky, block);
+        }
+        printComparison("Sky light vs vanilla", sky, chunks.size());
+        printComparison("Block light vs vanilla", block, chunks.size());
+
+        const std::vector<uint8_t> baseline = updates > 0 ? snapshotLight(engine, chunks) : std::vector<uint8_t>{};
+
+        // 3. 增量更新：随机放置一个石头再恢复原方块，每次变化后处理到队列为空
+        const uint16_t stone = registry.idFor("minecraft:stone", "minecraft:stone", "");
+        registry.upload();
+        std::mt19937 random(12345);
+        auto incrementalStart = std::chrono::steady_clock::now();
+        uint64_t incrementalTicks = 0;
+        for (size_t i = 0; i < updates; ++i) {
+            const auto& chunk = chunks[random() % chunks.size()];
+            const auto& section = chunk.sections[random() % chunk.sections.size()];
+            const size_t index = random() % 4096;
+            const uint16_t original = section.states.empty() ? air : section.states[index];
+            const int32_t x = (chunk.chunkX << 4) + static_cast<int32_t>(index & 15);
+            const int32_t y = (section.sectionY << 4) + static_cast<int32_t>(index >> 8);
+            const int32_t z = (chunk.chunkZ << 4) + static_cast<int32_t>(index >> 4 & 15);
+            engine.onBlockChange(x, y, z, original, stone);
+            incrementalTicks += static_cast<uint64_t>(settle(engine, MAX_SETTLE_TICKS));
+            engine.onBlockChange(x, y, z, stone, original);
+            incrementalTicks += static_cast<uint64_t>(settle(engine, MAX_SETTLE_TICKS));
+        }
+        const double incrementalSeconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - incrementalStart).count();
+        if (updates > 0) {
+            std::cout << "Incremental updates: " << 2 * updates / std::max(incrementalSeconds, 1e-9)
+                      << " block changes/sec (" << incrementalSeconds * 1000.0 << " ms, "
+                      << incrementalTicks << " ticks)" << std::endl;
+
+            // 每次变化都已恢复，光照应回到整区块计算后的结果
+            const std::vector<uint8_t> current = snapshotLight(engine, chunks);
+            size_t drift = 0;
+            for (size_t i = 0; i < current.size(); ++i) {
+                drift += current[i] != baseline[i];
+            }
+            std::cout << "Drift vs full-chunk result after restoring every change: " << drift << " / "
+                      << current.size() << " values" << std::endl;
+
+            Comparison skyAfter, blockAfter;
+            for (const auto& chunk : chunks) {
+                compareChunk(engine, chunk, skyAfter, blockAfter);
+            }
+            printComparison("Sky light vs vanilla after updates", skyAfter, chunks.size());
+            printComparison("Block light vs vanilla after updates", blockAfter, chunks.size());
+        }
+
+        const auto& stats = engine.getBatchStats();
+        std::cout << "Engine: " << stats.entriesProcessed.load() << " entries, "
+                  << stats.serialBatches.load() << " serial / " << stats.parallelBatches.load()
+                  << " parallel batches, " << engine.getLightMemoryUsage() / 1024 << " KB light arrays"
+                  << std::endl;
+
+        return sky.mismatches == 0 && block.mismatches == 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -16,6 +16,10 @@
 #include <memory>
 #include <algorithm>
 #include <iostream>
+#include "../core/native_runtime.hpp"
+#include "../core/slab_allocator.hpp"
+#include "../core/tick_budget.hpp"
+#include "mmap_manager.hpp"
 
 // ARM NEON 头文件 - 仅在ARM架构上包含
 #if defined(__aarch64__) || defined(__arm64__) || defined(__ARM_NEON__) || defined(__ARM_ARCH_8A__)
@@ -315,208 +319,26 @@ void detectCPUArchitecture(SIMDFeatures& features, CPUArchitecture& arch) {
 
 // ========== 内存池管理系统 ==========
 
+/**
+ * 原先是一个互斥锁保护的首次适配空闲链表；现在转发到进程共享的core::SlabAllocator
+ * （每线程按大小级别的slab，跨线程释放无锁），与追踪器节点、寻路搜索、I/O上下文共用同一个分配器。
+ * 保留原接口：失败时返回nullptr，deallocate须传入分配时的size。
+ */
 class MemoryPool {
-private:
-    struct Block {
-        void* ptr;
-        size_t size;
-        bool isFree;
-        Block* next;
-    };
-    
-    Block* freeBlocks;
-    size_t poolSize;
-    std::mutex poolMutex;
-    
-    static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024; // 1MB
-    static constexpr size_t MIN_BLOCK_SIZE = 64; // 64B
-    
 public:
-    MemoryPool(size_t initialSize = 16 * 1024 * 1024) : poolSize(initialSize) {
-        freeBlocks = (Block*)malloc(poolSize);
-        if (freeBlocks) {
-            freeBlocks->ptr = ((char*)freeBlocks) + sizeof(Block);
-            freeBlocks->size = poolSize - sizeof(Block);
-            freeBlocks->isFree = true;
-            freeBlocks->next = nullptr;
-        }
-    }
-    
-    ~MemoryPool() {
-        if (freeBlocks) {
-            Block* current = freeBlocks;
-            while (current) {
-                Block* next = current->next;
-                if (current->isFree) {
-                    free(current->ptr);
-                }
-                current = next;
-            }
-            free(freeBlocks);
-        }
-    }
-    
-    void* allocate(size_t size) {
-        if (size > MAX_BLOCK_SIZE) {
-            return malloc(size); // 大块直接malloc
-        }
-        
-        std::lock_guard<std::mutex> lock(poolMutex);
-        
-        // 查找合适的空闲块
-        Block** current = &freeBlocks;
-        while (*current) {
-            if ((*current)->isFree && (*current)->size >= size) {
-                void* result = (*current)->ptr;
-                
-                // 如果剩余空间足够，拆分块
-                if ((*current)->size - size > MIN_BLOCK_SIZE) {
-                    Block* newBlock = (Block*)(((char*)(*current)->ptr) + size);
-                    newBlock->ptr = ((char*)newBlock) + sizeof(Block);
-                    newBlock->size = (*current)->size - size - sizeof(Block);
-                    newBlock->isFree = true;
-                    newBlock->next = (*current)->next;
-                    
-                    (*current)->ptr = result;
-                    (*current)->size = size;
-                    (*current)->next = newBlock;
-                }
-                
-                (*current)->isFree = false;
-                return result;
-            }
-            current = &((*current)->next);
-        }
-        
-        // 没有合适的块，分配新块
-        return malloc(size);
-    }
-    
-    void deallocate(void* ptr, size_t size) {
-        if (ptr && size <= MAX_BLOCK_SIZE) {
-            std::lock_guard<std::mutex> lock(poolMutex);
-            
-            // 查找并释放对应的块
-            Block** current = &freeBlocks;
-            while (*current) {
-                if ((*current)->ptr == ptr) {
-                    (*current)->isFree = true;
-                    // 尝试合并相邻的空闲块
-                    mergeFreeBlocks(*current);
-                    return;
-                }
-                current = &((*current)->next);
-            }
-        }
-        
-        // 大块或未找到，使用标准free
-        if (ptr) {
-            free(ptr);
-        }
-    }
-    
-private:
-    void mergeFreeBlocks(Block* block) {
-        // 与前一个块合并
-        Block* prev = nullptr;
-        Block* current = freeBlocks;
-        while (current && current != block) {
-            prev = current;
-            current = current->next;
-        }
-        
-        if (prev && prev->isFree) {
-            prev->size += block->size + sizeof(Block);
-            prev->next = block->next;
-            block = prev;
-        }
-        
-        // 与后一个块合并
-        if (block->next && block->next->isFree) {
-            block->size += block->next->size + sizeof(Block);
-            block->next = block->next->next;
-        }
-    }
-};
+    // initialSize只为兼容旧接口保留：slab按需申请，不再预先分配
+    explicit MemoryPool(size_t initialSize = 16 * 1024 * 1024) { (void)initialSize; }
 
-// ========== mmap零拷贝共享内存管理 ==========
-
-class MMAPManager {
-private:
-    struct SharedBuffer {
-        void* addr;
-        size_t size;
-        int fd;
-        bool isOwner;
-    };
-    
-    std::mutex mmapMutex;
-    std::vector<SharedBuffer> activeBuffers;
-    
-public:
-    ~MMAPManager() {
-        std::lock_guard<std::mutex> lock(mmapMutex);
-        for (auto& buf : activeBuffers) {
-            if (buf.addr && buf.isOwner) {
-                munmap(buf.addr, buf.size);
-            }
-            if (buf.fd >= 0) {
-                close(buf.fd);
-            }
-        }
-    }
-    
-    void* createSharedBuffer(size_t size) {
-        std::lock_guard<std::mutex> lock(mmapMutex);
-        
-        // 创建临时文件用于共享内存
-        char tempFile[] = "/tmp/lattice_optimized_XXXXXX";
-        int fd = mkstemp(tempFile);
-        if (fd < 0) return nullptr;
-        
-        unlink(tempFile); // 删除文件名，但保留文件描述符
-        
-        // 设置文件大小
-        if (ftruncate(fd, size) < 0) {
-            close(fd);
-            return nullptr;
-        }
-        
-        // 创建共享内存映射
-        void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, 
-                         MAP_SHARED | MAP_ANONYMOUS, fd, 0);
-        
-        if (addr == MAP_FAILED) {
-            close(fd);
+    void* allocate(size_t size) {
+        try {
+            return core::SlabAllocator::instance().allocate(size);
+        } catch (const std::bad_alloc&) {
             return nullptr;
         }
-        
-        // 记录活跃缓冲区
-        SharedBuffer buf;
-        buf.addr = addr;
-        buf.size = size;
-        buf.fd = fd;
-        buf.isOwner = true;
-        activeBuffers.push_back(buf);
-        
-        return addr;
     }
-    
-    void releaseSharedBuffer(void* addr) {
-        std::lock_guard<std::mutex> lock(mmapMutex);
-        
-        for (auto it = activeBuffers.begin(); it != activeBuffers.end(); ++it) {
-            if (it->addr == addr) {
-                if (it->isOwner) {
-                    munmap(it->addr, it->size);
-                }
-                if (it->fd >= 0) {
-                    close(it->fd);
-                }
-                activeBuffers.erase(it);
-                break;
-            }
-        }
+
+    void deallocate(void* ptr, size_t size) {
+        core::SlabAllocator::instance().deallocate(ptr, size);
     }
 };
 
@@ -553,9 +375,10 @@ public:
             return Strategy::FAST_PATH;
         }
         
-        // 大数据块：考虑内存映射或多线程
+        // 大数据块：考虑内存映射或多线程；主线程tick超时期间不占用共享线程池，留在调用线程上批处理
         if (task.maxBlockSize >= 1024 * 1024) { // 1MB
-            return Strategy::MULTI_THREAD;
+            return core::TickBudget::instance().paused(core::DeferrableWork::BULK_COPY)
+                       ? Strategy::BATCHED : Strategy::MULTI_THREAD;
         }
         
         // 中等数据：批处理
@@ -621,27 +444,13 @@ private:
     }
     
     static void executeMultiThread(const TaskInfo& task) {
-        // 多线程处理：对于非常大的数据块
-        std::vector<std::thread> threads;
-        int numThreads = std::min(task.count, static_cast<int>(std::thread::hardware_concurrency()));
-        int blockSize = (task.count + numThreads - 1) / numThreads;
-        
-        for (int t = 0; t < numThreads; t++) {
-            int start = t * blockSize;
-            int end = std::min(start + blockSize, task.count);
-            
-            if (start < end) {
-                threads.emplace_back([&task, start, end]() {
-                    for (int i = start; i < end; i++) {
-                        fast_memcpy(task.dsts[i], task.srcs[i], task.sizes[i]);
-                    }
-                });
-            }
-        }
-        
-        for (auto& thread : threads) {
-            thread.join();
-        }
+        // 多线程处理：对于非常大的数据块，在共享线程池上每块一个分块，不再每次调用临时起线程
+        core::NativeRuntime::instance().pool().parallel_for(
+            0, static_cast<size_t>(task.count), [&task](size_t start, size_t end) {
+                for (size_t i = start; i < end; i++) {
+                    fast_memcpy(task.dsts[i], task.srcs[i], task.sizes[i]);
+                }
+            }, 1);
     }
 };
 
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <mutex>
+#include <vector>
+
+namespace lattice {
+namespace optimization {
+
+// ========== mmap零拷贝共享内存管理 ==========
+
+class MMAPManager {
+private:
+    struct SharedBuffer {
+        void* addr;
+        size_t size;
+        int fd;
+        bool isOwner;
+    };
+    
+    std::mutex mmapMutex;
+    std::vector<SharedBuffer> activeBuffers;
+    
+public:
+    ~MMAPManager() {
+        std::lock_guard<std::mutex> lock(mmapMutex);
+        for (auto& buf : activeBuffers) {
+            if (buf.addr && buf.isOwner) {
+                munmap(buf.addr, buf.size);
+            }
+            if (buf.fd >= 0) {
+                close(buf.fd);
+            }
+        }
+    }
+    
+    void* createSharedBuffer(size_t size) {
+        std::lock_guard<std::mutex> lock(mmapMutex);
+        
+        // 创建临时文件用于共享内存
+        char tempFile[] = "/tmp/lattice_optimized_XXXXXX";
+        int fd = mkstemp(tempFile);
+        if (fd < 0) return nullptr;
+        
+        unlink(tempFile); // 删除文件名，但保留文件描述符
+        
+        // 设置文件大小
+        if (ftruncate(fd, size) < 0) {
+            close(fd);
+            return nullptr;
+        }
+        
+        // 创建共享内存映射
+        void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, 
+                         MAP_SHARED | MAP_ANONYMOUS, fd, 0);
+        
+        if (addr == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+        
+        // 记录活跃缓冲区
+        SharedBuffer buf;
+        buf.addr = addr;
+        buf.size = size;
+        buf.fd = fd;
+        buf.isOwner = true;
+        activeBuffers.push_back(buf);
+        
+        return addr;
+    }
+    
+    void releaseSharedBuffer(void* addr) {
+        std::lock_guard<std::mutex> lock(mmapMutex);
+        
+        for (auto it = activeBuffers.begin(); it != activeBuffers.end(); ++it) {
+            if (it->addr == addr) {
+                if (it->isOwner) {
+                    munmap(it->addr, it->size);
+                }
+                if (it->fd >= 0) {
+                    close(it->fd);
+                }
+                activeBuffers.erase(it);
+                break;
+            }
+        }
+    }
+};
+
+} // namespace optimization
+} // namespace lattice
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "../core/native_runtime.hpp"
+#include "mmap_manager.hpp"
+#include "shared_ring.hpp"
+
+namespace lattice {
+namespace optimization {
+
+// ========== Java ⇄ native 共享内存通道 ==========
+
+/**
+ * @brief 一块共享缓冲区上的一对消息环：命令环（Java写、native分发线程读）与结果环（native写、Java读）
+ *
+ * 缓冲区布局（CHANNEL_HEADER_SIZE字节的通道头，之后两个SharedRing）：
+ *   0  uint32 magic, uint32 version, uint32 commandOffset, uint32 resultOffset, uint64 totalSize
+ *
+ * 命令按RingSubsystem交给setHandler登记的处理函数（实体追踪、光照、红石、区块I/O、寻路共用这一条通道），
+ * 处理函数在分发线程上运行，结果经publish写回结果环，由Java在tick中批量取走。
+ * 处理函数表是本库内的静态对象：登记处理函数的代码须与shared_ring_jni.cpp链接进同一个库（lattice_native）。
+ * 分发线程空闲一段时间后休眠，Java只在看到consumerWaiting时调用一次nativeWake，
+ * 繁忙时每条消息都没有JNI调用。
+ */
+class RingChannel {
+public:
+    static constexpr uint32_t MAGIC = 0x4C524348;   // "LRCH"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t CHANNEL_HEADER_SIZE = 64;
+
+    struct Config {
+        uint32_t commandSlots = 4096;
+        uint32_t commandSlotSize = 64;
+        uint32_t resultSlots = 4096;
+        uint32_t resultSlotSize = 64;
+    };
+
+    struct Stats {
+        uint64_t commandsDispatched{0};
+        uint64_t commandsUnrouted{0};     // 子系统没有登记处理函数
+        uint64_t resultsPublished{0};
+        uint64_t resultsDropped{0};       // 结果环已满
+        uint64_t wakeups{0};              // Java端唤醒分发线程的次数
+    };
+
+    // 处理函数在分发线程上调用；message的负载只在调用期间有效
+    using Handler = std::function<void(const RingMessage& message, RingChannel& channel)>;
+
+    /**
+     * 登记某个子系统的命令处理函数（传入空函数即取消），对所有通道生效，可在任意时刻调用
+     * 不能在处理函数内部调用
+     */
+    static void setHandler(RingSubsystem subsystem, Handler handler) {
+        HandlerTable& table = handlerTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.handlers[static_cast<size_t>(subsystem)] = std::move(handler);
+        table.generation.fetch_add(1, std::memory_order_release);
+    }
+
+    static bool hasHandler(RingSubsystem subsystem) {
+        HandlerTable& table = handlerTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        return static_cast<size_t>(subsystem) < RING_SUBSYSTEM_COUNT &&
+               static_cast<bool>(table.handlers[static_cast<size_t>(subsystem)]);
+    }
+
+    // 参数不合法或共享内存创建失败时返回nullptr
+    static std::unique_ptr<RingChannel> open(MMAPManager& mmap, const Config& config) {
+        if (!SharedRing::validGeometry(config.commandSlots, config.commandSlotSize) ||
+            !SharedRing::validGeometry(config.resultSlots, config.resultSlotSize)) {
+            fprintf(stderr, "RingChannel: invalid ring geometry\n");
+            return nullptr;
+        }
+        const size_t commandOffset = CHANNEL_HEADER_SIZE;
+        const size_t resultOffset =
+            alignUp(commandOffset + SharedRing::bytesFor(config.commandSlots, config.commandSlotSize));
+        const size_t totalSize = resultOffset + SharedRing::bytesFor(config.resultSlots, config.resultSlotSize);
+        if (resultOffset > UINT32_MAX) {
+            fprintf(stderr, "RingChannel: rings too large\n");
+            return nullptr;
+        }
+
+        void* memory = mmap.createSharedBuffer(totalSize);
+        if (!memory) {
+            fprintf(stderr, "RingChannel: failed to map %zu bytes\n", totalSize);
+            return nullptr;
+        }
+        return std::unique_ptr<RingChannel>(
+            new RingChannel(mmap, memory, totalSize, commandOffset, resultOffset, config));
+    }
+
+    ~RingChannel() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            running_ = false;
+        }
+        wakeCv_.notify_one();
+        if (dispatcher_.joinable()) {
+            dispatcher_.join();
+        }
+        mmap_.releaseSharedBuffer(memory_);
+    }
+
+    RingChannel(const RingChannel&) = delete;
+    RingChannel& operator=(const RingChannel&) = delete;
+
+    void* buffer() const { return memory_; }
+    size_t size() const { return size_; }
+
+    // 从任意native线程写回结果；结果环已满时丢弃并返回false
+    bool publish(uint32_t type, const void* payload, uint32_t length) {
+        if (results_.tryPush(type, payload, length)) {
+            resultsPublished_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        resultsDropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    uint32_t maxResultPayload() const { return results_.maxPayload(); }
+
+    // Java端写入命令后看到consumerWaiting时调用
+    void wake() {
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex_);
+            wakePending_ = true;
+        }
+        wakeups_.fetch_add(1, std::memory_order_relaxed);
+        wakeCv_.notify_one();
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.commandsDispatched = commandsDispatched_.load(std::memory_order_relaxed);
+        stats.commandsUnrouted = commandsUnrouted_.load(std::memory_order_relaxed);
+        stats.resultsPublished = resultsPublished_.load(std::memory_order_relaxed);
+        stats.resultsDropped = resultsDropped_.load(std::memory_order_relaxed);
+        stats.wakeups = wakeups_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    // 分发线程每批最多处理的命令数；空转这么多轮仍无命令后休眠
+    static constexpr size_t DISPATCH_BATCH = 256;
+    static constexpr int IDLE_SPINS = 64;
+    // 休眠的上限：即使唤醒丢失，命令的延迟也不超过这个时间
+    static constexpr auto MAX_SLEEP = std::chrono::milliseconds(10);
+
+    struct HandlerTable {
+        std::mutex mutex;
+        std::array<Handler, RING_SUBSYSTEM_COUNT> handlers;
+        std::atomic<uint64_t> generation{0};
+    };
+
+    static HandlerTable& handlerTable() {
+        static HandlerTable table;
+        return table;
+    }
+
+    static size_t alignUp(size_t value) {
+        return (value + 63) & ~size_t{63};
+    }
+
+    RingChannel(MMAPManager& mmap, void* memory, size_t size, size_t commandOffset, size_t resultOffset,
+                const Config& config)
+        : mmap_(mmap), memory_(memory), size_(size) {
+        auto* base = static_cast<uint8_t*>(memory);
+        commands_ = SharedRing::initialize(base + commandOffset, config.commandSlots, config.commandSlotSize,
+                                           RingMode::MULTI_PRODUCER);
+        results_ = SharedRing::initialize(base + resultOffset, config.resultSlots, config.resultSlotSize,
+                                          RingMode::MULTI_PRODUCER);
+
+        const uint32_t fields[3] = {VERSION, static_cast<uint32_t>(commandOffset),
+                                    static_cast<uint32_t>(resultOffset)};
+        const uint64_t totalSize = size;
+        std::memcpy(base + 4, fields, sizeof(fields));
+        std::memcpy(base + 16, &totalSize, sizeof(totalSize));
+        // 与SharedRing::initialize相同，magic最后写
+        std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(base)).store(MAGIC, std::memory_order_release);
+
+        dispatcher_ = core::NativeRuntime::instance().startThread(core::NativeSubsystem::RING,
+                                                                  [this] { dispatchLoop(); });
+    }
+
+    void dispatchLoop() {
+        HandlerTable& table = handlerTable();
+        std::array<Handler, RING_SUBSYSTEM_COUNT> handlers;
+        uint64_t generation = ~uint64_t{0};
+        int idle = 0;
+
+        while (running_.load(std::memory_order_relaxed)) {
+            // 处理函数表有变化时才在锁内复制一份
+            const uint64_t current = table.generation.load(std::memory_order_acquire);
+            if (current != generation) {
+                std::lock_guard<std::mutex> lock(table.mutex);
+                handlers = table.handlers;
+                generation = table.generation.load(std::memory_order_relaxed);
+            }
+
+            const size_t count = commands_.drain([&](const RingMessage& message) {
+                const size_t index = static_cast<size_t>(message.subsystem());
+                if (index >= RING_SUBSYSTEM_COUNT || !handlers[index]) {
+                    commandsUnrouted_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                try {
+                    handlers[index](message, *this);
+                } catch (const std::exception& e) {
+                    fprintf(stderr, "RingChannel: handler for subsystem %zu failed: %s\n", index, e.what());
+                }
+            }, DISPATCH_BATCH);
+
+            if (count) {
+                commandsDispatched_.fetch_add(count, std::memory_order_relaxed);
+                idle = 0;
+                continue;
+            }
+            if (++idle < IDLE_SPINS) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            commands_.setConsumerWaiting(true);
+            if (commands_.empty()) {
+                std::unique_lock<std::mutex> lock(wakeMutex_);
+                wakeCv_.wait_for(lock, MAX_SLEEP, [this] { return wakePending_ || !running_; });
+                wakePending_ = false;
+            }
+            commands_.setConsumerWaiting(false);
+            idle = 0;
+        }
+    }
+
+    MMAPManager& mmap_;
+    void* memory_;
+    size_t size_;
+    SharedRing commands_;
+    SharedRing results_;
+
+    std::mutex wakeMutex_;
+    std::condition_variable wakeCv_;
+    bool wakePending_ = false;
+    std::atomic<bool> running_{true};
+    std::thread dispatcher_;
+
+    std::atomic<uint64_t> commandsDispatched_{0};
+    std::atomic<uint64_t> commandsUnrouted_{0};
+    std::atomic<uint64_t> resultsPublished_{0};
+    std::atomic<uint64_t> resultsDropped_{0};
+    std::atomic<uint64_t> wakeups_{0};
+};
+
+} // namespace optimization
+} // namespace lattice
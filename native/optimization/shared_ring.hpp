@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace lattice {
+namespace optimization {
+
+// ========== 共享内存消息环 ==========
+//
+// Java与native共用同一块内存（MMAPManager::createSharedBuffer），双方只用这里定义的偏移访问，
+// 每条消息不需要JNI调用。Java端实现见io.lattice.nativeutil.SharedRingChannel，改动布局时两边同步。
+//
+// 环头部（RING_HEADER_SIZE字节，各组字段独占缓存行）：
+//   0   uint32 magic, uint32 version, uint32 slotCount, uint32 slotSize, uint32 mode
+//   64  uint64 tail             生产者预留的下一个位置
+//   128 uint64 head             消费者的下一个位置（只由消费者写）
+//   192 uint32 consumerWaiting  消费者准备休眠；生产者写入后看到非0需要唤醒它
+// 之后是slotCount个槽，每个slotSize字节：
+//   0   uint64 sequence  等于位置pos表示空闲待写，等于pos+1表示已写入待读
+//   8   uint32 type      高16位为子系统（RingSubsystem），低16位为子系统内的操作码
+//   12  uint32 length    负载字节数
+//   16  负载
+//
+// 槽序号协议（Vyukov有界队列）：多生产者用CAS推进tail，单生产者直接写；
+// 消费者只有一个。所有字段按小端（两端同一进程，即本机字节序）。
+
+enum class RingSubsystem : uint16_t {
+    NONE = 0,
+    TRACKER = 1,     // 实体移动、注册与移除
+    LIGHT = 2,       // 方块变化引起的光照更新
+    REDSTONE = 3,    // 红石方块变化
+    CHUNK_IO = 4,    // 区块读写请求
+    PATHFINDER = 5,  // 寻路方块快照的方块变化
+    COUNT
+};
+
+inline constexpr size_t RING_SUBSYSTEM_COUNT = static_cast<size_t>(RingSubsystem::COUNT);
+
+constexpr uint32_t ringMessageType(RingSubsystem subsystem, uint16_t opcode) {
+    return (static_cast<uint32_t>(subsystem) << 16) | opcode;
+}
+
+constexpr RingSubsystem ringSubsystemOf(uint32_t type) {
+    return static_cast<RingSubsystem>(type >> 16);
+}
+
+constexpr uint16_t ringOpcodeOf(uint32_t type) {
+    return static_cast<uint16_t>(type & 0xFFFF);
+}
+
+enum class RingMode : uint32_t {
+    SINGLE_PRODUCER = 0,
+    MULTI_PRODUCER = 1
+};
+
+struct RingMessage {
+    uint32_t type;
+    uint32_t length;
+    const uint8_t* payload;
+
+    RingSubsystem subsystem() const { return ringSubsystemOf(type); }
+    uint16_t opcode() const { return ringOpcodeOf(type); }
+};
+
+/**
+ * @brief 位于共享内存中的有界消息环（固定大小的槽）
+ *
+ * 只是对内存的视图，不拥有内存；拷贝视图不复制数据。
+ * 生产者可以在任意线程调用tryPush（RingMode::SINGLE_PRODUCER时同一时间只能有一个），
+ * 消费者同一时间只能有一个。
+ */
+class SharedRing {
+public:
+    static constexpr uint32_t MAGIC = 0x4C52494E;   // "LRIN"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t RING_HEADER_SIZE = 256;
+    static constexpr size_t SLOT_HEADER_SIZE = 16;
+
+    static constexpr size_t OFFSET_MAGIC = 0;
+    static constexpr size_t OFFSET_VERSION = 4;
+    static constexpr size_t OFFSET_SLOT_COUNT = 8;
+    static constexpr size_t OFFSET_SLOT_SIZE = 12;
+    static constexpr size_t OFFSET_MODE = 16;
+    static constexpr size_t OFFSET_TAIL = 64;
+    static constexpr size_t OFFSET_HEAD = 128;
+    static constexpr size_t OFFSET_CONSUMER_WAITING = 192;
+
+    SharedRing() = default;
+
+    // slotCount须为2的幂，slotSize为8的倍数且能放下槽头部
+    static bool validGeometry(uint32_t slotCount, uint32_t slotSize) {
+        return slotCount >= 2 && (slotCount & (slotCount - 1)) == 0 &&
+               slotSize > SLOT_HEADER_SIZE && slotSize % 8 == 0 && slotSize <= 64 * 1024;
+    }
+
+    static size_t bytesFor(uint32_t slotCount, uint32_t slotSize) {
+        return RING_HEADER_SIZE + static_cast<size_t>(slotCount) * slotSize;
+    }
+
+    // 在memory处（8字节对齐，至少bytesFor字节）建立一个空环
+    static SharedRing initialize(void* memory, uint32_t slotCount, uint32_t slotSize, RingMode mode) {
+        auto* base = static_cast<uint8_t*>(memory);
+        std::memset(base, 0, RING_HEADER_SIZE);
+        SharedRing ring(base, slotCount, slotSize, mode);
+        for (uint32_t i = 0; i < slotCount; ++i) {
+            ring.sequence(i).store(i, std::memory_order_relaxed);
+        }
+        ring.word32(OFFSET_VERSION).store(VERSION, std::memory_order_relaxed);
+        ring.word32(OFFSET_SLOT_COUNT).store(slotCount, std::memory_order_relaxed);
+        ring.word32(OFFSET_SLOT_SIZE).store(slotSize, std::memory_order_relaxed);
+        ring.word32(OFFSET_MODE).store(static_cast<uint32_t>(mode), std::memory_order_relaxed);
+        // magic最后写：对端看到magic即可以使用
+        ring.word32(OFFSET_MAGIC).store(MAGIC, std::memory_order_release);
+        return ring;
+    }
+
+    bool valid() const { return base_ != nullptr; }
+    uint32_t slotCount() const { return mask_ + 1; }
+    uint32_t maxPayload() const { return slotSize_ - static_cast<uint32_t>(SLOT_HEADER_SIZE); }
+
+    /**
+     * 写入一条消息；环已满或负载超过maxPayload()时返回false
+     */
+    bool tryPush(uint32_t type, const void* payload, uint32_t length) {
+        if (length > maxPayload()) {
+            return false;
+        }
+        auto tail = word64(OFFSET_TAIL);
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            const uint64_t seq = sequence(pos).load(std::memory_order_acquire);
+            const int64_t diff = static_cast<int64_t>(seq - pos);
+            if (diff == 0) {
+                if (mode_ == RingMode::SINGLE_PRODUCER) {
+                    tail.store(pos + 1, std::memory_order_relaxed);
+                    break;
+                }
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+        uint8_t* slot = slotAt(pos);
+        std::memcpy(slot + 8, &type, sizeof(type));
+        std::memcpy(slot + 12, &length, sizeof(length));
+        if (length) {
+            std::memcpy(slot + SLOT_HEADER_SIZE, payload, length);
+        }
+        sequence(pos).store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * 取出至多maxMessages条消息，依次调用handler(const RingMessage&)，返回处理的条数
+     * 负载指针只在handler调用期间有效
+     */
+    template <class Handler>
+    size_t drain(Handler&& handler, size_t maxMessages) {
+        auto head = word64(OFFSET_HEAD);
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (count < maxMessages) {
+            if (sequence(pos).load(std::memory_order_acquire) != pos + 1) {
+                break;
+            }
+            const uint8_t* slot = slotAt(pos);
+            RingMessage message;
+            std::memcpy(&message.type, slot + 8, sizeof(message.type));
+            std::memcpy(&message.length, slot + 12, sizeof(message.length));
+            if (message.length > maxPayload()) {
+                message.length = maxPayload();   // 对端写坏的长度不越过槽
+            }
+            message.payload = slot + SLOT_HEADER_SIZE;
+            handler(static_cast<const RingMessage&>(message));
+            sequence(pos).store(pos + slotCount(), std::memory_order_release);
+            ++pos;
+            ++count;
+        }
+        if (count) {
+            head.store(pos, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // 消费者视角：下一个位置还没有消息
+    bool empty() const {
+        const uint64_t pos = word64(OFFSET_HEAD).load(std::memory_order_relaxed);
+        return sequence(pos).load(std::memory_order_seq_cst) != pos + 1;
+    }
+
+    // 已写入且未取出的消息数（近似值，用于统计）
+    uint64_t pending() const {
+        const uint64_t tail = word64(OFFSET_TAIL).load(std::memory_order_relaxed);
+        const uint64_t head = word64(OFFSET_HEAD).load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    /**
+     * 消费者休眠前置1、醒来后清0。置1后须再检查一次empty()：
+     * 与生产者"写入后全屏障再读consumerWaiting"配对，保证不会错过唤醒
+     */
+    void setConsumerWaiting(bool waiting) {
+        word32(OFFSET_CONSUMER_WAITING).store(waiting ? 1u : 0u, std::memory_order_seq_cst);
+    }
+
+    // 生产者写入后调用：为true时需要唤醒消费者
+    bool consumerWaiting() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return word32(OFFSET_CONSUMER_WAITING).load(std::memory_order_relaxed) != 0;
+    }
+
+private:
+    SharedRing(uint8_t* base, uint32_t slotCount, uint32_t slotSize, RingMode mode)
+        : base_(base), mask_(slotCount - 1), slotSize_(slotSize), mode_(mode) {}
+
+    std::atomic_ref<uint64_t> word64(size_t offset) const {
+        return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(base_ + offset));
+    }
+
+    std::atomic_ref<uint32_t> word32(size_t offset) const {
+        return std::atomic_ref<uint32_t>(*reinterpret_cast<uint32_t*>(base_ + offset));
+    }
+
+    uint8_t* slotAt(uint64_t pos) const {
+        return base_ + RING_HEADER_SIZE + static_cast<size_t>(pos & mask_) * slotSize_;
+    }
+
+    std::atomic_ref<uint64_t> sequence(uint64_t pos) const {
+        return std::atomic_ref<uint64_t>(*reinterpret_cast<uint64_t*>(slotAt(pos)));
+    }
+
+    uint8_t* base_ = nullptr;
+    uint32_t mask_ = 0;
+    uint32_t slotSize_ = 0;
+    RingMode mode_ = RingMode::SINGLE_PRODUCER;
+};
+
+} // namespace optimization
+} // namespace lattice
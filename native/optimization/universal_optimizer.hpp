@@ -1,6 +1,8 @@
 #pragma once
 
 #include "simd_optimization.hpp"
+#include <fstream>
+#include <string>
 #include <thread>
 #include <atomic>
 #include <future>
@@ -407,7 +409,23 @@ private:
     
     // 辅助方法
     void detectMemoryBandwidth() { /* 实现内存带宽检测 */ }
-    void detectHugePages() { hasHugePages_ = false; /* 检测大页面支持 */ }
+    void detectHugePages() {
+        // 透明大页处于always / madvise模式，或hugetlbfs有预留页（与ArenaPageAllocator的检测一致）
+        hasHugePages_ = false;
+        std::ifstream thp("/sys/kernel/mm/transparent_hugepage/enabled");
+        std::string mode;
+        if (thp && std::getline(thp, mode)) {
+            hasHugePages_ = mode.find("[always]") != std::string::npos ||
+                            mode.find("[madvise]") != std::string::npos;
+        }
+        std::ifstream meminfo("/proc/meminfo");
+        std::string line;
+        while (!hasHugePages_ && std::getline(meminfo, line)) {
+            if (line.rfind("HugePages_Total:", 0) == 0) {
+                hasHugePages_ = line.find_first_of("123456789") != std::string::npos;
+            }
+        }
+    }
     void logHardwareInfo();
     void selectOptimalStrategies();
     std::string getArchitectureName() const;
@@ -0,0 +1,501 @@
+#include "core/io/anvil_format.hpp"
+#include "core/io/bulk_region_importer.hpp"
+#include "core/io/chunk_packet_store.hpp"
+#include "core/io/hot_chunk_cache.hpp"
+#include "core/io/linear_region_file.hpp"
+#include "core/io/save_pipeline.hpp"
+#include "core/io/zstd_dictionary.hpp"
+#include "core/native_runtime.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace lattice::io;
+using namespace lattice::io::anvil;
+
+namespace {
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::cerr << "  ❌ " << __FILE__ << ":" << __LINE__ << ": " #condition << std::endl; \
+            std::exit(1);                                                                  \
+        }                                                                                  \
+    } while (0)
+
+// 每个测试使用自己的临时目录，结束时删除
+struct TempDir {
+    std::filesystem::path path;
+
+    explicit TempDir(const char* name)
+        : path(std::filesystem::temp_directory_path() / (std::string("lattice_") + name + "_" +
+                                                         std::to_string(::getpid()))) {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+    ~TempDir() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    std::string file(const char* name) const { return (path / name).string(); }
+};
+
+std::vector<uint8_t> makeFrame(size_t size, uint8_t seed) {
+    std::vector<uint8_t> frame(size);
+    for (size_t i = 0; i < size; ++i) {
+        frame[i] = static_cast<uint8_t>(seed + i * 31);
+    }
+    return frame;
+}
+
+// 读出一个区块的帧，没有有效记录时返回空
+std::vector<uint8_t> readFrame(ChunkPacketStore& store, const std::string& region, int x, int z,
+                               uint32_t timestamp, uint32_t formatTag) {
+    std::vector<uint8_t> out;
+    const size_t n = store.read(region, x, z, timestamp, formatTag, [&](size_t size) {
+        out.resize(size);
+        return out.data();
+    });
+    out.resize(n);
+    return out;
+}
+
+void testChunkPacketStore() {
+    std::cout << "\n=== 测试区块数据包旁路文件 ===" << std::endl;
+    TempDir dir("packet_store");
+    const std::string region = dir.file("r.0.0.mca");
+    const std::string sidecar = ChunkPacketStore::sidecarPath(region);
+    CHECK(sidecar == dir.file("r.0.0.lcp"));
+
+    ChunkPacketStore store;
+    const auto frame = makeFrame(1000, 7);
+
+    // 旁路文件不存在时invalidate不创建它，也不留下打开的句柄
+    store.invalidate(region, 1, 2);
+    CHECK(!std::filesystem::exists(sidecar));
+    CHECK(store.getStats().openFiles == 0);
+    CHECK(readFrame(store, region, 1, 2, 100, 5).empty());
+
+    // 写入后按时间戳与formatTag命中
+    CHECK(store.write(region, 1, 2, 100, 5, store.generation(region, 1, 2), frame.data(), frame.size()));
+    CHECK(std::filesystem::exists(sidecar));
+    CHECK(readFrame(store, region, 1, 2, 100, 5) == frame);
+    CHECK(readFrame(store, region, 1, 2, 101, 5).empty());
+    CHECK(readFrame(store, region, 1, 2, 100, 6).empty());
+    CHECK(readFrame(store, region, 2, 1, 100, 5).empty());
+    std::cout << "  - 写入/读取/过期: ✅" << std::endl;
+
+    // 重新打开后记录仍在
+    {
+        ChunkPacketStore reopened;
+        CHECK(readFrame(reopened, region, 1, 2, 100, 5) == frame);
+    }
+
+    // 保存后记录被清除
+    store.invalidate(region, 1, 2);
+    CHECK(readFrame(store, region, 1, 2, 100, 5).empty());
+    CHECK(store.getStats().invalidations == 1);
+
+    // 压缩期间区块被保存（同一秒内，时间戳不变）：旧帧被丢弃
+    const uint32_t generation = store.generation(region, 3, 3);
+    store.invalidate(region, 3, 3);
+    CHECK(!store.write(region, 3, 3, 100, 5, generation, frame.data(), frame.size()));
+    CHECK(readFrame(store, region, 3, 3, 100, 5).empty());
+    CHECK(store.getStats().discardedWrites == 1);
+    std::cout << "  - 保存后失效与过期帧丢弃: ✅" << std::endl;
+
+    // 反复替换同一区块，死数据超过阈值后整体重写
+    const auto large = makeFrame(1024 * 1024, 11);
+    for (int i = 0; i < 6; ++i) {
+        CHECK(store.write(region, 4, 4, 200, 5, store.generation(region, 4, 4), large.data(), large.size()));
+    }
+    CHECK(store.write(region, 1, 2, 100, 5, store.generation(region, 1, 2), frame.data(), frame.size()));
+    CHECK(store.getStats().compactions >= 1);
+    CHECK(std::filesystem::file_size(sidecar) < 3 * large.size());
+    CHECK(readFrame(store, region, 4, 4, 200, 5) == large);
+    CHECK(readFrame(store, region, 1, 2, 100, 5) == frame);
+    std::cout << "  - 重写: ✅" << std::endl;
+
+    // 损坏的帧按未命中处理
+    store.clear();
+    {
+        FILE* f = std::fopen(sidecar.c_str(), "r+b");
+        CHECK(f != nullptr);
+        std::fseek(f, -1, SEEK_END);
+        const int last = std::fgetc(f);
+        std::fseek(f, -1, SEEK_END);
+        std::fputc(last ^ 0xFF, f);
+        std::fclose(f);
+    }
+    const auto before = store.getStats().corrupt;
+    CHECK(readFrame(store, region, 1, 2, 100, 5).empty() || readFrame(store, region, 4, 4, 200, 5).empty());
+    CHECK(store.getStats().corrupt > before);
+    std::cout << "  - 损坏记录: ✅" << std::endl;
+}
+
+// 以COMPOUND标签开头的NBT负载
+std::vector<uint8_t> makeNbt(size_t size, uint8_t seed) {
+    std::vector<uint8_t> nbt = makeFrame(size, seed);
+    nbt[0] = 0x0A;
+    return nbt;
+}
+
+// 改写文件中offset处的4字节大端整数
+void patchBigEndian32(const std::string& path, long offset, uint32_t value) {
+    FILE* f = std::fopen(path.c_str(), "r+b");
+    CHECK(f != nullptr);
+    std::fseek(f, offset, SEEK_SET);
+    const uint8_t bytes[4] = {static_cast<uint8_t>(value >> 24), static_cast<uint8_t>(value >> 16),
+                              static_cast<uint8_t>(value >> 8), static_cast<uint8_t>(value)};
+    std::fwrite(bytes, 1, sizeof(bytes), f);
+    std::fclose(f);
+}
+
+bool loadThrows(const std::string& path) {
+    try {
+        LinearRegionFile::load(path);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void testLinearRegionFile() {
+    std::cout << "\n=== 测试linear region文件 ===" << std::endl;
+    if (!LinearRegionFile::available()) {
+        std::cout << "  - 未编译zstd支持，跳过" << std::endl;
+        return;
+    }
+    TempDir dir("linear_region");
+    const std::string path = dir.file("r.0.0.linear");
+
+    // 写出后整体载入，内容与时间戳不变
+    const auto first = std::make_shared<const std::vector<uint8_t>>(makeNbt(5000, 3));
+    const auto second = std::make_shared<const std::vector<uint8_t>>(makeNbt(300, 9));
+    {
+        LinearRegionFile region;
+        region.putChunk(0, 0, first, 42);
+        region.putChunk(31, 17, second, 43);
+        CHECK(region.isDirty());
+        CHECK(region.save(path, LinearRegionFile::DEFAULT_COMPRESSION_LEVEL, false) > 0);
+        CHECK(!region.isDirty());
+    }
+    CHECK(LinearRegionFile::load(dir.file("missing.linear")) == nullptr);
+    {
+        auto loaded = LinearRegionFile::load(path);
+        CHECK(loaded && loaded->chunkCount() == 2);
+        uint32_t timestamp = 0;
+        CHECK(*loaded->getChunk(0, 0, &timestamp) == *first && timestamp == 42);
+        CHECK(*loaded->getChunk(31, 17, &timestamp) == *second && timestamp == 43);
+        CHECK(!loaded->hasChunk(1, 0));
+    }
+    std::cout << "  - 写出/载入: ✅" << std::endl;
+
+    // 尾部魔数损坏
+    const std::string corrupt = dir.file("corrupt.linear");
+    std::filesystem::copy_file(path, corrupt);
+    {
+        FILE* f = std::fopen(corrupt.c_str(), "r+b");
+        CHECK(f != nullptr);
+        std::fseek(f, -1, SEEK_END);
+        const int last = std::fgetc(f);
+        std::fseek(f, -1, SEEK_END);
+        std::fputc(last ^ 0xFF, f);
+        std::fclose(f);
+    }
+    CHECK(loadThrows(corrupt));
+
+    // 头部声明的解压后大小超过区块数允许的上限，或与zstd帧不一致：分配缓冲区前拒绝
+    const std::string oversized = dir.file("oversized.linear");
+    std::filesystem::copy_file(path, oversized);
+    patchBigEndian32(oversized, 24, 0xFFFFFFF0u);
+    CHECK(loadThrows(oversized));
+    const std::string mismatched = dir.file("mismatched.linear");
+    std::filesystem::copy_file(path, mismatched);
+    patchBigEndian32(mismatched, 24, static_cast<uint32_t>(REGION_CHUNK_COUNT * LinearRegionFile::TABLE_ENTRY_SIZE + 100));
+    CHECK(loadThrows(mismatched));
+    std::cout << "  - 损坏与超限头部: ✅" << std::endl;
+
+    // 只常驻一个region：访问第二个region时脏的第一个被写出，再次访问从磁盘读回
+    const std::string world = dir.file("world");
+    {
+        LinearChunkIO io(world, 1);
+        io.setSyncOnSave(false);
+        const auto a = makeNbt(2000, 5);
+        const auto b = makeNbt(3000, 6);
+        io.saveChunk(0, 1, 1, a, 100);
+        io.saveChunk(0, 40, 1, b, 101);
+        CHECK(io.getStats().evictions >= 1);
+        CHECK(std::filesystem::exists(LinearRegionFile::pathFor(world, 0, 0, 0)));
+        uint32_t timestamp = 0;
+        auto reloaded = io.loadChunk(0, 1, 1, &timestamp);
+        CHECK(reloaded && *reloaded == a && timestamp == 100);
+        reloaded = io.loadChunk(0, 40, 1, &timestamp);
+        CHECK(reloaded && *reloaded == b && timestamp == 101);
+        CHECK(io.getStats().residentRegions == 1);
+    }
+    std::cout << "  - 淘汰时写出脏region: ✅" << std::endl;
+}
+
+void testBulkImportWriteFailure() {
+    std::cout << "\n=== 测试批量导入写入失败 ===" << std::endl;
+    TempDir dir("bulk_import");
+    BulkRegionImporter::Config config;
+    config.compressWorkers = 2;
+    config.syncFiles = false;
+    auto regionPath = [&](int, int regionX, int regionZ) {
+        return dir.file(("r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".mca").c_str());
+    };
+    // 不压缩：类型字节NONE + NBT
+    auto compress = [](const uint8_t* nbt, size_t size) {
+        std::vector<uint8_t> framed{static_cast<uint8_t>(MinecraftCompressor::CompressionType::NONE)};
+        framed.insert(framed.end(), nbt, nbt + size);
+        return framed;
+    };
+    // 第一个region写出后的回调抛出：只有它计为失败，写入线程继续写第二个region
+    auto onWritten = [](const std::string&, int, int regionX, int) {
+        if (regionX == 0) {
+            throw std::runtime_error("listener failed");
+        }
+    };
+
+    BulkRegionImporter importer(config, regionPath, compress, onWritten);
+    for (int regionX = 0; regionX < 2; ++regionX) {
+        for (int i = 0; i < 4; ++i) {
+            auto chunk = std::make_shared<AnvilChunkData>();
+            chunk->x = regionX * 32 + i;
+            chunk->z = 0;
+            chunk->worldId = 0;
+            chunk->lastModified = 1;
+            chunk->data = makeFrame(200, static_cast<uint8_t>(i));
+            chunk->data[0] = static_cast<uint8_t>(NBTType::COMPOUND);
+            importer.add(std::move(chunk));
+        }
+    }
+    const auto stats = importer.finish();
+    CHECK(stats.failedRegions == 1);
+    CHECK(stats.failedChunks == 4);
+    CHECK(stats.regionsWritten == 1);
+    CHECK(stats.firstError.find("listener failed") != std::string::npos);
+    CHECK(std::filesystem::exists(regionPath(0, 1, 0)));
+    std::cout << "  - 单个region失败不影响其余region: ✅" << std::endl;
+}
+
+void testHotChunkCacheGeneration() {
+    std::cout << "\n=== 测试热缓存读盘填充 ===" << std::endl;
+    HotChunkCache cache(1024 * 1024, 4);
+    const uint64_t key = HotChunkCache::packKey(0, 5, -7);
+    auto stale = std::make_shared<const std::vector<uint8_t>>(makeFrame(100, 1));
+    auto fresh = std::make_shared<const std::vector<uint8_t>>(makeFrame(100, 2));
+
+    // 没有并发保存时填充成功
+    CHECK(cache.putIfCurrent(key, stale, 1, cache.generation(key)));
+    HotChunkCache::Entry entry;
+    CHECK(cache.get(key, entry) && entry.payload == stale);
+
+    // 读盘期间保存放入了新内容：旧内容被丢弃
+    uint32_t generation = cache.generation(key);
+    cache.put(key, fresh, 2);
+    CHECK(!cache.putIfCurrent(key, stale, 1, generation));
+    CHECK(cache.get(key, entry) && entry.payload == fresh && entry.lastModified == 2);
+
+    // 读盘期间区块被移出缓存（已压缩记录的保存、region替换）：同样丢弃
+    generation = cache.generation(key);
+    cache.erase(key);
+    CHECK(!cache.putIfCurrent(key, stale, 1, generation));
+    CHECK(!cache.contains(key));
+    CHECK(cache.getStats().staleFills == 2);
+    std::cout << "  - 并发保存后丢弃旧内容: ✅" << std::endl;
+}
+
+void testSavePipelineReuse() {
+    std::cout << "\n=== 测试保存流水线 ===" << std::endl;
+    SavePipeline::Config config;
+    config.serializeWorkers = 2;
+    config.compressWorkers = 2;
+    config.writerThreads = 3;
+    config.queueCapacity = 4;
+    auto& runtime = lattice::core::NativeRuntime::instance();
+    const int threadsBefore = runtime.liveThreads(lattice::core::NativeSubsystem::CHUNK_IO);
+
+    // 每个region同时最多一个写线程
+    constexpr int REGIONS = 8;
+    std::atomic<int> writing[REGIONS] = {};
+    std::atomic<bool> overlapped{false};
+    std::atomic<size_t> written{0};
+    SavePipeline::Stages stages;
+    stages.compress = [](SavePipeline::Job& job) {
+        if (job.localX == 31) {
+            throw std::runtime_error("compress failed");
+        }
+    };
+    stages.write = [&](SavePipeline::Job& job) {
+        const int region = job.localZ;
+        if (writing[region].fetch_add(1) != 0) {
+            overlapped = true;
+        }
+        std::this_thread::yield();
+        writing[region].fetch_sub(1);
+        written++;
+    };
+    auto makeJobs = [](size_t count) {
+        std::vector<SavePipeline::Job> jobs(count);
+        for (size_t i = 0; i < count; ++i) {
+            jobs[i].index = i;
+            jobs[i].localZ = static_cast<int>(i % REGIONS);
+            jobs[i].localX = static_cast<int>(i % 32);
+            jobs[i].regionPath = "r." + std::to_string(jobs[i].localZ) + ".0.mca";
+        }
+        return jobs;
+    };
+
+    {
+        SavePipeline pipeline(config);
+        // 多个批次，其中两个并发提交；工作线程只在第一次启动
+        for (int round = 0; round < 5; ++round) {
+            auto jobs = makeJobs(200);
+            const auto stats = pipeline.run(jobs, stages);
+            CHECK(stats.jobs == 200);
+            CHECK(stats.failed == 6);   // localX == 31 的任务
+            CHECK(jobs[31].failed && jobs[31].errorMessage == "compress failed");
+            CHECK(runtime.liveThreads(lattice::core::NativeSubsystem::CHUNK_IO) == threadsBefore + 7);
+        }
+        std::vector<SavePipeline::Job> first = makeJobs(300);
+        std::vector<SavePipeline::Job> second = makeJobs(300);
+        std::thread other([&] { pipeline.run(second, stages); });
+        pipeline.run(first, stages);
+        other.join();
+        CHECK(!overlapped.load());
+        CHECK(written.load() == 5 * (200 - 6) + 2 * (300 - 9));
+
+        // 小批次在调用线程内执行
+        auto small = makeJobs(2);
+        CHECK(pipeline.run(small, stages).failed == 0);
+    }
+    CHECK(runtime.liveThreads(lattice::core::NativeSubsystem::CHUNK_IO) == threadsBefore);
+    std::cout << "  - 工作线程复用、region串行写入、阶段失败: ✅" << std::endl;
+}
+
+// 类似区块NBT的样本：标签名与调色板字符串重复，vocabulary不同的两组样本训练出不同的字典
+std::vector<std::vector<uint8_t>> makeDictionarySamples(const std::vector<std::string>& vocabulary, uint32_t seed) {
+    std::vector<std::vector<uint8_t>> samples;
+    uint32_t state = seed;
+    for (int i = 0; i < 400; ++i) {
+        std::string text;
+        while (text.size() < 1024) {
+            state = state * 1103515245u + 12345u;
+            text += vocabulary[(state >> 16) % vocabulary.size()];
+            text += std::to_string((state >> 8) & 0xFF);
+        }
+        samples.emplace_back(text.begin(), text.end());
+    }
+    return samples;
+}
+
+void testZstdDictionaryRetrain() {
+    std::cout << "\n=== 测试zstd字典重新训练 ===" << std::endl;
+    if (!MinecraftCompressor::isSupported(MinecraftCompressor::CompressionType::ZSTD)) {
+        std::cout << "  - 未编译zstd支持，跳过" << std::endl;
+        return;
+    }
+    using Type = MinecraftCompressor::CompressionType;
+    TempDir world("zstd_dict");
+    const auto oldSamples = makeDictionarySamples({"minecraft:stone", "block_states", "palette", "Name"}, 1);
+    const auto newSamples = makeDictionarySamples({"minecraft:deepslate", "biomes", "sky_light", "Status"}, 2);
+    auto oldDictionary = ZstdDictionary::fromBytes(ZstdDictionary::train(oldSamples, 4096),
+                                                   MinecraftCompressor::ZSTD_LEVEL);
+    auto newDictionary = ZstdDictionary::fromBytes(ZstdDictionary::train(newSamples, 4096),
+                                                   MinecraftCompressor::ZSTD_LEVEL);
+    CHECK(oldDictionary && newDictionary && oldDictionary->id() != newDictionary->id());
+
+    CHECK(oldDictionary->saveForWorld(world.path.string()));
+    AnvilChunkIO before(world.path.string());
+    CHECK(before.getZstdDictionary() && before.getZstdDictionary()->id() == oldDictionary->id());
+    const auto oldFrame = MinecraftCompressor::compressData(oldSamples[0], Type::ZSTD,
+                                                            before.getZstdDictionary().get());
+
+    // 重新训练：旧字典按ID存档，存档不会被另一份内容覆盖
+    CHECK(newDictionary->saveForWorld(world.path.string()));
+    CHECK(std::filesystem::exists(ZstdDictionary::pathForId(world.path.string(), oldDictionary->id())));
+    CHECK(std::filesystem::exists(ZstdDictionary::pathForId(world.path.string(), newDictionary->id())));
+    CHECK(!newDictionary->saveToFile(ZstdDictionary::pathForId(world.path.string(), oldDictionary->id())));
+    CHECK(oldDictionary->saveToFile(ZstdDictionary::pathForId(world.path.string(), oldDictionary->id())));
+
+    // 重新打开的世界用新字典压缩，旧字典写入的区块仍可读取
+    AnvilChunkIO after(world.path.string());
+    auto dictionary = after.getZstdDictionary();
+    CHECK(dictionary && dictionary->id() == newDictionary->id() && dictionary->forId(oldDictionary->id()));
+    CHECK(after.decompressChunk(oldFrame) == oldSamples[0]);
+    const auto newFrame = MinecraftCompressor::compressData(newSamples[0], Type::ZSTD, dictionary.get());
+    CHECK(after.decompressChunk(newFrame) == newSamples[0]);
+
+    // 运行中换字典同样保留旧字典；没有对应字典的帧解压失败
+    before.setZstdDictionary(newDictionary);
+    CHECK(before.getZstdDictionary()->id() == newDictionary->id());
+    CHECK(before.decompressChunk(oldFrame) == oldSamples[0]);
+    CHECK(MinecraftCompressor::decompressData(oldFrame, Type::ZSTD, newDictionary.get()).empty());
+    std::cout << "  - 旧字典存档与按帧字典ID解压: ✅" << std::endl;
+}
+
+void testVerifyRecordDictionary() {
+    std::cout << "\n=== 测试区块记录校验与zstd字典 ===" << std::endl;
+    if (!MinecraftCompressor::isSupported(MinecraftCompressor::CompressionType::ZSTD)) {
+        std::cout << "  - 未编译zstd支持，跳过" << std::endl;
+        return;
+    }
+    using Integrity = MinecraftCompressor::RecordIntegrity;
+    const auto oldSamples = makeDictionarySamples({"minecraft:stone", "block_states", "palette", "Name"}, 3);
+    const auto newSamples = makeDictionarySamples({"minecraft:deepslate", "biomes", "sky_light", "Status"}, 4);
+    auto oldDictionary = ZstdDictionary::fromBytes(ZstdDictionary::train(oldSamples, 4096),
+                                                   MinecraftCompressor::ZSTD_LEVEL);
+    auto newDictionary = ZstdDictionary::fromBytes(ZstdDictionary::train(newSamples, 4096),
+                                                   MinecraftCompressor::ZSTD_LEVEL);
+    CHECK(oldDictionary && newDictionary);
+
+    // 校验要求负载是以TAG_End结束的复合标签
+    std::vector<uint8_t> nbt{10};
+    nbt.insert(nbt.end(), oldSamples[0].begin(), oldSamples[0].end());
+    nbt.push_back(0);
+    auto framed = MinecraftCompressor::compressData(nbt, MinecraftCompressor::CompressionType::ZSTD,
+                                                    oldDictionary.get());
+    const uint8_t regionId = MinecraftCompressor::toRegionCompressionId(MinecraftCompressor::CompressionType::ZSTD);
+    auto verify = [&](const std::vector<uint8_t>& record, const ZstdDictionary* dictionary) {
+        return MinecraftCompressor::verifyRecord(regionId, record.data() + 1, record.size() - 1, dictionary);
+    };
+
+    CHECK(verify(framed, oldDictionary.get()) == Integrity::OK);
+    // 字典未加载（或只有新字典）时无法判断，不能报告为损坏
+    CHECK(verify(framed, nullptr) == Integrity::UNSUPPORTED);
+    CHECK(verify(framed, newDictionary.get()) == Integrity::UNSUPPORTED);
+    auto superseded = ZstdDictionary::supersede(newDictionary, oldDictionary);
+    CHECK(verify(framed, superseded.get()) == Integrity::OK);
+
+    framed.resize(framed.size() - 8);
+    CHECK(verify(framed, superseded.get()) == Integrity::CORRUPT);
+    std::cout << "  - 未知字典报告UNSUPPORTED，损坏仍报告CORRUPT: ✅" << std::endl;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Lattice 区块I/O测试" << std::endl;
+    testChunkPacketStore();
+    testHotChunkCacheGeneration();
+    testLinearRegionFile();
+    testBulkImportWriteFailure();
+    testSavePipelineReuse();
+    testZstdDictionaryRetrain();
+    testVerifyRecordDictionary();
+    std::cout << "\n全部通过" << std::endl;
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include "core/net/inbound_decompressor.hpp"
+#include "core/net/native_compressor.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace lattice::net;
+
+namespace {
+
+#define CHECK(condition)                                                                   \
+    do {                                                                                   \
+        if (!(condition)) {                                                                \
+            std::cerr << "  ❌ " << __FILE__ << ":" << __LINE__ << ": " #condition << std::endl; \
+            std::exit(1);                                                                  \
+        }                                                                                  \
+    } while (0)
+
+struct InboundPacket {
+    std::vector<uint8_t> plain;
+    std::vector<uint8_t> compressed;
+    std::vector<uint8_t> output;
+};
+
+InboundPacket makePacket(size_t size, uint32_t seed) {
+    InboundPacket packet;
+    packet.plain.resize(size);
+    uint32_t state = seed * 2654435761u + 1;
+    for (size_t i = 0; i < size; ++i) {
+        // 半随机内容：大包解压要花一些时间，小包才有机会先完成
+        state = state * 1103515245u + 12345u;
+        packet.plain[i] = (i & 7) == 0 ? static_cast<uint8_t>(state >> 24) : static_cast<uint8_t>(i);
+    }
+    NativeCompressor* compressor = NativeCompressor::forThread(6);
+    packet.compressed.resize(size + size / 2 + 1024);
+    const size_t n = compressor->compressZlib(reinterpret_cast<const char*>(packet.plain.data()), size,
+                                              reinterpret_cast<char*>(packet.compressed.data()),
+                                              packet.compressed.size());
+    CHECK(n > 0);
+    packet.compressed.resize(n);
+    packet.output.resize(size);
+    return packet;
+}
+
+// 按交付顺序记录(序号, 状态)
+struct DeliveryLog {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::pair<int, InboundDecompressor::Status>> entries;
+
+    InboundDecompressor::Completion record(int index) {
+        return [this, index](InboundDecompressor::Status status) {
+            std::lock_guard<std::mutex> lock(mutex);
+            entries.emplace_back(index, status);
+            cv.notify_all();
+        };
+    }
+
+    void waitFor(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        CHECK(cv.wait_for(lock, std::chrono::seconds(30), [&] { return entries.size() >= count; }));
+    }
+};
+
+InboundDecompressor::Status submitPacket(InboundDecompressor& decompressor, uint64_t connectionId,
+                                         InboundPacket& packet, DeliveryLog& log, int index,
+                                         InboundDecompressor::Submitted* submitted = nullptr) {
+    return decompressor.submit(connectionId, packet.compressed.data(), packet.compressed.size(),
+                               packet.plain.size(), packet.output.data(), packet.output.size(),
+                               log.record(index), submitted);
+}
+
+void testInboundOrdering() {
+    std::cout << "\n=== 测试入站解压保序 ===" << std::endl;
+    InboundDecompressor::Config config;
+    config.asyncThreshold = 64 * 1024;
+    InboundDecompressor decompressor(config);
+
+    // 连接空闲时小包在调用线程上交付
+    DeliveryLog inlineLog;
+    InboundPacket single = makePacket(1000, 1);
+    InboundDecompressor::Submitted submitted = InboundDecompressor::Submitted::QUEUED;
+    CHECK(submitPacket(decompressor, 1, single, inlineLog, 0, &submitted) == InboundDecompressor::Status::OK);
+    CHECK(submitted == InboundDecompressor::Submitted::DELIVERED);
+    CHECK(inlineLog.entries.size() == 1 && single.output == single.plain);
+
+    // 大包异步解压，随后的小包先解压完成，但必须排在大包之后交付
+    std::vector<InboundPacket> packets;
+    packets.push_back(makePacket(4 * 1024 * 1024, 2));
+    for (int i = 0; i < 8; ++i) {
+        packets.push_back(makePacket(2000 + i * 100, 10 + i));
+    }
+    packets.push_back(makePacket(256 * 1024, 3));
+    packets.push_back(makePacket(500, 4));
+
+    DeliveryLog log;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        CHECK(submitPacket(decompressor, 2, packets[i], log, static_cast<int>(i)) == InboundDecompressor::Status::OK);
+    }
+    log.waitFor(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) {
+        CHECK(log.entries[i].first == static_cast<int>(i));
+        CHECK(log.entries[i].second == InboundDecompressor::Status::OK);
+        CHECK(packets[i].output == packets[i].plain);
+    }
+    std::cout << "  - 乱序完成按提交顺序交付: ✅ (reordered=" << decompressor.getStats().reordered << ")"
+              << std::endl;
+
+    // 损坏的包以CORRUPT按序交付，不影响后面的包
+    DeliveryLog corruptLog;
+    std::vector<InboundPacket> mixed;
+    mixed.push_back(makePacket(128 * 1024, 5));
+    mixed.push_back(makePacket(3000, 6));
+    mixed.push_back(makePacket(4000, 7));
+    mixed[1].compressed[mixed[1].compressed.size() / 2] ^= 0xFF;
+    mixed[1].compressed.resize(mixed[1].compressed.size() / 2);
+    for (size_t i = 0; i < mixed.size(); ++i) {
+        CHECK(submitPacket(decompressor, 3, mixed[i], corruptLog, static_cast<int>(i)) == InboundDecompressor::Status::OK);
+    }
+    corruptLog.waitFor(mixed.size());
+    CHECK(corruptLog.entries[0].first == 0 && corruptLog.entries[0].second == InboundDecompressor::Status::OK);
+    CHECK(corruptLog.entries[1].first == 1 && corruptLog.entries[1].second == InboundDecompressor::Status::CORRUPT);
+    CHECK(corruptLog.entries[2].first == 2 && corruptLog.entries[2].second == InboundDecompressor::Status::OK);
+    std::cout << "  - 损坏的包: ✅" << std::endl;
+
+    // 声明长度超过上限或输出缓冲区：直接拒绝，不回调
+    DeliveryLog rejectLog;
+    InboundPacket oversized = makePacket(1000, 8);
+    CHECK(decompressor.submit(4, oversized.compressed.data(), oversized.compressed.size(), 9 * 1024 * 1024,
+                              oversized.output.data(), 9 * 1024 * 1024, rejectLog.record(0)) ==
+          InboundDecompressor::Status::TOO_LARGE);
+    CHECK(decompressor.submit(4, oversized.compressed.data(), oversized.compressed.size(), 2000,
+                              oversized.output.data(), oversized.output.size(), rejectLog.record(0)) ==
+          InboundDecompressor::Status::TOO_LARGE);
+    CHECK(rejectLog.entries.empty());
+
+    // 连接移除后，尚未交付的包以CANCELLED按序交付：大包的回调阻塞到连接移除之后，
+    // 排在它后面的小包一定在移除之后才交付
+    DeliveryLog cancelLog;
+    std::vector<InboundPacket> pending;
+    pending.push_back(makePacket(1024 * 1024, 9));
+    pending.push_back(makePacket(1500, 10));
+    std::mutex gateMutex;
+    std::condition_variable gateCv;
+    bool removed = false;
+    auto first = cancelLog.record(0);
+    CHECK(decompressor.submit(5, pending[0].compressed.data(), pending[0].compressed.size(),
+                              pending[0].plain.size(), pending[0].output.data(), pending[0].output.size(),
+                              [&](InboundDecompressor::Status status) {
+                                  std::unique_lock<std::mutex> lock(gateMutex);
+                                  gateCv.wait(lock, [&] { return removed; });
+                                  first(status);
+                              }) == InboundDecompressor::Status::OK);
+    CHECK(submitPacket(decompressor, 5, pending[1], cancelLog, 1) == InboundDecompressor::Status::OK);
+    decompressor.removeConnection(5);
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        removed = true;
+    }
+    gateCv.notify_all();
+    cancelLog.waitFor(pending.size());
+    CHECK(cancelLog.entries[0].first == 0 && cancelLog.entries[1].first == 1);
+    CHECK(cancelLog.entries[1].second == InboundDecompressor::Status::CANCELLED);
+    CHECK(decompressor.getStats().cancelled >= 1);
+    std::cout << "  - 拒绝与取消: ✅" << std::endl;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "Lattice 网络压缩测试" << std::endl;
+    testInboundOrdering();
+    std::cout << "\n全部通过" << std::endl;
+    return 0;
+}
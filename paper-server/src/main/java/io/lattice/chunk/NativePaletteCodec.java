@@ -0,0 +1,56 @@
+package io.lattice.chunk;
+
+import io.lattice.config.LatticeConfig;
+import io.lattice.nativeutil.LatticeNativeInitializer;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+/**
+ * Native packing and unpacking of chunk section palette indices
+ * (the "data" long array of block_states / biomes, 1.16+ layout: 64 / bits indices per long,
+ * lowest bits first, never spanning two longs). The native side picks AVX-512 / AVX2 / scalar
+ * kernels for the running CPU.
+ */
+public final class NativePaletteCodec {
+    private static final Logger LOGGER = LoggerFactory.getLogger(NativePaletteCodec.class);
+
+    public static final int MAX_BITS = 15;
+
+    // 通过统一初始化器检查本地库是否可用
+    private static final boolean nativeAvailable;
+
+    static {
+        nativeAvailable = LatticeNativeInitializer.isFeatureNativeOptimizationAvailable(
+            LatticeConfig.isChunkSerializationOptimizationEnabled());
+
+        if (nativeAvailable) {
+            LOGGER.info("调色板编解码原生优化已启用");
+        } else {
+            LOGGER.info("调色板编解码原生优化不可用，将使用标准Java实现");
+        }
+    }
+
+    private NativePaletteCodec() {
+    }
+
+    public static boolean isNativeAvailable() {
+        return nativeAvailable;
+    }
+
+    /**
+     * Unpack {@code count} indices of {@code bits} width (1-15) from {@code data} into {@code out}.
+     *
+     * @return 0 on success, -1 if the arguments are invalid (bits out of range, arrays too short),
+     *         -2 if the arrays could not be accessed
+     */
+    public static native int nativeUnpack(long[] data, int bits, short[] out, int count);
+
+    /**
+     * Pack the first {@code count} indices of {@code values} into {@code data}
+     * ({@code ceil(count / (64 / bits))} longs, unused high bits of the last long are zero).
+     *
+     * @return 0 on success, -1 if the arguments are invalid (including an index wider than {@code bits}),
+     *         -2 if the arrays could not be accessed
+     */
+    public static native int nativePack(short[] values, int count, int bits, long[] data);
+}
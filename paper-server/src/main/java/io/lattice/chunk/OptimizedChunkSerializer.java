@@ -210,6 +210,72 @@ public class OptimizedChunkSerializer {
         }
     }
     
+    /**
+     * Number of longs needed to store {@code count} palette indices of {@code bits} width
+     */
+    public static int paletteLongCount(int count, int bits) {
+        int perLong = 64 / bits;
+        return (count + perLong - 1) / perLong;
+    }
+
+    /**
+     * Decode the palette indices of a chunk section ("data" of block_states / biomes)
+     * using the native SIMD kernels when available
+     *
+     * @param data The packed long array
+     * @param bits Bits per index (1-15)
+     * @param out Receives {@code out.length} indices
+     * @throws IllegalArgumentException If bits is out of range or data is too short
+     */
+    public static void decodePaletteIndices(long[] data, int bits, short[] out) {
+        if (bits < 1 || bits > NativePaletteCodec.MAX_BITS || data.length < paletteLongCount(out.length, bits)) {
+            throw new IllegalArgumentException("Invalid palette data: bits=" + bits + ", longs=" + data.length
+                + ", indices=" + out.length);
+        }
+        if (NativePaletteCodec.isNativeAvailable()
+            && NativePaletteCodec.nativeUnpack(data, bits, out, out.length) == 0) {
+            return;
+        }
+
+        // Fallback to the Java implementation
+        int perLong = 64 / bits;
+        long mask = (1L << bits) - 1;
+        for (int i = 0; i < out.length; i++) {
+            out[i] = (short) ((data[i / perLong] >>> ((i % perLong) * bits)) & mask);
+        }
+    }
+
+    /**
+     * Encode palette indices of a chunk section into a packed long array
+     * using the native SIMD kernels when available
+     *
+     * @param values The indices, each below {@code 1 << bits}
+     * @param bits Bits per index (1-15)
+     * @return The packed long array of {@link #paletteLongCount} longs
+     * @throws IllegalArgumentException If bits is out of range or an index does not fit
+     */
+    public static long[] encodePaletteIndices(short[] values, int bits) {
+        if (bits < 1 || bits > NativePaletteCodec.MAX_BITS) {
+            throw new IllegalArgumentException("Invalid palette bits: " + bits);
+        }
+        long[] data = new long[paletteLongCount(values.length, bits)];
+        if (NativePaletteCodec.isNativeAvailable()
+            && NativePaletteCodec.nativePack(values, values.length, bits, data) == 0) {
+            return data;
+        }
+
+        // Fallback to the Java implementation
+        int perLong = 64 / bits;
+        for (int i = 0; i < values.length; i++) {
+            int value = values[i] & 0xFFFF;
+            if ((value >>> bits) != 0) {
+                throw new IllegalArgumentException("Palette index " + value + " does not fit in " + bits + " bits");
+            }
+            data[i / perLong] |= (long) value << ((i % perLong) * bits);
+        }
+        return data;
+    }
+
     /**
      * Write compressed chunk data directly to a file channel using zero-copy operations
      * 
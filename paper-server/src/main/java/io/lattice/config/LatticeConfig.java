@@ -47,6 +47,11 @@ public final class LatticeConfig {
     private static volatile int maxCompressionLevel = 9;
     private static volatile double compressionSensitivity = 0.5;
 
+    // Native runtime thread budget
+    private static volatile int nativeThreads = -1; // -1 means half of the CPU cores
+    private static volatile boolean nativePinThreads = false;
+    private static volatile int nativeMainThreadCore = -1; // -1 means do not reserve a core
+
     private LatticeConfig() {}
 
     // Auto-load from default config directory on class load (config/lattice.yml)
@@ -112,7 +117,13 @@ public final class LatticeConfig {
                         "  enabled: true # Enable pathfinding system optimization\n" +
                         "  caching-enabled: true # Enable pathfinding cache mechanism\n" +
                         "  cache-size: 1000 # Size of pathfinding cache\n" +
-                        "  native-optimization: true # Enable pathfinding native optimization\n";
+                        "  native-optimization: true # Enable pathfinding native optimization\n" +
+                        "\n" +
+                        "# Native worker threads (shared by compression, pathfinding, AI and redstone)\n" +
+                        "native-runtime:\n" +
+                        "  threads: -1 # Total native worker threads (-1 for half of the CPU cores)\n" +
+                        "  pin-threads: false # Pin each native thread to one CPU core\n" +
+                        "  main-thread-core: -1 # Core used by the main server thread, skipped when pinning (-1 for none)\n";
                 Files.writeString(cfgPath, def, StandardCharsets.UTF_8);
             }
 
@@ -150,6 +161,11 @@ public final class LatticeConfig {
             pathfindingCachingEnabled = cfg.getBoolean("pathfinding-optimization.caching-enabled", pathfindingCachingEnabled);
             pathfindingCacheSize = cfg.getInt("pathfinding-optimization.cache-size", pathfindingCacheSize);
             pathfindingNativeOptimization = cfg.getBoolean("pathfinding-optimization.native-optimization", pathfindingNativeOptimization); // Load new native optimization setting
+
+            // Load native runtime configuration
+            nativeThreads = cfg.getInt("native-runtime.threads", nativeThreads);
+            nativePinThreads = cfg.getBoolean("native-runtime.pin-threads", nativePinThreads);
+            nativeMainThreadCore = cfg.getInt("native-runtime.main-thread-core", nativeMainThreadCore);
         } catch (IOException e) {
             // leave defaults
         }
@@ -269,6 +285,29 @@ public final class LatticeConfig {
         return asyncCompressionThreads;
     }
 
+    /**
+     * Get the total native worker thread budget.
+     * Returns -1 for half of the CPU cores.
+     */
+    public static int getNativeThreads() {
+        return nativeThreads;
+    }
+
+    /**
+     * Check if native threads should be pinned to CPU cores.
+     */
+    public static boolean isNativePinThreadsEnabled() {
+        return nativePinThreads;
+    }
+
+    /**
+     * Get the core reserved for the main server thread when pinning.
+     * Returns -1 if no core is reserved.
+     */
+    public static int getNativeMainThreadCore() {
+        return nativeMainThreadCore;
+    }
+
     public static YamlConfiguration getRaw() {
         return cfg;
     }
@@ -46,6 +46,7 @@ public class LatticeNativeInitializer {
             if (nativeLibraryLoaded) {
                 nativeOptimizationAvailable = true;
                 LOGGER.info("成功加载Lattice本地库: {}", LIB_NAME);
+                configureRuntime();
             } else {
                 LOGGER.warn("无法加载Lattice本地库: {}", LIB_NAME);
             }
@@ -59,6 +60,25 @@ public class LatticeNativeInitializer {
         return nativeLibraryLoaded;
     }
     
+    /**
+     * 把LatticeConfig中的线程预算传给native运行时，须在任何native子系统启动线程之前调用
+     */
+    private static void configureRuntime() {
+        try {
+            int compressionThreads = LatticeConfig.isAsyncCompressionEnabled()
+                ? LatticeConfig.getAsyncCompressionThreads() : -1;
+            if (!nativeConfigureRuntime(LatticeConfig.getNativeThreads(), compressionThreads,
+                    LatticeConfig.isNativePinThreadsEnabled(), LatticeConfig.getNativeMainThreadCore())) {
+                LOGGER.warn("native运行时线程配置失败，使用默认线程预算");
+            }
+        } catch (UnsatisfiedLinkError e) {
+            LOGGER.warn("本地库不支持线程预算配置，使用默认线程预算");
+        }
+    }
+
+    private static native boolean nativeConfigureRuntime(int totalThreads, int compressionThreads,
+                                                         boolean pinThreads, int mainThreadCore);
+
     /**
      * 检查本地库是否已加载
      * @return 本地库是否已加载
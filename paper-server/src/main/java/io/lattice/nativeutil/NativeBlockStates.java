@@ -0,0 +1,147 @@
+package io.lattice.nativeutil;
+
+/**
+ * 共享的native方块状态（native侧见native/core/world/block_state_store.hpp）
+ *
+ * native侧每个区块段存一份调色板解码后的方块状态id（Block.BLOCK_STATE_REGISTRY），光照、寻路与AI
+ * 读取每tick发布的快照，不再各自回调Java。区块加载时上传该区块的所有段，卸载时移除；方块变化在发生时上报，
+ * 每tick结束时调用{@link #publish()}一次。只在lattice_optimization_jni中；库未加载时调用什么也不做。
+ */
+public final class NativeBlockStates {
+    /** 某个时刻的状态；memoryBytes包括仍被旧快照引用的段数组 */
+    public record Stats(long version, long columns, long published, long sectionsLoaded, long blockChanges,
+                        long ignoredChanges, long sectionsCopied, long sectionsCompacted, long chunksUnloaded,
+                        long memoryBytes) {
+    }
+
+    private static volatile boolean loaded = true;
+
+    private NativeBlockStates() {
+    }
+
+    private static native boolean nativeLoadSection(int chunkX, int sectionY, int chunkZ, int[] palette, long[] data);
+    private static native void nativeLoadSectionStates(int chunkX, int sectionY, int chunkZ, short[] states);
+    private static native int nativeSetBlock(int x, int y, int z, int stateId);
+    private static native int nativeSetBlocks(long[] positions, int[] stateIds);
+    private static native void nativeUnloadChunk(int chunkX, int chunkZ);
+    private static native long nativePublish();
+    private static native void nativeSetPathBlockTypes(byte[] types);
+    private static native long[] nativeStats();
+
+    /**
+     * 按区块NBT block_states的格式载入一个段：palette为方块状态id，data为调色板下标（可以为null，调色板只有一项时）
+     * 数据无效时返回false
+     */
+    public static boolean loadSection(int chunkX, int sectionY, int chunkZ, int[] palette, long[] data) {
+        if (!loaded) {
+            return false;
+        }
+        try {
+            return nativeLoadSection(chunkX, sectionY, chunkZ, palette, data);
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+            return false;
+        }
+    }
+
+    /**
+     * 载入已解码的段：4096个方块状态id，下标(y << 8) | (z << 4) | x
+     */
+    public static void loadSection(int chunkX, int sectionY, int chunkZ, short[] states) {
+        if (!loaded) {
+            return;
+        }
+        try {
+            nativeLoadSectionStates(chunkX, sectionY, chunkZ, states);
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+        }
+    }
+
+    /**
+     * 上报方块变化，返回变化前的状态id；区块未载入（或库不可用）时返回-1
+     */
+    public static int setBlock(int x, int y, int z, int stateId) {
+        if (!loaded) {
+            return -1;
+        }
+        try {
+            return nativeSetBlock(x, y, z, stateId);
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+            return -1;
+        }
+    }
+
+    /**
+     * 批量上报方块变化（positions为BlockPos.asLong()），返回应用的变化数
+     */
+    public static int setBlocks(long[] positions, int[] stateIds) {
+        if (!loaded) {
+            return 0;
+        }
+        try {
+            return nativeSetBlocks(positions, stateIds);
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+            return 0;
+        }
+    }
+
+    public static void unloadChunk(int chunkX, int chunkZ) {
+        if (!loaded) {
+            return;
+        }
+        try {
+            nativeUnloadChunk(chunkX, chunkZ);
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+        }
+    }
+
+    /**
+     * 发布本tick的修改（同时同步寻路快照），返回快照版本；库不可用时返回0
+     */
+    public static long publish() {
+        if (!loaded) {
+            return 0;
+        }
+        try {
+            return nativePublish();
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+            return 0;
+        }
+    }
+
+    /**
+     * 上传寻路分类表：下标为方块状态id，值为PathBlockType（0可穿过 1实心 2水 3危险 4栅栏）。
+     * 上传后寻路快照在每次publish时从方块状态同步
+     */
+    public static void setPathBlockTypes(byte[] types) {
+        if (!loaded) {
+            return;
+        }
+        try {
+            nativeSetPathBlockTypes(types);
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+        }
+    }
+
+    /**
+     * 库未加载时返回null
+     */
+    public static Stats stats() {
+        if (!loaded) {
+            return null;
+        }
+        try {
+            long[] v = nativeStats();
+            return new Stats(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9]);
+        } catch (UnsatisfiedLinkError e) {
+            loaded = false;
+            return null;
+        }
+    }
+}
@@ -0,0 +1,205 @@
+package io.lattice.nativeutil;
+
+import java.util.EnumMap;
+import java.util.Map;
+
+/**
+ * 按子系统的native内存预算（native侧见native/core/memory_budget.hpp）
+ *
+ * native侧按子系统（区块缓存、压缩缓冲区、光照、实体追踪、AI、JNI缓冲区、方块状态）记账，
+ * 超出预算的子系统由后台线程释放缓存；总量上限由容器内存上限减去JVM最大堆推算。
+ * 每个本地库各有一份预算，native方法注册在下面对应的嵌套类上；未加载的库调用时抛出UnsatisfiedLinkError，
+ * 第一次失败后不再调用该库。
+ *
+ * 启动时调用{@link #configure()}把JVM最大堆告诉native侧。
+ */
+public final class NativeMemoryBudget {
+    /** 与native的MemorySubsystem顺序一致 */
+    public enum Subsystem {
+        CHUNK_CACHE, COMPRESSION_BUFFERS, LIGHT_STORAGE, TRACKER, AI, JNI_BUFFERS, BLOCK_STATES
+    }
+
+    public record SubsystemStats(long usage, long peak, long budget, long shedPasses, long shedBytes) {
+    }
+
+    /** 某个库的预算状态；上限为0表示不限制 */
+    public record Stats(long globalLimit, long containerLimit, long jvmMaxHeap, long totalUsage,
+                        Map<Subsystem, SubsystemStats> subsystems) {
+    }
+
+    private static final int GLOBAL_STAT_COUNT = 4;
+    private static final int SUBSYSTEM_STAT_COUNT = 5;
+
+    private static volatile boolean coreLoaded = true;
+    private static volatile boolean chunkIOLoaded = true;
+    private static volatile boolean optimizedLoaded = true;
+
+    private NativeMemoryBudget() {
+    }
+
+    /** lattice_native：实体追踪、AI */
+    static final class Core {
+        static native void nativeSetJvmMaxHeap(long bytes);
+        static native void nativeSetGlobalLimit(long bytes);
+        static native void nativeSetBudget(int subsystem, long bytes);
+        static native long nativeEnforce();
+        static native long[] nativeStats();
+    }
+
+    /** lattice_chunk_io：区块缓存 */
+    static final class ChunkIO {
+        static native void nativeSetJvmMaxHeap(long bytes);
+        static native void nativeSetGlobalLimit(long bytes);
+        static native void nativeSetBudget(int subsystem, long bytes);
+        static native long nativeEnforce();
+        static native long[] nativeStats();
+    }
+
+    /** lattice_optimization_jni：压缩缓冲区、光照、方块状态 */
+    static final class Optimized {
+        static native void nativeSetJvmMaxHeap(long bytes);
+        static native void nativeSetGlobalLimit(long bytes);
+        static native void nativeSetBudget(int subsystem, long bytes);
+        static native long nativeEnforce();
+        static native long[] nativeStats();
+    }
+
+    /**
+     * 按当前JVM的最大堆推算native上限
+     */
+    public static void configure() {
+        setJvmMaxHeap(Runtime.getRuntime().maxMemory());
+    }
+
+    public static void setJvmMaxHeap(long bytes) {
+        if (coreLoaded) {
+            try {
+                Core.nativeSetJvmMaxHeap(bytes);
+            } catch (UnsatisfiedLinkError e) {
+                coreLoaded = false;
+            }
+        }
+        if (chunkIOLoaded) {
+            try {
+                ChunkIO.nativeSetJvmMaxHeap(bytes);
+            } catch (UnsatisfiedLinkError e) {
+                chunkIOLoaded = false;
+            }
+        }
+        if (optimizedLoaded) {
+            try {
+                Optimized.nativeSetJvmMaxHeap(bytes);
+            } catch (UnsatisfiedLinkError e) {
+                optimizedLoaded = false;
+            }
+        }
+    }
+
+    /**
+     * 显式设置native全局上限（字节）；<= 0恢复为按容器上限推算
+     */
+    public static void setGlobalLimit(long bytes) {
+        if (coreLoaded) {
+            try {
+                Core.nativeSetGlobalLimit(bytes);
+            } catch (UnsatisfiedLinkError e) {
+                coreLoaded = false;
+            }
+        }
+        if (chunkIOLoaded) {
+            try {
+                ChunkIO.nativeSetGlobalLimit(bytes);
+            } catch (UnsatisfiedLinkError e) {
+                chunkIOLoaded = false;
+            }
+        }
+        if (optimizedLoaded) {
+            try {
+                Optimized.nativeSetGlobalLimit(bytes);
+            } catch (UnsatisfiedLinkError e) {
+                optimizedLoaded = false;
+            }
+        }
+    }
+
+    /**
+     * 单独设置子系统预算（字节）；<= 0恢复为全局上限的默认比例
+     */
+    public static void setBudget(Subsystem subsystem, long bytes) {
+        int index = subsystem.ordinal();
+        if (coreLoaded) {
+            try {
+                Core.nativeSetBudget(index, bytes);
+            } catch (UnsatisfiedLinkError e) {
+                coreLoaded = false;
+            }
+        }
+        if (chunkIOLoaded) {
+            try {
+                ChunkIO.nativeSetBudget(index, bytes);
+            } catch (UnsatisfiedLinkError e) {
+                chunkIOLoaded = false;
+            }
+        }
+        if (optimizedLoaded) {
+            try {
+                Optimized.nativeSetBudget(index, bytes);
+            } catch (UnsatisfiedLinkError e) {
+                optimizedLoaded = false;
+            }
+        }
+    }
+
+    /**
+     * 在所有已加载的库上立即执行一轮回收，返回释放的字节数
+     */
+    public static long enforce() {
+        long released = 0;
+        if (coreLoaded) {
+            try {
+                released += Core.nativeEnforce();
+            } catch (UnsatisfiedLinkError e) {
+                coreLoaded = false;
+            }
+        }
+        if (chunkIOLoaded) {
+            try {
+                released += ChunkIO.nativeEnforce();
+            } catch (UnsatisfiedLinkError e) {
+                chunkIOLoaded = false;
+            }
+        }
+        if (optimizedLoaded) {
+            try {
+                released += Optimized.nativeEnforce();
+            } catch (UnsatisfiedLinkError e) {
+                optimizedLoaded = false;
+            }
+        }
+        return released;
+    }
+
+    /**
+     * lattice_native的状态；库未加载时返回null
+     */
+    public static Stats stats() {
+        try {
+            return decode(Core.nativeStats());
+        } catch (UnsatisfiedLinkError e) {
+            return null;
+        }
+    }
+
+    private static Stats decode(long[] values) {
+        Map<Subsystem, SubsystemStats> subsystems = new EnumMap<>(Subsystem.class);
+        for (Subsystem subsystem : Subsystem.values()) {
+            int base = GLOBAL_STAT_COUNT + subsystem.ordinal() * SUBSYSTEM_STAT_COUNT;
+            if (base + SUBSYSTEM_STAT_COUNT > values.length) {
+                break;
+            }
+            subsystems.put(subsystem, new SubsystemStats(values[base], values[base + 1], values[base + 2],
+                                                         values[base + 3], values[base + 4]));
+        }
+        return new Stats(values[0], values[1], values[2], values[3], subsystems);
+    }
+}
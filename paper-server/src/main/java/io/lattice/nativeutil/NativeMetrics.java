@@ -0,0 +1,192 @@
+package io.lattice.nativeutil;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayList;
+import java.util.LinkedHashMap;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * native指标的导出（native侧见native/core/metrics.hpp）
+ *
+ * 每个本地库各有一个指标注册表，一次nativeSnapshot()取回该库的全部指标；这里解码后加上library标签，
+ * 按指标名合并各库的样本，输出Prometheus文本格式。未加载的库调用时抛出UnsatisfiedLinkError，这里跳过。
+ */
+public final class NativeMetrics {
+    private static final int MAGIC = 'L' | ('M' << 8) | ('S' << 16) | ('1' << 24);
+
+    private static final int TYPE_COUNTER = 0;
+    private static final int TYPE_GAUGE = 1;
+    private static final int TYPE_HISTOGRAM = 2;
+
+    private NativeMetrics() {
+    }
+
+    /** lattice_native：红石、AI等 */
+    static final class Core {
+        static native byte[] nativeSnapshot();
+    }
+
+    /** lattice_chunk_io：区块I/O */
+    static final class ChunkIO {
+        static native byte[] nativeSnapshot();
+    }
+
+    /** lattice_optimization_jni：压缩、光照 */
+    static final class Optimized {
+        static native byte[] nativeSnapshot();
+    }
+
+    /**
+     * 一个指标样本；histogram时bounds/cumulative为各le桶，count为+Inf桶
+     */
+    public record Sample(int type, String name, String help, Map<String, String> labels, double value,
+                         double[] bounds, long[] cumulative, long count, double sum) {
+    }
+
+    /**
+     * 所有已加载库的指标
+     */
+    public static List<Sample> snapshot() {
+        List<Sample> samples = new ArrayList<>();
+        try {
+            decode(Core.nativeSnapshot(), "native", samples);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        try {
+            decode(ChunkIO.nativeSnapshot(), "chunk_io", samples);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        try {
+            decode(Optimized.nativeSnapshot(), "optimization", samples);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        return samples;
+    }
+
+    /**
+     * Prometheus文本格式（text/plain; version=0.0.4）
+     */
+    public static String scrape() {
+        Map<String, List<Sample>> families = new LinkedHashMap<>();
+        for (Sample sample : snapshot()) {
+            families.computeIfAbsent(sample.name(), name -> new ArrayList<>()).add(sample);
+        }
+
+        StringBuilder out = new StringBuilder(4096);
+        for (Map.Entry<String, List<Sample>> family : families.entrySet()) {
+            String name = family.getKey();
+            Sample first = family.getValue().get(0);
+            out.append("# HELP ").append(name).append(' ').append(escapeHelp(first.help())).append('\n');
+            out.append("# TYPE ").append(name).append(' ').append(typeName(first.type())).append('\n');
+            for (Sample sample : family.getValue()) {
+                if (sample.type() == TYPE_HISTOGRAM) {
+                    for (int i = 0; i < sample.bounds().length; i++) {
+                        appendSample(out, name + "_bucket", sample.labels(), formatNumber(sample.bounds()[i]),
+                                     Long.toString(sample.cumulative()[i]));
+                    }
+                    appendSample(out, name + "_bucket", sample.labels(), "+Inf", Long.toString(sample.count()));
+                    appendSample(out, name + "_sum", sample.labels(), null, formatNumber(sample.sum()));
+                    appendSample(out, name + "_count", sample.labels(), null, Long.toString(sample.count()));
+                } else {
+                    appendSample(out, name, sample.labels(), null, formatNumber(sample.value()));
+                }
+            }
+        }
+        return out.toString();
+    }
+
+    // 格式见MetricsRegistry::encodeSnapshot
+    private static void decode(byte[] encoded, String library, List<Sample> samples) {
+        if (encoded == null || encoded.length < 8) {
+            return;
+        }
+        ByteBuffer buffer = ByteBuffer.wrap(encoded).order(ByteOrder.LITTLE_ENDIAN);
+        if (buffer.getInt() != MAGIC) {
+            return;
+        }
+        int count = buffer.getInt();
+        for (int i = 0; i < count; i++) {
+            int type = buffer.get() & 0xFF;
+            String name = readString(buffer);
+            String help = readString(buffer);
+            int labelCount = buffer.getShort() & 0xFFFF;
+            Map<String, String> labels = new LinkedHashMap<>();
+            labels.put("library", library);
+            for (int l = 0; l < labelCount; l++) {
+                String key = readString(buffer);
+                labels.put(key, readString(buffer));
+            }
+            if (type == TYPE_HISTOGRAM) {
+                int bucketCount = buffer.getShort() & 0xFFFF;
+                double[] bounds = new double[bucketCount];
+                long[] cumulative = new long[bucketCount];
+                for (int b = 0; b < bucketCount; b++) {
+                    bounds[b] = buffer.getDouble();
+                    cumulative[b] = buffer.getLong();
+                }
+                long total = buffer.getLong();
+                double sum = buffer.getDouble();
+                samples.add(new Sample(type, name, help, labels, 0.0, bounds, cumulative, total, sum));
+            } else {
+                samples.add(new Sample(type, name, help, labels, buffer.getDouble(), null, null, 0, 0.0));
+            }
+        }
+    }
+
+    private static String readString(ByteBuffer buffer) {
+        int length = buffer.getShort() & 0xFFFF;
+        String text = new String(buffer.array(), buffer.position(), length, StandardCharsets.UTF_8);
+        buffer.position(buffer.position() + length);
+        return text;
+    }
+
+    private static void appendSample(StringBuilder out, String name, Map<String, String> labels, String le,
+                                     String value) {
+        out.append(name).append('{');
+        boolean firstLabel = true;
+        for (Map.Entry<String, String> label : labels.entrySet()) {
+            if (!firstLabel) {
+                out.append(',');
+            }
+            firstLabel = false;
+            out.append(label.getKey()).append("=\"").append(escapeLabel(label.getValue())).append('"');
+        }
+        if (le != null) {
+            out.append(firstLabel ? "" : ",").append("le=\"").append(le).append('"');
+        }
+        out.append("} ").append(value).append('\n');
+    }
+
+    private static String typeName(int type) {
+        return switch (type) {
+            case TYPE_COUNTER -> "counter";
+            case TYPE_GAUGE -> "gauge";
+            case TYPE_HISTOGRAM -> "histogram";
+            default -> "untyped";
+        };
+    }
+
+    private static String formatNumber(double value) {
+        if (Double.isNaN(value)) {
+            return "NaN";
+        }
+        if (Double.isInfinite(value)) {
+            return value > 0 ? "+Inf" : "-Inf";
+        }
+        if (value == Math.rint(value) && Math.abs(value) < 1e15) {
+            return Long.toString((long) value);
+        }
+        return Double.toString(value);
+    }
+
+    private static String escapeLabel(String value) {
+        return value.replace("\\", "\\\\").replace("\"", "\\\"").replace("\n", "\\n");
+    }
+
+    private static String escapeHelp(String help) {
+        return help.replace("\\", "\\\\").replace("\n", "\\n");
+    }
+}
@@ -0,0 +1,143 @@
+package io.lattice.nativeutil;
+
+/**
+ * 向native侧上报主线程tick（native侧见native/core/tick_budget.hpp）
+ *
+ * 光照批处理、压缩、区块预取等可推迟的native后台工作据此降速或暂停，tick有余量时再加速。
+ * 每个本地库各有一份预算，native方法注册在下面对应的嵌套类上；未加载的库调用时抛出UnsatisfiedLinkError，
+ * 第一次失败后不再调用该库。
+ *
+ * 主线程在每个tick开始时调用{@link #tickStarted}，结束时调用{@link #tickEnded}。
+ * tickStarted同时推进该库的帧分配器（native/core/frame_allocator.hpp），上上个tick的临时分配随之退回；
+ * 超过一秒没有上报时native侧的临时分配退回普通堆分配。
+ */
+public final class NativeTickBudget {
+    public enum Pressure {
+        UNREPORTED, HEADROOM, NORMAL, BEHIND, OVERLOADED
+    }
+
+    /** 某个库的tick预算状态 */
+    public record Stats(long ticks, long overruns, double smoothedMspt, double lastMspt, Pressure pressure) {
+    }
+
+    private static volatile boolean coreLoaded = true;
+    private static volatile boolean chunkIOLoaded = true;
+    private static volatile boolean optimizedLoaded = true;
+
+    private NativeTickBudget() {
+    }
+
+    /** lattice_native */
+    static final class Core {
+        static native void nativeTickStarted();
+        static native void nativeTickEnded();
+        static native void nativeSetTargetMspt(double mspt);
+        static native double[] nativeStats();
+    }
+
+    /** lattice_chunk_io：区块预取 */
+    static final class ChunkIO {
+        static native void nativeTickStarted();
+        static native void nativeTickEnded();
+        static native void nativeSetTargetMspt(double mspt);
+        static native double[] nativeStats();
+    }
+
+    /** lattice_optimization_jni：压缩、光照 */
+    static final class Optimized {
+        static native void nativeTickStarted();
+        static native void nativeTickEnded();
+        static native void nativeSetTargetMspt(double mspt);
+        static native double[] nativeStats();
+    }
+
+    /**
+     * 目标每tick毫秒数（默认50）；<= 0恢复默认
+     */
+    public static void setTargetMspt(double mspt) {
+        if (coreLoaded) {
+            try {
+                Core.nativeSetTargetMspt(mspt);
+            } catch (UnsatisfiedLinkError e) {
+                coreLoaded = false;
+            }
+        }
+        if (chunkIOLoaded) {
+            try {
+                ChunkIO.nativeSetTargetMspt(mspt);
+            } catch (UnsatisfiedLinkError e) {
+                chunkIOLoaded = false;
+            }
+        }
+        if (optimizedLoaded) {
+            try {
+                Optimized.nativeSetTargetMspt(mspt);
+            } catch (UnsatisfiedLinkError e) {
+                optimizedLoaded = false;
+            }
+        }
+    }
+
+    public static void tickStarted() {
+        if (coreLoaded) {
+            try {
+                Core.nativeTickStarted();
+            } catch (UnsatisfiedLinkError e) {
+                coreLoaded = false;
+            }
+        }
+        if (chunkIOLoaded) {
+            try {
+                ChunkIO.nativeTickStarted();
+            } catch (UnsatisfiedLinkError e) {
+                chunkIOLoaded = false;
+            }
+        }
+        if (optimizedLoaded) {
+            try {
+                Optimized.nativeTickStarted();
+            } catch (UnsatisfiedLinkError e) {
+                optimizedLoaded = false;
+            }
+        }
+    }
+
+    public static void tickEnded() {
+        if (coreLoaded) {
+            try {
+                Core.nativeTickEnded();
+            } catch (UnsatisfiedLinkError e) {
+                coreLoaded = false;
+            }
+        }
+        if (chunkIOLoaded) {
+            try {
+                ChunkIO.nativeTickEnded();
+            } catch (UnsatisfiedLinkError e) {
+                chunkIOLoaded = false;
+            }
+        }
+        if (optimizedLoaded) {
+            try {
+                Optimized.nativeTickEnded();
+            } catch (UnsatisfiedLinkError e) {
+                optimizedLoaded = false;
+            }
+        }
+    }
+
+    /**
+     * lattice_native的状态；库未加载时返回null
+     */
+    public static Stats stats() {
+        try {
+            double[] values = Core.nativeStats();
+            Pressure[] pressures = Pressure.values();
+            int pressure = (int) values[4];
+            return new Stats((long) values[0], (long) values[1], values[2], values[3],
+                             pressure >= 0 && pressure < pressures.length ? pressures[pressure] : Pressure.UNREPORTED);
+        } catch (UnsatisfiedLinkError e) {
+            return null;
+        }
+    }
+}
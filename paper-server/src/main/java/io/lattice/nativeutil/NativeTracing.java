@@ -0,0 +1,167 @@
+package io.lattice.nativeutil;
+
+import java.nio.file.Path;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+/**
+ * native时间线追踪的开关与导出（native侧见native/core/tracing.hpp）
+ *
+ * 每个本地库各有一份追踪器，native方法注册在下面对应的嵌套类上；未加载的库调用时抛出UnsatisfiedLinkError，
+ * 这里跳过。dump把所有已加载库的事件合并写入一个Chrome trace event JSON文件，用Perfetto UI打开。
+ *
+ * 主线程tick用{@link #beginSpan}/{@link #endSpan}包起来，就能看到native工作与tick的重叠。
+ */
+public final class NativeTracing {
+    private static final Logger LOGGER = LoggerFactory.getLogger(NativeTracing.class);
+
+    private NativeTracing() {
+    }
+
+    /** lattice_native：红石、AI等 */
+    static final class Core {
+        static native void nativeSetEnabled(boolean enabled);
+        static native boolean nativeIsEnabled();
+        static native long nativeDump(String path, boolean append);
+        static native void nativeBeginSpan(String name);
+        static native void nativeEndSpan();
+        static native void nativeCounter(String name, long value);
+        static native long nativeDroppedEvents();
+    }
+
+    /** lattice_chunk_io：区块I/O */
+    static final class ChunkIO {
+        static native void nativeSetEnabled(boolean enabled);
+        static native boolean nativeIsEnabled();
+        static native long nativeDump(String path, boolean append);
+        static native void nativeBeginSpan(String name);
+        static native void nativeEndSpan();
+        static native void nativeCounter(String name, long value);
+        static native long nativeDroppedEvents();
+    }
+
+    /** lattice_optimization_jni：压缩、光照 */
+    static final class Optimized {
+        static native void nativeSetEnabled(boolean enabled);
+        static native boolean nativeIsEnabled();
+        static native long nativeDump(String path, boolean append);
+        static native void nativeBeginSpan(String name);
+        static native void nativeEndSpan();
+        static native void nativeCounter(String name, long value);
+        static native long nativeDroppedEvents();
+    }
+
+    public static void setEnabled(boolean enabled) {
+        try {
+            Core.nativeSetEnabled(enabled);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        try {
+            ChunkIO.nativeSetEnabled(enabled);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        try {
+            Optimized.nativeSetEnabled(enabled);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+    }
+
+    public static boolean isEnabled() {
+        try {
+            return Core.nativeIsEnabled();
+        } catch (UnsatisfiedLinkError e) {
+            return false;
+        }
+    }
+
+    /**
+     * 主线程上的区间开始（例如每个服务端tick），只记录在lattice_native中；合并后与其他库在同一时间线上
+     */
+    public static void beginSpan(String name) {
+        try {
+            Core.nativeBeginSpan(name);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+    }
+
+    public static void endSpan() {
+        try {
+            Core.nativeEndSpan();
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+    }
+
+    public static void counter(String name, long value) {
+        try {
+            Core.nativeCounter(name, value);
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+    }
+
+    /**
+     * 取出各库已记录的事件写入output（覆盖），返回写出的事件总数；全部失败时返回-1
+     */
+    public static long dump(Path output) {
+        String path = output.toAbsolutePath().toString();
+        long total = -1;
+        boolean append = false;
+        long written;
+        if ((written = dumpCore(path, append)) >= 0) {
+            total = Math.max(total, 0) + written;
+            append = true;
+        }
+        if ((written = dumpChunkIO(path, append)) >= 0) {
+            total = Math.max(total, 0) + written;
+            append = true;
+        }
+        if ((written = dumpOptimized(path, append)) >= 0) {
+            total = Math.max(total, 0) + written;
+        }
+        long dropped = droppedEvents();
+        if (dropped > 0) {
+            LOGGER.warn("Native tracing dropped {} events (thread buffers full); dump more often", dropped);
+        }
+        return total;
+    }
+
+    public static long droppedEvents() {
+        long dropped = 0;
+        try {
+            dropped += Core.nativeDroppedEvents();
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        try {
+            dropped += ChunkIO.nativeDroppedEvents();
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        try {
+            dropped += Optimized.nativeDroppedEvents();
+        } catch (UnsatisfiedLinkError ignored) {
+        }
+        return dropped;
+    }
+
+    private static long dumpCore(String path, boolean append) {
+        try {
+            return Core.nativeDump(path, append);
+        } catch (UnsatisfiedLinkError e) {
+            return -1;
+        }
+    }
+
+    private static long dumpChunkIO(String path, boolean append) {
+        try {
+            return ChunkIO.nativeDump(path, append);
+        } catch (UnsatisfiedLinkError e) {
+            return -1;
+        }
+    }
+
+    private static long dumpOptimized(String path, boolean append) {
+        try {
+            return Optimized.nativeDump(path, append);
+        } catch (UnsatisfiedLinkError e) {
+            return -1;
+        }
+    }
+}
@@ -0,0 +1,342 @@
+package io.lattice.nativeutil;
+
+import java.lang.invoke.MethodHandles;
+import java.lang.invoke.VarHandle;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import org.slf4j.Logger;
+import org.slf4j.LoggerFactory;
+
+/**
+ * Java与native共享内存的消息通道（native侧见native/optimization/ring_channel.hpp）
+ *
+ * 命令环：任意Java线程写入，native分发线程按子系统（追踪、光照、红石、区块I/O）分发；
+ * 结果环：native工作线程写入，由一个Java线程（通常是tick线程）批量取出。
+ * 每条消息不需要JNI调用，只有分发线程休眠时才调用一次nativeWake。
+ *
+ * 共享内存布局的偏移与native侧一一对应，修改时两边同步。
+ * 使用DirectByteBuffer的VarHandle视图做原子访问（不依赖Java 21尚在预览中的MemorySegment）。
+ */
+public final class SharedRingChannel implements AutoCloseable {
+    private static final Logger LOGGER = LoggerFactory.getLogger(SharedRingChannel.class);
+
+    public static final int SUBSYSTEM_TRACKER = 1;
+    public static final int SUBSYSTEM_LIGHT = 2;
+    public static final int SUBSYSTEM_REDSTONE = 3;
+    public static final int SUBSYSTEM_CHUNK_IO = 4;
+    public static final int SUBSYSTEM_PATHFINDER = 5;
+
+    // 通道头
+    private static final int CHANNEL_MAGIC = 0x4C524348;
+    private static final int CHANNEL_VERSION = 1;
+    private static final int CHANNEL_OFFSET_COMMANDS = 8;
+    private static final int CHANNEL_OFFSET_RESULTS = 12;
+
+    // 环头部
+    private static final int RING_MAGIC = 0x4C52494E;
+    private static final int RING_HEADER_SIZE = 256;
+    private static final int RING_OFFSET_SLOT_COUNT = 8;
+    private static final int RING_OFFSET_SLOT_SIZE = 12;
+    private static final int RING_OFFSET_MODE = 16;
+    private static final int RING_OFFSET_TAIL = 64;
+    private static final int RING_OFFSET_HEAD = 128;
+    private static final int RING_OFFSET_CONSUMER_WAITING = 192;
+    private static final int SLOT_HEADER_SIZE = 16;
+
+    private static final VarHandle LONGS = MethodHandles.byteBufferViewVarHandle(long[].class, ByteOrder.nativeOrder());
+    private static final VarHandle INTS = MethodHandles.byteBufferViewVarHandle(int[].class, ByteOrder.nativeOrder());
+
+    /**
+     * 在槽内写入负载：从offset开始最多capacity字节，返回写入的字节数
+     */
+    @FunctionalInterface
+    public interface PayloadWriter {
+        int write(ByteBuffer buffer, int offset, int capacity);
+    }
+
+    /**
+     * 处理一条结果：负载位于buffer的[offset, offset + length)，只在调用期间有效
+     */
+    @FunctionalInterface
+    public interface MessageHandler {
+        void handle(int type, ByteBuffer buffer, int offset, int length);
+    }
+
+    private final long handle;
+    private final Ring commands;
+    private final Ring results;
+    private volatile boolean closed;
+
+    private SharedRingChannel(long handle, ByteBuffer buffer) {
+        this.handle = handle;
+        this.commands = new Ring(buffer, (int) INTS.get(buffer, CHANNEL_OFFSET_COMMANDS));
+        this.results = new Ring(buffer, (int) INTS.get(buffer, CHANNEL_OFFSET_RESULTS));
+    }
+
+    /**
+     * 创建通道；slot数须为2的幂，slot大小为8的倍数（含16字节槽头）
+     *
+     * @return 本地库不可用或创建失败时返回null
+     */
+    public static SharedRingChannel open(int commandSlots, int commandSlotSize, int resultSlots, int resultSlotSize) {
+        if (!LatticeNativeInitializer.isNativeOptimizationAvailable()) {
+            return null;
+        }
+        long handle = nativeOpen(commandSlots, commandSlotSize, resultSlots, resultSlotSize);
+        if (handle == 0) {
+            LOGGER.warn("无法创建共享内存通道");
+            return null;
+        }
+        ByteBuffer buffer = nativeBuffer(handle);
+        if (buffer == null || (int) INTS.getAcquire(buffer, 0) != CHANNEL_MAGIC
+                || (int) INTS.get(buffer, 4) != CHANNEL_VERSION) {
+            LOGGER.warn("共享内存通道布局不匹配");
+            nativeClose(handle);
+            return null;
+        }
+        return new SharedRingChannel(handle, buffer.order(ByteOrder.nativeOrder()));
+    }
+
+    /**
+     * 本地库是否登记了该子系统的命令处理函数；没有时发往该子系统的命令会被丢弃（计入unrouted）
+     */
+    public static boolean hasHandler(int subsystem) {
+        try {
+            return nativeHasHandler(subsystem);
+        } catch (UnsatisfiedLinkError e) {
+            return false;
+        }
+    }
+
+    public static int messageType(int subsystem, int opcode) {
+        return (subsystem << 16) | (opcode & 0xFFFF);
+    }
+
+    public static int subsystemOf(int type) {
+        return type >>> 16;
+    }
+
+    public static int opcodeOf(int type) {
+        return type & 0xFFFF;
+    }
+
+    public int maxCommandPayload() {
+        return commands.slotSize - SLOT_HEADER_SIZE;
+    }
+
+    /**
+     * 写入一条命令，可在任意线程调用
+     *
+     * @return 通道已关闭或命令环已满时返回false
+     */
+    public boolean offer(int type, PayloadWriter writer) {
+        if (closed) {
+            return false;
+        }
+        long pos = commands.reserve();
+        if (pos < 0) {
+            return false;
+        }
+        int slot = commands.slotOffset(pos);
+        int length = 0;
+        try {
+            length = writer.write(commands.buffer, slot + SLOT_HEADER_SIZE, maxCommandPayload());
+        } catch (RuntimeException e) {
+            // 已预留的槽必须发布，否则消费者会停在这里；写成空消息
+            commands.commit(pos, 0, 0);
+            throw e;
+        }
+        if (length < 0 || length > maxCommandPayload()) {
+            commands.commit(pos, 0, 0);
+            throw new IllegalStateException("payload length out of range: " + length);
+        }
+        commands.commit(pos, type, length);
+        // 与分发线程"置consumerWaiting后再检查环"配对
+        VarHandle.fullFence();
+        if (commands.consumerWaiting()) {
+            nativeWake(handle);
+        }
+        return true;
+    }
+
+    /**
+     * 写入payload中剩余的字节（不改变payload的position）
+     */
+    public boolean offer(int type, ByteBuffer payload) {
+        int length = payload.remaining();
+        if (length > maxCommandPayload()) {
+            return false;
+        }
+        return offer(type, (buffer, offset, capacity) -> {
+            buffer.put(offset, payload, payload.position(), length);
+            return length;
+        });
+    }
+
+    /**
+     * 等待此前写入的命令全部被分发线程处理完（处理函数已返回）。
+     * 用于之后要走JNI直接调用、必须排在这些命令之后的操作
+     *
+     * @return 超时或通道已关闭时返回false
+     */
+    public boolean awaitCommandsDrained(long timeoutNanos) {
+        if (closed) {
+            return false;
+        }
+        long target = commands.tail();
+        if (commands.head() >= target) {
+            return true;
+        }
+        long deadline = System.nanoTime() + timeoutNanos;
+        boolean woken = false;
+        while (commands.head() < target) {
+            if (closed || System.nanoTime() - deadline > 0) {
+                return false;
+            }
+            if (!woken && commands.consumerWaiting()) {
+                nativeWake(handle);
+                woken = true;
+            }
+            Thread.onSpinWait();
+        }
+        return true;
+    }
+
+    /**
+     * 取出至多maxMessages条结果；同一时间只能有一个线程调用
+     *
+     * @return 处理的结果数
+     */
+    public int poll(MessageHandler handler, int maxMessages) {
+        if (closed) {
+            return 0;
+        }
+        return results.drain(handler, maxMessages);
+    }
+
+    /**
+     * @return dispatched, unrouted, resultsPublished, resultsDropped, wakeups
+     */
+    public long[] stats() {
+        return closed ? new long[5] : nativeStats(handle);
+    }
+
+    /**
+     * 关闭通道；调用前须确保没有线程仍在offer / poll
+     */
+    @Override
+    public synchronized void close() {
+        if (closed) {
+            return;
+        }
+        closed = true;
+        nativeClose(handle);
+    }
+
+    // 位于共享缓冲区中的一个环，算法与native侧SharedRing相同
+    private static final class Ring {
+        final ByteBuffer buffer;
+        final int base;
+        final int mask;
+        final int slotSize;
+        final boolean multiProducer;
+
+        Ring(ByteBuffer buffer, int base) {
+            if ((int) INTS.getAcquire(buffer, base) != RING_MAGIC) {
+                throw new IllegalStateException("shared ring not initialized at " + base);
+            }
+            this.buffer = buffer;
+            this.base = base;
+            this.mask = (int) INTS.get(buffer, base + RING_OFFSET_SLOT_COUNT) - 1;
+            this.slotSize = (int) INTS.get(buffer, base + RING_OFFSET_SLOT_SIZE);
+            this.multiProducer = (int) INTS.get(buffer, base + RING_OFFSET_MODE) != 0;
+        }
+
+        int slotOffset(long pos) {
+            return base + RING_HEADER_SIZE + (int) (pos & mask) * slotSize;
+        }
+
+        // 预留下一个槽，返回其位置；环已满时返回-1
+        long reserve() {
+            int tail = base + RING_OFFSET_TAIL;
+            long pos = (long) LONGS.getOpaque(buffer, tail);
+            for (;;) {
+                long seq = (long) LONGS.getAcquire(buffer, slotOffset(pos));
+                long diff = seq - pos;
+                if (diff == 0) {
+                    if (!multiProducer) {
+                        LONGS.setOpaque(buffer, tail, pos + 1);
+                        return pos;
+                    }
+                    if (LONGS.weakCompareAndSet(buffer, tail, pos, pos + 1)) {
+                        return pos;
+                    }
+                } else if (diff < 0) {
+                    return -1;
+                }
+                pos = (long) LONGS.getOpaque(buffer, tail);
+            }
+        }
+
+        void commit(long pos, int type, int length) {
+            int slot = slotOffset(pos);
+            INTS.set(buffer, slot + 8, type);
+            INTS.set(buffer, slot + 12, length);
+            LONGS.setRelease(buffer, slot, pos + 1);
+        }
+
+        long tail() {
+            return (long) LONGS.getAcquire(buffer, base + RING_OFFSET_TAIL);
+        }
+
+        // 消费者在一批命令的处理函数都返回后才推进head
+        long head() {
+            return (long) LONGS.getAcquire(buffer, base + RING_OFFSET_HEAD);
+        }
+
+        boolean consumerWaiting() {
+            return (int) INTS.getOpaque(buffer, base + RING_OFFSET_CONSUMER_WAITING) != 0;
+        }
+
+        int drain(MessageHandler handler, int maxMessages) {
+            int head = base + RING_OFFSET_HEAD;
+            long pos = (long) LONGS.getOpaque(buffer, head);
+            int count = 0;
+            try {
+                while (count < maxMessages) {
+                    int slot = slotOffset(pos);
+                    if ((long) LONGS.getAcquire(buffer, slot) != pos + 1) {
+                        break;
+                    }
+                    int type = (int) INTS.get(buffer, slot + 8);
+                    int length = Math.min((int) INTS.get(buffer, slot + 12), slotSize - SLOT_HEADER_SIZE);
+                    try {
+                        handler.handle(type, buffer, slot + SLOT_HEADER_SIZE, length);
+                    } finally {
+                        // 处理函数抛出异常时这条结果也算已取出
+                        LONGS.setRelease(buffer, slot, pos + mask + 1);
+                        pos++;
+                        count++;
+                    }
+                }
+            } finally {
+                if (count > 0) {
+                    LONGS.setRelease(buffer, head, pos);
+                }
+            }
+            return count;
+        }
+    }
+
+    private static native long nativeOpen(int commandSlots, int commandSlotSize, int resultSlots, int resultSlotSize);
+
+    private static native ByteBuffer nativeBuffer(long handle);
+
+    private static native void nativeWake(long handle);
+
+    private static native boolean nativeHasHandler(int subsystem);
+
+    private static native long[] nativeStats(long handle);
+
+    private static native void nativeClose(long handle);
+}
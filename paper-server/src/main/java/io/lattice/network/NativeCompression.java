@@ -21,6 +21,8 @@ public class NativeCompression {
             LatticeConfig.isPacketCompressionOptimizationEnabled());
         
         if (nativeAvailable) {
+            // 原生侧的分流阈值与解码器的保持一致，声明长度上限与MAX_DECOMPRESSED_SIZE一致
+            nativeConfigureInboundDecompression(INBOUND_ASYNC_THRESHOLD, MAX_DECOMPRESSED_SIZE);
             LOGGER.info("网络压缩原生优化已启用");
         } else {
             LOGGER.info("网络压缩原生优化不可用，将使用标准Java实现");
@@ -78,4 +80,103 @@ public class NativeCompression {
      * Get maximum compressed size for zlib
      */
     public static native int deflateCompressBound(int srcLen);
+
+    // Per-flush batch API
+    /**
+     * Compress every pending outbound packet of one flush in a single native call.
+     * <p>
+     * {@code packets} holds the encoded, uncompressed packet bodies; {@code table} (native byte order)
+     * holds 5 ints per packet: offset, length, capacity (at least length + 5), level (negative for
+     * {@code level}) and result. Each packet is framed in place as VarInt(dataLength) + zlib, or
+     * VarInt(0) + raw when shorter than {@code threshold}; result receives the framed length, or a
+     * negative error code.
+     *
+     * @return number of packets framed successfully, or a negative value on invalid buffers
+     */
+    public static native int nativeCompressFlush(ByteBuffer packets, ByteBuffer table, int count, int threshold, int level);
+
+    // Shared chunk / light packet cache
+    public static final int CHUNK_PACKET_DATA = 0;
+    public static final int CHUNK_PACKET_LIGHT = 1;
+
+    /**
+     * Compress a chunk or light packet body through the cross-connection cache.
+     * Entries are keyed by chunk, packet kind, {@code version} and level; bump {@code version}
+     * whenever the chunk changes. Writes VarInt(srcLen) + zlib into {@code dstDirect}.
+     *
+     * @return framed length, or a negative error code (-4 when {@code dstCapacity} is too small)
+     */
+    public static native int nativeCompressChunkPacket(int worldId, int chunkX, int chunkZ, int kind, long version,
+                                                       int level, ByteBuffer srcDirect, int srcLen,
+                                                       ByteBuffer dstDirect, int dstCapacity);
+
+    /**
+     * Drop every cached packet of a chunk (on modification or unload)
+     */
+    public static native void nativeInvalidateChunkPackets(int worldId, int chunkX, int chunkZ);
+
+    /**
+     * Set the byte budget of the chunk packet cache
+     */
+    public static native void nativeSetChunkPacketCacheBudget(long budgetBytes);
+
+    // Closed-loop compression level controller
+    /**
+     * Configure the controller: CPU cores compression may use, level bounds and the level for new connections
+     */
+    public static native void nativeConfigureCompressionController(double cpuBudgetCores, int minLevel, int maxLevel, int baseLevel);
+
+    /**
+     * Report a connection's RTT and cumulative bytes sent (about once per second)
+     */
+    public static native void nativeUpdateConnection(long connectionId, double rttMs, long bytesSent);
+
+    /**
+     * Forget a connection: drops its controller state and cancels its queued inbound decompressions
+     * (their callbacks still run, in order, with {@link #INBOUND_CANCELLED})
+     */
+    public static native void nativeRemoveConnection(long connectionId);
+
+    /**
+     * Compression level the controller currently picks for a connection
+     */
+    public static native int nativeConnectionLevel(long connectionId);
+
+    /**
+     * Call once per tick; samples and re-plans when the sample interval has elapsed
+     *
+     * @return highest level allowed by the CPU budget
+     */
+    public static native int nativeCompressionControllerTick();
+
+    // Inbound decompression on the compression pool
+    /** Declared sizes at or above this are decompressed off the Netty event loop */
+    public static final int INBOUND_ASYNC_THRESHOLD = 32 * 1024;
+
+    /** {@link #nativeDecompressInbound} result: the callback already ran on the calling thread */
+    public static final int INBOUND_DONE = 0;
+    /** {@link #nativeDecompressInbound} result: the callback runs later on a compression thread */
+    public static final int INBOUND_QUEUED = 1;
+    // Error codes (negative results and onError arguments)
+    public static final int INBOUND_CORRUPT = -1;
+    public static final int INBOUND_TOO_LARGE = -2;
+    public static final int INBOUND_CANCELLED = -3;
+    public static final int INBOUND_INVALID_ARGUMENT = -4;
+
+    /**
+     * Set the size above which inbound packets are decompressed asynchronously and the largest
+     * declared size accepted; values {@code <= 0} leave the current setting unchanged
+     */
+    public static native void nativeConfigureInboundDecompression(long asyncThreshold, long maxDeclaredSize);
+
+    /**
+     * Decompress one inbound packet into {@code dstDirect}, which must stay valid until the callback runs;
+     * {@code srcDirect} may be released as soon as this returns. The callback receives
+     * {@code onSuccess(declaredSize)} or {@code onError(code)}, in submission order per connection.
+     *
+     * @return {@link #INBOUND_DONE}, {@link #INBOUND_QUEUED}, or a negative error code (no callback)
+     */
+    public static native int nativeDecompressInbound(long connectionId, ByteBuffer srcDirect, long srcLen,
+                                                     ByteBuffer dstDirect, long declaredSize,
+                                                     AsyncCompressionCallback callback);
 }
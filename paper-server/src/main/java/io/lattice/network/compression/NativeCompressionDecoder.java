@@ -1,15 +1,31 @@
 package io.lattice.network.compression;
 
+import io.lattice.network.AsyncCompressionCallback;
 import io.lattice.network.NativeCompression;
 import io.netty.buffer.ByteBuf;
 import io.netty.channel.ChannelHandlerContext;
 import io.netty.handler.codec.ByteToMessageDecoder;
+import io.netty.handler.codec.DecoderException;
 
 import java.nio.ByteBuffer;
+import java.util.ArrayDeque;
 import java.util.List;
+import java.util.concurrent.atomic.AtomicLong;
 
 public class NativeCompressionDecoder extends ByteToMessageDecoder {
+    // Connection ids for the native inbound decompressor, one per decoder instance
+    private static final AtomicLong NEXT_CONNECTION_ID = new AtomicLong(1);
+
     private final int maxSize;
+    private final long connectionId = NEXT_CONNECTION_ID.getAndIncrement();
+
+    // Set while a large packet is being decompressed on the compression pool. Frames that arrive
+    // meanwhile are queued one by one in pendingFrames (never merged into the cumulation buffer) and
+    // replayed after it is delivered, so packets reach the next handler in order.
+    // Only touched on the event loop.
+    private boolean awaitingInbound;
+    private boolean removed;
+    private final ArrayDeque<ByteBuf> pendingFrames = new ArrayDeque<>();
 
     public NativeCompressionDecoder(int maxSize) {
         this.maxSize = Math.min(maxSize, NativeCompression.MAX_DECOMPRESSED_SIZE);
@@ -52,6 +68,13 @@ public class NativeCompressionDecoder extends ByteToMessageDecoder {
             throw new RuntimeException("No compressed data after size field");
         }
 
+        // Large packets: decompress on the compression pool instead of stalling the event loop
+        if (asyncInboundAvailable() && in.isDirect()
+                && uncompressedSize >= NativeCompression.INBOUND_ASYNC_THRESHOLD
+                && decodeAsync(ctx, in, compressedLen, uncompressedSize)) {
+            return;
+        }
+
         // Try direct-buffer zero-copy path first
         if (NativeCompression.isNativeAvailable() && in.isDirect()) {
             ByteBuffer srcNio = in.nioBuffer(in.readerIndex(), compressedLen);
@@ -98,6 +121,127 @@ public class NativeCompressionDecoder extends ByteToMessageDecoder {
         out.add(decompressed);
     }
 
+    /**
+     * Submit the frame to the native inbound decompressor. Returns false (nothing consumed) when the
+     * native side refuses it, so the caller falls back to the synchronous paths.
+     */
+    private boolean decodeAsync(ChannelHandlerContext ctx, ByteBuf in, int compressedLen, int uncompressedSize) {
+        ByteBuffer srcNio = in.nioBuffer(in.readerIndex(), compressedLen);
+        ByteBuf dstBuf = ctx.alloc().directBuffer(uncompressedSize);
+        ByteBuffer dstNio = dstBuf.nioBuffer(0, uncompressedSize);
+        int result;
+        try {
+            result = submitInbound(srcNio, compressedLen, dstNio, uncompressedSize,
+                    new InboundCallback(ctx, dstBuf, uncompressedSize));
+        } catch (Throwable t) {
+            result = NativeCompression.INBOUND_INVALID_ARGUMENT;
+        }
+        if (result < 0) {
+            dstBuf.release();
+            return false;
+        }
+        // The source bytes were copied (or already consumed) before the call returned
+        in.skipBytes(compressedLen);
+        awaitingInbound = true;
+        return true;
+    }
+
+    /** Whether large frames may go to the native inbound decompressor; overridden by tests */
+    boolean asyncInboundAvailable() {
+        return NativeCompression.isNativeAvailable();
+    }
+
+    /** Hands one frame to the native inbound decompressor; overridden by tests */
+    int submitInbound(ByteBuffer srcNio, int compressedLen, ByteBuffer dstNio, int uncompressedSize,
+                      AsyncCompressionCallback callback) {
+        return NativeCompression.nativeDecompressInbound(connectionId, srcNio, compressedLen, dstNio,
+                uncompressedSize, callback);
+    }
+
+    @Override
+    public void channelRead(ChannelHandlerContext ctx, Object msg) throws Exception {
+        // Each frame from the splitter is one packet: keep it as its own buffer while a packet is in flight,
+        // so decode() later sees exactly one frame at a time
+        if (msg instanceof ByteBuf frame && (awaitingInbound || !pendingFrames.isEmpty())) {
+            pendingFrames.add(frame);
+            return;
+        }
+        super.channelRead(ctx, msg);
+    }
+
+    // Runs on the event loop once the native side delivered the packet
+    private void completeInbound(ChannelHandlerContext ctx, ByteBuf dstBuf, int written, int errorCode) {
+        awaitingInbound = false;
+        if (removed) {
+            dstBuf.release();
+            return;
+        }
+        if (errorCode != 0) {
+            dstBuf.release();
+            // The stream is broken from here on: drop what queued behind the lost packet
+            releasePendingFrames();
+            ctx.fireExceptionCaught(new DecoderException("Failed to decompress packet (" + errorCode + ")"));
+            return;
+        }
+        dstBuf.writerIndex(written);
+        ctx.fireChannelRead(dstBuf);
+        // Replay the frames that arrived while this packet was in flight, stopping again if one of them
+        // goes async itself
+        ByteBuf frame;
+        while (!awaitingInbound && !removed && (frame = pendingFrames.poll()) != null) {
+            try {
+                super.channelRead(ctx, frame);
+            } catch (Exception e) {
+                ctx.fireExceptionCaught(e);
+            }
+        }
+    }
+
+    @Override
+    protected void handlerRemoved0(ChannelHandlerContext ctx) throws Exception {
+        removed = true;
+        releasePendingFrames();
+        if (NativeCompression.isNativeAvailable()) {
+            // Queued packets still complete (as cancelled) and release their buffers
+            NativeCompression.nativeRemoveConnection(connectionId);
+        }
+    }
+
+    private void releasePendingFrames() {
+        ByteBuf frame;
+        while ((frame = pendingFrames.poll()) != null) {
+            frame.release();
+        }
+    }
+
+    private final class InboundCallback implements AsyncCompressionCallback {
+        private final ChannelHandlerContext ctx;
+        private final ByteBuf dstBuf;
+        private final int expectedSize;
+
+        InboundCallback(ChannelHandlerContext ctx, ByteBuf dstBuf, int expectedSize) {
+            this.ctx = ctx;
+            this.dstBuf = dstBuf;
+            this.expectedSize = expectedSize;
+        }
+
+        @Override
+        public void onSuccess(long size) {
+            // Always go through the executor, even when called inline: frames decoded after this one in
+            // the current read must not overtake it
+            if (size == expectedSize) {
+                ctx.executor().execute(() -> completeInbound(ctx, dstBuf, expectedSize, 0));
+            } else {
+                ctx.executor().execute(() -> completeInbound(ctx, dstBuf, 0, NativeCompression.INBOUND_CORRUPT));
+            }
+        }
+
+        @Override
+        public void onError(int errorCode) {
+            ctx.executor().execute(() -> completeInbound(ctx, dstBuf, 0, errorCode));
+        }
+    }
+
     // Returns int[2] = { value, lengthInBytes } or null if not enough bytes available to parse VarInt
     private static int[] tryReadVarInt(ByteBuf buf) {
         int value = 0;
@@ -5,6 +5,11 @@ import io.lattice.nativeutil.LatticeNativeInitializer;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.List;
+
 /**
  * 原生红石优化器
  * 使用C++原生代码优化Minecraft红石系统计算
@@ -115,6 +120,60 @@ public class NativeRedstoneOptimizer {
      */
     private static native void nativeInvalidateNetworkCache(int x, int y, int z);
     
+    // 每条开销记录的字节数，与native/jni/redstone/redstone_optimizer_jni.hpp一致
+    private static final int NETWORK_COST_RECORD_SIZE = 8 + 4 * 7 + 8 * 4;
+    
+    /**
+     * 设置按网络的开销统计
+     * @param enabled 是否启用
+     * @param sampleInterval 每多少次网络更新采样一次耗时
+     */
+    public static void setProfiling(boolean enabled, int sampleInterval) {
+        if (isNativeOptimizationAvailable()) {
+            try {
+                nativeSetProfiling(enabled, sampleInterval);
+            } catch (Throwable t) {
+                LOGGER.warn("设置红石开销统计失败", t);
+            }
+        }
+    }
+    
+    /**
+     * 获取最近耗时最高的红石网络
+     * @param limit 最多返回的条数
+     * @return 按耗时从高到低排列的网络开销，原生优化不可用时为空
+     */
+    public static List<RedstonePerformanceMonitor.NetworkCost> getTopNetworks(int limit) {
+        List<RedstonePerformanceMonitor.NetworkCost> result = new ArrayList<>();
+        if (limit <= 0 || !isNativeOptimizationAvailable()) {
+            return result;
+        }
+        try {
+            ByteBuffer buffer = ByteBuffer.allocateDirect(limit * NETWORK_COST_RECORD_SIZE).order(ByteOrder.nativeOrder());
+            int count = nativeTopNetworks(limit, buffer);
+            for (int i = 0; i < count; i++) {
+                result.add(new RedstonePerformanceMonitor.NetworkCost(
+                    buffer.getLong(), buffer.getInt(),
+                    buffer.getInt(), buffer.getInt(), buffer.getInt(),
+                    buffer.getInt(), buffer.getInt(), buffer.getInt(),
+                    buffer.getLong(), buffer.getLong(), buffer.getDouble(), buffer.getDouble()));
+            }
+        } catch (Throwable t) {
+            LOGGER.warn("获取红石网络开销失败", t);
+        }
+        return result;
+    }
+    
+    /**
+     * 原生方法：设置开销统计
+     */
+    private static native void nativeSetProfiling(boolean enabled, int sampleInterval);
+    
+    /**
+     * 原生方法：写出耗时最高的网络
+     */
+    private static native int nativeTopNetworks(int limit, ByteBuffer out);
+    
     /**
      * 检查原生优化是否可用
      * @return 原生优化是否可用
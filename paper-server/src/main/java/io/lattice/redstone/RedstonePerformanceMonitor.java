@@ -3,6 +3,7 @@ package io.lattice.redstone;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
+import java.util.List;
 import java.util.concurrent.atomic.AtomicLong;
 
 /**
@@ -24,6 +25,21 @@ public class RedstonePerformanceMonitor {
     private final AtomicLong cacheSize = new AtomicLong(0);
     private final AtomicLong cacheEvictions = new AtomicLong(0);
     
+    // 报告中列出的最耗时网络数
+    private static final int REPORT_TOP_NETWORKS = 5;
+    
+    /**
+     * 单个红石网络的开销
+     * @param networkId 网络id
+     * @param world 所在世界
+     * @param nanosPerTick 最近一段时间（约一分钟半衰期）平均每tick的估计耗时，按采样放大
+     * @param updatesPerTick 最近一段时间平均每tick功率变化的红石线数
+     */
+    public record NetworkCost(long networkId, int world,
+                              int minX, int minY, int minZ, int maxX, int maxY, int maxZ,
+                              long evaluations, long updates, double nanosPerTick, double updatesPerTick) {
+    }
+    
     // 单例实例
     private static final RedstonePerformanceMonitor instance = new RedstonePerformanceMonitor();
     
@@ -191,6 +207,15 @@ public class RedstonePerformanceMonitor {
         return cacheEvictions.get();
     }
     
+    /**
+     * 获取最近耗时最高的红石网络
+     * @param limit 最多返回的条数
+     * @return 按耗时从高到低排列的网络开销
+     */
+    public List<NetworkCost> getTopNetworks(int limit) {
+        return NativeRedstoneOptimizer.getTopNetworks(limit);
+    }
+    
     /**
      * 打印性能统计报告
      */
@@ -204,6 +229,17 @@ public class RedstonePerformanceMonitor {
         LOGGER.info("最大计算时间: {} 纳秒", getMaxCalculationTime());
         LOGGER.info("当前缓存大小: {}", getCacheSize());
         LOGGER.info("缓存驱逐次数: {}", getCacheEvictions());
+        List<NetworkCost> topNetworks = getTopNetworks(REPORT_TOP_NETWORKS);
+        if (!topNetworks.isEmpty()) {
+            LOGGER.info("最耗时的红石网络:");
+            for (NetworkCost cost : topNetworks) {
+                LOGGER.info("  网络 {} 世界 {} ({}, {}, {}) - ({}, {}, {}): {} 微秒/tick, {} 更新/tick",
+                    cost.networkId(), cost.world(), cost.minX(), cost.minY(), cost.minZ(),
+                    cost.maxX(), cost.maxY(), cost.maxZ(),
+                    String.format("%.1f", cost.nanosPerTick() / 1000.0),
+                    String.format("%.1f", cost.updatesPerTick()));
+            }
+        }
         LOGGER.info("========================");
     }
     
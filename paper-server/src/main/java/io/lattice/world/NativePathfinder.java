@@ -2,6 +2,16 @@ package io.lattice.world;
 
 import io.lattice.config.LatticeConfig;
 import io.lattice.nativeutil.LatticeNativeInitializer;
+import io.lattice.nativeutil.SharedRingChannel;
+import java.util.concurrent.TimeUnit;
+import net.minecraft.core.BlockPos;
+import net.minecraft.tags.BlockTags;
+import net.minecraft.tags.FluidTags;
+import net.minecraft.world.level.Level;
+import net.minecraft.world.level.block.Blocks;
+import net.minecraft.world.level.block.state.BlockState;
+import net.minecraft.world.level.chunk.LevelChunk;
+import net.minecraft.world.level.chunk.LevelChunkSection;
 import org.slf4j.Logger;
 import org.slf4j.LoggerFactory;
 
@@ -25,6 +35,27 @@ public class NativePathfinder {
     public static final int MOB_TYPE_WATER = 3;       // 水生生物
     public static final int MOB_TYPE_FLYING = 4;      // 飞行生物
     
+    // 寻路方块分类（与native/core/world/pathfinder.hpp的PathBlockType一致）
+    public static final byte BLOCK_OPEN = 0;          // 可穿过
+    public static final byte BLOCK_SOLID = 1;         // 完整碰撞箱，可站立其上
+    public static final byte BLOCK_WATER = 2;         // 水
+    public static final byte BLOCK_DANGER = 3;        // 岩浆、火、仙人掌等
+    public static final byte BLOCK_FENCE = 4;         // 栅栏、墙
+    
+    // 方块变化经共享内存通道上报（格式与native/jni/world/pathfinder_jni.cpp的PATH_RING_BLOCK_CHANGES一致）：
+    // 每条记录16字节，int32 x, y, z, type
+    private static final int RING_BLOCK_CHANGES = SharedRingChannel.messageType(SharedRingChannel.SUBSYSTEM_PATHFINDER, 1);
+    private static final int RING_RECORD_SIZE = 16;
+    private static final int RING_COMMAND_SLOTS = 8192;
+    private static final int RING_SLOT_SIZE = 32;
+    // 段上传与区块卸载之前等待命令环排空的上限；超时只记一次日志
+    private static final long RING_DRAIN_TIMEOUT_NANOS = TimeUnit.MILLISECONDS.toNanos(50);
+    
+    // 首次上报方块变化时创建，之后在进程内一直使用；创建失败时为null，回退到nativeSetBlock
+    private static volatile SharedRingChannel blockChannel;
+    private static boolean blockChannelOpened = false;
+    private static boolean drainTimeoutLogged = false;
+    
     static {
         // 使用统一的本地库初始化器
         nativeLibraryLoaded = LatticeNativeInitializer.isNativeLibraryLoaded();
@@ -101,6 +132,159 @@ public class NativePathfinder {
         return new MobPathfindingParams();
     }
     
+    /**
+     * 原生方法：上传区块段的寻路分类（4096项，下标(y << 8) | (z << 4) | x），null移除该段
+     */
+    private static native void nativeSetSectionBlocks(int chunkX, int sectionY, int chunkZ, byte[] types);
+    
+    /**
+     * 原生方法：单个方块的寻路分类变化
+     */
+    private static native void nativeSetBlock(int x, int y, int z, int type);
+    
+    /**
+     * 原生方法：移除区块的所有段
+     */
+    private static native void nativeClearChunk(int chunkX, int chunkZ);
+    
+    /**
+     * 方块状态的寻路分类
+     * @param state 方块状态
+     * @return BLOCK_OPEN等分类
+     */
+    public static byte classifyBlock(BlockState state) {
+        if (state.isAir()) {
+            return BLOCK_OPEN;
+        }
+        if (state.getFluidState().is(FluidTags.LAVA) || state.is(BlockTags.FIRE) || state.is(Blocks.CACTUS)
+                || state.is(Blocks.SWEET_BERRY_BUSH) || state.is(Blocks.MAGMA_BLOCK) || state.is(BlockTags.CAMPFIRES)
+                || state.is(Blocks.POWDER_SNOW) || state.is(Blocks.WITHER_ROSE)) {
+            return BLOCK_DANGER;
+        }
+        if (state.is(BlockTags.FENCES) || state.is(BlockTags.WALLS) || state.is(BlockTags.FENCE_GATES)) {
+            return BLOCK_FENCE;
+        }
+        if (state.getFluidState().is(FluidTags.WATER)) {
+            return state.blocksMotion() ? BLOCK_SOLID : BLOCK_WATER;
+        }
+        return state.blocksMotion() ? BLOCK_SOLID : BLOCK_OPEN;
+    }
+    
+    // 原生寻路只维护一个世界的方块快照（主世界），其他维度的区块不上传
+    private static boolean tracksLevel(Level level) {
+        return level.dimension() == Level.OVERWORLD && isNativeOptimizationAvailable();
+    }
+    
+    /**
+     * 区块加载完成时调用：上传每个非空段的寻路分类
+     * @param chunk 已加载的区块
+     */
+    public static void onChunkLoad(LevelChunk chunk) {
+        if (!tracksLevel(chunk.getLevel())) {
+            return;
+        }
+        try {
+            awaitBlockChanges();
+            int chunkX = chunk.getPos().x;
+            int chunkZ = chunk.getPos().z;
+            LevelChunkSection[] sections = chunk.getSections();
+            byte[] types = new byte[4096];
+            for (int i = 0; i < sections.length; i++) {
+                int sectionY = chunk.getSectionYFromSectionIndex(i);
+                LevelChunkSection section = sections[i];
+                if (section == null || section.hasOnlyAir()) {
+                    nativeSetSectionBlocks(chunkX, sectionY, chunkZ, null);
+                    continue;
+                }
+                for (int y = 0; y < 16; y++) {
+                    for (int z = 0; z < 16; z++) {
+                        for (int x = 0; x < 16; x++) {
+                            types[(y << 8) | (z << 4) | x] = classifyBlock(section.getBlockState(x, y, z));
+                        }
+                    }
+                }
+                nativeSetSectionBlocks(chunkX, sectionY, chunkZ, types);
+            }
+        } catch (Throwable t) {
+            LOGGER.warn("上传区块寻路数据失败，禁用原生寻路", t);
+            nativeOptimizationAvailable = false;
+        }
+    }
+    
+    /**
+     * 区块卸载时调用
+     */
+    public static void onChunkUnload(Level level, int chunkX, int chunkZ) {
+        if (!tracksLevel(level)) {
+            return;
+        }
+        try {
+            awaitBlockChanges();
+            nativeClearChunk(chunkX, chunkZ);
+        } catch (Throwable t) {
+            LOGGER.warn("移除区块寻路数据失败，禁用原生寻路", t);
+            nativeOptimizationAvailable = false;
+        }
+    }
+    
+    /**
+     * 方块变化后调用（LevelChunk.setBlockState中状态确实改变时）
+     */
+    public static void onBlockChange(Level level, BlockPos pos, BlockState state) {
+        if (!tracksLevel(level)) {
+            return;
+        }
+        try {
+            int x = pos.getX();
+            int y = pos.getY();
+            int z = pos.getZ();
+            int type = classifyBlock(state);
+            SharedRingChannel channel = blockChannel();
+            if (channel != null && channel.offer(RING_BLOCK_CHANGES, (buffer, offset, capacity) -> {
+                buffer.putInt(offset, x);
+                buffer.putInt(offset + 4, y);
+                buffer.putInt(offset + 8, z);
+                buffer.putInt(offset + 12, type);
+                return RING_RECORD_SIZE;
+            })) {
+                return;
+            }
+            // 没有通道或命令环已满：先等已写入的变化处理完，再直接调用，保持顺序
+            awaitBlockChanges();
+            nativeSetBlock(x, y, z, type);
+        } catch (Throwable t) {
+            LOGGER.warn("上报方块寻路分类失败，禁用原生寻路", t);
+            nativeOptimizationAvailable = false;
+        }
+    }
+    
+    private static SharedRingChannel blockChannel() {
+        SharedRingChannel channel = blockChannel;
+        if (channel != null || blockChannelOpened) {
+            return channel;
+        }
+        synchronized (NativePathfinder.class) {
+            if (!blockChannelOpened) {
+                blockChannelOpened = true;
+                // 处理函数与nativeSetBlock在同一个库中；没有登记时不用通道
+                if (SharedRingChannel.hasHandler(SharedRingChannel.SUBSYSTEM_PATHFINDER)) {
+                    // 结果环不使用，取最小的几何
+                    blockChannel = SharedRingChannel.open(RING_COMMAND_SLOTS, RING_SLOT_SIZE, 2, 24);
+                }
+            }
+            return blockChannel;
+        }
+    }
+    
+    // 段的上传与移除走JNI直接调用，必须排在此前经通道上报的方块变化之后
+    private static void awaitBlockChanges() {
+        SharedRingChannel channel = blockChannel;
+        if (channel != null && !channel.awaitCommandsDrained(RING_DRAIN_TIMEOUT_NANOS) && !drainTimeoutLogged) {
+            drainTimeoutLogged = true;
+            LOGGER.warn("等待寻路方块变化处理超时");
+        }
+    }
+    
     /**
      * 根据Minecraft原版实体类型获取对应的寻路类型
      * @param entityClass 实体类名
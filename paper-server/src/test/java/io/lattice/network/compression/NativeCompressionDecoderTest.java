@@ -0,0 +1,172 @@
+package io.lattice.network.compression;
+
+import static org.junit.jupiter.api.Assertions.*;
+
+import io.lattice.network.AsyncCompressionCallback;
+import io.lattice.network.NativeCompression;
+import io.netty.buffer.ByteBuf;
+import io.netty.buffer.Unpooled;
+import io.netty.channel.embedded.EmbeddedChannel;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.util.ArrayDeque;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import java.util.zip.Inflater;
+import org.junit.jupiter.api.Test;
+
+public class NativeCompressionDecoderTest {
+
+    private static final int LARGE_SIZE = NativeCompression.INBOUND_ASYNC_THRESHOLD + 1000;
+
+    /** Decoder whose inbound decompressor is driven by the test instead of the native pool */
+    private static final class ManualDecoder extends NativeCompressionDecoder {
+        private final ArrayDeque<Runnable> inFlight = new ArrayDeque<>();
+
+        ManualDecoder() {
+            super(NativeCompression.MAX_DECOMPRESSED_SIZE);
+        }
+
+        @Override
+        boolean asyncInboundAvailable() {
+            return true;
+        }
+
+        @Override
+        int submitInbound(ByteBuffer srcNio, int compressedLen, ByteBuffer dstNio, int uncompressedSize,
+                          AsyncCompressionCallback callback) {
+            // Like the native side, copy the source before returning
+            byte[] compressed = new byte[compressedLen];
+            srcNio.duplicate().get(compressed);
+            inFlight.add(() -> {
+                Inflater inflater = new Inflater();
+                try {
+                    inflater.setInput(compressed);
+                    callback.onSuccess(inflater.inflate(dstNio));
+                } catch (DataFormatException e) {
+                    callback.onError(NativeCompression.INBOUND_CORRUPT);
+                } finally {
+                    inflater.end();
+                }
+            });
+            return NativeCompression.INBOUND_QUEUED;
+        }
+
+        void completeNext() {
+            inFlight.remove().run();
+        }
+    }
+
+    private static byte[] payload(int size, int seed) {
+        byte[] data = new byte[size];
+        for (int i = 0; i < size; i++) {
+            data[i] = (byte) ((i * 31 + seed) % 251);
+        }
+        return data;
+    }
+
+    private static void writeVarInt(ByteBuf buf, int value) {
+        while ((value & ~0x7F) != 0) {
+            buf.writeByte((value & 0x7F) | 0x80);
+            value >>>= 7;
+        }
+        buf.writeByte(value);
+    }
+
+    private static ByteBuf compressedFrame(byte[] data) {
+        Deflater deflater = new Deflater();
+        deflater.setInput(data);
+        deflater.finish();
+        byte[] out = new byte[data.length + 64];
+        int len = deflater.deflate(out);
+        deflater.end();
+        ByteBuf frame = Unpooled.directBuffer();
+        writeVarInt(frame, data.length);
+        frame.writeBytes(out, 0, len);
+        return frame;
+    }
+
+    private static ByteBuf plainFrame(String text) {
+        ByteBuf frame = Unpooled.directBuffer();
+        writeVarInt(frame, 0);
+        frame.writeBytes(text.getBytes(StandardCharsets.US_ASCII));
+        return frame;
+    }
+
+    private static void assertPacket(EmbeddedChannel channel, byte[] expected) {
+        ByteBuf packet = channel.readInbound();
+        assertNotNull(packet, "packet missing");
+        try {
+            byte[] actual = new byte[packet.readableBytes()];
+            packet.readBytes(actual);
+            assertArrayEquals(expected, actual);
+        } finally {
+            packet.release();
+        }
+    }
+
+    private static void assertPacket(EmbeddedChannel channel, String expected) {
+        assertPacket(channel, expected.getBytes(StandardCharsets.US_ASCII));
+    }
+
+    @Test
+    public void framesBehindAsyncPacketStaySeparate() {
+        ManualDecoder decoder = new ManualDecoder();
+        EmbeddedChannel channel = new EmbeddedChannel(decoder);
+        byte[] large = payload(LARGE_SIZE, 1);
+
+        channel.writeInbound(compressedFrame(large), plainFrame("ab"), plainFrame("c"));
+        assertNull(channel.readInbound(), "nothing may overtake the in-flight packet");
+
+        decoder.completeNext();
+        channel.runPendingTasks();
+
+        assertPacket(channel, large);
+        assertPacket(channel, "ab");
+        assertPacket(channel, "c");
+        assertNull(channel.readInbound());
+        assertFalse(channel.finish());
+    }
+
+    @Test
+    public void replayStopsAtNextAsyncPacket() {
+        ManualDecoder decoder = new ManualDecoder();
+        EmbeddedChannel channel = new EmbeddedChannel(decoder);
+        byte[] first = payload(LARGE_SIZE, 2);
+        byte[] second = payload(LARGE_SIZE, 3);
+
+        channel.writeInbound(compressedFrame(first), plainFrame("x"), compressedFrame(second), plainFrame("y"));
+        decoder.completeNext();
+        channel.runPendingTasks();
+
+        assertPacket(channel, first);
+        assertPacket(channel, "x");
+        assertNull(channel.readInbound(), "the frame behind the second async packet must wait for it");
+
+        channel.writeInbound(plainFrame("z"));
+        decoder.completeNext();
+        channel.runPendingTasks();
+
+        assertPacket(channel, second);
+        assertPacket(channel, "y");
+        assertPacket(channel, "z");
+        assertNull(channel.readInbound());
+        assertFalse(channel.finish());
+    }
+
+    @Test
+    public void pendingFramesReleasedOnRemoval() {
+        ManualDecoder decoder = new ManualDecoder();
+        EmbeddedChannel channel = new EmbeddedChannel(decoder);
+        ByteBuf queued = plainFrame("q");
+
+        channel.writeInbound(compressedFrame(payload(LARGE_SIZE, 4)), queued);
+        channel.pipeline().remove(decoder);
+
+        assertEquals(0, queued.refCnt());
+        decoder.completeNext();
+        channel.runPendingTasks();
+        assertNull(channel.readInbound());
+        channel.finishAndReleaseAll();
+    }
+}